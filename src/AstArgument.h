@@ -89,7 +89,7 @@ public:
 };
 
 /**
- * Counter
+ * Counter, whose values are unique but neither dense nor ordered in parallel evaluations
  */
 class AstCounter : public AstArgument {
 public:
@@ -383,6 +383,15 @@ public:
         returnType = type;
     }
 
+    /** check whether the functor receives the symbol and record tables */
+    bool isStateful() const {
+        return stateful;
+    }
+
+    void setStateful(bool value) {
+        stateful = value;
+    }
+
     AstUserDefinedFunctor* clone() const override {
         auto res = new AstUserDefinedFunctor(name);
         // Set args
@@ -395,6 +404,7 @@ public:
             res->setArgsTypes(argTypes);
         }
         res->setReturnType(returnType);
+        res->setStateful(stateful);
 
         res->setSrcLoc(getSrcLoc());
         return res;
@@ -409,6 +419,7 @@ protected:
 
     std::vector<TypeAttribute> argTypes;
     TypeAttribute returnType;
+    bool stateful = false;
 
     /** name of user-defined functor */
     const std::string name;
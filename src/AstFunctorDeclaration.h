@@ -32,9 +32,9 @@ namespace souffle {
 
 class AstFunctorDeclaration : public AstNode {
 public:
-    AstFunctorDeclaration(
-            const std::string& name, std::vector<TypeAttribute> argsTypes, TypeAttribute returnType)
-            : name(name), argsTypes(std::move(argsTypes)), returnType(returnType) {
+    AstFunctorDeclaration(const std::string& name, std::vector<TypeAttribute> argsTypes,
+            TypeAttribute returnType, bool stateful = false)
+            : name(name), argsTypes(std::move(argsTypes)), returnType(returnType), stateful(stateful) {
         assert(name.length() > 0 && "functor name is empty");
     }
 
@@ -58,7 +58,11 @@ public:
         std::transform(argsTypes.begin(), argsTypes.end(), args.begin(), convert);
 
         out << join(args, ",");
-        out << "):" << convert(returnType) << std::endl;
+        out << "):" << convert(returnType);
+        if (stateful) {
+            out << " stateful";
+        }
+        out << std::endl;
     }
 
     /** get name */
@@ -75,6 +79,11 @@ public:
         return returnType;
     }
 
+    /** check whether the functor receives the symbol and record tables */
+    bool isStateful() const {
+        return stateful;
+    }
+
     /** get number of arguments */
     size_t getArity() const {
         return argsTypes.size();
@@ -82,7 +91,7 @@ public:
 
     /** clone */
     AstFunctorDeclaration* clone() const override {
-        auto* res = new AstFunctorDeclaration(name, argsTypes, returnType);
+        auto* res = new AstFunctorDeclaration(name, argsTypes, returnType, stateful);
         res->setSrcLoc(getSrcLoc());
         return res;
     }
@@ -91,7 +100,8 @@ protected:
     bool equal(const AstNode& node) const override {
         assert(nullptr != dynamic_cast<const AstFunctorDeclaration*>(&node));
         const auto& other = static_cast<const AstFunctorDeclaration&>(node);
-        return name == other.name && argsTypes == other.argsTypes && returnType == other.returnType;
+        return name == other.name && argsTypes == other.argsTypes && returnType == other.returnType &&
+               stateful == other.stateful;
     }
 
     /** name of functor */
@@ -102,6 +112,9 @@ protected:
 
     /** Type of the return value */
     const TypeAttribute returnType;
+
+    /** Whether the functor receives the symbol and record tables */
+    const bool stateful;
 };
 
 }  // end of namespace souffle
@@ -83,6 +83,9 @@ BoolDisjunctConstraint isTrue(const BoolDisjunctVar& var) {
             ass[var] = true;
             return res;
         }
+        std::vector<BoolDisjunctVar> getVariables() const override {
+            return {var};
+        }
         void print(std::ostream& out) const override {
             out << var << " is true";
         }
@@ -132,6 +135,12 @@ BoolDisjunctConstraint imply(const std::vector<BoolDisjunctVar>& vars, const Boo
             return true;
         }
 
+        std::vector<BoolDisjunctVar> getVariables() const override {
+            std::vector<BoolDisjunctVar> all = vars;
+            all.push_back(res);
+            return all;
+        }
+
         void print(std::ostream& out) const override {
             out << join(vars, " ∧ ") << " ⇒ " << res;
         }
@@ -16,22 +16,46 @@
  ***********************************************************************/
 
 #include "AstProfileUse.h"
+#include "AstArgument.h"
+#include "AstClause.h"
+#include "AstLiteral.h"
+#include "AstProgram.h"
+#include "AstRelation.h"
 #include "AstRelationIdentifier.h"
+#include "AstTranslationUnit.h"
+#include "AstUtils.h"
+#include "AstVisitor.h"
 #include "Global.h"
 #include "profile/ProgramRun.h"
 #include "profile/Reader.h"
 #include "profile/Relation.h"
+#include <algorithm>
 #include <limits>
+#include <numeric>
 #include <string>
 
 namespace souffle {
 
-class AstTranslationUnit;
+namespace {
+
+/**
+ * Add the variables bound by the given atom, i.e., its arguments being variables.
+ */
+void bindVariables(const AstAtom* atom, std::set<std::string>& boundVariables) {
+    for (const AstArgument* arg : atom->getArguments()) {
+        if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+            boundVariables.insert(var->getName());
+        }
+    }
+}
+
+}  // namespace
 
 /**
  * Run analysis, i.e., retrieve profile information
  */
 void AstProfileUse::run(const AstTranslationUnit& translationUnit) {
+    program = translationUnit.getProgram();
     if (Global::config().has("profile-use")) {
         std::string filename = Global::config().get("profile-use");
         profile::Reader(filename, programRun).processFile();
@@ -39,9 +63,34 @@ void AstProfileUse::run(const AstTranslationUnit& translationUnit) {
 }
 
 /**
- * Print analysis
+ * Print analysis, i.e., the estimated costs of the join orders of all rules with statistics
  */
-void AstProfileUse::print(std::ostream& os) const {}
+void AstProfileUse::print(std::ostream& os) const {
+    if (program == nullptr) {
+        return;
+    }
+    for (const AstRelation* rel : program->getRelations()) {
+        for (const AstClause* clause : rel->getClauses()) {
+            const auto& atoms = getBodyLiterals<AstAtom>(*clause);
+            if (atoms.size() < 2) {
+                continue;
+            }
+            os << *clause << std::endl;
+            if (!std::all_of(atoms.begin(), atoms.end(),
+                        [&](const AstAtom* atom) { return hasStatistics(atom->getName()); })) {
+                os << "   no statistics available" << std::endl;
+                continue;
+            }
+            const std::vector<const AstAtom*> order(atoms.begin(), atoms.end());
+            const std::vector<double> cardinalities = getCardinalityEstimates(order);
+            for (size_t i = 0; i < order.size(); ++i) {
+                os << "   " << *order[i] << ": " << cardinalities[i] << " estimated tuples" << std::endl;
+            }
+            os << "   estimated cost: "
+               << std::accumulate(cardinalities.begin(), cardinalities.end(), 0.0) << std::endl;
+        }
+    }
+}
 
 /**
  * Check whether relation size is defined in profile
@@ -55,10 +104,163 @@ bool AstProfileUse::hasRelationSize(const AstRelationIdentifier& rel) {
  */
 size_t AstProfileUse::getRelationSize(const AstRelationIdentifier& rel) {
     if (const auto* profRel = programRun->getRelation(rel.getName())) {
-        return profRel->size();
+        return profRel->hasCardinality() ? profRel->getCardinality() : profRel->size();
     } else {
         return std::numeric_limits<size_t>::max();
     }
 }
 
+/**
+ * Check whether relation statistics are defined in profile
+ */
+bool AstProfileUse::hasStatistics(const AstRelationIdentifier& rel) const {
+    const auto* profRel = programRun->getRelation(rel.getName());
+    return profRel != nullptr && profRel->hasCardinality();
+}
+
+/**
+ * Get the number of distinct values of a column from profile, assuming a key if unknown
+ */
+size_t AstProfileUse::getDistinctValues(const AstRelationIdentifier& rel, size_t column) const {
+    const auto* profRel = programRun->getRelation(rel.getName());
+    if (profRel == nullptr) {
+        return std::numeric_limits<size_t>::max();
+    }
+    const auto& distinct = profRel->getDistinctValues();
+    auto pos = distinct.find(column);
+    return pos != distinct.end() ? pos->second : profRel->getCardinality();
+}
+
+/**
+ * Get the fraction of missing lookups of complete tuples from profile, each of which found at most one tuple
+ */
+double AstProfileUse::getLookupMissRatio(
+        const AstRelationIdentifier& rel, size_t arity, size_t minLookups) const {
+    const auto* searches = programRun->getSearches(rel.getName());
+    const auto* tuples = programRun->getSearchTuples(rel.getName());
+    if (searches == nullptr || tuples == nullptr || arity == 0 || arity >= 64) {
+        return 0;
+    }
+    const uint64_t total = (uint64_t(1) << arity) - 1;
+    auto lookups = searches->find(total);
+    if (lookups == searches->end() || lookups->second < minLookups) {
+        return 0;
+    }
+    auto hits = tuples->find(total);
+    const size_t found = hits != tuples->end() ? std::min(hits->second, lookups->second) : 0;
+    return 1.0 - static_cast<double>(found) / lookups->second;
+}
+
+/**
+ * Estimate the matching tuples of an atom, dividing the relation size by the distinct values of
+ * each bound column
+ */
+double AstProfileUse::getMatchEstimate(
+        const AstAtom* atom, const std::set<std::string>& boundVariables) const {
+    const AstRelationIdentifier& rel = atom->getName();
+    double estimate = std::max<size_t>(1, programRun->getRelation(rel.getName())->getCardinality());
+
+    // repeated variables of the atom are bound by their first occurrence
+    std::set<std::string> bound = boundVariables;
+    const auto& args = atom->getArguments();
+    for (size_t i = 0; i < args.size(); ++i) {
+        bool isBound = true;
+        visitDepthFirst(*args[i], [&](const AstVariable& var) {
+            if (bound.find(var.getName()) == bound.end()) {
+                isBound = false;
+            }
+        });
+        visitDepthFirst(*args[i], [&](const AstUnnamedVariable&) { isBound = false; });
+        if (isBound) {
+            estimate /= std::max<size_t>(1, getDistinctValues(rel, i));
+        } else if (const auto* var = dynamic_cast<const AstVariable*>(args[i])) {
+            bound.insert(var->getName());
+        }
+    }
+    return estimate;
+}
+
+/**
+ * Estimate the cardinalities of the prefixes of an atom order
+ */
+std::vector<double> AstProfileUse::getCardinalityEstimates(const std::vector<const AstAtom*>& atoms) const {
+    std::vector<double> res;
+    std::set<std::string> boundVariables;
+    double cardinality = 1;
+    for (const AstAtom* atom : atoms) {
+        cardinality *= getMatchEstimate(atom, boundVariables);
+        res.push_back(cardinality);
+        bindVariables(atom, boundVariables);
+    }
+    return res;
+}
+
+/**
+ * Find the cheapest atom order
+ */
+std::vector<unsigned int> AstProfileUse::getCostBasedOrder(const std::vector<AstAtom*>& atoms) const {
+    const size_t n = atoms.size();
+    std::vector<unsigned int> order;
+
+    // choose the atom producing the fewest bindings next if there are too many atoms to search
+    if (n > maxExhaustiveAtoms) {
+        std::vector<bool> done(n, false);
+        std::set<std::string> boundVariables;
+        while (order.size() < n) {
+            unsigned int best = 0;
+            double bestEstimate = -1;
+            for (unsigned int i = 0; i < n; ++i) {
+                if (done[i]) {
+                    continue;
+                }
+                double estimate = getMatchEstimate(atoms[i], boundVariables);
+                if (bestEstimate < 0 || estimate < bestEstimate) {
+                    best = i;
+                    bestEstimate = estimate;
+                }
+            }
+            done[best] = true;
+            order.push_back(best);
+            bindVariables(atoms[best], boundVariables);
+        }
+        return order;
+    }
+
+    // compute the cheapest order of each subset of atoms from the cheapest orders of its subsets,
+    // where the cost of an order is the sum of the cardinalities of its prefixes
+    const size_t subsets = size_t(1) << n;
+    std::vector<double> cost(subsets, -1);
+    std::vector<double> cardinality(subsets, 1);
+    std::vector<unsigned int> last(subsets, 0);
+    cost[0] = 0;
+    for (size_t subset = 0; subset < subsets; ++subset) {
+        std::set<std::string> boundVariables;
+        for (unsigned int i = 0; i < n; ++i) {
+            if ((subset & (size_t(1) << i)) != 0) {
+                bindVariables(atoms[i], boundVariables);
+            }
+        }
+        for (unsigned int i = 0; i < n; ++i) {
+            const size_t next = subset | (size_t(1) << i);
+            if (next == subset) {
+                continue;
+            }
+            const double nextCardinality = cardinality[subset] * getMatchEstimate(atoms[i], boundVariables);
+            const double nextCost = cost[subset] + nextCardinality;
+            if (cost[next] < 0 || nextCost < cost[next]) {
+                cost[next] = nextCost;
+                cardinality[next] = nextCardinality;
+                last[next] = i;
+            }
+        }
+    }
+
+    // reconstruct the order of all atoms
+    for (size_t subset = subsets - 1; subset != 0; subset &= ~(size_t(1) << last[subset])) {
+        order.push_back(last[subset]);
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
 }  // end of namespace souffle
@@ -23,9 +23,15 @@
 #include <cstddef>
 #include <iostream>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace souffle {
 
+class AstAtom;
+class AstProgram;
+
 /**
  * AstAnalysis that loads profile data and has a profile query interface.
  */
@@ -34,6 +40,9 @@ private:
     /** performance model of profile run */
     std::shared_ptr<profile::ProgramRun> programRun;
 
+    /** program whose join plans are reported */
+    const AstProgram* program = nullptr;
+
 public:
     /** Name of analysis */
     static constexpr const char* name = "profile-use";
@@ -51,6 +60,40 @@ public:
 
     /** Return size of relation in the profile */
     size_t getRelationSize(const AstRelationIdentifier& rel);
+
+    /** Check whether the cardinality and distinct values of the relation exist in profile */
+    bool hasStatistics(const AstRelationIdentifier& rel) const;
+
+    /** Return the estimated number of distinct values of a column of the relation in the profile */
+    size_t getDistinctValues(const AstRelationIdentifier& rel, size_t column) const;
+
+    /**
+     * Return the fraction of the lookups of complete tuples of the relation of the given arity in the
+     * profile which found no tuple, or 0 if there were fewer than minLookups of them.
+     */
+    double getLookupMissRatio(const AstRelationIdentifier& rel, size_t arity, size_t minLookups) const;
+
+    /**
+     * Estimate the number of tuples of the given atom matching each binding of the given variables,
+     * assuming uniformly distributed and independent columns.
+     */
+    double getMatchEstimate(const AstAtom* atom, const std::set<std::string>& boundVariables) const;
+
+    /**
+     * Estimate the number of bindings produced by each prefix of the given order of atoms. The cost of
+     * the order is the sum of these cardinalities, i.e., the number of enumerated intermediate tuples.
+     */
+    std::vector<double> getCardinalityEstimates(const std::vector<const AstAtom*>& atoms) const;
+
+    /**
+     * Find the order of the given atoms minimising the estimated cost, by dynamic programming over the
+     * subsets of atoms for up to maxExhaustiveAtoms atoms and greedily otherwise. Requires the statistics
+     * of all relations of the atoms.
+     */
+    std::vector<unsigned int> getCostBasedOrder(const std::vector<AstAtom*>& atoms) const;
+
+    /** Maximum number of atoms whose orders are searched exhaustively */
+    static constexpr size_t maxExhaustiveAtoms = 14;
 };
 
 }  // end of namespace souffle
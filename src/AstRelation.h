@@ -63,9 +63,24 @@
 /* Relation is an info relation for provenance */
 #define INFO_RELATION (0x200)
 
+/* Relation uses a hash set data structure */
+#define HASHSET_RELATION (0x400)
+
 /* Relation warnings are suppressed */
 #define SUPPRESSED_RELATION (0x800)
 
+/* Relation keeps the tuple with the least last attribute of each key */
+#define MIN_RELATION (0x1000)
+
+/* Relation keeps the tuple with the greatest last attribute of each key */
+#define MAX_RELATION (0x2000)
+
+/* Relation spills its tuples to disk under memory pressure */
+#define EXTERNAL_RELATION (0x4000)
+
+/* Relation uses a dense bitmap or adjacency data structure */
+#define DENSE_RELATION (0x8000)
+
 namespace souffle {
 
 /*!
@@ -97,6 +112,12 @@ public:
             os << "inline ";
         }
         os << representation << " ";
+        if (blockSize != 0) {
+            os << "blocksize(" << blockSize << ") ";
+        }
+        if (!choiceDomain.empty()) {
+            os << "choice-domain (" << join(choiceDomain, ",") << ") ";
+        }
     }
 
     /** Return the name of the relation */
@@ -115,6 +136,11 @@ public:
         attributes.push_back(std::move(attr));
     }
 
+    /** Remove the attribute at position @p idx */
+    void removeAttribute(size_t idx) {
+        attributes.erase(attributes.begin() + idx);
+    }
+
     /** Return the arity of this relation */
     size_t getArity() const {
         return attributes.size();
@@ -144,11 +170,41 @@ public:
             representation = RelationRepresentation::BRIE;
         } else if ((q & BTREE_RELATION) != 0) {
             representation = RelationRepresentation::BTREE;
+        } else if ((q & HASHSET_RELATION) != 0) {
+            representation = RelationRepresentation::HASHSET;
+        } else if ((q & DENSE_RELATION) != 0) {
+            representation = RelationRepresentation::DENSE;
+        } else if ((q & MIN_RELATION) != 0) {
+            representation = RelationRepresentation::MIN_LATTICE;
+        } else if ((q & MAX_RELATION) != 0) {
+            representation = RelationRepresentation::MAX_LATTICE;
+        } else if ((q & EXTERNAL_RELATION) != 0) {
+            representation = RelationRepresentation::EXTERNAL;
         } else if ((q & INFO_RELATION) != 0) {
             representation = RelationRepresentation::INFO;
         }
     }
 
+    /** Return the number of bytes of b-tree nodes requested for this relation, 0 if unspecified */
+    size_t getBlockSize() const {
+        return blockSize;
+    }
+
+    /** Set the number of bytes of b-tree nodes requested for this relation */
+    void setBlockSize(size_t size) {
+        blockSize = size;
+    }
+
+    /** Return the attributes of which this relation keeps only the first tuple, empty if unrestricted */
+    const std::vector<std::string>& getChoiceDomain() const {
+        return choiceDomain;
+    }
+
+    /** Set the attributes of which this relation keeps only the first tuple */
+    void setChoiceDomain(std::vector<std::string> domain) {
+        choiceDomain = std::move(domain);
+    }
+
     /** Get representation for this relation */
     RelationRepresentation getRepresentation() const {
         return representation;
@@ -231,6 +287,8 @@ public:
             res->clauses.emplace_back(cur->clone());
         }
         res->qualifier = qualifier;
+        res->blockSize = blockSize;
+        res->choiceDomain = choiceDomain;
         return res;
     }
 
@@ -280,6 +338,12 @@ protected:
 
     /** Datastructure to use for this relation */
     RelationRepresentation representation{RelationRepresentation::DEFAULT};
+
+    /** Number of bytes of b-tree nodes requested by a qualifier, 0 if unspecified */
+    size_t blockSize = 0;
+
+    /** Attributes functionally determining the other attributes, inserts of a known key being rejected */
+    std::vector<std::string> choiceDomain;
 };
 
 struct AstNameComparison {
@@ -36,6 +36,7 @@
 #include "ErrorReport.h"
 #include "FunctorOps.h"
 #include "Global.h"
+#include "IODirectives.h"
 #include "GraphUtils.h"
 #include "PrecedenceGraph.h"
 #include "RamTypes.h"
@@ -695,6 +696,85 @@ void AstSemanticChecker::checkRelation(ErrorReport& report, const TypeEnvironmen
         }
     }
 
+    if (relation.getRepresentation() == RelationRepresentation::DENSE && relation.getArity() != 1 &&
+            relation.getArity() != 2) {
+        report.addWarning("Dense relation " + toString(relation.getName()) +
+                                  " is neither unary nor binary, using a b-tree instead",
+                relation.getSrcLoc());
+    }
+
+    if (relation.getRepresentation() == RelationRepresentation::MIN_LATTICE ||
+            relation.getRepresentation() == RelationRepresentation::MAX_LATTICE) {
+        if (relation.getArity() == 0) {
+            report.addError("Subsumptive relation " + toString(relation.getName()) + " is nullary",
+                    relation.getSrcLoc());
+        } else {
+            const AstTypeIdentifier& valueType =
+                    relation.getAttribute(relation.getArity() - 1)->getTypeName();
+            if (!typeEnv.isType(valueType) || !isNumberType(typeEnv.getType(valueType))) {
+                report.addError("Last attribute of subsumptive relation " + toString(relation.getName()) +
+                                        " is not a number",
+                        relation.getSrcLoc());
+            }
+        }
+        if (Global::config().has("provenance")) {
+            report.addError("Subsumptive relation " + toString(relation.getName()) +
+                                    " is not supported with provenance",
+                    relation.getSrcLoc());
+        }
+        if (Global::config().has("incremental")) {
+            report.addError("Subsumptive relation " + toString(relation.getName()) +
+                                    " is not supported with incremental evaluation",
+                    relation.getSrcLoc());
+        }
+    }
+
+    if (!relation.getChoiceDomain().empty()) {
+        const auto& domain = relation.getChoiceDomain();
+        for (size_t i = 0; i < domain.size(); i++) {
+            const auto& attributes = relation.getAttributes();
+            if (std::none_of(attributes.begin(), attributes.end(),
+                        [&](const AstAttribute* attr) { return attr->getAttributeName() == domain[i]; })) {
+                report.addError("Choice-domain attribute " + domain[i] + " of relation " +
+                                        toString(relation.getName()) + " is not declared",
+                        relation.getSrcLoc());
+            }
+            if (std::find(domain.begin(), domain.begin() + i, domain[i]) != domain.begin() + i) {
+                report.addError("Choice-domain attribute " + domain[i] + " of relation " +
+                                        toString(relation.getName()) + " is given more than once",
+                        relation.getSrcLoc());
+            }
+        }
+        if (domain.size() > 12) {
+            report.addError("Choice-domain of relation " + toString(relation.getName()) +
+                                    " has more than 12 attributes",
+                    relation.getSrcLoc());
+        }
+        if (relation.getRepresentation() != RelationRepresentation::DEFAULT &&
+                relation.getRepresentation() != RelationRepresentation::BTREE) {
+            report.addError("Choice-domain of relation " + toString(relation.getName()) +
+                                    " is only supported for b-tree relations",
+                    relation.getSrcLoc());
+        }
+        if (Global::config().has("provenance")) {
+            report.addError("Choice-domain of relation " + toString(relation.getName()) +
+                                    " is not supported with provenance",
+                    relation.getSrcLoc());
+        }
+        if (Global::config().has("incremental")) {
+            report.addError("Choice-domain of relation " + toString(relation.getName()) +
+                                    " is not supported with incremental evaluation",
+                    relation.getSrcLoc());
+        }
+    }
+
+    // incremental updates change input relations through the interface only
+    if (Global::config().has("incremental") && ioTypes.isInput(&relation) && relation.clauseSize() > 0) {
+        report.addError("Input relation " + toString(relation.getName()) +
+                                " has rules or facts, which is not supported with incremental evaluation",
+                relation.getSrcLoc());
+    }
+
     // start with declaration
     checkRelationDeclaration(report, typeEnv, program, relation, ioTypes);
 
@@ -965,9 +1045,40 @@ void AstSemanticChecker::checkIODirectives(ErrorReport& report, const AstProgram
     };
     for (const auto& directive : program.getLoads()) {
         checkIODirective(directive.get());
+
+        // the sample of an input is a fraction of its tuples
+        const auto& directives = directive->getIODirectiveMap();
+        auto sample = directives.find("sample");
+        if (sample != directives.end() && !IODirectives::isSampleRate(sample->second)) {
+            report.addError("Invalid sample rate " + sample->second + " of relation " +
+                                    toString(directive->getName()) + ", expected a number in (0, 1]",
+                    directive->getSrcLoc());
+        }
     }
     for (const auto& directive : program.getStores()) {
         checkIODirective(directive.get());
+
+        // the order of an output lists distinct attributes of its relation
+        const auto* relation = program.getRelation(directive->getName());
+        const auto& directives = directive->getIODirectiveMap();
+        auto order = directives.find("order");
+        if (relation == nullptr || order == directives.end()) {
+            continue;
+        }
+        const std::vector<AstAttribute*> attributes = relation->getAttributes();
+        std::set<std::string> seen;
+        for (const std::string& name : splitString(order->second, ',')) {
+            if (std::none_of(attributes.begin(), attributes.end(),
+                        [&](const AstAttribute* attr) { return attr->getAttributeName() == name; })) {
+                report.addError("Unknown attribute " + name + " in the order of relation " +
+                                        toString(directive->getName()),
+                        directive->getSrcLoc());
+            } else if (!seen.insert(name).second) {
+                report.addError("Repeated attribute " + name + " in the order of relation " +
+                                        toString(directive->getName()),
+                        directive->getSrcLoc());
+            }
+        }
     }
 }
 
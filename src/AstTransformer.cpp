@@ -15,26 +15,73 @@
  ***********************************************************************/
 
 #include "AstTransformer.h"
+#include "AstClause.h"
+#include "AstIOTypeAnalysis.h"
+#include "AstProgram.h"
+#include "AstRelation.h"
 #include "AstTranslationUnit.h"
+#include "AstTypeEnvironmentAnalysis.h"
 #include "ErrorReport.h"
+#include "Global.h"
+#include "ParallelUtils.h"
+#include "PhaseTimes.h"
+#include "PrecedenceGraph.h"
+#include "Util.h"
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
 
 namespace souffle {
 
 bool AstTransformer::apply(AstTranslationUnit& translationUnit) {
     bool changed = transform(translationUnit);
     if (changed) {
-        translationUnit.invalidateAnalyses();
+        translationUnit.invalidateAnalyses(
+                [&](const std::string& analysis) { return preservesAnalysis(analysis); });
     }
     return changed;
 }
 
+bool AstClauseTransformer::transform(AstTranslationUnit& translationUnit) {
+    std::vector<AstClause*> clauses;
+    for (AstRelation* rel : translationUnit.getProgram()->getRelations()) {
+        for (AstClause* clause : rel->getClauses()) {
+            clauses.push_back(clause);
+        }
+    }
+
+    // transform the clauses on the threads of the jobs option
+    std::atomic<bool> changed(false);
+    const std::string jobs = Global::config().has("jobs") ? Global::config().get("jobs") : "1";
+    ThreadBudget::Lease threads(isNumber(jobs.c_str()) ? std::stoi(jobs) : 1);
+    PARALLEL_START
+    pfor(size_t i = 0; i < clauses.size(); i++) {
+        if (transformClause(*clauses[i])) {
+            changed = true;
+        }
+    }
+    PARALLEL_END
+    return changed;
+}
+
+bool AstClauseTransformer::preservesAnalysis(const std::string& analysis) const {
+    // the relations, their dependencies and the types are left unchanged
+    static const std::set<std::string> preserved = {PrecedenceGraph::name, RedundantRelations::name,
+            RecursiveClauses::name, SCCGraph::name, TopologicallySortedSCCGraph::name,
+            RelationSchedule::name, IOType::name, TypeEnvironmentAnalysis::name};
+    return preserved.find(analysis) != preserved.end();
+}
+
 bool MetaTransformer::applySubtransformer(AstTranslationUnit& translationUnit, AstTransformer* transformer) {
     auto start = std::chrono::high_resolution_clock::now();
+    const auto phaseStart = PhaseTimes::clock::now();
     bool changed = transformer->apply(translationUnit);
     auto end = std::chrono::high_resolution_clock::now();
+    if (dynamic_cast<MetaTransformer*>(transformer) == nullptr) {
+        PhaseTimes::instance().record("ast-transform", transformer->getName(), phaseStart, changed);
+    }
 
     if (verbose && (dynamic_cast<MetaTransformer*>(transformer) == nullptr)) {
         std::string changedString = changed ? "changed" : "unchanged";
@@ -21,12 +21,18 @@
 
 namespace souffle {
 
+class AstClause;
 class AstTranslationUnit;
 
 class AstTransformer {
 private:
     virtual bool transform(AstTranslationUnit& translationUnit) = 0;
 
+    /** whether the cached analysis of the given name remains valid once the program changed */
+    virtual bool preservesAnalysis(const std::string& analysis) const {
+        return false;
+    }
+
 public:
     virtual ~AstTransformer() = default;
 
@@ -35,10 +41,31 @@ public:
     virtual std::string getName() const = 0;
 };
 
+/**
+ * Transformer rewriting each clause on its own, without adding or removing relations, clauses or
+ * the literals referring to relations. The clauses are transformed in parallel, and the analyses
+ * of the relations and their dependencies remain valid.
+ */
+class AstClauseTransformer : public AstTransformer {
+private:
+    bool transform(AstTranslationUnit& translationUnit) final;
+
+    bool preservesAnalysis(const std::string& analysis) const override;
+
+    /** transform a clause; may be called concurrently for distinct clauses */
+    virtual bool transformClause(AstClause& clause) const = 0;
+};
+
 /**
  * Transformer that coordinates other sub-transformations
  */
 class MetaTransformer : public AstTransformer {
+private:
+    /* The sub-transformations invalidate the analyses themselves */
+    bool preservesAnalysis(const std::string& analysis) const override {
+        return true;
+    }
+
 protected:
     bool verbose = false;
 
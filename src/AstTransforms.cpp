@@ -19,6 +19,8 @@
 #include "AstAttribute.h"
 #include "AstClause.h"
 #include "AstGroundAnalysis.h"
+#include "AstIO.h"
+#include "AstIOTypeAnalysis.h"
 #include "AstLiteral.h"
 #include "AstNode.h"
 #include "AstProgram.h"
@@ -29,17 +31,24 @@
 #include "AstUtils.h"
 #include "AstVisitor.h"
 #include "BinaryConstraintOps.h"
+#include "DebugReport.h"
 #include "FunctorOps.h"
+#include "Global.h"
 #include "GraphUtils.h"
 #include "PrecedenceGraph.h"
 #include "RamTypes.h"
 #include "TypeSystem.h"
+#include "json11.h"
+#include <algorithm>
 #include <cstddef>
+#include <fstream>
 #include <functional>
 #include <map>
 #include <memory>
 #include <ostream>
 #include <set>
+#include <sstream>
+#include <utility>
 
 namespace souffle {
 
@@ -948,11 +957,9 @@ bool ReduceExistentialsTransformer::transform(AstTranslationUnit& translationUni
     return changed;
 }
 
-bool ReplaceSingletonVariablesTransformer::transform(AstTranslationUnit& translationUnit) {
+bool ReplaceSingletonVariablesTransformer::transformClause(AstClause& clause) const {
     bool changed = false;
 
-    AstProgram& program = *translationUnit.getProgram();
-
     // Node-mapper to replace a set of singletons with unnamed variables
     struct replaceSingletons : public AstNodeMapper {
         std::set<std::string>& singletons;
@@ -970,56 +977,51 @@ bool ReplaceSingletonVariablesTransformer::transform(AstTranslationUnit& transla
         }
     };
 
-    for (AstRelation* rel : program.getRelations()) {
-        for (AstClause* clause : rel->getClauses()) {
-            std::set<std::string> nonsingletons;
-            std::set<std::string> vars;
-
-            visitDepthFirst(*clause, [&](const AstVariable& var) {
-                const std::string& name = var.getName();
-                if (vars.find(name) != vars.end()) {
-                    // Variable seen before, so not a singleton variable
-                    nonsingletons.insert(name);
-                } else {
-                    vars.insert(name);
-                }
-            });
+    std::set<std::string> nonsingletons;
+    std::set<std::string> vars;
 
-            std::set<std::string> ignoredVars;
+    visitDepthFirst(clause, [&](const AstVariable& var) {
+        const std::string& name = var.getName();
+        if (vars.find(name) != vars.end()) {
+            // Variable seen before, so not a singleton variable
+            nonsingletons.insert(name);
+        } else {
+            vars.insert(name);
+        }
+    });
 
-            // Don't unname singleton variables occurring in records.
-            // TODO (azreika): remove this check once issue #420 is fixed
-            std::set<std::string> recordVars;
-            visitDepthFirst(*clause, [&](const AstRecordInit& rec) {
-                visitDepthFirst(rec, [&](const AstVariable& var) { ignoredVars.insert(var.getName()); });
-            });
+    std::set<std::string> ignoredVars;
 
-            // Don't unname singleton variables occuring in constraints.
-            std::set<std::string> constraintVars;
-            visitDepthFirst(*clause, [&](const AstConstraint& cons) {
-                visitDepthFirst(cons, [&](const AstVariable& var) { ignoredVars.insert(var.getName()); });
-            });
+    // Don't unname singleton variables occurring in records.
+    // TODO (azreika): remove this check once issue #420 is fixed
+    std::set<std::string> recordVars;
+    visitDepthFirst(clause, [&](const AstRecordInit& rec) {
+        visitDepthFirst(rec, [&](const AstVariable& var) { ignoredVars.insert(var.getName()); });
+    });
 
-            std::set<std::string> singletons;
-            for (auto& var : vars) {
-                if ((nonsingletons.find(var) == nonsingletons.end()) &&
-                        (ignoredVars.find(var) == ignoredVars.end())) {
-                    changed = true;
-                    singletons.insert(var);
-                }
-            }
+    // Don't unname singleton variables occuring in constraints.
+    std::set<std::string> constraintVars;
+    visitDepthFirst(clause, [&](const AstConstraint& cons) {
+        visitDepthFirst(cons, [&](const AstVariable& var) { ignoredVars.insert(var.getName()); });
+    });
 
-            // Replace the singletons found with underscores
-            replaceSingletons update(singletons);
-            clause->apply(update);
+    std::set<std::string> singletons;
+    for (auto& var : vars) {
+        if ((nonsingletons.find(var) == nonsingletons.end()) &&
+                (ignoredVars.find(var) == ignoredVars.end())) {
+            changed = true;
+            singletons.insert(var);
         }
     }
 
+    // Replace the singletons found with underscores
+    replaceSingletons update(singletons);
+    clause.apply(update);
+
     return changed;
 }
 
-bool NameUnnamedVariablesTransformer::transform(AstTranslationUnit& translationUnit) {
-    bool changed = false;
+bool NameUnnamedVariablesTransformer::transformClause(AstClause& clause) const {
     static constexpr const char* boundPrefix = "+underscore";
 
     struct nameVariables : public AstNodeMapper {
@@ -1039,19 +1041,12 @@ bool NameUnnamedVariablesTransformer::transform(AstTranslationUnit& translationU
         }
     };
 
-    AstProgram& program = *translationUnit.getProgram();
-    for (AstRelation* rel : program.getRelations()) {
-        for (AstClause* clause : rel->getClauses()) {
-            nameVariables update;
-            clause->apply(update);
-            changed |= update.changed;
-        }
-    }
-
-    return changed;
+    nameVariables update;
+    clause.apply(update);
+    return update.changed;
 }
 
-bool RemoveRedundantSumsTransformer::transform(AstTranslationUnit& translationUnit) {
+bool RemoveRedundantSumsTransformer::transformClause(AstClause& clause) const {
     struct ReplaceSumWithCount : public AstNodeMapper {
         ReplaceSumWithCount() = default;
 
@@ -1087,10 +1082,111 @@ bool RemoveRedundantSumsTransformer::transform(AstTranslationUnit& translationUn
     };
 
     ReplaceSumWithCount update;
-    translationUnit.getProgram()->apply(update);
+    clause.apply(update);
     return update.changed;
 }
 
+bool RecursiveAggregatesTransformer::transform(AstTranslationUnit& translationUnit) {
+    // subsumptive relations do not support provenance
+    if (Global::config().has("provenance")) {
+        return false;
+    }
+
+    AstProgram& program = *translationUnit.getProgram();
+    const auto& graph = translationUnit.getAnalysis<PrecedenceGraph>()->graph();
+    const auto* ioTypes = translationUnit.getAnalysis<IOType>();
+
+    bool changed = false;
+    for (AstRelation* rel : program.getRelations()) {
+        if (rel->getRepresentation() != RelationRepresentation::DEFAULT || rel->clauseSize() != 1 ||
+                rel->getArity() == 0 || ioTypes->isInput(rel)) {
+            continue;
+        }
+        const AstClause& clause = *rel->getClause(0);
+        const auto* result = dynamic_cast<const AstVariable*>(clause.getHead()->getArguments().back());
+        if (result == nullptr) {
+            continue;
+        }
+
+        // find the constraint binding the last head argument to a min or max aggregate
+        const AstBinaryConstraint* binding = nullptr;
+        const AstAggregator* agg = nullptr;
+        for (const AstLiteral* lit : clause.getBodyLiterals()) {
+            const auto* constraint = dynamic_cast<const AstBinaryConstraint*>(lit);
+            if (constraint == nullptr || constraint->getOperator() != BinaryConstraintOp::EQ) {
+                continue;
+            }
+            const AstArgument* lhs = constraint->getLHS();
+            const AstArgument* rhs = constraint->getRHS();
+            if (dynamic_cast<const AstAggregator*>(lhs) != nullptr) {
+                std::swap(lhs, rhs);
+            }
+            const auto* var = dynamic_cast<const AstVariable*>(lhs);
+            const auto* cur = dynamic_cast<const AstAggregator*>(rhs);
+            if (var != nullptr && cur != nullptr && var->getName() == result->getName()) {
+                binding = constraint;
+                agg = cur;
+                break;
+            }
+        }
+        if (agg == nullptr || agg->getTargetExpression() == nullptr) {
+            continue;
+        }
+        if (agg->getOperator() != AstAggregator::Op::min && agg->getOperator() != AstAggregator::Op::max) {
+            continue;
+        }
+
+        // the result may only occur in the head and the binding, and other aggregates could capture the
+        // local variables of the aggregate once they are moved into the clause
+        int occurrences = 0;
+        visitDepthFirst(clause, [&](const AstVariable& var) {
+            occurrences += (var.getName() == result->getName()) ? 1 : 0;
+        });
+        int aggregates = 0;
+        visitDepthFirst(clause, [&](const AstAggregator&) { aggregates++; });
+        visitDepthFirst(*agg, [&](const AstAggregator&) { aggregates--; });
+        if (occurrences != 2 || aggregates != 0) {
+            continue;
+        }
+
+        // only recursive aggregates are rewritten, others are evaluated after their bodies
+        bool recursive = false;
+        visitDepthFirst(*agg, [&](const AstAtom& atom) {
+            const AstRelation* source = getAtomRelation(&atom, &program);
+            recursive = recursive || source == rel || (source != nullptr && graph.reaches(rel, source));
+        });
+        if (!recursive) {
+            continue;
+        }
+
+        // replace the result by the target expression, and the binding by the body of the aggregate
+        auto head = std::make_unique<AstAtom>(clause.getHead()->getName());
+        head->setSrcLoc(clause.getHead()->getSrcLoc());
+        for (const AstArgument* arg : clause.getHead()->getArguments()) {
+            head->addArgument(std::unique_ptr<AstArgument>(
+                    (arg == result ? agg->getTargetExpression() : arg)->clone()));
+        }
+        auto replacement = std::make_unique<AstClause>();
+        replacement->setSrcLoc(clause.getSrcLoc());
+        replacement->setHead(std::move(head));
+        for (const AstLiteral* lit : clause.getBodyLiterals()) {
+            if (lit != binding) {
+                replacement->addToBody(std::unique_ptr<AstLiteral>(lit->clone()));
+            }
+        }
+        for (const AstLiteral* lit : agg->getBodyLiterals()) {
+            replacement->addToBody(std::unique_ptr<AstLiteral>(lit->clone()));
+        }
+
+        rel->setQualifier(rel->getQualifier() |
+                          (agg->getOperator() == AstAggregator::Op::min ? MIN_RELATION : MAX_RELATION));
+        program.removeClause(&clause);
+        program.appendClause(std::move(replacement));
+        changed = true;
+    }
+    return changed;
+}
+
 bool NormaliseConstraintsTransformer::transform(AstTranslationUnit& translationUnit) {
     bool changed = false;
 
@@ -1197,7 +1293,7 @@ bool NormaliseConstraintsTransformer::transform(AstTranslationUnit& translationU
     return changed;
 }
 
-bool RemoveTypecastsTransformer::transform(AstTranslationUnit& translationUnit) {
+bool RemoveTypecastsTransformer::transformClause(AstClause& clause) const {
     struct TypecastRemover : public AstNodeMapper {
         mutable bool changed{false};
 
@@ -1217,7 +1313,7 @@ bool RemoveTypecastsTransformer::transform(AstTranslationUnit& translationUnit)
     };
 
     TypecastRemover update;
-    translationUnit.getProgram()->apply(update);
+    clause.apply(update);
 
     return update.changed;
 }
@@ -1325,6 +1421,7 @@ bool AstUserDefinedFunctorsTransformer::transform(AstTranslationUnit& translatio
                 // Set types of functor instance based on its declaration.
                 userFunctor->setArgsTypes(functorDeclaration->getArgsTypes());
                 userFunctor->setReturnType(functorDeclaration->getReturnType());
+                userFunctor->setStateful(functorDeclaration->isStateful());
 
                 changed = true;
             }
@@ -1336,4 +1433,416 @@ bool AstUserDefinedFunctorsTransformer::transform(AstTranslationUnit& translatio
     return update.changed;
 }
 
+bool ShareJoinPrefixesTransformer::transform(AstTranslationUnit& translationUnit) {
+    AstProgram& program = *translationUnit.getProgram();
+    const auto* sccGraph = translationUnit.getAnalysis<SCCGraph>();
+
+    // Computes the join prefix of the given length of a clause, renaming its variables in order of
+    // occurrence; returns whether the clause has a join prefix of that length
+    auto getPrefix = [&](const AstClause& clause, size_t length, std::string& key,
+                             std::vector<std::string>& variables) {
+        const AstRelation* rel = program.getRelation(clause.getHead()->getName());
+        const std::vector<AstLiteral*> body = clause.getBodyLiterals();
+        std::map<std::string, size_t> renaming;
+        std::stringstream out;
+        for (size_t i = 0; i < length; i++) {
+            const auto* atom = (i < body.size()) ? dynamic_cast<const AstAtom*>(body[i]) : nullptr;
+            if (atom == nullptr) {
+                return false;
+            }
+            // atoms of the same stratum are computed by the rule itself
+            const AstRelation* atomRel = program.getRelation(atom->getName());
+            if (atomRel == nullptr || sccGraph->getSCC(atomRel) == sccGraph->getSCC(rel)) {
+                return false;
+            }
+            out << atom->getName() << "(";
+            for (const AstArgument* arg : atom->getArguments()) {
+                if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                    auto pos = renaming.find(var->getName());
+                    if (pos == renaming.end()) {
+                        pos = renaming.insert({var->getName(), variables.size()}).first;
+                        variables.push_back(var->getName());
+                    }
+                    out << "v" << pos->second;
+                } else if (dynamic_cast<const AstUnnamedVariable*>(arg) != nullptr ||
+                           dynamic_cast<const AstConstant*>(arg) != nullptr) {
+                    out << *arg;
+                } else {
+                    return false;
+                }
+                out << ",";
+            }
+            out << ")";
+        }
+        key = out.str();
+        return true;
+    };
+
+    // Collect the clauses of each join prefix of at least two atoms, longest prefixes first
+    std::map<std::pair<size_t, std::string>, std::vector<AstClause*>, std::greater<>> sharing;
+    for (AstRelation* rel : program.getRelations()) {
+        for (AstClause* clause : rel->getClauses()) {
+            // user-defined plans refer to the positions of the atoms
+            if (isFact(*clause) || clause->getExecutionPlan() != nullptr) {
+                continue;
+            }
+            std::string key;
+            std::vector<std::string> variables;
+            for (size_t length = 2; getPrefix(*clause, length, key, variables); length++) {
+                sharing[{length, key}].push_back(clause);
+                variables.clear();
+            }
+        }
+    }
+
+    // Materialise each prefix shared by clauses without a longer shared prefix
+    std::set<const AstClause*> rewritten;
+    std::vector<std::unique_ptr<AstClause>> clausesToAdd;
+    std::stringstream report;
+    int sharedCount = 0;
+    for (const auto& cur : sharing) {
+        const size_t length = cur.first.first;
+        std::vector<AstClause*> clauses;
+        for (AstClause* clause : cur.second) {
+            if (rewritten.find(clause) == rewritten.end()) {
+                clauses.push_back(clause);
+            }
+        }
+        if (clauses.size() < 2) {
+            continue;
+        }
+
+        // Find the variables of the prefix used by the remainder of any of the clauses
+        std::vector<std::vector<std::string>> clauseVariables(clauses.size());
+        std::set<size_t> usedVariables;
+        for (size_t i = 0; i < clauses.size(); i++) {
+            std::string key;
+            getPrefix(*clauses[i], length, key, clauseVariables[i]);
+            const std::vector<std::string>& variables = clauseVariables[i];
+            std::vector<const AstLiteral*> remainder = {clauses[i]->getHead()};
+            const std::vector<AstLiteral*> body = clauses[i]->getBodyLiterals();
+            remainder.insert(remainder.end(), body.begin() + length, body.end());
+            for (const AstLiteral* lit : remainder) {
+                visitDepthFirst(*lit, [&](const AstVariable& var) {
+                    auto pos = std::find(variables.begin(), variables.end(), var.getName());
+                    if (pos != variables.end()) {
+                        usedVariables.insert(pos - variables.begin());
+                    }
+                });
+            }
+        }
+
+        // Create the relation of the prefix, typed after the first occurrence of each variable
+        std::string name;
+        do {
+            name = "+shared" + toString(sharedCount++);
+        } while (program.getRelation(name) != nullptr);
+        auto relation = std::make_unique<AstRelation>();
+        relation->setName(name);
+        auto head = std::make_unique<AstAtom>(name);
+        const std::vector<AstLiteral*> prefix = clauses[0]->getBodyLiterals();
+        for (size_t var : usedVariables) {
+            const std::string& varName = clauseVariables[0][var];
+            const AstAttribute* attribute = nullptr;
+            for (size_t i = 0; i < length && attribute == nullptr; i++) {
+                const auto* atom = static_cast<const AstAtom*>(prefix[i]);
+                const auto args = atom->getArguments();
+                for (size_t j = 0; j < args.size() && attribute == nullptr; j++) {
+                    const auto* argVar = dynamic_cast<const AstVariable*>(args[j]);
+                    if (argVar != nullptr && argVar->getName() == varName) {
+                        attribute = program.getRelation(atom->getName())->getAttribute(j);
+                    }
+                }
+            }
+            relation->addAttribute(std::make_unique<AstAttribute>(varName, attribute->getTypeName()));
+            head->addArgument(std::make_unique<AstVariable>(varName));
+        }
+        program.appendRelation(std::move(relation));
+
+        auto sharedClause = std::make_unique<AstClause>();
+        sharedClause->setSrcLoc(clauses[0]->getSrcLoc());
+        sharedClause->setHead(std::unique_ptr<AstAtom>(head->clone()));
+        for (size_t i = 0; i < length; i++) {
+            sharedClause->addToBody(std::unique_ptr<AstLiteral>(prefix[i]->clone()));
+        }
+        report << *sharedClause << std::endl;
+        clausesToAdd.push_back(std::move(sharedClause));
+
+        // Replace the prefix of each clause by the new relation
+        for (size_t i = 0; i < clauses.size(); i++) {
+            auto newClause = std::make_unique<AstClause>();
+            newClause->setSrcLoc(clauses[i]->getSrcLoc());
+            newClause->setHead(std::unique_ptr<AstAtom>(clauses[i]->getHead()->clone()));
+            auto atom = std::make_unique<AstAtom>(name);
+            for (size_t var : usedVariables) {
+                atom->addArgument(std::make_unique<AstVariable>(clauseVariables[i][var]));
+            }
+            newClause->addToBody(std::move(atom));
+            const std::vector<AstLiteral*> body = clauses[i]->getBodyLiterals();
+            for (size_t j = length; j < body.size(); j++) {
+                newClause->addToBody(std::unique_ptr<AstLiteral>(body[j]->clone()));
+            }
+            report << "   " << *clauses[i]->getHead() << std::endl;
+            clausesToAdd.push_back(std::move(newClause));
+            rewritten.insert(clauses[i]);
+        }
+        report << "   join of " << length << " atoms evaluated once instead of " << clauses.size()
+               << " times" << std::endl
+               << std::endl;
+    }
+
+    if (rewritten.empty()) {
+        return false;
+    }
+    for (const AstClause* clause : rewritten) {
+        program.removeClause(clause);
+    }
+    for (auto& clause : clausesToAdd) {
+        program.appendClause(std::move(clause));
+    }
+    translationUnit.getDebugReport().addSection(getName(), "Shared Join Prefixes", report.str());
+    return true;
+}
+
+bool PruneInputsTransformer::transform(AstTranslationUnit& translationUnit) {
+    AstProgram& program = *translationUnit.getProgram();
+    const auto* ioType = translationUnit.getAnalysis<IOType>();
+    const TypeEnvironment& env = translationUnit.getAnalysis<TypeEnvironmentAnalysis>()->getTypeEnvironment();
+
+    // the atoms of each relation, and the relations counted by aggregates, whose unbound columns
+    // count distinct tuples and can thus not be dropped
+    std::map<AstRelationIdentifier, std::vector<const AstAtom*>> atoms;
+    visitDepthFirst(program, [&](const AstAtom& atom) { atoms[atom.getName()].push_back(&atom); });
+    std::set<AstRelationIdentifier> aggregated;
+    visitDepthFirst(program, [&](const AstAggregator& aggr) {
+        visitDepthFirst(aggr, [&](const AstAtom& atom) { aggregated.insert(atom.getName()); });
+    });
+
+    // Obtains the loads of a relation, if all of them read CSV without a filter of their own
+    auto getLoads = [&](const AstRelation& rel, std::vector<AstLoad*>& loads) {
+        for (const auto& load : program.getLoads()) {
+            if (load->getName() != rel.getName()) {
+                continue;
+            }
+            const std::map<std::string, std::string>& kvps = load->getIODirectiveMap();
+            auto has = [&](const std::string& key, const std::string& value) {
+                auto it = kvps.find(key);
+                return it != kvps.end() && it->second == value;
+            };
+            if ((kvps.count("IO") != 0 && !has("IO", "file") && !has("IO", "stdin")) ||
+                    kvps.count("filter") != 0 || kvps.count("intermediate") != 0 ||
+                    has("symbol-ids", "true")) {
+                return false;
+            }
+            loads.push_back(load.get());
+        }
+        return !loads.empty();
+    };
+
+    // Checks whether an argument is a constant the reader can compare with; the directive is
+    // escaped on its way into the generated code, hence only plain symbols are pushed
+    auto isFilterConstant = [](const AstArgument* arg) {
+        if (const auto* str = dynamic_cast<const AstStringConstant*>(arg)) {
+            const std::string& text = str->getConstant();
+            return std::none_of(text.begin(), text.end(), [](char c) {
+                return c == '\\' || c == '"' || static_cast<unsigned char>(c) < ' ';
+            });
+        }
+        return dynamic_cast<const AstNumberConstant*>(arg) != nullptr ||
+               dynamic_cast<const AstUnsignedConstant*>(arg) != nullptr ||
+               dynamic_cast<const AstFloatConstant*>(arg) != nullptr;
+    };
+
+    // the kept columns of each pruned relation
+    std::map<AstRelationIdentifier, std::vector<size_t>> keptColumns;
+    std::stringstream report;
+    for (AstRelation* rel : program.getRelations()) {
+        const auto& relAtoms = atoms[rel->getName()];
+        std::vector<AstLoad*> loads;
+        if (!ioType->isInput(rel) || ioType->isOutput(rel) || ioType->isPrintSize(rel) ||
+                !rel->getClauses().empty() || !rel->getChoiceDomain().empty() || relAtoms.empty() ||
+                (rel->getRepresentation() != RelationRepresentation::DEFAULT &&
+                        rel->getRepresentation() != RelationRepresentation::BTREE &&
+                        rel->getRepresentation() != RelationRepresentation::BRIE &&
+                        rel->getRepresentation() != RelationRepresentation::HASHSET) ||
+                !getLoads(*rel, loads)) {
+            continue;
+        }
+
+        // the input column of each attribute, by the columns directive of the loads
+        std::vector<std::vector<std::string>> inputColumns;
+        bool mapped = true;
+        for (const AstLoad* load : loads) {
+            std::vector<std::string> columns;
+            const auto& kvps = load->getIODirectiveMap();
+            if (kvps.count("columns") != 0) {
+                columns = splitString(kvps.at("columns"), ':');
+            } else {
+                for (size_t i = 0; i < rel->getArity(); i++) {
+                    columns.push_back(std::to_string(i));
+                }
+            }
+            mapped = mapped && columns.size() == rel->getArity();
+            inputColumns.push_back(std::move(columns));
+        }
+        if (!mapped) {
+            continue;
+        }
+
+        // classify the columns into filtered, unbound and kept ones
+        std::vector<size_t> kept;
+        std::map<size_t, std::string> filter;
+        for (size_t i = 0; i < rel->getArity(); i++) {
+            const AstArgument* first = relAtoms.front()->getArguments()[i];
+            auto isFirst = [&](const AstAtom* atom) { return *atom->getArguments()[i] == *first; };
+            if (isFilterConstant(first) && std::all_of(relAtoms.begin(), relAtoms.end(), isFirst)) {
+                const auto* constant = static_cast<const AstConstant*>(first);
+                const std::string kind = getTypeQualifier(env.getType(rel->getAttribute(i)->getTypeName()));
+                if (kind[0] == 's') {
+                    filter[i] = "s" + static_cast<const AstStringConstant*>(first)->getConstant();
+                } else {
+                    filter[i] = kind.substr(0, 1) + std::to_string(constant->getRamRepresentation());
+                }
+            } else if (aggregated.count(rel->getName()) != 0 ||
+                       !std::all_of(relAtoms.begin(), relAtoms.end(), [&](const AstAtom* atom) {
+                           return dynamic_cast<const AstUnnamedVariable*>(atom->getArguments()[i]) != nullptr;
+                       })) {
+                kept.push_back(i);
+            }
+        }
+        // a relation keeps at least one column, which may also be filtered
+        if (kept.empty()) {
+            kept.push_back(0);
+        }
+        if (kept.size() == rel->getArity() && filter.empty()) {
+            continue;
+        }
+
+        // read the kept columns of the lines matching the filter
+        for (size_t j = 0; j < loads.size(); j++) {
+            const std::vector<std::string>& columns = inputColumns[j];
+            std::stringstream keptColumnNames;
+            keptColumnNames << join(kept, ":", [&](std::ostream& out, size_t i) { out << columns[i]; });
+            json11::Json::object filterJson;
+            for (const auto& cur : filter) {
+                filterJson[columns[cur.first]] = cur.second;
+            }
+            loads[j]->addKVP("columns", keptColumnNames.str());
+            if (!filterJson.empty()) {
+                loads[j]->addKVP("filter", json11::Json(filterJson).dump());
+            }
+        }
+
+        report << rel->getName() << ": kept columns " << join(kept, ",");
+        if (!filter.empty()) {
+            report << ", filter " << loads.front()->getIODirectiveMap().at("filter");
+        }
+        report << std::endl;
+
+        for (size_t i = rel->getArity(); i-- > 0;) {
+            if (std::find(kept.begin(), kept.end(), i) == kept.end()) {
+                rel->removeAttribute(i);
+            }
+        }
+        keptColumns[rel->getName()] = std::move(kept);
+    }
+
+    if (keptColumns.empty()) {
+        return false;
+    }
+
+    // Mapper that projects the atoms of pruned relations onto their kept columns
+    struct projectAtoms : public AstNodeMapper {
+        const std::map<AstRelationIdentifier, std::vector<size_t>>& keptColumns;
+
+        projectAtoms(const std::map<AstRelationIdentifier, std::vector<size_t>>& keptColumns)
+                : keptColumns(keptColumns) {}
+
+        std::unique_ptr<AstNode> operator()(std::unique_ptr<AstNode> node) const override {
+            node->apply(*this);
+            if (auto* atom = dynamic_cast<AstAtom*>(node.get())) {
+                auto it = keptColumns.find(atom->getName());
+                if (it != keptColumns.end()) {
+                    const std::vector<AstArgument*> args = atom->getArguments();
+                    std::vector<std::unique_ptr<AstArgument>> keptArgs;
+                    for (size_t i : it->second) {
+                        keptArgs.push_back(std::unique_ptr<AstArgument>(args[i]->clone()));
+                    }
+                    return std::make_unique<AstAtom>(atom->getName(), std::move(keptArgs), atom->getSrcLoc());
+                }
+            }
+            return node;
+        }
+    };
+    projectAtoms update(keptColumns);
+    program.apply(update);
+
+    translationUnit.getDebugReport().addSection(getName(), "Pruned Inputs", report.str());
+    return true;
+}
+
+bool RelationConfigTransformer::transform(AstTranslationUnit& translationUnit) {
+    AstProgram& program = *translationUnit.getProgram();
+    ErrorReport& report = translationUnit.getErrorReport();
+    const std::string& fileName = Global::config().get("relation-config");
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        report.addError("Cannot open relation configuration " + fileName, SrcLocation());
+        return false;
+    }
+
+    static const std::map<std::string, RelationRepresentation> representations = {
+            {"btree", RelationRepresentation::BTREE}, {"brie", RelationRepresentation::BRIE},
+            {"hashset", RelationRepresentation::HASHSET}, {"dense", RelationRepresentation::DENSE},
+            {"external", RelationRepresentation::EXTERNAL}};
+    std::map<std::string, AstRelation*> relations;
+    for (AstRelation* rel : program.getRelations()) {
+        relations[toString(rel->getName())] = rel;
+    }
+
+    bool changed = false;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        std::stringstream fields(line);
+        std::string name;
+        if (!(fields >> name) || name[0] == '#') {
+            continue;
+        }
+        const std::string location = fileName + ":" + std::to_string(lineNumber);
+
+        // the representation, and the block size of a b-tree
+        std::string representation;
+        std::string blockSize;
+        std::string rest;
+        fields >> representation >> blockSize >> rest;
+        auto chosen = representations.find(representation);
+        if (chosen == representations.end() || !rest.empty() ||
+                (!blockSize.empty() && (representation != "btree" || !isNumber(blockSize.c_str())))) {
+            report.addError("Invalid relation configuration in " + location + ", expected a relation, " +
+                                    "one of btree, brie, hashset, dense and external, and a block size",
+                    SrcLocation());
+            continue;
+        }
+
+        auto rel = relations.find(name);
+        if (rel == relations.end()) {
+            report.addWarning("Relation " + name + " configured in " + location + " does not exist",
+                    SrcLocation());
+            continue;
+        }
+        const RelationRepresentation current = rel->second->getRepresentation();
+        if (current == RelationRepresentation::EQREL || current == RelationRepresentation::MIN_LATTICE ||
+                current == RelationRepresentation::MAX_LATTICE || current == RelationRepresentation::INFO) {
+            report.addError("Representation of relation " + name + " configured in " + location +
+                                    " cannot be changed from " + toString(current),
+                    rel->second->getSrcLoc());
+            continue;
+        }
+        rel->second->setRepresentation(chosen->second);
+        rel->second->setBlockSize(blockSize.empty() ? 0 : std::stoul(blockSize));
+        changed = true;
+    }
+    return changed;
+}
+
 }  // end of namespace souffle
@@ -235,7 +235,9 @@ private:
 };
 
 /**
- * Transformation pass to inline marked relations
+ * Transformation pass to inline marked relations, unless inlining a relation is estimated to generate
+ * clauses whose total number of body literals, generated from a single clause, exceeds a limit, in
+ * which case the relation is materialised
  */
 class InlineRelationsTransformer : public AstTransformer {
 public:
@@ -243,6 +245,9 @@ public:
         return "InlineRelationsTransformer";
     }
 
+    /** The limit of the body literals generated from a single clause, unless given by --inline-limit */
+    static constexpr double DEFAULT_INLINE_LIMIT = 4096;
+
 private:
     bool transform(AstTranslationUnit& translationUnit) override;
 };
@@ -284,14 +289,14 @@ private:
  * with unnamed variables.
  * E.g.: a() :- b(x). -> a() :- b(_).
  */
-class ReplaceSingletonVariablesTransformer : public AstTransformer {
+class ReplaceSingletonVariablesTransformer : public AstClauseTransformer {
 public:
     std::string getName() const override {
         return "ReplaceSingletonVariablesTransformer";
     }
 
 private:
-    bool transform(AstTranslationUnit& translationUnit) override;
+    bool transformClause(AstClause& clause) const override;
 };
 
 /**
@@ -299,14 +304,14 @@ private:
  * with singletons.
  * E.g.: a() :- b(_). -> a() :- b(x).
  */
-class NameUnnamedVariablesTransformer : public AstTransformer {
+class NameUnnamedVariablesTransformer : public AstClauseTransformer {
 public:
     std::string getName() const override {
         return "NameUnnamedVariablesTransformer";
     }
 
 private:
-    bool transform(AstTranslationUnit& translationUnit) override;
+    bool transformClause(AstClause& clause) const override;
 };
 
 /**
@@ -322,6 +327,61 @@ private:
     bool transform(AstTranslationUnit& translationUnit) override;
 };
 
+/**
+ * Transformation pass to evaluate join prefixes shared by several rules once.
+ * The leading atoms of a rule, computed in earlier strata, form its join prefix. A prefix repeated
+ * (up to renaming) by several rules is materialised into a new relation holding the variables the
+ * rules use, and replaced by an atom of it in each rule.
+ * E.g. a(x) :- b(x,y), c(y,z), d(z). and e(z) :- b(x,y), c(y,z), f(x). are transformed into:
+ *      - a(x) :- +shared0(x,z), d(z).
+ *      - e(z) :- +shared0(x,z), f(x).
+ *      - +shared0(x,z) :- b(x,y), c(y,z).
+ */
+class ShareJoinPrefixesTransformer : public AstTransformer {
+public:
+    std::string getName() const override {
+        return "ShareJoinPrefixesTransformer";
+    }
+
+private:
+    bool transform(AstTranslationUnit& translationUnit) override;
+};
+
+/**
+ * Transformation pass to push the constants and projections of input relations into their loads.
+ * A column of an input relation read from CSV that holds the same constant in every atom of the
+ * relation is filtered by the reader, and dropped from the relation along with the columns no atom
+ * binds; the reader skips the lines of other constants and does not parse dropped columns.
+ * E.g. a(x) :- e(x,_,"call"). with an input e(x,y,k) is transformed into a(x) :- e(x). reading
+ * only the first column of the lines of e whose third column is "call".
+ */
+class PruneInputsTransformer : public AstTransformer {
+public:
+    std::string getName() const override {
+        return "PruneInputsTransformer";
+    }
+
+private:
+    bool transform(AstTranslationUnit& translationUnit) override;
+};
+
+/**
+ * Transformation pass to apply the representations of relations chosen by the configuration file of
+ * --relation-config, as written by souffle-tune. Each line of the file names a relation followed by
+ * its representation, one of btree, brie, hashset, dense and external, and for a b-tree optionally by
+ * the block size of its nodes in bytes; lines starting with # are comments. Only the representation of
+ * a plain set can be chosen, as equivalence and subsumptive relations hold other tuples.
+ */
+class RelationConfigTransformer : public AstTransformer {
+public:
+    std::string getName() const override {
+        return "RelationConfigTransformer";
+    }
+
+private:
+    bool transform(AstTranslationUnit& translationUnit) override;
+};
+
 /**
  * Transformation pass to normalise constraints.
  * E.g.: a(x) :- b(x, 1). -> a(x) :- b(x, tmp0), tmp0=1.
@@ -342,12 +402,32 @@ private:
  * k * count : { ... }
  * where k is a constant.
  */
-class RemoveRedundantSumsTransformer : public AstTransformer {
+class RemoveRedundantSumsTransformer : public AstClauseTransformer {
 public:
     std::string getName() const override {
         return "RemoveRedundantSumsTransformer";
     }
 
+private:
+    bool transformClause(AstClause& clause) const override;
+};
+
+/**
+ * Transformation pass to maintain recursive min and max aggregates incrementally. A relation defined
+ * by a single clause of the form
+ *     r(k..., v) :- ..., v = min e : { body }.
+ * whose aggregate depends on r itself cannot be stratified. If v occurs nowhere else, the clause is
+ * replaced by
+ *     r(k..., e) :- ..., body.
+ * and r becomes a subsumptive min relation, which keeps the least e of each key. The semi-naive
+ * evaluation of r then only propagates the keys whose values improved in the last iteration.
+ */
+class RecursiveAggregatesTransformer : public AstTransformer {
+public:
+    std::string getName() const override {
+        return "RecursiveAggregatesTransformer";
+    }
+
 private:
     bool transform(AstTranslationUnit& translationUnit) override;
 };
@@ -368,9 +448,9 @@ private:
 /**
  * Transformation to remove typecasts.
  */
-class RemoveTypecastsTransformer : public AstTransformer {
+class RemoveTypecastsTransformer : public AstClauseTransformer {
 private:
-    bool transform(AstTranslationUnit& translationUnit) override;
+    bool transformClause(AstClause& clause) const override;
 
 public:
     std::string getName() const override {
@@ -24,6 +24,7 @@
 #include "ErrorReport.h"
 #include "SymbolTable.h"
 
+#include <functional>
 #include <map>
 #include <memory>
 
@@ -89,6 +90,13 @@ public:
         analyses.clear();
     }
 
+    /** destroy the cached analyses of translation unit except for those preserved */
+    void invalidateAnalyses(const std::function<bool(const std::string&)>& preserved) {
+        for (auto it = analyses.begin(); it != analyses.end();) {
+            it = preserved(it->first) ? std::next(it) : analyses.erase(it);
+        }
+    }
+
     /** get debug report */
     DebugReport& getDebugReport() {
         return debugReport;
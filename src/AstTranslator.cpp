@@ -22,6 +22,7 @@
 #include "AstIO.h"
 #include "AstLiteral.h"
 #include "AstNode.h"
+#include "AstProfileUse.h"
 #include "AstProgram.h"
 #include "AstRelation.h"
 #include "AstTranslationUnit.h"
@@ -97,13 +98,14 @@ void AstTranslator::makeIODirective(IODirectives& ioDirective, const AstRelation
     }
 
     // load intermediate relations from correct files
-    if (ioDirective.getIOType() == "file") {
+    if (ioDirective.getIOType() == "file" || ioDirective.getIOType() == "binary") {
         // set filename by relation if not given
         if (!ioDirective.has("filename")) {
-            ioDirective.setFileName(ioDirective.getRelationName() + fileExt);
+            const bool isBinary = ioDirective.getIOType() == "binary";
+            ioDirective.setFileName(ioDirective.getRelationName() + (isBinary ? ".bin" : fileExt));
         }
         // if filename is not an absolute path, concat with cmd line facts directory
-        if (ioDirective.getIOType() == "file" && ioDirective.getFileName().front() != '/') {
+        if (ioDirective.getFileName().front() != '/') {
             ioDirective.setFileName(filePath + "/" + ioDirective.getFileName());
         }
     }
@@ -158,6 +160,10 @@ std::vector<IODirectives> AstTranslator::getInputIODirectives(
 
     for (auto& ioDirective : inputDirectives) {
         makeIODirective(ioDirective, rel, inputFilePath, inputFileExt);
+        // inputs are sampled at the rate of --input-sample, unless they set their own
+        if (Global::config().has("input-sample") && !ioDirective.has("sample")) {
+            ioDirective.set("sample", Global::config().get("input-sample"));
+        }
     }
 
     return inputDirectives;
@@ -208,6 +214,19 @@ std::vector<IODirectives> AstTranslator::getOutputIODirectives(
     for (auto& ioDirective : outputDirectives) {
         makeIODirective(ioDirective, rel, outputFilePath, outputFileExt);
 
+        // the attributes an output is sorted by are resolved to their columns
+        if (ioDirective.has("order")) {
+            std::vector<std::string> columns;
+            for (const std::string& name : splitString(ioDirective.get("order"), ',')) {
+                for (unsigned int i = 0; i < rel->getArity(); i++) {
+                    if (rel->getAttribute(i)->getAttributeName() == name) {
+                        columns.push_back(std::to_string(i));
+                    }
+                }
+            }
+            ioDirective.set("orderColumns", toString(join(columns, ":")));
+        }
+
         if (!ioDirective.has("attributeNames")) {
             std::string delimiter("\t");
             if (ioDirective.has("delimiter")) {
@@ -231,6 +250,57 @@ std::vector<IODirectives> AstTranslator::getOutputIODirectives(
     return outputDirectives;
 }
 
+namespace {
+
+/** Whether an output directive asks for the tuples of each iteration (stream=true) as text */
+bool isStreamedIODirective(const IODirectives& ioDirective) {
+    return ioDirective.has("stream") && ioDirective.get("stream") == "true" &&
+           (ioDirective.getIOType() == "file" || ioDirective.getIOType() == "stdout");
+}
+
+/**
+ * Whether independent strata, and the relations of a recursive stratum, are evaluated concurrently; the
+ * profiler logs strata one at a time, and checkpoints record the number of completed strata of the
+ * topological order
+ */
+bool evaluateConcurrently() {
+    return Global::config().has("stratum-jobs") && Global::config().get("jobs") != "1" &&
+           !Global::config().has("profile") && !Global::config().has("checkpoint");
+}
+
+/**
+ * Whether a relation is stored in a dense data structure unless another one is requested, i.e., whether
+ * it is a unary or binary relation of the indexes of symbols and records, which are dense
+ */
+bool hasDenseDomain(const std::vector<std::string>& attributeTypes, size_t auxiliaryArity) {
+    if (auxiliaryArity > 0 || attributeTypes.empty() || attributeTypes.size() > 2) {
+        return false;
+    }
+    return std::all_of(attributeTypes.begin(), attributeTypes.end(),
+            [](const std::string& type) { return type[0] == 's' || type[0] == 'r'; });
+}
+
+}  // namespace
+
+std::vector<IODirectives> AstTranslator::getStreamedIODirectives(const AstRelation* rel) {
+    // the new tuples of equivalence and subsumptive relations are not final when merged, and the
+    // incremental and provenance evaluations revise the relations after the fixpoint
+    const RelationRepresentation representation = rel->getRepresentation();
+    if (Global::config().has("incremental") || Global::config().has("provenance") ||
+            representation == RelationRepresentation::EQREL ||
+            representation == RelationRepresentation::MIN_LATTICE ||
+            representation == RelationRepresentation::MAX_LATTICE) {
+        return {};
+    }
+    std::vector<IODirectives> streamed;
+    for (const auto& ioDirective : getOutputIODirectives(rel, Global::config().get("output-dir"), ".csv")) {
+        if (isStreamedIODirective(ioDirective)) {
+            streamed.push_back(ioDirective);
+        }
+    }
+    return streamed;
+}
+
 std::unique_ptr<RamRelationReference> AstTranslator::createRelationReference(const std::string name) {
     auto it = ramRels.find(name);
     assert(it != ramRels.end() && "relation name not found");
@@ -256,6 +326,18 @@ std::unique_ptr<RamRelationReference> AstTranslator::translateNewRelation(const
     return translateRelation(rel, "@new_");
 }
 
+std::unique_ptr<RamRelationReference> AstTranslator::translateAddedRelation(const AstRelation* rel) {
+    return translateRelation(rel, "@add_");
+}
+
+std::unique_ptr<RamRelationReference> AstTranslator::translateRemovedRelation(const AstRelation* rel) {
+    return translateRelation(rel, "@del_");
+}
+
+std::unique_ptr<RamRelationReference> AstTranslator::translatePreviousRelation(const AstRelation* rel) {
+    return translateRelation(rel, "@old_");
+}
+
 std::unique_ptr<RamExpression> AstTranslator::translateValue(
         const AstArgument* arg, const ValueIndex& index) {
     if (arg == nullptr) {
@@ -316,8 +398,8 @@ std::unique_ptr<RamExpression> AstTranslator::translateValue(
                 values.push_back(translator.translateValue(cur, index));
             }
 
-            return std::make_unique<RamUserDefinedOperator>(
-                    udf.getName(), udf.getArgsTypes(), udf.getReturnType(), std::move(values));
+            return std::make_unique<RamUserDefinedOperator>(udf.getName(), udf.getArgsTypes(),
+                    udf.getReturnType(), udf.isStateful(), std::move(values));
         }
 
         std::unique_ptr<RamExpression> visitCounter(const AstCounter&) override {
@@ -401,7 +483,7 @@ std::unique_ptr<RamCondition> AstTranslator::translateConstraint(
                 values.push_back(translator.translateValue(args[i], index));
             }
             // we don't care about the provenance columns when doing the existence check
-            if (Global::config().has("provenance")) {
+            if (auxiliaryArity > 0) {
                 // undefined value for rule number
                 values.push_back(std::make_unique<RamUndefValue>());
                 // add the height annotation for provenanceNotExists
@@ -556,7 +638,7 @@ std::unique_ptr<RamOperation> AstTranslator::ClauseTranslator::createOperation(c
 
     // check existence for original tuple if we have provenance
     // only if we don't compile
-    if (Global::config().has("provenance") &&
+    if (Global::config().has("provenance") && translator.getEvaluationArity(head) > 0 &&
             ((!Global::config().has("compile") && !Global::config().has("dl-program") &&
                     !Global::config().has("generate")))) {
         size_t auxiliaryArity = translator.getEvaluationArity(head);
@@ -1023,9 +1105,27 @@ void AstTranslator::nameUnnamedVariables(AstClause* clause) {
     }
 }
 
+std::unique_ptr<AstAtom> AstTranslator::translateChoiceKey(const AstRelation& rel, const AstAtom& head) {
+    const auto& domain = rel.getChoiceDomain();
+    if (domain.empty()) {
+        return std::unique_ptr<AstAtom>(head.clone());
+    }
+    auto res = std::make_unique<AstAtom>(head.getName());
+    res->setSrcLoc(head.getSrcLoc());
+    for (size_t i = 0; i < head.getArity(); i++) {
+        const std::string& name = rel.getAttribute(i)->getAttributeName();
+        if (std::find(domain.begin(), domain.end(), name) != domain.end()) {
+            res->addArgument(std::unique_ptr<AstArgument>(head.getArguments()[i]->clone()));
+        } else {
+            res->addArgument(std::make_unique<AstUnnamedVariable>());
+        }
+    }
+    return res;
+}
+
 /** generate RAM code for recursive relations in a strongly-connected component */
 std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
-        const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses) {
+        const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses, bool incremental) {
     // initialize sections
     std::unique_ptr<RamStatement> preamble;
     std::unique_ptr<RamSequence> updateTable(new RamSequence());
@@ -1048,7 +1148,12 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
                 std::make_unique<RamScan>(std::unique_ptr<RamRelationReference>(src->clone()), 0,
                         std::make_unique<RamProject>(
                                 std::unique_ptr<RamRelationReference>(dest->clone()), std::move(values))));
-        if (dest->get()->getRepresentation() == RelationRepresentation::EQREL) {
+        // equivalence relations complete the new knowledge by the implied tuples before merging, while
+        // subsumptive relations discard the new tuples which do not improve on the merged relation
+        const RelationRepresentation representation = dest->get()->getRepresentation();
+        if (representation == RelationRepresentation::EQREL ||
+                representation == RelationRepresentation::MIN_LATTICE ||
+                representation == RelationRepresentation::MAX_LATTICE) {
             stmt = std::make_unique<RamSequence>(
                     std::make_unique<RamExtend>(std::unique_ptr<RamRelationReference>(dest->clone()),
                             std::unique_ptr<RamRelationReference>(src->clone())),
@@ -1064,10 +1169,27 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
     for (const AstRelation* rel : scc) {
         std::unique_ptr<RamStatement> updateRelTable;
 
+        /* output streamed by the fixpoint: the relation before it, and the new tuples of each iteration */
+        const std::vector<IODirectives> streamed =
+                incremental ? std::vector<IODirectives>() : getStreamedIODirectives(rel);
+        std::vector<IODirectives> appended = streamed;
+        for (auto& ioDirectives : appended) {
+            ioDirectives.set("append", "true");
+            ioDirectives.set("headers", "false");
+        }
+
         /* create update statements for fixpoint (even iteration) */
+        appendStmt(updateRelTable, genMerge(translateRelation(rel).get(), translateNewRelation(rel).get()));
+        if (!appended.empty()) {
+            appendStmt(updateRelTable, std::make_unique<RamStore>(translateNewRelation(rel), appended));
+        }
+        if (incremental) {
+            /* record the new tuples as insertions of the incremental update */
+            appendStmt(updateRelTable,
+                    genMerge(translateAddedRelation(rel).get(), translateNewRelation(rel).get()));
+        }
         appendStmt(updateRelTable,
                 std::make_unique<RamSequence>(
-                        genMerge(translateRelation(rel).get(), translateNewRelation(rel).get()),
                         std::make_unique<RamSwap>(translateDeltaRelation(rel), translateNewRelation(rel)),
                         std::make_unique<RamClear>(translateNewRelation(rel))));
 
@@ -1083,19 +1205,40 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
                 std::make_unique<RamSequence>(std::make_unique<RamClear>(translateDeltaRelation(rel)),
                         std::make_unique<RamClear>(translateNewRelation(rel))));
 
-        /* Generate code for non-recursive part of relation */
-        appendStmt(preamble, translateNonRecursiveRelation(*rel, recursiveClauses));
+        if (incremental) {
+            /* Generate code for the new tuples derived from insertions into lower components */
+            appendStmt(preamble, translateIncrementalInsertion(*rel, scc, "@new_"));
+        } else {
+            /* Generate code for non-recursive part of relation */
+            appendStmt(preamble, translateNonRecursiveRelation(*rel, recursiveClauses));
+
+            /* Generate merge operation for temp tables */
+            appendStmt(preamble, genMerge(translateDeltaRelation(rel).get(), translateRelation(rel).get()));
 
-        /* Generate merge operation for temp tables */
-        appendStmt(preamble, genMerge(translateDeltaRelation(rel).get(), translateRelation(rel).get()));
+            if (!streamed.empty()) {
+                appendStmt(preamble, std::make_unique<RamStore>(translateRelation(rel), streamed));
+            }
+        }
 
         /* Add update operations of relations to parallel statements */
         updateTable->add(std::move(updateRelTable));
     }
 
+    /* the new tuples of the incremental version become the first delta */
+    if (incremental) {
+        appendStmt(preamble, std::unique_ptr<RamStatement>(updateTable->clone()));
+    }
+
     // --- build main loop ---
 
-    std::unique_ptr<RamParallel> loopSeq(new RamParallel());
+    // each relation only writes its own new relation, hence the relations of the SCC are independent;
+    // they share the threads of the stratum if evaluated concurrently
+    std::unique_ptr<RamListStatement> loopSeq;
+    if (evaluateConcurrently() && scc.size() > 1) {
+        loopSeq = std::make_unique<RamSchedule>(0);
+    } else {
+        loopSeq = std::make_unique<RamParallel>();
+    }
 
     // create a utility to check SCC membership
     auto isInSameSCC = [&](const AstRelation* rel) {
@@ -1132,13 +1275,13 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
                 r1->getHead()->setName(translateNewRelation(rel)->get()->getName());
                 getBodyLiterals<AstAtom>(*r1)[j]->setName(
                         translateDeltaRelation(atomRelation)->get()->getName());
-                if (Global::config().has("provenance")) {
+                if (Global::config().has("provenance") && auxArityAnalysis->getArity(rel) > 0) {
                     r1->addToBody(std::make_unique<AstProvenanceNegation>(
                             std::unique_ptr<AstAtom>(cl->getHead()->clone())));
                 } else {
                     if (r1->getHead()->getArity() > 0) {
-                        r1->addToBody(std::make_unique<AstNegation>(
-                                std::unique_ptr<AstAtom>(cl->getHead()->clone())));
+                        r1->addToBody(
+                                std::make_unique<AstNegation>(translateChoiceKey(*rel, *cl->getHead())));
                     }
                 }
 
@@ -1146,8 +1289,10 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
                 // atoms)
                 nameUnnamedVariables(r1.get());
 
-                // reduce R to P ...
-                for (size_t k = j + 1; k < atoms.size(); k++) {
+                // exclude the delta from the atoms of the SCC before the delta atom, so that each
+                // combination of new tuples is derived by the version of its first new tuple only; as
+                // these atoms are joined before the delta atom, the exclusion filters the outer loops
+                for (size_t k = 0; k < j; k++) {
                     if (isInSameSCC(getAtomRelation(atoms[k], program))) {
                         AstAtom* cur = getBodyLiterals<AstAtom>(*r1)[k]->clone();
                         cur->setName(
@@ -1159,6 +1304,35 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
                 std::unique_ptr<RamStatement> rule =
                         ClauseTranslator(*this).translateClause(*r1, *cl, version);
 
+                /* add alternative orders led by the delta atom and the first other atoms, choosing the
+                   cheapest one at each iteration */
+                if (Global::config().has("adaptive-joins") && cl->getExecutionPlan() == nullptr &&
+                        atoms.size() > 1) {
+                    const size_t maxAdaptiveAlternatives = 4;
+                    auto adaptive = std::make_unique<RamAdaptiveQuery>();
+                    adaptive->add(std::move(rule));
+                    std::vector<unsigned int> leaders = {static_cast<unsigned int>(j)};
+                    for (unsigned int k = 1; k < atoms.size(); ++k) {
+                        if (k != j) {
+                            leaders.push_back(k);
+                        }
+                    }
+                    for (unsigned int leader : leaders) {
+                        if (leader == 0 || adaptive->getStatements().size() == maxAdaptiveAlternatives) {
+                            continue;
+                        }
+                        std::vector<unsigned int> order = {leader};
+                        for (unsigned int k = 0; k < atoms.size(); ++k) {
+                            if (k != leader) {
+                                order.push_back(k);
+                            }
+                        }
+                        std::unique_ptr<AstClause> reordered(reorderAtoms(r1.get(), order));
+                        adaptive->add(ClauseTranslator(*this).translateClause(*reordered, *cl, version));
+                    }
+                    rule = std::move(adaptive);
+                }
+
                 /* add logging */
                 if (Global::config().has("profile")) {
                     const std::string& relationName = toString(rel->getName());
@@ -1206,12 +1380,21 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
             const SrcLocation& srcLocation = rel->getSrcLoc();
             const std::string logTimerStatement = LogStatement::tRecursiveRelation(relationName, srcLocation);
             const std::string logSizeStatement = LogStatement::nRecursiveRelation(relationName, srcLocation);
+            const std::string logDeltaStatement = LogStatement::dRecursiveRelation(relationName, srcLocation);
             loopRelSeq = std::make_unique<RamLogRelationTimer>(
                     std::move(loopRelSeq), logTimerStatement, translateNewRelation(rel));
+            // record the delta the iteration starts from, outlining the convergence of the fixpoint
+            loopRelSeq = std::make_unique<RamSequence>(
+                    std::make_unique<RamLogSize>(translateDeltaRelation(rel), logDeltaStatement),
+                    std::move(loopRelSeq));
         }
 
         /* add rule computations of a relation to parallel statement */
-        loopSeq->add(std::move(loopRelSeq));
+        if (auto* schedule = dynamic_cast<RamSchedule*>(loopSeq.get())) {
+            schedule->add(std::move(loopRelSeq), {});
+        } else {
+            loopSeq->add(std::move(loopRelSeq));
+        }
     }
 
     /* construct exit conditions for odd and even iteration */
@@ -1245,6 +1428,214 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
     return nullptr;
 }
 
+/** generate RAM code for the tuples derived from insertions into the relations of lower components */
+std::unique_ptr<RamStatement> AstTranslator::translateIncrementalInsertion(
+        const AstRelation& rel, const std::set<const AstRelation*>& scc, const std::string& targetPrefix) {
+    std::unique_ptr<RamStatement> res;
+    for (AstClause* clause : rel.getClauses()) {
+        // each atom of a lower component results in a version reading the insertions into its relation
+        const auto& atoms = getBodyLiterals<AstAtom>(*clause);
+        for (size_t j = 0; j < atoms.size(); ++j) {
+            const AstRelation* atomRelation = getAtomRelation(atoms[j], program);
+            if (scc.find(atomRelation) != scc.end()) {
+                continue;
+            }
+
+            // write the tuples not derived before into the target relation
+            std::unique_ptr<AstClause> r1(clause->clone());
+            r1->getHead()->setName(translateRelation(&rel, targetPrefix)->get()->getName());
+            getBodyLiterals<AstAtom>(*r1)[j]->setName(translateAddedRelation(atomRelation)->get()->getName());
+            if (r1->getHead()->getArity() > 0) {
+                r1->addToBody(
+                        std::make_unique<AstNegation>(std::unique_ptr<AstAtom>(clause->getHead()->clone())));
+            }
+            nameUnnamedVariables(r1.get());
+
+            std::unique_ptr<RamStatement> rule = ClauseTranslator(*this).translateClause(*r1, *clause);
+
+            // add debug info
+            std::ostringstream ds;
+            ds << toString(*clause) << "\nin file ";
+            ds << clause->getSrcLoc();
+            rule = std::make_unique<RamDebugInfo>(std::move(rule), ds.str());
+
+            appendStmt(res, std::move(rule));
+        }
+    }
+    return res;
+}
+
+/** generate RAM code updating the relations of a strongly-connected component incrementally */
+std::unique_ptr<RamStatement> AstTranslator::translateIncrementalUpdate(
+        const std::set<const AstRelation*>& scc, const std::set<const AstRelation*>& inputs, bool isRecursive,
+        const RecursiveClauses* recursiveClauses) {
+    // a query writing the tuples of lhs missing from rhs, or all tuples for a null rhs, into dest
+    auto genDifference = [](std::unique_ptr<RamRelationReference> dest,
+                                 std::unique_ptr<RamRelationReference> lhs,
+                                 std::unique_ptr<RamRelationReference> rhs) -> std::unique_ptr<RamStatement> {
+        const size_t arity = lhs->get()->getArity();
+        std::vector<std::unique_ptr<RamExpression>> values;
+        std::unique_ptr<RamCondition> missing;
+        if (arity == 0) {
+            missing = std::make_unique<RamNegation>(std::make_unique<RamEmptinessCheck>(std::move(lhs)));
+            if (rhs != nullptr) {
+                missing = std::make_unique<RamConjunction>(
+                        std::move(missing), std::make_unique<RamEmptinessCheck>(std::move(rhs)));
+            }
+            return std::make_unique<RamQuery>(std::make_unique<RamFilter>(
+                    std::move(missing), std::make_unique<RamProject>(std::move(dest), std::move(values))));
+        }
+        std::vector<std::unique_ptr<RamExpression>> pattern;
+        for (size_t i = 0; i < arity; ++i) {
+            values.push_back(std::make_unique<RamTupleElement>(0, i));
+            pattern.push_back(std::make_unique<RamTupleElement>(0, i));
+        }
+        std::unique_ptr<RamOperation> op = std::make_unique<RamProject>(std::move(dest), std::move(values));
+        if (rhs != nullptr) {
+            op = std::make_unique<RamFilter>(
+                    std::make_unique<RamNegation>(
+                            std::make_unique<RamExistenceCheck>(std::move(rhs), std::move(pattern))),
+                    std::move(op));
+        }
+        return std::make_unique<RamQuery>(std::make_unique<RamScan>(std::move(lhs), 0, std::move(op)));
+    };
+
+    // a loop running the body at most once, skipping it if the condition holds
+    auto genGuard = [](std::unique_ptr<RamCondition> skip,
+                            std::unique_ptr<RamStatement> body) -> std::unique_ptr<RamStatement> {
+        auto guarded = std::make_unique<RamSequence>();
+        guarded->add(std::make_unique<RamExit>(std::move(skip)));
+        guarded->add(std::move(body));
+        guarded->add(std::make_unique<RamExit>(std::make_unique<RamTrue>()));
+        return std::make_unique<RamLoop>(std::move(guarded));
+    };
+
+    // a conjunction of the emptiness of the given relations
+    auto genEmpty = [](std::vector<std::unique_ptr<RamRelationReference>> relations) {
+        std::unique_ptr<RamCondition> cond;
+        for (auto& relation : relations) {
+            auto empty = std::make_unique<RamEmptinessCheck>(std::move(relation));
+            cond = (cond) ? std::make_unique<RamConjunction>(std::move(cond), std::move(empty))
+                          : std::unique_ptr<RamCondition>(std::move(empty));
+        }
+        return cond;
+    };
+
+    // a sequence moving the tuples of a relation into its previous relation, keeping the relation itself in
+    // place for the program interface
+    auto genMoveToPrevious = [&](const AstRelation* rel) -> std::unique_ptr<RamStatement> {
+        return std::make_unique<RamSequence>(
+                genDifference(translatePreviousRelation(rel), translateRelation(rel), nullptr),
+                std::make_unique<RamClear>(translateRelation(rel)));
+    };
+
+    std::unique_ptr<RamStatement> res;
+
+    // input relations receive their changes from the program interface, rebuilding the relation for removals
+    if (!inputs.empty()) {
+        for (const AstRelation* rel : inputs) {
+            std::unique_ptr<RamStatement> rebuild;
+            appendStmt(rebuild, genMoveToPrevious(rel));
+            appendStmt(rebuild, genDifference(translateRelation(rel), translatePreviousRelation(rel),
+                                        translateRemovedRelation(rel)));
+            if (rel->getRepresentation() == RelationRepresentation::EQREL) {
+                // insertions imply further tuples of equivalence relations, so the changes are recomputed
+                appendStmt(rebuild,
+                        genDifference(translateRelation(rel), translateAddedRelation(rel), nullptr));
+                appendStmt(rebuild, std::make_unique<RamClear>(translateAddedRelation(rel)));
+                appendStmt(rebuild, std::make_unique<RamClear>(translateRemovedRelation(rel)));
+                appendStmt(rebuild, genDifference(translateAddedRelation(rel), translateRelation(rel),
+                                            translatePreviousRelation(rel)));
+                appendStmt(rebuild, genDifference(translateRemovedRelation(rel),
+                                            translatePreviousRelation(rel), translateRelation(rel)));
+                appendStmt(rebuild, std::make_unique<RamClear>(translatePreviousRelation(rel)));
+                std::vector<std::unique_ptr<RamRelationReference>> changes;
+                changes.push_back(translateAddedRelation(rel));
+                changes.push_back(translateRemovedRelation(rel));
+                appendStmt(res, genGuard(genEmpty(std::move(changes)), std::move(rebuild)));
+            } else {
+                appendStmt(rebuild, std::make_unique<RamClear>(translatePreviousRelation(rel)));
+                std::vector<std::unique_ptr<RamRelationReference>> removals;
+                removals.push_back(translateRemovedRelation(rel));
+                appendStmt(res, genGuard(genEmpty(std::move(removals)), std::move(rebuild)));
+                appendStmt(res, genDifference(translateRelation(rel), translateAddedRelation(rel), nullptr));
+            }
+        }
+        return res;
+    }
+
+    // collect the relations of lower components used by the clauses; insertions into them only add tuples
+    // unless they are negated or aggregated, or the implied tuples of equivalence relations are needed
+    std::set<const AstRelation*> dependencies;
+    bool monotone = true;
+    for (const AstRelation* rel : scc) {
+        if (rel->getRepresentation() == RelationRepresentation::EQREL) {
+            monotone = false;
+        }
+        for (AstClause* clause : rel->getClauses()) {
+            for (AstLiteral* literal : clause->getBodyLiterals()) {
+                visitDepthFirst(*literal, [&](const AstAtom& atom) {
+                    const AstRelation* atomRelation = getAtomRelation(&atom, program);
+                    if (scc.find(atomRelation) == scc.end()) {
+                        dependencies.insert(atomRelation);
+                    }
+                });
+            }
+            visitDepthFirst(*clause, [&](const AstNegation&) { monotone = false; });
+            visitDepthFirst(*clause, [&](const AstAggregator&) { monotone = false; });
+        }
+    }
+    if (dependencies.empty()) {
+        return nullptr;
+    }
+
+    // recompute the relations, recording the difference to the previous relations as their changes
+    std::unique_ptr<RamStatement> recompute;
+    for (const AstRelation* rel : scc) {
+        appendStmt(recompute, genMoveToPrevious(rel));
+    }
+    appendStmt(recompute, isRecursive ? translateRecursiveRelation(scc, recursiveClauses)
+                                      : translateNonRecursiveRelation(**scc.begin(), recursiveClauses));
+    for (const AstRelation* rel : scc) {
+        appendStmt(recompute, genDifference(translateAddedRelation(rel), translateRelation(rel),
+                                      translatePreviousRelation(rel)));
+        appendStmt(recompute, genDifference(translateRemovedRelation(rel), translatePreviousRelation(rel),
+                                      translateRelation(rel)));
+        appendStmt(recompute, std::make_unique<RamClear>(translatePreviousRelation(rel)));
+    }
+
+    std::vector<std::unique_ptr<RamRelationReference>> removals;
+    for (const AstRelation* dependency : dependencies) {
+        removals.push_back(translateRemovedRelation(dependency));
+    }
+    if (!monotone) {
+        std::vector<std::unique_ptr<RamRelationReference>> changes;
+        for (const AstRelation* dependency : dependencies) {
+            changes.push_back(translateAddedRelation(dependency));
+            changes.push_back(translateRemovedRelation(dependency));
+        }
+        return genGuard(genEmpty(std::move(changes)), std::move(recompute));
+    }
+
+    // removals are handled by recomputation, insertions only evaluate the tuples derived from them
+    std::unique_ptr<RamStatement> insertion;
+    if (isRecursive) {
+        insertion = translateRecursiveRelation(scc, recursiveClauses, true);
+    } else {
+        const AstRelation* rel = *scc.begin();
+        appendStmt(insertion, translateIncrementalInsertion(*rel, scc, "@add_"));
+        appendStmt(insertion, genDifference(translateRelation(rel), translateAddedRelation(rel), nullptr));
+    }
+    std::vector<std::unique_ptr<RamRelationReference>> clones;
+    for (const auto& removal : removals) {
+        clones.emplace_back(removal->clone());
+    }
+    appendStmt(res, genGuard(genEmpty(std::move(removals)), std::move(recompute)));
+    appendStmt(res,
+            genGuard(std::make_unique<RamNegation>(genEmpty(std::move(clones))), std::move(insertion)));
+    return res;
+}
+
 /** make a subroutine to search for subproofs */
 std::unique_ptr<RamStatement> AstTranslator::makeSubproofSubroutine(const AstClause& clause) {
     // make intermediate clause with constraints
@@ -1521,10 +1912,20 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
 
     // a function to store relations
     const auto& makeRamStore = [&](std::unique_ptr<RamStatement>& current, const AstRelation* relation,
-                                       const std::string& outputDirectory, const std::string& fileExtension) {
+                                       const std::string& outputDirectory, const std::string& fileExtension,
+                                       bool recursive) {
+        std::vector<IODirectives> ioDirectives =
+                getOutputIODirectives(relation, Global::config().get(outputDirectory), fileExtension);
+        // the output streamed by the fixpoint of a recursive relation is complete
+        if (recursive && !getStreamedIODirectives(relation).empty()) {
+            auto end = std::remove_if(ioDirectives.begin(), ioDirectives.end(), isStreamedIODirective);
+            ioDirectives.erase(end, ioDirectives.end());
+            if (ioDirectives.empty()) {
+                return;
+            }
+        }
         std::unique_ptr<RamStatement> statement = std::make_unique<RamStore>(
-                std::unique_ptr<RamRelationReference>(translateRelation(relation)),
-                getOutputIODirectives(relation, Global::config().get(outputDirectory), fileExtension));
+                std::unique_ptr<RamRelationReference>(translateRelation(relation)), ioDirectives);
         if (Global::config().has("profile")) {
             const std::string logTimerStatement =
                     LogStatement::tRelationSaveTime(toString(relation->getName()), relation->getSrcLoc());
@@ -1542,6 +1943,25 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     // maintain the index of the SCC within the topological order
     size_t indexOfScc = 0;
 
+    // evaluate independent strata concurrently if requested
+    const bool concurrentStrata = evaluateConcurrently();
+    std::unique_ptr<RamSchedule> schedule;
+    if (concurrentStrata) {
+        schedule = std::make_unique<RamSchedule>(std::stoi(Global::config().get("stratum-jobs")));
+    }
+
+    // the index of the strata of the schedule computing each SCC of the topological order
+    std::vector<size_t> strataOfScc;
+
+    // the index of the strata of the schedule storing the output relations of an SCC, if any
+    std::map<size_t, size_t> storeStratumOfScc;
+
+    // sizes of relations recorded by a previous run, to tune their data structures
+    AstProfileUse* profileUse = nullptr;
+    if (Global::config().has("profile-use")) {
+        profileUse = translationUnit.getAnalysis<AstProfileUse>();
+    }
+
     // create all Ram relations in ramRels
     for (const auto& scc : sccOrder.order()) {
         const auto& isRecursive = sccGraph.isRecursive(scc);
@@ -1560,18 +1980,57 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
                             getTypeQualifier(typeEnv->getType(rel->getAttribute(i)->getTypeName())));
                 }
             }
-            ramRels[name] = std::make_unique<RamRelation>(
-                    name, arity, auxiliaryArity, attributeNames, attributeTypeQualifiers, representation);
+            auto blockSize = rel->getBlockSize();
+            std::vector<size_t> choiceDomain;
+            for (const std::string& attribute : rel->getChoiceDomain()) {
+                choiceDomain.push_back(std::find(attributeNames.begin(), attributeNames.end(), attribute) -
+                                       attributeNames.begin());
+            }
+            if (representation == RelationRepresentation::DEFAULT && blockSize == 0 &&
+                    choiceDomain.empty() && hasDenseDomain(attributeTypeQualifiers, auxiliaryArity)) {
+                representation = RelationRepresentation::DENSE;
+            }
+            size_t sizeHint = 0;
+            bool bloomFilter = false;
+            if (profileUse != nullptr && profileUse->hasRelationSize(rel->getName())) {
+                sizeHint = profileUse->getRelationSize(rel->getName());
+                // lookups of complete tuples which mostly miss, e.g. of negations, are filtered first
+                bloomFilter = auxiliaryArity == 0 && representation != RelationRepresentation::EQREL &&
+                              representation != RelationRepresentation::MIN_LATTICE &&
+                              representation != RelationRepresentation::MAX_LATTICE &&
+                              profileUse->getLookupMissRatio(rel->getName(), arity, 1000) >= 0.9;
+            }
+            ramRels[name] = std::make_unique<RamRelation>(name, arity, auxiliaryArity, attributeNames,
+                    attributeTypeQualifiers, representation, blockSize, sizeHint, bloomFilter, choiceDomain);
             if (isRecursive) {
                 std::string deltaName = "@delta_" + name;
                 std::string newName = "@new_" + name;
                 ramRels[deltaName] = std::make_unique<RamRelation>(deltaName, arity, auxiliaryArity,
-                        attributeNames, attributeTypeQualifiers, representation);
+                        attributeNames, attributeTypeQualifiers, representation, blockSize, 0, false,
+                        choiceDomain);
                 ramRels[newName] = std::make_unique<RamRelation>(newName, arity, auxiliaryArity,
-                        attributeNames, attributeTypeQualifiers, representation);
+                        attributeNames, attributeTypeQualifiers, representation, blockSize, 0, false,
+                        choiceDomain);
+            }
+            if (Global::config().has("incremental")) {
+                // the changes of a relation are plain sets, even if they are not closed under equivalence
+                const auto changeRepresentation = representation == RelationRepresentation::EQREL
+                                                          ? RelationRepresentation::DEFAULT
+                                                          : representation;
+                for (const std::string prefix : {"@add_", "@del_"}) {
+                    ramRels[prefix + name] = std::make_unique<RamRelation>(prefix + name, arity,
+                            auxiliaryArity, attributeNames, attributeTypeQualifiers, changeRepresentation,
+                            blockSize);
+                }
+                std::string oldName = "@old_" + name;
+                ramRels[oldName] = std::make_unique<RamRelation>(oldName, arity, auxiliaryArity,
+                        attributeNames, attributeTypeQualifiers, representation, blockSize);
             }
         }
     }
+
+    // the incremental update of all SCCs, recording the changes of their relations
+    std::unique_ptr<RamStatement> incrementalUpdate;
     // iterate over each SCC according to the topological order
     for (const auto& scc : sccOrder.order()) {
         // make a new ram statement for the current SCC
@@ -1589,9 +2048,11 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
         // make a variable for all relations that are expired at the current SCC
         const auto& internExps = expirySchedule.at(indexOfScc).expired();
 
-        // load all internal input relations from the facts dir with a .facts extension
+        // load all internal input relations from the facts dir with a .facts extension; with concurrent
+        // strata the loads get a stratum of their own that starts with the program
+        std::unique_ptr<RamStatement> load;
         for (const auto& relation : internIns) {
-            makeRamLoad(current, relation, "fact-dir", ".facts");
+            makeRamLoad(concurrentStrata ? load : current, relation, "fact-dir", ".facts");
         }
 
         // compute the relations themselves
@@ -1601,23 +2062,108 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
                                : translateRecursiveRelation(allInterns, recursiveClauses);
         appendStmt(current, std::move(bodyStatement));
 
-        // store all internal output relations to the output dir with a .csv extension
+        // update the relations for the changes of the relations they depend on
+        if (Global::config().has("incremental")) {
+            appendStmt(incrementalUpdate,
+                    translateIncrementalUpdate(allInterns, internIns, isRecursive, recursiveClauses));
+        }
+
+        // record the statistics of the computed relations for cost-based optimisations
+        if (Global::config().has("profile")) {
+            for (const auto& relation : allInterns) {
+                appendStmt(current, std::make_unique<RamLogStatistics>(translateRelation(relation),
+                                            LogStatement::relationStatistics(toString(relation->getName()))));
+            }
+        }
+
+        // store all internal output relations to the output dir with a .csv extension; with concurrent
+        // strata the stores get a stratum of their own, so that dependent strata need not wait for them
+        std::unique_ptr<RamStatement> store;
         for (const auto& relation : internOuts) {
-            makeRamStore(current, relation, "output-dir", ".csv");
+            makeRamStore(concurrentStrata ? store : current, relation, "output-dir", ".csv", isRecursive);
         }
 
-        // if provenance is not enabled...
-        if (!Global::config().has("provenance")) {
-            // otherwise, drop all  relations expired as per the topological order
+        // record the memory of the relations computed by the stratum and of the relations about to expire,
+        // while all of them are still populated
+        if (Global::config().has("profile")) {
+            std::set<const AstRelation*> logged(allInterns.begin(), allInterns.end());
+            logged.insert(internExps.begin(), internExps.end());
+            std::vector<std::unique_ptr<RamRelationReference>> relations;
+            for (const auto& relation : logged) {
+                relations.push_back(translateRelation(relation));
+            }
+            appendStmt(current, std::make_unique<RamLogMemory>(indexOfScc, std::move(relations)));
+        }
+
+        // if incremental updates are not enabled, and no queries are served on the relations...
+        std::unique_ptr<RamStatement> clear;
+        if (!Global::config().has("incremental") && !Global::config().has("serve")) {
+            // otherwise, drop all  relations expired as per the topological order, except those
+            // annotated with provenance, which are searched when explaining their tuples
             for (const auto& relation : internExps) {
-                makeRamClear(current, relation);
+                if (auxArityAnalysis->getArity(relation) == 0) {
+                    makeRamClear(concurrentStrata ? clear : current, relation);
+                }
             }
         }
 
-        appendStmt(res, std::move(current));
+        // record the state of the program once the stratum is completed
+        if (Global::config().has("checkpoint")) {
+            if (!current) {
+                current = std::make_unique<RamSequence>();
+            }
+            current = std::make_unique<RamCheckpoint>(
+                    indexOfScc, std::move(current), Global::config().get("checkpoint"));
+        }
+
+        if (concurrentStrata) {
+            // the stratum waits for the strata computing its predecessors, and expired relations are
+            // dropped in a stratum of their own once all strata using them are done
+            const auto& step = expirySchedule.at(indexOfScc);
+            const auto& toStrata = [&](const std::set<size_t>& indices) {
+                std::vector<size_t> strata;
+                for (size_t index : indices) {
+                    strata.push_back(strataOfScc.at(index));
+                }
+                return strata;
+            };
+            std::vector<size_t> strata = toStrata(step.dependencies());
+            if (load && current) {
+                strata.push_back(schedule->getStatements().size());
+                schedule->add(std::move(load), {});
+            } else if (load) {
+                current = std::move(load);
+            }
+            if (!current) {
+                current = std::make_unique<RamSequence>();
+            }
+            strataOfScc.push_back(schedule->getStatements().size());
+            schedule->add(std::move(current), std::move(strata));
+            if (store) {
+                storeStratumOfScc[indexOfScc] = schedule->getStatements().size();
+                schedule->add(std::move(store), {strataOfScc.back()});
+            }
+            if (clear) {
+                // the relations must also have been written before they are dropped
+                std::vector<size_t> strata = toStrata(step.expiryDependencies());
+                for (size_t index : step.expiryDependencies()) {
+                    auto pos = storeStratumOfScc.find(index);
+                    if (pos != storeStratumOfScc.end()) {
+                        strata.push_back(pos->second);
+                    }
+                }
+                schedule->add(std::move(clear), std::move(strata));
+            }
+        } else {
+            appendStmt(res, std::move(current));
+        }
         indexOfScc++;
     }
 
+    if (concurrentStrata) {
+        res = std::move(schedule);
+    }
+
     // add main timer if profiling
     if (res && Global::config().has("profile")) {
         res = std::make_unique<RamLogTimer>(std::move(res), LogStatement::runtime());
@@ -1626,14 +2172,26 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     // done for main prog
     ramMain = std::move(res);
 
+    // add subroutine for incremental updates, discarding the changes once they have been propagated
+    if (Global::config().has("incremental")) {
+        for (const auto& scc : sccOrder.order()) {
+            for (const AstRelation* relation : sccGraph.getInternalRelations(scc)) {
+                appendStmt(incrementalUpdate, std::make_unique<RamClear>(translateAddedRelation(relation)));
+                appendStmt(incrementalUpdate, std::make_unique<RamClear>(translateRemovedRelation(relation)));
+            }
+        }
+        ramSubs["incremental"] = std::move(incrementalUpdate);
+    }
+
     // add subroutines for each clause
     if (Global::config().has("provenance")) {
         visitDepthFirst(program->getRelations(), [&](const AstClause& clause) {
             std::stringstream relName;
             relName << clause.getHead()->getName();
 
-            // do not add subroutines for info relations or facts
-            if (relName.str().find("@info") != std::string::npos || clause.getBodyLiterals().empty()) {
+            // do not add subroutines for info relations, facts or relations not annotated
+            if (relName.str().find("@info") != std::string::npos || clause.getBodyLiterals().empty() ||
+                    auxArityAnalysis->getArity(clause.getHead()) == 0) {
                 return;
             }
 
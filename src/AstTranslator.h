@@ -288,6 +288,12 @@ private:
      */
     void nameUnnamedVariables(AstClause* clause);
 
+    /**
+     * the atom of the given head checked for existence before inserting it into the relation, covering
+     * only the columns of its choice-domain if any, such that tuples of a known key are not derived
+     */
+    std::unique_ptr<AstAtom> translateChoiceKey(const AstRelation& rel, const AstAtom& head);
+
     /** append statement to a list of statements */
     void appendStmt(std::unique_ptr<RamStatement>& stmtList, std::unique_ptr<RamStatement> stmt);
 
@@ -305,6 +311,9 @@ private:
     std::vector<IODirectives> getOutputIODirectives(const AstRelation* rel,
             std::string filePath = std::string(), const std::string& fileExt = std::string());
 
+    /** Get the output directives of a recursive relation which stream the new tuples of each iteration */
+    std::vector<IODirectives> getStreamedIODirectives(const AstRelation* rel);
+
     /** create a reference to a RAM relation */
     std::unique_ptr<RamRelationReference> createRelationReference(const std::string name);
 
@@ -321,6 +330,15 @@ private:
     /** translate a temporary `new` relation to a RAM relation for semi-naive evaluation */
     std::unique_ptr<RamRelationReference> translateNewRelation(const AstRelation* rel);
 
+    /** translate a temporary `add` relation to a RAM relation holding the insertions of an update */
+    std::unique_ptr<RamRelationReference> translateAddedRelation(const AstRelation* rel);
+
+    /** translate a temporary `del` relation to a RAM relation holding the removals of an update */
+    std::unique_ptr<RamRelationReference> translateRemovedRelation(const AstRelation* rel);
+
+    /** translate a temporary `old` relation to a RAM relation holding a relation before an update */
+    std::unique_ptr<RamRelationReference> translatePreviousRelation(const AstRelation* rel);
+
     /** translate an AST argument to a RAM value */
     std::unique_ptr<RamExpression> translateValue(const AstArgument* arg, const ValueIndex& index);
 
@@ -393,9 +411,29 @@ private:
     std::unique_ptr<RamStatement> translateNonRecursiveRelation(
             const AstRelation& rel, const RecursiveClauses* recursiveClauses);
 
-    /** translate RAM code for recursive relations in a strongly-connected component */
-    std::unique_ptr<RamStatement> translateRecursiveRelation(
-            const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses);
+    /**
+     * translate RAM code for recursive relations in a strongly-connected component; the incremental
+     * version starts from the tuples derived from the insertions into the relations of lower components.
+     */
+    std::unique_ptr<RamStatement> translateRecursiveRelation(const std::set<const AstRelation*>& scc,
+            const RecursiveClauses* recursiveClauses, bool incremental = false);
+
+    /**
+     * translate RAM code for the tuples of the given relation derived from the insertions into the
+     * relations of lower components, written into the relation with the given prefix.
+     */
+    std::unique_ptr<RamStatement> translateIncrementalInsertion(const AstRelation& rel,
+            const std::set<const AstRelation*>& scc, const std::string& targetPrefix);
+
+    /**
+     * translate RAM code updating the relations of a strongly-connected component for the insertions into
+     * and removals from the relations it depends on, recording the changes of its own relations.
+     *
+     * @return a corresponding statement or null if the relations cannot change.
+     */
+    std::unique_ptr<RamStatement> translateIncrementalUpdate(const std::set<const AstRelation*>& scc,
+            const std::set<const AstRelation*>& inputs, bool isRecursive,
+            const RecursiveClauses* recursiveClauses);
 
     /** translate RAM code for subroutine to get subproofs */
     std::unique_ptr<RamStatement> makeSubproofSubroutine(const AstClause& clause);
@@ -31,6 +31,7 @@
 #include "AstVisitor.h"
 #include "Constraints.h"
 #include "Global.h"
+#include "ParallelUtils.h"
 #include "TypeSystem.h"
 #include "Util.h"
 #include <cassert>
@@ -40,6 +41,7 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace souffle {
 
@@ -134,6 +136,10 @@ TypeConstraint isSubtypeOf(const TypeVar& a, const Type& b) {
             return true;
         }
 
+        std::vector<TypeVar> getVariables() const override {
+            return {a};
+        }
+
         void print(std::ostream& out) const override {
             out << a << " <: " << b.getName();
         }
@@ -183,6 +189,10 @@ TypeConstraint isSupertypeOf(const TypeVar& a, const Type& b) {
             return true;
         }
 
+        std::vector<TypeVar> getVariables() const override {
+            return {a};
+        }
+
         void print(std::ostream& out) const override {
             out << a << " >: " << b.getName();
         }
@@ -251,6 +261,10 @@ TypeConstraint isSubtypeOfComponent(const TypeVar& a, const TypeVar& b, int inde
             return changed;
         }
 
+        std::vector<TypeVar> getVariables() const override {
+            return {a, b};
+        }
+
         void print(std::ostream& out) const override {
             out << a << " <: " << b << "::" << index;
         }
@@ -331,19 +345,39 @@ void TypeAnalysis::run(const AstTranslationUnit& translationUnit) {
         debugStream = &analysisLogs;
     }
     auto* typeEnvAnalysis = translationUnit.getAnalysis<TypeEnvironmentAnalysis>();
-    for (const AstRelation* rel : translationUnit.getProgram()->getRelations()) {
+    const TypeEnvironment& env = typeEnvAnalysis->getTypeEnvironment();
+    const AstProgram* program = translationUnit.getProgram();
+    std::vector<const AstClause*> clauses;
+    for (const AstRelation* rel : program->getRelations()) {
         for (const AstClause* clause : rel->getClauses()) {
-            // Perform the type analysis
-            std::map<const AstArgument*, TypeSet> clauseArgumentTypes =
-                    analyseTypes(typeEnvAnalysis->getTypeEnvironment(), *clause, translationUnit.getProgram(),
-                            debugStream);
-            argumentTypes.insert(clauseArgumentTypes.begin(), clauseArgumentTypes.end());
-
-            if (debugStream != nullptr) {
-                // Store an annotated clause for printing purposes
-                AstClause* annotatedClause = createAnnotatedClause(clause, clauseArgumentTypes);
-                annotatedClauses.emplace_back(annotatedClause);
-            }
+            clauses.push_back(clause);
+        }
+    }
+
+    // Perform the type analysis; the clauses are analysed independently, on the threads of the
+    // jobs option unless their logs are recorded
+    std::vector<std::map<const AstArgument*, TypeSet>> clauseArgumentTypes(clauses.size());
+    if (debugStream == nullptr && clauses.size() > 1) {
+        const std::string jobs = Global::config().has("jobs") ? Global::config().get("jobs") : "1";
+        ThreadBudget::Lease threads(isNumber(jobs.c_str()) ? std::stoi(jobs) : 1);
+        PARALLEL_START
+        pfor(size_t i = 0; i < clauses.size(); i++) {
+            clauseArgumentTypes[i] = analyseTypes(env, *clauses[i], program, nullptr);
+        }
+        PARALLEL_END
+    } else {
+        for (size_t i = 0; i < clauses.size(); i++) {
+            clauseArgumentTypes[i] = analyseTypes(env, *clauses[i], program, debugStream);
+        }
+    }
+
+    for (size_t i = 0; i < clauses.size(); i++) {
+        argumentTypes.insert(clauseArgumentTypes[i].begin(), clauseArgumentTypes[i].end());
+
+        if (debugStream != nullptr) {
+            // Store an annotated clause for printing purposes
+            AstClause* annotatedClause = createAnnotatedClause(clauses[i], clauseArgumentTypes[i]);
+            annotatedClauses.emplace_back(annotatedClause);
         }
     }
 }
@@ -20,12 +20,58 @@
 #include "AstRelation.h"
 #include "AstRelationIdentifier.h"
 #include "AstUtils.h"
+#include "AstVisitor.h"
 #include "Global.h"
+#include "RelationRepresentation.h"
+#include "Util.h"
 #include <string>
+#include <vector>
 
 namespace souffle {
 
+void AuxiliaryArity::run(const AstTranslationUnit& translationUnit) {
+    program = translationUnit.getProgram();
+    annotated.clear();
+    restricted = Global::config().has("provenance") && Global::config().has("provenance-relations");
+    if (!restricted) {
+        return;
+    }
+
+    // the marked relations and, transitively, the relations occurring in their clauses
+    std::vector<AstRelationIdentifier> pending;
+    for (const std::string& relName : splitString(Global::config().get("provenance-relations"), ',')) {
+        const std::vector<std::string> comps = splitString(relName, '.');
+        if (!comps.empty()) {
+            AstRelationIdentifier relId(comps[0]);
+            for (size_t i = 1; i < comps.size(); i++) {
+                relId.append(comps[i]);
+            }
+            pending.push_back(relId);
+        }
+    }
+    while (!pending.empty()) {
+        AstRelationIdentifier relId = pending.back();
+        pending.pop_back();
+        const AstRelation* relation = program->getRelation(relId);
+        if (relation == nullptr || !annotated.insert(relId).second) {
+            continue;
+        }
+        for (const AstClause* clause : relation->getClauses()) {
+            visitDepthFirst(*clause, [&](const AstAtom& atom) {
+                if (annotated.count(atom.getName()) == 0) {
+                    pending.push_back(atom.getName());
+                }
+            });
+        }
+    }
+}
+
 const size_t AuxiliaryArity::computeArity(const AstRelation* relation) const {
+    // info relations are generated for the clauses of annotated relations only
+    if (restricted && relation->getRepresentation() != RelationRepresentation::INFO &&
+            annotated.count(relation->getName()) == 0) {
+        return 0;
+    }
     if (Global::config().has("provenance")) {
         if (Global::config().get("provenance") == "subtreeHeights") {
             size_t maxNrOfPremises = 0;
@@ -19,21 +19,25 @@
 #include "AstAnalysis.h"
 #include "AstLiteral.h"
 #include "AstProgram.h"
+#include "AstRelationIdentifier.h"
 #include "AstTranslationUnit.h"
+#include <set>
 
 namespace souffle {
 class AstRelation;
 
 /**
  * Determine the auxiliary arity for relations
+ *
+ * With provenance, relations carry the rule number and the height annotations of their tuples. If the
+ * option provenance-relations lists the relations to explain, only these and the relations they are
+ * derived from are annotated; the auxiliary arity of all other relations is zero.
  */
 class AuxiliaryArity : public AstAnalysis {
 public:
     static constexpr const char* name = "auxiliary-arity";
 
-    void run(const AstTranslationUnit& translationUnit) override {
-        program = translationUnit.getProgram();
-    }
+    void run(const AstTranslationUnit& translationUnit) override;
 
     /**
      * Returns the number of auxiliary parameters of an atom's relation
@@ -62,6 +66,12 @@ private:
     const size_t computeArity(const AstRelation* relation) const;
 
     const AstProgram* program = nullptr;
+
+    /** whether only some of the relations are annotated with provenance */
+    bool restricted = false;
+
+    /** the relations annotated with provenance if restricted */
+    std::set<AstRelationIdentifier> annotated;
 };
 
 }  // end of namespace souffle
@@ -17,16 +17,24 @@
 
 #pragma once
 
+#include "NodePool.h"
 #include "ParallelUtils.h"
 #include "Util.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <iostream>
 #include <iterator>
+#include <new>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
 namespace souffle {
 
 namespace detail {
@@ -197,6 +205,232 @@ struct binary_search : public search_strategy {
     }
 };
 
+/**
+ * A trait determining whether keys of the given type can be searched column wise:
+ * the keys need to be stored contiguously and be arrays of arithmetic values, and
+ * the comparator needs to order them primarily by an ascending leading column.
+ */
+template <typename Key, typename Iter, typename Comp, typename = void>
+struct is_column_searchable : public std::false_type {};
+
+template <typename Key, typename Iter, typename Comp>
+struct is_column_searchable<Key, Iter, Comp,
+        std::void_t<decltype(Comp::leading_column), decltype(Key::arity)>>
+        : public std::integral_constant<bool,
+                  std::is_pointer<Iter>::value &&
+                          std::is_same<std::remove_cv_t<std::remove_pointer_t<Iter>>, Key>::value &&
+                          std::is_arithmetic<std::decay_t<decltype(std::declval<const Key&>()[0])>>::value &&
+                          sizeof(Key) == Key::arity * sizeof(std::declval<const Key&>()[0])> {};
+
+/**
+ * A search strategy for b-tree nodes of tuples ordered by a leading column,
+ * such as the tuples of indexes in generated code. The keys sharing the
+ * leading column of the searched key are located by comparing the leading
+ * columns of multiple keys per instruction (utilising AVX-512 or AVX2 where
+ * enabled), and are then resolved by a binary search. Keys that can not be
+ * searched column wise are searched by a binary search.
+ */
+struct simd_search : public search_strategy {
+    /**
+     * Required user-defined default constructor.
+     */
+    simd_search() = default;
+
+    /**
+     * Obtains an iterator referencing an element equivalent to the
+     * given key in the given range. If no such element is present,
+     * a reference to the first element not less than the given key
+     * is returned.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter operator()(const Key& k, Iter a, Iter b, Comp& comp) const {
+        return lower_bound(k, a, b, comp);
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * is not less than the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter lower_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (is_column_searchable<Key, Iter, Comp>::value) {
+            auto ties = leadingColumnRange(k, a, b, comp);
+            return binary_search().lower_bound(k, ties.first, ties.second, comp);
+        } else {
+            return binary_search().lower_bound(k, a, b, comp);
+        }
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * such that the given key is less than the referenced element.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter upper_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (is_column_searchable<Key, Iter, Comp>::value) {
+            auto ties = leadingColumnRange(k, a, b, comp);
+            return binary_search().upper_bound(k, ties.first, ties.second, comp);
+        } else {
+            return binary_search().upper_bound(k, a, b, comp);
+        }
+    }
+
+private:
+    /**
+     * Obtains the range of elements in the given range whose leading
+     * column equals the leading column of the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    static std::pair<Iter, Iter> leadingColumnRange(const Key& k, Iter a, Iter b, Comp& /* comp */) {
+        using value_type = std::decay_t<decltype(k[0])>;
+        constexpr std::size_t column = Comp::leading_column;
+        const auto* values = reinterpret_cast<const value_type*>(a) + column;
+        const std::size_t n = b - a;
+        const std::size_t lo = countPrefix<false>(values, Key::arity, 0, n, k[column]);
+        const std::size_t hi = countPrefix<true>(values, Key::arity, lo, n, k[column]);
+        return {a + lo, a + hi};
+    }
+
+    /**
+     * Obtains the index of the first of the given n values, stored with the given
+     * stride and sorted ascending, that is greater or equal to the given pivot
+     * (or greater than the pivot, if inclusive), starting the search at index i.
+     */
+    template <bool Inclusive, typename T>
+    static std::size_t countPrefix(
+            const T* values, std::size_t stride, std::size_t i, std::size_t n, T pivot) {
+        // bisect down to a window of a few vector widths, which is scanned
+        while (n - i > 32) {
+            const std::size_t mid = i + (n - i) / 2;
+            const T& cur = values[mid * stride];
+            if (Inclusive ? !(pivot < cur) : cur < pivot) {
+                i = mid + 1;
+            } else {
+                n = mid;
+            }
+        }
+#if defined(__AVX512F__)
+        if constexpr (std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) == 4) {
+            const __m512i offsets = _mm512_mullo_epi32(
+                    _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                    _mm512_set1_epi32(static_cast<int>(stride)));
+            const __m512i bound = _mm512_set1_epi32(pivot);
+            for (; i + 16 <= n; i += 16) {
+                const __m512i cur = _mm512_i32gather_epi32(offsets, values + i * stride, 4);
+                const __mmask16 below =
+                        Inclusive ? _mm512_cmple_epi32_mask(cur, bound) : _mm512_cmplt_epi32_mask(cur, bound);
+                if (below != 0xFFFF) {
+                    return i + __builtin_popcount(below);
+                }
+            }
+        }
+#elif defined(__AVX2__)
+        if constexpr (std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) == 4) {
+            const __m256i offsets = _mm256_mullo_epi32(
+                    _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+            const __m256i bound = _mm256_set1_epi32(pivot);
+            for (; i + 8 <= n; i += 8) {
+                const __m256i cur =
+                        _mm256_i32gather_epi32(reinterpret_cast<const int*>(values + i * stride), offsets, 4);
+                // lanes outside of the prefix, i.e. greater than (or not less than) the pivot
+                const __m256i above = Inclusive ? _mm256_cmpgt_epi32(cur, bound)
+                                                : _mm256_or_si256(_mm256_cmpgt_epi32(cur, bound),
+                                                          _mm256_cmpeq_epi32(cur, bound));
+                const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(above));
+                if (mask != 0) {
+                    return i + __builtin_ctz(mask);
+                }
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            const T& cur = values[i * stride];
+            if (Inclusive ? pivot < cur : !(cur < pivot)) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+
+/**
+ * A trait determining whether the given comparator orders keys by an unsigned integer
+ * encoding, provided by a static encode function returning its key_type.
+ */
+template <typename Comp, typename = void>
+struct has_key_encoding : public std::false_type {};
+
+template <typename Comp>
+struct has_key_encoding<Comp, std::void_t<typename Comp::key_type>> : public std::true_type {};
+
+/**
+ * A branchless binary search strategy for keys ordered by an integer encoding, which
+ * encodes the searched key once and bisects by conditional moves. For comparators
+ * without such an encoding it is a binary search.
+ */
+struct packed_search : public search_strategy {
+    /**
+     * Required user-defined default constructor.
+     */
+    packed_search() = default;
+
+    /**
+     * Obtains a reference to the first element in the given range that is not less than
+     * the given key, which is an element equal to the key if available.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    Iter operator()(const Key& k, Iter a, Iter b, Comp& comp) const {
+        return lower_bound(k, a, b, comp);
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * is not less than the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    Iter lower_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (has_key_encoding<Comp>::value) {
+            return bisect<false, Comp>(Comp::encode(k), a, b);
+        } else {
+            return binary_search().lower_bound(k, a, b, comp);
+        }
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * such that the given key is less than the referenced element.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    Iter upper_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (has_key_encoding<Comp>::value) {
+            return bisect<true, Comp>(Comp::encode(k), a, b);
+        } else {
+            return binary_search().upper_bound(k, a, b, comp);
+        }
+    }
+
+private:
+    /**
+     * Obtains the first element in the given range whose encoding is greater or equal to
+     * the given encoded key (or greater than the key, if inclusive).
+     */
+    template <bool Inclusive, typename Comp, typename Iter>
+    static Iter bisect(typename Comp::key_type key, Iter a, Iter b) {
+        auto n = b - a;
+        if (n == 0) {
+            return a;
+        }
+        while (n > 1) {
+            const auto half = n / 2;
+            const auto cur = Comp::encode(a[half - 1]);
+            a = (Inclusive ? cur <= key : cur < key) ? a + half : a;
+            n -= half;
+        }
+        const auto cur = Comp::encode(*a);
+        return a + (Inclusive ? cur <= key : cur < key);
+    }
+};
+
 // ---------- search strategies selection --------------
 
 /**
@@ -210,6 +444,8 @@ struct strategy_selection {
 
 struct linear : public strategy_selection<linear_search> {};
 struct binary : public strategy_selection<binary_search> {};
+struct simd : public strategy_selection<simd_search> {};
+struct packed : public strategy_selection<packed_search> {};
 
 // by default every key utilizes binary search
 template <typename Key>
@@ -370,19 +606,15 @@ protected:
          */
         static constexpr size_t maxKeys = (desiredNumKeys > 3) ? desiredNumKeys : 3;
 
+        // the position of a child in its parent has to fit into a field index
+        static_assert(maxKeys < (1 << (8 * sizeof(field_index_type))), "too many keys per b-tree node");
+
         // the keys stored in this node
         Key keys[maxKeys];
 
         // a simple constructor
         node(bool inner) : base(inner) {}
 
-        // a destructor cleaning up nodes
-        ~node() {
-            if (this->inner) {
-                asInnerNode().cleanup();
-            }
-        }
-
         /**
          * A deep-copy operation creating a clone of this node.
          */
@@ -1066,11 +1298,17 @@ protected:
         // a simple default constructor initializing member fields
         inner_node() : node(true) {}
 
-        // a destruction operation clearing up child nodes recursively
-        void cleanup() {
-            for (unsigned i = 0; i <= this->numElements; ++i) {
-                delete children[i];
-            }
+        static NodePool& pool() {
+            return NodePool::get<sizeof(inner_node), alignof(inner_node)>();
+        }
+
+        // inner nodes are allocated from the node pool of their size
+        static void* operator new(std::size_t) {
+            return pool().allocate();
+        }
+
+        static void operator delete(void* ptr) {
+            pool().deallocate(ptr);
         }
     };
 
@@ -1081,6 +1319,19 @@ protected:
     struct leaf_node : public node {
         // a simple default constructor initializing member fields
         leaf_node() : node(false) {}
+
+        static NodePool& pool() {
+            return NodePool::get<sizeof(leaf_node), alignof(leaf_node)>();
+        }
+
+        // leaf nodes are allocated from the node pool of their size
+        static void* operator new(std::size_t) {
+            return pool().allocate();
+        }
+
+        static void operator delete(void* ptr) {
+            pool().deallocate(ptr);
+        }
     };
 
     // ------------------- iterators ------------------------
@@ -1678,6 +1929,84 @@ public:
 #endif
     }
 
+    /**
+     * Inserts the given elements, in arbitrary order, into this tree. The elements are sorted in
+     * parallel unless they are sorted already. An empty tree is then built by a bulk-load,
+     * otherwise the sorted elements are inserted utilizing the insertion hints.
+     */
+    void insertBulk(std::vector<Key> elements) {
+        auto lessThan = [&](const Key& a, const Key& b) { return less(a, b); };
+        if (!std::is_sorted(elements.begin(), elements.end(), lessThan)) {
+            parallelSort(elements.begin(), elements.end(), lessThan);
+        }
+
+        // the bulk-load does not merge elements which are equal w.r.t. the weak comparator
+        if (!empty() || elements.empty() || !std::is_same<Comparator, WeakComparator>::value) {
+            insert(elements.begin(), elements.end());
+            return;
+        }
+
+        if (isSet) {
+            auto equalTo = [&](const Key& a, const Key& b) { return equal(a, b); };
+            elements.erase(std::unique(elements.begin(), elements.end(), equalTo), elements.end());
+        }
+        root = buildSubTree(elements.begin(), elements.end() - 1);
+        node* cur = root;
+        while (!cur->isLeaf()) {
+            cur = cur->getChild(0);
+        }
+        leftmost = static_cast<leaf_node*>(cur);
+    }
+
+    /**
+     * Rebuilds this tree from its elements with nodes filled to capacity, e.g. once the tree is only
+     * read anymore. The nodes are allocated adjacently, the leaves in the order of the elements and
+     * the inner nodes level by level, such that the tree occupies the least memory and scans as well
+     * as searches touch consecutive memory. No other operations may be conducted concurrently.
+     */
+    void compact() {
+        if (empty()) {
+            return;
+        }
+        std::vector<Key> elements(begin(), end());
+        clear();
+        root = buildPackedTree(elements.begin(), elements.end());
+        node* cur = root;
+        while (!cur->isLeaf()) {
+            cur = cur->getChild(0);
+        }
+        leftmost = static_cast<leaf_node*>(cur);
+    }
+
+    /**
+     * Inserts the given elements, in arbitrary order, into this tree like insertBulk, and returns
+     * the elements not contained before in the order of this tree. The sorted elements are merged
+     * into a non-empty tree by insertions utilizing the insertion hints, such that runs of elements
+     * falling into the same leaf are inserted without searching the tree.
+     */
+    std::vector<Key> insertBulkNew(std::vector<Key> elements) {
+        auto lessThan = [&](const Key& a, const Key& b) { return less(a, b); };
+        if (!std::is_sorted(elements.begin(), elements.end(), lessThan)) {
+            parallelSort(elements.begin(), elements.end(), lessThan);
+        }
+
+        if (empty() && isSet && std::is_same<Comparator, WeakComparator>::value) {
+            auto equalTo = [&](const Key& a, const Key& b) { return equal(a, b); };
+            elements.erase(std::unique(elements.begin(), elements.end(), equalTo), elements.end());
+            insertBulk(elements);
+            return elements;
+        }
+
+        std::vector<Key> res;
+        operation_hints hints;
+        for (const Key& cur : elements) {
+            if (insert(cur, hints)) {
+                res.push_back(cur);
+            }
+        }
+        return res;
+    }
+
     /**
      * Inserts the given range of elements into this tree.
      */
@@ -1857,6 +2186,63 @@ public:
         }
     }
 
+    /** The number of searches descended together by prefetch() */
+    static constexpr std::size_t PREFETCH_BATCH = 16;
+
+    /** The number of inner levels below which the paths are assumed to be cached, and not prefetched */
+    static constexpr std::size_t PREFETCH_MIN_HEIGHT = 5;
+
+    /**
+     * Prefetches the nodes on the paths to the lower bounds of the given keys, descending the paths of
+     * up to PREFETCH_BATCH keys a level at a time, such that the cache misses of their searches overlap
+     * rather than follow each other. Keys equal to their predecessor or covered by the leaves of the
+     * hints are skipped, since their searches start at those leaves.
+     */
+    void prefetch(const Key* keys, std::size_t count, operation_hints& hints) const {
+        if (empty()) {
+            return;
+        }
+        // all paths are of the same length, the nodes above the leaves being inner nodes
+        std::size_t height = 0;
+        for (const node* cur = root; cur->inner; cur = cur->getChild(0)) {
+            ++height;
+        }
+        if (height < PREFETCH_MIN_HEIGHT) {
+            return;
+        }
+        std::array<const node*, PREFETCH_BATCH> nodes;
+        std::array<const Key*, PREFETCH_BATCH> searched;
+        for (std::size_t begin = 0; begin < count; begin += PREFETCH_BATCH) {
+            std::size_t active = 0;
+            for (std::size_t i = begin; i < std::min(count, begin + PREFETCH_BATCH); ++i) {
+                const Key& k = keys[i];
+                if (i > begin && equal(keys[i - 1], k)) {
+                    continue;
+                }
+                if (!hints.last_lower_bound_end.any([&](node* hint) { return hint && covers(hint, k); })) {
+                    nodes[active] = root;
+                    searched[active++] = &k;
+                }
+            }
+            for (std::size_t level = height; level > 0 && active > 0; --level) {
+                std::size_t next = 0;
+                for (std::size_t i = 0; i < active; ++i) {
+                    const node* cur = nodes[i];
+                    if (!cur->inner) {
+                        continue;
+                    }
+                    auto a = &(cur->keys[0]);
+                    auto b = &(cur->keys[cur->numElements]);
+                    const node* child = cur->getChild(search.lower_bound(*searched[i], a, b, comp) - a);
+                    prefetchNode(child, level > 1);
+                    nodes[next] = child;
+                    searched[next++] = searched[i];
+                }
+                active = next;
+            }
+        }
+    }
+
     /**
      * Obtains an upper boundary for the given key -- hence an iterator referencing
      * the first element that the given key is less than the referenced value. If
@@ -1915,10 +2301,14 @@ public:
     }
 
     /**
-     * Clears this tree.
+     * Clears this tree, returning all nodes to the node pools at once.
      */
     void clear() {
-        delete root;
+        if (root != nullptr) {
+            NodePool::Batch leaves(leaf_node::pool());
+            NodePool::Batch inners(inner_node::pool());
+            release(root, leaves, inners);
+        }
         root = nullptr;
         leftmost = nullptr;
     }
@@ -2116,6 +2506,19 @@ protected:
         return !node->isEmpty() && less(node->keys[0], k) && less(k, node->keys[node->numElements - 1]);
     }
 
+    /**
+     * Prefetches the cache lines of an inner or leaf node.
+     */
+    static void prefetchNode(const node* cur, bool inner) {
+#ifdef __GNUC__
+        const char* begin = reinterpret_cast<const char*>(cur);
+        const std::size_t size = inner ? sizeof(inner_node) : sizeof(leaf_node);
+        for (std::size_t offset = 0; offset < size; offset += 64) {
+            __builtin_prefetch(begin + offset);
+        }
+#endif
+    }
+
     /**
      * Determines whether the range covered by the given node is also
      * covering the given key value.
@@ -2198,6 +2601,81 @@ private:
         // done
         return res;
     }
+
+    // Utility function for the compact operation above, building a tree of full nodes bottom-up from
+    // the non-empty range of ordered elements [a, b).
+    template <typename Iter>
+    static node* buildPackedTree(Iter a, Iter b) {
+        const std::size_t N = node::maxKeys;
+
+        // the nodes of the current level and the keys separating consecutive nodes
+        std::vector<node*> nodes;
+        std::vector<Key> separators;
+
+        // the leaves share the elements not separating them evenly
+        const std::size_t length = b - a;
+        const std::size_t numLeaves = (length + N + 1) / (N + 1);
+        const std::size_t leafKeys = length - (numLeaves - 1);
+        for (std::size_t i = 0; i < numLeaves; ++i) {
+            auto* leaf = ::new (leaf_node::pool().allocateAdjacent()) leaf_node();
+            leaf->numElements = leafKeys / numLeaves + (i < leafKeys % numLeaves ? 1 : 0);
+            std::copy(a, a + leaf->numElements, leaf->keys);
+            a += leaf->numElements;
+            nodes.push_back(leaf);
+            if (i + 1 < numLeaves) {
+                separators.push_back(*a++);
+            }
+        }
+
+        // the nodes of a level are grouped evenly into inner nodes, until a single root remains
+        while (nodes.size() > 1) {
+            const std::size_t numInner = (nodes.size() + N) / (N + 1);
+            std::vector<node*> parents;
+            std::vector<Key> parentSeparators;
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < numInner; ++i) {
+                const std::size_t numChildren =
+                        nodes.size() / numInner + (i < nodes.size() % numInner ? 1 : 0);
+                auto* inner = ::new (inner_node::pool().allocateAdjacent()) inner_node();
+                inner->numElements = numChildren - 1;
+                for (std::size_t j = 0; j < numChildren; ++j) {
+                    node* child = nodes[next + j];
+                    child->parent = inner;
+                    child->position = j;
+                    inner->getChildren()[j] = child;
+                    if (j + 1 < numChildren) {
+                        inner->keys[j] = separators[next + j];
+                    }
+                }
+                next += numChildren;
+                if (i + 1 < numInner) {
+                    parentSeparators.push_back(separators[next - 1]);
+                }
+                parents.push_back(inner);
+            }
+            nodes.swap(parents);
+            separators.swap(parentSeparators);
+        }
+        return nodes[0];
+    }
+
+    // Utility function for the clear operation above, destroying a sub-tree.
+    static void release(node* cur, NodePool::Batch& leaves, NodePool::Batch& inners) {
+        if (cur->isLeaf()) {
+            auto* leaf = static_cast<leaf_node*>(cur);
+            leaf->~leaf_node();
+            leaves.add(leaf);
+            return;
+        }
+        auto* inner = static_cast<inner_node*>(cur);
+        for (unsigned i = 0; i <= inner->numElements; ++i) {
+            if (inner->children[i] != nullptr) {
+                release(inner->children[i], leaves, inners);
+            }
+        }
+        inner->~inner_node();
+        inners.add(inner);
+    }
 };  // namespace souffle
 
 // Instantiation of static member search.
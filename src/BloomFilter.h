@@ -0,0 +1,116 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file BloomFilter.h
+ *
+ * This header file contains a concurrent bloom filter of tuples, which
+ * rules out most lookups of tuples missing in a relation without
+ * searching its indexes.
+ *
+ * The filter is blocked: all bits of a tuple are set in a single 64-bit
+ * word selected by the hash of the tuple, such that a lookup reads a
+ * single cache line. Bits are only ever set, hence inserts are lock free
+ * and lookups may be conducted concurrently to inserts.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace souffle {
+
+class BloomFilter {
+public:
+    /**
+     * Create a filter for the given number of tuples, which is exceeded
+     * at the cost of a higher false positive rate.
+     */
+    explicit BloomFilter(std::size_t expectedTuples) {
+        std::size_t required = expectedTuples * BITS_PER_TUPLE / 64;
+        numWords = MIN_WORDS;
+        while (numWords < required && numWords < MAX_WORDS) {
+            numWords *= 2;
+        }
+        words = std::make_unique<std::atomic<uint64_t>[]>(numWords);
+        clear();
+    }
+
+    /** Record the given tuple */
+    void insert(const RamDomain* tuple, std::size_t arity) {
+        const uint64_t h = hash(tuple, arity);
+        words[h & (numWords - 1)].fetch_or(getBits(h), std::memory_order_relaxed);
+    }
+
+    /** Check whether the given tuple may have been recorded, i.e., false if it has not been */
+    bool mayContain(const RamDomain* tuple, std::size_t arity) const {
+        const uint64_t h = hash(tuple, arity);
+        const uint64_t bits = getBits(h);
+        return (words[h & (numWords - 1)].load(std::memory_order_relaxed) & bits) == bits;
+    }
+
+    /** Forget all recorded tuples */
+    void clear() {
+        for (std::size_t i = 0; i < numWords; ++i) {
+            words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /** Get the number of bytes occupied by the filter */
+    std::size_t getMemoryUsage() const {
+        return numWords * sizeof(uint64_t);
+    }
+
+private:
+    /** Number of bits reserved for each expected tuple */
+    static constexpr std::size_t BITS_PER_TUPLE = 16;
+
+    /** Number of bits set for each tuple, each selected by 6 bits of the upper half of the hash */
+    static constexpr std::size_t BITS_SET = 4;
+
+    static constexpr std::size_t MIN_WORDS = 64;
+
+    static constexpr std::size_t MAX_WORDS = std::size_t(1) << 28;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+
+    /** Number of words, a power of two */
+    std::size_t numWords;
+
+    /** Hash a tuple, finalised by the finaliser of MurmurHash3 */
+    static uint64_t hash(const RamDomain* tuple, std::size_t arity) {
+        uint64_t h = 0;
+        for (std::size_t i = 0; i < arity; ++i) {
+            h ^= static_cast<uint64_t>(static_cast<RamUnsigned>(tuple[i])) + 0x9e3779b97f4a7c15ull +
+                 (h << 6) + (h >> 2);
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /** Get the bits of a word set for a tuple of the given hash */
+    static uint64_t getBits(uint64_t h) {
+        uint64_t bits = 0;
+        for (std::size_t i = 0; i < BITS_SET; ++i) {
+            bits |= uint64_t(1) << ((h >> (40 + 6 * i)) & 63);
+        }
+        return bits;
+    }
+};
+
+}  // namespace souffle
@@ -16,7 +16,7 @@
  * Tries trie is utilized to store n-ary tuples of integers. Each level
  * is implemented via a sparse array (also covered by this header file),
  * referencing the following nested level. The leaf level is realized
- * by a sparse bit-map to minimize the memory footprint.
+ * by a roaring bit-map to minimize the memory footprint.
  *
  * Multiple insert operations can be be conducted concurrently on trie
  * structures. So can read-only operations. However, inserts and read
@@ -27,14 +27,21 @@
 #pragma once
 
 #include "CompiledTuple.h"
+#include "NodePool.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "Util.h"
 
+#include <algorithm>
 #include <atomic>
 #include <bitset>
 #include <cstring>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 #ifdef _WIN32
 /**
@@ -165,6 +172,19 @@ private:
         const Node* parent;
         // the pointers to the child nodes (inner nodes) or the stored values (leaf nodes)
         Cell cell[NUM_CELLS];
+
+        static NodePool& pool() {
+            return NodePool::get<sizeof(Node), alignof(Node)>();
+        }
+
+        // nodes are allocated from the node pool of their size
+        static void* operator new(std::size_t) {
+            return pool().allocate();
+        }
+
+        static void operator delete(void* ptr) {
+            pool().deallocate(ptr);
+        }
     };
 
     /**
@@ -1221,29 +1241,31 @@ private:
      * Creates new nodes and initializes them with 0.
      */
     static Node* newNode() {
-        auto* res = new Node();
-        std::memset(res->cell, 0, sizeof(Cell) * NUM_CELLS);
-        return res;
+        // value-initialisation zeroes the parent and all cells
+        return new Node();
     }
 
     /**
-     * Destroys a node and all its sub-nodes recursively.
+     * Destroys a node and all its sub-nodes recursively, collecting them
+     * in the given batch to be returned to the node pool.
      */
-    static void freeNodes(Node* node, int level) {
+    static void freeNodes(Node* node, int level, NodePool::Batch& batch) {
         if (!node) return;
         if (level != 0) {
             for (int i = 0; i < NUM_CELLS; i++) {
-                freeNodes(node->cell[i].ptr, level - 1);
+                freeNodes(node->cell[i].ptr, level - 1, batch);
             }
         }
-        delete node;
+        node->~Node();
+        batch.add(node);
     }
 
     /**
      * Conducts a cleanup of the internal tree structure.
      */
     void clean() {
-        freeNodes(unsynced.root, unsynced.levels);
+        NodePool::Batch batch(Node::pool());
+        freeNodes(unsynced.root, unsynced.levels, batch);
         unsynced.root = nullptr;
         unsynced.levels = 0;
     }
@@ -1569,6 +1591,89 @@ public:
         store.addAll(other.store);
     }
 
+    // ---------------------------------------------------------------------
+    //                         Bulk Iteration
+    // ---------------------------------------------------------------------
+
+    /**
+     * Applies the given function to all indices set to 1, in ascending order.
+     * In contrast to the iterator, the words of the map are consumed one set
+     * bit at a time without maintaining any iterator state.
+     */
+    template <typename F>
+    void forEach(const F& f) const {
+        for (const auto& cur : store) {
+            forEachInWord(cur.first, iterator::toMask(cur.second), f);
+        }
+    }
+
+    /**
+     * Applies the given function to all maximal runs of consecutive indices set
+     * to 1, in ascending order. The function is called with the first index and
+     * the length of each run; runs spanning several words are reported once.
+     */
+    template <typename F>
+    void forEachRun(const F& f) const {
+        index_type first = 0;
+        index_type length = 0;
+        for (const auto& cur : store) {
+            const index_type base = cur.first << LEAF_INDEX_WIDTH;
+            uint64_t word = iterator::toMask(cur.second);
+            while (word != 0) {
+                // the run starts at the least set bit and ends before the next cleared one
+                const unsigned start = __builtin_ctzll(word);
+                const uint64_t rest = ~(word >> start);
+                const unsigned count = (rest == 0) ? BITS_PER_ENTRY - start : __builtin_ctzll(rest);
+                if (length > 0 && first + length == base + start) {
+                    length += count;
+                } else {
+                    if (length > 0) f(first, length);
+                    first = base + start;
+                    length = count;
+                }
+                word = (start + count == BITS_PER_ENTRY) ? 0 : word & (~uint64_t(0) << (start + count));
+            }
+        }
+        if (length > 0) f(first, length);
+    }
+
+    /**
+     * Applies the given function to all indices set to 1 in both this and the
+     * given bit map, in ascending order. The maps are intersected a word at a
+     * time, skipping the words missing in either map by lower-bound searches.
+     */
+    template <typename F>
+    void forEachCommon(const SparseBitMap& other, const F& f) const {
+        auto a = store.begin();
+        auto b = other.store.begin();
+        while (!a.isEnd() && !b.isEnd()) {
+            if (a->first < b->first) {
+                // step to the next word first, the words of dense maps are mostly consecutive
+                ++a;
+                if (!a.isEnd() && a->first < b->first) a = store.lowerBound(b->first);
+            } else if (b->first < a->first) {
+                ++b;
+                if (!b.isEnd() && b->first < a->first) b = other.store.lowerBound(a->first);
+            } else {
+                forEachInWord(a->first, iterator::toMask(a->second) & iterator::toMask(b->second), f);
+                ++a;
+                ++b;
+            }
+        }
+    }
+
+private:
+    // applies the given function to the indices of the set bits of a word of the map
+    template <typename F>
+    static void forEachInWord(index_type key, uint64_t word, const F& f) {
+        const index_type base = key << LEAF_INDEX_WIDTH;
+        while (word != 0) {
+            f(base | __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+
+public:
     // ---------------------------------------------------------------------
     //                           Iterator
     // ---------------------------------------------------------------------
@@ -1780,6 +1885,836 @@ public:
     }
 };
 
+/**
+ * A roaring bit-map is, like the sparse bit-map, a bit map virtually assigning a bit
+ * value to every value of the index domain. Its 1-bits are grouped into chunks of 2^16
+ * consecutive values, which are located utilizing a sparse array. Each chunk is stored
+ * in the most compact of three containers: a sorted array of the low bits of its values
+ * while it is sparse, a bitmap while it is dense, or a sorted list of runs of consecutive
+ * values while there are few of those. Hence, both very sparse and very dense regions
+ * are stored compactly, and the containers of two maps may be intersected directly,
+ * e.g. by conjoining bitmaps word-wise or by intersecting runs.
+ *
+ * Inserts into the same chunk are serialized by a lock of the chunk.
+ *
+ * @tparam BITS similar to the BITS parameter of the sparse array type; since there
+ *              are few chunks, e.g. within the leaf levels of tries, small nodes
+ *              are utilized by default
+ */
+template <unsigned BITS = 2>
+class RoaringBitMap {
+    // some constants for addressing chunks
+    static constexpr unsigned CHUNK_BITS = 16;
+    static constexpr uint32_t CHUNK_SIZE = uint32_t(1) << CHUNK_BITS;
+    static constexpr uint64_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+    /**
+     * The values of a single chunk, addressed by their low bits. Elements of a chunk are
+     * referenced by cursors: the position within the array, the value itself within the
+     * bitmap, or the index of the run in the upper and the value in the lower half-word
+     * within the list of runs. END marks the end of a chunk.
+     */
+    class Chunk {
+        // the number of words of the bitmap
+        static constexpr uint32_t WORDS = CHUNK_SIZE / 64;
+
+        // the number of values up to which a chunk may be an array, occupying at most the memory of a bitmap
+        static constexpr uint32_t ARRAY_LIMIT = CHUNK_SIZE / 16;
+
+    public:
+        static constexpr uint32_t END = ~uint32_t(0);
+
+        enum class Kind : uint8_t { ARRAY, BITMAP, RUNS };
+
+        Chunk() = default;
+
+        Chunk(const Chunk& other)
+                : kind(other.kind), count(other.count), runs(other.runs), values(other.values) {
+            if (other.words) {
+                words.reset(new uint64_t[WORDS]);
+                std::copy(other.words.get(), other.words.get() + WORDS, words.get());
+            }
+        }
+
+        Chunk& operator=(const Chunk&) = delete;
+
+        /**
+         * Inserts the given value, returning whether it was not present before.
+         */
+        bool insert(uint32_t value) {
+            std::lock_guard<SpinLock> guard(lock);
+            switch (kind) {
+                case Kind::ARRAY: {
+                    auto pos = std::lower_bound(values.begin(), values.end(), value);
+                    if (pos != values.end() && *pos == value) return false;
+                    const bool left = pos != values.begin() && *(pos - 1) + 1u == value;
+                    const bool right = pos != values.end() && *pos == value + 1;
+                    values.insert(pos, static_cast<uint16_t>(value));
+                    runs = runs + 1 - left - right;
+                    break;
+                }
+                case Kind::BITMAP: {
+                    if (testBit(value)) return false;
+                    const bool left = value > 0 && testBit(value - 1);
+                    const bool right = value + 1 < CHUNK_SIZE && testBit(value + 1);
+                    words[value / 64] |= uint64_t(1) << (value % 64);
+                    runs = runs + 1 - left - right;
+                    break;
+                }
+                case Kind::RUNS: {
+                    // the first run starting after the value, and its predecessor
+                    const uint32_t next = upperRun(value);
+                    if (next > 0 && getLast(next - 1) >= value) return false;
+                    const bool left = next > 0 && getLast(next - 1) + 1 == value;
+                    const bool right = next < runs && getFirst(next) == value + 1;
+                    if (left && right) {
+                        values[2 * (next - 1) + 1] = values[2 * next + 1];
+                        values.erase(values.begin() + 2 * next, values.begin() + 2 * next + 2);
+                        --runs;
+                    } else if (left) {
+                        values[2 * (next - 1) + 1] = static_cast<uint16_t>(value);
+                    } else if (right) {
+                        values[2 * next] = static_cast<uint16_t>(value);
+                    } else {
+                        const uint16_t run[] = {static_cast<uint16_t>(value), static_cast<uint16_t>(value)};
+                        values.insert(values.begin() + 2 * next, run, run + 2);
+                        ++runs;
+                    }
+                    break;
+                }
+            }
+            ++count;
+            adapt();
+            return true;
+        }
+
+        /**
+         * Inserts all values of the given chunk.
+         */
+        void insertAll(const Chunk& other) {
+            if (kind == Kind::ARRAY && other.kind == Kind::ARRAY && count + other.count <= ARRAY_LIMIT) {
+                std::vector<uint16_t> merged;
+                merged.reserve(count + other.count);
+                std::set_union(values.begin(), values.end(), other.values.begin(), other.values.end(),
+                        std::back_inserter(merged));
+                values.swap(merged);
+                count = static_cast<uint32_t>(values.size());
+                runs = 0;
+                for (uint32_t i = 0; i < count; ++i) {
+                    runs += (i == 0 || values[i - 1] + 1u != values[i]);
+                }
+            } else {
+                // otherwise the values are merged within a bitmap
+                convert(Kind::BITMAP);
+                other.forEachRange(
+                        [&](uint32_t first, uint32_t last) { setRange(words.get(), first, last); });
+                count = 0;
+                runs = 0;
+                uint64_t carry = 0;
+                for (uint32_t i = 0; i < WORDS; ++i) {
+                    const uint64_t word = words[i];
+                    count += __builtin_popcountll(word);
+                    runs += __builtin_popcountll(word & ~((word << 1) | carry));
+                    carry = word >> 63;
+                }
+            }
+            adapt();
+        }
+
+        bool contains(uint32_t value) const {
+            switch (kind) {
+                case Kind::ARRAY:
+                    return std::binary_search(values.begin(), values.end(), value);
+                case Kind::BITMAP:
+                    return testBit(value);
+                case Kind::RUNS: {
+                    const uint32_t next = upperRun(value);
+                    return next > 0 && getLast(next - 1) >= value;
+                }
+            }
+            return false;
+        }
+
+        /** the number of values of this chunk */
+        uint32_t size() const {
+            return count;
+        }
+
+        /** the cursor of the least value not less than the given value, END if there is none */
+        uint32_t seek(uint32_t value) const {
+            switch (kind) {
+                case Kind::ARRAY: {
+                    auto pos = std::lower_bound(values.begin(), values.end(), value);
+                    return pos == values.end() ? END : static_cast<uint32_t>(pos - values.begin());
+                }
+                case Kind::BITMAP: {
+                    uint32_t w = value / 64;
+                    if (w >= WORDS) return END;
+                    uint64_t word = words[w] & (~uint64_t(0) << (value % 64));
+                    while (word == 0) {
+                        if (++w == WORDS) return END;
+                        word = words[w];
+                    }
+                    return w * 64 + __builtin_ctzll(word);
+                }
+                case Kind::RUNS: {
+                    // the run containing the value or the first one after it
+                    uint32_t next = upperRun(value);
+                    if (next > 0 && getLast(next - 1) >= value) {
+                        return ((next - 1) << CHUNK_BITS) | value;
+                    }
+                    return next < runs ? (next << CHUNK_BITS) | getFirst(next) : END;
+                }
+            }
+            return END;
+        }
+
+        /** the cursor following the given cursor, END if there is none */
+        uint32_t advance(uint32_t cursor) const {
+            switch (kind) {
+                case Kind::ARRAY:
+                    return cursor + 1 < count ? cursor + 1 : END;
+                case Kind::BITMAP:
+                    return seek(cursor + 1);
+                case Kind::RUNS: {
+                    const uint32_t run = cursor >> CHUNK_BITS;
+                    if ((cursor & CHUNK_MASK) < getLast(run)) return cursor + 1;
+                    return run + 1 < runs ? ((run + 1) << CHUNK_BITS) | getFirst(run + 1) : END;
+                }
+            }
+            return END;
+        }
+
+        /** the value at the given cursor */
+        uint32_t at(uint32_t cursor) const {
+            return kind == Kind::ARRAY ? values[cursor] : cursor & CHUNK_MASK;
+        }
+
+        /**
+         * Applies the given function to all values of this chunk, in ascending order.
+         */
+        template <typename F>
+        void forEach(const F& f) const {
+            switch (kind) {
+                case Kind::ARRAY:
+                    for (uint16_t cur : values) f(cur);
+                    break;
+                case Kind::BITMAP:
+                    for (uint32_t i = 0; i < WORDS; ++i) {
+                        forEachInWord(i * 64, words[i], f);
+                    }
+                    break;
+                case Kind::RUNS:
+                    forEachRange([&](uint32_t first, uint32_t last) {
+                        for (uint32_t cur = first; cur <= last; ++cur) f(cur);
+                    });
+                    break;
+            }
+        }
+
+        /**
+         * Applies the given function to the first and last value of all maximal runs of
+         * consecutive values of this chunk, in ascending order.
+         */
+        template <typename F>
+        void forEachRange(const F& f) const {
+            switch (kind) {
+                case Kind::ARRAY:
+                    for (uint32_t i = 0; i < count;) {
+                        uint32_t j = i;
+                        while (j + 1 < count && values[j] + 1u == values[j + 1]) ++j;
+                        f(values[i], values[j]);
+                        i = j + 1;
+                    }
+                    break;
+                case Kind::BITMAP:
+                    for (uint32_t first = seek(0); first != END;) {
+                        // the run ends before the next cleared bit
+                        uint32_t w = first / 64;
+                        uint64_t rest = ~words[w] & (~uint64_t(0) << (first % 64));
+                        while (rest == 0 && ++w < WORDS) rest = ~words[w];
+                        const uint32_t end = (w == WORDS) ? CHUNK_SIZE : w * 64 + __builtin_ctzll(rest);
+                        f(first, end - 1);
+                        first = seek(end);
+                    }
+                    break;
+                case Kind::RUNS:
+                    for (uint32_t i = 0; i < runs; ++i) {
+                        f(getFirst(i), getLast(i));
+                    }
+                    break;
+            }
+        }
+
+        /**
+         * Applies the given function to all values present in both given chunks, in
+         * ascending order, intersecting their containers directly.
+         */
+        template <typename F>
+        static void forEachCommon(const Chunk& a, const Chunk& b, const F& f) {
+            if (a.kind == Kind::ARRAY && b.kind == Kind::ARRAY) {
+                auto i = a.values.begin();
+                auto j = b.values.begin();
+                while (i != a.values.end() && j != b.values.end()) {
+                    if (*i < *j) {
+                        ++i;
+                    } else if (*j < *i) {
+                        ++j;
+                    } else {
+                        f(*i);
+                        ++i;
+                        ++j;
+                    }
+                }
+            } else if (a.kind == Kind::ARRAY || b.kind == Kind::ARRAY) {
+                // the values of the array are probed in the other container
+                const Chunk& array = (a.kind == Kind::ARRAY) ? a : b;
+                const Chunk& other = (a.kind == Kind::ARRAY) ? b : a;
+                for (uint16_t cur : array.values) {
+                    if (other.contains(cur)) f(cur);
+                }
+            } else if (a.kind == Kind::BITMAP && b.kind == Kind::BITMAP) {
+                for (uint32_t i = 0; i < WORDS; ++i) {
+                    forEachInWord(i * 64, a.words[i] & b.words[i], f);
+                }
+            } else if (a.kind == Kind::RUNS && b.kind == Kind::RUNS) {
+                uint32_t i = 0;
+                uint32_t j = 0;
+                while (i < a.runs && j < b.runs) {
+                    const uint32_t first = std::max(a.getFirst(i), b.getFirst(j));
+                    const uint32_t last = std::min(a.getLast(i), b.getLast(j));
+                    for (uint32_t cur = first; cur <= last; ++cur) f(cur);
+                    (a.getLast(i) < b.getLast(j)) ? ++i : ++j;
+                }
+            } else {
+                // the ranges of the bitmap covered by the runs are scanned
+                const Chunk& list = (a.kind == Kind::RUNS) ? a : b;
+                const Chunk& bitmap = (a.kind == Kind::RUNS) ? b : a;
+                list.forEachRange([&](uint32_t first, uint32_t last) {
+                    for (uint32_t w = first / 64; w <= last / 64; ++w) {
+                        forEachInWord(w * 64, bitmap.words[w] & getRangeMask(w, first, last), f);
+                    }
+                });
+            }
+        }
+
+        std::size_t getMemoryUsage() const {
+            return sizeof(*this) + values.capacity() * sizeof(uint16_t) +
+                   (words ? WORDS * sizeof(uint64_t) : 0);
+        }
+
+    private:
+        // the lock serializing inserts into this chunk
+        SpinLock lock;
+
+        // the container currently storing the values of this chunk
+        Kind kind = Kind::ARRAY;
+
+        // the number of values and maximal runs of consecutive values of this chunk
+        uint32_t count = 0;
+        uint32_t runs = 0;
+
+        // the sorted values of an array, or the first and last values of the runs of a list of runs
+        std::vector<uint16_t> values;
+
+        // the words of a bitmap
+        std::unique_ptr<uint64_t[]> words;
+
+        bool testBit(uint32_t value) const {
+            return ((words[value / 64] >> (value % 64)) & 1) != 0;
+        }
+
+        /** the bits of the given word of a bitmap within the range from first to last */
+        static uint64_t getRangeMask(uint32_t w, uint32_t first, uint32_t last) {
+            uint64_t mask = ~uint64_t(0);
+            if (w == first / 64) mask &= ~uint64_t(0) << (first % 64);
+            if (w == last / 64) mask &= ~uint64_t(0) >> (63 - last % 64);
+            return mask;
+        }
+
+        static void setRange(uint64_t* bitmap, uint32_t first, uint32_t last) {
+            for (uint32_t w = first / 64; w <= last / 64; ++w) {
+                bitmap[w] |= getRangeMask(w, first, last);
+            }
+        }
+
+        uint32_t getFirst(uint32_t run) const {
+            return values[2 * run];
+        }
+
+        uint32_t getLast(uint32_t run) const {
+            return values[2 * run + 1];
+        }
+
+        /** the index of the first run starting after the given value within a list of runs */
+        uint32_t upperRun(uint32_t value) const {
+            uint32_t lo = 0;
+            uint32_t hi = runs;
+            while (lo < hi) {
+                const uint32_t mid = (lo + hi) / 2;
+                if (getFirst(mid) <= value) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+
+        /** the memory occupied by the values of this chunk within the given container */
+        std::size_t getContainerSize(Kind container) const {
+            switch (container) {
+                case Kind::ARRAY:
+                    // an array is not an option beyond its limit
+                    if (count > ARRAY_LIMIT) return std::numeric_limits<std::size_t>::max();
+                    return count * sizeof(uint16_t);
+                case Kind::BITMAP:
+                    return WORDS * sizeof(uint64_t);
+                case Kind::RUNS:
+                    return runs * 2 * sizeof(uint16_t);
+            }
+            return 0;
+        }
+
+        /**
+         * Switches to the most compact container once the current one occupies more than
+         * twice its memory, such that alternating inserts do not keep converting chunks.
+         */
+        void adapt() {
+            Kind best = Kind::BITMAP;
+            for (Kind cur : {Kind::ARRAY, Kind::RUNS}) {
+                if (getContainerSize(cur) < getContainerSize(best)) best = cur;
+            }
+            const std::size_t size = getContainerSize(kind);
+            if (size == std::numeric_limits<std::size_t>::max() || size > 2 * getContainerSize(best)) {
+                convert(best);
+            }
+        }
+
+        /** converts this chunk to the given container */
+        void convert(Kind container) {
+            if (container == kind) return;
+            std::vector<uint16_t> list;
+            std::unique_ptr<uint64_t[]> bitmap;
+            if (container == Kind::BITMAP) {
+                bitmap.reset(new uint64_t[WORDS]());
+            } else {
+                list.reserve(container == Kind::ARRAY ? count : 2 * runs);
+            }
+            forEachRange([&](uint32_t first, uint32_t last) {
+                if (container == Kind::ARRAY) {
+                    for (uint32_t cur = first; cur <= last; ++cur) list.push_back(cur);
+                } else if (container == Kind::RUNS) {
+                    list.push_back(first);
+                    list.push_back(last);
+                } else {
+                    setRange(bitmap.get(), first, last);
+                }
+            });
+            values.swap(list);
+            words.swap(bitmap);
+            kind = container;
+        }
+
+        // applies the given function to the values of the set bits of a word
+        template <typename F>
+        static void forEachInWord(uint32_t base, uint64_t word, const F& f) {
+            while (word != 0) {
+                f(base + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    };
+
+    // the merge operation merging the chunks of two maps
+    struct chunk_merger {
+        Chunk* operator()(Chunk* a, const Chunk* b) const {
+            if (!b) return a;
+            if (!a) return new Chunk(*b);
+            a->insertAll(*b);
+            return a;
+        }
+    };
+
+    // the operation cloning a chunk
+    struct chunk_cloner {
+        Chunk* operator()(Chunk* a) const {
+            if (!a) return a;
+            return new Chunk(*a);
+        }
+    };
+
+    // the type of the internal data store, indexing the chunks by the high bits of their values
+    using data_store_t = SparseArray<Chunk*, BITS, chunk_merger, chunk_cloner>;
+    using atomic_value_t = typename data_store_t::atomic_value_type;
+
+public:
+    // the type to address individual entries
+    using index_type = typename data_store_t::index_type;
+
+private:
+    // it utilizes a sparse map to store its chunks
+    data_store_t store;
+
+public:
+    // a simple default constructor
+    RoaringBitMap() = default;
+
+    // a copy constructor cloning the chunks of the given map
+    RoaringBitMap(const RoaringBitMap&) = default;
+
+    // a default r-value copy constructor
+    RoaringBitMap(RoaringBitMap&&) = default;
+
+    ~RoaringBitMap() {
+        clear();
+    }
+
+    // an assignment operator cloning the chunks of the given map
+    RoaringBitMap& operator=(const RoaringBitMap& other) {
+        if (this == &other) return *this;
+        clear();
+        store = other.store;
+        return *this;
+    }
+
+    // an r-value assignment operator taking over the chunks of the given map
+    RoaringBitMap& operator=(RoaringBitMap&& other) {
+        if (this == &other) return *this;
+        clear();
+        store = std::move(other.store);
+        return *this;
+    }
+
+    // checks whether this bit-map is empty -- thus it does not have any 1-entries
+    bool empty() const {
+        return store.empty();
+    }
+
+    // the type utilized for recording context information for exploiting temporal locality
+    using op_context = typename data_store_t::op_context;
+
+    /**
+     * Sets the bit addressed by i to 1.
+     */
+    bool set(index_type i) {
+        op_context ctxt;
+        return set(i, ctxt);
+    }
+
+    /**
+     * Sets the bit addressed by i to 1. A context for exploiting temporal locality
+     * can be provided.
+     */
+    bool set(index_type i, op_context& ctxt) {
+        atomic_value_t& slot = store.getAtomic(i >> CHUNK_BITS, ctxt);
+        Chunk* chunk = slot.load(std::memory_order_acquire);
+
+        // conduct a lock-free lazy-creation of the chunk
+        if (!chunk) {
+            auto fresh = new Chunk();
+            if (slot.compare_exchange_strong(chunk, fresh)) {
+                chunk = fresh;
+            } else {
+                delete fresh;  // some other thread was faster => use its version
+            }
+        }
+        return chunk->insert(i & CHUNK_MASK);
+    }
+
+    /**
+     * Determines the whether the bit addressed by i is set or not.
+     */
+    bool test(index_type i) const {
+        op_context ctxt;
+        return test(i, ctxt);
+    }
+
+    /**
+     * Determines the whether the bit addressed by i is set or not. A context for
+     * exploiting temporal locality can be provided.
+     */
+    bool test(index_type i, op_context& ctxt) const {
+        const Chunk* chunk = store.lookup(i >> CHUNK_BITS, ctxt);
+        return chunk && chunk->contains(i & CHUNK_MASK);
+    }
+
+    /**
+     * Determines the whether the bit addressed by i is set or not.
+     */
+    bool operator[](index_type i) const {
+        return test(i);
+    }
+
+    /**
+     * Resets all contained bits to 0.
+     */
+    void clear() {
+        for (auto& cur : store) {
+            delete cur.second;
+        }
+        store.clear();
+    }
+
+    /**
+     * Determines the number of bits set.
+     */
+    std::size_t size() const {
+        std::size_t res = 0;
+        for (const auto& cur : store) {
+            res += cur.second->size();
+        }
+        return res;
+    }
+
+    /**
+     * Computes the total memory usage of this data structure.
+     */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this) - sizeof(data_store_t) + store.getMemoryUsage();
+        for (const auto& cur : store) {
+            res += cur.second->getMemoryUsage();
+        }
+        return res;
+    }
+
+    /**
+     * Sets all bits set in other to 1 within this bit map.
+     */
+    void addAll(const RoaringBitMap& other) {
+        // nothing to do if it is a self-assignment
+        if (this == &other) return;
+
+        // merge the chunks
+        store.addAll(other.store);
+    }
+
+    // ---------------------------------------------------------------------
+    //                         Bulk Iteration
+    // ---------------------------------------------------------------------
+
+    /**
+     * Applies the given function to all indices set to 1, in ascending order.
+     */
+    template <typename F>
+    void forEach(const F& f) const {
+        for (const auto& cur : store) {
+            const index_type base = cur.first << CHUNK_BITS;
+            cur.second->forEach([&](uint32_t value) { f(base | value); });
+        }
+    }
+
+    /**
+     * Applies the given function to all maximal runs of consecutive indices set
+     * to 1, in ascending order. The function is called with the first index and
+     * the length of each run; runs spanning several chunks are reported once.
+     */
+    template <typename F>
+    void forEachRun(const F& f) const {
+        index_type first = 0;
+        index_type length = 0;
+        for (const auto& cur : store) {
+            const index_type base = cur.first << CHUNK_BITS;
+            cur.second->forEachRange([&](uint32_t from, uint32_t to) {
+                if (length > 0 && first + length == base + from) {
+                    length += to - from + 1;
+                } else {
+                    if (length > 0) f(first, length);
+                    first = base + from;
+                    length = to - from + 1;
+                }
+            });
+        }
+        if (length > 0) f(first, length);
+    }
+
+    /**
+     * Applies the given function to all indices set to 1 in both this and the
+     * given bit map, in ascending order. The maps are intersected a chunk at a
+     * time, skipping the chunks missing in either map by lower-bound searches.
+     */
+    template <typename F>
+    void forEachCommon(const RoaringBitMap& other, const F& f) const {
+        auto a = store.begin();
+        auto b = other.store.begin();
+        while (!a.isEnd() && !b.isEnd()) {
+            if (a->first < b->first) {
+                a = store.lowerBound(b->first);
+            } else if (b->first < a->first) {
+                b = other.store.lowerBound(a->first);
+            } else {
+                const index_type base = a->first << CHUNK_BITS;
+                Chunk::forEachCommon(*a->second, *b->second, [&](uint32_t value) { f(base | value); });
+                ++a;
+                ++b;
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    //                           Iterator
+    // ---------------------------------------------------------------------
+
+    /**
+     * An iterator iterating over all indices set to 1.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, index_type> {
+        using nested_iterator = typename data_store_t::iterator;
+
+        // the iterator through the chunks
+        nested_iterator iter;
+
+        // the cursor within the current chunk
+        uint32_t cursor = 0;
+
+        // the value currently pointed to
+        index_type value{};
+
+    public:
+        // default constructor -- creating an end-iterator
+        iterator() = default;
+
+        iterator(const nested_iterator& iter) : iterator(iter, iter->second->seek(0)) {}
+
+        iterator(const nested_iterator& iter, uint32_t cursor)
+                : iter(iter), cursor(cursor), value((iter->first << CHUNK_BITS) | iter->second->at(cursor)) {}
+
+        // a copy constructor
+        iterator(const iterator& other) = default;
+
+        // an assignment operator
+        iterator& operator=(const iterator& other) = default;
+
+        // the equality operator as required by the iterator concept
+        bool operator==(const iterator& other) const {
+            return iter == other.iter && cursor == other.cursor;
+        }
+
+        // the not-equality operator as required by the iterator concept
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        // the deref operator as required by the iterator concept
+        const index_type& operator*() const {
+            return value;
+        }
+
+        // support for the pointer operator
+        const index_type* operator->() const {
+            return &value;
+        }
+
+        // the increment operator as required by the iterator concept
+        iterator& operator++() {
+            // progress in the current chunk
+            cursor = iter->second->advance(cursor);
+            if (cursor != Chunk::END) {
+                value = (value & ~CHUNK_MASK) | iter->second->at(cursor);
+                return *this;
+            }
+
+            // go to the next chunk
+            ++iter;
+            if (iter.isEnd()) {
+                cursor = 0;
+                return *this;
+            }
+            cursor = iter->second->seek(0);
+            value = (iter->first << CHUNK_BITS) | iter->second->at(cursor);
+            return *this;
+        }
+
+        bool isEnd() const {
+            return iter.isEnd();
+        }
+
+        void print(std::ostream& out) const {
+            out << "RoaringBitMapIter(" << iter << " -> " << cursor << " @ " << value << ")";
+        }
+
+        // enables this iterator core to be printed (for debugging)
+        friend std::ostream& operator<<(std::ostream& out, const iterator& iter) {
+            iter.print(out);
+            return out;
+        }
+    };
+
+    /**
+     * Obtains an iterator pointing to the first index set to 1. If there
+     * is no such bit, end() will be returned.
+     */
+    iterator begin() const {
+        auto it = store.begin();
+        if (it.isEnd()) return end();
+        return iterator(it);
+    }
+
+    /**
+     * Returns an iterator referencing the position after the last set bit.
+     */
+    iterator end() const {
+        return iterator();
+    }
+
+    /**
+     * Obtains an iterator referencing the position i if the corresponding
+     * bit is set, end() otherwise.
+     */
+    iterator find(index_type i) const {
+        op_context ctxt;
+        return find(i, ctxt);
+    }
+
+    /**
+     * Obtains an iterator referencing the position i if the corresponding
+     * bit is set, end() otherwise. An operation context can be provided
+     * to exploit temporal locality.
+     */
+    iterator find(index_type i, op_context& ctxt) const {
+        auto it = store.find(i >> CHUNK_BITS, ctxt);
+        if (it.isEnd()) return end();
+        auto cursor = it->second->seek(i & CHUNK_MASK);
+        if (cursor == Chunk::END || it->second->at(cursor) != (i & CHUNK_MASK)) return end();
+        return iterator(it, cursor);
+    }
+
+    /**
+     * Locates an iterator to the first element in this bit map not less
+     * than the given index.
+     */
+    iterator lower_bound(index_type i) const {
+        auto it = store.lowerBound(i >> CHUNK_BITS);
+        if (it.isEnd()) return end();
+
+        // a subsequent chunk starts with its first value
+        if (it->first != (i >> CHUNK_BITS)) return iterator(it);
+        auto cursor = it->second->seek(i & CHUNK_MASK);
+        if (cursor != Chunk::END) return iterator(it, cursor);
+
+        // there is no value left in this chunk, use the next one
+        ++it;
+        if (it.isEnd()) return end();
+        return iterator(it);
+    }
+
+    /**
+     * A debugging utility printing the internal structure of this map to the
+     * given output stream.
+     */
+    void dump(bool detail = false, std::ostream& out = std::cout) const {
+        store.dump(detail, out);
+    }
+
+    /**
+     * Provides write-protected access to the internal store for running
+     * analysis on the data structure.
+     */
+    const data_store_t& getStore() const {
+        return store;
+    }
+};
+
 // ---------------------------------------------------------------------
 //                              TRIE
 // ---------------------------------------------------------------------
@@ -1801,6 +2736,16 @@ public:
      */
     using entry_type = typename ram::Tuple<RamDomain, Dim>;
 
+    TrieBase() = default;
+
+    // copies start with fresh hint statistics
+    TrieBase(const TrieBase& other) : numEntries(other.numEntries.load(std::memory_order_relaxed)) {}
+
+    TrieBase& operator=(const TrieBase& other) {
+        numEntries.store(other.numEntries.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
     // -- operation wrappers --
 
     /**
@@ -1921,6 +2866,38 @@ protected:
     // the hint statistic of this b-tree instance
     mutable hint_statistics hint_stats;
 
+    // the marker of an unknown number of entries, which are recounted by the next size query
+    static constexpr std::size_t unknownSize = std::numeric_limits<std::size_t>::max();
+
+    // the number of entries, maintained by the operations on this trie such that size queries are
+    // cheap; nested tries are modified through their parents and recounted instead
+    mutable std::atomic<std::size_t> numEntries{0};
+
+    // counts a new entry inserted into this trie, concurrently with other insertions
+    void countInsert() {
+        if (numEntries.load(std::memory_order_relaxed) != unknownSize) {
+            numEntries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // accounts for merging the entries of another trie, whose number is only known if this trie is empty
+    void mergeCount(const TrieBase& other) {
+        numEntries.store(static_cast<const Derived&>(*this).empty()
+                                 ? other.numEntries.load(std::memory_order_relaxed)
+                                 : unknownSize,
+                std::memory_order_relaxed);
+    }
+
+    // the number of entries, recounting them if unknown
+    std::size_t countedSize() const {
+        std::size_t res = numEntries.load(std::memory_order_relaxed);
+        if (res == unknownSize) {
+            res = static_cast<const Derived&>(*this).countEntries();
+            numEntries.store(res, std::memory_order_relaxed);
+        }
+        return res;
+    }
+
 public:
     // Obtains a reference to the internally maintained hint statistics
     const hint_statistics& getHintStatistics() const {
@@ -1954,8 +2931,8 @@ struct get_nested_iter_core<0> {
  */
 template <unsigned Pos, unsigned Dim>
 struct fix_first {
-    template <unsigned bits, typename iterator>
-    void operator()(const SparseBitMap<bits>& store, iterator& iter) const {
+    template <template <unsigned> class BitMap, unsigned bits, typename iterator>
+    void operator()(const BitMap<bits>& store, iterator& iter) const {
         // set iterator to first in store
         auto first = store.begin();
         get_nested_iter_core<Pos>()(iter.iter_core).setIterator(first);
@@ -1987,9 +2964,9 @@ struct fix_first<Dim, Dim> {
  */
 template <unsigned Len, unsigned Pos, unsigned Dim>
 struct fix_binding {
-    template <unsigned bits, typename iterator, typename entry_type>
+    template <template <unsigned> class BitMap, unsigned bits, typename iterator, typename entry_type>
     bool operator()(
-            const SparseBitMap<bits>& store, iterator& begin, iterator& end, const entry_type& entry) const {
+            const BitMap<bits>& store, iterator& begin, iterator& end, const entry_type& entry) const {
         // search in current level
         auto cur = store.find(entry[Pos]);
 
@@ -2041,9 +3018,9 @@ struct fix_binding {
 
 template <unsigned Pos, unsigned Dim>
 struct fix_binding<0, Pos, Dim> {
-    template <unsigned bits, typename iterator, typename entry_type>
+    template <template <unsigned> class BitMap, unsigned bits, typename iterator, typename entry_type>
     bool operator()(
-            const SparseBitMap<bits>& store, iterator& begin, iterator& end, const entry_type& entry) const {
+            const BitMap<bits>& store, iterator& begin, iterator& end, const entry_type& entry) const {
         // move begin to begin of store
         auto a = store.begin();
         get_nested_iter_core<Pos>()(begin.iter_core).setIterator(a);
@@ -2080,8 +3057,8 @@ struct fix_binding<0, Dim, Dim> {
  */
 template <unsigned Pos, unsigned Dim>
 struct fix_lower_bound {
-    template <unsigned bits, typename iterator, typename entry_type>
-    bool operator()(const SparseBitMap<bits>& store, iterator& iter, const entry_type& entry) const {
+    template <template <unsigned> class BitMap, unsigned bits, typename iterator, typename entry_type>
+    bool operator()(const BitMap<bits>& store, iterator& iter, const entry_type& entry) const {
         // search in current level
         auto cur = store.lower_bound(entry[Pos]);
 
@@ -2311,10 +3288,16 @@ public:
      * Determines the number of entries in this trie.
      */
     std::size_t size() const {
-        // the number of elements is lazy-evaluated
+        return base::countedSize();
+    }
+
+    /**
+     * Counts the entries in this trie by traversing it.
+     */
+    std::size_t countEntries() const {
         std::size_t res = 0;
         for (const auto& cur : store) {
-            res += cur.second->size();
+            res += cur.second->countEntries();
         }
         return res;
     }
@@ -2346,6 +3329,7 @@ public:
 
         // clear store
         store.clear();
+        base::numEntries.store(0, std::memory_order_relaxed);
     }
 
     /**
@@ -2368,7 +3352,11 @@ public:
      * @return true if the same tuple hasn't been present before, false otherwise
      */
     bool insert(const entry_type& tuple, op_context& ctxt) {
-        return insert_internal<0>(tuple, ctxt);
+        if (!insert_internal<0>(tuple, ctxt)) {
+            return false;
+        }
+        base::countInsert();
+        return true;
     }
 
     /**
@@ -2402,6 +3390,7 @@ public:
      * @param other the elements to be inserted into this trie
      */
     void insertAll(const Trie& other) {
+        base::mergeCount(other);
         store.addAll(other.store);
     }
 
@@ -2900,7 +3889,7 @@ private:
  * A template specialization for tries containing tuples exhibiting a single
  * element. For improved memory efficiency, this level is the leaf-node level
  * of all tires exhibiting an arity >= 1. Internally, values are stored utilizing
- * sparse bit maps.
+ * roaring bit maps.
  */
 template <>
 class Trie<1u> : public detail::TrieBase<1u, Trie<1u>> {
@@ -2914,7 +3903,7 @@ class Trie<1u> : public detail::TrieBase<1u, Trie<1u>> {
     using base = typename detail::TrieBase<1u, Trie<1u>>;
 
     // the map type utilized internally
-    using map_type = SparseBitMap<>;
+    using map_type = RoaringBitMap<>;
 
     // the internal data store
     map_type map;
@@ -2938,6 +3927,13 @@ public:
      * Determines the number of elements stored in this trie.
      */
     std::size_t size() const {
+        return base::countedSize();
+    }
+
+    /**
+     * Counts the elements stored in this trie by traversing its bit map.
+     */
+    std::size_t countEntries() const {
         return map.size();
     }
 
@@ -2954,6 +3950,7 @@ public:
      */
     void clear() {
         map.clear();
+        base::numEntries.store(0, std::memory_order_relaxed);
     }
 
     /**
@@ -2976,7 +3973,11 @@ public:
      * @return true if the tuple has not been present before, false otherwise
      */
     bool insert(const entry_type& tuple, op_context& ctxt) {
-        return insert_internal<0>(tuple, ctxt);
+        if (!insert_internal<0>(tuple, ctxt)) {
+            return false;
+        }
+        base::countInsert();
+        return true;
     }
 
     /**
@@ -3008,9 +4009,31 @@ public:
      * insertion of the elements in other into this trie.
      */
     void insertAll(const Trie& other) {
+        base::mergeCount(other);
         map.addAll(other.map);
     }
 
+    /**
+     * Applies the given function to all maximal runs of consecutive values stored
+     * in this trie, in the order of its iterator, passing the first value and the length of
+     * each run. Dense tries are thereby scanned a run at a time.
+     */
+    template <typename F>
+    void forEachRun(const F& f) const {
+        map.forEachRun([&](map_type::index_type first, map_type::index_type length) {
+            f(static_cast<RamDomain>(first), static_cast<std::size_t>(length));
+        });
+    }
+
+    /**
+     * Applies the given function to all values stored in both this and the given
+     * trie, in the order of their iterators, intersecting the containers of both tries.
+     */
+    template <typename F>
+    void forEachCommon(const Trie& other, const F& f) const {
+        map.forEachCommon(other.map, [&](map_type::index_type value) { f(static_cast<RamDomain>(value)); });
+    }
+
     // ---------------------------------------------------------------------
     //                           Iterator
     // ---------------------------------------------------------------------
@@ -0,0 +1,80 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file CheckpointFormat.h
+ *
+ * Layout of the checkpoint files written by SouffleProgram::checkpoint.
+ *
+ * A checkpoint file consists of
+ *   - a CheckpointHeader,
+ *   - the symbol table: for each symbol in index order its length
+ *     (uint64_t) followed by its characters,
+ *   - the record table: for each arity the arity and the number of records
+ *     (uint64_t each) followed by the records in reference order,
+ *   - the relations: for each relation the length of its name (uint64_t),
+ *     its name, its arity and number of tuples (uint64_t each) followed by
+ *     its tuples in row-major order.
+ *
+ * Every item starts at an offset that is a multiple of 8 bytes, hence the
+ * records and tuples of a mapped file can be used in place. Values are
+ * stored in the byte order of the machine writing the file.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <cstdint>
+#include <cstring>
+
+namespace souffle {
+
+struct CheckpointHeader {
+    /** The magic string identifying checkpoint files */
+    static constexpr char MAGIC[8] = {'S', 'O', 'U', 'F', 'F', 'L', 'E', 'C'};
+
+    /** The version of the file format */
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t domainSize;
+    uint64_t completedStrata;
+    uint64_t numSymbols;
+    uint64_t numRecordArities;
+    uint64_t numRelations;
+
+    /** Create a header for the current format and domain size */
+    static CheckpointHeader create(
+            uint64_t completedStrata, uint64_t numSymbols, uint64_t numRecordArities, uint64_t numRelations) {
+        CheckpointHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.domainSize = sizeof(RamDomain);
+        header.completedStrata = completedStrata;
+        header.numSymbols = numSymbols;
+        header.numRecordArities = numRecordArities;
+        header.numRelations = numRelations;
+        return header;
+    }
+
+    /** Check whether this header describes a file readable by this build */
+    bool isValid() const {
+        return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && version == VERSION &&
+               domainSize == sizeof(RamDomain);
+    }
+};
+
+/** Round the given offset up to the alignment of the items of a checkpoint */
+inline uint64_t alignCheckpointOffset(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+}  // namespace souffle
@@ -25,6 +25,7 @@
 #include "RamTypes.h"
 #include "Util.h"
 #include <cassert>
+#include <cstdint>
 #include <iterator>
 #include <ostream>
 #include <string>
@@ -85,6 +86,9 @@ struct comparator;
 
 template <unsigned First, unsigned... Rest>
 struct comparator<First, Rest...> {
+    // the column ordering tuples primarily, utilised by column wise searches
+    static constexpr unsigned leading_column = First;
+
     template <typename T>
     int operator()(const T& a, const T& b) const {
         return (a[First] < b[First]) ? -1 : ((a[First] > b[First]) ? 1 : comparator<Rest...>()(a, b));
@@ -115,6 +119,84 @@ struct comparator<> {
     }
 };
 
+// -------- packed-key tuple comparator ----------
+
+/** The unsigned integer type of packed keys of the given number of bits, if there is one */
+template <size_t Bits, typename = void>
+struct packed_key {
+    static constexpr bool available = false;
+};
+
+template <size_t Bits>
+struct packed_key<Bits, std::enable_if_t<(Bits <= 64)>> {
+    static constexpr bool available = true;
+    using type = uint64_t;
+};
+
+/**
+ * Orders tuples like comparator<Columns...>, by encoding the key columns of a tuple in the
+ * order of the index into a single unsigned integer and comparing the encodings without
+ * branches. The sign bit of each column is flipped, hence the unsigned order of encodings
+ * agrees with the lexicographic order of the signed columns.
+ */
+template <typename Key, unsigned... Columns>
+struct packed_key_comparator {
+    using key_type = Key;
+
+    static constexpr unsigned columns[] = {Columns...};
+    static constexpr unsigned leading_column = columns[0];
+
+    template <typename T>
+    static Key encode(const T& t) {
+        constexpr RamUnsigned sign = RamUnsigned(1) << (RAM_DOMAIN_SIZE - 1);
+        Key key = 0;
+        for (unsigned column : columns) {
+            const RamUnsigned value = ramBitCast<RamUnsigned>(static_cast<RamDomain>(t[column]));
+            key = (key << RAM_DOMAIN_SIZE) | (value ^ sign);
+        }
+        return key;
+    }
+
+    template <typename T>
+    int operator()(const T& a, const T& b) const {
+        const Key ka = encode(a);
+        const Key kb = encode(b);
+        return int(ka > kb) - int(ka < kb);
+    }
+    template <typename T>
+    bool less(const T& a, const T& b) const {
+        return encode(a) < encode(b);
+    }
+    template <typename T>
+    bool equal(const T& a, const T& b) const {
+        return encode(a) == encode(b);
+    }
+};
+
+template <unsigned... Columns>
+struct is_packable {
+    static constexpr bool value =
+            sizeof...(Columns) >= 2 && packed_key<RAM_DOMAIN_SIZE * sizeof...(Columns)>::available;
+};
+
+template <bool Packed, unsigned... Columns>
+struct select_packed_comparator {
+    using type = comparator<Columns...>;
+};
+
+template <unsigned... Columns>
+struct select_packed_comparator<true, Columns...> {
+    using type = packed_key_comparator<typename packed_key<RAM_DOMAIN_SIZE * sizeof...(Columns)>::type,
+            Columns...>;
+};
+
+/**
+ * The comparator of indexes over several columns whose key fits into 64 bits; wider keys
+ * are compared column by column, as encoding them costs more than the branches it saves.
+ */
+template <unsigned... Columns>
+using packed_comparator = typename select_packed_comparator<is_packable<Columns...>::value, Columns...>::type;
+
 // ----- a comparator wrapper dereferencing pointers ----------
 //         (required for handling indirect indices)
 
@@ -16,18 +16,28 @@
 
 #pragma once
 
+#include "souffle/BloomFilter.h"
 #include "souffle/Brie.h"
 #include "souffle/CompiledIndexUtils.h"
 #include "souffle/CompiledTuple.h"
+#include "souffle/DenseSet.h"
+#include "souffle/HashGroupTable.h"
+#include "souffle/HashJoinTable.h"
+#include "souffle/HashSet.h"
+#include "souffle/KeyIndex.h"
+#include "souffle/LatticeSet.h"
 #include "souffle/IODirectives.h"
 #include "souffle/IOSystem.h"
 #include "souffle/ParallelUtils.h"
 #include "souffle/RamTypes.h"
+#include "souffle/ReadStream.h"
 #include "souffle/RecordTable.h"
+#include "souffle/RegexCache.h"
 #include "souffle/SignalHandler.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/Table.h"
+#include "souffle/ThreadBinding.h"
 #include "souffle/Util.h"
 #include "souffle/WriteStream.h"
 #ifndef __EMBEDDED_SOUFFLE__
@@ -44,8 +54,10 @@
 #include <exception>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -61,13 +73,159 @@ inline souffle::SouffleProgram* getInstance(const char* p) {
 }
 }
 
+namespace detail {
+/**
+ * A type trait to check whether a relation supports looking up the tuples with given values in some
+ * of their columns, which the generated relations providing searches do.
+ */
+template <typename T, typename Tuple, typename filter = void>
+struct has_scan_equal_range : public std::false_type {};
+
+template <typename T, typename Tuple>
+struct has_scan_equal_range<T, Tuple,
+        typename std::conditional<false,
+                decltype(std::declval<const T&>().scanEqualRange(SearchSignature(),
+                        std::declval<const Tuple&>(), std::declval<void (*)(const Tuple&)>())),
+                void>::type> : public std::true_type {};
+}  // namespace detail
+
+/**
+ * A relation of the generated program that is only constructed once it is accessed, such that
+ * programs with many relations, most of them empty for a given input, start quickly. Emptiness
+ * and size are answered without constructing the relation. Copies share the relation, e.g. the
+ * base relations of the forks of a program, until one of them is modified through mutate() or
+ * purged, which copies the tuples of the shared relation or drops the share for that holder only.
+ */
+template <class RelType>
+class LazyRelation {
+public:
+    LazyRelation() = default;
+
+    LazyRelation(const LazyRelation& other) : relation(other.share()) {
+        allocated = relation.get();
+    }
+
+    LazyRelation& operator=(const LazyRelation&) = delete;
+
+    /** whether the relation has been constructed */
+    bool isAllocated() const {
+        return allocated.load(std::memory_order_acquire) != nullptr;
+    }
+
+    RelType* operator->() const {
+        return &get();
+    }
+
+    RelType& operator*() const {
+        return get();
+    }
+
+    bool empty() const {
+        RelType* rel = allocated.load(std::memory_order_acquire);
+        return rel == nullptr || rel->empty();
+    }
+
+    std::size_t size() const {
+        RelType* rel = allocated.load(std::memory_order_acquire);
+        return rel == nullptr ? 0 : rel->size();
+    }
+
+    void purge() {
+        std::lock_guard<std::mutex> guard(allocation);
+        if (relation.use_count() > 1) {
+            // other holders keep the tuples of the shared relation
+            relation.reset();
+            allocated.store(nullptr, std::memory_order_release);
+        } else if (relation) {
+            relation->purge();
+        }
+    }
+
+    /**
+     * Get the relation for modifying it, copying the tuples of a relation shared with other holders
+     * first, such that they do not observe the modification. Not concurrently with other accesses of
+     * this holder.
+     */
+    RelType& mutate() {
+        std::lock_guard<std::mutex> guard(allocation);
+        if (!relation) {
+            relation = std::make_shared<RelType>();
+        } else if (relation.use_count() > 1) {
+            auto copy = std::make_shared<RelType>();
+            auto ctxt = copy->createContext();
+            for (const auto& cur : *relation) {
+                copy->insert(cur, ctxt);
+            }
+            relation = std::move(copy);
+        }
+        allocated.store(relation.get(), std::memory_order_release);
+        return *relation;
+    }
+
+    /** share the relation with the holders of other programs, e.g. of a program reloaded from this one */
+    std::shared_ptr<RelType> shared() const {
+        return share();
+    }
+
+    /** hold the given relation instead of the own one; not concurrently with other accesses */
+    void adopt(std::shared_ptr<RelType> other) {
+        relation = std::move(other);
+        allocated = relation.get();
+    }
+
+    /** exchange the relations of two holders; not concurrently with other accesses of them */
+    void swap(LazyRelation& other) {
+        relation.swap(other.relation);
+        allocated = relation.get();
+        other.allocated = other.relation.get();
+    }
+
+private:
+    mutable std::shared_ptr<RelType> relation;
+    mutable std::atomic<RelType*> allocated{nullptr};
+    mutable std::mutex allocation;
+
+    RelType& get() const {
+        RelType* rel = allocated.load(std::memory_order_acquire);
+        if (rel == nullptr) {
+            rel = share().get();
+        }
+        return *rel;
+    }
+
+    std::shared_ptr<RelType> share() const {
+        std::lock_guard<std::mutex> guard(allocation);
+        if (!relation) {
+            relation = std::make_shared<RelType>();
+            allocated.store(relation.get(), std::memory_order_release);
+        }
+        return relation;
+    }
+};
+
+/**
+ * Insert the facts of a relation which the generated program embeds as a static array, storing the
+ * tuples one after the other.
+ */
+template <std::size_t Arity, class RelType>
+void insertFacts(RelType& rel, const RamDomain* facts, std::size_t numFacts) {
+    auto ctxt = rel.createContext();
+    ram::Tuple<RamDomain, Arity> tuple;
+    for (std::size_t i = 0; i < numFacts; ++i) {
+        for (std::size_t j = 0; j < Arity; ++j) {
+            tuple[j] = facts[i * Arity + j];
+        }
+        rel.insert(tuple, ctxt);
+    }
+}
+
 /**
  * Relation wrapper used internally in the generated Datalog program
  */
 template <uint32_t id, class RelType, class TupleType, size_t Arity, size_t NumAuxAttributes>
 class RelationWrapper : public souffle::Relation {
 private:
-    RelType& relation;
+    LazyRelation<RelType>& relation;
     SymbolTable& symTable;
     std::string name;
     std::array<const char*, Arity> tupleType;
@@ -103,14 +261,14 @@ private:
     };
 
 public:
-    RelationWrapper(RelType& r, SymbolTable& s, std::string name, const std::array<const char*, Arity>& t,
-            const std::array<const char*, Arity>& n)
+    RelationWrapper(LazyRelation<RelType>& r, SymbolTable& s, std::string name,
+            const std::array<const char*, Arity>& t, const std::array<const char*, Arity>& n)
             : relation(r), symTable(s), name(std::move(name)), tupleType(t), tupleName(n) {}
     iterator begin() const override {
-        return iterator(new iterator_wrapper(id, this, relation.begin()));
+        return iterator(new iterator_wrapper(id, this, relation->begin()));
     }
     iterator end() const override {
-        return iterator(new iterator_wrapper(id, this, relation.end()));
+        return iterator(new iterator_wrapper(id, this, relation->end()));
     }
     void insert(const tuple& arg) override {
         TupleType t;
@@ -119,7 +277,75 @@ public:
         for (size_t i = 0; i < Arity; i++) {
             t[i] = arg[i];
         }
-        relation.insert(t);
+        relation.mutate().insert(t);
+        modified();
+    }
+    void insertBatch(const RamDomain* data, std::size_t numTuples) override {
+        RelType& rel = relation.mutate();
+        if constexpr (detail::has_insert_bulk<RelType>::value) {
+            rel.insertBulk(data, numTuples, Arity);
+        } else {
+            typename RelType::context h;
+            TupleType t;
+            for (size_t i = 0; i < numTuples; i++) {
+                for (size_t j = 0; j < Arity; j++) {
+                    t[j] = data[i * Arity + j];
+                }
+                rel.insert(t, h);
+            }
+        }
+        modified();
+    }
+    void scanBatches(const std::function<void(const RamDomain*, std::size_t)>& callback,
+            std::size_t batchSize) const override {
+        assert(batchSize > 0 && "empty batches");
+        std::vector<RamDomain> buffer(batchSize * Arity);
+        std::size_t count = 0;
+        if (!relation.isAllocated()) {
+            return;
+        }
+        for (const auto& cur : *relation) {
+            for (size_t j = 0; j < Arity; j++) {
+                buffer[count * Arity + j] = cur[j];
+            }
+            if (++count == batchSize) {
+                callback(buffer.data(), count);
+                count = 0;
+            }
+        }
+        if (count > 0) {
+            callback(buffer.data(), count);
+        }
+    }
+    void equalRange(const std::vector<std::size_t>& columns, const std::vector<RamDomain>& values,
+            const std::function<void(const tuple&)>& callback) const override {
+        if constexpr (detail::has_scan_equal_range<RelType, TupleType>::value) {
+            assert(columns.size() == values.size() && "mismatching columns and values");
+            TupleType pattern{};
+            SearchSignature bound = 0;
+            for (size_t i = 0; i < columns.size(); i++) {
+                assert(columns[i] < Arity && "attribute out of bound");
+                const SearchSignature column = SearchSignature(1) << columns[i];
+                if ((bound & column) != 0 && pattern[columns[i]] != values[i]) {
+                    // a column bound to two different values matches nothing
+                    return;
+                }
+                pattern[columns[i]] = values[i];
+                bound |= column;
+            }
+            if (!relation.isAllocated()) {
+                return;
+            }
+            tuple t(this);
+            relation->scanEqualRange(bound, pattern, [&](const TupleType& cur) {
+                for (size_t i = 0; i < Arity; i++) {
+                    t[i] = cur[i];
+                }
+                callback(t);
+            });
+        } else {
+            Relation::equalRange(columns, values, callback);
+        }
     }
     bool contains(const tuple& arg) const override {
         TupleType t;
@@ -127,7 +353,7 @@ public:
         for (size_t i = 0; i < Arity; i++) {
             t[i] = arg[i];
         }
-        return relation.contains(t);
+        return relation.isAllocated() && relation->contains(t);
     }
     std::size_t size() const override {
         return relation.size();
@@ -156,6 +382,26 @@ public:
     /** Eliminate all the tuples in relation*/
     void purge() override {
         relation.purge();
+        modified();
+    }
+
+    /** The data structures of relations are named by their mangled types */
+    std::string getDataType() const override {
+        return typeid(RelType).name();
+    }
+
+    std::shared_ptr<void> shareData() const override {
+        return relation.shared();
+    }
+
+    bool adoptData(const Relation& other) override {
+        std::shared_ptr<void> data = other.getDataType() == getDataType() ? other.shareData() : nullptr;
+        if (data == nullptr) {
+            return false;
+        }
+        relation.adopt(std::static_pointer_cast<RelType>(data));
+        modified();
+        return true;
     }
 };
 
@@ -211,6 +457,9 @@ public:
     void insert(const RamDomain* ramDomain) {
         data = true;
     }
+    void insert(const RamDomain* ramDomain, context& /* ctxt */) {
+        data = true;
+    }
     bool insert() {
         bool result = data;
         data = true;
@@ -232,6 +481,10 @@ public:
         data = false;
     }
     void printHintStatistics(std::ostream& o, std::string prefix) const {}
+    void logHintStatistics(const std::string& prefix) const {}
+    std::vector<std::size_t> getMemoryUsage() const {
+        return {sizeof(*this)};
+    }
 };
 
 /** info relations */
@@ -317,6 +570,10 @@ public:
         data.clear();
     }
     void printHintStatistics(std::ostream& o, std::string prefix) const {}
+    void logHintStatistics(const std::string& prefix) const {}
+    std::vector<std::size_t> getMemoryUsage() const {
+        return {sizeof(*this) + data.capacity() * sizeof(t_tuple)};
+    }
 };
 
 }  // namespace souffle
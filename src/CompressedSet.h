@@ -0,0 +1,368 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file CompressedSet.h
+ *
+ * This header file contains the implementation of a compressed, ordered
+ * set of tuples, intended for large relations that are loaded once and
+ * only read afterwards.
+ *
+ * The sorted elements are split into blocks of a fixed number of tuples.
+ * Within a block, the first column is stored as the differences of
+ * consecutive values, while all other columns are stored relative to the
+ * minimum value of the column in the block. Each column of a block is
+ * bit-packed with the width of its largest stored value. The first tuple
+ * of each block is kept uncompressed, forming a sparse index that is
+ * binary searched to locate the block of a key.
+ *
+ * The set is immutable between bulk inserts, which rebuild the blocks.
+ * Hence, all reading operations may be conducted concurrently.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include "Util.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A compressed, ordered set of tuples supporting bulk inserts and lookups.
+ *
+ * @tparam T the type of the elements, a tuple of RamDomain values ordered lexicographically
+ */
+template <typename T>
+class CompressedSet {
+    static constexpr std::size_t Arity = T::arity;
+
+    // the number of tuples of a block
+    static constexpr uint32_t BLOCK_SIZE = 128;
+
+    // the number of bits of a stored value
+    static constexpr unsigned VALUE_BITS = sizeof(RamUnsigned) * 8;
+
+    // a block of consecutive elements
+    struct Block {
+        // the first tuple of the block, also the key of the sparse index
+        T first;
+
+        // the number of elements in this block
+        uint32_t count;
+
+        // the minimum value of each column, unused for the first column
+        std::array<RamUnsigned, Arity> base;
+
+        // the number of bits of each value of a column
+        std::array<uint8_t, Arity> width;
+
+        // the position of the first bit of each column in the packed words
+        std::array<std::size_t, Arity> offset;
+    };
+
+    // the blocks in the order of their elements
+    std::vector<Block> blocks;
+
+    // the bit-packed columns of all blocks
+    std::vector<uint64_t> words;
+
+    // the number of elements in this set
+    std::size_t numElements = 0;
+
+public:
+    using element_type = T;
+
+    // compressed sets do not utilise operation hints
+    struct operation_hints {};
+
+    /**
+     * An iterator over the elements of the set, decoding a single element at a time.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, T> {
+        const CompressedSet* set = nullptr;
+        std::size_t block = 0;
+        uint32_t pos = 0;
+        T value{};
+
+        friend class CompressedSet;
+
+        iterator(const CompressedSet* set, std::size_t block) : set(set), block(block) {
+            if (block < set->blocks.size()) {
+                value = set->blocks[block].first;
+            }
+        }
+
+    public:
+        // the end iterator of an empty set
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return block == other.block && pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const T& operator*() const {
+            return value;
+        }
+
+        const T* operator->() const {
+            return &value;
+        }
+
+        iterator& operator++() {
+            const Block& cur = set->blocks[block];
+            if (++pos == cur.count) {
+                pos = 0;
+                if (++block < set->blocks.size()) {
+                    value = set->blocks[block].first;
+                }
+                return *this;
+            }
+            // the first column is the sum of the differences, the others are relative to the base
+            value[0] = RamUnsigned(value[0]) + set->read(cur, 0, pos - 1);
+            for (std::size_t i = 1; i < Arity; ++i) {
+                value[i] = cur.base[i] + set->read(cur, i, pos);
+            }
+            return *this;
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    CompressedSet() = default;
+
+    CompressedSet(const CompressedSet&) = delete;
+    CompressedSet& operator=(const CompressedSet&) = delete;
+
+    bool empty() const {
+        return numElements == 0;
+    }
+
+    std::size_t size() const {
+        return numElements;
+    }
+
+    /**
+     * Inserts the given element, returning whether it was not present before. Each
+     * insert rebuilds the set, such that elements should be added by bulk inserts.
+     */
+    bool insert(const T& value) {
+        operation_hints hints;
+        return insert(value, hints);
+    }
+
+    bool insert(const T& value, operation_hints& hints) {
+        if (contains(value, hints)) {
+            return false;
+        }
+        insertBulk(std::vector<T>(1, value));
+        return true;
+    }
+
+    /**
+     * Inserts the given elements, in arbitrary order and possibly containing duplicates,
+     * rebuilding the blocks of this set. No other operations may be conducted concurrently.
+     */
+    void insertBulk(std::vector<T> data) {
+        if (!empty()) {
+            data.insert(data.end(), begin(), end());
+        }
+        std::sort(data.begin(), data.end());
+        data.erase(std::unique(data.begin(), data.end()), data.end());
+        build(data);
+    }
+
+    bool contains(const T& value) const {
+        operation_hints hints;
+        return contains(value, hints);
+    }
+
+    bool contains(const T& value, operation_hints& hints) const {
+        return find(value, hints) != end();
+    }
+
+    iterator find(const T& value, operation_hints& hints) const {
+        iterator pos = lower_bound(value, hints);
+        if (pos != end() && *pos == value) {
+            return pos;
+        }
+        return end();
+    }
+
+    /**
+     * Obtains an iterator to the first element not less than the given value.
+     */
+    iterator lower_bound(const T& value, operation_hints& /* hints */) const {
+        iterator pos = locate(value);
+        while (pos != end() && *pos < value) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    /**
+     * Obtains an iterator to the first element greater than the given value.
+     */
+    iterator upper_bound(const T& value, operation_hints& /* hints */) const {
+        iterator pos = locate(value);
+        while (pos != end() && !(value < *pos)) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    iterator begin() const {
+        return iterator(this, 0);
+    }
+
+    iterator end() const {
+        return iterator(this, blocks.size());
+    }
+
+    /**
+     * Partitions this set into at most the given number of chunks of whole blocks,
+     * which may be processed in parallel.
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        std::vector<chunk> res;
+        if (blocks.empty()) {
+            return res;
+        }
+        num = std::max<std::size_t>(1, std::min(num, blocks.size()));
+        for (std::size_t i = 0; i < num; ++i) {
+            res.emplace_back(
+                    iterator(this, blocks.size() * i / num), iterator(this, blocks.size() * (i + 1) / num));
+        }
+        return res;
+    }
+
+    /**
+     * Removes all elements. No other operations may be conducted concurrently.
+     */
+    void clear() {
+        blocks.clear();
+        words.clear();
+        numElements = 0;
+    }
+
+    /**
+     * Obtains the number of bytes occupied by the compressed elements.
+     */
+    std::size_t getMemoryUsage() const {
+        return blocks.size() * sizeof(Block) + words.size() * sizeof(uint64_t);
+    }
+
+private:
+    // obtains an iterator to the first element of the last block starting at most at the given value
+    iterator locate(const T& value) const {
+        auto pos = std::upper_bound(blocks.begin(), blocks.end(), value,
+                [](const T& value, const Block& block) { return value < block.first; });
+        return iterator(this, pos == blocks.begin() ? 0 : pos - blocks.begin() - 1);
+    }
+
+    // reads the value at the given index of a column of a block
+    RamUnsigned read(const Block& block, std::size_t column, std::size_t index) const {
+        const unsigned width = block.width[column];
+        if (width == 0) {
+            return 0;
+        }
+        const std::size_t bit = block.offset[column] + index * width;
+        const unsigned shift = bit % 64;
+        uint64_t res = words[bit / 64] >> shift;
+        if (shift + width > 64) {
+            res |= words[bit / 64 + 1] << (64 - shift);
+        }
+        if (width < 64) {
+            res &= (uint64_t(1) << width) - 1;
+        }
+        return RamUnsigned(res);
+    }
+
+    // appends the given values to the packed words, each stored with the given width
+    void write(const std::vector<RamUnsigned>& values, unsigned width, std::size_t& bits) {
+        words.resize((bits + values.size() * width + 63) / 64, 0);
+        if (width == 0) {
+            return;
+        }
+        for (RamUnsigned cur : values) {
+            const uint64_t value = cur;
+            const unsigned shift = bits % 64;
+            words[bits / 64] |= value << shift;
+            if (shift + width > 64) {
+                words[bits / 64 + 1] |= value >> (64 - shift);
+            }
+            bits += width;
+        }
+    }
+
+    // the number of bits required to represent the given value
+    static unsigned getWidth(RamUnsigned value) {
+        unsigned res = 0;
+        while (res < VALUE_BITS && (value >> res) != 0) {
+            ++res;
+        }
+        return res;
+    }
+
+    // replaces the content of this set by the given sorted, duplicate free elements
+    void build(const std::vector<T>& data) {
+        clear();
+        std::size_t bits = 0;
+        std::vector<RamUnsigned> values;
+        for (std::size_t first = 0; first < data.size(); first += BLOCK_SIZE) {
+            const std::size_t last = std::min(data.size(), first + BLOCK_SIZE);
+            Block block;
+            block.first = data[first];
+            block.count = last - first;
+            for (std::size_t i = 0; i < Arity; ++i) {
+                values.clear();
+                block.base[i] = 0;
+                if (i == 0) {
+                    // the first column is ascending, storing the differences of consecutive values
+                    for (std::size_t j = first + 1; j < last; ++j) {
+                        values.push_back(RamUnsigned(data[j][0]) - RamUnsigned(data[j - 1][0]));
+                    }
+                } else {
+                    RamDomain min = data[first][i];
+                    for (std::size_t j = first; j < last; ++j) {
+                        min = std::min(min, data[j][i]);
+                    }
+                    block.base[i] = RamUnsigned(min);
+                    for (std::size_t j = first; j < last; ++j) {
+                        values.push_back(RamUnsigned(data[j][i]) - RamUnsigned(min));
+                    }
+                }
+                RamUnsigned max = 0;
+                for (RamUnsigned cur : values) {
+                    max = std::max(max, cur);
+                }
+                block.width[i] = getWidth(max);
+                block.offset[i] = bits;
+                write(values, block.width[i], bits);
+            }
+            blocks.push_back(block);
+        }
+        words.shrink_to_fit();
+        blocks.shrink_to_fit();
+        numElements = data.size();
+    }
+};
+
+}  // end namespace souffle
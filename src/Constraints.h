@@ -18,7 +18,9 @@
 
 #include "Util.h"
 
+#include <deque>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <set>
 #include <utility>
@@ -195,6 +197,14 @@ public:
      */
     virtual bool update(Assignment<Var>& ass) const = 0;
 
+    /**
+     * Lists the variables this constraint reads or updates. A constraint listing no variables is
+     * re-evaluated whenever any variable changes.
+     */
+    virtual std::vector<Var> getVariables() const {
+        return {};
+    }
+
     /** Adds print support for constraints (debugging) */
     virtual void print(std::ostream& out) const = 0;
 
@@ -230,6 +240,10 @@ std::shared_ptr<Constraint<Var>> sub(const Var& a, const Var& b, const std::stri
             return meet_assign(ass[b], ass[a]);
         }
 
+        std::vector<Var> getVariables() const override {
+            return {a, b};
+        }
+
         void print(std::ostream& out) const override {
             out << a << " " << symbol << " " << b;
         }
@@ -260,6 +274,10 @@ std::shared_ptr<Constraint<Var>> sub(const Val& a, const Var& b, const std::stri
             return meet_assign(ass[b], a);
         }
 
+        std::vector<Var> getVariables() const override {
+            return {b};
+        }
+
         void print(std::ostream& out) const override {
             out << a << " " << symbol << " " << b;
         }
@@ -396,15 +414,57 @@ public:
      * @return an assignment representing a solution for this problem
      */
     Assignment<Var>& solve(Assignment<Var>& ass) const {
-        // this is the most naive version of a solver, but sound and complete
-        bool change = true;
-        while (change) {
-            change = false;
-            for (const auto& cur : constraints) {
-                change = cur->update(ass) || change;
+        // a worklist solver: once a constraint altered the assignment, only the constraints sharing
+        // variables with it are re-evaluated, starting with all constraints in the order they were added
+        const size_t n = constraints.size();
+        std::vector<std::vector<Var>> variables(n);
+        std::map<Var, std::vector<size_t>> users;
+        std::vector<size_t> unrestricted;
+        for (size_t i = 0; i < n; i++) {
+            variables[i] = constraints[i]->getVariables();
+            if (variables[i].empty()) {
+                unrestricted.push_back(i);
+            }
+            for (const auto& var : variables[i]) {
+                users[var].push_back(i);
+            }
+        }
+
+        std::deque<size_t> worklist;
+        std::vector<bool> queued(n, true);
+        for (size_t i = 0; i < n; i++) {
+            worklist.push_back(i);
+        }
+        auto enqueue = [&](size_t i) {
+            if (!queued[i]) {
+                queued[i] = true;
+                worklist.push_back(i);
+            }
+        };
+
+        while (!worklist.empty()) {
+            const size_t cur = worklist.front();
+            worklist.pop_front();
+            queued[cur] = false;
+            if (!constraints[cur]->update(ass)) {
+                continue;
+            }
+            if (variables[cur].empty()) {
+                // the altered variables are not known
+                for (size_t i = 0; i < n; i++) {
+                    enqueue(i);
+                }
+                continue;
+            }
+            for (const auto& var : variables[cur]) {
+                for (size_t i : users[var]) {
+                    enqueue(i);
+                }
+            }
+            for (size_t i : unrestricted) {
+                enqueue(i);
             }
         }
-        // already done
         return ass;
     }
 
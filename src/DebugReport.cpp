@@ -15,12 +15,35 @@
  ***********************************************************************/
 
 #include "DebugReport.h"
+#include "Util.h"
+#include <algorithm>
 #include <ostream>
 #include <utility>
 #include <vector>
 
+#ifdef USE_LIBZ
+#include <zlib.h>
+#endif
+
 namespace souffle {
 
+#ifdef USE_LIBZ
+/** Compress the given data in the gzip format, which browsers decompress natively */
+static std::string gzip(const std::string& data) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string result(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+    stream.avail_out = static_cast<uInt>(result.size());
+    deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result;
+}
+#endif
+
 void DebugReportSection::printIndex(std::ostream& out) const {
     out << "<a href=\"#" << id << "\">" << title << "</a>\n";
     out << "<ul>\n";
@@ -51,10 +74,23 @@ void DebugReportSection::printTitle(std::ostream& out) const {
     out << "</div><div style='clear:both'></div>\n";
 }
 
+void DebugReportSection::printBody(std::ostream& out) const {
+#ifdef USE_LIBZ
+    if (body.size() > COMPRESSION_THRESHOLD) {
+        out << "<div id='" << id << "-body' data-gzip='" << DebugReport::toBase64(gzip(body)) << "'>\n";
+        out << "<a href=\"javascript:decompress('" << id << "-body')\">(show " << body.size()
+            << " bytes)</a>\n";
+        out << "</div>\n";
+        return;
+    }
+#endif
+    out << body << "\n";
+}
+
 void DebugReportSection::printContent(std::ostream& out) const {
     printTitle(out);
     out << "<div style='padding-left: 1em'>\n";
-    out << body << "\n";
+    printBody(out);
     for (const DebugReportSection& subsection : subsections) {
         subsection.printContent(out);
     }
@@ -89,6 +125,19 @@ void DebugReport::print(std::ostream& out) const {
     out << "    element.style.display = 'none';\n";
     out << "  }\n";
     out << "}\n";
+    out << "function decompress(id) {\n";
+    out << "  var element = document.getElementById(id);\n";
+    out << "  var data = atob(element.getAttribute('data-gzip'));\n";
+    out << "  var bytes = new Uint8Array(data.length);\n";
+    out << "  for (var i = 0; i < data.length; i++) {\n";
+    out << "    bytes[i] = data.charCodeAt(i);\n";
+    out << "  }\n";
+    out << "  var stream = new Blob([bytes]).stream().pipeThrough(new DecompressionStream('gzip'));\n";
+    out << "  new Response(stream).text().then(function(html) {\n";
+    out << "    element.removeAttribute('data-gzip');\n";
+    out << "    element.innerHTML = html;\n";
+    out << "  });\n";
+    out << "}\n";
     out << "</script>\n";
     out << "</head>\n";
     out << "<body>\n";
@@ -104,4 +153,70 @@ void DebugReport::print(std::ostream& out) const {
     out << "</html>\n";
 }
 
+bool DebugReport::hasSection(const std::string& transformer) {
+    if (!Global::config().has("debug-report-sections")) {
+        return true;
+    }
+    static const std::vector<std::string> transformers =
+            splitString(Global::config().get("debug-report-sections"), ',');
+    return std::find(transformers.begin(), transformers.end(), transformer) != transformers.end();
+}
+
+std::map<std::string, std::string> DebugReport::updateProgramParts(std::map<std::string, std::string> parts) {
+    std::map<std::string, std::string> changes;
+    for (const auto& part : parts) {
+        auto pos = programParts.find(part.first);
+        if (pos == programParts.end() || pos->second != part.second) {
+            changes.insert(part);
+        }
+    }
+    for (const auto& part : programParts) {
+        if (parts.find(part.first) == parts.end()) {
+            changes.emplace(part.first, "");
+        }
+    }
+    programParts = std::move(parts);
+    return changes;
+}
+
+std::string DebugReport::toBase64(const std::string& data) {
+    static const std::vector<char> table = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+            'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+            'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y',
+            'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
+    std::string result;
+    std::string tmp = data;
+    unsigned int padding = 0;
+    if (data.size() % 3 == 2) {
+        padding = 1;
+    } else if (data.size() % 3 == 1) {
+        padding = 2;
+    }
+
+    for (unsigned int i = 0; i < padding; i++) {
+        tmp.push_back(0);
+    }
+    for (unsigned int i = 0; i < tmp.size(); i += 3) {
+        auto c1 = static_cast<unsigned char>(tmp[i]);
+        auto c2 = static_cast<unsigned char>(tmp[i + 1]);
+        auto c3 = static_cast<unsigned char>(tmp[i + 2]);
+        unsigned char index1 = c1 >> 2;
+        unsigned char index2 = ((c1 & 0x03) << 4) | (c2 >> 4);
+        unsigned char index3 = ((c2 & 0x0F) << 2) | (c3 >> 6);
+        unsigned char index4 = c3 & 0x3F;
+
+        result.push_back(table[index1]);
+        result.push_back(table[index2]);
+        result.push_back(table[index3]);
+        result.push_back(table[index4]);
+    }
+    if (padding == 1) {
+        result[result.size() - 1] = '=';
+    } else if (padding == 2) {
+        result[result.size() - 1] = '=';
+        result[result.size() - 2] = '=';
+    }
+    return result;
+}
+
 }  // end of namespace souffle
@@ -18,6 +18,7 @@
 #include "Global.h"
 
 #include <fstream>
+#include <map>
 #include <memory>
 #include <ostream>
 #include <set>
@@ -67,6 +68,14 @@ public:
     }
 
 private:
+    /** Bodies larger than this number of bytes are embedded compressed, and decompressed when shown */
+    static constexpr size_t COMPRESSION_THRESHOLD = 1ul << 16;
+
+    /**
+     * Outputs the HTML code for the body of the section to the given stream.
+     */
+    void printBody(std::ostream& out) const;
+
     std::string id;
     std::string title;
     std::vector<DebugReportSection> subsections;
@@ -97,6 +106,26 @@ public:
         sections.push_back(section);
     }
 
+    /**
+     * Whether sections are generated for the given transformer, i.e., all transformers unless
+     * restricted by --debug-report-sections.
+     */
+    static bool hasSection(const std::string& transformer);
+
+    /**
+     * Whether the parts of the program were recorded by a previous section.
+     */
+    bool hasProgramParts() const {
+        return !programParts.empty();
+    }
+
+    /**
+     * Record the printed parts of the program, e.g., its relations with their clauses, by their
+     * headers, and return the parts which changed since the previous record. Removed parts map
+     * to empty strings.
+     */
+    std::map<std::string, std::string> updateProgramParts(std::map<std::string, std::string> parts);
+
     void addSection(const std::string& id, std::string title, std::string code) {
         std::stringstream codeHTML;
         std::string escapedCode = std::move(code);
@@ -123,6 +152,11 @@ public:
      */
     static DebugReportSection getCodeSection(const std::string& id, std::string title, std::string code);
 
+    /**
+     * Encode the given data in base64, e.g., to embed images and compressed sections.
+     */
+    static std::string toBase64(const std::string& data);
+
     friend std::ostream& operator<<(std::ostream& out, const DebugReport& report) {
         report.print(out);
         return out;
@@ -130,6 +164,9 @@ public:
 
 private:
     std::vector<DebugReportSection> sections;
+
+    /** the printed parts of the program recorded by the previous section, by their headers */
+    std::map<std::string, std::string> programParts;
 };
 
 }  // end of namespace souffle
@@ -15,6 +15,8 @@
  ***********************************************************************/
 
 #include "DebugReporter.h"
+#include "AstComponent.h"
+#include "AstProgram.h"
 #include "AstTranslationUnit.h"
 #include "AstTypeAnalysis.h"
 #include "AstTypeEnvironmentAnalysis.h"
@@ -23,49 +25,39 @@
 #include <chrono>
 #include <cstdio>
 #include <fstream>
+#include <map>
 #include <sstream>
 #include <utility>
 
 namespace souffle {
 
-static std::string toBase64(const std::string& data) {
-    static const std::vector<char> table = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
-            'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
-            'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y',
-            'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
-    std::string result;
-    std::string tmp = data;
-    unsigned int padding = 0;
-    if (data.size() % 3 == 2) {
-        padding = 1;
-    } else if (data.size() % 3 == 1) {
-        padding = 2;
+/** Get the printed types, components, relations with their clauses, and orphan clauses by their headers */
+static std::map<std::string, std::string> getProgramParts(const AstProgram& program) {
+    std::map<std::string, std::string> parts;
+    std::stringstream types;
+    for (const AstType* type : program.getTypes()) {
+        types << *type << "\n";
     }
-
-    for (unsigned int i = 0; i < padding; i++) {
-        tmp.push_back(0);
+    parts["// ----- Types -----"] = types.str();
+    for (const AstComponent* component : program.getComponents()) {
+        std::stringstream text;
+        text << *component << "\n";
+        parts["// -- component " + component->getComponentType()->getName() + " --"] = text.str();
     }
-    for (unsigned int i = 0; i < tmp.size(); i += 3) {
-        auto c1 = static_cast<unsigned char>(tmp[i]);
-        auto c2 = static_cast<unsigned char>(tmp[i + 1]);
-        auto c3 = static_cast<unsigned char>(tmp[i + 2]);
-        unsigned char index1 = c1 >> 2;
-        unsigned char index2 = ((c1 & 0x03) << 4) | (c2 >> 4);
-        unsigned char index3 = ((c2 & 0x0F) << 2) | (c3 >> 6);
-        unsigned char index4 = c3 & 0x3F;
-
-        result.push_back(table[index1]);
-        result.push_back(table[index2]);
-        result.push_back(table[index3]);
-        result.push_back(table[index4]);
+    for (const AstRelation* rel : program.getRelations()) {
+        std::stringstream text;
+        text << *rel << "\n\n";
+        for (const AstClause* clause : rel->getClauses()) {
+            text << *clause << "\n\n";
+        }
+        parts["// -- " + toString(rel->getName()) + " --"] = text.str();
     }
-    if (padding == 1) {
-        result[result.size() - 1] = '=';
-    } else if (padding == 2) {
-        result[result.size() - 1] = '=';
-        result[result.size() - 2] = '=';
+    std::stringstream orphans;
+    for (const AstClause* clause : program.getOrphanClauses()) {
+        orphans << *clause << "\n\n";
     }
-    return result;
+    parts["// ----- Orphan Clauses -----"] = orphans.str();
+    return parts;
 }
 
 DebugReportSection DebugReporter::getDotGraphSection(
@@ -91,8 +83,8 @@ DebugReportSection DebugReporter::getDotGraphSection(
 
     std::stringstream graphHTML;
     if (data.str().find("<svg") != std::string::npos) {
-        graphHTML << "<img alt='graph image' src='data:image/svg+xml;base64," << toBase64(data.str())
-                  << "'><br/>\n";
+        graphHTML << "<img alt='graph image' src='data:image/svg+xml;base64,"
+                  << DebugReport::toBase64(data.str()) << "'><br/>\n";
     } else {
         graphHTML << "<p>(error: unable to generate dot graph image)</p>";
     }
@@ -108,6 +100,9 @@ DebugReportSection DebugReporter::getDotGraphSection(
 bool DebugReporter::transform(AstTranslationUnit& translationUnit) {
     auto start = std::chrono::high_resolution_clock::now();
     bool changed = applySubtransformer(translationUnit, wrappedTransformer.get());
+    if (!DebugReport::hasSection(wrappedTransformer->getName())) {
+        return changed;
+    }
     auto end = std::chrono::high_resolution_clock::now();
     std::string runtimeStr = "(" + std::to_string(std::chrono::duration<double>(end - start).count()) + "s)";
     if (changed) {
@@ -122,10 +117,22 @@ bool DebugReporter::transform(AstTranslationUnit& translationUnit) {
 
 void DebugReporter::generateDebugReport(
         AstTranslationUnit& translationUnit, const std::string& id, std::string title) {
+    // the first section lists the whole program, later sections the relations changed since
+    const AstProgram& program = *translationUnit.getProgram();
+    DebugReport& debugReport = translationUnit.getDebugReport();
+    const bool initial = !debugReport.hasProgramParts();
     std::stringstream datalogSpec;
-    translationUnit.getProgram()->print(datalogSpec);
+    if (initial) {
+        program.print(datalogSpec);
+    }
+    for (const auto& part : debugReport.updateProgramParts(getProgramParts(program))) {
+        if (!initial) {
+            datalogSpec << part.first << (part.second.empty() ? " (removed)\n" : "\n") << part.second;
+        }
+    }
 
-    DebugReportSection datalogSection(id + "-dl", "Datalog", datalogSpec.str());
+    DebugReportSection datalogSection(
+            id + "-dl", initial ? "Datalog" : "Datalog (changed relations)", datalogSpec.str());
 
     std::stringstream typeAnalysis;
     translationUnit.getAnalysis<TypeAnalysis>()->print(typeAnalysis);
@@ -149,7 +156,7 @@ void DebugReporter::generateDebugReport(
     DebugReportSection topsortSCCGraphSection(
             id + "-topsort-scc-graph", "SCC Topological Sort Order", topsortSCCGraph.str());
 
-    translationUnit.getDebugReport().addSection(DebugReportSection(id, std::move(title),
+    debugReport.addSection(DebugReportSection(id, std::move(title),
             {datalogSection, typeAnalysisSection, typeEnvironmentAnalysisSection, precedenceGraphSection,
                     sccGraphSection, topsortSCCGraphSection},
             ""));
@@ -0,0 +1,1016 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file DenseSet.h
+ *
+ * This header file contains data structures for unary and binary
+ * relations over dense domains, e.g., over the indexes of symbols and
+ * records.
+ *
+ * A dense set stores unary tuples as a compressed bitmap in the manner of
+ * roaring bitmaps: the values are grouped into chunks of 2^16 consecutive
+ * values, each chunk being a sorted array while it is sparse and a bitmap
+ * once it is dense. An adjacency set stores binary tuples as the sorted
+ * rows of targets of each source, where large rows are dense sets of
+ * their own. A reverse adjacency is an adjacency set of the swapped
+ * tuples, i.e., an index of the inverse order.
+ *
+ * Both structures order their elements lexicographically by the signed
+ * values of the domain, like b-trees, such that they support range
+ * queries by lower bounds. Chunks and rows are located by radix trees
+ * over the values, which are cheap to traverse for dense domains.
+ *
+ * Multiple insert operations can be conducted concurrently, inserts into
+ * the same chunk or row being serialised by a lock. So can read-only
+ * operations. However, inserts and read operations may not be conducted
+ * at the same time.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "CompiledTuple.h"
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include "Util.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace souffle {
+
+namespace detail {
+
+/** The key of a value of the domain, an unsigned number ordered as the signed value */
+inline RamUnsigned getDenseKey(RamDomain value) {
+    return static_cast<RamUnsigned>(value) ^ (RamUnsigned(1) << (RAM_DOMAIN_SIZE - 1));
+}
+
+/** The value of the domain of a key */
+inline RamDomain getDenseValue(RamUnsigned key) {
+    return static_cast<RamDomain>(key ^ (RamUnsigned(1) << (RAM_DOMAIN_SIZE - 1)));
+}
+
+/**
+ * A concurrent radix tree mapping indexes of the given number of bytes to
+ * lazily created leaves. The pages of the tree are created by the first
+ * insert reaching them and are never released before the tree is cleared,
+ * such that lookups do not need to lock.
+ *
+ * @tparam Leaf the type of the leaves
+ * @tparam Levels the number of levels of the tree, one per byte of an index
+ */
+template <typename Leaf, unsigned Levels>
+class RadixDirectory {
+    static_assert(Levels > 0 && Levels * 8 <= sizeof(RamUnsigned) * 8, "invalid number of levels");
+
+    static constexpr unsigned FANOUT_BITS = 8;
+    static constexpr std::size_t FANOUT = std::size_t(1) << FANOUT_BITS;
+
+    // a page of the tree, referencing pages of the next level or leaves
+    struct Page {
+        std::array<std::atomic<void*>, FANOUT> slots;
+
+        Page() {
+            for (auto& slot : slots) {
+                slot.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    Page root;
+
+public:
+    /** the greatest index of the tree */
+    static constexpr RamUnsigned MAX_INDEX = ~RamUnsigned(0) >> (sizeof(RamUnsigned) * 8 - Levels * 8);
+
+    RadixDirectory() = default;
+
+    RadixDirectory(const RadixDirectory&) = delete;
+    RadixDirectory& operator=(const RadixDirectory&) = delete;
+
+    ~RadixDirectory() {
+        clear();
+    }
+
+    /** the leaf of the given index, null if there is none */
+    Leaf* find(RamUnsigned index) const {
+        const Page* page = &root;
+        for (unsigned level = Levels; level > 1; --level) {
+            page = static_cast<const Page*>(
+                    page->slots[slotOf(index, level)].load(std::memory_order_acquire));
+            if (page == nullptr) {
+                return nullptr;
+            }
+        }
+        return static_cast<Leaf*>(page->slots[slotOf(index, 1)].load(std::memory_order_acquire));
+    }
+
+    /** the leaf of the given index, which is created if there is none */
+    Leaf& get(RamUnsigned index) {
+        Page* page = &root;
+        for (unsigned level = Levels; level > 1; --level) {
+            page = getOrCreate<Page>(page->slots[slotOf(index, level)]);
+        }
+        return *getOrCreate<Leaf>(page->slots[slotOf(index, 1)]);
+    }
+
+    /**
+     * The leaf of the least index not less than the given index, null if
+     * there is none. The index is updated to the index of the leaf found.
+     */
+    Leaf* next(RamUnsigned& index) const {
+        return next(root, Levels, index);
+    }
+
+    /** applies the given function to the indexes and leaves of the tree in ascending order */
+    template <typename F>
+    void forEach(F&& f) const {
+        forEach(root, Levels, 0, f);
+    }
+
+    /** the number of bytes of memory occupied by the pages and leaves of the tree */
+    std::size_t getMemoryUsage() const {
+        return getMemoryUsage(root, Levels);
+    }
+
+    /** removes all leaves, no other operations may be conducted concurrently */
+    void clear() {
+        clear(root, Levels);
+    }
+
+private:
+    // the slot of an index in a page of the given level
+    static std::size_t slotOf(RamUnsigned index, unsigned level) {
+        return static_cast<std::size_t>(index >> (FANOUT_BITS * (level - 1))) & (FANOUT - 1);
+    }
+
+    // the node referenced by the given slot, installing a new node if the slot is empty
+    template <typename Node>
+    static Node* getOrCreate(std::atomic<void*>& slot) {
+        void* node = slot.load(std::memory_order_acquire);
+        if (node != nullptr) {
+            return static_cast<Node*>(node);
+        }
+        auto created = std::make_unique<Node>();
+        if (slot.compare_exchange_strong(node, created.get(), std::memory_order_acq_rel)) {
+            return created.release();
+        }
+        // another thread installed the node first
+        return static_cast<Node*>(node);
+    }
+
+    static Leaf* next(const Page& page, unsigned level, RamUnsigned& index) {
+        const unsigned shift = FANOUT_BITS * (level - 1);
+        const std::size_t first = slotOf(index, level);
+        for (std::size_t i = first; i < FANOUT; ++i) {
+            if (i != first) {
+                // the least index of the slot, the bits of the upper levels being retained
+                index = (index & ~((RamUnsigned(FANOUT) << shift) - 1)) | (RamUnsigned(i) << shift);
+            }
+            void* child = page.slots[i].load(std::memory_order_acquire);
+            if (child == nullptr) {
+                continue;
+            }
+            if (level == 1) {
+                return static_cast<Leaf*>(child);
+            }
+            if (Leaf* res = next(*static_cast<const Page*>(child), level - 1, index)) {
+                return res;
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename F>
+    static void forEach(const Page& page, unsigned level, RamUnsigned prefix, F& f) {
+        for (std::size_t i = 0; i < FANOUT; ++i) {
+            void* child = page.slots[i].load(std::memory_order_acquire);
+            if (child == nullptr) {
+                continue;
+            }
+            const RamUnsigned index = (prefix << FANOUT_BITS) | i;
+            if (level == 1) {
+                f(index, *static_cast<const Leaf*>(child));
+            } else {
+                forEach(*static_cast<const Page*>(child), level - 1, index, f);
+            }
+        }
+    }
+
+    static std::size_t getMemoryUsage(const Page& page, unsigned level) {
+        std::size_t res = sizeof(Page);
+        for (const auto& slot : page.slots) {
+            void* child = slot.load(std::memory_order_relaxed);
+            if (child == nullptr) {
+                continue;
+            }
+            if (level == 1) {
+                res += static_cast<const Leaf*>(child)->getMemoryUsage();
+            } else {
+                res += getMemoryUsage(*static_cast<const Page*>(child), level - 1);
+            }
+        }
+        return res;
+    }
+
+    static void clear(Page& page, unsigned level) {
+        for (auto& slot : page.slots) {
+            void* child = slot.load(std::memory_order_relaxed);
+            if (child == nullptr) {
+                continue;
+            }
+            if (level == 1) {
+                delete static_cast<Leaf*>(child);
+            } else {
+                auto* nested = static_cast<Page*>(child);
+                clear(*nested, level - 1);
+                delete nested;
+            }
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * A chunk of a dense key set, covering 2^16 consecutive keys. A chunk is
+ * a sorted array of the low bits of its keys while it holds few keys, and
+ * a bitmap otherwise.
+ *
+ * Elements of a chunk are addressed by cursors, which are positions in the
+ * array or keys of the bitmap respectively, END marking the end of a chunk.
+ */
+class DenseChunk {
+public:
+    static constexpr unsigned BITS = 16;
+    static constexpr uint32_t SIZE = uint32_t(1) << BITS;
+    static constexpr uint32_t END = SIZE;
+
+    // the number of keys up to which a chunk is an array, occupying at most the memory of a bitmap
+    static constexpr std::size_t ARRAY_LIMIT = SIZE / 16;
+
+    DenseChunk() = default;
+
+    /** inserts the given key of this chunk, returning whether it was not present before */
+    bool insert(uint32_t key) {
+        std::lock_guard<SpinLock> guard(lock);
+        if (bits != nullptr) {
+            uint64_t& word = bits[key / 64];
+            const uint64_t mask = uint64_t(1) << (key % 64);
+            if ((word & mask) != 0) {
+                return false;
+            }
+            word |= mask;
+            ++count;
+            return true;
+        }
+        auto pos = std::lower_bound(array.begin(), array.end(), key);
+        if (pos != array.end() && *pos == key) {
+            return false;
+        }
+        if (array.size() < ARRAY_LIMIT) {
+            array.insert(pos, static_cast<uint16_t>(key));
+            ++count;
+            return true;
+        }
+        // the array is full, so the chunk is turned into a bitmap
+        bits.reset(new uint64_t[SIZE / 64]());
+        for (uint16_t cur : array) {
+            bits[cur / 64] |= uint64_t(1) << (cur % 64);
+        }
+        std::vector<uint16_t>().swap(array);
+        bits[key / 64] |= uint64_t(1) << (key % 64);
+        ++count;
+        return true;
+    }
+
+    bool contains(uint32_t key) const {
+        if (bits != nullptr) {
+            return ((bits[key / 64] >> (key % 64)) & 1) != 0;
+        }
+        return std::binary_search(array.begin(), array.end(), key);
+    }
+
+    /** the number of keys of this chunk */
+    std::size_t size() const {
+        return count;
+    }
+
+    /** the cursor of the least key not less than the given key, END if there is none */
+    uint32_t seek(uint32_t key) const {
+        if (bits == nullptr) {
+            auto pos = std::lower_bound(array.begin(), array.end(), key);
+            return pos == array.end() ? END : static_cast<uint32_t>(pos - array.begin());
+        }
+        std::size_t w = key / 64;
+        if (w >= SIZE / 64) {
+            return END;
+        }
+        uint64_t word = bits[w] & (~uint64_t(0) << (key % 64));
+        while (word == 0) {
+            if (++w == SIZE / 64) {
+                return END;
+            }
+            word = bits[w];
+        }
+        return static_cast<uint32_t>(w * 64 + __builtin_ctzll(word));
+    }
+
+    /** the cursor following the given cursor, END if there is none */
+    uint32_t advance(uint32_t cursor) const {
+        if (bits == nullptr) {
+            return cursor + 1 < array.size() ? cursor + 1 : END;
+        }
+        return seek(cursor + 1);
+    }
+
+    /** the key at the given cursor */
+    uint32_t at(uint32_t cursor) const {
+        return bits == nullptr ? array[cursor] : cursor;
+    }
+
+    std::size_t getMemoryUsage() const {
+        return sizeof(*this) + array.capacity() * sizeof(uint16_t) +
+               (bits == nullptr ? 0 : SIZE / 64 * sizeof(uint64_t));
+    }
+
+private:
+    // the lock serialising inserts into this chunk
+    SpinLock lock;
+
+    // the number of keys of this chunk
+    std::size_t count = 0;
+
+    // the sorted keys of a sparse chunk
+    std::vector<uint16_t> array;
+
+    // the bitmap of a dense chunk
+    std::unique_ptr<uint64_t[]> bits;
+};
+
+/**
+ * A concurrent set of keys, stored in chunks of 2^16 consecutive keys.
+ */
+class DenseKeySet {
+    using Directory = RadixDirectory<DenseChunk, (RAM_DOMAIN_SIZE - DenseChunk::BITS) / 8>;
+
+    Directory chunks;
+
+    std::atomic<std::size_t> count{0};
+
+public:
+    /** a position of a key of the set, the end being marked by a null chunk */
+    struct Position {
+        RamUnsigned chunk = 0;
+        const DenseChunk* leaf = nullptr;
+        uint32_t cursor = 0;
+
+        bool operator==(const Position& other) const {
+            return leaf == other.leaf && (leaf == nullptr || cursor == other.cursor);
+        }
+
+        bool operator!=(const Position& other) const {
+            return !(*this == other);
+        }
+    };
+
+    DenseKeySet() = default;
+
+    DenseKeySet(const DenseKeySet&) = delete;
+    DenseKeySet& operator=(const DenseKeySet&) = delete;
+
+    bool insert(RamUnsigned key) {
+        if (!chunks.get(key >> DenseChunk::BITS).insert(key & (DenseChunk::SIZE - 1))) {
+            return false;
+        }
+        count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool contains(RamUnsigned key) const {
+        const DenseChunk* chunk = chunks.find(key >> DenseChunk::BITS);
+        return chunk != nullptr && chunk->contains(key & (DenseChunk::SIZE - 1));
+    }
+
+    std::size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /** the position of the least key not less than the given key */
+    Position seek(RamUnsigned key) const {
+        Position pos;
+        pos.chunk = key >> DenseChunk::BITS;
+        pos.leaf = chunks.next(pos.chunk);
+        if (pos.leaf == nullptr) {
+            return {};
+        }
+        pos.cursor = pos.leaf->seek(pos.chunk == key >> DenseChunk::BITS ? key & (DenseChunk::SIZE - 1) : 0);
+        if (pos.cursor == DenseChunk::END) {
+            nextChunk(pos);
+        }
+        return pos;
+    }
+
+    /** the position of the first key of the given chunk */
+    static Position first(RamUnsigned chunk, const DenseChunk& leaf) {
+        return {chunk, &leaf, leaf.seek(0)};
+    }
+
+    /** advances the given position to the following key */
+    void advance(Position& pos) const {
+        pos.cursor = pos.leaf->advance(pos.cursor);
+        if (pos.cursor == DenseChunk::END) {
+            nextChunk(pos);
+        }
+    }
+
+    /** the key at the given position */
+    static RamUnsigned at(const Position& pos) {
+        return (pos.chunk << DenseChunk::BITS) | pos.leaf->at(pos.cursor);
+    }
+
+    /** applies the given function to the chunks and their number of keys in ascending order */
+    template <typename F>
+    void forEachChunk(F&& f) const {
+        chunks.forEach(
+                [&](RamUnsigned chunk, const DenseChunk& leaf) { f(first(chunk, leaf), leaf.size()); });
+    }
+
+    std::size_t getMemoryUsage() const {
+        return sizeof(*this) - sizeof(chunks) + chunks.getMemoryUsage();
+    }
+
+    void clear() {
+        chunks.clear();
+        count.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // moves the given position to the first key of the following chunk, or to the end
+    void nextChunk(Position& pos) const {
+        if (pos.chunk == Directory::MAX_INDEX) {
+            pos = {};
+            return;
+        }
+        ++pos.chunk;
+        pos.leaf = chunks.next(pos.chunk);
+        if (pos.leaf == nullptr) {
+            pos = {};
+            return;
+        }
+        pos.cursor = pos.leaf->seek(0);
+    }
+};
+
+/**
+ * Partitions a sequence of groups, e.g., chunks or rows, into about the
+ * given number of ranges of similar size, cutting between groups only.
+ */
+template <typename Iter, typename F>
+std::vector<range<Iter>> partitionGroups(std::size_t total, std::size_t num, Iter end, F&& forEachGroup) {
+    std::vector<range<Iter>> res;
+    if (total == 0) {
+        return res;
+    }
+    num = std::max<std::size_t>(1, std::min(num, total));
+    const std::size_t step = (total + num - 1) / num;
+    Iter first = end;
+    std::size_t pending = 0;
+    forEachGroup([&](const Iter& group, std::size_t size) {
+        if (first == end) {
+            first = group;
+        } else if (pending >= step) {
+            res.emplace_back(first, group);
+            first = group;
+            pending = 0;
+        }
+        pending += size;
+    });
+    res.emplace_back(first, end);
+    return res;
+}
+
+}  // end namespace detail
+
+/**
+ * A concurrent set of unary tuples over a dense domain.
+ */
+class DenseSet {
+    using Position = detail::DenseKeySet::Position;
+
+    detail::DenseKeySet keys;
+
+public:
+    using element_type = ram::Tuple<RamDomain, 1>;
+
+    // dense sets do not utilise operation hints
+    struct operation_hints {};
+
+    /** an iterator over the elements of the set in ascending order */
+    class iterator : public std::iterator<std::forward_iterator_tag, element_type> {
+        const detail::DenseKeySet* keys = nullptr;
+        Position pos;
+        element_type value{};
+
+        friend class DenseSet;
+
+        iterator(const detail::DenseKeySet& keys, Position pos) : keys(&keys), pos(pos) {
+            load();
+        }
+
+        void load() {
+            if (pos.leaf != nullptr) {
+                value[0] = detail::getDenseValue(detail::DenseKeySet::at(pos));
+            }
+        }
+
+    public:
+        // the end iterator
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const element_type& operator*() const {
+            return value;
+        }
+
+        const element_type* operator->() const {
+            return &value;
+        }
+
+        iterator& operator++() {
+            keys->advance(pos);
+            load();
+            return *this;
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    DenseSet() = default;
+
+    DenseSet(const DenseSet&) = delete;
+    DenseSet& operator=(const DenseSet&) = delete;
+
+    bool empty() const {
+        return keys.empty();
+    }
+
+    std::size_t size() const {
+        return keys.size();
+    }
+
+    /**
+     * Inserts the given element, returning whether it was not present before.
+     */
+    bool insert(const element_type& value) {
+        return keys.insert(detail::getDenseKey(value[0]));
+    }
+
+    bool insert(const element_type& value, operation_hints& /* hints */) {
+        return insert(value);
+    }
+
+    bool contains(const element_type& value) const {
+        return keys.contains(detail::getDenseKey(value[0]));
+    }
+
+    bool contains(const element_type& value, operation_hints& /* hints */) const {
+        return contains(value);
+    }
+
+    iterator find(const element_type& value) const {
+        return contains(value) ? lower_bound(value) : end();
+    }
+
+    iterator find(const element_type& value, operation_hints& /* hints */) const {
+        return find(value);
+    }
+
+    /** an iterator to the least element not less than the given element */
+    iterator lower_bound(const element_type& value) const {
+        return iterator(keys, keys.seek(detail::getDenseKey(value[0])));
+    }
+
+    iterator lower_bound(const element_type& value, operation_hints& /* hints */) const {
+        return lower_bound(value);
+    }
+
+    /** an iterator to the least element greater than the given element */
+    iterator upper_bound(const element_type& value, operation_hints& /* hints */) const {
+        if (value[0] == MAX_RAM_DOMAIN) {
+            return end();
+        }
+        return lower_bound(element_type{{value[0] + 1}});
+    }
+
+    /**
+     * The range of elements whose first given number of components equal
+     * those of the given element, i.e., all elements or the element itself.
+     */
+    template <unsigned levels>
+    range<iterator> getBoundaries(const element_type& value, operation_hints& /* hints */) const {
+        static_assert(levels <= 1, "invalid number of bound components");
+        if (levels == 0) {
+            return {begin(), end()};
+        }
+        iterator pos = find(value);
+        iterator fin = pos;
+        if (fin != end()) {
+            ++fin;
+        }
+        return {pos, fin};
+    }
+
+    iterator begin() const {
+        return iterator(keys, keys.seek(0));
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    /**
+     * Partitions the set into about the given number of chunks of similar
+     * size, cutting between chunks of keys only.
+     *
+     * @param num the number of chunks requested
+     * @return a list of chunks partitioning this set
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        return detail::partitionGroups<iterator>(size(), num, end(), [&](const auto& f) {
+            keys.forEachChunk([&](const Position& pos, std::size_t size) { f(iterator(keys, pos), size); });
+        });
+    }
+
+    /**
+     * Returns an estimate of the number of bytes of memory occupied by this set.
+     */
+    std::size_t getMemoryUsage() const {
+        return sizeof(*this) - sizeof(keys) + keys.getMemoryUsage();
+    }
+
+    /**
+     * Removes all elements. No other operations may be conducted concurrently.
+     */
+    void clear() {
+        keys.clear();
+    }
+};
+
+/**
+ * A concurrent set of binary tuples over a dense domain, stored as the
+ * sorted rows of the targets of each source, like a compressed sparse row
+ * representation of a graph growing by inserts.
+ */
+class AdjacencySet {
+    using Position = detail::DenseKeySet::Position;
+
+    /**
+     * The targets of a source, which are a sorted array while there are
+     * few of them, and a dense key set otherwise. Like chunks, elements of a
+     * row are addressed by cursors, i.e., positions in the array or
+     * positions of the key set respectively.
+     */
+    class Row {
+    public:
+        // the number of targets up to which a row is an array
+        static constexpr std::size_t ARRAY_LIMIT = 1024;
+
+        struct Cursor {
+            std::size_t index = 0;
+            Position pos;
+
+            bool operator==(const Cursor& other) const {
+                return index == other.index && pos == other.pos;
+            }
+        };
+
+        Row() = default;
+
+        bool insert(RamDomain target) {
+            std::lock_guard<SpinLock> guard(lock);
+            if (dense != nullptr) {
+                return dense->insert(detail::getDenseKey(target));
+            }
+            auto pos = std::lower_bound(targets.begin(), targets.end(), target);
+            if (pos != targets.end() && *pos == target) {
+                return false;
+            }
+            if (targets.size() < ARRAY_LIMIT) {
+                targets.insert(pos, target);
+                return true;
+            }
+            // the row is turned into a key set, rendering inserts independent of the size of the row
+            dense = std::make_unique<detail::DenseKeySet>();
+            for (RamDomain cur : targets) {
+                dense->insert(detail::getDenseKey(cur));
+            }
+            std::vector<RamDomain>().swap(targets);
+            return dense->insert(detail::getDenseKey(target));
+        }
+
+        bool contains(RamDomain target) const {
+            if (dense != nullptr) {
+                return dense->contains(detail::getDenseKey(target));
+            }
+            return std::binary_search(targets.begin(), targets.end(), target);
+        }
+
+        std::size_t size() const {
+            return dense != nullptr ? dense->size() : targets.size();
+        }
+
+        /** the cursor of the least target not less than the given target */
+        Cursor seek(RamDomain target) const {
+            Cursor res;
+            if (dense != nullptr) {
+                res.pos = dense->seek(detail::getDenseKey(target));
+            } else {
+                res.index = std::lower_bound(targets.begin(), targets.end(), target) - targets.begin();
+            }
+            return res;
+        }
+
+        /** whether the given cursor is at the end of this row */
+        bool isEnd(const Cursor& cursor) const {
+            return dense != nullptr ? cursor.pos.leaf == nullptr : cursor.index == targets.size();
+        }
+
+        void advance(Cursor& cursor) const {
+            if (dense != nullptr) {
+                dense->advance(cursor.pos);
+            } else {
+                ++cursor.index;
+            }
+        }
+
+        RamDomain at(const Cursor& cursor) const {
+            return dense != nullptr ? detail::getDenseValue(detail::DenseKeySet::at(cursor.pos))
+                                    : targets[cursor.index];
+        }
+
+        std::size_t getMemoryUsage() const {
+            return sizeof(*this) + targets.capacity() * sizeof(RamDomain) +
+                   (dense != nullptr ? dense->getMemoryUsage() : 0);
+        }
+
+    private:
+        // the lock serialising inserts into this row
+        SpinLock lock;
+
+        // the sorted targets of a small row
+        std::vector<RamDomain> targets;
+
+        // the targets of a large row
+        std::unique_ptr<detail::DenseKeySet> dense;
+    };
+
+    using Directory = detail::RadixDirectory<Row, RAM_DOMAIN_SIZE / 8>;
+
+    Directory rows;
+
+    std::atomic<std::size_t> count{0};
+
+public:
+    using element_type = ram::Tuple<RamDomain, 2>;
+
+    // adjacency sets do not utilise operation hints
+    struct operation_hints {};
+
+    /** an iterator over the elements of the set in lexicographical order */
+    class iterator : public std::iterator<std::forward_iterator_tag, element_type> {
+        const Directory* rows = nullptr;
+        RamUnsigned source = 0;
+        const Row* row = nullptr;
+        Row::Cursor cursor;
+        element_type value{};
+
+        friend class AdjacencySet;
+
+        iterator(const Directory& rows, RamUnsigned source, const Row* row, Row::Cursor cursor)
+                : rows(&rows), source(source), row(row), cursor(cursor) {
+            normalise();
+        }
+
+        // moves this iterator to the first target of the following rows if it is at the end of its row
+        void normalise() {
+            while (row != nullptr && row->isEnd(cursor)) {
+                if (source == Directory::MAX_INDEX) {
+                    row = nullptr;
+                    break;
+                }
+                ++source;
+                row = rows->next(source);
+                if (row != nullptr) {
+                    cursor = row->seek(MIN_RAM_DOMAIN);
+                }
+            }
+            if (row == nullptr) {
+                cursor = {};
+                return;
+            }
+            value[0] = detail::getDenseValue(source);
+            value[1] = row->at(cursor);
+        }
+
+    public:
+        // the end iterator
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return row == other.row && (row == nullptr || cursor == other.cursor);
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const element_type& operator*() const {
+            return value;
+        }
+
+        const element_type* operator->() const {
+            return &value;
+        }
+
+        iterator& operator++() {
+            row->advance(cursor);
+            normalise();
+            return *this;
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    AdjacencySet() = default;
+
+    AdjacencySet(const AdjacencySet&) = delete;
+    AdjacencySet& operator=(const AdjacencySet&) = delete;
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Inserts the given element, returning whether it was not present before.
+     */
+    bool insert(const element_type& value) {
+        if (!rows.get(detail::getDenseKey(value[0])).insert(value[1])) {
+            return false;
+        }
+        count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool insert(const element_type& value, operation_hints& /* hints */) {
+        return insert(value);
+    }
+
+    bool contains(const element_type& value) const {
+        const Row* row = rows.find(detail::getDenseKey(value[0]));
+        return row != nullptr && row->contains(value[1]);
+    }
+
+    bool contains(const element_type& value, operation_hints& /* hints */) const {
+        return contains(value);
+    }
+
+    iterator find(const element_type& value) const {
+        return contains(value) ? lower_bound(value) : end();
+    }
+
+    iterator find(const element_type& value, operation_hints& /* hints */) const {
+        return find(value);
+    }
+
+    /** an iterator to the least element not less than the given element */
+    iterator lower_bound(const element_type& value) const {
+        const RamUnsigned key = detail::getDenseKey(value[0]);
+        RamUnsigned source = key;
+        const Row* row = rows.next(source);
+        if (row == nullptr) {
+            return end();
+        }
+        return iterator(rows, source, row, row->seek(source == key ? value[1] : MIN_RAM_DOMAIN));
+    }
+
+    iterator lower_bound(const element_type& value, operation_hints& /* hints */) const {
+        return lower_bound(value);
+    }
+
+    /** an iterator to the least element greater than the given element */
+    iterator upper_bound(const element_type& value, operation_hints& /* hints */) const {
+        if (value[1] != MAX_RAM_DOMAIN) {
+            return lower_bound(element_type{{value[0], value[1] + 1}});
+        }
+        if (value[0] != MAX_RAM_DOMAIN) {
+            return lower_bound(element_type{{value[0] + 1, MIN_RAM_DOMAIN}});
+        }
+        return end();
+    }
+
+    /**
+     * The range of elements whose first given number of components equal
+     * those of the given element, i.e., all elements, the row of the source
+     * of the given element, or the element itself.
+     */
+    template <unsigned levels>
+    range<iterator> getBoundaries(const element_type& value, operation_hints& /* hints */) const {
+        static_assert(levels <= 2, "invalid number of bound components");
+        if (levels == 0) {
+            return {begin(), end()};
+        }
+        if (levels == 2) {
+            iterator pos = find(value);
+            iterator fin = pos;
+            if (fin != end()) {
+                ++fin;
+            }
+            return {pos, fin};
+        }
+        const RamUnsigned source = detail::getDenseKey(value[0]);
+        const Row* row = rows.find(source);
+        if (row == nullptr) {
+            return {end(), end()};
+        }
+        iterator pos(rows, source, row, row->seek(MIN_RAM_DOMAIN));
+        if (source == Directory::MAX_INDEX) {
+            return {pos, end()};
+        }
+        // the row ends at the first target of the following row
+        RamUnsigned next = source + 1;
+        const Row* following = rows.next(next);
+        if (following == nullptr) {
+            return {pos, end()};
+        }
+        return {pos, iterator(rows, next, following, following->seek(MIN_RAM_DOMAIN))};
+    }
+
+    iterator begin() const {
+        return lower_bound(element_type{{MIN_RAM_DOMAIN, MIN_RAM_DOMAIN}});
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    /**
+     * Partitions the set into about the given number of chunks of similar
+     * size, cutting between rows only.
+     *
+     * @param num the number of chunks requested
+     * @return a list of chunks partitioning this set
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        return detail::partitionGroups<iterator>(size(), num, end(), [&](const auto& f) {
+            rows.forEach([&](RamUnsigned source, const Row& row) {
+                f(iterator(rows, source, &row, row.seek(MIN_RAM_DOMAIN)), row.size());
+            });
+        });
+    }
+
+    /**
+     * Returns an estimate of the number of bytes of memory occupied by this set.
+     */
+    std::size_t getMemoryUsage() const {
+        return sizeof(*this) - sizeof(rows) + rows.getMemoryUsage();
+    }
+
+    /**
+     * Removes all elements. No other operations may be conducted concurrently.
+     */
+    void clear() {
+        rows.clear();
+        count.store(0, std::memory_order_relaxed);
+    }
+};
+
+}  // end namespace souffle
@@ -18,38 +18,33 @@
 
 #pragma once
 
-#include "LambdaBTree.h"
 #include "ParallelUtils.h"
 #include "UnionFind.h"
 #include "Util.h"
 #include <algorithm>
+#include <atomic>
 #include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <mutex>
-#include <set>
 #include <shared_mutex>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace souffle {
 template <typename TupleType>
 class EquivalenceRelation {
     using value_type = typename TupleType::value_type;
 
-    // mapping from representative to disjoint set
-    // just a cache, essentially, used for iteration over
-    using StatesList = souffle::PiggyList<value_type>;
-    using StatesBucket = StatesList*;
-    using StorePair = std::pair<value_type, StatesBucket>;
-    using StatesMap = souffle::LambdaBTreeSet<StorePair, std::function<StatesBucket(StorePair&)>,
-            souffle::EqrelMapComparator<StorePair>>;
+    // the members of a disjoint set, a cache used for iterating over its pairs
+    using StatesList = std::vector<value_type>;
+    using StatesBucket = const StatesList*;
 
 public:
     using element_type = TupleType;
 
-    EquivalenceRelation() : statesMapStale(false){};
-    ~EquivalenceRelation() {
-        emptyPartition();
-    }
+    EquivalenceRelation() : statesMapStale(true){};
 
     /**
      * A collection of operation hints speeding up some of the involved operations
@@ -91,13 +86,77 @@ public:
      * @return true if the pair is new to the data structure
      */
     bool insert(value_type x, value_type y, operation_hints) {
-        // indicate that iterators will have to generate on request
-        this->statesMapStale.store(true, std::memory_order_relaxed);
         bool retval = contains(x, y);
-        sds.unionNodes(x, y);
+        if (retval) {
+            return retval;
+        }
+        // without a cache, the iterators will have to generate it on request
+        if (this->statesMapStale.load(std::memory_order_acquire)) {
+            sds.unionNodes(x, y);
+            return retval;
+        }
+        // otherwise, keep the cached disjoint sets consistent with the union
+        statesLock.lock();
+        if (this->statesMapStale.load(std::memory_order_relaxed)) {
+            sds.unionNodes(x, y);
+        } else {
+            unionCached(x, y);
+        }
+        statesLock.unlock();
         return retval;
     }
 
+    /**
+     * Insert count pairs stored consecutively with the given stride, e.g. loaded from a file. The pairs are
+     * inserted in chunks: the distinct values of a chunk are densified in parallel, looking each of them up
+     * in the sparse map once, and the pairs of the chunk are then unioned in parallel by the lock-free
+     * unions of the disjoint set, which split the paths they traverse. The cache of the disjoint sets is
+     * dropped rather than maintained, and regenerated once it is read next.
+     * @param pairs the first pair
+     * @param count the number of pairs
+     * @param stride the distance of consecutive pairs
+     */
+    void insertBulk(const value_type* pairs, std::size_t count, std::size_t stride) {
+        if (count == 0) {
+            return;
+        }
+        statesLock.lock();
+        emptyPartition();
+        statesLock.unlock();
+
+        std::vector<value_type> values;
+        std::vector<parent_t> dense;
+        for (std::size_t begin = 0; begin < count; begin += BULK_CHUNK_SIZE) {
+            const std::size_t end = std::min(count, begin + BULK_CHUNK_SIZE);
+
+            // the distinct values of the chunk, sorted, such that each of them is densified once
+            values.resize(2 * (end - begin));
+            for (std::size_t i = begin; i < end; ++i) {
+                values[2 * (i - begin)] = pairs[i * stride];
+                values[2 * (i - begin) + 1] = pairs[i * stride + 1];
+            }
+            parallelSort(values.begin(), values.end(), std::less<value_type>());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            dense.resize(values.size());
+            PARALLEL_START
+                pfor(std::size_t i = 0; i < values.size(); ++i) {
+                    dense[i] = this->sds.toDense(values[i]);
+                }
+            PARALLEL_END;
+
+            // the dense values of the pairs are found by bisecting the distinct values
+            auto toDense = [&](value_type value) {
+                return dense[std::lower_bound(values.begin(), values.end(), value) - values.begin()];
+            };
+            PARALLEL_START
+                pfor(std::size_t i = begin; i < end; ++i) {
+                    const value_type* pair = pairs + i * stride;
+                    this->sds.ds.unionNodes(toDense(pair[0]), toDense(pair[1]));
+                }
+            PARALLEL_END;
+        }
+    }
+
     /**
      * inserts all nodes from the other relation into this one
      * @param other the binary relation from which to add elements from
@@ -105,19 +164,23 @@ public:
     void insertAll(const EquivalenceRelation<TupleType>& other) {
         other.genAllDisjointSetLists();
 
-        // iterate over partitions at a time
-        for (typename StatesMap::chunk it : other.equivalencePartition.getChunks(MAX_THREADS)) {
-            for (auto& p : it) {
-                value_type rep = p.first;
-                StatesList& pl = *p.second;
-                const size_t ksize = pl.size();
-                for (size_t i = 0; i < ksize; ++i) {
-                    this->sds.unionNodes(rep, pl.get(i));
+        // merge a disjoint set at a time, updating the cache of this relation if present
+        statesLock.lock();
+        const bool stale = this->statesMapStale.load(std::memory_order_relaxed);
+        for (const auto& members : other.equivalencePartition) {
+            if (members == nullptr) {
+                continue;
+            }
+            const value_type rep = members->front();
+            for (const value_type& cur : *members) {
+                if (stale) {
+                    this->sds.unionNodes(rep, cur);
+                } else {
+                    unionCached(rep, cur);
                 }
             }
         }
-        // invalidate iterators unconditionally
-        this->statesMapStale.store(true, std::memory_order_relaxed);
+        statesLock.unlock();
     }
 
     /**
@@ -128,44 +191,36 @@ public:
      */
     void extend(const EquivalenceRelation<TupleType>& other) {
         // nothing to extend if there's no new/original knowledge
-        if (other.size() == 0 || this->size() == 0) return;
+        if (other.empty() || this->empty()) return;
 
-        this->genAllDisjointSetLists();
         other.genAllDisjointSetLists();
 
-        std::set<value_type> repsCovered;
-
-        // find all the disjoint sets that need to be added to this relation
-        // that exist in other (and exist in this)
-        {
-            auto it = this->sds.sparseToDenseMap.begin();
-            auto end = this->sds.sparseToDenseMap.end();
-            value_type el;
-            for (; it != end; ++it) {
-                std::tie(el, std::ignore) = *it;
-                if (other.containsElement(el)) {
-                    value_type rep = other.sds.findNode(el);
-                    if (repsCovered.count(rep) == 0) {
-                        repsCovered.emplace(rep);
-                    }
-                }
+        // find all the disjoint sets of other that contain an element of this relation, in parallel
+        const size_t numElements = this->sds.size();
+        std::vector<parent_t> reps(numElements);
+        std::vector<bool> seen(other.equivalencePartition.size(), false);
+        PARALLEL_START
+            pfor(size_t i = 0; i < numElements; ++i) {
+                const value_type el = this->sds.toSparse(i);
+                reps[i] = other.containsElement(el) ? other.sds.ds.findNode(other.sds.toDense(el))
+                                                    : std::numeric_limits<parent_t>::max();
             }
-        }
+        PARALLEL_END;
 
-        // add the intersecting dj sets into this one
-        {
-            value_type el;
-            value_type rep;
-            auto it = other.sds.sparseToDenseMap.begin();
-            auto end = other.sds.sparseToDenseMap.end();
-            for (; it != end; ++it) {
-                std::tie(el, std::ignore) = *it;
-                rep = other.sds.findNode(el);
-                if (repsCovered.count(rep) != 0) {
-                    this->insert(el, rep);
-                }
+        // add the intersecting dj sets into this one as pairs of their first and other members
+        std::vector<value_type> pairs;
+        for (const parent_t rep : reps) {
+            if (rep == std::numeric_limits<parent_t>::max() || seen[rep]) {
+                continue;
+            }
+            seen[rep] = true;
+            const StatesList& members = *other.equivalencePartition[rep];
+            for (const value_type& cur : members) {
+                pairs.push_back(members.front());
+                pairs.push_back(cur);
             }
         }
+        insertBulk(pairs.data(), pairs.size() / 2, 2);
     }
 
     /**
@@ -186,14 +241,11 @@ public:
     };
 
     void emptyPartition() const {
-        // delete the beautiful values inside (they're raw ptrs, so they need to be.)
-        for (auto& pair : equivalencePartition) {
-            delete pair.second;
-        }
         // invalidate it my dude
         this->statesMapStale.store(true, std::memory_order_relaxed);
 
         equivalencePartition.clear();
+        numPairs = 0;
     }
 
     /**
@@ -208,6 +260,23 @@ public:
         statesLock.unlock();
     }
 
+    /**
+     * Return an estimate of the number of bytes of memory occupied by this relation, including the
+     * cached members of its disjoint sets
+     */
+    size_t getMemoryUsage() const {
+        statesLock.lock_shared();
+        size_t res = sizeof(*this) - sizeof(sds) + sds.getMemoryUsage() +
+                     equivalencePartition.capacity() * sizeof(std::unique_ptr<StatesList>);
+        for (const auto& members : equivalencePartition) {
+            if (members != nullptr) {
+                res += sizeof(StatesList) + members->capacity() * sizeof(value_type);
+            }
+        }
+        statesLock.unlock_shared();
+        return res;
+    }
+
     /**
      * Size of relation
      * @return the sum of the number of pairs per disjoint set
@@ -216,13 +285,7 @@ public:
         genAllDisjointSetLists();
 
         statesLock.lock_shared();
-
-        size_t retVal = 0;
-        for (auto& e : this->equivalencePartition) {
-            const size_t s = e.second->size();
-            retVal += s * s;
-        }
-
+        size_t retVal = numPairs;
         statesLock.unlock_shared();
         return retVal;
     }
@@ -237,16 +300,12 @@ public:
         explicit iterator(const EquivalenceRelation* br, bool /* signalIsEndIterator */)
                 : br(br), isEndVal(true){};
 
-        explicit iterator(const EquivalenceRelation* br)
-                : br(br), ityp(IterType::ALL), djSetMapListIt(br->equivalencePartition.begin()),
-                  djSetMapListEnd(br->equivalencePartition.end()) {
+        explicit iterator(const EquivalenceRelation* br) : br(br), ityp(IterType::ALL) {
             // no need to fast forward if this iterator is empty
-            if (djSetMapListIt == djSetMapListEnd) {
+            if (!seekDjSet()) {
                 isEndVal = true;
                 return;
             }
-            // grab the pointer to the list, and make it our current list
-            djSetList = (*djSetMapListIt).second;
             assert(djSetList->size() != 0);
 
             updateAnterior();
@@ -289,6 +348,18 @@ public:
             setPosterior(latter);
         }
 
+        /** move to the next cached dj set at or after the current position, if any */
+        inline bool seekDjSet() {
+            const auto& partition = br->equivalencePartition;
+            for (; djSetIndex < partition.size(); ++djSetIndex) {
+                if (partition[djSetIndex] != nullptr) {
+                    djSetList = partition[djSetIndex].get();
+                    return true;
+                }
+            }
+            return false;
+        }
+
         /** explicit set first half of cPair */
         inline void setAnterior(const value_type a) {
             this->cPair[0] = a;
@@ -296,7 +367,7 @@ public:
 
         /** quick update to whatever the current index is pointing to */
         inline void updateAnterior() {
-            this->cPair[0] = this->djSetList->get(this->cAnteriorIndex);
+            this->cPair[0] = (*this->djSetList)[this->cAnteriorIndex];
         }
 
         /** explicit set second half of cPair */
@@ -306,7 +377,7 @@ public:
 
         /** quick update to whatever the current index is pointing to */
         inline void updatePosterior() {
-            this->cPair[1] = this->djSetList->get(this->cPosteriorIndex);
+            this->cPair[1] = (*this->djSetList)[this->cPosteriorIndex];
         }
 
         // copy ctor
@@ -349,13 +420,13 @@ public:
                         if (++cAnteriorIndex == djSetList->size()) {
                             // move the djset it along one
                             // see if we can't move it along one (we're at the end)
-                            if (++djSetMapListIt == djSetMapListEnd) {
+                            ++djSetIndex;
+                            if (!seekDjSet()) {
                                 isEndVal = true;
                                 return *this;
                             }
 
                             // we can't iterate along this djset if it is empty
-                            djSetList = (*djSetMapListIt).second;
                             if (djSetList->size() == 0) {
                                 throw std::out_of_range("error: encountered a zero size djset");
                             }
@@ -429,8 +500,8 @@ public:
 
         // the disjoint set that we're currently iterating through
         StatesBucket djSetList;
-        typename StatesMap::iterator djSetMapListIt;
-        typename StatesMap::iterator djSetMapListEnd;
+        // used for ALL, the index of the current dj set in the cache
+        size_t djSetIndex = 0;
 
         // used for ALL, and POSTERIOR (just a current index in the cList)
         size_t cAnteriorIndex = 0;
@@ -548,10 +619,11 @@ public:
     }
 
     /**
-     * Check emptiness.
+     * Check emptiness, which does not need the cache of disjoint sets: every element forms a pair with
+     * itself, such that the relation is empty iff it has no elements.
      */
     bool empty() const {
-        return this->size() == 0;
+        return sds.size() == 0;
     }
 
     /**
@@ -564,10 +636,10 @@ public:
         genAllDisjointSetLists();
 
         // locate the blocklist that the anterior val resides in
-        auto found = equivalencePartition.find({sds.findNode(anteriorVal), nullptr});
-        assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
+        StatesBucket found = getDjSet(anteriorVal);
+        assert(found != nullptr && "iterator called on partition that doesn't exist");
 
-        return iterator(this, anteriorVal, (*found).second);
+        return iterator(this, anteriorVal, found);
     }
 
     /**
@@ -580,15 +652,15 @@ public:
      */
     iterator antpostit(value_type anteriorVal, value_type posteriorVal) const {
         // obv if they're in diff sets, then iteration for this pair just ends.
-        if (!sds.sameSet(anteriorVal, posteriorVal)) return end();
+        if (!sds.contains(anteriorVal, posteriorVal)) return end();
 
         genAllDisjointSetLists();
 
         // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(posteriorVal), nullptr});
-        assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
+        StatesBucket found = getDjSet(posteriorVal);
+        assert(found != nullptr && "iterator called on partition that doesn't exist");
 
-        return iterator(this, anteriorVal, posteriorVal, (*found).second);
+        return iterator(this, anteriorVal, posteriorVal, found);
     }
 
     /**
@@ -600,8 +672,7 @@ public:
         genAllDisjointSetLists();
 
         // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(rep), nullptr});
-        return iterator(this, (*found).second);
+        return iterator(this, getDjSet(rep));
     }
 
     /**
@@ -616,15 +687,22 @@ public:
         // generate all reps
         genAllDisjointSetLists();
 
-        size_t numPairs = this->size();
-        if (numPairs == 0) return {};
-        if (numPairs == 1 || chunks <= 1) return {souffle::make_range(begin(), end())};
+        const size_t totalPairs = this->size();
+        if (totalPairs == 0) return {};
+        if (totalPairs == 1 || chunks <= 1) return {souffle::make_range(begin(), end())};
+
+        std::vector<StatesBucket> djSets;
+        for (const auto& members : equivalencePartition) {
+            if (members != nullptr) {
+                djSets.push_back(members.get());
+            }
+        }
 
         // if there's more dj sets than requested chunks, then just return an iter per dj set
         std::vector<souffle::range<iterator>> ret;
-        if (chunks <= equivalencePartition.size()) {
-            for (auto& p : equivalencePartition) {
-                ret.push_back(souffle::make_range(closure(p.first), end()));
+        if (chunks <= djSets.size()) {
+            for (StatesBucket members : djSets) {
+                ret.push_back(souffle::make_range(iterator(this, members), end()));
             }
             return ret;
         }
@@ -632,15 +710,15 @@ public:
         // keep it simple stupid
         // just go through and if the size of the binrel is > numpairs/chunks, then generate an anteriorIt for
         // each
-        const size_t perchunk = numPairs / chunks;
-        for (const auto& itp : equivalencePartition) {
-            const size_t s = itp.second->size();
+        const size_t perchunk = totalPairs / chunks;
+        for (StatesBucket members : djSets) {
+            const size_t s = members->size();
             if (s * s > perchunk) {
-                for (const auto& i : *itp.second) {
-                    ret.push_back(souffle::make_range(anteriorIt(i), end()));
+                for (const auto& i : *members) {
+                    ret.push_back(souffle::make_range(iterator(this, i, members), end()));
                 }
             } else {
-                ret.push_back(souffle::make_range(closure(itp.first), end()));
+                ret.push_back(souffle::make_range(iterator(this, members), end()));
             }
         }
 
@@ -670,38 +748,94 @@ private:
     // read/write lock on equivalencePartition
     mutable std::shared_mutex statesLock;
 
-    mutable StatesMap equivalencePartition;
+    // the members of each disjoint set, indexed by the dense value of its representative
+    mutable std::vector<std::unique_ptr<StatesList>> equivalencePartition;
+    // the number of pairs of the cached disjoint sets
+    mutable size_t numPairs = 0;
     // whether the cache is stale
     mutable std::atomic<bool> statesMapStale;
 
+    // the number of pairs densified and unioned at a time by insertBulk
+    static constexpr std::size_t BULK_CHUNK_SIZE = 1 << 24;
+
+    /**
+     * Obtain the cached members of the disjoint set of the given value, which must exist.
+     */
+    StatesBucket getDjSet(value_type value) const {
+        return equivalencePartition[sds.ds.findNode(sds.toDense(value))].get();
+    }
+
+    /**
+     * Union the two values, merging their cached disjoint sets. The cache must be present and the
+     * states lock must be held, such that unions updating the cache are conducted in mutual exclusion.
+     */
+    void unionCached(value_type x, value_type y) {
+        const parent_t dx = sds.toDense(x);
+        const parent_t dy = sds.toDense(y);
+
+        // newly created nodes form disjoint sets of their own
+        for (size_t i = equivalencePartition.size(); i < sds.size(); ++i) {
+            equivalencePartition.push_back(std::make_unique<StatesList>(1, sds.toSparse(i)));
+            ++numPairs;
+        }
+
+        const parent_t rx = sds.ds.findNode(dx);
+        const parent_t ry = sds.ds.findNode(dy);
+        if (rx == ry) {
+            return;
+        }
+        sds.ds.unionNodes(dx, dy);
+        const parent_t rep = sds.ds.findNode(dx);
+        auto& target = equivalencePartition[rep];
+        auto& source = equivalencePartition[rep == rx ? ry : rx];
+
+        // append the smaller set to the larger one
+        if (target->size() < source->size()) {
+            std::swap(target, source);
+        }
+        numPairs += 2 * target->size() * source->size();
+        target->insert(target->end(), source->begin(), source->end());
+        source.reset();
+    }
+
     /**
      * Generate a cache of the sets such that they can be iterated over efficiently.
-     * Each set is partitioned into a PiggyList.
+     * The members of each set are collected into an array owned by its representative.
      */
     void genAllDisjointSetLists() const {
-        statesLock.lock();
-
         // no need to generate again, already done.
+        if (!this->statesMapStale.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        statesLock.lock();
         if (!this->statesMapStale.load(std::memory_order_acquire)) {
             statesLock.unlock();
             return;
         }
 
-        // btree version
         emptyPartition();
 
-        size_t dSetSize = this->sds.ds.a_blocks.size();
+        // the representatives are found in parallel, and the members collected in order afterwards
+        const size_t dSetSize = this->sds.size();
+        std::vector<parent_t> reps(dSetSize);
+        PARALLEL_START
+            pfor(size_t i = 0; i < dSetSize; ++i) {
+                reps[i] = this->sds.ds.findNode(i);
+            }
+        PARALLEL_END;
+        equivalencePartition.resize(dSetSize);
         for (size_t i = 0; i < dSetSize; ++i) {
-            typename TupleType::value_type sparseVal = this->sds.toSparse(i);
-            parent_t rep = this->sds.findNode(sparseVal);
-
-            StorePair p = {rep, nullptr};
-            StatesList* mapList = equivalencePartition.insert(p, [&](StorePair& sp) {
-                auto* r = new StatesList(1);
-                sp.second = r;
-                return r;
-            });
-            mapList->append(sparseVal);
+            auto& members = equivalencePartition[reps[i]];
+            if (members == nullptr) {
+                members = std::make_unique<StatesList>();
+            }
+            members->push_back(this->sds.toSparse(i));
+        }
+        for (const auto& members : equivalencePartition) {
+            if (members != nullptr) {
+                numPairs += members->size() * members->size();
+            }
         }
 
         statesMapStale.store(false, std::memory_order_release);
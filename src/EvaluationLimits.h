@@ -0,0 +1,166 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file EvaluationLimits.h
+ *
+ * Cooperative cancellation and wall-time and memory budgets of evaluations
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ResourceLimits.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace souffle {
+
+/**
+ * A token by which an evaluation is cancelled, e.g. from another thread than the one evaluating the
+ * program. Copies of a token share its state, such that cancelling any copy cancels them all.
+ */
+class CancellationToken {
+public:
+    /** cancel the evaluations observing the token */
+    void cancel() {
+        cancelled->store(true, std::memory_order_relaxed);
+    }
+
+    /** whether the token has been cancelled */
+    bool isCancelled() const {
+        return cancelled->load(std::memory_order_relaxed);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+};
+
+/**
+ * Exception thrown by an evaluation that was cancelled or exceeded one of its budgets
+ */
+class EvaluationAborted : public std::runtime_error {
+public:
+    explicit EvaluationAborted(const std::string& reason) : std::runtime_error(reason) {}
+};
+
+/**
+ * The cancellation token and the budgets an evaluation is aborted by.
+ *
+ * The limits are checked at the iterations of fixpoint loops, after parallel queries, and before each
+ * chunk of a parallel scan. The latter only skip the remaining chunks, as exceptions must not leave a
+ * parallel region; the evaluation is aborted once the region has been left. Without a token and
+ * budgets, a check is a single test of a flag.
+ */
+class EvaluationLimits {
+public:
+    /** adopt the token and the budgets of the given limits, e.g. those of a program that is forked */
+    void adopt(const EvaluationLimits& other) {
+        token = other.token;
+        hasToken = other.hasToken;
+        timeBudget = other.timeBudget;
+        memoryBudget = other.memoryBudget;
+        update();
+    }
+
+    /** abort the evaluation once the given token is cancelled */
+    void setCancellationToken(const CancellationToken& cancellationToken) {
+        token = cancellationToken;
+        hasToken = true;
+        update();
+    }
+
+    /** abort the evaluation once it took longer than the given time; zero disables the budget */
+    void setTimeBudget(std::chrono::milliseconds budget) {
+        timeBudget = budget;
+        update();
+    }
+
+    /**
+     * abort the evaluation once the resident memory of the process exceeds the given number of bytes;
+     * zero disables the budget
+     */
+    void setMemoryBudget(std::size_t bytes) {
+        memoryBudget = bytes;
+        update();
+    }
+
+    /** start the budgets of an evaluation */
+    void start() {
+        deadline = std::chrono::steady_clock::now() + timeBudget;
+        nextMemoryCheck = 0;
+        reason = nullptr;
+    }
+
+    /** whether the evaluation is to be aborted; may be called by all threads of the evaluation */
+    bool isExceeded() {
+        if (!limited) {
+            return false;
+        }
+        if (reason.load(std::memory_order_relaxed) != nullptr) {
+            return true;
+        }
+        if (hasToken && token.isCancelled()) {
+            reason = "Evaluation cancelled";
+            return true;
+        }
+        if (timeBudget.count() == 0 && memoryBudget == 0) {
+            return false;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (timeBudget.count() > 0 && now > deadline) {
+            reason = "Evaluation exceeded its time budget";
+            return true;
+        }
+        // reading the resident memory takes a system call, which is made at most once per interval
+        const int64_t ticks =
+                std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        int64_t next = nextMemoryCheck.load(std::memory_order_relaxed);
+        if (memoryBudget > 0 && ticks >= next &&
+                nextMemoryCheck.compare_exchange_strong(next, ticks + memoryCheckInterval)) {
+            if (ResourceLimits::getResidentMemory() > memoryBudget) {
+                reason = "Evaluation exceeded its memory budget";
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** throw an EvaluationAborted exception if the evaluation is to be aborted */
+    void check() {
+        if (isExceeded()) {
+            throw EvaluationAborted(reason.load());
+        }
+    }
+
+private:
+    CancellationToken token;
+    bool hasToken = false;
+    std::chrono::milliseconds timeBudget{0};
+    std::size_t memoryBudget = 0;
+    bool limited = false;
+
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<int64_t> nextMemoryCheck{0};
+    std::atomic<const char*> reason{nullptr};
+
+    /** milliseconds between two readings of the resident memory */
+    static constexpr int64_t memoryCheckInterval = 10;
+
+    void update() {
+        limited = hasToken || timeBudget.count() > 0 || memoryBudget > 0;
+    }
+};
+
+}  // namespace souffle
@@ -377,6 +377,65 @@ public:
     }
 } recursiveRelationNumberProcessor;
 
+/**
+ * Recursive Relation Delta Profile Event Processor, recording the number of tuples of the delta
+ * relation a recursive relation is evaluated on in an iteration
+ */
+const class RecursiveRelationDeltaProcessor : public EventProcessor {
+public:
+    RecursiveRelationDeltaProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@d-recursive-relation", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        size_t number = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "delta-tuples"}, number);
+    }
+} recursiveRelationDeltaProcessor;
+
+/**
+ * Hardware Counters Profile Event Processor, recording the instructions, cache misses and branch
+ * misses counted during the evaluation of a rule or relation next to its runtime
+ */
+const class HardwareCountersProcessor : public EventProcessor {
+public:
+    HardwareCountersProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@h-nonrecursive-rule", this);
+        EventProcessorSingleton::instance().registerEventProcessor("@h-recursive-rule", this);
+        EventProcessorSingleton::instance().registerEventProcessor("@h-nonrecursive-relation", this);
+        EventProcessorSingleton::instance().registerEventProcessor("@h-recursive-relation", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& keyword = signature[0];
+        const std::string& relation = signature[1];
+        size_t instructions = va_arg(args, size_t);
+        size_t cacheMisses = va_arg(args, size_t);
+        size_t branchMisses = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        std::vector<std::string> path;
+        if (keyword == "@h-nonrecursive-rule") {
+            path = {"program", "relation", relation, "non-recursive-rule", signature[3]};
+        } else if (keyword == "@h-recursive-rule") {
+            path = {"program", "relation", relation, "iteration", iteration, "recursive-rule", signature[4],
+                    signature[2]};
+        } else if (keyword == "@h-nonrecursive-relation") {
+            path = {"program", "relation", relation};
+        } else {
+            path = {"program", "relation", relation, "iteration", iteration};
+        }
+        path.push_back("counters");
+        path.push_back("instructions");
+        db.addSizeEntry(path, instructions);
+        path.back() = "cache-misses";
+        db.addSizeEntry(path, cacheMisses);
+        path.back() = "branch-misses";
+        db.addSizeEntry(path, branchMisses);
+    }
+} hardwareCountersProcessor;
+
 /**
  * Recursive Relation Copy Timing Profile Event Processor
  */
@@ -536,6 +595,231 @@ public:
 
 } relationReadsProcessor;
 
+/**
+ * Parallel scan processor, recording how often the parallel operations on a relation were
+ * executed in parallel and how often they ran sequentially, being too small to be split up
+ */
+const class ParallelScansProcessor : public EventProcessor {
+public:
+    ParallelScansProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@parallel-scans", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& mode = signature[2];
+        size_t count = va_arg(args, size_t);
+        db.addSizeEntry({"program", "relation", relation, "parallel-scans", mode}, count);
+    }
+
+} parallelScansProcessor;
+
+/**
+ * Relation statistics processor, recording the number of tuples of a relation and the estimated
+ * number of distinct values of its columns for cost-based optimisations
+ */
+const class RelationStatisticsProcessor : public EventProcessor {
+public:
+    RelationStatisticsProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@relation-statistics", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        size_t number = va_arg(args, size_t);
+        if (signature[2] == "num-tuples") {
+            db.addSizeEntry({"program", "relation", relation, "statistics", "num-tuples"}, number);
+        } else {
+            db.addSizeEntry(
+                    {"program", "relation", relation, "statistics", "distinct-values", signature[3]}, number);
+        }
+    }
+
+} relationStatisticsProcessor;
+
+/**
+ * Relation memory processor, recording the estimated bytes occupied by each index of a relation at the
+ * end of a stratum
+ */
+const class RelationMemoryProcessor : public EventProcessor {
+public:
+    RelationMemoryProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@relation-memory", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& stratum = signature[2];
+        const std::string& index = signature[3];
+        size_t bytes = va_arg(args, size_t);
+        db.addSizeEntry({"program", "memory", stratum, "relation", relation, index}, bytes);
+    }
+} relationMemoryProcessor;
+
+/**
+ * Memory processor, recording the time of the end of a stratum and the estimated bytes occupied by the
+ * symbol and record tables at that time
+ */
+const class MemoryProcessor : public EventProcessor {
+public:
+    MemoryProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@memory", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& stratum = signature[1];
+        const std::string& key = signature[2];
+        if (key == "time") {
+            microseconds time = va_arg(args, microseconds);
+            db.addTimeEntry({"program", "memory", stratum, key}, time);
+        } else {
+            size_t bytes = va_arg(args, size_t);
+            db.addSizeEntry({"program", "memory", stratum, key}, bytes);
+        }
+    }
+} memoryProcessor;
+
+/**
+ * Memory limit processor, recording each round of actions freeing memory once the resident memory of
+ * the program nears its limit: the time, the resident and the estimated bytes at the start of the round,
+ * and the estimated bytes freed by each action on a relation
+ */
+const class MemoryLimitProcessor : public EventProcessor {
+public:
+    MemoryLimitProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@memory-limit", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& round = signature[1];
+        const std::string& key = signature[2];
+        if (key == "time") {
+            microseconds time = va_arg(args, microseconds);
+            db.addTimeEntry({"program", "memory-limit", round, key}, time);
+        } else if (signature.size() > 3) {
+            size_t bytes = va_arg(args, size_t);
+            db.addSizeEntry({"program", "memory-limit", round, key, signature[3]}, bytes);
+        } else {
+            size_t bytes = va_arg(args, size_t);
+            db.addSizeEntry({"program", "memory-limit", round, key}, bytes);
+        }
+    }
+} memoryLimitProcessor;
+
+/**
+ * Relation searches processor, recording how often each search of a relation was executed,
+ * keyed by the search signature, for profile-guided index selection
+ */
+const class RelationSearchesProcessor : public EventProcessor {
+public:
+    RelationSearchesProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@relation-searches", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& search = signature[2];
+        size_t count = va_arg(args, size_t);
+        db.addSizeEntry({"program", "searches", relation, search}, count);
+    }
+
+} relationSearchesProcessor;
+
+/**
+ * Relation search tuples processor, recording the number of tuples found by the executions of each
+ * search of a relation, keyed by the search signature
+ */
+const class RelationSearchTuplesProcessor : public EventProcessor {
+public:
+    RelationSearchTuplesProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@relation-search-tuples", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& search = signature[2];
+        size_t count = va_arg(args, size_t);
+        db.addSizeEntry({"program", "search-tuples", relation, search}, count);
+    }
+
+} relationSearchTuplesProcessor;
+
+/**
+ * Relation hints processor, recording the hits and misses of the operation hints of each index of
+ * a relation
+ */
+const class RelationHintsProcessor : public EventProcessor {
+public:
+    RelationHintsProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@relation-hints", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& index = signature[2];
+        const std::string& operation = signature[3];
+        const std::string& outcome = signature[4];
+        size_t count = va_arg(args, size_t);
+        db.addSizeEntry({"program", "hints", relation, index, operation, outcome}, count);
+    }
+
+} relationHintsProcessor;
+
+/**
+ * Samples processor, recording the samples of the CPU time of the program attributed to each rule,
+ * keyed by the message of the rule, and to the time outside of rules, keyed by "other"
+ */
+const class SamplesProcessor : public EventProcessor {
+public:
+    SamplesProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@samples", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& rule = signature[1];
+        size_t count = va_arg(args, size_t);
+        db.addSizeEntry({"program", "samples", rule}, count);
+    }
+
+} samplesProcessor;
+
+/**
+ * Parallel loops processor, recording the utilisation of the threads of the parallel loops of each rule,
+ * keyed by the message of the rule, and of the loops outside of rules, keyed by "other"
+ */
+const class ParallelLoopsProcessor : public EventProcessor {
+public:
+    ParallelLoopsProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@parallel-loops", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& rule = signature[1];
+        const std::string& metric = signature[2];
+        size_t value = va_arg(args, size_t);
+        db.addSizeEntry({"program", "parallel-loops", rule, metric}, value);
+    }
+
+} parallelLoopsProcessor;
+
+/**
+ * Node pool processor, recording the memory reserved for and used by the nodes of the
+ * relation data structures
+ */
+const class NodePoolProcessor : public EventProcessor {
+public:
+    NodePoolProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@node-pool", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& kind = signature[1];
+        size_t bytes = va_arg(args, size_t);
+        db.addSizeEntry({"program", "node-pool", kind}, bytes);
+    }
+
+} nodePoolProcessor;
+
 /**
  * Config entry processor
  */
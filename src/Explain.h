@@ -54,6 +54,7 @@ public:
     std::unique_ptr<std::ostream> outputStream = nullptr;
     bool json = false;
     int depthLimit = 4;
+    size_t cacheSize = 64;
 
 private:
     ExplainConfig() = default;
@@ -87,6 +88,20 @@ public:
                 return true;
             }
             printInfo("Depth is now " + std::to_string(ExplainConfig::getExplainConfig().depthLimit) + "\n");
+        } else if (command[0] == "setcache") {
+            if (command.size() != 2) {
+                printError("Usage: setcache <megabytes>\n");
+                return true;
+            }
+            try {
+                ExplainConfig::getExplainConfig().cacheSize = std::stoul(command[1]);
+            } catch (std::exception& e) {
+                printError("<" + command[1] + "> is not a valid size\n");
+                return true;
+            }
+            prov.setSubproofCacheSize(ExplainConfig::getExplainConfig().cacheSize << 20);
+            printInfo("Subproof cache is now " + std::to_string(ExplainConfig::getExplainConfig().cacheSize) +
+                      " MB\n");
         } else if (command[0] == "explain") {
             std::pair<std::string, std::vector<std::string>> query;
             if (command.size() != 2) {
@@ -247,6 +262,7 @@ public:
                     "Commands:\n"
                     "----------\n"
                     "setdepth <depth>: Set a limit for printed derivation tree height\n"
+                    "setcache <megabytes>: Set the memory for memoised subproofs, 0 disables them\n"
                     "explain <relation>(<element1>, <element2>, ...): Prints derivation tree\n"
                     "explainnegation <relation>(<element1>, <element2>, ...): Enters an interactive\n"
                     "    interface where the non-existence of a tuple can be explained\n"
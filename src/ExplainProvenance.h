@@ -19,8 +19,11 @@
 #include "ExplainTree.h"
 #include "RamTypes.h"
 #include "SouffleInterface.h"
+#include "SubroutineCache.h"
 #include "WriteStreamCSV.h"
 
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -72,7 +75,7 @@ public:
     }
 
     /** Get indices of equivalent variables */
-    std::vector<std::pair<size_t, size_t>> getIndices() {
+    const std::vector<std::pair<size_t, size_t>>& getIndices() const {
         return indices;
     }
 
@@ -121,6 +124,11 @@ public:
         return constConstrs;
     }
 
+    /** Get the constant constraint vector */
+    const std::vector<std::pair<std::pair<size_t, size_t>, RamDomain>>& getConstraints() const {
+        return constConstrs;
+    }
+
 private:
     std::vector<std::pair<std::pair<size_t, size_t>, RamDomain>> constConstrs;
 };
@@ -159,6 +167,15 @@ public:
     virtual std::unique_ptr<TreeNode> explainSubproof(
             std::string relName, RamDomain label, size_t depthLimit) = 0;
 
+    /**
+     * Explain each of the given tuples, expanding their proof trees in parallel
+     * @param queries, vector of relation, argument pairs
+     * @return the proof trees in the order of the queries
+     */
+    virtual std::vector<std::unique_ptr<TreeNode>> explainAll(
+            const std::vector<std::pair<std::string, std::vector<std::string>>>& queries,
+            size_t depthLimit) = 0;
+
     virtual std::vector<std::string> explainNegationGetVariables(
             std::string relName, std::vector<std::string> args, size_t ruleNum) = 0;
 
@@ -173,6 +190,12 @@ public:
 
     virtual void printRulesJSON(std::ostream& os) = 0;
 
+    /**
+     * Set the memory for memoising the subproofs of explanations
+     * @param bytes, the number of bytes of the memoised subproofs
+     */
+    virtual void setSubproofCacheSize(size_t bytes) = 0;
+
     /**
      * Process query with given arguments
      * @param rels, vector of relation, argument pairs
@@ -18,13 +18,17 @@
 
 #include "BinaryConstraintOps.h"
 #include "ExplainProvenance.h"
+#include "ParallelUtils.h"
 #include "Util.h"
 
 #include <algorithm>
 #include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -93,15 +97,14 @@ public:
                 tuple.push_back(subtreeLevel);
             }
 
-            // find if subproof exists already
-            size_t idx = 0;
-            auto it = std::find(subproofs.begin(), subproofs.end(), tuple);
-            if (it != subproofs.end()) {
-                idx = it - subproofs.begin();
-            } else {
+            // find if subproof exists already, the subproofs are shared by concurrent explanations
+            std::lock_guard<std::mutex> guard(subproofsLock);
+            auto it = subproofIndex.find(tuple);
+            if (it == subproofIndex.end()) {
+                it = subproofIndex.emplace(tuple, subproofs.size()).first;
                 subproofs.push_back(tuple);
-                idx = subproofs.size() - 1;
             }
+            size_t idx = it->second;
 
             return std::make_unique<LeafNode>("subproof " + relName + "(" + std::to_string(idx) + ")");
         }
@@ -121,12 +124,16 @@ public:
             tuple.push_back(levelNum);
         }
 
-        // execute subroutine to get subproofs
-        prog.executeSubroutine(relName + "_" + std::to_string(ruleNum) + "_subproof", tuple, ret);
+        // execute subroutine to get subproofs, unless its result is memoised
+        const std::string subroutine = relName + "_" + std::to_string(ruleNum) + "_subproof";
+        if (!subproofCache.lookup(subroutine, tuple, ret)) {
+            prog.executeSubroutine(subroutine, tuple, ret);
+            subproofCache.insert(subroutine, tuple, ret);
+        }
 
         // recursively get nodes for subproofs
         size_t tupleCurInd = 0;
-        auto bodyRelations = info[std::make_pair(relName, ruleNum)];
+        const auto& bodyRelations = info.at(std::make_pair(relName, ruleNum));
 
         // start from begin + 1 because the first element represents the head atom
         for (auto it = bodyRelations.begin() + 1; it < bodyRelations.end(); it++) {
@@ -217,6 +224,11 @@ public:
             return std::make_unique<LeafNode>("Relation not found");
         }
 
+        // relations not listed in provenance-relations have no annotations to explain them by
+        if (prog.getRelation(relName)->getAuxiliaryArity() == 0) {
+            return std::make_unique<LeafNode>("Relation not annotated with provenance");
+        }
+
         std::tuple<int, int, std::vector<RamDomain>> tupleInfo = findTuple(relName, tuple);
 
         int ruleNum = std::get<0>(tupleInfo);
@@ -230,14 +242,33 @@ public:
         return explain(relName, tuple, ruleNum, levelNum, subtreeLevels, depthLimit);
     }
 
+    /**
+     * The explanations only read the program, whose subroutines may be executed concurrently. The
+     * numbering of the subproofs cut off by the depth limit depends on the order of their evaluation.
+     */
+    std::vector<std::unique_ptr<TreeNode>> explainAll(
+            const std::vector<std::pair<std::string, std::vector<std::string>>>& queries,
+            size_t depthLimit) override {
+        std::vector<std::unique_ptr<TreeNode>> trees(queries.size());
+        PARALLEL_START
+        pfor(size_t i = 0; i < queries.size(); i++) {
+            trees[i] = explain(queries[i].first, queries[i].second, depthLimit);
+        }
+        PARALLEL_END
+        return trees;
+    }
+
     std::unique_ptr<TreeNode> explainSubproof(
             std::string relName, RamDomain subproofNum, size_t depthLimit) override {
-        if (subproofNum >= (int)subproofs.size()) {
-            return std::make_unique<LeafNode>("Subproof not found");
+        std::vector<RamDomain> tup;
+        {
+            std::lock_guard<std::mutex> guard(subproofsLock);
+            if (subproofNum >= (int)subproofs.size()) {
+                return std::make_unique<LeafNode>("Subproof not found");
+            }
+            tup = subproofs[subproofNum];
         }
 
-        auto tup = subproofs[subproofNum];
-
         auto rel = prog.getRelation(relName);
 
         RamDomain ruleNum;
@@ -602,6 +633,10 @@ public:
         os << "\n]\n";
     }
 
+    void setSubproofCacheSize(size_t bytes) override {
+        subproofCache.setCapacity(bytes);
+    }
+
     void queryProcess(const std::vector<std::pair<std::string, std::vector<std::string>>>& rels) override {
         std::regex varRegex("[a-zA-Z_][a-zA-Z_0-9]*", std::regex_constants::extended);
         std::regex symbolRegex("\"([^\"]*)\"", std::regex_constants::extended);
@@ -663,7 +698,7 @@ public:
                         return;
                     }
                     // find index of symbol and add indices pair to constConstraints
-                    RamDomain rd = prog.getSymbolTable().lookup(argsMatcher[1]);
+                    RamDomain rd = prog.getSymbolTable().lookup(argsMatcher[1].str());
                     constConstraints.push_back(std::make_pair(std::make_pair(idx, j), rd));
                     if (!containVar) {
                         constTuple.push_back(rd);
@@ -725,6 +760,9 @@ private:
     std::map<std::pair<std::string, size_t>, std::vector<std::string>> info;
     std::map<std::pair<std::string, size_t>, std::string> rules;
     std::vector<std::vector<RamDomain>> subproofs;
+    std::map<std::vector<RamDomain>, size_t> subproofIndex;
+    std::mutex subproofsLock;
+    SubroutineCache subproofCache{64 << 20};
     std::vector<std::string> constraintList = {
             "=", "!=", "<", "<=", ">=", ">", "match", "contains", "not_match", "not_contains"};
 
@@ -732,7 +770,7 @@ private:
             const std::string& relName, std::vector<RamDomain> tup) {
         auto rel = prog.getRelation(relName);
 
-        if (rel == nullptr) {
+        if (rel == nullptr || rel->getAuxiliaryArity() == 0) {
             return std::make_tuple(-1, -1, std::vector<RamDomain>());
         }
 
@@ -786,6 +824,12 @@ private:
 
     /*
      * Find solution for parameterised query satisfying constant constraints and equivalence constraints
+     *
+     * The relations are joined by an index nested loop: each relation is looked up by the columns bound by
+     * constants and by the variables of the relations joined before it, such that the lookups use the
+     * indexes of the relations instead of enumerating the product of the relations. The relations with
+     * the most bound columns are joined first.
+     *
      * @param varRels, reference to vector of relation of tuple contains at least one variable in its
      * arguments
      * @param nameToEquivalence, reference to variable name and corresponding equivalence class
@@ -794,84 +838,147 @@ private:
     void findQuerySolution(const std::vector<Relation*>& varRels,
             const std::map<std::string, Equivalence>& nameToEquivalence,
             const ConstConstraint& constConstraints) {
-        // vector of iterators for relations in varRels
-        std::vector<Relation::iterator> varRelationIterators;
-        for (auto relation : varRels) {
-            varRelationIterators.push_back(relation->begin());
+        const size_t numRels = varRels.size();
+
+        // the constants and variables of the columns of each relation
+        std::vector<std::vector<std::pair<size_t, RamDomain>>> relConsts(numRels);
+        std::vector<std::vector<std::pair<size_t, std::string>>> relVars(numRels);
+        for (const auto& constr : constConstraints.getConstraints()) {
+            relConsts[constr.first.first].push_back({constr.first.second, constr.second});
+        }
+        for (const auto& var : nameToEquivalence) {
+            for (const auto& idx : var.second.getIndices()) {
+                relVars[idx.first].push_back({idx.second, var.first});
+            }
+        }
+
+        // order the relations by the number of columns bound when they are joined, then by their size
+        std::vector<size_t> order;
+        std::vector<bool> joined(numRels, false);
+        std::set<std::string> boundVars;
+        while (order.size() < numRels) {
+            size_t best = numRels;
+            size_t bestBound = 0;
+            for (size_t i = 0; i < numRels; ++i) {
+                if (joined[i]) {
+                    continue;
+                }
+                size_t bound = relConsts[i].size();
+                for (const auto& var : relVars[i]) {
+                    bound += boundVars.count(var.second);
+                }
+                if (best == numRels || bound > bestBound ||
+                        (bound == bestBound && varRels[i]->size() < varRels[best]->size())) {
+                    best = i;
+                    bestBound = bound;
+                }
+            }
+            order.push_back(best);
+            joined[best] = true;
+            for (const auto& var : relVars[best]) {
+                boundVars.insert(var.second);
+            }
+        }
+
+        // the lookup of each step of the join: the columns bound by constants, the columns bound by the
+        // columns of relations joined before, and the pairs of columns of a variable within the relation
+        struct Lookup {
+            std::vector<size_t> columns;
+            std::vector<RamDomain> constants;
+            std::vector<std::pair<size_t, size_t>> sources;
+            std::vector<std::pair<size_t, size_t>> equalColumns;
+        };
+        std::vector<Lookup> lookups(numRels);
+        std::map<std::string, std::pair<size_t, size_t>> firstOccurrence;
+        for (size_t step = 0; step < numRels; ++step) {
+            const size_t rel = order[step];
+            Lookup& lookup = lookups[step];
+            for (const auto& cur : relConsts[rel]) {
+                lookup.columns.push_back(cur.first);
+                lookup.constants.push_back(cur.second);
+            }
+            for (const auto& var : relVars[rel]) {
+                auto pos = firstOccurrence.find(var.second);
+                if (pos == firstOccurrence.end()) {
+                    firstOccurrence[var.second] = {rel, var.first};
+                } else if (pos->second.first == rel) {
+                    lookup.equalColumns.push_back({pos->second.second, var.first});
+                } else {
+                    lookup.columns.push_back(var.first);
+                    lookup.sources.push_back(pos->second);
+                }
+            }
         }
 
         size_t solutionCount = 0;
+        bool stopped = false;
         std::stringstream solution;
 
-        // iterate through the vector of iterators to find solution
-        while (true) {
-            bool isSolution = true;
+        // the attributes of the tuple of each relation in the current solution
+        std::vector<std::vector<RamDomain>> element(numRels);
 
-            // vector contains the tuples the iterators currently points to
-            std::vector<tuple> element;
-            for (auto it : varRelationIterators) {
-                element.push_back(*it);
-            }
-            // check if tuple satisfies variable equivalence
+        auto printSolution = [&]() {
+            size_t c = 0;
             for (auto var : nameToEquivalence) {
-                if (!var.second.verify(element)) {
-                    isSolution = false;
-                    break;
+                auto idx = var.second.getFirstIdx();
+                if (var.second.getType() == 'i') {
+                    solution << var.second.getSymbol() << " = "
+                             << std::to_string(element[idx.first][idx.second]);
+                } else {
+                    solution << var.second.getSymbol() << " = "
+                             << prog.getSymbolTable().resolve(element[idx.first][idx.second]);
+                }
+                if (++c < nameToEquivalence.size()) {
+                    solution << ", ";
+                } else {
+                    solution << " ";
                 }
             }
-            if (isSolution) {
-                // check if tuple satisfies constant constraints
-                isSolution = constConstraints.verify(element);
+        };
+
+        std::function<void(size_t)> join = [&](size_t step) {
+            const size_t rel = order[step];
+            const Lookup& lookup = lookups[step];
+            std::vector<RamDomain> values(lookup.constants);
+            for (const auto& source : lookup.sources) {
+                values.push_back(element[source.first][source.second]);
             }
+            varRels[rel]->equalRange(lookup.columns, values, [&](const tuple& t) {
+                if (stopped) {
+                    return;
+                }
+                for (const auto& cols : lookup.equalColumns) {
+                    if (t[cols.first] != t[cols.second]) {
+                        return;
+                    }
+                }
+                element[rel].resize(varRels[rel]->getArity());
+                for (size_t i = 0; i < element[rel].size(); ++i) {
+                    element[rel][i] = t[i];
+                }
+                if (step + 1 < numRels) {
+                    join(step + 1);
+                    return;
+                }
 
-            if (isSolution) {
                 solutionCount++;
                 // first solution has been found
                 if (solutionCount == 1) {
-                    size_t c = 0;
-                    for (auto var : nameToEquivalence) {
-                        auto idx = var.second.getFirstIdx();
-                        if (var.second.getType() == 'i') {
-                            solution << var.second.getSymbol() << " = "
-                                     << std::to_string(element[idx.first][idx.second]);
-                        } else {
-                            solution << var.second.getSymbol() << " = "
-                                     << prog.getSymbolTable().resolve(element[idx.first][idx.second]);
-                        }
-                        if (++c < nameToEquivalence.size()) {
-                            solution << ", ";
-                        } else {
-                            solution << " ";
-                        }
-                    }
+                    printSolution();
                     // query has more than one solution
                 } else {
                     // print previous solution
                     std::cout << solution.str();
                     // store the current solution
                     solution.str(std::string());
-                    size_t c = 0;
-                    for (auto var : nameToEquivalence) {
-                        auto idx = var.second.getFirstIdx();
-                        if (var.second.getType() == 'i') {
-                            solution << var.second.getSymbol() << " = "
-                                     << std::to_string(element[idx.first][idx.second]);
-                        } else {
-                            solution << var.second.getSymbol() << " = "
-                                     << prog.getSymbolTable().resolve(element[idx.first][idx.second]);
-                        }
-                        if (++c < nameToEquivalence.size()) {
-                            solution << ", ";
-                        } else {
-                            solution << " ";
-                        }
-                    }
+                    printSolution();
                     std::string input;
                     // get user input whether find next solution or break from current query
                     while (getline(std::cin, input)) {
                         if (input == ";") {
                             break;
                         } else if (input == ".") {
+                            stopped = true;
                             return;
                         } else {
                             std::cout << "use ; to find next solution, use . to break from current query"
@@ -879,49 +986,30 @@ private:
                         }
                     }
                 }
-            }
-            // increment the iterators
-            size_t i = varRels.size() - 1;
-            bool terminate = true;
-            for (auto it = varRelationIterators.rbegin(); it != varRelationIterators.rend(); ++it) {
-                if ((++(*it)) != varRels[i]->end()) {
-                    terminate = false;
-                    break;
-                } else {
-                    (*it) = varRels[i]->begin();
-                    --i;
-                }
-            }
+            });
+        };
+        join(0);
 
-            if (terminate) {
-                // if there is no solution, output false
-                if (solutionCount == 0) {
-                    std::cout << "false." << std::endl;
-                    // otherwise print the last solution
-                } else {
-                    std::cout << solution.str() << "." << std::endl;
-                }
-                break;
-            }
+        if (stopped) {
+            return;
+        }
+        // if there is no solution, output false
+        if (solutionCount == 0) {
+            std::cout << "false." << std::endl;
+            // otherwise print the last solution
+        } else {
+            std::cout << solution.str() << "." << std::endl;
         }
     }
 
-    // check if constTuple exists in relation
+    // check if constTuple exists in relation, looking it up by the index of the relation
     bool containsTuple(Relation* relation, const std::vector<RamDomain>& constTuple) {
-        bool tupleExist = false;
-        for (auto it = relation->begin(); it != relation->end(); ++it) {
-            bool eq = true;
-            for (size_t j = 0; j < constTuple.size(); ++j) {
-                if (constTuple[j] != (*it)[j]) {
-                    eq = false;
-                    break;
-                }
-            }
-            if (eq) {
-                tupleExist = true;
-                break;
-            }
+        std::vector<size_t> columns;
+        for (size_t j = 0; j < constTuple.size(); ++j) {
+            columns.push_back(j);
         }
+        bool tupleExist = false;
+        relation->equalRange(columns, constTuple, [&](const tuple&) { tupleExist = true; });
         return tupleExist;
     }
 };
@@ -0,0 +1,489 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ExternalSet.h
+ *
+ * This header file contains the implementation of an ordered set of tuples
+ * that is kept on disk once it outgrows its share of the main memory.
+ *
+ * Following log-structured merge trees, inserted elements are collected in
+ * an in-memory b-tree buffer. When the buffer exceeds its budget at a spill
+ * point, it is written as a sorted run to a temporary file, which is mapped
+ * into memory read-only; hence the pages of the runs are cached by the
+ * operating system and evicted under memory pressure. Runs of similar sizes
+ * are merged, such that a set of n elements consists of O(log n) runs. The
+ * buffer and the runs are disjoint, and iterators merge them in order.
+ *
+ * Single inserts and all reading operations may be conducted concurrently,
+ * while spilling the buffer must not overlap with any other operation.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BTree.h"
+#include "Util.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * The limits of the main memory occupied by the buffers of all external sets.
+ */
+struct ExternalMemory {
+    /** The directory of the files of spilled runs, the temporary directory if empty */
+    static inline std::string directory;
+
+    /** The number of bytes buffered by all external sets before they spill, 0 for no shared budget */
+    static inline std::atomic<std::size_t> budget{0};
+
+    /** The number of bytes buffered by all external sets, as of their most recent spill points */
+    static inline std::atomic<std::size_t> buffered{0};
+
+    /** The number of bytes a single buffer may occupy if there is no shared budget */
+    static constexpr std::size_t DEFAULT_BUFFER_BYTES = std::size_t(64) << 20;
+
+    /** Obtains the directory of spilled runs */
+    static std::string getDirectory() {
+        if (!directory.empty()) {
+            return directory;
+        }
+        const char* tmp = std::getenv("TMPDIR");
+        return tmp != nullptr && *tmp != '\0' ? tmp : "/tmp";
+    }
+};
+
+/**
+ * An ordered set of tuples whose elements are spilled to sorted runs on disk.
+ *
+ * @tparam T the type of the elements, a tuple of RamDomain values ordered lexicographically
+ */
+template <typename T>
+class ExternalSet {
+    // the in-memory buffer of recently inserted elements
+    using Buffer = btree_set<T>;
+
+    /**
+     * A sorted run of elements, stored in an unlinked temporary file that is mapped into memory.
+     */
+    class Run {
+        int fd = -1;
+        T* data = nullptr;
+        std::size_t count = 0;
+
+        // the elements appended but not yet written
+        std::vector<T> pending;
+
+        // the number of elements of a write
+        static constexpr std::size_t WRITE_CHUNK = 4096;
+
+        void write() {
+            const char* pos = reinterpret_cast<const char*>(pending.data());
+            std::size_t remaining = pending.size() * sizeof(T);
+            while (remaining > 0) {
+                ssize_t written = ::write(fd, pos, remaining);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written < 0) {
+                    throw std::runtime_error(
+                            "cannot write spilled relation to " + ExternalMemory::getDirectory());
+                }
+                pos += written;
+                remaining -= written;
+            }
+            pending.clear();
+        }
+
+    public:
+        Run() {
+            std::string path = ExternalMemory::getDirectory() + "/souffle-run-XXXXXX";
+            fd = mkstemp(&path[0]);
+            if (fd < 0) {
+                throw std::runtime_error(
+                        "cannot create spilled relation in " + ExternalMemory::getDirectory());
+            }
+            // the file is removed once it is closed
+            unlink(path.c_str());
+            pending.reserve(WRITE_CHUNK);
+        }
+
+        Run(const Run&) = delete;
+        Run& operator=(const Run&) = delete;
+
+        ~Run() {
+            if (data != nullptr) {
+                munmap(data, count * sizeof(T));
+            }
+            close(fd);
+        }
+
+        /** Appends an element greater than all elements of this run, before it is finished */
+        void append(const T& value) {
+            pending.push_back(value);
+            ++count;
+            if (pending.size() == WRITE_CHUNK) {
+                write();
+            }
+        }
+
+        /** Writes the remaining elements and maps the run into memory */
+        void finish() {
+            write();
+            pending.shrink_to_fit();
+            if (count == 0) {
+                return;
+            }
+            void* res = mmap(nullptr, count * sizeof(T), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (res == MAP_FAILED) {
+                throw std::runtime_error("cannot map spilled relation");
+            }
+            data = static_cast<T*>(res);
+        }
+
+        const T* begin() const {
+            return data;
+        }
+
+        const T* end() const {
+            return data + count;
+        }
+
+        std::size_t size() const {
+            return count;
+        }
+    };
+
+    // the buffer of elements not yet spilled
+    Buffer buffer;
+
+    // the spilled runs, ordered by decreasing size
+    std::vector<std::unique_ptr<Run>> runs;
+
+    // the number of elements of all runs
+    std::size_t numSpilled = 0;
+
+    // the number of bytes accounted to this set in the shared budget
+    std::size_t accounted = 0;
+
+    // updates the bytes of the buffer accounted in the shared budget, returning the bytes of the buffer
+    std::size_t account() {
+        const std::size_t bytes = buffer.size() * sizeof(T);
+        ExternalMemory::buffered += bytes;
+        ExternalMemory::buffered -= accounted;
+        accounted = bytes;
+        return bytes;
+    }
+
+public:
+    using element_type = T;
+
+    // external sets do not utilise operation hints
+    struct operation_hints {};
+
+    /**
+     * An iterator over the elements of the set, merging the buffer and the runs.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, T> {
+        using buffer_iterator = typename Buffer::iterator;
+
+        // the positions in the buffer
+        buffer_iterator cur;
+        buffer_iterator last;
+
+        // the positions in the runs, each paired with the end of the run
+        std::vector<std::pair<const T*, const T*>> positions;
+
+        // the current element, or null at the end
+        const T* value = nullptr;
+
+        friend class ExternalSet;
+
+        iterator(buffer_iterator cur, buffer_iterator last,
+                std::vector<std::pair<const T*, const T*>> positions)
+                : cur(std::move(cur)), last(std::move(last)), positions(std::move(positions)) {
+            settle();
+        }
+
+        // selects the least element of the buffer and the runs
+        void settle() {
+            value = cur != last ? &*cur : nullptr;
+            for (const auto& pos : positions) {
+                if (pos.first != pos.second && (value == nullptr || *pos.first < *value)) {
+                    value = pos.first;
+                }
+            }
+        }
+
+    public:
+        // the end iterator of an empty set
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return cur == other.cur && positions == other.positions;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const T& operator*() const {
+            return *value;
+        }
+
+        const T* operator->() const {
+            return value;
+        }
+
+        iterator& operator++() {
+            // the buffer and the runs are disjoint, hence a single component holds the current element
+            if (cur != last && &*cur == value) {
+                ++cur;
+            } else {
+                for (auto& pos : positions) {
+                    if (pos.first == value) {
+                        ++pos.first;
+                        break;
+                    }
+                }
+            }
+            settle();
+            return *this;
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    ExternalSet() = default;
+
+    ExternalSet(const ExternalSet&) = delete;
+    ExternalSet& operator=(const ExternalSet&) = delete;
+
+    ~ExternalSet() {
+        ExternalMemory::buffered -= accounted;
+    }
+
+    bool empty() const {
+        return numSpilled == 0 && buffer.empty();
+    }
+
+    std::size_t size() const {
+        return numSpilled + buffer.size();
+    }
+
+    /**
+     * Inserts the given element into the buffer, returning whether it was not present before.
+     */
+    bool insert(const T& value) {
+        operation_hints hints;
+        return insert(value, hints);
+    }
+
+    bool insert(const T& value, operation_hints& /* hints */) {
+        for (const auto& run : runs) {
+            if (std::binary_search(run->begin(), run->end(), value)) {
+                return false;
+            }
+        }
+        return buffer.insert(value);
+    }
+
+    bool contains(const T& value) const {
+        operation_hints hints;
+        return contains(value, hints);
+    }
+
+    bool contains(const T& value, operation_hints& /* hints */) const {
+        for (const auto& run : runs) {
+            if (std::binary_search(run->begin(), run->end(), value)) {
+                return true;
+            }
+        }
+        return buffer.contains(value);
+    }
+
+    iterator find(const T& value, operation_hints& hints) const {
+        iterator pos = lower_bound(value, hints);
+        if (pos != end() && *pos == value) {
+            return pos;
+        }
+        return end();
+    }
+
+    /**
+     * Obtains an iterator to the first element not less than the given value.
+     */
+    iterator lower_bound(const T& value, operation_hints& /* hints */) const {
+        std::vector<std::pair<const T*, const T*>> positions;
+        positions.reserve(runs.size());
+        for (const auto& run : runs) {
+            positions.emplace_back(std::lower_bound(run->begin(), run->end(), value), run->end());
+        }
+        return iterator(buffer.lower_bound(value), buffer.end(), std::move(positions));
+    }
+
+    /**
+     * Obtains an iterator to the first element greater than the given value.
+     */
+    iterator upper_bound(const T& value, operation_hints& /* hints */) const {
+        std::vector<std::pair<const T*, const T*>> positions;
+        positions.reserve(runs.size());
+        for (const auto& run : runs) {
+            positions.emplace_back(std::upper_bound(run->begin(), run->end(), value), run->end());
+        }
+        return iterator(buffer.upper_bound(value), buffer.end(), std::move(positions));
+    }
+
+    iterator begin() const {
+        std::vector<std::pair<const T*, const T*>> positions;
+        positions.reserve(runs.size());
+        for (const auto& run : runs) {
+            positions.emplace_back(run->begin(), run->end());
+        }
+        return iterator(buffer.begin(), buffer.end(), std::move(positions));
+    }
+
+    iterator end() const {
+        std::vector<std::pair<const T*, const T*>> positions;
+        positions.reserve(runs.size());
+        for (const auto& run : runs) {
+            positions.emplace_back(run->end(), run->end());
+        }
+        return iterator(buffer.end(), buffer.end(), std::move(positions));
+    }
+
+    /**
+     * Partitions this set into at most the given number of chunks, split at elements of the
+     * largest run, or of the buffer if nothing is spilled.
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        std::vector<chunk> res;
+        if (empty()) {
+            return res;
+        }
+        std::vector<T> pivots;
+        if (runs.empty()) {
+            auto chunks = buffer.partition(num);
+            for (std::size_t i = 1; i < chunks.size(); ++i) {
+                pivots.push_back(*chunks[i].begin());
+            }
+        } else {
+            const Run& largest = *runs.front();
+            num = std::max<std::size_t>(1, std::min(num, largest.size()));
+            for (std::size_t i = 1; i < num; ++i) {
+                pivots.push_back(largest.begin()[largest.size() * i / num]);
+            }
+        }
+        operation_hints hints;
+        iterator first = begin();
+        for (const T& pivot : pivots) {
+            iterator next = lower_bound(pivot, hints);
+            res.emplace_back(first, next);
+            first = next;
+        }
+        res.emplace_back(first, end());
+        return res;
+    }
+
+    /**
+     * Writes the buffer to a new run if it exceeds its budget, i.e. if it is larger than the shared
+     * budget of all buffers, or if all buffers together exceed the shared budget. No other operations
+     * may be conducted concurrently.
+     */
+    void spill() {
+        const std::size_t bytes = account();
+        const std::size_t budget = ExternalMemory::budget;
+        if (bytes == 0) {
+            return;
+        }
+        if (budget == 0 ? bytes <= ExternalMemory::DEFAULT_BUFFER_BYTES
+                        : bytes <= budget && ExternalMemory::buffered <= budget) {
+            return;
+        }
+        flush();
+    }
+
+    /**
+     * Writes the buffer to a new run, merging the runs of similar sizes. No other operations may
+     * be conducted concurrently.
+     */
+    void flush() {
+        if (buffer.empty()) {
+            return;
+        }
+        auto run = std::make_unique<Run>();
+        for (const T& cur : buffer) {
+            run->append(cur);
+        }
+        run->finish();
+        numSpilled += run->size();
+        runs.push_back(std::move(run));
+        buffer.clear();
+        account();
+
+        // merge the smallest runs until each run is more than twice as large as the next one
+        while (runs.size() >= 2 && runs[runs.size() - 2]->size() <= 2 * runs.back()->size()) {
+            const Run& a = *runs[runs.size() - 2];
+            const Run& b = *runs.back();
+            auto merged = std::make_unique<Run>();
+            const T* i = a.begin();
+            const T* j = b.begin();
+            while (i != a.end() || j != b.end()) {
+                if (j == b.end() || (i != a.end() && *i < *j)) {
+                    merged->append(*i++);
+                } else {
+                    merged->append(*j++);
+                }
+            }
+            merged->finish();
+            runs.pop_back();
+            runs.back() = std::move(merged);
+        }
+    }
+
+    /**
+     * Removes all elements. No other operations may be conducted concurrently.
+     */
+    void clear() {
+        buffer.clear();
+        runs.clear();
+        numSpilled = 0;
+        account();
+    }
+
+    /**
+     * Obtains the number of bytes of main memory occupied by the buffer and the handles of the runs,
+     * excluding the pages of the runs cached by the operating system.
+     */
+    std::size_t getMemoryUsage() const {
+        return buffer.getMemoryUsage() + runs.size() * sizeof(Run);
+    }
+
+    /**
+     * Obtains the number of runs on disk.
+     */
+    std::size_t getNumRuns() const {
+        return runs.size();
+    }
+};
+
+}  // end namespace souffle
@@ -0,0 +1,496 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file FrontCodedSet.h
+ *
+ * This header file contains the implementation of an ordered set of
+ * tuples, whose sorted elements are front coded, intended for wide
+ * relations whose columns repeat across many tuples.
+ *
+ * The sorted elements are split into blocks of at most twice the block
+ * size. The first tuple of a block is kept uncompressed, forming a sparse
+ * index that is binary searched to locate the block of a key. Any other
+ * tuple is encoded relative to its predecessor by the number of leading
+ * columns they share, the difference of the first column they do not
+ * share, and the differences of the remaining columns, each difference
+ * stored as a variable-length integer. Hence, a column repeating the value
+ * of the predecessor occupies a single byte.
+ *
+ * The elements are decoded by the iterators one after the other, such
+ * that scans read the encoded bytes sequentially. An element is inserted
+ * into its block in place, re-encoding its successor only, and blocks
+ * exceeding twice the block size are split.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include "Util.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * An ordered set of tuples, front coding its sorted elements in blocks.
+ *
+ * Inserts may be conducted concurrently with each other, but not with any other operation.
+ *
+ * @tparam T the type of the elements, a tuple of RamDomain values ordered lexicographically
+ * @tparam BLOCK_SIZE the number of elements of a block right after it has been built
+ */
+template <typename T, uint32_t BLOCK_SIZE = 64>
+class FrontCodedSet {
+    static constexpr std::size_t Arity = T::arity;
+
+    // the maximal number of bytes of an encoded value and of an encoded element
+    static constexpr std::size_t VALUE_BYTES = (sizeof(RamUnsigned) * 8 + 6) / 7;
+    static constexpr std::size_t ELEMENT_BYTES = 1 + Arity * VALUE_BYTES;
+
+    // a block of consecutive elements
+    struct Block {
+        // the first element of the block, also the key of the sparse index
+        T first;
+
+        // the number of elements in this block
+        uint32_t count = 1;
+
+        // the encoded elements following the first element
+        std::vector<uint8_t> bytes;
+
+        // a lock for inserting elements into this block
+        SpinLock lock;
+    };
+
+    // the blocks in the order of their elements
+    std::vector<std::unique_ptr<Block>> blocks;
+
+    // a lock guarding the blocks against insertions splitting them
+    ReadWriteLock directory;
+
+    // the number of elements in this set
+    std::atomic<std::size_t> numElements{0};
+
+public:
+    using element_type = T;
+
+    // front coded sets do not utilise operation hints
+    struct operation_hints {};
+
+    /**
+     * An iterator over the elements of the set, decoding a single element at a time.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, T> {
+        const FrontCodedSet* set = nullptr;
+        std::size_t block = 0;
+        uint32_t pos = 0;
+        const uint8_t* next = nullptr;
+        T value{};
+
+        friend class FrontCodedSet;
+
+        iterator(const FrontCodedSet* set, std::size_t block) : set(set), block(block) {
+            if (block < set->blocks.size()) {
+                value = set->blocks[block]->first;
+                next = set->blocks[block]->bytes.data();
+            }
+        }
+
+    public:
+        // the end iterator of an empty set
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return block == other.block && pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const T& operator*() const {
+            return value;
+        }
+
+        const T* operator->() const {
+            return &value;
+        }
+
+        iterator& operator++() {
+            if (++pos == set->blocks[block]->count) {
+                pos = 0;
+                if (++block < set->blocks.size()) {
+                    value = set->blocks[block]->first;
+                    next = set->blocks[block]->bytes.data();
+                }
+                return *this;
+            }
+            next = decode(next, value);
+            return *this;
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    FrontCodedSet() = default;
+
+    FrontCodedSet(const FrontCodedSet&) = delete;
+    FrontCodedSet& operator=(const FrontCodedSet&) = delete;
+
+    bool empty() const {
+        return numElements == 0;
+    }
+
+    std::size_t size() const {
+        return numElements;
+    }
+
+    /**
+     * Inserts the given element, returning whether it was not present before.
+     */
+    bool insert(const T& value) {
+        operation_hints hints;
+        return insert(value, hints);
+    }
+
+    bool insert(const T& value, operation_hints& /* hints */) {
+        directory.start_read();
+        // an element preceding all blocks alters the key of the first block
+        if (!blocks.empty() && !(value < blocks[0]->first)) {
+            Block& block = *blocks[locate(value)];
+            block.lock.lock();
+            if (block.count < 2 * BLOCK_SIZE) {
+                const bool res = insert(block, value);
+                block.lock.unlock();
+                directory.end_read();
+                if (res) {
+                    ++numElements;
+                }
+                return res;
+            }
+            block.lock.unlock();
+        }
+        directory.end_read();
+
+        // the blocks are modified exclusively
+        directory.start_write();
+        const bool res = insertExclusive(value);
+        directory.end_write();
+        if (res) {
+            ++numElements;
+        }
+        return res;
+    }
+
+    /**
+     * Inserts the given elements, in arbitrary order and possibly containing duplicates. If they
+     * are many, the blocks of this set are rebuilt. No other operations may be conducted concurrently.
+     */
+    void insertBulk(std::vector<T> data) {
+        std::sort(data.begin(), data.end());
+        data.erase(std::unique(data.begin(), data.end()), data.end());
+        if (data.size() < size() / 4) {
+            for (const T& cur : data) {
+                insert(cur);
+            }
+            return;
+        }
+        if (!empty()) {
+            std::vector<T> merged;
+            merged.reserve(size() + data.size());
+            std::merge(begin(), end(), data.begin(), data.end(), std::back_inserter(merged));
+            merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+            data.swap(merged);
+        }
+        build(data, BLOCK_SIZE);
+    }
+
+    bool contains(const T& value) const {
+        operation_hints hints;
+        return contains(value, hints);
+    }
+
+    bool contains(const T& value, operation_hints& hints) const {
+        return find(value, hints) != end();
+    }
+
+    iterator find(const T& value, operation_hints& hints) const {
+        iterator pos = lower_bound(value, hints);
+        if (pos != end() && *pos == value) {
+            return pos;
+        }
+        return end();
+    }
+
+    /**
+     * Obtains an iterator to the first element not less than the given value.
+     */
+    iterator lower_bound(const T& value, operation_hints& /* hints */) const {
+        iterator pos(this, locate(value));
+        while (pos != end() && *pos < value) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    /**
+     * Obtains an iterator to the first element greater than the given value.
+     */
+    iterator upper_bound(const T& value, operation_hints& /* hints */) const {
+        iterator pos(this, locate(value));
+        while (pos != end() && !(value < *pos)) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    iterator begin() const {
+        return iterator(this, 0);
+    }
+
+    iterator end() const {
+        return iterator(this, blocks.size());
+    }
+
+    /**
+     * Partitions this set into at most the given number of chunks of whole blocks,
+     * which may be processed in parallel.
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        std::vector<chunk> res;
+        if (blocks.empty()) {
+            return res;
+        }
+        num = std::max<std::size_t>(1, std::min(num, blocks.size()));
+        for (std::size_t i = 0; i < num; ++i) {
+            res.emplace_back(
+                    iterator(this, blocks.size() * i / num), iterator(this, blocks.size() * (i + 1) / num));
+        }
+        return res;
+    }
+
+    /**
+     * Removes all elements. No other operations may be conducted concurrently.
+     */
+    void clear() {
+        blocks.clear();
+        numElements = 0;
+    }
+
+    /**
+     * Rebuilds the blocks of this set filled to twice the block size, e.g. once the set is
+     * only read anymore. No other operations may be conducted concurrently.
+     */
+    void compact() {
+        build(std::vector<T>(begin(), end()), 2 * BLOCK_SIZE);
+    }
+
+    /**
+     * Obtains the number of bytes occupied by this set.
+     */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this) + blocks.capacity() * sizeof(std::unique_ptr<Block>);
+        for (const auto& block : blocks) {
+            res += sizeof(Block) + block->bytes.capacity();
+        }
+        return res;
+    }
+
+private:
+    // obtains the index of the last block starting at most at the given value, or the first block
+    std::size_t locate(const T& value) const {
+        auto pos = std::upper_bound(blocks.begin(), blocks.end(), value,
+                [](const T& value, const std::unique_ptr<Block>& block) { return value < block->first; });
+        return pos == blocks.begin() ? 0 : pos - blocks.begin() - 1;
+    }
+
+    // appends a variable-length integer, seven bits per byte, to the given bytes
+    static uint8_t* writeValue(uint8_t* out, RamUnsigned value) {
+        while (value >= 0x80) {
+            *out++ = uint8_t(value) | 0x80;
+            value >>= 7;
+        }
+        *out++ = uint8_t(value);
+        return out;
+    }
+
+    // reads a variable-length integer from the given bytes
+    static const uint8_t* readValue(const uint8_t* in, RamUnsigned& value) {
+        value = 0;
+        unsigned shift = 0;
+        while ((*in & 0x80) != 0) {
+            value |= RamUnsigned(*in++ & 0x7f) << shift;
+            shift += 7;
+        }
+        value |= RamUnsigned(*in++) << shift;
+        return in;
+    }
+
+    // maps differences of small magnitude, whether negative or positive, to small unsigned values
+    static RamUnsigned zigzag(RamUnsigned difference) {
+        return (difference << 1) ^ RamUnsigned(RamDomain(difference) >> (RAM_DOMAIN_SIZE - 1));
+    }
+
+    static RamUnsigned unzigzag(RamUnsigned value) {
+        return (value >> 1) ^ (RamUnsigned(0) - (value & 1));
+    }
+
+    // encodes the given element relative to its distinct predecessor, returning the end of the encoding
+    static uint8_t* encode(const T& pred, const T& value, uint8_t* out) {
+        std::size_t shared = 0;
+        while (pred[shared] == value[shared]) {
+            ++shared;
+        }
+        assert(shared < Arity && "elements are not distinct");
+        *out++ = uint8_t(shared);
+        // the first column which is not shared is ascending
+        out = writeValue(out, RamUnsigned(value[shared]) - RamUnsigned(pred[shared]));
+        for (std::size_t i = shared + 1; i < Arity; ++i) {
+            out = writeValue(out, zigzag(RamUnsigned(value[i]) - RamUnsigned(pred[i])));
+        }
+        return out;
+    }
+
+    // decodes the element following the given predecessor in place, returning the end of the encoding
+    static const uint8_t* decode(const uint8_t* in, T& value) {
+        const std::size_t shared = *in++;
+        RamUnsigned difference;
+        in = readValue(in, difference);
+        value[shared] = RamDomain(RamUnsigned(value[shared]) + difference);
+        for (std::size_t i = shared + 1; i < Arity; ++i) {
+            in = readValue(in, difference);
+            value[i] = RamDomain(RamUnsigned(value[i]) + unzigzag(difference));
+        }
+        return in;
+    }
+
+    // inserts an element not less than the first element of the given block into it
+    static bool insert(Block& block, const T& value) {
+        if (block.first == value) {
+            return false;
+        }
+        // the predecessor of the element, and its successor encoded at [from, to) if there is one
+        T pred = block.first;
+        T succ;
+        const uint8_t* data = block.bytes.data();
+        std::size_t from = block.bytes.size();
+        std::size_t to = from;
+        std::size_t offset = 0;
+        for (uint32_t i = 1; i < block.count; ++i) {
+            succ = pred;
+            const std::size_t next = decode(data + offset, succ) - data;
+            if (succ == value) {
+                return false;
+            }
+            if (value < succ) {
+                from = offset;
+                to = next;
+                break;
+            }
+            pred = succ;
+            offset = next;
+        }
+
+        // the encodings of the element and its successor replace the encoding of the successor
+        std::array<uint8_t, 2 * ELEMENT_BYTES> buffer;
+        uint8_t* end = encode(pred, value, buffer.data());
+        if (to != from) {
+            end = encode(value, succ, end);
+        }
+        const std::size_t length = end - buffer.data();
+        const std::size_t size = block.bytes.size();
+        if (size + length - (to - from) > block.bytes.capacity()) {
+            // grow by a fraction of the block only, as blocks are rarely filled up
+            block.bytes.reserve(size + length + size / 8 + 16);
+        }
+        block.bytes.resize(size + length - (to - from));
+        uint8_t* bytes = block.bytes.data();
+        std::memmove(bytes + from + length, bytes + to, size - to);
+        std::memcpy(bytes + from, buffer.data(), length);
+        ++block.count;
+        return true;
+    }
+
+    // inserts an element while no other operation accesses the blocks
+    bool insertExclusive(const T& value) {
+        if (blocks.empty()) {
+            blocks.push_back(std::make_unique<Block>());
+            blocks[0]->first = value;
+            return true;
+        }
+        const std::size_t pos = locate(value);
+        if (value < blocks[pos]->first) {
+            // an element preceding all blocks becomes the first element of the first block
+            std::vector<T> elements(1, value);
+            decodeAll(*blocks[pos], elements);
+            blocks[pos] = makeBlock(elements.begin(), elements.end());
+        } else if (!insert(*blocks[pos], value)) {
+            return false;
+        }
+        // a block exceeding twice the block size is split in halves
+        if (blocks[pos]->count > 2 * BLOCK_SIZE) {
+            std::vector<T> elements;
+            decodeAll(*blocks[pos], elements);
+            auto middle = elements.begin() + elements.size() / 2;
+            blocks[pos] = makeBlock(elements.begin(), middle);
+            blocks.insert(blocks.begin() + pos + 1, makeBlock(middle, elements.end()));
+        }
+        return true;
+    }
+
+    // appends the elements of the given block to the given elements
+    static void decodeAll(const Block& block, std::vector<T>& elements) {
+        T cur = block.first;
+        elements.push_back(cur);
+        const uint8_t* in = block.bytes.data();
+        for (uint32_t i = 1; i < block.count; ++i) {
+            in = decode(in, cur);
+            elements.push_back(cur);
+        }
+    }
+
+    // creates a block of the given non-empty range of sorted, duplicate free elements
+    template <typename Iter>
+    static std::unique_ptr<Block> makeBlock(Iter a, Iter b) {
+        auto block = std::make_unique<Block>();
+        block->first = *a;
+        block->count = b - a;
+        std::vector<uint8_t> bytes(block->count * ELEMENT_BYTES);
+        uint8_t* out = bytes.data();
+        for (Iter cur = a + 1; cur < b; ++cur) {
+            out = encode(*(cur - 1), *cur, out);
+        }
+        block->bytes.assign(bytes.data(), out);
+        return block;
+    }
+
+    // replaces the content of this set by the given sorted, duplicate free elements
+    void build(const std::vector<T>& data, std::size_t blockSize) {
+        clear();
+        for (std::size_t first = 0; first < data.size(); first += blockSize) {
+            const std::size_t last = std::min(data.size(), first + blockSize);
+            blocks.push_back(makeBlock(data.begin() + first, data.begin() + last));
+        }
+        blocks.shrink_to_fit();
+        numElements = data.size();
+    }
+};
+
+}  // end namespace souffle
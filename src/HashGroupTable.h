@@ -0,0 +1,71 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashGroupTable.h
+ *
+ * This header file contains the hash table of the group aggregates of
+ * synthesised programs.
+ *
+ * The table maps the key of each group to its aggregate. It is built by a
+ * single pass over the aggregated relation at the start of a group
+ * aggregate, by each thread on a part of the relation for parallel group
+ * aggregates, whose partial tables are merged afterwards. It is looked up
+ * concurrently by the tuples of the scanned relation, and discarded at the
+ * end of the group aggregate.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "HashSet.h"
+#include "RamTypes.h"
+#include <cstddef>
+#include <unordered_map>
+
+namespace souffle {
+
+/**
+ * A hash table of the aggregates of groups.
+ *
+ * @tparam Key the type of the keys of the groups, a tuple of the grouped columns
+ */
+template <typename Key>
+class HashGroupTable {
+public:
+    /** Get the aggregate of a group, which is initialised by the given value if the group is new */
+    RamDomain& get(const Key& key, RamDomain init) {
+        return groups.emplace(key, init).first->second;
+    }
+
+    /** Find the aggregate of a group, or nullptr if there is none */
+    const RamDomain* find(const Key& key) const {
+        auto pos = groups.find(key);
+        return pos == groups.end() ? nullptr : &pos->second;
+    }
+
+    /** Combine the aggregates of another table into the aggregates of this one */
+    template <typename F>
+    void merge(const HashGroupTable& other, RamDomain init, const F& combine) {
+        for (const auto& cur : other.groups) {
+            RamDomain& aggregate = get(cur.first, init);
+            aggregate = combine(aggregate, cur.second);
+        }
+    }
+
+    /** Get the number of groups of the table */
+    std::size_t size() const {
+        return groups.size();
+    }
+
+private:
+    std::unordered_map<Key, RamDomain, detail::tuple_hash<Key>> groups;
+};
+
+}  // end of namespace souffle
@@ -0,0 +1,91 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashJoinTable.h
+ *
+ * This header file contains the hash table of the equi-joins of large
+ * relations, which replaces a search of an index per tuple by a flat table.
+ *
+ * The table is built by a single thread at the start of a join, from copies
+ * of the tuples of one relation, and probed concurrently by the tuples of the
+ * other relation afterwards. The tuples of a bucket are chained by their
+ * positions, such that the table consists of three flat arrays, and it is
+ * discarded at the end of the join.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "HashSet.h"
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A hash table of tuples on a key, which is built once and probed afterwards.
+ *
+ * @tparam Key the type of the keys, a tuple of the joined columns
+ * @tparam Value the type of the stored tuples
+ */
+template <typename Key, typename Value>
+class HashJoinTable {
+public:
+    /** Add a tuple on a key; the table is built after all tuples are added */
+    void insert(const Key& key, const Value& value) {
+        keys.push_back(key);
+        values.push_back(value);
+    }
+
+    /** Chain the added tuples into buckets */
+    void build() {
+        std::size_t buckets = 1;
+        while (buckets < 2 * keys.size()) {
+            buckets <<= 1;
+        }
+        mask = buckets - 1;
+        heads.assign(buckets, END);
+        next.resize(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            std::size_t& head = heads[hash(keys[i]) & mask];
+            next[i] = head;
+            head = i;
+        }
+    }
+
+    /** Call a function for each tuple added on the given key */
+    template <typename F>
+    void probe(const Key& key, const F& f) const {
+        for (std::size_t i = heads[hash(key) & mask]; i != END; i = next[i]) {
+            if (keys[i] == key) {
+                f(values[i]);
+            }
+        }
+    }
+
+    /** Get the number of tuples of the table */
+    std::size_t size() const {
+        return keys.size();
+    }
+
+private:
+    static constexpr std::size_t END = std::numeric_limits<std::size_t>::max();
+
+    detail::tuple_hash<Key> hash;
+    std::vector<Key> keys;
+    std::vector<Value> values;
+    std::vector<std::size_t> heads = std::vector<std::size_t>(1, END);
+    std::vector<std::size_t> next;
+    std::size_t mask = 0;
+};
+
+}  // end of namespace souffle
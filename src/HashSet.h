@@ -0,0 +1,406 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashSet.h
+ *
+ * This header file contains the implementation of a concurrent hash set
+ * of tuples based on open addressing.
+ *
+ * The set is split into shards, selected by the hash of an element. Each
+ * shard is a table with linear probing, growing independently of the
+ * other shards. Inserts lock their shard, while lookups and iterations
+ * are lock free: a table is never modified after it has been replaced by
+ * a larger one, and tables are only released when the set is cleared or
+ * destroyed. Hence, lookups may be conducted concurrently to inserts and
+ * iterators stay valid, although they may miss concurrently inserted
+ * elements.
+ *
+ * Elements are not ordered, so the set supports lookups of complete
+ * elements and full scans, but no range queries.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include "Util.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace souffle {
+
+namespace detail {
+
+/**
+ * A hash function for tuples, combining the components and finalising
+ * the result such that all bits of the hash depend on all components.
+ */
+template <typename Tuple>
+struct tuple_hash {
+    std::size_t operator()(const Tuple& tuple) const {
+        uint64_t h = 0;
+        for (std::size_t i = 0; i < Tuple::arity; ++i) {
+            h ^= static_cast<uint64_t>(static_cast<RamUnsigned>(tuple[i])) + 0x9e3779b97f4a7c15ull +
+                 (h << 6) + (h >> 2);
+        }
+        // the finaliser of MurmurHash3
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+}  // end namespace detail
+
+/**
+ * A concurrent, insert-only hash set.
+ *
+ * @tparam T the type of the elements
+ * @tparam Hash the hash function of the elements
+ * @tparam Equal the equality of the elements
+ */
+template <typename T, typename Hash = detail::tuple_hash<T>, typename Equal = std::equal_to<T>>
+class HashSet {
+    // the number of shards, a power of two
+    static constexpr unsigned SHARD_BITS = 6;
+    static constexpr std::size_t NUM_SHARDS = std::size_t(1) << SHARD_BITS;
+
+    // the capacity of the first table of a shard, a power of two
+    static constexpr std::size_t MIN_CAPACITY = 16;
+
+    // a slot of a table, whose value is published by setting the used flag
+    struct Slot {
+        std::atomic<bool> used{false};
+        T value;
+    };
+
+    // a table of a shard, whose capacity is a power of two
+    struct Table {
+        const std::size_t capacity;
+        std::unique_ptr<Slot[]> slots;
+
+        explicit Table(std::size_t capacity) : capacity(capacity), slots(new Slot[capacity]) {}
+    };
+
+    // a shard of the set, padded to its own cache line
+    struct alignas(64) Shard {
+        // the current table, null while the shard is empty
+        std::atomic<const Table*> table{nullptr};
+
+        // the number of elements in this shard
+        std::atomic<std::size_t> count{0};
+
+        // the lock serialising inserts into this shard
+        SpinLock lock;
+
+        // all tables of this shard, the last one being the current
+        std::vector<std::unique_ptr<Table>> tables;
+    };
+
+    std::array<Shard, NUM_SHARDS> shards;
+
+    Hash hash;
+    Equal equal;
+
+public:
+    using element_type = T;
+
+    // hash sets do not utilise operation hints
+    struct operation_hints {};
+
+    /**
+     * An iterator over the elements of the set, visiting the shards in
+     * sequence. An iterator references the table of its shard present at
+     * the time it reached the shard, not covering later inserted elements.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, T> {
+        const Shard* shards = nullptr;
+        std::size_t shard = NUM_SHARDS;
+        const Table* table = nullptr;
+        std::size_t slot = 0;
+
+        friend class HashSet;
+
+        iterator(const Shard* shards, std::size_t shard, const Table* table, std::size_t slot)
+                : shards(shards), shard(shard), table(table), slot(slot) {
+            normalise();
+        }
+
+        // moves this iterator to the next used slot, or to the end
+        void normalise() {
+            while (shard < NUM_SHARDS) {
+                if (table != nullptr) {
+                    for (; slot < table->capacity; ++slot) {
+                        if (table->slots[slot].used.load(std::memory_order_acquire)) {
+                            return;
+                        }
+                    }
+                }
+                slot = 0;
+                if (++shard < NUM_SHARDS) {
+                    table = shards[shard].table.load(std::memory_order_acquire);
+                }
+            }
+            table = nullptr;
+        }
+
+    public:
+        // the end iterator
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return shard == other.shard && slot == other.slot;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const T& operator*() const {
+            return table->slots[slot].value;
+        }
+
+        const T* operator->() const {
+            return &table->slots[slot].value;
+        }
+
+        iterator& operator++() {
+            ++slot;
+            normalise();
+            return *this;
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    HashSet() = default;
+
+    HashSet(const HashSet&) = delete;
+    HashSet& operator=(const HashSet&) = delete;
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::size_t size() const {
+        std::size_t res = 0;
+        for (const Shard& shard : shards) {
+            res += shard.count.load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+    /**
+     * Inserts the given element, returning whether it was not present before.
+     */
+    bool insert(const T& value) {
+        operation_hints hints;
+        return insert(value, hints);
+    }
+
+    bool insert(const T& value, operation_hints& /* hints */) {
+        const std::size_t h = hash(value);
+        Shard& shard = shards[shardOf(h)];
+
+        // the common case of a present element does not need to lock the shard
+        if (probe(shard.table.load(std::memory_order_acquire), h, value) != NOT_FOUND) {
+            return false;
+        }
+
+        std::lock_guard<SpinLock> guard(shard.lock);
+        std::size_t count = shard.count.load(std::memory_order_relaxed);
+        Table* table = shard.tables.empty() ? nullptr : shard.tables.back().get();
+
+        // keep the load factor at most 1/2, for short probe sequences of missing elements
+        if (table == nullptr || 2 * (count + 1) > table->capacity) {
+            table = grow(shard);
+        }
+
+        const std::size_t mask = table->capacity - 1;
+        std::size_t i = h & mask;
+        while (table->slots[i].used.load(std::memory_order_relaxed)) {
+            if (equal(table->slots[i].value, value)) {
+                return false;
+            }
+            i = (i + 1) & mask;
+        }
+        table->slots[i].value = value;
+        table->slots[i].used.store(true, std::memory_order_release);
+        shard.count.store(count + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool contains(const T& value) const {
+        operation_hints hints;
+        return contains(value, hints);
+    }
+
+    bool contains(const T& value, operation_hints& /* hints */) const {
+        const std::size_t h = hash(value);
+        return probe(shards[shardOf(h)].table.load(std::memory_order_acquire), h, value) != NOT_FOUND;
+    }
+
+    iterator find(const T& value) const {
+        operation_hints hints;
+        return find(value, hints);
+    }
+
+    iterator find(const T& value, operation_hints& /* hints */) const {
+        const std::size_t h = hash(value);
+        const std::size_t s = shardOf(h);
+        const Table* table = shards[s].table.load(std::memory_order_acquire);
+        std::size_t i = probe(table, h, value);
+        if (i == NOT_FOUND) {
+            return end();
+        }
+        return iterator(shards.data(), s, table, i);
+    }
+
+    iterator begin() const {
+        return iterator(shards.data(), 0, shards[0].table.load(std::memory_order_acquire), 0);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    /**
+     * Partitions the set into about the given number of chunks of similar
+     * size, assuming the elements of a shard to be spread evenly across
+     * its table. No insertions may be conducted concurrently.
+     *
+     * @param num the number of chunks requested
+     * @return a list of chunks partitioning this set
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        std::vector<chunk> res;
+        const std::size_t total = size();
+        if (total == 0) {
+            return res;
+        }
+        num = std::max<std::size_t>(1, std::min(num, total));
+        const std::size_t step = (total + num - 1) / num;
+
+        iterator first = begin();
+        std::size_t pending = 0;
+        for (std::size_t s = 0; s < NUM_SHARDS; ++s) {
+            const Table* table = shards[s].table.load(std::memory_order_acquire);
+            const std::size_t count = shards[s].count.load(std::memory_order_relaxed);
+            std::size_t done = 0;
+            // cut the shard wherever the chunk in progress reaches the step size
+            while (pending + (count - done) >= step && res.size() + 1 < num) {
+                done += step - pending;
+                pending = 0;
+                iterator cut(shards.data(), s, table, table->capacity * done / count);
+                if (cut != first) {
+                    res.emplace_back(first, cut);
+                    first = cut;
+                }
+            }
+            pending += count - done;
+        }
+        if (first != end()) {
+            res.emplace_back(first, end());
+        }
+        return res;
+    }
+
+    /**
+     * Returns an estimate of the number of bytes of memory occupied by this
+     * set, including the tables retained for iterators of earlier tables.
+     */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this);
+        for (const Shard& shard : shards) {
+            res += shard.tables.capacity() * sizeof(std::unique_ptr<Table>);
+            for (const auto& table : shard.tables) {
+                res += sizeof(Table) + table->capacity * sizeof(Slot);
+            }
+        }
+        return res;
+    }
+
+    /**
+     * Removes all elements and releases the tables. No other operations may
+     * be conducted concurrently.
+     */
+    void clear() {
+        for (Shard& shard : shards) {
+            shard.table.store(nullptr, std::memory_order_relaxed);
+            shard.count.store(0, std::memory_order_relaxed);
+            shard.tables.clear();
+        }
+    }
+
+private:
+    static constexpr std::size_t NOT_FOUND = std::size_t(-1);
+
+    // the shard is selected by the upper bits, the slot by the lower bits of a hash
+    static std::size_t shardOf(std::size_t h) {
+        return h >> (sizeof(std::size_t) * 8 - SHARD_BITS);
+    }
+
+    // locates the slot of the given element in the given table
+    std::size_t probe(const Table* table, std::size_t h, const T& value) const {
+        if (table == nullptr) {
+            return NOT_FOUND;
+        }
+        const std::size_t mask = table->capacity - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            const Slot& slot = table->slots[i];
+            if (!slot.used.load(std::memory_order_acquire)) {
+                return NOT_FOUND;
+            }
+            if (equal(slot.value, value)) {
+                return i;
+            }
+        }
+    }
+
+    // replaces the current table of a locked shard by a table of twice the capacity
+    Table* grow(Shard& shard) {
+        const Table* old = shard.tables.empty() ? nullptr : shard.tables.back().get();
+        auto table = std::make_unique<Table>(old == nullptr ? MIN_CAPACITY : 2 * old->capacity);
+        if (old != nullptr) {
+            const std::size_t mask = table->capacity - 1;
+            for (std::size_t j = 0; j < old->capacity; ++j) {
+                if (!old->slots[j].used.load(std::memory_order_relaxed)) {
+                    continue;
+                }
+                const T& value = old->slots[j].value;
+                std::size_t i = hash(value) & mask;
+                while (table->slots[i].used.load(std::memory_order_relaxed)) {
+                    i = (i + 1) & mask;
+                }
+                table->slots[i].value = value;
+                table->slots[i].used.store(true, std::memory_order_relaxed);
+            }
+        }
+        Table* res = table.get();
+        shard.tables.push_back(std::move(table));
+        // publish the filled table to lock-free readers
+        shard.table.store(res, std::memory_order_release);
+        return res;
+    }
+};
+
+}  // end namespace souffle
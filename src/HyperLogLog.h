@@ -0,0 +1,119 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HyperLogLog.h
+ *
+ * This header file contains a HyperLogLog sketch, estimating the number
+ * of distinct values of a sequence in constant space.
+ *
+ * Each value is hashed, the leading bits of the hash select one of the
+ * registers of the sketch, and the register keeps the maximal position
+ * of the first set bit among the remaining bits of the hashes. Adding a
+ * value takes constant time, and sketches of parts of a sequence are
+ * merged by the maxima of their registers. The relative standard error
+ * of the estimate is about 1.04 / sqrt(m) for m registers, i.e. 1.6%.
+ * Up to a few hundred distinct values are counted exactly by their hashes.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+
+namespace souffle {
+
+class HyperLogLog {
+public:
+    /** Add a value to the sketched sequence */
+    void add(RamDomain value) {
+        // scramble the value to a uniformly distributed hash
+        uint64_t hash = static_cast<uint64_t>(static_cast<RamUnsigned>(value)) + 0x9e3779b97f4a7c15ULL;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+
+        if (!saturated) {
+            exact.insert(hash);
+            checkSaturation();
+        }
+
+        const std::size_t index = hash >> (64 - precision);
+        const uint64_t rest = hash << precision;
+        const uint8_t rank = rest == 0 ? 64 - precision + 1 : __builtin_clzll(rest) + 1;
+        registers[index] = std::max(registers[index], rank);
+    }
+
+    /** Add the values of the sequence sketched by the given sketch */
+    void merge(const HyperLogLog& other) {
+        for (std::size_t i = 0; i < m; ++i) {
+            registers[i] = std::max(registers[i], other.registers[i]);
+        }
+        saturated = saturated || other.saturated;
+        if (!saturated) {
+            exact.insert(other.exact.begin(), other.exact.end());
+        }
+        checkSaturation();
+    }
+
+    /** Estimate the number of distinct values added */
+    std::size_t estimate() const {
+        if (!saturated) {
+            return exact.size();
+        }
+        double sum = 0;
+        std::size_t empty = 0;
+        for (uint8_t rank : registers) {
+            sum += std::ldexp(1.0, -rank);
+            if (rank == 0) {
+                ++empty;
+            }
+        }
+        const double alpha = 0.7213 / (1 + 1.079 / m);
+        double res = alpha * m * m / sum;
+        // small numbers are estimated by the fraction of empty registers, i.e. by linear counting
+        if (res <= 2.5 * m && empty != 0) {
+            res = m * std::log(static_cast<double>(m) / empty);
+        }
+        return static_cast<std::size_t>(std::llround(res));
+    }
+
+private:
+    /** Number of leading bits of a hash selecting its register */
+    static constexpr std::size_t precision = 12;
+
+    /** Number of registers */
+    static constexpr std::size_t m = std::size_t(1) << precision;
+
+    /** Number of distinct hashes kept for counting exactly */
+    static constexpr std::size_t exactLimit = 512;
+
+    std::array<uint8_t, m> registers{};
+
+    /** The distinct hashes of the values, until there are more than exactLimit of them */
+    std::set<uint64_t> exact;
+
+    /** Whether the hashes exceeded exactLimit, such that the estimate is based on the registers */
+    bool saturated = false;
+
+    void checkSaturation() {
+        if (saturated || exact.size() > exactLimit) {
+            saturated = true;
+            exact.clear();
+        }
+    }
+};
+
+}  // namespace souffle
@@ -0,0 +1,89 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file IOBinaryFormat.h
+ *
+ * Layout of the binary fact files read and written by IO=binary.
+ *
+ * A binary fact file consists of
+ *   - a BinaryFactsHeader,
+ *   - the symbol sub-table: for each symbol its length (uint64_t) followed
+ *     by its characters, padded to a multiple of 8 bytes overall,
+ *   - the tuples in column-major order: for each of the arity columns,
+ *     numTuples RamDomain values.
+ *
+ * Symbol columns store indices into the symbol sub-table, all other
+ * columns store the RamDomain encoding of their values. Values are stored
+ * in the byte order of the machine writing the file.
+ *
+ * IO=shm publishes the same layout in a POSIX shared memory segment, such
+ * that programs on the same machine hand over relations without copying
+ * them through files.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace souffle {
+
+struct BinaryFactsHeader {
+    /** The magic string identifying binary fact files */
+    static constexpr char MAGIC[8] = {'S', 'O', 'U', 'F', 'F', 'L', 'E', 'B'};
+
+    /** The version of the file format */
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t domainSize;
+    uint64_t arity;
+    uint64_t numTuples;
+    uint64_t numSymbols;
+
+    /** Create a header for the current format and domain size */
+    static BinaryFactsHeader create(uint64_t arity, uint64_t numTuples, uint64_t numSymbols) {
+        BinaryFactsHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.domainSize = sizeof(RamDomain);
+        header.arity = arity;
+        header.numTuples = numTuples;
+        header.numSymbols = numSymbols;
+        return header;
+    }
+
+    /** Check whether this header describes a file readable by this build */
+    bool isValid() const {
+        return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && version == VERSION &&
+               domainSize == sizeof(RamDomain);
+    }
+};
+
+/** Round the given offset up to the alignment of the tuple data */
+inline uint64_t alignBinaryFactsOffset(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+/** The name of the shared memory segment of a relation read or written by IO=shm */
+inline std::string getSharedMemorySegment(const IODirectives& ioDirectives) {
+    if (ioDirectives.has("segment")) {
+        const std::string& segment = ioDirectives.get("segment");
+        return segment[0] == '/' ? segment : "/" + segment;
+    }
+    return "/souffle." + ioDirectives.getRelationName();
+}
+
+}  // namespace souffle
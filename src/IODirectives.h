@@ -14,9 +14,11 @@
 
 #pragma once
 
+#include <exception>
 #include <map>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -55,6 +57,10 @@ public:
         return directives.count(key) > 0;
     }
 
+    const std::map<std::string, std::string>& getDirectiveMap() const {
+        return directives;
+    }
+
     const std::string& getFileName() const {
         return get("filename");
     }
@@ -71,6 +77,35 @@ public:
         directives["name"] = name;
     }
 
+    /** The columns an output is sorted by, resolved from its order directive by the translator */
+    std::vector<size_t> getOrderColumns() const {
+        std::vector<size_t> columns;
+        if (has("orderColumns")) {
+            std::istringstream iss(get("orderColumns"));
+            std::string column;
+            while (std::getline(iss, column, ':')) {
+                columns.push_back(std::stoul(column));
+            }
+        }
+        return columns;
+    }
+
+    /** The fraction of the tuples of an input which are loaded, given by its sample directive */
+    double getSampleRate() const {
+        return has("sample") ? std::stod(get("sample")) : 1.0;
+    }
+
+    /** Whether the given text is a sample rate, i.e. a number greater than 0 and at most 1 */
+    static bool isSampleRate(const std::string& text) {
+        try {
+            size_t end = 0;
+            const double rate = std::stod(text, &end);
+            return end == text.size() && rate > 0 && rate <= 1;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
     bool isEmpty() {
         return directives.empty();
     }
@@ -17,9 +17,11 @@
 #include "IODirectives.h"
 #include "RamTypes.h"
 #include "ReadStream.h"
+#include "ReadStreamBinary.h"
 #include "ReadStreamCSV.h"
 #include "SymbolTable.h"
 #include "WriteStream.h"
+#include "WriteStreamBinary.h"
 #include "WriteStreamCSV.h"
 
 #ifdef USE_SQLITE
@@ -27,6 +29,11 @@
 #include "WriteStreamSQLite.h"
 #endif
 
+#ifdef USE_PARQUET
+#include "ReadStreamParquet.h"
+#include "WriteStreamParquet.h"
+#endif
+
 #include <map>
 #include <memory>
 #include <string>
@@ -79,9 +86,17 @@ private:
         registerWriteStreamFactory(std::make_shared<WriteFileCSVFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutCSVFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutPrintSizeFactory>());
+        registerReadStreamFactory(std::make_shared<ReadFileBinaryFactory>());
+        registerWriteStreamFactory(std::make_shared<WriteFileBinaryFactory>());
+        registerReadStreamFactory(std::make_shared<ReadSharedMemoryBinaryFactory>());
+        registerWriteStreamFactory(std::make_shared<WriteSharedMemoryBinaryFactory>());
 #ifdef USE_SQLITE
         registerReadStreamFactory(std::make_shared<ReadSQLiteFactory>());
         registerWriteStreamFactory(std::make_shared<WriteSQLiteFactory>());
+#endif
+#ifdef USE_PARQUET
+        registerReadStreamFactory(std::make_shared<ReadFileParquetFactory>());
+        registerWriteStreamFactory(std::make_shared<WriteFileParquetFactory>());
 #endif
     };
     std::map<std::string, std::shared_ptr<WriteStreamFactory>> outputFactories;
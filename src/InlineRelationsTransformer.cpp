@@ -16,6 +16,7 @@
 
 #include "AstArgument.h"
 #include "AstClause.h"
+#include "AstGroundAnalysis.h"
 #include "AstLiteral.h"
 #include "AstNode.h"
 #include "AstProgram.h"
@@ -26,10 +27,16 @@
 #include "AstUtils.h"
 #include "AstVisitor.h"
 #include "BinaryConstraintOps.h"
+#include "ErrorReport.h"
 #include "FunctorOps.h"
+#include "Global.h"
+#include "PrecedenceGraph.h"
 #include "Util.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <map>
 #include <memory>
 #include <ostream>
 #include <set>
@@ -976,10 +983,169 @@ std::vector<AstClause*> getInlinedClause(AstProgram& program, const AstClause& c
     }
 }
 
+/**
+ * Estimates the clauses generated from a clause by inlining its inlined atoms, i.e., their number and
+ * their mean number of body literals, whose product is the cost of inlining into the clause.
+ */
+class InliningCostEstimator {
+public:
+    /** The estimated number of generated clauses and their mean number of body literals */
+    using Estimate = std::pair<double, double>;
+
+    InliningCostEstimator(const AstProgram& program) : program(program) {}
+
+    /** Estimate the clauses generated from a clause */
+    Estimate estimate(const AstClause& clause) {
+        double clauses = 1;
+        double literals = 0;
+        for (AstLiteral* lit : clause.getBodyLiterals()) {
+            const AstAtom* atom = dynamic_cast<AstAtom*>(lit);
+            const auto* negation = dynamic_cast<AstNegation*>(lit);
+            if (negation != nullptr) {
+                atom = negation->getAtom();
+            }
+            const AstRelation* rel = atom != nullptr ? program.getRelation(atom->getName()) : nullptr;
+            if (rel == nullptr || !rel->isInline()) {
+                literals += 1;
+                continue;
+            }
+            const Estimate inlined = estimate(*rel);
+            if (negation != nullptr) {
+                // each generated clause negates one literal of each clause of the relation
+                clauses *= std::pow(std::max(inlined.second, 1.0), inlined.first);
+                literals += inlined.first;
+            } else {
+                // each generated clause is joined with one clause of the relation
+                clauses *= inlined.first;
+                literals += inlined.second;
+            }
+        }
+        return {clauses, literals};
+    }
+
+    /** Estimate the clauses generated from all clauses of an inlined relation */
+    Estimate estimate(const AstRelation& rel) {
+        auto pos = relations.find(&rel);
+        if (pos != relations.end()) {
+            return pos->second;
+        }
+        double clauses = 0;
+        double literals = 0;
+        for (const AstClause* clause : rel.getClauses()) {
+            const Estimate cur = estimate(*clause);
+            clauses += cur.first;
+            literals += cur.first * cur.second;
+        }
+        return relations[&rel] = {clauses, clauses > 0 ? literals / clauses : 0};
+    }
+
+private:
+    const AstProgram& program;
+
+    /** The estimates of the inlined relations so far */
+    std::map<const AstRelation*, Estimate> relations;
+};
+
+/**
+ * Collect the inlined relations whose clauses are inlined into a clause, directly or through other
+ * inlined relations.
+ */
+void collectInlinedRelations(
+        const AstProgram& program, const AstClause& clause, std::set<AstRelation*>& relations) {
+    visitDepthFirst(clause, [&](const AstAtom& atom) {
+        AstRelation* rel = program.getRelation(atom.getName());
+        if (rel != nullptr && rel->isInline() && relations.insert(rel).second) {
+            for (const AstClause* cur : rel->getClauses()) {
+                collectInlinedRelations(program, *cur, relations);
+            }
+        }
+    });
+}
+
+/**
+ * Checks if an inlined relation may be materialised instead, i.e., the variables of the heads of its
+ * clauses are grounded by their bodies, and it does not depend on itself, such that materialising it
+ * neither introduces ungrounded clauses nor negations or aggregates within recursive strata.
+ */
+bool isMaterialisable(const AstRelation& rel, const PrecedenceGraph& precedenceGraph) {
+    const auto& graph = precedenceGraph.graph();
+    if (graph.contains(&rel, &rel)) {
+        return false;
+    }
+    for (const AstRelation* dependency : graph.successors(&rel)) {
+        if (graph.reaches(dependency, &rel)) {
+            return false;
+        }
+    }
+    for (const AstClause* clause : rel.getClauses()) {
+        std::map<const AstArgument*, bool> grounded = getGroundedTerms(*clause);
+        bool headGrounded = true;
+        visitDepthFirst(*clause->getHead(), [&](const AstVariable& var) { headGrounded &= grounded[&var]; });
+        if (!headGrounded) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Materialise the inlined relations whose inlining is estimated to generate clauses of a total cost
+ * above the limit, i.e., body literals of all clauses generated from a single clause. The relations
+ * generating the most clauses are materialised first, until no clause exceeds the limit, and each
+ * materialised relation is reported by a warning.
+ */
+bool materialiseCostlyRelations(AstTranslationUnit& translationUnit, double limit) {
+    AstProgram& program = *translationUnit.getProgram();
+    const auto* precedenceGraph = translationUnit.getAnalysis<PrecedenceGraph>();
+    bool changed = false;
+    while (true) {
+        InliningCostEstimator estimator(program);
+        AstRelation* costliest = nullptr;
+        InliningCostEstimator::Estimate worst{0, 0};
+        for (AstRelation* rel : program.getRelations()) {
+            if (rel->isInline()) {
+                continue;
+            }
+            for (const AstClause* clause : rel->getClauses()) {
+                const InliningCostEstimator::Estimate cost = estimator.estimate(*clause);
+                if (cost.first * cost.second <= limit) {
+                    continue;
+                }
+                std::set<AstRelation*> inlined;
+                collectInlinedRelations(program, *clause, inlined);
+                for (AstRelation* cur : inlined) {
+                    const double clauses = estimator.estimate(*cur).first;
+                    if ((costliest == nullptr || clauses > estimator.estimate(*costliest).first) &&
+                            isMaterialisable(*cur, *precedenceGraph)) {
+                        costliest = cur;
+                        worst = cost;
+                    }
+                }
+            }
+        }
+        if (costliest == nullptr) {
+            return changed;
+        }
+        costliest->setQualifier(costliest->getQualifier() & ~INLINE_RELATION);
+        std::stringstream message;
+        message << "Relation " << costliest->getName() << " is materialised rather than inlined, as inlining "
+                << "it generates an estimated " << worst.first << " clauses of " << worst.second
+                << " body literals from a single clause";
+        translationUnit.getErrorReport().addWarning(message.str(), costliest->getSrcLoc());
+        changed = true;
+    }
+}
+
 bool InlineRelationsTransformer::transform(AstTranslationUnit& translationUnit) {
     bool changed = false;
     AstProgram& program = *translationUnit.getProgram();
 
+    // Materialise the inlined relations generating too many or too long clauses
+    const double limit = Global::config().has("inline-limit")
+                                 ? std::stod(Global::config().get("inline-limit"))
+                                 : DEFAULT_INLINE_LIMIT;
+    changed |= materialiseCostlyRelations(translationUnit, limit);
+
     // Replace constants in the head of inlined clauses with (constrained) variables.
     // This is done to simplify atom unification, particularly when negations are involved.
     normaliseInlinedHeads(program);
@@ -23,6 +23,7 @@
 #include "RamTypes.h"
 #include <cassert>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -32,25 +33,54 @@ namespace souffle {
  * Evaluation context for Interpreter operations
  */
 class InterpreterContext {
-    using ViewPtr = std::unique_ptr<IndexView>;
-
     /** @brief Run-time value */
     std::vector<const RamDomain*> data;
     /** @brief Subroutine return value */
     std::vector<RamDomain>* returnValues = nullptr;
+    /** @brief Lock of the return values of a subroutine with parallel operations, if any */
+    std::mutex* returnLock = nullptr;
     /** @brief Subroutine arguments */
     const std::vector<RamDomain>* args = nullptr;
-    /** @bref Allocated data */
-    std::vector<std::unique_ptr<RamDomain[]>> allocatedDataContainer;
-    /** @brief Views */
-    std::vector<std::unique_ptr<IndexView>> views;
+    /** @brief Blocks of the tuple arena, kept for reuse when tuples are released */
+    std::vector<std::unique_ptr<RamDomain[]>> arenaBlocks;
+    /** @brief Number of arena blocks in use */
+    size_t blocksInUse = 0;
+    /** @brief Used part of the current arena block */
+    size_t blockOffset = 0;
+    /** @brief Tuples exceeding the arena block size */
+    std::vector<std::unique_ptr<RamDomain[]>> largeTuples;
+    /** @brief Views, owned by the thread that created them, see InterpreterRelation::getView */
+    std::vector<IndexView*> views;
+    /** @brief Whether insertions are buffered until the end of the enclosing parallel operation */
+    bool bufferingInserts = false;
+    /** @brief Tuples buffered for insertion, stored consecutively per relation */
+    std::unordered_map<InterpreterRelation*, std::vector<RamDomain>> insertBuffers;
+    /** @brief Scratch space of the batches of fused scans */
+    std::vector<RamDomain> batchBuffer;
+    /** @brief Tuples derived by a partitioned query, collected for the exchange between ranks */
+    std::unordered_map<InterpreterRelation*, std::vector<RamDomain>>* outbox = nullptr;
+    /** @brief Whether the outermost scan only visits the tuples of the partition of this rank */
+    bool partitioned = false;
+    /** @brief Whether parallel operations are evaluated sequentially, e.g., in the tail of a loop */
+    bool sequential = false;
+    /** @brief Iteration of the innermost loop, counted per task such that strata may loop concurrently */
+    size_t iteration = 0;
+    /** @brief Whether the relations accessed by the enclosing stratum are locked by its task */
+    bool relationsLocked = false;
 
 public:
+    /** @brief Number of values in a block of the tuple arena */
+    static constexpr size_t ARENA_BLOCK_SIZE = 1024;
+
     InterpreterContext(size_t size = 0) : data(size) {}
 
     /** This constructor is used when program enter a new scope.
-     * Only Subroutine value needs to be copied */
-    InterpreterContext(InterpreterContext& ctxt) : returnValues(ctxt.returnValues), args(ctxt.args) {}
+     * Only Subroutine value needs to be copied, the environment is sized like the enclosing one */
+    InterpreterContext(InterpreterContext& ctxt)
+            : data(ctxt.data.size()), returnValues(ctxt.returnValues), returnLock(ctxt.returnLock),
+              args(ctxt.args), outbox(ctxt.outbox), partitioned(ctxt.partitioned),
+              sequential(ctxt.sequential), iteration(ctxt.iteration),
+              relationsLocked(ctxt.relationsLocked) {}
     virtual ~InterpreterContext() = default;
 
     const RamDomain*& operator[](size_t index) {
@@ -64,14 +94,37 @@ public:
         return data[index];
     }
 
+    /** @brief Make room for the given number of tuple ids in the environment */
+    void reserveTuples(size_t count) {
+        if (count > data.size()) {
+            data.resize(count);
+        }
+    }
+
     /** @brief Allocate a tuple.
-     *  allocatedDataContainer has the ownership of those tuples. */
+     *  The context owns the tuple until releaseTuples is called. */
     RamDomain* allocateNewTuple(size_t size) {
-        std::unique_ptr<RamDomain[]> newTuple(new RamDomain[size]);
-        allocatedDataContainer.push_back(std::move(newTuple));
+        if (size > ARENA_BLOCK_SIZE) {
+            largeTuples.emplace_back(new RamDomain[size]);
+            return largeTuples.back().get();
+        }
+        if (blocksInUse == 0 || blockOffset + size > ARENA_BLOCK_SIZE) {
+            if (blocksInUse == arenaBlocks.size()) {
+                arenaBlocks.emplace_back(new RamDomain[ARENA_BLOCK_SIZE]);
+            }
+            ++blocksInUse;
+            blockOffset = 0;
+        }
+        RamDomain* res = arenaBlocks[blocksInUse - 1].get() + blockOffset;
+        blockOffset += size;
+        return res;
+    }
 
-        // Return the reference as raw pointer.
-        return allocatedDataContainer.back().get();
+    /** @brief Release all allocated tuples, keeping the arena blocks for later allocations */
+    void releaseTuples() {
+        blocksInUse = 0;
+        blockOffset = 0;
+        largeTuples.clear();
     }
 
     /** @brief Get subroutine return value */
@@ -79,15 +132,24 @@ public:
         return *returnValues;
     }
 
-    /** @brief Set subroutine return value */
-    void setReturnValues(std::vector<RamDomain>& retVals) {
+    /**
+     * @brief Set subroutine return value, and the lock guarding it if the subroutine returns values
+     * from several threads
+     */
+    void setReturnValues(std::vector<RamDomain>& retVals, std::mutex* lock = nullptr) {
         returnValues = &retVals;
+        returnLock = lock;
     }
 
-    /** @brief Add subroutine return value */
-    void addReturnValue(RamDomain val) {
+    /** @brief Add the values returned at once by a subroutine */
+    void addReturnValues(const RamDomain* values, size_t count) {
         assert(returnValues != nullptr);
-        returnValues->push_back(val);
+        if (returnLock == nullptr) {
+            returnValues->insert(returnValues->end(), values, values + count);
+            return;
+        }
+        std::lock_guard<std::mutex> guard(*returnLock);
+        returnValues->insert(returnValues->end(), values, values + count);
     }
 
     /** @brief Get subroutine Arguments */
@@ -106,17 +168,95 @@ public:
         return (*args)[i];
     }
 
-    /** @brief Create a view in the environment */
+    /** @brief Enable the buffering of insertions */
+    void setBufferingInserts(bool buffering) {
+        bufferingInserts = buffering;
+    }
+
+    /** @brief Check whether insertions are buffered */
+    bool isBufferingInserts() const {
+        return bufferingInserts;
+    }
+
+    /** @brief Buffer a tuple for the insertion into the given relation */
+    void bufferInsert(InterpreterRelation& rel, const RamDomain* tuple) {
+        auto& buffer = insertBuffers[&rel];
+        buffer.insert(buffer.end(), tuple, tuple + rel.getArity());
+    }
+
+    /** @brief Collect the flushed insertions in the given outbox instead of inserting them */
+    void setOutbox(std::unordered_map<InterpreterRelation*, std::vector<RamDomain>>* box) {
+        outbox = box;
+    }
+
+    /** @brief Get the outbox collecting flushed insertions, or null if they are inserted */
+    std::unordered_map<InterpreterRelation*, std::vector<RamDomain>>* getOutbox() const {
+        return outbox;
+    }
+
+    /** @brief Restrict the outermost scan to the partition of this rank */
+    void setPartitioned(bool p) {
+        partitioned = p;
+    }
+
+    /** @brief Check whether the outermost scan is restricted to the partition of this rank */
+    bool isPartitioned() const {
+        return partitioned;
+    }
+
+    /** @brief Evaluate parallel operations sequentially, without forking threads */
+    void setSequential(bool s) {
+        sequential = s;
+    }
+
+    /** @brief Check whether parallel operations are evaluated sequentially */
+    bool isSequential() const {
+        return sequential;
+    }
+
+    /** @brief Return the iteration of the innermost loop */
+    size_t getIteration() const {
+        return iteration;
+    }
+
+    /** @brief Set the iteration of the innermost loop */
+    void setIteration(size_t i) {
+        iteration = i;
+    }
+
+    /** @brief Mark the relations accessed by the enclosing stratum as locked by its task */
+    void setRelationsLocked(bool locked) {
+        relationsLocked = locked;
+    }
+
+    /** @brief Check whether the relations accessed by the enclosing stratum are locked by its task */
+    bool hasRelationsLocked() const {
+        return relationsLocked;
+    }
+
+    /** @brief Return a scratch buffer of at least the given number of values for a batch */
+    RamDomain* getBatchBuffer(size_t size) {
+        if (batchBuffer.size() < size) {
+            batchBuffer.resize(size);
+        }
+        return batchBuffer.data();
+    }
+
+    /** @brief Return the buffered tuples of each relation */
+    std::unordered_map<InterpreterRelation*, std::vector<RamDomain>>& getInsertBuffers() {
+        return insertBuffers;
+    }
+
+    /** @brief Create a view in the environment, reusing the view of this thread if it is still valid */
     void createView(const InterpreterRelation& rel, size_t indexPos, size_t viewPos) {
-        ViewPtr view;
         if (views.size() < viewPos + 1) {
             views.resize(viewPos + 1);
         }
-        views[viewPos] = rel.getView(indexPos);
+        views[viewPos] = rel.getView(indexPos, viewPos);
     }
 
     /** @brief Return a view */
-    ViewPtr& getView(size_t id) {
+    IndexView* getView(size_t id) {
         assert(id < views.size());
         return views[id];
     }
@@ -0,0 +1,122 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InterpreterDistribution.h
+ *
+ * Distributed evaluation of the interpreter across the ranks of an MPI job.
+ *
+ * All ranks evaluate the same program on replicated relations. The tuples
+ * of the outermost scan of a query are hash-partitioned across the ranks,
+ * such that each rank derives the tuples of its share of the scanned
+ * relation, and the tuples derived by all ranks are exchanged in a single
+ * batch at the end of the query. Hence, all ranks hold the same relations
+ * after each statement, and take the same decisions at the exit conditions
+ * of loops without any further termination detection.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+namespace souffle {
+
+class InterpreterDistribution {
+public:
+    InterpreterDistribution() {
+#ifdef USE_MPI
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (initialized == 0) {
+            // collective operations are only issued by the main thread, between parallel regions
+            int provided = 0;
+            MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &provided);
+            finalize = true;
+        }
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+#else
+        throw std::runtime_error("This installation of Souffle does not support distributed evaluation.");
+#endif
+    }
+
+    InterpreterDistribution(const InterpreterDistribution&) = delete;
+    InterpreterDistribution& operator=(const InterpreterDistribution&) = delete;
+
+    ~InterpreterDistribution() {
+#ifdef USE_MPI
+        if (finalize) {
+            MPI_Finalize();
+        }
+#endif
+    }
+
+    /** Get the rank of this process */
+    int getRank() const {
+        return rank;
+    }
+
+    /** Get the number of ranks */
+    int getSize() const {
+        return size;
+    }
+
+    /** Check whether a scanned tuple belongs to the partition of this rank */
+    bool isLocal(const RamDomain* tuple, size_t arity) const {
+        uint64_t hash = 0;
+        for (size_t i = 0; i < arity; ++i) {
+            hash = (hash ^ static_cast<uint64_t>(static_cast<RamUnsigned>(tuple[i]))) * 0x100000001b3ULL;
+            hash ^= hash >> 29;
+        }
+        return hash % static_cast<uint64_t>(size) == static_cast<uint64_t>(rank);
+    }
+
+    /**
+     * Exchange the values derived by each rank, returning the values of all ranks in the order of
+     * their ranks. Each rank must call this for the same relations in the same order.
+     */
+    std::vector<RamDomain> exchange(const std::vector<RamDomain>& local) const {
+#ifdef USE_MPI
+        const MPI_Datatype type = sizeof(RamDomain) == 4 ? MPI_INT32_T : MPI_INT64_T;
+        const int count = static_cast<int>(local.size());
+        std::vector<int> counts(size);
+        MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+        std::vector<int> offsets(size);
+        size_t total = 0;
+        for (int i = 0; i < size; ++i) {
+            offsets[i] = static_cast<int>(total);
+            total += counts[i];
+        }
+        std::vector<RamDomain> res(total);
+        MPI_Allgatherv(local.data(), count, type, res.data(), counts.data(), offsets.data(), type,
+                MPI_COMM_WORLD);
+        return res;
+#else
+        return local;
+#endif
+    }
+
+private:
+    int rank = 0;
+    int size = 1;
+
+    /** Whether MPI was initialised by this instance, and is finalised by it */
+    bool finalize = false;
+};
+
+}  // end of namespace souffle
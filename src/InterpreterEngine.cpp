@@ -16,14 +16,35 @@
 #include "InterpreterEngine.h"
 #include "IOSystem.h"
 #include "InterpreterGenerator.h"
+#include "InterpreterProgInterface.h"
+#include "LogStatement.h"
 #include "Logger.h"
+#include "NodePool.h"
+#include "RamBaseAnalysis.h"
 #include "RamTypes.h"
 #include "RecordTable.h"
+#include "ResourceLimits.h"
 #include "SignalHandler.h"
+#include "ThreadBinding.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <csignal>
-#include <regex>
+#include <cstdint>
+#include <functional>
 #include <ffi.h>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// The direct-threaded dispatch requires labels as values, a GNU extension
+#if defined(INTERPRETER_THREADED_DISPATCH) && !defined(__GNUC__)
+#undef INTERPRETER_THREADED_DISPATCH
+#endif
 
 namespace souffle {
 
@@ -34,18 +55,329 @@ namespace souffle {
 #define dynamicLibSuffix ".so";
 #endif
 
-// Aliases for foreign function interface.
-#if RAM_DOMAIN_SIZE == 64
-#define FFI_RamSigned ffi_type_sint64
-#define FFI_RamUnsigned ffi_type_uint64
-#define FFI_RamFloat ffi_type_double
-#else
-#define FFI_RamSigned ffi_type_sint32
-#define FFI_RamUnsigned ffi_type_uint32
-#define FFI_RamFloat ffi_type_float
-#endif
+namespace {
+
+/** Initial value of an aggregate */
+RamDomain initAggregate(AggregateFunction fun) {
+    switch (fun) {
+        case souffle::MIN:
+            return MAX_RAM_DOMAIN;
+        case souffle::MAX:
+            return MIN_RAM_DOMAIN;
+        case souffle::COUNT:
+        case souffle::SUM:
+            return 0;
+    }
+    assert(false && "unsupported aggregate function");
+    return 0;
+}
 
-#define FFI_Symbol ffi_type_pointer
+/** Combine two partial results of an aggregate; a count combines the number of elements */
+RamDomain combineAggregate(AggregateFunction fun, RamDomain left, RamDomain right) {
+    switch (fun) {
+        case souffle::MIN:
+            return std::min(left, right);
+        case souffle::MAX:
+            return std::max(left, right);
+        case souffle::COUNT:
+        case souffle::SUM:
+            return left + right;
+    }
+    assert(false && "unsupported aggregate function");
+    return 0;
+}
+
+/**
+ * Call a user-defined functor through a function pointer typed by its arity; the prefix
+ * arguments are passed ahead of the arguments of the functor
+ */
+template <typename... Prefix>
+RamDomain callFunctor(void (*fn)(), size_t arity, const RamDomain* args, Prefix... prefix) {
+    using D = RamDomain;
+    switch (arity) {
+        case 0: return reinterpret_cast<D (*)(Prefix...)>(fn)(prefix...);
+        case 1: return reinterpret_cast<D (*)(Prefix..., D)>(fn)(prefix..., args[0]);
+        case 2: return reinterpret_cast<D (*)(Prefix..., D, D)>(fn)(prefix..., args[0], args[1]);
+        case 3: return reinterpret_cast<D (*)(Prefix..., D, D, D)>(fn)(prefix..., args[0], args[1], args[2]);
+        case 4:
+            return reinterpret_cast<D (*)(Prefix..., D, D, D, D)>(fn)(
+                    prefix..., args[0], args[1], args[2], args[3]);
+    }
+    static_assert(MAX_DIRECT_FUNCTOR_ARITY == 4, "functor calls are typed up to four arguments");
+    assert(false && "unsupported arity of a direct functor call");
+    return 0;
+}
+
+/** A simple constraint of a batched scan, comparing a scanned column with a column or a value */
+struct BatchFilter {
+    BinaryConstraintOp op;
+    size_t column;
+    bool rhsIsColumn;
+    /** The column or the value compared with */
+    RamDomain rhs;
+};
+
+/** The operator of a simple constraint whose operands are swapped */
+BinaryConstraintOp mirroredConstraintOp(BinaryConstraintOp op) {
+    switch (op) {
+        case BinaryConstraintOp::LT:
+            return BinaryConstraintOp::GT;
+        case BinaryConstraintOp::LE:
+            return BinaryConstraintOp::GE;
+        case BinaryConstraintOp::GT:
+            return BinaryConstraintOp::LT;
+        case BinaryConstraintOp::GE:
+            return BinaryConstraintOp::LE;
+        default:
+            return op;
+    }
+}
+
+/**
+ * Split the conjuncts of a condition of a batched scan into the simple constraints reading the
+ * scanned tuple, whose other operands are loaded once, and the remaining conjuncts
+ *
+ * @return false if there are more than MAX_BATCH_FILTERS remaining conjuncts
+ */
+bool splitCondition(const InterpreterNode* condition, size_t tupleId, const InterpreterContext& ctxt,
+        BatchFilter* filters, size_t& numFilters, const InterpreterNode** residual, size_t& numResidual) {
+    if (condition->getType() == I_Conjunction) {
+        for (size_t i = 0; i < condition->getNumChildren(); ++i) {
+            if (!splitCondition(condition->getChild(i), tupleId, ctxt, filters, numFilters, residual,
+                        numResidual)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (condition->getType() == I_SimpleConstraint && numFilters < MAX_BATCH_FILTERS &&
+            (condition->getData(0) == tupleId || condition->getData(2) == tupleId)) {
+        // the scanned column is the left operand of the filter
+        auto op = static_cast<const RamConstraint*>(condition->getShadow())->getOperator();
+        size_t lhs = 0;
+        size_t rhs = 2;
+        if (condition->getData(0) != tupleId) {
+            op = mirroredConstraintOp(op);
+            std::swap(lhs, rhs);
+        }
+        BatchFilter& filter = filters[numFilters++];
+        filter.op = op;
+        filter.column = condition->getData(lhs + 1);
+        filter.rhsIsColumn = condition->getData(rhs) == tupleId;
+        if (filter.rhsIsColumn) {
+            filter.rhs = static_cast<RamDomain>(condition->getData(rhs + 1));
+        } else if (condition->getData(rhs) == CONSTANT_OPERAND) {
+            filter.rhs = static_cast<RamDomain>(condition->getData(rhs + 1));
+        } else {
+            filter.rhs = ctxt[condition->getData(rhs)][condition->getData(rhs + 1)];
+        }
+        return true;
+    }
+    if (numResidual == MAX_BATCH_FILTERS) {
+        return false;
+    }
+    residual[numResidual++] = condition;
+    return true;
+}
+
+/** Clear the mask of the tuples of a batch, stored column-wise, failing a comparison */
+template <typename Compare>
+void filterBatch(const BatchFilter& filter, const RamDomain* batch, size_t count, uint8_t* mask,
+        const Compare& compare) {
+    const RamDomain* lhs = batch + filter.column * FUSED_BATCH_SIZE;
+    if (filter.rhsIsColumn) {
+        const RamDomain* rhs = batch + filter.rhs * FUSED_BATCH_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            mask[i] &= static_cast<uint8_t>(compare(lhs[i], rhs[i]));
+        }
+    } else {
+        const RamDomain rhs = filter.rhs;
+        for (size_t i = 0; i < count; i++) {
+            mask[i] &= static_cast<uint8_t>(compare(lhs[i], rhs));
+        }
+    }
+}
+
+/** Clear the mask of the tuples of a batch failing the given filter */
+void filterBatch(const BatchFilter& filter, const RamDomain* batch, size_t count, uint8_t* mask) {
+    switch (filter.op) {
+        case BinaryConstraintOp::EQ:
+            return filterBatch(filter, batch, count, mask, std::equal_to<RamDomain>());
+        case BinaryConstraintOp::NE:
+            return filterBatch(filter, batch, count, mask, std::not_equal_to<RamDomain>());
+        case BinaryConstraintOp::LT:
+            return filterBatch(filter, batch, count, mask, std::less<RamDomain>());
+        case BinaryConstraintOp::LE:
+            return filterBatch(filter, batch, count, mask, std::less_equal<RamDomain>());
+        case BinaryConstraintOp::GT:
+            return filterBatch(filter, batch, count, mask, std::greater<RamDomain>());
+        case BinaryConstraintOp::GE:
+            return filterBatch(filter, batch, count, mask, std::greater_equal<RamDomain>());
+        default:
+            assert(false && "unsupported operator of a simple constraint");
+    }
+}
+
+/**
+ * A hash table of copied tuples on a set of key columns, chaining the tuples of each bucket,
+ * which is built once and probed by tuples of another relation bound on corresponding columns
+ */
+class TupleHashTable {
+public:
+    TupleHashTable(size_t arity, std::vector<size_t> keys) : arity(arity), keys(std::move(keys)) {}
+
+    /** Copy a tuple into the table; the table is built after all tuples are added */
+    void add(const RamDomain* tuple) {
+        rows.insert(rows.end(), tuple, tuple + arity);
+    }
+
+    /** Chain the added tuples into buckets */
+    void build() {
+        const size_t count = rows.size() / arity;
+        size_t buckets = 1;
+        while (buckets < 2 * count) {
+            buckets <<= 1;
+        }
+        mask = buckets - 1;
+        heads.assign(buckets, END);
+        next.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            size_t& head = heads[hash(&rows[i * arity], keys)];
+            next[i] = head;
+            head = i;
+        }
+    }
+
+    /** Call a function for each tuple of the table whose keys equal the given columns of a tuple */
+    template <typename F>
+    void probe(const RamDomain* tuple, const std::vector<size_t>& columns, const F& f) const {
+        for (size_t i = heads[hash(tuple, columns)]; i != END; i = next[i]) {
+            const RamDomain* row = &rows[i * arity];
+            bool match = true;
+            for (size_t k = 0; k < keys.size() && match; k++) {
+                match = row[keys[k]] == tuple[columns[k]];
+            }
+            if (match) {
+                f(row);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t END = std::numeric_limits<size_t>::max();
+
+    size_t hash(const RamDomain* tuple, const std::vector<size_t>& columns) const {
+        uint64_t hash = 0;
+        for (size_t column : columns) {
+            hash = (hash ^ static_cast<uint64_t>(static_cast<RamUnsigned>(tuple[column]))) * 0x100000001b3ULL;
+            hash ^= hash >> 29;
+        }
+        return hash & mask;
+    }
+
+    const size_t arity;
+    const std::vector<size_t> keys;
+    std::vector<RamDomain> rows;
+    std::vector<size_t> heads;
+    std::vector<size_t> next;
+    size_t mask = 0;
+};
+
+/**
+ * A hash table of the aggregates of groups, keyed by a set of columns of tuples, which is built by
+ * combining the values of the tuples of each group and looked up afterwards
+ */
+class TupleGroupTable {
+public:
+    TupleGroupTable(std::vector<size_t> columns, AggregateFunction fun)
+            : columns(std::move(columns)), fun(fun), slots(16, END), mask(15) {}
+
+    /** Combine a value into the aggregate of the group on the columns of a tuple */
+    void add(const RamDomain* tuple, RamDomain value) {
+        RamDomain key[columns.size()];
+        for (size_t k = 0; k < columns.size(); k++) {
+            key[k] = tuple[columns[k]];
+        }
+        combine(key, value);
+    }
+
+    /** Combine the aggregates of another table on the same columns into the aggregates of this one */
+    void merge(const TupleGroupTable& other) {
+        for (size_t i = 0; i < other.values.size(); i++) {
+            combine(&other.keys[i * columns.size()], other.values[i]);
+        }
+    }
+
+    /** Find the aggregate of the group on the columns of a tuple, or nullptr if there is none */
+    const RamDomain* find(const RamDomain* tuple) const {
+        RamDomain key[columns.size()];
+        for (size_t k = 0; k < columns.size(); k++) {
+            key[k] = tuple[columns[k]];
+        }
+        const size_t group = slots[locate(key)];
+        return group == END ? nullptr : &values[group];
+    }
+
+private:
+    static constexpr size_t END = std::numeric_limits<size_t>::max();
+
+    size_t hash(const RamDomain* key) const {
+        uint64_t hash = 0;
+        for (size_t k = 0; k < columns.size(); k++) {
+            hash = (hash ^ static_cast<uint64_t>(static_cast<RamUnsigned>(key[k]))) * 0x100000001b3ULL;
+            hash ^= hash >> 29;
+        }
+        return hash & mask;
+    }
+
+    /** Get the slot of the group of a key, or the free slot it would occupy */
+    size_t locate(const RamDomain* key) const {
+        const size_t width = columns.size();
+        size_t pos = hash(key);
+        while (slots[pos] != END && !std::equal(key, key + width, &keys[slots[pos] * width])) {
+            pos = (pos + 1) & mask;
+        }
+        return pos;
+    }
+
+    void combine(const RamDomain* key, RamDomain value) {
+        size_t pos = locate(key);
+        if (slots[pos] == END) {
+            // the table is kept at most half full, doubling its slots when necessary
+            if (2 * (values.size() + 1) > slots.size()) {
+                slots.assign(2 * slots.size(), END);
+                mask = slots.size() - 1;
+                for (size_t i = 0; i < values.size(); i++) {
+                    slots[locate(&keys[i * columns.size()])] = i;
+                }
+                pos = locate(key);
+            }
+            slots[pos] = values.size();
+            keys.insert(keys.end(), key, key + columns.size());
+            values.push_back(initAggregate(fun));
+        }
+        RamDomain& aggregate = values[slots[pos]];
+        aggregate = combineAggregate(fun, aggregate, value);
+    }
+
+    const std::vector<size_t> columns;
+    const AggregateFunction fun;
+    std::vector<RamDomain> keys;
+    std::vector<RamDomain> values;
+    std::vector<size_t> slots;
+    size_t mask;
+};
+
+/** Obtain the words of a tuple visited by a scan, see InterpreterEngine::prefetchScan */
+const RamDomain* getWords(const RamDomain* tuple) {
+    return tuple;
+}
+
+const RamDomain* getWords(const TupleRef& tuple) {
+    return tuple.getBase();
+}
+
+}  // namespace
 
 InterpreterEngine::RelationHandle& InterpreterEngine::getRelationHandle(const size_t idx) {
     return generator.getRelationHandle(idx);
@@ -57,7 +389,7 @@ void InterpreterEngine::swapRelation(const size_t ramRel1, const size_t ramRel2)
     std::swap(rel1, rel2);
 }
 
-int InterpreterEngine::incCounter() {
+RamDomain InterpreterEngine::incCounter() {
     return counter++;
 }
 
@@ -133,14 +465,159 @@ const std::vector<void*>& InterpreterEngine::loadDLL() {
     return dll;
 }
 
-size_t InterpreterEngine::getIterationNumber() const {
-    return iteration;
+void InterpreterEngine::lockRelations(const InterpreterNode* schedule, size_t pos) {
+    const size_t count = schedule->getData(pos++);
+    for (size_t i = 0; i < count; ++i, pos += 2) {
+        std::shared_mutex& lock = relationLocks[schedule->getData(pos)];
+        const bool written = schedule->getData(pos + 1) != 0;
+        if (written ? lock.try_lock() : lock.try_lock_shared()) {
+            continue;
+        }
+        // the relation is accessed by a concurrent stratum, which the dependencies of the schedule do
+        // not order, e.g., one building the index of a relation the other one reads
+        const auto start = std::chrono::steady_clock::now();
+        if (written) {
+            lock.lock();
+        } else {
+            lock.lock_shared();
+        }
+        const auto waited = std::chrono::steady_clock::now() - start;
+        strataStatistics.waits++;
+        strataStatistics.waitTime += std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+    }
+}
+
+void InterpreterEngine::unlockRelations(const InterpreterNode* schedule, size_t pos) {
+    const size_t count = schedule->getData(pos++);
+    for (size_t i = 0; i < count; ++i, pos += 2) {
+        std::shared_mutex& lock = relationLocks[schedule->getData(pos)];
+        if (schedule->getData(pos + 1) != 0) {
+            lock.unlock();
+        } else {
+            lock.unlock_shared();
+        }
+    }
+}
+
+size_t InterpreterEngine::getMaxChunks(const InterpreterContext& ctxt) const {
+    return ctxt.isSequential() ? 1 : numOfPartitions;
+}
+
+bool InterpreterEngine::isTailIteration(const InterpreterNode* loop) {
+    if (tailThreshold == 0 || loop->getDataSize() == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < loop->getDataSize(); ++i) {
+        if (getRelationHandle(loop->getData(i))->size() >= tailThreshold) {
+            return false;
+        }
+    }
+    return true;
 }
-void InterpreterEngine::incIterationNumber() {
-    ++iteration;
+
+size_t InterpreterEngine::getTrackedMemory() {
+    size_t bytes = getSymbolTable().memoryUsage() + getRecordTable().memoryUsage();
+    for (const auto& handle : getRelationMap()) {
+        if (handle != nullptr && *handle != nullptr) {
+            for (size_t index : (*handle)->getMemoryUsage()) {
+                bytes += index;
+            }
+        }
+    }
+    return bytes;
 }
-void InterpreterEngine::resetIterationNumber() {
-    iteration = 0;
+
+void InterpreterEngine::checkMemoryLimit() {
+    // reading the resident memory is cheap, but queries may be short
+    const auto now = std::chrono::steady_clock::now();
+    if (now < nextMemoryCheck) {
+        return;
+    }
+    nextMemoryCheck = now + std::chrono::milliseconds(100);
+    const size_t threshold = memoryLimit / 8 * 7;
+    const size_t resident = ResourceLimits::getResidentMemory();
+    if (resident <= threshold) {
+        return;
+    }
+    nextMemoryCheck = now + std::chrono::seconds(1);
+
+    // freed memory is rarely returned to the operating system, hence the actions are measured by the
+    // estimated bytes of the data structures rather than by the resident memory
+    const std::string round = LogStatement::memoryLimit(memoryRounds++);
+    auto& profile = ProfileEventSingleton::instance();
+    const size_t excess = resident - threshold;
+    const size_t tracked = getTrackedMemory();
+    if (profileEnabled) {
+        profile.makeTimeEvent(round + ";time");
+        profile.makeQuantityEvent(round + ";resident", resident, 0);
+        profile.makeQuantityEvent(round + ";tracked", tracked, 0);
+    }
+    size_t freed = 0;
+    auto apply = [&](const std::string& action, size_t relId, auto&& free) {
+        InterpreterRelation& rel = *getRelationHandle(relId);
+        const auto before = rel.getMemoryUsage();
+        free(rel);
+        const auto after = rel.getMemoryUsage();
+        size_t bytes = 0;
+        for (size_t i = 0; i < before.size() && i < after.size(); ++i) {
+            bytes += before[i] > after[i] ? before[i] - after[i] : 0;
+        }
+        freed += bytes;
+        if (profileEnabled && bytes > 0) {
+            profile.makeQuantityEvent(round + ";" + action + ";" + rel.getName(), bytes, 0);
+        }
+    };
+
+    // pack the relations only read anymore, at the cost of copying them once
+    for (auto it = frozenRelations.begin(); it != frozenRelations.end() && freed < excess;) {
+        apply("compact", *it, [](InterpreterRelation& rel) { rel.compact(); });
+        it = frozenRelations.erase(it);
+    }
+
+    // spill the relations buffering their tuples in memory to disk sooner
+    if (freed < excess && ExternalMemory::budget > 0) {
+        ExternalMemory::budget = ExternalMemory::budget / 2;
+        for (size_t relId = 0; relId < getRelationMap().size(); ++relId) {
+            const auto& handle = getRelationMap()[relId];
+            if (handle != nullptr && *handle != nullptr) {
+                apply("spill", relId, [](InterpreterRelation& rel) { rel.spill(); });
+            }
+        }
+    }
+
+    // drop the secondary indexes of the relations not read recently, the largest first, which are built
+    // again before they are read next
+    if (freed < excess) {
+        std::vector<std::pair<size_t, size_t>> candidates;
+        for (size_t relId = 0; relId < getRelationMap().size(); ++relId) {
+            const auto& handle = getRelationMap()[relId];
+            if (handle == nullptr || *handle == nullptr || recentRelations.count(relId) > 0) {
+                continue;
+            }
+            size_t bytes = 0;
+            for (size_t index : (*handle)->getMemoryUsage()) {
+                bytes += index;
+            }
+            candidates.emplace_back(bytes, relId);
+        }
+        std::sort(candidates.rbegin(), candidates.rend());
+        for (size_t i = 0; i < candidates.size() && freed < excess; ++i) {
+            apply("drop-indexes", candidates[i].second, [&](InterpreterRelation& rel) {
+                indexesEvicted |= rel.evictIndexes() > 0;
+            });
+        }
+    }
+    recentRelations.clear();
+
+    if (profileEnabled) {
+        profile.makeQuantityEvent(round + ";freed", freed, 0);
+    }
+    if (freed < excess && !memoryExceeded) {
+        memoryExceeded = true;
+        std::cerr << "Warning: the resident memory of " << (resident >> 20) << "MiB exceeds "
+                  << (threshold >> 20) << "MiB of the memory limit of " << (memoryLimit >> 20)
+                  << "MiB, and only " << (freed >> 20) << "MiB could be freed\n";
+    }
 }
 
 void InterpreterEngine::executeMain() {
@@ -149,22 +626,37 @@ void InterpreterEngine::executeMain() {
         SignalHandler::instance()->enableLogging();
     }
 
+    // the threads of the evaluation are shared with the programs evaluated concurrently
+    ThreadBudget::Lease threads(numOfThreads > 0 ? numOfThreads : 0);
+    const std::string threadPlacement = bindThreads(Global::config().get("thread-binding"));
+
     RamStatement& program = tUnit.getProgram().getMain();
     auto entry = generator.generateTree(program);
+    relationLocks = std::vector<std::shared_mutex>(getRelationMap().size());
+    if (Global::config().has("memory-limit")) {
+        memoryLimit = std::stoull(Global::config().get("memory-limit"));
+    }
     InterpreterContext ctxt;
 
     if (!profileEnabled) {
+        // sample the rules of the program without instrumenting it, writing the samples as a profile
+        const bool sampling = Global::config().has("profile-sampling");
+        if (sampling) {
+            ProfileEventSingleton::instance().setOutputFile(Global::config().get("profile-sampling"));
+            SignalHandler::instance()->startSampling();
+        }
         InterpreterContext ctxt;
         execute(entry.get(), ctxt);
+        if (sampling) {
+            ProfileEventSingleton::instance().makeSamplesEvent(SignalHandler::instance()->stopSampling());
+        }
     } else {
         ProfileEventSingleton::instance().setOutputFile(Global::config().get("profile"));
+        if (Global::config().has("profile-counters")) {
+            ProfileEventSingleton::instance().enableCounters();
+        }
         // Prepare the frequency table for threaded use
-        visitDepthFirst(program, [&](const RamTupleOperation& node) {
-            if (!node.getProfileText().empty()) {
-                frequencies.emplace(node.getProfileText(), std::deque<std::atomic<size_t>>());
-                frequencies[node.getProfileText()].emplace_back(0);
-            }
-        });
+        frequencies.resize(generator.getProfileTexts().size(), std::vector<size_t>(1, 0));
         // Enable profiling for execution of main
         ProfileEventSingleton::instance().startTimer();
         ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");
@@ -172,6 +664,17 @@ void InterpreterEngine::executeMain() {
         for (const auto& cur : Global::config().data()) {
             ProfileEventSingleton::instance().makeConfigRecord(cur.first, cur.second);
         }
+        if (!threadPlacement.empty()) {
+            ProfileEventSingleton::instance().makeConfigRecord("thread-placement", threadPlacement);
+        }
+        // the effective parallelism and memory limit, e.g., of a container, rather than those requested
+        ProfileEventSingleton::instance().makeConfigRecord("threads", std::to_string(threads.size()));
+        ProfileEventSingleton::instance().makeConfigRecord(
+                "processors", std::to_string(ResourceLimits::getProcessors()));
+        if (!Global::config().has("memory-limit") && ResourceLimits::getMemoryLimit() > 0) {
+            ProfileEventSingleton::instance().makeConfigRecord(
+                    "memory-limit", std::to_string(ResourceLimits::getMemoryLimit()));
+        }
         // Store count of relations
         size_t relationCount = 0;
         for (auto rel : tUnit.getProgram().getRelations()) {
@@ -179,7 +682,19 @@ void InterpreterEngine::executeMain() {
                 ++relationCount;
                 reads[rel->getName()] = 0;
             }
+            parallelism[rel->getName()] = {0, 0};
         }
+        // Prepare the counters of searches, the seeks of leapfrog joins are not counted
+        visitDepthFirst(tUnit.getProgram(), [&](const RamIndexOperation& search) {
+            if (dynamic_cast<const RamLeapfrogJoin*>(&search) == nullptr) {
+                searches[&search] = 0;
+                searchTuples[&search] = 0;
+            }
+        });
+        visitDepthFirst(tUnit.getProgram(), [&](const RamExistenceCheck& exists) {
+            searches[&exists] = 0;
+            searchTuples[&exists] = 0;
+        });
         ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string(relationCount));
 
         // Store count of rules
@@ -189,51 +704,838 @@ void InterpreterEngine::executeMain() {
 
         InterpreterContext ctxt;
         execute(entry.get(), ctxt);
+        mergeFrequencies(ctxt.getIteration());
         ProfileEventSingleton::instance().stopTimer();
-        for (auto const& cur : frequencies) {
-            for (size_t i = 0; i < cur.second.size(); ++i) {
-                ProfileEventSingleton::instance().makeQuantityEvent(cur.first, cur.second[i], i);
+        for (size_t id = 0; id < frequencies.size(); ++id) {
+            const std::string& text = generator.getProfileTexts()[id];
+            for (size_t i = 0; i < frequencies[id].size(); ++i) {
+                ProfileEventSingleton::instance().makeQuantityEvent(text, frequencies[id][i], i);
             }
         }
         for (auto const& cur : reads) {
             ProfileEventSingleton::instance().makeQuantityEvent(
                     "@relation-reads;" + cur.first, cur.second, 0);
         }
+        // accumulate the executions of the searches of each relation, and the tuples they found, by their
+        // signature
+        std::map<std::string, std::map<SearchSignature, std::array<size_t, 2>>> searchCounts;
+        for (auto const& cur : searches) {
+            SearchSignature signature = 0;
+            const RamRelation* rel = nullptr;
+            if (const auto* search = dynamic_cast<const RamIndexOperation*>(cur.first)) {
+                signature = isa->getSearchSignature(search);
+                rel = &search->getRelation();
+            } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(cur.first)) {
+                signature = isa->getSearchSignature(exists);
+                rel = &exists->getRelation();
+            }
+            auto& counts = searchCounts[rel->getName()][signature];
+            counts[0] += cur.second;
+            counts[1] += searchTuples[cur.first];
+        }
+        for (auto const& rel : searchCounts) {
+            for (auto const& cur : rel.second) {
+                const std::string search = rel.first + ";" + std::to_string(cur.first);
+                ProfileEventSingleton::instance().makeQuantityEvent(
+                        "@relation-searches;" + search, cur.second[0], 0);
+                ProfileEventSingleton::instance().makeQuantityEvent(
+                        "@relation-search-tuples;" + search, cur.second[1], 0);
+            }
+        }
+        // the hits and misses of the operation hints of each index
+        if (isHintsProfilingEnabled()) {
+            for (const auto& handle : getRelationMap()) {
+                if (handle == nullptr || *handle == nullptr) {
+                    continue;
+                }
+                const InterpreterRelation& rel = **handle;
+                const auto statistics = rel.getHintStatistics();
+                for (size_t i = 0; i < statistics.size(); ++i) {
+                    for (const auto& op : statistics[i]) {
+                        ProfileEventSingleton::instance().makeHintEvent(
+                                "@relation-hints;" + rel.getName() + ";" + std::to_string(i) + ";" + op.first,
+                                op.second[0], op.second[1]);
+                    }
+                }
+            }
+        }
+        // attribute parallel operations on delta and new relations to their relation
+        std::map<std::string, std::array<size_t, 2>> parallelScans;
+        for (auto const& cur : parallelism) {
+            std::string name = cur.first;
+            for (const std::string prefix : {"@delta_", "@new_"}) {
+                if (name.compare(0, prefix.size(), prefix) == 0) {
+                    name = name.substr(prefix.size());
+                }
+            }
+            if (name[0] != '@' && cur.second[0] + cur.second[1] > 0) {
+                parallelScans[name][0] += cur.second[0];
+                parallelScans[name][1] += cur.second[1];
+            }
+        }
+        for (auto const& cur : parallelScans) {
+            ProfileEventSingleton::instance().makeQuantityEvent(
+                    "@parallel-scans;" + cur.first + ";parallel", cur.second[0], 0);
+            ProfileEventSingleton::instance().makeQuantityEvent(
+                    "@parallel-scans;" + cur.first + ";sequential", cur.second[1], 0);
+        }
+        ParallelLoopProfile::instance().makeEvents();
+        const NodePoolStatistics nodes = NodePool::getStatistics();
+        ProfileEventSingleton::instance().makeQuantityEvent("@node-pool;reserved", nodes.reserved, 0);
+        ProfileEventSingleton::instance().makeQuantityEvent("@node-pool;in-use", nodes.inUse, 0);
+        ProfileEventSingleton::instance().makeQuantityEvent("@node-pool;huge-pages", nodes.hugePages, 0);
+    }
+    if (Global::config().has("verbose") && strataStatistics.evaluated > 0) {
+        std::cerr << "Strata of schedules: " << strataStatistics.evaluated << " evaluated, at most "
+                  << strataStatistics.peak << " concurrently, " << strataStatistics.waits
+                  << " waits for relations locked by other strata taking "
+                  << strataStatistics.waitTime / 1000 << "ms\n";
+    }
+    // the subroutines and the program interface search the relations without preambles
+    if (indexesEvicted) {
+        for (const auto& handle : getRelationMap()) {
+            if (handle != nullptr && *handle != nullptr) {
+                (*handle)->restoreIndexes();
+            }
+        }
+        indexesEvicted = false;
+    }
+    memoryLimit = 0;
+    frozenRelations.clear();
+    SignalHandler::instance()->reset();
+}
+void InterpreterEngine::executeQuery(const std::function<bool(const std::string&)>& isBaseRelation) {
+    SignalHandler::instance()->set();
+    ThreadBudget::Lease threads(numOfThreads > 0 ? numOfThreads : 0);
+    performIO = false;
+    InterpreterContext ctxt;
+    // the statements computing base relations only are skipped, the base relations being kept
+    for (const RamStatement* statement : RamBaseAnalysis::getStatements(tUnit.getProgram().getMain())) {
+        const std::set<std::string> computed = RamBaseAnalysis::getComputedRelations(*statement);
+        if (!computed.empty() && std::all_of(computed.begin(), computed.end(), isBaseRelation)) {
+            continue;
+        }
+        auto entry = generator.generateTree(*statement);
+        execute(entry.get(), ctxt);
     }
+    performIO = true;
     SignalHandler::instance()->reset();
 }
+
 void InterpreterEngine::executeSubroutine(
         const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) {
+    // the trees are generated once, such that subroutines may be executed concurrently
+    const Subroutine& sub = subroutines.at(name);
+    std::mutex lock;
     InterpreterContext ctxt;
-    ctxt.setReturnValues(ret);
+    ctxt.setReturnValues(ret, sub.isParallel ? &lock : nullptr);
     ctxt.setArguments(args);
+    execute(sub.entry.get(), ctxt);
+}
+
+void InterpreterEngine::executeSubroutines(const std::string& name,
+        const std::vector<std::vector<RamDomain>>& args, std::vector<std::vector<RamDomain>>& ret) {
+    const Subroutine& sub = subroutines.at(name);
+    ret.assign(args.size(), std::vector<RamDomain>());
+    // the argument vectors are distributed over the threads; a parallel subroutine then runs its
+    // parallel searches on the thread of its argument vector
+    ThreadBudget::Lease threads(numOfThreads > 0 ? numOfThreads : 0);
+    PARALLEL_START
+    pfor(size_t i = 0; i < args.size(); i++) {
+        std::mutex lock;
+        InterpreterContext ctxt;
+        ctxt.setReturnValues(ret[i], sub.isParallel ? &lock : nullptr);
+        ctxt.setArguments(args[i]);
+        execute(sub.entry.get(), ctxt);
+    }
+    PARALLEL_END
+}
+
+void InterpreterEngine::countFrequency(size_t id) {
+#ifdef IS_PARALLEL
+    size_t thread = omp_get_thread_num();
+#else
+    size_t thread = 0;
+#endif
+    assert(thread < threadProfiles.size() && "profile counters of thread not allocated");
+    auto& counters = threadProfiles[thread].frequencies;
+    if (id >= counters.size()) {
+        counters.resize(id + 1, 0);
+    }
+    ++counters[id];
+}
+
+void InterpreterEngine::countSearch(const RamNode* search) {
+    if (profileEnabled) {
+        auto pos = searches.find(search);
+        if (pos != searches.end()) {
+            pos->second++;
+        }
+    }
+}
+
+void InterpreterEngine::countSearchTuples(const RamNode* search, size_t tuples) {
+    if (profileEnabled) {
+        auto pos = searchTuples.find(search);
+        if (pos != searchTuples.end()) {
+            pos->second += tuples;
+        }
+    }
+}
 
-    auto entry = generator.generateTree(tUnit.getProgram().getSubroutine(name));
-    execute(entry.get(), ctxt);
+void InterpreterEngine::mergeFrequencies(size_t iteration) {
+    if (frequencies.size() < generator.getProfileTexts().size()) {
+        frequencies.resize(generator.getProfileTexts().size(), std::vector<size_t>(1, 0));
+    }
+    for (auto& profile : threadProfiles) {
+        for (size_t id = 0; id < profile.frequencies.size(); ++id) {
+            if (profile.frequencies[id] == 0) {
+                continue;
+            }
+            if (frequencies[id].size() <= iteration) {
+                frequencies[id].resize(iteration + 1, 0);
+            }
+            frequencies[id][iteration] += profile.frequencies[id];
+            profile.frequencies[id] = 0;
+        }
+    }
+}
+
+void InterpreterEngine::flushInsertBuffers(InterpreterContext& ctxt, const InterpreterPreamble& preamble) {
+    auto& buffers = ctxt.getInsertBuffers();
+    for (size_t relId : preamble.bufferedRelations) {
+        InterpreterRelation& rel = *getRelationHandle(relId);
+        const std::vector<RamDomain>& buffer = buffers[&rel];
+        const size_t arity = rel.getArity();
+        const size_t count = buffer.size() / arity;
+
+        // sort the tuples by the main order of the relation outside of critical sections, inserting them
+        // in order
+        const std::vector<int>& order = rel.getMainOrder().getOrder();
+        auto less = [&](const RamDomain* a, const RamDomain* b) {
+            for (int column : order) {
+                if (a[column] != b[column]) {
+                    return a[column] < b[column];
+                }
+            }
+            return std::lexicographical_compare(a, a + arity, b, b + arity);
+        };
+        std::vector<const RamDomain*> sorted(count);
+        for (size_t i = 0; i < count; i++) {
+            sorted[i] = &buffer[i * arity];
+        }
+        std::sort(sorted.begin(), sorted.end(), less);
+
+        if (ctxt.getOutbox() != nullptr) {
+            PARALLEL_CRITICAL {
+                auto& outbox = (*ctxt.getOutbox())[&rel];
+                for (const RamDomain* tuple : sorted) {
+                    outbox.insert(outbox.end(), tuple, tuple + arity);
+                }
+            }
+            continue;
+        }
+        // the threads insert disjoint ranges of the main order of the relation from all buffers, rather than
+        // contending for the same leaves of its index; a single thread inserts its buffer at once
+        auto insert = [&](const RamDomain* tuple) { rel.insert(TupleRef(tuple, arity)); };
+        if (!insertByRanges(sorted, less, insert)) {
+            std::vector<RamDomain> tuples;
+            tuples.reserve(buffer.size());
+            for (const RamDomain* tuple : sorted) {
+                tuples.insert(tuples.end(), tuple, tuple + arity);
+            }
+            rel.insertBulk(tuples.data(), count, arity);
+        }
+    }
+    buffers.clear();
+}
+
+void InterpreterEngine::transientHashJoin(const InterpreterNode* node, InterpreterContext& ctxt) {
+    const auto& join = *static_cast<const RamHashJoin*>(node->getShadow());
+    const size_t outerId = join.getTupleId();
+    const size_t innerId = join.getInnerScan().getTupleId();
+    InterpreterRelation& outer = *node->getRelation();
+    InterpreterRelation& inner = *getRelationHandle(node->getData(0));
+    const bool partitioned = ctxt.isPartitioned() && outerId == 0;
+
+    // the keys of the inner relation are bound by columns of the outer tuple, or by constants
+    std::vector<size_t> innerKeys;
+    std::vector<size_t> outerKeys;
+    std::vector<std::pair<size_t, RamDomain>> constants;
+    for (size_t i = 0; i < node->getData(1); i++) {
+        const size_t column = node->getData(2 + 3 * i);
+        if (node->getData(3 + 3 * i) == CONSTANT_OPERAND) {
+            constants.emplace_back(column, static_cast<RamDomain>(node->getData(4 + 3 * i)));
+        } else {
+            innerKeys.push_back(column);
+            outerKeys.push_back(node->getData(4 + 3 * i));
+        }
+    }
+    auto isCandidate = [&](const RamDomain* tuple) {
+        return std::all_of(constants.begin(), constants.end(),
+                [&](const std::pair<size_t, RamDomain>& c) { return tuple[c.first] == c.second; });
+    };
+    auto isLocal = [&](const RamDomain* tuple) {
+        return !partitioned || distribution->isLocal(tuple, outer.getArity());
+    };
+
+    // the hash table is built on the smaller relation, and probed by the tuples of the larger one
+    const bool buildOuter = outer.size() <= inner.size();
+    InterpreterRelation& probed = buildOuter ? inner : outer;
+    TupleHashTable table(
+            buildOuter ? outer.getArity() : inner.getArity(), buildOuter ? outerKeys : innerKeys);
+    for (const RamDomain* tuple : buildOuter ? outer : inner) {
+        if (buildOuter ? isLocal(tuple) : isCandidate(tuple)) {
+            table.add(tuple);
+        }
+    }
+    table.build();
+
+    // the filter of the inner scan checks the keys of each pair of joined tuples and evaluates the nested
+    // operation of the join
+    const InterpreterNode* nested = node->getChild(0);
+    auto probe = [&](const RamDomain* tuple, InterpreterContext& probeCtxt) {
+        if (buildOuter) {
+            if (!isCandidate(tuple)) {
+                return;
+            }
+            probeCtxt[innerId] = tuple;
+            table.probe(tuple, innerKeys, [&](const RamDomain* row) {
+                probeCtxt[outerId] = row;
+                execute(nested, probeCtxt);
+            });
+        } else if (isLocal(tuple)) {
+            probeCtxt[outerId] = tuple;
+            table.probe(tuple, outerKeys, [&](const RamDomain* row) {
+                probeCtxt[innerId] = row;
+                execute(nested, probeCtxt);
+            });
+        }
+    };
+
+    if (dynamic_cast<const RamAbstractParallel*>(&join) == nullptr) {
+        for (const RamDomain* tuple : probed) {
+            probe(tuple, ctxt);
+        }
+        return;
+    }
+    auto preamble = node->getPreamble();
+    auto pStream = probed.partitionScan(parallelChunkCount(probed.size(), getMaxChunks(ctxt)));
+    WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+    PARALLEL_START_IF(pStream.size() > 1)
+        ;
+        InterpreterContext newCtxt(ctxt);
+        newCtxt.setBufferingInserts(preamble->bufferInserts);
+        for (const auto& info : preamble->getViewInfoForNested()) {
+            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+        }
+        pfor_steal(it, pStream, pLoop) {
+            for (const TupleRef& val : *it) {
+                probe(val.getBase(), newCtxt);
+            }
+        }
+        flushInsertBuffers(newCtxt, *preamble);
+    PARALLEL_END;
+    if (profileEnabled) {
+        ParallelLoopProfile::instance().record(pLoop);
+    }
+}
+
+void InterpreterEngine::groupAggregate(const InterpreterNode* node, InterpreterContext& ctxt) {
+    const auto& group = *static_cast<const RamGroupAggregate*>(node->getShadow());
+    const AggregateFunction fun = group.getAggregate().getFunction();
+    const size_t outerId = group.getTupleId();
+    const size_t innerId = group.getAggregate().getTupleId();
+    InterpreterRelation& outer = *node->getRelation();
+    InterpreterRelation& inner = *getRelationHandle(node->getData(0));
+    const bool partitioned = ctxt.isPartitioned() && outerId == 0;
+    const bool parallel = dynamic_cast<const RamAbstractParallel*>(&group) != nullptr;
+    auto preamble = node->getPreamble();
+
+    // the groups are keyed by the elements of the scanned tuple which the keys equate with columns of the
+    // aggregated tuples
+    std::vector<std::pair<size_t, size_t>> keys;
+    std::vector<size_t> columns;
+    for (size_t i = 0; i < node->getData(1); i++) {
+        keys.emplace_back(node->getData(2 + 2 * i), node->getData(3 + 2 * i));
+        columns.push_back(node->getData(3 + 2 * i));
+    }
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+
+    // an aggregated tuple is evaluated together with the key of its group in place of the scanned tuple,
+    // which satisfies the keys of the condition unless they equate an element with distinct columns
+    const InterpreterNode* condition = node->getChild(0);
+    const InterpreterNode* expression = node->getChild(1);
+    auto aggregate = [&](const RamDomain* tuple, RamDomain* key, InterpreterContext& aggCtxt,
+                             TupleGroupTable& table) {
+        for (const auto& cur : keys) {
+            key[cur.second] = tuple[cur.first];
+        }
+        aggCtxt[innerId] = tuple;
+        aggCtxt[outerId] = key;
+        if (execute(condition, aggCtxt)) {
+            table.add(key, fun == souffle::COUNT ? 1 : execute(expression, aggCtxt));
+        }
+    };
+
+    // aggregate the groups in a single pass, per thread for parallel operations
+    TupleGroupTable table(columns, fun);
+    if (!parallel) {
+        std::vector<RamDomain> key(outer.getArity());
+        for (const RamDomain* tuple : inner) {
+            aggregate(tuple, key.data(), ctxt, table);
+        }
+    } else {
+        auto pStream = inner.partitionScan(parallelChunkCount(inner.size(), getMaxChunks(ctxt)));
+        WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+        PARALLEL_START_IF(pStream.size() > 1)
+            ;
+            InterpreterContext newCtxt(ctxt);
+            for (const auto& info : preamble->getViewInfoForNested()) {
+                newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+            }
+            TupleGroupTable partial(columns, fun);
+            std::vector<RamDomain> key(outer.getArity());
+            pfor_steal(it, pStream, pLoop) {
+                for (const TupleRef& val : *it) {
+                    aggregate(val.getBase(), key.data(), newCtxt, partial);
+                }
+            }
+            PARALLEL_CRITICAL
+            table.merge(partial);
+        PARALLEL_END;
+        if (profileEnabled) {
+            ParallelLoopProfile::instance().record(pLoop);
+        }
+    }
+
+    // look up the group of each scanned tuple, where a missing group yields the aggregate of no tuples
+    const InterpreterNode* nested = node->getChild(2);
+    const RamDomain init = initAggregate(fun);
+    auto probe = [&](const RamDomain* tuple, InterpreterContext& probeCtxt) {
+        if (partitioned && !distribution->isLocal(tuple, outer.getArity())) {
+            return;
+        }
+        const RamDomain* found = table.find(tuple);
+        RamDomain result[1] = {found != nullptr ? *found : init};
+        if ((fun == souffle::MIN || fun == souffle::MAX) && result[0] == init) {
+            // no minimum or maximum found
+            return;
+        }
+        probeCtxt[outerId] = tuple;
+        probeCtxt[innerId] = result;
+        execute(nested, probeCtxt);
+    };
+
+    if (!parallel) {
+        for (const RamDomain* tuple : outer) {
+            probe(tuple, ctxt);
+        }
+        return;
+    }
+    auto pStream = outer.partitionScan(parallelChunkCount(outer.size(), getMaxChunks(ctxt)));
+    WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+    PARALLEL_START_IF(pStream.size() > 1)
+        ;
+        InterpreterContext newCtxt(ctxt);
+        newCtxt.setBufferingInserts(preamble->bufferInserts);
+        for (const auto& info : preamble->getViewInfoForNested()) {
+            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+        }
+        pfor_steal(it, pStream, pLoop) {
+            for (const TupleRef& val : *it) {
+                probe(val.getBase(), newCtxt);
+            }
+        }
+        flushInsertBuffers(newCtxt, *preamble);
+    PARALLEL_END;
+    if (profileEnabled) {
+        ParallelLoopProfile::instance().record(pLoop);
+    }
+}
+
+void InterpreterEngine::mergeJoin(const InterpreterNode* node, Stream& outer, InterpreterContext& ctxt) {
+    const auto& merge = *static_cast<const RamMergeJoin*>(node->getShadow());
+    const size_t outerId = merge.getTupleId();
+    const size_t column = merge.getColumn();
+    const size_t innerId = merge.getInnerScan().getTupleId();
+    const size_t innerColumn = merge.getInnerColumn();
+    const InterpreterRelation& rel = *node->getRelation();
+    const InterpreterRelation& inner = *getRelationHandle(node->getData(2));
+    const size_t arity = inner.getArity();
+    const bool partitioned = ctxt.isPartitioned() && outerId == 0;
+    const bool profiled = profileEnabled && !merge.getProfileText().empty();
+
+    // the cursor on the inner relation, ordered by the inner column
+    RamDomain low[arity];
+    RamDomain high[arity];
+    for (size_t i = 0; i < arity; i++) {
+        low[i] = MIN_RAM_DOMAIN;
+        high[i] = MAX_RAM_DOMAIN;
+    }
+    Stream cursor;
+    Stream::Iterator pos = cursor.end();
+    auto seek = [&](RamDomain value) {
+        low[innerColumn] = value;
+        cursor = inner.range(node->getData(1), TupleRef(low, arity), TupleRef(high, arity));
+        pos = cursor.begin();
+    };
+
+    // the inner tuples of the current value are copied, since the tuples of a stream are not stable
+    std::vector<RamDomain> group;
+    bool started = false;
+    RamDomain key = 0;
+    for (const TupleRef& tuple : outer) {
+        if (partitioned && !distribution->isLocal(tuple.getBase(), rel.getArity())) {
+            continue;
+        }
+        const RamDomain value = tuple[column];
+        if (!started || value != key) {
+            if (started && pos == cursor.end() && !profiled) {
+                // the inner relation is exhausted
+                return;
+            }
+            size_t steps = 0;
+            while (pos != cursor.end() && (*pos)[innerColumn] < value && steps < RamMergeJoin::LINEAR_STEPS) {
+                ++pos;
+                ++steps;
+            }
+            if (!started || (pos != cursor.end() && (*pos)[innerColumn] < value)) {
+                seek(value);
+            }
+            started = true;
+            key = value;
+            group.clear();
+            for (; pos != cursor.end() && (*pos)[innerColumn] == value; ++pos) {
+                const RamDomain* base = (*pos).getBase();
+                group.insert(group.end(), base, base + arity);
+            }
+        }
+        if (profiled) {
+            countFrequency(node->getData(3));
+        }
+        ctxt[outerId] = tuple.getBase();
+        for (size_t i = 0; i < group.size(); i += arity) {
+            ctxt[innerId] = &group[i];
+            if (!execute(node->getChild(0), ctxt)) {
+                break;
+            }
+        }
+    }
+}
+
+void InterpreterEngine::checkDistributable() const {
+    // symbols, records and counter values would be numbered differently on each rank
+    visitDepthFirst(tUnit.getProgram(), [&](const RamNode& node) {
+        bool creates = dynamic_cast<const RamPackRecord*>(&node) != nullptr ||
+                       dynamic_cast<const RamAutoIncrement*>(&node) != nullptr;
+        if (const auto* op = dynamic_cast<const RamIntrinsicOperator*>(&node)) {
+            creates = creates || functorReturnType(op->getOperator()) == TypeAttribute::Symbol;
+        }
+        if (const auto* op = dynamic_cast<const RamUserDefinedOperator*>(&node)) {
+            creates = creates || op->getReturnType() == TypeAttribute::Symbol;
+        }
+        if (creates) {
+            throw std::runtime_error(
+                    "Distributed evaluation does not support programs creating symbols, records or "
+                    "counter values.");
+        }
+    });
+}
+
+template <size_t Arity>
+void InterpreterEngine::evalTuple(const InterpreterNode* node, RamDomain* tuple, InterpreterContext& ctxt) {
+    for (size_t i = 0; i < Arity; i++) {
+        tuple[i] = execute(node->getChild(i), ctxt);
+    }
+}
+
+void InterpreterEngine::evalTuple(
+        const InterpreterNode* node, RamDomain* tuple, size_t arity, InterpreterContext& ctxt) {
+    // the loops of the common arities are instantiated for their arity
+    switch (arity) {
+        case 1:
+            return evalTuple<1>(node, tuple, ctxt);
+        case 2:
+            return evalTuple<2>(node, tuple, ctxt);
+        case 3:
+            return evalTuple<3>(node, tuple, ctxt);
+        case 4:
+            return evalTuple<4>(node, tuple, ctxt);
+        case 5:
+            return evalTuple<5>(node, tuple, ctxt);
+        case 6:
+            return evalTuple<6>(node, tuple, ctxt);
+    }
+    for (size_t i = 0; i < arity; i++) {
+        tuple[i] = execute(node->getChild(i), ctxt);
+    }
+}
+
+bool InterpreterEngine::evalExistenceCheck(const InterpreterNode* node, InterpreterContext& ctxt) {
+    const auto& cur = *static_cast<const RamExistenceCheck*>(node->getShadow());
+    // construct the pattern tuple
+    size_t arity = cur.getRelation().getArity();
+
+    size_t viewPos = node->getData(0);
+
+    if (profileEnabled && !cur.getRelation().isTemp()) {
+        reads[cur.getRelation().getName()]++;
+    }
+    countSearch(&cur);
+    // for total we use the exists test
+    if (node->getData(1) != 0) {
+        RamDomain tuple[arity];
+        evalTuple(node, tuple, arity, ctxt);
+        // the filter rules out most missing tuples without searching the index
+        if (!node->getRelation()->mayContain(tuple)) {
+            return false;
+        }
+        const bool found = ctxt.getView(viewPos)->contains(TupleRef(tuple, arity));
+        countSearchTuples(&cur, found ? 1 : 0);
+        return found;
+    }
+
+    // for partial we search for lower and upper boundaries
+    RamDomain low[arity];
+    RamDomain high[arity];
+    for (size_t i = 0; i < node->getNumChildren(); ++i) {
+        low[i] = node->getChild(i) != nullptr ? execute(node->getChild(i), ctxt) : MIN_RAM_DOMAIN;
+        high[i] = node->getChild(i) != nullptr ? low[i] : MAX_RAM_DOMAIN;
+    }
+    const bool found = ctxt.getView(viewPos)->contains(TupleRef(low, arity), TupleRef(high, arity));
+    countSearchTuples(&cur, found ? 1 : 0);
+    return found;
+}
+
+template <typename Range>
+size_t InterpreterEngine::prefetchScan(Range&& range, size_t arity, size_t tupleId,
+        const InterpreterNode* nested, InterpreterContext& ctxt) {
+    const InterpreterNode* search = nested->getChild(0);
+    const bool prefetch = search->getType() == I_IndexScan || search->getType() == I_IndexScanProject;
+    const size_t searchArity =
+            prefetch ? static_cast<const RamIndexScan*>(search->getShadow())->getRelation().getArity() : 0;
+    // the tuples of a range may be buffered by its stream, and are therefore copied
+    RamDomain tuples[PREFETCH_BATCH_SIZE * arity];
+    RamDomain lows[PREFETCH_BATCH_SIZE * searchArity];
+    std::array<TupleRef, PREFETCH_BATCH_SIZE> keys;
+    size_t visited = 0;
+    auto it = range.begin();
+    const auto end = range.end();
+    while (it != end) {
+        size_t count = 0;
+        for (; it != end && count < PREFETCH_BATCH_SIZE; ++it) {
+            std::copy_n(getWords(*it), arity, tuples + arity * count++);
+        }
+        if (prefetch) {
+            for (size_t i = 0; i < count; i++) {
+                ctxt[tupleId] = tuples + arity * i;
+                RamDomain* low = lows + searchArity * i;
+                for (size_t j = 0; j < searchArity; j++) {
+                    low[j] = search->getChild(j) != nullptr ? execute(search->getChild(j), ctxt)
+                                                            : MIN_RAM_DOMAIN;
+                }
+                keys[i] = TupleRef(low, searchArity);
+            }
+            ctxt.getView(search->getData(0))->prefetch(keys.data(), count);
+        }
+        for (size_t i = 0; i < count; i++) {
+            ++visited;
+            ctxt[tupleId] = tuples + arity * i;
+            if (!execute(nested, ctxt)) {
+                return visited;
+            }
+        }
+    }
+    return visited;
+}
+
+template <typename Range>
+void InterpreterEngine::projectRange(Range&& range, size_t tupleId, size_t scanArity,
+        const InterpreterNode* condition, const InterpreterNode* project, bool batched,
+        InterpreterContext& ctxt) {
+    switch (project->getRelation()->getArity()) {
+#define PROJECT_RANGE(Arity)                                                                       \
+    case Arity:                                                                                    \
+        if (batched) {                                                                             \
+            return projectBatches<Arity>(                                                          \
+                    std::forward<Range>(range), tupleId, scanArity, condition, project, ctxt);     \
+        }                                                                                          \
+        return projectRange<Arity>(std::forward<Range>(range), tupleId, condition, project, ctxt);
+        PROJECT_RANGE(1)
+        PROJECT_RANGE(2)
+        PROJECT_RANGE(3)
+        PROJECT_RANGE(4)
+        PROJECT_RANGE(5)
+        PROJECT_RANGE(6)
+        PROJECT_RANGE(7)
+        PROJECT_RANGE(8)
+        PROJECT_RANGE(9)
+        PROJECT_RANGE(10)
+        PROJECT_RANGE(11)
+        PROJECT_RANGE(12)
+#undef PROJECT_RANGE
+    }
+    static_assert(MAX_FUSED_PROJECT_ARITY == 12, "projection loops must cover all fused arities");
+    assert(false && "Unsupported arity of a fused projection");
+}
+
+template <size_t Arity, typename Range>
+void InterpreterEngine::projectRange(Range&& range, size_t tupleId, const InterpreterNode* condition,
+        const InterpreterNode* project, InterpreterContext& ctxt) {
+    // operands of other tuples and constants do not change while scanning, and are loaded once
+    RamDomain tuple[Arity];
+    size_t positions[Arity];
+    size_t columns[Arity];
+    size_t copied = 0;
+    for (size_t i = 0; i < Arity; i++) {
+        if (project->getData(2 * i) == tupleId) {
+            positions[copied] = i;
+            columns[copied++] = project->getData(2 * i + 1);
+        } else {
+            tuple[i] = loadOperand(project, 2 * i, ctxt);
+        }
+    }
+    InterpreterRelation& rel = *project->getRelation();
+    for (const auto& source : range) {
+        const RamDomain* scanned = &source[0];
+        if (condition != nullptr) {
+            ctxt[tupleId] = scanned;
+            if (!execute(condition, ctxt)) {
+                continue;
+            }
+        }
+        for (size_t i = 0; i < copied; i++) {
+            tuple[positions[i]] = scanned[columns[i]];
+        }
+        insertTuple(rel, tuple, ctxt);
+    }
+}
+
+template <size_t Arity, typename Range>
+void InterpreterEngine::projectBatches(Range&& range, size_t tupleId, size_t scanArity,
+        const InterpreterNode* condition, const InterpreterNode* project, InterpreterContext& ctxt) {
+    BatchFilter filters[MAX_BATCH_FILTERS];
+    const InterpreterNode* residual[MAX_BATCH_FILTERS];
+    size_t numFilters = 0;
+    size_t numResidual = 0;
+    if (condition != nullptr &&
+            !splitCondition(condition, tupleId, ctxt, filters, numFilters, residual, numResidual)) {
+        // too many conjuncts, the whole condition is evaluated for each tuple
+        numFilters = 0;
+        numResidual = 1;
+        residual[0] = condition;
+    }
+
+    RamDomain tuple[Arity];
+    size_t positions[Arity];
+    size_t columns[Arity];
+    size_t copied = 0;
+    for (size_t i = 0; i < Arity; i++) {
+        if (project->getData(2 * i) == tupleId) {
+            positions[copied] = i;
+            columns[copied++] = project->getData(2 * i + 1);
+        } else {
+            tuple[i] = loadOperand(project, 2 * i, ctxt);
+        }
+    }
+    InterpreterRelation& rel = *project->getRelation();
+
+    // the batch holds the scanned columns, the projected tuples and a scanned tuple for residuals
+    RamDomain* batch = nullptr;
+    RamDomain* projected = nullptr;
+    RamDomain* scanned = nullptr;
+    uint8_t mask[FUSED_BATCH_SIZE];
+    size_t count = 0;
+    auto flush = [&]() {
+        std::fill(mask, mask + count, 1);
+        for (size_t f = 0; f < numFilters; f++) {
+            filterBatch(filters[f], batch, count, mask);
+        }
+        size_t numProjected = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (mask[i] == 0) {
+                continue;
+            }
+            if (numResidual > 0) {
+                for (size_t c = 0; c < scanArity; c++) {
+                    scanned[c] = batch[c * FUSED_BATCH_SIZE + i];
+                }
+                ctxt[tupleId] = scanned;
+                bool pass = true;
+                for (size_t r = 0; r < numResidual && pass; r++) {
+                    pass = execute(residual[r], ctxt);
+                }
+                if (!pass) {
+                    continue;
+                }
+            }
+            for (size_t k = 0; k < copied; k++) {
+                tuple[positions[k]] = batch[columns[k] * FUSED_BATCH_SIZE + i];
+            }
+            std::copy(tuple, tuple + Arity, projected + numProjected++ * Arity);
+        }
+        insertTuples(rel, projected, numProjected, ctxt);
+        count = 0;
+    };
+
+    for (const auto& source : range) {
+        if (batch == nullptr) {
+            batch = ctxt.getBatchBuffer(FUSED_BATCH_SIZE * (scanArity + Arity) + scanArity);
+            projected = batch + FUSED_BATCH_SIZE * scanArity;
+            scanned = projected + FUSED_BATCH_SIZE * Arity;
+        }
+        for (size_t c = 0; c < scanArity; c++) {
+            batch[c * FUSED_BATCH_SIZE + count] = source[c];
+        }
+        if (++count == FUSED_BATCH_SIZE) {
+            flush();
+        }
+    }
+    if (count > 0) {
+        flush();
+    }
 }
 
 RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterContext& ctxt) {
 #define DEBUG(Kind) std::cout << "Running Node: " << #Kind << "\n";
 
-#define CASE(Kind)     \
-    case (I_##Kind): { \
+#ifdef INTERPRETER_THREADED_DISPATCH
+    // jump straight to the handler of the node type (direct threading)
+#define LABEL_ADDRESS(Kind) &&L_##Kind,
+    static const void* const dispatchTable[] = {FOR_EACH_INTERPRETER_TOKEN(LABEL_ADDRESS)};
+#undef LABEL_ADDRESS
+#define CASE_LABEL(Kind) L_##Kind
+#define DISPATCH_START goto* dispatchTable[node->getType()];
+#define DISPATCH_DEFAULT
+#else
+#define CASE_LABEL(Kind) case (I_##Kind)
+#define DISPATCH_START switch (node->getType())
+#define DISPATCH_DEFAULT \
+    default:             \
+        assert(false && "Unhandled\n");
+#endif
+
+#define CASE(Kind)          \
+    CASE_LABEL(Kind) : {    \
         return [&]() -> RamDomain { \
             const auto& cur = *static_cast<const Ram##Kind*>(node->getShadow());
-#define CASE_NO_CAST(Kind) \
-    case (I_##Kind): {     \
+#define CASE_NO_CAST(Kind)  \
+    CASE_LABEL(Kind) : {    \
         return [&]() -> RamDomain {
 #define ESAC(Kind) \
     }              \
     ();            \
     }
 
-    switch (node->getType()) {
-        CASE(Constant)
-            return cur.getConstant();
+    DISPATCH_START {
+        CASE_NO_CAST(Constant)
+            return static_cast<RamDomain>(node->getData(0));
         ESAC(Constant)
 
-        CASE(TupleElement)
-            return ctxt[cur.getTupleId()][cur.getElement()];
+        CASE_NO_CAST(TupleElement)
+            return ctxt[node->getData(0)][node->getData(1)];
         ESAC(TupleElement)
 
         CASE_NO_CAST(AutoIncrement)
@@ -498,11 +1800,17 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 }
 
                 case FunctorOp::CAT: {
-                    std::stringstream ss;
+                    // the concatenation is appended to a buffer of the thread, used as a stack by nested
+                    // concatenations of the arguments, and interned from there without any temporaries
+                    thread_local std::string buffer;
+                    const size_t start = buffer.size();
                     for (size_t i = 0; i < args.size(); i++) {
-                        ss << getSymbolTable().resolve(execute(node->getChild(i), ctxt));
+                        RamDomain symbol = execute(node->getChild(i), ctxt);
+                        buffer += getSymbolTable().resolve(symbol);
                     }
-                    return getSymbolTable().lookup(ss.str());
+                    RamDomain result = getSymbolTable().lookup(std::string_view(buffer).substr(start));
+                    buffer.resize(start);
+                    return result;
                 }
                 /** Ternary Functor Operators */
                 case FunctorOp::SUBSTR: {
@@ -510,9 +1818,9 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     const std::string& str = getSymbolTable().resolve(symbol);
                     auto idx = execute(node->getChild(1), ctxt);
                     auto len = execute(node->getChild(2), ctxt);
-                    std::string sub_str;
+                    std::string_view sub_str;
                     try {
-                        sub_str = str.substr(idx, len);
+                        sub_str = std::string_view(str).substr(idx, len);
                     } catch (...) {
                         std::cerr << "warning: wrong index position provided by substr(\"";
                         std::cerr << str << "\"," << (int32_t)idx << "," << (int32_t)len << ") functor.\n";
@@ -528,47 +1836,69 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(IntrinsicOperator)
 
         CASE(UserDefinedOperator)
-            // get name and type
-            const std::string& name = cur.getName();
+            const InterpreterFunctor& functor = *node->getFunctor();
+            if (functor.function == nullptr) {
+                std::cerr << "Cannot find user-defined operator " << cur.getName() << std::endl;
+                exit(1);
+            }
             const std::vector<TypeAttribute>& type = cur.getArgsTypes();
+            size_t arity = cur.getArguments().size();
+
+            if (functor.isDirect) {
+                RamDomain argVal[MAX_DIRECT_FUNCTOR_ARITY];
+                for (size_t i = 0; i < arity; i++) {
+                    argVal[i] = execute(node->getChild(i), ctxt);
+                }
+                if (cur.isStateful()) {
+                    return callFunctor(functor.function, arity, argVal, &getSymbolTable(), &getRecordTable());
+                }
+                return callFunctor(functor.function, arity, argVal);
+            }
 
-            auto fn = reinterpret_cast<void (*)()>(getMethodHandle(name));
-            if (fn == nullptr) {
-                std::cerr << "Cannot find user-defined operator " << name << std::endl;
+            if (!functor.isPrepared) {
+                std::cerr << "Failed to prepare CIF for user-defined operator ";
+                std::cerr << cur.getName() << std::endl;
                 exit(1);
             }
-            // prepare dynamic call environment
-            size_t arity = cur.getArguments().size();
-            ffi_cif cif;
-            ffi_type* args[arity];
-            void* values[arity];
+
+            // stateful functors receive the symbol and record tables ahead of their arguments
+            const size_t offset = cur.isStateful() ? 2 : 0;
+            SymbolTable* symbolTable = &getSymbolTable();
+            RecordTable* recordTable = &getRecordTable();
+            void* values[arity + offset];
             RamDomain intVal[arity];
             RamUnsigned uintVal[arity];
             RamFloat floatVal[arity];
             const char* strVal[arity];
             ffi_arg rc;
 
+            if (cur.isStateful()) {
+                values[0] = &symbolTable;
+                values[1] = &recordTable;
+            }
+
             /* Initialize arguments for ffi-call */
             for (size_t i = 0; i < arity; i++) {
                 RamDomain arg = execute(node->getChild(i), ctxt);
+                if (cur.isStateful()) {
+                    intVal[i] = arg;
+                    values[i + offset] = &intVal[i];
+                    continue;
+                }
                 switch (type[i]) {
                     case TypeAttribute::Symbol:
-                        args[i] = &FFI_Symbol;
                         strVal[i] = getSymbolTable().resolve(arg).c_str();
                         values[i] = &strVal[i];
                         break;
                     case TypeAttribute::Signed:
-                        args[i] = &FFI_RamSigned;
                         intVal[i] = arg;
                         values[i] = &intVal[i];
                         break;
                     case TypeAttribute::Unsigned:
-                        args[i] = &FFI_RamUnsigned;
                         uintVal[i] = ramBitCast<RamUnsigned>(arg);
                         values[i] = &uintVal[i];
                         break;
                     case TypeAttribute::Float:
-                        args[i] = &FFI_RamFloat;
                         floatVal[i] = ramBitCast<RamFloat>(arg);
                         values[i] = &floatVal[i];
                         break;
@@ -577,33 +1907,12 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 }
             }
 
-            // Get codomain.
-            auto codomain = &FFI_RamSigned;
-            switch (cur.getReturnType()) {
-                // initialize for string value.
-                case TypeAttribute::Symbol:
-                    codomain = &FFI_Symbol;
-                    break;
-                case TypeAttribute::Signed:
-                    codomain = &FFI_RamSigned;
-                    break;
-                case TypeAttribute::Unsigned:
-                    codomain = &FFI_RamUnsigned;
-                    break;
-                case TypeAttribute::Float:
-                    codomain = &FFI_RamFloat;
-                    break;
-                default:
-                    assert(false && "Not implemented");
-            }
-
             // Call the external function.
-            if (ffi_prep_cif(&cif, FFI_DEFAULT_ABI, arity, codomain, args) != FFI_OK) {
-                std::cerr << "Failed to prepare CIF for user-defined operator ";
-                std::cerr << name << std::endl;
-                exit(1);
+            ffi_call(const_cast<ffi_cif*>(&functor.cif), functor.function, &rc, values);
+
+            if (cur.isStateful()) {
+                return static_cast<RamDomain>(rc);
             }
-            ffi_call(&cif, fn, &rc, values);
 
             RamDomain result;
             switch (cur.getReturnType()) {
@@ -649,7 +1958,29 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(False)
 
         CASE_NO_CAST(Conjunction)
-            return execute(node->getChild(0), ctxt) && execute(node->getChild(1), ctxt);
+            const size_t numTerms = node->getNumChildren();
+            InterpreterConditionOrder* adaptive = node->getConditionOrder();
+            if (adaptive == nullptr) {
+                for (size_t i = 0; i < numTerms; ++i) {
+                    if (!execute(node->getChild(i), ctxt)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            const uint64_t order = adaptive->getOrder();
+            for (size_t pos = 0; pos < numTerms; ++pos) {
+                if (!execute(node->getChild(InterpreterConditionOrder::getTerm(order, pos)), ctxt)) {
+                    if (InterpreterConditionOrder::sample()) {
+                        adaptive->record(order, pos + 1, true);
+                    }
+                    return false;
+                }
+            }
+            if (InterpreterConditionOrder::sample()) {
+                adaptive->record(order, numTerms, false);
+            }
+            return true;
         ESAC(Conjunction)
 
         CASE_NO_CAST(Negation)
@@ -660,34 +1991,14 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return node->getRelation()->empty();
         ESAC(EmptinessCheck)
 
-        CASE(ExistenceCheck)
-            // construct the pattern tuple
-            size_t arity = cur.getRelation().getArity();
-
-            size_t viewPos = node->getData(0);
-
-            if (profileEnabled && !cur.getRelation().isTemp()) {
-                reads[cur.getRelation().getName()]++;
-            }
-            // for total we use the exists test
-            if (isa->isTotalSignature(&cur)) {
-                RamDomain tuple[arity];
-                for (size_t i = 0; i < arity; i++) {
-                    tuple[i] = execute(node->getChild(i), ctxt);
-                }
-                return ctxt.getView(viewPos)->contains(TupleRef(tuple, arity));
-            }
-
-            // for partial we search for lower and upper boundaries
-            RamDomain low[arity];
-            RamDomain high[arity];
-            for (size_t i = 0; i < node->getChildren().size(); ++i) {
-                low[i] = node->getChild(i) != nullptr ? execute(node->getChild(i), ctxt) : MIN_RAM_DOMAIN;
-                high[i] = node->getChild(i) != nullptr ? low[i] : MAX_RAM_DOMAIN;
-            }
-            return ctxt.getView(viewPos)->contains(TupleRef(low, arity), TupleRef(high, arity));
+        CASE_NO_CAST(ExistenceCheck)
+            return evalExistenceCheck(node, ctxt);
         ESAC(ExistenceCheck)
 
+        CASE_NO_CAST(NegatedExistenceCheck)
+            return !evalExistenceCheck(node, ctxt);
+        ESAC(NegatedExistenceCheck)
+
         CASE(ProvenanceExistenceCheck)
             // construct the pattern tuple
             size_t arity = cur.getRelation().getArity();
@@ -710,6 +2021,29 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return ctxt.getView(viewPos)->contains(TupleRef(low, arity), TupleRef(high, arity));
         ESAC(ProvenanceExistenceCheck)
 
+        CASE_NO_CAST(SimpleConstraint)
+            const auto& cur = *static_cast<const RamConstraint*>(node->getShadow());
+            RamDomain left = loadOperand(node, 0, ctxt);
+            RamDomain right = loadOperand(node, 2, ctxt);
+            switch (cur.getOperator()) {
+                case BinaryConstraintOp::EQ:
+                    return left == right;
+                case BinaryConstraintOp::NE:
+                    return left != right;
+                case BinaryConstraintOp::LT:
+                    return left < right;
+                case BinaryConstraintOp::LE:
+                    return left <= right;
+                case BinaryConstraintOp::GT:
+                    return left > right;
+                case BinaryConstraintOp::GE:
+                    return left >= right;
+                default:
+                    assert(false && "unsupported operator of a simple constraint");
+                    return false;
+            }
+        ESAC(SimpleConstraint)
+
         CASE(Constraint)
             switch (cur.getOperator()) {
                 case BinaryConstraintOp::EQ:
@@ -765,32 +2099,24 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     return left >= right;
                 }
                 case BinaryConstraintOp::MATCH: {
-                    RamDomain left = execute(node->getChild(0), ctxt);
-                    RamDomain right = execute(node->getChild(1), ctxt);
-                    const std::string& pattern = getSymbolTable().resolve(left);
-                    const std::string& text = getSymbolTable().resolve(right);
-                    bool result = false;
-                    try {
-                        result = std::regex_match(text, std::regex(pattern));
-                    } catch (...) {
-                        std::cerr << "warning: wrong pattern provided for match(\"" << pattern << "\",\""
-                                  << text << "\").\n";
+                    const CompiledRegex& regex = getPattern(node, ctxt);
+                    const std::string& text = getSymbolTable().resolve(execute(node->getChild(1), ctxt));
+                    if (!regex.isValid()) {
+                        std::cerr << "warning: wrong pattern provided for match(\"" << regex.getPattern()
+                                  << "\",\"" << text << "\").\n";
+                        return false;
                     }
-                    return result;
+                    return regex.matches(text);
                 }
                 case BinaryConstraintOp::NOT_MATCH: {
-                    RamDomain left = execute(node->getChild(0), ctxt);
-                    RamDomain right = execute(node->getChild(1), ctxt);
-                    const std::string& pattern = getSymbolTable().resolve(left);
-                    const std::string& text = getSymbolTable().resolve(right);
-                    bool result = false;
-                    try {
-                        result = !std::regex_match(text, std::regex(pattern));
-                    } catch (...) {
-                        std::cerr << "warning: wrong pattern provided for !match(\"" << pattern << "\",\""
-                                  << text << "\").\n";
+                    const CompiledRegex& regex = getPattern(node, ctxt);
+                    const std::string& text = getSymbolTable().resolve(execute(node->getChild(1), ctxt));
+                    if (!regex.isValid()) {
+                        std::cerr << "warning: wrong pattern provided for !match(\"" << regex.getPattern()
+                                  << "\",\"" << text << "\").\n";
+                        return false;
                     }
-                    return result;
+                    return !regex.matches(text);
                 }
                 case BinaryConstraintOp::CONTAINS: {
                     RamDomain left = execute(node->getChild(0), ctxt);
@@ -816,11 +2142,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             bool result = execute(node->getChild(0), ctxt);
 
             if (profileEnabled && !cur.getProfileText().empty()) {
-                auto& currentFrequencies = frequencies[cur.getProfileText()];
-                while (currentFrequencies.size() <= getIterationNumber()) {
-                    currentFrequencies.emplace_back(0);
-                }
-                frequencies[cur.getProfileText()][getIterationNumber()]++;
+                countFrequency(node->getData(0));
             }
             return result;
         ESAC(TupleOperation)
@@ -829,8 +2151,19 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             // get the targeted relation
             auto& rel = *node->getRelation();
 
+            if (node->getDataSize() > 0) {
+                prefetchScan(rel, rel.getArity(), cur.getTupleId(), node->getChild(0), ctxt);
+                return true;
+            }
+
+            // the outermost scan of a partitioned query only visits the tuples of this rank
+            const bool partitioned = ctxt.isPartitioned() && cur.getTupleId() == 0;
+
             // use simple iterator
             for (const RamDomain* tuple : rel) {
+                if (partitioned && !distribution->isLocal(tuple, rel.getArity())) {
+                    continue;
+                }
                 ctxt[cur.getTupleId()] = tuple;
                 if (!execute(node->getChild(0), ctxt)) {
                     break;
@@ -843,28 +2176,46 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             auto preamble = node->getPreamble();
             auto& rel = *node->getRelation();
 
-            auto pStream = rel.partitionScan(numOfThreads);
+            auto pStream = rel.partitionScan(parallelChunkCount(rel.size(), getMaxChunks(ctxt)));
 
-            PARALLEL_START
+            WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+            if (profileEnabled) {
+                parallelism[rel.getName()][pStream.size() > 1 ? 0 : 1]++;
+            }
+            PARALLEL_START_IF(pStream.size() > 1)
                 ;
                 InterpreterContext newCtxt(ctxt);
+                newCtxt.setBufferingInserts(preamble->bufferInserts);
                 auto viewInfo = preamble->getViewInfoForNested();
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
+                const bool partitioned = newCtxt.isPartitioned() && cur.getTupleId() == 0;
+                pfor_steal(it, pStream, pLoop) {
+                    if (node->getDataSize() > 0) {
+                        prefetchScan(*it, rel.getArity(), cur.getTupleId(), node->getChild(0), newCtxt);
+                        continue;
+                    }
                     for (const TupleRef& val : *it) {
+                        if (partitioned && !distribution->isLocal(val.getBase(), rel.getArity())) {
+                            continue;
+                        }
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (!execute(node->getChild(0), newCtxt)) {
                             break;
                         }
                     }
                 }
+                flushInsertBuffers(newCtxt, *preamble);
             PARALLEL_END;
+            if (profileEnabled) {
+                ParallelLoopProfile::instance().record(pLoop);
+            }
             return true;
         ESAC(ParallelScan)
 
         CASE(IndexScan)
+            countSearch(&cur);
             // create pattern tuple for range query
             size_t arity = cur.getRelation().getArity();
             RamDomain low[arity];
@@ -880,18 +2231,179 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t viewId = node->getData(0);
-            auto& view = ctxt.getView(viewId);
+            auto* view = ctxt.getView(viewId);
+            if (node->getDataSize() > 1) {
+                countSearchTuples(&cur, prefetchScan(view->range(TupleRef(low, arity), TupleRef(hig, arity)),
+                                                arity, cur.getTupleId(), node->getChild(arity), ctxt));
+                return true;
+            }
             // conduct range query
+            const bool partitioned = ctxt.isPartitioned() && cur.getTupleId() == 0;
+            size_t tuples = 0;
             for (auto data : view->range(TupleRef(low, arity), TupleRef(hig, arity))) {
+                ++tuples;
+                if (partitioned && !distribution->isLocal(&data[0], arity)) {
+                    continue;
+                }
                 ctxt[cur.getTupleId()] = &data[0];
                 if (!execute(node->getChild(arity), ctxt)) {
                     break;
                 }
             }
+            countSearchTuples(&cur, tuples);
             return true;
         ESAC(IndexScan)
 
+        CASE(LeapfrogJoin)
+            // the searches are the range of the relation followed by the intersections
+            const auto& intersections = cur.getIntersections();
+            const size_t count = intersections.size() + 1;
+            const size_t rangeArity = cur.getRelation().getArity();
+            size_t offsetBuffer[count + 1];
+            size_t* offsets = offsetBuffer;
+            offsets[0] = 0;
+            offsets[1] = rangeArity;
+            for (size_t i = 1; i < count; i++) {
+                offsets[i + 1] = offsets[i] + intersections[i - 1]->getRelation().getArity();
+            }
+
+            // the keys of the searches, and the entries they have been advanced to
+            RamDomain keyBuffer[offsets[count]];
+            RamDomain entryBuffer[offsets[count]];
+            RamDomain* keys = keyBuffer;
+            RamDomain* entries = entryBuffer;
+            for (size_t i = 0; i < rangeArity; i++) {
+                const InterpreterNode* value = node->getChild(i);
+                keys[i] = (value != nullptr) ? execute(value, ctxt) : MIN_RAM_DOMAIN;
+            }
+            for (size_t i = 1; i < count; i++) {
+                const InterpreterNode* check = node->getChild(rangeArity + i - 1);
+                for (size_t j = 0; j < offsets[i + 1] - offsets[i]; j++) {
+                    const InterpreterNode* value = check->getChild(j);
+                    keys[offsets[i] + j] = (value != nullptr) ? execute(value, ctxt) : MIN_RAM_DOMAIN;
+                }
+            }
+
+            // advances the i-th search to the given value of its free column
+            auto seek = [&](size_t i, RamDomain value) {
+                const size_t column = node->getData(2 * i + 1);
+                keys[offsets[i] + column] = value;
+                return ctxt.getView(node->getData(2 * i))
+                        ->seek(TupleRef(keys + offsets[i], offsets[i + 1] - offsets[i]), column,
+                                entries + offsets[i]);
+            };
+            auto current = [&](size_t i) { return entries[offsets[i] + node->getData(2 * i + 1)]; };
+
+            for (size_t i = 0; i < count; i++) {
+                if (!seek(i, MIN_RAM_DOMAIN)) {
+                    return true;
+                }
+            }
+            const InterpreterNode* nested = node->getChild(rangeArity + count - 1);
+            while (true) {
+                RamDomain max = current(0);
+                for (size_t i = 1; i < count; i++) {
+                    max = std::max(max, current(i));
+                }
+                // catch up with the largest value, which may be overtaken
+                bool agree = true;
+                for (size_t i = 0; i < count; i++) {
+                    if (current(i) != max) {
+                        agree = false;
+                        if (!seek(i, max)) {
+                            return true;
+                        }
+                    }
+                }
+                if (!agree) {
+                    continue;
+                }
+                ctxt[cur.getTupleId()] = entries;
+                if (!execute(nested, ctxt)) {
+                    break;
+                }
+                if (max == MAX_RAM_DOMAIN || !seek(0, max + 1)) {
+                    break;
+                }
+            }
+            return true;
+        ESAC(LeapfrogJoin)
+
+        CASE_NO_CAST(MergeJoin)
+            // stream the relation in the order of the joined column
+            auto& rel = *node->getRelation();
+            size_t arity = rel.getArity();
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            for (size_t i = 0; i < arity; i++) {
+                low[i] = MIN_RAM_DOMAIN;
+                hig[i] = MAX_RAM_DOMAIN;
+            }
+            auto stream = rel.range(node->getData(0), TupleRef(low, arity), TupleRef(hig, arity));
+            mergeJoin(node, stream, ctxt);
+            return true;
+        ESAC(MergeJoin)
+
+        CASE_NO_CAST(ParallelMergeJoin)
+            auto preamble = node->getPreamble();
+            auto& rel = *node->getRelation();
+            size_t arity = rel.getArity();
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            for (size_t i = 0; i < arity; i++) {
+                low[i] = MIN_RAM_DOMAIN;
+                hig[i] = MAX_RAM_DOMAIN;
+            }
+
+            // each thread merges an ordered chunk of the relation, seeking its first value in the inner one
+            auto pStream = rel.partitionRange(
+                    node->getData(0), TupleRef(low, arity), TupleRef(hig, arity), getMaxChunks(ctxt));
+
+            WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+            if (profileEnabled) {
+                parallelism[rel.getName()][pStream.size() > 1 ? 0 : 1]++;
+            }
+            PARALLEL_START_IF(pStream.size() > 1)
+                ;
+                InterpreterContext newCtxt(ctxt);
+                newCtxt.setBufferingInserts(preamble->bufferInserts);
+                auto viewInfo = preamble->getViewInfoForNested();
+                for (const auto& info : viewInfo) {
+                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                }
+                pfor_steal(it, pStream, pLoop) {
+                    mergeJoin(node, *it, newCtxt);
+                }
+                flushInsertBuffers(newCtxt, *preamble);
+            PARALLEL_END;
+            if (profileEnabled) {
+                ParallelLoopProfile::instance().record(pLoop);
+            }
+            return true;
+        ESAC(ParallelMergeJoin)
+
+        CASE_NO_CAST(HashJoin)
+            transientHashJoin(node, ctxt);
+            return true;
+        ESAC(HashJoin)
+
+        CASE_NO_CAST(ParallelHashJoin)
+            transientHashJoin(node, ctxt);
+            return true;
+        ESAC(ParallelHashJoin)
+
+        CASE_NO_CAST(GroupAggregate)
+            groupAggregate(node, ctxt);
+            return true;
+        ESAC(GroupAggregate)
+
+        CASE_NO_CAST(ParallelGroupAggregate)
+            groupAggregate(node, ctxt);
+            return true;
+        ESAC(ParallelGroupAggregate)
+
         CASE(ParallelIndexScan)
+            countSearch(&cur);
             auto preamble = node->getPreamble();
             auto& rel = *node->getRelation();
 
@@ -910,25 +2422,45 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t indexPos = node->getData(0);
-            auto pStream =
-                    rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads);
+            auto pStream = rel.partitionRange(
+                    indexPos, TupleRef(low, arity), TupleRef(hig, arity), getMaxChunks(ctxt));
 
-            PARALLEL_START
+            WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+            if (profileEnabled) {
+                parallelism[rel.getName()][pStream.size() > 1 ? 0 : 1]++;
+            }
+            PARALLEL_START_IF(pStream.size() > 1)
                 ;
                 InterpreterContext newCtxt(ctxt);
+                newCtxt.setBufferingInserts(preamble->bufferInserts);
                 auto viewInfo = preamble->getViewInfoForNested();
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
+                const bool partitioned = newCtxt.isPartitioned() && cur.getTupleId() == 0;
+                size_t tuples = 0;
+                pfor_steal(it, pStream, pLoop) {
+                    if (node->getDataSize() > 1) {
+                        tuples += prefetchScan(*it, arity, cur.getTupleId(), node->getChild(arity), newCtxt);
+                        continue;
+                    }
                     for (const TupleRef& val : *it) {
+                        ++tuples;
+                        if (partitioned && !distribution->isLocal(val.getBase(), arity)) {
+                            continue;
+                        }
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (!execute(node->getChild(arity), newCtxt)) {
                             break;
                         }
                     }
                 }
+                countSearchTuples(&cur, tuples);
+                flushInsertBuffers(newCtxt, *preamble);
             PARALLEL_END;
+            if (profileEnabled) {
+                ParallelLoopProfile::instance().record(pLoop);
+            }
 
             return true;
         ESAC(ParallelIndexScan)
@@ -952,11 +2484,12 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             auto preamble = node->getPreamble();
             auto& rel = *node->getRelation();
 
-            auto pStream = rel.partitionScan(numOfThreads);
+            auto pStream = rel.partitionScan(ctxt.isSequential() ? 1 : numOfThreads);
             auto viewInfo = preamble->getViewInfoForNested();
-            PARALLEL_START
+            PARALLEL_START_IF(pStream.size() > 1)
                 ;
                 InterpreterContext newCtxt(ctxt);
+                newCtxt.setBufferingInserts(preamble->bufferInserts);
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
@@ -969,11 +2502,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                         }
                     }
                 }
+                flushInsertBuffers(newCtxt, *preamble);
             PARALLEL_END;
             return true;
         ESAC(ParallelChoice)
 
         CASE(IndexChoice)
+            countSearch(&cur);
             // create pattern tuple for range query
             size_t arity = cur.getRelation().getArity();
             RamDomain low[arity];
@@ -989,7 +2524,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t viewId = node->getData(0);
-            auto& view = ctxt.getView(viewId);
+            auto* view = ctxt.getView(viewId);
 
             for (auto ip : view->range(TupleRef(low, arity), TupleRef(hig, arity))) {
                 const RamDomain* data = &ip[0];
@@ -1003,6 +2538,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(IndexChoice)
 
         CASE(ParallelIndexChoice)
+            countSearch(&cur);
             auto preamble = node->getPreamble();
             auto& rel = *node->getRelation();
 
@@ -1023,12 +2559,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t indexPos = node->getData(0);
-            auto pStream =
-                    rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads);
+            auto pStream = rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity),
+                    ctxt.isSequential() ? 1 : numOfThreads);
 
-            PARALLEL_START
+            PARALLEL_START_IF(pStream.size() > 1)
                 ;
                 InterpreterContext newCtxt(ctxt);
+                newCtxt.setBufferingInserts(preamble->bufferInserts);
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
@@ -1041,6 +2578,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                         }
                     }
                 }
+                flushInsertBuffers(newCtxt, *preamble);
             PARALLEL_END;
 
             return true;
@@ -1137,7 +2675,66 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
         ESAC(Aggregate)
 
+        CASE(ParallelAggregate)
+            auto preamble = node->getPreamble();
+            auto& rel = *node->getRelation();
+            AggregateFunction fun = cur.getFunction();
+            RamDomain res = initAggregate(fun);
+
+            auto pStream = rel.partitionScan(parallelChunkCount(rel.size(), getMaxChunks(ctxt)));
+            WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+            if (profileEnabled) {
+                parallelism[rel.getName()][pStream.size() > 1 ? 0 : 1]++;
+            }
+
+            // aggregate per thread, then combine the partial results
+            PARALLEL_START_IF(pStream.size() > 1)
+                ;
+                InterpreterContext newCtxt(ctxt);
+                auto viewInfo = preamble->getViewInfoForNested();
+                for (const auto& info : viewInfo) {
+                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                }
+                RamDomain partial = initAggregate(fun);
+                pfor_steal(it, pStream, pLoop) {
+                    for (const TupleRef& val : *it) {
+                        newCtxt[cur.getTupleId()] = val.getBase();
+                        if (execute(node->getChild(0), newCtxt)) {
+                            RamDomain value =
+                                    fun == souffle::COUNT ? 1 : execute(node->getChild(1), newCtxt);
+                            partial = combineAggregate(fun, partial, value);
+                        }
+                    }
+                }
+                PARALLEL_CRITICAL
+                res = combineAggregate(fun, res, partial);
+            PARALLEL_END;
+            if (profileEnabled) {
+                ParallelLoopProfile::instance().record(pLoop);
+            }
+
+            // the nested operation is executed once by this thread
+            for (const auto& info : preamble->getViewInfoForNested()) {
+                ctxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+            }
+
+            // write result to environment
+            RamDomain tuple[1];
+            tuple[0] = res;
+            ctxt[cur.getTupleId()] = tuple;
+
+            if (fun == souffle::MAX && res == MIN_RAM_DOMAIN) {
+                // no maximum found
+                return true;
+            } else if (fun == souffle::MIN && res == MAX_RAM_DOMAIN) {
+                // no minimum found
+                return true;
+            }
+            return execute(node->getChild(2), ctxt);
+        ESAC(ParallelAggregate)
+
         CASE(IndexAggregate)
+            countSearch(&cur);
             // initialize result
             RamDomain res = 0;
             switch (cur.getFunction()) {
@@ -1173,7 +2770,7 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t viewId = node->getData(0);
-            auto& view = ctxt.getView(viewId);
+            auto* view = ctxt.getView(viewId);
 
             for (auto ip : view->range(TupleRef(low, arity), TupleRef(hig, arity))) {
                 // link tuple
@@ -1229,6 +2826,81 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
         ESAC(IndexAggregate)
 
+        CASE(ParallelIndexAggregate)
+            countSearch(&cur);
+            auto preamble = node->getPreamble();
+            auto& rel = *node->getRelation();
+            AggregateFunction fun = cur.getFunction();
+            RamDomain res = initAggregate(fun);
+
+            // create pattern tuple for range query
+            size_t arity = rel.getArity();
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            for (size_t i = 0; i < arity; i++) {
+                if (node->getChild(i)) {
+                    low[i] = execute(node->getChild(i), ctxt);
+                    hig[i] = low[i];
+                } else {
+                    low[i] = MIN_RAM_DOMAIN;
+                    hig[i] = MAX_RAM_DOMAIN;
+                }
+            }
+
+            size_t indexPos = node->getData(0);
+            auto pStream = rel.partitionRange(
+                    indexPos, TupleRef(low, arity), TupleRef(hig, arity), getMaxChunks(ctxt));
+            WorkStealingLoop pLoop(pStream.size(), profileEnabled);
+            if (profileEnabled) {
+                parallelism[rel.getName()][pStream.size() > 1 ? 0 : 1]++;
+            }
+
+            // aggregate per thread, then combine the partial results
+            PARALLEL_START_IF(pStream.size() > 1)
+                ;
+                InterpreterContext newCtxt(ctxt);
+                auto viewInfo = preamble->getViewInfoForNested();
+                for (const auto& info : viewInfo) {
+                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                }
+                RamDomain partial = initAggregate(fun);
+                pfor_steal(it, pStream, pLoop) {
+                    for (const TupleRef& val : *it) {
+                        newCtxt[cur.getTupleId()] = val.getBase();
+                        if (execute(node->getChild(arity), newCtxt)) {
+                            RamDomain value =
+                                    fun == souffle::COUNT ? 1 : execute(node->getChild(arity + 1), newCtxt);
+                            partial = combineAggregate(fun, partial, value);
+                        }
+                    }
+                }
+                PARALLEL_CRITICAL
+                res = combineAggregate(fun, res, partial);
+            PARALLEL_END;
+            if (profileEnabled) {
+                ParallelLoopProfile::instance().record(pLoop);
+            }
+
+            // the nested operation is executed once by this thread
+            for (const auto& info : preamble->getViewInfoForNested()) {
+                ctxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+            }
+
+            // write result to environment
+            RamDomain tuple[1];
+            tuple[0] = res;
+            ctxt[cur.getTupleId()] = tuple;
+
+            if (fun == souffle::MAX && res == MIN_RAM_DOMAIN) {
+                // no maximum found
+                return true;
+            } else if (fun == souffle::MIN && res == MAX_RAM_DOMAIN) {
+                // no minimum found
+                return true;
+            }
+            return execute(node->getChild(arity + 2), ctxt);
+        ESAC(ParallelIndexAggregate)
+
         CASE_NO_CAST(Break)
             // check condition
             if (execute(node->getChild(0), ctxt)) {
@@ -1246,42 +2918,78 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             if (profileEnabled && !cur.getProfileText().empty()) {
-                auto& currentFrequencies = frequencies[cur.getProfileText()];
-                while (currentFrequencies.size() <= getIterationNumber()) {
-                    currentFrequencies.emplace_back(0);
-                }
-                frequencies[cur.getProfileText()][getIterationNumber()]++;
+                countFrequency(node->getData(0));
             }
             return result;
         ESAC(Filter)
 
         CASE(Project)
+            size_t arity = cur.getRelation().getArity();
+            RamDomain tuple[arity];
+            evalTuple(node, tuple, arity, ctxt);
+
+            // insert in target relation
+            InterpreterRelation& rel = *node->getRelation();
+            insertTuple(rel, tuple, ctxt);
+            return true;
+        ESAC(Project)
+
+        CASE_NO_CAST(SimpleProject)
+            const auto& cur = *static_cast<const RamProject*>(node->getShadow());
             size_t arity = cur.getRelation().getArity();
             RamDomain tuple[arity];
             for (size_t i = 0; i < arity; i++) {
-                tuple[i] = execute(node->getChild(i), ctxt);
+                tuple[i] = loadOperand(node, 2 * i, ctxt);
             }
 
             // insert in target relation
             InterpreterRelation& rel = *node->getRelation();
-            rel.insert(tuple);
+            insertTuple(rel, tuple, ctxt);
             return true;
-        ESAC(Project)
+        ESAC(SimpleProject)
 
-        CASE(SubroutineReturnValue)
-            for (size_t i = 0; i < cur.getValues().size(); ++i) {
-                if (node->getChild(i) == nullptr) {
-                    ctxt.addReturnValue(0);
+        CASE_NO_CAST(ScanProject)
+            const auto& cur = *static_cast<const RamScan*>(node->getShadow());
+            projectRange(*node->getRelation(), cur.getTupleId(), cur.getRelation().getArity(),
+                    node->getChild(0), node->getChild(1), node->getData(0) != 0, ctxt);
+            return true;
+        ESAC(ScanProject)
+
+        CASE_NO_CAST(IndexScanProject)
+            const auto& cur = *static_cast<const RamIndexScan*>(node->getShadow());
+            countSearch(&cur);
+            // create pattern tuple for range query
+            size_t arity = cur.getRelation().getArity();
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            for (size_t i = 0; i < arity; i++) {
+                if (node->getChild(i) != nullptr) {
+                    low[i] = execute(node->getChild(i), ctxt);
+                    hig[i] = low[i];
                 } else {
-                    ctxt.addReturnValue(execute(node->getChild(i), ctxt));
+                    low[i] = MIN_RAM_DOMAIN;
+                    hig[i] = MAX_RAM_DOMAIN;
                 }
             }
+            auto* view = ctxt.getView(node->getData(0));
+            projectRange(view->range(TupleRef(low, arity), TupleRef(hig, arity)), cur.getTupleId(), arity,
+                    node->getChild(arity), node->getChild(arity + 1), node->getData(1) != 0, ctxt);
+            return true;
+        ESAC(IndexScanProject)
+
+        CASE(SubroutineReturnValue)
+            size_t numValues = cur.getValues().size();
+            RamDomain values[numValues];
+            for (size_t i = 0; i < numValues; ++i) {
+                values[i] = node->getChild(i) == nullptr ? 0 : execute(node->getChild(i), ctxt);
+            }
+            ctxt.addReturnValues(values, numValues);
             return true;
         ESAC(SubroutineReturnValue)
 
         CASE_NO_CAST(Sequence)
-            for (const auto& child : node->getChildren()) {
-                if (!execute(child.get(), ctxt)) {
+            for (size_t i = 0; i < node->getNumChildren(); ++i) {
+                if (!execute(node->getChild(i), ctxt)) {
                     return false;
                 }
             }
@@ -1289,20 +2997,93 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Sequence)
 
         CASE_NO_CAST(Parallel)
-            for (const auto& child : node->getChildren()) {
-                if (!execute(child.get(), ctxt)) {
+            for (size_t i = 0; i < node->getNumChildren(); ++i) {
+                if (!execute(node->getChild(i), ctxt)) {
                     return false;
                 }
             }
             return true;
         ESAC(Parallel)
 
+        CASE(Schedule)
+            // A sequential context evaluates the statements in order, reusing the context.
+            if (ctxt.isSequential()) {
+                for (size_t i = 0; i < node->getNumChildren(); ++i) {
+                    execute(node->getChild(i), ctxt);
+                }
+                return true;
+            }
+            // Each stratum starts with a fresh context as strata do not share tuples, continuing the
+            // iteration of an enclosing loop. The strata of the outermost schedule lock the relations
+            // they access; nested schedules evaluate a recursive stratum, holding the locks of the stratum.
+            const bool locking = !ctxt.hasRelationsLocked();
+            std::vector<size_t> positions;
+            for (size_t pos = 0; positions.size() < node->getNumChildren();
+                    pos += 1 + 2 * node->getData(pos)) {
+                positions.push_back(pos);
+            }
+            parallelSchedule(cur.getDependencies(), cur.getJobs(), [&](size_t stratum) {
+                InterpreterContext stratumCtxt;
+                stratumCtxt.setIteration(ctxt.getIteration());
+                stratumCtxt.setRelationsLocked(true);
+                if (locking) {
+                    lockRelations(node, positions[stratum]);
+                }
+                const size_t active = ++strataStatistics.active;
+                size_t peak = strataStatistics.peak;
+                while (active > peak && !strataStatistics.peak.compare_exchange_weak(peak, active)) {
+                    // retry with the peak recorded by another stratum
+                }
+                execute(node->getChild(stratum), stratumCtxt);
+                strataStatistics.active--;
+                strataStatistics.evaluated++;
+                if (locking) {
+                    unlockRelations(node, positions[stratum]);
+                }
+            });
+            return true;
+        ESAC(Schedule)
+
+        CASE_NO_CAST(AdaptiveQuery)
+            // run the alternative of the least estimated cost for the current relation sizes
+            size_t best = 0;
+            double bestCost = 0;
+            size_t pos = 0;
+            for (size_t i = 0; i < node->getNumChildren(); ++i) {
+                const size_t levels = node->getData(pos++);
+                double bindings = 1;
+                double cost = 0;
+                for (size_t j = 0; j < levels; ++j, pos += 3) {
+                    const double size = getRelationHandle(node->getData(pos))->size();
+                    bindings *= size == 0 ? 0 : std::pow(size, double(node->getData(pos + 1)) /
+                                                                       node->getData(pos + 2));
+                    cost += bindings;
+                }
+                if (i == 0 || cost < bestCost) {
+                    best = i;
+                    bestCost = cost;
+                }
+            }
+            return execute(node->getChild(best), ctxt);
+        ESAC(AdaptiveQuery)
+
         CASE_NO_CAST(Loop)
-            resetIterationNumber();
+            // once the deltas are tiny, iterations skip the overhead of forking threads
+            const bool sequential = ctxt.isSequential();
+            ctxt.setIteration(0);
+            ctxt.setSequential(sequential || isTailIteration(node));
             while (execute(node->getChild(0), ctxt)) {
-                incIterationNumber();
+                if (profileEnabled) {
+                    mergeFrequencies(ctxt.getIteration());
+                }
+                ctxt.setIteration(ctxt.getIteration() + 1);
+                ctxt.setSequential(sequential || isTailIteration(node));
             }
-            resetIterationNumber();
+            if (profileEnabled) {
+                mergeFrequencies(ctxt.getIteration());
+            }
+            ctxt.setSequential(sequential);
+            ctxt.setIteration(0);
             return true;
         ESAC(Loop)
 
@@ -1311,34 +3092,97 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Exit)
 
         CASE(LogRelationTimer)
-            Logger logger(cur.getMessage(), getIterationNumber(),
-                    std::bind(&InterpreterRelation::size, node->getRelation()));
+            Logger logger(cur.getMessage(), ctxt.getIteration(),
+                    std::bind(&InterpreterRelation::getInsertions, node->getRelation()));
             return execute(node->getChild(0), ctxt);
         ESAC(LogRelationTimer)
 
         CASE(LogTimer)
-            Logger logger(cur.getMessage(), getIterationNumber());
+            Logger logger(cur.getMessage(), ctxt.getIteration());
             return execute(node->getChild(0), ctxt);
         ESAC(LogTimer)
 
-        CASE(DebugInfo)
-            SignalHandler::instance()->setMsg(cur.getMessage().c_str());
-            return execute(node->getChild(0), ctxt);
+        CASE_NO_CAST(DebugInfo)
+            SignalHandler::instance()->setRule(node->getData(0));
+            bool result = execute(node->getChild(0), ctxt);
+            SignalHandler::instance()->clearMsg();
+            return result;
         ESAC(DebugInfo)
 
-        CASE_NO_CAST(Clear)
-            node->getRelation()->purge();
+        CASE(Checkpoint)
+            // the first stratum resumes from the state recorded by a previous evaluation, if any
+            if (cur.getStratum() == 0) {
+                restoredStrata = existFile(cur.getFileName())
+                                         ? InterpreterProgInterface(*this).restore(cur.getFileName())
+                                         : 0;
+            }
+            if (cur.getStratum() < restoredStrata) {
+                return true;
+            }
+            bool result = execute(node->getChild(0), ctxt);
+            InterpreterProgInterface(*this).checkpoint(cur.getFileName(), cur.getStratum() + 1);
+            return result;
+        ESAC(Checkpoint)
+
+        CASE(Clear)
+            // evaluations without IO keep the relations of the program for the caller
+            if (performIO || cur.getRelation().isTemp()) {
+                node->getRelation()->purge();
+            }
             return true;
         ESAC(Clear)
 
+        CASE_NO_CAST(Freeze)
+            // under a memory limit, relations are only packed once memory runs short
+            if (memoryLimit > 0 && !Global::config().has("freeze-relations")) {
+                frozenRelations.insert(node->getData(0));
+                return true;
+            }
+            node->getRelation()->compact();
+            return true;
+        ESAC(Freeze)
+
+        CASE_NO_CAST(BuildIndex)
+            node->getRelation()->buildIndex(node->getData(0));
+            return true;
+        ESAC(BuildIndex)
+
+        CASE_NO_CAST(DropIndex)
+            node->getRelation()->dropIndex(node->getData(0));
+            return true;
+        ESAC(DropIndex)
+
         CASE(LogSize)
             const InterpreterRelation& rel = *node->getRelation();
             ProfileEventSingleton::instance().makeQuantityEvent(
-                    cur.getMessage(), rel.size(), getIterationNumber());
+                    cur.getMessage(), rel.size(), ctxt.getIteration());
             return true;
         ESAC(LogSize)
 
+        CASE(LogStatistics)
+            const InterpreterRelation& rel = *node->getRelation();
+            ProfileEventSingleton::instance().makeStatisticsEvent(
+                    cur.getMessage(), rel, rel.getArity() - rel.getAuxiliaryArity());
+            return true;
+        ESAC(LogStatistics)
+
+        CASE(LogMemory)
+            auto& profile = ProfileEventSingleton::instance();
+            const auto relations = cur.getRelations();
+            for (size_t i = 0; i < relations.size(); ++i) {
+                profile.makeRelationMemoryEvent(
+                        LogStatement::relationMemory(relations[i]->getName(), cur.getStratum()),
+                        getRelationHandle(node->getData(i))->getMemoryUsage());
+            }
+            profile.makeMemoryEvent(LogStatement::memory(cur.getStratum()), getSymbolTable().memoryUsage(),
+                    getRecordTable().memoryUsage());
+            return true;
+        ESAC(LogMemory)
+
         CASE(Load)
+            if (!performIO) {
+                return true;
+            }
             try {
                 for (IODirectives ioDirectives : cur.getIODirectives()) {
                     InterpreterRelation& relation = *node->getRelation();
@@ -1346,18 +3190,33 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                             .getReader(ioDirectives, getSymbolTable(), getRecordTable())
                             ->readAll(relation);
                 }
+                node->getRelation()->spill();
             } catch (std::exception& e) {
                 std::cerr << "Error loading data: " << e.what() << "\n";
             }
+            if (memoryLimit > 0) {
+                checkMemoryLimit();
+            }
             return true;
         ESAC(Load)
 
         CASE(Store)
+            // the relations of all ranks are equal, and written by the first one
+            if (!performIO || (distribution != nullptr && distribution->getRank() != 0)) {
+                return true;
+            }
             try {
                 for (IODirectives ioDirectives : cur.getIODirectives()) {
-                    IOSystem::getInstance()
-                            .getWriter(ioDirectives, getSymbolTable(), getRecordTable())
-                            ->writeAll(*node->getRelation());
+                    auto writer = IOSystem::getInstance().getWriter(
+                            ioDirectives, getSymbolTable(), getRecordTable());
+                    // an output sorted by columns of numbers iterates a built index starting with them
+                    const auto order = isa->getOutputOrder(cur.getRelation(), ioDirectives);
+                    const int indexPos = order.empty() ? -1 : node->getRelation()->getOrderedIndex(order);
+                    if (indexPos >= 0) {
+                        writer->writeOrdered(node->getRelation()->getIndexScan(indexPos));
+                    } else {
+                        writer->writeAll(*node->getRelation());
+                    }
                 }
             } catch (std::exception& e) {
                 std::cerr << e.what();
@@ -1368,6 +3227,15 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
         CASE_NO_CAST(Query)
             InterpreterPreamble* preamble = node->getPreamble();
+            if (memoryLimit > 0) {
+                for (size_t rel : preamble->readRelations) {
+                    recentRelations.insert(rel);
+                    if (indexesEvicted) {
+                        getRelationHandle(rel)->restoreIndexes();
+                    }
+                }
+            }
+            ctxt.reserveTuples(preamble->tupleCount);
 
             // Execute view-free operations in outer filter if any.
             auto& viewFreeOps = preamble->getOuterFilterViewFreeOps();
@@ -1400,7 +3268,34 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     ctxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
             }
-            execute(node->getChild(0), ctxt);
+            if (!preamble->partitioned) {
+                execute(node->getChild(0), ctxt);
+            } else {
+                // derive the tuples of the partition of this rank, and exchange them with the other ranks
+                std::unordered_map<InterpreterRelation*, std::vector<RamDomain>> outbox;
+                ctxt.setPartitioned(true);
+                ctxt.setOutbox(&outbox);
+                ctxt.setBufferingInserts(true);
+                execute(node->getChild(0), ctxt);
+                flushInsertBuffers(ctxt, *preamble);
+                ctxt.setPartitioned(false);
+                ctxt.setOutbox(nullptr);
+                ctxt.setBufferingInserts(false);
+                for (size_t relId : preamble->exchangedRelations) {
+                    InterpreterRelation& rel = *getRelationHandle(relId);
+                    const std::vector<RamDomain> tuples = distribution->exchange(outbox[&rel]);
+                    rel.insertBulk(tuples.data(), tuples.size() / rel.getArity(), rel.getArity());
+                }
+            }
+            ctxt.releaseTuples();
+
+            // the inserted relations are not accessed by other operations between statements
+            for (size_t rel : preamble->spillingRelations) {
+                getRelationHandle(rel)->spill();
+            }
+            if (memoryLimit > 0) {
+                checkMemoryLimit();
+            }
             return true;
         ESAC(Query)
 
@@ -1412,14 +3307,23 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return true;
         ESAC(Extend)
 
+        CASE_NO_CAST(Merge)
+            getRelationHandle(node->getData(1))->insert(*getRelationHandle(node->getData(0)));
+            return true;
+        ESAC(Merge)
+
         CASE_NO_CAST(Swap)
             swapRelation(node->getData(0), node->getData(1));
             return true;
         ESAC(Swap)
 
-        default:
-            assert(false && "Unhandled\n");
+        DISPATCH_DEFAULT
     }
+    return 0;
+
+#undef CASE_LABEL
+#undef DISPATCH_START
+#undef DISPATCH_DEFAULT
 }
 
 }  // namespace souffle
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include "ExternalSet.h"
 #include "InterpreterContext.h"
+#include "InterpreterDistribution.h"
 #include "InterpreterGenerator.h"
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
@@ -24,9 +26,15 @@
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
 #include "RecordTable.h"
-#include <deque>
+#include "RegexCache.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
+#include <set>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include <dlfcn.h>
@@ -46,19 +54,57 @@ class InterpreterEngine {
 public:
     InterpreterEngine(RamTranslationUnit& tUnit)
             : profileEnabled(Global::config().has("profile")),
-              numOfThreads(std::stoi(Global::config().get("jobs"))), tUnit(tUnit),
-              isa(tUnit.getAnalysis<RamIndexAnalysis>()), generator(isa) {
+              numOfThreads(std::stoi(Global::config().get("jobs"))),
+              numOfPartitions(MAX_CHUNKS_PER_THREAD *
+                              (numOfThreads > 0 ? numOfThreads : ThreadBudget::instance().getCapacity())),
+              tailThreshold(Global::config().has("tail-threshold")
+                                    ? std::stoull(Global::config().get("tail-threshold"))
+                                    : 0),
+              tUnit(tUnit),
+              isa(tUnit.getAnalysis<RamIndexAnalysis>()),
+              generator(isa, tUnit.getProgram(), tUnit.getSymbolTable(),
+                      [this](const std::string& name) { return getMethodHandle(name); }) {
 #ifdef _OPENMP
         if (numOfThreads > 0) {
             omp_set_num_threads(numOfThreads);
         }
 #endif
+        threadProfiles.resize(MAX_THREADS);
+
+        // b-tree relations exceeding the memory budget, in MiB, spill to disk
+        if (Global::config().has("memory-budget")) {
+            ExternalMemory::budget = std::stoull(Global::config().get("memory-budget")) << 20;
+        }
+        ExternalMemory::directory = Global::config().get("spill-dir");
+
+        if (Global::config().has("distributed")) {
+            checkDistributable();
+            distribution = std::make_unique<InterpreterDistribution>();
+        }
+
+        // generating the subroutines also creates the relations of incremental updates, such that the
+        // program interface can fill in the changes before the main program is executed
+        for (const auto& sub : tUnit.getProgram().getSubroutines()) {
+            bool isParallel = false;
+            visitDepthFirst(*sub.second, [&](const RamAbstractParallel&) { isParallel = true; });
+            subroutines[sub.first] = Subroutine{generator.generateTree(*sub.second), isParallel};
+        }
     }
     /** @brief Execute the main program */
     void executeMain();
+    /**
+     * @brief Execute the main program again on the relations of the program, without loads and stores,
+     * skipping the statements which compute base relations only
+     */
+    void executeQuery(const std::function<bool(const std::string&)>& isBaseRelation);
     /** @brief Execute the subroutine program */
     void executeSubroutine(
             const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret);
+    /** @brief Execute the subroutine program for each of a batch of argument vectors in parallel */
+    void executeSubroutines(const std::string& name, const std::vector<std::vector<RamDomain>>& args,
+            std::vector<std::vector<RamDomain>>& ret);
+    /** @brief Return the string symbol table */
+    SymbolTable& getSymbolTable();
 
 private:
     /** @brief Remove a relation from the environment */
@@ -67,26 +113,148 @@ private:
     void swapRelation(const size_t ramRel1, const size_t ramRel2);
     /** @brief Return a reference to the relation on the given index */
     RelationHandle& getRelationHandle(const size_t idx);
-    /** @brief Return the string symbol table */
-    SymbolTable& getSymbolTable();
     /** @brief Return the record table */
     RecordTable& getRecordTable();
     /** @brief Return the RamTranslationUnit */
     RamTranslationUnit& getTranslationUnit();
     /** @brief Execute the program */
     RamDomain execute(const InterpreterNode*, InterpreterContext&);
+    /** @brief Insert a tuple into a relation, or buffer it if the context buffers insertions */
+    static void insertTuple(InterpreterRelation& rel, const RamDomain* tuple, InterpreterContext& ctxt) {
+        if (ctxt.isBufferingInserts() && rel.getArity() > 0) {
+            ctxt.bufferInsert(rel, tuple);
+        } else {
+            rel.insert(tuple);
+        }
+    }
+    /** @brief Insert consecutive tuples into a relation, or buffer them if the context buffers insertions */
+    static void insertTuples(
+            InterpreterRelation& rel, const RamDomain* tuples, size_t count, InterpreterContext& ctxt) {
+        const size_t arity = rel.getArity();
+        if (ctxt.isBufferingInserts() && arity > 0) {
+            for (size_t i = 0; i < count; i++) {
+                ctxt.bufferInsert(rel, tuples + i * arity);
+            }
+        } else {
+            rel.insertBulk(tuples, count, arity);
+        }
+    }
+    /**
+     * @brief Check that the ranks of a distributed evaluation derive the same values, i.e., that the
+     * program creates neither symbols nor records nor counter values while it is evaluated
+     */
+    void checkDistributable() const;
+    /**
+     * @brief Sort the buffered insertions of a thread and merge them into their relations, each thread of
+     * the parallel region inserting a range of the tuples of all threads, or into the outbox of a
+     * partitioned query; must be called by all threads of the region
+     */
+    void flushInsertBuffers(InterpreterContext& ctxt, const InterpreterPreamble& preamble);
+    /** @brief Get the compiled pattern of a match constraint node */
+    const CompiledRegex& getPattern(const InterpreterNode* node, InterpreterContext& ctxt) {
+        if (node->getData(0) != DYNAMIC_PATTERN) {
+            return generator.getRegex(node->getData(0));
+        }
+        return RegexCache::get(getSymbolTable().resolve(execute(node->getChild(0), ctxt)));
+    }
+    /** @brief Evaluate the existence check of a plain or negated existence check node */
+    bool evalExistenceCheck(const InterpreterNode*, InterpreterContext&);
+    /** @brief Evaluate the children of a node into a tuple of the given arity */
+    void evalTuple(const InterpreterNode*, RamDomain* tuple, size_t arity, InterpreterContext&);
+    /** @brief Evaluate the children of a node into a tuple of a fixed arity, unrolling the loop */
+    template <size_t Arity>
+    void evalTuple(const InterpreterNode*, RamDomain* tuple, InterpreterContext&);
+    /** @brief Load an operand of a fused node, encoded as a pair at the given data position */
+    static RamDomain loadOperand(const InterpreterNode* node, size_t pos, const InterpreterContext& ctxt) {
+        size_t tupleId = node->getData(pos);
+        if (tupleId == CONSTANT_OPERAND) {
+            return static_cast<RamDomain>(node->getData(pos + 1));
+        }
+        return ctxt[tupleId][node->getData(pos + 1)];
+    }
+    /**
+     * @brief Insert the projection of each tuple of a range satisfying the condition, if any, into
+     * the target of the project node of a fused scan, by a loop specialised to the arity of the
+     * target; the scanned tuple of the given arity is bound to the given tuple id. Batched
+     * projections are evaluated by projectBatches.
+     */
+    template <typename Range>
+    void projectRange(Range&& range, size_t tupleId, size_t scanArity, const InterpreterNode* condition,
+            const InterpreterNode* project, bool batched, InterpreterContext& ctxt);
+    template <size_t Arity, typename Range>
+    void projectRange(Range&& range, size_t tupleId, const InterpreterNode* condition,
+            const InterpreterNode* project, InterpreterContext& ctxt);
+    /**
+     * @brief Insert the projections of a range like projectRange, collecting FUSED_BATCH_SIZE tuples
+     * at a time column-wise; the simple constraints of the condition are evaluated by loops over the
+     * columns of a batch, the remaining conjuncts for each tuple passing them, and the projections of
+     * a batch are inserted at once
+     */
+    template <size_t Arity, typename Range>
+    void projectBatches(Range&& range, size_t tupleId, size_t scanArity, const InterpreterNode* condition,
+            const InterpreterNode* project, InterpreterContext& ctxt);
+    /**
+     * @brief Evaluate the nested operation of a scan for each tuple of a range, bound to the given tuple
+     * id, where the nested operation is an index scan: the tuples are copied in batches, and the searches
+     * of the index scan for a batch are prefetched before the nested operation is evaluated for each of
+     * its tuples, such that their cache misses overlap; returns the number of tuples visited
+     */
+    template <typename Range>
+    size_t prefetchScan(Range&& range, size_t arity, size_t tupleId, const InterpreterNode* nested,
+            InterpreterContext& ctxt);
+    /**
+     * @brief Evaluate a transient hash join node: build a hash table of the smaller relation on the
+     * columns joining both relations, and probe it with each tuple of the larger relation, evaluating
+     * the filter of the inner scan for each pair of joined tuples
+     */
+    void transientHashJoin(const InterpreterNode* node, InterpreterContext& ctxt);
+    /**
+     * @brief Evaluate a group aggregate node: aggregate the tuples of the aggregated relation into a
+     * hash table on the keys of their groups, and look up the group of each scanned tuple, evaluating
+     * the nested operation with its aggregate
+     */
+    void groupAggregate(const InterpreterNode* node, InterpreterContext& ctxt);
+    /**
+     * @brief Merge a stream of the outer relation of a merge join node, ordered by the joined column,
+     * with a cursor on the inner relation: the cursor is advanced linearly to each new value of the
+     * outer tuples, or sought in the index if the value is further ahead, and the group of inner tuples
+     * of the value is joined with each outer tuple of the value
+     */
+    void mergeJoin(const InterpreterNode* node, Stream& outer, InterpreterContext& ctxt);
     /** @brief Return method handler */
     void* getMethodHandle(const std::string& method);
     /** @brief Load DLL */
     const std::vector<void*>& loadDLL();
-    /** @brief Return current iteration number for loop operation */
-    size_t getIterationNumber() const;
-    /** @brief Increase iteration number by one */
-    void incIterationNumber();
-    /** @brief Reset iteration number */
-    void resetIterationNumber();
-    /** @brief Increment the counter */
-    int incCounter();
+    /**
+     * @brief Lock the relations accessed by a stratum of a schedule node, shared if they are only read,
+     * starting at the given data position of the stratum, see InterpreterGenerator::visitSchedule
+     */
+    void lockRelations(const InterpreterNode* schedule, size_t pos);
+    /** @brief Unlock the relations locked by lockRelations */
+    void unlockRelations(const InterpreterNode* schedule, size_t pos);
+    /** @brief Take a unique value of the counter, see BlockCounter */
+    RamDomain incCounter();
+    /** @brief Count an execution of the operation with the given profile counter id */
+    void countFrequency(size_t id);
+    /** @brief Count an execution of a search operation or existence check when profiling */
+    void countSearch(const RamNode* search);
+    /** @brief Count the tuples found by an execution of a search operation or existence check when
+     * profiling */
+    void countSearchTuples(const RamNode* search, size_t tuples);
+    /** @brief Merge the per-thread profile counters into the frequencies of the given iteration */
+    void mergeFrequencies(size_t iteration);
+    /** @brief Return the maximal number of chunks of a parallel operation in the given context */
+    size_t getMaxChunks(const InterpreterContext& ctxt) const;
+    /** @brief Check whether the deltas of a loop are all smaller than the tail threshold */
+    bool isTailIteration(const InterpreterNode* loop);
+    /**
+     * @brief Free memory once the resident memory nears the memory limit, at most once a second: pack
+     * the frozen relations, halve the budget of relations spilling to disk, and drop the secondary indexes
+     * of the relations not read since the last check, until the estimated excess is freed
+     */
+    void checkMemoryLimit();
+    /** @brief Return the estimated bytes of the relations, symbols and records */
+    size_t getTrackedMemory();
     /** @brief Return the relation map. */
     std::vector<std::unique_ptr<RelationHandle>>& getRelationMap();
 
@@ -94,14 +262,58 @@ private:
     const bool profileEnabled;
     /** Number of threads enabled for this program */
     size_t numOfThreads;
-    /** Profile counter */
-    std::atomic<RamDomain> counter{0};
-    /** Loop iteration counter */
-    size_t iteration = 0;
-    /** Profile for rule frequencies */
-    std::map<std::string, std::deque<std::atomic<size_t>>> frequencies;
+    /** Maximal number of partitions of parallel operations */
+    size_t numOfPartitions;
+    /** Size of the deltas below which loop iterations are evaluated sequentially, zero to disable */
+    size_t tailThreshold;
+    /** Counter of the auto-increment operator, reserving a block of values per thread */
+    BlockCounter<RamDomain> counter;
+    /** Locks of the relations, indexed by relation id, held by the concurrent strata accessing them */
+    std::vector<std::shared_mutex> relationLocks;
+    /** Statistics of the strata of schedules, reported in verbose mode */
+    struct StrataStatistics {
+        /** Strata evaluated, strata being evaluated, and the peak of the latter */
+        std::atomic<size_t> evaluated{0};
+        std::atomic<size_t> active{0};
+        std::atomic<size_t> peak{0};
+        /** Waits of strata for relations locked by other strata, and the microseconds waited */
+        std::atomic<size_t> waits{0};
+        std::atomic<size_t> waitTime{0};
+    } strataStatistics;
+    /** Number of strata of the main program restored from a checkpoint */
+    size_t restoredStrata = 0;
+    /** If loads and stores are performed, and cleared relations other than temporary ones purged */
+    bool performIO = true;
+    /** Bytes the main program may occupy, zero for no limit */
+    size_t memoryLimit = 0;
+    /** Time of the next reading of the resident memory */
+    std::chrono::steady_clock::time_point nextMemoryCheck;
+    /** Number of checks of the memory limit which freed memory */
+    size_t memoryRounds = 0;
+    /** Relations frozen while the memory limit was not reached, packed once it is */
+    std::set<size_t> frozenRelations;
+    /** Relations read by queries since the last check freeing memory */
+    std::set<size_t> recentRelations;
+    /** If the indexes of some relation were dropped to free memory */
+    bool indexesEvicted = false;
+    /** If the memory limit was exceeded despite freeing memory, warned once */
+    bool memoryExceeded = false;
+    /** Profile counters of a thread for the current iteration, padded against false sharing */
+    struct alignas(64) ThreadProfile {
+        std::vector<size_t> frequencies;
+    };
+    /** Per-thread profile counters, merged into the frequencies at the end of each iteration */
+    std::vector<ThreadProfile> threadProfiles;
+    /** Profile for rule frequencies, indexed by profile counter id and iteration */
+    std::vector<std::vector<size_t>> frequencies;
     /** Profile for relation reads */
     std::map<std::string, std::atomic<size_t>> reads;
+    /** Profile for the executions of searches, indexed by the search operation or existence check */
+    std::map<const RamNode*, std::atomic<size_t>> searches;
+    /** Profile for the tuples found by searches, indexed by the search operation or existence check */
+    std::map<const RamNode*, std::atomic<size_t>> searchTuples;
+    /** Profile for parallel operations per relation, counting parallel and sequential executions */
+    std::map<std::string, std::array<size_t, 2>> parallelism;
     /** DLL */
     std::vector<void*> dll;
     /** Program */
@@ -110,8 +322,17 @@ private:
     RamIndexAnalysis* isa;
     /** Interpreter program generator */
     NodeGenerator generator;
+    /** The tree of a subroutine, and whether its body has parallel operations */
+    struct Subroutine {
+        std::unique_ptr<InterpreterNode> entry;
+        bool isParallel;
+    };
+    /** Subroutines by name */
+    std::map<std::string, Subroutine> subroutines;
     /** Record Table*/
     RecordTable recordTable;
+    /** Ranks of a distributed evaluation, or null if the evaluation is not distributed */
+    std::unique_ptr<InterpreterDistribution> distribution;
 };
 
 }  // namespace souffle
@@ -20,11 +20,23 @@
 #include "Global.h"
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
+#include "RamComplexityAnalysis.h"
 #include "RamIndexAnalysis.h"
+#include "RamProgram.h"
 #include "RamVisitor.h"
+#include "RegexCache.h"
+#include "SignalHandler.h"
+#include "SymbolTable.h"
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <map>
 #include <memory>
 #include <queue>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace souffle {
 
@@ -39,7 +51,23 @@ class NodeGenerator : public RamVisitor<std::unique_ptr<InterpreterNode>> {
     using RelationHandle = std::unique_ptr<InterpreterRelation>;
 
 public:
-    NodeGenerator(RamIndexAnalysis* isa) : isa(isa), isProvenance(Global::config().has("provenance")) {}
+    NodeGenerator(RamIndexAnalysis* isa, const RamProgram& program, const SymbolTable& symbolTable,
+            std::function<void*(const std::string&)> resolveFunctor)
+            : isa(isa), symbolTable(symbolTable), isProvenance(Global::config().has("provenance")),
+              hasMemoryBudget(Global::config().has("memory-budget")),
+              isDistributed(Global::config().has("distributed")),
+              hasAdaptiveConditions(Global::config().has("adaptive-conditions")),
+              resolveFunctor(std::move(resolveFunctor)) {
+        // relations that are only loaded are read-only once the loads are done
+        visitDepthFirst(program, [&](const RamLoad& load) { readOnlyRelations.insert(&load.getRelation()); });
+        visitDepthFirst(program, [&](const RamProject& project) {
+            readOnlyRelations.erase(&project.getRelation());
+        });
+        visitDepthFirst(program, [&](const RamBinRelationStatement& stmt) {
+            readOnlyRelations.erase(&stmt.getFirstRelation());
+            readOnlyRelations.erase(&stmt.getSecondRelation());
+        });
+    }
 
     /**
      * @brief Generate the tree based on given entry.
@@ -63,15 +91,21 @@ public:
             }
         });
         // Parse program
-        return visit(root);
+        NodePtr tree = visit(root);
+        tree->flatten();
+        return tree;
     }
 
     NodePtr visitConstant(const RamConstant& num) override {
-        return std::make_unique<InterpreterNode>(I_Constant, &num);
+        std::vector<size_t> data{static_cast<size_t>(num.getConstant())};
+        return std::make_unique<InterpreterNode>(I_Constant, &num, NodePtrVec{}, nullptr, std::move(data));
     }
 
     NodePtr visitTupleElement(const RamTupleElement& access) override {
-        return std::make_unique<InterpreterNode>(I_TupleElement, &access);
+        std::vector<size_t> data{
+                static_cast<size_t>(access.getTupleId()), static_cast<size_t>(access.getElement())};
+        return std::make_unique<InterpreterNode>(
+                I_TupleElement, &access, NodePtrVec{}, nullptr, std::move(data));
     }
 
     NodePtr visitAutoIncrement(const RamAutoIncrement& inc) override {
@@ -91,7 +125,9 @@ public:
         for (const auto& arg : op.getArguments()) {
             children.push_back(visit(arg));
         }
-        return std::make_unique<InterpreterNode>(I_UserDefinedOperator, &op, std::move(children));
+        auto res = std::make_unique<InterpreterNode>(I_UserDefinedOperator, &op, std::move(children));
+        res->setFunctor(std::make_unique<InterpreterFunctor>(op, resolveFunctor(op.getName())));
+        return res;
     }
 
     NodePtr visitPackRecord(const RamPackRecord& pr) override {
@@ -116,13 +152,34 @@ public:
     }
 
     NodePtr visitConjunction(const RamConjunction& conj) override {
+        // the terms of nested conjunctions are evaluated by a single node, from left to right
+        const RamComplexityAnalysis complexity(RamComplexityAnalysis::name);
         NodePtrVec children;
-        children.push_back(visit(conj.getLHS()));
-        children.push_back(visit(conj.getRHS()));
-        return std::make_unique<InterpreterNode>(I_Conjunction, &conj, std::move(children));
+        std::vector<size_t> costs;
+        std::function<void(const RamCondition&)> addTerms = [&](const RamCondition& cond) {
+            if (const auto* nested = dynamic_cast<const RamConjunction*>(&cond)) {
+                addTerms(nested->getLHS());
+                addTerms(nested->getRHS());
+            } else {
+                children.push_back(visit(cond));
+                costs.push_back(1 + complexity.getComplexity(&cond));
+            }
+        };
+        addTerms(conj);
+        const bool adaptive =
+                hasAdaptiveConditions && children.size() <= InterpreterConditionOrder::MAX_TERMS;
+        auto node = std::make_unique<InterpreterNode>(I_Conjunction, &conj, std::move(children));
+        if (adaptive) {
+            node->setConditionOrder(std::make_unique<InterpreterConditionOrder>(std::move(costs)));
+        }
+        return node;
     }
 
     NodePtr visitNegation(const RamNegation& neg) override {
+        // fuse a negated existence check into a single node
+        if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&neg.getOperand())) {
+            return generateExistenceCheck(I_NegatedExistenceCheck, *exists);
+        }
         NodePtrVec children;
         children.push_back(visit(neg.getOperand()));
         return std::make_unique<InterpreterNode>(I_Negation, &neg, std::move(children));
@@ -135,14 +192,7 @@ public:
     }
 
     NodePtr visitExistenceCheck(const RamExistenceCheck& exists) override {
-        NodePtrVec children;
-        for (const auto& value : exists.getValues()) {
-            children.push_back(visit(value));
-        }
-        std::vector<size_t> data;
-        data.push_back(encodeView(&exists));
-        return std::make_unique<InterpreterNode>(
-                I_ExistenceCheck, &exists, std::move(children), nullptr, std::move(data));
+        return generateExistenceCheck(I_ExistenceCheck, exists);
     }
 
     NodePtr visitProvenanceExistenceCheck(const RamProvenanceExistenceCheck& provExists) override {
@@ -158,10 +208,32 @@ public:
 
     // -- comparison operators --
     NodePtr visitConstraint(const RamConstraint& relOp) override {
+        // comparisons of tuple elements and constants are evaluated without child nodes
+        if (isSimpleComparison(relOp.getOperator()) && isSimpleOperand(relOp.getLHS()) &&
+                isSimpleOperand(relOp.getRHS())) {
+            std::vector<size_t> data;
+            encodeOperand(relOp.getLHS(), data);
+            encodeOperand(relOp.getRHS(), data);
+            return std::make_unique<InterpreterNode>(
+                    I_SimpleConstraint, &relOp, NodePtrVec{}, nullptr, std::move(data));
+        }
         NodePtrVec children;
         children.push_back(visit(relOp.getLHS()));
         children.push_back(visit(relOp.getRHS()));
-        return std::make_unique<InterpreterNode>(I_Constraint, &relOp, std::move(children));
+        // constant patterns of matches are compiled once
+        std::vector<size_t> data;
+        if (relOp.getOperator() == BinaryConstraintOp::MATCH ||
+                relOp.getOperator() == BinaryConstraintOp::NOT_MATCH) {
+            if (const auto* pattern = dynamic_cast<const RamSignedConstant*>(&relOp.getLHS())) {
+                data.push_back(regexes.size());
+                const std::string& text = symbolTable.resolve(pattern->getConstant());
+                regexes.push_back(std::make_unique<CompiledRegex>(text));
+            } else {
+                data.push_back(DYNAMIC_PATTERN);
+            }
+        }
+        return std::make_unique<InterpreterNode>(
+                I_Constraint, &relOp, std::move(children), nullptr, std::move(data));
     }
 
     NodePtr visitNestedOperation(const RamNestedOperation& nested) override {
@@ -171,15 +243,31 @@ public:
     NodePtr visitTupleOperation(const RamTupleOperation& search) override {
         NodePtrVec children;
         children.push_back(visit(search.getOperation()));
-        return std::make_unique<InterpreterNode>(I_TupleOperation, &search, std::move(children));
+        std::vector<size_t> data;
+        if (!search.getProfileText().empty()) {
+            data.push_back(encodeProfileText(search.getProfileText()));
+        }
+        return std::make_unique<InterpreterNode>(
+                I_TupleOperation, &search, std::move(children), nullptr, std::move(data));
     }
 
     NodePtr visitScan(const RamScan& scan) override {
         size_t relId = encodeRelation(scan.getRelation());
         auto rel = relations[relId].get();
         NodePtrVec children;
+        if (isFusableProjection(scan) && !isPartitionedScan(scan)) {
+            visitFusedProjection(scan, children);
+            std::vector<size_t> data;
+            data.push_back(batchProjections);
+            return std::make_unique<InterpreterNode>(
+                    I_ScanProject, &scan, std::move(children), rel, std::move(data));
+        }
         children.push_back(visitTupleOperation(scan));
-        return std::make_unique<InterpreterNode>(I_Scan, &scan, std::move(children), rel);
+        std::vector<size_t> data;
+        if (isPrefetchedJoin(scan)) {
+            data.push_back(1);
+        }
+        return std::make_unique<InterpreterNode>(I_Scan, &scan, std::move(children), rel, std::move(data));
     }
 
     NodePtr visitParallelScan(const RamParallelScan& pScan) override {
@@ -187,7 +275,12 @@ public:
         auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visitTupleOperation(pScan));
-        auto res = std::make_unique<InterpreterNode>(I_ParallelScan, &pScan, std::move(children), rel);
+        std::vector<size_t> data;
+        if (isPrefetchedJoin(pScan)) {
+            data.push_back(1);
+        }
+        auto res = std::make_unique<InterpreterNode>(
+                I_ParallelScan, &pScan, std::move(children), rel, std::move(data));
         res->setPreamble(parentQueryPreamble);
         return res;
     }
@@ -197,11 +290,117 @@ public:
         for (const auto& value : scan.getRangePattern()) {
             children.push_back(visit(value));
         }
-        children.push_back(visitTupleOperation(scan));
+        const bool fused = isFusableProjection(scan) && !isPartitionedScan(scan);
+        if (fused) {
+            visitFusedProjection(scan, children);
+        } else {
+            children.push_back(visitTupleOperation(scan));
+        }
         std::vector<size_t> data;
         data.push_back((encodeView(&scan)));
+        if (fused) {
+            data.push_back(batchProjections);
+        } else if (isPrefetchedJoin(scan)) {
+            data.push_back(1);
+        }
+        return std::make_unique<InterpreterNode>(fused ? I_IndexScanProject : I_IndexScan, &scan,
+                std::move(children), nullptr, std::move(data));
+    }
+
+    NodePtr visitLeapfrogJoin(const RamLeapfrogJoin& join) override {
+        // the range pattern is followed by the intersections and the nested operation
+        NodePtrVec children;
+        for (const auto& value : join.getRangePattern()) {
+            children.push_back(visit(value));
+        }
+        for (const auto& intersection : join.getIntersections()) {
+            children.push_back(visit(intersection));
+        }
+        children.push_back(visitTupleOperation(join));
+        // the view and the free column of each search
+        std::vector<size_t> data;
+        data.push_back(encodeView(&join));
+        data.push_back(RamLeapfrogJoin::getFreeColumn(join.getRangePattern()));
+        for (const auto& intersection : join.getIntersections()) {
+            data.push_back(encodeView(intersection));
+            data.push_back(RamLeapfrogJoin::getFreeColumn(intersection->getValues()));
+        }
         return std::make_unique<InterpreterNode>(
-                I_IndexScan, &scan, std::move(children), nullptr, std::move(data));
+                I_LeapfrogJoin, &join, std::move(children), nullptr, std::move(data));
+    }
+
+    NodePtr visitMergeJoin(const RamMergeJoin& merge) override {
+        // the nested operation of the merged index scan is evaluated for each pair of joined tuples
+        const RamIndexScan& inner = merge.getInnerScan();
+        NodePtrVec children;
+        children.push_back(visitTupleOperation(inner));
+        // the indexes ordering both relations, the inner relation, and the profile text of the scan
+        std::vector<size_t> data;
+        data.push_back(isa->getIndexes(merge.getRelation()).getLexOrderNum(isa->getSearchSignature(&merge)));
+        data.push_back(isa->getIndexes(inner.getRelation()).getLexOrderNum(isa->getSearchSignature(&inner)));
+        data.push_back(encodeRelation(inner.getRelation()));
+        if (!merge.getProfileText().empty()) {
+            data.push_back(encodeProfileText(merge.getProfileText()));
+        }
+        const bool parallel = dynamic_cast<const RamParallelMergeJoin*>(&merge) != nullptr;
+        auto res = std::make_unique<InterpreterNode>(parallel ? I_ParallelMergeJoin : I_MergeJoin, &merge,
+                std::move(children), relations[encodeRelation(merge.getRelation())].get(), std::move(data));
+        if (parallel) {
+            res->setPreamble(parentQueryPreamble);
+        }
+        return res;
+    }
+
+    NodePtr visitHashJoin(const RamHashJoin& join) override {
+        // the filter of the inner scan checks the keys and evaluates the nested operation for each pair
+        const RamScan& inner = join.getInnerScan();
+        NodePtrVec children;
+        children.push_back(visit(inner.getOperation()));
+        // the inner relation and the number of keys, followed by a triple for each key: the column of the
+        // inner relation and its operand
+        std::vector<size_t> data;
+        data.push_back(encodeRelation(inner.getRelation()));
+        const auto keys = join.getKeys();
+        data.push_back(keys.size());
+        for (const auto& key : keys) {
+            data.push_back(key.first);
+            encodeOperand(*key.second, data);
+        }
+        const bool parallel = dynamic_cast<const RamParallelHashJoin*>(&join) != nullptr;
+        auto res = std::make_unique<InterpreterNode>(parallel ? I_ParallelHashJoin : I_HashJoin, &join,
+                std::move(children), relations[encodeRelation(join.getRelation())].get(), std::move(data));
+        if (parallel) {
+            res->setPreamble(parentQueryPreamble);
+        }
+        return res;
+    }
+
+    NodePtr visitGroupAggregate(const RamGroupAggregate& group) override {
+        // the condition and the target expression of the aggregation are evaluated for each aggregated
+        // tuple, and the nested operation for each scanned tuple
+        const RamAggregate& aggregate = group.getAggregate();
+        NodePtrVec children;
+        children.push_back(visit(aggregate.getCondition()));
+        children.push_back(visit(aggregate.getExpression()));
+        children.push_back(visitTupleOperation(aggregate));
+        // the aggregated relation and the number of keys, followed by a pair for each key: the column of
+        // the aggregated relation and the element of the scanned tuple
+        std::vector<size_t> data;
+        data.push_back(encodeRelation(aggregate.getRelation()));
+        const auto keys = group.getKeys();
+        data.push_back(keys.size());
+        for (const auto& key : keys) {
+            data.push_back(key.first);
+            data.push_back(key.second);
+        }
+        const bool parallel = dynamic_cast<const RamParallelGroupAggregate*>(&group) != nullptr;
+        auto res = std::make_unique<InterpreterNode>(parallel ? I_ParallelGroupAggregate : I_GroupAggregate,
+                &group, std::move(children), relations[encodeRelation(group.getRelation())].get(),
+                std::move(data));
+        if (parallel) {
+            res->setPreamble(parentQueryPreamble);
+        }
+        return res;
     }
 
     NodePtr visitParallelIndexScan(const RamParallelIndexScan& piscan) override {
@@ -214,6 +413,9 @@ public:
         children.push_back(visitTupleOperation(piscan));
         std::vector<size_t> data;
         data.push_back((encodeIndexPos(piscan)));
+        if (isPrefetchedJoin(piscan)) {
+            data.push_back(1);
+        }
         auto res = std::make_unique<InterpreterNode>(
                 I_ParallelIndexScan, &piscan, std::move(children), rel, std::move(data));
         res->setPreamble(parentQueryPreamble);
@@ -287,6 +489,19 @@ public:
         return std::make_unique<InterpreterNode>(I_Aggregate, &aggregate, std::move(children), rel);
     }
 
+    NodePtr visitParallelAggregate(const RamParallelAggregate& aggregate) override {
+        size_t relId = encodeRelation(aggregate.getRelation());
+        auto rel = relations[relId].get();
+        NodePtrVec children;
+        children.push_back(visit(aggregate.getCondition()));
+        children.push_back(visit(aggregate.getExpression()));
+        children.push_back(visitTupleOperation(aggregate));
+        auto res = std::make_unique<InterpreterNode>(
+                I_ParallelAggregate, &aggregate, std::move(children), rel);
+        res->setPreamble(parentQueryPreamble);
+        return res;
+    }
+
     NodePtr visitIndexAggregate(const RamIndexAggregate& aggregate) override {
         size_t relId = encodeRelation(aggregate.getRelation());
         auto rel = relations[relId].get();
@@ -303,6 +518,24 @@ public:
                 I_IndexAggregate, &aggregate, std::move(children), rel, std::move(data));
     }
 
+    NodePtr visitParallelIndexAggregate(const RamParallelIndexAggregate& aggregate) override {
+        size_t relId = encodeRelation(aggregate.getRelation());
+        auto rel = relations[relId].get();
+        NodePtrVec children;
+        for (const auto& value : aggregate.getRangePattern()) {
+            children.push_back(visit(value));
+        }
+        children.push_back(visit(aggregate.getCondition()));
+        children.push_back(visit(aggregate.getExpression()));
+        children.push_back(visitTupleOperation(aggregate));
+        std::vector<size_t> data;
+        data.push_back((encodeIndexPos(aggregate)));
+        auto res = std::make_unique<InterpreterNode>(
+                I_ParallelIndexAggregate, &aggregate, std::move(children), rel, std::move(data));
+        res->setPreamble(parentQueryPreamble);
+        return res;
+    }
+
     NodePtr visitBreak(const RamBreak& breakOp) override {
         NodePtrVec children;
         children.push_back(visit(breakOp.getCondition()));
@@ -314,14 +547,31 @@ public:
         NodePtrVec children;
         children.push_back(visit(filter.getCondition()));
         children.push_back(visit(filter.getOperation()));
-        return std::make_unique<InterpreterNode>(I_Filter, &filter, std::move(children));
+        std::vector<size_t> data;
+        if (!filter.getProfileText().empty()) {
+            data.push_back(encodeProfileText(filter.getProfileText()));
+        }
+        return std::make_unique<InterpreterNode>(
+                I_Filter, &filter, std::move(children), nullptr, std::move(data));
     }
 
     NodePtr visitProject(const RamProject& project) override {
         size_t relId = encodeRelation(project.getRelation());
         auto rel = relations[relId].get();
+        const auto& values = project.getValues();
+        // projections of tuple elements and constants are evaluated without child nodes
+        if (std::all_of(values.begin(), values.end(), [](const RamExpression* value) {
+                return isSimpleOperand(*value);
+            })) {
+            std::vector<size_t> data;
+            for (const auto& value : values) {
+                encodeOperand(*value, data);
+            }
+            return std::make_unique<InterpreterNode>(
+                    I_SimpleProject, &project, NodePtrVec{}, rel, std::move(data));
+        }
         NodePtrVec children;
-        for (const auto& value : project.getValues()) {
+        for (const auto& value : values) {
             children.push_back(visit(value));
         }
         return std::make_unique<InterpreterNode>(I_Project, &project, std::move(children), rel);
@@ -353,10 +603,64 @@ public:
         return std::make_unique<InterpreterNode>(I_Parallel, &parallel, std::move(children));
     }
 
+    NodePtr visitSchedule(const RamSchedule& schedule) override {
+        // the relations accessed by each stratum are stored as (number of relations, (relation, written)*),
+        // ordered by relation, such that concurrent strata lock the relations they access in the same order
+        NodePtrVec children;
+        std::vector<size_t> data;
+        for (const auto& value : schedule.getStatements()) {
+            children.push_back(visit(value));
+            std::map<size_t, bool> access;
+            visitDepthFirst(*value, [&](const RamRelationReference& ref) {
+                access.insert({encodeRelation(*ref.get()), false});
+            });
+            auto write = [&](const RamRelation& rel) { access[encodeRelation(rel)] = true; };
+            visitDepthFirst(*value, [&](const RamLoad& load) { write(load.getRelation()); });
+            visitDepthFirst(*value, [&](const RamClear& clear) { write(clear.getRelation()); });
+            visitDepthFirst(
+                    *value, [&](const RamAbstractIndexStatement& stmt) { write(stmt.getRelation()); });
+            visitDepthFirst(*value, [&](const RamBinRelationStatement& stmt) {
+                write(stmt.getFirstRelation());
+                write(stmt.getSecondRelation());
+            });
+            visitDepthFirst(*value, [&](const RamProject& project) { write(project.getRelation()); });
+            data.push_back(access.size());
+            for (const auto& cur : access) {
+                data.push_back(cur.first);
+                data.push_back(cur.second ? 1 : 0);
+            }
+        }
+        return std::make_unique<InterpreterNode>(
+                I_Schedule, &schedule, std::move(children), nullptr, std::move(data));
+    }
+
+    NodePtr visitAdaptiveQuery(const RamAdaptiveQuery& adaptive) override {
+        // the loops of each alternative are stored as (relation, free attributes, arity)
+        NodePtrVec children;
+        std::vector<size_t> data;
+        for (const auto& alternative : adaptive.getStatements()) {
+            children.push_back(visit(alternative));
+            const auto levels = RamAdaptiveQuery::getLevels(*alternative);
+            data.push_back(levels.size());
+            for (const auto& level : levels) {
+                data.push_back(encodeRelation(*level.relation));
+                data.push_back(level.freeAttributes);
+                data.push_back(level.relation->getArity());
+            }
+        }
+        return std::make_unique<InterpreterNode>(
+                I_AdaptiveQuery, &adaptive, std::move(children), nullptr, std::move(data));
+    }
+
     NodePtr visitLoop(const RamLoop& loop) override {
         NodePtrVec children;
         children.push_back(visit(loop.getBody()));
-        return std::make_unique<InterpreterNode>(I_Loop, &loop, std::move(children));
+        // the delta relations of the loop, whose sizes decide whether an iteration is a tail iteration
+        std::vector<size_t> data;
+        visitDepthFirst(loop.getBody(),
+                [&](const RamSwap& swap) { data.push_back(encodeRelation(swap.getFirstRelation())); });
+        return std::make_unique<InterpreterNode>(
+                I_Loop, &loop, std::move(children), nullptr, std::move(data));
     }
 
     NodePtr visitExit(const RamExit& exit) override {
@@ -382,7 +686,16 @@ public:
     NodePtr visitDebugInfo(const RamDebugInfo& dbg) override {
         NodePtrVec children;
         children.push_back(visit(dbg.getStatement()));
-        return std::make_unique<InterpreterNode>(I_DebugInfo, &dbg, std::move(children));
+        // the message is registered once, such that the evaluation only records the id of the rule
+        std::vector<size_t> data{SignalHandler::instance()->registerMsg(dbg.getMessage())};
+        return std::make_unique<InterpreterNode>(
+                I_DebugInfo, &dbg, std::move(children), nullptr, std::move(data));
+    }
+
+    NodePtr visitCheckpoint(const RamCheckpoint& checkpoint) override {
+        NodePtrVec children;
+        children.push_back(visit(checkpoint.getStatement()));
+        return std::make_unique<InterpreterNode>(I_Checkpoint, &checkpoint, std::move(children));
     }
 
     NodePtr visitClear(const RamClear& clear) override {
@@ -391,12 +704,50 @@ public:
         return std::make_unique<InterpreterNode>(I_Clear, &clear, NodePtrVec{}, rel);
     }
 
+    NodePtr visitFreeze(const RamFreeze& freeze) override {
+        size_t relId = encodeRelation(freeze.getRelation());
+        auto rel = relations[relId].get();
+        return std::make_unique<InterpreterNode>(
+                I_Freeze, &freeze, NodePtrVec{}, rel, std::vector<size_t>{relId});
+    }
+
+    NodePtr visitBuildIndex(const RamBuildIndex& build) override {
+        size_t relId = encodeRelation(build.getRelation());
+        auto rel = relations[relId].get();
+        std::vector<size_t> data;
+        data.push_back(isa->getIndexes(build.getRelation()).getLexOrderNum(build.getSearchSignature()));
+        return std::make_unique<InterpreterNode>(I_BuildIndex, &build, NodePtrVec{}, rel, std::move(data));
+    }
+
+    NodePtr visitDropIndex(const RamDropIndex& drop) override {
+        size_t relId = encodeRelation(drop.getRelation());
+        auto rel = relations[relId].get();
+        std::vector<size_t> data;
+        data.push_back(isa->getIndexes(drop.getRelation()).getLexOrderNum(drop.getSearchSignature()));
+        return std::make_unique<InterpreterNode>(I_DropIndex, &drop, NodePtrVec{}, rel, std::move(data));
+    }
+
     NodePtr visitLogSize(const RamLogSize& size) override {
         size_t relId = encodeRelation(size.getRelation());
         auto rel = relations[relId].get();
         return std::make_unique<InterpreterNode>(I_LogSize, &size, NodePtrVec{}, rel);
     }
 
+    NodePtr visitLogStatistics(const RamLogStatistics& statistics) override {
+        size_t relId = encodeRelation(statistics.getRelation());
+        auto rel = relations[relId].get();
+        return std::make_unique<InterpreterNode>(I_LogStatistics, &statistics, NodePtrVec{}, rel);
+    }
+
+    NodePtr visitLogMemory(const RamLogMemory& memory) override {
+        std::vector<size_t> data;
+        for (const RamRelation* relation : memory.getRelations()) {
+            data.push_back(encodeRelation(*relation));
+        }
+        return std::make_unique<InterpreterNode>(
+                I_LogMemory, &memory, NodePtrVec{}, nullptr, std::move(data));
+    }
+
     NodePtr visitLoad(const RamLoad& load) override {
         size_t relId = encodeRelation(load.getRelation());
         auto rel = relations[relId].get();
@@ -433,10 +784,12 @@ public:
                     }
                 });
 
+                NodePtr op = visit(*cur);
+                op->flatten();
                 if (needView) {
-                    preamble->addViewOperationForFilter(visit(*cur));
+                    preamble->addViewOperationForFilter(std::move(op));
                 } else {
-                    preamble->addViewFreeOperationForFilter(visit(*cur));
+                    preamble->addViewFreeOperationForFilter(std::move(op));
                 }
             }
         }
@@ -449,9 +802,63 @@ public:
         });
 
         visitDepthFirst(*next, [&](const RamAbstractParallel& node) { preamble->isParallel = true; });
+        batchProjections = !readsInsertedRelation(query);
+        preamble->bufferInserts =
+                preamble->isParallel && Global::config().has("insert-buffers") && batchProjections;
+        visitDepthFirst(query, [&](const RamTupleOperation& node) {
+            preamble->tupleCount = std::max(preamble->tupleCount, size_t(node.getTupleId() + 1));
+        });
+        visitDepthFirst(query, [&](const RamProject& project) {
+            if (isExternal(project.getRelation())) {
+                preamble->spillingRelations.push_back(encodeRelation(project.getRelation()));
+            }
+        });
+        // the relations referred to by other operations than the insertions of the query
+        std::map<const RamRelation*, int> reads;
+        visitDepthFirst(query, [&](const RamRelationReference& ref) { reads[ref.get()]++; });
+        visitDepthFirst(query, [&](const RamProject& project) { reads[&project.getRelation()]--; });
+        for (const auto& cur : reads) {
+            if (cur.second > 0) {
+                preamble->readRelations.push_back(encodeRelation(*cur.first));
+            }
+        }
+        preamble->partitioned = isDistributed && isPartitionable(query, *next);
+        if (preamble->partitioned) {
+            // the derived tuples are exchanged at the end of the query
+            preamble->bufferInserts = true;
+            visitDepthFirst(query, [&](const RamProject& project) {
+                const size_t relId = encodeRelation(project.getRelation());
+                auto& exchanged = preamble->exchangedRelations;
+                if (std::find(exchanged.begin(), exchanged.end(), relId) == exchanged.end()) {
+                    exchanged.push_back(relId);
+                }
+            });
+        }
+
+        if (preamble->bufferInserts) {
+            visitDepthFirst(query, [&](const RamProject& project) {
+                const size_t relId = encodeRelation(project.getRelation());
+                auto& buffered = preamble->bufferedRelations;
+                if (std::find(buffered.begin(), buffered.end(), relId) == buffered.end()) {
+                    buffered.push_back(relId);
+                }
+            });
+        }
 
         NodePtrVec children;
-        children.push_back(visit(*next));
+        partitionedQuery = preamble->partitioned;
+        const auto copied = getCopiedRelations(*next);
+        if (copied.first != nullptr && !preamble->partitioned) {
+            // the tuples are merged in bulk, maintaining each index of the target at once
+            std::vector<size_t> data;
+            data.push_back(encodeRelation(*copied.first));
+            data.push_back(encodeRelation(*copied.second));
+            children.push_back(
+                    std::make_unique<InterpreterNode>(I_Merge, next, NodePtrVec{}, nullptr, std::move(data)));
+        } else {
+            children.push_back(visit(*next));
+        }
+        partitionedQuery = false;
 
         auto res = std::make_unique<InterpreterNode>(I_Query, &query, std::move(children));
         res->setPreamble(parentQueryPreamble);
@@ -493,14 +900,32 @@ public:
         return *relations[idx];
     }
 
+    /** @brief Return the profile texts of operations, indexed by their encoding */
+    const std::vector<std::string>& getProfileTexts() const {
+        return profileTexts;
+    }
+
+    /** @brief Return the compiled constant pattern of a match constraint */
+    const CompiledRegex& getRegex(size_t idx) const {
+        return *regexes[idx];
+    }
+
 private:
     /** Environment encoding, store a mapping from RamNode to its operation index id. */
     std::unordered_map<const RamNode*, size_t> indexTable;
     /** Used by index encoding */
     RamIndexAnalysis* isa;
+    /** Symbol table resolving the constant patterns of match constraints */
+    const SymbolTable& symbolTable;
+    /** Compiled constant patterns of match constraints */
+    std::vector<std::unique_ptr<CompiledRegex>> regexes;
     /** Points to the current preamble during the generation.  It is used to passing preamble between parent
      * query and its nested parallel operation. */
     std::shared_ptr<InterpreterPreamble> parentQueryPreamble = nullptr;
+    /** Whether the fused scans of the current query may insert their projections in batches */
+    bool batchProjections = false;
+    /** Whether the outermost scan of the current query is partitioned across ranks */
+    bool partitionedQuery = false;
     /** Next available location to encode View */
     size_t viewId = 0;
     /** Next available location to encode a relation */
@@ -513,6 +938,149 @@ private:
     std::vector<std::unique_ptr<RelationHandle>> relations;
     /** If generating a provenance program */
     const bool isProvenance;
+    /** If b-tree relations spill to disk once they exceed the memory budget */
+    const bool hasMemoryBudget;
+    /** If the outermost scans of queries are partitioned across the ranks of a distributed evaluation */
+    const bool isDistributed;
+    /** If the terms of conjunctions are reordered by their observed selectivities */
+    const bool hasAdaptiveConditions;
+    /** Resolves the address of a user-defined functor in the loaded libraries */
+    std::function<void*(const std::string&)> resolveFunctor;
+    /** Relations written by loads only */
+    std::set<const RamRelation*> readOnlyRelations;
+    /** Profile texts of operations, such that profile counters are resolved at generation time */
+    std::vector<std::string> profileTexts;
+    /** Environment encoding, store a mapping from profile text to its counter id */
+    std::unordered_map<std::string, size_t> profileTable;
+
+    /** @brief Generate an existence check of the given node type */
+    NodePtr generateExistenceCheck(enum InterpreterNodeType type, const RamExistenceCheck& exists) {
+        NodePtrVec children;
+        for (const auto& value : exists.getValues()) {
+            children.push_back(visit(value));
+        }
+        std::vector<size_t> data;
+        data.push_back(encodeView(&exists));
+        // whether all attributes are bound, such that the check is a membership test
+        data.push_back(isa->isTotalSignature(&exists) ? 1 : 0);
+        // the relation is consulted for its filter
+        auto rel = relations[encodeRelation(exists.getRelation())].get();
+        return std::make_unique<InterpreterNode>(type, &exists, std::move(children), rel, std::move(data));
+    }
+
+    /** @brief Check whether an expression can be an operand of a fused node */
+    static bool isSimpleOperand(const RamExpression& expr) {
+        return dynamic_cast<const RamTupleElement*>(&expr) != nullptr ||
+               dynamic_cast<const RamConstant*>(&expr) != nullptr;
+    }
+
+    /**
+     * @brief Check whether a scan only projects its tuples, possibly filtered, such that it can be
+     * evaluated by a fused scan node looping over the tuples without evaluating nested nodes
+     */
+    static bool isFusableProjection(const RamTupleOperation& search) {
+        const RamOperation* nested = &search.getOperation();
+        if (const auto* filter = dynamic_cast<const RamFilter*>(nested)) {
+            if (!filter->getProfileText().empty()) {
+                return false;
+            }
+            nested = &filter->getOperation();
+        }
+        const auto* project = dynamic_cast<const RamProject*>(nested);
+        if (project == nullptr || !search.getProfileText().empty()) {
+            return false;
+        }
+        const auto& values = project->getValues();
+        const size_t arity = project->getRelation().getArity();
+        return arity > 0 && arity <= MAX_FUSED_PROJECT_ARITY &&
+               std::all_of(values.begin(), values.end(),
+                       [](const RamExpression* value) { return isSimpleOperand(*value); });
+    }
+
+    /** @brief Append the condition, or nullptr, and the project node of a fusable projection */
+    void visitFusedProjection(const RamTupleOperation& search, NodePtrVec& children) {
+        const RamOperation* nested = &search.getOperation();
+        if (const auto* filter = dynamic_cast<const RamFilter*>(nested)) {
+            children.push_back(visit(filter->getCondition()));
+            nested = &filter->getOperation();
+        } else {
+            children.push_back(nullptr);
+        }
+        children.push_back(visit(*nested));
+    }
+
+    /** @brief Check whether a comparison can be evaluated by a fused constraint node */
+    static bool isSimpleComparison(BinaryConstraintOp op) {
+        switch (op) {
+            case BinaryConstraintOp::EQ:
+            case BinaryConstraintOp::NE:
+            case BinaryConstraintOp::LT:
+            case BinaryConstraintOp::LE:
+            case BinaryConstraintOp::GT:
+            case BinaryConstraintOp::GE:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /** @brief Append the two data entries of a fused node operand, see CONSTANT_OPERAND */
+    static void encodeOperand(const RamExpression& expr, std::vector<size_t>& data) {
+        if (const auto* elem = dynamic_cast<const RamTupleElement*>(&expr)) {
+            data.push_back(elem->getTupleId());
+            data.push_back(elem->getElement());
+        } else {
+            data.push_back(CONSTANT_OPERAND);
+            data.push_back(static_cast<size_t>(static_cast<const RamConstant&>(expr).getConstant()));
+        }
+    }
+
+    /**
+     * @brief Get the source and target relation of an operation copying all tuples of a relation
+     * unchanged into another relation, e.g., merging the new tuples of a fixpoint iteration
+     */
+    static std::pair<const RamRelation*, const RamRelation*> getCopiedRelations(const RamOperation& op) {
+        const auto* scan = dynamic_cast<const RamScan*>(&op);
+        if (scan == nullptr || !scan->getProfileText().empty() ||
+                dynamic_cast<const RamMergeJoin*>(scan) != nullptr) {
+            return {nullptr, nullptr};
+        }
+        const auto* project = dynamic_cast<const RamProject*>(&scan->getOperation());
+        if (project == nullptr) {
+            return {nullptr, nullptr};
+        }
+        const RamRelation& src = scan->getRelation();
+        const RamRelation& trg = project->getRelation();
+        if (&src == &trg || src.getArity() != trg.getArity()) {
+            return {nullptr, nullptr};
+        }
+        const auto& values = project->getValues();
+        for (size_t i = 0; i < values.size(); i++) {
+            const auto* element = dynamic_cast<const RamTupleElement*>(values[i]);
+            if (element == nullptr || element->getTupleId() != scan->getTupleId() ||
+                    element->getElement() != i) {
+                return {nullptr, nullptr};
+            }
+        }
+        return {&src, &trg};
+    }
+
+    /** @brief Check whether a query reads any of the relations it inserts into */
+    static bool readsInsertedRelation(const RamQuery& query) {
+        std::set<const RamRelation*> reads;
+        visitDepthFirst(query, [&](const RamRelationOperation& op) { reads.insert(&op.getRelation()); });
+        visitDepthFirst(query, [&](const RamAbstractExistenceCheck& exists) {
+            reads.insert(&exists.getRelation());
+        });
+        visitDepthFirst(query, [&](const RamEmptinessCheck& emptiness) {
+            reads.insert(&emptiness.getRelation());
+        });
+        bool res = false;
+        visitDepthFirst(query, [&](const RamProject& project) {
+            res = res || reads.count(&project.getRelation()) > 0;
+        });
+        return res;
+    }
 
     /** @brief Reset view allocation system, since view's life time is within each query. */
     void newQueryBlock() {
@@ -520,7 +1088,17 @@ private:
         viewId = 0;
     }
 
-    /** @brief Get a valid relation id for encoding */
+    /** @brief Encode a profile text as the id of its profile counter */
+    size_t encodeProfileText(const std::string& text) {
+        auto pos = profileTable.find(text);
+        if (pos != profileTable.end()) {
+            return pos->second;
+        }
+        profileTexts.push_back(text);
+        return profileTable[text] = profileTexts.size() - 1;
+    }
+
+        /** @brief Get a valid relation id for encoding */
     size_t getNewRelId() {
         return relId++;
     }
@@ -631,6 +1209,82 @@ private:
         return conditionList;
     }
 
+    /**
+     * Check whether the outermost scan of a query can be partitioned across the ranks of a distributed
+     * evaluation, i.e., whether the query projects into non-nullary relations which it does not read,
+     * such that the ranks may derive their tuples independently
+     */
+    bool isPartitionable(const RamQuery& query, const RamOperation& outer) const {
+        if (!batchProjections || (dynamic_cast<const RamScan*>(&outer) == nullptr &&
+                                         dynamic_cast<const RamIndexScan*>(&outer) == nullptr)) {
+            return false;
+        }
+        bool nullary = false;
+        visitDepthFirst(query, [&](const RamProject& project) {
+            nullary = nullary || project.getRelation().getArity() == 0;
+        });
+        return !nullary;
+    }
+
+    /** Check whether a scan is the partitioned outermost scan of the current query, which is not fused */
+    bool isPartitionedScan(const RamTupleOperation& scan) const {
+        return partitionedQuery && scan.getTupleId() == 0;
+    }
+
+    /**
+     * Check whether the outer tuples of a scan are visited in batches, prefetching the searches of the
+     * index scan of a b-tree relation nested into it for a batch, see InterpreterEngine::prefetchScan;
+     * the bounds of the index scan are evaluated twice, and may thus have no side effects
+     */
+    bool isPrefetchedJoin(const RamTupleOperation& scan) const {
+        const auto* search = dynamic_cast<const RamIndexScan*>(&scan.getOperation());
+        if (search == nullptr || isPartitionedScan(scan) || isExternal(search->getRelation()) ||
+                (search->getRelation().getRepresentation() != RelationRepresentation::DEFAULT &&
+                        search->getRelation().getRepresentation() != RelationRepresentation::BTREE)) {
+            return false;
+        }
+        bool pure = true;
+        for (const RamExpression* value : search->getRangePattern()) {
+            visitDepthFirst(*value, [&](const RamAutoIncrement&) { pure = false; });
+            visitDepthFirst(*value, [&](const RamUserDefinedOperator&) { pure = false; });
+            visitDepthFirst(*value, [&](const RamPackRecord&) { pure = false; });
+        }
+        return pure;
+    }
+
+    /** Check whether a relation is stored in external indexes, spilling its tuples to disk */
+    bool isExternal(const RamRelation& rel) const {
+        if (isProvenance && rel.getAuxiliaryArity() > 0) {
+            return false;
+        }
+        switch (rel.getRepresentation()) {
+            case RelationRepresentation::EXTERNAL:
+                return true;
+            case RelationRepresentation::DEFAULT:
+                // read-only relations are compressed instead
+                return hasMemoryBudget && readOnlyRelations.count(&rel) == 0;
+            case RelationRepresentation::BTREE:
+                return hasMemoryBudget;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Get the columns of a relation stored in 32 bits, i.e., the columns of a 64-bit domain holding the
+     * indexes of symbols and records, whose tables do not exceed 32 bits
+     */
+    std::vector<bool> getNarrowColumns(const RamRelation& rel) const {
+        std::vector<bool> narrow(rel.getArity(), false);
+        if (RAM_DOMAIN_SIZE == 64) {
+            for (size_t i = 0; i < rel.getArity(); i++) {
+                const char kind = rel.getAttributeTypes()[i][0];
+                narrow[i] = kind == 's' || kind == 'r';
+            }
+        }
+        return narrow;
+    }
+
     void createRelation(const RamRelation& id, const MinIndexSelection& orderSet, const size_t idx) {
         RelationHandle res;
         if (relations.size() < idx + 1) {
@@ -640,14 +1294,58 @@ private:
             res = std::make_unique<InterpreterEqRelation>(id.getArity(), id.getAuxiliaryArity(), id.getName(),
                     std::vector<std::string>(), orderSet);
         } else {
-            if (isProvenance) {
+            if (isProvenance && id.getAuxiliaryArity() > 0) {
                 res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
                         id.getName(), std::vector<std::string>(), orderSet, createBTreeProvenanceIndex);
-            } else {
-                res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+            } else if (id.getRepresentation() == RelationRepresentation::MIN_LATTICE ||
+                       id.getRepresentation() == RelationRepresentation::MAX_LATTICE) {
+                res = std::make_unique<InterpreterLatticeRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet,
+                        id.getRepresentation() == RelationRepresentation::MAX_LATTICE);
+            } else if (!id.getChoiceDomain().empty()) {
+                res = std::make_unique<InterpreterChoiceRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet, id.getChoiceDomain());
+            } else if (id.getRepresentation() == RelationRepresentation::DEFAULT &&
+                       readOnlyRelations.count(&id) > 0) {
+                res = std::make_unique<InterpreterCompressedRelation>(id.getArity(), id.getAuxiliaryArity(),
                         id.getName(), std::vector<std::string>(), orderSet);
+            } else if (isExternal(id)) {
+                res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet, createExternalIndex);
+            } else if (id.getRepresentation() == RelationRepresentation::HASHSET &&
+                       orderSet.hasOnlyTotalSearches(id.getArity())) {
+                res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet, createHashIndex);
+            } else if (id.getRepresentation() == RelationRepresentation::DENSE &&
+                       id.getAuxiliaryArity() == 0 && (id.getArity() == 1 || id.getArity() == 2)) {
+                res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet, createDenseIndex);
+            } else if (id.getRepresentation() == RelationRepresentation::DEFAULT && !id.isTemp() &&
+                       id.getArity() >= 8 && Global::config().has("front-coding")) {
+                // the delta and new relations of wide relations are small, and stored in full
+                res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet, createFrontCodedIndex);
+            } else {
+                const std::vector<bool> narrow = getNarrowColumns(id);
+                if (std::count(narrow.begin(), narrow.end(), true) > 0) {
+                    res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                            id.getName(), std::vector<std::string>(), orderSet,
+                            [narrow](const Order& order) { return createNarrowIndex(order, narrow); });
+                } else {
+                    res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                            id.getName(), std::vector<std::string>(), orderSet);
+                }
+            }
+            if (id.hasBloomFilter() && !(isProvenance && id.getAuxiliaryArity() > 0) &&
+                    id.getRepresentation() != RelationRepresentation::MIN_LATTICE &&
+                    id.getRepresentation() != RelationRepresentation::MAX_LATTICE) {
+                res->createFilter(id.getSizeHint());
             }
         }
+        // the logged rules of a profiled run read the number of new tuples of the relations they write
+        if (Global::config().has("profile")) {
+            res->countInsertions();
+        }
         relations[idx] = std::make_unique<RelationHandle>(std::move(res));
     }
 };
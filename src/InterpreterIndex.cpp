@@ -16,8 +16,17 @@
 
 #include "InterpreterIndex.h"
 #include "CompiledIndexUtils.h"
+#include "CompressedSet.h"
+#include "DenseSet.h"
+#include "ExternalSet.h"
+#include "FrontCodedSet.h"
+#include "HashSet.h"
+#include "LatticeSet.h"
+#include "NarrowSet.h"
 #include "Util.h"
+#include <algorithm>
 #include <atomic>
+#include <utility>
 
 namespace souffle {
 
@@ -152,6 +161,10 @@ public:
         return present ? 1 : 0;
     }
 
+    std::size_t getMemoryUsage() const override {
+        return sizeof(*this);
+    }
+
     IndexViewPtr createView() const override {
         return std::make_unique<NullaryIndexView>(*this);
     }
@@ -208,8 +221,10 @@ public:
  * data structures.
  *
  * @tparam Structure the structure to be utilized
+ * @tparam StableElements whether iterators of the structure reference elements
+ *         stored in the structure itself, which may then be streamed without copying
  */
-template <typename Structure>
+template <typename Structure, bool StableElements = false>
 class GenericIndex : public InterpreterIndex {
 protected:
     using Entry = typename Structure::element_type;
@@ -232,15 +247,28 @@ protected:
         iter cur;
         iter end;
 
+        // the begin of the most recently loaded chunk
+        iter first;
+
         // an internal buffer for re-ordered elements
         std::array<Entry, Stream::BUFFER_SIZE> buffer;
 
     public:
         Source(const Order& order, iter begin, iter end)
-                : order(order), cur(std::move(begin)), end(std::move(end)) {}
+                : order(order), cur(std::move(begin)), end(std::move(end)), first(cur) {}
 
         int load(TupleRef* out, int max) override {
             int c = 0;
+            first = cur;
+            // elements of a natural order may be referenced in place
+            if (StableElements && order.isNatural()) {
+                while (cur != end && c < max) {
+                    out[c] = *cur;
+                    ++cur;
+                    ++c;
+                }
+                return c;
+            }
             while (cur != end && c < max) {
                 buffer[c] = order.decode(*cur);
                 out[c] = buffer[c];
@@ -253,6 +281,13 @@ protected:
         int reload(TupleRef* out, int max) override {
             int c = 0;
             max = std::min(max, Stream::BUFFER_SIZE);
+            if (StableElements && order.isNatural()) {
+                for (iter it = first; it != cur && c < max; ++it) {
+                    out[c] = *it;
+                    ++c;
+                }
+                return c;
+            }
             while (c < max) {
                 out[c] = buffer[c];
                 ++c;
@@ -261,12 +296,14 @@ protected:
         }
 
         std::unique_ptr<Stream::Source> clone() override {
-            auto source = std::make_unique<Source>(order, cur, end);
-            source->buffer = this->buffer;
-            return source;
+            // the clone re-loads the current chunk when it is wrapped into a stream
+            return std::make_unique<Source>(order, first, end);
         }
     };
 
+    // prefetches the data visited by the searches of the given lower bounds, see IndexView::prefetch
+    virtual void prefetch(const TupleRef* lows, std::size_t count, Hints& hints) const {}
+
     virtual souffle::range<iter> bounds(const TupleRef& low, const TupleRef& high, Hints& hints) const {
         Entry a = order.encode(low.asTuple<Arity>());
         Entry b = order.encode(high.asTuple<Arity>());
@@ -309,13 +346,33 @@ protected:
             return std::make_unique<Source>(index.order, range.begin(), range.end());
         }
 
+        void prefetch(const TupleRef* lows, std::size_t count) const override {
+            index.prefetch(lows, count, hints);
+        }
+
+        bool seek(const TupleRef& key, std::size_t column, RamDomain* res) const override {
+            auto pos = index.data.lower_bound(index.order.encode(key.asTuple<Arity>()), hints);
+            if (pos == index.data.end()) {
+                return false;
+            }
+            const Entry entry = index.order.decode(*pos);
+            for (std::size_t i = 0; i < Arity; i++) {
+                if (i != column && entry[i] != key[i]) {
+                    return false;
+                }
+                res[i] = entry[i];
+            }
+            return true;
+        }
+
         size_t getArity() const override {
             return Arity;
         }
     };
 
 public:
-    GenericIndex(Order order) : order(std::move(order)) {}
+    template <typename... Args>
+    GenericIndex(Order order, Args&&... args) : order(std::move(order)), data(std::forward<Args>(args)...) {}
 
     IndexViewPtr createView() const override {
         return std::make_unique<GenericIndexView>(*this);
@@ -333,6 +390,10 @@ public:
         return data.size();
     }
 
+    std::size_t getMemoryUsage() const override {
+        return sizeof(*this) - sizeof(data) + data.getMemoryUsage();
+    }
+
     bool insert(const TupleRef& tuple) override {
         return data.insert(order.encode(tuple.asTuple<Arity>()));
     }
@@ -376,7 +437,7 @@ public:
         auto range = bounds(low, high, hints);
         std::vector<Stream> res;
         res.reserve(partitionCount);
-        for (const auto& cur : range.partition(partitionCount)) {
+        for (const auto& cur : range.partition(partitionCount, MIN_CHUNK_TUPLES)) {
             res.push_back(std::make_unique<Source>(order, cur.begin(), cur.end()));
         }
         return res;
@@ -387,65 +448,113 @@ public:
     }
 };
 
+// The hint statistics of a b-tree, which are only recorded if hints profiling is enabled
+template <typename Statistics>
+HintStatistics getBTreeHintStatistics(const Statistics& stats) {
+    if (!isHintsProfilingEnabled()) {
+        return {};
+    }
+    return {{"insert", {stats.inserts.getHits(), stats.inserts.getMisses()}},
+            {"contains", {stats.contains.getHits(), stats.contains.getMisses()}},
+            {"lower-bound", {stats.lower_bound.getHits(), stats.lower_bound.getMisses()}},
+            {"upper-bound", {stats.upper_bound.getHits(), stats.upper_bound.getMisses()}}};
+}
+
 /* B-Tree Indirect indexes */
 class IndirectIndex : public InterpreterIndex {
 public:
-    /* lexicographical comparison operation on two tuple pointers */
+    /* the number of leading columns of the order stored inline in the entries of the index */
+    static constexpr std::size_t PREFIX = 2;
+
+    /*
+     * an entry of the index, referencing a tuple of the relation and holding the leading columns of
+     * the tuple in the order of the index, such that comparisons only dereference tuples on ties
+     */
+    struct Entry {
+        std::array<RamDomain, PREFIX> prefix;
+        const RamDomain* base;
+    };
+
+    /* lexicographical comparison operation on two entries */
     struct comparator {
         const std::vector<int> order;
+        const std::size_t prefixLength;
 
         /* constructor to initialize state */
-        comparator(std::vector<int> order) : order(std::move(order)) {}
+        comparator(std::vector<int> order)
+                : order(std::move(order)), prefixLength(std::min(this->order.size(), PREFIX)) {}
 
         /* comparison function */
-        int operator()(const TupleRef& x, const TupleRef& y) const {
-            for (auto& i : order) {
-                if (x[i] < y[i]) {
-                    return -1;
+        int operator()(const Entry& x, const Entry& y) const {
+            for (std::size_t i = 0; i < prefixLength; i++) {
+                if (x.prefix[i] != y.prefix[i]) {
+                    return x.prefix[i] < y.prefix[i] ? -1 : 1;
                 }
-                if (x[i] > y[i]) {
-                    return 1;
+            }
+            for (std::size_t i = prefixLength; i < order.size(); i++) {
+                const RamDomain a = x.base[order[i]];
+                const RamDomain b = y.base[order[i]];
+                if (a != b) {
+                    return a < b ? -1 : 1;
                 }
             }
             return 0;
         }
 
         /* less comparison */
-        bool less(const TupleRef& x, const TupleRef& y) const {
+        bool less(const Entry& x, const Entry& y) const {
             return operator()(x, y) < 0;
         }
 
         /* equal comparison */
-        bool equal(const TupleRef& x, const TupleRef& y) const {
-            for (auto& i : order) {
-                if (x[i] != y[i]) {
+        bool equal(const Entry& x, const Entry& y) const {
+            for (std::size_t i = 0; i < prefixLength; i++) {
+                if (x.prefix[i] != y.prefix[i]) {
+                    return false;
+                }
+            }
+            for (std::size_t i = prefixLength; i < order.size(); i++) {
+                if (x.base[order[i]] != y.base[order[i]]) {
                     return false;
                 }
             }
             return true;
         }
+
+        /* the entry of a tuple, which has to outlive the entry */
+        Entry entry(const TupleRef& tuple) const {
+            Entry res{};
+            for (std::size_t i = 0; i < prefixLength; i++) {
+                res.prefix[i] = tuple[order[i]];
+            }
+            res.base = tuple.getBase();
+            return res;
+        }
     };
 
-    /* btree for storing tuple pointers with a given lexicographical order */
-    using index_set = btree_multiset<TupleRef, comparator, std::allocator<TupleRef>, 512>;
+    /* btree for storing entries with a given lexicographical order */
+    using index_set = btree_multiset<Entry, comparator, std::allocator<Entry>, 512>;
     using Hints = typename index_set::operation_hints;
 
     class Source : public Stream::Source {
         // the begin and end of the stream
-        using iter = btree_multiset<TupleRef, comparator, std::allocator<TupleRef>, 512>::iterator;
+        using iter = index_set::iterator;
         iter cur;
         iter end;
 
+        // the arity of the referenced tuples
+        std::size_t arity;
+
         // an internal buffer for re-ordered elements
         std::array<TupleRef, Stream::BUFFER_SIZE> buffer;
 
     public:
-        Source(iter begin, iter end) : cur(begin), end(end) {}
+        Source(iter begin, iter end, std::size_t arity) : cur(begin), end(end), arity(arity) {}
 
         int load(TupleRef* out, int max) override {
             int c = 0;
             while (cur != end && c < max) {
-                buffer[c] = *cur;
+                buffer[c] = TupleRef((*cur).base, arity);
                 out[c] = buffer[c];
                 ++cur;
                 ++c;
@@ -464,7 +573,7 @@ public:
         }
 
         std::unique_ptr<Stream::Source> clone() override {
-            auto* source = new Source(cur, end);
+            auto* source = new Source(cur, end, arity);
             source->buffer = this->buffer;
             return std::unique_ptr<Stream::Source>(source);
         }
@@ -478,7 +587,7 @@ public:
         IndirectIndexView(const IndirectIndex& index) : index(index) {}
 
         bool contains(const TupleRef& tuple) const override {
-            return index.set.contains(tuple, hints);
+            return index.set.contains(index.entry(tuple), hints);
         }
 
         bool contains(const TupleRef& low, const TupleRef& high) const override {
@@ -487,8 +596,23 @@ public:
         }
 
         Stream range(const TupleRef& low, const TupleRef& high) const override {
-            return std::make_unique<Source>(
-                    index.set.lower_bound(low, hints), index.set.upper_bound(high, hints));
+            return std::make_unique<Source>(index.set.lower_bound(index.entry(low), hints),
+                    index.set.upper_bound(index.entry(high), hints), index.arity);
+        }
+
+        bool seek(const TupleRef& key, std::size_t column, RamDomain* res) const override {
+            auto pos = index.set.lower_bound(index.entry(key), hints);
+            if (pos == index.set.end()) {
+                return false;
+            }
+            const TupleRef entry((*pos).base, key.size());
+            for (std::size_t i = 0; i < entry.size(); i++) {
+                if (i != column && entry[i] != key[i]) {
+                    return false;
+                }
+                res[i] = entry[i];
+            }
+            return true;
         }
 
         size_t getArity() const override {
@@ -497,8 +621,7 @@ public:
     };
 
     IndirectIndex(std::vector<int> order)
-            : theOrder(std::move(order)), set(comparator(theOrder), comparator(theOrder)),
-              arity(order.size()) {}
+            : theOrder(std::move(order)), comp(theOrder), set(comp, comp), arity(theOrder.size()) {}
 
     IndexViewPtr createView() const override {
         return std::make_unique<IndirectIndexView>(*this);
@@ -516,8 +639,16 @@ public:
         return set.size();
     }
 
+    size_t getMemoryUsage() const override {
+        return sizeof(*this) - sizeof(set) + set.getMemoryUsage();
+    }
+
+    HintStatistics getHintStatistics() const override {
+        return getBTreeHintStatistics(set.getHintStatistics());
+    }
+
     bool insert(const TupleRef& tuple) override {
-        return set.insert(tuple, operation_hints);
+        return set.insert(entry(tuple), operation_hints);
     }
 
     void insert(const InterpreterIndex& src) override {
@@ -535,7 +666,7 @@ public:
     }
 
     Stream scan() const override {
-        return std::make_unique<Source>(set.begin(), set.end());
+        return std::make_unique<Source>(set.begin(), set.end(), arity);
     }
 
     PartitionedStream partitionScan(int) const override {
@@ -564,13 +695,21 @@ private:
     /** retain the index order used to construct an object of this class */
     const std::vector<int> theOrder;
 
-    /** set storing tuple pointers of table */
+    /** comparator of the entries, also deriving the entries of tuples */
+    const comparator comp;
+
+    /** the entry of a tuple of the relation, or of a search key */
+    Entry entry(const TupleRef& tuple) const {
+        return comp.entry(tuple);
+    }
+
+    /** set storing the entries of the tuples of the table */
     index_set set;
 
     /** Operation hints */
     index_set::btree_operation_hints<1> operation_hints;
 
-    /** Arity as the relation arity, not necessary the order size in indirect index */
+    /** Arity of the relation, the size of the total order of the index */
     size_t arity;
 };
 
@@ -595,9 +734,59 @@ struct InterpreterProvenanceUpdater {
  * A index adapter for B-trees, using the generic index adapter.
  */
 template <std::size_t Arity>
-class BTreeIndex : public GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>> {
+class BTreeIndex : public GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>, true> {
 public:
-    using GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>>::GenericIndex;
+    using GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>, true>::GenericIndex;
+
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override {
+        std::vector<t_tuple<Arity>> entries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            entries[i] = this->order.encode(TupleRef(tuples + i * stride, Arity).asTuple<Arity>());
+        }
+        this->data.insertBulk(std::move(entries));
+    }
+
+    /**
+     * The tuples of a batch are inserted in the order of the index, sharing the insertion hints, such
+     * that runs of tuples falling into the same leaf are merged without searching the tree
+     */
+    void insertBatch(
+            const RamDomain* tuples, std::size_t count, std::size_t stride, bool* inserted) override {
+        std::vector<std::pair<t_tuple<Arity>, std::size_t>> entries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            entries[i] = {this->order.encode(TupleRef(tuples + i * stride, Arity).asTuple<Arity>()), i};
+        }
+        auto less = [](const std::pair<t_tuple<Arity>, std::size_t>& a,
+                            const std::pair<t_tuple<Arity>, std::size_t>& b) {
+            return comparator<Arity>().less(a.first, b.first);
+        };
+        if (!std::is_sorted(entries.begin(), entries.end(), less)) {
+            parallelSort(entries.begin(), entries.end(), less);
+        }
+        typename BTreeIndex::Hints hints;
+        for (const auto& entry : entries) {
+            inserted[entry.second] = this->data.insert(entry.first, hints);
+        }
+    }
+
+    HintStatistics getHintStatistics() const override {
+        return getBTreeHintStatistics(this->data.getHintStatistics());
+    }
+
+    void compact() override {
+        this->data.compact();
+    }
+
+    void prefetch(const TupleRef* lows, std::size_t count, typename BTreeIndex::Hints& hints) const override {
+        std::array<t_tuple<Arity>, btree_set<t_tuple<Arity>>::PREFETCH_BATCH> keys;
+        for (std::size_t begin = 0; begin < count; begin += keys.size()) {
+            const std::size_t num = std::min(count - begin, keys.size());
+            for (std::size_t i = 0; i < num; ++i) {
+                keys[i] = this->order.encode(lows[begin + i].asTuple<Arity>());
+            }
+            this->data.prefetch(keys.data(), num, hints);
+        }
+    }
 };
 
 /**
@@ -612,6 +801,10 @@ public:
     using GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t_tuple<Arity>>, 256,
             typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - 2>,
             InterpreterProvenanceUpdater<Arity>>>::GenericIndex;
+
+    HintStatistics getHintStatistics() const override {
+        return getBTreeHintStatistics(this->data.getHintStatistics());
+    }
 };
 
 /**
@@ -621,6 +814,16 @@ template <std::size_t Arity>
 class BrieIndex : public GenericIndex<Trie<Arity>> {
 public:
     using GenericIndex<Trie<Arity>>::GenericIndex;
+
+    HintStatistics getHintStatistics() const override {
+        if (!isHintsProfilingEnabled()) {
+            return {};
+        }
+        const auto& stats = this->data.getHintStatistics();
+        return {{"insert", {stats.inserts.getHits(), stats.inserts.getMisses()}},
+                {"contains", {stats.contains.getHits(), stats.contains.getMisses()}},
+                {"boundaries", {stats.get_boundaries.getHits(), stats.get_boundaries.getMisses()}}};
+    }
 };
 
 /**
@@ -636,6 +839,22 @@ public:
         this->data.extend(otherIndex->data);
     }
 
+    /** The pairs are unioned in bulk, as the columns of an equivalence relation are interchangeable */
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override {
+        this->data.insertBulk(tuples, count, stride);
+    }
+
+    /** A pair is new if it is not contained before the batch, though it may be implied by the batch */
+    void insertBatch(
+            const RamDomain* tuples, std::size_t count, std::size_t stride, bool* inserted) override {
+        PARALLEL_START
+            pfor(std::size_t i = 0; i < count; ++i) {
+                inserted[i] = !this->data.contains(tuples[i * stride], tuples[i * stride + 1]);
+            }
+        PARALLEL_END
+        this->data.insertBulk(tuples, count, stride);
+    }
+
 protected:
     souffle::range<iter> bounds(const TupleRef& low, const TupleRef& high, Hints& hints) const override {
         Entry a = order.encode(low.asTuple<Arity>());
@@ -643,6 +862,205 @@ protected:
     }
 };
 
+/**
+ * A hash set adapted to the generic index, which resolves total searches by lookups.
+ */
+template <std::size_t Arity>
+struct HashIndexSet : public HashSet<t_tuple<Arity>> {
+    using typename HashSet<t_tuple<Arity>>::iterator;
+    using typename HashSet<t_tuple<Arity>>::operation_hints;
+
+    iterator lower_bound(const t_tuple<Arity>& /* key */, operation_hints& /* hints */) const {
+        assert(false && "Hash index does not support range queries");
+        return this->end();
+    }
+};
+
+/**
+ * A index adapter for hash sets, using the generic index adapter. A hash index
+ * only supports full scans and searches binding all attributes.
+ */
+template <std::size_t Arity>
+class HashIndex : public GenericIndex<HashIndexSet<Arity>> {
+    using Base = GenericIndex<HashIndexSet<Arity>>;
+
+public:
+    using Base::GenericIndex;
+
+protected:
+    souffle::range<typename Base::iter> bounds(
+            const TupleRef& low, const TupleRef& high, typename Base::Hints& hints) const override {
+        typename Base::Entry a = this->order.encode(low.asTuple<Arity>());
+        typename Base::Entry b = this->order.encode(high.asTuple<Arity>());
+        // searches binding all attributes are lookups, all other searches are full scans
+        if (a != b) {
+            return {this->data.begin(), this->data.end()};
+        }
+        auto pos = this->data.find(a, hints);
+        auto fin = this->data.end();
+        if (pos != fin) {
+            fin = pos;
+            ++fin;
+        }
+        return {pos, fin};
+    }
+};
+
+/**
+ * Index adapters for dense sets and adjacency sets, using the generic index adapter. The index of
+ * the inverse order of a binary relation is its reverse adjacency.
+ */
+using DenseIndex = GenericIndex<DenseSet>;
+using AdjacencyIndex = GenericIndex<AdjacencySet>;
+
+/**
+ * A index adapter for compressed sets, using the generic index adapter. A compressed
+ * index is filled by bulk inserts, intended for relations which are only read once loaded.
+ */
+template <std::size_t Arity>
+class CompressedIndex : public GenericIndex<CompressedSet<t_tuple<Arity>>> {
+    using Base = GenericIndex<CompressedSet<t_tuple<Arity>>>;
+
+public:
+    using Base::GenericIndex;
+
+    void insert(const InterpreterIndex& src) override {
+        std::vector<t_tuple<Arity>> entries;
+        for (const auto& cur : src.scan()) {
+            entries.push_back(this->order.encode(cur.template asTuple<Arity>()));
+        }
+        this->data.insertBulk(std::move(entries));
+    }
+
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override {
+        std::vector<t_tuple<Arity>> entries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            entries[i] = this->order.encode(TupleRef(tuples + i * stride, Arity).asTuple<Arity>());
+        }
+        this->data.insertBulk(std::move(entries));
+    }
+};
+
+/**
+ * A index adapter for front coded sets, using the generic index adapter. Many tuples inserted at
+ * once, e.g. loaded or merged from another relation, are merged with the present ones in bulk.
+ */
+template <std::size_t Arity>
+class FrontCodedIndex : public GenericIndex<FrontCodedSet<t_tuple<Arity>>> {
+    using Base = GenericIndex<FrontCodedSet<t_tuple<Arity>>>;
+
+public:
+    using Base::GenericIndex;
+
+    void insert(const InterpreterIndex& src) override {
+        std::vector<t_tuple<Arity>> entries;
+        for (const auto& cur : src.scan()) {
+            entries.push_back(this->order.encode(cur.template asTuple<Arity>()));
+        }
+        this->data.insertBulk(std::move(entries));
+    }
+
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override {
+        std::vector<t_tuple<Arity>> entries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            entries[i] = this->order.encode(TupleRef(tuples + i * stride, Arity).asTuple<Arity>());
+        }
+        this->data.insertBulk(std::move(entries));
+    }
+
+    void compact() override {
+        this->data.compact();
+    }
+};
+
+/**
+ * A index adapter for narrow sets, using the generic index adapter. The narrow columns of the
+ * relation are located within the encoded tuples by the order of the index.
+ */
+template <std::size_t Arity, std::size_t Words>
+class NarrowIndex : public GenericIndex<NarrowSet<t_tuple<Arity>, Words>> {
+    using Base = GenericIndex<NarrowSet<t_tuple<Arity>, Words>>;
+
+    static std::vector<bool> encodeColumns(const Order& order, const std::vector<bool>& narrow) {
+        std::vector<bool> res(Arity);
+        for (std::size_t i = 0; i < Arity; ++i) {
+            res[i] = narrow[order.getOrder()[i]];
+        }
+        return res;
+    }
+
+public:
+    NarrowIndex(const Order& order, const std::vector<bool>& narrow)
+            : Base(order, encodeColumns(order, narrow)) {}
+
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override {
+        std::vector<t_tuple<Arity>> entries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            entries[i] = this->order.encode(TupleRef(tuples + i * stride, Arity).asTuple<Arity>());
+        }
+        this->data.insertBulk(entries);
+    }
+
+    /** The tuples of a batch tend to be close to each other, hence they share the insertion hints */
+    void insertBatch(
+            const RamDomain* tuples, std::size_t count, std::size_t stride, bool* inserted) override {
+        typename Base::Hints hints;
+        for (std::size_t i = 0; i < count; ++i) {
+            inserted[i] = this->data.insert(
+                    this->order.encode(TupleRef(tuples + i * stride, Arity).asTuple<Arity>()), hints);
+        }
+    }
+
+    HintStatistics getHintStatistics() const override {
+        return getBTreeHintStatistics(this->data.getHintStatistics());
+    }
+
+    void compact() override {
+        this->data.compact();
+    }
+};
+
+/**
+ * A index adapter for lattice sets, using the generic index adapter. The value of a tuple is held
+ * by its last column, which is located within the encoded tuples by the order of the index.
+ */
+template <std::size_t Arity, bool Max>
+class LatticeIndex : public GenericIndex<LatticeSet<t_tuple<Arity>>> {
+    using Base = GenericIndex<LatticeSet<t_tuple<Arity>>>;
+
+    // the position of the last column within the given order
+    static std::size_t getValueColumn(const Order& order) {
+        const auto& columns = order.getOrder();
+        return std::find(columns.begin(), columns.end(), int(Arity - 1)) - columns.begin();
+    }
+
+public:
+    LatticeIndex(const Order& order) : Base(order, getValueColumn(order), Max) {}
+
+    void extend(InterpreterIndex* other) override {
+        auto otherIndex = dynamic_cast<LatticeIndex*>(other);
+        assert(otherIndex != nullptr && "Can only extend to LatticeIndex");
+        // the indexes may order their columns differently
+        this->data.discard([&](const t_tuple<Arity>& cur) {
+            return otherIndex->data.subsumes(otherIndex->order.encode(this->order.decode(cur)));
+        });
+    }
+};
+
+/**
+ * A index adapter for external sets, using the generic index adapter. The buffer of an external
+ * index is spilled to disk between statements only, when no other operation accesses the index.
+ */
+template <std::size_t Arity>
+class ExternalIndex : public GenericIndex<ExternalSet<t_tuple<Arity>>> {
+public:
+    using GenericIndex<ExternalSet<t_tuple<Arity>>>::GenericIndex;
+
+    void spill() override {
+        this->data.spill();
+    }
+};
+
 std::unique_ptr<InterpreterIndex> createBTreeIndex(const Order& order) {
     switch (order.size()) {
         case 0:
@@ -676,6 +1094,46 @@ std::unique_ptr<InterpreterIndex> createBTreeIndex(const Order& order) {
     return {};
 }
 
+#if RAM_DOMAIN_SIZE == 64
+// Creates a narrow index whose elements occupy at least the given number of words
+template <std::size_t Arity, std::size_t Words = Arity>
+std::unique_ptr<InterpreterIndex> createNarrowIndex(
+        const Order& order, const std::vector<bool>& narrow, std::size_t words) {
+    // at least one column of a narrow index is narrow
+    if constexpr (Words + 1 < 2 * Arity) {
+        if (words > Words) {
+            return createNarrowIndex<Arity, Words + 1>(order, narrow, words);
+        }
+    }
+    return std::make_unique<NarrowIndex<Arity, Words>>(order, narrow);
+}
+#endif
+
+std::unique_ptr<InterpreterIndex> createNarrowIndex(const Order& order, const std::vector<bool>& narrow) {
+    assert(narrow.size() == order.size() && "arity mismatch of narrow columns");
+#if RAM_DOMAIN_SIZE == 64
+    const std::size_t words = 2 * order.size() - std::count(narrow.begin(), narrow.end(), true);
+    if (words < 2 * order.size()) {
+        switch (order.size()) {
+            case 1:
+                return createNarrowIndex<1>(order, narrow, words);
+            case 2:
+                return createNarrowIndex<2>(order, narrow, words);
+            case 3:
+                return createNarrowIndex<3>(order, narrow, words);
+            case 4:
+                return createNarrowIndex<4>(order, narrow, words);
+            case 5:
+                return createNarrowIndex<5>(order, narrow, words);
+            case 6:
+                return createNarrowIndex<6>(order, narrow, words);
+        }
+    }
+#endif
+    // the columns of a 32-bit domain are narrow anyway, and wider relations are stored in full
+    return createBTreeIndex(order);
+}
+
 std::unique_ptr<InterpreterIndex> createBTreeProvenanceIndex(const Order& order) {
     switch (order.size()) {
         case 0:
@@ -745,6 +1203,193 @@ std::unique_ptr<InterpreterIndex> createBrieIndex(const Order& order) {
     return {};
 }
 
+std::unique_ptr<InterpreterIndex> createHashIndex(const Order& order) {
+    switch (order.size()) {
+        case 0:
+            return std::make_unique<NullaryIndex>();
+        case 1:
+            return std::make_unique<HashIndex<1>>(order);
+        case 2:
+            return std::make_unique<HashIndex<2>>(order);
+        case 3:
+            return std::make_unique<HashIndex<3>>(order);
+        case 4:
+            return std::make_unique<HashIndex<4>>(order);
+        case 5:
+            return std::make_unique<HashIndex<5>>(order);
+        case 6:
+            return std::make_unique<HashIndex<6>>(order);
+        case 7:
+            return std::make_unique<HashIndex<7>>(order);
+        case 8:
+            return std::make_unique<HashIndex<8>>(order);
+        case 9:
+            return std::make_unique<HashIndex<9>>(order);
+        case 10:
+            return std::make_unique<HashIndex<10>>(order);
+        case 11:
+            return std::make_unique<HashIndex<11>>(order);
+        case 12:
+            return std::make_unique<HashIndex<12>>(order);
+    }
+    assert(false && "Requested arity not yet supported. Feel free to add it.");
+    return {};
+}
+
+std::unique_ptr<InterpreterIndex> createDenseIndex(const Order& order) {
+    switch (order.size()) {
+        case 0:
+            return std::make_unique<NullaryIndex>();
+        case 1:
+            return std::make_unique<DenseIndex>(order);
+        case 2:
+            return std::make_unique<AdjacencyIndex>(order);
+    }
+    assert(false && "Dense indexes are only supported for unary and binary relations.");
+    return {};
+}
+
+std::unique_ptr<InterpreterIndex> createCompressedIndex(const Order& order) {
+    switch (order.size()) {
+        case 0:
+            return std::make_unique<NullaryIndex>();
+        case 1:
+            return std::make_unique<CompressedIndex<1>>(order);
+        case 2:
+            return std::make_unique<CompressedIndex<2>>(order);
+        case 3:
+            return std::make_unique<CompressedIndex<3>>(order);
+        case 4:
+            return std::make_unique<CompressedIndex<4>>(order);
+        case 5:
+            return std::make_unique<CompressedIndex<5>>(order);
+        case 6:
+            return std::make_unique<CompressedIndex<6>>(order);
+        case 7:
+            return std::make_unique<CompressedIndex<7>>(order);
+        case 8:
+            return std::make_unique<CompressedIndex<8>>(order);
+        case 9:
+            return std::make_unique<CompressedIndex<9>>(order);
+        case 10:
+            return std::make_unique<CompressedIndex<10>>(order);
+        case 11:
+            return std::make_unique<CompressedIndex<11>>(order);
+        case 12:
+            return std::make_unique<CompressedIndex<12>>(order);
+    }
+    assert(false && "Requested arity not yet supported. Feel free to add it.");
+    return {};
+}
+
+std::unique_ptr<InterpreterIndex> createFrontCodedIndex(const Order& order) {
+    switch (order.size()) {
+        case 0:
+            return std::make_unique<NullaryIndex>();
+        case 1:
+            return std::make_unique<FrontCodedIndex<1>>(order);
+        case 2:
+            return std::make_unique<FrontCodedIndex<2>>(order);
+        case 3:
+            return std::make_unique<FrontCodedIndex<3>>(order);
+        case 4:
+            return std::make_unique<FrontCodedIndex<4>>(order);
+        case 5:
+            return std::make_unique<FrontCodedIndex<5>>(order);
+        case 6:
+            return std::make_unique<FrontCodedIndex<6>>(order);
+        case 7:
+            return std::make_unique<FrontCodedIndex<7>>(order);
+        case 8:
+            return std::make_unique<FrontCodedIndex<8>>(order);
+        case 9:
+            return std::make_unique<FrontCodedIndex<9>>(order);
+        case 10:
+            return std::make_unique<FrontCodedIndex<10>>(order);
+        case 11:
+            return std::make_unique<FrontCodedIndex<11>>(order);
+        case 12:
+            return std::make_unique<FrontCodedIndex<12>>(order);
+    }
+    assert(false && "Requested arity not yet supported. Feel free to add it.");
+    return {};
+}
+
+std::unique_ptr<InterpreterIndex> createExternalIndex(const Order& order) {
+    switch (order.size()) {
+        case 0:
+            return std::make_unique<NullaryIndex>();
+        case 1:
+            return std::make_unique<ExternalIndex<1>>(order);
+        case 2:
+            return std::make_unique<ExternalIndex<2>>(order);
+        case 3:
+            return std::make_unique<ExternalIndex<3>>(order);
+        case 4:
+            return std::make_unique<ExternalIndex<4>>(order);
+        case 5:
+            return std::make_unique<ExternalIndex<5>>(order);
+        case 6:
+            return std::make_unique<ExternalIndex<6>>(order);
+        case 7:
+            return std::make_unique<ExternalIndex<7>>(order);
+        case 8:
+            return std::make_unique<ExternalIndex<8>>(order);
+        case 9:
+            return std::make_unique<ExternalIndex<9>>(order);
+        case 10:
+            return std::make_unique<ExternalIndex<10>>(order);
+        case 11:
+            return std::make_unique<ExternalIndex<11>>(order);
+        case 12:
+            return std::make_unique<ExternalIndex<12>>(order);
+    }
+    assert(false && "Requested arity not yet supported. Feel free to add it.");
+    return {};
+}
+
+namespace {
+template <bool Max>
+std::unique_ptr<InterpreterIndex> createLatticeIndex(const Order& order) {
+    switch (order.size()) {
+        case 1:
+            return std::make_unique<LatticeIndex<1, Max>>(order);
+        case 2:
+            return std::make_unique<LatticeIndex<2, Max>>(order);
+        case 3:
+            return std::make_unique<LatticeIndex<3, Max>>(order);
+        case 4:
+            return std::make_unique<LatticeIndex<4, Max>>(order);
+        case 5:
+            return std::make_unique<LatticeIndex<5, Max>>(order);
+        case 6:
+            return std::make_unique<LatticeIndex<6, Max>>(order);
+        case 7:
+            return std::make_unique<LatticeIndex<7, Max>>(order);
+        case 8:
+            return std::make_unique<LatticeIndex<8, Max>>(order);
+        case 9:
+            return std::make_unique<LatticeIndex<9, Max>>(order);
+        case 10:
+            return std::make_unique<LatticeIndex<10, Max>>(order);
+        case 11:
+            return std::make_unique<LatticeIndex<11, Max>>(order);
+        case 12:
+            return std::make_unique<LatticeIndex<12, Max>>(order);
+    }
+    assert(false && "Requested arity not yet supported. Feel free to add it.");
+    return {};
+}
+}  // namespace
+
+std::unique_ptr<InterpreterIndex> createMinLatticeIndex(const Order& order) {
+    return createLatticeIndex<false>(order);
+}
+
+std::unique_ptr<InterpreterIndex> createMaxLatticeIndex(const Order& order) {
+    return createLatticeIndex<true>(order);
+}
+
 std::unique_ptr<InterpreterIndex> createIndirectIndex(const Order& order) {
     assert(order.size() != 0 && "IndirectIndex does not work with nullary relation\n");
     return std::make_unique<IndirectIndex>(order.getOrder());
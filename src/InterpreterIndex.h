@@ -22,9 +22,12 @@
 #include "Util.h"
 
 #include <array>
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -132,10 +135,16 @@ public:
 class Order {
     std::vector<int> order;
 
+    // whether this order is the natural order, making encoding and decoding the identity
+    bool natural = true;
+
 public:
     Order() = default;
     Order(std::vector<int> pos) : order(std::move(pos)) {
         assert(valid());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            natural = natural && order[i] == int(i);
+        }
     }
 
     // Creates a natural order for the given arity.
@@ -148,8 +157,18 @@ public:
      */
     bool valid() const;
 
+    /**
+     * Determines whether this order is the natural order of its components.
+     */
+    bool isNatural() const {
+        return natural;
+    }
+
     template <std::size_t Arity>
     ram::Tuple<RamDomain, Arity> encode(const ram::Tuple<RamDomain, Arity>& entry) const {
+        if (natural) {
+            return entry;
+        }
         ram::Tuple<RamDomain, Arity> res{};
         for (std::size_t i = 0; i < Arity; ++i) {
             res[i] = entry[order[i]];
@@ -159,6 +178,9 @@ public:
 
     template <std::size_t Arity>
     ram::Tuple<RamDomain, Arity> decode(const ram::Tuple<RamDomain, Arity>& entry) const {
+        if (natural) {
+            return entry;
+        }
         ram::Tuple<RamDomain, Arity> res{};
         for (std::size_t i = 0; i < Arity; ++i) {
             res[order[i]] = entry[i];
@@ -197,7 +219,8 @@ public:
          * Requests the source to retrieve the next set of elements,
          * to be stored in an array addressed by the first parameter.
          * The second parameter states an upper limit for the number
-         * of elements to be retrieved.
+         * of elements to be retrieved. Fewer elements than requested
+         * are only retrieved once the end has been reached.
          *
          * @return the number of elements retrieved, 0 if end has reached.
          */
@@ -231,6 +254,9 @@ private:
     // the end of valid elements in the buffer
     int limit = 0;
 
+    // whether the source has been drained, such that it is not asked for a further chunk
+    bool exhausted = false;
+
 public:
     Stream(std::unique_ptr<Source>&& src) : source(std::move(src)) {
         loadNext();
@@ -243,7 +269,8 @@ public:
     Stream& operator=(Stream& other) = delete;
 
     Stream(Stream&& other)
-            : source(std::move(other.source)), buffer(other.buffer), cur(other.cur), limit(other.limit) {}
+            : source(std::move(other.source)), buffer(other.buffer), cur(other.cur), limit(other.limit),
+              exhausted(other.exhausted) {}
 
     Stream& operator=(Stream&& other) {
         source = std::move(other.source);
@@ -252,6 +279,7 @@ public:
                 &buffer[other.cur], &other.buffer[other.cur], sizeof(TupleRef) * (other.limit - other.cur));
         cur = other.cur;
         limit = other.limit;
+        exhausted = other.exhausted;
         return *this;
     }
 
@@ -266,6 +294,7 @@ public:
         newStream->source->reload(&newStream->buffer[0], limit);
         newStream->cur = cur;
         newStream->limit = limit;
+        newStream->exhausted = exhausted;
         return newStream;
     }
 
@@ -320,11 +349,18 @@ public:
 
 private:
     /**
-     * Retrieves the next chunk of elements from the source.
+     * Retrieves the next chunk of elements from the source. A chunk shorter than the buffer is the
+     * last one, hence streams of up to a buffer's worth of elements, e.g., most range queries, call
+     * the virtual refill of their source only once.
      */
     void loadNext() {
-        limit = source->load(&buffer[0], BUFFER_SIZE);
         cur = 0;
+        if (exhausted) {
+            limit = 0;
+            return;
+        }
+        limit = source->load(&buffer[0], BUFFER_SIZE);
+        exhausted = limit < BUFFER_SIZE;
     }
 };
 
@@ -351,6 +387,11 @@ public:
     iterator end() {
         return streams.end();
     }
+
+    /** Return the number of streams of the partition */
+    size_t size() const {
+        return streams.size();
+    }
 };
 
 /**
@@ -375,6 +416,39 @@ public:
      */
     virtual Stream range(const TupleRef& low, const TupleRef& high) const = 0;
 
+    /**
+     * Seeks the least entry agreeing with the given key on all but the given
+     * column whose value in that column is not less than the one of the key.
+     * The entries agreeing on the other columns are required to be ordered by
+     * the given column, as they are in an index on the other columns.
+     *
+     * @param key the key to seek
+     * @param column the column to advance
+     * @param res the buffer receiving the entry found
+     * @return true if such an entry exists
+     */
+    virtual bool seek(const TupleRef& key, std::size_t column, RamDomain* res) const {
+        const std::size_t arity = key.size();
+        RamDomain high[arity];
+        for (std::size_t i = 0; i < arity; i++) {
+            high[i] = key[i];
+        }
+        high[column] = MAX_RAM_DOMAIN;
+        for (const auto& cur : range(key, TupleRef(high, arity))) {
+            for (std::size_t i = 0; i < arity; i++) {
+                res[i] = cur[i];
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Prefetches the data visited by the searches of the ranges starting at the given lower bounds,
+     * which are about to be searched, if the index benefits from doing so.
+     */
+    virtual void prefetch(const TupleRef* lows, std::size_t count) const {}
+
     /**
      * Return arity size of the index
      */
@@ -386,6 +460,9 @@ public:
 // A general handler type for index views.
 using IndexViewPtr = std::unique_ptr<IndexView>;
 
+// The hits and misses of the operation hints of an index, keyed by the kind of operation.
+using HintStatistics = std::map<std::string, std::array<std::size_t, 2>>;
+
 /**
  * An index is an abstraction of a data structure
  */
@@ -398,6 +475,21 @@ public:
      */
     virtual IndexViewPtr createView() const = 0;
 
+    /**
+     * Obtains the version of the storage of this index. The version is unique among all indexes,
+     * and changes whenever the index may release storage the hints of its views refer to.
+     */
+    std::size_t getVersion() const {
+        return version;
+    }
+
+    /**
+     * Marks the storage of this index as released, invalidating the views created before.
+     */
+    void invalidateViews() {
+        version = nextVersion();
+    }
+
     /**
      * Obtains the arity of the given index.
      */
@@ -413,6 +505,19 @@ public:
      */
     virtual std::size_t size() const = 0;
 
+    /**
+     * Obtains an estimate of the number of bytes of memory occupied by this index.
+     */
+    virtual std::size_t getMemoryUsage() const = 0;
+
+    /**
+     * Obtains the hits and misses of the operation hints of this index. They are only recorded
+     * if hints profiling is enabled, and only by indexes utilising hints.
+     */
+    virtual HintStatistics getHintStatistics() const {
+        return {};
+    }
+
     /**
      * Inserts a tuple into this index.
      */
@@ -423,6 +528,25 @@ public:
      */
     virtual void insert(const InterpreterIndex& src) = 0;
 
+    /**
+     * Inserts count tuples, in arbitrary order, stored consecutively with the given stride.
+     */
+    virtual void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) {
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(TupleRef(tuples + i * stride, getArity()));
+        }
+    }
+
+    /**
+     * Inserts count tuples stored consecutively with the given stride, one after the other,
+     * recording in inserted whether each of them was new.
+     */
+    virtual void insertBatch(const RamDomain* tuples, std::size_t count, std::size_t stride, bool* inserted) {
+        for (std::size_t i = 0; i < count; ++i) {
+            inserted[i] = insert(TupleRef(tuples + i * stride, getArity()));
+        }
+    }
+
     /**
      * Tests whether the given tuple is present in this index or not.
      */
@@ -449,7 +573,8 @@ public:
     virtual Stream range(const TupleRef& low, const TupleRef& high) const = 0;
 
     /**
-     * Returns a partitioned stream covering elements in the range [low,high)
+     * Returns a partitioned stream covering elements in the range [low,high), split into
+     * at most partitionCount streams of at least MIN_CHUNK_TUPLES elements each
      */
     virtual PartitionedStream partitionRange(
             const TupleRef& low, const TupleRef& high, int partitionCount) const = 0;
@@ -459,6 +584,18 @@ public:
      */
     virtual void clear() = 0;
 
+    /**
+     * Moves the buffered tuples of this index out of the main memory if they exceed their budget.
+     * No other operations may be conducted concurrently.
+     */
+    virtual void spill() {}
+
+    /**
+     * Packs the storage of this index, e.g. once it is only read anymore.
+     * No other operations may be conducted concurrently.
+     */
+    virtual void compact() {}
+
     /**
      * Extend another index.
      *
@@ -469,10 +606,19 @@ public:
      * explicitly inserted this relation.
      */
     virtual void extend(InterpreterIndex*) {}
+
+private:
+    static std::size_t nextVersion() {
+        static std::atomic<std::size_t> counter{0};
+        return ++counter;
+    }
+
+    /** The version of the storage of this index, see getVersion */
+    std::size_t version = nextVersion();
 };
 
 // The type of index factory functions.
-using IndexFactory = std::unique_ptr<InterpreterIndex> (*)(const Order&);
+using IndexFactory = std::function<std::unique_ptr<InterpreterIndex>(const Order&)>;
 
 // A factory for BTree based index.
 std::unique_ptr<InterpreterIndex> createBTreeIndex(const Order&);
@@ -480,12 +626,34 @@ std::unique_ptr<InterpreterIndex> createBTreeIndex(const Order&);
 // A factory for BTree provenance index.
 std::unique_ptr<InterpreterIndex> createBTreeProvenanceIndex(const Order&);
 
+// A factory for BTree based index storing the given columns in 32 bits, and the others in full.
+std::unique_ptr<InterpreterIndex> createNarrowIndex(const Order&, const std::vector<bool>& narrow);
+
 // A factory for Brie based index.
 std::unique_ptr<InterpreterIndex> createBrieIndex(const Order&);
 
 // A factory for indirect index.
 std::unique_ptr<InterpreterIndex> createIndirectIndex(const Order&);
 
+// A factory for hash set based index.
+std::unique_ptr<InterpreterIndex> createHashIndex(const Order&);
+
+// A factory for dense set or adjacency set based index of unary or binary relations.
+std::unique_ptr<InterpreterIndex> createDenseIndex(const Order&);
+
+// A factory for compressed index.
+std::unique_ptr<InterpreterIndex> createCompressedIndex(const Order&);
+
+// A factory for front coded index, intended for wide relations.
+std::unique_ptr<InterpreterIndex> createFrontCodedIndex(const Order&);
+
+// A factory for external index.
+std::unique_ptr<InterpreterIndex> createExternalIndex(const Order&);
+
+// A factory for lattice set based indexes, keeping the least or the greatest last column of each key.
+std::unique_ptr<InterpreterIndex> createMinLatticeIndex(const Order&);
+std::unique_ptr<InterpreterIndex> createMaxLatticeIndex(const Order&);
+
 // A factory for Eqrel index.
 std::unique_ptr<InterpreterIndex> createEqrelIndex(const Order&);
 
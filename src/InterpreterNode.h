@@ -25,56 +25,349 @@
 
 #include "InterpreterPreamble.h"
 #include "InterpreterRelation.h"
+#include "RamExpression.h"
 #include "RamNode.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <vector>
+#include <ffi.h>
 
 namespace souffle {
 
-enum InterpreterNodeType {
-    I_Constant,
-    I_TupleElement,
-    I_AutoIncrement,
-    I_IntrinsicOperator,
-    I_UserDefinedOperator,
-    I_PackRecord,
-    I_SubroutineArgument,
-    I_True,
-    I_False,
-    I_Conjunction,
-    I_Negation,
-    I_EmptinessCheck,
-    I_ExistenceCheck,
-    I_ProvenanceExistenceCheck,
-    I_Constraint,
-    I_TupleOperation,
-    I_Scan,
-    I_ParallelScan,
-    I_IndexScan,
-    I_ParallelIndexScan,
-    I_Choice,
-    I_ParallelChoice,
-    I_IndexChoice,
-    I_ParallelIndexChoice,
-    I_UnpackRecord,
-    I_Aggregate,
-    I_IndexAggregate,
-    I_Break,
-    I_Filter,
-    I_Project,
-    I_SubroutineReturnValue,
-    I_Sequence,
-    I_Parallel,
-    I_Loop,
-    I_Exit,
-    I_LogRelationTimer,
-    I_LogTimer,
-    I_DebugInfo,
-    I_Clear,
-    I_LogSize,
-    I_Load,
-    I_Store,
-    I_Query,
-    I_Extend,
-    I_Swap,
+/**
+ * The interpreter node types, listed once such that the enum and the dispatch
+ * table of the interpreter are generated from the same list. The trailing
+ * NegatedExistenceCheck, SimpleConstraint, SimpleProject, ScanProject and
+ * IndexScanProject are fused nodes that the node generator emits for common
+ * RAM patterns.
+ */
+#define FOR_EACH_INTERPRETER_TOKEN(FORWARD) \
+    FORWARD(Constant)                       \
+    FORWARD(TupleElement)                   \
+    FORWARD(AutoIncrement)                  \
+    FORWARD(IntrinsicOperator)              \
+    FORWARD(UserDefinedOperator)            \
+    FORWARD(PackRecord)                     \
+    FORWARD(SubroutineArgument)             \
+    FORWARD(True)                           \
+    FORWARD(False)                          \
+    FORWARD(Conjunction)                    \
+    FORWARD(Negation)                       \
+    FORWARD(EmptinessCheck)                 \
+    FORWARD(ExistenceCheck)                 \
+    FORWARD(ProvenanceExistenceCheck)       \
+    FORWARD(Constraint)                     \
+    FORWARD(TupleOperation)                 \
+    FORWARD(Scan)                           \
+    FORWARD(ParallelScan)                   \
+    FORWARD(IndexScan)                      \
+    FORWARD(ParallelIndexScan)              \
+    FORWARD(LeapfrogJoin)                   \
+    FORWARD(MergeJoin)                      \
+    FORWARD(ParallelMergeJoin)              \
+    FORWARD(HashJoin)                       \
+    FORWARD(ParallelHashJoin)               \
+    FORWARD(GroupAggregate)                 \
+    FORWARD(ParallelGroupAggregate)         \
+    FORWARD(Choice)                         \
+    FORWARD(ParallelChoice)                 \
+    FORWARD(IndexChoice)                    \
+    FORWARD(ParallelIndexChoice)            \
+    FORWARD(UnpackRecord)                   \
+    FORWARD(Aggregate)                      \
+    FORWARD(ParallelAggregate)              \
+    FORWARD(IndexAggregate)                 \
+    FORWARD(ParallelIndexAggregate)         \
+    FORWARD(Break)                          \
+    FORWARD(Filter)                         \
+    FORWARD(Project)                        \
+    FORWARD(SubroutineReturnValue)          \
+    FORWARD(Sequence)                       \
+    FORWARD(Parallel)                       \
+    FORWARD(Schedule)                       \
+    FORWARD(AdaptiveQuery)                  \
+    FORWARD(Loop)                           \
+    FORWARD(Exit)                           \
+    FORWARD(LogRelationTimer)               \
+    FORWARD(LogTimer)                       \
+    FORWARD(DebugInfo)                      \
+    FORWARD(Checkpoint)                     \
+    FORWARD(Clear)                          \
+    FORWARD(Freeze)                         \
+    FORWARD(BuildIndex)                     \
+    FORWARD(DropIndex)                      \
+    FORWARD(LogSize)                        \
+    FORWARD(LogStatistics)                  \
+    FORWARD(LogMemory)                      \
+    FORWARD(Load)                           \
+    FORWARD(Store)                          \
+    FORWARD(Query)                          \
+    FORWARD(Extend)                         \
+    FORWARD(Swap)                           \
+    FORWARD(Merge)                          \
+    FORWARD(NegatedExistenceCheck)          \
+    FORWARD(SimpleConstraint)               \
+    FORWARD(SimpleProject)                  \
+    FORWARD(ScanProject)                    \
+    FORWARD(IndexScanProject)
+
+#define TO_INTERPRETER_NODE_TYPE(Kind) I_##Kind,
+
+enum InterpreterNodeType { FOR_EACH_INTERPRETER_TOKEN(TO_INTERPRETER_NODE_TYPE) };
+
+#undef TO_INTERPRETER_NODE_TYPE
+
+/**
+ * Operands of the fused SimpleConstraint and SimpleProject nodes are stored in
+ * the node data as pairs: either (tuple id, element) or (CONSTANT_OPERAND, value).
+ */
+constexpr size_t CONSTANT_OPERAND = std::numeric_limits<size_t>::max();
+
+/**
+ * The data of match constraints holds the index of their compiled constant pattern, or
+ * DYNAMIC_PATTERN if the pattern is computed at runtime.
+ */
+constexpr size_t DYNAMIC_PATTERN = std::numeric_limits<size_t>::max();
+
+/**
+ * The largest arity of target relations of the fused ScanProject and IndexScanProject
+ * nodes, whose projection loops are instantiated for each arity up to it.
+ */
+constexpr size_t MAX_FUSED_PROJECT_ARITY = 12;
+
+/**
+ * The number of tuples processed at a time by fused scans whose target relation is
+ * not read by their query; a batch is filtered column-wise and inserted at once.
+ */
+constexpr size_t FUSED_BATCH_SIZE = 1024;
+
+/**
+ * The number of outer tuples of a scan whose nested index scan is prefetched, i.e., whose searches
+ * are descended together before the nested operation is evaluated for each of them.
+ */
+constexpr size_t PREFETCH_BATCH_SIZE = 16;
+
+/** The largest number of simple constraints of a fused scan filtered column-wise */
+constexpr size_t MAX_BATCH_FILTERS = 8;
+
+// Aliases for foreign function interface.
+#if RAM_DOMAIN_SIZE == 64
+#define FFI_RamSigned ffi_type_sint64
+#define FFI_RamUnsigned ffi_type_uint64
+#define FFI_RamFloat ffi_type_double
+#else
+#define FFI_RamSigned ffi_type_sint32
+#define FFI_RamUnsigned ffi_type_uint32
+#define FFI_RamFloat ffi_type_float
+#endif
+
+#define FFI_Symbol ffi_type_pointer
+
+/**
+ * The largest arity of user-defined functors that are called through a typed
+ * function pointer rather than a foreign function call.
+ */
+constexpr size_t MAX_DIRECT_FUNCTOR_ARITY = 4;
+
+/**
+ * @class InterpreterFunctor
+ * @brief A user-defined functor resolved when its node is generated, such that
+ *        neither the symbol lookup nor the preparation of the call interface
+ *        is repeated for each call.
+ *
+ * Stateful functors and functors on signed numbers only, with up to
+ * MAX_DIRECT_FUNCTOR_ARITY arguments, are called directly; all other
+ * functors through the prepared foreign call interface.
+ */
+struct InterpreterFunctor {
+    InterpreterFunctor(const RamUserDefinedOperator& op, void* handle)
+            : function(reinterpret_cast<void (*)()>(handle)) {
+        const auto& types = op.getArgsTypes();
+        if (op.getArguments().size() <= MAX_DIRECT_FUNCTOR_ARITY) {
+            isDirect = op.isStateful() ||
+                       (op.getReturnType() == TypeAttribute::Signed &&
+                               std::all_of(types.begin(), types.end(),
+                                       [](TypeAttribute type) { return type == TypeAttribute::Signed; }));
+        }
+
+        if (op.isStateful()) {
+            // symbol and record tables, followed by the arguments as RamDomain
+            argTypes.push_back(&ffi_type_pointer);
+            argTypes.push_back(&ffi_type_pointer);
+            argTypes.insert(argTypes.end(), types.size(), &FFI_RamSigned);
+            returnType = &FFI_RamSigned;
+        } else {
+            for (TypeAttribute type : types) {
+                argTypes.push_back(toFFIType(type));
+            }
+            returnType = toFFIType(op.getReturnType());
+        }
+        isPrepared = ffi_prep_cif(&cif, FFI_DEFAULT_ABI, argTypes.size(), returnType, argTypes.data()) ==
+                     FFI_OK;
+    }
+
+    InterpreterFunctor(const InterpreterFunctor&) = delete;
+    InterpreterFunctor& operator=(const InterpreterFunctor&) = delete;
+
+    /** Address of the functor, or nullptr if no loaded library defines it */
+    void (*function)() = nullptr;
+
+    /** Whether the functor is called through a typed function pointer */
+    bool isDirect = false;
+
+    /** Whether the call interface has been prepared */
+    bool isPrepared = false;
+
+    /** Call interface, referring to the argument types */
+    ffi_cif cif;
+    std::vector<ffi_type*> argTypes;
+    ffi_type* returnType = nullptr;
+
+private:
+    static ffi_type* toFFIType(TypeAttribute type) {
+        switch (type) {
+            case TypeAttribute::Symbol: return &FFI_Symbol;
+            case TypeAttribute::Signed: return &FFI_RamSigned;
+            case TypeAttribute::Unsigned: return &FFI_RamUnsigned;
+            case TypeAttribute::Float: return &FFI_RamFloat;
+            case TypeAttribute::Record: break;
+        }
+        assert(false && "Record support is not implemented");
+        return nullptr;
+    }
+};
+
+/**
+ * The order in which the terms of a conjunction are evaluated, adapted at runtime such that the terms
+ * rejecting the most tuples per unit of their cost are evaluated first, which minimises the expected
+ * cost of evaluating independent terms.
+ *
+ * Every SAMPLE_PERIOD-th evaluation of a thread is sampled, counting the evaluations of the terms and
+ * the term rejecting the tuple, if any. Every REORDER_PERIOD samples, the terms are ordered by their
+ * rejection rates over their costs, and their counts are halved, such that the order follows the
+ * selectivities of the terms as the relations change. Rejection rates are smoothed, such that terms
+ * not evaluated in the current order, as an earlier term rejects all tuples, are tried first once the
+ * earlier terms reject few tuples. The order is a permutation packed into a word, read without locking.
+ */
+class InterpreterConditionOrder {
+public:
+    /** the maximal number of terms of an adapted conjunction */
+    static constexpr size_t MAX_TERMS = 16;
+
+    /**
+     * @param costs the estimated costs of evaluating the terms, initially evaluated in the given order
+     */
+    explicit InterpreterConditionOrder(std::vector<size_t> costs)
+            : costs(std::move(costs)), terms(new Term[this->costs.size()]) {
+        assert(this->costs.size() <= MAX_TERMS && "too many terms");
+        uint64_t initial = 0;
+        for (size_t i = 0; i < this->costs.size(); ++i) {
+            initial |= uint64_t(i) << (4 * i);
+        }
+        order.store(initial, std::memory_order_relaxed);
+    }
+
+    /** get the current order, whose i-th term is given by getTerm() */
+    uint64_t getOrder() const {
+        return order.load(std::memory_order_relaxed);
+    }
+
+    /** get the term at the given position of an order */
+    static size_t getTerm(uint64_t order, size_t pos) {
+        return (order >> (4 * pos)) & 15;
+    }
+
+    /** whether the calling thread samples its current evaluation of a conjunction */
+    static bool sample() {
+        thread_local size_t ticks = 0;
+        return (++ticks & (SAMPLE_PERIOD - 1)) == 0;
+    }
+
+    /**
+     * record a sampled evaluation in the given order, where the given number of leading terms were
+     * evaluated and the last of them rejected the tuple, if rejected is set
+     */
+    void record(uint64_t order, size_t evaluated, bool rejected) {
+        for (size_t pos = 0; pos < evaluated; ++pos) {
+            terms[getTerm(order, pos)].evaluated.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (rejected) {
+            terms[getTerm(order, evaluated - 1)].rejected.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (samples.fetch_add(1, std::memory_order_relaxed) % REORDER_PERIOD == REORDER_PERIOD - 1) {
+            reorder();
+        }
+    }
+
+private:
+    /** sampling period of the evaluations of a thread, a power of two */
+    static constexpr size_t SAMPLE_PERIOD = 64;
+
+    /** number of samples between reorderings */
+    static constexpr size_t REORDER_PERIOD = 256;
+
+    /** sampled evaluations and rejections of a term */
+    struct Term {
+        std::atomic<size_t> evaluated{0};
+        std::atomic<size_t> rejected{0};
+    };
+
+    /** order the terms by their smoothed rejection rates over their costs, and age their counts */
+    void reorder() {
+        std::unique_lock<std::mutex> guard(lock, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            return;
+        }
+        std::vector<double> rank(costs.size());
+        for (size_t i = 0; i < costs.size(); ++i) {
+            const size_t evaluated = terms[i].evaluated.load(std::memory_order_relaxed);
+            const size_t rejected = terms[i].rejected.load(std::memory_order_relaxed);
+            rank[i] = (rejected + 1.0) / (evaluated + 2.0) / costs[i];
+            terms[i].evaluated.store(evaluated / 2, std::memory_order_relaxed);
+            terms[i].rejected.store(rejected / 2, std::memory_order_relaxed);
+        }
+        // ties keep their current order
+        const uint64_t current = getOrder();
+        std::vector<size_t> positions(costs.size());
+        std::iota(positions.begin(), positions.end(), 0);
+        std::stable_sort(positions.begin(), positions.end(), [&](size_t a, size_t b) {
+            return rank[getTerm(current, a)] > rank[getTerm(current, b)];
+        });
+        uint64_t next = 0;
+        for (size_t pos = 0; pos < positions.size(); ++pos) {
+            next |= uint64_t(getTerm(current, positions[pos])) << (4 * pos);
+        }
+        order.store(next, std::memory_order_relaxed);
+    }
+
+    const std::vector<size_t> costs;
+    std::unique_ptr<Term[]> terms;
+    std::atomic<uint64_t> order{0};
+    std::atomic<size_t> samples{0};
+    std::mutex lock;
+};
+
+class InterpreterNode;
+
+/**
+ * The children and data of an interpreter node as given by the node generator, until the tree of
+ * the node is flattened.
+ */
+struct InterpreterNodeContent {
+    std::vector<std::unique_ptr<InterpreterNode>> children;
+    std::vector<size_t> data;
+};
+
+/** The descendants and the data of the nodes of a flattened tree, owned by its root */
+struct InterpreterNodeArena {
+    std::vector<InterpreterNode> nodes;
+    std::vector<size_t> operands;
 };
 
 /**
@@ -82,8 +375,13 @@ enum InterpreterNodeType {
  * @brief This is a shadow node for a RamNode that is enriched for
  *        with local information so that the interpreter is executing
  *        quickly.
+ *
+ * The generated tree of a node is flattened before it is executed: its descendants are laid out in
+ * a single array owned by the root in execution order, the children of each node next to each other
+ * and followed by the descendants of each child in turn, and the data of all nodes in another array.
+ * A child is thus found by an offset from the first child rather than by chasing pointers to
+ * individually allocated nodes. A missing child is laid out as a placeholder node without a shadow.
  */
-
 class InterpreterNode {
     using RelationHandle = std::unique_ptr<InterpreterRelation>;
 
@@ -91,8 +389,9 @@ public:
     InterpreterNode(enum InterpreterNodeType ty, const RamNode* sdw,
             std::vector<std::unique_ptr<InterpreterNode>> chlds = {}, RelationHandle* relHandle = nullptr,
             std::vector<size_t> data = {})
-            : type(ty), shadow(sdw), children(std::move(chlds)), relHandle(relHandle), data(std::move(data)) {
-    }
+            : type(ty), relHandle(relHandle), shadow(sdw),
+              content(std::make_unique<InterpreterNodeContent>(
+                      InterpreterNodeContent{std::move(chlds), std::move(data)})) {}
 
     /** @brief get node type */
     inline enum InterpreterNodeType getType() const {
@@ -104,14 +403,26 @@ public:
         return shadow;
     }
 
-    /** @brief get children of node */
+    /** @brief get children of node, or nullptr if the child is missing */
     inline const InterpreterNode* getChild(std::size_t i) const {
-        return children[i].get();
+        assert(i < numChildren && "child out of range");
+        const InterpreterNode* child = firstChild + i;
+        return child->shadow != nullptr ? child : nullptr;
+    }
+
+    /** @brief get the number of children */
+    inline size_t getNumChildren() const {
+        return numChildren;
     }
 
     /** @brief get data */
     inline size_t getData(std::size_t i) const {
-        return data[i];
+        return operands[i];
+    }
+
+    /** @brief get the number of data values */
+    inline size_t getDataSize() const {
+        return numOperands;
     }
 
     /** @brief get preamble */
@@ -124,9 +435,24 @@ public:
         preamble = p;
     }
 
-    /** @brief get list of all children */
-    const std::vector<std::unique_ptr<InterpreterNode>>& getChildren() const {
-        return children;
+    /** @brief get user-defined functor */
+    inline const InterpreterFunctor* getFunctor() const {
+        return functor.get();
+    }
+
+    /** @brief set user-defined functor */
+    inline void setFunctor(std::unique_ptr<InterpreterFunctor> f) {
+        functor = std::move(f);
+    }
+
+    /** @brief get the adapted order of the terms of a conjunction, if any */
+    inline InterpreterConditionOrder* getConditionOrder() const {
+        return conditionOrder.get();
+    }
+
+    /** @brief set the adapted order of the terms of a conjunction */
+    inline void setConditionOrder(std::unique_ptr<InterpreterConditionOrder> order) {
+        conditionOrder = std::move(order);
     }
 
     /** @brief get relation from handle */
@@ -137,12 +463,67 @@ public:
         return (*relHandle).get();
     }
 
+    /**
+     * @brief flatten the generated tree of this node, which is its root, such that it can be executed
+     */
+    void flatten() {
+        auto flattened = std::make_unique<InterpreterNodeArena>();
+        size_t numNodes = 0;
+        size_t numData = 0;
+        count(*this, numNodes, numData);
+        // the arrays are not reallocated while the nodes refer to them
+        flattened->nodes.reserve(numNodes);
+        flattened->operands.reserve(numData);
+        layout(*this, *flattened);
+        arena = std::move(flattened);
+    }
+
 protected:
+    /** count the descendants of a generated node and the data of its tree */
+    static void count(const InterpreterNode& node, size_t& numNodes, size_t& numData) {
+        numData += node.content->data.size();
+        for (const auto& child : node.content->children) {
+            ++numNodes;
+            if (child != nullptr) {
+                count(*child, numNodes, numData);
+            }
+        }
+    }
+
+    /** move the children of a generated node into the arena, followed by their descendants */
+    static void layout(InterpreterNode& node, InterpreterNodeArena& arena) {
+        std::unique_ptr<InterpreterNodeContent> generated = std::move(node.content);
+        node.operands = arena.operands.data() + arena.operands.size();
+        node.numOperands = static_cast<uint32_t>(generated->data.size());
+        arena.operands.insert(arena.operands.end(), generated->data.begin(), generated->data.end());
+        const size_t first = arena.nodes.size();
+        node.firstChild = arena.nodes.data() + first;
+        node.numChildren = static_cast<uint32_t>(generated->children.size());
+        for (auto& child : generated->children) {
+            if (child != nullptr) {
+                arena.nodes.push_back(std::move(*child));
+            } else {
+                arena.nodes.emplace_back(I_False, nullptr);
+            }
+        }
+        for (size_t i = first; i < first + node.numChildren; ++i) {
+            layout(arena.nodes[i], arena);
+        }
+    }
+
     enum InterpreterNodeType type;
+    uint32_t numChildren = 0;
+    const InterpreterNode* firstChild = nullptr;
+    const size_t* operands = nullptr;
+    uint32_t numOperands = 0;
+    RelationHandle* relHandle;
     const RamNode* shadow;
-    std::vector<std::unique_ptr<InterpreterNode>> children;
-    RelationHandle* const relHandle;
-    std::vector<size_t> data;
     std::shared_ptr<InterpreterPreamble> preamble = nullptr;
+    std::unique_ptr<InterpreterFunctor> functor = nullptr;
+    std::unique_ptr<InterpreterConditionOrder> conditionOrder = nullptr;
+    /** The children and data as generated, until the tree is flattened */
+    std::unique_ptr<InterpreterNodeContent> content;
+    /** The descendants and data of a flattened tree, owned by its root */
+    std::unique_ptr<InterpreterNodeArena> arena;
 };
 }  // namespace souffle
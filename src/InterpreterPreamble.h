@@ -18,6 +18,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -84,6 +85,27 @@ public:
     /** If this preamble contains parallel operation.  */
     bool isParallel = false;
 
+    /** If the parallel operation buffers its insertions per thread.  */
+    bool bufferInserts = false;
+
+    /** Relations whose insertions are buffered, in the order all threads flush their buffers.  */
+    std::vector<size_t> bufferedRelations;
+
+    /** Number of tuple ids used by the query, i.e., the size of its environment.  */
+    size_t tupleCount = 0;
+
+    /** Relations inserted by the query which may spill their tuples to disk once it is done.  */
+    std::vector<size_t> spillingRelations;
+
+    /** Relations read by the query, whose indexes dropped to free memory are built before it runs.  */
+    std::vector<size_t> readRelations;
+
+    /** If the outermost scan of the query is partitioned across the ranks of a distributed evaluation.  */
+    bool partitioned = false;
+
+    /** Relations inserted by a partitioned query whose tuples are exchanged between the ranks.  */
+    std::vector<size_t> exchangedRelations;
+
 private:
     /** Vector of filter operation, views required */
     std::vector<std::unique_ptr<InterpreterNode>> outerFilterViewOps;
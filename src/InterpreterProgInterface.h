@@ -17,11 +17,17 @@
 #pragma once
 
 #include "InterpreterEngine.h"
+#include "RamBaseAnalysis.h"
 #include "RamVisitor.h"
 #include "SouffleInterface.h"
 
 #include <array>
+#include <cstddef>
+#include <functional>
+#include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace souffle {
 
@@ -39,6 +45,13 @@ public:
     /** Insert tuple */
     void insert(const tuple& t) override {
         relation.insert(t.data);
+        modified();
+    }
+
+    /** Insert a batch of tuples */
+    void insertBatch(const RamDomain* data, std::size_t numTuples) override {
+        relation.insertBulk(data, numTuples, relation.getArity());
+        modified();
     }
 
     /** Check whether tuple exists */
@@ -46,6 +59,56 @@ public:
         return relation.contains(TupleRef(&t.data[0], t.size()));
     }
 
+    /** Hand out all tuples in batches, scanning the main index */
+    void scanBatches(const std::function<void(const RamDomain*, std::size_t)>& callback,
+            std::size_t batchSize) const override {
+        assert(batchSize > 0 && "empty batches");
+        const std::size_t arity = relation.getArity();
+        std::vector<RamDomain> buffer(batchSize * arity);
+        std::size_t count = 0;
+        for (const TupleRef& cur : relation.scan()) {
+            for (std::size_t j = 0; j < arity; ++j) {
+                buffer[count * arity + j] = cur[j];
+            }
+            if (++count == batchSize) {
+                callback(buffer.data(), count);
+                count = 0;
+            }
+        }
+        if (count > 0) {
+            callback(buffer.data(), count);
+        }
+    }
+
+    /** Hand out the tuples with the given values in the given columns, searching the best index */
+    void equalRange(const std::vector<std::size_t>& columns, const std::vector<RamDomain>& values,
+            const std::function<void(const tuple&)>& callback) const override {
+        assert(columns.size() == values.size() && "mismatching columns and values");
+        const std::size_t arity = relation.getArity();
+        std::vector<RamDomain> pattern(arity, 0);
+        SearchSignature bound = 0;
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            assert(columns[i] < arity && "attribute out of bound");
+            pattern[columns[i]] = values[i];
+            bound |= SearchSignature(1) << columns[i];
+        }
+        // the index may cover only some of the columns, so all of them are checked
+        tuple t(this);
+        for (const TupleRef& cur : relation.equalRange(bound, TupleRef(pattern.data(), arity))) {
+            bool matches = true;
+            for (std::size_t i = 0; i < columns.size() && matches; ++i) {
+                matches = cur[columns[i]] == values[i];
+            }
+            if (!matches) {
+                continue;
+            }
+            for (std::size_t j = 0; j < arity; ++j) {
+                t[j] = cur[j];
+            }
+            callback(t);
+        }
+    }
+
     /** Iterator to first tuple */
     iterator begin() const override {
         return InterpreterRelInterface::iterator(
@@ -98,6 +161,7 @@ public:
     /** Eliminate all the tuples in relation*/
     void purge() override {
         relation.purge();
+        modified();
     }
 
 protected:
@@ -207,10 +271,10 @@ public:
             auto* interface = new InterpreterRelInterface(
                     interpreterRel, symTable, rel.getName(), types, attrNames, id);
             interfaces.push_back(interface);
-            bool input;
-            bool output;
+            bool input = false;
+            bool output = false;
             visitDepthFirst(prog, [&](const RamStore& store) {
-                if (store.getRelation() == rel) {
+                if (store.getRelation() == rel && !rel.isTemp()) {
                     output = true;
                 }
             });
@@ -222,6 +286,14 @@ public:
             addRelation(rel.getName(), interface, input, output);
             id++;
         }
+
+        // the results of subroutines not writing relations may be cached
+        for (const auto& sub : prog.getSubroutines()) {
+            if (!RamBaseAnalysis::writesRelations(*sub.second)) {
+                const std::set<std::string> reads = RamBaseAnalysis::getReferencedRelations(*sub.second);
+                addCachedSubroutine(sub.first, std::vector<std::string>(reads.begin(), reads.end()));
+            }
+        }
     }
     ~InterpreterProgInterface() override {
         for (auto* interface : interfaces) {
@@ -229,8 +301,11 @@ public:
         }
     }
 
-    /** Run program instance: not implemented */
-    void run() override {}
+    /** Run program instance on the relations of the interpreter, skipping the strata of base relations */
+    void run() override {
+        invalidateSubroutines();
+        exec.executeQuery([this](const std::string& name) { return isBaseRelation(name); });
+    }
 
     /** Load data, run program instance, store data: not implemented */
     void runAll(std::string, std::string) override {}
@@ -247,10 +322,41 @@ public:
     /** Dump outputs: not implemented */
     void dumpOutputs(std::ostream&) override {}
 
-    /** Run subroutine */
+    /** Run subroutine, unless its result is cached */
     void executeSubroutine(
             std::string name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) override {
+        if (lookupSubroutine(name, args, ret)) {
+            return;
+        }
         exec.executeSubroutine(name, args, ret);
+        storeSubroutine(name, args, ret);
+    }
+
+    /** Run subroutine for a batch of argument vectors, evaluating those whose results are not cached */
+    void executeSubroutines(const std::string& name, const std::vector<std::vector<RamDomain>>& args,
+            std::vector<std::vector<RamDomain>>& ret) override {
+        ret.assign(args.size(), std::vector<RamDomain>());
+        std::vector<size_t> missed;
+        for (size_t i = 0; i < args.size(); i++) {
+            if (!lookupSubroutine(name, args[i], ret[i])) {
+                missed.push_back(i);
+            }
+        }
+        if (missed.size() == args.size()) {
+            exec.executeSubroutines(name, args, ret);
+        } else if (!missed.empty()) {
+            std::vector<std::vector<RamDomain>> missedArgs, missedRet;
+            for (size_t i : missed) {
+                missedArgs.push_back(args[i]);
+            }
+            exec.executeSubroutines(name, missedArgs, missedRet);
+            for (size_t i = 0; i < missed.size(); i++) {
+                ret[missed[i]] = std::move(missedRet[i]);
+            }
+        }
+        for (size_t i : missed) {
+            storeSubroutine(name, args[i], ret[i]);
+        }
     }
 
     /** Get symbol table */
@@ -258,6 +364,11 @@ public:
         return symTable;
     }
 
+    /** Get record table */
+    RecordTable& getRecordTable() override {
+        return exec.getRecordTable();
+    }
+
 private:
     const RamProgram& prog;
     InterpreterEngine& exec;
@@ -19,8 +19,13 @@
 #include "BTree.h"
 #include "Brie.h"
 #include "EquivalenceRelation.h"
+#include "ParallelUtils.h"
 #include "Util.h"
+#include <algorithm>
+#include <map>
+#include <memory>
 #include <utility>
+#include <vector>
 
 namespace souffle {
 
@@ -39,8 +44,11 @@ InterpreterRelation::InterpreterRelation(std::size_t arity, std::size_t auxiliar
                 order.push_back(i);
             }
         }
-        indexes.push_back(factory(Order(order)));
+        orders.push_back(Order(order));
+        indexes.push_back(factory(orders.back()));
     }
+    built.resize(indexes.size(), true);
+    evicted.resize(indexes.size(), false);
 
     // Use the first index as default main index
     main = indexes[0].get();
@@ -52,28 +60,165 @@ void InterpreterRelation::removeIndex(const size_t& indexPos) {
     indexes[indexPos].reset(nullptr);
 }
 
-IndexViewPtr InterpreterRelation::getView(const size_t& indexPos) const {
+void InterpreterRelation::buildIndex(const size_t& indexPos) {
     assert(indexPos < indexes.size());
-    return indexes[indexPos]->createView();
+    if (built[indexPos]) {
+        return;
+    }
+    // all indexes are total orders, so the tuples of the main index are bulk-loaded
+    std::vector<RamDomain> tuples;
+    tuples.reserve(size() * arity);
+    for (const auto& cur : scan()) {
+        tuples.insert(tuples.end(), cur.getBase(), cur.getBase() + arity);
+    }
+    indexes[indexPos]->insertBulk(tuples.data(), size(), arity);
+    built[indexPos] = true;
+    evicted[indexPos] = false;
+}
+
+void InterpreterRelation::dropIndex(const size_t& indexPos) {
+    // the main index holds the tuples of the relation and can't be dropped
+    assert(indexPos < indexes.size() && indexes[indexPos].get() != main);
+    indexes[indexPos]->clear();
+    indexes[indexPos]->invalidateViews();
+    built[indexPos] = false;
+    evicted[indexPos] = false;
+}
+
+size_t InterpreterRelation::evictIndexes() {
+    size_t freed = 0;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] == nullptr || indexes[i].get() == main || !built[i]) {
+            continue;
+        }
+        freed += indexes[i]->getMemoryUsage();
+        dropIndex(i);
+        evicted[i] = true;
+    }
+    return freed;
+}
+
+void InterpreterRelation::restoreIndexes() {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (evicted[i]) {
+            buildIndex(i);
+        }
+    }
+}
+
+IndexView* InterpreterRelation::getView(const size_t& indexPos, size_t viewPos) const {
+    assert(indexPos < indexes.size());
+    // the views of this thread, kept across queries and iterations while their index is unchanged
+    struct CachedView {
+        std::size_t version = 0;
+        IndexViewPtr view;
+    };
+    thread_local std::map<std::pair<const InterpreterIndex*, size_t>, CachedView> views;
+    const InterpreterIndex* index = indexes[indexPos].get();
+    CachedView& cached = views[{index, viewPos}];
+    if (cached.view == nullptr || cached.version != index->getVersion()) {
+        cached.view = index->createView();
+        cached.version = index->getVersion();
+    }
+    return cached.view.get();
 }
 
 bool InterpreterRelation::insert(const TupleRef& tuple) {
+    // the filter records the tuple first, such that it never rules out a contained tuple
+    if (filter != nullptr) {
+        filter->insert(tuple.getBase(), arity);
+    }
     if (!main->insert(tuple)) {
         return false;
     }
-    for (const auto& cur : indexes) {
-        if (cur.get() == main) {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i].get() == main || !built[i]) {
             continue;
         }
-        cur->insert(tuple);
+        indexes[i]->insert(tuple);
     }
+    counted(1);
     return true;
 }
 
+void InterpreterRelation::insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) {
+    if (filter != nullptr) {
+        for (std::size_t i = 0; i < count; ++i) {
+            filter->insert(tuples + i * stride, arity);
+        }
+    }
+    if (!empty()) {
+        // the main index decides which tuples are new, and only those are inserted into the others
+        std::unique_ptr<bool[]> inserted = std::make_unique<bool[]>(count);
+        main->insertBatch(tuples, count, stride, inserted.get());
+        if (counting) {
+            counted(std::count(inserted.get(), inserted.get() + count, true));
+        }
+        std::vector<InterpreterIndex*> secondary;
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            if (indexes[i] != nullptr && indexes[i].get() != main && built[i]) {
+                secondary.push_back(indexes[i].get());
+            }
+        }
+        if (secondary.empty()) {
+            return;
+        }
+        std::vector<RamDomain> fresh;
+        for (std::size_t j = 0; j < count; ++j) {
+            if (inserted[j]) {
+                fresh.insert(fresh.end(), tuples + j * stride, tuples + j * stride + arity);
+            }
+        }
+        const std::size_t numFresh = arity > 0 ? fresh.size() / arity : 0;
+        if (numFresh == 0) {
+            return;
+        }
+        // the indexes are independent structures, hence large batches update each on a thread of its own
+        PARALLEL_START_IF(secondary.size() > 1 && numFresh >= PARALLEL_INDEX_TUPLES)
+            pfor(size_t i = 0; i < secondary.size(); ++i) {
+                std::unique_ptr<bool[]> skipped = std::make_unique<bool[]>(numFresh);
+                secondary[i]->insertBatch(fresh.data(), numFresh, arity, skipped.get());
+            }
+        PARALLEL_END
+        return;
+    }
+    // all indexes are total orders, so each of them receives every tuple
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] != nullptr && built[i]) {
+            indexes[i]->insertBulk(tuples, count, stride);
+        }
+    }
+    // the relation was empty, hence its size is the number of new tuples
+    if (counting) {
+        counted(size());
+    }
+}
+
 void InterpreterRelation::insert(const InterpreterRelation& other) {
-    // TODO: cover this in a smarter way
+    if (arity == 0) {
+        for (const auto& cur : other.scan()) {
+            insert(cur);
+        }
+        return;
+    }
+    // the tuples are copied in batches, such that the indexes are maintained by bulk insertions
+    std::vector<RamDomain> batch;
     for (const auto& cur : other.scan()) {
-        insert(cur);
+        batch.insert(batch.end(), cur.getBase(), cur.getBase() + arity);
+        if (batch.size() == MERGE_BATCH_SIZE * arity) {
+            insertBulk(batch.data(), MERGE_BATCH_SIZE, arity);
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) {
+        insertBulk(batch.data(), batch.size() / arity, arity);
+    }
+}
+
+void InterpreterRelation::createFilter(std::size_t expectedTuples) {
+    filter = std::make_unique<BloomFilter>(std::max(expectedTuples, size()));
+    for (const auto& cur : scan()) {
+        filter->insert(cur.getBase(), arity);
     }
 }
 
@@ -98,14 +243,66 @@ Stream InterpreterRelation::range(const size_t& indexPos, const TupleRef& low, c
     return pos->range(low, high);
 }
 
+Stream InterpreterRelation::equalRange(SearchSignature columns, const TupleRef& tuple) const {
+    // pick the built index whose order starts with the longest run of the given columns
+    size_t best = 0;
+    size_t bestPrefix = 0;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] == nullptr || !built[i]) {
+            continue;
+        }
+        size_t prefix = 0;
+        for (int column : orders[i].getOrder()) {
+            if (((columns >> column) & 1) == 0) {
+                break;
+            }
+            prefix++;
+        }
+        if (prefix > bestPrefix) {
+            best = i;
+            bestPrefix = prefix;
+        }
+    }
+    if (bestPrefix == 0) {
+        return scan();
+    }
+
+    // bound the columns of the prefix, leaving the others free
+    std::vector<RamDomain> low(arity, MIN_RAM_DOMAIN);
+    std::vector<RamDomain> high(arity, MAX_RAM_DOMAIN);
+    const auto& order = orders[best].getOrder();
+    for (size_t i = 0; i < bestPrefix; ++i) {
+        low[order[i]] = tuple[order[i]];
+        high[order[i]] = tuple[order[i]];
+    }
+    return indexes[best]->range(TupleRef(low.data(), arity), TupleRef(high.data(), arity));
+}
+
 PartitionedStream InterpreterRelation::partitionRange(
         const size_t& indexPos, const TupleRef& low, const TupleRef& high, size_t partitionCount) const {
     auto& pos = indexes[indexPos];
     return pos->partitionRange(low, high, partitionCount);
 }
 
+int InterpreterRelation::getOrderedIndex(const std::vector<int>& columns) const {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] == nullptr || !built[i]) {
+            continue;
+        }
+        const std::vector<int>& order = orders[i].getOrder();
+        if (order.size() >= columns.size() && std::equal(columns.begin(), columns.end(), order.begin())) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
 void InterpreterRelation::swap(InterpreterRelation& other) {
     indexes.swap(other.indexes);
+    orders.swap(other.orders);
+    built.swap(other.built);
+    evicted.swap(other.evicted);
+    filter.swap(other.filter);
 }
 
 size_t InterpreterRelation::getLevel() const {
@@ -132,9 +329,51 @@ bool InterpreterRelation::empty() const {
     return main->empty();
 }
 
+std::vector<HintStatistics> InterpreterRelation::getHintStatistics() const {
+    std::vector<HintStatistics> res;
+    for (const auto& index : indexes) {
+        res.push_back(index != nullptr ? index->getHintStatistics() : HintStatistics());
+    }
+    return res;
+}
+
+std::vector<size_t> InterpreterRelation::getMemoryUsage() const {
+    std::vector<size_t> res;
+    for (const auto& index : indexes) {
+        res.push_back(index != nullptr ? index->getMemoryUsage() : 0);
+    }
+    // the filter is accounted to the main index
+    if (filter != nullptr) {
+        res[0] += filter->getMemoryUsage();
+    }
+    return res;
+}
+
 void InterpreterRelation::purge() {
     for (auto& index : indexes) {
         index->clear();
+        index->invalidateViews();
+    }
+    if (filter != nullptr) {
+        filter->clear();
+    }
+}
+
+void InterpreterRelation::spill() {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] != nullptr && built[i]) {
+            indexes[i]->spill();
+            indexes[i]->invalidateViews();
+        }
+    }
+}
+
+void InterpreterRelation::compact() {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] != nullptr && built[i]) {
+            indexes[i]->compact();
+            indexes[i]->invalidateViews();
+        }
     }
 }
 
@@ -157,6 +396,86 @@ void InterpreterEqRelation::extend(const InterpreterRelation& rel) {
     this->main->extend(otherEqRel->main);
 }
 
+InterpreterLatticeRelation::InterpreterLatticeRelation(size_t arity, size_t auxiliaryArity,
+        const std::string& name, const std::vector<std::string>& attributeTypes,
+        const MinIndexSelection& orderSet, bool max)
+        : InterpreterRelation(arity, auxiliaryArity, name, attributeTypes, orderSet,
+                  max ? createMaxLatticeIndex : createMinLatticeIndex) {}
+
+void InterpreterLatticeRelation::extend(const InterpreterRelation& rel) {
+    auto otherLatticeRel = dynamic_cast<const InterpreterLatticeRelation*>(&rel);
+    assert(otherLatticeRel != nullptr && "A lattice relation can only merge with another lattice relation");
+    for (const auto& cur : indexes) {
+        if (cur != nullptr) {
+            cur->extend(otherLatticeRel->main);
+        }
+    }
+}
+
+InterpreterChoiceRelation::InterpreterChoiceRelation(size_t arity, size_t auxiliaryArity,
+        const std::string& name, const std::vector<std::string>& attributeTypes,
+        const MinIndexSelection& orderSet, std::vector<size_t> domain, IndexFactory factory)
+        : InterpreterRelation(arity, auxiliaryArity, name, attributeTypes, orderSet, factory),
+          domain(std::move(domain)), keys(createHashIndex(Order::create(this->domain.size()))) {
+    assert(this->domain.size() <= MAX_KEY_ARITY && "choice-domain exceeds the arity of hash indexes");
+}
+
+bool InterpreterChoiceRelation::insert(const TupleRef& tuple) {
+    RamDomain key[MAX_KEY_ARITY];
+    for (size_t i = 0; i < domain.size(); ++i) {
+        key[i] = tuple[domain[i]];
+    }
+    // the key is recorded first, such that concurrent inserts of the same key insert a single tuple
+    if (!keys->insert(TupleRef(key, domain.size()))) {
+        return false;
+    }
+    return InterpreterRelation::insert(tuple);
+}
+
+bool InterpreterChoiceRelation::insert(const RamDomain* tuple) {
+    return this->insert(TupleRef(tuple, arity));
+}
+
+void InterpreterChoiceRelation::insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) {
+    for (std::size_t i = 0; i < count; ++i) {
+        insert(TupleRef(tuples + i * stride, arity));
+    }
+}
+
+void InterpreterChoiceRelation::purge() {
+    InterpreterRelation::purge();
+    keys->clear();
+}
+
+std::vector<size_t> InterpreterChoiceRelation::getMemoryUsage() const {
+    std::vector<size_t> res = InterpreterRelation::getMemoryUsage();
+    res[0] += keys->getMemoryUsage();
+    return res;
+}
+
+InterpreterCompressedRelation::InterpreterCompressedRelation(size_t arity, size_t auxiliaryArity,
+        const std::string& name, const std::vector<std::string>& attributeTypes,
+        const MinIndexSelection& orderSet)
+        : InterpreterRelation(arity, auxiliaryArity, name, attributeTypes, orderSet, createCompressedIndex) {}
+
+void InterpreterCompressedRelation::insertBulk(
+        const RamDomain* tuples, std::size_t count, std::size_t stride) {
+    if (filter != nullptr) {
+        for (std::size_t i = 0; i < count; ++i) {
+            filter->insert(tuples + i * stride, arity);
+        }
+    }
+    const size_t before = counting ? size() : 0;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] != nullptr && built[i]) {
+            indexes[i]->insertBulk(tuples, count, stride);
+        }
+    }
+    if (counting) {
+        counted(size() - before);
+    }
+}
+
 InterpreterIndirectRelation::InterpreterIndirectRelation(size_t arity, size_t auxiliaryArity,
         const std::string& name, const std::vector<std::string>& attributeTypes,
         const MinIndexSelection& orderSet)
@@ -166,6 +485,9 @@ bool InterpreterIndirectRelation::insert(const TupleRef& tuple) {
     if (main->contains(tuple)) {
         return false;
     }
+    if (filter != nullptr) {
+        filter->insert(tuple.getBase(), arity);
+    }
 
     int blockIndex = numTuples / (BLOCK_SIZE / arity);
     int tupleIndex = (numTuples % (BLOCK_SIZE / arity)) * arity;
@@ -186,6 +508,7 @@ bool InterpreterIndirectRelation::insert(const TupleRef& tuple) {
 
     // increment relation size
     numTuples++;
+    counted(1);
 
     return true;
 }
@@ -194,12 +517,28 @@ bool InterpreterIndirectRelation::insert(const RamDomain* tuple) {
     return this->insert(TupleRef(tuple, arity));
 }
 
+void InterpreterIndirectRelation::insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) {
+    for (std::size_t i = 0; i < count; ++i) {
+        insert(TupleRef(tuples + i * stride, arity));
+    }
+}
+
 void InterpreterIndirectRelation::purge() {
     blockList.clear();
     for (auto& cur : indexes) {
         cur->clear();
+        cur->invalidateViews();
+    }
+    if (filter != nullptr) {
+        filter->clear();
     }
     numTuples = 0;
 }
 
+std::vector<size_t> InterpreterIndirectRelation::getMemoryUsage() const {
+    std::vector<size_t> res = InterpreterRelation::getMemoryUsage();
+    res[0] += blockList.size() * BLOCK_SIZE * sizeof(RamDomain);
+    return res;
+}
+
 }  // namespace souffle
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include "BloomFilter.h"
 #include "InterpreterIndex.h"
 #include "RamIndexAnalysis.h"
+#include <atomic>
 
 namespace souffle {
 /**
@@ -47,6 +49,8 @@ public:
 
         Iterator(const InterpreterRelation& rel) : stream(std::make_unique<Stream>(rel.scan())) {}
 
+        Iterator(Stream stream) : stream(std::make_unique<Stream>(std::move(stream))) {}
+
         Iterator(const Iterator& iter) : stream(iter.stream->clone()) {}
 
         Iterator(Iterator&& iter) : stream(std::move(iter.stream)) {}
@@ -84,9 +88,34 @@ public:
     void removeIndex(const size_t& indexPos);
 
     /**
-     * Obtains a view on an index of this relation, facilitating hint-supported accesses.
+     * Builds a secondary index from the tuples of this relation, which is
+     * maintained by insertions until it is dropped.
+     */
+    void buildIndex(const size_t& indexPos);
+
+    /**
+     * Drops the content of a secondary index, which is no longer maintained
+     * by insertions until it is built again.
+     */
+    void dropIndex(const size_t& indexPos);
+
+    /**
+     * Drops the content of the built secondary indexes to free memory, which are built again by
+     * restoreIndexes() before the relation is searched next; returns the estimated bytes freed.
+     */
+    virtual size_t evictIndexes();
+
+    /**
+     * Builds the secondary indexes dropped by evictIndexes() again.
+     */
+    void restoreIndexes();
+
+    /**
+     * Obtains a view on an index of this relation, facilitating hint-supported accesses. The view
+     * is owned by the calling thread, which obtains the same view for the same view position again
+     * until the index releases its storage, such that the hints are retained across iterations.
      */
-    IndexViewPtr getView(const size_t& indexPos) const;
+    IndexView* getView(const size_t& indexPos, size_t viewPos) const;
 
     /**
      * Add the given tuple to this relation.
@@ -101,15 +130,44 @@ public:
     }
 
     /**
-     * Add all entries of the given relation to this relation.
+     * Add count tuples, stored consecutively with the given stride, to this relation.
+     */
+    virtual void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride);
+
+    /**
+     * Add all entries of the given relation to this relation, in batches of MERGE_BATCH_SIZE tuples
+     * inserted by insertBulk.
      */
     void insert(const InterpreterRelation& other);
 
+    /** The number of tuples of another relation inserted at a time by insert(const InterpreterRelation&) */
+    static constexpr std::size_t MERGE_BATCH_SIZE = 1 << 16;
+
+    /**
+     * The least number of new tuples of a bulk insertion into a relation with several indexes for which
+     * the secondary indexes are maintained by a thread each.
+     */
+    static constexpr std::size_t PARALLEL_INDEX_TUPLES = 4096;
+
     /**
      * Tests whether this relation contains the given tuple.
      */
     bool contains(const TupleRef& tuple) const;
 
+    /**
+     * Tests whether this relation may contain the given tuple, i.e., false if the bloom filter of
+     * this relation rules it out.
+     */
+    bool mayContain(const RamDomain* tuple) const {
+        return filter == nullptr || filter->mayContain(tuple, arity);
+    }
+
+    /**
+     * Creates a bloom filter for the given number of tuples, recording the tuples of this relation
+     * and all tuples inserted from now on.
+     */
+    void createFilter(std::size_t expectedTuples);
+
     /**
      * Tests whether this relation contains any element between the given boundaries.
      */
@@ -130,12 +188,61 @@ public:
      */
     Stream range(const size_t& indexPos, const TupleRef& low, const TupleRef& high) const;
 
+    /**
+     * Obtains a stream covering the tuples agreeing with the given tuple on the given columns, through
+     * the index whose order starts with the most of them. Columns beyond that prefix are not checked, so
+     * the stream may cover further tuples.
+     */
+    Stream equalRange(SearchSignature columns, const TupleRef& tuple) const;
+
     /**
      * Obtains a partitioned stream list for parallel computation
      */
     PartitionedStream partitionRange(
             const size_t& indexPos, const TupleRef& low, const TupleRef& high, size_t partitionCount) const;
 
+    /**
+     * Obtains the position of a built index whose order starts with the given columns, or -1 if
+     * there is none.
+     */
+    int getOrderedIndex(const std::vector<int>& columns) const;
+
+    /**
+     * The tuples of a relation in the order of one of its indexes, written by WriteStream::writeOrdered
+     * for an output sorted by the leading columns of the index.
+     */
+    class IndexScan {
+    public:
+        IndexScan(const InterpreterRelation& rel, size_t indexPos) : rel(rel), indexPos(indexPos) {}
+
+        Iterator begin() const {
+            return Iterator(rel.indexes[indexPos]->scan());
+        }
+
+        Iterator end() const {
+            return Iterator();
+        }
+
+        size_t size() const {
+            return rel.size();
+        }
+
+        PartitionedStream partitionScan(size_t partitionCount) const {
+            return rel.indexes[indexPos]->partitionScan(partitionCount);
+        }
+
+    private:
+        const InterpreterRelation& rel;
+        const size_t indexPos;
+    };
+
+    /**
+     * Obtains the tuples of this relation in the order of the given index.
+     */
+    IndexScan getIndexScan(size_t indexPos) const {
+        return IndexScan(*this, indexPos);
+    }
+
     /**
      * Swaps the content of this and the given relation, including the
      * installed indexes.
@@ -176,6 +283,13 @@ public:
      */
     size_t getAuxiliaryArity() const;
 
+    /**
+     * Return the order of the main index, by which the relation is inserted into fastest in order
+     */
+    const Order& getMainOrder() const {
+        return orders[0];
+    }
+
     /**
      * Return number of tuples in relation (full-order)
      */
@@ -186,11 +300,50 @@ public:
      */
     bool empty() const;
 
+    /**
+     * Count the new tuples inserted from now on, such that the logged rules of a profiled run read the
+     * number of new tuples in constant time rather than the size of the relation
+     */
+    void countInsertions() {
+        counting = true;
+    }
+
+    /**
+     * Return the number of new tuples inserted since the insertions are counted, or the size of the
+     * relation if they are not counted
+     */
+    virtual size_t getInsertions() const {
+        return counting ? insertions.load(std::memory_order_relaxed) : size();
+    }
+
+    /**
+     * Return an estimate of the number of bytes of memory occupied by each index, the first being
+     * the main index
+     */
+    virtual std::vector<size_t> getMemoryUsage() const;
+
+    /**
+     * Return the hits and misses of the operation hints of each index, if hints profiling is enabled
+     */
+    std::vector<HintStatistics> getHintStatistics() const;
+
     /**
      * Clear all indexes
      */
     virtual void purge();
 
+    /**
+     * Move the buffered tuples of external indexes to disk if they exceed their memory budget,
+     * which may only be done between statements writing this relation
+     */
+    void spill();
+
+    /**
+     * Pack the b-tree indexes into full, adjacent nodes, which may only be done once no
+     * statement writes this relation anymore
+     */
+    void compact();
+
     /**
      * Check if a tuple exists in relation
      */
@@ -202,6 +355,13 @@ public:
     virtual void extend(const InterpreterRelation& rel);
 
 protected:
+    /** Account new tuples to the counted insertions */
+    void counted(size_t count) {
+        if (counting) {
+            insertions.fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+
     // Relation name
     std::string relName;
 
@@ -217,11 +377,29 @@ protected:
     // a map of managed indexes
     std::vector<std::unique_ptr<InterpreterIndex>> indexes;
 
+    // the total orders of the managed indexes
+    std::vector<Order> orders;
+
     // a pointer to the main index within the managed index
     InterpreterIndex* main;
 
+    // whether the managed indexes are built and maintained by insertions
+    std::vector<bool> built;
+
+    // whether the managed indexes were dropped to free memory, and are to be built again
+    std::vector<bool> evicted;
+
     // relation level
     size_t level = 0;
+
+    // a bloom filter of the inserted tuples, if lookups are filtered
+    std::unique_ptr<BloomFilter> filter;
+
+    // whether the new tuples are counted
+    bool counting = false;
+
+    // the number of new tuples inserted since they are counted
+    std::atomic<size_t> insertions{0};
 };  // namespace souffle
 
 /**
@@ -234,6 +412,74 @@ public:
 
     /** Extend this relation with new knowledge generated by inserting all tuples from a relation */
     void extend(const InterpreterRelation& rel) override;
+
+    /** Return the size, as the tuples implied by the inserted ones are added by extensions */
+    size_t getInsertions() const override {
+        return size();
+    }
+};
+
+/**
+ * Interpreter Lattice Relation, keeping the tuple with the least or greatest last column of each key
+ */
+class InterpreterLatticeRelation : public InterpreterRelation {
+public:
+    InterpreterLatticeRelation(size_t arity, size_t auxiliaryArity, const std::string& relName,
+            const std::vector<std::string>& attributeTypes, const MinIndexSelection& orderSet, bool max);
+
+    /** Discard the tuples of this relation which are subsumed by the given relation */
+    void extend(const InterpreterRelation& rel) override;
+
+    /** Return the size, as extensions both add and remove tuples */
+    size_t getInsertions() const override {
+        return size();
+    }
+};
+
+/**
+ * Interpreter Choice Relation, keeping the first inserted tuple of each key of its choice-domain
+ */
+class InterpreterChoiceRelation : public InterpreterRelation {
+public:
+    InterpreterChoiceRelation(size_t arity, size_t auxiliaryArity, const std::string& relName,
+            const std::vector<std::string>& attributeTypes, const MinIndexSelection& orderSet,
+            std::vector<size_t> domain, IndexFactory factory = &createBTreeIndex);
+
+    /** Insert the tuple unless a tuple of its key has been inserted before */
+    bool insert(const TupleRef& tuple) override;
+
+    bool insert(const RamDomain* tuple) override;
+
+    /** Insert tuples one by one, since each of them may be rejected by its key */
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override;
+
+    /** Clear all indexes and the keys */
+    void purge() override;
+
+    /** Account the keys to the main index */
+    std::vector<size_t> getMemoryUsage() const override;
+
+    /** The largest number of columns of a key, as supported by hash indexes */
+    static const size_t MAX_KEY_ARITY = 12;
+
+private:
+    /** The columns of the keys */
+    const std::vector<size_t> domain;
+
+    /** The keys of the inserted tuples, deciding in constant time whether a tuple is rejected */
+    std::unique_ptr<InterpreterIndex> keys;
+};
+
+/**
+ * Interpreter Compressed Relation
+ */
+class InterpreterCompressedRelation : public InterpreterRelation {
+public:
+    InterpreterCompressedRelation(size_t arity, size_t auxiliaryArity, const std::string& relName,
+            const std::vector<std::string>& attributeTypes, const MinIndexSelection& orderSet);
+
+    /** Insert tuples into all indexes at once, since the indexes are rebuilt by each insertion */
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override;
 };
 
 /**
@@ -248,9 +494,20 @@ public:
 
     bool insert(const RamDomain* tuple) override;
 
+    /** Insert tuples one by one, since the indexes refer to the stored tuples */
+    void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) override;
+
     /** Clear all indexes */
     void purge() override;
 
+    /** Account the blocks of the stored tuples to the main index */
+    std::vector<size_t> getMemoryUsage() const override;
+
+    /** Keep the indexes, which refer to the stored tuples rather than hold them */
+    size_t evictIndexes() override {
+        return 0;
+    }
+
 private:
     /** Size of blocks containing tuples */
     static const int BLOCK_SIZE = 1024;
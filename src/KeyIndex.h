@@ -0,0 +1,200 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file KeyIndex.h
+ *
+ * A secondary index of a relation storing, instead of copies of the
+ * tuples, the columns of its key followed by a reference to the tuple,
+ * which is stored once by the relation at a stable address.
+ *
+ * Such an index takes fewer words per tuple than a b-tree of complete
+ * tuples if its key is short compared to the arity of the relation. In
+ * turn, each tuple visited by a scan of the index is dereferenced, i.e.,
+ * scans access memory randomly.
+ *
+ * The entries are ordered by the columns of the key, and by the address
+ * of the tuple among entries of the same key. Hence, bounds on the key
+ * locate the same ranges as in a b-tree of complete tuples ordered by
+ * the key first.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BTree.h"
+#include "CompiledTuple.h"
+#include "RamTypes.h"
+#include "Util.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace souffle {
+
+template <typename T, unsigned... Columns>
+class KeyIndex {
+    /** The number of columns of the key */
+    static constexpr std::size_t KEY = sizeof...(Columns);
+
+    /** The number of words storing the reference to a tuple */
+    static constexpr std::size_t REF = (sizeof(const T*) + sizeof(RamDomain) - 1) / sizeof(RamDomain);
+
+    /** The entries of the index, the columns of the key followed by the words of the reference */
+    using entry = ram::Tuple<RamDomain, KEY + REF>;
+
+    using set_type = btree_set<entry>;
+
+    set_type set;
+
+    /** Obtain the entry of a tuple, the reference words being filled by the given value if no tuple */
+    static entry getEntry(const T& t, const T* ref, RamDomain fill) {
+        static constexpr std::array<unsigned, KEY> columns{{Columns...}};
+        entry res;
+        for (std::size_t i = 0; i < KEY; ++i) {
+            res[i] = t[columns[i]];
+        }
+        if (ref == nullptr) {
+            for (std::size_t i = KEY; i < KEY + REF; ++i) {
+                res[i] = fill;
+            }
+        } else {
+            std::fill(&res[KEY], &res[KEY] + REF, 0);
+            std::memcpy(&res[KEY], &ref, sizeof(ref));
+        }
+        return res;
+    }
+
+public:
+    using element_type = T;
+    using operation_hints = typename set_type::operation_hints;
+
+    /** An iterator over the tuples referenced by the entries */
+    class iterator : public std::iterator<std::forward_iterator_tag, T> {
+        typename set_type::iterator cur;
+
+    public:
+        iterator() = default;
+
+        explicit iterator(const typename set_type::iterator& cur) : cur(cur) {}
+
+        bool operator==(const iterator& other) const {
+            return cur == other.cur;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return cur != other.cur;
+        }
+
+        const T& operator*() const {
+            const T* ref;
+            std::memcpy(&ref, &(*cur)[KEY], sizeof(ref));
+            return *ref;
+        }
+
+        const T* operator->() const {
+            return &**this;
+        }
+
+        iterator& operator++() {
+            ++cur;
+            return *this;
+        }
+    };
+
+    /** Inserts a reference to a tuple, which must not move while this index refers to it */
+    bool insert(const T& t, operation_hints& hints) {
+        return set.insert(getEntry(t, &t, 0), hints);
+    }
+
+    bool insert(const T& t) {
+        operation_hints hints;
+        return insert(t, hints);
+    }
+
+    /** Inserts references to the given tuples, bulk-loading an empty index */
+    void insertBulk(const std::vector<const T*>& refs) {
+        std::vector<entry> entries;
+        entries.reserve(refs.size());
+        for (const T* ref : refs) {
+            entries.push_back(getEntry(*ref, ref, 0));
+        }
+        set.insertBulk(std::move(entries));
+    }
+
+    /** Prefetches the entries on the paths to the lower bounds of the keys of the given tuples */
+    void prefetch(const T* keys, std::size_t count, operation_hints& hints) const {
+        std::array<entry, set_type::PREFETCH_BATCH> entries;
+        for (std::size_t begin = 0; begin < count; begin += entries.size()) {
+            const std::size_t num = std::min(count - begin, entries.size());
+            for (std::size_t i = 0; i < num; ++i) {
+                entries[i] = getEntry(keys[begin + i], nullptr, MIN_RAM_DOMAIN);
+            }
+            set.prefetch(entries.data(), num, hints);
+        }
+    }
+
+    /** The first tuple whose key is not less than the key of the given tuple */
+    iterator lower_bound(const T& t, operation_hints& hints) const {
+        return iterator(set.lower_bound(getEntry(t, nullptr, MIN_RAM_DOMAIN), hints));
+    }
+
+    /** The first tuple whose key is greater than the key of the given tuple */
+    iterator upper_bound(const T& t, operation_hints& hints) const {
+        return iterator(set.upper_bound(getEntry(t, nullptr, MAX_RAM_DOMAIN), hints));
+    }
+
+    iterator begin() const {
+        return iterator(set.begin());
+    }
+
+    iterator end() const {
+        return iterator(set.end());
+    }
+
+    std::size_t size() const {
+        return set.size();
+    }
+
+    bool empty() const {
+        return set.empty();
+    }
+
+    void clear() {
+        set.clear();
+    }
+
+    /** Packs the entries once the index is only read anymore */
+    void compact() {
+        set.compact();
+    }
+
+    /** Splits the index into about the given number of consecutive ranges */
+    std::vector<range<iterator>> getChunks(std::size_t num) const {
+        std::vector<range<iterator>> res;
+        for (const auto& chunk : set.getChunks(num)) {
+            res.push_back(make_range(iterator(chunk.begin()), iterator(chunk.end())));
+        }
+        return res;
+    }
+
+    /** The bytes occupied by the entries, not counting the referenced tuples */
+    std::size_t getMemoryUsage() const {
+        return set.getMemoryUsage();
+    }
+
+    const auto& getHintStatistics() const {
+        return set.getHintStatistics();
+    }
+};
+
+}  // end of namespace souffle
@@ -0,0 +1,258 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file LatticeSet.h
+ *
+ * This header file contains the implementation of an ordered set of
+ * tuples for subsumptive relations. The tuples are partitioned into keys,
+ * formed by all but one of their columns, and the value of the remaining
+ * column. For each key, only the tuple with the least (or greatest) value
+ * is kept: inserting a tuple with a better value replaces the dominated
+ * tuple in place, while dominated tuples are rejected.
+ *
+ * Insertions are conducted in mutual exclusion, whereas reading operations
+ * are only thread-safe in the absence of concurrent insertions.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BTree.h"
+#include "RamTypes.h"
+#include "Util.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * An ordered set of tuples keeping a single dominant tuple per key.
+ *
+ * @tparam T the type of the elements, a tuple of RamDomain values
+ * @tparam Comparator the order of the elements, providing a less member function
+ */
+template <typename T, typename Comparator = detail::comparator<T>>
+class LatticeSet {
+    // adapts the comparator to the standard containers
+    struct less {
+        bool operator()(const T& a, const T& b) const {
+            return Comparator().less(a, b);
+        }
+    };
+
+    using Elements = std::set<T, less>;
+
+    // the elements of this set
+    Elements elements;
+
+    // the value of each key, stored as the key's tuple with a cleared value column
+    std::map<T, RamDomain, less> values;
+
+    // the column holding the value of a tuple
+    std::size_t column;
+
+    // whether greater values dominate lesser ones
+    bool max;
+
+    // serialises insertions
+    std::mutex lock;
+
+public:
+    using element_type = T;
+    using iterator = typename Elements::const_iterator;
+    using chunk = range<iterator>;
+
+    // lattice sets do not utilise operation hints
+    struct operation_hints {
+        void clear() {}
+    };
+
+    /**
+     * Creates a set whose tuples are keyed by all columns but the given one, and retaining the least or,
+     * if max is set, the greatest value of that column for each key.
+     */
+    LatticeSet(std::size_t column = T::arity - 1, bool max = false) : column(column), max(max) {
+        assert(column < T::arity && "value column out of range");
+    }
+
+    LatticeSet(const LatticeSet&) = delete;
+    LatticeSet& operator=(const LatticeSet&) = delete;
+
+    bool empty() const {
+        return elements.empty();
+    }
+
+    std::size_t size() const {
+        return elements.size();
+    }
+
+    /**
+     * Returns an estimate of the number of bytes of memory occupied by this set, assuming tree nodes
+     * holding three pointers and a colour next to their entry.
+     */
+    std::size_t getMemoryUsage() const {
+        const std::size_t nodeSize = 4 * sizeof(void*);
+        return sizeof(*this) + elements.size() * (nodeSize + sizeof(T)) +
+               values.size() * (nodeSize + sizeof(typename decltype(values)::value_type));
+    }
+
+    /**
+     * Inserts the given element unless its key has an equal or better value, replacing the element
+     * holding a dominated value of the key. Returns whether the element has been added.
+     */
+    bool insert(const T& value) {
+        operation_hints hints;
+        return insert(value, hints);
+    }
+
+    bool insert(const T& value, operation_hints& /* hints */) {
+        std::lock_guard<std::mutex> guard(lock);
+        T key = value;
+        key[column] = 0;
+        auto pos = values.find(key);
+        if (pos == values.end()) {
+            values.emplace(key, value[column]);
+        } else {
+            if (!dominates(value[column], pos->second)) {
+                return false;
+            }
+            key[column] = pos->second;
+            elements.erase(key);
+            pos->second = value[column];
+        }
+        elements.insert(value);
+        return true;
+    }
+
+    /**
+     * Inserts the given elements in order.
+     */
+    void insertBulk(const std::vector<T>& data) {
+        for (const T& cur : data) {
+            insert(cur);
+        }
+    }
+
+    /**
+     * Determines whether the key of the given tuple holds a value equal to or better than its value,
+     * such that inserting the tuple has no effect.
+     */
+    bool subsumes(const T& value) const {
+        T key = value;
+        key[column] = 0;
+        auto pos = values.find(key);
+        return pos != values.end() && !dominates(value[column], pos->second);
+    }
+
+    /**
+     * Removes all elements satisfying the given predicate. No other operations may be conducted
+     * concurrently.
+     */
+    template <typename Predicate>
+    void discard(const Predicate& predicate) {
+        for (auto pos = elements.begin(); pos != elements.end();) {
+            if (predicate(*pos)) {
+                T key = *pos;
+                key[column] = 0;
+                values.erase(key);
+                pos = elements.erase(pos);
+            } else {
+                ++pos;
+            }
+        }
+    }
+
+    /**
+     * Removes all elements subsumed by the given set, which is keyed by the same column, retaining the
+     * elements which improve on the given set.
+     */
+    void extend(const LatticeSet& other) {
+        discard([&](const T& cur) { return other.subsumes(cur); });
+    }
+
+    bool contains(const T& value) const {
+        return elements.find(value) != elements.end();
+    }
+
+    bool contains(const T& value, operation_hints& /* hints */) const {
+        return contains(value);
+    }
+
+    iterator find(const T& value) const {
+        return elements.find(value);
+    }
+
+    iterator find(const T& value, operation_hints& /* hints */) const {
+        return find(value);
+    }
+
+    iterator lower_bound(const T& value, operation_hints& /* hints */) const {
+        return elements.lower_bound(value);
+    }
+
+    iterator upper_bound(const T& value, operation_hints& /* hints */) const {
+        return elements.upper_bound(value);
+    }
+
+    iterator begin() const {
+        return elements.begin();
+    }
+
+    iterator end() const {
+        return elements.end();
+    }
+
+    /**
+     * Partitions this set into at most the given number of chunks of similar size.
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        std::vector<chunk> res;
+        if (elements.empty()) {
+            return res;
+        }
+        num = std::max<std::size_t>(1, std::min(num, elements.size()));
+        const std::size_t step = (elements.size() + num - 1) / num;
+        iterator first = elements.begin();
+        while (first != elements.end()) {
+            iterator last = first;
+            for (std::size_t i = 0; i < step && last != elements.end(); ++i) {
+                ++last;
+            }
+            res.emplace_back(first, last);
+            first = last;
+        }
+        return res;
+    }
+
+    std::vector<chunk> getChunks(std::size_t num) const {
+        return partition(num);
+    }
+
+    /**
+     * Removes all elements. No other operations may be conducted concurrently.
+     */
+    void clear() {
+        elements.clear();
+        values.clear();
+    }
+
+private:
+    // whether the given value improves on the present one
+    bool dominates(RamDomain value, RamDomain present) const {
+        return max ? present < value : value < present;
+    }
+};
+
+}  // end namespace souffle
@@ -104,6 +104,14 @@ public:
         return line.str();
     }
 
+    static const std::string dRecursiveRelation(
+            const std::string& relationName, const SrcLocation& srcLocation) {
+        const char* messageType = "@d-recursive-relation";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << srcLocation << ";";
+        return line.str();
+    }
+
     static const std::string cRecursiveRelation(
             const std::string& relationName, const SrcLocation& srcLocation) {
         const char* messageType = "@c-recursive-relation";
@@ -125,6 +133,34 @@ public:
         return line.str();
     }
 
+    static const std::string relationStatistics(const std::string& relationName) {
+        const char* messageType = "@relation-statistics";
+        std::stringstream line;
+        line << messageType << ";" << relationName;
+        return line.str();
+    }
+
+    static const std::string relationMemory(const std::string& relationName, size_t stratum) {
+        const char* messageType = "@relation-memory";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << stratum;
+        return line.str();
+    }
+
+    static const std::string memory(size_t stratum) {
+        const char* messageType = "@memory";
+        std::stringstream line;
+        line << messageType << ";" << stratum;
+        return line.str();
+    }
+
+    static const std::string memoryLimit(size_t round) {
+        const char* messageType = "@memory-limit";
+        std::stringstream line;
+        line << messageType << ";" << round;
+        return line.str();
+    }
+
     static const std::string runtime() {
         const char* messageType = "@runtime";
         std::stringstream line;
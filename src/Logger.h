@@ -21,6 +21,7 @@
 #include "ProfileEvent.h"
 
 #include <chrono>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <utility>
@@ -34,34 +35,65 @@ namespace souffle {
  *
  * To far, only execution times are logged. More events, e.g. the number of
  * processed tuples may be added in the future.
+ *
+ * A logger is created for each execution of each rule, hence it only reads cheap
+ * measurements: the number of new tuples is read from the insertion counter of the
+ * relation rather than its size, and the memory usage is the one last sampled by the
+ * profile timer rather than read by a system call.
  */
 class Logger {
 public:
     Logger(std::string label, size_t iteration) : Logger(label, iteration, []() { return 0; }) {}
 
+    /**
+     * @param size The number of tuples inserted so far into the logged relation, whose difference is the
+     * number of new tuples of the logged region
+     */
     Logger(std::string label, size_t iteration, std::function<size_t()> size)
             : label(std::move(label)), start(now()), iteration(iteration), size(size), preSize(size()) {
-        struct rusage ru {};
-        getrusage(RUSAGE_SELF, &ru);
-        startMaxRSS = ru.ru_maxrss;
+        startMaxRSS = ProfileEventSingleton::instance().getMaxRSS();
+        if (ProfileEventSingleton::instance().hasCounters()) {
+            countersLabel = getCountersLabel(this->label);
+            if (!countersLabel.empty()) {
+                startCounts = HardwareCounters::forThread().read();
+            }
+        }
         // Assume that if we are logging the progress of an event then we care about usage during that time.
         ProfileEventSingleton::instance().resetTimerInterval();
     }
 
     ~Logger() {
-        struct rusage ru {};
-        getrusage(RUSAGE_SELF, &ru);
-        size_t endMaxRSS = ru.ru_maxrss;
+        size_t endMaxRSS = ProfileEventSingleton::instance().getMaxRSS();
         ProfileEventSingleton::instance().makeTimingEvent(
                 label, start, now(), startMaxRSS, endMaxRSS, size() - preSize, iteration);
+        if (!countersLabel.empty()) {
+            ProfileEventSingleton::instance().makeCountersEvent(
+                    countersLabel, startCounts, HardwareCounters::forThread().read(), iteration);
+        }
     }
 
 private:
+    /**
+     * Get the label of the hardware counters event of a timed region, or the empty string if
+     * the counters of the region are not recorded, being neither a rule nor a relation
+     */
+    static std::string getCountersLabel(const std::string& label) {
+        for (const char* keyword : {"@t-nonrecursive-rule;", "@t-recursive-rule;",
+                     "@t-nonrecursive-relation;", "@t-recursive-relation;"}) {
+            if (label.compare(0, std::strlen(keyword), keyword) == 0) {
+                return "@h-" + label.substr(3);
+            }
+        }
+        return "";
+    }
+
     std::string label;
     time_point start;
     size_t startMaxRSS;
     size_t iteration;
     std::function<size_t()> size;
     size_t preSize;
+    std::string countersLabel;
+    HardwareCounters::Counts startCounts{};
 };
 }  // end of namespace souffle
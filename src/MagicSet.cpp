@@ -19,6 +19,7 @@
 #include "AstIO.h"
 #include "AstIOTypeAnalysis.h"
 #include "AstNode.h"
+#include "AstProfileUse.h"
 #include "AstProgram.h"
 #include "AstRelation.h"
 #include "AstTransforms.h"
@@ -29,6 +30,7 @@
 #include "RelationRepresentation.h"
 #include "SrcLocation.h"
 #include "Util.h"
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
@@ -180,7 +182,7 @@ SrcLocation nextSrcLoc(SrcLocation orig) {
     pos += 1;
 
     SrcLocation newLoc;
-    newLoc.filename = orig.filename + " [MAGIC_FILE]";
+    newLoc.setFilename(orig.getFilename() + " [MAGIC_FILE]");
     newLoc.start.line = pos;
     newLoc.end.line = pos;
     newLoc.start.column = 0;
@@ -476,6 +478,26 @@ std::pair<std::string, std::set<std::string>> bindArguments(
     return std::make_pair(atomAdornment, boundArgs);
 }
 
+// checks whether the bound arguments of an adornment are expected to select a small enough
+// fraction of the tuples of the relation for the magic set transformation to pay off;
+// without profile statistics any bound argument is assumed to be selective
+bool isSelectiveAdornment(
+        const AstRelationIdentifier& rel, const std::string& adornment, const AstProfileUse* profileUse) {
+    if (adornment.find('b') == std::string::npos) {
+        return false;
+    }
+    if (profileUse == nullptr || !profileUse->hasStatistics(rel)) {
+        return true;
+    }
+    double selectivity = 1;
+    for (size_t i = 0; i < adornment.size(); i++) {
+        if (adornment[i] == 'b') {
+            selectivity /= std::max<size_t>(1, profileUse->getDistinctValues(rel, i));
+        }
+    }
+    return selectivity <= Adornment::maxSelectivity;
+}
+
 // SIPS #1:
 // Choose the left-most body atom with at least one bound argument
 // If none exist, prioritise EDB predicates.
@@ -712,6 +734,11 @@ void Adornment::run(const AstTranslationUnit& translationUnit) {
     // normalises and tracks bindings of composite arguments (namely records and functors)
     BindingStore compositeBindings = bindComposites(program);
 
+    // only keep adornments whose bound arguments are selective
+    const bool selective = Global::config().has("magic-selective");
+    const AstProfileUse* profileUse =
+            Global::config().has("profile-use") ? translationUnit.getAnalysis<AstProfileUse>() : nullptr;
+
     // set up IDB/EDB and the output queries
     std::vector<AstRelationIdentifier> outputQueries;
     std::vector<std::vector<AdornedClause>> adornedProgram;
@@ -856,6 +883,11 @@ void Adornment::run(const AstTranslationUnit& translationUnit) {
                     std::string atomAdornment = result.first;
                     boundArgs = result.second;
 
+                    // an unselective adornment is demanded in full instead
+                    if (selective && !isSelectiveAdornment(atomName, atomAdornment, profileUse)) {
+                        atomAdornment = std::string(atomAdornment.size(), 'f');
+                    }
+
                     // check if we've already dealt with this adornment before
                     if (!contains(seenPredicates, atomName, atomAdornment)) {
                         // not seen before, so push it onto the computation list
@@ -882,6 +914,42 @@ void Adornment::run(const AstTranslationUnit& translationUnit) {
         adornmentClauses.push_back(adornedClauses);
     }
 
+    // a relation only benefits from the transformation if it is adorned with a bound argument
+    // or depends on such a relation; all other relations are computed in full
+    if (selective) {
+        std::set<AstRelationIdentifier> specialised;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const auto& adornedClauses : adornmentClauses) {
+                for (const AdornedClause& adornedClause : adornedClauses) {
+                    const AstClause* clause = adornedClause.getClause();
+                    AstRelationIdentifier headName = clause->getHead()->getName();
+                    if (contains(specialised, headName)) {
+                        continue;
+                    }
+                    bool useful = adornedClause.getHeadAdornment().find('b') != std::string::npos;
+                    for (const AstAtom* atom : getBodyLiterals<AstAtom>(*clause)) {
+                        useful = useful || contains(specialised, atom->getName());
+                    }
+                    if (useful) {
+                        specialised.insert(headName);
+                        changed = true;
+                    }
+                }
+            }
+        }
+        for (const auto& adornedClauses : adornmentClauses) {
+            for (const AdornedClause& adornedClause : adornedClauses) {
+                AstRelationIdentifier headName = adornedClause.getClause()->getHead()->getName();
+                if (!contains(specialised, headName)) {
+                    ignoredAtoms.insert(headName);
+                }
+            }
+        }
+        ignoredAtoms = addForwardDependencies(program, ignoredAtoms);
+    }
+
     this->bindings = std::move(compositeBindings);
 }
 
@@ -1080,6 +1148,29 @@ bool MagicSetTransformer::transform(AstTranslationUnit& translationUnit) {
         ignoredAtoms.insert(relation);
     }
 
+    // report the adornments of the relations to be specialised
+    if (Global::config().get("show") == "magic-sets") {
+        std::map<AstRelationIdentifier, std::set<std::string>> specialised;
+        for (const auto& adornedClauses : allAdornedClauses) {
+            for (const AdornedClause& adornedClause : adornedClauses) {
+                AstRelationIdentifier headName = adornedClause.getClause()->getHead()->getName();
+                if (!contains(ignoredAtoms, headName)) {
+                    specialised[headName].insert(adornedClause.getHeadAdornment());
+                }
+            }
+        }
+        std::cout << "Specialised relations:" << std::endl;
+        for (const auto& cur : specialised) {
+            std::cout << "   " << cur.first << ": " << join(cur.second, ", ") << std::endl;
+        }
+        std::cout << "Relations computed in full:" << std::endl;
+        for (const AstRelationIdentifier& relation : oldIdb) {
+            if (specialised.find(relation) == specialised.end()) {
+                std::cout << "   " << relation << std::endl;
+            }
+        }
+    }
+
     // perform magic set algorithm for each output
     for (size_t querynum = 0; querynum < outputQueries.size(); querynum++) {
         AstRelationIdentifier outputQuery = outputQueries[querynum];
@@ -1145,6 +1236,9 @@ bool MagicSetTransformer::transform(AstTranslationUnit& translationUnit) {
                         if (directives["IO"] == "file" && directives.find("filename") == directives.end()) {
                             current.addKVP("filename", originalName.getNames()[0] + ".facts");
                         }
+                        if (directives["IO"] == "binary" && directives.find("filename") == directives.end()) {
+                            current.addKVP("filename", originalName.getNames()[0] + ".bin");
+                        }
                     });
                 }
                 adornedRelation = newRelation;
@@ -174,6 +174,12 @@ private:
 public:
     static constexpr const char* name = "adorned-clauses";
 
+    /**
+     * Largest estimated fraction of the tuples of a relation selected by the bound arguments of an
+     * adornment for the adornment to be kept with --magic-selective
+     */
+    static constexpr double maxSelectivity = 0.01;
+
     ~Adornment() override = default;
 
     void run(const AstTranslationUnit& translationUnit) override;
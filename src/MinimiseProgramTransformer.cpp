@@ -26,10 +26,15 @@
 #include "AstTranslationUnit.h"
 #include "AstUtils.h"
 #include "AstVisitor.h"
+#include "Util.h"
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace souffle {
@@ -192,6 +197,9 @@ bool isValidPermutation(
     std::map<std::string, std::string> variableMap;
     visitDepthFirst(*reorderedLeft, [&](const AstVariable& var) { variableMap[var.getName()] = ""; });
 
+    // the mapping must be injective too, otherwise distinct variables would be unified
+    std::map<std::string, std::string> inverseMap;
+
     // need to match the variables in the body
     std::vector<AstLiteral*> leftAtoms = reorderedLeft->getBodyLiterals();
     std::vector<AstLiteral*> rightAtoms = right->getBodyLiterals();
@@ -227,7 +235,11 @@ bool isValidPermutation(
 
                 std::string currentMap = variableMap[leftVarName];
                 if (currentMap.empty()) {
-                    // unassigned yet, so assign it appropriately
+                    // unassigned yet, so assign it appropriately, unless another variable maps to it
+                    if (!inverseMap.insert(std::make_pair(rightVarName, leftVarName)).second) {
+                        validMapping = false;
+                        break;
+                    }
                     variableMap[leftVarName] = rightVarName;
                 } else if (currentMap != rightVarName) {
                     // mapping is inconsistent!
@@ -260,30 +272,81 @@ bool isValidPermutation(
 /**
  * Check whether two clauses are bijectively equivalent.
  */
-bool areBijectivelyEquivalent(const AstClause* left, const AstClause* right) {
-    // only check bijective equivalence for a subset of the possible clauses
-    auto isValidClause = [&](const AstClause* clause) {
-        // check that all body literals are atoms
-        // i.e. avoid clauses with constraints or negations
-        // TODO (azreika): extend to constraints and negations
-        for (AstLiteral* lit : clause->getBodyLiterals()) {
-            if (dynamic_cast<AstAtom*>(lit) == nullptr) {
-                return false;
-            }
+/**
+ * Check whether bijective equivalence is checked for a clause, which is only done for a subset of
+ * the possible clauses.
+ */
+bool isValidClause(const AstClause* clause) {
+    // check that all body literals are atoms
+    // i.e. avoid clauses with constraints or negations
+    // TODO (azreika): extend to constraints and negations
+    for (AstLiteral* lit : clause->getBodyLiterals()) {
+        if (dynamic_cast<AstAtom*>(lit) == nullptr) {
+            return false;
         }
+    }
 
-        // check that all arguments are either constants or variables
-        // i.e. only allow primitive arguments
-        bool valid = true;
-        visitDepthFirst(*clause, [&](const AstArgument& arg) {
-            if (dynamic_cast<const AstVariable*>(&arg) == nullptr &&
-                    dynamic_cast<const AstConstant*>(&arg) == nullptr) {
-                valid = false;
+    // check that all arguments are either constants or variables
+    // i.e. only allow primitive arguments
+    bool valid = true;
+    visitDepthFirst(*clause, [&](const AstArgument& arg) {
+        if (dynamic_cast<const AstVariable*>(&arg) == nullptr &&
+                dynamic_cast<const AstConstant*>(&arg) == nullptr) {
+            valid = false;
+        }
+    });
+    return valid;
+}
+
+/**
+ * Compute a key of a valid clause that is invariant under bijective renamings of its variables and
+ * permutations of its body atoms, such that bijectively equivalent clauses have the same key. The
+ * name of the head relation is not part of the key. Clauses with the same key are not necessarily
+ * equivalent, which areBijectivelyEquivalent decides.
+ */
+std::string getCanonicalKey(const AstClause* clause) {
+    // describe each variable by its number of occurrences and its positions in the head
+    std::map<std::string, size_t> occurrences;
+    visitDepthFirst(*clause, [&](const AstVariable& var) { occurrences[var.getName()]++; });
+    std::map<std::string, std::string> headPositions;
+    const auto& headArgs = clause->getHead()->getArguments();
+    for (size_t i = 0; i < headArgs.size(); i++) {
+        if (auto* var = dynamic_cast<const AstVariable*>(headArgs[i])) {
+            headPositions[var->getName()] += std::to_string(i) + ",";
+        }
+    }
+
+    // describe an atom by its arguments, naming the variables by their first position in the atom
+    auto describe = [&](const AstAtom* atom) {
+        std::stringstream signature;
+        std::map<std::string, size_t> local;
+        signature << "(";
+        for (const AstArgument* arg : atom->getArguments()) {
+            if (auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                auto pos = local.insert(std::make_pair(var->getName(), local.size())).first;
+                signature << "v" << pos->second << ":" << occurrences[var->getName()] << ":"
+                          << headPositions[var->getName()] << ";";
+            } else {
+                signature << "c" << dynamic_cast<const AstConstant*>(arg)->getRamRepresentation() << ";";
             }
-        });
-        return valid;
+        }
+        signature << ")";
+        return signature.str();
     };
 
+    std::vector<std::string> body;
+    for (AstLiteral* lit : clause->getBodyLiterals()) {
+        const AstAtom* atom = dynamic_cast<AstAtom*>(lit);
+        body.push_back(toString(atom->getName()) + describe(atom));
+    }
+    std::sort(body.begin(), body.end());
+    return describe(clause->getHead()) + ":-" + toString(join(body, ","));
+}
+
+/**
+ * Check whether two clauses are bijectively equivalent.
+ */
+bool areBijectivelyEquivalent(const AstClause* left, const AstClause* right) {
     if (!isValidClause(left) || !isValidClause(right)) {
         return false;
     }
@@ -343,9 +406,15 @@ bool reduceLocallyEquivalentClauses(AstTranslationUnit& translationUnit) {
     // split up each relation's rules into equivalence classes
     // TODO (azreika): consider turning this into an ast analysis instead
     for (AstRelation* rel : program.getRelations()) {
-        std::vector<std::vector<AstClause*>> equivalenceClasses;
+        // only the clauses with the same canonical key can be equivalent
+        std::unordered_map<std::string, std::vector<std::vector<AstClause*>>> equivalenceClassesByKey;
 
         for (AstClause* clause : rel->getClauses()) {
+            if (!isValidClause(clause)) {
+                continue;
+            }
+            std::vector<std::vector<AstClause*>>& equivalenceClasses =
+                    equivalenceClassesByKey[getCanonicalKey(clause)];
             bool added = false;
 
             for (std::vector<AstClause*>& eqClass : equivalenceClasses) {
@@ -389,12 +458,20 @@ bool reduceSingletonRelations(AstTranslationUnit& translationUnit) {
     AstProgram& program = *translationUnit.getProgram();
     auto* ioTypes = translationUnit.getAnalysis<IOType>();
 
-    // Find all singleton relations to consider
-    std::vector<AstClause*> singletonRelationClauses;
+    // Find all singleton relations to consider, grouped by the canonical keys of their clauses
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, std::vector<AstClause*>> singletonRelationClauses;
     for (AstRelation* rel : program.getRelations()) {
         if (!ioTypes->isIO(rel) && rel->getClauses().size() == 1) {
             AstClause* clause = rel->getClauses()[0];
-            singletonRelationClauses.push_back(clause);
+            if (isValidClause(clause)) {
+                std::string key = getCanonicalKey(clause);
+                auto& clauses = singletonRelationClauses[key];
+                if (clauses.empty()) {
+                    keys.push_back(key);
+                }
+                clauses.push_back(clause);
+            }
         }
     }
 
@@ -404,23 +481,26 @@ bool reduceSingletonRelations(AstTranslationUnit& translationUnit) {
     // Keep track of canonical relation name for each redundant clause
     std::map<AstRelationIdentifier, AstRelationIdentifier> canonicalName;
 
-    // Check pairwise equivalence of each singleton relation
-    for (size_t i = 0; i < singletonRelationClauses.size(); i++) {
-        AstClause* first = singletonRelationClauses[i];
-        if (redundantClauses.find(first) != redundantClauses.end()) {
-            // Already found to be redundant, no need to check
-            continue;
-        }
+    // Check pairwise equivalence of each singleton relation with the same key
+    for (const std::string& key : keys) {
+        const std::vector<AstClause*>& clauses = singletonRelationClauses[key];
+        for (size_t i = 0; i < clauses.size(); i++) {
+            AstClause* first = clauses[i];
+            if (redundantClauses.find(first) != redundantClauses.end()) {
+                // Already found to be redundant, no need to check
+                continue;
+            }
 
-        for (size_t j = i + 1; j < singletonRelationClauses.size(); j++) {
-            AstClause* second = singletonRelationClauses[j];
+            for (size_t j = i + 1; j < clauses.size(); j++) {
+                AstClause* second = clauses[j];
 
-            // Note: Bijective-equivalence check does not care about the head relation name
-            if (areBijectivelyEquivalent(first, second)) {
-                AstRelationIdentifier firstName = first->getHead()->getName();
-                AstRelationIdentifier secondName = second->getHead()->getName();
-                redundantClauses.insert(second);
-                canonicalName.insert(std::pair(secondName, firstName));
+                // Note: Bijective-equivalence check does not care about the head relation name
+                if (areBijectivelyEquivalent(first, second)) {
+                    AstRelationIdentifier firstName = first->getHead()->getName();
+                    AstRelationIdentifier secondName = second->getHead()->getName();
+                    redundantClauses.insert(second);
+                    canonicalName.insert(std::pair(secondName, firstName));
+                }
             }
         }
     }
@@ -0,0 +1,293 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file NarrowSet.h
+ *
+ * This header file contains the implementation of an ordered set of
+ * tuples, whose columns are stored in words of 32 bits. The narrow
+ * columns of a tuple occupy a single word, while the other columns occupy
+ * as many words as a RamDomain value. Hence, with a 64-bit domain, the
+ * narrow columns of a tuple take half of the space of the other ones.
+ *
+ * The sign bit of each column is flipped when it is stored, such that the
+ * unsigned order of the words agrees with the lexicographic order of the
+ * signed columns. The tuples are widened to RamDomain values when they are
+ * read, and all values of the narrow columns are required to fit into 32
+ * bits.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BTree.h"
+#include "CompiledTuple.h"
+#include "RamTypes.h"
+#include "Util.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * An ordered set of tuples, storing the narrow columns of its elements in 32 bits.
+ *
+ * @tparam T the type of the elements, a tuple of RamDomain values ordered lexicographically
+ * @tparam Words the number of 32-bit words of a stored element
+ */
+template <typename T, std::size_t Words>
+class NarrowSet {
+    static constexpr std::size_t Arity = T::arity;
+
+    // the number of words of a column which is not narrow
+    static constexpr std::size_t WIDE_WORDS = sizeof(RamDomain) / sizeof(uint32_t);
+
+    // the sign bit of a column which is not narrow
+    static constexpr RamUnsigned SIGN_BIT = RamUnsigned(1) << (RAM_DOMAIN_SIZE - 1);
+
+    using Packed = ram::Tuple<uint32_t, Words>;
+    using Set = btree_set<Packed>;
+
+    // the stored elements
+    Set set;
+
+    // whether each column is narrow
+    std::array<bool, Arity> narrow;
+
+public:
+    using element_type = T;
+    using operation_hints = typename Set::operation_hints;
+
+    /**
+     * An iterator over the elements of the set, widening a single element at a time.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, T> {
+        const NarrowSet* set = nullptr;
+        typename Set::iterator pos;
+
+    public:
+        iterator() = default;
+
+        iterator(const NarrowSet* set, typename Set::iterator pos) : set(set), pos(pos) {}
+
+        T operator*() const {
+            return set->unpack(*pos);
+        }
+
+        iterator& operator++() {
+            ++pos;
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return pos != other.pos;
+        }
+    };
+
+    using chunk = range<iterator>;
+
+    /**
+     * Creates a set storing the given columns in 32 bits, where the other columns occupy the remaining
+     * words of an element.
+     */
+    NarrowSet(const std::vector<bool>& columns) {
+        assert(columns.size() == Arity && "arity mismatch of narrow columns");
+        std::size_t words = 0;
+        for (std::size_t i = 0; i < Arity; ++i) {
+            narrow[i] = columns[i];
+            words += narrow[i] ? 1 : WIDE_WORDS;
+        }
+        assert(words == Words && "narrow columns do not fill the words of an element");
+    }
+
+    NarrowSet(const NarrowSet&) = delete;
+    NarrowSet& operator=(const NarrowSet&) = delete;
+
+    bool empty() const {
+        return set.empty();
+    }
+
+    std::size_t size() const {
+        return set.size();
+    }
+
+    std::size_t getMemoryUsage() const {
+        return sizeof(*this) - sizeof(set) + set.getMemoryUsage();
+    }
+
+    auto getHintStatistics() const {
+        return set.getHintStatistics();
+    }
+
+    bool insert(const T& value) {
+        operation_hints hints;
+        return insert(value, hints);
+    }
+
+    bool insert(const T& value, operation_hints& hints) {
+        Packed packed;
+        bool fits = pack(value, packed) == 0;
+        assert(fits && "value exceeds the width of a narrow column");
+        return fits && set.insert(packed, hints);
+    }
+
+    /**
+     * Inserts the given elements, in arbitrary order.
+     */
+    void insertBulk(const std::vector<T>& data) {
+        std::vector<Packed> packed(data.size());
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            bool fits = pack(data[i], packed[i]) == 0;
+            assert(fits && "value exceeds the width of a narrow column");
+            (void)fits;
+        }
+        set.insertBulk(std::move(packed));
+    }
+
+    bool contains(const T& value) const {
+        operation_hints hints;
+        return contains(value, hints);
+    }
+
+    bool contains(const T& value, operation_hints& hints) const {
+        Packed packed;
+        return pack(value, packed) == 0 && set.contains(packed, hints);
+    }
+
+    /**
+     * Returns the least element not less than the given one, which may exceed the narrow columns.
+     */
+    iterator lower_bound(const T& value, operation_hints& hints) const {
+        Packed packed;
+        if (pack(value, packed) > 0) {
+            // the value is greater than all elements sharing the columns before the exceeding one
+            return iterator(this, set.upper_bound(packed, hints));
+        }
+        return iterator(this, set.lower_bound(packed, hints));
+    }
+
+    /**
+     * Returns the least element greater than the given one, which may exceed the narrow columns.
+     */
+    iterator upper_bound(const T& value, operation_hints& hints) const {
+        Packed packed;
+        if (pack(value, packed) < 0) {
+            // the value is less than all elements sharing the columns before the exceeding one
+            return iterator(this, set.lower_bound(packed, hints));
+        }
+        return iterator(this, set.upper_bound(packed, hints));
+    }
+
+    iterator begin() const {
+        return iterator(this, set.begin());
+    }
+
+    iterator end() const {
+        return iterator(this, set.end());
+    }
+
+    /**
+     * Partitions this set into approximately the given number of chunks of similar size.
+     */
+    std::vector<chunk> partition(std::size_t num) const {
+        std::vector<chunk> res;
+        for (const auto& cur : set.partition(num)) {
+            res.push_back(chunk(iterator(this, cur.begin()), iterator(this, cur.end())));
+        }
+        return res;
+    }
+
+    std::vector<chunk> getChunks(std::size_t num) const {
+        return partition(num);
+    }
+
+    /**
+     * Removes all elements. No other operations may be conducted concurrently.
+     */
+    void clear() {
+        set.clear();
+    }
+
+    /**
+     * Packs the elements into full, adjacent nodes. No other operations may be conducted concurrently.
+     */
+    void compact() {
+        set.compact();
+    }
+
+private:
+    /**
+     * Stores a tuple in words, flipping the sign bits of its columns. A narrow column of the tuple exceeding
+     * 32 bits is clamped, and the following columns are set to their least (or greatest) value, such that
+     * the order of the tuple among the stored elements is retained.
+     *
+     * @return -1 (or 1) if a narrow column is less (or greater) than the values of 32 bits, 0 otherwise
+     */
+    int pack(const T& value, Packed& res) const {
+        int exceeds = 0;
+        std::size_t word = 0;
+        for (std::size_t i = 0; i < Arity; ++i) {
+            if (exceeds != 0) {
+                const std::size_t words = narrow[i] ? 1 : WIDE_WORDS;
+                for (std::size_t j = 0; j < words; ++j) {
+                    res[word++] = exceeds < 0 ? 0 : std::numeric_limits<uint32_t>::max();
+                }
+                continue;
+            }
+            if (narrow[i]) {
+                RamDomain cur = value[i];
+                if (cur < std::numeric_limits<int32_t>::min()) {
+                    cur = std::numeric_limits<int32_t>::min();
+                    exceeds = -1;
+                } else if (cur > std::numeric_limits<int32_t>::max()) {
+                    cur = std::numeric_limits<int32_t>::max();
+                    exceeds = 1;
+                }
+                res[word++] = static_cast<uint32_t>(static_cast<int32_t>(cur)) ^ (uint32_t(1) << 31);
+                continue;
+            }
+            const RamUnsigned bits = ramBitCast<RamUnsigned>(value[i]) ^ SIGN_BIT;
+            for (std::size_t j = WIDE_WORDS; j-- > 0;) {
+                res[word++] = static_cast<uint32_t>(bits >> (32 * j));
+            }
+        }
+        return exceeds;
+    }
+
+    /**
+     * Widens a stored element to a tuple.
+     */
+    T unpack(const Packed& packed) const {
+        T res{};
+        std::size_t word = 0;
+        for (std::size_t i = 0; i < Arity; ++i) {
+            if (narrow[i]) {
+                res[i] = static_cast<int32_t>(packed[word++] ^ (uint32_t(1) << 31));
+                continue;
+            }
+            RamUnsigned bits = 0;
+            for (std::size_t j = 0; j < WIDE_WORDS; ++j) {
+                bits = (bits << 16 << 16) | packed[word++];
+            }
+            res[i] = ramBitCast<RamDomain>(bits ^ SIGN_BIT);
+        }
+        return res;
+    }
+};
+
+}  // end namespace souffle
@@ -0,0 +1,366 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file NodePool.h
+ *
+ * A pool allocator for the fixed-size nodes of the relation data
+ * structures (b-trees and the sparse arrays of tries).
+ *
+ * Nodes are carved out of large slabs, grouped by size classes such that
+ * node types of similar size share their slabs. Each pool is split into
+ * slots, and a thread always allocates from and releases to the slot it
+ * is assigned to. Hence, concurrent threads do not contend for a lock, and
+ * nodes released by one data structure are reused by the next one
+ * allocating nodes of the same size class, e.g. when delta relations are
+ * cleared and refilled in every iteration of a fixpoint. Slabs are only
+ * returned to the system at the end of the program.
+ *
+ * Large relations scattered over many pages of 4 KiB miss the TLB on most
+ * accesses. The environment variable SOUFFLE_HUGE_PAGES selects the pages
+ * backing the slabs: with "transparent", slabs of 2 MiB are aligned to and
+ * advised as transparent huge pages; with "2M" or "1G", slabs of that size
+ * are mapped from the huge pages reserved for hugetlbfs, falling back to
+ * transparent huge pages if none are left. Each slot of each size class
+ * used takes at least one such slab, such that 1G pays off for few threads
+ * and large relations only.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace souffle {
+
+/**
+ * The memory consumption of node pools, in bytes.
+ */
+struct NodePoolStatistics {
+    // the memory reserved by the slabs of the pools
+    std::size_t reserved = 0;
+
+    // the memory of the nodes currently in use
+    std::size_t inUse = 0;
+
+    // the memory of the slabs backed by huge pages, explicitly or as advised
+    std::size_t hugePages = 0;
+};
+
+/**
+ * The pages backing the slabs of node pools.
+ */
+enum class HugePages {
+    // regular pages of the system
+    None,
+    // slabs of 2 MiB advised as transparent huge pages
+    Transparent,
+    // slabs of 2 MiB or 1 GiB mapped from explicitly reserved huge pages
+    Explicit2M,
+    Explicit1G
+};
+
+/**
+ * A pool of memory blocks of a fixed size.
+ */
+class NodePool {
+    // the number of slots, a power of two
+    static constexpr std::size_t NUM_SLOTS = 64;
+
+    // the minimal size of a slab
+    static constexpr std::size_t MIN_SLAB_SIZE = 64 * 1024;
+
+    // the minimal number of blocks per slab
+    static constexpr std::size_t MIN_SLAB_BLOCKS = 16;
+
+    // a released block, linking to the next released block of a slot
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // a slot of the pool, padded to its own cache line
+    struct alignas(64) Slot {
+        // the lock protecting this slot against threads sharing it
+        SpinLock lock;
+
+        // the list of released blocks
+        FreeBlock* free = nullptr;
+
+        // the not yet allocated part of the current slab
+        char* cur = nullptr;
+        char* end = nullptr;
+
+        // the number of allocated minus the number of released blocks,
+        // which may be negative since blocks may be released to other slots
+        std::ptrdiff_t used = 0;
+
+        // the bytes of all slabs of this slot, and of those backed by huge pages
+        std::size_t reserved = 0;
+        std::size_t hugePages = 0;
+    };
+
+    const std::size_t blockSize;
+    const std::size_t alignment;
+    const std::size_t slabSize;
+
+    std::array<Slot, NUM_SLOTS> slots;
+
+    NodePool(std::size_t blockSize, std::size_t alignment)
+            : blockSize(blockSize), alignment(alignment),
+              slabSize(std::max(MIN_SLAB_SIZE, MIN_SLAB_BLOCKS * blockSize)) {
+        std::lock_guard<std::mutex> guard(registryLock());
+        registry().push_back(this);
+    }
+
+public:
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /**
+     * Obtains the pool for blocks of the given size and alignment. Pools
+     * are never destroyed, such that they outlive static data structures.
+     */
+    template <std::size_t Size, std::size_t Align>
+    static NodePool& get() {
+        static_assert(Align > 0 && (Align & (Align - 1)) == 0, "alignment must be a power of two");
+        return instance<sizeClass(Size, Align), std::max<std::size_t>(Align, granularity)>();
+    }
+
+    /**
+     * Allocates a block of this pool.
+     */
+    void* allocate() {
+        Slot& slot = localSlot();
+        std::lock_guard<SpinLock> guard(slot.lock);
+        slot.used++;
+        if (slot.free != nullptr) {
+            FreeBlock* res = slot.free;
+            slot.free = res->next;
+            return res;
+        }
+        return carve(slot);
+    }
+
+    /**
+     * Allocates a block of this pool from the unused part of the current slab, bypassing the
+     * released blocks, such that consecutive allocations are mostly adjacent in memory.
+     */
+    void* allocateAdjacent() {
+        Slot& slot = localSlot();
+        std::lock_guard<SpinLock> guard(slot.lock);
+        slot.used++;
+        return carve(slot);
+    }
+
+    /**
+     * Releases a block of this pool for later allocations.
+     */
+    void deallocate(void* ptr) {
+        Slot& slot = localSlot();
+        std::lock_guard<SpinLock> guard(slot.lock);
+        slot.used--;
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = slot.free;
+        slot.free = block;
+    }
+
+    /**
+     * A collection of blocks to be released, which are handed to the pool
+     * in a single operation when the batch is destroyed.
+     */
+    class Batch {
+        NodePool& pool;
+        FreeBlock* head = nullptr;
+        FreeBlock* tail = nullptr;
+        std::ptrdiff_t count = 0;
+
+    public:
+        explicit Batch(NodePool& pool) : pool(pool) {}
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+        ~Batch() {
+            if (head == nullptr) {
+                return;
+            }
+            Slot& slot = pool.localSlot();
+            std::lock_guard<SpinLock> guard(slot.lock);
+            slot.used -= count;
+            tail->next = slot.free;
+            slot.free = head;
+        }
+
+        /** Adds a block to be released. */
+        void add(void* ptr) {
+            auto* block = static_cast<FreeBlock*>(ptr);
+            block->next = head;
+            head = block;
+            if (tail == nullptr) {
+                tail = block;
+            }
+            count++;
+        }
+    };
+
+    /**
+     * Obtains the pages backing the slabs allocated from now on, as given by the environment variable
+     * SOUFFLE_HUGE_PAGES (none, transparent, 2M or 1G) unless set otherwise.
+     */
+    static HugePages getHugePages() {
+        return hugePages();
+    }
+
+    /**
+     * Sets the pages backing the slabs allocated from now on, overriding the environment; slabs
+     * allocated before are kept.
+     */
+    static void setHugePages(HugePages mode) {
+        hugePages() = mode;
+    }
+
+    /**
+     * Obtains the memory consumption of all pools, summed over their slots.
+     * Concurrent allocations may or may not be covered.
+     */
+    static NodePoolStatistics getStatistics() {
+        NodePoolStatistics res;
+        std::lock_guard<std::mutex> guard(registryLock());
+        for (NodePool* pool : registry()) {
+            std::ptrdiff_t used = 0;
+            for (Slot& slot : pool->slots) {
+                std::lock_guard<SpinLock> slotGuard(slot.lock);
+                used += slot.used;
+                res.reserved += slot.reserved;
+                res.hugePages += slot.hugePages;
+            }
+            res.inUse += static_cast<std::size_t>(std::max<std::ptrdiff_t>(used, 0)) * pool->blockSize;
+        }
+        return res;
+    }
+
+private:
+    // the granularity of the size classes
+    static constexpr std::size_t granularity = 16;
+
+    // rounds a block size up to its size class, a multiple of the granularity and the alignment
+    static constexpr std::size_t sizeClass(std::size_t size, std::size_t align) {
+        const std::size_t step = std::max(align, granularity);
+        return (std::max(size, sizeof(FreeBlock)) + step - 1) / step * step;
+    }
+
+    template <std::size_t Size, std::size_t Align>
+    static NodePool& instance() {
+        static NodePool* pool = new NodePool(Size, Align);
+        return *pool;
+    }
+
+    // the slot of the calling thread, assigning slots round robin to new threads
+    Slot& localSlot() {
+        static std::atomic<std::size_t> nextThread(0);
+        thread_local std::size_t thread = nextThread++;
+        return slots[thread & (NUM_SLOTS - 1)];
+    }
+
+    // the size of transparent huge pages and of the smaller explicit huge pages
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    // the pages backing new slabs, initially as given by the environment
+    static std::atomic<HugePages>& hugePages() {
+        static auto* mode = new std::atomic<HugePages>(parseHugePages(std::getenv("SOUFFLE_HUGE_PAGES")));
+        return *mode;
+    }
+
+    static HugePages parseHugePages(const char* mode) {
+        if (mode == nullptr) {
+            return HugePages::None;
+        } else if (std::strcmp(mode, "transparent") == 0) {
+            return HugePages::Transparent;
+        } else if (std::strcmp(mode, "2M") == 0) {
+            return HugePages::Explicit2M;
+        } else if (std::strcmp(mode, "1G") == 0) {
+            return HugePages::Explicit1G;
+        }
+        return HugePages::None;
+    }
+
+    // takes the next block of the current slab of the given slot, starting a new slab if it is used up
+    void* carve(Slot& slot) {
+        if (slot.cur == slot.end) {
+            // slabs of huge pages span whole pages
+            const HugePages mode = getHugePages();
+            std::size_t pageSize = 1;
+            if (mode == HugePages::Explicit1G) {
+                pageSize = std::size_t(1) << 30;
+            } else if (mode != HugePages::None) {
+                pageSize = HUGE_PAGE_SIZE;
+            }
+            const std::size_t size = (slabSize + pageSize - 1) / pageSize * pageSize;
+            bool huge = false;
+            slot.cur = allocateSlab(size, mode, huge);
+            slot.end = slot.cur + size / blockSize * blockSize;
+            slot.reserved += size;
+            slot.hugePages += huge ? size : 0;
+        }
+        void* res = slot.cur;
+        slot.cur += blockSize;
+        return res;
+    }
+
+    // allocates a slab of the given size backed by the given pages, falling back to transparent huge
+    // pages if no explicit huge pages are left, and to regular pages if the system has no huge pages
+    char* allocateSlab(std::size_t size, HugePages mode, bool& huge) const {
+#ifdef __linux__
+        if (mode == HugePages::Explicit2M || mode == HugePages::Explicit1G) {
+            // the page size is encoded by its logarithm, see MAP_HUGE_2MB and MAP_HUGE_1GB
+            const int log = mode == HugePages::Explicit1G ? 30 : 21;
+            void* res = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log << 26), -1, 0);
+            if (res != MAP_FAILED) {
+                huge = true;
+                return static_cast<char*>(res);
+            }
+        }
+        if (mode != HugePages::None) {
+            // only aligned ranges of 2 MiB are backed by transparent huge pages
+            void* res = ::operator new(size, std::align_val_t(std::max(alignment, HUGE_PAGE_SIZE)));
+            huge = madvise(res, size, MADV_HUGEPAGE) == 0;
+            return static_cast<char*>(res);
+        }
+#endif
+        return static_cast<char*>(::operator new(size, std::align_val_t(alignment)));
+    }
+
+    static std::vector<NodePool*>& registry() {
+        static auto* pools = new std::vector<NodePool*>();
+        return *pools;
+    }
+
+    static std::mutex& registryLock() {
+        static auto* lock = new std::mutex();
+        return *lock;
+    }
+};
+
+}  // end namespace souffle
@@ -17,7 +17,21 @@
 
 #pragma once
 
+#include "ResourceLimits.h"
+#include <algorithm>
 #include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef _OPENMP
 
@@ -35,9 +49,18 @@
 #define PARALLEL_START _Pragma("omp parallel") {
 #define PARALLEL_END }
 
+// support for a parallel region that only forks if the condition holds
+#define PARALLEL_PRAGMA(X) _Pragma(#X)
+#define PARALLEL_START_IF(COND) PARALLEL_PRAGMA(omp parallel if (COND)) {
+
 // support for parallel loops
 #define pfor _Pragma("omp for schedule(dynamic)") for
 
+// support for combining the partial results of threads
+#define PARALLEL_CRITICAL _Pragma("omp critical")
+#define PARALLEL_BARRIER _Pragma("omp barrier")
+#define PARALLEL_SINGLE _Pragma("omp single")
+
 // spawn and sync are processed sequentially (overhead to expensive)
 #define task_spawn
 #define task_sync
@@ -63,10 +86,16 @@
 // support for a parallel region => sequential execution
 #define PARALLEL_START {
 #define PARALLEL_END }
+#define PARALLEL_START_IF(COND) {
 
 // support for parallel loops => simple sequential loop
 #define pfor for
 
+// a single thread combines its partial result
+#define PARALLEL_CRITICAL
+#define PARALLEL_BARRIER
+#define PARALLEL_SINGLE
+
 // spawn and sync not supported
 #define task_spawn
 #define task_sync
@@ -570,4 +599,775 @@ inline Lock& getOutputLock() {
     return outputLock;
 }
 
+/**
+ * The threads of the processors, shared by the programs evaluated concurrently in a process.
+ *
+ * Each evaluation leases threads for its duration. An evaluation requesting a number of threads gets
+ * them; an evaluation that does not request any gets the threads not leased by other evaluations, but
+ * at least one, instead of a team of all threads, such that concurrent evaluations do not oversubscribe
+ * the processors. The threads default to the processors available to the process, bounded by the CPU
+ * quota of a container, unless the number of threads of OpenMP is set by OMP_NUM_THREADS.
+ */
+class ThreadBudget {
+public:
+    /**
+     * The threads leased by an evaluation, which are the threads of the parallel regions opened by the
+     * leasing thread until the lease ends.
+     */
+    class Lease {
+    public:
+        /** lease the given number of threads, or a share of the available threads if zero */
+        explicit Lease(std::size_t requested) : budget(ThreadBudget::instance()) {
+            {
+                std::lock_guard<std::mutex> guard(budget.lock);
+                const std::size_t available =
+                        budget.capacity > budget.leased ? budget.capacity - budget.leased : 0;
+                threads = (requested > 0) ? requested : std::max<std::size_t>(1, available);
+                budget.leased += threads;
+            }
+#ifdef IS_PARALLEL
+            previous = omp_get_max_threads();
+            omp_set_num_threads(static_cast<int>(threads));
+#endif
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease() {
+#ifdef IS_PARALLEL
+            omp_set_num_threads(previous);
+#endif
+            std::lock_guard<std::mutex> guard(budget.lock);
+            budget.leased -= threads;
+        }
+
+        /** the number of leased threads */
+        std::size_t size() const {
+            return threads;
+        }
+
+    private:
+        ThreadBudget& budget;
+        std::size_t threads;
+        int previous = 1;
+    };
+
+    /** get the budget of the process, holding the default number of threads of the first caller */
+    static ThreadBudget& instance() {
+        static ThreadBudget budget;
+        return budget;
+    }
+
+    /** set the number of threads shared by the evaluations that do not request a number of threads */
+    void setCapacity(std::size_t threads) {
+        std::lock_guard<std::mutex> guard(lock);
+        capacity = std::max<std::size_t>(1, threads);
+    }
+
+    /** get the number of threads shared by the evaluations */
+    std::size_t getCapacity() {
+        std::lock_guard<std::mutex> guard(lock);
+        return capacity;
+    }
+
+private:
+    ThreadBudget() : capacity(getDefaultCapacity()) {}
+
+    static std::size_t getDefaultCapacity() {
+        const std::size_t threads = MAX_THREADS;
+        if (std::getenv("OMP_NUM_THREADS") != nullptr) {
+            return threads;
+        }
+        return std::min(threads, ResourceLimits::getProcessors());
+    }
+
+    std::mutex lock;
+    std::size_t capacity;
+    std::size_t leased = 0;
+};
+
+/**
+ * The background threads of the process, shared by the subsystems working besides the evaluation, e.g.,
+ * by reading inputs ahead, sampling the profile and serving the live profiler.
+ *
+ * Workers are started on demand up to the capacity, which defaults to the threads of the ThreadBudget and
+ * is set by -j, and wait for further tasks once idle. Services running as long as the evaluation, e.g., a
+ * profiler waiting for input, occupy a worker beyond the capacity, such that they do not starve the short
+ * tasks. A task not taken by a worker yet is run by the thread waiting for its result, hence tasks may wait
+ * for the tasks they submit even if all workers are busy.
+ */
+class TaskPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** The result of a submitted task */
+    template <typename T>
+    class Task {
+    public:
+        Task() = default;
+
+        /** whether this refers to a submitted task */
+        bool valid() const {
+            return state != nullptr;
+        }
+
+        /** wait for the task, running it on the calling thread once due if no worker has taken it yet */
+        void wait() {
+            state->run(true);
+            state->result.wait();
+        }
+
+        /** wait for the result of the task, which is obtained once */
+        T get() {
+            auto cur = std::move(state);
+            cur->run(true);
+            return cur->result.get();
+        }
+
+    private:
+        friend class TaskPool;
+
+        struct State {
+            std::packaged_task<T()> task;
+            std::future<T> result;
+            const Clock::time_point due;
+            std::atomic<bool> taken{false};
+
+            State(std::packaged_task<T()> task, Clock::time_point due)
+                    : task(std::move(task)), result(this->task.get_future()), due(due) {}
+
+            /** run the task unless it has been taken by another thread, waiting until it is due first */
+            void run(bool early) {
+                if (!taken.exchange(true)) {
+                    if (early) {
+                        std::this_thread::sleep_until(due);
+                    }
+                    task();
+                }
+            }
+        };
+
+        std::shared_ptr<State> state;
+    };
+
+    /** get the pool of the process, which is never destroyed, such that exiting does not wait for workers */
+    static TaskPool& instance() {
+        static auto* pool = new TaskPool();
+        return *pool;
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /** set the number of workers running short tasks */
+    void setCapacity(std::size_t threads) {
+        std::lock_guard<std::mutex> guard(lock);
+        capacity = std::max<std::size_t>(1, threads);
+    }
+
+    /** get the number of workers running short tasks */
+    std::size_t getCapacity() {
+        std::lock_guard<std::mutex> guard(lock);
+        return capacity;
+    }
+
+    /** submit a short task */
+    template <typename F>
+    auto submit(F task) -> Task<decltype(task())> {
+        return enqueue(std::move(task), Clock::now(), false);
+    }
+
+    /** submit a short task, run once the given delay has passed */
+    template <typename F>
+    auto submitAfter(std::chrono::milliseconds delay, F task) -> Task<decltype(task())> {
+        return enqueue(std::move(task), Clock::now() + delay, false);
+    }
+
+    /** submit a service, running as long as the evaluation on a worker of its own */
+    template <typename F>
+    auto submitService(F task) -> Task<decltype(task())> {
+        return enqueue(std::move(task), Clock::now(), true);
+    }
+
+private:
+    TaskPool() : capacity(ThreadBudget::instance().getCapacity()) {}
+
+    /** a queued task, run by a worker once it is due */
+    struct Entry {
+        std::function<void()> run;
+        bool service;
+    };
+
+    template <typename F>
+    auto enqueue(F task, Clock::time_point due, bool service) -> Task<decltype(task())> {
+        using T = decltype(task());
+        Task<T> res;
+        res.state = std::make_shared<typename Task<T>::State>(std::packaged_task<T()>(std::move(task)), due);
+        std::lock_guard<std::mutex> guard(lock);
+        queue.emplace(due, Entry{[state = res.state]() { state->run(false); }, service});
+        if (service) {
+            services++;
+        }
+        if (idle == 0 && workers.size() < capacity + services) {
+            workers.emplace_back([this]() { work(); });
+        } else {
+            changed.notify_one();
+        }
+        return res;
+    }
+
+    /** run the due tasks, waiting for the next one while there are none */
+    void work() {
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;) {
+            if (queue.empty() || queue.begin()->first > Clock::now()) {
+                idle++;
+                if (queue.empty()) {
+                    changed.wait(guard);
+                } else {
+                    const Clock::time_point due = queue.begin()->first;
+                    changed.wait_until(guard, due);
+                }
+                idle--;
+                continue;
+            }
+            Entry entry = std::move(queue.begin()->second);
+            queue.erase(queue.begin());
+            guard.unlock();
+            entry.run();
+            guard.lock();
+            if (entry.service) {
+                services--;
+            }
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::multimap<Clock::time_point, Entry> queue;
+    std::vector<std::thread> workers;
+    std::size_t capacity;
+    std::size_t idle = 0;
+    std::size_t services = 0;
+};
+
+/**
+ * A step run by the task pool periodically, e.g., sampling the utilisation of the processors, until the
+ * step returns false or the task is stopped. Steps never run concurrently.
+ */
+class PeriodicTask {
+public:
+    PeriodicTask(std::function<bool()> step, std::chrono::milliseconds interval)
+            : state(std::make_shared<State>(std::move(step), interval)) {}
+
+    PeriodicTask(const PeriodicTask&) = delete;
+    PeriodicTask& operator=(const PeriodicTask&) = delete;
+
+    ~PeriodicTask() {
+        stop();
+    }
+
+    /** start running the step after the given delay, and then every interval */
+    void start(std::chrono::milliseconds delay = std::chrono::milliseconds(0)) {
+        if (state->running.exchange(true)) {
+            return;
+        }
+        schedule(state, ++state->generation, delay);
+    }
+
+    /** stop running the step, waiting for a running step */
+    void stop() {
+        state->running = false;
+        std::lock_guard<std::mutex> guard(state->lock);
+    }
+
+    /** set the interval between the steps scheduled from now on */
+    void setInterval(std::chrono::milliseconds interval) {
+        state->interval = interval.count();
+    }
+
+    /** get the interval between the steps */
+    std::chrono::milliseconds getInterval() const {
+        return std::chrono::milliseconds(state->interval);
+    }
+
+    /** run the step now, and then every interval */
+    void restart() {
+        if (state->running) {
+            schedule(state, ++state->generation, std::chrono::milliseconds(0));
+        }
+    }
+
+private:
+    /** the state shared with the scheduled steps, which may outlive the task */
+    struct State {
+        std::function<bool()> step;
+        std::atomic<std::chrono::milliseconds::rep> interval;
+        std::atomic<bool> running{false};
+        std::atomic<std::size_t> generation{0};
+        std::mutex lock;
+
+        State(std::function<bool()> step, std::chrono::milliseconds interval)
+                : step(std::move(step)), interval(interval.count()) {}
+    };
+
+    /** schedule a step, which is skipped if the task has been stopped or restarted since */
+    static void schedule(
+            std::shared_ptr<State> state, std::size_t generation, std::chrono::milliseconds delay) {
+        TaskPool::instance().submitAfter(delay, [state, generation]() {
+            std::lock_guard<std::mutex> guard(state->lock);
+            if (!state->running || state->generation != generation) {
+                return;
+            }
+            if (!state->step()) {
+                state->running = false;
+                return;
+            }
+            schedule(state, generation, std::chrono::milliseconds(state->interval));
+        });
+    }
+
+    std::shared_ptr<State> state;
+};
+
+/**
+ * Sorts the given random-access range utilizing all available threads. The range is split into one
+ * chunk per thread, the chunks are sorted concurrently and merged pairwise afterwards.
+ */
+template <typename Iter, typename Compare>
+void parallelSort(Iter begin, Iter end, Compare comp) {
+    const std::size_t length = end - begin;
+    const std::size_t numChunks = std::min<std::size_t>(MAX_THREADS, length / 1024 + 1);
+    if (numChunks <= 1) {
+        std::sort(begin, end, comp);
+        return;
+    }
+
+    std::vector<Iter> bounds;
+    for (std::size_t i = 0; i <= numChunks; ++i) {
+        bounds.push_back(begin + (length * i) / numChunks);
+    }
+    PARALLEL_START
+        pfor(std::size_t i = 0; i < numChunks; ++i) {
+            std::sort(bounds[i], bounds[i + 1], comp);
+        }
+    PARALLEL_END;
+    for (std::size_t width = 1; width < numChunks; width *= 2) {
+        PARALLEL_START
+            pfor(std::size_t i = 0; i < numChunks; i += 2 * width) {
+                if (i + width < numChunks) {
+                    std::inplace_merge(bounds[i], bounds[i + width],
+                            bounds[std::min(i + 2 * width, numChunks)], comp);
+                }
+            }
+        PARALLEL_END;
+    }
+}
+
+/**
+ * Evaluates the tasks 0..n-1 where task i may only start once all tasks in dependencies[i] are done.
+ * Dependencies must refer to preceding tasks, so evaluating the tasks in order is a valid schedule.
+ * Ready tasks are spawned as OpenMP tasks that are picked up by idle threads; each task may use at
+ * most the given number of threads for its own parallel regions, where zero divides the threads
+ * evenly among the tasks that may run at the same time.
+ */
+inline void parallelSchedule(const std::vector<std::vector<std::size_t>>& dependencies, std::size_t jobs,
+        const std::function<void(std::size_t)>& run) {
+    const std::size_t numTasks = dependencies.size();
+#ifdef IS_PARALLEL
+    // the maximal number of tasks on the same level bounds the number of concurrent tasks
+    std::vector<std::size_t> level(numTasks, 0);
+    std::vector<std::size_t> levelWidth(numTasks + 1, 0);
+    std::vector<std::vector<std::size_t>> successors(numTasks);
+    std::unique_ptr<std::atomic<std::size_t>[]> pending(new std::atomic<std::size_t>[numTasks]);
+    for (std::size_t task = 0; task < numTasks; ++task) {
+        pending[task] = dependencies[task].size();
+        for (std::size_t dep : dependencies[task]) {
+            assert(dep < task && "dependency on a subsequent task");
+            level[task] = std::max(level[task], level[dep] + 1);
+            successors[dep].push_back(task);
+        }
+        levelWidth[level[task]]++;
+    }
+    const std::size_t width = *std::max_element(levelWidth.begin(), levelWidth.end());
+    if (width <= 1) {
+        for (std::size_t task = 0; task < numTasks; ++task) {
+            run(task);
+        }
+        return;
+    }
+    const std::size_t maxThreads = omp_get_max_threads();
+    const std::size_t taskThreads = (jobs > 0) ? jobs : std::max<std::size_t>(1, maxThreads / width);
+    const std::size_t teamSize = std::max<std::size_t>(1, std::min(width, maxThreads / taskThreads));
+
+    // tasks open nested parallel regions, also if the schedule is itself evaluated by a task
+    const int activeLevels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(activeLevels, omp_get_active_level() + 2));
+
+    // tasks copy captured variables, hence they only get hold of pointers to the shared state
+    std::function<void(std::size_t)> spawn = [&](std::size_t task) {
+        const auto* spawnTask = &spawn;
+        const auto* runTask = &run;
+        const auto* taskSuccessors = &successors[task];
+        std::atomic<std::size_t>* pendingDeps = pending.get();
+#pragma omp task firstprivate(task, spawnTask, runTask, taskSuccessors, pendingDeps)
+        {
+            omp_set_num_threads(static_cast<int>(taskThreads));
+            (*runTask)(task);
+            for (std::size_t succ : *taskSuccessors) {
+                if (--pendingDeps[succ] == 0) {
+                    (*spawnTask)(succ);
+                }
+            }
+        }
+    };
+#pragma omp parallel num_threads(teamSize)
+#pragma omp single
+    for (std::size_t task = 0; task < numTasks; ++task) {
+        if (dependencies[task].empty()) {
+            spawn(task);
+        }
+    }
+
+    omp_set_max_active_levels(activeLevels);
+#else
+    (void)jobs;
+    for (std::size_t task = 0; task < numTasks; ++task) {
+        run(task);
+    }
+#endif
+}
+
+/**
+ * A counter handing out unique values to concurrent threads without contention. Each thread reserves a
+ * block of consecutive values of the shared counter at a time, and takes the values of its block without
+ * synchronisation. Hence, the values are unique, but neither dense nor ordered, unless they are all taken
+ * by a single thread.
+ */
+template <typename T>
+class BlockCounter {
+public:
+    /** the number of values reserved by a thread at a time */
+    static constexpr T BLOCK_SIZE = 4096;
+
+    BlockCounter() : id(nextId()) {}
+
+    BlockCounter(const BlockCounter&) = delete;
+    BlockCounter& operator=(const BlockCounter&) = delete;
+
+    /** take the next value of the block of the calling thread */
+    T operator++(int) {
+        Block& block = getBlock();
+        if (block.counter != id || block.next == block.end) {
+            block.counter = id;
+            block.next = next.fetch_add(BLOCK_SIZE, std::memory_order_relaxed);
+            block.end = block.next + BLOCK_SIZE;
+        }
+        return block.next++;
+    }
+
+private:
+    /** the block of a thread, reserved from the counter of the given id */
+    struct Block {
+        std::size_t counter = 0;
+        T next = 0;
+        T end = 0;
+    };
+
+    /** get the block of the calling thread, which only holds values of its most recently used counter */
+    static Block& getBlock() {
+        static thread_local Block block;
+        return block;
+    }
+
+    /** get a new id, such that the blocks of a destroyed counter are not taken from its successors */
+    static std::size_t nextId() {
+        static std::atomic<std::size_t> ids(1);
+        return ids++;
+    }
+
+    const std::size_t id;
+    std::atomic<T> next{0};
+};
+
+/** Minimal number of tuples per chunk of a parallel loop, amortising the cost of scheduling the chunk */
+constexpr std::size_t MIN_CHUNK_TUPLES = 256;
+
+/** Maximal number of chunks per thread of a parallel loop, leaving room for work stealing to balance skew */
+constexpr std::size_t MAX_CHUNKS_PER_THREAD = 16;
+
+/**
+ * Determines the number of chunks a parallel loop over the given number of tuples is split into.
+ * Small inputs result in a single chunk, i.e., they are not worth forking a parallel region for,
+ * while large inputs are over-split into up to maxChunks chunks.
+ */
+inline std::size_t parallelChunkCount(
+        std::size_t tuples, std::size_t maxChunks = MAX_CHUNKS_PER_THREAD * MAX_THREADS) {
+    return std::max<std::size_t>(1, std::min(maxChunks, tuples / MIN_CHUNK_TUPLES));
+}
+
+/**
+ * The utilisation of the threads of the executions of a parallel loop, summed over the executions. Times
+ * are in microseconds; chunks are the indices of the loop, i.e., the parts of a partitioned relation.
+ */
+struct ParallelLoopStatistics {
+    /** the executions of the loop, and those forking a team of several threads */
+    std::size_t executions = 0;
+    std::size_t forked = 0;
+    /** the threads working on the loop */
+    std::size_t threads = 0;
+    /** the time the threads worked, and the time they waited for the last thread to finish */
+    std::size_t busy = 0;
+    std::size_t idle = 0;
+    /** the time of the last thread to finish, i.e., the time of the loop */
+    std::size_t critical = 0;
+    /** the chunks processed, and the chunks of the thread processing the most of them */
+    std::size_t chunks = 0;
+    std::size_t maxChunks = 0;
+
+    ParallelLoopStatistics& operator+=(const ParallelLoopStatistics& other) {
+        executions += other.executions;
+        forked += other.forked;
+        threads += other.threads;
+        busy += other.busy;
+        idle += other.idle;
+        critical += other.critical;
+        chunks += other.chunks;
+        maxChunks += other.maxChunks;
+        return *this;
+    }
+};
+
+/**
+ * Distributes the indices [0, n) of a parallel loop among the threads of a parallel region by work
+ * stealing. Each thread starts on a contiguous block of indices; once its block is exhausted, it
+ * steals the upper half of the remaining block of another thread. Neighbouring chunks hence stay on
+ * the same thread, while skewed chunks are balanced by recursively splitting the remaining blocks.
+ *
+ * The loop is created before the parallel region and shared by all its threads, see pfor_steal.
+ */
+class WorkStealingLoop {
+public:
+    /**
+     * Create a loop over the given number of indices; a profiled loop records the indices taken by each
+     * thread and the time it ran out of work, see getStatistics()
+     */
+    WorkStealingLoop(std::size_t size, bool profiled = false)
+#ifdef IS_PARALLEL
+            : numSlots(std::max(1, omp_get_max_threads())), slots(new Slot[numSlots]) {
+        for (std::size_t i = 0; i < numSlots; ++i) {
+            slots[i].begin = size * i / numSlots;
+            slots[i].end = size * (i + 1) / numSlots;
+        }
+#else
+            : size(size) {
+#endif
+        if (profiled) {
+            start = std::chrono::steady_clock::now();
+            threads.reset(new ThreadProfile[numSlots]);
+        }
+    }
+
+    /** Obtains the next index for the calling thread, returns false once all indices are taken */
+    bool next(std::size_t& index) {
+#ifdef IS_PARALLEL
+        const std::size_t self = omp_get_thread_num();
+        if (self < numSlots) {
+            Slot& own = slots[self];
+            own.lock.lock();
+            if (own.begin < own.end) {
+                index = own.begin++;
+                own.lock.unlock();
+                return taken(self);
+            }
+            own.lock.unlock();
+        }
+        for (std::size_t i = 1; i <= numSlots; ++i) {
+            Slot& victim = slots[(self + i) % numSlots];
+            victim.lock.lock();
+            if (victim.begin == victim.end) {
+                victim.lock.unlock();
+                continue;
+            }
+            // threads without a block of their own only take a single index
+            if (self >= numSlots) {
+                index = --victim.end;
+                victim.lock.unlock();
+                return taken(self);
+            }
+            const std::size_t mid = victim.begin + (victim.end - victim.begin) / 2;
+            const std::size_t stolenEnd = victim.end;
+            victim.end = mid;
+            victim.lock.unlock();
+            Slot& own = slots[self];
+            own.lock.lock();
+            own.begin = mid + 1;
+            own.end = stolenEnd;
+            own.lock.unlock();
+            index = mid;
+            return taken(self);
+        }
+        return finished(self);
+#else
+        if (current < size) {
+            index = current++;
+            return taken(0);
+        }
+        return finished(0);
+#endif
+    }
+
+    /**
+     * The utilisation of the threads of a profiled loop, once the parallel region running it has ended.
+     * Each thread is busy from the start of the loop until it runs out of work, and idles from then on
+     * until the last thread runs out of work, i.e., at the barrier closing the region.
+     */
+    ParallelLoopStatistics getStatistics() const {
+        ParallelLoopStatistics statistics;
+        if (!threads) {
+            return statistics;
+        }
+        statistics.executions = 1;
+        std::vector<std::size_t> busy;
+        for (std::size_t i = 0; i < numSlots; ++i) {
+            const ThreadProfile& thread = threads[i];
+            if (thread.done) {
+                busy.push_back(std::chrono::duration_cast<std::chrono::microseconds>(thread.finish - start)
+                                       .count());
+                statistics.chunks += thread.chunks;
+                statistics.maxChunks = std::max(statistics.maxChunks, thread.chunks);
+            }
+        }
+        statistics.threads = busy.size();
+        statistics.forked = busy.size() > 1 ? 1 : 0;
+        for (std::size_t cur : busy) {
+            statistics.critical = std::max(statistics.critical, cur);
+            statistics.busy += cur;
+        }
+        statistics.idle = statistics.critical * busy.size() - statistics.busy;
+        return statistics;
+    }
+
+private:
+    /** The work of a thread of a profiled loop, padded against false sharing */
+    struct alignas(64) ThreadProfile {
+        std::size_t chunks = 0;
+        bool done = false;
+        std::chrono::steady_clock::time_point finish;
+    };
+
+    /** Count an index taken by the given thread */
+    bool taken(std::size_t self) {
+        if (threads && self < numSlots) {
+            ++threads[self].chunks;
+        }
+        return true;
+    }
+
+    /** Record the time the given thread ran out of work */
+    bool finished(std::size_t self) {
+        if (threads && self < numSlots && !threads[self].done) {
+            threads[self].done = true;
+            threads[self].finish = std::chrono::steady_clock::now();
+        }
+        return false;
+    }
+
+#ifdef IS_PARALLEL
+    /** The remaining block of a thread, padded against false sharing */
+    struct alignas(64) Slot {
+        SpinLock lock;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    const std::size_t numSlots;
+    std::unique_ptr<Slot[]> slots;
+#else
+    static constexpr std::size_t numSlots = 1;
+    const std::size_t size;
+    std::size_t current = 0;
+#endif
+
+    /** The start of a profiled loop and the work of each of its threads, null unless profiled */
+    std::chrono::steady_clock::time_point start;
+    std::unique_ptr<ThreadProfile[]> threads;
+};
+
+// support for parallel loops over a list of chunks distributed by a WorkStealingLoop
+#define pfor_steal(IT, CHUNKS, LOOP)                         \
+    for (std::size_t IT##_index = 0; LOOP.next(IT##_index);) \
+        if (auto IT = CHUNKS.begin() + IT##_index; false) {  \
+        } else
+
+/**
+ * Inserts the sorted buffers of the threads of a parallel region by ranges of their order, such that the
+ * threads insert in parallel into disjoint ranges of the target instead of one buffer after the other.
+ *
+ * Must be called by all threads of the innermost parallel region, each with its buffer sorted by the given
+ * order. Splitters sampled from all buffers cut the order into one range per thread, and each thread
+ * inserts the tuples of its range from all buffers, in order. The target must support concurrent
+ * insertions. Returns false without inserting any tuple if the region has a single thread, such that the
+ * caller may insert its buffer at once instead.
+ */
+template <typename T, typename Less, typename Insert>
+bool insertByRanges(const std::vector<T>& buffer, Less less, Insert insert) {
+#ifdef IS_PARALLEL
+    const std::size_t threads = omp_get_num_threads();
+    if (threads > 1) {
+        struct Shared {
+            std::vector<const std::vector<T>*> buffers;
+            std::vector<T> splitters;
+        };
+        Shared* shared = nullptr;
+#pragma omp single copyprivate(shared)
+        shared = new Shared{std::vector<const std::vector<T>*>(threads), {}};
+        const std::size_t self = omp_get_thread_num();
+        shared->buffers[self] = &buffer;
+#pragma omp barrier
+#pragma omp single
+        {
+            // each buffer contributes samples in proportion to its size
+            std::size_t total = 0;
+            for (const auto* cur : shared->buffers) {
+                total += cur->size();
+            }
+            std::vector<T> samples;
+            const std::size_t step = std::max<std::size_t>(1, total / (threads * threads));
+            for (const auto* cur : shared->buffers) {
+                for (std::size_t i = step / 2; i < cur->size(); i += step) {
+                    samples.push_back((*cur)[i]);
+                }
+            }
+            std::sort(samples.begin(), samples.end(), less);
+            for (std::size_t i = 1; i < threads && !samples.empty(); ++i) {
+                shared->splitters.push_back(samples[i * samples.size() / threads]);
+            }
+        }
+        const std::vector<T>& splitters = shared->splitters;
+        for (const auto* cur : shared->buffers) {
+            auto begin = cur->begin();
+            auto end = cur->end();
+            if (self > 0) {
+                begin = self <= splitters.size()
+                                ? std::lower_bound(cur->begin(), cur->end(), splitters[self - 1], less)
+                                : cur->end();
+            }
+            if (self < splitters.size()) {
+                end = std::lower_bound(begin, cur->end(), splitters[self], less);
+            }
+            for (auto it = begin; it < end; ++it) {
+                insert(*it);
+            }
+        }
+#pragma omp barrier
+#pragma omp single nowait
+        delete shared;
+        return true;
+    }
+#endif
+    return false;
+}
+
 }  // end of namespace souffle
@@ -50,7 +50,7 @@ std::unique_ptr<AstTranslationUnit> ParserDriver::parse(const std::string& filen
             std::make_unique<AstProgram>(), symbolTable, errorReport, debugReport);
     yyscan_t scanner;
     scanner_data data;
-    data.yyfilename = filename;
+    data.yylloc.setFilename(filename);
     yylex_init_extra(&data, &scanner);
     yyset_in(in, scanner);
 
@@ -70,7 +70,7 @@ std::unique_ptr<AstTranslationUnit> ParserDriver::parse(const std::string& code,
             std::make_unique<AstProgram>(), symbolTable, errorReport, debugReport);
 
     scanner_data data;
-    data.yyfilename = "<in-memory>";
+    data.yylloc.setFilename("<in-memory>");
     yyscan_t scanner;
     yylex_init_extra(&data, &scanner);
     yy_scan_string(code.c_str(), scanner);
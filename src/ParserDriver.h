@@ -41,10 +41,8 @@ class SymbolTable;
 using yyscan_t = void*;
 
 struct scanner_data {
+    /* The location of the current token, which refers to the file being parsed */
     SrcLocation yylloc;
-
-    /* Stack of parsed files */
-    std::string yyfilename;
 };
 
 class ParserDriver {
@@ -0,0 +1,101 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file PhaseTimes.h
+ *
+ * Records the time taken by each phase of the compiler: parsing, each AST transformer, the
+ * translation to RAM, each RAM transformer, the synthesis of C++ code and its compilation.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "json11.h"
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * The times of the phases of the compiler, written as JSON to the file given by --phase-times
+ * once the compiler exits, such that the turnaround of large programs can be broken down and
+ * tracked by scripts. Phases are listed in the order they ran; a transformer applied repeatedly,
+ * e.g. in a loop of transformers, is listed once for each application.
+ *
+ * The file is a JSON object with the program and its phases, e.g.
+ * {"program": "a.dl", "phases": [{"phase": "parse", "name": "parser", "seconds": 0.02},
+ *  {"phase": "ast-transform", "name": "MagicSetTransformer", "seconds": 0.01, "changed": false}, ...]}
+ */
+class PhaseTimes {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static PhaseTimes& instance() {
+        static PhaseTimes singleton;
+        return singleton;
+    }
+
+    /** Record the phases of the compilation of the given program into the given file */
+    void setOutputFile(const std::string& file, const std::string& program) {
+        outputFile = file;
+        programName = program;
+    }
+
+    /** Whether the phases are recorded */
+    bool isEnabled() const {
+        return !outputFile.empty();
+    }
+
+    /** Record a phase of the given kind and name that started at the given time */
+    void record(const std::string& phase, const std::string& name, clock::time_point start) {
+        if (isEnabled()) {
+            add(json11::Json::object{{"phase", phase}, {"name", name}, {"seconds", since(start)}});
+        }
+    }
+
+    /** Record a transformer that started at the given time, and whether it changed the program */
+    void record(const std::string& phase, const std::string& name, clock::time_point start, bool changed) {
+        if (isEnabled()) {
+            add(json11::Json::object{
+                    {"phase", phase}, {"name", name}, {"seconds", since(start)}, {"changed", changed}});
+        }
+    }
+
+private:
+    PhaseTimes() = default;
+
+    static double since(clock::time_point start) {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    void add(json11::Json::object entry) {
+        std::lock_guard<std::mutex> guard(lock);
+        phases.emplace_back(std::move(entry));
+    }
+
+    ~PhaseTimes() {
+        if (!isEnabled()) {
+            return;
+        }
+        std::ofstream os(outputFile);
+        os << json11::Json(json11::Json::object{{"program", programName}, {"phases", phases}}).dump()
+           << std::endl;
+    }
+
+    std::string outputFile;
+    std::string programName;
+    std::vector<json11::Json> phases;
+    std::mutex lock;
+};
+
+}  // end of namespace souffle
@@ -3,6 +3,7 @@
 #include "ParallelUtils.h"
 #include <array>
 #include <atomic>
+#include <cassert>
 #include <cstring>
 #include <iostream>
 #include <list>
@@ -108,6 +109,19 @@ public:
         freeList();
         numElements.store(0);
     }
+
+    /**
+     * Return an estimate of the number of bytes of memory occupied by this list
+     */
+    size_t getMemoryUsage() const {
+        size_t res = sizeof(*this);
+        for (size_t i = 0; i < maxContainers; ++i) {
+            if (blockLookupTable[i].load() != nullptr) {
+                res += (INITIALBLOCKSIZE << i) * sizeof(T);
+            }
+        }
+        return res;
+    }
     const size_t BLOCKBITS = 16ul;
     const size_t INITIALBLOCKSIZE = (1ul << BLOCKBITS);
 
@@ -249,6 +263,13 @@ public:
         container_size = 0;
     }
 
+    /**
+     * Return an estimate of the number of bytes of memory occupied by this list
+     */
+    size_t getMemoryUsage() const {
+        return sizeof(*this) + container_size.load() * sizeof(T);
+    }
+
     class iterator : std::iterator<std::forward_iterator_tag, T> {
         size_t cIndex = 0;
         PiggyList* bl;
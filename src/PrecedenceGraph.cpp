@@ -433,6 +433,10 @@ void RelationScheduleStep::print(std::ostream& os) const {
     for (const AstRelation* compRel : expired()) {
         os << compRel->getName() << ", ";
     }
+    os << "\ndepends on: ";
+    for (size_t step : dependencies()) {
+        os << step << ", ";
+    }
     os << "\n";
     if (recursive()) {
         os << "recursive";
@@ -450,13 +454,26 @@ void RelationSchedule::run(const AstTranslationUnit& translationUnit) {
     std::vector<std::set<const AstRelation*>> relationExpirySchedule =
             computeRelationExpirySchedule(translationUnit);
 
+    const auto& sccGraph = translationUnit.getAnalysis<SCCGraph>();
     relationSchedule.clear();
     for (size_t i = 0; i < numSCCs; i++) {
         auto scc = topsortSCCGraph->order()[i];
-        const std::set<const AstRelation*> computedRelations =
-                translationUnit.getAnalysis<SCCGraph>()->getInternalRelations(scc);
-        relationSchedule.emplace_back(computedRelations, relationExpirySchedule[i],
-                translationUnit.getAnalysis<SCCGraph>()->isRecursive(scc));
+        const std::set<const AstRelation*> computedRelations = sccGraph->getInternalRelations(scc);
+
+        // steps computing the predecessors of this step
+        std::set<size_t> dependencies = topsortSCCGraph->indexOfScc(sccGraph->getPredecessorSCCs(scc));
+
+        // an expired relation may be dropped once the step computing it and all steps using it are done
+        std::set<size_t> expiryDependencies;
+        for (const AstRelation* rel : relationExpirySchedule[i]) {
+            expiryDependencies.insert(topsortSCCGraph->indexOfScc(sccGraph->getSCC(rel)));
+            for (const AstRelation* successor : precedenceGraph->graph().successors(rel)) {
+                expiryDependencies.insert(topsortSCCGraph->indexOfScc(sccGraph->getSCC(successor)));
+            }
+        }
+
+        relationSchedule.emplace_back(computedRelations, relationExpirySchedule[i], std::move(dependencies),
+                std::move(expiryDependencies), sccGraph->isRecursive(scc));
     }
 }
 
@@ -495,6 +512,22 @@ std::vector<std::set<const AstRelation*>> RelationSchedule::computeRelationExpir
                         relationExpirySchedule[numSCCs - orderedSCC].end()));
     }
 
+    /* Relations which are not used by later steps, such as output relations, expire at the step computing
+       them if their memory is to be freed as early as possible, i.e., once they have been written. */
+    if (Global::config().has("free-relations")) {
+        std::set<const AstRelation*> expired;
+        for (const auto& step : relationExpirySchedule) {
+            expired.insert(step.begin(), step.end());
+        }
+        for (size_t i = 0; i < numSCCs; i++) {
+            for (const AstRelation* r : sccGraph->getInternalRelations(topsortSCCGraph->order()[i])) {
+                if (expired.count(r) == 0) {
+                    relationExpirySchedule[i].insert(r);
+                }
+            }
+        }
+    }
+
     return relationExpirySchedule;
 }
 
@@ -343,19 +343,25 @@ public:
 
 /**
  * A single step in a relation schedule, consisting of the relations computed in the step
- * and the relations that are no longer required at that step.
+ * and the relations that are no longer required at that step. Besides its position in the
+ * linear schedule, a step records the preceding steps it depends on, so that steps without
+ * a dependency path in between may be evaluated concurrently.
  */
 class RelationScheduleStep {
 private:
     std::set<const AstRelation*> computedRelations;
     std::set<const AstRelation*> expiredRelations;
+    std::set<size_t> dependentSteps;
+    std::set<size_t> expiryDependentSteps;
     const bool isRecursive;
 
 public:
     RelationScheduleStep(std::set<const AstRelation*> computedRelations,
-            std::set<const AstRelation*> expiredRelations, const bool isRecursive)
+            std::set<const AstRelation*> expiredRelations, std::set<size_t> dependentSteps,
+            std::set<size_t> expiryDependentSteps, const bool isRecursive)
             : computedRelations(std::move(computedRelations)), expiredRelations(std::move(expiredRelations)),
-              isRecursive(isRecursive) {}
+              dependentSteps(std::move(dependentSteps)),
+              expiryDependentSteps(std::move(expiryDependentSteps)), isRecursive(isRecursive) {}
 
     const std::set<const AstRelation*>& computed() const {
         return computedRelations;
@@ -365,6 +371,16 @@ public:
         return expiredRelations;
     }
 
+    /** Preceding steps computing relations used by this step */
+    const std::set<size_t>& dependencies() const {
+        return dependentSteps;
+    }
+
+    /** Steps that must be completed before the expired relations of this step can be dropped */
+    const std::set<size_t>& expiryDependencies() const {
+        return expiryDependentSteps;
+    }
+
     bool recursive() const {
         return isRecursive;
     }
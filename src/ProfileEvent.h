@@ -17,27 +17,185 @@
 #pragma once
 
 #include "EventProcessor.h"
+#include "HyperLogLog.h"
+#include "ParallelUtils.h"
 #include "ProfileDatabase.h"
+#include "ProfileStream.h"
+#include "SignalHandler.h"
 #include "Util.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <functional>
+#include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <sys/resource.h>
 #include <sys/time.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace souffle {
 
+/**
+ * Hardware performance counters of the calling thread, counting the retired instructions, cache
+ * misses and branch misses in user space. The counters are opened by perf_event_open on Linux;
+ * counters that are not supported, or not permitted by the perf_event_paranoid setting of the
+ * kernel, read as zero.
+ *
+ * The counters only count the thread they were opened by, i.e. the thread evaluating a timed
+ * region, but not the worker threads of the parallel operations within that region.
+ */
+class HardwareCounters {
+public:
+    /** number of counters */
+    static constexpr std::size_t size = 3;
+
+    using Counts = std::array<uint64_t, size>;
+
+    /** get the counters of the calling thread */
+    static HardwareCounters& forThread() {
+        thread_local HardwareCounters counters;
+        return counters;
+    }
+
+    /** read the counts so far */
+    Counts read() const {
+        Counts counts{};
+#ifdef __linux__
+        for (std::size_t i = 0; i < size; ++i) {
+            if (fds[i] < 0 || ::read(fds[i], &counts[i], sizeof(uint64_t)) != sizeof(uint64_t)) {
+                counts[i] = 0;
+            }
+        }
+#endif
+        return counts;
+    }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    ~HardwareCounters() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+private:
+#ifdef __linux__
+    HardwareCounters() {
+        const uint64_t events[size] = {
+                PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (std::size_t i = 0; i < size; ++i) {
+            struct perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = events[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    }
+
+    /** file descriptors of the counters, or -1 for counters that could not be opened */
+    int fds[size];
+#else
+    HardwareCounters() = default;
+#endif
+};
+
+/**
+ * A profile event recorded in binary form by an evaluating thread, such that parsing its text and
+ * adding it to the profile database is deferred to the folding of the event log
+ */
+struct ProfileEventRecord {
+    /** kind of the event, determining the meaning of its values */
+    profile::EventKind kind;
+
+    /** text of the event, interned by the log of the recording thread */
+    const std::string* text;
+
+    /** times in microseconds and sizes of the event */
+    uint64_t values[6];
+};
+
+/**
+ * Log of the profile events of a single thread
+ *
+ * The log is a ring buffer with a single producer, the thread owning it, which appends records
+ * without locking. Records are consumed by folding them into the profile database, and the
+ * profile stream if there is one, under the lock of the log; the producer folds its own log only
+ * if the buffer is full.
+ */
+class ProfileEventLog {
+    /** number of records of the buffer, a power of two */
+    static constexpr std::size_t capacity = 1 << 14;
+
+    std::vector<ProfileEventRecord> buffer = std::vector<ProfileEventRecord>(capacity);
+
+    /** number of records consumed and produced so far */
+    std::atomic<std::size_t> head{0};
+    std::atomic<std::size_t> tail{0};
+
+    /** texts of the events; nodes of the set remain at their address once inserted */
+    std::unordered_set<std::string> texts;
+
+    /** lock of consumers */
+    std::mutex consumer;
+
+public:
+    /** append a record, folding the log if its buffer is full */
+    void append(profile::EventKind kind, const std::string& txt, std::initializer_list<uint64_t> values,
+            profile::ProfileDatabase& db, profile::ProfileStreamWriter* stream = nullptr) {
+        const std::size_t pos = tail.load(std::memory_order_relaxed);
+        if (pos - head.load(std::memory_order_acquire) == capacity) {
+            fold(db, stream);
+        }
+        ProfileEventRecord& record = buffer[pos & (capacity - 1)];
+        record.kind = kind;
+        record.text = &*texts.insert(txt).first;
+        std::copy(values.begin(), values.end(), record.values);
+        tail.store(pos + 1, std::memory_order_release);
+    }
+
+    /** add the records produced so far to the profile database and the profile stream */
+    void fold(profile::ProfileDatabase& db, profile::ProfileStreamWriter* stream = nullptr) {
+        std::lock_guard<std::mutex> guard(consumer);
+        const std::size_t end = tail.load(std::memory_order_acquire);
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        for (; pos != end; ++pos) {
+            const ProfileEventRecord& record = buffer[pos & (capacity - 1)];
+            profile::processEvent(db, record.kind, record.text->c_str(), record.values);
+            if (stream != nullptr) {
+                stream->write(record.kind, *record.text, record.values);
+            }
+        }
+        head.store(pos, std::memory_order_release);
+    }
+};
+
 /**
  * Profile Event Singleton
  */
@@ -46,8 +204,32 @@ class ProfileEventSingleton {
     profile::ProfileDatabase database;
     std::string filename{""};
 
+    /** profile stream the events are written to, if the output file has the extension "bin" */
+    std::unique_ptr<profile::ProfileStreamWriter> stream;
+
+    /** event logs of the threads that recorded events */
+    std::list<ProfileEventLog> logs;
+    std::mutex logsLock;
+
+    /** whether hardware counters are recorded for timed rules and relations */
+    bool counters = false;
+
+    /** the maximum resident set size (kb) last sampled by the profile timer, read by the timed regions */
+    std::atomic<size_t> sampledMaxRSS{0};
+
     ProfileEventSingleton() = default;
 
+    /** get the event log of the current thread */
+    ProfileEventLog& getLog() {
+        thread_local ProfileEventLog* log = nullptr;
+        if (log == nullptr) {
+            std::lock_guard<std::mutex> guard(logsLock);
+            logs.emplace_back();
+            log = &logs.back();
+        }
+        return *log;
+    }
+
 public:
     ~ProfileEventSingleton() {
         stopTimer();
@@ -63,12 +245,15 @@ public:
     /** create config record */
     void makeConfigRecord(const std::string& key, const std::string& value) {
         profile::EventProcessorSingleton::instance().process(database, "@config", key.c_str(), value.c_str());
+        if (stream) {
+            stream->writeConfig(key, value);
+        }
     }
 
     /** create time event */
     void makeTimeEvent(const std::string& txt) {
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), std::chrono::duration_cast<microseconds>(now().time_since_epoch()));
+        microseconds time = std::chrono::duration_cast<microseconds>(now().time_since_epoch());
+        getLog().append(profile::EventKind::Time, txt, {uint64_t(time.count())}, database, stream.get());
     }
 
     /** create an event for recording start and end times */
@@ -76,13 +261,78 @@ public:
             size_t endMaxRSS, size_t size, size_t iteration) {
         microseconds start_ms = std::chrono::duration_cast<microseconds>(start.time_since_epoch());
         microseconds end_ms = std::chrono::duration_cast<microseconds>(end.time_since_epoch());
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), start_ms, end_ms, startMaxRSS, endMaxRSS, size, iteration);
+        getLog().append(profile::EventKind::Timing, txt,
+                {uint64_t(start_ms.count()), uint64_t(end_ms.count()), startMaxRSS, endMaxRSS, size,
+                        iteration},
+                database, stream.get());
+    }
+
+    /** create an event for recording the hardware counters of a timed region */
+    void makeCountersEvent(const std::string& txt, const HardwareCounters::Counts& start,
+            const HardwareCounters::Counts& end, size_t iteration) {
+        getLog().append(profile::EventKind::Counters, txt,
+                {end[0] - start[0], end[1] - start[1], end[2] - start[2], iteration}, database,
+                stream.get());
     }
 
     /** create quantity event */
     void makeQuantityEvent(const std::string& txt, size_t number, int iteration) {
-        profile::EventProcessorSingleton::instance().process(database, txt.c_str(), number, iteration);
+        getLog().append(
+                profile::EventKind::Quantity, txt, {number, uint64_t(iteration)}, database, stream.get());
+    }
+
+    /**
+     * create statistics events for a relation, holding its number of tuples and the estimated
+     * number of distinct values of each of the given leading columns
+     */
+    template <typename Relation>
+    void makeStatisticsEvent(const std::string& txt, const Relation& relation, std::size_t columns) {
+        std::vector<HyperLogLog> estimators(columns);
+        std::size_t count = 0;
+        for (const auto& tuple : relation) {
+            for (std::size_t i = 0; i < columns; ++i) {
+                estimators[i].add(tuple[i]);
+            }
+            ++count;
+        }
+        makeQuantityEvent(txt + ";num-tuples", count, 0);
+        for (std::size_t i = 0; i < columns; ++i) {
+            makeQuantityEvent(txt + ";distinct-values;" + std::to_string(i), estimators[i].estimate(), 0);
+        }
+    }
+
+    /** create events for the hits and misses of the operation hints of an index */
+    void makeHintEvent(const std::string& txt, size_t hits, size_t misses) {
+        makeQuantityEvent(txt + ";hits", hits, 0);
+        makeQuantityEvent(txt + ";misses", misses, 0);
+    }
+
+    /** create memory events for a relation, holding the estimated bytes occupied by each of its indexes */
+    void makeRelationMemoryEvent(const std::string& txt, const std::vector<size_t>& indexes) {
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            makeQuantityEvent(txt + ";" + std::to_string(i), indexes[i], 0);
+        }
+    }
+
+    /**
+     * create memory events for the end of a stratum, holding the current time and the estimated bytes
+     * occupied by the symbol and record tables
+     */
+    void makeMemoryEvent(const std::string& txt, size_t symbolTable, size_t recordTable) {
+        makeTimeEvent(txt + ";time");
+        makeQuantityEvent(txt + ";symbol-table", symbolTable, 0);
+        makeQuantityEvent(txt + ";record-table", recordTable, 0);
+    }
+
+    /**
+     * create sample events holding the samples of each rule, keyed by the message of the rule, and of
+     * the time outside of rules, keyed by the empty message
+     */
+    void makeSamplesEvent(const std::map<std::string, size_t>& samples) {
+        for (const auto& cur : samples) {
+            const std::string rule = cur.first.empty() ? "other" : stringify(cur.first);
+            makeQuantityEvent("@samples;" + rule, cur.second, 0);
+        }
     }
 
     /** create utilisation event */
@@ -98,17 +348,41 @@ public:
         uint64_t userTime = ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec;
         /* Maximum resident set size (kb) */
         size_t maxRSS = ru.ru_maxrss;
+        sampledMaxRSS.store(maxRSS, std::memory_order_relaxed);
 
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), time, systemTime, userTime, maxRSS);
+        getLog().append(profile::EventKind::Utilisation, txt,
+                {uint64_t(time.count()), systemTime, userTime, maxRSS}, database, stream.get());
+    }
+
+    /** fold the events recorded so far into the profile database */
+    void fold() {
+        std::lock_guard<std::mutex> guard(logsLock);
+        for (auto& log : logs) {
+            log.fold(database, stream.get());
+        }
+        if (stream) {
+            stream->flush();
+        }
     }
 
     void setOutputFile(std::string filename) {
         this->filename = filename;
+        if (fileExtension(filename) == "bin") {
+            // events are written while the program runs
+            fold();
+            stream = std::make_unique<profile::ProfileStreamWriter>(filename);
+            if (!stream->isOpen()) {
+                std::cerr << "Cannot open profile log file <" + filename + ">";
+                stream = nullptr;
+            }
+        }
     }
     /** Dump all events */
     void dump() {
-        if (!filename.empty()) {
+        fold();
+        if (stream) {
+            stream->close();
+        } else if (!filename.empty()) {
             std::ofstream os(filename);
             if (!os.is_open()) {
                 std::cerr << "Cannot open profile log file <" + filename + ">";
@@ -118,6 +392,15 @@ public:
         }
     }
 
+    /** Record hardware counters for timed rules and relations */
+    void enableCounters() {
+        counters = true;
+    }
+
+    bool hasCounters() const {
+        return counters;
+    }
+
     /** Start timer */
     void startTimer() {
         timer.start();
@@ -131,51 +414,55 @@ public:
     void resetTimerInterval(uint32_t interval = 1) {
         timer.resetTimerInterval(interval);
     }
-    const profile::ProfileDatabase& getDB() const {
+
+    /** Return the maximum resident set size (kb) last sampled by the profile timer */
+    size_t getMaxRSS() const {
+        return sampledMaxRSS.load(std::memory_order_relaxed);
+    }
+    const profile::ProfileDatabase& getDB() {
+        fold();
         return database;
     }
 
-    void setDBFromFile(const std::string& filename) {
-        database = profile::ProfileDatabase(filename);
+    /**
+     * Load the profile database from a file; only the given relations are loaded from a profile
+     * stream, unless none are given
+     */
+    void setDBFromFile(const std::string& filename, const std::set<std::string>& relations = {}) {
+        if (profile::ProfileStreamReader::isStream(filename)) {
+            database = profile::ProfileDatabase();
+            profile::ProfileStreamReader::load(filename, database, relations);
+        } else {
+            database = profile::ProfileDatabase(filename);
+        }
     }
 
 private:
     /**  Profile Timer */
     class ProfileTimer {
     private:
-        /** time interval between per utilisation read */
-        uint32_t t;
-
-        /** timer is running */
-        std::atomic<bool> running{false};
-
-        /** thread timer runs on */
-        std::thread th;
-
-        std::condition_variable conditionVariable;
-        std::mutex timerMutex;
+        /** the periodic task of the task pool reading the utilisation */
+        PeriodicTask task;
 
         /** number of utilisation events */
         std::atomic<uint32_t> runCount{0};
 
-        /** run method for thread th */
-        void run() {
+        /** a step of the periodic task */
+        bool run() {
             ProfileEventSingleton::instance().makeUtilisationEvent("@utilisation");
+            ProfileEventSingleton::instance().fold();
             ++runCount;
             if (runCount % 128 == 0) {
                 increaseInterval();
             }
-        }
-
-        uint32_t getInterval() {
-            return t;
+            return true;
         }
 
         /** Increase value of time interval by factor of 2 */
         void increaseInterval() {
             // Don't increase time interval past 60 seconds
-            if (t < 60000) {
-                t = t * 2;
+            if (task.getInterval() < std::chrono::milliseconds(60000)) {
+                task.setInterval(task.getInterval() * 2);
             }
         }
 
@@ -183,31 +470,17 @@ private:
         /*
          *  @param interval the size of the timing interval in milliseconds
          */
-        ProfileTimer(uint32_t interval = 10) : t(interval) {}
+        ProfileTimer(uint32_t interval = 10)
+                : task([this]() { return run(); }, std::chrono::milliseconds(interval)) {}
 
-        /** start timer on the thread th */
+        /** start timer on the task pool */
         void start() {
-            if (running) {
-                return;
-            }
-            running = true;
-
-            th = std::thread([this]() {
-                while (running) {
-                    run();
-                    std::unique_lock<std::mutex> lock(timerMutex);
-                    conditionVariable.wait_for(lock, std::chrono::milliseconds(getInterval()));
-                }
-            });
+            task.start();
         }
 
-        /** stop timer on the thread th */
+        /** stop timer, waiting for a running step */
         void stop() {
-            running = false;
-            conditionVariable.notify_all();
-            if (th.joinable()) {
-                th.join();
-            }
+            task.stop();
         }
 
         /** Reset timer interval.
@@ -218,13 +491,68 @@ private:
          *  @param interval the size of the timing interval in milliseconds
          */
         void resetTimerInterval(uint32_t interval = 10) {
-            t = interval;
             runCount = 0;
-            conditionVariable.notify_all();
+            // restarting reschedules the step on the task pool, which is only worth it for a longer interval
+            if (task.getInterval() <= std::chrono::milliseconds(interval)) {
+                return;
+            }
+            task.setInterval(std::chrono::milliseconds(interval));
+            task.restart();
         }
     };
 
     ProfileTimer timer;
 };
 
+/**
+ * The utilisation of the threads of the parallel loops of each rule, accumulated over the executions of
+ * the loops and written as profile events at the end of the evaluation. The loops are attributed to the
+ * rule executed by the thread opening their parallel region, i.e., to the message set for the signal
+ * handler, and to "other" outside of rules.
+ */
+class ParallelLoopProfile {
+public:
+    /** get the profile of the process */
+    static ParallelLoopProfile& instance() {
+        static ParallelLoopProfile profile;
+        return profile;
+    }
+
+    /** accumulate the statistics of a profiled loop once its parallel region has ended */
+    void record(const WorkStealingLoop& loop) {
+        const ParallelLoopStatistics statistics = loop.getStatistics();
+        const char* rule = SignalHandler::instance()->getMsg();
+        std::lock_guard<std::mutex> guard(lock);
+        rules[rule] += statistics;
+    }
+
+    /** create the events of the loops of each rule, and reset the statistics */
+    void makeEvents() {
+        std::map<const char*, ParallelLoopStatistics> statistics;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            statistics.swap(rules);
+        }
+        for (const auto& cur : statistics) {
+            const ParallelLoopStatistics& loops = cur.second;
+            const std::string txt =
+                    "@parallel-loops;" + (cur.first == nullptr ? "other" : stringify(cur.first)) + ";";
+            auto& events = ProfileEventSingleton::instance();
+            events.makeQuantityEvent(txt + "executions", loops.executions, 0);
+            events.makeQuantityEvent(txt + "forked", loops.forked, 0);
+            events.makeQuantityEvent(txt + "threads", loops.threads, 0);
+            events.makeQuantityEvent(txt + "busy", loops.busy, 0);
+            events.makeQuantityEvent(txt + "idle", loops.idle, 0);
+            events.makeQuantityEvent(txt + "critical", loops.critical, 0);
+            events.makeQuantityEvent(txt + "chunks", loops.chunks, 0);
+            events.makeQuantityEvent(txt + "max-chunks", loops.maxChunks, 0);
+        }
+    }
+
+private:
+    /** the statistics of the loops of each rule, keyed by the registered message of the rule */
+    std::map<const char*, ParallelLoopStatistics> rules;
+    std::mutex lock;
+};
+
 }  // namespace souffle
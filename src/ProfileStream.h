@@ -0,0 +1,346 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ProfileStream.h
+ *
+ * Declares the streaming profile format, an append-only binary log of
+ * profile events written while the program runs, and indexed by relation
+ * when the program ends.
+ *
+ * The file starts with the magic string, followed by fixed-size records in
+ * the native byte order. The text of an event is stored once, by a text
+ * record preceding its first use, and events refer to it by its id. The
+ * index lists the offsets of the text records, of the events on the whole
+ * program and of the events of each relation. It is followed by the footer,
+ * holding the offset of the index and the magic string. A file without
+ * footer, e.g. of a run that did not terminate, is read sequentially.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "EventProcessor.h"
+#include "ProfileDatabase.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+/** Kinds of profile events, determining the meaning of their values */
+enum class EventKind : uint32_t { Time, Timing, Quantity, Utilisation, Config, Text, Counters };
+
+/** A profile event as stored by the streaming profile format */
+struct StreamRecord {
+    /** kind of the event */
+    EventKind kind;
+
+    /** id of the text of the event, or of the text defined by a text record */
+    uint32_t text;
+
+    /**
+     * times in microseconds, sizes or counts of the event; the id of the value of a configuration
+     * record; the length of the text following a text record
+     */
+    uint64_t values[6];
+};
+
+/** Magic string at the beginning and the end of a profile stream */
+constexpr char PROFILE_STREAM_MAGIC[8] = {'S', 'O', 'U', 'F', 'P', 'R', 'F', '1'};
+
+/** Add an event, other than a configuration record, to a profile database */
+inline void processEvent(ProfileDatabase& db, EventKind kind, const char* txt, const uint64_t* v) {
+    auto& processor = EventProcessorSingleton::instance();
+    switch (kind) {
+        case EventKind::Time: processor.process(db, txt, microseconds(v[0])); break;
+        case EventKind::Timing:
+            processor.process(db, txt, microseconds(v[0]), microseconds(v[1]), size_t(v[2]), size_t(v[3]),
+                    size_t(v[4]), size_t(v[5]));
+            break;
+        case EventKind::Quantity: processor.process(db, txt, size_t(v[0]), int(v[1])); break;
+        case EventKind::Utilisation:
+            processor.process(db, txt, microseconds(v[0]), v[1], v[2], size_t(v[3]));
+            break;
+        case EventKind::Counters:
+            processor.process(db, txt, size_t(v[0]), size_t(v[1]), size_t(v[2]), size_t(v[3]));
+            break;
+        case EventKind::Config:
+        case EventKind::Text: assert(false && "not an event of the profile database"); break;
+    }
+}
+
+/**
+ * Return the relation an event is about, or the empty string for events on the whole program
+ */
+inline std::string getEventRelation(const std::string& txt) {
+    static const std::set<std::string> programEvents = {
+            "@time", "@runtime", "@utilisation", "@node-pool", "@text", "@config", "@memory",
+            "@samples", "@parallel-loops"};
+    const size_t keywordEnd = txt.find(';');
+    if (keywordEnd == std::string::npos || programEvents.count(txt.substr(0, keywordEnd)) > 0) {
+        return "";
+    }
+    const size_t relationEnd = txt.find(';', keywordEnd + 1);
+    return txt.substr(keywordEnd + 1, relationEnd - keywordEnd - 1);
+}
+
+/**
+ * Writer of a profile stream
+ *
+ * Events are appended as they are folded from the event logs of the evaluating threads;
+ * the index is written when the stream is closed.
+ */
+class ProfileStreamWriter {
+public:
+    ProfileStreamWriter(const std::string& filename) : out(filename, std::ios::binary) {
+        out.write(PROFILE_STREAM_MAGIC, sizeof(PROFILE_STREAM_MAGIC));
+    }
+
+    ~ProfileStreamWriter() {
+        close();
+    }
+
+    bool isOpen() const {
+        return out.is_open();
+    }
+
+    /** append an event */
+    void write(EventKind kind, const std::string& txt, const uint64_t* values) {
+        std::lock_guard<std::mutex> guard(lock);
+        StreamRecord record{kind, getTextId(txt), {}};
+        std::copy(values, values + 6, record.values);
+        const std::string relation = getEventRelation(txt);
+        if (relation.empty()) {
+            programOffsets.push_back(out.tellp());
+        } else {
+            relationOffsets[relation].push_back(out.tellp());
+        }
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    /** append a configuration record */
+    void writeConfig(const std::string& key, const std::string& value) {
+        std::lock_guard<std::mutex> guard(lock);
+        StreamRecord record{EventKind::Config, getTextId(key), {getTextId(value)}};
+        programOffsets.push_back(out.tellp());
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    /** write the records appended so far to the file */
+    void flush() {
+        std::lock_guard<std::mutex> guard(lock);
+        out.flush();
+    }
+
+    /** write the index and the footer, and close the file */
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!out.is_open()) {
+            return;
+        }
+        const uint64_t indexOffset = out.tellp();
+        writeOffsets(textOffsets);
+        writeOffsets(programOffsets);
+        writeValue(uint64_t(relationOffsets.size()));
+        for (const auto& cur : relationOffsets) {
+            writeValue(uint64_t(cur.first.size()));
+            out.write(cur.first.data(), cur.first.size());
+            writeOffsets(cur.second);
+        }
+        writeValue(indexOffset);
+        out.write(PROFILE_STREAM_MAGIC, sizeof(PROFILE_STREAM_MAGIC));
+        out.close();
+    }
+
+private:
+    /** get the id of a text, writing its text record the first time it is used */
+    uint32_t getTextId(const std::string& txt) {
+        auto pos = textIds.find(txt);
+        if (pos != textIds.end()) {
+            return pos->second;
+        }
+        const auto id = static_cast<uint32_t>(textIds.size());
+        textIds[txt] = id;
+        textOffsets.push_back(out.tellp());
+        StreamRecord record{EventKind::Text, id, {txt.size()}};
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        out.write(txt.data(), txt.size());
+        return id;
+    }
+
+    template <typename T>
+    void writeValue(T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeOffsets(const std::vector<uint64_t>& offsets) {
+        writeValue(uint64_t(offsets.size()));
+        out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    }
+
+    std::ofstream out;
+    std::mutex lock;
+
+    /** ids of the texts written so far */
+    std::unordered_map<std::string, uint32_t> textIds;
+
+    /** offsets of the text records, the events on the whole program, and the events of each relation */
+    std::vector<uint64_t> textOffsets;
+    std::vector<uint64_t> programOffsets;
+    std::map<std::string, std::vector<uint64_t>> relationOffsets;
+};
+
+/**
+ * Reader of a profile stream
+ */
+class ProfileStreamReader {
+public:
+    /** check whether a file is a profile stream */
+    static bool isStream(const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[sizeof(PROFILE_STREAM_MAGIC)] = {};
+        in.read(magic, sizeof(magic));
+        return in && std::memcmp(magic, PROFILE_STREAM_MAGIC, sizeof(magic)) == 0;
+    }
+
+    /**
+     * Load a profile stream into a profile database. If relations are given, only the events on
+     * the whole program and on the given relations are loaded, which are found by the index of
+     * the stream if it has been closed.
+     */
+    static void load(const std::string& filename, ProfileDatabase& db,
+            const std::set<std::string>& relations = {}) {
+        std::ifstream in(filename, std::ios::binary);
+        if (!isStream(filename)) {
+            throw std::runtime_error("Log file could not be opened.");
+        }
+        ProfileStreamReader reader(in, db, relations);
+        // a closed stream ends with the offset of its index and the magic string
+        char magic[sizeof(PROFILE_STREAM_MAGIC)] = {};
+        uint64_t indexOffset = 0;
+        in.seekg(0, std::ios::end);
+        const uint64_t size = in.tellg();
+        if (size >= 2 * sizeof(PROFILE_STREAM_MAGIC) + sizeof(indexOffset)) {
+            in.seekg(size - sizeof(magic) - sizeof(indexOffset));
+            reader.readValue(indexOffset);
+            in.read(magic, sizeof(magic));
+        }
+        if (!in || std::memcmp(magic, PROFILE_STREAM_MAGIC, sizeof(magic)) != 0) {
+            in.clear();
+            indexOffset = size;
+        } else if (!relations.empty()) {
+            reader.loadIndexed(indexOffset);
+            return;
+        }
+        reader.loadSequentially(indexOffset);
+    }
+
+private:
+    ProfileStreamReader(std::ifstream& in, ProfileDatabase& db, const std::set<std::string>& relations)
+            : in(in), db(db), relations(relations) {}
+
+    template <typename T>
+    void readValue(T& value) {
+        in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    }
+
+    std::vector<uint64_t> readOffsets() {
+        uint64_t count = 0;
+        readValue(count);
+        std::vector<uint64_t> offsets(count);
+        in.read(reinterpret_cast<char*>(offsets.data()), count * sizeof(uint64_t));
+        return offsets;
+    }
+
+    /** read the records up to the given offset in the order they have been written */
+    void loadSequentially(uint64_t end) {
+        in.seekg(sizeof(PROFILE_STREAM_MAGIC));
+        StreamRecord record{};
+        while (static_cast<uint64_t>(in.tellg()) + sizeof(record) <= end) {
+            readValue(record);
+            if (!in) {
+                break;
+            }
+            if (record.kind == EventKind::Text) {
+                readText(record);
+            } else if (record.kind == EventKind::Config || relations.empty() ||
+                       contains(relations, getEventRelation(texts[record.text]))) {
+                process(record);
+            }
+        }
+    }
+
+    /** read the records of the requested relations by the index of the stream */
+    void loadIndexed(uint64_t indexOffset) {
+        in.seekg(indexOffset);
+        const std::vector<uint64_t> textOffsets = readOffsets();
+        std::vector<uint64_t> offsets = readOffsets();
+        uint64_t count = 0;
+        readValue(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t length = 0;
+            readValue(length);
+            std::string relation(length, '\0');
+            in.read(&relation[0], length);
+            std::vector<uint64_t> relationOffsets = readOffsets();
+            if (contains(relations, relation)) {
+                offsets.insert(offsets.end(), relationOffsets.begin(), relationOffsets.end());
+            }
+        }
+
+        StreamRecord record{};
+        for (uint64_t offset : textOffsets) {
+            in.seekg(offset);
+            readValue(record);
+            readText(record);
+        }
+        // events are processed in the order they have been written
+        std::sort(offsets.begin(), offsets.end());
+        for (uint64_t offset : offsets) {
+            in.seekg(offset);
+            readValue(record);
+            process(record);
+        }
+    }
+
+    void readText(const StreamRecord& record) {
+        std::string txt(record.values[0], '\0');
+        in.read(&txt[0], txt.size());
+        texts.resize(std::max<size_t>(texts.size(), record.text + 1));
+        texts[record.text] = std::move(txt);
+    }
+
+    void process(const StreamRecord& record) {
+        if (record.kind == EventKind::Config) {
+            EventProcessorSingleton::instance().process(
+                    db, "@config", texts[record.text].c_str(), texts[record.values[0]].c_str());
+        } else {
+            processEvent(db, record.kind, texts[record.text].c_str(), record.values);
+        }
+    }
+
+    std::ifstream& in;
+    ProfileDatabase& db;
+    const std::set<std::string>& relations;
+
+    /** texts of the stream by their id */
+    std::vector<std::string> texts;
+};
+
+}  // namespace profile
+}  // namespace souffle
@@ -0,0 +1,97 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ProgramLibrary.h
+ *
+ * A compiled program loaded from a shared library, such that a host
+ * process can swap the version of the program it evaluates at runtime.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "SouffleInterface.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <dlfcn.h>
+
+namespace souffle {
+
+/**
+ * A compiled program loaded from a shared library built by souffle-compile -S, whose instances are
+ * created by the host process rather than linked into it.
+ *
+ * A changed rule set is redeployed by loading the library of its new version and reloading the running
+ * instance with reload(): the input relations of the same name, attribute types, representation and
+ * indexes are migrated into the new instance without copying their tuples, and only the other inputs
+ * are read by loadAll(). Both versions must be compiled by the same version of souffle.
+ *
+ * Libraries are never unloaded, as the relations and the symbol and record tables migrated into later
+ * versions of a program are destroyed by the code of the library that created them.
+ */
+class ProgramLibrary {
+public:
+    /**
+     * Load the program of the given name, i.e. the base name of its generated source, from a shared
+     * library.
+     *
+     * @param path The path of the shared library (const std::string&)
+     * @param name The name of the program (const std::string&)
+     */
+    ProgramLibrary(const std::string& path, const std::string& name) {
+        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) {
+            throw std::runtime_error("Cannot load program library " + path + ": " + dlerror());
+        }
+        newInstanceHook =
+                reinterpret_cast<NewInstance>(dlsym(handle, ("souffle_newInstance_" + name).c_str()));
+        reloadInstanceHook =
+                reinterpret_cast<ReloadInstance>(dlsym(handle, ("souffle_reloadInstance_" + name).c_str()));
+        if (newInstanceHook == nullptr || reloadInstanceHook == nullptr) {
+            throw std::runtime_error("Cannot find program " + name + " in library " + path);
+        }
+    }
+
+    /**
+     * Create an instance of the program, owned by the caller.
+     */
+    SouffleProgram* newInstance() const {
+        return newInstanceHook();
+    }
+
+    /**
+     * Create an instance of the program, owned by the caller, reloaded from a previous version of it,
+     * whose unchanged input relations are migrated into the new instance. The previous version should
+     * not be evaluated any more, as it shares the migrated relations.
+     *
+     * @param previous The previous version of the program (SouffleProgram&)
+     * @param migrated The names of the migrated relations are stored here, if given
+     * @see SouffleProgram::migrateRelations()
+     */
+    SouffleProgram* reload(SouffleProgram& previous, std::vector<std::string>* migrated = nullptr) const {
+        SouffleProgram* program = reloadInstanceHook(&previous);
+        std::vector<std::string> names = program->migrateRelations(previous);
+        if (migrated != nullptr) {
+            *migrated = std::move(names);
+        }
+        return program;
+    }
+
+private:
+    using NewInstance = SouffleProgram* (*)();
+    using ReloadInstance = SouffleProgram* (*)(const SouffleProgram*);
+
+    /** The entry points of the program in the library */
+    NewInstance newInstanceHook = nullptr;
+    ReloadInstance reloadInstanceHook = nullptr;
+};
+
+}  // end of namespace souffle
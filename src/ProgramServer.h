@@ -0,0 +1,326 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ProgramServer.h
+ *
+ * Server answering the queries of clients on an evaluated program, whose
+ * base relations stay resident between the queries.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include "ServerSocket.h"
+#include "SouffleInterface.h"
+#include "SymbolTable.h"
+#include "Util.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * Server answering the queries of clients on a program whose base relations are evaluated, such that the
+ * facts are loaded and the base is computed once rather than per query.
+ *
+ * The server listens on an address as accepted by openServerSocket() and serves each connection as a
+ * session of its own, concurrently with the other sessions. A session sends requests of a line each,
+ * whose fields are separated by tabs, and receives the result lines of each request followed by a line
+ * "ok", or a line "error" followed by the message:
+ *
+ *   size REL              the number of tuples of the relation
+ *   select REL V...       the tuples of the relation matching the values, of which '_' matches any
+ *   insert REL V...       add a fact to a relation, other than a base relation, for the next run
+ *   run                   evaluate the relations depending on the added facts
+ *   reset                 drop the added facts and the relations evaluated from them
+ *   call SUB ARG...       execute a subroutine on numeric arguments, returning a line of results
+ *   quit                  close the session
+ *   shutdown              close the session and stop the server
+ *
+ * The base relations are read-only. If the program can be forked, the facts of a session are evaluated
+ * by a fork of its own sharing the base relations, and the session reads the relations of its fork;
+ * sessions then run concurrently. Otherwise, the program evaluates the facts of one session at a time,
+ * and all sessions read the relations of the last run, each request reading the program concurrently
+ * with the other reading requests.
+ */
+class ProgramServer {
+public:
+    ProgramServer(SouffleProgram& program, std::string address)
+            : program(program), address(std::move(address)), forking(probeFork(program)) {}
+
+    ProgramServer(const ProgramServer&) = delete;
+    ProgramServer& operator=(const ProgramServer&) = delete;
+
+    /** Serve the sessions of clients until one of them requests a shutdown */
+    void serve() {
+        std::string socketPath;
+        const int listener = openServerSocket(address, socketPath);
+        if (listener < 0) {
+            throw std::runtime_error("Cannot open server socket <" + address + ">");
+        }
+        std::vector<TaskPool::Task<void>> sessions;
+        while (running) {
+            // check for a shutdown every 0.5s
+            pollfd pfd{listener, POLLIN, 0};
+            if (poll(&pfd, 1, 500) <= 0) {
+                continue;
+            }
+            const int client = accept(listener, nullptr, nullptr);
+            if (client >= 0) {
+                sessions.push_back(TaskPool::instance().submitService([this, client]() {
+                    serveSession(client);
+                    close(client);
+                }));
+            }
+        }
+        for (auto& session : sessions) {
+            session.wait();
+        }
+        close(listener);
+        if (!socketPath.empty()) {
+            unlink(socketPath.c_str());
+        }
+    }
+
+private:
+    /** The state of a connection */
+    struct Session {
+        /** The fork evaluating the facts of the session, if the program can be forked */
+        std::unique_ptr<SouffleProgram> fork;
+        /** The facts added since the last run, by relation */
+        std::map<Relation*, std::vector<RamDomain>> facts;
+    };
+
+    SouffleProgram& program;
+    const std::string address;
+    /** Whether the sessions evaluate their facts by forks of the program */
+    const bool forking;
+    std::atomic<bool> running{true};
+    /** Held exclusively by the evaluations of the program itself, and shared by the reading requests */
+    std::shared_mutex lock;
+
+    static bool probeFork(const SouffleProgram& program) {
+        std::unique_ptr<SouffleProgram> fork(program.fork());
+        return fork != nullptr;
+    }
+
+    /** Answer the requests of a connection until it is closed, checking for a shutdown every 0.5s */
+    void serveSession(int client) {
+        Session session;
+        std::string buffer;
+        char chunk[4096];
+        while (running) {
+            size_t end;
+            while ((end = buffer.find('\n')) != std::string::npos) {
+                std::string request = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                if (!request.empty() && request.back() == '\r') {
+                    request.pop_back();
+                }
+                if (request.empty()) {
+                    continue;
+                }
+                std::stringstream reply;
+                const bool goesOn = answer(session, request, reply);
+                if (!sendAll(client, reply.str()) || !goesOn) {
+                    return;
+                }
+            }
+            pollfd pfd{client, POLLIN, 0};
+            if (poll(&pfd, 1, 500) <= 0) {
+                continue;
+            }
+            const ssize_t count = recv(client, chunk, sizeof(chunk), 0);
+            if (count <= 0) {
+                return;
+            }
+            buffer.append(chunk, count);
+        }
+    }
+
+    /** Answer a request of a session, writing its result lines to out; return whether the session goes on */
+    bool answer(Session& session, const std::string& request, std::ostream& out) {
+        const std::vector<std::string> fields = splitString(request, '\t');
+        const std::string& command = fields[0];
+        if (command == "quit") {
+            return false;
+        }
+        if (command == "shutdown") {
+            running = false;
+            out << "ok\n";
+            return false;
+        }
+        try {
+            if (command == "size" || command == "select" || command == "insert") {
+                answerRelation(session, fields, out);
+            } else if (command == "run") {
+                run(session);
+            } else if (command == "reset") {
+                session.facts.clear();
+                if (forking) {
+                    session.fork.reset();
+                } else {
+                    std::unique_lock<std::shared_mutex> guard(lock);
+                    program.reset();
+                }
+            } else if (command == "call" && fields.size() >= 2) {
+                std::vector<RamDomain> args;
+                for (size_t i = 2; i < fields.size(); ++i) {
+                    args.push_back(RamDomainFromChars(fields[i]));
+                }
+                std::vector<RamDomain> ret;
+                {
+                    std::shared_lock<std::shared_mutex> guard(lock);
+                    view(session).executeSubroutine(fields[1], args, ret);
+                }
+                out << join(ret, "\t") << "\n";
+            } else {
+                throw std::invalid_argument("Unknown request " + command);
+            }
+        } catch (std::exception& e) {
+            out << "error\t" << e.what() << "\n";
+            return true;
+        }
+        out << "ok\n";
+        return true;
+    }
+
+    /** Answer a request on the tuples of a relation */
+    void answerRelation(Session& session, const std::vector<std::string>& fields, std::ostream& out) {
+        Relation* relation = fields.size() >= 2 ? view(session).getRelation(fields[1]) : nullptr;
+        if (relation == nullptr) {
+            throw std::invalid_argument("Unknown relation " + (fields.size() >= 2 ? fields[1] : ""));
+        }
+        const std::string& command = fields[0];
+        if (command == "size") {
+            std::shared_lock<std::shared_mutex> guard(lock);
+            out << relation->size() << "\n";
+            return;
+        }
+
+        const size_t arity = relation->getArity() - relation->getAuxiliaryArity();
+        if (fields.size() != arity + 2) {
+            throw std::invalid_argument("Expected " + std::to_string(arity) + " values of " + fields[1]);
+        }
+        if (command == "insert") {
+            if (program.isBaseRelation(fields[1])) {
+                throw std::invalid_argument("Base relation " + fields[1] + " is read-only");
+            }
+            std::vector<RamDomain>& facts = session.facts[program.getRelation(fields[1])];
+            for (size_t i = 0; i < arity; ++i) {
+                facts.push_back(parseValue(*relation, i, fields[i + 2], true));
+            }
+            // the auxiliary columns are filled by the relation
+            facts.resize(facts.size() + relation->getAuxiliaryArity(), 0);
+            return;
+        }
+
+        // a symbol unknown to the program matches no tuple
+        std::vector<size_t> columns;
+        std::vector<RamDomain> values;
+        for (size_t i = 0; i < arity; ++i) {
+            if (fields[i + 2] == "_") {
+                continue;
+            }
+            const std::string& value = fields[i + 2];
+            if (*relation->getAttrType(i) == 's' && !relation->getSymbolTable().contains(value)) {
+                return;
+            }
+            columns.push_back(i);
+            values.push_back(parseValue(*relation, i, value, false));
+        }
+        std::shared_lock<std::shared_mutex> guard(lock);
+        relation->equalRange(columns, values, [&](const tuple& t) {
+            for (size_t i = 0; i < arity; ++i) {
+                out << (i > 0 ? "\t" : "");
+                printValue(out, *relation, i, t[i]);
+            }
+            out << "\n";
+        });
+    }
+
+    /** Evaluate the facts of a session */
+    void run(Session& session) {
+        auto insertFacts = [&](SouffleProgram& target) {
+            for (const auto& cur : session.facts) {
+                Relation* relation = target.getRelation(cur.first->getName());
+                relation->insertBatch(cur.second.data(), cur.second.size() / relation->getArity());
+            }
+            session.facts.clear();
+        };
+        if (forking) {
+            std::unique_ptr<SouffleProgram> fork(program.fork());
+            insertFacts(*fork);
+            std::shared_lock<std::shared_mutex> guard(lock);
+            fork->run();
+            session.fork = std::move(fork);
+        } else {
+            std::unique_lock<std::shared_mutex> guard(lock);
+            program.reset();
+            insertFacts(program);
+            program.run();
+        }
+    }
+
+    /** The program whose relations a session reads */
+    SouffleProgram& view(Session& session) {
+        return session.fork != nullptr ? *session.fork : program;
+    }
+
+    /** Parse a value of a column, looking up a symbol unknown to the program only if it is interned */
+    static RamDomain parseValue(
+            const Relation& relation, size_t column, const std::string& value, bool intern) {
+        switch (*relation.getAttrType(column)) {
+            case 's':
+                return intern ? relation.getSymbolTable().lookup(value)
+                              : relation.getSymbolTable().lookupExisting(value);
+            case 'i':
+                return RamDomainFromChars(value);
+            case 'u':
+                return ramBitCast(RamUnsignedFromChars(value));
+            case 'f':
+                return ramBitCast(RamFloatFromChars(value));
+            default:
+                throw std::invalid_argument("Values of column " + std::string(relation.getAttrName(column)) +
+                                            " of " + relation.getName() + " are not supported");
+        }
+    }
+
+    /** Print a value of a column */
+    static void printValue(std::ostream& out, const Relation& relation, size_t column, RamDomain value) {
+        switch (*relation.getAttrType(column)) {
+            case 's':
+                out << relation.getSymbolTable().resolve(value);
+                break;
+            case 'u':
+                out << ramBitCast<RamUnsigned>(value);
+                break;
+            case 'f':
+                out << RamFloatToString(ramBitCast<RamFloat>(value));
+                break;
+            default:
+                out << value;
+        }
+    }
+};
+
+}  // end of namespace souffle
@@ -187,6 +187,37 @@ std::unique_ptr<AstRelation> makeInfoRelation(
     return std::unique_ptr<AstRelation>(infoRelation);
 }
 
+/** Append unnamed variables for the provenance columns of an atom, if its relation is annotated */
+void addProvenanceWildcards(AstAtom& atom, const AuxiliaryArity& auxArityAnalysis) {
+    for (size_t i = 0; i < auxArityAnalysis.getArity(&atom); i++) {
+        atom.addArgument(std::make_unique<AstUnnamedVariable>());
+    }
+}
+
+/**
+ * Widen the atoms of annotated relations in the clauses of a relation that is not annotated itself,
+ * i.e. one that is not explained, so that it keeps its width
+ */
+void addProvenanceWildcards(AstRelation& relation, const AuxiliaryArity& auxArityAnalysis) {
+    std::function<std::unique_ptr<AstNode>(std::unique_ptr<AstNode>)> rewriter =
+            [&](std::unique_ptr<AstNode> node) -> std::unique_ptr<AstNode> {
+        if (auto atom = dynamic_cast<AstAtom*>(node.get())) {
+            addProvenanceWildcards(*atom, auxArityAnalysis);
+        }
+        node->apply(makeLambdaAstMapper(rewriter));
+        return node;
+    };
+    for (auto clause : relation.getClauses()) {
+        clause->getHead()->apply(makeLambdaAstMapper(rewriter));
+        for (auto lit : clause->getBodyLiterals()) {
+            if (auto atom = dynamic_cast<AstAtom*>(lit)) {
+                addProvenanceWildcards(*atom, auxArityAnalysis);
+            }
+            lit->apply(makeLambdaAstMapper(rewriter));
+        }
+    }
+}
+
 /** Transform eqrel relations to explicitly define equivalence relations */
 void transformEqrelRelation(AstRelation& rel) {
     assert(rel.getRepresentation() == RelationRepresentation::EQREL &&
@@ -274,13 +305,19 @@ bool ProvenanceTransformer::transformSubtreeHeights(AstTranslationUnit& translat
     };
 
     for (auto relation : program->getRelations()) {
-        if (relation->getRepresentation() == RelationRepresentation::EQREL) {
+        if (relation->getRepresentation() == RelationRepresentation::EQREL &&
+                auxArityAnalysis.getArity(relation) > 0) {
             // Explicitly expand eqrel relation
             transformEqrelRelation(*relation);
         }
     }
 
     for (auto relation : program->getRelations()) {
+        if (auxArityAnalysis.getArity(relation) == 0) {
+            addProvenanceWildcards(*relation, auxArityAnalysis);
+            continue;
+        }
+
         // generate info relations for each clause
         // do this before all other transformations so that we record
         // the original rule without any instrumentation
@@ -306,25 +343,11 @@ bool ProvenanceTransformer::transformSubtreeHeights(AstTranslationUnit& translat
                     [&](std::unique_ptr<AstNode> node) -> std::unique_ptr<AstNode> {
                 // add provenance columns
 
+                // rule number, max level and level numbers
                 if (auto atom = dynamic_cast<AstAtom*>(node.get())) {
-                    // rule number
-                    atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                    // max level
-                    atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                    // level number
-                    for (size_t i = 0; i < auxArityAnalysis.getArity(atom) - 2; i++) {
-                        atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                    }
+                    addProvenanceWildcards(*atom, auxArityAnalysis);
                 } else if (auto neg = dynamic_cast<AstNegation*>(node.get())) {
-                    auto atom = neg->getAtom();
-                    // rule number
-                    atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                    // max level
-                    atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                    // level number
-                    for (size_t i = 0; i < auxArityAnalysis.getArity(atom) - 2; i++) {
-                        atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                    }
+                    addProvenanceWildcards(*neg->getAtom(), auxArityAnalysis);
                 }
 
                 // otherwise - apply mapper recursively
@@ -386,6 +409,7 @@ bool ProvenanceTransformer::transformSubtreeHeights(AstTranslationUnit& translat
 
 bool ProvenanceTransformer::transformMaxHeight(AstTranslationUnit& translationUnit) {
     auto program = translationUnit.getProgram();
+    const auto& auxArityAnalysis = *translationUnit.getAnalysis<AuxiliaryArity>();
 
     // get next level number
     auto getNextLevelNumber = [&](std::vector<AstArgument*> levels) {
@@ -411,13 +435,19 @@ bool ProvenanceTransformer::transformMaxHeight(AstTranslationUnit& translationUn
     };
 
     for (auto relation : program->getRelations()) {
-        if (relation->getRepresentation() == RelationRepresentation::EQREL) {
+        if (relation->getRepresentation() == RelationRepresentation::EQREL &&
+                auxArityAnalysis.getArity(relation) > 0) {
             // Explicitly expand eqrel relation
             transformEqrelRelation(*relation);
         }
     }
 
     for (auto relation : program->getRelations()) {
+        if (auxArityAnalysis.getArity(relation) == 0) {
+            addProvenanceWildcards(*relation, auxArityAnalysis);
+            continue;
+        }
+
         // generate info relations for each clause
         // do this before all other transformations so that we record
         // the original rule without any instrumentation
@@ -441,15 +471,16 @@ bool ProvenanceTransformer::transformMaxHeight(AstTranslationUnit& translationUn
             struct M : public AstNodeMapper {
                 using AstNodeMapper::operator();
 
+                const AuxiliaryArity& auxArityAnalysis;
+
+                M(const AuxiliaryArity& auxArityAnalysis) : auxArityAnalysis(auxArityAnalysis) {}
+
                 std::unique_ptr<AstNode> operator()(std::unique_ptr<AstNode> node) const override {
                     // add provenance columns
                     if (auto atom = dynamic_cast<AstAtom*>(node.get())) {
-                        atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                        atom->addArgument(std::make_unique<AstUnnamedVariable>());
+                        addProvenanceWildcards(*atom, auxArityAnalysis);
                     } else if (auto neg = dynamic_cast<AstNegation*>(node.get())) {
-                        auto atom = neg->getAtom();
-                        atom->addArgument(std::make_unique<AstUnnamedVariable>());
-                        atom->addArgument(std::make_unique<AstUnnamedVariable>());
+                        addProvenanceWildcards(*neg->getAtom(), auxArityAnalysis);
                     }
 
                     // otherwise - apply mapper recursively
@@ -459,7 +490,7 @@ bool ProvenanceTransformer::transformMaxHeight(AstTranslationUnit& translationUn
             };
 
             // add unnamed vars to each atom nested in arguments of head
-            clause->getHead()->apply(M());
+            clause->getHead()->apply(M(auxArityAnalysis));
 
             // if fact, level number is 0
             if (isFact(*clause)) {
@@ -472,7 +503,7 @@ bool ProvenanceTransformer::transformMaxHeight(AstTranslationUnit& translationUn
                     auto lit = clause->getBodyLiterals()[i];
 
                     // add unnamed vars to each atom nested in arguments of lit
-                    lit->apply(M());
+                    lit->apply(M(auxArityAnalysis));
 
                     // add two provenance columns to lit; first is rule num, second is level num
                     if (auto atom = dynamic_cast<AstAtom*>(lit)) {
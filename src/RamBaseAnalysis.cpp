@@ -0,0 +1,120 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamBaseAnalysis.cpp
+ *
+ * Implementation of the RAM base analysis
+ *
+ ***********************************************************************/
+
+#include "RamBaseAnalysis.h"
+#include "Global.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamTranslationUnit.h"
+#include "RamVisitor.h"
+#include "Util.h"
+
+namespace souffle {
+
+void RamBaseAnalysis::run(const RamTranslationUnit& translationUnit) {
+    const RamProgram& program = translationUnit.getProgram();
+    std::set<std::string> dependent;
+    for (const std::string& name : splitString(Global::config().get("query-inputs"), ',')) {
+        if (!name.empty()) {
+            dependent.insert(name);
+        }
+    }
+
+    // a statement reading a query-dependent relation makes the relations it computes query-dependent
+    const std::vector<const RamStatement*> statements = getStatements(program.getMain());
+    bool changed = !dependent.empty();
+    while (changed) {
+        changed = false;
+        for (const RamStatement* statement : statements) {
+            bool reads = false;
+            visitDepthFirst(*statement, [&](const RamRelationReference& ref) {
+                reads = reads || dependent.count(ref.get()->getName()) > 0;
+            });
+            if (!reads) {
+                continue;
+            }
+            for (const std::string& name : getComputedRelations(*statement)) {
+                changed = dependent.insert(name).second || changed;
+            }
+        }
+    }
+
+    baseRelations.clear();
+    for (const RamRelation* rel : program.getRelations()) {
+        if (!rel->isTemp() && dependent.count(rel->getName()) == 0) {
+            baseRelations.push_back(rel->getName());
+        }
+    }
+}
+
+void RamBaseAnalysis::print(std::ostream& os) const {
+    os << "Base relations: " << join(baseRelations, ", ") << "\n";
+}
+
+std::vector<const RamStatement*> RamBaseAnalysis::getStatements(const RamStatement& main) {
+    // the timer of the whole program encloses the statements
+    const RamStatement* program = &main;
+    if (const auto* timer = dynamic_cast<const RamLogTimer*>(program)) {
+        program = &timer->getStatement();
+    }
+    std::vector<const RamStatement*> statements;
+    const auto* list = dynamic_cast<const RamListStatement*>(program);
+    if (dynamic_cast<const RamSequence*>(program) != nullptr ||
+            dynamic_cast<const RamSchedule*>(program) != nullptr) {
+        for (const RamStatement* statement : list->getStatements()) {
+            statements.push_back(statement);
+        }
+    } else {
+        statements.push_back(program);
+    }
+    return statements;
+}
+
+std::set<std::string> RamBaseAnalysis::getComputedRelations(const RamStatement& statement) {
+    std::set<std::string> computed;
+    auto add = [&](const RamRelation& rel) {
+        if (!rel.isTemp()) {
+            computed.insert(rel.getName());
+        }
+    };
+    visitDepthFirst(statement, [&](const RamProject& project) { add(project.getRelation()); });
+    visitDepthFirst(statement, [&](const RamExtend& extend) { add(extend.getTargetRelation()); });
+    visitDepthFirst(statement, [&](const RamSwap& swap) {
+        add(swap.getFirstRelation());
+        add(swap.getSecondRelation());
+    });
+    visitDepthFirst(statement, [&](const RamLoad& load) { add(load.getRelation()); });
+    return computed;
+}
+
+std::set<std::string> RamBaseAnalysis::getReferencedRelations(const RamStatement& statement) {
+    std::set<std::string> referenced;
+    visitDepthFirst(
+            statement, [&](const RamRelationReference& ref) { referenced.insert(ref.get()->getName()); });
+    return referenced;
+}
+
+bool RamBaseAnalysis::writesRelations(const RamStatement& statement) {
+    bool writes = false;
+    visitDepthFirst(statement, [&](const RamProject&) { writes = true; });
+    visitDepthFirst(statement, [&](const RamBinRelationStatement&) { writes = true; });
+    visitDepthFirst(statement, [&](const RamLoad&) { writes = true; });
+    visitDepthFirst(statement, [&](const RamClear&) { writes = true; });
+    visitDepthFirst(statement, [&](const RamAbstractIndexStatement&) { writes = true; });
+    return writes;
+}
+
+}  // end of namespace souffle
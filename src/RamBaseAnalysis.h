@@ -0,0 +1,72 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamBaseAnalysis.h
+ *
+ * Determine the relations of a program which do not depend on the query
+ * inputs of a served program, and hence are evaluated once.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamAnalysis.h"
+#include "RamRelation.h"
+#include "RamStatement.h"
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+class RamTranslationUnit;
+
+/**
+ * @class RamBaseAnalysis
+ * @brief A Ram Analysis for determining the base relations of a served program
+ *
+ * The query inputs, given by the option query-inputs, are filled by the queries of a served program. A
+ * relation is query-dependent if it is computed by a top-level statement of the main program which
+ * reads a query input or another query-dependent relation. All other relations form the base, which is
+ * evaluated once and kept while the queries are evaluated, skipping the statements computing it.
+ */
+class RamBaseAnalysis : public RamAnalysis {
+public:
+    RamBaseAnalysis(const char* id) : RamAnalysis(id) {}
+
+    static constexpr const char* name = "base-analysis";
+
+    void run(const RamTranslationUnit& translationUnit) override;
+
+    void print(std::ostream& os) const override;
+
+    /** @brief Get the names of the relations which do not depend on the query inputs */
+    const std::vector<std::string>& getBaseRelations() const {
+        return baseRelations;
+    }
+
+    /** @brief Get the top-level statements of the main program, i.e., its strata, loads and stores */
+    static std::vector<const RamStatement*> getStatements(const RamStatement& main);
+
+    /** @brief Get the names of the relations, other than temporary ones, which a statement writes */
+    static std::set<std::string> getComputedRelations(const RamStatement& statement);
+
+    /** @brief Get the names of the relations, including temporary ones, which a statement refers to */
+    static std::set<std::string> getReferencedRelations(const RamStatement& statement);
+
+    /** @brief Whether a statement, e.g. a subroutine, writes any relation or index */
+    static bool writesRelations(const RamStatement& statement);
+
+private:
+    std::vector<std::string> baseRelations;
+};
+
+}  // end of namespace souffle
@@ -140,9 +140,9 @@ protected:
 class RamUserDefinedOperator : public RamAbstractOperator {
 public:
     RamUserDefinedOperator(std::string n, std::vector<TypeAttribute> argsTypes, TypeAttribute returnType,
-            std::vector<std::unique_ptr<RamExpression>> args)
+            bool stateful, std::vector<std::unique_ptr<RamExpression>> args)
             : RamAbstractOperator(std::move(args)), name(std::move(n)), argsTypes(std::move(argsTypes)),
-              returnType(returnType) {
+              returnType(returnType), stateful(stateful) {
         assert(argsTypes.size() == args.size());
     }
 
@@ -168,8 +168,19 @@ public:
         return returnType;
     }
 
+    /**
+     * @brief Check whether the functor is stateful
+     *
+     * Stateful functors receive the symbol and record tables ahead of their
+     * arguments, and take and return all values as RamDomain, such that
+     * symbols are passed as their indices.
+     */
+    bool isStateful() const {
+        return stateful;
+    }
+
     RamUserDefinedOperator* clone() const override {
-        auto* res = new RamUserDefinedOperator(name, argsTypes, returnType, {});
+        auto* res = new RamUserDefinedOperator(name, argsTypes, returnType, stateful, {});
         for (auto& cur : arguments) {
             RamExpression* arg = cur->clone();
             res->arguments.emplace_back(arg);
@@ -181,7 +192,7 @@ protected:
     bool equal(const RamNode& node) const override {
         const auto& other = static_cast<const RamUserDefinedOperator&>(node);
         return RamAbstractOperator::equal(node) && name == other.name && argsTypes == other.argsTypes &&
-               returnType == other.returnType;
+               returnType == other.returnType && stateful == other.stateful;
     }
 
     /** Name of user-defined operator */
@@ -191,6 +202,9 @@ protected:
     const std::vector<TypeAttribute> argsTypes;
 
     const TypeAttribute returnType;
+
+    /** Stateful functor */
+    const bool stateful;
 };
 
 /**
@@ -350,7 +364,9 @@ public:
  * @class RamAutoIncrement
  * @brief Increment a counter and return its value.
  *
- * Note that there exists a single counter only.
+ * Note that there exists a single counter only. The values are unique, but neither dense
+ * nor ordered in parallel evaluations, since each thread takes the values of a block of
+ * its own.
  */
 class RamAutoIncrement : public RamExpression {
 public:
@@ -15,11 +15,13 @@
  ***********************************************************************/
 
 #include "RamIndexAnalysis.h"
+#include "Global.h"
 #include "RamCondition.h"
 #include "RamNode.h"
 #include "RamOperation.h"
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
@@ -169,6 +171,98 @@ void MinIndexSelection::solve() {
     }
 }
 
+MinIndexSelection::IndexStorage MinIndexSelection::getIndexStorage(size_t arity) const {
+    const size_t numIndexes = std::max<size_t>(orders.size(), 1);
+    const size_t refWords = (sizeof(void*) + sizeof(RamDomain) - 1) / sizeof(RamDomain);
+
+    // the first index and the table store complete tuples, each secondary index its cheaper entries
+    IndexStorage res{std::vector<bool>(numIndexes, false), numIndexes * arity, 2 * arity};
+    for (size_t i = 1; i < orders.size(); i++) {
+        const size_t keyWords = orders[i].size() + refWords;
+        res.indirect[i] = keyWords < arity;
+        res.words += std::min(keyWords, arity);
+    }
+
+    // the dereferences of the scans pay off for a considerable saving only
+    if (8 * res.words > 7 * res.directWords) {
+        res.indirect.assign(numIndexes, false);
+        res.words = res.directWords;
+    }
+    return res;
+}
+
+std::map<SearchSignature, SearchSignature> MinIndexSelection::reduceSearches(
+        const SearchFrequencies& frequencies, const std::function<double(SearchSignature)>& matches,
+        double indexCost) const {
+    auto getOrders = [](const SearchSet& keys) {
+        MinIndexSelection selection;
+        for (auto key : keys) {
+            selection.addSearch(key);
+        }
+        selection.solve();
+        return selection.getAllOrders();
+    };
+
+    // consider the searches in ascending order of frequency
+    std::vector<std::pair<size_t, SearchSignature>> candidates;
+    for (const auto& cur : frequencies) {
+        if (searches.find(cur.first) != searches.end()) {
+            candidates.emplace_back(cur.second, cur.first);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::map<SearchSignature, SearchSignature> res;
+    SearchSet current = searches;
+    SearchSet prefixes;
+    size_t numIndexes = getOrders(current).size();
+    for (const auto& candidate : candidates) {
+        const SearchSignature search = candidate.second;
+        // the prefix of another reduced search has to remain
+        if (prefixes.find(search) != prefixes.end() || current.size() == 1) {
+            continue;
+        }
+        SearchSet reduced = current;
+        reduced.erase(search);
+        const OrderCollection reducedOrders = getOrders(reduced);
+        if (reducedOrders.size() >= numIndexes) {
+            continue;
+        }
+
+        // find the longest prefix of the remaining indexes binding columns of the search only
+        SearchSignature prefix = 0;
+        for (const auto& order : reducedOrders) {
+            SearchSignature cols = 0;
+            for (int col : order) {
+                if ((search & (SearchSignature(1) << col)) == 0) {
+                    break;
+                }
+                cols |= SearchSignature(1) << col;
+            }
+            if (card(cols) > card(prefix)) {
+                prefix = cols;
+            }
+        }
+        if (prefix == 0) {
+            continue;
+        }
+
+        // the prefix matches more tuples for each execution of the search
+        const double extraCost = candidate.first * (matches(prefix) - matches(search));
+        if (extraCost >= indexCost) {
+            continue;
+        }
+
+        // the prefix is comparable to each search of its chain, hence keeps the number of indexes
+        reduced.insert(prefix);
+        current = std::move(reduced);
+        prefixes.insert(prefix);
+        numIndexes = reducedOrders.size();
+        res[search] = prefix;
+    }
+    return res;
+}
+
 MinIndexSelection::Chain MinIndexSelection::getChain(
         const SearchSignature umn, const MaxMatching::Matchings& match) {
     SearchSignature start = umn;  // start at an unmateched node
@@ -242,6 +336,9 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
         if (const auto* indexSearch = dynamic_cast<const RamIndexOperation*>(&node)) {
             MinIndexSelection& indexes = getIndexes(indexSearch->getRelation());
             indexes.addSearch(getSearchSignature(indexSearch));
+        } else if (const auto* merge = dynamic_cast<const RamMergeJoin*>(&node)) {
+            MinIndexSelection& indexes = getIndexes(merge->getRelation());
+            indexes.addSearch(getSearchSignature(merge));
         } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
             MinIndexSelection& indexes = getIndexes(exists->getRelation());
             indexes.addSearch(getSearchSignature(exists));
@@ -254,6 +351,16 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
         }
     });
 
+    // outputs sorted by columns of numbers are written by iterating an index
+    visitDepthFirst(translationUnit.getProgram(), [&](const RamStore& store) {
+        for (const IODirectives& directives : store.getIODirectives()) {
+            const MinIndexSelection::LexOrder order = getOutputOrder(store.getRelation(), directives);
+            if (!order.empty()) {
+                getIndexes(store.getRelation()).addOrder(order);
+            }
+        }
+    });
+
     // A swap happen between rel A and rel B indicates A should include all indices of B, vice versa.
     visitDepthFirst(translationUnit.getProgram(), [&](const RamSwap& swap) {
         // Note: this naive approach will not work if there exists chain or cyclic swapping.
@@ -328,14 +435,29 @@ void RamIndexAnalysis::print(std::ostream& os) const {
             os << "\n";
         }
 
+        // secondary indexes of compiled b-tree relations may store keys and references of the tuples
+        const bool direct = !Global::config().has("provenance") && rel.getChoiceDomain().empty() &&
+                            (rel.getRepresentation() == RelationRepresentation::BTREE ||
+                                    (rel.getRepresentation() == RelationRepresentation::DEFAULT &&
+                                            arity <= 6));
+        const auto storage = indexes.getIndexStorage(arity);
+
         os << "\tNumber of Indexes: " << indexes.getAllOrders().size() << "\n";
-        for (auto& order : indexes.getAllOrders()) {
+        for (size_t num = 0; num < indexes.getAllOrders().size(); num++) {
             os << "\t\t";
-            for (auto& i : order) {
+            for (auto& i : indexes.getAllOrders()[num]) {
                 os << attrib[i] << " ";
             }
+            if (direct && storage.indirect[num]) {
+                os << "(key and reference)";
+            }
             os << "\n";
         }
+
+        if (direct && storage.words < storage.directWords) {
+            os << "\tEstimated words per tuple: " << storage.words << " instead of " << storage.directWords
+               << ", scans of indexes of keys and references dereference each tuple\n";
+        }
     }
 }
 
@@ -350,6 +472,10 @@ SearchSignature RamIndexAnalysis::getSearchSignature(const RamIndexOperation* se
     return keys;
 }
 
+SearchSignature RamIndexAnalysis::getSearchSignature(const RamMergeJoin* merge) const {
+    return SearchSignature(1) << merge->getColumn();
+}
+
 SearchSignature RamIndexAnalysis::getSearchSignature(
         const RamProvenanceExistenceCheck* provExistCheck) const {
     const auto values = provExistCheck->getValues();
@@ -380,6 +506,23 @@ SearchSignature RamIndexAnalysis::getSearchSignature(const RamRelation* ramRel)
     return res;
 }
 
+MinIndexSelection::LexOrder RamIndexAnalysis::getOutputOrder(
+        const RamRelation& rel, const IODirectives& directives) const {
+    MinIndexSelection::LexOrder res;
+    const RelationRepresentation repr = rel.getRepresentation();
+    if (Global::config().has("provenance") ||
+            (repr != RelationRepresentation::DEFAULT && repr != RelationRepresentation::BTREE)) {
+        return res;
+    }
+    for (size_t column : directives.getOrderColumns()) {
+        if (rel.getAttributeTypes()[column][0] != 'i') {
+            return MinIndexSelection::LexOrder();
+        }
+        res.push_back(column);
+    }
+    return res;
+}
+
 bool RamIndexAnalysis::isTotalSignature(const RamAbstractExistenceCheck* existCheck) const {
     for (const auto& cur : existCheck->getValues()) {
         if (isRamUndefValue(cur)) {
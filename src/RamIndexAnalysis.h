@@ -16,11 +16,13 @@
 
 #pragma once
 
+#include "IODirectives.h"
 #include "RamAnalysis.h"
 #include "RamOperation.h"
 #include "RamRelation.h"
 #include "RamStatement.h"
 #include "RamTypes.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <functional>
@@ -156,6 +158,7 @@ public:
     using Chain = std::set<SearchSignature>;
     using ChainOrderMap = std::vector<Chain>;
     using SearchSet = std::set<SearchSignature>;
+    using SearchFrequencies = std::map<SearchSignature, size_t>;
 
     MinIndexSelection() = default;
     ~MinIndexSelection() = default;
@@ -172,6 +175,56 @@ public:
         return searches;
     }
 
+    /**
+     * @Brief Add the order an output is sorted by, whose prefixes are searched such that they
+     * form a chain, i.e. an index iterating the tuples in the order of the output
+     */
+    void addOrder(const LexOrder& columns) {
+        SearchSignature prefix = 0;
+        for (int column : columns) {
+            prefix |= SearchSignature(1) << column;
+            addSearch(prefix);
+        }
+        outputOrders.push_back(columns);
+    }
+
+    /** @Brief Get the orders outputs are sorted by */
+    const OrderCollection& getOutputOrders() const {
+        return outputOrders;
+    }
+
+    /**
+     * @Brief Get the index starting with the given columns, which iterates the tuples in their order
+     * @param columns an output is sorted by
+     * @result the number of the index, or -1 if the chain cover split the prefixes of the columns
+     */
+    int getOrderNum(const LexOrder& columns) const {
+        SearchSignature cols = 0;
+        for (int column : columns) {
+            cols |= SearchSignature(1) << column;
+        }
+        if (columns.empty() || searches.find(cols) == searches.end()) {
+            return -1;
+        }
+        const int idx = map(cols);
+        const LexOrder& order = orders[idx];
+        if (order.size() < columns.size() || !std::equal(columns.begin(), columns.end(), order.begin())) {
+            return -1;
+        }
+        return idx;
+    }
+
+    /** @Brief check whether all searches bind all attributes of a relation with the given arity */
+    bool hasOnlyTotalSearches(size_t arity) const {
+        const SearchSignature total = arity < 64 ? (SearchSignature(1) << arity) - 1 : ~SearchSignature(0);
+        for (SearchSignature search : searches) {
+            if (search != total) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     /** @Brief Get index for a search */
     const LexOrder getLexOrder(SearchSignature cols) const {
         int idx = map(cols);
@@ -217,6 +270,40 @@ public:
         return (b xor msb);
     }
 
+    /**
+     * @Brief serve infrequent searches by an index of a prefix of their columns
+     * @param frequencies profiled number of executions of the searches that may be served by a prefix
+     * @param matches estimated number of tuples matching a single binding of the columns of a signature
+     * @param indexCost estimated cost of maintaining an index of the relation
+     * @result maps each search that is not worth an index of its own to the prefix serving it
+     *
+     * Each search is covered by the minimal number of indexes, which is worthwhile for frequent searches
+     * only. The searches are considered in ascending order of frequency: a search dropping an index of
+     * the cover when served by the longest prefix of the remaining indexes is served by that prefix if
+     * the additionally scanned tuples cost less than maintaining the index. Hence, the extra index of a
+     * search is only added if it pays off.
+     */
+    std::map<SearchSignature, SearchSignature> reduceSearches(const SearchFrequencies& frequencies,
+            const std::function<double(SearchSignature)>& matches, double indexCost) const;
+
+    /** @Brief the storage of the indexes of a relation, estimated in words per tuple */
+    struct IndexStorage {
+        std::vector<bool> indirect;  // whether an index stores the columns of its key and a reference
+        size_t directWords;          // words per tuple if all indexes store complete tuples
+        size_t words;                // words per tuple of the chosen storage
+    };
+
+    /**
+     * @Brief choose the secondary indexes storing the columns of their key and a reference to the tuple
+     * @param arity of the relation
+     *
+     * The first index holds the complete tuples. A secondary index whose key and reference take fewer
+     * words than a tuple may store them instead, at the expense of a table keeping each tuple at a stable
+     * address once more. Since scans of such an index dereference each tuple found, they are chosen if
+     * they save at least an eighth of the words of the indexes storing complete tuples only.
+     */
+    IndexStorage getIndexStorage(size_t arity) const;
+
     /** @Brief insert a total order index
      *  @param size of the index
      */
@@ -233,10 +320,11 @@ public:
     }
 
 protected:
-    SearchSet searches;          // set of search patterns on table
-    OrderCollection orders;      // collection of lexicographical orders
-    ChainOrderMap chainToOrder;  // maps order index to set of searches covered by chain
-    MaxMatching matching;        // matching problem for finding minimal number of orders
+    SearchSet searches;            // set of search patterns on table
+    OrderCollection outputOrders;  // orders outputs are sorted by
+    OrderCollection orders;        // collection of lexicographical orders
+    ChainOrderMap chainToOrder;    // maps order index to set of searches covered by chain
+    MaxMatching matching;          // matching problem for finding minimal number of orders
 
     /** @Brief count the number of bits in key */
     static size_t card(SearchSignature cols) {
@@ -348,6 +436,13 @@ public:
      */
     SearchSignature getSearchSignature(const RamIndexOperation* search) const;
 
+    /**
+     * @Brief Get the index signature ordering the relation of a merge join by its column
+     * @param Merge join
+     * @result Index signature of the merge join
+     */
+    SearchSignature getSearchSignature(const RamMergeJoin* merge) const;
+
     /**
      * @Brief Get the index signature for an existence check
      * @param Existence check
@@ -378,6 +473,17 @@ public:
      */
     bool isTotalSignature(const RamAbstractExistenceCheck* existCheck) const;
 
+    /**
+     * @Brief Get the columns an output is sorted by, if an index may iterate the tuples in their order
+     * @param relation and directives of the output
+     * @result the columns, or none if the output is not sorted or is sorted by its writer
+     *
+     * The indexes of b-tree relations order the tuples by the signed values of their columns, which is
+     * the order of an output by columns of numbers. Other types, e.g. symbols ordered by their text,
+     * and other representations are sorted by the writer.
+     */
+    MinIndexSelection::LexOrder getOutputOrder(const RamRelation& rel, const IODirectives& directives) const;
+
 private:
     /**
      * minimal index cover for relations, i.e., maps a relation to a set of indexes
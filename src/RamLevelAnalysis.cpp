@@ -58,6 +58,18 @@ int RamLevelAnalysis::getLevel(const RamNode* node) const {
             return level;
         }
 
+        // leapfrog join
+        int visitLeapfrogJoin(const RamLeapfrogJoin& join) override {
+            int level = -1;
+            for (auto& index : join.getRangePattern()) {
+                level = std::max(level, visit(index));
+            }
+            for (auto& intersection : join.getIntersections()) {
+                level = std::max(level, visit(intersection));
+            }
+            return level;
+        }
+
         // choice
         int visitChoice(const RamChoice& choice) override {
             return std::max(-1, visit(choice.getCondition()));
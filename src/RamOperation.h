@@ -23,11 +23,14 @@
 #include "RamTypes.h"
 #include "RamUtils.h"
 #include "Util.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
 namespace souffle {
@@ -404,6 +407,248 @@ public:
     }
 };
 
+/**
+ * @class RamLeapfrogJoin
+ * @brief Search for tuples of a relation whose free column is matched in other relations
+ *
+ * The range pattern binds all but one column of the relation. Each
+ * intersection is an existence check leaving a single column unspecified.
+ * A tuple of the range is found if its free column occurs in the unspecified
+ * column of all intersections. Since the indexes of the searches are ordered
+ * by the free columns, the values are found by a leapfrog join, advancing
+ * each search in turn to the largest value seen so far.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *	 LEAPFROG t1 IN X ON INDEX t1.a = t0.1 WITH (t0.0,_) ∈ Y
+ *	 ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamLeapfrogJoin : public RamIndexOperation {
+public:
+    RamLeapfrogJoin(std::unique_ptr<RamRelationReference> r, int ident,
+            std::vector<std::unique_ptr<RamExpression>> queryPattern,
+            std::vector<std::unique_ptr<RamExistenceCheck>> intersections,
+            std::unique_ptr<RamOperation> nested, std::string profileText = "")
+            : RamIndexOperation(std::move(r), ident, std::move(queryPattern), std::move(nested),
+                      std::move(profileText)),
+              intersections(std::move(intersections)) {
+        assert(!this->intersections.empty() && "no relation to intersect with");
+        assert(getFreeColumn(getRangePattern()) < getRelation().getArity() && "no free column");
+        for (const auto& cur : this->intersections) {
+            assert(getFreeColumn(cur->getValues()) < cur->getRelation().getArity() && "no free column");
+        }
+    }
+
+    /** @brief Get the existence checks intersected with the range */
+    std::vector<RamExistenceCheck*> getIntersections() const {
+        return toPtrVector(intersections);
+    }
+
+    /**
+     * @brief Get the single unspecified column of a pattern
+     * @return the column, or the size of the pattern if there is none
+     */
+    static size_t getFreeColumn(const std::vector<RamExpression*>& pattern) {
+        size_t res = pattern.size();
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (isRamUndefValue(pattern[i])) {
+                if (res != pattern.size()) {
+                    return pattern.size();
+                }
+                res = i;
+            }
+        }
+        return res;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        const RamRelation& rel = getRelation();
+        os << times(" ", tabpos);
+        os << "LEAPFROG t" << getTupleId() << " IN ";
+        os << rel.getName();
+        printIndex(os);
+        os << " WITH " << join(intersections, " AND ", print_deref<std::unique_ptr<RamExistenceCheck>>());
+        os << std::endl;
+        RamIndexOperation::print(os, tabpos + 1);
+    }
+
+    std::vector<const RamNode*> getChildNodes() const override {
+        auto res = RamIndexOperation::getChildNodes();
+        for (auto& cur : intersections) {
+            res.push_back(cur.get());
+        }
+        return res;
+    }
+
+    void apply(const RamNodeMapper& map) override {
+        RamIndexOperation::apply(map);
+        for (auto& cur : intersections) {
+            cur = map(std::move(cur));
+        }
+    }
+
+    RamLeapfrogJoin* clone() const override {
+        std::vector<std::unique_ptr<RamExpression>> resQueryPattern(queryPattern.size());
+        for (unsigned int i = 0; i < queryPattern.size(); ++i) {
+            resQueryPattern[i] = std::unique_ptr<RamExpression>(queryPattern[i]->clone());
+        }
+        std::vector<std::unique_ptr<RamExistenceCheck>> resIntersections;
+        for (const auto& cur : intersections) {
+            resIntersections.push_back(std::unique_ptr<RamExistenceCheck>(cur->clone()));
+        }
+        return new RamLeapfrogJoin(std::unique_ptr<RamRelationReference>(relationRef->clone()), getTupleId(),
+                std::move(resQueryPattern), std::move(resIntersections),
+                std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamLeapfrogJoin&>(node);
+        return RamIndexOperation::equal(other) && equal_targets(intersections, other.intersections);
+    }
+
+    /** Existence checks, each leaving the column to be matched unspecified */
+    std::vector<std::unique_ptr<RamExistenceCheck>> intersections;
+};
+
+/**
+ * @class RamMergeJoin
+ * @brief Iterate all tuples of a relation ordered by a column, merging them with the index scan
+ * nested in the operation
+ *
+ * The nested index scan binds a single column to the ordering column of the
+ * scanned tuple, hence the tuples of both relations are visited in the order
+ * of the joined columns. Rather than descending into the index of the nested
+ * scan for each tuple, both are streamed in order, advancing the nested scan
+ * to the value of each new tuple of the relation.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *   MERGE t0 IN A ON INDEX t0.1
+ *    FOR t1 IN B ON INDEX t1.0 = t0.1
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamMergeJoin : public RamScan {
+public:
+    /**
+     * The number of tuples the cursor on the nested index scan is advanced by, before the
+     * next value of the relation is sought in the index of the nested scan instead
+     */
+    static constexpr size_t LINEAR_STEPS = 8;
+
+    RamMergeJoin(std::unique_ptr<RamRelationReference> rel, int ident, size_t column,
+            std::unique_ptr<RamOperation> nested, std::string profileText = "")
+            : RamScan(std::move(rel), ident, std::move(nested), std::move(profileText)), column(column) {
+        assert(column < getRelation().getArity() && "column out of range");
+        assert(isMergeable(ident, column, getOperation()) && "no index scan to merge with");
+    }
+
+    /** @brief Get the column ordering the tuples of the relation */
+    size_t getColumn() const {
+        return column;
+    }
+
+    /** @brief Get the index scan merged with the relation */
+    const RamIndexScan& getInnerScan() const {
+        return static_cast<const RamIndexScan&>(getOperation());
+    }
+
+    /** @brief Get the column of the nested index scan bound to the ordering column */
+    size_t getInnerColumn() const {
+        const auto pattern = getInnerScan().getRangePattern();
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (!isRamUndefValue(pattern[i])) {
+                return i;
+            }
+        }
+        return pattern.size();
+    }
+
+    /**
+     * @brief Check whether an operation nested in the scan of the given tuple is an index scan
+     * binding a single column to the given column of the tuple, which the scan can be merged with
+     */
+    static bool isMergeable(int ident, size_t column, const RamOperation& nested) {
+        const auto* iscan = dynamic_cast<const RamIndexScan*>(&nested);
+        if (iscan == nullptr || dynamic_cast<const RamAbstractParallel*>(iscan) != nullptr) {
+            return false;
+        }
+        size_t bound = 0;
+        for (const RamExpression* value : iscan->getRangePattern()) {
+            if (isRamUndefValue(value)) {
+                continue;
+            }
+            const auto* element = dynamic_cast<const RamTupleElement*>(value);
+            if (element == nullptr || element->getTupleId() != ident || element->getElement() != column) {
+                return false;
+            }
+            bound++;
+        }
+        return bound == 1;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "MERGE t" << getTupleId() << " IN " << getRelation().getName();
+        os << " ON INDEX t" << getTupleId() << "." << column << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamMergeJoin* clone() const override {
+        return new RamMergeJoin(std::unique_ptr<RamRelationReference>(relationRef->clone()), getTupleId(),
+                column, std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamMergeJoin&>(node);
+        return RamScan::equal(other) && column == other.column;
+    }
+
+    /** Column ordering the tuples of the relation */
+    const size_t column;
+};
+
+/**
+ * @class RamParallelMergeJoin
+ * @brief Merge the tuples of a relation with the nested index scan in parallel, each thread
+ * merging a chunk of the tuples ordered by the column
+ *
+ * An example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *   PARALLEL MERGE t0 IN A ON INDEX t0.1
+ *    FOR t1 IN B ON INDEX t1.0 = t0.1
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamParallelMergeJoin : public RamMergeJoin, public RamAbstractParallel {
+public:
+    RamParallelMergeJoin(std::unique_ptr<RamRelationReference> rel, int ident, size_t column,
+            std::unique_ptr<RamOperation> nested, std::string profileText = "")
+            : RamMergeJoin(std::move(rel), ident, column, std::move(nested), std::move(profileText)) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "PARALLEL MERGE t" << getTupleId() << " IN " << getRelation().getName();
+        os << " ON INDEX t" << getTupleId() << "." << column << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamParallelMergeJoin* clone() const override {
+        return new RamParallelMergeJoin(std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                getTupleId(), column, std::unique_ptr<RamOperation>(getOperation().clone()),
+                getProfileText());
+    }
+};
+
 /**
  * @class RamAbstractChoice
  * @brief Abstract class for a choice operation
@@ -778,6 +1023,45 @@ protected:
     }
 };
 
+/**
+ * @class RamParallelAggregate
+ * @brief Aggregation function applied on some relation in parallel
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * PARALLEL t0.0=COUNT FOR ALL t0 IN A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Partial results are computed per thread and combined
+ * before the nested operation is executed once.
+ */
+class RamParallelAggregate : public RamAggregate, public RamAbstractParallel {
+public:
+    RamParallelAggregate(std::unique_ptr<RamOperation> nested, AggregateFunction fun,
+            std::unique_ptr<RamRelationReference> relRef, std::unique_ptr<RamExpression> expression,
+            std::unique_ptr<RamCondition> condition, int ident)
+            : RamAggregate(std::move(nested), fun, std::move(relRef), std::move(expression),
+                      std::move(condition), ident) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "PARALLEL t" << getTupleId() << ".0=";
+        RamAbstractAggregate::print(os, tabpos);
+        os << "FOR ALL t" << getTupleId() << " ∈ " << getRelation().getName();
+        if (!isRamTrue(condition.get())) {
+            os << " WHERE " << getCondition();
+        }
+        os << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamParallelAggregate* clone() const override {
+        return new RamParallelAggregate(std::unique_ptr<RamOperation>(getOperation().clone()), function,
+                std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                std::unique_ptr<RamExpression>(expression->clone()),
+                std::unique_ptr<RamCondition>(condition->clone()), getTupleId());
+    }
+};
+
 /**
  * @class RamIndexAggregate
  * @brief Indexed aggregation on a relation
@@ -835,6 +1119,44 @@ protected:
     }
 };
 
+/**
+ * @class RamParallelIndexAggregate
+ * @brief Indexed aggregation on a relation in parallel
+ */
+class RamParallelIndexAggregate : public RamIndexAggregate, public RamAbstractParallel {
+public:
+    RamParallelIndexAggregate(std::unique_ptr<RamOperation> nested, AggregateFunction fun,
+            std::unique_ptr<RamRelationReference> relRef, std::unique_ptr<RamExpression> expression,
+            std::unique_ptr<RamCondition> condition, std::vector<std::unique_ptr<RamExpression>> queryPattern,
+            int ident)
+            : RamIndexAggregate(std::move(nested), fun, std::move(relRef), std::move(expression),
+                      std::move(condition), std::move(queryPattern), ident) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "PARALLEL t" << getTupleId() << ".0=";
+        RamAbstractAggregate::print(os, tabpos);
+        os << "SEARCH t" << getTupleId() << " ∈ " << getRelation().getName();
+        printIndex(os);
+        if (!isRamTrue(condition.get())) {
+            os << " WHERE " << getCondition();
+        }
+        os << std::endl;
+        RamIndexOperation::print(os, tabpos + 1);
+    }
+
+    RamParallelIndexAggregate* clone() const override {
+        std::vector<std::unique_ptr<RamExpression>> pattern;
+        for (auto const& e : queryPattern) {
+            pattern.push_back(std::unique_ptr<RamExpression>(e->clone()));
+        }
+        return new RamParallelIndexAggregate(std::unique_ptr<RamOperation>(getOperation().clone()),
+                function, std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                std::unique_ptr<RamExpression>(expression->clone()),
+                std::unique_ptr<RamCondition>(condition->clone()), std::move(pattern), getTupleId());
+    }
+};
+
 /**
  * @class RamUnpackRecord
  * @brief Record lookup
@@ -1011,6 +1333,291 @@ protected:
     }
 };
 
+/**
+ * @class RamHashJoin
+ * @brief Join all tuples of a relation with the scan nested in the operation through a transient
+ * hash table
+ *
+ * The nested scan is filtered by keys equating columns of its tuple with
+ * columns of the scanned tuple or with constants. Rather than searching an
+ * index of the nested relation for each tuple, a hash table of the smaller
+ * of both relations is built on the keys once, and probed by the tuples of
+ * the other relation. The hash table is discarded at the end of the
+ * operation, hence the nested relation does not need an index for the keys.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *   HASH t0 IN A
+ *    FOR t1 IN B
+ *     IF (t1.0 = t0.1)
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamHashJoin : public RamScan {
+public:
+    RamHashJoin(std::unique_ptr<RamRelationReference> rel, int ident, std::unique_ptr<RamOperation> nested,
+            std::string profileText = "")
+            : RamScan(std::move(rel), ident, std::move(nested), std::move(profileText)) {
+        assert(isHashable(ident, getOperation()) && "no keys to join the nested scan on");
+    }
+
+    /** @brief Get the scan joined with the relation */
+    const RamScan& getInnerScan() const {
+        return static_cast<const RamScan&>(getOperation());
+    }
+
+    /**
+     * @brief Get the keys of the join, i.e., the columns of the nested scan with the tuple elements
+     * of the relation or the constants they are equated with
+     */
+    std::vector<std::pair<size_t, const RamExpression*>> getKeys() const {
+        return getKeys(getTupleId(), getOperation());
+    }
+
+    /**
+     * @brief Check whether an operation nested in the scan of the given tuple is a scan filtered by
+     * keys on the tuple, which the scan can be joined with by a hash table
+     */
+    static bool isHashable(int ident, const RamOperation& nested) {
+        const auto keys = getKeys(ident, nested);
+        return std::any_of(keys.begin(), keys.end(), [](const std::pair<size_t, const RamExpression*>& key) {
+            return dynamic_cast<const RamTupleElement*>(key.second) != nullptr;
+        });
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "HASH t" << getTupleId() << " IN " << getRelation().getName() << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamHashJoin* clone() const override {
+        return new RamHashJoin(std::unique_ptr<RamRelationReference>(relationRef->clone()), getTupleId(),
+                std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+
+protected:
+    /** Get the keys of the filter directly nested in a plain scan nested in the scan of the given tuple */
+    static std::vector<std::pair<size_t, const RamExpression*>> getKeys(
+            int ident, const RamOperation& nested) {
+        std::vector<std::pair<size_t, const RamExpression*>> keys;
+        const auto* scan = dynamic_cast<const RamScan*>(&nested);
+        if (scan == nullptr || typeid(*scan) != typeid(RamScan)) {
+            return keys;
+        }
+        const auto* filter = dynamic_cast<const RamFilter*>(&scan->getOperation());
+        if (filter == nullptr) {
+            return keys;
+        }
+        std::vector<const RamCondition*> conditions = {&filter->getCondition()};
+        while (!conditions.empty()) {
+            const RamCondition* condition = conditions.back();
+            conditions.pop_back();
+            if (const auto* conj = dynamic_cast<const RamConjunction*>(condition)) {
+                conditions.push_back(&conj->getRHS());
+                conditions.push_back(&conj->getLHS());
+                continue;
+            }
+            const auto* constraint = dynamic_cast<const RamConstraint*>(condition);
+            if (constraint == nullptr || constraint->getOperator() != BinaryConstraintOp::EQ) {
+                continue;
+            }
+            const auto* column = dynamic_cast<const RamTupleElement*>(&constraint->getLHS());
+            const auto* element = dynamic_cast<const RamTupleElement*>(&constraint->getRHS());
+            if (column == nullptr || column->getTupleId() != scan->getTupleId() ||
+                    (element == nullptr ? dynamic_cast<const RamConstant*>(&constraint->getRHS()) == nullptr
+                                        : element->getTupleId() != ident)) {
+                continue;
+            }
+            keys.emplace_back(column->getElement(), &constraint->getRHS());
+        }
+        return keys;
+    }
+};
+
+/**
+ * @class RamParallelHashJoin
+ * @brief Join the tuples of a relation with the nested scan through a transient hash table, which
+ * is probed by the tuples of the larger relation in parallel
+ *
+ * An example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *   PARALLEL HASH t0 IN A
+ *    FOR t1 IN B
+ *     IF (t1.0 = t0.1)
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamParallelHashJoin : public RamHashJoin, public RamAbstractParallel {
+public:
+    RamParallelHashJoin(std::unique_ptr<RamRelationReference> rel, int ident,
+            std::unique_ptr<RamOperation> nested, std::string profileText = "")
+            : RamHashJoin(std::move(rel), ident, std::move(nested), std::move(profileText)) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "PARALLEL HASH t" << getTupleId() << " IN " << getRelation().getName() << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamParallelHashJoin* clone() const override {
+        return new RamParallelHashJoin(std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                getTupleId(), std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+};
+
+/**
+ * @class RamGroupAggregate
+ * @brief Aggregate over the groups of a relation for all tuples of another relation at once,
+ * grouping the aggregated tuples by a transient hash table
+ *
+ * The nested aggregation is restricted by keys equating columns of its tuple
+ * with elements of the scanned tuple, and its remaining condition and its
+ * target expression do not refer to the scanned tuple. Rather than searching
+ * the aggregated relation for each scanned tuple, the aggregates of all
+ * groups of keys are computed by a single pass over the aggregated relation,
+ * and looked up by the elements of each scanned tuple. A scanned tuple
+ * without a group obtains the aggregate of no tuples. The hash table is
+ * discarded at the end of the operation.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *   GROUP t0 IN A
+ *    t1.0=COUNT FOR ALL t1 ∈ B WHERE (t1.0 = t0.0)
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamGroupAggregate : public RamScan {
+public:
+    RamGroupAggregate(std::unique_ptr<RamRelationReference> rel, int ident,
+            std::unique_ptr<RamOperation> nested, std::string profileText = "")
+            : RamScan(std::move(rel), ident, std::move(nested), std::move(profileText)) {
+        assert(isGroupable(ident, getOperation()) && "no keys to group the nested aggregate by");
+    }
+
+    /** @brief Get the aggregation computed for each scanned tuple */
+    const RamAggregate& getAggregate() const {
+        return static_cast<const RamAggregate&>(getOperation());
+    }
+
+    /**
+     * @brief Get the keys of the groups, i.e., the columns of the aggregated relation with the elements
+     * of the scanned tuple they are equated with
+     */
+    std::vector<std::pair<size_t, size_t>> getKeys() const {
+        return getKeys(getTupleId(), getOperation());
+    }
+
+    /**
+     * @brief Check whether an operation nested in the scan of the given tuple is an aggregation
+     * restricted by keys on the tuple only, whose groups can be computed for all scanned tuples at once
+     */
+    static bool isGroupable(int ident, const RamOperation& nested) {
+        const auto keys = getKeys(ident, nested);
+        if (keys.empty()) {
+            return false;
+        }
+        // the scanned tuple is only referred to by the keys
+        const auto& aggregate = static_cast<const RamAggregate&>(nested);
+        return countReferences(ident, aggregate.getCondition()) +
+                       countReferences(ident, aggregate.getExpression()) ==
+               keys.size();
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "GROUP t" << getTupleId() << " IN " << getRelation().getName() << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamGroupAggregate* clone() const override {
+        return new RamGroupAggregate(std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                getTupleId(), std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+
+protected:
+    /** Count the elements of the given tuple referred to by a node and its descendants */
+    static size_t countReferences(int ident, const RamNode& node) {
+        const auto* element = dynamic_cast<const RamTupleElement*>(&node);
+        size_t count = (element != nullptr && element->getTupleId() == ident) ? 1 : 0;
+        for (const RamNode* child : node.getChildNodes()) {
+            count += countReferences(ident, *child);
+        }
+        return count;
+    }
+
+    /** Get the keys of the condition of a plain aggregation nested in the scan of the given tuple */
+    static std::vector<std::pair<size_t, size_t>> getKeys(int ident, const RamOperation& nested) {
+        std::vector<std::pair<size_t, size_t>> keys;
+        if (typeid(nested) != typeid(RamAggregate)) {
+            return keys;
+        }
+        const auto& aggregate = static_cast<const RamAggregate&>(nested);
+        std::vector<const RamCondition*> conditions = {&aggregate.getCondition()};
+        while (!conditions.empty()) {
+            const RamCondition* condition = conditions.back();
+            conditions.pop_back();
+            if (const auto* conj = dynamic_cast<const RamConjunction*>(condition)) {
+                conditions.push_back(&conj->getRHS());
+                conditions.push_back(&conj->getLHS());
+                continue;
+            }
+            const auto* constraint = dynamic_cast<const RamConstraint*>(condition);
+            if (constraint == nullptr || constraint->getOperator() != BinaryConstraintOp::EQ) {
+                continue;
+            }
+            const auto* column = dynamic_cast<const RamTupleElement*>(&constraint->getLHS());
+            const auto* element = dynamic_cast<const RamTupleElement*>(&constraint->getRHS());
+            if (column != nullptr && element != nullptr && column->getTupleId() == aggregate.getTupleId() &&
+                    element->getTupleId() == ident) {
+                keys.emplace_back(column->getElement(), element->getElement());
+            }
+        }
+        return keys;
+    }
+};
+
+/**
+ * @class RamParallelGroupAggregate
+ * @brief Aggregate over the groups of a relation for all tuples of another relation at once, computing
+ * the groups and scanning the tuples in parallel
+ *
+ * Each thread aggregates a part of the aggregated relation into a hash table
+ * of its own, and the partial tables are merged before the scan.
+ *
+ * An example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *   PARALLEL GROUP t0 IN A
+ *    t1.0=COUNT FOR ALL t1 ∈ B WHERE (t1.0 = t0.0)
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamParallelGroupAggregate : public RamGroupAggregate, public RamAbstractParallel {
+public:
+    RamParallelGroupAggregate(std::unique_ptr<RamRelationReference> rel, int ident,
+            std::unique_ptr<RamOperation> nested, std::string profileText = "")
+            : RamGroupAggregate(std::move(rel), ident, std::move(nested), std::move(profileText)) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "PARALLEL GROUP t" << getTupleId() << " IN " << getRelation().getName() << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamParallelGroupAggregate* clone() const override {
+        return new RamParallelGroupAggregate(std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                getTupleId(), std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+};
+
 /**
  * @class RamProject
  * @brief Project a result into the target relation.
@@ -96,6 +96,12 @@ public:
         return toPtrVector(relations);
     }
 
+    /** @brief Add a relation, e.g. a temporary relation introduced by a transformation */
+    void addRelation(std::unique_ptr<RamRelation> relation) {
+        assert(relation != nullptr && "Relation is a null-pointer");
+        relations.push_back(std::move(relation));
+    }
+
     /** @brief Get all subroutines of a RAM program */
     const std::map<std::string, RamStatement*> getSubroutines() const {
         std::map<std::string, RamStatement*> subroutineRefs;
@@ -0,0 +1,1220 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamProgramCache.cpp
+ *
+ * Implementation of the cache of translated RAM programs
+ *
+ ***********************************************************************/
+
+#include "RamProgramCache.h"
+#include "Global.h"
+#include "IODirectives.h"
+#include "RamCondition.h"
+#include "RamExpression.h"
+#include "RamOperation.h"
+#include "RamRelation.h"
+#include "RamStatement.h"
+#include "RamVisitor.h"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace souffle {
+
+namespace {
+
+/** The kinds of RAM nodes identifying them in a cache file */
+enum class NodeKind : uint64_t {
+    // expressions
+    TupleElement,
+    SignedConstant,
+    UnsignedConstant,
+    FloatConstant,
+    IntrinsicOperator,
+    UserDefinedOperator,
+    AutoIncrement,
+    PackRecord,
+    SubroutineArgument,
+    UndefValue,
+
+    // conditions
+    True,
+    False,
+    EmptinessCheck,
+    ExistenceCheck,
+    ProvenanceExistenceCheck,
+    Conjunction,
+    Negation,
+    Constraint,
+
+    // operations
+    Filter,
+    Break,
+    Project,
+    SubroutineReturnValue,
+    UnpackRecord,
+    Scan,
+    ParallelScan,
+    IndexScan,
+    ParallelIndexScan,
+    LeapfrogJoin,
+    MergeJoin,
+    ParallelMergeJoin,
+    HashJoin,
+    ParallelHashJoin,
+    GroupAggregate,
+    ParallelGroupAggregate,
+    Choice,
+    ParallelChoice,
+    IndexChoice,
+    ParallelIndexChoice,
+    Aggregate,
+    ParallelAggregate,
+    IndexAggregate,
+    ParallelIndexAggregate,
+
+    // statements
+    Load,
+    Store,
+    Query,
+    Clear,
+    BuildIndex,
+    DropIndex,
+    LogSize,
+    LogStatistics,
+    LogMemory,
+    Swap,
+    Extend,
+    Sequence,
+    Loop,
+    Parallel,
+    Schedule,
+    AdaptiveQuery,
+    Exit,
+    LogTimer,
+    LogRelationTimer,
+    DebugInfo,
+    Checkpoint
+};
+
+/**
+ * Writes the nodes of a RAM program, each as its kind followed by its fields and children
+ */
+class RamWriter : public RamVisitor<void> {
+public:
+    explicit RamWriter(std::ostream& out) : out(out) {}
+
+    void writeInt(uint64_t value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(const std::string& str) {
+        writeInt(str.size());
+        out.write(str.data(), str.size());
+    }
+
+    void writeRelation(const RamRelation& relation) {
+        writeString(relation.getName());
+    }
+
+    template <class Node>
+    void writeNodes(const std::vector<Node*>& nodes) {
+        writeInt(nodes.size());
+        for (const Node* node : nodes) {
+            visit(*node);
+        }
+    }
+
+protected:
+    void writeKind(NodeKind kind) {
+        writeInt(static_cast<uint64_t>(kind));
+    }
+
+    void writeDomain(RamDomain value) {
+        writeInt(static_cast<uint64_t>(static_cast<int64_t>(value)));
+    }
+
+    // -- expressions --
+
+    void visitTupleElement(const RamTupleElement& elem) override {
+        writeKind(NodeKind::TupleElement);
+        writeInt(elem.getTupleId());
+        writeInt(elem.getElement());
+    }
+
+    void visitSignedConstant(const RamSignedConstant& constant) override {
+        writeKind(NodeKind::SignedConstant);
+        writeDomain(constant.getConstant());
+    }
+
+    void visitUnsignedConstant(const RamUnsignedConstant& constant) override {
+        writeKind(NodeKind::UnsignedConstant);
+        writeDomain(constant.getConstant());
+    }
+
+    void visitFloatConstant(const RamFloatConstant& constant) override {
+        writeKind(NodeKind::FloatConstant);
+        writeDomain(constant.getConstant());
+    }
+
+    void visitIntrinsicOperator(const RamIntrinsicOperator& op) override {
+        writeKind(NodeKind::IntrinsicOperator);
+        writeInt(static_cast<uint64_t>(op.getOperator()));
+        writeNodes(op.getArguments());
+    }
+
+    void visitUserDefinedOperator(const RamUserDefinedOperator& op) override {
+        writeKind(NodeKind::UserDefinedOperator);
+        writeString(op.getName());
+        writeInt(op.getArgsTypes().size());
+        for (TypeAttribute type : op.getArgsTypes()) {
+            writeInt(static_cast<uint64_t>(type));
+        }
+        writeInt(static_cast<uint64_t>(op.getReturnType()));
+        writeInt(op.isStateful() ? 1 : 0);
+        writeNodes(op.getArguments());
+    }
+
+    void visitAutoIncrement(const RamAutoIncrement&) override {
+        writeKind(NodeKind::AutoIncrement);
+    }
+
+    void visitPackRecord(const RamPackRecord& pack) override {
+        writeKind(NodeKind::PackRecord);
+        writeNodes(pack.getArguments());
+    }
+
+    void visitSubroutineArgument(const RamSubroutineArgument& arg) override {
+        writeKind(NodeKind::SubroutineArgument);
+        writeInt(arg.getArgument());
+    }
+
+    void visitUndefValue(const RamUndefValue&) override {
+        writeKind(NodeKind::UndefValue);
+    }
+
+    // -- conditions --
+
+    void visitTrue(const RamTrue&) override {
+        writeKind(NodeKind::True);
+    }
+
+    void visitFalse(const RamFalse&) override {
+        writeKind(NodeKind::False);
+    }
+
+    void visitEmptinessCheck(const RamEmptinessCheck& check) override {
+        writeKind(NodeKind::EmptinessCheck);
+        writeRelation(check.getRelation());
+    }
+
+    void visitExistenceCheck(const RamExistenceCheck& check) override {
+        writeKind(NodeKind::ExistenceCheck);
+        writeRelation(check.getRelation());
+        writeNodes(check.getValues());
+    }
+
+    void visitProvenanceExistenceCheck(const RamProvenanceExistenceCheck& check) override {
+        writeKind(NodeKind::ProvenanceExistenceCheck);
+        writeRelation(check.getRelation());
+        writeNodes(check.getValues());
+    }
+
+    void visitConjunction(const RamConjunction& conj) override {
+        writeKind(NodeKind::Conjunction);
+        visit(conj.getLHS());
+        visit(conj.getRHS());
+    }
+
+    void visitNegation(const RamNegation& neg) override {
+        writeKind(NodeKind::Negation);
+        visit(neg.getOperand());
+    }
+
+    void visitConstraint(const RamConstraint& constraint) override {
+        writeKind(NodeKind::Constraint);
+        writeInt(static_cast<uint64_t>(constraint.getOperator()));
+        visit(constraint.getLHS());
+        visit(constraint.getRHS());
+    }
+
+    // -- operations --
+
+    void visitFilter(const RamFilter& filter) override {
+        writeKind(NodeKind::Filter);
+        visit(filter.getCondition());
+        writeString(filter.getProfileText());
+        visit(filter.getOperation());
+    }
+
+    void visitBreak(const RamBreak& breakOp) override {
+        writeKind(NodeKind::Break);
+        visit(breakOp.getCondition());
+        writeString(breakOp.getProfileText());
+        visit(breakOp.getOperation());
+    }
+
+    void visitProject(const RamProject& project) override {
+        writeKind(NodeKind::Project);
+        writeRelation(project.getRelation());
+        writeNodes(project.getValues());
+    }
+
+    void visitSubroutineReturnValue(const RamSubroutineReturnValue& ret) override {
+        writeKind(NodeKind::SubroutineReturnValue);
+        writeNodes(ret.getValues());
+    }
+
+    void visitUnpackRecord(const RamUnpackRecord& unpack) override {
+        writeKind(NodeKind::UnpackRecord);
+        writeInt(unpack.getTupleId());
+        visit(unpack.getExpression());
+        writeInt(unpack.getArity());
+        visit(unpack.getOperation());
+    }
+
+    void visitParallelMergeJoin(const RamParallelMergeJoin& merge) override {
+        writeKind(NodeKind::ParallelMergeJoin);
+        writeMergeJoin(merge);
+    }
+
+    void visitMergeJoin(const RamMergeJoin& merge) override {
+        writeKind(NodeKind::MergeJoin);
+        writeMergeJoin(merge);
+    }
+
+    void visitParallelHashJoin(const RamParallelHashJoin& join) override {
+        writeKind(NodeKind::ParallelHashJoin);
+        writeScan(join);
+    }
+
+    void visitHashJoin(const RamHashJoin& join) override {
+        writeKind(NodeKind::HashJoin);
+        writeScan(join);
+    }
+
+    void visitParallelGroupAggregate(const RamParallelGroupAggregate& group) override {
+        writeKind(NodeKind::ParallelGroupAggregate);
+        writeScan(group);
+    }
+
+    void visitGroupAggregate(const RamGroupAggregate& group) override {
+        writeKind(NodeKind::GroupAggregate);
+        writeScan(group);
+    }
+
+    void visitParallelScan(const RamParallelScan& scan) override {
+        writeKind(NodeKind::ParallelScan);
+        writeScan(scan);
+    }
+
+    void visitScan(const RamScan& scan) override {
+        writeKind(NodeKind::Scan);
+        writeScan(scan);
+    }
+
+    void visitParallelIndexScan(const RamParallelIndexScan& scan) override {
+        writeKind(NodeKind::ParallelIndexScan);
+        writeScan(scan);
+    }
+
+    void visitIndexScan(const RamIndexScan& scan) override {
+        writeKind(NodeKind::IndexScan);
+        writeScan(scan);
+    }
+
+    void visitLeapfrogJoin(const RamLeapfrogJoin& join) override {
+        writeKind(NodeKind::LeapfrogJoin);
+        writeRelation(join.getRelation());
+        writeInt(join.getTupleId());
+        writeNodes(join.getRangePattern());
+        writeNodes(join.getIntersections());
+        writeString(join.getProfileText());
+        visit(join.getOperation());
+    }
+
+    void visitParallelChoice(const RamParallelChoice& choice) override {
+        writeKind(NodeKind::ParallelChoice);
+        writeChoice(choice);
+    }
+
+    void visitChoice(const RamChoice& choice) override {
+        writeKind(NodeKind::Choice);
+        writeChoice(choice);
+    }
+
+    void visitParallelIndexChoice(const RamParallelIndexChoice& choice) override {
+        writeKind(NodeKind::ParallelIndexChoice);
+        writeChoice(choice);
+    }
+
+    void visitIndexChoice(const RamIndexChoice& choice) override {
+        writeKind(NodeKind::IndexChoice);
+        writeChoice(choice);
+    }
+
+    void visitParallelAggregate(const RamParallelAggregate& aggregate) override {
+        writeKind(NodeKind::ParallelAggregate);
+        writeAggregate(aggregate);
+    }
+
+    void visitAggregate(const RamAggregate& aggregate) override {
+        writeKind(NodeKind::Aggregate);
+        writeAggregate(aggregate);
+    }
+
+    void visitParallelIndexAggregate(const RamParallelIndexAggregate& aggregate) override {
+        writeKind(NodeKind::ParallelIndexAggregate);
+        writeAggregate(aggregate);
+    }
+
+    void visitIndexAggregate(const RamIndexAggregate& aggregate) override {
+        writeKind(NodeKind::IndexAggregate);
+        writeAggregate(aggregate);
+    }
+
+    // -- statements --
+
+    void visitLoad(const RamLoad& load) override {
+        writeKind(NodeKind::Load);
+        writeLoadStore(load);
+    }
+
+    void visitStore(const RamStore& store) override {
+        writeKind(NodeKind::Store);
+        writeLoadStore(store);
+    }
+
+    void visitQuery(const RamQuery& query) override {
+        writeKind(NodeKind::Query);
+        visit(query.getOperation());
+    }
+
+    void visitClear(const RamClear& clear) override {
+        writeKind(NodeKind::Clear);
+        writeRelation(clear.getRelation());
+    }
+
+    void visitBuildIndex(const RamBuildIndex& build) override {
+        writeKind(NodeKind::BuildIndex);
+        writeRelation(build.getRelation());
+        writeInt(build.getSearchSignature());
+    }
+
+    void visitDropIndex(const RamDropIndex& drop) override {
+        writeKind(NodeKind::DropIndex);
+        writeRelation(drop.getRelation());
+        writeInt(drop.getSearchSignature());
+    }
+
+    void visitLogSize(const RamLogSize& log) override {
+        writeKind(NodeKind::LogSize);
+        writeRelation(log.getRelation());
+        writeString(log.getMessage());
+    }
+
+    void visitLogStatistics(const RamLogStatistics& log) override {
+        writeKind(NodeKind::LogStatistics);
+        writeRelation(log.getRelation());
+        writeString(log.getMessage());
+    }
+
+    void visitLogMemory(const RamLogMemory& log) override {
+        writeKind(NodeKind::LogMemory);
+        writeInt(log.getStratum());
+        writeInt(log.getRelations().size());
+        for (const RamRelation* rel : log.getRelations()) {
+            writeRelation(*rel);
+        }
+    }
+
+    void visitSwap(const RamSwap& swap) override {
+        writeKind(NodeKind::Swap);
+        writeRelation(swap.getFirstRelation());
+        writeRelation(swap.getSecondRelation());
+    }
+
+    void visitExtend(const RamExtend& extend) override {
+        writeKind(NodeKind::Extend);
+        writeRelation(extend.getTargetRelation());
+        writeRelation(extend.getSourceRelation());
+    }
+
+    void visitSequence(const RamSequence& seq) override {
+        writeKind(NodeKind::Sequence);
+        writeNodes(seq.getStatements());
+    }
+
+    void visitLoop(const RamLoop& loop) override {
+        writeKind(NodeKind::Loop);
+        visit(loop.getBody());
+    }
+
+    void visitParallel(const RamParallel& parallel) override {
+        writeKind(NodeKind::Parallel);
+        writeNodes(parallel.getStatements());
+    }
+
+    void visitSchedule(const RamSchedule& schedule) override {
+        writeKind(NodeKind::Schedule);
+        writeInt(schedule.getJobs());
+        writeNodes(schedule.getStatements());
+        for (const auto& deps : schedule.getDependencies()) {
+            writeInt(deps.size());
+            for (size_t dep : deps) {
+                writeInt(dep);
+            }
+        }
+    }
+
+    void visitAdaptiveQuery(const RamAdaptiveQuery& query) override {
+        writeKind(NodeKind::AdaptiveQuery);
+        writeNodes(query.getStatements());
+    }
+
+    void visitExit(const RamExit& exit) override {
+        writeKind(NodeKind::Exit);
+        visit(exit.getCondition());
+    }
+
+    void visitLogTimer(const RamLogTimer& timer) override {
+        writeKind(NodeKind::LogTimer);
+        writeString(timer.getMessage());
+        visit(timer.getStatement());
+    }
+
+    void visitLogRelationTimer(const RamLogRelationTimer& timer) override {
+        writeKind(NodeKind::LogRelationTimer);
+        writeString(timer.getMessage());
+        writeRelation(timer.getRelation());
+        visit(timer.getStatement());
+    }
+
+    void visitDebugInfo(const RamDebugInfo& dbg) override {
+        writeKind(NodeKind::DebugInfo);
+        writeString(dbg.getMessage());
+        visit(dbg.getStatement());
+    }
+
+    void visitCheckpoint(const RamCheckpoint& checkpoint) override {
+        writeKind(NodeKind::Checkpoint);
+        writeInt(checkpoint.getStratum());
+        writeString(checkpoint.getFileName());
+        visit(checkpoint.getStatement());
+    }
+
+    void visitNode(const RamNode&) override {
+        throw std::runtime_error("RAM node cannot be cached");
+    }
+
+private:
+    std::ostream& out;
+
+    void writeMergeJoin(const RamMergeJoin& merge) {
+        writeRelation(merge.getRelation());
+        writeInt(merge.getTupleId());
+        writeInt(merge.getColumn());
+        writeString(merge.getProfileText());
+        visit(merge.getOperation());
+    }
+
+    void writeScan(const RamScan& scan) {
+        writeRelation(scan.getRelation());
+        writeInt(scan.getTupleId());
+        writeString(scan.getProfileText());
+        visit(scan.getOperation());
+    }
+
+    void writeScan(const RamIndexScan& scan) {
+        writeRelation(scan.getRelation());
+        writeInt(scan.getTupleId());
+        writeNodes(scan.getRangePattern());
+        writeString(scan.getProfileText());
+        visit(scan.getOperation());
+    }
+
+    void writeChoice(const RamChoice& choice) {
+        writeRelation(choice.getRelation());
+        writeInt(choice.getTupleId());
+        visit(choice.getCondition());
+        writeString(choice.getProfileText());
+        visit(choice.getOperation());
+    }
+
+    void writeChoice(const RamIndexChoice& choice) {
+        writeRelation(choice.getRelation());
+        writeInt(choice.getTupleId());
+        visit(choice.getCondition());
+        writeNodes(choice.getRangePattern());
+        writeString(choice.getProfileText());
+        visit(choice.getOperation());
+    }
+
+    void writeAggregate(const RamAggregate& aggregate) {
+        writeInt(static_cast<uint64_t>(aggregate.getFunction()));
+        writeRelation(aggregate.getRelation());
+        visit(aggregate.getExpression());
+        visit(aggregate.getCondition());
+        writeInt(aggregate.getTupleId());
+        visit(aggregate.getOperation());
+    }
+
+    void writeAggregate(const RamIndexAggregate& aggregate) {
+        writeInt(static_cast<uint64_t>(aggregate.getFunction()));
+        writeRelation(aggregate.getRelation());
+        visit(aggregate.getExpression());
+        visit(aggregate.getCondition());
+        writeNodes(aggregate.getRangePattern());
+        writeInt(aggregate.getTupleId());
+        visit(aggregate.getOperation());
+    }
+
+    void writeLoadStore(const RamAbstractLoadStore& io) {
+        writeRelation(io.getRelation());
+        writeInt(io.getIODirectives().size());
+        for (const IODirectives& directives : io.getIODirectives()) {
+            writeInt(directives.getDirectiveMap().size());
+            for (const auto& cur : directives.getDirectiveMap()) {
+                writeString(cur.first);
+                writeString(cur.second);
+            }
+        }
+    }
+};
+
+/**
+ * Reads the nodes of a RAM program written by a RamWriter; throws a runtime error for corrupt input
+ */
+class RamReader {
+public:
+    RamReader(const std::string& content, size_t offset) : content(content), offset(offset) {}
+
+    uint64_t readInt() {
+        uint64_t value;
+        if (content.size() - offset < sizeof(value)) {
+            throw std::runtime_error("truncated RAM program");
+        }
+        std::memcpy(&value, content.data() + offset, sizeof(value));
+        offset += sizeof(value);
+        return value;
+    }
+
+    std::string readString() {
+        const uint64_t length = readInt();
+        if (content.size() - offset < length) {
+            throw std::runtime_error("truncated RAM program");
+        }
+        std::string str = content.substr(offset, length);
+        offset += length;
+        return str;
+    }
+
+    /** Declare a relation, such that the nodes read later may refer to it */
+    void addRelation(const RamRelation* relation) {
+        relations[relation->getName()] = relation;
+    }
+
+    std::unique_ptr<RamRelationReference> readRelation() {
+        auto pos = relations.find(readString());
+        if (pos == relations.end()) {
+            throw std::runtime_error("undeclared RAM relation");
+        }
+        return std::make_unique<RamRelationReference>(pos->second);
+    }
+
+    std::unique_ptr<RamExpression> readExpression() {
+        const auto kind = readKind();
+        switch (kind) {
+            case NodeKind::TupleElement: {
+                const size_t ident = readInt();
+                return std::make_unique<RamTupleElement>(ident, readInt());
+            }
+            case NodeKind::SignedConstant:
+                return std::make_unique<RamSignedConstant>(readDomain());
+            case NodeKind::UnsignedConstant:
+                return std::make_unique<RamUnsignedConstant>(readDomain());
+            case NodeKind::FloatConstant:
+                return std::make_unique<RamFloatConstant>(readDomain());
+            case NodeKind::IntrinsicOperator: {
+                const auto op = static_cast<FunctorOp>(readInt());
+                return std::make_unique<RamIntrinsicOperator>(op, readExpressions());
+            }
+            case NodeKind::UserDefinedOperator: {
+                std::string name = readString();
+                std::vector<TypeAttribute> argsTypes(readInt());
+                for (TypeAttribute& type : argsTypes) {
+                    type = static_cast<TypeAttribute>(readInt());
+                }
+                const auto returnType = static_cast<TypeAttribute>(readInt());
+                const bool stateful = readInt() != 0;
+                return std::make_unique<RamUserDefinedOperator>(
+                        std::move(name), std::move(argsTypes), returnType, stateful, readExpressions());
+            }
+            case NodeKind::AutoIncrement:
+                return std::make_unique<RamAutoIncrement>();
+            case NodeKind::PackRecord:
+                return std::make_unique<RamPackRecord>(readExpressions());
+            case NodeKind::SubroutineArgument:
+                return std::make_unique<RamSubroutineArgument>(readInt());
+            case NodeKind::UndefValue:
+                return std::make_unique<RamUndefValue>();
+            default:
+                throw std::runtime_error("invalid RAM expression");
+        }
+    }
+
+    std::unique_ptr<RamCondition> readCondition() {
+        const auto kind = readKind();
+        switch (kind) {
+            case NodeKind::True:
+                return std::make_unique<RamTrue>();
+            case NodeKind::False:
+                return std::make_unique<RamFalse>();
+            case NodeKind::EmptinessCheck:
+                return std::make_unique<RamEmptinessCheck>(readRelation());
+            case NodeKind::ExistenceCheck:
+                return readExistenceCheck();
+            case NodeKind::ProvenanceExistenceCheck: {
+                auto rel = readRelation();
+                return std::make_unique<RamProvenanceExistenceCheck>(std::move(rel), readExpressions());
+            }
+            case NodeKind::Conjunction: {
+                auto lhs = readCondition();
+                return std::make_unique<RamConjunction>(std::move(lhs), readCondition());
+            }
+            case NodeKind::Negation:
+                return std::make_unique<RamNegation>(readCondition());
+            case NodeKind::Constraint: {
+                const auto op = static_cast<BinaryConstraintOp>(readInt());
+                auto lhs = readExpression();
+                return std::make_unique<RamConstraint>(op, std::move(lhs), readExpression());
+            }
+            default:
+                throw std::runtime_error("invalid RAM condition");
+        }
+    }
+
+    std::unique_ptr<RamOperation> readOperation() {
+        const auto kind = readKind();
+        switch (kind) {
+            case NodeKind::Filter:
+            case NodeKind::Break: {
+                auto cond = readCondition();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (kind == NodeKind::Filter) {
+                    return std::make_unique<RamFilter>(std::move(cond), std::move(nested), profileText);
+                }
+                return std::make_unique<RamBreak>(std::move(cond), std::move(nested), profileText);
+            }
+            case NodeKind::Project: {
+                auto rel = readRelation();
+                return std::make_unique<RamProject>(std::move(rel), readExpressions());
+            }
+            case NodeKind::SubroutineReturnValue:
+                return std::make_unique<RamSubroutineReturnValue>(readExpressions());
+            case NodeKind::UnpackRecord: {
+                const int ident = readInt();
+                auto expr = readExpression();
+                const size_t arity = readInt();
+                return std::make_unique<RamUnpackRecord>(readOperation(), ident, std::move(expr), arity);
+            }
+            case NodeKind::Scan:
+            case NodeKind::ParallelScan: {
+                auto rel = readRelation();
+                const int ident = readInt();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (kind == NodeKind::Scan) {
+                    return std::make_unique<RamScan>(std::move(rel), ident, std::move(nested), profileText);
+                }
+                return std::make_unique<RamParallelScan>(
+                        std::move(rel), ident, std::move(nested), profileText);
+            }
+            case NodeKind::MergeJoin:
+            case NodeKind::ParallelMergeJoin: {
+                auto rel = readRelation();
+                const int ident = readInt();
+                const size_t column = readInt();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (column >= rel->get()->getArity() ||
+                        !RamMergeJoin::isMergeable(ident, column, *nested)) {
+                    throw std::runtime_error("invalid RAM merge join");
+                }
+                if (kind == NodeKind::MergeJoin) {
+                    return std::make_unique<RamMergeJoin>(
+                            std::move(rel), ident, column, std::move(nested), profileText);
+                }
+                return std::make_unique<RamParallelMergeJoin>(
+                        std::move(rel), ident, column, std::move(nested), profileText);
+            }
+            case NodeKind::HashJoin:
+            case NodeKind::ParallelHashJoin: {
+                auto rel = readRelation();
+                const int ident = readInt();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (!RamHashJoin::isHashable(ident, *nested)) {
+                    throw std::runtime_error("invalid RAM hash join");
+                }
+                if (kind == NodeKind::HashJoin) {
+                    return std::make_unique<RamHashJoin>(
+                            std::move(rel), ident, std::move(nested), profileText);
+                }
+                return std::make_unique<RamParallelHashJoin>(
+                        std::move(rel), ident, std::move(nested), profileText);
+            }
+            case NodeKind::GroupAggregate:
+            case NodeKind::ParallelGroupAggregate: {
+                auto rel = readRelation();
+                const int ident = readInt();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (!RamGroupAggregate::isGroupable(ident, *nested)) {
+                    throw std::runtime_error("invalid RAM group aggregate");
+                }
+                if (kind == NodeKind::GroupAggregate) {
+                    return std::make_unique<RamGroupAggregate>(
+                            std::move(rel), ident, std::move(nested), profileText);
+                }
+                return std::make_unique<RamParallelGroupAggregate>(
+                        std::move(rel), ident, std::move(nested), profileText);
+            }
+            case NodeKind::IndexScan:
+            case NodeKind::ParallelIndexScan: {
+                auto rel = readRelation();
+                const int ident = readInt();
+                auto pattern = readExpressions();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (kind == NodeKind::IndexScan) {
+                    return std::make_unique<RamIndexScan>(
+                            std::move(rel), ident, std::move(pattern), std::move(nested), profileText);
+                }
+                return std::make_unique<RamParallelIndexScan>(
+                        std::move(rel), ident, std::move(pattern), std::move(nested), profileText);
+            }
+            case NodeKind::LeapfrogJoin: {
+                auto rel = readRelation();
+                const int ident = readInt();
+                auto pattern = readExpressions();
+                std::vector<std::unique_ptr<RamExistenceCheck>> intersections(readInt());
+                for (auto& cur : intersections) {
+                    if (readKind() != NodeKind::ExistenceCheck) {
+                        throw std::runtime_error("invalid RAM intersection");
+                    }
+                    cur = readExistenceCheck();
+                }
+                std::string profileText = readString();
+                return std::make_unique<RamLeapfrogJoin>(std::move(rel), ident, std::move(pattern),
+                        std::move(intersections), readOperation(), profileText);
+            }
+            case NodeKind::Choice:
+            case NodeKind::ParallelChoice: {
+                auto rel = readRelation();
+                const size_t ident = readInt();
+                auto cond = readCondition();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (kind == NodeKind::Choice) {
+                    return std::make_unique<RamChoice>(
+                            std::move(rel), ident, std::move(cond), std::move(nested), profileText);
+                }
+                return std::make_unique<RamParallelChoice>(
+                        std::move(rel), ident, std::move(cond), std::move(nested), profileText);
+            }
+            case NodeKind::IndexChoice:
+            case NodeKind::ParallelIndexChoice: {
+                auto rel = readRelation();
+                const int ident = readInt();
+                auto cond = readCondition();
+                auto pattern = readExpressions();
+                std::string profileText = readString();
+                auto nested = readOperation();
+                if (kind == NodeKind::IndexChoice) {
+                    return std::make_unique<RamIndexChoice>(std::move(rel), ident, std::move(cond),
+                            std::move(pattern), std::move(nested), profileText);
+                }
+                return std::make_unique<RamParallelIndexChoice>(std::move(rel), ident, std::move(cond),
+                        std::move(pattern), std::move(nested), profileText);
+            }
+            case NodeKind::Aggregate:
+            case NodeKind::ParallelAggregate: {
+                const auto fun = static_cast<AggregateFunction>(readInt());
+                auto rel = readRelation();
+                auto expr = readExpression();
+                auto cond = readCondition();
+                const int ident = readInt();
+                auto nested = readOperation();
+                if (kind == NodeKind::Aggregate) {
+                    return std::make_unique<RamAggregate>(
+                            std::move(nested), fun, std::move(rel), std::move(expr), std::move(cond), ident);
+                }
+                return std::make_unique<RamParallelAggregate>(
+                        std::move(nested), fun, std::move(rel), std::move(expr), std::move(cond), ident);
+            }
+            case NodeKind::IndexAggregate:
+            case NodeKind::ParallelIndexAggregate: {
+                const auto fun = static_cast<AggregateFunction>(readInt());
+                auto rel = readRelation();
+                auto expr = readExpression();
+                auto cond = readCondition();
+                auto pattern = readExpressions();
+                const int ident = readInt();
+                auto nested = readOperation();
+                if (kind == NodeKind::IndexAggregate) {
+                    return std::make_unique<RamIndexAggregate>(std::move(nested), fun, std::move(rel),
+                            std::move(expr), std::move(cond), std::move(pattern), ident);
+                }
+                return std::make_unique<RamParallelIndexAggregate>(std::move(nested), fun, std::move(rel),
+                        std::move(expr), std::move(cond), std::move(pattern), ident);
+            }
+            default:
+                throw std::runtime_error("invalid RAM operation");
+        }
+    }
+
+    std::unique_ptr<RamStatement> readStatement() {
+        const auto kind = readKind();
+        switch (kind) {
+            case NodeKind::Load:
+            case NodeKind::Store: {
+                auto rel = readRelation();
+                std::vector<IODirectives> ioDirectives;
+                for (uint64_t i = readInt(); i > 0; --i) {
+                    IODirectives directives;
+                    for (uint64_t j = readInt(); j > 0; --j) {
+                        std::string key = readString();
+                        directives.set(key, readString());
+                    }
+                    ioDirectives.push_back(std::move(directives));
+                }
+                if (kind == NodeKind::Load) {
+                    return std::make_unique<RamLoad>(std::move(rel), std::move(ioDirectives));
+                }
+                return std::make_unique<RamStore>(std::move(rel), std::move(ioDirectives));
+            }
+            case NodeKind::Query:
+                return std::make_unique<RamQuery>(readOperation());
+            case NodeKind::Clear:
+                return std::make_unique<RamClear>(readRelation());
+            case NodeKind::BuildIndex:
+            case NodeKind::DropIndex: {
+                auto rel = readRelation();
+                const SearchSignature search = readInt();
+                if (kind == NodeKind::BuildIndex) {
+                    return std::make_unique<RamBuildIndex>(std::move(rel), search);
+                }
+                return std::make_unique<RamDropIndex>(std::move(rel), search);
+            }
+            case NodeKind::LogSize:
+            case NodeKind::LogStatistics: {
+                auto rel = readRelation();
+                std::string message = readString();
+                if (kind == NodeKind::LogSize) {
+                    return std::make_unique<RamLogSize>(std::move(rel), message);
+                }
+                return std::make_unique<RamLogStatistics>(std::move(rel), message);
+            }
+            case NodeKind::LogMemory: {
+                const size_t stratum = readInt();
+                std::vector<std::unique_ptr<RamRelationReference>> relRefs(readInt());
+                for (auto& cur : relRefs) {
+                    cur = readRelation();
+                }
+                return std::make_unique<RamLogMemory>(stratum, std::move(relRefs));
+            }
+            case NodeKind::Swap: {
+                auto first = readRelation();
+                return std::make_unique<RamSwap>(std::move(first), readRelation());
+            }
+            case NodeKind::Extend: {
+                auto target = readRelation();
+                return std::make_unique<RamExtend>(std::move(target), readRelation());
+            }
+            case NodeKind::Sequence: {
+                auto seq = std::make_unique<RamSequence>();
+                for (uint64_t i = readInt(); i > 0; --i) {
+                    seq->add(readStatement());
+                }
+                return seq;
+            }
+            case NodeKind::Loop:
+                return std::make_unique<RamLoop>(readStatement());
+            case NodeKind::Parallel: {
+                auto parallel = std::make_unique<RamParallel>();
+                for (uint64_t i = readInt(); i > 0; --i) {
+                    parallel->add(readStatement());
+                }
+                return parallel;
+            }
+            case NodeKind::Schedule: {
+                auto schedule = std::make_unique<RamSchedule>(readInt());
+                std::vector<std::unique_ptr<RamStatement>> strata(readInt());
+                for (auto& stratum : strata) {
+                    stratum = readStatement();
+                }
+                for (auto& stratum : strata) {
+                    std::vector<size_t> deps(readInt());
+                    for (size_t& dep : deps) {
+                        dep = readInt();
+                        if (dep >= schedule->getStatements().size()) {
+                            throw std::runtime_error("invalid RAM schedule");
+                        }
+                    }
+                    schedule->add(std::move(stratum), std::move(deps));
+                }
+                return schedule;
+            }
+            case NodeKind::AdaptiveQuery: {
+                auto query = std::make_unique<RamAdaptiveQuery>();
+                for (uint64_t i = readInt(); i > 0; --i) {
+                    query->add(readStatement());
+                }
+                return query;
+            }
+            case NodeKind::Exit:
+                return std::make_unique<RamExit>(readCondition());
+            case NodeKind::LogTimer:
+            case NodeKind::DebugInfo: {
+                std::string message = readString();
+                auto stmt = readStatement();
+                if (kind == NodeKind::LogTimer) {
+                    return std::make_unique<RamLogTimer>(std::move(stmt), message);
+                }
+                return std::make_unique<RamDebugInfo>(std::move(stmt), message);
+            }
+            case NodeKind::LogRelationTimer: {
+                std::string message = readString();
+                auto rel = readRelation();
+                return std::make_unique<RamLogRelationTimer>(readStatement(), message, std::move(rel));
+            }
+            case NodeKind::Checkpoint: {
+                const size_t stratum = readInt();
+                std::string fileName = readString();
+                return std::make_unique<RamCheckpoint>(stratum, readStatement(), fileName);
+            }
+            default:
+                throw std::runtime_error("invalid RAM statement");
+        }
+    }
+
+    /** Check that the whole input has been read */
+    void finish() const {
+        if (offset != content.size()) {
+            throw std::runtime_error("trailing data after RAM program");
+        }
+    }
+
+private:
+    const std::string& content;
+    size_t offset;
+    std::map<std::string, const RamRelation*> relations;
+
+    NodeKind readKind() {
+        return static_cast<NodeKind>(readInt());
+    }
+
+    RamDomain readDomain() {
+        return static_cast<RamDomain>(static_cast<int64_t>(readInt()));
+    }
+
+    std::vector<std::unique_ptr<RamExpression>> readExpressions() {
+        std::vector<std::unique_ptr<RamExpression>> exprs(readInt());
+        for (auto& cur : exprs) {
+            cur = readExpression();
+        }
+        return exprs;
+    }
+
+    std::unique_ptr<RamExistenceCheck> readExistenceCheck() {
+        auto rel = readRelation();
+        return std::make_unique<RamExistenceCheck>(std::move(rel), readExpressions());
+    }
+};
+
+}  // namespace
+
+std::string RamProgramCache::getFileName(const std::string& directory, const std::string& code) {
+    // 64-bit FNV-1a hash of the strings, each terminated by a byte that cannot occur in them
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&](const std::string& str) {
+        for (unsigned char c : str) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        hash = (hash ^ 0xff) * 1099511628211ULL;
+    };
+
+    add(code);
+    for (const auto& cur : Global::config().data()) {
+        add(cur.first);
+        add(cur.second);
+    }
+    // the join orders and indexes depend on the contents of the profile, and the representations on
+    // the contents of the relation configuration
+    for (const std::string option : {"profile-use", "relation-config"}) {
+        if (Global::config().has(option)) {
+            std::ifstream file(Global::config().get(option), std::ios::in | std::ios::binary);
+            add(std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()));
+        }
+    }
+
+    std::stringstream name;
+    name << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".ram";
+    return name.str();
+}
+
+void RamProgramCache::store(const std::string& fileName, const RamProgram& program,
+        const SymbolTable& symbolTable, const std::string& warnings) {
+    const std::string tempName = fileName + ".tmp" + std::to_string(getpid());
+    std::ofstream file(tempName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open RAM program cache file " + tempName);
+    }
+    const auto header = RamProgramCacheHeader::create();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    RamWriter writer(file);
+    writer.writeInt(symbolTable.size());
+    for (size_t i = 0; i < symbolTable.size(); ++i) {
+        writer.writeString(symbolTable.unsafeResolve(i));
+    }
+    writer.writeInt(Global::config().data().size());
+    for (const auto& cur : Global::config().data()) {
+        writer.writeString(cur.first);
+        writer.writeString(cur.second);
+    }
+    writer.writeString(warnings);
+
+    writer.writeInt(program.getRelations().size());
+    for (const RamRelation* rel : program.getRelations()) {
+        writer.writeString(rel->getName());
+        writer.writeInt(rel->getArity());
+        writer.writeInt(rel->getAuxiliaryArity());
+        for (size_t i = 0; i < rel->getArity(); ++i) {
+            writer.writeString(rel->getAttributeNames()[i]);
+            writer.writeString(rel->getAttributeTypes()[i]);
+        }
+        writer.writeInt(static_cast<uint64_t>(rel->getRepresentation()));
+        writer.writeInt(rel->getBlockSize());
+        writer.writeInt(rel->getSizeHint());
+        writer.writeInt(rel->hasBloomFilter() ? 1 : 0);
+        writer.writeInt(rel->getChoiceDomain().size());
+        for (size_t column : rel->getChoiceDomain()) {
+            writer.writeInt(column);
+        }
+    }
+    writer.writeInt(program.getSubroutines().size());
+    for (const auto& sub : program.getSubroutines()) {
+        writer.writeString(sub.first);
+        writer(sub.second);
+    }
+    writer(program.getMain());
+
+    file.close();
+    if (!file) {
+        std::remove(tempName.c_str());
+        throw std::runtime_error("Cannot write RAM program cache file " + tempName);
+    }
+    if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+        std::remove(tempName.c_str());
+        throw std::runtime_error("Cannot replace RAM program cache file " + fileName);
+    }
+}
+
+std::unique_ptr<RamProgram> RamProgramCache::load(
+        const std::string& fileName, SymbolTable& symbolTable, std::string& warnings) {
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    RamProgramCacheHeader header;
+    if (content.size() < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, content.data(), sizeof(header));
+    if (!header.isValid()) {
+        return nullptr;
+    }
+
+    assert(symbolTable.size() == 0 && "symbols of a cached program must be restored into an empty table");
+
+    // the program is read completely before the symbols and the configuration are restored, such that
+    // a corrupt file leaves them unchanged
+    RamReader reader(content, sizeof(header));
+    try {
+        std::vector<std::string> symbols(reader.readInt());
+        for (std::string& symbol : symbols) {
+            symbol = reader.readString();
+        }
+        std::vector<std::pair<std::string, std::string>> config(reader.readInt());
+        for (auto& cur : config) {
+            cur.first = reader.readString();
+            cur.second = reader.readString();
+        }
+        std::string translationWarnings = reader.readString();
+
+        std::vector<std::unique_ptr<RamRelation>> relations(reader.readInt());
+        for (auto& rel : relations) {
+            std::string name = reader.readString();
+            const size_t arity = reader.readInt();
+            const size_t auxiliaryArity = reader.readInt();
+            std::vector<std::string> attributeNames;
+            std::vector<std::string> attributeTypes;
+            for (size_t i = 0; i < arity; ++i) {
+                attributeNames.push_back(reader.readString());
+                attributeTypes.push_back(reader.readString());
+            }
+            const auto representation = static_cast<RelationRepresentation>(reader.readInt());
+            const size_t blockSize = reader.readInt();
+            const size_t sizeHint = reader.readInt();
+            const bool bloomFilter = reader.readInt() != 0;
+            std::vector<size_t> choiceDomain(reader.readInt());
+            for (size_t& column : choiceDomain) {
+                column = reader.readInt();
+            }
+            rel = std::make_unique<RamRelation>(std::move(name), arity, auxiliaryArity,
+                    std::move(attributeNames), std::move(attributeTypes), representation, blockSize,
+                    sizeHint, bloomFilter, std::move(choiceDomain));
+            reader.addRelation(rel.get());
+        }
+        std::map<std::string, std::unique_ptr<RamStatement>> subroutines;
+        for (uint64_t i = reader.readInt(); i > 0; --i) {
+            std::string name = reader.readString();
+            subroutines[name] = reader.readStatement();
+        }
+        auto main = reader.readStatement();
+        reader.finish();
+
+        symbolTable.insert(symbols);
+        for (const auto& cur : config) {
+            Global::config().set(cur.first, cur.second);
+        }
+        warnings = std::move(translationWarnings);
+        return std::make_unique<RamProgram>(std::move(relations), std::move(main), std::move(subroutines));
+    } catch (std::runtime_error&) {
+        return nullptr;
+    }
+}
+
+}  // namespace souffle
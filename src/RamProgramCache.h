@@ -0,0 +1,99 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamProgramCache.h
+ *
+ * Persist translated RAM programs, such that the interpreter runs an
+ * unchanged program without parsing and optimising it again.
+ *
+ * A cached program is stored in a file named by a hash of the preprocessed
+ * source and of the configuration it was translated under. The file
+ * consists of
+ *   - a RamProgramCacheHeader,
+ *   - the symbols of the program in index order,
+ *   - the configuration after the translation, which includes the options
+ *     set by pragmas,
+ *   - the warnings reported by the translation,
+ *   - the relations, the subroutines and the main statement of the
+ *     program, each node given by its kind followed by its fields and
+ *     children.
+ *
+ * Integers are stored as uint64_t, and strings as their length followed
+ * by their characters.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamProgram.h"
+#include "RamTypes.h"
+#include "SymbolTable.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace souffle {
+
+struct RamProgramCacheHeader {
+    /** The magic string identifying cached RAM programs */
+    static constexpr char MAGIC[8] = {'S', 'O', 'U', 'F', 'F', 'L', 'E', 'R'};
+
+    /** The version of the file format; to be increased whenever a RAM node changes */
+    static constexpr uint32_t VERSION = 3;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t domainSize;
+
+    /** Create a header for the current format */
+    static RamProgramCacheHeader create() {
+        RamProgramCacheHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.domainSize = RAM_DOMAIN_SIZE;
+        return header;
+    }
+
+    /** Check whether this header describes a file readable by this build */
+    bool isValid() const {
+        return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && version == VERSION &&
+               domainSize == RAM_DOMAIN_SIZE;
+    }
+};
+
+class RamProgramCache {
+public:
+    /**
+     * Get the file caching the given preprocessed source in the given directory. The name depends on
+     * the source, the current configuration and the profile it uses, if any.
+     */
+    static std::string getFileName(const std::string& directory, const std::string& code);
+
+    /**
+     * Write a translated program with its symbols, the current configuration and the warnings of its
+     * translation to a cache file. The file is replaced atomically, hence concurrent runs read a
+     * complete program.
+     */
+    static void store(const std::string& fileName, const RamProgram& program, const SymbolTable& symbolTable,
+            const std::string& warnings);
+
+    /**
+     * Read a program from a cache file into the given empty symbol table, and restore the configuration
+     * it was translated under.
+     *
+     * @return The program, or a null pointer if the file does not exist, is of another format or is
+     * corrupt
+     */
+    static std::unique_ptr<RamProgram> load(
+            const std::string& fileName, SymbolTable& symbolTable, std::string& warnings);
+};
+
+}  // namespace souffle
@@ -33,16 +33,21 @@ class RamRelation : public RamNode {
 public:
     RamRelation(std::string name, size_t arity, size_t auxiliaryArity,
             std::vector<std::string> attributeNames, std::vector<std::string> attributeTypes,
-            RelationRepresentation representation)
+            RelationRepresentation representation, size_t blockSize = 0, size_t sizeHint = 0,
+            bool bloomFilter = false, std::vector<size_t> choiceDomain = {})
             : representation(representation), name(std::move(name)), arity(arity),
               auxiliaryArity(auxiliaryArity), attributeNames(std::move(attributeNames)),
-              attributeTypes(std::move(attributeTypes)) {
+              attributeTypes(std::move(attributeTypes)), blockSize(blockSize), sizeHint(sizeHint),
+              bloomFilter(bloomFilter), choiceDomain(std::move(choiceDomain)) {
         assert(this->attributeNames.size() == arity && "arity mismatch for attributes");
         assert(this->attributeTypes.size() == arity && "arity mismatch for types");
         for (std::size_t i = 0; i < arity; i++) {
             assert(!this->attributeNames[i].empty() && "no attribute name specified");
             assert(!this->attributeTypes[i].empty() && "no attribute type specified");
         }
+        for (size_t column : this->choiceDomain) {
+            assert(column < arity && "choice-domain column out of range");
+        }
     }
 
     /** @brief Get name */
@@ -70,6 +75,26 @@ public:
         return representation;
     }
 
+    /** @brief Get number of bytes of b-tree nodes requested for this relation, 0 if unspecified */
+    size_t getBlockSize() const {
+        return blockSize;
+    }
+
+    /** @brief Get expected number of tuples of this relation, e.g., from a profile, 0 if unknown */
+    size_t getSizeHint() const {
+        return sizeHint;
+    }
+
+    /** @brief Check whether lookups of complete tuples are filtered, e.g., since most of them miss */
+    bool hasBloomFilter() const {
+        return bloomFilter;
+    }
+
+    /** @brief Get the columns of which only the first tuple is kept, empty if unrestricted */
+    const std::vector<size_t>& getChoiceDomain() const {
+        return choiceDomain;
+    }
+
     /** @brief Is temporary relation (for semi-naive evaluation) */
     const bool isTemp() const {
         return name.at(0) == '@';
@@ -103,13 +128,27 @@ public:
             }
             out << ")";
             out << " " << representation;
+            if (blockSize != 0) {
+                out << " blocksize(" << blockSize << ")";
+            }
+            if (bloomFilter) {
+                out << " bloomfilter";
+            }
+            if (!choiceDomain.empty()) {
+                out << " choice-domain(";
+                for (size_t i = 0; i < choiceDomain.size(); i++) {
+                    out << (i == 0 ? "" : ",") << attributeNames[choiceDomain[i]];
+                }
+                out << ")";
+            }
         } else {
             out << " nullary";
         }
     }
 
     RamRelation* clone() const override {
-        return new RamRelation(name, arity, auxiliaryArity, attributeNames, attributeTypes, representation);
+        return new RamRelation(name, arity, auxiliaryArity, attributeNames, attributeTypes, representation,
+                blockSize, sizeHint, bloomFilter, choiceDomain);
     }
 
 protected:
@@ -117,7 +156,9 @@ protected:
         assert(nullptr != dynamic_cast<const RamRelation*>(&node));
         const auto& other = static_cast<const RamRelation&>(node);
         return name == other.name && arity == other.arity && attributeNames == other.attributeNames &&
-               attributeTypes == other.attributeTypes && representation == other.representation;
+               attributeTypes == other.attributeTypes && representation == other.representation &&
+               blockSize == other.blockSize && sizeHint == other.sizeHint &&
+               bloomFilter == other.bloomFilter && choiceDomain == other.choiceDomain;
     }
 
 protected:
@@ -138,6 +179,18 @@ protected:
 
     /** Type of attributes */
     const std::vector<std::string> attributeTypes;
+
+    /** Number of bytes of b-tree nodes requested by a qualifier, 0 if unspecified */
+    const size_t blockSize;
+
+    /** Expected number of tuples, 0 if unknown */
+    const size_t sizeHint;
+
+    /** Whether a bloom filter rules out lookups of complete tuples not contained */
+    const bool bloomFilter;
+
+    /** Columns functionally determining the others, inserts of a known key being rejected */
+    const std::vector<size_t> choiceDomain;
 };
 
 /**
@@ -22,6 +22,7 @@
 #include "RamNode.h"
 #include "RamOperation.h"
 #include "RamRelation.h"
+#include "RamTypes.h"
 #include "Util.h"
 
 #include <algorithm>
@@ -213,6 +214,122 @@ public:
     }
 };
 
+/**
+ * @class RamFreeze
+ * @brief Pack the indexes of a relation which is only read anymore
+ *
+ * The tuples of the relation are retained, while its b-tree indexes are
+ * rebuilt from full nodes which are allocated adjacently.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * FREEZE A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamFreeze : public RamRelationStatement {
+public:
+    RamFreeze(std::unique_ptr<RamRelationReference> relRef) : RamRelationStatement(std::move(relRef)) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "FREEZE " << getRelation().getName() << std::endl;
+    }
+
+    RamFreeze* clone() const override {
+        return new RamFreeze(std::unique_ptr<RamRelationReference>(relationRef->clone()));
+    }
+};
+
+/**
+ * @class RamAbstractIndexStatement
+ * @brief Abstract class for statements on a secondary index of a relation
+ *
+ * The index is identified by a search signature it serves.
+ */
+class RamAbstractIndexStatement : public RamRelationStatement {
+public:
+    RamAbstractIndexStatement(std::unique_ptr<RamRelationReference> relRef, SearchSignature search)
+            : RamRelationStatement(std::move(relRef)), search(search) {}
+
+    /** @brief Get a search signature served by the index */
+    SearchSignature getSearchSignature() const {
+        return search;
+    }
+
+protected:
+    /** Print the statement with the columns of the search */
+    void printIndex(std::ostream& os, int tabpos, const std::string& keyword) const {
+        std::vector<size_t> columns;
+        for (size_t i = 0; i < getRelation().getArity(); i++) {
+            if (((search >> i) & 1) != 0) {
+                columns.push_back(i);
+            }
+        }
+        os << times(" ", tabpos) << keyword << " " << getRelation().getName() << " ON (" << join(columns)
+           << ")" << std::endl;
+    }
+
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamAbstractIndexStatement&>(node);
+        return RamRelationStatement::equal(other) && search == other.search;
+    }
+
+    /** Search signature served by the index */
+    const SearchSignature search;
+};
+
+/**
+ * @class RamBuildIndex
+ * @brief Build a secondary index of a relation
+ *
+ * The index is bulk-built from the tuples of the relation and maintained
+ * by subsequent insertions until it is dropped. Building an index which
+ * is maintained already has no effect.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * BUILD_INDEX A ON (0,2)
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamBuildIndex : public RamAbstractIndexStatement {
+public:
+    RamBuildIndex(std::unique_ptr<RamRelationReference> relRef, SearchSignature search)
+            : RamAbstractIndexStatement(std::move(relRef), search) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        printIndex(os, tabpos, "BUILD_INDEX");
+    }
+
+    RamBuildIndex* clone() const override {
+        return new RamBuildIndex(std::unique_ptr<RamRelationReference>(relationRef->clone()), search);
+    }
+};
+
+/**
+ * @class RamDropIndex
+ * @brief Drop a secondary index of a relation
+ *
+ * The content of the index is discarded, and insertions no longer
+ * maintain it until it is built again.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * DROP_INDEX A ON (0,2)
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamDropIndex : public RamAbstractIndexStatement {
+public:
+    RamDropIndex(std::unique_ptr<RamRelationReference> relRef, SearchSignature search)
+            : RamAbstractIndexStatement(std::move(relRef), search) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        printIndex(os, tabpos, "DROP_INDEX");
+    }
+
+    RamDropIndex* clone() const override {
+        return new RamDropIndex(std::unique_ptr<RamRelationReference>(relationRef->clone()), search);
+    }
+};
+
 /**
  * @class RamBinRelationStatement
  * @brief Abstract class for a binary relation
@@ -272,6 +389,9 @@ protected:
  * @class RamExtend
  * @brief Extend equivalence relation.
  *
+ * For subsumptive relations, the tuples of the source which are subsumed
+ * by the target are discarded instead.
+ *
  * The following example merges A into B:
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * EXTEND B WITH A
@@ -527,6 +647,166 @@ protected:
     }
 };
 
+/**
+ * @class RamSchedule
+ * @brief Strata annotated with the strata they depend on
+ *
+ * Each stratum is evaluated as soon as all strata it depends on have
+ * completed, so that independent strata are evaluated concurrently. A
+ * stratum may only depend on preceding strata, i.e., evaluating the strata
+ * in order is a valid schedule. Each stratum uses at most the given number
+ * of threads for its parallel operations; zero divides the threads evenly.
+ * Schedules nest, e.g., the relations of a recursive stratum may form the
+ * independent strata of a schedule within its fixpoint loop, which share the
+ * threads of the enclosing stratum.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * SCHEDULE (JOBS 0)
+ *  STRATUM 0
+ *   ...
+ *  STRATUM 1 AFTER 0
+ *   ...
+ * END SCHEDULE
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamSchedule : public RamListStatement {
+public:
+    RamSchedule(size_t jobs) : RamListStatement(), jobs(jobs) {}
+
+    /** @brief Add a stratum depending on the given preceding strata */
+    void add(std::unique_ptr<RamStatement> stmt, std::vector<size_t> deps) {
+        assert(stmt && "stratum is a null-pointer");
+        assert(std::all_of(deps.begin(), deps.end(), [&](size_t dep) { return dep < statements.size(); }) &&
+                "stratum depends on a subsequent stratum");
+        statements.push_back(std::move(stmt));
+        dependencies.push_back(std::move(deps));
+    }
+
+    /** @brief Get the strata each stratum depends on */
+    const std::vector<std::vector<size_t>>& getDependencies() const {
+        return dependencies;
+    }
+
+    /** @brief Get the maximal number of threads of a stratum */
+    size_t getJobs() const {
+        return jobs;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "SCHEDULE (JOBS " << jobs << ")" << std::endl;
+        for (size_t i = 0; i < statements.size(); ++i) {
+            os << times(" ", tabpos + 1) << "STRATUM " << i;
+            if (!dependencies[i].empty()) {
+                os << " AFTER " << join(dependencies[i], ", ");
+            }
+            os << std::endl;
+            statements[i]->print(os, tabpos + 2);
+        }
+        os << times(" ", tabpos) << "END SCHEDULE" << std::endl;
+    }
+
+    RamSchedule* clone() const override {
+        auto* res = new RamSchedule(jobs);
+        for (size_t i = 0; i < statements.size(); ++i) {
+            res->add(std::unique_ptr<RamStatement>(statements[i]->clone()), dependencies[i]);
+        }
+        return res;
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamSchedule&>(node);
+        return RamListStatement::equal(node) && dependencies == other.dependencies && jobs == other.jobs;
+    }
+
+    /** strata each stratum depends on */
+    std::vector<std::vector<size_t>> dependencies;
+
+    /** maximal number of threads of a stratum, zero for an even share */
+    const size_t jobs;
+};
+
+/**
+ * @class RamAdaptiveQuery
+ * @brief Alternative queries computing the same tuples in different nested-loop orders
+ *
+ * Each execution runs the alternative of the least estimated cost for the
+ * current relation sizes. The cost of an alternative is the sum of the
+ * estimated numbers of bindings of its loops, where a loop over a relation
+ * of n tuples with k of its m attributes unbound yields n^(k/m) tuples per
+ * outer binding.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * ADAPTIVE
+ *  QUERY
+ *   ...
+ *  QUERY
+ *   ...
+ * END ADAPTIVE
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamAdaptiveQuery : public RamListStatement {
+public:
+    /** A loop searching a relation, with the number of attributes not bound by the outer loops */
+    struct Level {
+        const RamRelation* relation;
+        size_t freeAttributes;
+    };
+
+    RamAdaptiveQuery() : RamListStatement() {}
+
+    /** @brief Get the loops of an alternative in nesting order */
+    static std::vector<Level> getLevels(const RamStatement& alternative) {
+        std::vector<Level> levels;
+        const auto* query = dynamic_cast<const RamQuery*>(&alternative);
+        if (query == nullptr) {
+            return levels;
+        }
+        const RamOperation* op = &query->getOperation();
+        while (const auto* nested = dynamic_cast<const RamNestedOperation*>(op)) {
+            if (const auto* search = dynamic_cast<const RamRelationOperation*>(op)) {
+                size_t free = search->getRelation().getArity();
+                if (dynamic_cast<const RamAbstractChoice*>(op) != nullptr ||
+                        dynamic_cast<const RamAbstractAggregate*>(op) != nullptr) {
+                    // choices and aggregates yield a single binding
+                    free = 0;
+                } else if (const auto* indexed = dynamic_cast<const RamIndexOperation*>(op)) {
+                    const auto pattern = indexed->getRangePattern();
+                    free = std::count_if(pattern.begin(), pattern.end(), [](const RamExpression* value) {
+                        return dynamic_cast<const RamUndefValue*>(value) != nullptr;
+                    });
+                }
+                levels.push_back({&search->getRelation(), free});
+            }
+            op = &nested->getOperation();
+        }
+        return levels;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "ADAPTIVE" << std::endl;
+        for (auto const& stmt : statements) {
+            stmt->print(os, tabpos + 1);
+        }
+        os << times(" ", tabpos) << "END ADAPTIVE" << std::endl;
+    }
+
+    RamAdaptiveQuery* clone() const override {
+        auto* res = new RamAdaptiveQuery();
+        for (auto& cur : statements) {
+            res->add(std::unique_ptr<RamStatement>(cur->clone()));
+        }
+        return res;
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        return RamListStatement::equal(node);
+    }
+};
+
 /**
  * @class RamLoop
  * @brief Execute statement until statement terminates loop via an exit statement
@@ -822,6 +1102,80 @@ protected:
     }
 };
 
+/**
+ * @class RamCheckpoint
+ * @brief Stratum recorded in a checkpoint file
+ *
+ * Evaluates the stratum and writes the state of the program, including
+ * the number of completed strata, to the checkpoint file. The first
+ * stratum restores the state of an existing checkpoint file, and the
+ * strata it records as completed are not evaluated again.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * BEGIN_CHECKPOINT 0 "state.ckpt"
+ *   ...
+ * END_CHECKPOINT
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamCheckpoint : public RamStatement {
+public:
+    RamCheckpoint(size_t stratum, std::unique_ptr<RamStatement> stmt, std::string fileName)
+            : stratum(stratum), statement(std::move(stmt)), fileName(std::move(fileName)) {
+        assert(statement && "checkpointed statement is a nullptr");
+    }
+
+    /** @brief Get the index of the stratum */
+    size_t getStratum() const {
+        return stratum;
+    }
+
+    /** @brief Get the statement of the stratum */
+    const RamStatement& getStatement() const {
+        return *statement;
+    }
+
+    /** @brief Get the name of the checkpoint file */
+    const std::string& getFileName() const {
+        return fileName;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "BEGIN_CHECKPOINT " << stratum << " \"" << stringify(fileName) << "\""
+           << std::endl;
+        statement->print(os, tabpos + 1);
+        os << times(" ", tabpos) << "END_CHECKPOINT" << std::endl;
+    }
+
+    std::vector<const RamNode*> getChildNodes() const override {
+        return {statement.get()};
+    }
+
+    RamCheckpoint* clone() const override {
+        return new RamCheckpoint(stratum, std::unique_ptr<RamStatement>(statement->clone()), fileName);
+    }
+
+    void apply(const RamNodeMapper& map) override {
+        statement = map(std::move(statement));
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamCheckpoint&>(node);
+        return stratum == other.stratum && getStatement() == other.getStatement() &&
+               fileName == other.fileName;
+    }
+
+    /** index of the stratum */
+    const size_t stratum;
+
+    /** statement of the stratum */
+    std::unique_ptr<RamStatement> statement;
+
+    /** name of the checkpoint file */
+    const std::string fileName;
+};
+
 /**
  * @class RamLogSize
  * @brief Log relation size and a logging message.
@@ -858,4 +1212,119 @@ protected:
     std::string message;
 };
 
+/**
+ * @class RamLogStatistics
+ * @brief Log the size of a relation and the estimated number of distinct values of
+ * its attributes
+ */
+class RamLogStatistics : public RamRelationStatement {
+public:
+    RamLogStatistics(std::unique_ptr<RamRelationReference> relRef, std::string message)
+            : RamRelationStatement(std::move(relRef)), message(std::move(message)) {}
+
+    /** @brief Get logging message */
+    const std::string& getMessage() const {
+        return message;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "LOGSTATISTICS " << getRelation().getName();
+        os << " TEXT "
+           << "\"" << stringify(message) << "\"";
+        os << std::endl;
+    }
+
+    RamLogStatistics* clone() const override {
+        return new RamLogStatistics(std::unique_ptr<RamRelationReference>(relationRef->clone()), message);
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamLogStatistics&>(node);
+        return RamRelationStatement::equal(other) && getMessage() == other.getMessage();
+    }
+
+protected:
+    /** logging message */
+    std::string message;
+};
+
+/**
+ * @class RamLogMemory
+ * @brief Log the memory occupied by the indexes of relations, and by the symbol and
+ * record tables, at the end of a stratum
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * LOGMEMORY 3 (A, B)
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamLogMemory : public RamStatement {
+public:
+    RamLogMemory(size_t stratum, std::vector<std::unique_ptr<RamRelationReference>> relRefs)
+            : stratum(stratum), relationRefs(std::move(relRefs)) {
+        for (const auto& relRef : relationRefs) {
+            assert(relRef != nullptr && "Relation reference is a null-pointer");
+        }
+    }
+
+    /** @brief Get the index of the stratum */
+    size_t getStratum() const {
+        return stratum;
+    }
+
+    /** @brief Get the logged relations */
+    std::vector<const RamRelation*> getRelations() const {
+        std::vector<const RamRelation*> res;
+        for (const auto& relRef : relationRefs) {
+            res.push_back(relRef->get());
+        }
+        return res;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "LOGMEMORY " << stratum << " ("
+           << join(relationRefs, ", ",
+                      [](std::ostream& out, const std::unique_ptr<RamRelationReference>& ref) {
+                          out << ref->get()->getName();
+                      })
+           << ")" << std::endl;
+    }
+
+    std::vector<const RamNode*> getChildNodes() const override {
+        std::vector<const RamNode*> res;
+        for (const auto& relRef : relationRefs) {
+            res.push_back(relRef.get());
+        }
+        return res;
+    }
+
+    RamLogMemory* clone() const override {
+        std::vector<std::unique_ptr<RamRelationReference>> refs;
+        for (const auto& relRef : relationRefs) {
+            refs.emplace_back(relRef->clone());
+        }
+        return new RamLogMemory(stratum, std::move(refs));
+    }
+
+    void apply(const RamNodeMapper& map) override {
+        for (auto& relRef : relationRefs) {
+            relRef = map(std::move(relRef));
+        }
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamLogMemory&>(node);
+        return stratum == other.stratum && equal_targets(relationRefs, other.relationRefs);
+    }
+
+protected:
+    /** index of the stratum */
+    size_t stratum;
+
+    /** references of the logged relations */
+    std::vector<std::unique_ptr<RamRelationReference>> relationRefs;
+};
+
 }  // end of namespace souffle
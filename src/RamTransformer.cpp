@@ -16,6 +16,7 @@
 
 #include "RamTransformer.h"
 #include "DebugReport.h"
+#include "PhaseTimes.h"
 #include "RamTranslationUnit.h"
 
 #include <algorithm>
@@ -27,13 +28,20 @@ bool RamTransformer::apply(RamTranslationUnit& translationUnit) {
     std::set<const RamAnalysis*> beforeInvocation = translationUnit.getAliveAnalyses();
 
     // invoke the transformation
+    const auto start = PhaseTimes::clock::now();
     bool changed = transform(translationUnit);
+    if (nullptr == dynamic_cast<RamMetaTransformer*>(this)) {
+        PhaseTimes::instance().record("ram-transform", getName(), start, changed);
+    }
 
     // take snapshot of alive analyses after invocation
     std::set<const RamAnalysis*> afterInvocation = translationUnit.getAliveAnalyses();
 
+    // the sections of the debug report are only generated if requested
+    const bool report = !Global::config().get("debug-report").empty() && DebugReport::hasSection(getName());
+
     // print newly invoked analyses (not for meta transformers)
-    if (nullptr == dynamic_cast<RamMetaTransformer*>(this)) {
+    if (report && nullptr == dynamic_cast<RamMetaTransformer*>(this)) {
         for (const RamAnalysis* analysis : afterInvocation) {
             if (0 == beforeInvocation.count(analysis)) {
                 std::stringstream ramAnalysisStr;
@@ -48,12 +56,13 @@ bool RamTransformer::apply(RamTranslationUnit& translationUnit) {
 
     if (changed) {
         translationUnit.invalidateAnalyses();
+    }
+    if (changed && report) {
         std::stringstream ramProgStr;
         ramProgStr << translationUnit.getProgram();
         translationUnit.getDebugReport().addSection(
                 getName(), "RAM Program after " + getName(), ramProgStr.str());
-
-    } else {
+    } else if (report) {
         translationUnit.getDebugReport().addSection(
                 getName(), "After " + getName() + " " + " (unchanged)", "");
     }
@@ -16,6 +16,7 @@
 
 #include "RamTransforms.h"
 #include "BinaryConstraintOps.h"
+#include "Global.h"
 #include "RamComplexityAnalysis.h"
 #include "RamCondition.h"
 #include "RamExpression.h"
@@ -27,8 +28,17 @@
 #include "RamTypes.h"
 #include "RamUtils.h"
 #include "RamVisitor.h"
+#include "RelationRepresentation.h"
+#include "profile/ProgramRun.h"
+#include "profile/Reader.h"
+#include "profile/Relation.h"
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
 #include <list>
+#include <map>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -67,6 +77,239 @@ bool ExpandFilterTransformer::expandFilters(RamProgram& program) {
     return changed;
 }
 
+std::unique_ptr<RamExpression> FoldConstantsTransformer::foldFunctor(const RamIntrinsicOperator& op) {
+    std::vector<RamDomain> args;
+    for (const RamExpression* arg : op.getArguments()) {
+        const auto* constant = dynamic_cast<const RamConstant*>(arg);
+        if (constant == nullptr) {
+            return nullptr;
+        }
+        args.push_back(constant->getConstant());
+    }
+    auto i = [&](size_t k) { return args[k]; };
+    auto u = [&](size_t k) { return ramBitCast<RamUnsigned>(args[k]); };
+    auto f = [&](size_t k) { return ramBitCast<RamFloat>(args[k]); };
+    // signed arithmetic wraps around at runtime, hence it is evaluated on unsigned values
+    auto wrap = [](RamUnsigned value) { return ramBitCast<RamSigned>(value); };
+    // minimum and maximum are n-ary
+    auto extremum = [&](auto get, auto select) {
+        auto result = get(0);
+        for (size_t k = 1; k < args.size(); ++k) {
+            result = select(result, get(k));
+        }
+        return ramBitCast(result);
+    };
+    auto lessThan = [](auto a, auto b) { return std::min(a, b); };
+    auto greaterThan = [](auto a, auto b) { return std::max(a, b); };
+    const bool overflows = args.size() == 2 && i(0) == std::numeric_limits<RamSigned>::min() && i(1) == -1;
+
+    RamDomain result;
+    switch (op.getOperator()) {
+        case FunctorOp::NEG: result = wrap(RamUnsigned(0) - u(0)); break;
+        case FunctorOp::FNEG: result = ramBitCast(-f(0)); break;
+        case FunctorOp::BNOT: result = ~i(0); break;
+        case FunctorOp::UBNOT: result = ramBitCast(static_cast<RamUnsigned>(~u(0))); break;
+        case FunctorOp::LNOT: result = !i(0); break;
+        case FunctorOp::ULNOT: result = ramBitCast(static_cast<RamUnsigned>(!u(0))); break;
+        case FunctorOp::ITOU: result = ramBitCast(static_cast<RamUnsigned>(i(0))); break;
+        case FunctorOp::UTOI: result = static_cast<RamSigned>(u(0)); break;
+        case FunctorOp::ITOF: result = ramBitCast(static_cast<RamFloat>(i(0))); break;
+        case FunctorOp::UTOF: result = ramBitCast(static_cast<RamFloat>(u(0))); break;
+        case FunctorOp::ADD: result = wrap(u(0) + u(1)); break;
+        case FunctorOp::SUB: result = wrap(u(0) - u(1)); break;
+        case FunctorOp::MUL: result = wrap(u(0) * u(1)); break;
+        case FunctorOp::DIV:
+            if (i(1) == 0 || overflows) {
+                return nullptr;
+            }
+            result = i(0) / i(1);
+            break;
+        case FunctorOp::MOD:
+            if (i(1) == 0 || overflows) {
+                return nullptr;
+            }
+            result = i(0) % i(1);
+            break;
+        case FunctorOp::BAND: result = i(0) & i(1); break;
+        case FunctorOp::BOR: result = i(0) | i(1); break;
+        case FunctorOp::BXOR: result = i(0) ^ i(1); break;
+        case FunctorOp::LAND: result = i(0) && i(1); break;
+        case FunctorOp::LOR: result = i(0) || i(1); break;
+        case FunctorOp::UADD: result = ramBitCast(static_cast<RamUnsigned>(u(0) + u(1))); break;
+        case FunctorOp::USUB: result = ramBitCast(static_cast<RamUnsigned>(u(0) - u(1))); break;
+        case FunctorOp::UMUL: result = ramBitCast(static_cast<RamUnsigned>(u(0) * u(1))); break;
+        case FunctorOp::UDIV:
+            if (u(1) == 0) {
+                return nullptr;
+            }
+            result = ramBitCast(static_cast<RamUnsigned>(u(0) / u(1)));
+            break;
+        case FunctorOp::UMOD:
+            if (u(1) == 0) {
+                return nullptr;
+            }
+            result = ramBitCast(static_cast<RamUnsigned>(u(0) % u(1)));
+            break;
+        case FunctorOp::UBAND: result = ramBitCast(static_cast<RamUnsigned>(u(0) & u(1))); break;
+        case FunctorOp::UBOR: result = ramBitCast(static_cast<RamUnsigned>(u(0) | u(1))); break;
+        case FunctorOp::UBXOR: result = ramBitCast(static_cast<RamUnsigned>(u(0) ^ u(1))); break;
+        case FunctorOp::ULAND: result = ramBitCast(static_cast<RamUnsigned>(u(0) && u(1))); break;
+        case FunctorOp::ULOR: result = ramBitCast(static_cast<RamUnsigned>(u(0) || u(1))); break;
+        case FunctorOp::FADD: result = ramBitCast(static_cast<RamFloat>(f(0) + f(1))); break;
+        case FunctorOp::FSUB: result = ramBitCast(static_cast<RamFloat>(f(0) - f(1))); break;
+        case FunctorOp::FMUL: result = ramBitCast(static_cast<RamFloat>(f(0) * f(1))); break;
+        case FunctorOp::FDIV: result = ramBitCast(static_cast<RamFloat>(f(0) / f(1))); break;
+        case FunctorOp::MAX: result = extremum(i, greaterThan); break;
+        case FunctorOp::MIN: result = extremum(i, lessThan); break;
+        case FunctorOp::UMAX: result = extremum(u, greaterThan); break;
+        case FunctorOp::UMIN: result = extremum(u, lessThan); break;
+        case FunctorOp::FMAX: result = extremum(f, greaterThan); break;
+        case FunctorOp::FMIN: result = extremum(f, lessThan); break;
+        // exponentiation, float conversions and functors on symbols are evaluated at runtime
+        default:
+            return nullptr;
+    }
+
+    switch (functorReturnType(op.getOperator())) {
+        case TypeAttribute::Signed: return std::make_unique<RamSignedConstant>(result);
+        case TypeAttribute::Unsigned: return std::make_unique<RamUnsignedConstant>(result);
+        case TypeAttribute::Float: return std::make_unique<RamFloatConstant>(result);
+        default:
+            return nullptr;
+    }
+}
+
+std::unique_ptr<RamCondition> FoldConstantsTransformer::foldConstraint(const RamConstraint& constraint) {
+    const auto* lhs = dynamic_cast<const RamConstant*>(&constraint.getLHS());
+    const auto* rhs = dynamic_cast<const RamConstant*>(&constraint.getRHS());
+    const BinaryConstraintOp op = constraint.getOperator();
+    if (lhs == nullptr || rhs == nullptr || !isNumericBinaryConstraintOp(op)) {
+        return nullptr;
+    }
+    const RamDomain left = lhs->getConstant();
+    const RamDomain right = rhs->getConstant();
+    const auto lu = ramBitCast<RamUnsigned>(left);
+    const auto ru = ramBitCast<RamUnsigned>(right);
+    const auto lf = ramBitCast<RamFloat>(left);
+    const auto rf = ramBitCast<RamFloat>(right);
+
+    bool holds;
+    switch (op) {
+        case BinaryConstraintOp::EQ: holds = left == right; break;
+        case BinaryConstraintOp::NE: holds = left != right; break;
+        case BinaryConstraintOp::LT: holds = left < right; break;
+        case BinaryConstraintOp::ULT: holds = lu < ru; break;
+        case BinaryConstraintOp::FLT: holds = lf < rf; break;
+        case BinaryConstraintOp::LE: holds = left <= right; break;
+        case BinaryConstraintOp::ULE: holds = lu <= ru; break;
+        case BinaryConstraintOp::FLE: holds = lf <= rf; break;
+        case BinaryConstraintOp::GT: holds = left > right; break;
+        case BinaryConstraintOp::UGT: holds = lu > ru; break;
+        case BinaryConstraintOp::FGT: holds = lf > rf; break;
+        case BinaryConstraintOp::GE: holds = left >= right; break;
+        case BinaryConstraintOp::UGE: holds = lu >= ru; break;
+        case BinaryConstraintOp::FGE: holds = lf >= rf; break;
+        default:
+            return nullptr;
+    }
+    if (holds) {
+        return std::make_unique<RamTrue>();
+    }
+    return std::make_unique<RamFalse>();
+}
+
+bool FoldConstantsTransformer::foldConstants(RamProgram& program) {
+    bool changed = false;
+    std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> folder =
+            [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+        // tuple elements bound by the range pattern of an index search are the pattern's constants
+        if (auto* indexOp = dynamic_cast<RamIndexOperation*>(node.get())) {
+            if (nullptr != dynamic_cast<RamIndexScan*>(indexOp) ||
+                    nullptr != dynamic_cast<RamIndexChoice*>(indexOp)) {
+                const int identifier = indexOp->getTupleId();
+                const std::vector<RamExpression*> pattern = indexOp->getRangePattern();
+                std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> binder =
+                        [&](std::unique_ptr<RamNode> expr) -> std::unique_ptr<RamNode> {
+                    const auto* element = dynamic_cast<RamTupleElement*>(expr.get());
+                    if (element != nullptr && element->getTupleId() == identifier) {
+                        const RamExpression* value = pattern[element->getElement()];
+                        if (nullptr != dynamic_cast<const RamConstant*>(value)) {
+                            changed = true;
+                            return std::unique_ptr<RamNode>(value->clone());
+                        }
+                    }
+                    expr->apply(makeLambdaRamMapper(binder));
+                    return expr;
+                };
+                indexOp->apply(makeLambdaRamMapper(binder));
+            }
+        }
+
+        node->apply(makeLambdaRamMapper(folder));
+
+        if (const auto* op = dynamic_cast<RamIntrinsicOperator*>(node.get())) {
+            if (auto value = foldFunctor(*op)) {
+                changed = true;
+                return value;
+            }
+        } else if (const auto* constraint = dynamic_cast<RamConstraint*>(node.get())) {
+            if (auto condition = foldConstraint(*constraint)) {
+                changed = true;
+                return condition;
+            }
+        } else if (const auto* conj = dynamic_cast<RamConjunction*>(node.get())) {
+            const RamCondition& lhs = conj->getLHS();
+            const RamCondition& rhs = conj->getRHS();
+            if (isRamFalse(&lhs) || isRamFalse(&rhs)) {
+                changed = true;
+                return std::make_unique<RamFalse>();
+            }
+            if (isRamTrue(&lhs)) {
+                changed = true;
+                return std::unique_ptr<RamNode>(rhs.clone());
+            }
+            if (isRamTrue(&rhs)) {
+                changed = true;
+                return std::unique_ptr<RamNode>(lhs.clone());
+            }
+        } else if (const auto* neg = dynamic_cast<RamNegation*>(node.get())) {
+            if (isRamTrue(&neg->getOperand())) {
+                changed = true;
+                return std::make_unique<RamFalse>();
+            }
+            if (isRamFalse(&neg->getOperand())) {
+                changed = true;
+                return std::make_unique<RamTrue>();
+            }
+        } else if (const auto* filter = dynamic_cast<RamFilter*>(node.get())) {
+            // profiled filters are kept for their frequency counts
+            if (isRamTrue(&filter->getCondition()) && filter->getProfileText().empty()) {
+                changed = true;
+                return std::unique_ptr<RamNode>(filter->getOperation().clone());
+            }
+        } else if (const auto* breakOp = dynamic_cast<RamBreak*>(node.get())) {
+            if (isRamFalse(&breakOp->getCondition()) && breakOp->getProfileText().empty()) {
+                changed = true;
+                return std::unique_ptr<RamNode>(breakOp->getOperation().clone());
+            }
+        } else if (const auto* query = dynamic_cast<RamQuery*>(node.get())) {
+            // operations of a query are nested in a chain, hence no tuple passes a filter
+            // that never holds
+            bool infeasible = false;
+            visitDepthFirst(*query, [&](const RamFilter& filter) {
+                infeasible = infeasible || isRamFalse(&filter.getCondition());
+            });
+            if (infeasible) {
+                changed = true;
+                return std::make_unique<RamSequence>();
+            }
+        }
+        return node;
+    };
+    program.apply(makeLambdaRamMapper(folder));
+    return changed;
+}
+
 bool ReorderConditionsTransformer::reorderConditions(RamProgram& program) {
     bool changed = false;
     visitDepthFirst(program, [&](const RamQuery& query) {
@@ -487,6 +730,34 @@ std::unique_ptr<RamOperation> IfConversionTransformer::rewriteIndexScan(const Ra
     return nullptr;
 }
 
+std::unique_ptr<RamOperation> IfConversionTransformer::rewriteScan(const RamScan* scan) {
+    // check whether tuple is used in subsequent operations
+    bool tupleNotUsed = true;
+    visitDepthFirst(*scan, [&](const RamTupleElement& element) {
+        if (element.getTupleId() == scan->getTupleId()) {
+            tupleNotUsed = false;
+        }
+    });
+    if (!tupleNotUsed) {
+        return nullptr;
+    }
+
+    // the nested operation is evaluated once if the relation is not empty, and a break
+    // condition, which cannot depend on the tuple, becomes a filter of its negation
+    std::unique_ptr<RamOperation> newOp;
+    if (const auto* breakOp = dynamic_cast<const RamBreak*>(&scan->getOperation())) {
+        newOp = std::make_unique<RamFilter>(
+                std::make_unique<RamNegation>(std::unique_ptr<RamCondition>(breakOp->getCondition().clone())),
+                std::unique_ptr<RamOperation>(breakOp->getOperation().clone()), breakOp->getProfileText());
+    } else {
+        newOp = std::unique_ptr<RamOperation>(scan->getOperation().clone());
+    }
+    return std::make_unique<RamFilter>(
+            std::make_unique<RamNegation>(std::make_unique<RamEmptinessCheck>(
+                    std::make_unique<RamRelationReference>(&scan->getRelation()))),
+            std::move(newOp), scan->getProfileText());
+}
+
 bool IfConversionTransformer::convertIndexScans(RamProgram& program) {
     bool changed = false;
     visitDepthFirst(program, [&](const RamQuery& query) {
@@ -497,6 +768,11 @@ bool IfConversionTransformer::convertIndexScans(RamProgram& program) {
                     changed = true;
                     node = std::move(op);
                 }
+            } else if (const RamScan* scan = dynamic_cast<RamScan*>(node.get())) {
+                if (std::unique_ptr<RamOperation> op = rewriteScan(scan)) {
+                    changed = true;
+                    node = std::move(op);
+                }
             }
             node->apply(makeLambdaRamMapper(scanRewriter));
             return node;
@@ -506,66 +782,53 @@ bool IfConversionTransformer::convertIndexScans(RamProgram& program) {
     return changed;
 }
 
-std::unique_ptr<RamOperation> ChoiceConversionTransformer::rewriteScan(const RamScan* scan) {
-    bool transformTuple = false;
-
-    // Check that RamFilter follows the Scan in the loop nest
-    if (const auto* filter = dynamic_cast<const RamFilter*>(&scan->getOperation())) {
-        // Check that the Filter uses the identifier in the Scan
+std::unique_ptr<RamCondition> ChoiceConversionTransformer::collectFilters(
+        const RamRelationOperation* scan, const RamOperation*& next) {
+    // collect the conditions of the Filters following the scan in the loop nest
+    std::vector<std::unique_ptr<RamCondition>> conditions;
+    bool tupleUsed = false;
+    next = &scan->getOperation();
+    while (const auto* filter = dynamic_cast<const RamFilter*>(next)) {
+        // Check that a Filter uses the identifier in the scan
         if (rla->getLevel(&filter->getCondition()) == scan->getTupleId()) {
-            transformTuple = true;
-
-            // Check that the filter is not referred to after
-            const auto* nextNode = dynamic_cast<const RamNode*>(&filter->getOperation());
+            tupleUsed = true;
+        }
+        conditions.emplace_back(filter->getCondition().clone());
+        next = &filter->getOperation();
+    }
+    if (!tupleUsed) {
+        return nullptr;
+    }
 
-            visitDepthFirst(*nextNode, [&](const RamTupleElement& element) {
-                if (element.getTupleId() == scan->getTupleId()) {
-                    transformTuple = false;
-                }
-            });
+    // Check that the tuple is not referred to after the filters
+    bool referredAfter = false;
+    visitDepthFirst(*next, [&](const RamTupleElement& element) {
+        if (element.getTupleId() == scan->getTupleId()) {
+            referredAfter = true;
         }
+    });
+    if (referredAfter) {
+        return nullptr;
     }
+    return toCondition(conditions);
+}
 
+std::unique_ptr<RamOperation> ChoiceConversionTransformer::rewriteScan(const RamScan* scan) {
     // Convert the Scan/If pair into a Choice
-    if (transformTuple) {
-        std::vector<std::unique_ptr<RamExpression>> newValues;
-        const auto* filter = dynamic_cast<const RamFilter*>(&scan->getOperation());
-        const int identifier = scan->getTupleId();
-
+    const RamOperation* next = nullptr;
+    if (std::unique_ptr<RamCondition> condition = collectFilters(scan, next)) {
         return std::make_unique<RamChoice>(std::make_unique<RamRelationReference>(&scan->getRelation()),
-                identifier, std::unique_ptr<RamCondition>(filter->getCondition().clone()),
-                std::unique_ptr<RamOperation>(scan->getOperation().clone()), scan->getProfileText());
+                scan->getTupleId(), std::move(condition), std::unique_ptr<RamOperation>(next->clone()),
+                scan->getProfileText());
     }
     return nullptr;
 }
 
 std::unique_ptr<RamOperation> ChoiceConversionTransformer::rewriteIndexScan(const RamIndexScan* indexScan) {
-    bool transformTuple = false;
-
-    // Check that RamFilter follows the IndexScan in the loop nest
-    if (const auto* filter = dynamic_cast<const RamFilter*>(&indexScan->getOperation())) {
-        // Check that the Filter uses the identifier in the IndexScan
-        if (rla->getLevel(&filter->getCondition()) == indexScan->getTupleId()) {
-            transformTuple = true;
-
-            // Check that the filter is not referred to after
-            const auto* nextNode = dynamic_cast<const RamNode*>(&filter->getOperation());
-
-            visitDepthFirst(*nextNode, [&](const RamTupleElement& element) {
-                if (element.getTupleId() == indexScan->getTupleId()) {
-                    transformTuple = false;
-                }
-            });
-        }
-    }
-
     // Convert the IndexScan/If pair into an IndexChoice
-    if (transformTuple) {
+    const RamOperation* next = nullptr;
+    if (std::unique_ptr<RamCondition> condition = collectFilters(indexScan, next)) {
         std::vector<std::unique_ptr<RamExpression>> newValues;
-        const auto* filter = dynamic_cast<const RamFilter*>(&indexScan->getOperation());
-        const int identifier = indexScan->getTupleId();
-        const RamRelation& rel = indexScan->getRelation();
-
         for (auto& cur : indexScan->getRangePattern()) {
             RamExpression* val = nullptr;
             if (cur != nullptr) {
@@ -574,9 +837,10 @@ std::unique_ptr<RamOperation> ChoiceConversionTransformer::rewriteIndexScan(cons
             newValues.emplace_back(val);
         }
 
-        return std::make_unique<RamIndexChoice>(std::make_unique<RamRelationReference>(&rel), identifier,
-                std::unique_ptr<RamCondition>(filter->getCondition().clone()), std::move(newValues),
-                std::unique_ptr<RamOperation>(filter->getOperation().clone()), indexScan->getProfileText());
+        return std::make_unique<RamIndexChoice>(
+                std::make_unique<RamRelationReference>(&indexScan->getRelation()), indexScan->getTupleId(),
+                std::move(condition), std::move(newValues), std::unique_ptr<RamOperation>(next->clone()),
+                indexScan->getProfileText());
     }
     return nullptr;
 }
@@ -724,6 +988,694 @@ bool HoistAggregateTransformer::hoistAggregate(RamProgram& program) {
     return changed;
 }  // namespace souffle
 
+/**
+ * Clone a node, where the elements of the renamed tuples become elements of other tuples, whose
+ * columns start at the given offsets
+ */
+template <typename T>
+static std::unique_ptr<T> renameTuples(const T& node, const std::map<int, std::pair<int, size_t>>& renaming) {
+    std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> rename =
+            [&](std::unique_ptr<RamNode> cur) -> std::unique_ptr<RamNode> {
+        if (const auto* element = dynamic_cast<RamTupleElement*>(cur.get())) {
+            auto pos = renaming.find(element->getTupleId());
+            if (pos != renaming.end()) {
+                return std::make_unique<RamTupleElement>(
+                        pos->second.first, pos->second.second + element->getElement());
+            }
+        }
+        cur->apply(makeLambdaRamMapper(rename));
+        return cur;
+    };
+    return std::unique_ptr<T>(static_cast<T*>(rename(std::unique_ptr<RamNode>(node.clone())).release()));
+}
+
+bool HoistInvariantJoinsTransformer::hoistInvariantJoins(RamProgram& program) {
+    // the tuples whose elements a node refers to
+    const auto& getTuples = [](const RamNode& node) {
+        std::set<int> tuples;
+        visitDepthFirst(node, [&](const RamTupleElement& element) { tuples.insert(element.getTupleId()); });
+        return tuples;
+    };
+
+    // the relations materialized by earlier fragments, which are not joined again
+    std::set<const RamRelation*> materialized;
+    bool changed = false;
+
+    std::vector<const RamLoop*> loops;
+    visitDepthFirst(program.getMain(), [&](const RamLoop& loop) { loops.push_back(&loop); });
+    for (const RamLoop* loop : loops) {
+        // the relations inserted into, merged, swapped or cleared in the iterations
+        std::set<const RamRelation*> variant;
+        visitDepthFirst(*loop, [&](const RamNode& node) {
+            if (const auto* project = dynamic_cast<const RamProject*>(&node)) {
+                variant.insert(&project->getRelation());
+            } else if (const auto* stmt = dynamic_cast<const RamRelationStatement*>(&node)) {
+                variant.insert(&stmt->getRelation());
+            } else if (const auto* binStmt = dynamic_cast<const RamBinRelationStatement*>(&node)) {
+                variant.insert(&binStmt->getFirstRelation());
+                variant.insert(&binStmt->getSecondRelation());
+            }
+        });
+
+        // whether a node evaluates alike in all iterations once the tuples it refers to are bound
+        const auto& isInvariant = [&](const RamNode& node) {
+            bool invariant = true;
+            visitDepthFirst(node, [&](const RamNode& cur) {
+                if (const auto* ref = dynamic_cast<const RamRelationReference*>(&cur)) {
+                    invariant = invariant && variant.count(ref->get()) == 0;
+                } else if (dynamic_cast<const RamAutoIncrement*>(&cur) != nullptr) {
+                    invariant = false;
+                }
+            });
+            return invariant;
+        };
+
+        // materialize the first invariant join of a query, returning the query evaluating it
+        const auto& hoistJoin = [&](RamQuery& query) -> std::unique_ptr<RamStatement> {
+            std::vector<const RamOperation*> nest;
+            for (const RamOperation* op = &query.getOperation(); op != nullptr;) {
+                nest.push_back(op);
+                const auto* nested = dynamic_cast<const RamNestedOperation*>(op);
+                op = (nested != nullptr) ? &nested->getOperation() : nullptr;
+            }
+
+            for (size_t begin = 0; begin < nest.size(); begin++) {
+                // the fragment consists of invariant scans, each joined with the preceding ones, and of
+                // the filters between and after them
+                std::vector<const RamRelationOperation*> scans;
+                std::set<int> fragment;
+                size_t end = begin;
+                for (size_t i = begin; i < nest.size(); i++) {
+                    const RamOperation* op = nest[i];
+                    if (dynamic_cast<const RamFilter*>(op) != nullptr && !scans.empty()) {
+                        continue;
+                    }
+                    const bool isScan = dynamic_cast<const RamScan*>(op) != nullptr ||
+                                        dynamic_cast<const RamIndexScan*>(op) != nullptr;
+                    if (!isScan || dynamic_cast<const RamAbstractParallel*>(op) != nullptr) {
+                        break;
+                    }
+                    const auto* scan = static_cast<const RamRelationOperation*>(op);
+                    if (variant.count(&scan->getRelation()) > 0 ||
+                            materialized.count(&scan->getRelation()) > 0) {
+                        break;
+                    }
+                    bool joined = false;
+                    bool mixed = false;
+                    if (const auto* indexScan = dynamic_cast<const RamIndexScan*>(op)) {
+                        for (const RamExpression* value : indexScan->getRangePattern()) {
+                            const std::set<int> tuples = getTuples(*value);
+                            const size_t inside = std::count_if(tuples.begin(), tuples.end(),
+                                    [&](int tuple) { return fragment.count(tuple) > 0; });
+                            joined = joined || (inside > 0 && inside == tuples.size());
+                            mixed = mixed || (inside > 0 && inside < tuples.size()) || !isInvariant(*value);
+                        }
+                    }
+                    if (mixed || (!scans.empty() && !joined)) {
+                        break;
+                    }
+                    scans.push_back(scan);
+                    fragment.insert(scan->getTupleId());
+                    end = i + 1;
+                }
+                if (scans.size() < 2) {
+                    continue;
+                }
+                while (dynamic_cast<const RamFilter*>(nest[end]) != nullptr) {
+                    end++;
+                }
+
+                // the temporary relation holds the columns of all scanned relations
+                std::vector<std::string> names;
+                std::vector<std::string> types;
+                std::map<int, std::pair<int, size_t>> materializedTuples;
+                std::map<int, std::pair<int, size_t>> probedTuples;
+                const int tupleId = scans.front()->getTupleId();
+                for (const RamRelationOperation* scan : scans) {
+                    const RamRelation& rel = scan->getRelation();
+                    const int id = materializedTuples.size();
+                    materializedTuples[scan->getTupleId()] = {id, 0};
+                    probedTuples[scan->getTupleId()] = {tupleId, names.size()};
+                    for (size_t i = 0; i < rel.getArity(); i++) {
+                        names.push_back("t" + std::to_string(scan->getTupleId()) + "_" +
+                                        rel.getAttributeNames()[i]);
+                        types.push_back(rel.getAttributeTypes()[i]);
+                    }
+                }
+                const size_t arity = names.size();
+                auto relation = std::make_unique<RamRelation>(
+                        "@invariant_" + std::to_string(materialized.size()), arity, 0, std::move(names),
+                        std::move(types), RelationRepresentation::DEFAULT);
+                const RamRelation* invariant = relation.get();
+                program.addRelation(std::move(relation));
+                materialized.insert(invariant);
+
+                // the materialization evaluates the fragment without the bindings of the other scans,
+                // which are searched by the probe instead
+                std::vector<std::unique_ptr<RamExpression>> values;
+                for (const RamRelationOperation* scan : scans) {
+                    const int id = materializedTuples[scan->getTupleId()].first;
+                    for (size_t i = 0; i < scan->getRelation().getArity(); i++) {
+                        values.push_back(std::make_unique<RamTupleElement>(id, i));
+                    }
+                }
+                std::unique_ptr<RamOperation> materialization = std::make_unique<RamProject>(
+                        std::make_unique<RamRelationReference>(invariant), std::move(values));
+                std::vector<std::unique_ptr<RamExpression>> probePattern(arity);
+                std::vector<std::unique_ptr<RamCondition>> probeConditions;
+                for (size_t i = end; i-- > begin;) {
+                    if (const auto* filter = dynamic_cast<const RamFilter*>(nest[i])) {
+                        std::vector<std::unique_ptr<RamCondition>> conditions;
+                        for (auto& condition : toConjunctionList(&filter->getCondition())) {
+                            const std::set<int> tuples = getTuples(*condition);
+                            if (isInvariant(*condition) && std::includes(fragment.begin(), fragment.end(),
+                                                                   tuples.begin(), tuples.end())) {
+                                conditions.push_back(renameTuples(*condition, materializedTuples));
+                            } else {
+                                probeConditions.push_back(renameTuples(*condition, probedTuples));
+                            }
+                        }
+                        if (!conditions.empty()) {
+                            materialization = std::make_unique<RamFilter>(
+                                    toCondition(conditions), std::move(materialization));
+                        }
+                        continue;
+                    }
+                    const auto* scan = static_cast<const RamRelationOperation*>(nest[i]);
+                    auto ref = std::make_unique<RamRelationReference>(&scan->getRelation());
+                    const int id = materializedTuples[scan->getTupleId()].first;
+                    const auto* indexScan = dynamic_cast<const RamIndexScan*>(scan);
+                    if (indexScan == nullptr) {
+                        materialization =
+                                std::make_unique<RamScan>(std::move(ref), id, std::move(materialization));
+                        continue;
+                    }
+                    std::vector<std::unique_ptr<RamExpression>> pattern;
+                    bool indexed = false;
+                    size_t column = probedTuples[scan->getTupleId()].second;
+                    for (const RamExpression* value : indexScan->getRangePattern()) {
+                        const std::set<int> tuples = getTuples(*value);
+                        if (!tuples.empty() && fragment.count(*tuples.begin()) == 0) {
+                            probePattern[column] = std::unique_ptr<RamExpression>(value->clone());
+                            pattern.push_back(std::make_unique<RamUndefValue>());
+                        } else {
+                            indexed = indexed || dynamic_cast<const RamUndefValue*>(value) == nullptr;
+                            pattern.push_back(renameTuples(*value, materializedTuples));
+                        }
+                        column++;
+                    }
+                    if (indexed) {
+                        materialization = std::make_unique<RamIndexScan>(
+                                std::move(ref), id, std::move(pattern), std::move(materialization));
+                    } else {
+                        materialization =
+                                std::make_unique<RamScan>(std::move(ref), id, std::move(materialization));
+                    }
+                }
+
+                // the loop probes the temporary relation on the columns bound outside of the fragment
+                std::unique_ptr<RamOperation> probe = renameTuples(*nest[end], probedTuples);
+                if (!probeConditions.empty()) {
+                    probe = std::make_unique<RamFilter>(toCondition(probeConditions), std::move(probe));
+                }
+                bool indexed = false;
+                for (auto& value : probePattern) {
+                    indexed = indexed || value != nullptr;
+                    if (value == nullptr) {
+                        value = std::make_unique<RamUndefValue>();
+                    }
+                }
+                auto ref = std::make_unique<RamRelationReference>(invariant);
+                if (indexed) {
+                    probe = std::make_unique<RamIndexScan>(
+                            std::move(ref), tupleId, std::move(probePattern), std::move(probe));
+                } else {
+                    probe = std::make_unique<RamScan>(std::move(ref), tupleId, std::move(probe));
+                }
+                query.rewrite(nest[begin], std::move(probe));
+                return std::make_unique<RamQuery>(std::move(materialization));
+            }
+            return nullptr;
+        };
+
+        // the joins are evaluated before the loop, and their relations are cleared after it
+        std::vector<const RamQuery*> queries;
+        visitDepthFirst(*loop, [&](const RamQuery& query) { queries.push_back(&query); });
+        auto sequence = std::make_unique<RamSequence>();
+        std::vector<std::unique_ptr<RamStatement>> clears;
+        for (const RamQuery* query : queries) {
+            while (auto materialization = hoistJoin(const_cast<RamQuery&>(*query))) {
+                sequence->add(std::move(materialization));
+                // the relation of the join is the last one added to the program
+                clears.push_back(std::make_unique<RamClear>(
+                        std::make_unique<RamRelationReference>(program.getRelations().back())));
+            }
+        }
+        if (clears.empty()) {
+            continue;
+        }
+        sequence->add(std::unique_ptr<RamStatement>(loop->clone()));
+        for (auto& clear : clears) {
+            sequence->add(std::move(clear));
+        }
+        program.getMain().rewrite(loop, std::move(sequence));
+        changed = true;
+    }
+    return changed;
+}
+
+std::unique_ptr<RamOperation> EqrelJoinTransformer::rewriteScan(const RamScan& scan, int ident) {
+    const int tupleId = scan.getTupleId();
+
+    // the operations nested in the scan, up to the end of the loop-nest
+    std::vector<const RamOperation*> nest;
+    for (const RamOperation* op = &scan.getOperation(); op != nullptr;) {
+        nest.push_back(op);
+        const auto* nested = dynamic_cast<const RamNestedOperation*>(op);
+        op = (nested != nullptr) ? &nested->getOperation() : nullptr;
+    }
+
+    // whether an operation reads a column of the scanned tuple, apart from its nested operation
+    const auto& readsColumn = [&](const RamOperation& op, size_t column) {
+        const auto* nested = dynamic_cast<const RamNestedOperation*>(&op);
+        bool reads = false;
+        for (const RamNode* child : op.getChildNodes()) {
+            if (nested != nullptr && child == &nested->getOperation()) {
+                continue;
+            }
+            visitDepthFirst(*child, [&](const RamTupleElement& element) {
+                reads = reads || (element.getTupleId() == tupleId && element.getElement() == column);
+            });
+        }
+        return reads;
+    };
+
+    // the joined column is the one read alone by the most operations; the other column is bound by an
+    // expansion of the class, which is dropped if no operation reads it
+    size_t joined = 0;
+    size_t expanded = 0;
+    size_t best = 0;
+    for (size_t column : {1, 0}) {
+        size_t first = 0;
+        while (first < nest.size() && !readsColumn(*nest[first], 1 - column)) {
+            first++;
+        }
+        const size_t rank = (first == nest.size()) ? first + 1 : first;
+        if (rank > best) {
+            joined = column;
+            expanded = first;
+            best = rank;
+        }
+    }
+    if (best == 0) {
+        return nullptr;
+    }
+
+    std::unique_ptr<RamOperation> nested(scan.getOperation().clone());
+    if (expanded < nest.size()) {
+        // the operations reading the other column follow an index scan over the class of the element
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> substitute =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const auto* element = dynamic_cast<RamTupleElement*>(node.get())) {
+                if (element->getTupleId() == tupleId && element->getElement() == 1 - joined) {
+                    return std::make_unique<RamTupleElement>(ident, 1);
+                }
+            }
+            node->apply(makeLambdaRamMapper(substitute));
+            return node;
+        };
+        std::vector<std::unique_ptr<RamExpression>> pattern;
+        pattern.push_back(std::make_unique<RamTupleElement>(tupleId, joined));
+        pattern.push_back(std::make_unique<RamUndefValue>());
+        auto expansion = std::make_unique<RamIndexScan>(
+                std::make_unique<RamRelationReference>(&scan.getRelation()), ident, std::move(pattern),
+                std::unique_ptr<RamOperation>(static_cast<RamOperation*>(
+                        substitute(std::unique_ptr<RamNode>(nest[expanded]->clone())).release())));
+
+        // the expansion replaces the first operation reading the other column in the clone of the nest
+        const RamOperation* cut = nested.get();
+        for (size_t i = 0; i < expanded; i++) {
+            cut = &static_cast<const RamNestedOperation*>(cut)->getOperation();
+        }
+        nested->rewrite(cut, std::move(expansion));
+    }
+
+    // the scan only binds the pairs (y, y) of the relation
+    auto diagonal = std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+            std::make_unique<RamTupleElement>(tupleId, 0), std::make_unique<RamTupleElement>(tupleId, 1));
+    return std::make_unique<RamScan>(std::make_unique<RamRelationReference>(&scan.getRelation()), tupleId,
+            std::make_unique<RamFilter>(std::move(diagonal), std::move(nested)), scan.getProfileText());
+}
+
+bool EqrelJoinTransformer::joinClasses(RamProgram& program) {
+    bool changed = false;
+    visitDepthFirst(program, [&](const RamQuery& query) {
+        // the relations inserted into by the query are not scanned by class
+        std::set<const RamRelation*> inserted;
+        visitDepthFirst(query, [&](const RamProject& project) { inserted.insert(&project.getRelation()); });
+        int ident = 0;
+        visitDepthFirst(
+                query, [&](const RamTupleOperation& op) { ident = std::max(ident, op.getTupleId() + 1); });
+
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> classRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const auto* scan = dynamic_cast<RamScan*>(node.get())) {
+                const RamRelation& rel = scan->getRelation();
+                bool nondeterministic = false;
+                visitDepthFirst(scan->getOperation(), [&](const RamNode& cur) {
+                    nondeterministic = nondeterministic || dynamic_cast<const RamBreak*>(&cur) != nullptr ||
+                                       dynamic_cast<const RamAutoIncrement*>(&cur) != nullptr;
+                });
+                if (typeid(*scan) == typeid(RamScan) &&
+                        rel.getRepresentation() == RelationRepresentation::EQREL && rel.getArity() == 2 &&
+                        rel.getAuxiliaryArity() == 0 && inserted.count(&rel) == 0 && !nondeterministic) {
+                    if (std::unique_ptr<RamOperation> op = rewriteScan(*scan, ident)) {
+                        changed = true;
+                        ident++;
+                        node = std::move(op);
+                    }
+                }
+            }
+            node->apply(makeLambdaRamMapper(classRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(classRewriter));
+    });
+    return changed;
+}
+
+std::unique_ptr<RamOperation> LeapfrogJoinTransformer::rewriteScan(const RamRelationOperation* scan) {
+    const RamRelation& rel = scan->getRelation();
+    const int identifier = scan->getTupleId();
+
+    // seeks are performed on the b-trees and dense relations only, which order values as signed numbers
+    auto isJoinable = [&](const RamRelation& other) {
+        if (other.isNullary()) {
+            return false;
+        }
+        switch (other.getRepresentation()) {
+            case RelationRepresentation::DEFAULT:
+            case RelationRepresentation::BTREE:
+                return true;
+            case RelationRepresentation::DENSE:
+                return other.getArity() <= 2 && other.getAuxiliaryArity() == 0;
+            default:
+                return false;
+        }
+    };
+    if (!isJoinable(rel)) {
+        return nullptr;
+    }
+
+    // obtain the range pattern, leaving a single column free
+    std::vector<std::unique_ptr<RamExpression>> queryPattern;
+    if (const auto* iscan = dynamic_cast<const RamIndexScan*>(scan)) {
+        for (const RamExpression* cur : iscan->getRangePattern()) {
+            queryPattern.push_back(std::unique_ptr<RamExpression>(cur->clone()));
+        }
+    } else if (rel.getArity() == 1) {
+        queryPattern.push_back(std::make_unique<RamUndefValue>());
+    }
+    const size_t column = RamLeapfrogJoin::getFreeColumn(toPtrVector(queryPattern));
+    if (column == queryPattern.size()) {
+        return nullptr;
+    }
+
+    // the checks must immediately follow the scan
+    const auto* filter = dynamic_cast<const RamFilter*>(&scan->getOperation());
+    if (filter == nullptr) {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<RamExistenceCheck>> intersections;
+    std::vector<std::unique_ptr<RamCondition>> remainingConditions;
+    for (auto& cond : toConjunctionList(&filter->getCondition())) {
+        const auto* exists = dynamic_cast<const RamExistenceCheck*>(cond.get());
+        if (exists == nullptr || !isJoinable(exists->getRelation())) {
+            remainingConditions.push_back(std::move(cond));
+            continue;
+        }
+        // the free column of the scan has to be the only reference to the scanned tuple
+        size_t matched = 0;
+        size_t position = 0;
+        bool joinable = true;
+        const auto values = exists->getValues();
+        for (size_t i = 0; i < values.size(); i++) {
+            const auto* element = dynamic_cast<const RamTupleElement*>(values[i]);
+            if (element != nullptr && element->getTupleId() == identifier &&
+                    element->getElement() == column) {
+                matched++;
+                position = i;
+            } else if (isRamUndefValue(values[i]) || rla->getLevel(values[i]) >= identifier) {
+                joinable = false;
+            }
+        }
+        if (!joinable || matched != 1) {
+            remainingConditions.push_back(std::move(cond));
+            continue;
+        }
+        std::vector<std::unique_ptr<RamExpression>> pattern;
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i == position) {
+                pattern.push_back(std::make_unique<RamUndefValue>());
+            } else {
+                pattern.push_back(std::unique_ptr<RamExpression>(values[i]->clone()));
+            }
+        }
+        intersections.push_back(std::make_unique<RamExistenceCheck>(
+                std::make_unique<RamRelationReference>(&exists->getRelation()), std::move(pattern)));
+    }
+    if (intersections.empty()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<RamOperation> nested(filter->getOperation().clone());
+    if (!remainingConditions.empty()) {
+        nested = std::make_unique<RamFilter>(
+                toCondition(remainingConditions), std::move(nested), filter->getProfileText());
+    }
+    return std::make_unique<RamLeapfrogJoin>(std::make_unique<RamRelationReference>(&rel), identifier,
+            std::move(queryPattern), std::move(intersections), std::move(nested), scan->getProfileText());
+}
+
+bool LeapfrogJoinTransformer::makeLeapfrogJoins(RamProgram& program) {
+    bool changed = false;
+    visitDepthFirst(program, [&](const RamQuery& query) {
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> leapfrogRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            // the outermost loop is left for the parallelization
+            const RamRelationOperation* scan = dynamic_cast<RamScan*>(node.get());
+            if (scan == nullptr) {
+                scan = dynamic_cast<RamIndexScan*>(node.get());
+            }
+            if (scan != nullptr && scan->getTupleId() > 0) {
+                if (std::unique_ptr<RamOperation> op = rewriteScan(scan)) {
+                    changed = true;
+                    node = std::move(op);
+                }
+            }
+            node->apply(makeLambdaRamMapper(leapfrogRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(leapfrogRewriter));
+    });
+    return changed;
+}
+
+std::unique_ptr<RamOperation> ProfileGuidedIndexTransformer::rewriteSearch(
+        const RamIndexOperation* search, SearchSignature prefix) {
+    if (dynamic_cast<const RamAbstractParallel*>(search) != nullptr) {
+        return nullptr;
+    }
+    const RamRelation& rel = search->getRelation();
+    const int identifier = search->getTupleId();
+
+    // keep the prefix in the query pattern and check the other columns of the search
+    std::vector<std::unique_ptr<RamExpression>> queryPattern;
+    std::unique_ptr<RamCondition> condition;
+    auto addCondition = [&](std::unique_ptr<RamCondition> c) {
+        if (condition != nullptr) {
+            condition = std::make_unique<RamConjunction>(std::move(condition), std::move(c));
+        } else {
+            condition = std::move(c);
+        }
+    };
+    const auto rangePattern = search->getRangePattern();
+    for (size_t i = 0; i < rangePattern.size(); i++) {
+        if (isRamUndefValue(rangePattern[i]) || (prefix & (SearchSignature(1) << i)) != 0) {
+            queryPattern.push_back(std::unique_ptr<RamExpression>(rangePattern[i]->clone()));
+        } else {
+            queryPattern.push_back(std::make_unique<RamUndefValue>());
+            addCondition(std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+                    std::make_unique<RamTupleElement>(identifier, i),
+                    std::unique_ptr<RamExpression>(rangePattern[i]->clone())));
+        }
+    }
+    if (condition == nullptr) {
+        return nullptr;
+    }
+
+    if (const auto* iscan = dynamic_cast<const RamIndexScan*>(search)) {
+        std::unique_ptr<RamOperation> op;
+        if (const auto* filter = dynamic_cast<const RamFilter*>(&iscan->getOperation())) {
+            addCondition(std::unique_ptr<RamCondition>(filter->getCondition().clone()));
+            op = std::unique_ptr<RamOperation>(filter->getOperation().clone());
+        } else {
+            op = std::unique_ptr<RamOperation>(iscan->getOperation().clone());
+        }
+        return std::make_unique<RamIndexScan>(std::make_unique<RamRelationReference>(&rel), identifier,
+                std::move(queryPattern), std::make_unique<RamFilter>(std::move(condition), std::move(op)),
+                iscan->getProfileText());
+    } else if (const auto* ichoice = dynamic_cast<const RamIndexChoice*>(search)) {
+        addCondition(std::unique_ptr<RamCondition>(ichoice->getCondition().clone()));
+        return std::make_unique<RamIndexChoice>(std::make_unique<RamRelationReference>(&rel), identifier,
+                std::move(condition), std::move(queryPattern),
+                std::unique_ptr<RamOperation>(ichoice->getOperation().clone()), ichoice->getProfileText());
+    } else if (const auto* agg = dynamic_cast<const RamIndexAggregate*>(search)) {
+        if (!isRamTrue(&agg->getCondition())) {
+            addCondition(std::unique_ptr<RamCondition>(agg->getCondition().clone()));
+        }
+        return std::make_unique<RamIndexAggregate>(std::unique_ptr<RamOperation>(agg->getOperation().clone()),
+                agg->getFunction(), std::make_unique<RamRelationReference>(&rel),
+                std::unique_ptr<RamExpression>(agg->getExpression().clone()), std::move(condition),
+                std::move(queryPattern), identifier);
+    }
+    return nullptr;
+}
+
+bool ProfileGuidedIndexTransformer::reduceSearches(RamProgram& program, const profile::ProgramRun& run) {
+    // the searches of leapfrog joins and existence checks cannot be served by a prefix
+    std::map<const RamRelation*, std::set<SearchSignature>> fixedSearches;
+    visitDepthFirst(program, [&](const RamNode& node) {
+        if (const auto* leapfrog = dynamic_cast<const RamLeapfrogJoin*>(&node)) {
+            fixedSearches[&leapfrog->getRelation()].insert(isa->getSearchSignature(leapfrog));
+        } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
+            fixedSearches[&exists->getRelation()].insert(isa->getSearchSignature(exists));
+        } else if (const auto* provExists = dynamic_cast<const RamProvenanceExistenceCheck*>(&node)) {
+            fixedSearches[&provExists->getRelation()].insert(isa->getSearchSignature(provExists));
+        }
+    });
+
+    // swapped relations share their indexes, hence their searches are weighted together
+    std::map<const RamRelation*, const RamRelation*> swapped;
+    visitDepthFirst(program, [&](const RamSwap& swap) {
+        swapped[&swap.getFirstRelation()] = &swap.getSecondRelation();
+        swapped[&swap.getSecondRelation()] = &swap.getFirstRelation();
+    });
+
+    // find the prefixes serving the infrequent searches of each relation
+    std::map<const RamRelation*, std::map<SearchSignature, SearchSignature>> prefixes;
+    for (const RamRelation* rel : program.getRelations()) {
+        switch (rel->getRepresentation()) {
+            case RelationRepresentation::DEFAULT:
+            case RelationRepresentation::BTREE:
+                break;
+            default:
+                continue;
+        }
+
+        // delta and new relations receive the tuples of their relation over all iterations
+        std::string name = rel->getName();
+        for (const std::string prefix : {"@delta_", "@new_"}) {
+            if (name.compare(0, prefix.size(), prefix) == 0) {
+                name = name.substr(prefix.size());
+            }
+        }
+        const profile::Relation* profRel = run.getRelation(name);
+        if (profRel == nullptr || !profRel->hasCardinality()) {
+            continue;
+        }
+        const double cardinality = profRel->getCardinality();
+        const auto& distinct = profRel->getDistinctValues();
+
+        MinIndexSelection::SearchFrequencies frequencies;
+        std::vector<const RamRelation*> group = {rel};
+        if (swapped.count(rel) != 0) {
+            group.push_back(swapped[rel]);
+        }
+        std::map<SearchSignature, size_t> tuples;
+        for (const RamRelation* cur : group) {
+            if (const auto* counts = run.getSearches(cur->getName())) {
+                for (const auto& count : *counts) {
+                    frequencies[count.first] += count.second;
+                }
+            }
+            if (const auto* counts = run.getSearchTuples(cur->getName())) {
+                for (const auto& count : *counts) {
+                    tuples[count.first] += count.second;
+                }
+            }
+        }
+
+        // prefer the tuples found by the profiled searches to the estimate from distinct values
+        std::map<SearchSignature, double> measured;
+        for (const auto& cur : tuples) {
+            auto pos = frequencies.find(cur.first);
+            if (pos != frequencies.end() && pos->second != 0) {
+                measured[cur.first] = static_cast<double>(cur.second) / pos->second;
+            }
+        }
+        auto matches = [&](SearchSignature search) {
+            auto found = measured.find(search);
+            if (found != measured.end()) {
+                return found->second;
+            }
+            double res = cardinality;
+            for (size_t i = 0; i < rel->getArity(); i++) {
+                if ((search & (SearchSignature(1) << i)) != 0) {
+                    auto pos = distinct.find(i);
+                    const double values = pos != distinct.end() ? pos->second : cardinality;
+                    res /= std::max(1.0, values);
+                }
+            }
+            return std::max(res, std::min(cardinality, 1.0));
+        };
+        for (const RamRelation* cur : group) {
+            for (SearchSignature search : fixedSearches[cur]) {
+                frequencies.erase(search);
+            }
+        }
+        frequencies.erase(isa->getSearchSignature(rel));
+        if (frequencies.empty()) {
+            continue;
+        }
+
+        // maintaining an index inserts each tuple of the relation into a tree
+        const double indexCost = cardinality * std::log2(cardinality + 1);
+        prefixes[rel] = isa->getIndexes(*rel).reduceSearches(frequencies, matches, indexCost);
+    }
+
+    bool changed = false;
+    visitDepthFirst(program, [&](const RamQuery& query) {
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> searchRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const auto* search = dynamic_cast<RamIndexOperation*>(node.get())) {
+                auto pos = prefixes.find(&search->getRelation());
+                if (pos != prefixes.end()) {
+                    auto prefix = pos->second.find(isa->getSearchSignature(search));
+                    if (prefix != pos->second.end()) {
+                        if (std::unique_ptr<RamOperation> op = rewriteSearch(search, prefix->second)) {
+                            changed = true;
+                            node = std::move(op);
+                        }
+                    }
+                }
+            }
+            node->apply(makeLambdaRamMapper(searchRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(searchRewriter));
+    });
+    return changed;
+}
+
+bool ProfileGuidedIndexTransformer::transform(RamTranslationUnit& translationUnit) {
+    isa = translationUnit.getAnalysis<RamIndexAnalysis>();
+    auto run = std::make_shared<profile::ProgramRun>();
+    profile::Reader(Global::config().get("profile-use"), run).processFile();
+    return reduceSearches(translationUnit.getProgram(), *run);
+}
+
 bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
     bool changed = false;
 
@@ -790,6 +1742,39 @@ bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
                             std::unique_ptr<RamOperation>(indexChoice->getOperation().clone()),
                             indexChoice->getProfileText());
                 }
+            } else if (const RamAggregate* aggregate = dynamic_cast<RamAggregate*>(node.get())) {
+                // an unrestricted count is answered by the size of the relation
+                bool isSize = aggregate->getFunction() == souffle::COUNT &&
+                              isRamTrue(&aggregate->getCondition());
+                if (aggregate->getTupleId() == 0 && aggregate->getRelation().getArity() > 0 && !isSize) {
+                    changed = true;
+                    return std::make_unique<RamParallelAggregate>(
+                            std::unique_ptr<RamOperation>(aggregate->getOperation().clone()),
+                            aggregate->getFunction(),
+                            std::make_unique<RamRelationReference>(&aggregate->getRelation()),
+                            std::unique_ptr<RamExpression>(aggregate->getExpression().clone()),
+                            std::unique_ptr<RamCondition>(aggregate->getCondition().clone()),
+                            aggregate->getTupleId());
+                }
+            } else if (const RamIndexAggregate* indexAgg = dynamic_cast<RamIndexAggregate*>(node.get())) {
+                if (indexAgg->getTupleId() == 0) {
+                    changed = true;
+                    const RamRelation& rel = indexAgg->getRelation();
+                    std::vector<std::unique_ptr<RamExpression>> queryPattern;
+                    for (const RamExpression* cur : indexAgg->getRangePattern()) {
+                        if (nullptr != cur) {
+                            queryPattern.push_back(std::unique_ptr<RamExpression>(cur->clone()));
+                        } else {
+                            queryPattern.push_back(nullptr);
+                        }
+                    }
+                    return std::make_unique<RamParallelIndexAggregate>(
+                            std::unique_ptr<RamOperation>(indexAgg->getOperation().clone()),
+                            indexAgg->getFunction(), std::make_unique<RamRelationReference>(&rel),
+                            std::unique_ptr<RamExpression>(indexAgg->getExpression().clone()),
+                            std::unique_ptr<RamCondition>(indexAgg->getCondition().clone()),
+                            std::move(queryPattern), indexAgg->getTupleId());
+                }
             }
             node->apply(makeLambdaRamMapper(parallelRewriter));
             return node;
@@ -799,4 +1784,566 @@ bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
     return changed;
 }
 
+std::unique_ptr<RamOperation> HashJoinTransformer::rewriteScan(const RamScan* scan) {
+    if ((typeid(*scan) != typeid(RamScan) && typeid(*scan) != typeid(RamParallelScan)) ||
+            scan->getTupleId() != 0 || scan->getRelation().getArity() == 0 ||
+            !scan->getProfileText().empty()) {
+        return nullptr;
+    }
+    const auto* inner = dynamic_cast<const RamIndexScan*>(&scan->getOperation());
+    if (inner == nullptr || dynamic_cast<const RamAbstractParallel*>(inner) != nullptr ||
+            !inner->getProfileText().empty()) {
+        return nullptr;
+    }
+
+    // the joined tuples are found in the order of the hash table, hence the search is not broken off
+    bool breaks = false;
+    visitDepthFirst(inner->getOperation(), [&](const RamBreak&) { breaks = true; });
+    if (breaks) {
+        return nullptr;
+    }
+
+    // the columns of the search are bound to elements of the scanned tuple or to constants
+    std::unique_ptr<RamCondition> keys;
+    const auto pattern = inner->getRangePattern();
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (isRamUndefValue(pattern[i])) {
+            continue;
+        }
+        const auto* element = dynamic_cast<const RamTupleElement*>(pattern[i]);
+        if ((element == nullptr || element->getTupleId() != scan->getTupleId()) &&
+                dynamic_cast<const RamConstant*>(pattern[i]) == nullptr) {
+            return nullptr;
+        }
+        auto key = std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+                std::make_unique<RamTupleElement>(inner->getTupleId(), i),
+                std::unique_ptr<RamExpression>(pattern[i]->clone()));
+        if (keys != nullptr) {
+            keys = std::make_unique<RamConjunction>(std::move(keys), std::move(key));
+        } else {
+            keys = std::move(key);
+        }
+    }
+    if (keys == nullptr) {
+        return nullptr;
+    }
+
+    auto nested = std::make_unique<RamScan>(std::make_unique<RamRelationReference>(&inner->getRelation()),
+            inner->getTupleId(),
+            std::make_unique<RamFilter>(
+                    std::move(keys), std::unique_ptr<RamOperation>(inner->getOperation().clone())));
+    if (!RamHashJoin::isHashable(scan->getTupleId(), *nested)) {
+        return nullptr;
+    }
+    auto rel = std::make_unique<RamRelationReference>(&scan->getRelation());
+    if (dynamic_cast<const RamParallelScan*>(scan) != nullptr) {
+        return std::make_unique<RamParallelHashJoin>(std::move(rel), scan->getTupleId(), std::move(nested));
+    }
+    return std::make_unique<RamHashJoin>(std::move(rel), scan->getTupleId(), std::move(nested));
+}
+
+bool HashJoinTransformer::makeHashJoins(RamProgram& program) {
+    // the number of operations searching each relation by each signature
+    std::map<std::pair<const RamRelation*, SearchSignature>, size_t> uses;
+    visitDepthFirst(program, [&](const RamNode& node) {
+        if (const auto* search = dynamic_cast<const RamIndexOperation*>(&node)) {
+            uses[{&search->getRelation(), isa->getSearchSignature(search)}]++;
+        } else if (const auto* merge = dynamic_cast<const RamMergeJoin*>(&node)) {
+            uses[{&merge->getRelation(), isa->getSearchSignature(merge)}]++;
+        } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
+            uses[{&exists->getRelation(), isa->getSearchSignature(exists)}]++;
+        } else if (const auto* provExists = dynamic_cast<const RamProvenanceExistenceCheck*>(&node)) {
+            uses[{&provExists->getRelation(), isa->getSearchSignature(provExists)}]++;
+        }
+    });
+
+    // swapped relations share their searches, and only b-tree relations maintain an index per order
+    std::set<const RamRelation*> excluded;
+    visitDepthFirst(program, [&](const RamSwap& swap) {
+        excluded.insert(&swap.getFirstRelation());
+        excluded.insert(&swap.getSecondRelation());
+    });
+    for (const RamRelation* rel : program.getRelations()) {
+        RelationRepresentation representation = rel->getRepresentation();
+        if (representation != RelationRepresentation::BTREE &&
+                representation != RelationRepresentation::DEFAULT) {
+            excluded.insert(rel);
+        }
+    }
+
+    // the remaining searches of the relations, which lose the searches of the hash joins
+    std::map<const RamRelation*, MinIndexSelection::SearchSet> searches;
+    const auto& savesIndex = [&](const RamRelation& rel, SearchSignature search) {
+        auto pos = searches.find(&rel);
+        if (pos == searches.end()) {
+            pos = searches.insert({&rel, isa->getIndexes(rel).getSearches()}).first;
+        }
+        MinIndexSelection with;
+        MinIndexSelection without;
+        for (SearchSignature cur : pos->second) {
+            with.addSearch(cur);
+            if (cur != search) {
+                without.addSearch(cur);
+            }
+        }
+        with.solve();
+        without.solve();
+        if (without.getAllOrders().size() >= with.getAllOrders().size()) {
+            return false;
+        }
+        pos->second.erase(search);
+        return true;
+    };
+
+    // the relations of recursive strata are small deltas, which are searched for each tuple instead
+    std::set<const RamQuery*> recursive;
+    visitDepthFirst(program.getMain(), [&](const RamLoop& loop) {
+        visitDepthFirst(loop, [&](const RamQuery& query) { recursive.insert(&query); });
+    });
+
+    bool changed = false;
+    visitDepthFirst(program.getMain(), [&](const RamQuery& query) {
+        if (recursive.count(&query) > 0) {
+            return;
+        }
+        // the joined relations are not inserted into while they are scanned
+        std::set<const RamRelation*> inserted;
+        visitDepthFirst(query, [&](const RamProject& project) { inserted.insert(&project.getRelation()); });
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> hashRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const RamScan* scan = dynamic_cast<RamScan*>(node.get())) {
+                const auto* inner = dynamic_cast<const RamIndexScan*>(&scan->getOperation());
+                if (inner == nullptr || inserted.count(&scan->getRelation()) > 0) {
+                    return node;
+                }
+                const RamRelation& rel = inner->getRelation();
+                const SearchSignature search = isa->getSearchSignature(inner);
+                if (inserted.count(&rel) > 0 || excluded.count(&rel) > 0 || uses[{&rel, search}] != 1) {
+                    return node;
+                }
+                std::unique_ptr<RamOperation> op = rewriteScan(scan);
+                if (op != nullptr && savesIndex(rel, search)) {
+                    changed = true;
+                    return op;
+                }
+                return node;
+            }
+            node->apply(makeLambdaRamMapper(hashRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(hashRewriter));
+    });
+    return changed;
+}
+
+std::unique_ptr<RamOperation> GroupAggregateTransformer::rewriteScan(const RamScan* scan) {
+    if ((typeid(*scan) != typeid(RamScan) && typeid(*scan) != typeid(RamParallelScan)) ||
+            scan->getTupleId() != 0 || scan->getRelation().getArity() == 0 ||
+            !scan->getProfileText().empty()) {
+        return nullptr;
+    }
+
+    // skip the filters on the scanned tuple, which are moved below the aggregation
+    std::vector<const RamFilter*> filters;
+    const RamOperation* op = &scan->getOperation();
+    while (const auto* filter = dynamic_cast<const RamFilter*>(op)) {
+        filters.push_back(filter);
+        op = &filter->getOperation();
+    }
+    const auto* aggregate = dynamic_cast<const RamIndexAggregate*>(op);
+    if (aggregate == nullptr || typeid(*aggregate) != typeid(RamIndexAggregate) ||
+            !aggregate->getProfileText().empty()) {
+        return nullptr;
+    }
+
+    // the groups are visited in the order of the hash table, hence the scan is not broken off
+    bool breaks = false;
+    visitDepthFirst(aggregate->getOperation(), [&](const RamBreak&) { breaks = true; });
+    if (breaks) {
+        return nullptr;
+    }
+
+    // each element of the scanned tuple binds a single column of the search, the others are constants
+    const auto pattern = aggregate->getRangePattern();
+    const size_t arity = scan->getRelation().getArity();
+    std::vector<bool> bound(arity, false);
+    std::unique_ptr<RamCondition> condition;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (isRamUndefValue(pattern[i])) {
+            continue;
+        }
+        const auto* element = dynamic_cast<const RamTupleElement*>(pattern[i]);
+        if (element != nullptr && element->getTupleId() == scan->getTupleId()) {
+            if (bound[element->getElement()]) {
+                return nullptr;
+            }
+            bound[element->getElement()] = true;
+        } else if (dynamic_cast<const RamConstant*>(pattern[i]) == nullptr) {
+            return nullptr;
+        }
+        auto key = std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+                std::make_unique<RamTupleElement>(aggregate->getTupleId(), i),
+                std::unique_ptr<RamExpression>(pattern[i]->clone()));
+        if (condition != nullptr) {
+            condition = std::make_unique<RamConjunction>(std::move(condition), std::move(key));
+        } else {
+            condition = std::move(key);
+        }
+    }
+    if (std::find(bound.begin(), bound.end(), false) != bound.end()) {
+        return nullptr;
+    }
+    if (!isRamTrue(&aggregate->getCondition())) {
+        condition = std::make_unique<RamConjunction>(std::move(condition),
+                std::unique_ptr<RamCondition>(aggregate->getCondition().clone()));
+    }
+
+    // the filters on the scanned tuple do not depend on the result of the aggregation
+    auto nested = std::unique_ptr<RamOperation>(aggregate->getOperation().clone());
+    for (auto it = filters.rbegin(); it != filters.rend(); ++it) {
+        nested = std::make_unique<RamFilter>(
+                std::unique_ptr<RamCondition>((*it)->getCondition().clone()), std::move(nested));
+    }
+    auto plain = std::make_unique<RamAggregate>(std::move(nested), aggregate->getFunction(),
+            std::make_unique<RamRelationReference>(&aggregate->getRelation()),
+            std::unique_ptr<RamExpression>(aggregate->getExpression().clone()), std::move(condition),
+            aggregate->getTupleId());
+    if (!RamGroupAggregate::isGroupable(scan->getTupleId(), *plain)) {
+        return nullptr;
+    }
+    auto rel = std::make_unique<RamRelationReference>(&scan->getRelation());
+    if (dynamic_cast<const RamParallelScan*>(scan) != nullptr) {
+        return std::make_unique<RamParallelGroupAggregate>(
+                std::move(rel), scan->getTupleId(), std::move(plain));
+    }
+    return std::make_unique<RamGroupAggregate>(std::move(rel), scan->getTupleId(), std::move(plain));
+}
+
+bool GroupAggregateTransformer::makeGroupAggregates(RamProgram& program) {
+    // the relations of recursive strata are small deltas, which are searched for each tuple instead
+    std::set<const RamQuery*> recursive;
+    visitDepthFirst(program.getMain(), [&](const RamLoop& loop) {
+        visitDepthFirst(loop, [&](const RamQuery& query) { recursive.insert(&query); });
+    });
+
+    bool changed = false;
+    visitDepthFirst(program.getMain(), [&](const RamQuery& query) {
+        if (recursive.count(&query) > 0) {
+            return;
+        }
+        // the groups are computed before the scan, hence the aggregated relation is not inserted into
+        std::set<const RamRelation*> inserted;
+        visitDepthFirst(query, [&](const RamProject& project) { inserted.insert(&project.getRelation()); });
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> groupRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const RamScan* scan = dynamic_cast<RamScan*>(node.get())) {
+                bool aggregatesInserted = false;
+                visitDepthFirst(*scan, [&](const RamIndexAggregate& aggregate) {
+                    aggregatesInserted = aggregatesInserted || inserted.count(&aggregate.getRelation()) > 0;
+                });
+                if (aggregatesInserted) {
+                    return node;
+                }
+                std::unique_ptr<RamOperation> op = rewriteScan(scan);
+                if (op != nullptr) {
+                    changed = true;
+                    return op;
+                }
+                return node;
+            }
+            node->apply(makeLambdaRamMapper(groupRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(groupRewriter));
+    });
+    return changed;
+}
+
+std::unique_ptr<RamOperation> MergeJoinTransformer::rewriteScan(const RamScan* scan) {
+    if (dynamic_cast<const RamMergeJoin*>(scan) != nullptr || scan->getTupleId() != 0) {
+        return nullptr;
+    }
+    const auto* inner = dynamic_cast<const RamIndexScan*>(&scan->getOperation());
+    if (inner == nullptr) {
+        return nullptr;
+    }
+
+    // the column of the scanned tuple bound by the single bound column of the index scan
+    size_t column = 0;
+    for (const RamExpression* value : inner->getRangePattern()) {
+        if (const auto* element = dynamic_cast<const RamTupleElement*>(value)) {
+            column = element->getElement();
+        }
+    }
+    if (!RamMergeJoin::isMergeable(scan->getTupleId(), column, *inner)) {
+        return nullptr;
+    }
+
+    // both relations are ordered by b-tree indexes, and the order of the scanned relation is not
+    // introduced for the merge join only
+    const auto& isBTree = [](const RamRelation& rel) {
+        return rel.getArity() > 0 && (rel.getRepresentation() == RelationRepresentation::BTREE ||
+                                             (rel.getRepresentation() == RelationRepresentation::DEFAULT &&
+                                                     rel.getArity() <= 6));
+    };
+    if (!isBTree(scan->getRelation()) || !isBTree(inner->getRelation())) {
+        return nullptr;
+    }
+    const auto orders = isa->getIndexes(scan->getRelation()).getAllOrders();
+    if (std::none_of(orders.begin(), orders.end(), [&](const MinIndexSelection::LexOrder& order) {
+            return !order.empty() && order[0] == static_cast<int>(column);
+        })) {
+        return nullptr;
+    }
+
+    auto rel = std::make_unique<RamRelationReference>(&scan->getRelation());
+    auto nested = std::unique_ptr<RamOperation>(inner->clone());
+    if (dynamic_cast<const RamParallelScan*>(scan) != nullptr) {
+        return std::make_unique<RamParallelMergeJoin>(
+                std::move(rel), scan->getTupleId(), column, std::move(nested), scan->getProfileText());
+    }
+    return std::make_unique<RamMergeJoin>(
+            std::move(rel), scan->getTupleId(), column, std::move(nested), scan->getProfileText());
+}
+
+bool MergeJoinTransformer::makeMergeJoins(RamProgram& program) {
+    // the relations of recursive strata are small deltas, which are searched for each tuple instead
+    std::set<const RamQuery*> recursive;
+    visitDepthFirst(program.getMain(), [&](const RamLoop& loop) {
+        visitDepthFirst(loop, [&](const RamQuery& query) { recursive.insert(&query); });
+    });
+
+    bool changed = false;
+    visitDepthFirst(program.getMain(), [&](const RamQuery& query) {
+        if (recursive.count(&query) > 0) {
+            return;
+        }
+        // the merged relations are not inserted into while they are streamed
+        std::set<const RamRelation*> inserted;
+        visitDepthFirst(query, [&](const RamProject& project) { inserted.insert(&project.getRelation()); });
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> mergeRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const RamScan* scan = dynamic_cast<RamScan*>(node.get())) {
+                const auto* inner = dynamic_cast<const RamIndexScan*>(&scan->getOperation());
+                if (inner != nullptr && inserted.count(&scan->getRelation()) == 0 &&
+                        inserted.count(&inner->getRelation()) == 0) {
+                    if (std::unique_ptr<RamOperation> op = rewriteScan(scan)) {
+                        changed = true;
+                        return op;
+                    }
+                }
+                return node;
+            }
+            node->apply(makeLambdaRamMapper(mergeRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(mergeRewriter));
+    });
+    return changed;
+}
+
+bool LazyIndexTransformer::makeLazyIndexes(RamProgram& program) {
+    // the strata are the statements of the main sequence, possibly enclosed by the timer of the program
+    RamStatement* main = &program.getMain();
+    if (auto* timer = dynamic_cast<RamLogTimer*>(main)) {
+        main = const_cast<RamStatement*>(&timer->getStatement());
+    }
+    auto* sequence = dynamic_cast<RamSequence*>(main);
+    if (sequence == nullptr) {
+        return false;
+    }
+    std::vector<RamStatement*> strata = sequence->getStatements();
+
+    // relations whose indexes are all maintained throughout the program, where default relations of
+    // larger arities are not stored in b-trees by the synthesiser
+    std::set<const RamRelation*> excluded;
+    for (const RamRelation* rel : program.getRelations()) {
+        RelationRepresentation representation = rel->getRepresentation();
+        bool isBTree = representation == RelationRepresentation::BTREE ||
+                       (representation == RelationRepresentation::DEFAULT && rel->getArity() <= 6);
+        if (rel->isTemp() || rel->isNullary() || !isBTree) {
+            excluded.insert(rel);
+        }
+    }
+    for (const auto& sub : program.getSubroutines()) {
+        visitDepthFirst(*sub.second, [&](const RamRelationReference& ref) { excluded.insert(ref.get()); });
+    }
+    visitDepthFirst(program, [&](const RamBinRelationStatement& stmt) {
+        excluded.insert(&stmt.getFirstRelation());
+        excluded.insert(&stmt.getSecondRelation());
+    });
+
+    // the first and last stratum searching each index, and a search identifying the index
+    struct Liveness {
+        size_t first;
+        size_t last;
+        SearchSignature search;
+    };
+    std::map<std::pair<const RamRelation*, int>, Liveness> liveness;
+    for (size_t stratum = 0; stratum < strata.size(); stratum++) {
+        const auto& use = [&](const RamRelation& rel, SearchSignature search) {
+            if (search == 0) {
+                // searches without bound columns are not associated with an index
+                excluded.insert(&rel);
+                return;
+            }
+            int index = isa->getIndexes(rel).getLexOrderNum(search);
+            auto pos = liveness.find({&rel, index});
+            if (pos == liveness.end()) {
+                liveness.insert({{&rel, index}, {stratum, stratum, search}});
+            } else {
+                pos->second.last = stratum;
+            }
+        };
+        visitDepthFirst(*strata[stratum], [&](const RamNode& node) {
+            if (const auto* search = dynamic_cast<const RamIndexOperation*>(&node)) {
+                use(search->getRelation(), isa->getSearchSignature(search));
+            } else if (const auto* merge = dynamic_cast<const RamMergeJoin*>(&node)) {
+                use(merge->getRelation(), isa->getSearchSignature(merge));
+            } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
+                use(exists->getRelation(), isa->getSearchSignature(exists));
+            } else if (const auto* provExists = dynamic_cast<const RamProvenanceExistenceCheck*>(&node)) {
+                use(provExists->getRelation(), isa->getSearchSignature(provExists));
+            }
+        });
+    }
+
+    // the main index holds the tuples of a relation and is never dropped, and the indexes searched by
+    // a later stratum are dropped at the start of the program to be built from the tuples in bulk
+    auto lazy = std::make_unique<RamSequence>();
+    std::vector<std::vector<std::unique_ptr<RamStatement>>> builds(strata.size());
+    std::vector<std::vector<std::unique_ptr<RamStatement>>> drops(strata.size());
+    bool changed = false;
+    for (const auto& cur : liveness) {
+        const RamRelation* rel = cur.first.first;
+        if (cur.first.second == 0 || excluded.count(rel) > 0) {
+            continue;
+        }
+        const Liveness& live = cur.second;
+        const auto& ref = [&]() { return std::make_unique<RamRelationReference>(rel); };
+        if (live.first > 0) {
+            lazy->add(std::make_unique<RamDropIndex>(ref(), live.search));
+            builds[live.first].push_back(std::make_unique<RamBuildIndex>(ref(), live.search));
+        }
+        drops[live.last].push_back(std::make_unique<RamDropIndex>(ref(), live.search));
+        changed = true;
+    }
+    if (!changed) {
+        return false;
+    }
+
+    // the index statements enclose the strata, hence they are also evaluated for restored checkpoints
+    for (size_t stratum = 0; stratum < strata.size(); stratum++) {
+        for (auto& build : builds[stratum]) {
+            lazy->add(std::move(build));
+        }
+        lazy->add(std::unique_ptr<RamStatement>(strata[stratum]->clone()));
+        for (auto& drop : drops[stratum]) {
+            lazy->add(std::move(drop));
+        }
+    }
+    std::unique_ptr<RamStatement> replacement = std::move(lazy);
+    const auto& replace = [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+        if (node.get() == sequence) {
+            return std::move(replacement);
+        }
+        return node;
+    };
+    if (main == &program.getMain()) {
+        program.apply(makeLambdaRamMapper(replace));
+    } else {
+        program.getMain().apply(makeLambdaRamMapper(replace));
+    }
+    return true;
+}
+
+bool FreezeTransformer::freezeRelations(RamProgram& program) {
+    // the strata are the statements of the main sequence, possibly enclosed by the timer of the program
+    RamStatement* main = &program.getMain();
+    if (auto* timer = dynamic_cast<RamLogTimer*>(main)) {
+        main = const_cast<RamStatement*>(&timer->getStatement());
+    }
+    auto* sequence = dynamic_cast<RamSequence*>(main);
+    if (sequence == nullptr) {
+        return false;
+    }
+    std::vector<RamStatement*> strata = sequence->getStatements();
+
+    // relations which are not frozen, where default relations of larger arities are not stored in
+    // b-trees by the synthesiser, and relations with a choice domain keep their keys in another set
+    std::set<const RamRelation*> excluded;
+    for (const RamRelation* rel : program.getRelations()) {
+        RelationRepresentation representation = rel->getRepresentation();
+        bool isBTree = representation == RelationRepresentation::BTREE ||
+                       (representation == RelationRepresentation::DEFAULT && rel->getArity() <= 6);
+        if (rel->isTemp() || rel->isNullary() || !isBTree || !rel->getChoiceDomain().empty()) {
+            excluded.insert(rel);
+        }
+    }
+    for (const auto& sub : program.getSubroutines()) {
+        visitDepthFirst(*sub.second, [&](const RamRelationReference& ref) { excluded.insert(ref.get()); });
+    }
+
+    // the last stratum writing each relation, including the strata building its indexes, such that
+    // the indexes built lazily are packed as well
+    std::map<const RamRelation*, size_t> lastWrite;
+    for (size_t stratum = 0; stratum < strata.size(); stratum++) {
+        visitDepthFirst(*strata[stratum], [&](const RamNode& node) {
+            if (const auto* project = dynamic_cast<const RamProject*>(&node)) {
+                lastWrite[&project->getRelation()] = stratum;
+            } else if (const auto* load = dynamic_cast<const RamLoad*>(&node)) {
+                lastWrite[&load->getRelation()] = stratum;
+            } else if (const auto* build = dynamic_cast<const RamBuildIndex*>(&node)) {
+                lastWrite[&build->getRelation()] = stratum;
+            } else if (const auto* stmt = dynamic_cast<const RamBinRelationStatement*>(&node)) {
+                lastWrite[&stmt->getFirstRelation()] = stratum;
+                lastWrite[&stmt->getSecondRelation()] = stratum;
+            }
+        });
+    }
+
+    // a relation is frozen after the last stratum writing it if a later query reads it, whereas
+    // clearing it or writing it to an output does not benefit from packing its indexes
+    std::vector<std::set<const RamRelation*>> freezes(strata.size());
+    for (size_t stratum = 0; stratum < strata.size(); stratum++) {
+        visitDepthFirst(*strata[stratum], [&](const RamQuery& query) {
+            visitDepthFirst(query, [&](const RamRelationReference& ref) {
+                const RamRelation* rel = ref.get();
+                auto pos = lastWrite.find(rel);
+                if (pos != lastWrite.end() && pos->second < stratum && excluded.count(rel) == 0) {
+                    freezes[pos->second].insert(rel);
+                }
+            });
+        });
+    }
+    if (std::all_of(freezes.begin(), freezes.end(),
+                [](const std::set<const RamRelation*>& cur) { return cur.empty(); })) {
+        return false;
+    }
+
+    // the freezes follow the strata, hence they are also evaluated for restored checkpoints
+    auto frozen = std::make_unique<RamSequence>();
+    for (size_t stratum = 0; stratum < strata.size(); stratum++) {
+        frozen->add(std::unique_ptr<RamStatement>(strata[stratum]->clone()));
+        for (const RamRelation* rel : program.getRelations()) {
+            if (freezes[stratum].count(rel) > 0) {
+                frozen->add(std::make_unique<RamFreeze>(std::make_unique<RamRelationReference>(rel)));
+            }
+        }
+    }
+    std::unique_ptr<RamStatement> replacement = std::move(frozen);
+    const auto& replace = [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+        if (node.get() == sequence) {
+            return std::move(replacement);
+        }
+        return node;
+    };
+    if (main == &program.getMain()) {
+        program.apply(makeLambdaRamMapper(replace));
+    } else {
+        program.getMain().apply(makeLambdaRamMapper(replace));
+    }
+    return true;
+}
+
 }  // end of namespace souffle
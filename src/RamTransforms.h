@@ -26,6 +26,10 @@
 
 namespace souffle {
 
+namespace profile {
+class ProgramRun;
+}
+
 class RamProgram;
 
 /**
@@ -71,6 +75,70 @@ protected:
     }
 };
 
+/**
+ * @class FoldConstantsTransformer
+ * @brief Evaluates constant expressions and conditions at compile time.
+ *
+ * Intrinsic functors whose arguments are constants are replaced by their
+ * value, and constraints on constants by true or false. Filters that always
+ * hold are removed, and queries with a filter that never holds are dropped.
+ * The values of tuple elements bound by the equalities of an index search
+ * are replaced by the constants of its range pattern.
+ *
+ * For example ..
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A ON INDEX t0.0 = number(3)
+ *    IF (number(1)+number(2)) = t0.0
+ *     PROJECT (t0.0, t0.1) INTO B
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A ON INDEX t0.0 = number(3)
+ *    PROJECT (number(3), t0.1) INTO B
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ */
+class FoldConstantsTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "FoldConstantsTransformer";
+    }
+
+    /**
+     * @brief Evaluate an intrinsic functor whose arguments are constants
+     * @param op Intrinsic functor
+     * @return The constant value of the functor, or nullptr if it cannot be folded
+     *
+     * Functors on symbols and functors whose evaluation fails at runtime, e.g.
+     * divisions by zero, are not folded.
+     */
+    std::unique_ptr<RamExpression> foldFunctor(const RamIntrinsicOperator& op);
+
+    /**
+     * @brief Evaluate a numeric constraint whose operands are constants
+     * @param constraint Constraint
+     * @return RamTrue or RamFalse, or nullptr if the constraint cannot be folded
+     */
+    std::unique_ptr<RamCondition> foldConstraint(const RamConstraint& constraint);
+
+    /**
+     * @brief Fold constant expressions and conditions
+     * @param program Program that is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool foldConstants(RamProgram& program);
+
+protected:
+    bool transform(RamTranslationUnit& translationUnit) override {
+        return foldConstants(translationUnit.getProgram());
+    }
+};
+
 /**
  * @class ReorderConditionsTransformer
  * @brief Reorders conjunctive terms depending on cost, i.e.,
@@ -418,11 +486,13 @@ protected:
 
 /**
  * @class IfConversionTransformer
- * @brief Convert IndexScan operations to Filter/Existence Checks
+ * @brief Convert Scan/IndexScan operations to Filter/Existence Checks
 
- * If there exists IndexScan operations in the RAM, and their tuples
+ * If there exists Scan/IndexScan operations in the RAM, and their tuples
  * are not further used in subsequent operations, the IndexScan operations
- * will be rewritten to Filter/Existence Checks.
+ * will be rewritten to Filter/Existence Checks, and the Scan operations to
+ * Filters checking that their relation is not empty. The subsequent
+ * operations are thus evaluated once rather than once per matching tuple.
  *
  * For example,
  *
@@ -459,6 +529,16 @@ public:
      */
     std::unique_ptr<RamOperation> rewriteIndexScan(const RamIndexScan* indexScan);
 
+    /**
+     * @brief Rewrite Scan operations
+     * @param scan A scan operation
+     * @result The null pointer if the if-conversion fails; otherwise the filter/emptiness check
+     *
+     * Rewrites Scan operations to a filter/emptiness check if the Scan's tuple
+     * is not used in a consecutive RAM operation
+     */
+    std::unique_ptr<RamOperation> rewriteScan(const RamScan* scan);
+
     /**
      * @brief Apply if-conversion to the whole program
      * @param RAM program
@@ -480,10 +560,11 @@ protected:
  * (Choice)/(IndexChoice) operations
 
  * If there exists Scan/IndexScan operations in the RAM, and the
- * variables are used in a subsequent Filter operation but no
- * subsequent operation in the tree (up until and including
+ * variables are used in the subsequent Filter operations but no
+ * other subsequent operation in the tree (up until and including
  * the Project), the operations are rewritten to Choice/IndexChoice
- * operations.
+ * operations, which stop at the first tuple satisfying the conditions
+ * of the Filters.
  *
  * For example,
  *
@@ -547,6 +628,15 @@ protected:
         rla = translationUnit.getAnalysis<RamLevelAnalysis>();
         return convertScans(translationUnit.getProgram());
     }
+
+    /**
+     * @brief Collect the conditions of the Filters following a scan
+     * @param scan A Scan/IndexScan operation
+     * @param next Set to the operation following the Filters
+     * @result The conjunction of the conditions if they use the scan's tuple and the
+     *         following operations do not; otherwise the null pointer
+     */
+    std::unique_ptr<RamCondition> collectFilters(const RamRelationOperation* scan, const RamOperation*& next);
 };
 
 /**
@@ -623,9 +713,254 @@ protected:
     }
 };
 
+/**
+ * @class HoistInvariantJoinsTransformer
+ * @brief Materializes the joins of a fixpoint loop over relations the loop does not change before the loop
+ *
+ * A join of scans over relations that are not inserted into, merged or
+ * swapped by a loop yields the same tuples in each iteration. It is evaluated
+ * once into a temporary relation before the loop, and the loop probes the
+ * temporary relation on the columns bound by its other scans.
+ *
+ * For example ..
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  LOOP
+ *   QUERY
+ *    FOR t0 IN @delta_R
+ *     FOR t1 IN A ON INDEX t1.0 = t0.1
+ *      FOR t2 IN B ON INDEX t2.0 = t1.1
+ *       IF t2.1 != t0.0
+ *        PROJECT (t0.0, t2.1) INTO @new_R
+ *   ...
+ *  END LOOP
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON INDEX t1.0 = t0.1
+ *     PROJECT (t0.0, t0.1, t1.0, t1.1) INTO @invariant_0
+ *  LOOP
+ *   QUERY
+ *    FOR t0 IN @delta_R
+ *     FOR t1 IN @invariant_0 ON INDEX t1.0 = t0.1
+ *      IF t1.3 != t0.0
+ *       PROJECT (t0.0, t1.3) INTO @new_R
+ *   ...
+ *  END LOOP
+ *  CLEAR @invariant_0
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Only joins are materialized, i.e. each scan after the first one of the
+ * fragment is searched on a column bound by the fragment, such that no cross
+ * products are stored. As a join may still be much larger than the tuples
+ * the loop probes, the transformer is only applied on request.
+ */
+class HoistInvariantJoinsTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "HoistInvariantJoinsTransformer";
+    }
+
+    /**
+     * @brief Materialize the loop-invariant joins of the fixpoint loops of the main program
+     * @param program Program that is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool hoistInvariantJoins(RamProgram& program);
+
+protected:
+    bool transform(RamTranslationUnit& translationUnit) override {
+        return hoistInvariantJoins(translationUnit.getProgram());
+    }
+};
+
+/**
+ * @class EqrelJoinTransformer
+ * @brief Joins the scans of equivalence relations on the elements of their classes instead of their pairs
+ *
+ * A scan of an equivalence relation enumerates all k * k pairs of a class of
+ * k elements, and the operations nested in it are evaluated for each pair. If
+ * the operations following the scan only read one column of the pairs, they
+ * are evaluated once for each element of a class, i.e. for the pairs (y, y),
+ * and the class of the element is only expanded by an index scan of the
+ * relation where the other column is read. The operations reading only the
+ * joined column are thus evaluated k times instead of k * k times per class,
+ * and the expansion is dropped if the other column is not read at all.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN eq
+ *    FOR t1 IN r ON INDEX t1.0 = t0.1
+ *     PROJECT (t0.0, t1.1) INTO q
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN eq
+ *    IF (t0.0 = t0.1)
+ *     FOR t1 IN r ON INDEX t1.0 = t0.1
+ *      FOR t2 IN eq ON INDEX t2.0 = t0.1
+ *       PROJECT (t2.1, t1.1) INTO q
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Since the relation holds (y, y) and (y, x) for each pair (x, y), the pairs
+ * bound by the rewritten operations are the same.
+ */
+class EqrelJoinTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "EqrelJoinTransformer";
+    }
+
+    /**
+     * @brief Rewrite a scan of an equivalence relation to a scan of the elements of its classes
+     * @param scan Scan of an equivalence relation
+     * @param ident Unused tuple identifier of the query, identifying the expansion of the classes
+     * @return The rewritten scan, or null if the operations nested in the scan read both columns
+     *         right away
+     */
+    std::unique_ptr<RamOperation> rewriteScan(const RamScan& scan, int ident);
+
+    /**
+     * @brief Rewrite the scans of equivalence relations of the program
+     * @param program Program that is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool joinClasses(RamProgram& program);
+
+protected:
+    bool transform(RamTranslationUnit& translationUnit) override {
+        return joinClasses(translationUnit.getProgram());
+    }
+};
+
+/**
+ * @class LeapfrogJoinTransformer
+ * @brief Intersects index scans with existence checks on their free column by leapfrog joins.
+ *
+ * An index scan binding all but one column, that is immediately followed by
+ * existence checks matching the free column against the single unbound value
+ * of relations of the same representation, is rewritten to a leapfrog join.
+ * Cyclic bodies such as triangles thus skip the tuples of the scan that are
+ * not matched rather than testing each of them.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON INDEX t1.x = t0.1
+ *     IF (t0.0,t1.1) ∈ C /\ D
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    LEAPFROG t1 IN B ON INDEX t1.x = t0.1 WITH (t0.0,_) ∈ C
+ *     IF D
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * The outermost loop is kept as it is, such that it may be parallelized.
+ */
+class LeapfrogJoinTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "LeapfrogJoinTransformer";
+    }
+
+    /**
+     * @brief Rewrite a scan to a leapfrog join
+     * @param Scan or index scan binding all but one column
+     * @result The result is null if there are no checks to intersect the scan with;
+     *         otherwise the leapfrog join is returned.
+     */
+    std::unique_ptr<RamOperation> rewriteScan(const RamRelationOperation* scan);
+
+    /**
+     * @brief Rewrite scans followed by existence checks on their free column to leapfrog joins
+     * @param RAM program that is transformed
+     * @result Flag that indicates whether the input program has changed
+     */
+    bool makeLeapfrogJoins(RamProgram& program);
+
+protected:
+    RamLevelAnalysis* rla{nullptr};
+    bool transform(RamTranslationUnit& translationUnit) override {
+        rla = translationUnit.getAnalysis<RamLevelAnalysis>();
+        return makeLeapfrogJoins(translationUnit.getProgram());
+    }
+};
+
+/**
+ * @class ProfileGuidedIndexTransformer
+ * @brief Serves infrequent searches by an index of a prefix of their columns.
+ *
+ * The searches of a relation are weighted by their number of executions in a
+ * previous profile of the program. A search that would require an index of its
+ * own is rewritten to search a shorter prefix of its columns and to check the
+ * other columns in a filter, if the additionally scanned tuples are expected to
+ * cost less than maintaining the index (see MinIndexSelection::reduceSearches).
+ *
+ * For example ..
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON INDEX t1.x = t0.0 AND t1.z = t0.1
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON INDEX t1.x = t0.0
+ *     IF t1.z = t0.1
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * if the search on x and z is rare and x is the prefix of a more frequent search.
+ */
+class ProfileGuidedIndexTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "ProfileGuidedIndexTransformer";
+    }
+
+    /**
+     * @brief Rewrite an index operation to search a prefix of its columns only
+     * @param Index operation that is rewritten
+     * @param Prefix of the columns of the search
+     * @result The result is null if the operation cannot be rewritten;
+     *         otherwise the operation searching the prefix and checking the other columns is returned.
+     */
+    std::unique_ptr<RamOperation> rewriteSearch(const RamIndexOperation* search, SearchSignature prefix);
+
+    /**
+     * @brief Serve the infrequent searches of the relations by prefixes of their columns
+     * @param RAM program that is transformed
+     * @param Profile of a previous run of the program
+     * @result Flag that indicates whether the input program has changed
+     */
+    bool reduceSearches(RamProgram& program, const profile::ProgramRun& run);
+
+protected:
+    RamIndexAnalysis* isa{nullptr};
+    bool transform(RamTranslationUnit& translationUnit) override;
+};
+
 /**
  * @class ParallelTransformer
- * @brief Transforms Choice/IndexChoice/IndexScan/Scan into parallel versions.
+ * @brief Transforms Choice/IndexChoice/IndexScan/Scan/Aggregate/IndexAggregate into parallel versions.
  *
  * For example ..
  *
@@ -663,6 +998,297 @@ protected:
     }
 };
 
+/**
+ * @class HashJoinTransformer
+ * @brief Joins the outermost scans of queries with the index scans nested in them by transient hash
+ * tables, if the indexes of the searches would be maintained for these joins only.
+ *
+ * The outermost scan of a query outside of loops, whose nested index scan
+ * binds columns to elements of the scanned tuple or to constants only, is
+ * rewritten to a hash join if no other operation of the program searches the
+ * nested relation by these columns, and dropping the search saves an index of
+ * the relation. The keys of the search are checked by a filter of a plain scan
+ * instead, such that the hash table built on the smaller relation at the start
+ * of the join replaces an index that would be maintained forever.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON INDEX t1.0 = t0.1
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   HASH t0 IN A
+ *    FOR t1 IN B
+ *     IF (t1.0 = t0.1)
+ *      ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Parallel scans are rewritten to parallel hash joins, which probe the hash
+ * table by the tuples of the larger relation in parallel.
+ */
+class HashJoinTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "HashJoinTransformer";
+    }
+
+    /**
+     * @brief Rewrite a scan to a hash join
+     * @param Outermost scan of a query
+     * @result The result is null if the scan cannot be joined with its nested operation by a hash
+     *         table; otherwise the hash join is returned.
+     */
+    std::unique_ptr<RamOperation> rewriteScan(const RamScan* scan);
+
+    /**
+     * @brief Rewrite the outermost scans of the queries outside of loops to hash joins, where the
+     * indexes of their nested searches are not needed otherwise
+     * @param RAM program that is transformed
+     * @result Flag that indicates whether the input program has changed
+     */
+    bool makeHashJoins(RamProgram& program);
+
+protected:
+    RamIndexAnalysis* isa{nullptr};
+    bool transform(RamTranslationUnit& translationUnit) override {
+        isa = translationUnit.getAnalysis<RamIndexAnalysis>();
+        return makeHashJoins(translationUnit.getProgram());
+    }
+};
+
+/**
+ * @class GroupAggregateTransformer
+ * @brief Computes the aggregates nested in the outermost scans of queries for all groups at once,
+ * if the scans enumerate the keys of the groups.
+ *
+ * The outermost scan of a query outside of loops, whose nested aggregation
+ * searches an index by all elements of the scanned tuple, each bound to one
+ * column, and by constants otherwise, is rewritten to a group aggregate,
+ * provided the condition and the target expression of the aggregation do not
+ * refer to the scanned tuple. The keys of the search are checked by the
+ * condition of a plain aggregation instead. Filters between the scan and the
+ * aggregation only depend on the scanned tuple, and are moved below the
+ * aggregation.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    t1.0=COUNT SEARCH t1 ∈ B ON INDEX t1.0 = t0.0
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   GROUP t0 IN A
+ *    t1.0=COUNT FOR ALL t1 ∈ B WHERE (t1.0 = t0.0)
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Parallel scans are rewritten to parallel group aggregates.
+ */
+class GroupAggregateTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "GroupAggregateTransformer";
+    }
+
+    /**
+     * @brief Rewrite a scan to a group aggregate
+     * @param Outermost scan of a query
+     * @result The result is null if the aggregation nested in the scan cannot be computed for all
+     *         groups at once; otherwise the group aggregate is returned.
+     */
+    std::unique_ptr<RamOperation> rewriteScan(const RamScan* scan);
+
+    /**
+     * @brief Rewrite the outermost scans of the queries outside of loops to group aggregates
+     * @param RAM program that is transformed
+     * @result Flag that indicates whether the input program has changed
+     */
+    bool makeGroupAggregates(RamProgram& program);
+
+protected:
+    bool transform(RamTranslationUnit& translationUnit) override {
+        return makeGroupAggregates(translationUnit.getProgram());
+    }
+};
+
+/**
+ * @class MergeJoinTransformer
+ * @brief Merges the outermost scans of queries with the index scans nested in them.
+ *
+ * The outermost scan of a query outside of loops, whose nested index scan
+ * binds a single column to a column of the scanned tuple, is rewritten to a
+ * merge join if the scanned relation already has an index ordered by that
+ * column. Both relations are then streamed in the order of the joined
+ * columns, rather than descending into the index of the inner relation for
+ * each tuple of the large outer relation.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON INDEX t1.0 = t0.1
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   MERGE t0 IN A ON INDEX t0.1
+ *    FOR t1 IN B ON INDEX t1.0 = t0.1
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Parallel scans are rewritten to parallel merge joins, which merge disjoint
+ * chunks of the ordered outer relation in parallel.
+ */
+class MergeJoinTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "MergeJoinTransformer";
+    }
+
+    /**
+     * @brief Rewrite a scan to a merge join
+     * @param Outermost scan of a query
+     * @result The result is null if the scan cannot be merged with its nested operation;
+     *         otherwise the merge join is returned.
+     */
+    std::unique_ptr<RamOperation> rewriteScan(const RamScan* scan);
+
+    /**
+     * @brief Rewrite the outermost scans of the queries outside of loops to merge joins
+     * @param RAM program that is transformed
+     * @result Flag that indicates whether the input program has changed
+     */
+    bool makeMergeJoins(RamProgram& program);
+
+protected:
+    RamIndexAnalysis* isa{nullptr};
+    bool transform(RamTranslationUnit& translationUnit) override {
+        isa = translationUnit.getAnalysis<RamIndexAnalysis>();
+        return makeMergeJoins(translationUnit.getProgram());
+    }
+};
+
+/**
+ * @class LazyIndexTransformer
+ * @brief Maintains the secondary indexes of a relation only in the strata using them.
+ *
+ * The strata of the main program are evaluated in the order of the relation
+ * schedule. A secondary index of a relation is dropped at the start of the
+ * program, built from the tuples of the relation right before the first
+ * stratum searching it, and dropped again after the last stratum searching it,
+ * such that the insertions outside of these strata do not maintain it.
+ *
+ * For example ..
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  LOAD DATA FOR A FROM {...}
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN A ON INDEX t1.1 = t0.0
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  DROP_INDEX A ON (1)
+ *  LOAD DATA FOR A FROM {...}
+ *  BUILD_INDEX A ON (1)
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN A ON INDEX t1.1 = t0.0
+ *     ...
+ *  DROP_INDEX A ON (1)
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * if the load and the query are separate strata. Relations used by
+ * subroutines, temporary relations and relations which are not stored in
+ * b-trees keep all their indexes.
+ */
+class LazyIndexTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "LazyIndexTransformer";
+    }
+
+    /**
+     * @brief Build and drop the secondary indexes around the strata using them
+     * @param program Program that is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool makeLazyIndexes(RamProgram& program);
+
+protected:
+    RamIndexAnalysis* isa{nullptr};
+    bool transform(RamTranslationUnit& translationUnit) override {
+        isa = translationUnit.getAnalysis<RamIndexAnalysis>();
+        return makeLazyIndexes(translationUnit.getProgram());
+    }
+};
+
+/**
+ * @class FreezeTransformer
+ * @brief Packs the indexes of a relation once the strata writing it are evaluated.
+ *
+ * The strata of the main program are evaluated in the order of the relation
+ * schedule. A relation which is read by a stratum after the last stratum
+ * writing it is frozen right after that stratum, i.e., its b-tree indexes are
+ * rebuilt from full nodes which are allocated adjacently, such that the reads
+ * of the later strata touch less and consecutive memory.
+ *
+ * For example ..
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  LOAD DATA FOR A FROM {...}
+ *  QUERY
+ *   FOR t0 IN A
+ *    ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  LOAD DATA FOR A FROM {...}
+ *  FREEZE A
+ *  QUERY
+ *   FOR t0 IN A
+ *    ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * if the load and the query are separate strata. Relations used by
+ * subroutines, temporary relations and relations which are not stored in
+ * b-trees are not frozen.
+ */
+class FreezeTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "FreezeTransformer";
+    }
+
+    /**
+     * @brief Freeze the relations after the last strata writing them
+     * @param program Program that is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool freezeRelations(RamProgram& program);
+
+protected:
+    bool transform(RamTranslationUnit& translationUnit) override {
+        return freezeRelations(translationUnit.getProgram());
+    }
+};
+
 /**
  * @class ReportIndexSetsTransformer
  * @brief does not transform the program but reports on the index sets
@@ -33,6 +33,11 @@ inline bool isRamTrue(const RamCondition* cond) {
     return nullptr != dynamic_cast<const RamTrue*>(cond);
 }
 
+/** @brief Determines if a condition represents false */
+inline bool isRamFalse(const RamCondition* cond) {
+    return nullptr != dynamic_cast<const RamFalse*>(cond);
+}
+
 /**
  * @brief Convert terms of a conjunction to a list
  * @param conds A RAM condition
@@ -109,15 +109,24 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Project);
         FORWARD(SubroutineReturnValue);
         FORWARD(UnpackRecord);
+        FORWARD(ParallelMergeJoin);
+        FORWARD(MergeJoin);
+        FORWARD(ParallelHashJoin);
+        FORWARD(HashJoin);
+        FORWARD(ParallelGroupAggregate);
+        FORWARD(GroupAggregate);
         FORWARD(ParallelScan);
         FORWARD(Scan);
         FORWARD(ParallelIndexScan);
         FORWARD(IndexScan);
+        FORWARD(LeapfrogJoin);
         FORWARD(ParallelChoice);
         FORWARD(Choice);
         FORWARD(ParallelIndexChoice);
         FORWARD(IndexChoice);
+        FORWARD(ParallelAggregate);
         FORWARD(Aggregate);
+        FORWARD(ParallelIndexAggregate);
         FORWARD(IndexAggregate);
 
         // Statements
@@ -125,7 +134,12 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Store);
         FORWARD(Query);
         FORWARD(Clear);
+        FORWARD(Freeze);
+        FORWARD(BuildIndex);
+        FORWARD(DropIndex);
         FORWARD(LogSize);
+        FORWARD(LogStatistics);
+        FORWARD(LogMemory);
 
         FORWARD(Swap);
         FORWARD(Extend);
@@ -135,10 +149,13 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Sequence);
         FORWARD(Loop);
         FORWARD(Parallel);
+        FORWARD(Schedule);
+        FORWARD(AdaptiveQuery);
         FORWARD(Exit);
         FORWARD(LogTimer);
         FORWARD(LogRelationTimer);
         FORWARD(DebugInfo);
+        FORWARD(Checkpoint);
 
 #undef FORWARD
 
@@ -165,7 +182,13 @@ protected:
     LINK(AbstractLoadStore, RelationStatement);
     LINK(Query, Statement);
     LINK(Clear, RelationStatement);
+    LINK(Freeze, RelationStatement);
+    LINK(BuildIndex, AbstractIndexStatement);
+    LINK(DropIndex, AbstractIndexStatement);
+    LINK(AbstractIndexStatement, RelationStatement);
     LINK(LogSize, RelationStatement);
+    LINK(LogStatistics, RelationStatement);
+    LINK(LogMemory, Statement);
 
     LINK(RelationStatement, Statement);
 
@@ -176,11 +199,14 @@ protected:
     LINK(Sequence, ListStatement);
     LINK(Loop, Statement);
     LINK(Parallel, ListStatement);
+    LINK(Schedule, ListStatement);
+    LINK(AdaptiveQuery, ListStatement);
     LINK(ListStatement, Statement);
     LINK(Exit, Statement);
     LINK(LogTimer, Statement);
     LINK(LogRelationTimer, Statement);
     LINK(DebugInfo, Statement);
+    LINK(Checkpoint, Statement);
 
     LINK(Statement, Node);
 
@@ -192,13 +218,22 @@ protected:
     LINK(ParallelScan, Scan);
     LINK(IndexScan, IndexOperation);
     LINK(ParallelIndexScan, IndexScan);
+    LINK(LeapfrogJoin, IndexOperation);
+    LINK(MergeJoin, Scan);
+    LINK(ParallelMergeJoin, MergeJoin);
+    LINK(HashJoin, Scan);
+    LINK(ParallelHashJoin, HashJoin);
+    LINK(GroupAggregate, Scan);
+    LINK(ParallelGroupAggregate, GroupAggregate);
     LINK(Choice, RelationOperation);
     LINK(ParallelChoice, Choice);
     LINK(IndexChoice, IndexOperation);
     LINK(ParallelIndexChoice, IndexChoice);
     LINK(RelationOperation, TupleOperation);
     LINK(Aggregate, RelationOperation);
+    LINK(ParallelAggregate, Aggregate);
     LINK(IndexAggregate, IndexOperation);
+    LINK(ParallelIndexAggregate, IndexAggregate);
     LINK(IndexOperation, RelationOperation);
     LINK(TupleOperation, NestedOperation);
     LINK(Filter, AbstractConditional);
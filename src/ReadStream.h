@@ -15,25 +15,59 @@
 #pragma once
 
 #include "IODirectives.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "RecordTable.h"
 #include "SymbolTable.h"
 #include "Util.h"
 #include "json11.h"
+#include <algorithm>
 #include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace souffle {
 
 using json11::Json;
 
+namespace detail {
+
+/**
+ * A type trait to check whether a relation supports the insertion of many tuples at once.
+ * In this general case, tuples are inserted one by one.
+ */
+template <typename T, typename filter = void>
+struct has_insert_bulk : public std::false_type {};
+
+/**
+ * A type trait to check whether a relation supports the insertion of many tuples at once.
+ * This specialization covers relations providing insertBulk(tuples, count, stride).
+ */
+template <typename T>
+struct has_insert_bulk<T, typename std::conditional<false,
+                                  decltype(std::declval<T&>().insertBulk(
+                                          std::declval<const RamDomain*>(), std::size_t(), std::size_t())),
+                                  void>::type> : public std::true_type {};
+}  // namespace detail
+
 class ReadStream {
 protected:
     ReadStream(const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable)
-            : symbolTable(symbolTable), recordTable(recordTable) {
+            : symbolTable(symbolTable), recordTable(recordTable),
+              streamed(ioDirectives.has("stream") && ioDirectives.get("stream") == "true"),
+              sampleRate(ioDirectives.getSampleRate()) {
         const std::string& relationName{ioDirectives.getRelationName()};
+        sampleSeed = std::hash<std::string>()(relationName);
 
         std::string parseErrors;
 
@@ -51,19 +85,179 @@ protected:
     }
 
 public:
+    /**
+     * Read all tuples into the given relation.
+     *
+     * Relations supporting bulk insertion receive all tuples at once, such that their indexes
+     * can be sorted and bulk-loaded rather than built by individual insertions.
+     */
     template <typename T>
     void readAll(T& relation) {
-        auto lease = symbolTable.acquireLock();
-        (void)lease;
-        while (const auto next = readNextTuple()) {
-            const RamDomain* ramDomain = next.get();
-            relation.insert(ramDomain);
+        const size_t width = arity + auxiliaryArity;
+        if (streamed) {
+            readStreamed(relation, width);
+            return;
+        }
+        std::vector<RamDomain> buffer;
+        if constexpr (detail::has_insert_bulk<T>::value) {
+            if (width > 0) {
+                std::vector<RamDomain> tuples;
+                size_t numTuples = 0;
+                while (const size_t count = readSampledTuples(buffer)) {
+                    tuples.insert(tuples.end(), buffer.begin(), buffer.begin() + count * width);
+                    numTuples += count;
+                }
+                relation.insertBulk(tuples.data(), numTuples, width);
+                return;
+            }
+        }
+        while (const size_t count = readSampledTuples(buffer)) {
+            for (size_t i = 0; i < count; ++i) {
+                relation.insert(&buffer[i * width]);
+            }
         }
     }
 
     virtual ~ReadStream() = default;
 
 protected:
+    /** Maximal number of batches read ahead of their insertion by a streamed input */
+    static constexpr size_t STREAM_BATCHES = 4;
+
+    /**
+     * Read the tuples of a streamed input (stream=true) by a task of the task pool, and insert them
+     * batch by batch while the next batches are read.
+     *
+     * Reading a pipe thus overlaps with building the indexes of the relation, and at most
+     * STREAM_BATCHES batches are held in memory besides the relation.
+     */
+    template <typename T>
+    void readStreamed(T& relation, size_t width) {
+        std::mutex lock;
+        std::condition_variable changed;
+        std::deque<std::pair<std::vector<RamDomain>, size_t>> batches;
+        bool done = false;
+        bool cancelled = false;
+        std::exception_ptr error;
+
+        // reading a pipe may last as long as the evaluation, hence the reader is a service
+        auto reader = TaskPool::instance().submitService([&]() {
+            try {
+                std::vector<RamDomain> buffer;
+                while (const size_t count = readSampledTuples(buffer)) {
+                    std::unique_lock<std::mutex> guard(lock);
+                    changed.wait(guard, [&]() { return batches.size() < STREAM_BATCHES || cancelled; });
+                    if (cancelled) {
+                        break;
+                    }
+                    batches.emplace_back(std::move(buffer), count);
+                    buffer = std::vector<RamDomain>();
+                    changed.notify_all();
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            done = true;
+            changed.notify_all();
+        });
+
+        try {
+            for (;;) {
+                std::pair<std::vector<RamDomain>, size_t> batch;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    changed.wait(guard, [&]() { return !batches.empty() || done; });
+                    if (batches.empty()) {
+                        break;
+                    }
+                    batch = std::move(batches.front());
+                    batches.pop_front();
+                    changed.notify_all();
+                }
+                insertBatch(relation, batch.first.data(), batch.second, width);
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                cancelled = true;
+                changed.notify_all();
+            }
+            reader.wait();
+            throw;
+        }
+        reader.wait();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * Read the next batch of tuples like readNextTuples(), keeping only those of the sample of the input
+     * if it is sampled (sample=RATE).
+     *
+     * A tuple belongs to the sample if a hash of its values and of the name of the relation falls below
+     * the rate, hashing the text of symbols rather than their indices. The sample is hence the same for
+     * each load, and contains the samples of lower rates, such that the runs of a program on samples of
+     * several rates can be compared.
+     */
+    size_t readSampledTuples(std::vector<RamDomain>& buffer) {
+        const size_t width = arity + auxiliaryArity;
+        while (const size_t count = readNextTuples(buffer)) {
+            if (sampleRate >= 1 || width == 0) {
+                return count;
+            }
+            size_t kept = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (!isSampled(&buffer[i * width])) {
+                    continue;
+                }
+                if (kept < i) {
+                    std::copy(&buffer[i * width], &buffer[i * width] + width, &buffer[kept * width]);
+                }
+                ++kept;
+            }
+            if (kept > 0) {
+                return kept;
+            }
+        }
+        return 0;
+    }
+
+    /** Whether a tuple belongs to the sample of the input */
+    bool isSampled(const RamDomain* tuple) const {
+        uint64_t h = sampleSeed;
+        for (size_t i = 0; i < arity; ++i) {
+            uint64_t value = static_cast<uint64_t>(static_cast<RamUnsigned>(tuple[i]));
+            if (typeAttributes[i][0] == 's') {
+                value = std::hash<std::string>()(symbolTable.resolve(tuple[i]));
+            }
+            h ^= value + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        }
+        // the finaliser of MurmurHash3, such that all bits of the hash depend on all values
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return static_cast<double>(h >> 11) * 0x1.0p-53 < sampleRate;
+    }
+
+    /** Insert a batch of tuples, each occupying width consecutive values, into the given relation */
+    template <typename T>
+    void insertBatch(T& relation, const RamDomain* tuples, size_t count, size_t width) {
+        if constexpr (detail::has_insert_bulk<T>::value) {
+            if (width > 0) {
+                relation.insertBulk(tuples, count, width);
+                return;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            relation.insert(tuples + i * width);
+        }
+    }
+
     /**
      * Read a record from a string.
      *
@@ -113,13 +307,15 @@ protected:
                     recordValues[i] = readStringInRecord(source, pos, &consumed);
                     break;
                 case 'i':
-                    recordValues[i] = RamDomainFromString(source.substr(pos), &consumed);
+                    recordValues[i] = RamDomainFromChars(readNumberInRecord(source, pos, &consumed));
                     break;
                 case 'u':
-                    recordValues[i] = ramBitCast(RamUnsignedFromString(source.substr(pos), &consumed));
+                    recordValues[i] =
+                            ramBitCast(RamUnsignedFromChars(readNumberInRecord(source, pos, &consumed)));
                     break;
                 case 'f':
-                    recordValues[i] = ramBitCast(RamFloatFromString(source.substr(pos), &consumed));
+                    recordValues[i] =
+                            ramBitCast(RamFloatFromChars(readNumberInRecord(source, pos, &consumed)));
                     break;
                 case 'r':
                     recordValues[i] = readRecord(source, recordType, pos, &consumed);
@@ -148,7 +344,19 @@ protected:
         *_consumed = endOfSymbol - pos;
         std::string str = source.substr(pos, *_consumed);
 
-        return symbolTable.unsafeLookup(str);
+        return symbolTable.lookup(str);
+    }
+
+    /** The characters of a number in a record, up to the next ',' or ']' or whitespace */
+    std::string_view readNumberInRecord(const std::string& source, const size_t pos, size_t* _consumed) {
+        size_t endOfNumber = source.find_first_of(",] \t\r\n", pos);
+
+        if (endOfNumber == std::string::npos) {
+            throw std::invalid_argument("Unexpected end of input in record");
+        }
+
+        *_consumed = endOfNumber - pos;
+        return std::string_view(source).substr(pos, *_consumed);
     }
 
     /**
@@ -179,12 +387,36 @@ protected:
     Json types;
 
     virtual std::unique_ptr<RamDomain[]> readNextTuple() = 0;
+
+    /**
+     * Read the next batch of tuples into the given buffer, each tuple occupying
+     * arity + auxiliaryArity consecutive values (auxiliary values are zero).
+     *
+     * Returns the number of tuples read, and zero if no tuple was readable. Streams which
+     * can decode many tuples at once override this to avoid a heap allocation per tuple.
+     */
+    virtual size_t readNextTuples(std::vector<RamDomain>& buffer) {
+        const auto next = readNextTuple();
+        if (next == nullptr) {
+            return 0;
+        }
+        buffer.assign(std::max<size_t>(arity + auxiliaryArity, 1), 0);
+        std::copy(next.get(), next.get() + arity, buffer.begin());
+        return 1;
+    }
     std::vector<std::string> typeAttributes;
     SymbolTable& symbolTable;
     RecordTable& recordTable;
 
     size_t arity;
     size_t auxiliaryArity;
+
+    /** Whether the tuples are inserted while they are read (stream=true) */
+    const bool streamed;
+
+    /** The fraction of the tuples kept (sample=RATE), and the seed of the hash selecting them */
+    const double sampleRate;
+    uint64_t sampleSeed;
 };
 
 class ReadStreamFactory {
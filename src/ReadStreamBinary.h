@@ -0,0 +1,275 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamBinary.h
+ *
+ * Reads binary fact files (see IOBinaryFormat.h) by memory-mapping them, from files or
+ * shared memory.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "IOBinaryFormat.h"
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include "ReadStream.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "Util.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace souffle {
+
+class ReadFileBinary : public ReadStream {
+public:
+    ReadFileBinary(const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable)
+            : ReadFileBinary(ioDirectives, symbolTable, recordTable,
+                      open(getFileName(ioDirectives).c_str(), O_RDONLY),
+                      souffle::baseName(getFileName(ioDirectives))) {}
+
+    ~ReadFileBinary() override {
+        if (data != nullptr) {
+            munmap(data, size);
+        }
+    }
+
+protected:
+    /** Map the facts of the given open descriptor, which is closed; a negative descriptor failed to open */
+    ReadFileBinary(const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable,
+            int fd, std::string name)
+            : ReadStream(ioDirectives, symbolTable, recordTable), baseName(std::move(name)) {
+        for (const auto& type : typeAttributes) {
+            if (type[0] == 'r') {
+                if (fd >= 0) {
+                    close(fd);
+                }
+                throw std::invalid_argument("Binary IO does not support records in fact file " + baseName);
+            }
+            isSymbol.push_back(type[0] == 's');
+        }
+
+        if (fd < 0) {
+            if (ioDirectives.has("intermediate")) {
+                return;
+            }
+            throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
+        }
+        size = static_cast<size_t>(info.st_size);
+        if (size > 0) {
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (data == MAP_FAILED) {
+            data = nullptr;
+            throw std::invalid_argument("Cannot map fact file " + baseName + "\n");
+        }
+
+        try {
+            parse();
+        } catch (std::exception& e) {
+            munmap(data, size);
+            throw std::invalid_argument(std::string(e.what()) + "cannot parse fact file " + baseName + "!\n");
+        }
+    }
+
+    /** Number of tuples decoded at once by readNextTuples */
+    static constexpr size_t BATCH_SIZE = 4096;
+
+    /**
+     * Read and return the next tuple.
+     *
+     * Returns nullptr if no tuple was readable.
+     * @return
+     */
+    std::unique_ptr<RamDomain[]> readNextTuple() override {
+        if (next >= numTuples) {
+            return nullptr;
+        }
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(arity + auxiliaryArity);
+        for (size_t column = 0; column < arity; ++column) {
+            tuple[column] = decode(column, next);
+        }
+        ++next;
+        return tuple;
+    }
+
+    size_t readNextTuples(std::vector<RamDomain>& buffer) override {
+        const size_t count = std::min<size_t>(BATCH_SIZE, numTuples - next);
+        if (count == 0) {
+            return 0;
+        }
+        const size_t width = std::max<size_t>(arity + auxiliaryArity, 1);
+        buffer.assign(count * width, 0);
+
+        // copy column by column, such that each column is read sequentially
+        for (size_t column = 0; column < arity; ++column) {
+            const RamDomain* values = columns + column * numTuples + next;
+            if (isSymbol[column]) {
+                for (size_t i = 0; i < count; ++i) {
+                    buffer[i * width + column] = resolveSymbol(values[i]);
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    buffer[i * width + column] = values[i];
+                }
+            }
+        }
+        next += count;
+        return count;
+    }
+
+    /** Decode the value of the given column of the given tuple */
+    RamDomain decode(size_t column, size_t tuple) const {
+        const RamDomain value = columns[column * numTuples + tuple];
+        return isSymbol[column] ? resolveSymbol(value) : value;
+    }
+
+    /** Map an index of the file's symbol sub-table to the index in the symbol table */
+    RamDomain resolveSymbol(RamDomain value) const {
+        const auto pos = static_cast<size_t>(value);
+        if (pos >= symbols.size()) {
+            throw std::invalid_argument("Invalid symbol index in fact file " + baseName + "\n");
+        }
+        return symbols[pos];
+    }
+
+    /** Check the header and intern the symbol sub-table */
+    void parse() {
+        const auto* bytes = static_cast<const char*>(data);
+        if (size < sizeof(BinaryFactsHeader)) {
+            throw std::invalid_argument("Truncated header; ");
+        }
+        BinaryFactsHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (!header.isValid()) {
+            throw std::invalid_argument("Not a binary fact file of this build; ");
+        }
+        if (header.arity != arity) {
+            throw std::invalid_argument("Fact file has arity " + std::to_string(header.arity) +
+                                        ", expected " + std::to_string(arity) + "; ");
+        }
+
+        uint64_t offset = sizeof(header);
+        symbols.reserve(header.numSymbols);
+        for (uint64_t i = 0; i < header.numSymbols; ++i) {
+            uint64_t length;
+            if (size < offset + sizeof(length)) {
+                throw std::invalid_argument("Truncated symbol table; ");
+            }
+            std::memcpy(&length, bytes + offset, sizeof(length));
+            offset += sizeof(length);
+            if (size < offset + length) {
+                throw std::invalid_argument("Truncated symbol table; ");
+            }
+            symbols.push_back(symbolTable.lookup(std::string(bytes + offset, length)));
+            offset += length;
+        }
+
+        offset = alignBinaryFactsOffset(offset);
+        if (size < offset + header.arity * header.numTuples * sizeof(RamDomain)) {
+            throw std::invalid_argument("Truncated tuple data; ");
+        }
+        columns = reinterpret_cast<const RamDomain*>(bytes + offset);
+        numTuples = header.numTuples;
+    }
+
+    static std::string getFileName(const IODirectives& ioDirectives) {
+        if (ioDirectives.has("filename")) {
+            return ioDirectives.get("filename");
+        }
+        return ioDirectives.getRelationName() + ".bin";
+    }
+
+    std::string baseName;
+
+    /** Whether a column holds symbols */
+    std::vector<bool> isSymbol;
+
+    /** The mapped file */
+    void* data = nullptr;
+    size_t size = 0;
+
+    /** The symbol sub-table, mapped to indices of the symbol table */
+    std::vector<RamDomain> symbols;
+
+    /** The tuple data, column-major */
+    const RamDomain* columns = nullptr;
+    size_t numTuples = 0;
+
+    /** The index of the next tuple to read */
+    size_t next = 0;
+};
+
+/**
+ * Loads the binary facts published by IO=shm in a POSIX shared memory segment. The
+ * segment is kept for further readers, unless unlink=true removes it once loaded.
+ */
+class ReadSharedMemoryBinary : public ReadFileBinary {
+public:
+    ReadSharedMemoryBinary(
+            const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable)
+            : ReadFileBinary(ioDirectives, symbolTable, recordTable,
+                      shm_open(getSharedMemorySegment(ioDirectives).c_str(), O_RDONLY, 0),
+                      getSharedMemorySegment(ioDirectives)) {
+        if (ioDirectives.has("unlink") && ioDirectives.get("unlink") == "true") {
+            shm_unlink(baseName.c_str());
+        }
+    }
+
+    ~ReadSharedMemoryBinary() override = default;
+};
+
+class ReadFileBinaryFactory : public ReadStreamFactory {
+public:
+    std::unique_ptr<ReadStream> getReader(
+            const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable) override {
+        return std::make_unique<ReadFileBinary>(ioDirectives, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~ReadFileBinaryFactory() override = default;
+};
+
+class ReadSharedMemoryBinaryFactory : public ReadStreamFactory {
+public:
+    std::unique_ptr<ReadStream> getReader(
+            const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable) override {
+        return std::make_unique<ReadSharedMemoryBinary>(ioDirectives, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "shm";
+        return name;
+    }
+
+    ~ReadSharedMemoryBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "IODirectives.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "ReadStream.h"
 #include "RecordTable.h"
@@ -27,11 +28,15 @@
 #include <fstream>
 #endif
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <glob.h>
 
 namespace souffle {
 
@@ -40,16 +45,38 @@ public:
     ReadStreamCSV(std::istream& file, const IODirectives& ioDirectives, SymbolTable& symbolTable,
             RecordTable& recordTable)
             : ReadStream(ioDirectives, symbolTable, recordTable), delimiter(getDelimiter(ioDirectives)),
+              symbolIds(ioDirectives.has("symbol-ids") && ioDirectives.get("symbol-ids") == "true"),
               file(file), lineNumber(0), inputMap(getInputColumnMap(ioDirectives, arity)) {
         while (inputMap.size() < arity) {
             int size = static_cast<int>(inputMap.size());
             inputMap[size] = size;
         }
+        for (const auto& mapping : inputMap) {
+            if (mapping.first < 0) {
+                continue;
+            }
+            if (columnAttribute.size() <= static_cast<size_t>(mapping.first)) {
+                columnAttribute.resize(mapping.first + 1, -1);
+            }
+            columnAttribute[mapping.first] = mapping.second;
+        }
+        for (const auto& type : typeAttributes) {
+            attributeKind.push_back(type[0]);
+        }
+        if (ioDirectives.has("filter")) {
+            parseFilter(ioDirectives.get("filter"));
+        }
     }
 
     ~ReadStreamCSV() override = default;
 
 protected:
+    /** Maximal number of lines parsed at once by readNextTuples */
+    static constexpr size_t CHUNK_LINES = 1ul << 16;
+
+    /** Number of lines parsed by a parallel task of readNextTuples */
+    static constexpr size_t BLOCK_LINES = 1ul << 10;
+
     /**
      * Read and return the next tuple.
      *
@@ -60,61 +87,278 @@ protected:
         if (file.eof()) {
             return nullptr;
         }
-        std::string line;
+        if (lines.empty()) {
+            lines.emplace_back();
+        }
+        std::string& line = lines.front();
         std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(typeAttributes.size());
 
-        if (!getline(file, line)) {
-            return nullptr;
+        do {
+            if (!getline(file, line)) {
+                return nullptr;
+            }
+            // Handle Windows line endings on non-Windows systems
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            ++lineNumber;
+        } while (!parseLine(line, lineNumber, tuple.get(), nullptr));
+        return tuple;
+    }
+
+    /**
+     * Read the next chunk of lines, and parse them in parallel.
+     *
+     * Symbols are collected as views into the lines while parsing and interned afterwards in input
+     * order, such that the numbering of symbols does not depend on the number of threads. Relations
+     * with records are read line by line, since parsing a record interns its symbols. Lines dropped
+     * by the filter are removed before interning, hence their symbols never enter the symbol table.
+     */
+    size_t readNextTuples(std::vector<RamDomain>& buffer) override {
+        if (hasRecords()) {
+            return ReadStream::readNextTuples(buffer);
+        }
+        // a chunk whose lines are all filtered out does not end the input
+        size_t numTuples = 0;
+        while (numTuples == 0) {
+            const size_t numLines = readNextChunk(buffer, numTuples);
+            if (numLines == 0) {
+                return 0;
+            }
+        }
+        return numTuples;
+    }
+
+    /** Read and parse the next chunk of lines into the given buffer, returning the number of lines */
+    size_t readNextChunk(std::vector<RamDomain>& buffer, size_t& numTuples) {
+        const size_t numLines = parseNextChunk(buffer, numTuples);
+        internSymbols(buffer, numTuples);
+        return numLines;
+    }
+
+    /**
+     * Read and parse the next chunk of lines into the given buffer, returning the number of lines,
+     * without interning its symbols. Readers of different files may thus parse their chunks
+     * concurrently; the symbols of a chunk remain valid until its reader parses the next chunk.
+     */
+    size_t parseNextChunk(std::vector<RamDomain>& buffer, size_t& numTuples) {
+        // read the next lines
+        if (lines.size() < CHUNK_LINES) {
+            lines.resize(CHUNK_LINES);
+        }
+        size_t numLines = 0;
+        while (numLines < CHUNK_LINES && !file.eof() && getline(file, lines[numLines])) {
+            std::string& line = lines[numLines];
+            // Handle Windows line endings on non-Windows systems
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            ++numLines;
+        }
+        if (numLines == 0) {
+            return 0;
+        }
+        const size_t firstLine = lineNumber + 1;
+        lineNumber += numLines;
+
+        // parse them in parallel
+        const size_t width = std::max<size_t>(arity + auxiliaryArity, 1);
+        buffer.assign(numLines * width, 0);
+        symbolFields.resize(numLines * arity);
+        kept.assign(numLines, 1);
+        const size_t numBlocks = (numLines + BLOCK_LINES - 1) / BLOCK_LINES;
+        std::vector<std::string> errors(numBlocks);
+        PARALLEL_START
+            pfor(size_t block = 0; block < numBlocks; ++block) {
+                const size_t end = std::min(numLines, (block + 1) * BLOCK_LINES);
+                for (size_t i = block * BLOCK_LINES; i < end; ++i) {
+                    try {
+                        kept[i] = parseLine(
+                                lines[i], firstLine + i, &buffer[i * width], &symbolFields[i * arity]);
+                    } catch (std::exception& e) {
+                        errors[block] = e.what();
+                        break;
+                    }
+                }
+            }
+        PARALLEL_END;
+        for (const auto& error : errors) {
+            if (!error.empty()) {
+                throw std::invalid_argument(error);
+            }
+        }
+
+        // move the kept lines to the front
+        numTuples = numLines;
+        if (!filters.empty()) {
+            numTuples = 0;
+            for (size_t i = 0; i < numLines; ++i) {
+                if (!kept[i]) {
+                    continue;
+                }
+                if (numTuples != i) {
+                    std::copy_n(&buffer[i * width], width, &buffer[numTuples * width]);
+                    std::copy_n(&symbolFields[i * arity], arity, &symbolFields[numTuples * arity]);
+                }
+                ++numTuples;
+            }
         }
-        // Handle Windows line endings on non-Windows systems
-        if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
+        return numLines;
+    }
+
+    /** Intern the symbols of the kept lines of the last parsed chunk in input order */
+    void internSymbols(std::vector<RamDomain>& buffer, size_t numTuples) {
+        const size_t width = std::max<size_t>(arity + auxiliaryArity, 1);
+        for (size_t column = 0; column < arity; ++column) {
+            if (attributeKind[column] != 's' || symbolIds) {
+                continue;
+            }
+            for (size_t i = 0; i < numTuples; ++i) {
+                buffer[i * width + column] = symbolTable.lookup(symbolFields[i * arity + column]);
+            }
         }
-        ++lineNumber;
+    }
+
+    /** Check whether any attribute of the relation is a record */
+    bool hasRecords() const {
+        return std::any_of(typeAttributes.begin(), typeAttributes.end(),
+                [](const std::string& type) { return type[0] == 'r'; });
+    }
 
+    /**
+     * Parse the given line into the given tuple, returning false if the line is dropped by the filter.
+     *
+     * If symbols is not nullptr, symbol values are not interned but stored in symbols as views
+     * into the line, at the position of their attribute; this does not modify any state and may
+     * thus run in parallel.
+     */
+    bool parseLine(std::string_view line, size_t lineNo, RamDomain* tuple, std::string_view* symbols) {
         size_t start = 0;
         size_t end = 0;
         size_t columnsFilled = 0;
-        for (uint32_t column = 0; columnsFilled < arity; column++) {
-            std::string element = nextElement(line, start, end);
-            if (inputMap.count(column) == 0) {
+        for (uint32_t column = 0; columnsFilled < arity || column < columnFilter.size(); column++) {
+            std::string_view element = nextElement(line, start, end, lineNo);
+            if (column < columnFilter.size() && columnFilter[column] >= 0 &&
+                    !matches(filters[columnFilter[column]], element, column, lineNo)) {
+                return false;
+            }
+            if (columnsFilled == arity || column >= columnAttribute.size() || columnAttribute[column] < 0) {
                 continue;
             }
+            const int attribute = columnAttribute[column];
             ++columnsFilled;
 
             try {
-                switch (typeAttributes.at(inputMap[column])[0]) {
+                switch (attributeKind[attribute]) {
                     case 's':
-                        tuple[inputMap[column]] = symbolTable.unsafeLookup(element);
+                        if (symbolIds) {
+                            tuple[attribute] = parseSymbolId(element);
+                        } else if (symbols != nullptr) {
+                            symbols[attribute] = element;
+                        } else {
+                            tuple[attribute] = symbolTable.lookup(element);
+                        }
                         break;
                     case 'r':
-                        tuple[inputMap[column]] = readRecord(element, typeAttributes[inputMap[column]]);
+                        tuple[attribute] = readRecord(std::string(element), typeAttributes[attribute]);
                         break;
                     case 'i':
-                        tuple[inputMap[column]] = RamDomainFromString(element);
+                        tuple[attribute] = RamDomainFromChars(element);
                         break;
                     case 'u':
-                        tuple[inputMap[column]] = ramBitCast(RamUnsignedFromString(element));
+                        tuple[attribute] = ramBitCast(RamUnsignedFromChars(element));
                         break;
                     case 'f':
-                        tuple[inputMap[column]] = ramBitCast(RamFloatFromString(element));
+                        tuple[attribute] = ramBitCast(RamFloatFromChars(element));
                         break;
                     default:
                         assert(false && "Invalid type attribute");
                 }
             } catch (...) {
                 std::stringstream errorMessage;
-                errorMessage << "Error converting <" + element + "> in column " << column + 1 << " in line "
-                             << lineNumber << "; ";
+                errorMessage << "Error converting <" << element << "> in column " << column + 1 << " in line "
+                             << lineNo << "; ";
                 throw std::invalid_argument(errorMessage.str());
             }
         }
+        return true;
+    }
 
-        return tuple;
+    /** A constant an input column has to equal for a line to be kept */
+    struct Filter {
+        /** The type of the constant, as the first character of a type attribute */
+        char kind;
+
+        /** The text of a symbol constant */
+        std::string text;
+
+        /** The RAM representation of a numeric constant */
+        RamDomain value;
+    };
+
+    /**
+     * Parse the filter directive, a JSON object mapping input columns to constants, each given by
+     * the kind of its type followed by the symbol or the RAM representation of the number, e.g.
+     * {"2": "scall", "4": "i7"}; a float is thus given by the bits of its value.
+     */
+    void parseFilter(const std::string& filterString) {
+        std::string parseErrors;
+        const Json filter = Json::parse(filterString, parseErrors);
+        if (!parseErrors.empty() || !filter.is_object()) {
+            throw std::invalid_argument("Invalid filter was given: <" + filterString + ">");
+        }
+        for (const auto& entry : filter.object_items()) {
+            const size_t column = std::stoul(entry.first);
+            const std::string& constant = entry.second.string_value();
+            if (constant.empty()) {
+                throw std::invalid_argument("Invalid filter was given: <" + filterString + ">");
+            }
+            Filter cur{constant[0], constant.substr(1), 0};
+            if (cur.kind != 's') {
+                if (cur.kind != 'i' && cur.kind != 'u' && cur.kind != 'f') {
+                    throw std::invalid_argument("Invalid filter was given: <" + filterString + ">");
+                }
+                cur.value = RamDomainFromChars(cur.text);
+            }
+            if (columnFilter.size() <= column) {
+                columnFilter.resize(column + 1, -1);
+            }
+            columnFilter[column] = static_cast<int>(filters.size());
+            filters.push_back(std::move(cur));
+        }
     }
 
-    std::string nextElement(const std::string& line, size_t& start, size_t& end) {
-        std::string element;
+    /** Check whether the given element of an input column equals the constant of its filter */
+    bool matches(const Filter& filter, std::string_view element, uint32_t column, size_t lineNo) const {
+        try {
+            switch (filter.kind) {
+                case 'i':
+                    return RamDomainFromChars(element) == filter.value;
+                case 'u':
+                    return ramBitCast(RamUnsignedFromChars(element)) == filter.value;
+                case 'f':
+                    return ramBitCast(RamFloatFromChars(element)) == filter.value;
+                default:
+                    return element == filter.text;
+            }
+        } catch (...) {
+            std::stringstream errorMessage;
+            errorMessage << "Error converting <" << element << "> in column " << column + 1 << " in line "
+                         << lineNo << "; ";
+            throw std::invalid_argument(errorMessage.str());
+        }
+    }
+
+    /** Parse the index of a symbol of the pre-seeded symbol table (see SymbolDictionary.h) */
+    RamDomain parseSymbolId(std::string_view element) const {
+        const RamDomain index = RamDomainFromChars(element);
+        if (!symbolTable.contains(index)) {
+            throw std::invalid_argument("Unknown symbol index");
+        }
+        return index;
+    }
+
+    std::string_view nextElement(std::string_view line, size_t& start, size_t& end, size_t lineNo) {
 
         // Handle record/tuple delimiter coincidence.
         if (delimiter.find(',') != std::string::npos) {
@@ -122,7 +366,7 @@ protected:
             size_t next_delimiter = line.find(delimiter, start);
 
             // Find first delimiter after the record.
-            while (end < std::min(next_delimiter, line.length()) || record_parens != 0) {
+            while (end < line.length() && (end < next_delimiter || record_parens != 0)) {
                 // Track the number of parenthesis.
                 if (line[end] == '[') {
                     ++record_parens;
@@ -147,7 +391,7 @@ protected:
             // Handle the end-of-the-line case where parenthesis are unbalanced.
             if (record_parens != 0) {
                 std::stringstream errorMessage;
-                errorMessage << "Unbalanced record parenthesis " << lineNumber << "; ";
+                errorMessage << "Unbalanced record parenthesis " << lineNo << "; ";
                 throw std::invalid_argument(errorMessage.str());
             }
         } else {
@@ -157,11 +401,11 @@ protected:
         // Check for missing value.
         if (start > end) {
             std::stringstream errorMessage;
-            errorMessage << "Values missing in line " << lineNumber << "; ";
+            errorMessage << "Values missing in line " << lineNo << "; ";
             throw std::invalid_argument(errorMessage.str());
         }
 
-        element = line.substr(start, end - start);
+        std::string_view element = line.substr(start, end - start);
         start = end + delimiter.size();
 
         return element;
@@ -201,9 +445,36 @@ protected:
     }
 
     const std::string delimiter;
+
+    /** Whether symbols are given by their indices in the symbol table (symbol-ids=true) */
+    const bool symbolIds;
+
     std::istream& file;
     size_t lineNumber;
     std::map<int, int> inputMap;
+
+    /** The attribute of each input column, or -1 if the column is skipped */
+    std::vector<int> columnAttribute;
+
+    /** The type of each attribute, as the first character of its type attribute */
+    std::vector<char> attributeKind;
+
+    /** The constants of the filter directive */
+    std::vector<Filter> filters;
+
+    /** The filter of each input column, or -1 if the column is not filtered */
+    std::vector<int> columnFilter;
+
+    /** Whether each line of the current chunk is kept by the filter */
+    std::vector<char> kept;
+
+    /** The lines of the current chunk, reused across chunks */
+    std::vector<std::string> lines;
+
+    /** The symbols of the current chunk as views into lines, arity entries per line */
+    std::vector<std::string_view> symbolFields;
+
+    friend class ReadShardedCSV;
 };
 
 class ReadFileCSV : public ReadStreamCSV {
@@ -241,6 +512,17 @@ public:
         }
     }
 
+    size_t readNextTuples(std::vector<RamDomain>& buffer) override {
+        try {
+            return ReadStreamCSV::readNextTuples(buffer);
+        } catch (std::exception& e) {
+            std::stringstream errorMessage;
+            errorMessage << e.what();
+            errorMessage << "cannot parse fact file " << baseName << "!\n";
+            throw std::invalid_argument(errorMessage.str());
+        }
+    }
+
     ~ReadFileCSV() override = default;
 
 protected:
@@ -258,6 +540,160 @@ protected:
 #endif
 };
 
+/**
+ * Reads the facts of a relation from many shard files, given by the shards directive as a directory
+ * or a glob pattern, e.g. shards="edge" or shards="edge/part-*.facts.gz". Relative patterns are
+ * resolved against the directory of the fact file, i.e. the fact directory by default.
+ *
+ * Up to MAX_OPEN_SHARDS shards are read at once, each parsing its next chunk of lines concurrently
+ * into its own buffer. The chunks are merged and their symbols interned in the order of the shards
+ * afterwards, such that neither depends on the number of threads. Each shard is read like a fact
+ * file, hence it may be gzipped and the other directives apply to each of them.
+ */
+class ReadShardedCSV : public ReadStream {
+public:
+    ReadShardedCSV(const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable)
+            : ReadStream(ioDirectives, symbolTable, recordTable), ioDirectives(ioDirectives),
+              paths(getShardPaths(ioDirectives)), nextPath(0),
+              records(std::any_of(typeAttributes.begin(), typeAttributes.end(),
+                      [](const std::string& type) { return type[0] == 'r'; })) {}
+
+    ~ReadShardedCSV() override = default;
+
+protected:
+    /** Maximal number of shards read at once */
+    static constexpr size_t MAX_OPEN_SHARDS = 64;
+
+    /** A shard being read, with the buffer of its current chunk */
+    struct Shard {
+        std::unique_ptr<ReadFileCSV> reader;
+        std::string name;
+        std::vector<RamDomain> buffer;
+        size_t numLines;
+        size_t numTuples;
+    };
+
+    /**
+     * Read and return the next tuple, reading the shards one after another.
+     *
+     * Returns nullptr if no tuple was readable.
+     * @return
+     */
+    std::unique_ptr<RamDomain[]> readNextTuple() override {
+        while (!shards.empty() || nextPath < paths.size()) {
+            if (shards.empty()) {
+                openShard();
+            }
+            if (auto tuple = shards.front().reader->readNextTuple()) {
+                return tuple;
+            }
+            shards.clear();
+        }
+        return nullptr;
+    }
+
+    /**
+     * Parse the next chunk of each open shard in parallel, and merge their buffers in the order of
+     * the shards. Relations with records are read line by line, one shard after another.
+     */
+    size_t readNextTuples(std::vector<RamDomain>& buffer) override {
+        if (records) {
+            return ReadStream::readNextTuples(buffer);
+        }
+        const size_t width = std::max<size_t>(arity + auxiliaryArity, 1);
+        size_t numTuples = 0;
+        buffer.clear();
+        // chunks whose lines are all filtered out do not end the input
+        while (numTuples == 0 && openShards()) {
+            std::vector<std::string> errors(shards.size());
+            PARALLEL_START_IF(shards.size() > 1)
+                pfor(size_t i = 0; i < shards.size(); ++i) {
+                    Shard& shard = shards[i];
+                    shard.numTuples = 0;
+                    try {
+                        shard.numLines = shard.reader->parseNextChunk(shard.buffer, shard.numTuples);
+                    } catch (std::exception& e) {
+                        errors[i] = std::string(e.what()) + "cannot parse fact file " + shard.name + "!\n";
+                    }
+                }
+            PARALLEL_END;
+            for (const auto& error : errors) {
+                if (!error.empty()) {
+                    throw std::invalid_argument(error);
+                }
+            }
+
+            for (Shard& shard : shards) {
+                shard.reader->internSymbols(shard.buffer, shard.numTuples);
+                buffer.insert(buffer.end(), shard.buffer.begin(),
+                        shard.buffer.begin() + shard.numTuples * width);
+                numTuples += shard.numTuples;
+            }
+            shards.erase(std::remove_if(shards.begin(), shards.end(),
+                                 [](const Shard& shard) { return shard.numLines == 0; }),
+                    shards.end());
+        }
+        return numTuples;
+    }
+
+    /** Open shards up to MAX_OPEN_SHARDS, returning false if all shards were read */
+    bool openShards() {
+        while (shards.size() < MAX_OPEN_SHARDS && nextPath < paths.size()) {
+            openShard();
+        }
+        return !shards.empty();
+    }
+
+    /** Open the next shard */
+    void openShard() {
+        IODirectives directives = ioDirectives;
+        directives.setFileName(paths[nextPath++]);
+        auto reader = std::make_unique<ReadFileCSV>(directives, symbolTable, recordTable);
+        shards.push_back({std::move(reader), souffle::baseName(directives.getFileName()), {}, 0, 0});
+    }
+
+    /** Find the files matched by the shards directive in sorted order */
+    static std::vector<std::string> getShardPaths(const IODirectives& ioDirectives) {
+        std::string pattern = ioDirectives.get("shards");
+        if (pattern.empty() || pattern[0] != '/') {
+            const std::string dir = ioDirectives.has("filename") ? dirName(ioDirectives.getFileName()) : ".";
+            pattern = dir + "/" + pattern;
+        }
+        if (existDir(pattern)) {
+            pattern += "/*";
+        }
+        std::vector<std::string> paths;
+        glob_t matches;
+        if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i) {
+                if (!existDir(matches.gl_pathv[i])) {
+                    paths.emplace_back(matches.gl_pathv[i]);
+                }
+            }
+        }
+        globfree(&matches);
+        if (paths.empty()) {
+            throw std::invalid_argument("Cannot find fact shards " + ioDirectives.get("shards") + "\n");
+        }
+        return paths;
+    }
+
+    /** The directives of the input, from which the directives of each shard are derived */
+    const IODirectives ioDirectives;
+
+    /** The files of the shards */
+    const std::vector<std::string> paths;
+
+    /** The index of the next shard to be opened */
+    size_t nextPath;
+
+    /** Whether any attribute of the relation is a record */
+    const bool records;
+
+    /** The open shards */
+    std::vector<Shard> shards;
+};
+
 class ReadCinCSVFactory : public ReadStreamFactory {
 public:
     std::unique_ptr<ReadStream> getReader(
@@ -276,6 +712,9 @@ class ReadFileCSVFactory : public ReadStreamFactory {
 public:
     std::unique_ptr<ReadStream> getReader(
             const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable) override {
+        if (ioDirectives.has("shards")) {
+            return std::make_unique<ReadShardedCSV>(ioDirectives, symbolTable, recordTable);
+        }
         return std::make_unique<ReadFileCSV>(ioDirectives, symbolTable, recordTable);
     }
 
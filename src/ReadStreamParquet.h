@@ -0,0 +1,277 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamParquet.h
+ *
+ * Reads relations from Apache Parquet files, one column per attribute.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include "ReadStream.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "Util.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/exception.h>
+
+namespace souffle {
+
+/**
+ * The file is read a row group at a time, whose column chunks are decoded in parallel by
+ * Arrow. Integer and floating point columns of any width are accepted for numbers, and
+ * string or dictionary columns for symbols; dictionaries are interned once per chunk.
+ */
+class ReadFileParquet : public ReadStream {
+public:
+    ReadFileParquet(const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable)
+            : ReadStream(ioDirectives, symbolTable, recordTable),
+              baseName(souffle::baseName(getFileName(ioDirectives))) {
+        for (const auto& type : typeAttributes) {
+            if (type[0] == 'r') {
+                throw std::invalid_argument("Parquet IO does not support records in fact file " + baseName);
+            }
+        }
+        const std::string fileName = getFileName(ioDirectives);
+        if (ioDirectives.has("intermediate") && !existFile(fileName)) {
+            return;
+        }
+
+        try {
+            std::shared_ptr<arrow::io::ReadableFile> input;
+            PARQUET_ASSIGN_OR_THROW(input, arrow::io::ReadableFile::Open(fileName));
+
+            parquet::ArrowReaderProperties properties(true);
+            for (size_t col = 0; col < arity; ++col) {
+                properties.set_read_dictionary(col, typeAttributes[col][0] == 's');
+            }
+            parquet::arrow::FileReaderBuilder builder;
+            PARQUET_THROW_NOT_OK(builder.Open(input));
+            PARQUET_THROW_NOT_OK(builder.properties(properties)->Build(&reader));
+
+            std::shared_ptr<arrow::Schema> schema;
+            PARQUET_THROW_NOT_OK(reader->GetSchema(&schema));
+            if (static_cast<size_t>(schema->num_fields()) != arity) {
+                throw std::invalid_argument("Fact file has " + std::to_string(schema->num_fields()) +
+                                            " columns, expected " + std::to_string(arity) + "; ");
+            }
+        } catch (std::exception& e) {
+            throw std::invalid_argument(std::string(e.what()) + " cannot read fact file " + baseName + "!\n");
+        }
+    }
+
+    ~ReadFileParquet() override = default;
+
+protected:
+    /**
+     * Read and return the next tuple.
+     *
+     * Returns nullptr if no tuple was readable.
+     * @return
+     */
+    std::unique_ptr<RamDomain[]> readNextTuple() override {
+        if (next >= numRows && !readRowGroup()) {
+            return nullptr;
+        }
+        const size_t width = std::max<size_t>(arity + auxiliaryArity, 1);
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(arity + auxiliaryArity);
+        std::copy(&rows[next * width], &rows[next * width] + arity, tuple.get());
+        ++next;
+        return tuple;
+    }
+
+    /** Return the remaining tuples of the current row group */
+    size_t readNextTuples(std::vector<RamDomain>& buffer) override {
+        if (next >= numRows && !readRowGroup()) {
+            return 0;
+        }
+        const size_t width = std::max<size_t>(arity + auxiliaryArity, 1);
+        const size_t count = numRows - next;
+        if (next == 0) {
+            buffer.swap(rows);
+        } else {
+            buffer.assign(rows.begin() + next * width, rows.end());
+        }
+        next = numRows;
+        return count;
+    }
+
+    /** Decode the next non-empty row group into rows; returns false at the end of the file */
+    bool readRowGroup() {
+        while (reader != nullptr && nextRowGroup < reader->num_row_groups()) {
+            std::shared_ptr<arrow::Table> table;
+            try {
+                PARQUET_THROW_NOT_OK(reader->ReadRowGroup(nextRowGroup++, &table));
+                PARQUET_ASSIGN_OR_THROW(table, table->CombineChunks());
+            } catch (std::exception& e) {
+                throw std::invalid_argument(
+                        std::string(e.what()) + " cannot read fact file " + baseName + "!\n");
+            }
+            if (table->num_rows() == 0) {
+                continue;
+            }
+            numRows = static_cast<size_t>(table->num_rows());
+            next = 0;
+            const size_t width = std::max<size_t>(arity + auxiliaryArity, 1);
+            rows.assign(numRows * width, 0);
+            for (size_t col = 0; col < arity; ++col) {
+                const auto& chunks = table->column(static_cast<int>(col))->chunks();
+                if (!chunks.empty()) {
+                    decodeColumn(*chunks.front(), col, width);
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /** Decode a column into the rows, converting the values to the type of the attribute */
+    void decodeColumn(const arrow::Array& array, size_t col, size_t width) {
+        if (array.null_count() > 0) {
+            throw std::invalid_argument(
+                    "Null value in column " + std::to_string(col + 1) + " of fact file " + baseName + "\n");
+        }
+        const char type = typeAttributes[col][0];
+        switch (array.type_id()) {
+            case arrow::Type::INT8:
+                return decodeNumbers<arrow::Int8Type>(array, col, width, type);
+            case arrow::Type::INT16:
+                return decodeNumbers<arrow::Int16Type>(array, col, width, type);
+            case arrow::Type::INT32:
+                return decodeNumbers<arrow::Int32Type>(array, col, width, type);
+            case arrow::Type::INT64:
+                return decodeNumbers<arrow::Int64Type>(array, col, width, type);
+            case arrow::Type::UINT8:
+                return decodeNumbers<arrow::UInt8Type>(array, col, width, type);
+            case arrow::Type::UINT16:
+                return decodeNumbers<arrow::UInt16Type>(array, col, width, type);
+            case arrow::Type::UINT32:
+                return decodeNumbers<arrow::UInt32Type>(array, col, width, type);
+            case arrow::Type::UINT64:
+                return decodeNumbers<arrow::UInt64Type>(array, col, width, type);
+            case arrow::Type::FLOAT:
+                return decodeNumbers<arrow::FloatType>(array, col, width, type);
+            case arrow::Type::DOUBLE:
+                return decodeNumbers<arrow::DoubleType>(array, col, width, type);
+            case arrow::Type::STRING:
+                if (type == 's') {
+                    return decodeStrings(static_cast<const arrow::StringArray&>(array), col, width);
+                }
+                break;
+            case arrow::Type::DICTIONARY:
+                if (type == 's') {
+                    return decodeDictionary(static_cast<const arrow::DictionaryArray&>(array), col, width);
+                }
+                break;
+            default:
+                break;
+        }
+        throw std::invalid_argument("Column " + std::to_string(col + 1) + " of fact file " + baseName +
+                                    " has type " + array.type()->ToString() + ", expected " +
+                                    typeAttributes[col] + "\n");
+    }
+
+    template <typename ArrowType>
+    void decodeNumbers(const arrow::Array& array, size_t col, size_t width, char type) {
+        const auto* values = static_cast<const arrow::NumericArray<ArrowType>&>(array).raw_values();
+        switch (type) {
+            case 'i':
+                for (size_t i = 0; i < numRows; ++i) {
+                    rows[i * width + col] = static_cast<RamSigned>(values[i]);
+                }
+                return;
+            case 'u':
+                for (size_t i = 0; i < numRows; ++i) {
+                    rows[i * width + col] = ramBitCast(static_cast<RamUnsigned>(values[i]));
+                }
+                return;
+            case 'f':
+                for (size_t i = 0; i < numRows; ++i) {
+                    rows[i * width + col] = ramBitCast(static_cast<RamFloat>(values[i]));
+                }
+                return;
+        }
+        throw std::invalid_argument("Column " + std::to_string(col + 1) + " of fact file " + baseName +
+                                    " holds numbers, expected symbols\n");
+    }
+
+    void decodeStrings(const arrow::StringArray& array, size_t col, size_t width) {
+        for (size_t i = 0; i < numRows; ++i) {
+            const auto value = array.GetView(static_cast<int64_t>(i));
+            rows[i * width + col] = symbolTable.lookup(std::string_view(value.data(), value.size()));
+        }
+    }
+
+    /** Intern the dictionary once and map the indices of the column to its symbols */
+    void decodeDictionary(const arrow::DictionaryArray& array, size_t col, size_t width) {
+        const auto& dictionary = array.dictionary();
+        if (dictionary->type_id() != arrow::Type::STRING) {
+            throw std::invalid_argument("Column " + std::to_string(col + 1) + " of fact file " + baseName +
+                                        " has a dictionary of " + dictionary->type()->ToString() + "\n");
+        }
+        const auto& strings = static_cast<const arrow::StringArray&>(*dictionary);
+        std::vector<RamDomain> symbols(strings.length());
+        for (int64_t i = 0; i < strings.length(); ++i) {
+            const auto value = strings.GetView(i);
+            symbols[i] = symbolTable.lookup(std::string_view(value.data(), value.size()));
+        }
+        for (size_t i = 0; i < numRows; ++i) {
+            rows[i * width + col] = symbols[array.GetValueIndex(static_cast<int64_t>(i))];
+        }
+    }
+
+    std::string getFileName(const IODirectives& ioDirectives) const {
+        if (ioDirectives.has("filename")) {
+            return ioDirectives.get("filename");
+        }
+        return ioDirectives.getRelationName() + ".parquet";
+    }
+
+    std::string baseName;
+
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    int nextRowGroup = 0;
+
+    /** The tuples of the current row group */
+    std::vector<RamDomain> rows;
+    size_t numRows = 0;
+
+    /** The index of the next tuple of the current row group */
+    size_t next = 0;
+};
+
+class ReadFileParquetFactory : public ReadStreamFactory {
+public:
+    std::unique_ptr<ReadStream> getReader(
+            const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable) override {
+        return std::make_unique<ReadFileParquet>(ioDirectives, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "parquet";
+        return name;
+    }
+
+    ~ReadFileParquetFactory() override = default;
+};
+
+} /* namespace souffle */
@@ -18,11 +18,13 @@
 #include "ReadStream.h"
 #include "RecordTable.h"
 #include "SymbolTable.h"
+#include "Util.h"
 #include <fstream>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include <sqlite3.h>
 
@@ -32,7 +34,8 @@ class ReadStreamSQLite : public ReadStream {
 public:
     ReadStreamSQLite(const IODirectives& ioDirectives, SymbolTable& symbolTable, RecordTable& recordTable)
             : ReadStream(ioDirectives, symbolTable, recordTable), dbFilename(ioDirectives.get("dbname")),
-              relationName(ioDirectives.getRelationName()) {
+              relationName(ioDirectives.getRelationName()),
+              tableName(ioDirectives.has("table") ? ioDirectives.get("table") : "") {
         openDB();
         checkTableExists();
         prepareSelectStatement();
@@ -59,26 +62,8 @@ protected:
 
         uint32_t column;
         for (column = 0; column < arity; column++) {
-            std::string element(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, column)));
-
-            if (element.empty()) {
-                element = "n/a";
-            }
-
             try {
-                switch (typeAttributes.at(column)[0]) {
-                    case 's':
-                        tuple[column] = symbolTable.unsafeLookup(element);
-                        break;
-                    case 'i':
-                    case 'u':
-                    case 'f':
-                    case 'r':
-                        tuple[column] = RamDomainFromString(element);
-                        break;
-                    default:
-                        assert(false && "Invalid type attribute");
-                }
+                tuple[column] = readValue(column);
             } catch (...) {
                 std::stringstream errorMessage;
                 errorMessage << "Error converting number in column " << (column) + 1;
@@ -89,6 +74,43 @@ protected:
         return tuple;
     }
 
+    /**
+     * Read the value of a column of the current row according to its storage class. Integers are
+     * the values written by souffle, i.e., the bit patterns of unsigned and float values, while
+     * text is parsed like a fact file; symbols are interned from the text of the statement.
+     */
+    RamDomain readValue(uint32_t column) {
+        const char type = typeAttributes.at(column)[0];
+        const int storage = sqlite3_column_type(selectStatement, column);
+        if (type != 's' && storage == SQLITE_INTEGER) {
+            return static_cast<RamDomain>(sqlite3_column_int64(selectStatement, column));
+        }
+        if (type != 's' && storage == SQLITE_FLOAT) {
+            const double value = sqlite3_column_double(selectStatement, column);
+            return type == 'f' ? ramBitCast(static_cast<RamFloat>(value)) : static_cast<RamDomain>(value);
+        }
+
+        const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, column));
+        std::string_view element(text == nullptr ? "" : text, sqlite3_column_bytes(selectStatement, column));
+        if (element.empty()) {
+            element = "n/a";
+        }
+        switch (type) {
+            case 's':
+                return symbolTable.lookup(element);
+            case 'i':
+            case 'r':
+                return RamDomainFromChars(element);
+            case 'u':
+                return ramBitCast(RamUnsignedFromChars(element));
+            case 'f':
+                return ramBitCast(RamFloatFromChars(element));
+            default:
+                assert(false && "Invalid type attribute");
+                return 0;
+        }
+    }
+
     void executeSQL(const std::string& sql) {
         assert(db && "Database connection is closed");
 
@@ -113,7 +135,7 @@ protected:
 
     void prepareSelectStatement() {
         std::stringstream selectSQL;
-        selectSQL << "SELECT * FROM '" << relationName << "'";
+        selectSQL << "SELECT * FROM '" << (tableName.empty() ? relationName : tableName) << "'";
         const char* tail = nullptr;
         if (sqlite3_prepare_v2(db, selectSQL.str().c_str(), -1, &selectStatement, &tail) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_prepare_v2: ");
@@ -129,11 +151,16 @@ protected:
         executeSQL("PRAGMA journal_mode = MEMORY");
     }
 
+    /** Either the given table or the table and view written by souffle are required */
     void checkTableExists() {
         sqlite3_stmt* tableStatement;
         std::stringstream selectSQL;
         selectSQL << "SELECT count(*) FROM sqlite_master WHERE type IN ('table', 'view') AND ";
-        selectSQL << " name IN ('" << relationName << "', '_" << relationName << "');";
+        if (tableName.empty()) {
+            selectSQL << " name IN ('" << relationName << "', '_" << relationName << "');";
+        } else {
+            selectSQL << " name = '" << tableName << "';";
+        }
         const char* tail = nullptr;
 
         if (sqlite3_prepare_v2(db, selectSQL.str().c_str(), -1, &tableStatement, &tail) != SQLITE_OK) {
@@ -142,16 +169,22 @@ protected:
 
         if (sqlite3_step(tableStatement) == SQLITE_ROW) {
             int count = sqlite3_column_int(tableStatement, 0);
-            if (count == 2) {
+            if (count == (tableName.empty() ? 2 : 1)) {
                 sqlite3_finalize(tableStatement);
                 return;
             }
         }
         sqlite3_finalize(tableStatement);
+        if (!tableName.empty()) {
+            throw std::invalid_argument(
+                    "Table " + tableName + " does not exist for relation " + relationName);
+        }
         throw std::invalid_argument("Required table and view does not exist for relation " + relationName);
     }
-    const std::string& dbFilename;
-    const std::string& relationName;
+    const std::string dbFilename;
+    const std::string relationName;
+    /** The table or view to read the tuples from instead of the view written by souffle, if any */
+    const std::string tableName;
     sqlite3_stmt* selectStatement = nullptr;
     sqlite3* db = nullptr;
 };
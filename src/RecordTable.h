@@ -19,87 +19,235 @@
 #include "CompiledTuple.h"
 #include "ParallelUtils.h"
 #include "RamTypes.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <limits>
-#include <map>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace souffle {
 
 /**
  * A bidirectional mapping between tuples and reference indices.
+ *
+ * Tuples are stored flat, arity values each, in a slab of blocks of doubling capacity that
+ * never move once allocated; the reference of a tuple is its position in the slab, hence
+ * unpacking a reference is wait-free. The tuple-to-index map only holds pointers into the
+ * slab, and is split into shards selected by the hash of a tuple, each guarded by its own
+ * read/write lock.
  */
 class RecordMap {
+    /** Number of bits of a tuple's hash used to select its shard */
+    static constexpr size_t SHARD_BITS = 6;
+
+    /** Number of shards of the tuple-to-index map */
+    static constexpr size_t NUM_SHARDS = 1ul << SHARD_BITS;
+
+    /** Size (in bits) of the first block of the slab, in tuples */
+    static constexpr size_t INITIAL_BLOCK_BITS = 10;
+
+    /** Number of tuples of the first block of the slab */
+    static constexpr size_t INITIAL_BLOCK_SIZE = 1ul << INITIAL_BLOCK_BITS;
+
+    /** Maximal number of blocks of the slab */
+    static constexpr size_t MAX_BLOCKS = 64 - INITIAL_BLOCK_BITS;
+
+    /** Hash function for tuples of a given arity */
+    struct RecordHash {
+        size_t arity;
+
+        RecordHash() : arity(0) {}
+        explicit RecordHash(size_t arity) : arity(arity) {}
+
+        size_t operator()(const RamDomain* record) const {
+            std::hash<RamDomain> hash;
+            size_t res = 0;
+            for (size_t i = 0; i < arity; ++i) {
+                // from boost hash combine
+                res ^= hash(record[i]) + 0x9e3779b9 + (res << 6) + (res >> 2);
+            }
+            return res;
+        }
+    };
+
+    /** Equality of tuples of a given arity */
+    struct RecordEqual {
+        size_t arity;
+
+        RecordEqual() : arity(0) {}
+        explicit RecordEqual(size_t arity) : arity(arity) {}
+
+        bool operator()(const RamDomain* a, const RamDomain* b) const {
+            return std::equal(a, a + arity, b);
+        }
+    };
+
+    /** The mapping from tuples (pointing into the slab) to references/indices */
+    using IndexMap = std::unordered_map<const RamDomain*, RamDomain, RecordHash, RecordEqual>;
+
+    /** A partition of the tuple-to-index map */
+    struct Shard {
+        /** A lock to synchronize parallel accesses to this shard */
+        mutable ReadWriteLock access;
+
+        /** The mapping from tuples to references/indices */
+        IndexMap recordToIndex;
+    };
+
     /** The arity of the stored tuples */
     const size_t arity;
 
-    /** The mapping from tuples to references/indices */
-    std::map<std::vector<RamDomain>, RamDomain> recordToIndex;
+    /** The mapping from tuples to references/indices, partitioned into shards */
+    std::array<Shard, NUM_SHARDS> shards;
+
+    /** The blocks of the slab; block i holds (INITIAL_BLOCK_SIZE << i) tuples */
+    std::array<std::atomic<RamDomain*>, MAX_BLOCKS> blocks = {};
+
+    /** A lock to synchronize the allocation of blocks */
+    SpinLock allocation;
+
+    /** The next free index; note: index 0 is left free */
+    std::atomic<RamDomain> nextIndex{1};
+
+    /** Select the shard responsible for the given tuple. */
+    Shard& getShard(const RamDomain* record) {
+        // spread the hash by Fibonacci hashing, and use its upper bits
+        const uint64_t hash = static_cast<uint64_t>(RecordHash{arity}(record)) * 0x9e3779b97f4a7c15ull;
+        return shards[hash >> (64 - SHARD_BITS)];
+    }
+
+    /** Obtain the block number and the position within the block of the given index. */
+    static std::pair<size_t, size_t> locate(size_t index) {
+        const size_t nindex = index + INITIAL_BLOCK_SIZE;
+        const size_t blockNum = 63 - __builtin_clzll(nindex);
+        return {blockNum - INITIAL_BLOCK_BITS, nindex - (1ul << blockNum)};
+    }
+
+    /** Obtain the slot of the given index, allocating its block if necessary. */
+    RamDomain* allocate(size_t index) {
+        const auto [blockNum, offset] = locate(index);
+        RamDomain* block = blocks[blockNum].load(std::memory_order_acquire);
+        if (block == nullptr) {
+            allocation.lock();
+            block = blocks[blockNum].load(std::memory_order_relaxed);
+            if (block == nullptr) {
+                block = new RamDomain[(INITIAL_BLOCK_SIZE << blockNum) * arity];
+                blocks[blockNum].store(block, std::memory_order_release);
+            }
+            allocation.unlock();
+        }
+        return block + offset * arity;
+    }
 
-    /** The mapping from indices to tuples */
-    std::vector<std::vector<RamDomain>> indexToRecord;
+    /** Obtain the slot of the given index. */
+    RamDomain* slot(size_t index) const {
+        const auto [blockNum, offset] = locate(index);
+        return blocks[blockNum].load(std::memory_order_acquire) + offset * arity;
+    }
 
 public:
-    explicit RecordMap(size_t arity) : arity(arity), indexToRecord(1) {}  // note: index 0 element left free
+    explicit RecordMap(size_t arity) : arity(arity) {
+        for (Shard& shard : shards) {
+            shard.recordToIndex = IndexMap(0, RecordHash{arity}, RecordEqual{arity});
+        }
+    }
+
+    RecordMap(const RecordMap&) = delete;
+    RecordMap& operator=(const RecordMap&) = delete;
+
+    ~RecordMap() {
+        for (auto& block : blocks) {
+            delete[] block.load();
+        }
+    }
 
     /**
      * Pack the given vector -- create a new reference in necessary.
      */
     RamDomain pack(const std::vector<RamDomain>& vector) {
-        RamDomain index;
-#pragma omp critical(record_pack)
-        {
-            auto pos = recordToIndex.find(vector);
-            if (pos != recordToIndex.end()) {
-                index = pos->second;
-            } else {
-#pragma omp critical(record_unpack)
-                {
-                    indexToRecord.push_back(vector);
-                    index = indexToRecord.size() - 1;
-                    recordToIndex[vector] = index;
-
-                    // assert that new index is smaller than the range
-                    assert(index != std::numeric_limits<RamDomain>::max());
-                }
-            }
-        }
-        return index;
+        assert(vector.size() == arity && "Arity mismatch");
+        return pack(vector.data());
     }
 
     /**
      * Packs the given tuple -- and may create a new reference if necessary.
      */
     RamDomain pack(const RamDomain* tuple) {
-        std::vector<RamDomain> tmp(arity);
-        for (size_t i = 0; i < arity; i++) {
-            tmp[i] = tuple[i];
+        Shard& shard = getShard(tuple);
+
+        // fast path: the record is already present
+        shard.access.start_read();
+        auto pos = shard.recordToIndex.find(tuple);
+        if (pos != shard.recordToIndex.end()) {
+            const RamDomain index = pos->second;
+            shard.access.end_read();
+            return index;
         }
+        shard.access.end_read();
 
-        return pack(tmp);
+        // slow path: insert the record (it may have been inserted in the meantime)
+        shard.access.start_write();
+        RamDomain index;
+        pos = shard.recordToIndex.find(tuple);
+        if (pos != shard.recordToIndex.end()) {
+            index = pos->second;
+        } else {
+            index = nextIndex++;
+
+            // assert that new index is smaller than the range
+            assert(index != std::numeric_limits<RamDomain>::max());
+
+            RamDomain* record = allocate(index);
+            std::copy(tuple, tuple + arity, record);
+            shard.recordToIndex.emplace(record, index);
+        }
+        shard.access.end_write();
+        return index;
     }
 
     /**
      * Obtains a pointer to the tuple addressed by the given index.
      */
     RamDomain* unpack(RamDomain index) {
-        RamDomain* res;
-
-#pragma omp critical(record_unpack)
-        res = &(indexToRecord[index][0]);
-
-        return res;
+        return slot(index);
     }
 
     const RamDomain* unpack(RamDomain index) const {
-        const RamDomain* res;
+        return slot(index);
+    }
 
-#pragma omp critical(record_unpack)
-        res = &(indexToRecord[index][0]);
+    /**
+     * Return the number of records stored in this map.
+     */
+    size_t size() const {
+        return nextIndex.load() - 1;
+    }
 
-        return res;
+    /**
+     * Return an estimate of the number of bytes of memory occupied by this map.
+     */
+    size_t memoryUsage() const {
+        size_t bytes = sizeof(RecordMap);
+        for (size_t i = 0; i < MAX_BLOCKS; ++i) {
+            if (blocks[i].load() != nullptr) {
+                bytes += (INITIAL_BLOCK_SIZE << i) * arity * sizeof(RamDomain);
+            }
+        }
+        for (const Shard& shard : shards) {
+            shard.access.start_read();
+            bytes += shard.recordToIndex.bucket_count() * sizeof(void*);
+            bytes += shard.recordToIndex.size() *
+                     (sizeof(IndexMap::value_type) + sizeof(void*) + sizeof(size_t));
+            shard.access.end_read();
+        }
+        return bytes;
     }
 };
 
@@ -111,7 +259,7 @@ public:
     /**
      * A function packing a tuple of the given arity into a reference.
      */
-    RamDomain pack(RamDomain* tuple, size_t arity) {
+    RamDomain pack(const RamDomain* tuple, size_t arity) {
         return getForArity(arity).pack(tuple);
     }
 
@@ -134,24 +282,32 @@ public:
      * A function obtaining a pointer to the tuple addressed by the given reference.
      */
     RamDomain* unpack(RamDomain ref, size_t arity) {
-        auto iter = maps.find(arity);
-        assert(iter != maps.end() && "Attempting to unpack non-existing record");
+        RecordMap* map = findForArity(arity);
+        assert(map != nullptr && "Attempting to unpack non-existing record");
 
-        return (iter->second).unpack(ref);
+        return map->unpack(ref);
     }
 
     /**
      * A function obtaining a pointer to the tuple addressed by the given reference.
      */
     const RamDomain* unpack(RamDomain ref, size_t arity) const {
-        auto iter = maps.find(arity);
-        assert(iter != maps.end() && "Attempting to unpack non-existing record");
+        const RecordMap* map = findForArity(arity);
+        assert(map != nullptr && "Attempting to unpack non-existing record");
 
-        return (iter->second).unpack(ref);
+        return map->unpack(ref);
     }
 
     /**
-     * A function obtaining a pointer to the tuple addressed by the given reference.
+     * A function obtaining a pointer to the tuple of a fixed arity addressed by the given reference.
+     */
+    template <std::size_t Arity>
+    const RamDomain* unpack(RamDomain ref) const {
+        return unpack(ref, Arity);
+    }
+
+    /**
+     * A function obtaining a copy of the tuple addressed by the given reference.
      */
     template <typename Domain, std::size_t Arity>
     ram::Tuple<Domain, Arity> unpackTuple(RamDomain ref) {
@@ -176,17 +332,98 @@ public:
         return 0;
     }
 
+    /**
+     * Return the number of records stored in this table.
+     */
+    size_t size() const {
+        size_t res = 0;
+        access.start_read();
+        for (const auto& cur : maps) {
+            res += cur.second->size();
+        }
+        access.end_read();
+        return res;
+    }
+
+    /**
+     * Return the number of records of the given arity stored in this table; their references
+     * range from 1 to this number.
+     */
+    size_t size(size_t arity) const {
+        const RecordMap* map = findForArity(arity);
+        return map == nullptr ? 0 : map->size();
+    }
+
+    /**
+     * Return the arities of the records stored in this table, in ascending order.
+     */
+    std::vector<size_t> getArities() const {
+        std::vector<size_t> arities;
+        access.start_read();
+        for (const auto& cur : maps) {
+            arities.push_back(cur.first);
+        }
+        access.end_read();
+        std::sort(arities.begin(), arities.end());
+        return arities;
+    }
+
+    /**
+     * Return an estimate of the number of bytes of memory occupied by this table.
+     */
+    size_t memoryUsage() const {
+        size_t bytes = sizeof(RecordTable);
+        access.start_read();
+        for (const auto& cur : maps) {
+            bytes += cur.second->memoryUsage();
+        }
+        access.end_read();
+        return bytes;
+    }
+
 private:
-    std::unordered_map<size_t, RecordMap> maps;
+    /** Number of arities whose maps are looked up without locking */
+    static constexpr size_t DIRECT_ARITIES = 16;
+
+    /** A lock to synchronize the creation of maps */
+    mutable ReadWriteLock access;
+
+    std::unordered_map<size_t, std::unique_ptr<RecordMap>> maps;
+
+    /** The maps of small arities, published once they are created */
+    std::array<std::atomic<RecordMap*>, DIRECT_ARITIES> direct = {};
+
+    /** Obtain the map of the given arity, or nullptr if there is none yet. */
+    RecordMap* findForArity(size_t arity) const {
+        if (arity < DIRECT_ARITIES) {
+            if (RecordMap* map = direct[arity].load(std::memory_order_acquire)) {
+                return map;
+            }
+        }
+        access.start_read();
+        auto pos = maps.find(arity);
+        RecordMap* map = (pos != maps.end()) ? pos->second.get() : nullptr;
+        access.end_read();
+        return map;
+    }
 
     RecordMap& getForArity(size_t arity) {
-        std::unordered_map<size_t, RecordMap>::iterator mapsIterator;
-#pragma omp critical(RecordTableGetForArity)
-        {
-            // This will create a new map if it doesn't exist yet.
-            mapsIterator = maps.emplace(arity, arity).first;
+        if (RecordMap* map = findForArity(arity)) {
+            return *map;
         }
-        return mapsIterator->second;
+
+        // This will create a new map if it doesn't exist yet.
+        access.start_write();
+        auto& map = maps[arity];
+        if (map == nullptr) {
+            map = std::make_unique<RecordMap>(arity);
+            if (arity < DIRECT_ARITIES) {
+                direct[arity].store(map.get(), std::memory_order_release);
+            }
+        }
+        RecordMap& res = *map;
+        access.end_write();
+        return res;
     }
 };
 
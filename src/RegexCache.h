@@ -0,0 +1,117 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RegexCache.h
+ *
+ * Compiled regular expressions of match constraints, and a cache of the
+ * compiled patterns of each thread.
+ *
+ * Constant patterns are compiled once, when the interpreter generates its
+ * nodes or when the synthesised program is constructed. Patterns computed
+ * at runtime are looked up in a small least-recently-used cache of the
+ * evaluating thread, such that a handful of patterns matched repeatedly
+ * are compiled once per thread without any synchronisation.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace souffle {
+
+/**
+ * A regular expression compiled from a pattern, matching whole texts. Patterns without
+ * meta-characters are matched by comparing strings.
+ */
+class CompiledRegex {
+public:
+    explicit CompiledRegex(std::string pattern) : pattern(std::move(pattern)) {
+        if (this->pattern.find_first_of(".[]{}()\\*+?^$|") == std::string::npos) {
+            literal = true;
+            return;
+        }
+        try {
+            regex = std::make_unique<std::regex>(
+                    this->pattern, std::regex::ECMAScript | std::regex::optimize);
+        } catch (const std::regex_error&) {
+            regex = nullptr;
+        }
+    }
+
+    /** Get the pattern */
+    const std::string& getPattern() const {
+        return pattern;
+    }
+
+    /** Check whether the pattern is a valid regular expression */
+    bool isValid() const {
+        return literal || regex != nullptr;
+    }
+
+    /** Check whether the given text matches the valid pattern as a whole */
+    bool matches(const std::string& text) const {
+        return literal ? text == pattern : std::regex_match(text, *regex);
+    }
+
+private:
+    std::string pattern;
+
+    /** Whether the pattern has no meta-characters, matching the equal text only */
+    bool literal = false;
+
+    /** The compiled pattern, or null if it is literal or invalid */
+    std::unique_ptr<std::regex> regex;
+};
+
+/**
+ * The compiled patterns recently matched by the calling thread.
+ */
+class RegexCache {
+public:
+    /** Get the compiled pattern, compiling it unless it is cached by the calling thread */
+    static const CompiledRegex& get(const std::string& pattern) {
+        thread_local RegexCache cache;
+        return cache.lookup(pattern);
+    }
+
+private:
+    /** Number of cached patterns per thread */
+    static constexpr std::size_t capacity = 64;
+
+    /** The cached patterns, the most recently used first */
+    std::list<CompiledRegex> entries;
+
+    /** The position of each cached pattern in the list of entries */
+    std::unordered_map<std::string, std::list<CompiledRegex>::iterator> positions;
+
+    const CompiledRegex& lookup(const std::string& pattern) {
+        auto pos = positions.find(pattern);
+        if (pos != positions.end()) {
+            entries.splice(entries.begin(), entries, pos->second);
+            return entries.front();
+        }
+        if (entries.size() == capacity) {
+            positions.erase(entries.back().getPattern());
+            entries.pop_back();
+        }
+        entries.emplace_front(pattern);
+        positions[pattern] = entries.begin();
+        return entries.front();
+    }
+};
+
+}  // namespace souffle
@@ -30,6 +30,16 @@ enum class RelationRepresentation {
     BRIE,
     // equivalence relation
     EQREL,
+    // hash set data-structure
+    HASHSET,
+    // dense bitmap or adjacency data-structure for unary and binary relations
+    DENSE,
+    // subsumptive relation keeping the least last column of each key
+    MIN_LATTICE,
+    // subsumptive relation keeping the greatest last column of each key
+    MAX_LATTICE,
+    // b-tree buffer spilling sorted runs to disk
+    EXTERNAL,
     // info relation
     INFO
 };
@@ -45,6 +55,21 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation structu
         case RelationRepresentation::EQREL:
             os << "eqrel";
             break;
+        case RelationRepresentation::HASHSET:
+            os << "hashset";
+            break;
+        case RelationRepresentation::DENSE:
+            os << "dense";
+            break;
+        case RelationRepresentation::MIN_LATTICE:
+            os << "min";
+            break;
+        case RelationRepresentation::MAX_LATTICE:
+            os << "max";
+            break;
+        case RelationRepresentation::EXTERNAL:
+            os << "external";
+            break;
         case RelationRepresentation::INFO:
             os << "info";
             break;
@@ -26,6 +26,7 @@
 #include "AstUtils.h"
 #include "AstVisitor.h"
 #include "Global.h"
+#include <algorithm>
 #include <cmath>
 #include <set>
 #include <string>
@@ -330,15 +331,10 @@ std::vector<unsigned int> applySips(sips_t sipsFunction, std::vector<AstAtom*> a
     return newOrder;
 }
 
-AstClause* reorderClauseWithSips(sips_t sipsFunction, AstClause* clause) {
-    // ignore clauses with fixed execution plans
-    if (clause->getExecutionPlan() != nullptr) {
-        return nullptr;
-    }
-
-    // get the ordering corresponding to the SIPS
-    std::vector<unsigned int> newOrdering = applySips(sipsFunction, getBodyLiterals<AstAtom>(*clause));
-
+/**
+ * Reorders the atoms of a clause as given, returning nullptr if the order is unchanged.
+ */
+AstClause* reorderClauseWithOrdering(AstClause* clause, const std::vector<unsigned int>& newOrdering) {
     // check if we need a change
     bool changeNeeded = false;
     for (unsigned int i = 0; i < newOrdering.size(); i++) {
@@ -351,6 +347,17 @@ AstClause* reorderClauseWithSips(sips_t sipsFunction, AstClause* clause) {
     return changeNeeded ? reorderAtoms(clause, newOrdering) : nullptr;
 }
 
+AstClause* reorderClauseWithSips(sips_t sipsFunction, AstClause* clause) {
+    // ignore clauses with fixed execution plans
+    if (clause->getExecutionPlan() != nullptr) {
+        return nullptr;
+    }
+
+    // get the ordering corresponding to the SIPS
+    std::vector<unsigned int> newOrdering = applySips(sipsFunction, getBodyLiterals<AstAtom>(*clause));
+    return reorderClauseWithOrdering(clause, newOrdering);
+}
+
 bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit) {
     bool changed = false;
     AstProgram& program = *translationUnit.getProgram();
@@ -428,12 +435,19 @@ bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit)
             return currOptimalIdx;
         };
 
-        // change the ordering of literals within clauses
+        // change the ordering of literals within clauses, minimising the estimated cost of the join if
+        // the statistics of all atoms were collected and resorting to the profiler SIPS otherwise
         std::vector<AstClause*> clausesToRemove;
 
         for (const AstRelation* rel : program.getRelations()) {
             for (AstClause* clause : rel->getClauses()) {
-                AstClause* newClause = reorderClauseWithSips(profilerSips, clause);
+                const auto& atoms = getBodyLiterals<AstAtom>(*clause);
+                bool hasStatistics = std::all_of(atoms.begin(), atoms.end(),
+                        [&](const AstAtom* atom) { return profileUse->hasStatistics(atom->getName()); });
+                AstClause* newClause =
+                        hasStatistics && clause->getExecutionPlan() == nullptr
+                                ? reorderClauseWithOrdering(clause, profileUse->getCostBasedOrder(atoms))
+                                : reorderClauseWithSips(profilerSips, clause);
                 if (newClause != nullptr) {
                     // reordering needed - swap around
                     clausesToRemove.push_back(clause);
@@ -0,0 +1,168 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ResourceLimits.h
+ *
+ * The processors and memory available to the process, e.g., as limited
+ * by the control group of a container, and the memory it occupies
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace souffle {
+
+/**
+ * The processors and memory available to the process.
+ *
+ * Besides the processors the process may be scheduled on, the quota of CPU time and the memory limit of
+ * its control group are taken into account, such that the defaults of a program running in a container,
+ * e.g., in a pod with a CPU quota, do not exceed the share of the host assigned to it. Both the unified
+ * hierarchy of cgroup v2 and the controllers of cgroup v1 are read; the limits of the ancestors of the
+ * control group apply as well. The limits are read once.
+ */
+class ResourceLimits {
+public:
+    /** the number of processors available, the CPU quota of the control group being rounded up */
+    static std::size_t getProcessors() {
+        static const std::size_t processors = readProcessors();
+        return processors;
+    }
+
+    /** the memory limit of the control group in bytes, zero if there is none */
+    static std::size_t getMemoryLimit() {
+        static const std::size_t limit = readMemoryLimit();
+        return limit;
+    }
+
+    /** the memory available in bytes, i.e., the memory limit of the control group or the physical memory */
+    static std::size_t getMemory() {
+        const std::size_t limit = getMemoryLimit();
+        return limit > 0 ? limit : getPhysicalMemory();
+    }
+
+    /** the resident memory of the process in bytes, or its peak if the current one is not known */
+    static std::size_t getResidentMemory() {
+        std::ifstream statm("/proc/self/statm");
+        std::size_t size = 0;
+        std::size_t resident = 0;
+        if (statm >> size >> resident) {
+            return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        }
+        struct rusage ru {};
+        getrusage(RUSAGE_SELF, &ru);
+        return static_cast<std::size_t>(ru.ru_maxrss) * 1024;
+    }
+
+private:
+    static constexpr const char* cgroupRoot = "/sys/fs/cgroup";
+
+    static std::size_t getPhysicalMemory() {
+        const long pages = sysconf(_SC_PHYS_PAGES);
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        return (pages > 0 && pageSize > 0) ? static_cast<std::size_t>(pages) * pageSize : 0;
+    }
+
+    static std::size_t readProcessors() {
+        std::size_t processors = std::max(1u, std::thread::hardware_concurrency());
+#ifdef __linux__
+        cpu_set_t cpus;
+        if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+            processors = std::max(1, CPU_COUNT(&cpus));
+        }
+#endif
+        // cgroup v2, e.g. "150000 100000" for one and a half processors, or "max 100000"
+        for (const std::string& dir : getUnifiedGroups()) {
+            std::ifstream file(dir + "/cpu.max");
+            std::string quota;
+            double period = 0;
+            if (file >> quota >> period && quota != "max" && period > 0) {
+                processors = std::min(processors, roundUp(std::stod(quota) / period));
+            }
+        }
+        // cgroup v1, a quota of -1 being unlimited
+        double quota = readNumber(std::string(cgroupRoot) + "/cpu/cpu.cfs_quota_us");
+        double period = readNumber(std::string(cgroupRoot) + "/cpu/cpu.cfs_period_us");
+        if (quota > 0 && period > 0) {
+            processors = std::min(processors, roundUp(quota / period));
+        }
+        return processors;
+    }
+
+    static std::size_t readMemoryLimit() {
+        const std::size_t physical = getPhysicalMemory();
+        std::size_t limit = 0;
+        auto bound = [&](double bytes) {
+            // cgroup v1 reports the absence of a limit by a number beyond the physical memory
+            if (bytes > 0 && (physical == 0 || bytes < physical)) {
+                const auto value = static_cast<std::size_t>(bytes);
+                limit = (limit == 0) ? value : std::min(limit, value);
+            }
+        };
+        // cgroup v2, "max" if unlimited
+        for (const std::string& dir : getUnifiedGroups()) {
+            bound(readNumber(dir + "/memory.max"));
+        }
+        // cgroup v1
+        bound(readNumber(std::string(cgroupRoot) + "/memory/memory.limit_in_bytes"));
+        return limit;
+    }
+
+    /** the control group of the process in the unified hierarchy and its ancestors */
+    static std::vector<std::string> getUnifiedGroups() {
+        std::vector<std::string> res;
+        std::ifstream cgroups("/proc/self/cgroup");
+        std::string line;
+        while (std::getline(cgroups, line)) {
+            // the unified hierarchy is listed as "0::<path>"
+            if (line.compare(0, 3, "0::") != 0) {
+                continue;
+            }
+            std::string path = line.substr(3);
+            while (!path.empty() && path != "/") {
+                res.push_back(cgroupRoot + path);
+                path = path.substr(0, path.find_last_of('/'));
+            }
+        }
+        // inside a container, the group of the process is usually mounted as the root
+        res.push_back(cgroupRoot);
+        return res;
+    }
+
+    /** the number in the given file, or -1 if there is none, e.g., if the file is missing or "max" */
+    static double readNumber(const std::string& fileName) {
+        std::ifstream file(fileName);
+        double value = -1;
+        if (!(file >> value)) {
+            return -1;
+        }
+        return value;
+    }
+
+    static std::size_t roundUp(double processors) {
+        return std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(processors)));
+    }
+};
+
+}  // end of namespace souffle
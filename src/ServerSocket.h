@@ -0,0 +1,101 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ServerSocket.h
+ *
+ * Listening sockets of the servers of a program, i.e., the profile
+ * endpoint and the query server.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * Open a listening socket for an address, given as "unix:PATH" for a Unix socket, as "PORT" for a TCP
+ * port of the loopback interface, or as "HOST:PORT"; return -1 if it cannot be opened. The path of a
+ * Unix socket is stored in socketPath, to be unlinked once the socket is closed.
+ */
+inline int openServerSocket(const std::string& address, std::string& socketPath) {
+    auto fail = [](int fd) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    };
+    int fd = -1;
+    if (address.compare(0, 5, "unix:") == 0) {
+        sockaddr_un addr{};
+        const std::string path = address.substr(5);
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            return fail(fd);
+        }
+        socketPath = path;
+    } else {
+        const size_t colon = address.rfind(':');
+        const std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+        const std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        try {
+            addr.sin_port = htons(static_cast<uint16_t>(std::stoul(port)));
+        } catch (...) {
+            return -1;
+        }
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+            return -1;
+        }
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+                bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            return fail(fd);
+        }
+    }
+    if (listen(fd, 8) != 0) {
+        return fail(fd);
+    }
+    return fd;
+}
+
+/** Send data to a client; return whether all of it was sent */
+inline bool sendAll(int client, const std::string& data) {
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    // a client closing its connection early must not terminate the program
+    flags = MSG_NOSIGNAL;
+#endif
+    for (size_t sent = 0; sent < data.size();) {
+        const ssize_t count = send(client, data.data() + sent, data.size() - sent, flags);
+        if (count <= 0) {
+            return false;
+        }
+        sent += count;
+    }
+    return true;
+}
+
+}  // end of namespace souffle
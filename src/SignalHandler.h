@@ -19,10 +19,13 @@
 #include <atomic>
 #include <cassert>
 #include <csignal>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <map>
 #include <mutex>
 #include <string>
+#include <sys/time.h>
 
 namespace souffle {
 
@@ -43,37 +46,123 @@ public:
     void enableLogging() {
         logMessages = true;
     }
-    // set signal message
+    /***
+     * register the message of a rule and return its id for setRule(); registering the same message
+     * again returns the same id, and ids of messages exceeding the capacity are 0, i.e., no rule
+     */
+    std::size_t registerMsg(const std::string& m) {
+        std::lock_guard<std::mutex> guard(registerLock);
+        auto pos = msgIds.find(m);
+        if (pos != msgIds.end()) {
+            return pos->second;
+        }
+        const std::size_t id = msgIds.size() + 1;
+        if (id >= chunkSize * maxChunks) {
+            return 0;
+        }
+        RuleChunk* chunk = chunks[id / chunkSize].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new RuleChunk();
+            chunks[id / chunkSize].store(chunk, std::memory_order_release);
+        }
+        // the text is owned by the key of the map, whose nodes are never moved
+        pos = msgIds.emplace(m, id).first;
+        chunk->entries[id % chunkSize].msg.store(pos->first.c_str(), std::memory_order_release);
+        return id;
+    }
+
+    /***
+     * set the rule executed by the current thread to a registered id; only the id is recorded, its
+     * message is resolved if a signal is raised or sampled
+     */
+    void setRule(std::size_t id) {
+        if (logMessages) {
+            logRule(id);
+        }
+        threadRule() = id;
+        lastRule.store(id, std::memory_order_relaxed);
+        activeRule.store(id, std::memory_order_relaxed);
+    }
+
+    // set signal message, registering it first
     void setMsg(const char* m) {
-        if (logMessages && m != nullptr) {
-            static std::mutex outputMutex;
-            static bool sameLine = false;
-            std::lock_guard<std::mutex> guard(outputMutex);
-            if (msg != nullptr && strcmp(m, msg) == 0) {
-                std::cout << ".";
-                sameLine = true;
-            } else {
-                if (sameLine) {
-                    sameLine = false;
-                    std::cout << std::endl;
-                }
-                std::string outputMessage(m);
-                for (char& c : outputMessage) {
-                    if (c == '\n' || c == '\t') {
-                        c = ' ';
-                    }
+        if (m != nullptr) {
+            setRule(registerMsg(m));
+        }
+    }
+
+    // message of the rule executed by the current thread, or nullptr outside of rules
+    const char* getMsg() const {
+        return resolve(threadRule());
+    }
+
+    // clear the rule finished by the current thread, such that later samples are not attributed to
+    // it; the rule reported for signals is kept
+    void clearMsg() {
+        threadRule() = 0;
+        activeRule.store(0, std::memory_order_relaxed);
+    }
+
+    /***
+     * start sampling the rule executed by the interrupted thread every interval of CPU time of the
+     * process; a thread that has not set a message itself, e.g. the worker of a parallel loop, is
+     * sampled in the rule of the last message set by any thread
+     */
+    void startSampling(long intervalMicroseconds = 1000) {
+        if (sampling) {
+            return;
+        }
+        if ((prevProfHandler = signal(SIGPROF, sampleHandler)) == SIG_ERR) {
+            perror("Failed to set SIGPROF signal handler.");
+            exit(1);
+        }
+        itimerval timer{};
+        timer.it_interval.tv_sec = intervalMicroseconds / 1000000;
+        timer.it_interval.tv_usec = intervalMicroseconds % 1000000;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        sampling = true;
+    }
+
+    /***
+     * stop sampling and return the number of samples of each rule message; samples outside of
+     * rules, e.g. loading, merging and storing relations, are returned for the empty message
+     */
+    std::map<std::string, size_t> stopSampling() {
+        std::map<std::string, size_t> res;
+        if (!sampling) {
+            return res;
+        }
+        itimerval timer{};
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        signal(SIGPROF, prevProfHandler);
+        sampling = false;
+        for (std::size_t i = 0; i < maxChunks; ++i) {
+            RuleChunk* chunk = chunks[i].load(std::memory_order_acquire);
+            if (chunk == nullptr) {
+                break;
+            }
+            for (auto& entry : chunk->entries) {
+                const std::size_t count = entry.samples.exchange(0);
+                if (count > 0) {
+                    res[entry.msg.load(std::memory_order_acquire)] += count;
                 }
-                std::cout << "Starting work on " << outputMessage << std::endl;
             }
         }
-        msg = m;
+        const size_t other = otherSamples.exchange(0);
+        if (other > 0) {
+            res[""] += other;
+        }
+        return res;
     }
 
     /***
-     * set signal handlers
+     * set signal handlers; programs evaluated concurrently share them, such that they are set by the
+     * first evaluation and reset by the last one
      */
     void set() {
-        if (!isSet && std::getenv("SOUFFLE_ALLOW_SIGNALS") == nullptr) {
+        std::lock_guard<std::mutex> guard(setLock);
+        if (activeRuns++ == 0 && !isSet && std::getenv("SOUFFLE_ALLOW_SIGNALS") == nullptr) {
             // register signals
             // floating point exception
             if ((prevFpeHandler = signal(SIGFPE, handler)) == SIG_ERR) {
@@ -95,10 +184,14 @@ public:
     }
 
     /***
-     * reset signal handlers
+     * reset signal handlers, once no other evaluation needs them
      */
     void reset() {
-        if (isSet) {
+        std::lock_guard<std::mutex> guard(setLock);
+        if (activeRuns > 0) {
+            --activeRuns;
+        }
+        if (activeRuns == 0 && isSet) {
             // reset floating point exception
             if (signal(SIGFPE, prevFpeHandler) == SIG_ERR) {
                 perror("Failed to reset SIGFPE signal handler.");
@@ -123,6 +216,7 @@ public:
      */
 
     void error(const std::string& error) {
+        const char* msg = resolve(currentRule());
         if (msg != nullptr) {
             std::cerr << error << " in rule:\n" << msg << std::endl;
         } else {
@@ -132,24 +226,121 @@ public:
     }
 
 private:
-    // signal context information
-    std::atomic<const char*> msg;
+    // registered messages of rules and their samples, in chunks which are never freed or moved, such
+    // that signal handlers resolve ids without locking
+    struct RuleEntry {
+        std::atomic<const char*> msg{nullptr};
+        std::atomic<std::size_t> samples{0};
+    };
+    static constexpr std::size_t chunkSize = 1 << 10;
+    static constexpr std::size_t maxChunks = 1 << 10;
+    struct RuleChunk {
+        RuleEntry entries[chunkSize];
+    };
+    std::atomic<RuleChunk*> chunks[maxChunks] = {};
+    std::map<std::string, std::size_t> msgIds;
+    std::mutex registerLock;
+
+    // last rule of any thread, reported for signals of threads not executing a rule themselves
+    std::atomic<std::size_t> lastRule{0};
+
+    // rule being executed by any thread, for sampling
+    std::atomic<std::size_t> activeRule{0};
+
+    // samples outside of rules
+    std::atomic<size_t> otherSamples{0};
+    bool sampling = false;
 
     // state of signal handler
     bool isSet = false;
 
+    // number of evaluations between set() and reset()
+    std::size_t activeRuns = 0;
+    std::mutex setLock;
+
     bool logMessages = false;
 
+    // last logged rule, whose repetitions are logged as dots
+    std::size_t loggedRule = 0;
+
     // previous signal handler routines
     void (*prevFpeHandler)(int) = nullptr;
     void (*prevIntHandler)(int) = nullptr;
     void (*prevSegVHandler)(int) = nullptr;
+    void (*prevProfHandler)(int) = nullptr;
+
+    // rule being executed by the current thread
+    static std::size_t& threadRule() {
+        thread_local std::size_t id = 0;
+        return id;
+    }
+
+    // rule of the current thread, or of the last rule of any thread; errors and signals like
+    // segmentation violations are raised by the thread of the failing rule, which is not the rule of
+    // the last message if programs are evaluated concurrently
+    std::size_t currentRule() const {
+        return threadRule() != 0 ? threadRule() : lastRule.load(std::memory_order_relaxed);
+    }
+
+    // entry of a registered rule, or nullptr for no rule
+    RuleEntry* entry(std::size_t id) const {
+        RuleChunk* chunk = id == 0 ? nullptr : chunks[id / chunkSize].load(std::memory_order_acquire);
+        return chunk == nullptr ? nullptr : &chunk->entries[id % chunkSize];
+    }
+
+    // message of a registered rule, or nullptr for no rule
+    const char* resolve(std::size_t id) const {
+        RuleEntry* e = entry(id);
+        return e == nullptr ? nullptr : e->msg.load(std::memory_order_acquire);
+    }
+
+    // log the start of a rule
+    void logRule(std::size_t id) {
+        const char* m = resolve(id);
+        if (m == nullptr) {
+            return;
+        }
+        static std::mutex outputMutex;
+        static bool sameLine = false;
+        std::lock_guard<std::mutex> guard(outputMutex);
+        if (id == loggedRule) {
+            std::cout << ".";
+            sameLine = true;
+        } else {
+            if (sameLine) {
+                sameLine = false;
+                std::cout << std::endl;
+            }
+            std::string outputMessage(m);
+            for (char& c : outputMessage) {
+                if (c == '\n' || c == '\t') {
+                    c = ' ';
+                }
+            }
+            std::cout << "Starting work on " << outputMessage << std::endl;
+            loggedRule = id;
+        }
+    }
+
+    /**
+     * Sample handler, counting a sample for the rule of the interrupted thread without locking or
+     * allocating memory.
+     */
+    static void sampleHandler(int) {
+        SignalHandler& handler = *instance();
+        const std::size_t id = threadRule() != 0 ? threadRule() : handler.activeRule.load();
+        if (RuleEntry* e = handler.entry(id)) {
+            e->samples.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            handler.otherSamples.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
 
     /**
      * Signal handler for various types of signals.
      */
     static void handler(int signal) {
-        const char* msg = instance()->msg;
+        const char* msg = instance()->resolve(instance()->currentRule());
         std::string error;
         switch (signal) {
             case SIGINT:
@@ -173,7 +364,7 @@ private:
         exit(1);
     }
 
-    SignalHandler() : msg(nullptr) {}
+    SignalHandler() = default;
 };
 
 }  // namespace souffle
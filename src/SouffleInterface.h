@@ -16,20 +16,39 @@
 
 #pragma once
 
+#include "CheckpointFormat.h"
+#include "EvaluationLimits.h"
 #include "RamTypes.h"
+#include "RecordTable.h"
+#include "SubroutineCache.h"
+#include "SymbolDictionary.h"
 #include "SymbolTable.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <cassert>
 #include <cstddef>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace souffle {
 
 class tuple;
@@ -267,6 +286,26 @@ public:
      */
     virtual void insert(const tuple& t) = 0;
 
+    /**
+     * Insert a batch of tuples into the relation.
+     *
+     * The tuples are stored consecutively, each of them as getArity() elements. Symbols have to be
+     * looked up in the symbol table of the program beforehand. The default implementation inserts the
+     * tuples one by one; derived classes insert the batch directly into the underlying indexes.
+     *
+     * @param data Pointer to numTuples * getArity() elements
+     * @param numTuples The number of tuples
+     */
+    virtual void insertBatch(const RamDomain* data, std::size_t numTuples);
+
+    /**
+     * Insert a batch of tuples, given column by column, into the relation.
+     *
+     * @param columns Array of getArity() pointers, each referring to the numTuples elements of an attribute
+     * @param numTuples The number of tuples
+     */
+    virtual void insertBatchColumns(const RamDomain* const* columns, std::size_t numTuples);
+
     /**
      * Check whether a tuple exists in a relation.
      * The definition of contains has to be defined by the child class of relation class.
@@ -291,6 +330,34 @@ public:
      */
     virtual iterator end() const = 0;
 
+    /**
+     * Hand out all tuples of the relation in batches.
+     *
+     * The callback receives up to batchSize tuples at a time, stored consecutively as getArity()
+     * elements each. The storage is reused for the next batch, so the callback must copy what it
+     * keeps. The default implementation collects the tuples through the iterator; derived classes
+     * read them directly from the underlying indexes.
+     *
+     * @param callback Function called with a pointer to the tuples of a batch and their number
+     * @param batchSize The maximal number of tuples per batch
+     */
+    virtual void scanBatches(const std::function<void(const RamDomain*, std::size_t)>& callback,
+            std::size_t batchSize = 1024) const;
+
+    /**
+     * Hand out the tuples of the relation whose given columns have the given values.
+     *
+     * The tuples are looked up in the index that binds the most of the given columns, such that a
+     * lookup by a prefix of an index takes logarithmic rather than linear time. The default
+     * implementation scans the relation; derived classes search their underlying indexes.
+     *
+     * @param columns The positions of the bound attributes
+     * @param values The values of the bound attributes, one for each of the columns
+     * @param callback Function called with each matching tuple
+     */
+    virtual void equalRange(const std::vector<std::size_t>& columns, const std::vector<RamDomain>& values,
+            const std::function<void(const tuple&)>& callback) const;
+
     /**
      * Get the number of tuples in a relation.
      *
@@ -387,6 +454,54 @@ public:
      * in the table, set the next element pointer points to the current element itself.
      */
     virtual void purge() = 0;
+
+    /**
+     * Get the name of the type of the data structure holding the tuples of the relation, which is the
+     * same for relations of the same representation and indexes in programs compiled by the same
+     * version of souffle, or the empty string if the relation cannot share its data structure.
+     */
+    virtual std::string getDataType() const {
+        return "";
+    }
+
+    /**
+     * Share the data structure holding the tuples of the relation, of the type named by getDataType(),
+     * or return nullptr if it cannot be shared.
+     */
+    virtual std::shared_ptr<void> shareData() const {
+        return nullptr;
+    }
+
+    /**
+     * Hold the data structure of the given relation instead of the tuples of this one, without copying
+     * it, if both are of the same data type. Not concurrently with other accesses of either relation.
+     *
+     * @param other The relation whose data structure is adopted (const Relation&)
+     * @return Whether the data structure was adopted
+     */
+    virtual bool adoptData(const Relation& /* other */) {
+        return false;
+    }
+
+    /**
+     * Get the number of modifications of the relation through this interface, by which the results
+     * computed from its tuples, e.g. the cached results of subroutines, are invalidated. Evaluations of
+     * the program are not counted, as they invalidate such results themselves.
+     */
+    std::size_t getVersion() const {
+        return version.load(std::memory_order_acquire);
+    }
+
+protected:
+    /**
+     * Count a modification of the relation, after its tuples were changed.
+     */
+    void modified() {
+        version.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<std::size_t> version{0};
 };
 
 /**
@@ -591,6 +706,63 @@ public:
     }
 };
 
+inline void Relation::scanBatches(
+        const std::function<void(const RamDomain*, std::size_t)>& callback, std::size_t batchSize) const {
+    assert(batchSize > 0 && "empty batches");
+    const std::size_t arity = getArity();
+    std::vector<RamDomain> buffer(batchSize * arity);
+    std::size_t count = 0;
+    for (const tuple& t : *this) {
+        for (std::size_t j = 0; j < arity; ++j) {
+            buffer[count * arity + j] = t[j];
+        }
+        if (++count == batchSize) {
+            callback(buffer.data(), count);
+            count = 0;
+        }
+    }
+    if (count > 0) {
+        callback(buffer.data(), count);
+    }
+}
+
+inline void Relation::equalRange(const std::vector<std::size_t>& columns,
+        const std::vector<RamDomain>& values, const std::function<void(const tuple&)>& callback) const {
+    assert(columns.size() == values.size() && "mismatching columns and values");
+    for (const tuple& t : *this) {
+        bool matches = true;
+        for (std::size_t i = 0; i < columns.size() && matches; ++i) {
+            assert(columns[i] < getArity() && "attribute out of bound");
+            matches = t[columns[i]] == values[i];
+        }
+        if (matches) {
+            callback(t);
+        }
+    }
+}
+
+inline void Relation::insertBatch(const RamDomain* data, std::size_t numTuples) {
+    const std::size_t arity = getArity();
+    tuple t(this);
+    for (std::size_t i = 0; i < numTuples; ++i) {
+        for (std::size_t j = 0; j < arity; ++j) {
+            t[j] = data[i * arity + j];
+        }
+        insert(t);
+    }
+}
+
+inline void Relation::insertBatchColumns(const RamDomain* const* columns, std::size_t numTuples) {
+    const std::size_t arity = getArity();
+    std::vector<RamDomain> data(numTuples * arity);
+    for (std::size_t j = 0; j < arity; ++j) {
+        for (std::size_t i = 0; i < numTuples; ++i) {
+            data[i * arity + j] = columns[j][i];
+        }
+    }
+    insertBatch(data.data(), numTuples);
+}
+
 /**
  * Abstract base class for generated Datalog programs.
  */
@@ -625,6 +797,64 @@ private:
     std::vector<Relation*> allRelations;
     std::size_t numThreads = 1;
 
+    /**
+     * The insertions (true) and removals (false) scheduled for the next incremental update, holding the
+     * last change of each tuple of a relation.
+     */
+    std::map<Relation*, std::map<std::vector<RamDomain>, bool>> scheduledChanges;
+
+    /**
+     * The names of the base relations, which are kept by reset() and shared by forks.
+     */
+    std::set<std::string> baseRelations;
+
+    /**
+     * The names of the input relations migrated from a previous version of the program, which
+     * loadAll() skips.
+     */
+    std::set<std::string> migratedRelations;
+
+    /**
+     * The relations read by the subroutines which do not write relations, whose results may hence be
+     * cached; relations which are not accessible through this interface are only changed by evaluations.
+     */
+    std::map<std::string, std::vector<const Relation*>> cachedSubroutines;
+
+    /**
+     * The cached results of subroutines, or nullptr if they are not cached.
+     */
+    std::unique_ptr<SubroutineCache> subroutineCache;
+
+    /**
+     * The number of evaluations and other changes of relations not counted by their versions, e.g.
+     * loads, executions of subroutines writing relations and migrations.
+     */
+    std::atomic<std::size_t> evaluations{0};
+
+    /**
+     * Get the versions of the relations read by a cached subroutine, following the evaluations.
+     */
+    std::vector<std::size_t> getSubroutineVersions(const std::vector<const Relation*>& reads) const {
+        std::vector<std::size_t> versions;
+        versions.reserve(reads.size() + 1);
+        versions.push_back(evaluations.load(std::memory_order_acquire));
+        for (const Relation* relation : reads) {
+            versions.push_back(relation->getVersion());
+        }
+        return versions;
+    }
+
+    /**
+     * Schedule a change of the relation of the given tuple for the next incremental update.
+     */
+    void scheduleChange(const tuple& t, bool insertion) {
+        std::vector<RamDomain> values(t.size());
+        for (size_t i = 0; i < t.size(); ++i) {
+            values[i] = t[i];
+        }
+        scheduledChanges[const_cast<Relation*>(&t.getRelation())][values] = insertion;
+    }
+
 protected:
     /**
      * Add the relation to relationMap (with its name) and allRelations,
@@ -651,6 +881,111 @@ protected:
         }
     }
 
+    /**
+     * Get the symbol table of a previous version of the program, if it interns the given symbols of
+     * this one at the same indices, which the compiled program uses for its constants, or otherwise a
+     * new symbol table of them.
+     */
+    static std::shared_ptr<SymbolTable> adoptSymbolTable(
+            const SouffleProgram& previous, const char* const* symbols, std::size_t numSymbols) {
+        std::shared_ptr<SymbolTable> shared = previous.shareSymbolTable();
+        if (shared != nullptr && shared->size() >= numSymbols) {
+            std::size_t i = 0;
+            while (i < numSymbols && shared->resolve(i) == symbols[i]) {
+                ++i;
+            }
+            if (i == numSymbols) {
+                return shared;
+            }
+        }
+        return std::make_shared<SymbolTable>(symbols, numSymbols);
+    }
+
+    /**
+     * Get the record table of a previous version of the program, if this one adopted its symbol table,
+     * or otherwise a new record table.
+     */
+    static std::shared_ptr<RecordTable> adoptRecordTable(
+            const SouffleProgram& previous, const std::shared_ptr<SymbolTable>& symbols) {
+        std::shared_ptr<RecordTable> shared = previous.shareRecordTable();
+        if (shared != nullptr && symbols == previous.shareSymbolTable()) {
+            return shared;
+        }
+        return std::make_shared<RecordTable>();
+    }
+
+    /**
+     * Adopt the base relations, the number of threads and the size of the subroutine cache of the
+     * program this one is forked from.
+     */
+    void adoptBase(const SouffleProgram& base) {
+        baseRelations = base.baseRelations;
+        numThreads = base.numThreads;
+        limits.adopt(base.limits);
+        if (base.subroutineCache != nullptr) {
+            setSubroutineCacheSize(base.subroutineCache->getCapacity());
+        }
+    }
+
+    /**
+     * Declare a subroutine which does not write relations, such that its results may be cached until
+     * the relations of the given names which it reads change.
+     */
+    void addCachedSubroutine(const std::string& name, const std::vector<std::string>& reads) {
+        std::vector<const Relation*>& relations = cachedSubroutines[name];
+        for (const std::string& read : reads) {
+            if (const Relation* relation = getRelation(read)) {
+                relations.push_back(relation);
+            }
+        }
+    }
+
+    /**
+     * Look up the cached result of a subroutine for the given arguments, and return whether it was
+     * found, i.e. the subroutine is cached and the relations it reads did not change since its result
+     * was stored.
+     */
+    bool lookupSubroutine(const std::string& name, const std::vector<RamDomain>& args,
+            std::vector<RamDomain>& ret) const {
+        if (subroutineCache == nullptr) {
+            return false;
+        }
+        auto pos = cachedSubroutines.find(name);
+        return pos != cachedSubroutines.end() &&
+               subroutineCache->lookup(name, args, ret, getSubroutineVersions(pos->second));
+    }
+
+    /**
+     * Store the result of an executed subroutine for the given arguments. The results of all
+     * subroutines are invalidated instead if the subroutine may have written relations.
+     */
+    void storeSubroutine(const std::string& name, const std::vector<RamDomain>& args,
+            const std::vector<RamDomain>& ret) {
+        if (subroutineCache == nullptr) {
+            return;
+        }
+        auto pos = cachedSubroutines.find(name);
+        if (pos == cachedSubroutines.end()) {
+            invalidateSubroutines();
+            return;
+        }
+        subroutineCache->insert(name, args, ret, getSubroutineVersions(pos->second));
+    }
+
+    /**
+     * Invalidate the cached results of subroutines, once the relations are changed other than through
+     * this interface, e.g. by an evaluation or a load.
+     */
+    void invalidateSubroutines() {
+        evaluations.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * The cancellation token and the budgets of the evaluations of the program, checked while the
+     * program is evaluated.
+     */
+    EvaluationLimits limits;
+
 public:
     /**
      * Destructor.
@@ -702,7 +1037,8 @@ public:
     virtual void dumpOutputs(std::ostream& out = std::cout) = 0;
 
     /**
-     * Set the number of threads to be used
+     * Set the number of threads to be used; if unset, the program uses the threads that programs
+     * evaluated concurrently in the process have not leased (see ThreadBudget)
      */
     void setNumThreads(std::size_t numThreadsValue) {
         this->numThreads = numThreadsValue;
@@ -715,6 +1051,56 @@ public:
         return numThreads;
     }
 
+    /**
+     * Abort the evaluations of the program by an EvaluationAborted exception once the given token is
+     * cancelled. The relations keep the tuples derived so far, which reset() removes.
+     *
+     * @param token The cancellation token (const CancellationToken&)
+     */
+    void setCancellationToken(const CancellationToken& token) {
+        limits.setCancellationToken(token);
+    }
+
+    /**
+     * Abort an evaluation of the program by an EvaluationAborted exception once it took longer than the
+     * given time; zero disables the budget.
+     *
+     * @param budget The wall time of an evaluation (std::chrono::milliseconds)
+     */
+    void setTimeBudget(std::chrono::milliseconds budget) {
+        limits.setTimeBudget(budget);
+    }
+
+    /**
+     * Abort an evaluation of the program by an EvaluationAborted exception once the resident memory of the
+     * process exceeds the given number of bytes; zero disables the budget.
+     *
+     * @param bytes The resident memory of the process (std::size_t)
+     */
+    void setMemoryBudget(std::size_t bytes) {
+        limits.setMemoryBudget(bytes);
+    }
+
+    /**
+     * Cache the results of subroutines which do not write relations, keyed by the subroutine and its
+     * arguments, such that repeated calls, e.g. the queries of explanations or of a service, are looked
+     * up rather than evaluated again. Results are invalidated once the relations a subroutine reads are
+     * modified through this interface, and by evaluations and loads of the program. The least recently
+     * used results are evicted once they exceed the given number of bytes; zero disables the cache,
+     * which is the default.
+     *
+     * @param bytes The estimated size of the cached results (std::size_t)
+     */
+    void setSubroutineCacheSize(std::size_t bytes) {
+        if (bytes == 0) {
+            subroutineCache.reset();
+        } else if (subroutineCache == nullptr) {
+            subroutineCache = std::make_unique<SubroutineCache>(bytes);
+        } else {
+            subroutineCache->setCapacity(bytes);
+        }
+    }
+
     /**
      * Get Relation by its name from relationMap, if relation not found, return a nullptr.
      *
@@ -792,7 +1178,34 @@ public:
     }
 
     /**
-     * Execute a subroutine
+     * Schedule the insertion of a tuple into an input relation. The insertion takes effect on the next
+     * call of updateIncremental().
+     *
+     * @param t The inserted tuple, belonging to the input relation (const tuple&)
+     */
+    void insert(const tuple& t) {
+        scheduleChange(t, true);
+    }
+
+    /**
+     * Schedule the removal of a tuple from an input relation. The removal takes effect on the next
+     * call of updateIncremental().
+     *
+     * @param t The removed tuple, belonging to the input relation (const tuple&)
+     */
+    void remove(const tuple& t) {
+        scheduleChange(t, false);
+    }
+
+    /**
+     * Apply the scheduled insertions and removals to the input relations and update the relations
+     * computed from them. Programs translated with --incremental only evaluate the consequences of the
+     * changes; other programs are evaluated again from their changed input relations.
+     */
+    virtual void updateIncremental();
+
+    /**
+     * Execute a subroutine, possibly concurrently with other subroutines
      * @param name  Name of a subroutine (std:string)
      * @param arg Arguments of the subroutine (std::vector<RamDomain>&)
      * @param ret Return values of the subroutine (std::vector<RamDomain>&)
@@ -800,11 +1213,115 @@ public:
     virtual void executeSubroutine(
             std::string name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) {}
 
+    /**
+     * Execute a subroutine for each of a batch of argument vectors, e.g. to answer many parameterised
+     * queries at once. The evaluations are distributed over the threads of the program.
+     * @param name  Name of a subroutine
+     * @param args Argument vectors of the evaluations
+     * @param ret Return values of the evaluations, in the order of their argument vectors
+     */
+    virtual void executeSubroutines(const std::string& name, const std::vector<std::vector<RamDomain>>& args,
+            std::vector<std::vector<RamDomain>>& ret) {
+        ret.assign(args.size(), std::vector<RamDomain>());
+        for (std::size_t i = 0; i < args.size(); i++) {
+            executeSubroutine(name, args[i], ret[i]);
+        }
+    }
+
     /**
      * Get the symbol table of the program.
      */
     virtual SymbolTable& getSymbolTable() = 0;
 
+    /**
+     * Get the record table of the program.
+     */
+    virtual RecordTable& getRecordTable() = 0;
+
+    /**
+     * Share the symbol table of the program with the programs reloaded from it, or return nullptr if
+     * it cannot be shared.
+     */
+    virtual std::shared_ptr<SymbolTable> shareSymbolTable() const {
+        return nullptr;
+    }
+
+    /**
+     * Share the record table of the program with the programs reloaded from it, or return nullptr if
+     * it cannot be shared.
+     */
+    virtual std::shared_ptr<RecordTable> shareRecordTable() const {
+        return nullptr;
+    }
+
+    /**
+     * Migrate the input relations of a previous version of the program into this one, which is
+     * reloaded from it, e.g. an instance of a changed rule set compiled into a shared library. An input
+     * relation is migrated if the previous program has a relation of the same name, attribute types and
+     * data type, i.e. the same representation and indexes, whose data structure is then shared rather
+     * than copied. Relations of symbols and records are only migrated if this program shares the symbol
+     * and record tables of the previous one. The other input relations are left empty, to be loaded by
+     * loadAll(), which skips the migrated ones; run() then evaluates the program.
+     *
+     * @param previous The previous version of the program (SouffleProgram&)
+     * @return The names of the migrated relations
+     */
+    std::vector<std::string> migrateRelations(SouffleProgram& previous) {
+        const bool sharedTables = &getSymbolTable() == &previous.getSymbolTable() &&
+                                  &getRecordTable() == &previous.getRecordTable();
+        std::vector<std::string> migrated;
+        for (Relation* relation : inputRelations) {
+            const Relation* old = previous.getRelation(relation->getName());
+            if (old == nullptr || old->getArity() != relation->getArity() ||
+                    old->getAuxiliaryArity() != relation->getAuxiliaryArity()) {
+                continue;
+            }
+            bool sameTypes = true;
+            bool usesTables = false;
+            for (size_t i = 0; i < relation->getArity(); ++i) {
+                const std::string type = relation->getAttrType(i);
+                sameTypes = sameTypes && type == old->getAttrType(i);
+                usesTables = usesTables || type[0] == 's' || type[0] == 'r';
+            }
+            if (sameTypes && (sharedTables || !usesTables) && relation->adoptData(*old)) {
+                migrated.push_back(relation->getName());
+            }
+        }
+        migratedRelations = std::set<std::string>(migrated.begin(), migrated.end());
+        numThreads = previous.numThreads;
+        return migrated;
+    }
+
+    /**
+     * Return whether the relation of the given name was migrated from a previous version of the
+     * program, and is hence not loaded by loadAll().
+     *
+     * @param name The name of the relation (const std::string&)
+     * @see migrateRelations()
+     */
+    bool isMigratedRelation(const std::string& name) const {
+        return migratedRelations.count(name) > 0;
+    }
+
+    /**
+     * Write the tuples of all relations, the symbol table and the record table to a checkpoint file.
+     * The file is replaced atomically, hence it holds a complete state even if the program is
+     * interrupted while writing.
+     *
+     * @param filename The name of the checkpoint file (const std::string&)
+     * @param completedStrata The number of evaluated strata of the program recorded in the checkpoint
+     */
+    void checkpoint(const std::string& filename, std::size_t completedStrata = 0);
+
+    /**
+     * Replace the tuples of all relations by those of a checkpoint written by an instance of the same
+     * program, extending the symbol table and the record table by the recorded symbols and records.
+     *
+     * @param filename The name of the checkpoint file (const std::string&)
+     * @return The number of evaluated strata recorded in the checkpoint
+     */
+    std::size_t restore(const std::string& filename);
+
     /**
      * Remove all the tuples from the outputRelations, calling the purge method of each.
      *
@@ -838,6 +1355,66 @@ public:
         }
     }
 
+    /**
+     * Declare the relations holding the facts shared by all evaluations of the program, e.g. a large
+     * fact base loaded once, on top of which small sets of facts are evaluated one after the other.
+     *
+     * Base relations are kept by reset() and shared by fork(). They should be input relations that no
+     * rule derives tuples for, or relations derived from base relations only, whose strata the
+     * evaluations then skip. Inserting tuples into a shared base relation through this interface copies
+     * it first, and purging it drops the share, such that only the modifying program observes the
+     * change, e.g. a fork evaluating a variant of the base with a few more facts.
+     *
+     * @param names The names of the base relations (const std::vector<std::string>&)
+     */
+    void setBaseRelations(const std::vector<std::string>& names) {
+        for (const std::string& name : names) {
+            if (getRelation(name) == nullptr) {
+                throw std::invalid_argument("Unknown base relation " + name);
+            }
+        }
+        baseRelations = std::set<std::string>(names.begin(), names.end());
+    }
+
+    /**
+     * Return whether the relation of the given name is a base relation.
+     *
+     * @param name The name of the relation (const std::string&)
+     * @see setBaseRelations()
+     */
+    bool isBaseRelation(const std::string& name) const {
+        return baseRelations.count(name) > 0;
+    }
+
+    /**
+     * Remove all the tuples but those of the base relations, and the scheduled changes, such that the
+     * program can evaluate another set of facts on top of the base relations. Unlike creating a new
+     * instance, this neither constructs relations nor reloads the base relations.
+     *
+     * @see setBaseRelations()
+     */
+    void reset() {
+        for (Relation* relation : allRelations) {
+            if (!isBaseRelation(relation->getName())) {
+                relation->purge();
+            }
+        }
+        scheduledChanges.clear();
+    }
+
+    /**
+     * Create an instance of the program sharing the base relations, the symbol table and the record
+     * table of this one, without copying them. All other relations of the fork start empty. Forks are
+     * evaluated by run(), and may be evaluated concurrently. A base relation is only copied once the
+     * fork, or this program, inserts into it.
+     *
+     * @return The fork, owned by the caller, or nullptr if the program cannot be forked
+     * @see setBaseRelations()
+     */
+    virtual SouffleProgram* fork() const {
+        return nullptr;
+    }
+
     /**
      * Helper function for the wrapper function Relation::insert() and Relation::contains().
      */
@@ -890,6 +1467,238 @@ public:
     }
 };
 
+inline void SouffleProgram::updateIncremental() {
+    if (scheduledChanges.empty()) {
+        return;
+    }
+
+    // incremental programs provide relations receiving the changes of each input relation
+    bool incremental = true;
+    for (const auto& changes : scheduledChanges) {
+        const std::string& name = changes.first->getName();
+        incremental = incremental && getRelation("@add_" + name) != nullptr &&
+                      getRelation("@del_" + name) != nullptr;
+    }
+
+    std::map<Relation*, std::set<std::vector<RamDomain>>> removals;
+    for (const auto& changes : scheduledChanges) {
+        Relation* relation = changes.first;
+        tuple t(relation);
+        for (const auto& change : changes.second) {
+            const std::vector<RamDomain>& values = change.first;
+            for (size_t i = 0; i < values.size(); ++i) {
+                t[i] = values[i];
+            }
+            // only record the changes modifying the relation
+            if (change.second == relation->contains(t)) {
+                continue;
+            }
+            if (incremental) {
+                getRelation((change.second ? "@add_" : "@del_") + relation->getName())
+                        ->insertBatch(values.data(), 1);
+            } else if (change.second) {
+                relation->insert(t);
+            } else {
+                removals[relation].insert(values);
+            }
+        }
+    }
+    scheduledChanges.clear();
+
+    if (incremental) {
+        std::vector<RamDomain> args, ret;
+        executeSubroutine("incremental", args, ret);
+        return;
+    }
+
+    // otherwise rebuild the relations with removals and evaluate the program again
+    for (const auto& cur : removals) {
+        Relation* relation = cur.first;
+        const size_t arity = relation->getArity();
+        std::vector<RamDomain> remaining;
+        relation->scanBatches([&](const RamDomain* data, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                std::vector<RamDomain> values(data + i * arity, data + (i + 1) * arity);
+                if (cur.second.find(values) == cur.second.end()) {
+                    remaining.insert(remaining.end(), values.begin(), values.end());
+                }
+            }
+        });
+        relation->purge();
+        relation->insertBatch(remaining.data(), arity == 0 ? 0 : remaining.size() / arity);
+    }
+    for (Relation* relation : allRelations) {
+        if (std::find(inputRelations.begin(), inputRelations.end(), relation) == inputRelations.end()) {
+            relation->purge();
+        }
+    }
+    run();
+}
+
+inline void SouffleProgram::checkpoint(const std::string& filename, std::size_t completedStrata) {
+    SymbolTable& symbolTable = getSymbolTable();
+    RecordTable& recordTable = getRecordTable();
+    const std::vector<size_t> recordArities = recordTable.getArities();
+
+    // write a temporary file first, replacing the checkpoint once it is complete
+    const std::string tempName = filename + ".tmp";
+    std::ofstream file(tempName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open checkpoint file " + tempName);
+    }
+    const char zeros[8] = {};
+    const auto write = [&](const void* data, uint64_t size) {
+        file.write(reinterpret_cast<const char*>(data), size);
+        file.write(zeros, alignCheckpointOffset(size) - size);
+    };
+    const auto writeNumber = [&](uint64_t value) { write(&value, sizeof(value)); };
+
+    const auto header = CheckpointHeader::create(
+            completedStrata, symbolTable.size(), recordArities.size(), allRelations.size());
+    write(&header, sizeof(header));
+
+    for (size_t i = 0; i < symbolTable.size(); ++i) {
+        const std::string& symbol = symbolTable.unsafeResolve(i);
+        writeNumber(symbol.size());
+        write(symbol.data(), symbol.size());
+    }
+
+    for (size_t arity : recordArities) {
+        const size_t count = recordTable.size(arity);
+        writeNumber(arity);
+        writeNumber(count);
+        std::vector<RamDomain> records;
+        records.reserve(count * arity);
+        for (size_t ref = 1; ref <= count; ++ref) {
+            const RamDomain* record = recordTable.unpack(static_cast<RamDomain>(ref), arity);
+            records.insert(records.end(), record, record + arity);
+        }
+        write(records.data(), records.size() * sizeof(RamDomain));
+    }
+
+    for (const Relation* relation : allRelations) {
+        const std::string name = relation->getName();
+        const uint64_t arity = relation->getArity();
+        writeNumber(name.size());
+        write(name.data(), name.size());
+        writeNumber(arity);
+
+        // the number of tuples is known once they have been written
+        const auto countPos = file.tellp();
+        writeNumber(0);
+        uint64_t count = 0;
+        relation->scanBatches([&](const RamDomain* data, std::size_t numTuples) {
+            file.write(reinterpret_cast<const char*>(data), numTuples * arity * sizeof(RamDomain));
+            count += numTuples;
+        });
+        const uint64_t size = count * arity * sizeof(RamDomain);
+        file.write(zeros, alignCheckpointOffset(size) - size);
+        const auto endPos = file.tellp();
+        file.seekp(countPos);
+        writeNumber(count);
+        file.seekp(endPos);
+    }
+
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Cannot write checkpoint file " + tempName);
+    }
+    if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace checkpoint file " + filename);
+    }
+}
+
+inline std::size_t SouffleProgram::restore(const std::string& filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open checkpoint file " + filename);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot open checkpoint file " + filename);
+    }
+    const auto size = static_cast<uint64_t>(info.st_size);
+    void* data = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    close(fd);
+    if (data == MAP_FAILED || data == nullptr) {
+        throw std::runtime_error("Cannot map checkpoint file " + filename);
+    }
+
+    const char* base = static_cast<const char*>(data);
+    uint64_t offset = 0;
+    // obtain the next item of the file, skipping its padding
+    const auto next = [&](uint64_t length) {
+        if (length > size - offset || alignCheckpointOffset(offset + length) > size) {
+            throw std::runtime_error("Truncated checkpoint file " + filename);
+        }
+        const char* item = base + offset;
+        offset = alignCheckpointOffset(offset + length);
+        return item;
+    };
+    const auto nextNumber = [&]() {
+        uint64_t value;
+        std::memcpy(&value, next(sizeof(value)), sizeof(value));
+        return value;
+    };
+    const auto mismatch = [&]() {
+        return std::runtime_error("Checkpoint file " + filename + " was not written by this program");
+    };
+
+    try {
+        CheckpointHeader header;
+        std::memcpy(&header, next(sizeof(header)), sizeof(header));
+        if (!header.isValid()) {
+            throw std::runtime_error("Invalid checkpoint file " + filename);
+        }
+
+        // symbols and records keep the indices and references they had when being recorded
+        SymbolTable& symbolTable = getSymbolTable();
+        for (uint64_t i = 0; i < header.numSymbols; ++i) {
+            const uint64_t length = nextNumber();
+            const std::string_view symbol(next(length), length);
+            if (i < symbolTable.size() ? symbolTable.unsafeResolve(i) != symbol
+                                       : symbolTable.lookup(symbol) != static_cast<RamDomain>(i)) {
+                throw mismatch();
+            }
+        }
+
+        RecordTable& recordTable = getRecordTable();
+        for (uint64_t i = 0; i < header.numRecordArities; ++i) {
+            const uint64_t arity = nextNumber();
+            const uint64_t count = nextNumber();
+            const auto* records = reinterpret_cast<const RamDomain*>(next(count * arity * sizeof(RamDomain)));
+            for (uint64_t ref = 1; ref <= count; ++ref) {
+                if (recordTable.pack(records + (ref - 1) * arity, arity) != static_cast<RamDomain>(ref)) {
+                    throw mismatch();
+                }
+            }
+        }
+
+        for (Relation* relation : allRelations) {
+            relation->purge();
+        }
+        for (uint64_t i = 0; i < header.numRelations; ++i) {
+            const uint64_t length = nextNumber();
+            const std::string name(next(length), length);
+            const uint64_t arity = nextNumber();
+            const uint64_t count = nextNumber();
+            const auto* tuples = reinterpret_cast<const RamDomain*>(next(count * arity * sizeof(RamDomain)));
+            Relation* relation = getRelation(name);
+            if (relation == nullptr || relation->getArity() != arity) {
+                throw mismatch();
+            }
+            relation->insertBatch(tuples, count);
+        }
+
+        munmap(data, size);
+        return header.completedStrata;
+    } catch (...) {
+        munmap(data, size);
+        throw;
+    }
+}
+
 /**
  * Abstract program factory class.
  */
@@ -969,6 +1778,16 @@ protected:
      */
     virtual SouffleProgram* newInstance() = 0;
 
+    /**
+     * Create an instance reloaded from a previous version of the program, sharing its symbol and
+     * record tables if they are compatible, or return nullptr if the program cannot be reloaded.
+     *
+     * @see SouffleProgram::migrateRelations()
+     */
+    virtual SouffleProgram* reloadInstance(const SouffleProgram& /* previous */) {
+        return nullptr;
+    }
+
 public:
     /**
      * Destructor.
@@ -992,5 +1811,19 @@ public:
             return nullptr;
         }
     }
+
+    /**
+     * Create an instance of the program of the given name reloaded from a previous version of it,
+     * return nullptr if the program is not found or cannot be reloaded. The input relations of the
+     * previous version are then migrated by SouffleProgram::migrateRelations().
+     *
+     * @param name Instance name (const std::string)
+     * @param previous The previous version of the program (const SouffleProgram&)
+     * @return The new instance (SouffleProgram*), or null pointer
+     */
+    static SouffleProgram* reloadInstance(const std::string& name, const SouffleProgram& previous) {
+        ProgramFactory* factory = find(name);
+        return factory != nullptr ? factory->reloadInstance(previous) : nullptr;
+    }
 };
 }  // namespace souffle
@@ -20,15 +20,25 @@
 #include <cstdio>
 #include <fstream>
 #include <limits>
+#include <mutex>
+#include <set>
 #include <sstream>
 
 namespace souffle {
 
+void SrcLocation::setFilename(const std::string& filename) {
+    // file names are few and live as long as the program; nodes are located concurrently by transformers
+    static std::mutex mutex;
+    static std::set<std::string> filenames;
+    std::lock_guard<std::mutex> guard(mutex);
+    file = &*filenames.insert(filename).first;
+}
+
 std::string SrcLocation::extloc() const {
-    std::ifstream in(filename);
+    std::ifstream in(getFilename());
     std::stringstream s;
     if (in.is_open()) {
-        s << "file " << baseName(filename) << " at line " << start.line << "\n";
+        s << "file " << baseName(getFilename()) << " at line " << start.line << "\n";
         for (int i = 0; i < start.line - 1; ++i) {
             in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         }
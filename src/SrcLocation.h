@@ -52,22 +52,30 @@ public:
         }
     };
 
-    /** The file referred to */
-    std::string filename;
-
     /** The start location */
     Point start = {};
 
     /** The End location */
     Point end = {};
 
+    /** The file referred to */
+    const std::string& getFilename() const {
+        static const std::string none;
+        return file != nullptr ? *file : none;
+    }
+
+    /** Set the file referred to; the names of files are shared by all locations referring to them */
+    void setFilename(const std::string& filename);
+
     /** A comparison for source locations */
     bool operator<(const SrcLocation& other) const {
-        if (filename < other.filename) {
-            return true;
-        }
-        if (filename > other.filename) {
-            return false;
+        if (file != other.file) {
+            if (getFilename() < other.getFilename()) {
+                return true;
+            }
+            if (getFilename() > other.getFilename()) {
+                return false;
+            }
         }
         if (start < other.start) {
             return true;
@@ -85,7 +93,7 @@ public:
     std::string extloc() const;
 
     void print(std::ostream& out) const {
-        out << filename << " [" << start << "-" << end << "]";
+        out << getFilename() << " [" << start << "-" << end << "]";
     }
 
     /** Enables ranges to be printed */
@@ -93,6 +101,10 @@ public:
         range.print(out);
         return out;
     }
+
+private:
+    /** The interned name of the file, such that copying a location, e.g. per token, does not allocate */
+    const std::string* file = nullptr;
 };
 
 }  // end of namespace souffle
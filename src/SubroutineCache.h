@@ -0,0 +1,140 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file SubroutineCache.h
+ *
+ * Memo table of the results of subroutines
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Memo table of the results of subroutines, keyed by the subroutine and its arguments, such that repeated
+ * calls, e.g. of the subproofs of tuples occurring many times in proof trees, are only evaluated once. The
+ * least recently used results are evicted once the estimated size of the table exceeds its capacity.
+ *
+ * The results of a subroutine may be tagged by the versions of the relations it reads when they were
+ * computed. Looking up or storing results of other versions drops those held for the subroutine. The
+ * table may be used by concurrent evaluations.
+ */
+class SubroutineCache {
+public:
+    /** Constructor, holding results of up to the given number of bytes */
+    explicit SubroutineCache(size_t capacity) : capacity(capacity) {}
+
+    /**
+     * Look up the result of a subroutine for the given arguments, computed at the given versions, and
+     * return whether it was found
+     */
+    bool lookup(const std::string& subroutine, const std::vector<RamDomain>& args,
+            std::vector<RamDomain>& ret, const std::vector<size_t>& versions = {}) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!update(subroutine, versions)) {
+            return false;
+        }
+        auto pos = index.find(std::make_pair(subroutine, args));
+        if (pos == index.end()) {
+            return false;
+        }
+        entries.splice(entries.begin(), entries, pos->second);
+        ret = pos->second->second;
+        return true;
+    }
+
+    /** Store the result of a subroutine for the given arguments, computed at the given versions */
+    void insert(const std::string& subroutine, const std::vector<RamDomain>& args,
+            const std::vector<RamDomain>& ret, const std::vector<size_t>& versions = {}) {
+        std::lock_guard<std::mutex> guard(lock);
+        update(subroutine, versions);
+        Key key(subroutine, args);
+        if (index.count(key) > 0) {
+            return;
+        }
+        size += estimate(key, ret);
+        entries.emplace_front(key, ret);
+        index.emplace(std::move(key), entries.begin());
+        evict();
+    }
+
+    /** Set the number of bytes of the results held, evicting results if there are more */
+    void setCapacity(size_t bytes) {
+        std::lock_guard<std::mutex> guard(lock);
+        capacity = bytes;
+        evict();
+    }
+
+    /** Get the number of bytes of the results held */
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+private:
+    using Key = std::pair<std::string, std::vector<RamDomain>>;
+    using Entry = std::pair<Key, std::vector<RamDomain>>;
+
+    /** results, the most recently used first */
+    std::list<Entry> entries;
+    std::map<Key, std::list<Entry>::iterator> index;
+    /** the versions of the results held per subroutine */
+    std::map<std::string, std::vector<size_t>> versionsOf;
+    size_t size = 0;
+    size_t capacity;
+    std::mutex lock;
+
+    /** estimate of the bytes occupied by an entry, including its list and map nodes */
+    static size_t estimate(const Key& key, const std::vector<RamDomain>& ret) {
+        const size_t keyBytes = key.first.size() + key.second.size() * sizeof(RamDomain);
+        return 2 * keyBytes + ret.size() * sizeof(RamDomain) + sizeof(Entry) +
+               sizeof(std::pair<const Key, std::list<Entry>::iterator>) + 64;
+    }
+
+    /** drop the results of a subroutine of other than the given versions; return whether none were */
+    bool update(const std::string& subroutine, const std::vector<size_t>& versions) {
+        auto cur = versionsOf.find(subroutine);
+        if (cur == versionsOf.end()) {
+            versionsOf.emplace(subroutine, versions);
+            return true;
+        }
+        if (cur->second == versions) {
+            return true;
+        }
+        cur->second = versions;
+        // the keys of a subroutine are adjacent, the one of no arguments first
+        auto pos = index.lower_bound(Key(subroutine, {}));
+        while (pos != index.end() && pos->first.first == subroutine) {
+            size -= estimate(pos->first, pos->second->second);
+            entries.erase(pos->second);
+            pos = index.erase(pos);
+        }
+        return false;
+    }
+
+    void evict() {
+        while (size > capacity && !entries.empty()) {
+            size -= estimate(entries.back().first, entries.back().second);
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+};
+
+}  // end of namespace souffle
@@ -0,0 +1,146 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file SymbolDictionary.h
+ *
+ * Persist the symbol table of a run in a symbol dictionary file, and
+ * pre-seed the symbol table of a later run from it.
+ *
+ * A symbol dictionary file consists of
+ *   - a SymbolDictionaryHeader,
+ *   - for each symbol in index order its length (uint64_t) followed by its
+ *     characters.
+ *
+ * A pre-seeded symbol table assigns every symbol of the dictionary its
+ * index in the dictionary, hence inputs may refer to symbols by these
+ * indices (see the symbol-ids directive of CSV IO), and the symbols of
+ * unchanged inputs are found in the table rather than inserted.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include "SymbolTable.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace souffle {
+
+struct SymbolDictionaryHeader {
+    /** The magic string identifying symbol dictionary files */
+    static constexpr char MAGIC[8] = {'S', 'O', 'U', 'F', 'F', 'L', 'E', 'S'};
+
+    /** The version of the file format */
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t numSymbols;
+
+    /** Create a header for the current format */
+    static SymbolDictionaryHeader create(uint64_t numSymbols) {
+        SymbolDictionaryHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.reserved = 0;
+        header.numSymbols = numSymbols;
+        return header;
+    }
+
+    /** Check whether this header describes a file readable by this build */
+    bool isValid() const {
+        return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && version == VERSION;
+    }
+};
+
+/**
+ * Write all symbols of the given table to a symbol dictionary file. The file is replaced
+ * atomically, hence concurrent runs pre-seeding from it read a complete dictionary.
+ */
+inline void saveSymbolTable(const SymbolTable& symbolTable, const std::string& filename) {
+    const std::string tempName = filename + ".tmp";
+    std::ofstream file(tempName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open symbol dictionary file " + tempName);
+    }
+    const auto header = SymbolDictionaryHeader::create(symbolTable.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t i = 0; i < header.numSymbols; ++i) {
+        const std::string& symbol = symbolTable.unsafeResolve(i);
+        const uint64_t length = symbol.size();
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(symbol.data(), length);
+    }
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Cannot write symbol dictionary file " + tempName);
+    }
+    if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace symbol dictionary file " + filename);
+    }
+}
+
+/**
+ * Pre-seed the given table with the symbols of a symbol dictionary file, such that each symbol
+ * obtains its index in the dictionary. The symbols already in the table, i.e. the constants of
+ * the program, must be a prefix of the dictionary or vice versa.
+ *
+ * @return Whether the file existed
+ */
+inline bool seedSymbolTable(SymbolTable& symbolTable, const std::string& filename) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const auto truncated = [&]() {
+        return std::runtime_error("Truncated symbol dictionary file " + filename);
+    };
+
+    SymbolDictionaryHeader header;
+    if (content.size() < sizeof(header)) {
+        throw truncated();
+    }
+    std::memcpy(&header, content.data(), sizeof(header));
+    if (!header.isValid()) {
+        throw std::runtime_error("Invalid symbol dictionary file " + filename);
+    }
+
+    size_t offset = sizeof(header);
+    for (uint64_t i = 0; i < header.numSymbols; ++i) {
+        uint64_t length;
+        if (content.size() - offset < sizeof(length)) {
+            throw truncated();
+        }
+        std::memcpy(&length, content.data() + offset, sizeof(length));
+        offset += sizeof(length);
+        if (content.size() - offset < length) {
+            throw truncated();
+        }
+        const std::string_view symbol(content.data() + offset, length);
+        offset += length;
+        if (i < symbolTable.size() ? symbolTable.unsafeResolve(i) != symbol
+                                   : symbolTable.unsafeLookup(symbol) != static_cast<RamDomain>(i)) {
+            throw std::runtime_error("Symbol dictionary file " + filename +
+                                     " does not agree with the symbols of this program");
+        }
+    }
+    return true;
+}
+
+}  // namespace souffle
@@ -17,14 +17,23 @@
 #pragma once
 
 #include "ParallelUtils.h"
+#include "PiggyList.h"
 #include "RamTypes.h"
 #include "Util.h"
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <deque>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace souffle {
 
@@ -34,58 +43,144 @@ namespace souffle {
  * Global pool of re-usable strings
  *
  * SymbolTable stores Datalog symbols and converts them to numbers and vice versa.
+ *
+ * The string-to-index map is split into shards selected by the hash of a symbol, each
+ * guarded by its own read/write lock, such that concurrent lookups rarely contend. The
+ * index-to-string map is an append-only chunked array whose blocks never move, hence
+ * resolving a symbol does not require any locking.
+ *
+ * Each symbol is stored exactly once, in the pointer-stable storage of its shard; both
+ * the string-to-index map (keyed by string views) and the index-to-string map refer to
+ * this single copy.
  */
 class SymbolTable {
 private:
-    /** A lock to synchronize parallel accesses */
-    mutable Lock access;
+    /** Number of bits of a symbol's hash used to select its shard */
+    static constexpr size_t SHARD_BITS = 6;
+
+    /** Number of shards of the string-to-index map */
+    static constexpr size_t NUM_SHARDS = 1ul << SHARD_BITS;
+
+    /** Size (in bits) of the first block of the index-to-string map */
+    static constexpr size_t INITIAL_BLOCK_BITS = 10;
+
+    /** A partition of the string-to-index map */
+    struct Shard {
+        /** A lock to synchronize parallel accesses to this shard */
+        mutable ReadWriteLock access;
+
+        /** The symbols of this shard; elements never move once appended. */
+        std::deque<std::string> symbols;
+
+        /** Map strings to indices, keyed by views into symbols. */
+        std::unordered_map<std::string_view, size_t> strToNum;
+    };
+
+    /** Map strings to indices, partitioned into shards. */
+    std::unique_ptr<std::array<Shard, NUM_SHARDS>> shards =
+            std::make_unique<std::array<Shard, NUM_SHARDS>>();
+
+    /** Map indices to strings, pointing to the symbols stored in the shards. */
+    std::unique_ptr<RandomInsertPiggyList<const std::string*>> numToStr =
+            std::make_unique<RandomInsertPiggyList<const std::string*>>(INITIAL_BLOCK_BITS);
+
+    /** The next free index */
+    std::atomic<size_t> nextIndex{0};
+
+    /** The number of published indices; all indices below it refer to a stored symbol. */
+    std::atomic<size_t> published{0};
+
+    /** Select the shard responsible for the given symbol. */
+    inline Shard& getShard(std::string_view symbol) const {
+        const size_t hash = std::hash<std::string_view>()(symbol);
+        return (*shards)[hash >> (sizeof(size_t) * 8 - SHARD_BITS)];
+    }
 
-    /** Map indices to strings. */
-    std::deque<std::string> numToStr;
+    /** Convenience method to place a new symbol in the given shard, if it does not exist, and return the
+     * index of it. The caller must hold the write lock of the shard. */
+    inline size_t newSymbolOfIndex(Shard& shard, std::string_view symbol) {
+        auto it = shard.strToNum.find(symbol);
+        if (it != shard.strToNum.end()) {
+            return it->second;
+        }
+        const size_t index = nextIndex++;
+        const std::string& stored = shard.symbols.emplace_back(symbol);
+        shard.strToNum.emplace(stored, index);
+        numToStr->insertAt(index, &stored);
 
-    /** Map strings to indices. */
-    std::unordered_map<std::string, size_t> strToNum;
+        // publish indices in order, since shards may fill the index-to-string map out of order; the
+        // preceding indices are claimed by writers holding other shards' locks and complete without ours
+        while (published.load(std::memory_order_acquire) != index) {
+            std::this_thread::yield();
+        }
+        published.store(index + 1, std::memory_order_release);
+        return index;
+    }
 
     /** Convenience method to place a new symbol in the table, if it does not exist, and return the index of
      * it. */
-    inline size_t newSymbolOfIndex(const std::string& symbol) {
-        size_t index;
-        auto it = strToNum.find(symbol);
-        if (it == strToNum.end()) {
-            index = numToStr.size();
-            strToNum[symbol] = index;
-            numToStr.push_back(symbol);
-        } else {
-            index = it->second;
+    inline size_t newSymbolOfIndex(std::string_view symbol) {
+        Shard& shard = getShard(symbol);
+
+        // fast path: the symbol is already present
+        shard.access.start_read();
+        auto it = shard.strToNum.find(symbol);
+        if (it != shard.strToNum.end()) {
+            const size_t index = it->second;
+            shard.access.end_read();
+            return index;
         }
+        shard.access.end_read();
+
+        // slow path: insert the symbol (it may have been inserted in the meantime)
+        shard.access.start_write();
+        const size_t index = newSymbolOfIndex(shard, symbol);
+        shard.access.end_write();
         return index;
     }
 
-    /** Convenience method to place a new symbol in the table, if it does not exist. */
-    inline void newSymbol(const std::string& symbol) {
-        if (strToNum.find(symbol) == strToNum.end()) {
-            strToNum[symbol] = numToStr.size();
-            numToStr.push_back(symbol);
+    /** Copy all symbols of the other table, preserving their indices. */
+    void copySymbols(const SymbolTable& other) {
+        for (size_t i = 0; i < other.size(); ++i) {
+            const std::string& symbol = other.unsafeResolve(i);
+            newSymbolOfIndex(getShard(symbol), symbol);
         }
     }
 
+    /** Exchange the content of this table with the content of the other one. */
+    void swap(SymbolTable& other) {
+        std::swap(shards, other.shards);
+        std::swap(numToStr, other.numToStr);
+        nextIndex.store(other.nextIndex.exchange(nextIndex.load()));
+        published.store(other.published.exchange(published.load()));
+    }
+
 public:
     /** Empty constructor. */
     SymbolTable() = default;
 
     /** Copy constructor, performs a deep copy. */
-    SymbolTable(const SymbolTable& other) : numToStr(other.numToStr), strToNum(other.strToNum) {}
+    SymbolTable(const SymbolTable& other) {
+        copySymbols(other);
+    }
 
     /** Copy constructor for r-value reference. */
     SymbolTable(SymbolTable&& other) noexcept {
-        numToStr.swap(other.numToStr);
-        strToNum.swap(other.strToNum);
+        swap(other);
     }
 
     SymbolTable(std::initializer_list<std::string> symbols) {
-        strToNum.reserve(symbols.size());
         for (const auto& symbol : symbols) {
-            newSymbol(symbol);
+            newSymbolOfIndex(getShard(symbol), symbol);
+        }
+    }
+
+    /** Constructor interning the symbols of an array in order, e.g., the static symbols of a generated
+     * program, without constructing temporary strings. */
+    SymbolTable(const char* const* symbols, size_t numSymbols) {
+        for (size_t i = 0; i < numSymbols; ++i) {
+            const std::string_view symbol(symbols[i]);
+            newSymbolOfIndex(getShard(symbol), symbol);
         }
     }
 
@@ -97,138 +192,149 @@ public:
         if (this == &other) {
             return *this;
         }
-        numToStr = other.numToStr;
-        strToNum = other.strToNum;
+        SymbolTable copy(other);
+        swap(copy);
         return *this;
     }
 
     /** Assignment operator for r-value references. */
     SymbolTable& operator=(SymbolTable&& other) noexcept {
-        numToStr.swap(other.numToStr);
-        strToNum.swap(other.strToNum);
+        swap(other);
         return *this;
     }
 
     /** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
      * already. */
-    RamDomain lookup(const std::string& symbol) {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            return static_cast<RamDomain>(newSymbolOfIndex(symbol));
+    RamDomain lookup(std::string_view symbol) {
+        return static_cast<RamDomain>(newSymbolOfIndex(symbol));
+    }
+
+    /** Find the index of the concatenation of the given symbols, inserting it if it does not exist there
+     * already. The concatenation is assembled in a buffer of the calling thread that is reused across
+     * calls, hence no temporary strings are allocated. */
+    RamDomain concatenate(std::initializer_list<RamDomain> indices) {
+        thread_local std::string buffer;
+        buffer.clear();
+        for (RamDomain index : indices) {
+            buffer += resolve(index);
         }
+        return lookup(buffer);
     }
 
     /** Finds the index of a symbol in the table, giving an error if it's not found */
-    RamDomain lookupExisting(const std::string& symbol) const {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            auto result = strToNum.find(symbol);
-            if (result == strToNum.end()) {
-                std::cerr << "Error string not found in call to SymbolTable::lookupExisting.\n";
-                exit(1);
-            }
-            return static_cast<RamDomain>(result->second);
+    RamDomain lookupExisting(std::string_view symbol) const {
+        const Shard& shard = getShard(symbol);
+        shard.access.start_read();
+        auto result = shard.strToNum.find(symbol);
+        if (result == shard.strToNum.end()) {
+            shard.access.end_read();
+            std::cerr << "Error string not found in call to SymbolTable::lookupExisting.\n";
+            exit(1);
         }
+        const size_t index = result->second;
+        shard.access.end_read();
+        return static_cast<RamDomain>(index);
     }
 
     /** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
-     * already. */
-    RamDomain unsafeLookup(const std::string& symbol) {
-        return newSymbolOfIndex(symbol);
+     * already. This operation does not synchronize with concurrent accesses. */
+    RamDomain unsafeLookup(std::string_view symbol) {
+        return static_cast<RamDomain>(newSymbolOfIndex(getShard(symbol), symbol));
     }
 
     /** Find a symbol in the table by its index, note that this gives an error if the index is out of
      * bounds.
      */
     const std::string& resolve(const RamDomain index) const {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            auto pos = static_cast<size_t>(index);
-            if (pos >= size()) {
-                // TODO: use different error reporting here!!
-                std::cerr << "Error index out of bounds in call to SymbolTable::resolve.\n";
-                exit(1);
-            }
-            return numToStr[pos];
+        auto pos = static_cast<size_t>(index);
+        if (pos >= size()) {
+            // TODO: use different error reporting here!!
+            std::cerr << "Error index out of bounds in call to SymbolTable::resolve.\n";
+            exit(1);
         }
+        return *numToStr->get(pos);
     }
 
     const std::string& unsafeResolve(const RamDomain index) const {
-        return numToStr[static_cast<size_t>(index)];
+        return *numToStr->get(static_cast<size_t>(index));
     }
 
     /* Return the size of the symbol table, being the number of symbols it currently holds. */
     size_t size() const {
-        return numToStr.size();
+        return published.load(std::memory_order_acquire);
+    }
+
+    /** Return an estimate of the number of bytes of memory occupied by this symbol table. */
+    size_t memoryUsage() const {
+        size_t bytes = sizeof(SymbolTable) + sizeof(*shards) + sizeof(*numToStr);
+
+        // index-to-string map
+        for (size_t i = 0; i < numToStr->maxContainers; ++i) {
+            if (numToStr->blockLookupTable[i].load() != nullptr) {
+                bytes += (numToStr->INITIALBLOCKSIZE << i) * sizeof(const std::string*);
+            }
+        }
+
+        // symbols and string-to-index maps
+        const size_t shortCapacity = std::string().capacity();
+        for (const Shard& shard : *shards) {
+            shard.access.start_read();
+            bytes += shard.symbols.size() * sizeof(std::string);
+            for (const std::string& symbol : shard.symbols) {
+                if (symbol.capacity() > shortCapacity) {
+                    bytes += symbol.capacity() + 1;
+                }
+            }
+            bytes += shard.strToNum.bucket_count() * sizeof(void*);
+            bytes += shard.strToNum.size() *
+                     (sizeof(std::pair<const std::string_view, size_t>) + 2 * sizeof(void*));
+            shard.access.end_read();
+        }
+        return bytes;
     }
 
     /** Bulk insert symbols into the table, note that this operation is more efficient than repeated
      * inserts
      * of single symbols. */
     void insert(const std::vector<std::string>& symbols) {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            strToNum.reserve(size() + symbols.size());
-            for (auto& symbol : symbols) {
-                newSymbol(symbol);
-            }
+        for (auto& symbol : symbols) {
+            newSymbolOfIndex(symbol);
         }
     }
 
     /** Insert a single symbol into the table, not that this operation should not be used if inserting
      * symbols
      * in bulk. */
-    void insert(const std::string& symbol) {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            newSymbol(symbol);
-        }
+    void insert(std::string_view symbol) {
+        newSymbolOfIndex(symbol);
     }
 
     /** Print the symbol table to the given stream. */
     void print(std::ostream& out) const {
-        {
-            out << "SymbolTable: {\n\t";
-            out << join(strToNum, "\n\t",
-                           [](std::ostream& out, const std::pair<std::string, std::size_t>& entry) {
-                               out << entry.first << "\t => " << entry.second;
-                           })
-                << "\n";
-            out << "}\n";
+        out << "SymbolTable: {\n\t";
+        for (size_t i = 0; i < size(); ++i) {
+            if (i != 0) {
+                out << "\n\t";
+            }
+            out << unsafeResolve(i) << "\t => " << i;
         }
+        out << "\n";
+        out << "}\n";
     }
 
     /** Check if the symbol table contains a string */
-    bool contains(const std::string& symbol) const {
-        auto lease = access.acquire();
-        (void)lease;  // avoid warning;
-        auto result = strToNum.find(symbol);
-        if (result == strToNum.end()) {
-            return false;
-        } else {
-            return true;
-        }
+    bool contains(std::string_view symbol) const {
+        const Shard& shard = getShard(symbol);
+        shard.access.start_read();
+        const bool result = shard.strToNum.find(symbol) != shard.strToNum.end();
+        shard.access.end_read();
+        return result;
     }
 
     /** Check if the symbol table contains an index */
     bool contains(const RamDomain index) const {
-        auto lease = access.acquire();
-        (void)lease;  // avoid warning;
         auto pos = static_cast<size_t>(index);
-        if (pos >= size()) {
-            return false;
-        } else {
-            return true;
-        }
-    }
-
-    Lock::Lease acquireLock() const {
-        return access.acquire();
+        return pos < size();
     }
 
     /** Stream operator, used as a convenience for print. */
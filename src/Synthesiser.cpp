@@ -19,6 +19,8 @@
 #include "FunctorOps.h"
 #include "Global.h"
 #include "IODirectives.h"
+#include "LogStatement.h"
+#include "RamBaseAnalysis.h"
 #include "RamCondition.h"
 #include "RamExpression.h"
 #include "RamIndexAnalysis.h"
@@ -41,6 +43,7 @@
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <set>
 #include <sstream>
 #include <typeinfo>
 #include <utility>
@@ -74,6 +77,85 @@ size_t Synthesiser::lookupReadIdx(const std::string& txt) {
     }
 }
 
+/** Lookup search counter of a relation and search signature */
+size_t Synthesiser::lookupSearchIdx(const std::string& relName, SearchSignature signature) {
+    const std::string txt = relName + ";" + std::to_string(signature);
+    auto pos = searchIdxMap.find(txt);
+    if (pos == searchIdxMap.end()) {
+        size_t idx = searchIdxMap.size();
+        return searchIdxMap[txt] = idx;
+    } else {
+        return pos->second;
+    }
+}
+
+/** Lookup registered message of a rule */
+size_t Synthesiser::lookupRuleIdx(const std::string& msg) {
+    auto pos = ruleIdxMap.find(msg);
+    if (pos == ruleIdxMap.end()) {
+        size_t idx = ruleIdxMap.size();
+        return ruleIdxMap[msg] = idx;
+    } else {
+        return pos->second;
+    }
+}
+
+/** Get the insertion of a fact by a statement, a query projecting constants only, or nullptr */
+const RamProject* Synthesiser::getFact(const RamStatement& statement) {
+    const RamStatement* cur = &statement;
+    if (const auto* dbg = dynamic_cast<const RamDebugInfo*>(cur)) {
+        cur = &dbg->getStatement();
+    }
+    const auto* query = dynamic_cast<const RamQuery*>(cur);
+    if (query == nullptr) {
+        return nullptr;
+    }
+    const auto* project = dynamic_cast<const RamProject*>(&query->getOperation());
+    if (project == nullptr || project->getValues().empty()) {
+        return nullptr;
+    }
+    for (const RamExpression* value : project->getValues()) {
+        if (dynamic_cast<const RamConstant*>(value) == nullptr) {
+            return nullptr;
+        }
+    }
+    return project;
+}
+
+/** Get the message of a run of facts of a relation */
+std::string Synthesiser::getFactsMessage(const RamRelation& rel, size_t numFacts) {
+    return std::to_string(numFacts) + " facts of " + rel.getName();
+}
+
+/** Lookup compiled constant pattern of a match constraint */
+size_t Synthesiser::lookupRegexIdx(RamDomain pattern) {
+    auto pos = regexIdxMap.find(pattern);
+    if (pos == regexIdxMap.end()) {
+        size_t idx = regexIdxMap.size();
+        return regexIdxMap[pattern] = idx;
+    } else {
+        return pos->second;
+    }
+}
+
+/** Lookup parallel operation counter, attributing delta and new relations to their relation */
+size_t Synthesiser::lookupParallelIdx(const std::string& relName) {
+    std::string modifiedTxt = relName;
+    for (const std::string prefix : {"@delta_", "@new_"}) {
+        if (modifiedTxt.compare(0, prefix.size(), prefix) == 0) {
+            modifiedTxt = modifiedTxt.substr(prefix.size());
+        }
+    }
+    std::replace(modifiedTxt.begin(), modifiedTxt.end(), '-', '.');
+    auto pos = parallelIdxMap.find(modifiedTxt);
+    if (pos == parallelIdxMap.end()) {
+        size_t idx = parallelIdxMap.size();
+        return parallelIdxMap[modifiedTxt] = idx;
+    } else {
+        return pos->second;
+    }
+}
+
 /** Convert RAM identifier */
 const std::string Synthesiser::convertRamIdent(const std::string& name) {
     auto it = identifiers.find(name);
@@ -109,6 +191,10 @@ const std::string Synthesiser::convertRamIdent(const std::string& name) {
 
 /** Get relation name */
 const std::string Synthesiser::getRelationName(const RamRelation& rel) {
+    auto param = relationParameters.find(&rel);
+    if (param != relationParameters.end()) {
+        return param->second;
+    }
     return "rel_" + convertRamIdent(rel.getName());
 }
 
@@ -117,6 +203,17 @@ const std::string Synthesiser::getOpContextName(const RamRelation& rel) {
     return getRelationName(rel) + "_op_ctxt";
 }
 
+std::string Synthesiser::getWriteCall(const RamRelation& rel, const IODirectives& ioDirectives) {
+    auto* idxAnalysis = translationUnit.getAnalysis<RamIndexAnalysis>();
+    const MinIndexSelection::LexOrder order = idxAnalysis->getOutputOrder(rel, ioDirectives);
+    if (!order.empty() && orderedRelations.count(&rel) > 0 &&
+            idxAnalysis->getIndexes(rel).getOrderNum(order) >= 0) {
+        return "writeOrdered(" + getRelationName(rel) + "->" + SynthesiserRelation::getOrderedByName(order) +
+               "())";
+    }
+    return "writeAll(*" + getRelationName(rel) + ")";
+}
+
 /** Get relation type struct */
 void Synthesiser::generateRelationTypeStruct(
         std::ostream& out, std::unique_ptr<SynthesiserRelation> relationType) {
@@ -192,10 +289,53 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         std::ostringstream preamble;
         bool preambleIssued = false;
 
+        // whether the parallel region of the current query steals the chunks of partLoop
+        bool stealingLoop = false;
+
+        // the number of tuples of a scan whose nested searches are prefetched together
+        const size_t prefetchBatch = 16;
+
+        // the relations whose insertions are buffered per thread in the current query
+        std::set<const RamRelation*> bufferedRelations;
+
+        // the statement emitted by this emitter
+        const RamStatement& root;
+
+        // whether subroutine return values are emitted by several threads, and need a lock
+        bool lockReturnValues = false;
+
+        // the arguments passed for the constants of the query emitted as a shared template, if any
+        std::vector<std::string>* constantArguments = nullptr;
+
     public:
-        CodeEmitter(Synthesiser& syn)
-                : synthesiser(syn), isa(syn.getTranslationUnit().getAnalysis<RamIndexAnalysis>()) {
+        CodeEmitter(Synthesiser& syn, const RamStatement& root)
+                : synthesiser(syn), isa(syn.getTranslationUnit().getAnalysis<RamIndexAnalysis>()),
+                  root(root) {
             rec = [&](std::ostream& out, const RamNode* node) { this->visit(*node, out); };
+            visitDepthFirst(root, [&](const RamAbstractParallel&) { lockReturnValues = true; });
+        }
+
+        using RamVisitor<void, std::ostream&>::visit;
+
+        void visit(const RamNode& node, std::ostream& out) override {
+            const auto* statement = dynamic_cast<const RamStatement*>(&node);
+            // statements computing base relations only are skipped, the base relations being kept by
+            // reset() and shared by forks
+            auto guard = synthesiser.baseGuards.find(statement);
+            const bool guarded = guard != synthesiser.baseGuards.end() && &node != &root;
+            if (guarded) {
+                out << "if (" << guard->second << ") {\n";
+            }
+            // the strata of split code are evaluated by the methods emitted to their units
+            auto stratum = synthesiser.stratumUnits.find(statement);
+            if (stratum != synthesiser.stratumUnits.end() && &node != &root) {
+                out << "stratum_" << stratum->second << "(" << synthesiser.stratumArguments << ");\n";
+            } else {
+                RamVisitor<void, std::ostream&>::visit(node, out);
+            }
+            if (guarded) {
+                out << "}\n";
+            }
         }
 
         // -- relation statements --
@@ -209,7 +349,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << "try {";
                 out << "std::map<std::string, std::string> directiveMap(";
                 out << ioDirectives << ");\n";
-                out << R"_(if (!inputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+                out << R"_(if (!inputDirectory.empty() && )_";
+                out << R"_((directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
                 out << "directiveMap[\"filename\"].front() != '/') {";
                 out << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
                 out << "}\n";
@@ -232,23 +373,146 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             for (IODirectives ioDirectives : store.getIODirectives()) {
                 out << "try {";
                 out << "std::map<std::string, std::string> directiveMap(" << ioDirectives << ");\n";
-                out << R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+                out << R"_(if (!outputDirectory.empty() && )_";
+                out << R"_((directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
                 out << "directiveMap[\"filename\"].front() != '/') {";
                 out << R"_(directiveMap["filename"] = outputDirectory + "/" + directiveMap["filename"];)_";
                 out << "}\n";
                 out << "IODirectives ioDirectives(directiveMap);\n";
                 out << "IOSystem::getInstance().getWriter(";
                 out << "ioDirectives, symTable, recordTable";
-                out << ")->writeAll(*" << synthesiser.getRelationName(store.getRelation()) << ");\n";
+                out << ")->" << synthesiser.getWriteCall(store.getRelation(), ioDirectives) << ";\n";
                 out << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
             }
             out << "}\n";
             PRINT_END_COMMENT(out);
         }
 
+        /**
+         * Check whether the insertions of the threads of a parallel query into a relation are collected
+         * in a subtrie per thread, which are merged into the tries of the relation at the end
+         */
+        bool isSubtried(const RamRelation& rel) const {
+            return rel.getRepresentation() == RelationRepresentation::BRIE && rel.getAuxiliaryArity() == 0;
+        }
+
+        /**
+         * Get the source and target relation of a query copying all tuples of a relation unchanged into
+         * another relation, e.g., merging the new tuples of a fixpoint iteration, if the target merges the
+         * tuples at once
+         */
+        std::pair<const RamRelation*, const RamRelation*> getCopiedRelations(const RamQuery& query) {
+            const auto* scan = dynamic_cast<const RamScan*>(&query.getOperation());
+            if (scan == nullptr) {
+                return {nullptr, nullptr};
+            }
+            const auto* project = dynamic_cast<const RamProject*>(&scan->getOperation());
+            if (project == nullptr) {
+                return {nullptr, nullptr};
+            }
+            const RamRelation& src = scan->getRelation();
+            const RamRelation& trg = project->getRelation();
+            if (&src == &trg || src.getArity() != trg.getArity() ||
+                    synthesiser.insertAllRelations.count(&src) == 0 ||
+                    synthesiser.insertAllRelations.count(&trg) == 0) {
+                return {nullptr, nullptr};
+            }
+            const auto& values = project->getValues();
+            for (size_t i = 0; i < values.size(); i++) {
+                const auto* element = dynamic_cast<const RamTupleElement*>(values[i]);
+                if (element == nullptr || element->getTupleId() != scan->getTupleId() ||
+                        element->getElement() != i) {
+                    return {nullptr, nullptr};
+                }
+            }
+            return {&src, &trg};
+        }
+
+        /**
+         * Check whether a query may be emitted as a shared template, i.e., its code refers to no state
+         * of the emitting method, such as the counter or the arguments of a subroutine
+         */
+        bool isShareable(const RamQuery& query) const {
+            bool shareable = true;
+            visitDepthFirst(query, [&](const RamAutoIncrement&) { shareable = false; });
+            visitDepthFirst(query, [&](const RamSubroutineArgument&) { shareable = false; });
+            visitDepthFirst(query, [&](const RamSubroutineReturnValue&) { shareable = false; });
+            return shareable;
+        }
+
+        /**
+         * Emit a call of the shared template of a query, whose parameters are the relations and the
+         * constants of the query; structurally identical queries, differing in their relations and
+         * constants only, share a template, which is emitted once
+         */
+        void emitSharedQuery(const RamQuery& query, std::ostream& out) {
+            // the relations are named by their parameters in the order of their references
+            std::vector<const RamRelation*> relations;
+            visitDepthFirst(query, [&](const RamRelationReference& ref) {
+                if (synthesiser.relationParameters.count(ref.get()) == 0) {
+                    synthesiser.relationParameters[ref.get()] = "rel" + std::to_string(relations.size());
+                    relations.push_back(ref.get());
+                }
+            });
+            std::vector<std::string> constants;
+            std::ostringstream code;
+            constantArguments = &constants;
+            visitQuery(query, code);
+            constantArguments = nullptr;
+            synthesiser.relationParameters.clear();
+
+            std::ostringstream params;
+            for (size_t i = 0; i < relations.size(); ++i) {
+                params << (i > 0 ? ", " : "") << "R" << i << "& rel" << i;
+            }
+            for (size_t i = 0; i < constants.size(); ++i) {
+                params << ", RamSigned c" << i;
+            }
+            const std::string key = params.str() + "\n" + code.str();
+            auto pos = synthesiser.queryTemplates.find(key);
+            if (pos == synthesiser.queryTemplates.end()) {
+                const size_t idx = synthesiser.queryTemplates.size();
+                pos = synthesiser.queryTemplates.insert(std::make_pair(key, idx)).first;
+                std::ostringstream definition;
+                definition << "template <";
+                for (size_t i = 0; i < relations.size(); ++i) {
+                    definition << (i > 0 ? ", " : "") << "typename R" << i;
+                }
+                definition << ">\nvoid query_" << idx << "(" << params.str() << ") {\n";
+                definition << code.str() << "\n}\n";
+                synthesiser.queryTemplateDefinitions.push_back(definition.str());
+            }
+
+            out << "query_" << pos->second << "(";
+            out << join(relations, ", ", [&](std::ostream& os, const RamRelation* rel) {
+                os << synthesiser.getRelationName(*rel);
+            });
+            for (const std::string& constant : constants) {
+                out << ", " << constant;
+            }
+            out << ");\n";
+        }
+
         void visitQuery(const RamQuery& query, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
 
+            // the copied tuples are sorted and merged into the indexes of the target, instead of being
+            // inserted one by one
+            const auto copied = getCopiedRelations(query);
+            if (copied.first != nullptr) {
+                out << synthesiser.getRelationName(*copied.second) << "->insertAll(*"
+                    << synthesiser.getRelationName(*copied.first) << ");\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
+            if (Global::config().has("query-templates") && constantArguments == nullptr &&
+                    isShareable(query)) {
+                emitSharedQuery(query, out);
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             // split terms of conditions of outer filter operation
             // into terms that require a context and terms that
             // do not require a context
@@ -290,14 +554,58 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             preamble.str("");
             preamble.clear();
             preambleIssued = false;
+            stealingLoop = false;
 
-            // create operation contexts for this operation
+            // create operation contexts for this operation, ordered by the names of their relations
+            std::map<std::string, const RamRelation*> contextRelations;
             for (const RamRelation* rel : synthesiser.getReferencedRelations(query.getOperation())) {
-                preamble << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*rel);
-                preamble << "," << synthesiser.getRelationName(*rel);
+                contextRelations[synthesiser.getRelationName(*rel)] = rel;
+            }
+            for (const auto& cur : contextRelations) {
+                preamble << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*cur.second);
+                preamble << "," << cur.first;
                 preamble << "->createContext());\n";
             }
 
+            // buffer the insertions of each thread, if the inserted relations are not read by the query;
+            // brie relations are always filled through a subtrie per thread, since concurrent inserts
+            // contend on the first levels of their tries
+            bufferedRelations.clear();
+            if (isParallel) {
+                std::set<const RamRelation*> reads;
+                visitDepthFirst(
+                        query, [&](const RamRelationOperation& op) { reads.insert(&op.getRelation()); });
+                visitDepthFirst(query, [&](const RamAbstractExistenceCheck& exists) {
+                    reads.insert(&exists.getRelation());
+                });
+                visitDepthFirst(query, [&](const RamEmptinessCheck& emptiness) {
+                    reads.insert(&emptiness.getRelation());
+                });
+                visitDepthFirst(query, [&](const RamProject& project) {
+                    const RamRelation& rel = project.getRelation();
+                    if (rel.getArity() > 0 && (Global::config().has("insert-buffers") || isSubtried(rel))) {
+                        bufferedRelations.insert(&rel);
+                    }
+                });
+                for (const RamRelation* rel : bufferedRelations) {
+                    if (reads.count(rel) > 0) {
+                        bufferedRelations.clear();
+                        break;
+                    }
+                }
+            }
+            for (const RamRelation* rel : bufferedRelations) {
+                const std::string buffer = "buffer_" + synthesiser.getRelationName(*rel);
+                if (isSubtried(*rel)) {
+                    preamble << "std::decay_t<decltype(*" << synthesiser.getRelationName(*rel) << ")> "
+                             << buffer << ";\n";
+                    preamble << "auto " << buffer << "_ctxt = " << buffer << ".createContext();\n";
+                } else {
+                    preamble << "std::vector<Tuple<RamDomain," << rel->getArity() << ">> " << buffer
+                             << ";\n";
+                }
+            }
+
             // discharge conditions that require a context
             if (isParallel) {
                 if (requireCtx.size() > 0) {
@@ -322,8 +630,33 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 }
             }
 
+            // merge the subtries or the sorted insertions of each thread
+            for (const RamRelation* rel : bufferedRelations) {
+                const std::string buffer = "buffer_" + synthesiser.getRelationName(*rel);
+                if (isSubtried(*rel)) {
+                    out << "PARALLEL_CRITICAL\n";
+                    out << synthesiser.getRelationName(*rel) << "->mergeAll(" << buffer << ");\n";
+                    continue;
+                }
+                // the threads insert disjoint ranges of the tuples of all threads, a single thread its own
+                const std::string insert = synthesiser.getRelationName(*rel) +
+                                           "->insert(tuple,READ_OP_CONTEXT(" +
+                                           synthesiser.getOpContextName(*rel) + "));\n";
+                out << "std::sort(" << buffer << ".begin(), " << buffer << ".end());\n";
+                out << "if (!insertByRanges(" << buffer << ", std::less<>(), [&](const auto& tuple) {\n"
+                    << insert << "})) {\n";
+                out << "for (const auto& tuple : " << buffer << ") " << insert;
+                out << "}\n";
+            }
+            bufferedRelations.clear();
+
             if (isParallel) {
                 out << "PARALLEL_END;\n";  // end parallel
+                if (stealingLoop && Global::config().has("profile")) {
+                    out << "ParallelLoopProfile::instance().record(partLoop);\n";
+                }
+                // chunks skipped once the limits are exceeded abort the evaluation outside of the region
+                out << "limits.check();\n";
             }
 
             out << "}\n";
@@ -341,9 +674,41 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
             out << "if (!isHintsProfilingEnabled()"
                 << (clear.getRelation().isTemp() ? ") " : "&& performIO) ");
-            out << synthesiser.getRelationName(clear.getRelation()) << "->"
-                << "purge();\n";
+            out << synthesiser.getRelationName(clear.getRelation()) << ".purge();\n";
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitFreeze(const RamFreeze& freeze, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const RamRelation& rel = freeze.getRelation();
+            const std::string name = synthesiser.getRelationName(rel);
+            // base relations are shared by the forks of the program, which may read them concurrently
+            out << "if (" << name << ".isAllocated() && !isBaseRelation(\"" << rel.getName() << "\")) ";
+            out << name << "->compact();\n";
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitBuildIndex(const RamBuildIndex& build, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const RamRelation& rel = build.getRelation();
+            // the indexes of base relations stay built, as they are shared by the forks of the program
+            if (!rel.isTemp()) {
+                out << "if (!isBaseRelation(\"" << rel.getName() << "\")) ";
+            }
+            out << synthesiser.getRelationName(rel) << "->buildIndex_"
+                << isa->getIndexes(rel).getLexOrderNum(build.getSearchSignature()) << "();\n";
+            PRINT_END_COMMENT(out);
+        }
 
+        void visitDropIndex(const RamDropIndex& drop, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const RamRelation& rel = drop.getRelation();
+            if (!rel.isTemp()) {
+                out << "if (!isBaseRelation(\"" << rel.getName() << "\")) ";
+            }
+            out << synthesiser.getRelationName(rel) << "->dropIndex_"
+                << isa->getIndexes(rel).getLexOrderNum(drop.getSearchSignature()) << "();\n";
             PRINT_END_COMMENT(out);
         }
 
@@ -351,7 +716,30 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
             out << "ProfileEventSingleton::instance().makeQuantityEvent( R\"(";
             out << size.getMessage() << ")\",";
-            out << synthesiser.getRelationName(size.getRelation()) << "->size(),iter);";
+            out << synthesiser.getRelationName(size.getRelation()) << ".size(),iter);";
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitLogStatistics(const RamLogStatistics& statistics, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const RamRelation& rel = statistics.getRelation();
+            out << "ProfileEventSingleton::instance().makeStatisticsEvent( R\"(";
+            out << statistics.getMessage() << ")\",";
+            out << "*" << synthesiser.getRelationName(rel) << ","
+                << rel.getArity() - rel.getAuxiliaryArity() << ");";
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitLogMemory(const RamLogMemory& memory, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            for (const RamRelation* rel : memory.getRelations()) {
+                out << "ProfileEventSingleton::instance().makeRelationMemoryEvent(R\"_("
+                    << LogStatement::relationMemory(rel->getName(), memory.getStratum()) << ")_\","
+                    << synthesiser.getRelationName(*rel) << "->getMemoryUsage());\n";
+            }
+            out << "ProfileEventSingleton::instance().makeMemoryEvent(R\"_("
+                << LogStatement::memory(memory.getStratum())
+                << ")_\",symTable.memoryUsage(),recordTable.memoryUsage());\n";
             PRINT_END_COMMENT(out);
         }
 
@@ -360,11 +748,42 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         void visitSequence(const RamSequence& seq, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             for (const auto& cur : seq.getStatements()) {
-                visit(cur, out);
+                auto batch = synthesiser.factBatches.find(cur);
+                if (batch != synthesiser.factBatches.end()) {
+                    visitFacts(batch->second, out);
+                } else if (synthesiser.batchedFacts.count(cur) == 0) {
+                    visit(cur, out);
+                }
             }
             PRINT_END_COMMENT(out);
         }
 
+        // a run of facts of a relation is inserted from a static array, rather than by a query per fact
+        void visitFacts(const std::vector<const RamProject*>& facts, std::ostream& out) {
+            const RamRelation& rel = facts.front()->getRelation();
+            out << "SignalHandler::instance()->setRule(rule_"
+                << synthesiser.lookupRuleIdx(getFactsMessage(rel, facts.size())) << ");\n";
+            out << "{\nstatic const RamDomain facts[] = {\n";
+            for (const RamProject* fact : facts) {
+                // the smallest value has no literal, its negation overflowing
+                out << join(fact->getValues(), ",", [](std::ostream& os, const RamExpression* value) {
+                    const RamDomain constant = static_cast<const RamConstant*>(value)->getConstant();
+                    if (constant == MIN_RAM_DOMAIN) {
+                        os << "MIN_RAM_DOMAIN";
+                    } else {
+                        os << constant;
+                    }
+                }) << ",\n";
+            }
+            out << "};\n";
+            out << "insertFacts<" << rel.getArity() << ">(*" << synthesiser.getRelationName(rel)
+                << ", facts, " << facts.size() << ");\n";
+            out << "}\n";
+            if (Global::config().has("profile-sampling")) {
+                out << "SignalHandler::instance()->clearMsg();\n";
+            }
+        }
+
         void visitParallel(const RamParallel& parallel, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             auto stmts = parallel.getStatements();
@@ -399,10 +818,71 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitSchedule(const RamSchedule& schedule, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            auto stmts = schedule.getStatements();
+            const auto& dependencies = schedule.getDependencies();
+
+            // evaluate each stratum once all strata it depends on are done
+            out << "parallelSchedule({";
+            out << join(dependencies, ", ", [](std::ostream& os, const std::vector<size_t>& deps) {
+                os << "{" << join(deps, ", ") << "}";
+            });
+            out << "}, " << schedule.getJobs() << ", [&](std::size_t stratum) {\n";
+            out << "switch (stratum) {\n";
+            for (size_t i = 0; i < stmts.size(); ++i) {
+                out << "case " << i << ": {\n";
+                visit(stmts[i], out);
+                out << "break;\n";
+                out << "}\n";
+            }
+            out << "}\n";
+            out << "});\n";
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitAdaptiveQuery(const RamAdaptiveQuery& adaptive, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            auto stmts = adaptive.getStatements();
+
+            // estimate the cost of each alternative for the current relation sizes
+            out << "{\n";
+            out << "std::size_t best = 0;\n";
+            out << "double bestCost = -1;\n";
+            for (size_t i = 0; i < stmts.size(); ++i) {
+                out << "{\n";
+                out << "double bindings = 1, cost = 0, size;\n";
+                for (const auto& level : RamAdaptiveQuery::getLevels(*stmts[i])) {
+                    out << "size = " << synthesiser.getRelationName(*level.relation) << ".size();\n";
+                    out << "bindings *= size == 0 ? 0 : std::pow(size, " << level.freeAttributes << ".0 / "
+                        << level.relation->getArity() << ");\n";
+                    out << "cost += bindings;\n";
+                }
+                out << "if (bestCost < 0 || cost < bestCost) {\n";
+                out << "best = " << i << ";\n";
+                out << "bestCost = cost;\n";
+                out << "}\n";
+                out << "}\n";
+            }
+
+            // run the cheapest alternative
+            out << "switch (best) {\n";
+            for (size_t i = 0; i < stmts.size(); ++i) {
+                out << "case " << i << ": {\n";
+                visit(stmts[i], out);
+                out << "break;\n";
+                out << "}\n";
+            }
+            out << "}\n";
+            out << "}\n";
+            PRINT_END_COMMENT(out);
+        }
+
         void visitLoop(const RamLoop& loop, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << "iter = 0;\n";
             out << "for(;;) {\n";
+            out << "limits.check();\n";
             visit(loop.getBody(), out);
             out << "iter++;\n";
             out << "}\n";
@@ -415,7 +895,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             const std::string& deltaKnowledge = synthesiser.getRelationName(swap.getFirstRelation());
             const std::string& newKnowledge = synthesiser.getRelationName(swap.getSecondRelation());
 
-            out << "std::swap(" << deltaKnowledge << ", " << newKnowledge << ");\n";
+            out << deltaKnowledge << ".swap(" << newKnowledge << ");\n";
             PRINT_END_COMMENT(out);
         }
 
@@ -445,8 +925,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             const auto& rel = timer.getRelation();
             auto relName = synthesiser.getRelationName(rel);
 
+            // the new tuples are counted by b-tree relations, whose sizes are computed by traversals
+            const std::string count =
+                    synthesiser.countedRelations.count(&rel) != 0 ? "getInsertions()" : "size()";
             out << "\tLogger logger(R\"_(" << timer.getMessage() << ")_\",iter, [&](){return " << relName
-                << "->size();});\n";
+                << "->" << count << ";});\n";
             // insert statement to be measured
             visit(timer.getStatement(), out);
 
@@ -474,12 +957,29 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitDebugInfo(const RamDebugInfo& dbg, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
-            out << "SignalHandler::instance()->setMsg(R\"_(";
-            out << dbg.getMessage();
-            out << ")_\");\n";
+            out << "SignalHandler::instance()->setRule(rule_" << synthesiser.lookupRuleIdx(dbg.getMessage())
+                << ");\n";
 
             // insert statements of the rule
             visit(dbg.getStatement(), out);
+            if (Global::config().has("profile-sampling")) {
+                out << "SignalHandler::instance()->clearMsg();\n";
+            }
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitCheckpoint(const RamCheckpoint& checkpoint, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const std::string fileName = "R\"_(" + checkpoint.getFileName() + ")_\"";
+            // the first stratum resumes from the state recorded by a previous evaluation, if any
+            if (checkpoint.getStratum() == 0) {
+                out << "restoredStrata = existFile(" << fileName << ") ? restore(" << fileName
+                    << ") : 0;\n";
+            }
+            out << "if (restoredStrata <= " << checkpoint.getStratum() << ") {\n";
+            visit(checkpoint.getStatement(), out);
+            out << "checkpoint(" << fileName << ", " << checkpoint.getStratum() + 1 << ");\n";
+            out << "}\n";
             PRINT_END_COMMENT(out);
         }
 
@@ -512,15 +1012,12 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
-            out << "PARALLEL_START;\n";
+            emitParallelStart(rel, out);
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            out << "pfor_steal(it, part, partLoop) {\n";
+            out << "if (limits.isExceeded()) continue;\n";
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
-
-            visitTupleOperation(pscan, out);
-
-            out << "}\n";
+            emitScanLoop(pscan, "*it", false, out);
             out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
 
@@ -530,18 +1027,12 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         void visitScan(const RamScan& scan, std::ostream& out) override {
             const auto& rel = scan.getRelation();
             auto relName = synthesiser.getRelationName(rel);
-            auto id = scan.getTupleId();
 
             PRINT_BEGIN_COMMENT(out);
 
             assert(rel.getArity() > 0 && "AstTranslator failed/no scans for nullaries");
 
-            out << "for(const auto& env" << id << " : "
-                << "*" << relName << ") {\n";
-
-            visitTupleOperation(scan, out);
-
-            out << "}\n";
+            emitScanLoop(scan, "*" + relName, false, out);
 
             PRINT_END_COMMENT(out);
         }
@@ -589,6 +1080,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "PARALLEL_START;\n";
             out << preamble.str();
             out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            out << "if (limits.isExceeded()) continue;\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -619,6 +1111,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             assert(arity > 0 && "AstTranslator failed/no index scans for nullaries");
 
             PRINT_BEGIN_COMMENT(out);
+            emitSearchCount(rel, keys, out);
 
             out << "const Tuple<RamDomain," << arity << "> key{{";
             for (size_t i = 0; i < arity; i++) {
@@ -637,11 +1130,158 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
             out << "auto range = " << relName << "->"
                 << "equalRange_" << keys << "(key," << ctxName << ");\n";
-            out << "for(const auto& env" << identifier << " : range) {\n";
+            emitSearchTuplesStart(identifier, out);
+            emitScanLoop(iscan, "range", true, out);
+            emitSearchTuplesEnd(rel, keys, identifier, out);
+            PRINT_END_COMMENT(out);
+        }
 
-            visitTupleOperation(iscan, out);
+        void visitLeapfrogJoin(const RamLeapfrogJoin& leapfrog, std::ostream& out) override {
+            const auto identifier = leapfrog.getTupleId();
+            const std::string prefix = "lf" + std::to_string(identifier) + "_";
+            const std::string max = prefix + "max";
+
+            // the searches are the range of the relation followed by the intersections
+            std::vector<const RamRelation*> relations = {&leapfrog.getRelation()};
+            std::vector<std::vector<RamExpression*>> patterns = {leapfrog.getRangePattern()};
+            std::vector<SearchSignature> searches = {isa->getSearchSignature(&leapfrog)};
+            for (const RamExistenceCheck* intersection : leapfrog.getIntersections()) {
+                relations.push_back(&intersection->getRelation());
+                patterns.push_back(intersection->getValues());
+                searches.push_back(isa->getSearchSignature(intersection));
+            }
 
+            PRINT_BEGIN_COMMENT(out);
+
+            // the key of each search, advanced to the tuples found
+            std::vector<std::string> seeks;
+            std::vector<std::string> values;
+            for (size_t i = 0; i < relations.size(); i++) {
+                const std::string key = prefix + std::to_string(i);
+                const size_t column = RamLeapfrogJoin::getFreeColumn(patterns[i]);
+                out << "Tuple<RamDomain," << relations[i]->getArity() << "> " << key << "{{";
+                out << join(patterns[i], ",", [&](std::ostream& out, RamExpression* value) {
+                    if (!isRamUndefValue(value)) {
+                        visit(*value, out);
+                    } else {
+                        out << "MIN_RAM_DOMAIN";
+                    }
+                });
+                out << "}};\n";
+                seeks.push_back(synthesiser.getRelationName(*relations[i]) + "->seek_" +
+                                std::to_string(searches[i]) + "(" + key +
+                                ",READ_OP_CONTEXT(" + synthesiser.getOpContextName(*relations[i]) + "))");
+                values.push_back(key + "[" + std::to_string(column) + "]");
+            }
+
+            out << "if (" << join(seeks, " && ") << ") {\n";
+            out << "for (;;) {\n";
+            out << "RamDomain " << max << " = " << values[0] << ";\n";
+            for (size_t i = 1; i < values.size(); i++) {
+                out << "if (" << max << " < " << values[i] << ") " << max << " = " << values[i] << ";\n";
+            }
+            std::vector<std::string> agree;
+            for (const auto& value : values) {
+                agree.push_back(value + " == " + max);
+            }
+            out << "if (" << join(agree, " && ") << ") {\n";
+            out << "const auto& env" << identifier << " = " << prefix << "0;\n";
+
+            visitTupleOperation(leapfrog, out);
+
+            out << "if (" << max << " == MAX_RAM_DOMAIN) break;\n";
+            out << values[0] << " = " << max << " + 1;\n";
+            out << "if (!" << seeks[0] << ") break;\n";
+            out << "} else {\n";
+            // catch up with the largest value, which may be overtaken
+            for (size_t i = 0; i < values.size(); i++) {
+                out << "if (" << values[i] << " != " << max << ") {\n";
+                out << values[i] << " = " << max << ";\n";
+                out << "if (!" << seeks[i] << ") break;\n";
+                out << "}\n";
+            }
+            out << "}\n";
+            out << "}\n";
+            out << "}\n";
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitMergeJoin(const RamMergeJoin& merge, std::ostream& out) override {
+            const auto& rel = merge.getRelation();
+            const std::string first = "mj" + std::to_string(merge.getTupleId()) + "_first";
+
+            PRINT_BEGIN_COMMENT(out);
+
+            out << "const Tuple<RamDomain," << rel.getArity() << "> " << first << "{{"
+                << join(std::vector<std::string>(rel.getArity(), "MIN_RAM_DOMAIN"), ",") << "}};\n";
+            emitMergeJoin(merge,
+                    synthesiser.getRelationName(rel) + "->lowerRange_" +
+                            std::to_string(isa->getSearchSignature(&merge)) + "(" + first +
+                            ",READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + "))",
+                    out);
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitParallelMergeJoin(const RamParallelMergeJoin& pmerge, std::ostream& out) override {
+            const auto& rel = pmerge.getRelation();
+
+            assert(pmerge.getTupleId() == 0 && "not outer-most loop");
+
+            assert(!preambleIssued && "only first loop can be made parallel");
+            preambleIssued = true;
+
+            PRINT_BEGIN_COMMENT(out);
+
+            // each thread merges an ordered chunk of the relation, seeking its first value in the inner one
+            out << "auto part = " << synthesiser.getRelationName(rel) << "->partition_"
+                << isa->getSearchSignature(&pmerge) << "();\n";
+            emitParallelStart(rel, out);
+            out << preamble.str();
+            out << "pfor_steal(it, part, partLoop) {\n";
+            out << "if (limits.isExceeded()) continue;\n";
+            out << "try{\n";
+
+            emitMergeJoin(pmerge, "*it", out);
+
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitHashJoin(const RamHashJoin& join, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            emitHashJoin(join, false, out);
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitParallelHashJoin(const RamParallelHashJoin& pjoin, std::ostream& out) override {
+            assert(pjoin.getTupleId() == 0 && "not outer-most loop");
+
+            assert(!preambleIssued && "only first loop can be made parallel");
+            preambleIssued = true;
+
+            PRINT_BEGIN_COMMENT(out);
+            emitHashJoin(pjoin, true, out);
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitGroupAggregate(const RamGroupAggregate& group, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            emitGroupAggregate(group, false, out);
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitParallelGroupAggregate(
+                const RamParallelGroupAggregate& pgroup, std::ostream& out) override {
+            assert(pgroup.getTupleId() == 0 && "not outer-most loop");
+
+            assert(!preambleIssued && "only first loop can be made parallel");
+            preambleIssued = true;
+
+            PRINT_BEGIN_COMMENT(out);
+            emitGroupAggregate(pgroup, true, out);
             PRINT_END_COMMENT(out);
         }
 
@@ -660,6 +1300,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             preambleIssued = true;
 
             PRINT_BEGIN_COMMENT(out);
+            emitSearchCount(rel, keys, out);
 
             out << "const Tuple<RamDomain," << arity << "> key{{";
             for (size_t i = 0; i < arity; i++) {
@@ -677,16 +1318,15 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 << "->"
                 // TODO (b-scholz): context may be missing here?
                 << "equalRange_" << keys << "(key);\n";
-            out << "auto part = range.partition();\n";
-            out << "PARALLEL_START;\n";
+            out << "auto part = range.partition(MAX_CHUNKS_PER_THREAD * MAX_THREADS, MIN_CHUNK_TUPLES);\n";
+            emitParallelStart(rel, out);
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            out << "pfor_steal(it, part, partLoop) {\n";
+            out << "if (limits.isExceeded()) continue;\n";
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
-
-            visitTupleOperation(piscan, out);
-
-            out << "}\n";
+            emitSearchTuplesStart(0, out);
+            emitScanLoop(piscan, "*it", true, out);
+            emitSearchTuplesEnd(rel, keys, 0, out);
             out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
 
@@ -704,6 +1344,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
             // check list of keys
             assert(arity > 0 && "AstTranslator failed");
+            emitSearchCount(rel, keys, out);
 
             out << "const Tuple<RamDomain," << arity << "> key{{";
             for (size_t i = 0; i < arity; i++) {
@@ -754,6 +1395,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             preambleIssued = true;
 
             PRINT_BEGIN_COMMENT(out);
+            emitSearchCount(rel, keys, out);
 
             out << "const Tuple<RamDomain," << arity << "> key{{";
             for (size_t i = 0; i < arity; i++) {
@@ -775,6 +1417,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "PARALLEL_START;\n";
             out << preamble.str();
             out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            out << "if (limits.isExceeded()) continue;\n";
             out << "try{";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -798,9 +1441,6 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
             auto arity = lookup.getArity();
 
-            // get the tuple type working with
-            std::string tuple_type = "ram::Tuple<RamDomain," + toString(arity) + ">";
-
             // look up reference
             out << "auto ref = ";
             visit(lookup.getExpression(), out);
@@ -809,10 +1449,10 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             // Handle nil case.
             out << "if (recordTable.isNil(ref)) continue;\n";
 
-            // Unpack tuple
-            out << tuple_type << " "
+            // Refer to the stored tuple, which never moves, instead of copying it
+            out << "const RamDomain* "
                 << "env" << lookup.getTupleId() << " = "
-                << "recordTable.unpackTuple<RamDomain, " << arity << ">"
+                << "recordTable.unpack<" << arity << ">"
                 << "(ref);"
                 << "\n";
 
@@ -833,6 +1473,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             auto relName = synthesiser.getRelationName(rel);
             auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
             auto identifier = aggregate.getTupleId();
+            emitSearchCount(rel, isa->getSearchSignature(&aggregate), out);
 
             // aggregate tuple storing the result of aggregate
             std::string tuple_type = "ram::Tuple<RamDomain," + toString(arity) + ">";
@@ -934,46 +1575,635 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                     abort();
             }
 
-            out << "}\n";
+            out << "}\n";
+
+            // end aggregator loop
+            out << "}\n";
+
+            // write result into environment tuple
+            out << "env" << identifier << "[0] = res" << identifier << ";\n";
+
+            if (aggregate.getFunction() == souffle::MIN || aggregate.getFunction() == souffle::MAX) {
+                // check whether there exists a min/max first before next loop
+                out << "if(res" << identifier << " != " << init << "){\n";
+                visitTupleOperation(aggregate, out);
+                out << "}\n";
+            } else {
+                visitTupleOperation(aggregate, out);
+            }
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitAggregate(const RamAggregate& aggregate, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            // get some properties
+            const auto& rel = aggregate.getRelation();
+            auto relName = synthesiser.getRelationName(rel);
+            auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
+            auto identifier = aggregate.getTupleId();
+
+            // declare environment variable
+            out << "ram::Tuple<RamDomain,1> env" << identifier << ";\n";
+
+            // special case: counting number elements over an unrestricted predicate
+            if (aggregate.getFunction() == souffle::COUNT && isRamTrue(&aggregate.getCondition())) {
+                // shortcut: use relation size
+                out << "env" << identifier << "[0] = " << relName << "->"
+                    << "size();\n";
+                visitTupleOperation(aggregate, out);
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
+            // init result
+            std::string init;
+            switch (aggregate.getFunction()) {
+                case souffle::MIN:
+                    init = "MAX_RAM_DOMAIN";
+                    break;
+                case souffle::MAX:
+                    init = "MIN_RAM_DOMAIN";
+                    break;
+                case souffle::COUNT:
+                    init = "0";
+                    break;
+                case souffle::SUM:
+                    init = "0";
+                    break;
+                default:
+                    abort();
+            }
+            out << "RamDomain res" << identifier << " = " << init << ";\n";
+
+            // check whether there is an index to use
+            out << "for(const auto& env" << identifier << " : "
+                << "*" << relName << ") {\n";
+
+            // produce condition inside the loop
+            out << "if( ";
+            visit(aggregate.getCondition(), out);
+            out << ") {\n";
+
+            // pick function
+            switch (aggregate.getFunction()) {
+                case souffle::MIN:
+                    out << "res" << identifier << " = std::min(res" << identifier << ",";
+                    visit(aggregate.getExpression(), out);
+                    out << ");\n";
+                    break;
+                case souffle::MAX:
+                    out << "res" << identifier << " = std::max(res" << identifier << ",";
+                    visit(aggregate.getExpression(), out);
+                    out << ");\n";
+                    break;
+                case souffle::COUNT:
+                    out << "++res" << identifier << "\n;";
+                    break;
+                case souffle::SUM:
+                    out << "res" << identifier << " += ";
+                    visit(aggregate.getExpression(), out);
+                    out << ";\n";
+                    break;
+                default:
+                    abort();
+            }
+
+            out << "}\n";
+
+            // end aggregator loop
+            out << "}\n";
+
+            // write result into environment tuple
+            out << "env" << identifier << "[0] = res" << identifier << ";\n";
+
+            if (aggregate.getFunction() == souffle::MIN || aggregate.getFunction() == souffle::MAX) {
+                // check whether there exists a min/max first before next loop
+                out << "if(res" << identifier << " != " << init << "){\n";
+                visitTupleOperation(aggregate, out);
+                out << "}\n";
+            } else {
+                visitTupleOperation(aggregate, out);
+            }
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitParallelAggregate(const RamParallelAggregate& aggregate, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto& rel = aggregate.getRelation();
+            auto relName = synthesiser.getRelationName(rel);
+            auto identifier = aggregate.getTupleId();
+
+            assert(identifier == 0 && "not outer-most loop");
+
+            assert(rel.getArity() > 0 && "AstTranslator failed/no parallel aggregates for nullaries");
+
+            // declare environment variable
+            out << "ram::Tuple<RamDomain,1> env" << identifier << ";\n";
+
+            out << "auto part = " << relName << "->partition();\n";
+            emitParallelAggregate(aggregate, aggregate, out);
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitParallelIndexAggregate(
+                const RamParallelIndexAggregate& aggregate, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto& rel = aggregate.getRelation();
+            auto arity = rel.getArity();
+            auto relName = synthesiser.getRelationName(rel);
+            auto identifier = aggregate.getTupleId();
+            auto keys = isa->getSearchSignature(&aggregate);
+
+            assert(identifier == 0 && "not outer-most loop");
+            emitSearchCount(rel, keys, out);
+
+            // declare environment variable
+            out << "ram::Tuple<RamDomain,1> env" << identifier << ";\n";
+
+            if (keys == 0) {
+                out << "auto part = " << relName << "->partition();\n";
+            } else {
+                out << "const ram::Tuple<RamDomain," << arity << "> key{{";
+                for (size_t i = 0; i < arity; i++) {
+                    if (!isRamUndefValue(aggregate.getRangePattern()[i])) {
+                        visit(aggregate.getRangePattern()[i], out);
+                    } else {
+                        out << "0";
+                    }
+                    if (i + 1 < arity) {
+                        out << ",";
+                    }
+                }
+                out << "}};\n";
+                out << "auto range = " << relName << "->"
+                    << "equalRange_" << keys << "(key);\n";
+                out << "auto part = range.partition(MAX_CHUNKS_PER_THREAD * MAX_THREADS, "
+                       "MIN_CHUNK_TUPLES);\n";
+            }
+            emitParallelAggregate(aggregate, aggregate, out);
+
+            PRINT_END_COMMENT(out);
+        }
+
+        /** Emit the count of an execution of a search of the relation when profiling */
+        void emitSearchCount(const RamRelation& rel, SearchSignature keys, std::ostream& out) {
+            if (Global::config().has("profile")) {
+                out << "++searches[" << synthesiser.lookupSearchIdx(rel.getName(), keys) << "];\n";
+            }
+        }
+
+        /** Emit the counter of the tuples found by a search of the relation when profiling */
+        void emitSearchTuplesStart(int identifier, std::ostream& out) {
+            if (Global::config().has("profile")) {
+                out << "size_t tuples" << identifier << " = 0;\n";
+            }
+        }
+
+        void emitSearchTuple(int identifier, std::ostream& out) {
+            if (Global::config().has("profile")) {
+                out << "++tuples" << identifier << ";\n";
+            }
+        }
+
+        void emitSearchTuplesEnd(
+                const RamRelation& rel, SearchSignature keys, int identifier, std::ostream& out) {
+            if (Global::config().has("profile")) {
+                out << "searchTuples[" << synthesiser.lookupSearchIdx(rel.getName(), keys)
+                    << "].fetch_add(tuples" << identifier << ", std::memory_order_relaxed);\n";
+            }
+        }
+
+        /**
+         * Get the index scan nested into a scan whose searches are prefetched for batches of the tuples
+         * of the scan, or nullptr; the bounds of the index scan are evaluated twice, and may thus have no
+         * side effects
+         */
+        const RamIndexScan* getPrefetchedSearch(const RamTupleOperation& scan) const {
+            const auto* search = dynamic_cast<const RamIndexScan*>(&scan.getOperation());
+            if (search == nullptr || synthesiser.prefetchRelations.count(&search->getRelation()) == 0) {
+                return nullptr;
+            }
+            bool pure = true;
+            for (const RamExpression* value : search->getRangePattern()) {
+                visitDepthFirst(*value, [&](const RamAutoIncrement&) { pure = false; });
+                visitDepthFirst(*value, [&](const RamUserDefinedOperator&) { pure = false; });
+                visitDepthFirst(*value, [&](const RamPackRecord&) { pure = false; });
+            }
+            return pure ? search : nullptr;
+        }
+
+        /**
+         * Emit the loop binding the tuple of a scan to the tuples of the given range. If the searches of
+         * an index scan nested into the scan are prefetched, the tuples are copied in batches, and the
+         * searches of a batch are prefetched before the nested operation is executed for its tuples,
+         * such that the cache misses of the searches overlap.
+         */
+        void emitScanLoop(const RamRelationOperation& scan, const std::string& range, bool counted,
+                std::ostream& out) {
+            const auto identifier = scan.getTupleId();
+            const std::string env = "env" + std::to_string(identifier);
+            const RamIndexScan* search = getPrefetchedSearch(scan);
+            if (search == nullptr) {
+                out << "for(const auto& " << env << " : " << range << ") {\n";
+                if (counted) {
+                    emitSearchTuple(identifier, out);
+                }
+                visitTupleOperation(scan, out);
+                out << "}\n";
+                return;
+            }
+
+            const auto& rel = search->getRelation();
+            const std::string prefix = "pf" + std::to_string(identifier) + "_";
+            const size_t arity = scan.getRelation().getArity();
+            const auto& rangePattern = search->getRangePattern();
+            out << "{\n";
+            out << "Tuple<RamDomain," << arity << "> " << prefix << "batch[" << prefetchBatch << "];\n";
+            out << "Tuple<RamDomain," << rel.getArity() << "> " << prefix << "keys[" << prefetchBatch
+                << "];\n";
+            out << "auto&& " << prefix << "range = " << range << ";\n";
+            out << "for(auto " << prefix << "it = " << prefix << "range.begin(); " << prefix
+                << "it != " << prefix << "range.end();) {\n";
+            out << "std::size_t " << prefix << "count = 0;\n";
+            out << "for(; " << prefix << "it != " << prefix << "range.end() && " << prefix << "count < "
+                << prefetchBatch << "; ++" << prefix << "it, ++" << prefix << "count) {\n";
+            out << "const auto& t = *" << prefix << "it;\n";
+            out << "for(std::size_t c = 0; c < " << arity << "; ++c) " << prefix << "batch[" << prefix
+                << "count][c] = t[c];\n";
+            out << "}\n";
+            out << "for(std::size_t i = 0; i < " << prefix << "count; ++i) {\n";
+            out << "const auto& " << env << " = " << prefix << "batch[i];\n";
+            out << prefix << "keys[i] = Tuple<RamDomain," << rel.getArity() << ">{{";
+            for (size_t i = 0; i < rel.getArity(); i++) {
+                if (!isRamUndefValue(rangePattern[i])) {
+                    visit(rangePattern[i], out);
+                } else {
+                    out << "0";
+                }
+                if (i + 1 < rel.getArity()) {
+                    out << ",";
+                }
+            }
+            out << "}};\n";
+            out << "}\n";
+            out << synthesiser.getRelationName(rel) << "->prefetch_" << isa->getSearchSignature(search) << "("
+                << prefix << "keys, " << prefix << "count, READ_OP_CONTEXT("
+                << synthesiser.getOpContextName(rel) << "));\n";
+            out << "for(std::size_t i = 0; i < " << prefix << "count; ++i) {\n";
+            out << "const auto& " << env << " = " << prefix << "batch[i];\n";
+            if (counted) {
+                emitSearchTuple(identifier, out);
+            }
+            visitTupleOperation(scan, out);
+            out << "}\n";
+            out << "}\n";
+            out << "}\n";
+        }
+
+        /**
+         * Emit the start of a parallel region stealing the given number of chunks, those of
+         * partition part by default. The region only forks if there is more than one chunk,
+         * i.e., the partition of a small relation is executed sequentially, unless another
+         * condition to fork is given.
+         */
+        void emitParallelStart(const RamRelation& rel, std::ostream& out,
+                const std::string& chunks = "part.size()", std::string fork = "") {
+            if (fork.empty()) {
+                fork = chunks + " > 1";
+            }
+            stealingLoop = true;
+            if (Global::config().has("profile")) {
+                out << "WorkStealingLoop partLoop(" << chunks << ", true);\n";
+                out << "++parallelScans[" << synthesiser.lookupParallelIdx(rel.getName()) << "][" << fork
+                    << " ? 0 : 1];\n";
+            } else {
+                out << "WorkStealingLoop partLoop(" << chunks << ");\n";
+            }
+            out << "PARALLEL_START_IF(" << fork << ");\n";
+        }
+
+        /**
+         * Emit a group aggregate, aggregating the tuples of the aggregated relation into a hash table on
+         * the keys of their groups and looking up the group of each scanned tuple, in parallel if
+         * requested. Each aggregated tuple is evaluated together with the key of its group in place of
+         * the scanned tuple, which satisfies the keys of the condition.
+         */
+        void emitGroupAggregate(const RamGroupAggregate& group, bool parallel, std::ostream& out) {
+            const RamAggregate& aggregate = group.getAggregate();
+            const auto& outerRel = group.getRelation();
+            const auto& innerRel = aggregate.getRelation();
+            const std::string outerName = synthesiser.getRelationName(outerRel);
+            const std::string innerName = synthesiser.getRelationName(innerRel);
+            const std::string outerEnv = "env" + std::to_string(group.getTupleId());
+            const std::string innerEnv = "env" + std::to_string(aggregate.getTupleId());
+            const std::string prefix = "ga" + std::to_string(group.getTupleId()) + "_";
+
+            // the groups are keyed by the elements of the scanned tuple equated with the aggregated columns
+            std::set<size_t> columns;
+            std::stringstream bindings;
+            for (const auto& key : group.getKeys()) {
+                columns.insert(key.second);
+                bindings << outerEnv << "[" << key.second << "] = " << innerEnv << "[" << key.first << "];\n";
+            }
+            std::vector<std::string> elements;
+            for (size_t column : columns) {
+                elements.push_back(outerEnv + "[" + std::to_string(column) + "]");
+            }
+            const std::string keyType = "Tuple<RamDomain," + std::to_string(columns.size()) + ">";
+            const std::string key = keyType + "{{" + toString(join(elements, ",")) + "}}";
+
+            std::string init;
+            std::string combine;
+            switch (aggregate.getFunction()) {
+                case souffle::MIN:
+                    init = "MAX_RAM_DOMAIN";
+                    combine = "std::min(a, b)";
+                    break;
+                case souffle::MAX:
+                    init = "MIN_RAM_DOMAIN";
+                    combine = "std::max(a, b)";
+                    break;
+                case souffle::COUNT:
+                case souffle::SUM:
+                    init = "0";
+                    combine = "a + b";
+                    break;
+                default:
+                    abort();
+            }
+            std::stringstream value;
+            if (aggregate.getFunction() == souffle::COUNT) {
+                value << "1";
+            } else {
+                visit(aggregate.getExpression(), value);
+            }
+
+            // aggregate each tuple passing the condition into the given table
+            auto emitAggregation = [&](const std::string& table) {
+                out << "Tuple<RamDomain," << outerRel.getArity() << "> " << outerEnv << "{{}};\n";
+                out << bindings.str();
+                out << "if( ";
+                visit(aggregate.getCondition(), out);
+                out << ") {\n";
+                out << "RamDomain& " << prefix << "aggregate = " << table << ".get(" << key << ", " << init
+                    << ");\n";
+                out << "const RamDomain a = " << prefix << "aggregate;\n";
+                out << "const RamDomain b = " << value.str() << ";\n";
+                out << prefix << "aggregate = " << combine << ";\n";
+                out << "}\n";
+            };
+
+            // look up the group of each scanned tuple, a missing group yields the aggregate of no tuples
+            auto emitLookup = [&]() {
+                out << "const RamDomain* " << prefix << "found = " << prefix << "groups.find(" << key
+                    << ");\n";
+                out << "ram::Tuple<RamDomain,1> " << innerEnv << "{{" << prefix << "found != nullptr ? *"
+                    << prefix << "found : " << init << "}};\n";
+                if (aggregate.getFunction() == souffle::MIN || aggregate.getFunction() == souffle::MAX) {
+                    out << "if(" << innerEnv << "[0] != " << init << "){\n";
+                    visitTupleOperation(aggregate, out);
+                    out << "}\n";
+                } else {
+                    visitTupleOperation(aggregate, out);
+                }
+            };
 
-            // end aggregator loop
+            out << "HashGroupTable<" << keyType << "> " << prefix << "groups;\n";
+            if (!parallel) {
+                out << "for(const auto& " << innerEnv << " : *" << innerName << ") {\n";
+                emitAggregation(prefix + "groups");
+                out << "}\n";
+                out << "for(const auto& " << outerEnv << " : *" << outerName << ") {\n";
+                emitLookup();
+                out << "}\n";
+                return;
+            }
+
+            // each thread aggregates chunks of the aggregated relation into a table of its own, which are
+            // merged before the chunks of the scanned relation are looked up
+            out << "auto " << prefix << "innerPart = " << innerName << "->partition();\n";
+            out << "WorkStealingLoop " << prefix << "innerLoop(" << prefix << "innerPart.size());\n";
+            out << "auto part = " << outerName << "->partition();\n";
+            emitParallelStart(
+                    outerRel, out, "part.size()", "part.size() > 1 || " + prefix + "innerPart.size() > 1");
+            out << preamble.str();
+            out << "HashGroupTable<" << keyType << "> " << prefix << "partial;\n";
+            out << "pfor_steal(it, " << prefix << "innerPart, " << prefix << "innerLoop) {\n";
+            out << "if (limits.isExceeded()) continue;\n";
+            out << "try{\n";
+            out << "for(const auto& " << innerEnv << " : *it) {\n";
+            emitAggregation(prefix + "partial");
+            out << "}\n";
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
+            out << "PARALLEL_CRITICAL\n";
+            out << prefix << "groups.merge(" << prefix << "partial, " << init
+                << ", [](RamDomain a, RamDomain b) { return " << combine << "; });\n";
+            out << "PARALLEL_BARRIER;\n";
+            out << "pfor_steal(it, part, partLoop) {\n";
+            out << "if (limits.isExceeded()) continue;\n";
+            out << "try{\n";
+            out << "for(const auto& " << outerEnv << " : *it) {\n";
+            emitLookup();
+            out << "}\n";
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
+        }
 
-            // write result into environment tuple
-            out << "env" << identifier << "[0] = res" << identifier << ";\n";
+        /**
+         * Emit a transient hash join, building a hash table of the smaller relation on the joined
+         * columns and probing it with each tuple of the larger relation, in parallel if requested.
+         * The filter of the inner scan checks the keys and evaluates the nested operation for each
+         * pair of joined tuples; it is wrapped in a lambda called by both directions of the join.
+         */
+        void emitHashJoin(const RamHashJoin& hashJoin, bool parallel, std::ostream& out) {
+            const RamScan& inner = hashJoin.getInnerScan();
+            const auto& outerRel = hashJoin.getRelation();
+            const auto& innerRel = inner.getRelation();
+            const std::string outerName = synthesiser.getRelationName(outerRel);
+            const std::string innerName = synthesiser.getRelationName(innerRel);
+            const std::string outerEnv = "env" + std::to_string(hashJoin.getTupleId());
+            const std::string innerEnv = "env" + std::to_string(inner.getTupleId());
+            const std::string prefix = "hj" + std::to_string(hashJoin.getTupleId()) + "_";
+            const std::string buildOuter = prefix + "buildOuter";
+
+            // the keys of the hash table are the joined columns, the constants filter the inner tuples
+            std::vector<std::string> outerKeys;
+            std::vector<std::string> innerKeys;
+            std::vector<std::string> constants;
+            for (const auto& key : hashJoin.getKeys()) {
+                const std::string column = innerEnv + "[" + std::to_string(key.first) + "]";
+                if (const auto* element = dynamic_cast<const RamTupleElement*>(key.second)) {
+                    outerKeys.push_back(outerEnv + "[" + std::to_string(element->getElement()) + "]");
+                    innerKeys.push_back(column);
+                } else {
+                    std::stringstream value;
+                    visit(key.second, value);
+                    constants.push_back("(" + column + " == " + value.str() + ")");
+                }
+            }
+            const std::string candidate = constants.empty() ? "true" : toString(join(constants, " && "));
+            const std::string keyType = "Tuple<RamDomain," + std::to_string(outerKeys.size()) + ">";
+            auto copy = [](const std::string& env, size_t arity) {
+                std::vector<std::string> values;
+                for (size_t i = 0; i < arity; i++) {
+                    values.push_back(env + "[" + std::to_string(i) + "]");
+                }
+                return "Tuple<RamDomain," + std::to_string(arity) + ">{{" + toString(join(values, ",")) +
+                       "}}";
+            };
+
+            // the hash table is built on the smaller relation, whose tuples are copied
+            out << "const bool " << buildOuter << " = " << outerName << "->size() <= " << innerName
+                << "->size();\n";
+            out << "HashJoinTable<" << keyType << ",Tuple<RamDomain," << outerRel.getArity() << ">> "
+                << prefix << "outerTable;\n";
+            out << "HashJoinTable<" << keyType << ",Tuple<RamDomain," << innerRel.getArity() << ">> "
+                << prefix << "innerTable;\n";
+            out << "if (" << buildOuter << ") {\n";
+            out << "for(const auto& " << outerEnv << " : *" << outerName << ") " << prefix
+                << "outerTable.insert(" << keyType << "{{" << join(outerKeys, ",") << "}}, "
+                << copy(outerEnv, outerRel.getArity()) << ");\n";
+            out << prefix << "outerTable.build();\n";
+            out << "} else {\n";
+            out << "for(const auto& " << innerEnv << " : *" << innerName << ") {\n";
+            out << "if (" << candidate << ") " << prefix << "innerTable.insert(" << keyType << "{{"
+                << join(innerKeys, ",") << "}}, " << copy(innerEnv, innerRel.getArity()) << ");\n";
+            out << "}\n";
+            out << prefix << "innerTable.build();\n";
+            out << "}\n";
 
-            if (aggregate.getFunction() == souffle::MIN || aggregate.getFunction() == souffle::MAX) {
-                // check whether there exists a min/max first before next loop
-                out << "if(res" << identifier << " != " << init << "){\n";
-                visitTupleOperation(aggregate, out);
+            // the probes of both directions of the join
+            std::stringstream probeInner;
+            probeInner << "if (" << candidate << ") " << prefix << "outerTable.probe(" << keyType << "{{"
+                       << join(innerKeys, ",") << "}}, [&](const auto& " << prefix << "row) { " << prefix
+                       << "join(" << prefix << "row, " << innerEnv << "); });\n";
+            std::stringstream probeOuter;
+            probeOuter << prefix << "innerTable.probe(" << keyType << "{{" << join(outerKeys, ",")
+                       << "}}, [&](const auto& " << prefix << "row) { " << prefix << "join(" << outerEnv
+                       << ", " << prefix << "row); });\n";
+
+            if (parallel) {
+                // only the partition of the probing relation is computed
+                out << "decltype(" << outerName << "->partition()) " << prefix << "outerPart;\n";
+                out << "decltype(" << innerName << "->partition()) " << prefix << "innerPart;\n";
+                out << "if (" << buildOuter << ") " << prefix << "innerPart = " << innerName
+                    << "->partition();\n";
+                out << "else " << prefix << "outerPart = " << outerName << "->partition();\n";
+                emitParallelStart(outerRel, out,
+                        "(" + buildOuter + " ? " + prefix + "innerPart.size() : " + prefix +
+                                "outerPart.size())");
+                out << preamble.str();
+            }
+            out << "auto " << prefix << "join = [&](const auto& " << outerEnv << ", const auto& " << innerEnv
+                << ") {\n";
+            out << "for (int " << prefix << "once = 0; " << prefix << "once < 1; ++" << prefix << "once) {\n";
+            visit(inner.getOperation(), out);
+            out << "}\n";
+            out << "};\n";
+            if (parallel) {
+                out << "if (" << buildOuter << ") {\n";
+                out << "pfor_steal(it, " << prefix << "innerPart, partLoop) {\n";
+                out << "if (limits.isExceeded()) continue;\n";
+                out << "try{\n";
+                out << "for(const auto& " << innerEnv << " : *it) {\n";
+                out << probeInner.str();
+                out << "}\n";
+                out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+                out << "}\n";
+                out << "} else {\n";
+                out << "pfor_steal(it, " << prefix << "outerPart, partLoop) {\n";
+                out << "if (limits.isExceeded()) continue;\n";
+                out << "try{\n";
+                out << "for(const auto& " << outerEnv << " : *it) {\n";
+                out << probeOuter.str();
+                out << "}\n";
+                out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+                out << "}\n";
                 out << "}\n";
             } else {
-                visitTupleOperation(aggregate, out);
+                out << "if (" << buildOuter << ") {\n";
+                out << "for(const auto& " << innerEnv << " : *" << innerName << ") {\n";
+                out << probeInner.str();
+                out << "}\n";
+                out << "} else {\n";
+                out << "for(const auto& " << outerEnv << " : *" << outerName << ") {\n";
+                out << probeOuter.str();
+                out << "}\n";
+                out << "}\n";
             }
-
-            PRINT_END_COMMENT(out);
         }
 
-        void visitAggregate(const RamAggregate& aggregate, std::ostream& out) override {
-            PRINT_BEGIN_COMMENT(out);
-            // get some properties
-            const auto& rel = aggregate.getRelation();
-            auto relName = synthesiser.getRelationName(rel);
-            auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
-            auto identifier = aggregate.getTupleId();
+        /**
+         * Emit the merge of an ordered range of the relation of a merge join with a cursor on the
+         * relation of its index scan. The cursor is advanced linearly to each new value of the
+         * range, or sought in the index of the scan if the value is further ahead, and the group
+         * of tuples of the value is joined with each tuple of the range agreeing on it.
+         */
+        void emitMergeJoin(const RamMergeJoin& merge, const std::string& outer, std::ostream& out) {
+            const RamIndexScan& inner = merge.getInnerScan();
+            const auto& rel = inner.getRelation();
+            const std::string prefix = "mj" + std::to_string(merge.getTupleId()) + "_";
+            const std::string key = prefix + "key";
+            const std::string pos = prefix + "pos";
+            const std::string end = prefix + "end";
+            const std::string group = prefix + "group";
+            const std::string value = "env" + std::to_string(merge.getTupleId()) + "[" +
+                                      std::to_string(merge.getColumn()) + "]";
+            const std::string current = key + "[" + std::to_string(merge.getInnerColumn()) + "]";
+            const std::string cursor = "(*" + pos + ")[" + std::to_string(merge.getInnerColumn()) + "]";
+            const std::string lowerRange = synthesiser.getRelationName(rel) + "->lowerRange_" +
+                                           std::to_string(isa->getSearchSignature(&inner)) + "(" + key +
+                                           ",READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + "))";
+
+            // the cursor starts at the least value, and the key holds the value of the current group
+            out << "Tuple<RamDomain," << rel.getArity() << "> " << key << "{{"
+                << join(std::vector<std::string>(rel.getArity(), "MIN_RAM_DOMAIN"), ",") << "}};\n";
+            out << "auto " << prefix << "cursor = " << lowerRange << ";\n";
+            out << "auto " << pos << " = " << prefix << "cursor.begin();\n";
+            out << "const auto " << end << " = " << prefix << "cursor.end();\n";
+            out << "auto " << group << " = " << pos << ";\n";
+            out << "bool " << prefix << "started = false;\n";
+            out << "for(const auto& env" << merge.getTupleId() << " : " << outer << ") {\n";
+            out << "if (!" << prefix << "started || " << current << " != " << value << ") {\n";
+            out << "for (size_t " << prefix << "step = 0; " << prefix
+                << "step < " << RamMergeJoin::LINEAR_STEPS << " && " << pos << " != " << end << " && "
+                << cursor << " < " << value << "; ++" << prefix << "step) ++" << pos << ";\n";
+            out << current << " = " << value << ";\n";
+            out << "if (" << pos << " != " << end << " && " << cursor << " < " << value << ") " << pos
+                << " = " << lowerRange << ".begin();\n";
+            out << prefix << "started = true;\n";
+            out << group << " = " << pos << ";\n";
+            out << "while (" << pos << " != " << end << " && " << cursor << " == " << value << ") ++" << pos
+                << ";\n";
+            out << "}\n";
+            if (Global::config().has("profile") && !merge.getProfileText().empty()) {
+                out << "freqs[" << synthesiser.lookupFreqIdx(merge.getProfileText()) << "]++;\n";
+            }
+            out << "for (auto " << prefix << "it = " << group << "; " << prefix << "it != " << pos << "; ++"
+                << prefix << "it) {\n";
+            out << "const auto& env" << inner.getTupleId() << " = *" << prefix << "it;\n";
 
-            // declare environment variable
-            out << "ram::Tuple<RamDomain,1> env" << identifier << ";\n";
+            visitTupleOperation(inner, out);
 
-            // special case: counting number elements over an unrestricted predicate
-            if (aggregate.getFunction() == souffle::COUNT && isRamTrue(&aggregate.getCondition())) {
-                // shortcut: use relation size
-                out << "env" << identifier << "[0] = " << relName << "->"
-                    << "size();\n";
-                visitTupleOperation(aggregate, out);
-                PRINT_END_COMMENT(out);
-                return;
-            }
+            out << "}\n";
+            out << "}\n";
+        }
+
+        /**
+         * Emit a parallel aggregate over the partition part, where each thread
+         * aggregates a partial result. The nested operation is executed once
+         * by a single thread after the partial results have been combined.
+         */
+        void emitParallelAggregate(
+                const RamAbstractAggregate& aggregate, const RamRelationOperation& op, std::ostream& out) {
+            auto identifier = op.getTupleId();
+
+            assert(!preambleIssued && "only first loop can be made parallel");
+            preambleIssued = true;
 
             // init result
             std::string init;
@@ -995,32 +2225,35 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             }
             out << "RamDomain res" << identifier << " = " << init << ";\n";
 
-            // check whether there is an index to use
-            out << "for(const auto& env" << identifier << " : "
-                << "*" << relName << ") {\n";
+            emitParallelStart(op.getRelation(), out);
+            out << preamble.str();
+            out << "RamDomain partial" << identifier << " = " << init << ";\n";
+            out << "pfor_steal(it, part, partLoop) {\n";
+            out << "if (limits.isExceeded()) continue;\n";
+            out << "try{\n";
+            out << "for(const auto& env" << identifier << " : *it) {\n";
 
             // produce condition inside the loop
             out << "if( ";
             visit(aggregate.getCondition(), out);
             out << ") {\n";
 
-            // pick function
             switch (aggregate.getFunction()) {
                 case souffle::MIN:
-                    out << "res" << identifier << " = std::min(res" << identifier << ",";
+                    out << "partial" << identifier << " = std::min(partial" << identifier << ",";
                     visit(aggregate.getExpression(), out);
                     out << ");\n";
                     break;
                 case souffle::MAX:
-                    out << "res" << identifier << " = std::max(res" << identifier << ",";
+                    out << "partial" << identifier << " = std::max(partial" << identifier << ",";
                     visit(aggregate.getExpression(), out);
                     out << ");\n";
                     break;
                 case souffle::COUNT:
-                    out << "++res" << identifier << "\n;";
+                    out << "++partial" << identifier << ";\n";
                     break;
                 case souffle::SUM:
-                    out << "res" << identifier << " += ";
+                    out << "partial" << identifier << " += ";
                     visit(aggregate.getExpression(), out);
                     out << ";\n";
                     break;
@@ -1029,23 +2262,41 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             }
 
             out << "}\n";
-
-            // end aggregator loop
+            out << "}\n";
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
 
-            // write result into environment tuple
-            out << "env" << identifier << "[0] = res" << identifier << ";\n";
+            // combine partial results
+            out << "PARALLEL_CRITICAL\n";
+            switch (aggregate.getFunction()) {
+                case souffle::MIN:
+                    out << "res" << identifier << " = std::min(res" << identifier << ",partial" << identifier
+                        << ");\n";
+                    break;
+                case souffle::MAX:
+                    out << "res" << identifier << " = std::max(res" << identifier << ",partial" << identifier
+                        << ");\n";
+                    break;
+                default:
+                    out << "res" << identifier << " += partial" << identifier << ";\n";
+            }
+            out << "PARALLEL_BARRIER;\n";
 
+            // execute the nested operation once
+            out << "PARALLEL_SINGLE\n";
+            out << "{\n";
+            out << "try{\n";
+            out << "env" << identifier << "[0] = res" << identifier << ";\n";
             if (aggregate.getFunction() == souffle::MIN || aggregate.getFunction() == souffle::MAX) {
                 // check whether there exists a min/max first before next loop
                 out << "if(res" << identifier << " != " << init << "){\n";
-                visitTupleOperation(aggregate, out);
+                visitTupleOperation(op, out);
                 out << "}\n";
             } else {
-                visitTupleOperation(aggregate, out);
+                visitTupleOperation(op, out);
             }
-
-            PRINT_END_COMMENT(out);
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
         }
 
         void visitFilter(const RamFilter& filter, std::ostream& out) override {
@@ -1082,9 +2333,15 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                     << join(project.getValues(), "),static_cast<RamDomain>(", rec) << ")}};\n";
             }
 
-            // insert tuple
-            out << relName << "->"
-                << "insert(tuple," << ctxName << ");\n";
+            // insert tuple, or buffer it until the end of the query
+            if (bufferedRelations.count(&rel) > 0 && isSubtried(rel)) {
+                out << "buffer_" << relName << ".insert(tuple,buffer_" << relName << "_ctxt);\n";
+            } else if (bufferedRelations.count(&rel) > 0) {
+                out << "buffer_" << relName << ".push_back(tuple);\n";
+            } else {
+                out << relName << "->"
+                    << "insert(tuple," << ctxName << ");\n";
+            }
 
             PRINT_END_COMMENT(out);
         }
@@ -1175,18 +2432,20 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                     break;
 
                 // strings
-                case BinaryConstraintOp::MATCH: {
-                    out << "regex_wrapper(symTable.resolve(";
-                    visit(rel.getLHS(), out);
-                    out << "),symTable.resolve(";
-                    visit(rel.getRHS(), out);
-                    out << "))";
-                    break;
-                }
+                case BinaryConstraintOp::MATCH:
                 case BinaryConstraintOp::NOT_MATCH: {
-                    out << "!regex_wrapper(symTable.resolve(";
-                    visit(rel.getLHS(), out);
-                    out << "),symTable.resolve(";
+                    if (rel.getOperator() == BinaryConstraintOp::NOT_MATCH) {
+                        out << "!";
+                    }
+                    // constant patterns are compiled once by the constructor of the program
+                    if (const auto* pattern = dynamic_cast<const RamSignedConstant*>(&rel.getLHS())) {
+                        out << "regex_wrapper(regex_" << synthesiser.lookupRegexIdx(pattern->getConstant());
+                    } else {
+                        out << "regex_wrapper(symTable.resolve(";
+                        visit(rel.getLHS(), out);
+                        out << ")";
+                    }
+                    out << ",symTable.resolve(";
                     visit(rel.getRHS(), out);
                     out << "))";
                     break;
@@ -1216,8 +2475,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitEmptinessCheck(const RamEmptinessCheck& emptiness, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
-            out << synthesiser.getRelationName(emptiness.getRelation()) << "->"
-                << "empty()";
+            // unallocated relations are empty, without allocating them
+            out << synthesiser.getRelationName(emptiness.getRelation()) << ".empty()";
             PRINT_END_COMMENT(out);
         }
 
@@ -1234,6 +2493,14 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << R"_((reads[)_" << synthesiser.lookupReadIdx(rel.getName()) << R"_(]++,)_";
                 after = ")";
             }
+            if (Global::config().has("profile")) {
+                // count the execution of the search, and whether it found a tuple
+                const size_t idx =
+                        synthesiser.lookupSearchIdx(rel.getName(), isa->getSearchSignature(&exists));
+                out << "(searches[" << idx << "]++,(";
+                after = " && (searchTuples[" + std::to_string(idx) +
+                        "].fetch_add(1, std::memory_order_relaxed), true)))" + after;
+            }
 
             // if it is total we use the contains function
             if (isa->isTotalSignature(&exists)) {
@@ -1342,6 +2609,12 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitSignedConstant(const RamSignedConstant& constant, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
+            if (constantArguments != nullptr) {
+                out << "c" << constantArguments->size();
+                constantArguments->push_back("RamSigned(" + std::to_string(constant.getConstant()) + ")");
+                PRINT_END_COMMENT(out);
+                return;
+            }
             out << "RamSigned(" << constant.getConstant() << ")";
             PRINT_END_COMMENT(out);
         }
@@ -1561,17 +2834,16 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
                 // strings
                 case FunctorOp::CAT: {
-                    out << "symTable.lookup(";
-                    size_t i = 0;
-                    while (i < args.size() - 1) {
-                        out << "symTable.resolve(";
+                    out << "symTable.concatenate({";
+                    for (size_t i = 0; i < args.size(); i++) {
+                        if (i > 0) {
+                            out << ",";
+                        }
+                        out << "RamDomain(";
                         visit(args[i], out);
-                        out << ") + ";
-                        i++;
+                        out << ")";
                     }
-                    out << "symTable.resolve(";
-                    visit(args[i], out);
-                    out << "))";
+                    out << "})";
                     break;
                 }
 
@@ -1602,6 +2874,18 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             const std::vector<TypeAttribute>& argTypes = op.getArgsTypes();
             auto args = op.getArguments();
 
+            // stateful functors resolve and intern symbols themselves
+            if (op.isStateful()) {
+                out << name << "(&symTable,&recordTable";
+                for (auto* arg : args) {
+                    out << ",((RamDomain)";
+                    visit(*arg, out);
+                    out << ")";
+                }
+                out << ")";
+                return;
+            }
+
             if (op.getReturnType() == TypeAttribute::Symbol) {
                 out << "symTable.lookup(";
             }
@@ -1662,7 +2946,9 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         // -- subroutine return --
 
         void visitSubroutineReturnValue(const RamSubroutineReturnValue& ret, std::ostream& out) override {
-            out << "std::lock_guard<std::mutex> guard(lock);\n";
+            if (lockReturnValues) {
+                out << "std::lock_guard<std::mutex> guard(lock);\n";
+            }
             for (auto val : ret.getValues()) {
                 if (isRamUndefValue(val)) {
                     out << "ret.push_back(0);\n";
@@ -1687,10 +2973,26 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
     };
 
     // emit code
-    CodeEmitter(*this).visit(stmt, out);
+    CodeEmitter(*this, stmt).visit(stmt, out);
+}
+
+std::vector<const RamStatement*> Synthesiser::getStrata(const RamStatement& main) {
+    const std::vector<const RamStatement*> statements = RamBaseAnalysis::getStatements(main);
+
+    // statements without rules, such as loads and the maintenance of indexes, remain in runFunction
+    std::vector<const RamStatement*> strata;
+    for (const RamStatement* statement : statements) {
+        bool hasQuery = false;
+        visitDepthFirst(*statement, [&](const RamQuery&) { hasQuery = true; });
+        if (hasQuery) {
+            strata.push_back(statement);
+        }
+    }
+    return strata;
 }
 
-void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary) {
+void Synthesiser::generateCode(std::ostream& out, const std::string& id, bool& withSharedLibrary,
+        std::ostream* header, const std::string& headerName, std::vector<std::string>* units) {
     // ---------------------------------------------------------------
     //                      Auto-Index Generation
     // ---------------------------------------------------------------
@@ -1706,7 +3008,31 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     std::string classname = "Sf_" + id;
 
+    // the relation types and the class of the program are declared in the header of split code, and
+    // the methods evaluating the program are defined in the main unit and the units of the strata
+    const bool split = units != nullptr;
+    std::ostream& os = split ? *header : out;
+    std::ostream& defs = out;
+
+    // emit the declaration of a method in the class, returning the stream of its definition
+    const auto defineMethod = [&](const std::string& declaration,
+                                      const std::string& definition) -> std::ostream& {
+        if (!split) {
+            os << declaration << " {\n";
+            return os;
+        }
+        os << declaration << ";\n";
+        defs << definition << " {\n";
+        return defs;
+    };
+
     // generate C++ program
+    if (split) {
+        os << "#pragma once\n";
+        defs << "#include \"" << headerName << "\"\n";
+        defs << "namespace souffle {\n";
+        defs << "using namespace ram;\n";
+    }
     os << "\n#include \"souffle/CompiledSouffle.h\"\n";
     if (Global::config().has("provenance")) {
         os << "#include <mutex>\n";
@@ -1717,13 +3043,23 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         os << "#include <thread>\n";
         os << "#include \"souffle/profile/Tui.h\"\n";
     }
+    if (Global::config().has("profile-endpoint")) {
+        os << "#include \"souffle/profile/LiveEndpoint.h\"\n";
+    }
+    if (Global::config().has("serve")) {
+        os << "#include \"souffle/ProgramServer.h\"\n";
+    }
     os << "\n";
     // produce external definitions for user-defined functors
     std::map<std::string, std::pair<TypeAttribute, std::vector<TypeAttribute>>> functors;
+    std::set<std::string> statefulFunctors;
     visitDepthFirst(prog, [&](const RamUserDefinedOperator& op) {
         if (functors.find(op.getName()) == functors.end()) {
             functors[op.getName()] = std::make_pair(op.getReturnType(), op.getArgsTypes());
         }
+        if (op.isStateful()) {
+            statefulFunctors.insert(op.getName());
+        }
         withSharedLibrary = true;
     });
     os << "extern \"C\" {\n";
@@ -1735,6 +3071,15 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         const auto& returnType = functorTypes.first;
         const auto& argsTypes = functorTypes.second;
 
+        if (contains(statefulFunctors, name)) {
+            os << "souffle::RamDomain " << name << "(souffle::SymbolTable*,souffle::RecordTable*";
+            for (size_t i = 0; i < argsTypes.size(); i++) {
+                os << ",souffle::RamDomain";
+            }
+            os << ");\n";
+            continue;
+        }
+
         switch (returnType) {
             case TypeAttribute::Signed:
                 os << "souffle::RamSigned ";
@@ -1784,7 +3129,19 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     for (auto rel : prog.getRelations()) {
         bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
         auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                *rel, idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
+                *rel, idxAnalysis->getIndexes(*rel), rel->getAuxiliaryArity() > 0 && !isProvInfo);
+        if (relationType->hasInsertAll()) {
+            insertAllRelations.insert(rel);
+        }
+        if (relationType->hasPrefetch()) {
+            prefetchRelations.insert(rel);
+        }
+        if (relationType->hasInsertionCounter()) {
+            countedRelations.insert(rel);
+        }
+        if (relationType->hasOrderedIndexes()) {
+            orderedRelations.insert(rel);
+        }
 
         generateRelationTypeStruct(os, std::move(relationType));
     }
@@ -1792,21 +3149,76 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     os << "class " << classname << " : public SouffleProgram {\n";
 
-    // regex wrapper
+    // regex wrapper, matching compiled patterns, and patterns computed at runtime through the cache of
+    // the thread
     os << "private:\n";
+    os << "static inline bool regex_wrapper(const CompiledRegex& regex, const std::string& text) {\n";
+    os << "   if (!regex.isValid()) {\n";
+    os << "     std::cerr << \"warning: wrong pattern provided for match(\\\"\" << regex.getPattern() << "
+          "\"\\\",\\\"\" << text << \"\\\").\\n\";\n";
+    os << "     return false;\n";
+    os << "   }\n";
+    os << "   return regex.matches(text);\n";
+    os << "}\n";
     os << "static inline bool regex_wrapper(const std::string& pattern, const std::string& text) {\n";
-    os << "   bool result = false; \n";
-    os << "   try { result = std::regex_match(text, std::regex(pattern)); } catch(...) { \n";
-    os << "     std::cerr << \"warning: wrong pattern provided for match(\\\"\" << pattern << \"\\\",\\\"\" "
-          "<< text << \"\\\").\\n\";\n}\n";
-    os << "   return result;\n";
+    os << "   return regex_wrapper(RegexCache::get(pattern), text);\n";
     os << "}\n";
 
+    // constant patterns of match constraints, compiled once
+    visitDepthFirst(prog, [&](const RamConstraint& constraint) {
+        if (constraint.getOperator() == BinaryConstraintOp::MATCH ||
+                constraint.getOperator() == BinaryConstraintOp::NOT_MATCH) {
+            if (const auto* pattern = dynamic_cast<const RamSignedConstant*>(&constraint.getLHS())) {
+                lookupRegexIdx(pattern->getConstant());
+            }
+        }
+    });
+    for (const auto& cur : regexIdxMap) {
+        os << "const CompiledRegex regex_" << cur.second << "{R\"_(" << symTable.resolve(cur.first)
+           << ")_\"};\n";
+    }
+
+    // runs of consecutive facts of a relation are emitted as static arrays, rather than as a query each
+    visitDepthFirst(prog, [&](const RamSequence& seq) {
+        const auto statements = seq.getStatements();
+        for (size_t i = 0; i < statements.size();) {
+            const RamProject* first = getFact(*statements[i]);
+            size_t end = i + 1;
+            while (first != nullptr && end < statements.size()) {
+                const RamProject* next = getFact(*statements[end]);
+                if (next == nullptr || &next->getRelation() != &first->getRelation()) {
+                    break;
+                }
+                ++end;
+            }
+            if (end - i > 1) {
+                auto& batch = factBatches[statements[i]];
+                for (size_t j = i; j < end; ++j) {
+                    batch.push_back(getFact(*statements[j]));
+                    batchedFacts.insert(statements[j]);
+                }
+                lookupRuleIdx(getFactsMessage(first->getRelation(), batch.size()));
+            }
+            i = end;
+        }
+    });
+
+    // messages of rules, registered once such that rules only record their ids
+    visitDepthFirst(prog, [&](const RamDebugInfo& dbg) {
+        if (batchedFacts.count(&dbg) == 0) {
+            lookupRuleIdx(dbg.getMessage());
+        }
+    });
+    for (const auto& cur : ruleIdxMap) {
+        os << "const std::size_t rule_" << cur.second << " = SignalHandler::instance()->registerMsg(R\"_("
+           << cur.first << ")_\");\n";
+    }
+
     // substring wrapper
     os << "private:\n";
-    os << "static inline std::string substr_wrapper(const std::string& str, size_t idx, size_t len) {\n";
-    os << "   std::string result; \n";
-    os << "   try { result = str.substr(idx,len); } catch(...) { \n";
+    os << "static inline std::string_view substr_wrapper(const std::string& str, size_t idx, size_t len) {\n";
+    os << "   std::string_view result; \n";
+    os << "   try { result = std::string_view(str).substr(idx,len); } catch(...) { \n";
     os << "     std::cerr << \"warning: wrong index position provided by substr(\\\"\";\n";
     os << "     std::cerr << str << \"\\\",\" << (int32_t)idx << \",\" << (int32_t)len << \") "
           "functor.\\n\";\n";
@@ -1831,24 +3243,28 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     os << "public:\n";
 
-    // declare symbol table
+    // declare symbol table, shared with the forks of the program
     os << "// -- initialize symbol table --\n";
 
-    os << "SymbolTable symTable\n";
+    // the symbols are a static array of literals, interned without constructing temporary strings
     if (symTable.size() > 0) {
-        os << "{\n";
+        os << "static constexpr const char* initialSymbols[] = {\n";
         for (size_t i = 0; i < symTable.size(); i++) {
             os << "\tR\"_(" << symTable.resolve(i) << ")_\",\n";
         }
-        os << "}";
+        os << "};\n";
+        os << "std::shared_ptr<SymbolTable> symTableOwner = std::make_shared<SymbolTable>(initialSymbols, "
+           << symTable.size() << ");\n";
+    } else {
+        os << "std::shared_ptr<SymbolTable> symTableOwner = std::make_shared<SymbolTable>();\n";
     }
-    os << ";";
+    os << "SymbolTable& symTable = *symTableOwner;\n";
 
-    // declare record table
+    // declare record table, shared with the forks of the program
     os << "// -- initialize record table --\n";
 
-    os << "RecordTable recordTable;"
-       << "\n";
+    os << "std::shared_ptr<RecordTable> recordTableOwner = std::make_shared<RecordTable>();\n";
+    os << "RecordTable& recordTable = *recordTableOwner;\n";
 
     if (Global::config().has("profile")) {
         os << "private:\n";
@@ -1862,16 +3278,44 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             }
         }
         os << "  size_t reads[" << numRead << "]{};\n";
+        visitDepthFirst(prog, [&](const RamRelationOperation& op) {
+            if (dynamic_cast<const RamParallelScan*>(&op) != nullptr ||
+                    dynamic_cast<const RamParallelIndexScan*>(&op) != nullptr ||
+                    dynamic_cast<const RamParallelAggregate*>(&op) != nullptr ||
+                    dynamic_cast<const RamParallelIndexAggregate*>(&op) != nullptr) {
+                lookupParallelIdx(op.getRelation().getName());
+            }
+        });
+        if (!parallelIdxMap.empty()) {
+            os << "  size_t parallelScans[" << parallelIdxMap.size() << "][2]{};\n";
+        }
+        visitDepthFirst(prog, [&](const RamIndexOperation& search) {
+            if (dynamic_cast<const RamLeapfrogJoin*>(&search) == nullptr) {
+                lookupSearchIdx(search.getRelation().getName(), idxAnalysis->getSearchSignature(&search));
+            }
+        });
+        visitDepthFirst(prog, [&](const RamExistenceCheck& exists) {
+            lookupSearchIdx(exists.getRelation().getName(), idxAnalysis->getSearchSignature(&exists));
+        });
+        if (!searchIdxMap.empty()) {
+            os << "  size_t searches[" << searchIdxMap.size() << "]{};\n";
+            os << "  std::atomic<size_t> searchTuples[" << searchIdxMap.size() << "]{};\n";
+        }
     }
 
     // print relation definitions
     std::string initCons;     // initialization of constructor
+    std::string forkCons;     // initialization of the constructor of forks
     std::string registerRel;  // registration of relations
     int relCtr = 0;
     std::set<std::string> storeRelations;
     std::set<std::string> loadRelations;
-    visitDepthFirst(prog.getMain(),
-            [&](const RamStore& store) { storeRelations.insert(store.getRelation().getName()); });
+    // the new tuples of streamed relations are stores of temporary relations, which are not outputs
+    visitDepthFirst(prog.getMain(), [&](const RamStore& store) {
+        if (!store.getRelation().isTemp()) {
+            storeRelations.insert(store.getRelation().getName());
+        }
+    });
     visitDepthFirst(
             prog.getMain(), [&](const RamLoad& load) { loadRelations.insert(load.getRelation().getName()); });
 
@@ -1886,14 +3330,20 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         // this would permit a more efficient storage of relations (no indexes!!)
         bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
         auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                *rel, idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
+                *rel, idxAnalysis->getIndexes(*rel), rel->getAuxiliaryArity() > 0 && !isProvInfo);
         const std::string& type = relationType->getTypeName();
 
         // defining table
         os << "// -- Table: " << datalogName << "\n";
 
-        os << "std::unique_ptr<" << type << "> " << cppName << " = std::make_unique<" << type << ">();\n";
-        if (!rel->isTemp()) {
+        os << "LazyRelation<" << type << "> " << cppName << ";\n";
+
+        // the changes of input relations are passed to incremental updates through the interface
+        const bool isChangeRelation =
+                datalogName.rfind("@add_", 0) == 0 || datalogName.rfind("@del_", 0) == 0;
+        const bool isInputChange = Global::config().has("incremental") && isChangeRelation &&
+                                   loadRelations.count(datalogName.substr(5)) > 0;
+        if (!rel->isTemp() || isInputChange) {
             os << "souffle::RelationWrapper<";
             os << relCtr++ << ",";
             os << type << ",";
@@ -1925,8 +3375,12 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             if (!initCons.empty()) {
                 initCons += ",\n";
             }
-            initCons += "\nwrapper_" + cppName + "(" + "*" + cppName + ",symTable,\"" + datalogName + "\"," +
-                        tupleType + "," + tupleName + ")";
+            const std::string wrapperCons = "\nwrapper_" + cppName + "(" + cppName + ",symTable,\"" +
+                                            datalogName + "\"," + tupleType + "," + tupleName + ")";
+            initCons += wrapperCons;
+            // forks share the base relations, and start with empty other relations
+            forkCons += ",\n" + cppName + "(base->isBaseRelation(\"" + datalogName + "\") ? LazyRelation<" +
+                        type + ">(base->" + cppName + ") : LazyRelation<" + type + ">())," + wrapperCons;
             registerRel += "addRelation(\"" + datalogName + "\",&wrapper_" + cppName + ",";
             registerRel += (loadRelations.count(rel->getName()) > 0) ? "true" : "false";
             registerRel += ",";
@@ -1934,27 +3388,95 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             registerRel += ");\n";
         }
     }
+    // the results of subroutines not writing relations may be cached until the relations they read change
+    for (const auto& sub : prog.getSubroutines()) {
+        if (!RamBaseAnalysis::writesRelations(*sub.second)) {
+            auto quote = [](std::ostream& out, const std::string& name) { out << '"' << name << '"'; };
+            registerRel += "addCachedSubroutine(\"" + sub.first + "\", {" +
+                           toString(join(RamBaseAnalysis::getReferencedRelations(*sub.second), ", ", quote)) +
+                           "});\n";
+        }
+    }
     os << "public:\n";
 
     // -- constructor --
 
-    os << classname;
+    std::string initializers;
     if (Global::config().has("profile")) {
-        os << "(std::string pf=\"profile.log\") : profiling_fname(pf)";
-        if (!initCons.empty()) {
-            os << ",\n" << initCons;
-        }
+        initializers = " : profiling_fname(pf)" + (initCons.empty() ? "" : ",\n" + initCons);
+    } else if (!initCons.empty()) {
+        initializers = " : " + initCons;
+    }
+    const std::string parameters = Global::config().has("profile") ? "(std::string pf)" : "()";
+    std::ostream& constructor = split ? defs : os;
+    if (split) {
+        os << classname << (Global::config().has("profile") ? "(std::string pf=\"profile.log\")" : "()")
+           << ";\n";
+        defs << classname << "::" << classname << parameters;
     } else {
-        os << "()";
-        if (!initCons.empty()) {
-            os << " : " << initCons;
+        os << classname << (Global::config().has("profile") ? "(std::string pf=\"profile.log\")" : "()");
+    }
+    constructor << initializers << "{\n";
+    if (Global::config().has("profile")) {
+        constructor << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
+        if (Global::config().has("profile-counters")) {
+            constructor << "ProfileEventSingleton::instance().enableCounters();\n";
         }
     }
-    os << "{\n";
+    constructor << registerRel;
+    constructor << "}\n";
+
+    // -- constructor of forks, sharing the base relations and the symbol and record tables --
+    std::string forkInitializers = " : ";
+    if (Global::config().has("profile")) {
+        forkInitializers += "profiling_fname(base->profiling_fname),\n";
+    }
+    forkInitializers +=
+            "symTableOwner(base->symTableOwner),\nrecordTableOwner(base->recordTableOwner)" + forkCons;
+    std::ostream& forkConstructor = split ? defs : os;
+    os << "private:\n";
+    if (split) {
+        os << "explicit " << classname << "(const " << classname << "* base);\n";
+        defs << classname << "::" << classname << "(const " << classname << "* base)";
+    } else {
+        os << "explicit " << classname << "(const " << classname << "* base)";
+    }
+    forkConstructor << forkInitializers << "{\n";
+    forkConstructor << registerRel;
+    forkConstructor << "adoptBase(*base);\n";
+    forkConstructor << "}\n";
+    os << "public:\n";
+    os << "SouffleProgram* fork() const override {\n";
+    os << "return new " << classname << "(this);\n";
+    os << "}\n";
+
+    // -- constructor of reloaded programs, adopting the symbol and record tables of a previous version --
+    std::string reloadInitializers = " : ";
     if (Global::config().has("profile")) {
-        os << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
+        reloadInitializers += "profiling_fname(\"profile.log\"),\n";
+    }
+    reloadInitializers += "symTableOwner(adoptSymbolTable(previous, ";
+    reloadInitializers +=
+            symTable.size() > 0 ? "initialSymbols, " + std::to_string(symTable.size()) : "nullptr, 0";
+    reloadInitializers += ")),\nrecordTableOwner(adoptRecordTable(previous, symTableOwner))";
+    if (!initCons.empty()) {
+        reloadInitializers += ",\n" + initCons;
+    }
+    std::ostream& reloadConstructor = split ? defs : os;
+    if (split) {
+        os << "explicit " << classname << "(const SouffleProgram& previous);\n";
+        defs << classname << "::" << classname << "(const SouffleProgram& previous)";
+    } else {
+        os << "explicit " << classname << "(const SouffleProgram& previous)";
     }
-    os << registerRel;
+    reloadConstructor << reloadInitializers << "{\n";
+    reloadConstructor << registerRel;
+    reloadConstructor << "}\n";
+    os << "std::shared_ptr<SymbolTable> shareSymbolTable() const override {\n";
+    os << "return symTableOwner;\n";
+    os << "}\n";
+    os << "std::shared_ptr<RecordTable> shareRecordTable() const override {\n";
+    os << "return recordTableOwner;\n";
     os << "}\n";
     // -- destructor --
 
@@ -1962,36 +3484,88 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "}\n";
 
     // -- run function --
-    os << "private:\nvoid runFunction(std::string inputDirectory = \".\", "
-          "std::string outputDirectory = \".\", bool performIO = false) "
-          "{\n";
+    bool hasIncrement = false;
+    visitDepthFirst(prog.getMain(), [&](const RamAutoIncrement& inc) { hasIncrement = true; });
+    bool hasCheckpoint = false;
+    visitDepthFirst(prog.getMain(), [&](const RamCheckpoint&) { hasCheckpoint = true; });
+
+    // the strata of split code are evaluated by methods of their own, sharing the state of runFunction
+    std::string stratumParameters =
+            "const std::string& inputDirectory, const std::string& outputDirectory, bool performIO, "
+            "std::atomic<size_t>& iter";
+    stratumArguments = "inputDirectory, outputDirectory, performIO, iter";
+    if (hasIncrement) {
+        stratumParameters += ", BlockCounter<RamDomain>& ctr";
+        stratumArguments += ", ctr";
+    }
+    if (hasCheckpoint) {
+        stratumParameters += ", std::size_t& restoredStrata";
+        stratumArguments += ", restoredStrata";
+    }
+    for (const RamStatement* statement : RamBaseAnalysis::getStatements(prog.getMain())) {
+        const std::set<std::string> computed = RamBaseAnalysis::getComputedRelations(*statement);
+        if (!computed.empty() && statement != &prog.getMain()) {
+            baseGuards[statement] = toString(join(computed, " || ", [](std::ostream& out, const auto& name) {
+                out << "!isBaseRelation(\"" << name << "\")";
+            }));
+        }
+    }
+    std::vector<const RamStatement*> strata;
+    if (split) {
+        strata = getStrata(prog.getMain());
+        for (size_t i = 0; i < strata.size(); ++i) {
+            stratumUnits[strata[i]] = i;
+        }
+    }
+
+    os << "private:\n";
+    for (size_t i = 0; i < strata.size(); ++i) {
+        os << "void stratum_" << i << "(" << stratumParameters << ");\n";
+    }
+    std::ostream& body = defineMethod(
+            "void runFunction(std::string inputDirectory = \".\", std::string outputDirectory = \".\", "
+            "bool performIO = false)",
+            "void " + classname +
+                    "::runFunction(std::string inputDirectory, std::string outputDirectory, bool performIO)");
 
-    os << "SignalHandler::instance()->set();\n";
+    body << "SignalHandler::instance()->set();\n";
     if (Global::config().has("verbose")) {
-        os << "SignalHandler::instance()->enableLogging();\n";
+        body << "SignalHandler::instance()->enableLogging();\n";
     }
-    bool hasIncrement = false;
-    visitDepthFirst(prog.getMain(), [&](const RamAutoIncrement& inc) { hasIncrement = true; });
+    // an evaluation aborted by its limits resets the signal handlers before handing on the exception
+    body << "limits.start();\n";
+    body << "invalidateSubroutines();\n";
+    body << "try {\n";
     // initialize counter
     if (hasIncrement) {
-        os << "// -- initialize counter --\n";
-        os << "std::atomic<RamDomain> ctr(0);\n\n";
+        body << "// -- initialize counter, reserving a block of values per thread --\n";
+        body << "BlockCounter<RamDomain> ctr;\n\n";
     }
-    os << "std::atomic<size_t> iter(0);\n\n";
+    body << "std::atomic<size_t> iter(0);\n\n";
+    // number of strata restored from a checkpoint
+    if (hasCheckpoint) {
+        body << "std::size_t restoredStrata = 0;\n\n";
+    }
+
+    // lease the threads of the evaluation from those shared with the programs evaluated concurrently;
+    // if the number of threads is not set, the threads not leased by other evaluations are used
+    body << "ThreadBudget::Lease threads(getNumThreads());\n\n";
 
-    // set default threads (in embedded mode)
-    // if this is not set, and omp is used, the default omp setting of number of cores is used.
-    os << "#if defined(_OPENMP)\n";
-    os << "if (getNumThreads() > 0) {omp_set_num_threads(getNumThreads());}\n";
-    os << "#endif\n\n";
+    // pin the threads to the cores, before the first relation is filled
+    const bool bindThreads =
+            Global::config().has("thread-binding") && !Global::config().has("thread-binding", "none");
+    if (bindThreads) {
+        body << "const std::string threadPlacement = bindThreads(R\"_("
+             << Global::config().get("thread-binding") << ")_\");\n";
+    }
 
     // add actual program body
-    os << "// -- query evaluation --\n";
+    body << "// -- query evaluation --\n";
     if (Global::config().has("profile")) {
-        os << "ProfileEventSingleton::instance().startTimer();\n";
-        os << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
-        os << "{\n"
-           << R"_(Logger logger("@runtime;", 0);)_" << '\n';
+        body << "ProfileEventSingleton::instance().startTimer();\n";
+        body << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
+        body << "{\n"
+             << R"_(Logger logger("@runtime;", 0);)_" << '\n';
         // Store count of relations
         size_t relationCount = 0;
         for (auto rel : prog.getRelations()) {
@@ -2000,34 +3574,71 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             }
         }
         // Store configuration
-        os << R"_(ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string()_"
-           << relationCount << "));";
+        body << R"_(ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string()_"
+             << relationCount << "));";
+        if (bindThreads) {
+            body << R"_(ProfileEventSingleton::instance().makeConfigRecord("thread-binding", ")_"
+                 << Global::config().get("thread-binding") << "\");\n";
+            body << R"_(ProfileEventSingleton::instance().makeConfigRecord("thread-placement", )_"
+                 << "threadPlacement);\n";
+        }
+        // the effective parallelism and memory limit, e.g., of a container, rather than those requested
+        body << R"_(ProfileEventSingleton::instance().makeConfigRecord("threads", )_"
+             << "std::to_string(threads.size()));\n";
+        body << R"_(ProfileEventSingleton::instance().makeConfigRecord("processors", )_"
+             << "std::to_string(ResourceLimits::getProcessors()));\n";
+        body << "if (ResourceLimits::getMemoryLimit() > 0) {\n"
+             << R"_(ProfileEventSingleton::instance().makeConfigRecord("memory-limit", )_"
+             << "std::to_string(ResourceLimits::getMemoryLimit()));\n"
+             << "}\n";
+        // the rate of sampled inputs, by which souffle-profile estimate extrapolates the profile
+        if (Global::config().has("input-sample")) {
+            body << R"_(ProfileEventSingleton::instance().makeConfigRecord("input-sample", ")_"
+                 << Global::config().get("input-sample") << "\");\n";
+        }
     }
 
     // emit code
-    emitCode(os, prog.getMain());
+    emitCode(body, prog.getMain());
 
     if (Global::config().has("profile")) {
-        os << "}\n";
-        os << "ProfileEventSingleton::instance().stopTimer();\n";
-        os << "dumpFreqs();\n";
+        body << "}\n";
+        body << "ProfileEventSingleton::instance().stopTimer();\n";
+        body << "dumpFreqs();\n";
     }
 
     // add code printing hint statistics
-    os << "\n// -- relation hint statistics --\n";
-    os << "if(isHintsProfilingEnabled()) {\n";
-    os << "std::cout << \" -- Operation Hint Statistics --\\n\";\n";
+    body << "\n// -- relation hint statistics --\n";
+    body << "if(isHintsProfilingEnabled()) {\n";
+    body << "std::cout << \" -- Operation Hint Statistics --\\n\";\n";
     for (auto rel : prog.getRelations()) {
         auto name = getRelationName(*rel);
-        os << "std::cout << \"Relation " << name << ":\\n\";\n";
-        os << name << "->printHintStatistics(std::cout,\"  \");\n";
-        os << "std::cout << \"\\n\";\n";
+        body << "std::cout << \"Relation " << name << ":\\n\";\n";
+        body << name << "->printHintStatistics(std::cout,\"  \");\n";
+        body << "std::cout << \"\\n\";\n";
+    }
+    body << "}\n";
+
+    body << "} catch (const EvaluationAborted&) {\n";
+    body << "SignalHandler::instance()->reset();\n";
+    body << "throw;\n";
+    body << "}\n";
+    body << "SignalHandler::instance()->reset();\n";
+
+    body << "}\n";  // end of runFunction() method
+
+    // emit each stratum of split code to a translation unit of its own
+    for (size_t i = 0; i < strata.size(); ++i) {
+        std::ostringstream unit;
+        unit << "#include \"" << headerName << "\"\n";
+        unit << "namespace souffle {\n";
+        unit << "using namespace ram;\n";
+        unit << "void " << classname << "::stratum_" << i << "(" << stratumParameters << ") {\n";
+        emitCode(unit, *strata[i]);
+        unit << "}\n";
+        unit << "}\n";
+        units->push_back(unit.str());
     }
-    os << "}\n";
-
-    os << "SignalHandler::instance()->reset();\n";
-
-    os << "}\n";  // end of runFunction() method
 
     // add methods to run with and without performing IO (mainly for the interface)
     os << "public:\nvoid run() override { runFunction(\".\", \".\", "
@@ -2035,76 +3646,114 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "public:\nvoid runAll(std::string inputDirectory = \".\", std::string outputDirectory = \".\") "
           "override { ";
     if (Global::config().has("live-profile")) {
-        os << "std::thread profiler([]() { profile::Tui().runProf(); });\n";
+        os << "auto profiler = TaskPool::instance().submitService([]() { profile::Tui().runProf(); });\n";
     }
     os << "runFunction(inputDirectory, outputDirectory, true);\n";
     if (Global::config().has("live-profile")) {
-        os << "if (profiler.joinable()) { profiler.join(); }\n";
+        os << "profiler.wait();\n";
     }
     os << "}\n";
     // issue printAll method
     os << "public:\n";
-    os << "void printAll(std::string outputDirectory = \".\") override {\n";
+    std::ostream& printAll = defineMethod("void printAll(std::string outputDirectory = \".\") override",
+            "void " + classname + "::printAll(std::string outputDirectory)");
 
     visitDepthFirst(prog.getMain(), [&](const RamStatement& node) {
-        if (auto store = dynamic_cast<const RamStore*>(&node)) {
+        auto store = dynamic_cast<const RamStore*>(&node);
+        if (store != nullptr && !store->getRelation().isTemp()) {
             for (IODirectives ioDirectives : store->getIODirectives()) {
-                os << "try {";
-                os << "std::map<std::string, std::string> directiveMap(" << ioDirectives << ");\n";
-                os << R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
-                os << "directiveMap[\"filename\"].front() != '/') {";
-                os << R"_(directiveMap["filename"] = outputDirectory + "/" + directiveMap["filename"];)_";
-                os << "}\n";
-                os << "IODirectives ioDirectives(directiveMap);\n";
-                os << "IOSystem::getInstance().getWriter(";
-                os << "ioDirectives, symTable, recordTable";
-                os << ")->writeAll(*" << getRelationName(store->getRelation()) << ");\n";
-
-                os << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+                printAll << "try {";
+                printAll << "std::map<std::string, std::string> directiveMap(" << ioDirectives << ");\n";
+                printAll << R"_(if (!outputDirectory.empty() && )_";
+                printAll << R"_((directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
+                printAll << "directiveMap[\"filename\"].front() != '/') {";
+                printAll << R"_(directiveMap["filename"] = outputDirectory + "/" + )_"
+                         << R"_(directiveMap["filename"];)_";
+                printAll << "}\n";
+                printAll << "IODirectives ioDirectives(directiveMap);\n";
+                printAll << "IOSystem::getInstance().getWriter(";
+                printAll << "ioDirectives, symTable, recordTable";
+                printAll << ")->" << getWriteCall(store->getRelation(), ioDirectives) << ";\n";
+
+                printAll << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
             }
         }
     });
-    os << "}\n";  // end of printAll() method
+    printAll << "}\n";  // end of printAll() method
 
     // dumpFreqs method
     if (Global::config().has("profile")) {
         os << "private:\n";
-        os << "void dumpFreqs() {\n";
+        std::ostream& dumpFreqs = defineMethod("void dumpFreqs()", "void " + classname + "::dumpFreqs()");
         for (auto const& cur : idxMap) {
-            os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(" << cur.first << ")_\", freqs["
-               << cur.second << "],0);\n";
+            dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(" << cur.first
+                      << ")_\", freqs[" << cur.second << "],0);\n";
         }
         for (auto const& cur : neIdxMap) {
-            os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;" << cur.first
-               << ")_\", reads[" << cur.second << "],0);\n";
-        }
-        os << "}\n";  // end of dumpFreqs() method
+            dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;"
+                      << cur.first << ")_\", reads[" << cur.second << "],0);\n";
+        }
+        for (auto const& cur : searchIdxMap) {
+            dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-searches;"
+                      << cur.first << ")_\", searches[" << cur.second << "],0);\n";
+            dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-search-tuples;"
+                      << cur.first << ")_\", searchTuples[" << cur.second << "],0);\n";
+        }
+        for (auto const& cur : parallelIdxMap) {
+            dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@parallel-scans;"
+                      << cur.first << ";parallel)_\", parallelScans[" << cur.second << "][0],0);\n";
+            dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@parallel-scans;"
+                      << cur.first << ";sequential)_\", parallelScans[" << cur.second << "][1],0);\n";
+        }
+        dumpFreqs << "\tParallelLoopProfile::instance().makeEvents();\n";
+        dumpFreqs << "\tif (isHintsProfilingEnabled()) {\n";
+        for (auto rel : prog.getRelations()) {
+            dumpFreqs << "\t" << getRelationName(*rel) << "->logHintStatistics(R\"_(@relation-hints;"
+                      << rel->getName() << ")_\");\n";
+        }
+        dumpFreqs << "\t}\n";
+        dumpFreqs << "\t{\n";
+        dumpFreqs << "\tconst NodePoolStatistics nodes = NodePool::getStatistics();\n";
+        dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(\"@node-pool;reserved\", "
+                     "nodes.reserved,0);\n";
+        dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(\"@node-pool;in-use\", "
+                     "nodes.inUse,0);\n";
+        dumpFreqs << "\tProfileEventSingleton::instance().makeQuantityEvent(\"@node-pool;huge-pages\", "
+                     "nodes.hugePages,0);\n";
+        dumpFreqs << "\t}\n";
+        dumpFreqs << "}\n";  // end of dumpFreqs() method
     }
     // issue loadAll method
     os << "public:\n";
-    os << "void loadAll(std::string inputDirectory = \".\") override {\n";
+    std::ostream& loadAll = defineMethod("void loadAll(std::string inputDirectory = \".\") override",
+            "void " + classname + "::loadAll(std::string inputDirectory)");
+    loadAll << "invalidateSubroutines();\n";
 
     visitDepthFirst(prog.getMain(), [&](const RamLoad& load) {
+        // the relations migrated from a previous version of the program are loaded already
+        loadAll << "if (!isMigratedRelation(\"" << load.getRelation().getName() << "\")) {\n";
         for (IODirectives ioDirectives : load.getIODirectives()) {
-            os << "try {";
-            os << "std::map<std::string, std::string> directiveMap(";
-            os << ioDirectives << ");\n";
-            os << R"_(if (!inputDirectory.empty() && directiveMap["IO"] == "file" && )_";
-            os << "directiveMap[\"filename\"].front() != '/') {";
-            os << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
-            os << "}\n";
-            os << "IODirectives ioDirectives(directiveMap);\n";
-            os << "IOSystem::getInstance().getReader(";
-            os << "ioDirectives, symTable, recordTable";
-            os << ")->readAll(*" << getRelationName(load.getRelation());
-            os << ");\n";
-            os << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() << "
+            loadAll << "try {";
+            loadAll << "std::map<std::string, std::string> directiveMap(";
+            loadAll << ioDirectives << ");\n";
+            loadAll << R"_(if (!inputDirectory.empty() && )_";
+            loadAll << R"_((directiveMap["IO"] == "file" || directiveMap["IO"] == "binary") && )_";
+            loadAll << "directiveMap[\"filename\"].front() != '/') {";
+            loadAll << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
+            loadAll << "}\n";
+            loadAll << "IODirectives ioDirectives(directiveMap);\n";
+            loadAll << "IOSystem::getInstance().getReader(";
+            loadAll << "ioDirectives, symTable, recordTable";
+            loadAll << ")->readAll(*" << getRelationName(load.getRelation());
+            loadAll << ");\n";
+            loadAll << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() << "
                   "'\\n';}\n";
         }
+        loadAll << "}\n";
     });
-    os << "}\n";  // end of loadAll() method
+    loadAll << "}\n";  // end of loadAll() method
     // issue dump methods
-    auto dumpRelation = [&](const RamRelation& ramRelation) {
+    auto dumpRelation = [&](std::ostream& os, const RamRelation& ramRelation) {
         const auto& relName = getRelationName(ramRelation);
         const auto& name = ramRelation.getName();
         const auto& attributesTypes = ramRelation.getAttributeTypes();
@@ -2130,153 +3779,264 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     // dump inputs
     os << "public:\n";
-    os << "void dumpInputs(std::ostream& out = std::cout) override {\n";
-    visitDepthFirst(prog.getMain(), [&](const RamLoad& load) { dumpRelation(load.getRelation()); });
-    os << "}\n";  // end of dumpInputs() method
+    std::ostream& dumpInputs = defineMethod("void dumpInputs(std::ostream& out = std::cout) override",
+            "void " + classname + "::dumpInputs(std::ostream& out)");
+    visitDepthFirst(
+            prog.getMain(), [&](const RamLoad& load) { dumpRelation(dumpInputs, load.getRelation()); });
+    dumpInputs << "}\n";  // end of dumpInputs() method
 
     // dump outputs
     os << "public:\n";
-    os << "void dumpOutputs(std::ostream& out = std::cout) override {\n";
-    visitDepthFirst(prog.getMain(), [&](const RamStore& store) { dumpRelation(store.getRelation()); });
-    os << "}\n";  // end of dumpOutputs() method
+    std::ostream& dumpOutputs = defineMethod("void dumpOutputs(std::ostream& out = std::cout) override",
+            "void " + classname + "::dumpOutputs(std::ostream& out)");
+    std::set<std::string> dumpedRelations;
+    visitDepthFirst(prog.getMain(), [&](const RamStore& store) {
+        const RamRelation& relation = store.getRelation();
+        if (!relation.isTemp() && dumpedRelations.insert(relation.getName()).second) {
+            dumpRelation(dumpOutputs, relation);
+        }
+    });
+    dumpOutputs << "}\n";  // end of dumpOutputs() method
 
     os << "public:\n";
     os << "SymbolTable& getSymbolTable() override {\n";
     os << "return symTable;\n";
     os << "}\n";  // end of getSymbolTable() method
 
+    os << "RecordTable& getRecordTable() override {\n";
+    os << "return recordTable;\n";
+    os << "}\n";  // end of getRecordTable() method
+
     // TODO: generate code for subroutines
-    if (Global::config().has("provenance")) {
+    if (Global::config().has("provenance") || Global::config().has("incremental")) {
         if (Global::config().get("provenance") == "subtreeHeights") {
             // method that populates provenance indices
-            os << "void copyIndex() {\n";
+            std::ostream& copyIndex = defineMethod("void copyIndex()", "void " + classname + "::copyIndex()");
             for (auto rel : prog.getRelations()) {
                 // get some table details
                 const std::string& cppName = getRelationName(*rel);
 
                 bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
                 auto relationType = SynthesiserRelation::getSynthesiserRelation(*rel,
-                        idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
+                        idxAnalysis->getIndexes(*rel), rel->getAuxiliaryArity() > 0 && !isProvInfo);
 
                 if (!relationType->getProvenenceIndexNumbers().empty()) {
-                    os << cppName << "->copyIndex();\n";
+                    copyIndex << cppName << "->copyIndex();\n";
                 }
             }
-            os << "}\n";
+            copyIndex << "}\n";
         }
 
         // generate subroutine adapter
-        os << "void executeSubroutine(std::string name, const std::vector<RamDomain>& args, "
-              "std::vector<RamDomain>& ret) override {\n";
+        std::ostream& executeSubroutine = defineMethod(
+                "void executeSubroutine(std::string name, const std::vector<RamDomain>& args, "
+                "std::vector<RamDomain>& ret) override",
+                "void " + classname +
+                        "::executeSubroutine(std::string name, const std::vector<RamDomain>& args, "
+                        "std::vector<RamDomain>& ret)");
+        executeSubroutine << "if (lookupSubroutine(name, args, ret)) {\n"
+                          << "return;\n"
+                          << "}\n";
 
         // subroutine number
         size_t subroutineNum = 0;
         for (auto& sub : prog.getSubroutines()) {
-            os << "if (name == \"" << sub.first << "\") {\n"
-               << "subproof_" << subroutineNum
-               << "(args, ret);\n"  // subproof_i to deal with special characters in relation names
-               << "}\n";
+            executeSubroutine << "if (name == \"" << sub.first << "\") {\n"
+                              // subproof_i to deal with special characters in relation names
+                              << "subproof_" << subroutineNum << "(args, ret);\n"
+                              << "}\n";
             subroutineNum++;
         }
-        os << "}\n";  // end of executeSubroutine
+        executeSubroutine << "storeSubroutine(name, args, ret);\n";
+        executeSubroutine << "}\n";  // end of executeSubroutine
+
+        // generate batch adapter, distributing the argument vectors over the threads of the program
+        std::ostream& executeSubroutines =
+                defineMethod("void executeSubroutines(const std::string& name, "
+                             "const std::vector<std::vector<RamDomain>>& args, "
+                             "std::vector<std::vector<RamDomain>>& ret) override",
+                        "void " + classname +
+                                "::executeSubroutines(const std::string& name, "
+                                "const std::vector<std::vector<RamDomain>>& args, "
+                                "std::vector<std::vector<RamDomain>>& ret)");
+        executeSubroutines << "ret.assign(args.size(), std::vector<RamDomain>());\n"
+                           << "ThreadBudget::Lease threads(getNumThreads());\n"
+                           << "PARALLEL_START\n"
+                           << "pfor(size_t i = 0; i < args.size(); i++) {\n"
+                           << "executeSubroutine(name, args[i], ret[i]);\n"
+                           << "}\n"
+                           << "PARALLEL_END\n"
+                           << "}\n";  // end of executeSubroutines
 
         // generate method for each subroutine
         subroutineNum = 0;
         for (auto& sub : prog.getSubroutines()) {
             // method header
-            os << "void "
-               << "subproof_" << subroutineNum
-               << "(const std::vector<RamDomain>& args, "
-                  "std::vector<RamDomain>& ret) {\n";
+            const std::string signature = "subproof_" + std::to_string(subroutineNum) +
+                                          "(const std::vector<RamDomain>& args, std::vector<RamDomain>& ret)";
+            std::ostream& subroutine =
+                    defineMethod("void " + signature, "void " + classname + "::" + signature);
+
+            // a lock is needed when filling the subroutine return vectors from several threads,
+            // otherwise concurrent calls of the subroutine do not synchronise
+            bool isParallel = false;
+            visitDepthFirst(*sub.second, [&](const RamAbstractParallel&) { isParallel = true; });
+            if (isParallel) {
+                subroutine << "std::mutex lock;\n";
+            }
+
+            // loops count their iterations
+            bool hasLoop = false;
+            visitDepthFirst(*sub.second, [&](const RamLoop&) { hasLoop = true; });
+            if (hasLoop) {
+                subroutine << "std::atomic<size_t> iter(0);\n";
+            }
 
-            // a lock is needed when filling the subroutine return vectors
-            os << "std::mutex lock;\n";
+            // clears of program relations are only conditional on performIO in the main program
+            bool clearsRelation = false;
+            visitDepthFirst(*sub.second, [&](const RamClear& clear) {
+                clearsRelation = clearsRelation || !clear.getRelation().isTemp();
+            });
+            if (clearsRelation) {
+                subroutine << "const bool performIO = true;\n";
+            }
 
             // generate code for body
-            emitCode(os, *sub.second);
+            emitCode(subroutine, *sub.second);
 
-            os << "return;\n";
-            os << "}\n";  // end of subroutine
+            subroutine << "return;\n";
+            subroutine << "}\n";  // end of subroutine
             subroutineNum++;
         }
     }
+    // the shared templates of the queries of all methods
+    if (!queryTemplateDefinitions.empty()) {
+        os << "private:\n";
+        for (const std::string& definition : queryTemplateDefinitions) {
+            os << definition;
+        }
+    }
     os << "};\n";  // end of class declaration
+    if (split) {
+        os << "}\n";
+    }
 
     // hidden hooks
-    os << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
-    os << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
-       << "*>(p)->symTable;}\n";
-
-    os << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
-    os << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
-    os << "SouffleProgram *newInstance() {\n";
-    os << "return new " << classname << "();\n";
-    os << "};\n";
-    os << "public:\n";
-    os << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
-    os << "};\n";
-    os << "static factory_" << classname << " __factory_" << classname << "_instance;\n";
-    os << "}\n";
-    os << "#else\n";
-    os << "}\n";
-    os << "int main(int argc, char** argv)\n{\n";
-    os << "try{\n";
+    defs << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
+    defs << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
+         << "*>(p)->symTable;}\n";
+
+    defs << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
+    defs << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
+    defs << "SouffleProgram *newInstance() {\n";
+    defs << "return new " << classname << "();\n";
+    defs << "};\n";
+    defs << "SouffleProgram *reloadInstance(const SouffleProgram& previous) override {\n";
+    defs << "return new " << classname << "(previous);\n";
+    defs << "};\n";
+    defs << "public:\n";
+    defs << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
+    defs << "};\n";
+    defs << "static factory_" << classname << " __factory_" << classname << "_instance;\n";
+    // unmangled entry points of programs compiled into shared libraries, loaded by ProgramLibrary
+    defs << "extern \"C\" {\n";
+    defs << "SouffleProgram *souffle_newInstance_" << id << "(){return new " << classname << "();}\n";
+    defs << "SouffleProgram *souffle_reloadInstance_" << id << "(const SouffleProgram *previous){return new "
+         << classname << "(*previous);}\n";
+    defs << "}\n";
+    defs << "}\n";
+    defs << "#else\n";
+    defs << "}\n";
+    defs << "int main(int argc, char** argv)\n{\n";
+    defs << "try{\n";
 
     // parse arguments
-    os << "souffle::CmdOptions opt(";
-    os << "R\"(" << Global::config().get("") << ")\",\n";
-    os << "R\"(.)\",\n";
-    os << "R\"(.)\",\n";
+    defs << "souffle::CmdOptions opt(";
+    defs << "R\"(" << Global::config().get("") << ")\",\n";
+    defs << "R\"(.)\",\n";
+    defs << "R\"(.)\",\n";
     if (Global::config().has("profile")) {
-        os << "true,\n";
-        os << "R\"(" << Global::config().get("profile") << ")\",\n";
+        defs << "true,\n";
+        defs << "R\"(" << Global::config().get("profile") << ")\",\n";
+    } else if (Global::config().has("profile-sampling")) {
+        defs << "true,\n";
+        defs << "R\"(" << Global::config().get("profile-sampling") << ")\",\n";
     } else {
-        os << "false,\n";
-        os << "R\"()\",\n";
+        defs << "false,\n";
+        defs << "R\"()\",\n";
     }
-    os << std::stoi(Global::config().get("jobs")) << ",\n";
-    os << "-1";
-    os << ");\n";
+    defs << std::stoi(Global::config().get("jobs")) << ",\n";
+    defs << "-1";
+    defs << ");\n";
 
-    os << "if (!opt.parse(argc,argv)) return 1;\n";
+    defs << "if (!opt.parse(argc,argv)) return 1;\n";
 
-    os << "souffle::";
+    defs << "souffle::";
     if (Global::config().has("profile")) {
-        os << classname + " obj(opt.getProfileName());\n";
+        defs << classname + " obj(opt.getProfileName());\n";
     } else {
-        os << classname + " obj;\n";
+        defs << classname + " obj;\n";
     }
 
-    os << "#if defined(_OPENMP) \n";
-    os << "obj.setNumThreads(opt.getNumJobs());\n";
-    os << "\n#endif\n";
+    defs << "#if defined(_OPENMP) \n";
+    defs << "obj.setNumThreads(opt.getNumJobs());\n";
+    defs << "if (opt.getNumJobs() > 0) souffle::TaskPool::instance().setCapacity(opt.getNumJobs());\n";
+    defs << "\n#endif\n";
 
     if (Global::config().has("profile")) {
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
-           << Global::config().get("version") << R"_(");)_" << '\n';
-    }
-    os << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
+             << Global::config().get("version") << R"_(");)_" << '\n';
+    }
+    if (Global::config().has("profile-sampling")) {
+        defs << "souffle::ProfileEventSingleton::instance().setOutputFile(opt.getProfileName());\n";
+        defs << "souffle::SignalHandler::instance()->startSampling();\n";
+    }
+    if (Global::config().has("profile-endpoint")) {
+        defs << "souffle::profile::LiveEndpoint endpoint(R\"_(" << Global::config().get("profile-endpoint")
+             << ")_\");\n";
+    }
+    if (Global::config().has("symbol-table")) {
+        const std::string fileName = "R\"_(" + Global::config().get("symbol-table") + ")_\"";
+        defs << "souffle::seedSymbolTable(obj.getSymbolTable(), " << fileName << ");\n";
+        defs << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
+        defs << "souffle::saveSymbolTable(obj.getSymbolTable(), " << fileName << ");\n";
+    } else {
+        defs << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
+    }
+
+    if (Global::config().has("profile-sampling")) {
+        defs << "souffle::ProfileEventSingleton::instance().makeSamplesEvent("
+                "souffle::SignalHandler::instance()->stopSampling());\n";
+    }
+
+    // the relations not depending on the query inputs are kept while the queries are evaluated
+    if (Global::config().has("serve")) {
+        const auto& base = translationUnit.getAnalysis<RamBaseAnalysis>()->getBaseRelations();
+        auto quote = [](std::ostream& out, const std::string& name) { out << '"' << name << '"'; };
+        defs << "obj.setBaseRelations({" << join(base, ", ", quote) << "});\n";
+        defs << "souffle::ProgramServer(obj, R\"_(" << Global::config().get("serve") << ")_\").serve();\n";
+    }
 
     if (Global::config().get("provenance") == "explain") {
-        os << "explain(obj, false, false);\n";
+        defs << "explain(obj, false, false);\n";
     } else if (Global::config().get("provenance") == "subtreeHeights") {
-        os << "obj.copyIndex();\n";
-        os << "explain(obj, false, true);\n";
+        defs << "obj.copyIndex();\n";
+        defs << "explain(obj, false, true);\n";
     } else if (Global::config().get("provenance") == "explore") {
-        os << "explain(obj, true, false);\n";
+        defs << "explain(obj, true, false);\n";
     }
-    os << "return 0;\n";
-    os << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
-    os << "}\n";
-    os << "\n#endif\n";
+    defs << "return 0;\n";
+    defs << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
+    defs << "}\n";
+    defs << "\n#endif\n";
 }
 
 }  // end of namespace souffle
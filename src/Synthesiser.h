@@ -24,10 +24,12 @@
 #include <ostream>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
 class RamOperation;
+class RamProject;
 class RamTranslationUnit;
 class SynthesiserRelation;
 class RamRelation;
@@ -52,9 +54,58 @@ private:
     /** Frequency profiling of non-existence checks */
     std::map<std::string, size_t> neIdxMap;
 
+    /** Profiling of parallel operations, indexed by relation */
+    std::map<std::string, size_t> parallelIdxMap;
+
+    /** Profiling of searches, indexed by relation and search signature */
+    std::map<std::string, size_t> searchIdxMap;
+
+    /** Compiled constant patterns of match constraints, indexed by their symbol */
+    std::map<RamDomain, size_t> regexIdxMap;
+
+    /** Registered messages of rules, indexed by their text */
+    std::map<std::string, size_t> ruleIdxMap;
+
     /** Cache for generated types for relations */
     std::set<std::string> typeCache;
 
+    /** Relations whose types merge all tuples of another relation at once */
+    std::set<const RamRelation*> insertAllRelations;
+
+    /** Relations whose types prefetch the searches of a batch of keys */
+    std::set<const RamRelation*> prefetchRelations;
+
+    /** Relations whose types count their new tuples for the logged rules of a profiled program */
+    std::set<const RamRelation*> countedRelations;
+
+    /** Relations whose types iterate the indexes starting with the columns their outputs are sorted by */
+    std::set<const RamRelation*> orderedRelations;
+
+    /** The strata of split code, evaluated by methods of their own, and their indices */
+    std::map<const RamStatement*, size_t> stratumUnits;
+
+    /** The conditions of the top-level statements of the main program on their computed relations not
+     * all being base relations */
+    std::map<const RamStatement*, std::string> baseGuards;
+
+    /** Runs of consecutive facts of a relation, emitted as static arrays, indexed by their first statement */
+    std::map<const RamStatement*, std::vector<const RamProject*>> factBatches;
+
+    /** The statements of the facts emitted by the runs of factBatches */
+    std::set<const RamStatement*> batchedFacts;
+
+    /** The arguments passed to the methods evaluating strata */
+    std::string stratumArguments;
+
+    /** The parameters naming the relations of the query emitted as a shared template */
+    std::map<const RamRelation*, std::string> relationParameters;
+
+    /** Shared templates of queries, indexed by their parameters and code */
+    std::map<std::string, size_t> queryTemplates;
+
+    /** The definitions of the shared templates of queries, emitted as methods of the program */
+    std::vector<std::string> queryTemplateDefinitions;
+
 protected:
     /** Get record table */
     const RecordTable& getRecordTable();
@@ -62,18 +113,33 @@ protected:
     /** Convert RAM identifier */
     const std::string convertRamIdent(const std::string& name);
 
+    /** Get the insertion of a fact by a statement, a query projecting constants only, or nullptr */
+    static const RamProject* getFact(const RamStatement& statement);
+
+    /** Get the message of a run of facts of a relation */
+    static std::string getFactsMessage(const RamRelation& rel, size_t numFacts);
+
     /** Get relation name */
     const std::string getRelationName(const RamRelation& rel);
 
     /** Get context name */
     const std::string getOpContextName(const RamRelation& rel);
 
+    /**
+     * Get the call of a writer writing a relation to an output, which iterates the index starting with
+     * the columns the output is sorted by, if there is one
+     */
+    std::string getWriteCall(const RamRelation& rel, const IODirectives& ioDirectives);
+
     /** Get relation struct definition */
     void generateRelationTypeStruct(std::ostream& out, std::unique_ptr<SynthesiserRelation> relationType);
 
     /* Convert SearchColums to a template index */
     std::string toIndex(SearchSignature key);
 
+    /** Get the strata of the main program evaluating rules, which are emitted to units of their own */
+    static std::vector<const RamStatement*> getStrata(const RamStatement& main);
+
     /** Get referenced relations */
     std::set<const RamRelation*> getReferencedRelations(const RamOperation& op);
 
@@ -86,6 +152,18 @@ protected:
     /** Lookup read counter */
     size_t lookupReadIdx(const std::string& txt);
 
+    /** Lookup search counter */
+    size_t lookupSearchIdx(const std::string& relName, SearchSignature signature);
+
+    /** Lookup registered message of a rule */
+    size_t lookupRuleIdx(const std::string& msg);
+
+    /** Lookup compiled constant pattern */
+    size_t lookupRegexIdx(RamDomain pattern);
+
+    /** Lookup parallel operation counter */
+    size_t lookupParallelIdx(const std::string& relName);
+
 public:
     explicit Synthesiser(RamTranslationUnit& tUnit) : translationUnit(tUnit) {}
     virtual ~Synthesiser() = default;
@@ -95,7 +173,12 @@ public:
         return translationUnit;
     }
 
-    /** Generate code */
-    void generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary);
+    /**
+     * Generate code, which is split into translation units if units is given: the relation types and
+     * the class of the program are written to header, the strata to a unit each, and the rest to out.
+     */
+    void generateCode(std::ostream& out, const std::string& id, bool& withSharedLibrary,
+            std::ostream* header = nullptr, const std::string& headerName = "",
+            std::vector<std::string>* units = nullptr);
 };
 }  // end of namespace souffle
@@ -8,6 +8,7 @@
 
 #include "SynthesiserRelation.h"
 #include "Global.h"
+#include "RamTypes.h"
 #include "RelationRepresentation.h"
 #include "Util.h"
 #include <algorithm>
@@ -15,9 +16,42 @@
 #include <map>
 #include <numeric>
 #include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace souffle {
 
+namespace {
+
+/** The hint counters of b-trees, and their names in the profile */
+const std::vector<std::pair<std::string, std::string>> btreeHintCounters = {{"inserts", "insert"},
+        {"contains", "contains"}, {"lower_bound", "lower-bound"}, {"upper_bound", "upper-bound"}};
+
+/** The hint counters of bries, and their names in the profile */
+const std::vector<std::pair<std::string, std::string>> brieHintCounters = {
+        {"inserts", "insert"}, {"contains", "contains"}, {"get_boundaries", "boundaries"}};
+
+/**
+ * Emit the logHintStatistics method of a relation type, recording the hits and misses of the given
+ * hint counters of its first indexes in the profile
+ */
+void emitLogHintStatistics(std::ostream& out, size_t numIndexes,
+        const std::vector<std::pair<std::string, std::string>>& counters) {
+    out << "void logHintStatistics(const std::string& prefix) const {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "const auto& stats_" << i << " = ind_" << i << ".getHintStatistics();\n";
+        for (const auto& counter : counters) {
+            out << "ProfileEventSingleton::instance().makeHintEvent(prefix + \";" << i << ";"
+                << counter.second << "\", stats_" << i << "." << counter.first << ".getHits(), stats_" << i
+                << "." << counter.first << ".getMisses());\n";
+        }
+    }
+    out << "}\n";
+}
+
+}  // namespace
+
 std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(
         const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance) {
     SynthesiserRelation* rel;
@@ -27,7 +61,10 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.isNullary()) {
         rel = new SynthesiserNullaryRelation(ramRel, indexSet, isProvenance);
-    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE) {
+    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE ||
+               ramRel.getRepresentation() == RelationRepresentation::MIN_LATTICE ||
+               ramRel.getRepresentation() == RelationRepresentation::MAX_LATTICE ||
+               !ramRel.getChoiceDomain().empty()) {
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BRIE) {
         rel = new SynthesiserBrieRelation(ramRel, indexSet, isProvenance);
@@ -35,8 +72,14 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
         rel = new SynthesiserEqrelRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::INFO) {
         rel = new SynthesiserInfoRelation(ramRel, indexSet, isProvenance);
+    } else if (ramRel.getRepresentation() == RelationRepresentation::HASHSET &&
+               indexSet.hasOnlyTotalSearches(ramRel.getArity())) {
+        rel = new SynthesiserHashRelation(ramRel, indexSet, isProvenance);
+    } else if (ramRel.getRepresentation() == RelationRepresentation::DENSE &&
+               ramRel.getAuxiliaryArity() == 0 && ramRel.getArity() <= 2) {
+        rel = new SynthesiserDenseRelation(ramRel, indexSet, isProvenance);
     } else {
-        // Handle the data structure command line flag
+        // Handle the data structure command line flag, also covering hash sets searched by partial keys
         if (ramRel.getArity() > 6) {
             rel = new SynthesiserIndirectRelation(ramRel, indexSet, isProvenance);
         } else {
@@ -52,6 +95,101 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
     return std::unique_ptr<SynthesiserRelation>(rel);
 }
 
+std::vector<SearchSignature> SynthesiserRelation::getSeekSearches() const {
+    std::vector<SearchSignature> res;
+    const size_t arity = getArity();
+    // the range of a unary relation is the whole relation
+    if (arity == 1) {
+        res.push_back(0);
+    }
+    for (SearchSignature search : getMinIndexSelection().getSearches()) {
+        size_t bound = 0;
+        for (size_t column = 0; column < arity; column++) {
+            if (((search >> column) & 1) != 0) {
+                bound++;
+            }
+        }
+        if (bound + 1 == arity) {
+            res.push_back(search);
+        }
+    }
+    return res;
+}
+
+std::string SynthesiserRelation::getOrderedByName(const MinIndexSelection::LexOrder& order) {
+    return "orderedBy_" + toString(join(order, "_"));
+}
+
+std::vector<SearchSignature> SynthesiserRelation::getMergeSearches() const {
+    std::vector<SearchSignature> res;
+    for (SearchSignature search : getMinIndexSelection().getSearches()) {
+        if (search != 0 && (search & (search - 1)) == 0) {
+            res.push_back(search);
+        }
+    }
+    return res;
+}
+
+void SynthesiserRelation::generateSeekMethod(std::ostream& out, SearchSignature search,
+        const std::string& lowerBound, const std::string& end, const std::string& entry) const {
+    out << "bool seek_" << search << "(t_tuple& t, context& h) const {\n";
+    out << "auto pos = " << lowerBound << ";\n";
+    out << "if (pos == " << end << ") return false;\n";
+    out << "const t_tuple& entry = " << entry << ";\n";
+    for (size_t column = 0; column < getArity(); column++) {
+        if (((search >> column) & 1) != 0) {
+            out << "if (entry[" << column << "] != t[" << column << "]) return false;\n";
+        }
+    }
+    out << "t = entry;\n";
+    out << "return true;\n";
+    out << "}\n";
+}
+
+void SynthesiserRelation::generateScanEqualRangeMethod(std::ostream& out) const {
+    const size_t arity = getArity();
+    auto bound = [&](SearchSignature search) {
+        size_t res = 0;
+        for (size_t column = 0; column < arity; column++) {
+            res += (search >> column) & 1;
+        }
+        return res;
+    };
+
+    // try the searches binding more columns first
+    std::vector<SearchSignature> searches;
+    for (SearchSignature search : getMinIndexSelection().getSearches()) {
+        if (search != 0) {
+            searches.push_back(search);
+        }
+    }
+    std::stable_sort(searches.begin(), searches.end(),
+            [&](SearchSignature a, SearchSignature b) { return bound(a) > bound(b); });
+
+    out << "template <typename F>\n";
+    out << "void scanEqualRange(SearchSignature columns, const t_tuple& t, F&& f) const {\n";
+    out << "context h;\n";
+    // the columns not bound by the search are checked for each tuple
+    out << "auto scan = [&](const auto& range) {\n";
+    out << "for (const auto& cur : range) {\n";
+    out << "if (";
+    for (size_t column = 0; column < arity; column++) {
+        out << (column > 0 ? " && " : "") << "((columns & " << (SearchSignature(1) << column)
+            << "ull) == 0 || cur[" << column << "] == t[" << column << "])";
+    }
+    out << ") f(cur);\n";
+    out << "}\n";
+    out << "};\n";
+    for (SearchSignature search : searches) {
+        out << "if ((columns & " << search << "ull) == " << search << "ull) {\n";
+        out << "scan(equalRange_" << search << "(t, h));\n";
+        out << "return;\n";
+        out << "}\n";
+    }
+    out << "scan(*this);\n";
+    out << "}\n";
+}
+
 // -------- Info Relation --------
 
 /** Generate index set for a info relation, which should be empty */
@@ -197,10 +335,44 @@ void SynthesiserDirectRelation::computeIndices() {
     computedIndices = inds;
 }
 
+/** Get the number of bytes of the b-tree nodes of a direct indexed relation */
+size_t SynthesiserDirectRelation::getBlockSize() const {
+    const size_t tupleSize = relation.getArity() * sizeof(RamDomain);
+    size_t res = relation.getBlockSize();
+    if (res == 0) {
+        // hold at least 16 tuples per node, such that wide tuples do not result in deep trees
+        res = 256;
+        while (res < 16 * tupleSize + 32) {
+            res *= 2;
+        }
+        // relations profiled to be large get larger nodes, for shallower trees and longer scans
+        if (relation.getSizeHint() >= (1u << 20)) {
+            res *= 2;
+        }
+    }
+    // b-tree nodes hold at most 255 keys
+    while (res > 64 && res / tupleSize > 255) {
+        res /= 2;
+    }
+    return res;
+}
+
+bool SynthesiserDirectRelation::hasOrderedIndexes() const {
+    return !isProvenance && !isLattice();
+}
+
+bool SynthesiserDirectRelation::hasInsertionCounter() const {
+    return Global::config().has("profile") && !isLattice();
+}
+
 /** Generate type name of a direct indexed relation */
 std::string SynthesiserDirectRelation::getTypeName() {
     std::stringstream res;
-    res << "t_btree_" << getArity();
+    if (isLattice()) {
+        res << "t_lattice_" << relation.getRepresentation() << "_" << getArity();
+    } else {
+        res << "t_btree_" << getArity();
+    }
 
     for (auto& ind : getIndices()) {
         res << "__" << join(ind, "_");
@@ -210,6 +382,25 @@ std::string SynthesiserDirectRelation::getTypeName() {
         res << "__" << search;
     }
 
+    // types iterating indexes for sorted outputs have methods of their own
+    if (hasOrderedIndexes()) {
+        for (const auto& order : getMinIndexSelection().getOutputOrders()) {
+            res << "__o" << join(order, "_");
+        }
+    }
+
+    if (getBlockSize() != 256) {
+        res << "__b" << getBlockSize();
+    }
+
+    if (hasFilter()) {
+        res << "__f" << relation.getSizeHint();
+    }
+
+    if (isChoice()) {
+        res << "__c" << join(relation.getChoiceDomain(), "_");
+    }
+
     return res.str();
 }
 
@@ -221,9 +412,26 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     size_t numIndexes = inds.size();
     std::map<MinIndexSelection::LexOrder, int> indexToNumMap;
 
+    // secondary indexes storing the columns of their key and references to the tuples kept by a table
+    std::vector<bool> indirect(numIndexes, false);
+    if (!isProvenance && !isLattice() && !isChoice()) {
+        indirect = getMinIndexSelection().getIndexStorage(arity).indirect;
+        indirect.resize(numIndexes, false);
+    }
+    const bool hasTable = std::find(indirect.begin(), indirect.end(), true) != indirect.end();
+
     // struct definition
     out << "struct " << getTypeName() << " {\n";
 
+    // number of bytes of the b-tree nodes
+    size_t blockSize = getBlockSize();
+
+    // search strategy of the b-trees, selected by the command line or defaulting to the key type
+    std::string strategy = "typename souffle::detail::default_strategy<t_tuple>::type";
+    if (Global::config().has("btree-search")) {
+        strategy = "souffle::detail::" + Global::config().get("btree-search") + "_search";
+    }
+
     // stored tuple type
     out << "using t_tuple = Tuple<RamDomain, " << arity << ">;\n";
 
@@ -254,29 +462,79 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
             if (provenanceIndexNumbers.find(i) == provenanceIndexNumbers.end()) {  // index for bottom up
                                                                                    // phase
                 out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind);
-                out << ">, std::allocator<t_tuple>, 256, typename "
-                       "souffle::detail::default_strategy<t_tuple>::type, index_utils::comparator<";
+                out << ">, std::allocator<t_tuple>, " << blockSize << ", " << strategy
+                    << ", index_utils::comparator<";
                 out << join(ind.begin(), ind.end() - auxiliaryArity) << ">, updater_" << getTypeName()
                     << ">;\n";
             } else {  // index for top down phase
                 out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind);
-                out << ">, std::allocator<t_tuple>, 256, typename "
-                       "souffle::detail::default_strategy<t_tuple>::type, index_utils::comparator<";
+                out << ">, std::allocator<t_tuple>, " << blockSize << ", " << strategy
+                    << ", index_utils::comparator<";
                 out << join(ind.begin(), ind.end()) << ">, updater_" << getTypeName() << ">;\n";
             }
             // without provenance, some indices may be not full, so we use btree_multiset for those
+        } else if (isLattice()) {
+            // subsumptive relations keep a single tuple of each key in all indexes
+            out << "using t_ind_" << i << " = LatticeSet<t_tuple, index_utils::comparator<" << join(ind)
+                << ">>;\n";
+            out << "t_ind_" << i << " ind_" << i << "{" << arity - 1 << ", "
+                << (relation.getRepresentation() == RelationRepresentation::MAX_LATTICE ? "true" : "false")
+                << "};\n";
+            continue;
+        } else if (indirect[i]) {
+            const size_t keySize = getMinIndexSelection().getAllOrders()[i].size();
+            out << "using t_ind_" << i << " = KeyIndex<t_tuple, " << join(ind.begin(), ind.begin() + keySize)
+                << ">;\n";
         } else {
+            // with packed search, keys of several columns fitting into 64 bits are compared as a
+            // single integer, and other keys by columns
+            const bool packed = Global::config().has("btree-search", "packed") && ind.size() >= 2 &&
+                                ind.size() * RAM_DOMAIN_SIZE <= 64;
+            const std::string comparator = packed ? "packed_comparator" : "comparator";
             if (ind.size() == arity) {
-                out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind)
-                    << ">>;\n";
+                out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::" << comparator << "<"
+                    << join(ind) << ">, std::allocator<t_tuple>, " << blockSize << ", " << strategy << ">;\n";
             } else {
-                out << "using t_ind_" << i << " = btree_multiset<t_tuple, index_utils::comparator<"
-                    << join(ind) << ">>;\n";
+                out << "using t_ind_" << i << " = btree_multiset<t_tuple, index_utils::" << comparator << "<"
+                    << join(ind) << ">, std::allocator<t_tuple>, " << blockSize << ", " << strategy << ">;\n";
             }
         }
         out << "t_ind_" << i << " ind_" << i << ";\n";
     }
 
+    // the tuples referred to by the indexes of keys, at stable addresses
+    if (hasTable) {
+        out << "Table<t_tuple> dataTable;\n";
+        out << "Lock table_lock;\n";
+    }
+
+    // secondary indexes may be built lazily, and are only maintained once built
+    bool lazy = Global::config().has("lazy-indexes") && !isProvenance && !isLattice();
+    if (lazy) {
+        for (size_t i = 0; i < numIndexes; i++) {
+            if (i != masterIndex) {
+                out << "bool built_" << i << " = true;\n";
+            }
+        }
+    }
+    const auto& maintain = [&](size_t i) { return lazy ? "if (built_" + std::to_string(i) + ") " : ""; };
+
+    // a bloom filter recording all inserted tuples, ruling out most lookups of missing tuples
+    if (hasFilter()) {
+        out << "BloomFilter filter{" << relation.getSizeHint() << "};\n";
+    }
+
+    // the keys of the inserted tuples, rejecting further tuples of a known key in constant time
+    const auto& domain = relation.getChoiceDomain();
+    if (isChoice()) {
+        out << "HashSet<Tuple<RamDomain, " << domain.size() << ">> keys;\n";
+    }
+
+    // the number of new tuples, read by the logged rules instead of the size traversing the b-tree
+    if (hasInsertionCounter()) {
+        out << "std::atomic<std::size_t> insertions{0};\n";
+    }
+
     // typedef master index iterator to be struct iterator
     out << "using iterator = t_ind_" << masterIndex << "::iterator;\n";
 
@@ -295,12 +553,34 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "}\n";  // end of insert(t_tuple&)
 
     out << "bool insert(const t_tuple& t, context& h) {\n";
+    if (isChoice()) {
+        std::vector<std::string> key;
+        for (size_t column : domain) {
+            key.push_back("t[" + std::to_string(column) + "]");
+        }
+        out << "if (!keys.insert(Tuple<RamDomain, " << domain.size() << ">{{" << join(key, ",")
+            << "}})) return false;\n";
+    }
+    if (hasFilter()) {
+        out << "filter.insert(&t[0], " << arity << ");\n";
+    }
     out << "if (ind_" << masterIndex << ".insert(t, h.hints_" << masterIndex << ")) {\n";
+    if (hasTable) {
+        out << "const t_tuple* ref;\n";
+        out << "{\n";
+        out << "auto lease = table_lock.acquire();\n";
+        out << "ref = &dataTable.insert(t);\n";
+        out << "}\n";
+    }
     for (size_t i = 0; i < numIndexes; i++) {
         if (i != masterIndex && provenanceIndexNumbers.find(i) == provenanceIndexNumbers.end()) {
-            out << "ind_" << i << ".insert(t, h.hints_" << i << ");\n";
+            out << maintain(i) << "ind_" << i << ".insert(" << (indirect[i] ? "*ref" : "t") << ", h.hints_"
+                << i << ");\n";
         }
     }
+    if (hasInsertionCounter()) {
+        out << "insertions.fetch_add(1, std::memory_order_relaxed);\n";
+    }
     out << "return true;\n";
     out << "} else return false;\n";
     out << "}\n";  // end of insert(t_tuple&, context&)
@@ -324,8 +604,111 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
 
+    const auto& storeTuples = [&]() {
+        if (hasTable) {
+            out << "std::vector<const t_tuple*> refs;\n";
+            out << "refs.reserve(data.size());\n";
+            out << "for (const auto& t : data) refs.push_back(&dataTable.insert(t));\n";
+        }
+    };
+    const auto& source = [&](size_t i) { return indirect[i] ? "refs" : "data"; };
+
+    // bulk insertion, loading the indexes of an empty relation from sorted tuples; tuples of a choice
+    // relation are inserted one by one, since each of them may be rejected by its key
+    if (isChoice()) {
+        out << "void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) {\n";
+        out << "for (std::size_t i = 0; i < count; ++i) insert(tuples + i * stride);\n";
+        out << "}\n";  // end of insertBulk(const RamDomain*, std::size_t, std::size_t)
+    } else if (!isProvenance) {
+        out << "void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) {\n";
+        out << "if (!empty()) {\n";
+        out << "for (std::size_t i = 0; i < count; ++i) insert(tuples + i * stride);\n";
+        out << "return;\n";
+        out << "}\n";
+        out << "std::vector<t_tuple> data(count);\n";
+        out << "for (std::size_t i = 0; i < count; ++i) {\n";
+        out << "std::copy(tuples + i * stride, tuples + i * stride + " << arity << ", &data[i][0]);\n";
+        if (hasFilter()) {
+            out << "filter.insert(&data[i][0], " << arity << ");\n";
+        }
+        out << "}\n";
+        out << "ind_" << masterIndex << ".insertBulk(std::move(data));\n";
+        if (hasInsertionCounter()) {
+            out << "insertions.fetch_add(ind_" << masterIndex << ".size(), std::memory_order_relaxed);\n";
+        }
+        if (numIndexes > 1) {
+            out << "data.assign(ind_" << masterIndex << ".begin(), ind_" << masterIndex << ".end());\n";
+            storeTuples();
+            for (size_t i = 0; i < numIndexes; i++) {
+                if (i != masterIndex) {
+                    out << maintain(i) << "ind_" << i << ".insertBulk(" << source(i) << ");\n";
+                }
+            }
+        }
+        out << "}\n";  // end of insertBulk(const RamDomain*, std::size_t, std::size_t)
+    }
+
+    // merging all tuples of another relation, sorted by the master index first, which determines the new
+    // tuples inserted into the other indexes
+    if (hasInsertAll()) {
+        std::vector<std::string> columns;
+        for (size_t i = 0; i < arity; i++) {
+            columns.push_back("t[" + std::to_string(i) + "]");
+        }
+        out << "template <typename T>\n";
+        out << "void insertAll(const T& other) {\n";
+        out << "std::vector<t_tuple> data;\n";
+        out << "data.reserve(other.size());\n";
+        out << "for (const auto& t : other) {\n";
+        out << "data.push_back(t_tuple{{" << join(columns, ",") << "}});\n";
+        if (hasFilter()) {
+            out << "filter.insert(&data.back()[0], " << arity << ");\n";
+        }
+        out << "}\n";
+        out << "data = ind_" << masterIndex << ".insertBulkNew(std::move(data));\n";
+        if (hasInsertionCounter()) {
+            out << "insertions.fetch_add(data.size(), std::memory_order_relaxed);\n";
+        }
+        storeTuples();
+        for (size_t i = 0; i < numIndexes; i++) {
+            if (i != masterIndex) {
+                out << maintain(i) << "ind_" << i << ".insertBulk(" << source(i) << ");\n";
+            }
+        }
+        out << "}\n";  // end of insertAll(const T&)
+    }
+
+    // building a secondary index bulk-loads the tuples of the master index, and dropping it discards them
+    if (lazy) {
+        for (size_t i = 0; i < numIndexes; i++) {
+            if (i == masterIndex) {
+                continue;
+            }
+            out << "void buildIndex_" << i << "() {\n";
+            out << "if (built_" << i << ") return;\n";
+            if (indirect[i]) {
+                out << "std::vector<const t_tuple*> refs;\n";
+                out << "for (const auto& t : dataTable) refs.push_back(&t);\n";
+                out << "ind_" << i << ".insertBulk(refs);\n";
+            } else {
+                out << "ind_" << i << ".insertBulk(std::vector<t_tuple>(ind_" << masterIndex
+                    << ".begin(), ind_" << masterIndex << ".end()));\n";
+            }
+            out << "built_" << i << " = true;\n";
+            out << "}\n";  // end of buildIndex_i()
+
+            out << "void dropIndex_" << i << "() {\n";
+            out << "ind_" << i << ".clear();\n";
+            out << "built_" << i << " = false;\n";
+            out << "}\n";  // end of dropIndex_i()
+        }
+    }
+
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
+    if (hasFilter()) {
+        out << "if (!filter.mayContain(&t[0], " << arity << ")) return false;\n";
+    }
     out << "return ind_" << masterIndex << ".contains(t, h.hints_" << masterIndex << ");\n";
     out << "}\n";
 
@@ -339,6 +722,12 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return ind_" << masterIndex << ".size();\n";
     out << "}\n";
 
+    if (hasInsertionCounter()) {
+        out << "std::size_t getInsertions() const {\n";
+        out << "return insertions.load(std::memory_order_relaxed);\n";
+        out << "}\n";
+    }
+
     // find methods
     out << "iterator find(const t_tuple& t, context& h) const {\n";
     out << "return ind_" << masterIndex << ".find(t, h.hints_" << masterIndex << ");\n";
@@ -403,6 +792,68 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // prefetch methods for the index scans nested into scans, padding the keys to their lower bounds
+    if (hasPrefetch()) {
+        for (SearchSignature search : getMinIndexSelection().getSearches()) {
+            size_t indNum = indexToNumMap[getMinIndexSelection().getLexOrder(search)];
+            out << "void prefetch_" << search << "(t_tuple* keys, std::size_t count, context& h) const {\n";
+            out << "for (std::size_t i = 0; i < count; ++i) {\n";
+            for (size_t column = 0; column < arity; column++) {
+                if (((search >> column) & 1) == 0) {
+                    out << "keys[i][" << column << "] = MIN_RAM_DOMAIN;\n";
+                }
+            }
+            out << "}\n";
+            out << "ind_" << indNum << ".prefetch(keys, count, h.hints_" << indNum << ");\n";
+            out << "}\n";
+        }
+    }
+
+    // seek methods for the leapfrog joins
+    for (SearchSignature search : getSeekSearches()) {
+        const std::string num = std::to_string(
+                search == 0 ? masterIndex : indexToNumMap[getMinIndexSelection().getLexOrder(search)]);
+        generateSeekMethod(out, search, "ind_" + num + ".lower_bound(t, h.hints_" + num + ")",
+                "ind_" + num + ".end()", "*pos");
+    }
+
+    // lowerRange and partition methods for the merge joins, streaming an index from a value on
+    for (SearchSignature search : isLattice() ? std::vector<SearchSignature>() : getMergeSearches()) {
+        const size_t indNum = indexToNumMap[getMinIndexSelection().getLexOrder(search)];
+        out << "range<t_ind_" << indNum << "::iterator> lowerRange_" << search;
+        out << "(const t_tuple& t, context& h) const {\n";
+        out << "t_tuple low(t);\n";
+        for (size_t column = 0; column < arity; column++) {
+            if (((search >> column) & 1) == 0) {
+                out << "low[" << column << "] = MIN_RAM_DOMAIN;\n";
+            }
+        }
+        out << "return make_range(ind_" << indNum << ".lower_bound(low, h.hints_" << indNum << "), ind_"
+            << indNum << ".end());\n";
+        out << "}\n";
+
+        out << "std::vector<range<t_ind_" << indNum << "::iterator>> partition_" << search << "() const {\n";
+        out << "return ind_" << indNum << ".getChunks(parallelChunkCount(ind_" << indNum << ".size()));\n";
+        out << "}\n";
+    }
+
+    // the indexes iterated by the outputs sorted by their leading columns
+    std::set<std::string> orderedBy;
+    for (const auto& order : hasOrderedIndexes() ? getMinIndexSelection().getOutputOrders()
+                                                 : MinIndexSelection::OrderCollection()) {
+        const int orderNum = getMinIndexSelection().getOrderNum(order);
+        if (orderNum < 0 || !orderedBy.insert(getOrderedByName(order)).second) {
+            continue;
+        }
+        const size_t indNum = indexToNumMap[getMinIndexSelection().getAllOrders()[orderNum]];
+        out << "IndexOrder<t_ind_" << indNum << "> " << getOrderedByName(order) << "() const {\n";
+        out << "return IndexOrder<t_ind_" << indNum << ">(ind_" << indNum << ");\n";
+        out << "}\n";
+    }
+
+    // scanEqualRange method for lookups through the interface
+    generateScanEqualRangeMethod(out);
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -410,7 +861,8 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
 
     // partition method for parallelism
     out << "std::vector<range<iterator>> partition() const {\n";
-    out << "return ind_" << masterIndex << ".getChunks(400);\n";
+    out << "return ind_" << masterIndex << ".getChunks(parallelChunkCount(ind_" << masterIndex
+        << ".size()));\n";
     out << "}\n";
 
     // purge method
@@ -418,8 +870,26 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     for (size_t i = 0; i < numIndexes; i++) {
         out << "ind_" << i << ".clear();\n";
     }
+    if (hasFilter()) {
+        out << "filter.clear();\n";
+    }
+    if (isChoice()) {
+        out << "keys.clear();\n";
+    }
+    if (hasTable) {
+        out << "dataTable.clear();\n";
+    }
     out << "}\n";
 
+    // compact method, packing the b-trees of a relation which is only read anymore
+    if (!isLattice()) {
+        out << "void compact() {\n";
+        for (size_t i = 0; i < numIndexes; i++) {
+            out << "ind_" << i << ".compact();\n";
+        }
+        out << "}\n";
+    }
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return ind_" << masterIndex << ".begin();\n";
@@ -429,6 +899,20 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return ind_" << masterIndex << ".end();\n";
     out << "}\n";
 
+    // discard the tuples subsumed by another relation, which may be indexed differently
+    if (isLattice()) {
+        out << "bool subsumes(const t_tuple& t) const {\n";
+        out << "return ind_" << masterIndex << ".subsumes(t);\n";
+        out << "}\n";
+
+        out << "template <typename T>\n";
+        out << "void extend(const T& other) {\n";
+        for (size_t i = 0; i < numIndexes; i++) {
+            out << "ind_" << i << ".discard([&](const t_tuple& t) { return other.subsumes(t); });\n";
+        }
+        out << "}\n";
+    }
+
     // copyIndex method
     if (!provenanceIndexNumbers.empty()) {
         out << "void copyIndex() {\n";
@@ -440,11 +924,31 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // getMemoryUsage method, estimating the bytes occupied by each index
+    out << "std::vector<std::size_t> getMemoryUsage() const {\n";
+    out << "std::vector<std::size_t> res;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res.push_back(ind_" << i << ".getMemoryUsage());\n";
+    }
+    if (hasFilter()) {
+        out << "res[" << masterIndex << "] += filter.getMemoryUsage();\n";
+    }
+    if (hasTable) {
+        out << "res[" << masterIndex << "] += dataTable.getMemoryUsage();\n";
+    }
+    out << "return res;\n";
+    out << "}\n";
+
+    // logHintStatistics method, lattice sets do not utilise hints
+    emitLogHintStatistics(out, isLattice() ? 0 : numIndexes, btreeHintCounters);
+
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
-    for (size_t i = 0; i < numIndexes; i++) {
+    // lattice sets do not utilise hints
+    for (size_t i = 0; i < numIndexes && !isLattice(); i++) {
         out << "const auto& stats_" << i << " = ind_" << i << ".getHintStatistics();\n";
-        out << "o << prefix << \"arity " << getArity() << " direct b-tree index " << inds[i]
+        out << "o << prefix << \"arity " << getArity()
+            << (indirect[i] ? " key index " : " direct b-tree index ") << inds[i]
             << ": (hits/misses/total)\\n\";\n";
         out << "o << prefix << \"Insert: \" << stats_" << i << ".inserts.getHits() << \"/\" << stats_" << i
             << ".inserts.getMisses() << \"/\" << stats_" << i << ".inserts.getAccesses() << \"\\n\";\n";
@@ -509,6 +1013,18 @@ void SynthesiserIndirectRelation::computeIndices() {
         masterIndex = 0;
     }
 
+    // expand the orders missing a single column, such that seeks find the tuples in order
+    for (auto& ind : inds) {
+        if (ind.size() + 1 == getArity()) {
+            std::set<int> curIndexElems(ind.begin(), ind.end());
+            for (size_t i = 0; i < getArity(); i++) {
+                if (curIndexElems.find(i) == curIndexElems.end()) {
+                    ind.push_back(i);
+                }
+            }
+        }
+    }
+
     computedIndices = inds;
 }
 
@@ -699,6 +1215,17 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // seek methods for the leapfrog joins
+    for (SearchSignature search : getSeekSearches()) {
+        const std::string num = std::to_string(
+                search == 0 ? masterIndex : indexToNumMap[getMinIndexSelection().getLexOrder(search)]);
+        generateSeekMethod(out, search, "ind_" + num + ".lower_bound(&t, h.hints_" + num + ")",
+                "ind_" + num + ".end()", "**pos");
+    }
+
+    // scanEqualRange method for lookups through the interface
+    generateScanEqualRangeMethod(out);
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -707,7 +1234,8 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     // partition method
     out << "std::vector<range<iterator>> partition() const {\n";
     out << "std::vector<range<iterator>> res;\n";
-    out << "for (const auto& cur : ind_" << masterIndex << ".getChunks(400)) {\n";
+    out << "for (const auto& cur : ind_" << masterIndex << ".getChunks(parallelChunkCount(ind_" << masterIndex
+        << ".size()))) {\n";
     out << "    res.push_back(make_range(derefIter(cur.begin()), derefIter(cur.end())));\n";
     out << "}\n";
     out << "return res;\n";
@@ -730,6 +1258,20 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return ind_" << masterIndex << ".end();\n";
     out << "}\n";
 
+    // getMemoryUsage method
+    out << "std::vector<std::size_t> getMemoryUsage() const {\n";
+    out << "std::vector<std::size_t> res;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res.push_back(ind_" << i << ".getMemoryUsage());\n";
+    }
+    // the stored tuples are accounted to the master index
+    out << "res[" << masterIndex << "] += dataTable.getMemoryUsage();\n";
+    out << "return res;\n";
+    out << "}\n";
+
+    // logHintStatistics method
+    emitLogHintStatistics(out, numIndexes, btreeHintCounters);
+
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
@@ -914,6 +1456,13 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";
 
+    // merging the tries of another relation of this type, e.g., the subtrie filled by a thread
+    out << "void mergeAll(const " << getTypeName() << "& other) {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".insertAll(other.ind_" << i << ");\n";
+    }
+    out << "}\n";
+
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
     out << "return ind_" << masterIndex << ".contains(orderIn_" << masterIndex << "(t), h.hints_"
@@ -980,6 +1529,9 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // scanEqualRange method for lookups through the interface
+    generateScanEqualRangeMethod(out);
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -1010,6 +1562,18 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".end());\n";
     out << "}\n";
 
+    // getMemoryUsage method
+    out << "std::vector<std::size_t> getMemoryUsage() const {\n";
+    out << "std::vector<std::size_t> res;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res.push_back(ind_" << i << ".getMemoryUsage());\n";
+    }
+    out << "return res;\n";
+    out << "}\n";
+
+    // logHintStatistics method
+    emitLogHintStatistics(out, numIndexes, brieHintCounters);
+
     // TODO: finish printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
@@ -1051,60 +1615,510 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     out << "};\n";
 }
 
-// -------- Eqrel Relation --------
+// -------- Hash Relation --------
 
-/** Generate index set for a eqrel relation */
-void SynthesiserEqrelRelation::computeIndices() {
-    assert(!isProvenance && "eqrel cannot be used with provenance");
+/** Generate index set for a hash relation, which is a single full index */
+void SynthesiserHashRelation::computeIndices() {
+    assert(!isProvenance && "hash sets cannot be used with provenance");
 
+    MinIndexSelection::LexOrder fullInd(getArity());
+    std::iota(fullInd.begin(), fullInd.end(), 0);
+    computedIndices = {fullInd};
     masterIndex = 0;
-    // {1, 0} is equivalent for an eqrel
-    computedIndices = {{0, 1}};
 }
 
-/** Generate type name of a eqrel relation */
-std::string SynthesiserEqrelRelation::getTypeName() {
-    return "t_eqrel";
+/** Generate type name of a hash relation */
+std::string SynthesiserHashRelation::getTypeName() {
+    return "t_hash_" + std::to_string(getArity());
 }
 
-/** Generate type struct of a eqrel relation */
-void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
-    const auto& inds = getIndices();
-    size_t numIndexes = inds.size();
-    std::map<MinIndexSelection::LexOrder, int> indexToNumMap;
+/** Generate type struct of a hash relation */
+void SynthesiserHashRelation::generateTypeStruct(std::ostream& out) {
+    size_t arity = getArity();
 
     // struct definition
     out << "struct " << getTypeName() << " {\n";
+    out << "using t_tuple = Tuple<RamDomain, " << arity << ">;\n";
+    out << "using t_ind_0 = HashSet<t_tuple>;\n";
+    out << "t_ind_0 ind_0;\n";
+    out << "using iterator = t_ind_0::iterator;\n";
 
-    // eqrel is only for binary relations
-    out << "using t_tuple = ram::Tuple<RamDomain, 2>;\n";
-    out << "using t_ind_" << masterIndex << " = EquivalenceRelation<t_tuple>;\n";
-    out << "t_ind_" << masterIndex << " ind_" << masterIndex << ";\n";
-
-    // generate auxiliary iterators that reorder tuples according to index orders
-    // generate auxiliary iterators which orderOut
-    out << "class iterator_0 : public std::iterator<std::forward_iterator_tag, t_tuple> {\n";
-    out << "    using nested_iterator = typename t_ind_0::iterator;\n";
-    out << "    nested_iterator nested;\n";
-    out << "    t_tuple value;\n";
+    // hints struct
+    out << "struct context {\n";
+    out << "t_ind_0::operation_hints hints_0;\n";
+    out << "};\n";
+    out << "context createContext() { return context(); }\n";
 
-    out << "public:\n";
-    out << "    iterator_0() = default;\n";
-    out << "    iterator_0(const nested_iterator& iter) : nested(iter), value(orderOut_0(*iter)) {}\n";
-    out << "    iterator_0(const iterator_0& other) = default;\n";
-    out << "    iterator_0& operator=(const iterator_0& other) = default;\n";
+    // insert methods
+    out << "bool insert(const t_tuple& t) {\n";
+    out << "context h;\n";
+    out << "return insert(t, h);\n";
+    out << "}\n";
 
-    out << "    bool operator==(const iterator_0& other) const {\n";
-    out << "        return nested == other.nested;\n";
-    out << "    }\n";
+    out << "bool insert(const t_tuple& t, context& h) {\n";
+    out << "return ind_0.insert(t, h.hints_0);\n";
+    out << "}\n";
 
-    out << "    bool operator!=(const iterator_0& other) const {\n";
-    out << "        return !(*this == other);\n";
-    out << "    }\n";
+    out << "bool insert(const RamDomain* ramDomain) {\n";
+    out << "RamDomain data[" << arity << "];\n";
+    out << "std::copy(ramDomain, ramDomain + " << arity << ", data);\n";
+    out << "const t_tuple& tuple = reinterpret_cast<const t_tuple&>(data);\n";
+    out << "context h;\n";
+    out << "return insert(tuple, h);\n";
+    out << "}\n";
 
-    out << "    const t_tuple& operator*() const {\n";
-    out << "        return value;\n";
-    out << "    }\n";
+    std::vector<std::string> decls;
+    std::vector<std::string> params;
+    for (size_t i = 0; i < arity; i++) {
+        decls.push_back("RamDomain a" + std::to_string(i));
+        params.push_back("a" + std::to_string(i));
+    }
+    out << "bool insert(" << join(decls, ",") << ") {\n";
+    out << "RamDomain data[" << arity << "] = {" << join(params, ",") << "};\n";
+    out << "return insert(data);\n";
+    out << "}\n";
+
+    // contains methods
+    out << "bool contains(const t_tuple& t, context& h) const {\n";
+    out << "return ind_0.contains(t, h.hints_0);\n";
+    out << "}\n";
+
+    out << "bool contains(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "return contains(t, h);\n";
+    out << "}\n";
+
+    // size method
+    out << "std::size_t size() const {\n";
+    out << "return ind_0.size();\n";
+    out << "}\n";
+
+    // find methods
+    out << "iterator find(const t_tuple& t, context& h) const {\n";
+    out << "return ind_0.find(t, h.hints_0);\n";
+    out << "}\n";
+
+    out << "iterator find(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "return find(t, h);\n";
+    out << "}\n";
+
+    // empty equalRange method
+    out << "range<iterator> equalRange_0(const t_tuple& t, context& h) const {\n";
+    out << "return range<iterator>(ind_0.begin(),ind_0.end());\n";
+    out << "}\n";
+
+    out << "range<iterator> equalRange_0(const t_tuple& t) const {\n";
+    out << "return range<iterator>(ind_0.begin(),ind_0.end());\n";
+    out << "}\n";
+
+    // equalRange methods, all searching for complete tuples
+    for (int64_t search : getMinIndexSelection().getSearches()) {
+        out << "range<iterator> equalRange_" << search << "(const t_tuple& t, context& h) const {\n";
+        out << "auto pos = ind_0.find(t, h.hints_0);\n";
+        out << "auto fin = ind_0.end();\n";
+        out << "if (pos != fin) {fin = pos; ++fin;}\n";
+        out << "return make_range(pos, fin);\n";
+        out << "}\n";
+
+        out << "range<iterator> equalRange_" << search << "(const t_tuple& t) const {\n";
+        out << "context h;\n";
+        out << "return equalRange_" << search << "(t, h);\n";
+        out << "}\n";
+    }
+
+    // scanEqualRange method for lookups through the interface
+    generateScanEqualRangeMethod(out);
+
+    // empty method
+    out << "bool empty() const {\n";
+    out << "return ind_0.empty();\n";
+    out << "}\n";
+
+    // partition method for parallelism
+    out << "std::vector<range<iterator>> partition() const {\n";
+    out << "return ind_0.partition(parallelChunkCount(ind_0.size()));\n";
+    out << "}\n";
+
+    // purge method
+    out << "void purge() {\n";
+    out << "ind_0.clear();\n";
+    out << "}\n";
+
+    // begin and end iterators
+    out << "iterator begin() const {\n";
+    out << "return ind_0.begin();\n";
+    out << "}\n";
+
+    out << "iterator end() const {\n";
+    out << "return ind_0.end();\n";
+    out << "}\n";
+
+    // getMemoryUsage method
+    out << "std::vector<std::size_t> getMemoryUsage() const {\n";
+    out << "return {ind_0.getMemoryUsage()};\n";
+    out << "}\n";
+
+    // logHintStatistics method, hash sets do not collect hint statistics
+    emitLogHintStatistics(out, 0, {});
+
+    // printHintStatistics method, hash sets do not collect hint statistics
+    out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
+    out << "o << prefix << \"arity " << arity << " hash set index " << getIndices()[0]
+        << ": no hint statistics\\n\";\n";
+    out << "}\n";
+
+    // end struct
+    out << "};\n";
+}
+
+// -------- Dense Relation --------
+
+/** Generate index set for a dense relation, the index of the inverse order being the reverse adjacency */
+void SynthesiserDenseRelation::computeIndices() {
+    assert(!isProvenance && "dense sets cannot be used with provenance");
+
+    MinIndexSelection::OrderCollection inds = indices.getAllOrders();
+
+    // generate a full index if no indices exist
+    if (inds.empty()) {
+        MinIndexSelection::LexOrder fullInd(getArity());
+        std::iota(fullInd.begin(), fullInd.end(), 0);
+        inds.push_back(fullInd);
+    }
+
+    // expand all indexes to be full
+    for (auto& ind : inds) {
+        for (size_t i = 0; i < getArity(); i++) {
+            if (std::find(ind.begin(), ind.end(), i) == ind.end()) {
+                ind.push_back(i);
+            }
+        }
+    }
+    masterIndex = 0;
+
+    computedIndices = inds;
+}
+
+/** Generate type name of a dense relation */
+std::string SynthesiserDenseRelation::getTypeName() {
+    std::stringstream res;
+    res << "t_dense_" << getArity();
+
+    for (auto& ind : getIndices()) {
+        res << "__" << join(ind, "_");
+    }
+
+    for (auto& search : getMinIndexSelection().getSearches()) {
+        res << "__" << search;
+    }
+
+    return res.str();
+}
+
+/** Generate type struct of a dense relation */
+void SynthesiserDenseRelation::generateTypeStruct(std::ostream& out) {
+    size_t arity = getArity();
+    const auto& inds = getIndices();
+    size_t numIndexes = inds.size();
+    std::map<MinIndexSelection::LexOrder, int> indexToNumMap;
+
+    // struct definition
+    out << "struct " << getTypeName() << " {\n";
+    out << "using t_tuple = Tuple<RamDomain, " << arity << ">;\n";
+
+    // define dense sets of unary relations and adjacency sets of binary relations
+    for (size_t i = 0; i < numIndexes; i++) {
+        if (i < getMinIndexSelection().getAllOrders().size()) {
+            indexToNumMap[getMinIndexSelection().getAllOrders()[i]] = i;
+        }
+        out << "using t_ind_" << i << " = " << (arity == 1 ? "DenseSet" : "AdjacencySet") << ";\n";
+        out << "t_ind_" << i << " ind_" << i << ";\n";
+    }
+
+    // generate auxiliary iterators that use orderOut
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "class iterator_" << i << " : public std::iterator<std::forward_iterator_tag, t_tuple> {\n";
+        out << "    using nested_iterator = typename t_ind_" << i << "::iterator;\n";
+        out << "    nested_iterator nested;\n";
+        out << "    t_tuple value;\n";
+
+        out << "public:\n";
+        out << "    iterator_" << i << "() = default;\n";
+        out << "    iterator_" << i << "(const nested_iterator& iter) : nested(iter), value(orderOut_" << i
+            << "(*iter)) {}\n";
+
+        out << "    bool operator==(const iterator_" << i << "& other) const {\n";
+        out << "        return nested == other.nested;\n";
+        out << "    }\n";
+
+        out << "    bool operator!=(const iterator_" << i << "& other) const {\n";
+        out << "        return !(*this == other);\n";
+        out << "    }\n";
+
+        out << "    const t_tuple& operator*() const {\n";
+        out << "        return value;\n";
+        out << "    }\n";
+
+        out << "    const t_tuple* operator->() const {\n";
+        out << "        return &value;\n";
+        out << "    }\n";
+
+        out << "    iterator_" << i << "& operator++() {\n";
+        out << "        ++nested;\n";
+        out << "        value = orderOut_" << i << "(*nested);\n";
+        out << "        return *this;\n";
+        out << "    }\n";
+        out << "};\n";
+    }
+    out << "using iterator = iterator_" << masterIndex << ";\n";
+
+    // hints struct
+    out << "struct context {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "t_ind_" << i << "::operation_hints hints_" << i << ";\n";
+    }
+    out << "};\n";
+    out << "context createContext() { return context(); }\n";
+
+    // insert methods
+    out << "bool insert(const t_tuple& t) {\n";
+    out << "context h;\n";
+    out << "return insert(t, h);\n";
+    out << "}\n";
+
+    out << "bool insert(const t_tuple& t, context& h) {\n";
+    out << "if (ind_" << masterIndex << ".insert(orderIn_" << masterIndex << "(t), h.hints_" << masterIndex
+        << ")) {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        if (i != masterIndex) {
+            out << "ind_" << i << ".insert(orderIn_" << i << "(t), h.hints_" << i << ");\n";
+        }
+    }
+    out << "return true;\n";
+    out << "} else return false;\n";
+    out << "}\n";
+
+    out << "bool insert(const RamDomain* ramDomain) {\n";
+    out << "RamDomain data[" << arity << "];\n";
+    out << "std::copy(ramDomain, ramDomain + " << arity << ", data);\n";
+    out << "const t_tuple& tuple = reinterpret_cast<const t_tuple&>(data);\n";
+    out << "context h;\n";
+    out << "return insert(tuple, h);\n";
+    out << "}\n";
+
+    std::vector<std::string> decls;
+    std::vector<std::string> params;
+    for (size_t i = 0; i < arity; i++) {
+        decls.push_back("RamDomain a" + std::to_string(i));
+        params.push_back("a" + std::to_string(i));
+    }
+    out << "bool insert(" << join(decls, ",") << ") {\n";
+    out << "RamDomain data[" << arity << "] = {" << join(params, ",") << "};\n";
+    out << "return insert(data);\n";
+    out << "}\n";
+
+    // contains methods
+    out << "bool contains(const t_tuple& t, context& h) const {\n";
+    out << "return ind_" << masterIndex << ".contains(orderIn_" << masterIndex << "(t), h.hints_"
+        << masterIndex << ");\n";
+    out << "}\n";
+
+    out << "bool contains(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "return contains(t, h);\n";
+    out << "}\n";
+
+    // size method
+    out << "std::size_t size() const {\n";
+    out << "return ind_" << masterIndex << ".size();\n";
+    out << "}\n";
+
+    // find methods
+    out << "iterator find(const t_tuple& t, context& h) const {\n";
+    out << "return ind_" << masterIndex << ".find(orderIn_" << masterIndex << "(t), h.hints_" << masterIndex
+        << ");\n";
+    out << "}\n";
+
+    out << "iterator find(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "return find(t, h);\n";
+    out << "}\n";
+
+    // empty equalRange method
+    out << "range<iterator> equalRange_0(const t_tuple& t, context& h) const {\n";
+    out << "return range<iterator>(begin(), end());\n";
+    out << "}\n";
+
+    out << "range<iterator> equalRange_0(const t_tuple& t) const {\n";
+    out << "return range<iterator>(begin(), end());\n";
+    out << "}\n";
+
+    // equalRange methods, searching for the row of a source or for complete tuples
+    for (int64_t search : getMinIndexSelection().getSearches()) {
+        size_t indNum = indexToNumMap[getMinIndexSelection().getLexOrder(search)];
+
+        size_t indSize = 0;
+        for (size_t i = 0; i < arity; i++) {
+            if (((search >> i) & 1) != 0) {
+                indSize++;
+            }
+        }
+
+        out << "range<iterator_" << indNum << "> equalRange_" << search;
+        out << "(const t_tuple& t, context& h) const {\n";
+        out << "auto r = ind_" << indNum << ".template getBoundaries<" << indSize << ">(orderIn_" << indNum
+            << "(t), h.hints_" << indNum << ");\n";
+        out << "return make_range(iterator_" << indNum << "(r.begin()), iterator_" << indNum
+            << "(r.end()));\n";
+        out << "}\n";
+
+        out << "range<iterator_" << indNum << "> equalRange_" << search;
+        out << "(const t_tuple& t) const {\n";
+        out << "context h; return equalRange_" << search << "(t, h);\n";
+        out << "}\n";
+    }
+
+    // seek methods for the leapfrog joins
+    for (SearchSignature search : getSeekSearches()) {
+        const std::string num = std::to_string(
+                search == 0 ? masterIndex : indexToNumMap[getMinIndexSelection().getLexOrder(search)]);
+        generateSeekMethod(out, search,
+                "ind_" + num + ".lower_bound(orderIn_" + num + "(t), h.hints_" + num + ")",
+                "ind_" + num + ".end()", "orderOut_" + num + "(*pos)");
+    }
+
+    // scanEqualRange method for lookups through the interface
+    generateScanEqualRangeMethod(out);
+
+    // empty method
+    out << "bool empty() const {\n";
+    out << "return ind_" << masterIndex << ".empty();\n";
+    out << "}\n";
+
+    // partition method for parallelism, cutting between chunks or rows
+    out << "std::vector<range<iterator>> partition() const {\n";
+    out << "std::vector<range<iterator>> res;\n";
+    out << "for (const auto& cur : ind_" << masterIndex << ".partition(parallelChunkCount(size()))) {\n";
+    out << "    res.push_back(make_range(iterator(cur.begin()), iterator(cur.end())));\n";
+    out << "}\n";
+    out << "return res;\n";
+    out << "}\n";
+
+    // purge method
+    out << "void purge() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".clear();\n";
+    }
+    out << "}\n";
+
+    // begin and end iterators
+    out << "iterator begin() const {\n";
+    out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".begin());\n";
+    out << "}\n";
+
+    out << "iterator end() const {\n";
+    out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".end());\n";
+    out << "}\n";
+
+    // getMemoryUsage method
+    out << "std::vector<std::size_t> getMemoryUsage() const {\n";
+    out << "std::vector<std::size_t> res;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res.push_back(ind_" << i << ".getMemoryUsage());\n";
+    }
+    out << "return res;\n";
+    out << "}\n";
+
+    // logHintStatistics method, dense sets do not collect hint statistics
+    emitLogHintStatistics(out, 0, {});
+
+    // printHintStatistics method, dense sets do not collect hint statistics
+    out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "o << prefix << \"arity " << arity << " dense index " << inds[i]
+            << ": no hint statistics\\n\";\n";
+    }
+    out << "}\n";
+
+    // orderOut and orderIn methods for reordering tuples according to index orders
+    for (size_t i = 0; i < numIndexes; i++) {
+        auto ind = inds[i];
+        out << "static t_tuple orderIn_" << i << "(const t_tuple& t) {\n";
+        out << "t_tuple res;\n";
+        for (size_t j = 0; j < ind.size(); j++) {
+            out << "res[" << j << "] = t[" << ind[j] << "];\n";
+        }
+        out << "return res;\n";
+        out << "}\n";
+
+        out << "static t_tuple orderOut_" << i << "(const t_tuple& t) {\n";
+        out << "t_tuple res;\n";
+        for (size_t j = 0; j < ind.size(); j++) {
+            out << "res[" << ind[j] << "] = t[" << j << "];\n";
+        }
+        out << "return res;\n";
+        out << "}\n";
+    }
+
+    // end struct
+    out << "};\n";
+}
+
+// -------- Eqrel Relation --------
+
+/** Generate index set for a eqrel relation */
+void SynthesiserEqrelRelation::computeIndices() {
+    assert(!isProvenance && "eqrel cannot be used with provenance");
+
+    masterIndex = 0;
+    // {1, 0} is equivalent for an eqrel
+    computedIndices = {{0, 1}};
+}
+
+/** Generate type name of a eqrel relation */
+std::string SynthesiserEqrelRelation::getTypeName() {
+    return "t_eqrel";
+}
+
+/** Generate type struct of a eqrel relation */
+void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
+    const auto& inds = getIndices();
+    size_t numIndexes = inds.size();
+    std::map<MinIndexSelection::LexOrder, int> indexToNumMap;
+
+    // struct definition
+    out << "struct " << getTypeName() << " {\n";
+
+    // eqrel is only for binary relations
+    out << "using t_tuple = ram::Tuple<RamDomain, 2>;\n";
+    out << "using t_ind_" << masterIndex << " = EquivalenceRelation<t_tuple>;\n";
+    out << "t_ind_" << masterIndex << " ind_" << masterIndex << ";\n";
+
+    // generate auxiliary iterators that reorder tuples according to index orders
+    // generate auxiliary iterators which orderOut
+    out << "class iterator_0 : public std::iterator<std::forward_iterator_tag, t_tuple> {\n";
+    out << "    using nested_iterator = typename t_ind_0::iterator;\n";
+    out << "    nested_iterator nested;\n";
+    out << "    t_tuple value;\n";
+
+    out << "public:\n";
+    out << "    iterator_0() = default;\n";
+    out << "    iterator_0(const nested_iterator& iter) : nested(iter), value(orderOut_0(*iter)) {}\n";
+    out << "    iterator_0(const iterator_0& other) = default;\n";
+    out << "    iterator_0& operator=(const iterator_0& other) = default;\n";
+
+    out << "    bool operator==(const iterator_0& other) const {\n";
+    out << "        return nested == other.nested;\n";
+    out << "    }\n";
+
+    out << "    bool operator!=(const iterator_0& other) const {\n";
+    out << "        return !(*this == other);\n";
+    out << "    }\n";
+
+    out << "    const t_tuple& operator*() const {\n";
+    out << "        return value;\n";
+    out << "    }\n";
 
     out << "    const t_tuple* operator->() const {\n";
     out << "        return &value;\n";
@@ -1147,6 +2161,11 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";
 
+    // bulk insertion, e.g. of loaded pairs, unioning the pairs in parallel
+    out << "void insertBulk(const RamDomain* tuples, std::size_t count, std::size_t stride) {\n";
+    out << "ind_" << masterIndex << ".insertBulk(tuples, count, stride);\n";
+    out << "}\n";
+
     // extends method for eqrel
     // performs a delta extension, where we union the sets that share elements between this and other.
     //      i.e. if a in this, and a in other, union(set(this->a), set(other->a))
@@ -1199,9 +2218,12 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // scanEqualRange method for lookups through the interface
+    generateScanEqualRangeMethod(out);
+
     // empty method
     out << "bool empty() const {\n";
-    out << "return ind_" << masterIndex << ".size() == 0;\n";
+    out << "return ind_" << masterIndex << ".empty();\n";
     out << "}\n";
 
     // partition method
@@ -1229,6 +2251,18 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".end());\n";
     out << "}\n";
 
+    // getMemoryUsage method
+    out << "std::vector<std::size_t> getMemoryUsage() const {\n";
+    out << "std::vector<std::size_t> res;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res.push_back(ind_" << i << ".getMemoryUsage());\n";
+    }
+    out << "return res;\n";
+    out << "}\n";
+
+    // logHintStatistics method, equivalence relations do not collect hint statistics
+    emitLogHintStatistics(out, 0, {});
+
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     out << "o << \"eqrel index: no hint statistics supported\\n\";\n";
@@ -14,6 +14,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -65,11 +66,64 @@ public:
     /** Generate relation type struct */
     virtual void generateTypeStruct(std::ostream& out) = 0;
 
+    /** Whether the type struct has an insertAll method, merging all tuples of another relation at once */
+    virtual bool hasInsertAll() const {
+        return false;
+    }
+
+    /** Whether the type struct has prefetch methods, prefetching the searches of a batch of keys */
+    virtual bool hasPrefetch() const {
+        return false;
+    }
+
+    /**
+     * Whether the type struct counts its new tuples, read by the logged rules of a profiled program by
+     * getInsertions() instead of its size
+     */
+    virtual bool hasInsertionCounter() const {
+        return false;
+    }
+
+    /**
+     * Whether the type struct iterates the indexes starting with the columns outputs are sorted by,
+     * through the methods named by getOrderedByName()
+     */
+    virtual bool hasOrderedIndexes() const {
+        return false;
+    }
+
+    /** Get the name of the method iterating the index starting with the columns of the given order */
+    static std::string getOrderedByName(const MinIndexSelection::LexOrder& order);
+
     /** Factory method to generate a SynthesiserRelation */
     static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(
             const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance);
 
 protected:
+    /** Get the searches binding all but one column, which are advanced by leapfrog joins */
+    std::vector<SearchSignature> getSeekSearches() const;
+
+    /** Get the searches binding a single column, which order the relations of merge joins */
+    std::vector<SearchSignature> getMergeSearches() const;
+
+    /**
+     * Generate the method seeking the least tuple agreeing with a given one on the
+     * columns of a search, whose free column is not less than the given one.
+     *
+     * @param search the search, binding all but one column
+     * @param lowerBound the expression locating the tuple
+     * @param end the end iterator of the index searched
+     * @param entry the expression obtaining the tuple from the position found
+     */
+    void generateSeekMethod(std::ostream& out, SearchSignature search, const std::string& lowerBound,
+            const std::string& end, const std::string& entry) const;
+
+    /**
+     * Generate the method handing out the tuples agreeing with a given one on a set of
+     * columns, through the equalRange method of the search binding the most of them.
+     */
+    void generateScanEqualRangeMethod(std::ostream& out) const;
+
     /** Ram relation referred to by this */
     const RamRelation& relation;
 
@@ -121,6 +175,38 @@ public:
     void computeIndices() override;
     std::string getTypeName() override;
     void generateTypeStruct(std::ostream& out) override;
+
+    bool hasInsertAll() const override {
+        return !isProvenance && !isLattice() && !isChoice();
+    }
+
+    bool hasPrefetch() const override {
+        return !isLattice();
+    }
+
+    /** The sizes of b-trees are computed by traversals, whereas subsumptive relations replace tuples */
+    bool hasOrderedIndexes() const override;
+    bool hasInsertionCounter() const override;
+
+protected:
+    /** Get the number of bytes of the b-tree nodes, by qualifier or by tuple width and expected size */
+    size_t getBlockSize() const;
+
+    /** Whether the relation is subsumptive, indexed by lattice sets instead of b-trees */
+    bool isLattice() const {
+        return relation.getRepresentation() == RelationRepresentation::MIN_LATTICE ||
+               relation.getRepresentation() == RelationRepresentation::MAX_LATTICE;
+    }
+
+    /** Whether the relation keeps the first tuple of each key of its choice-domain only */
+    bool isChoice() const {
+        return !relation.getChoiceDomain().empty() && !isProvenance;
+    }
+
+    /** Whether lookups of complete tuples are ruled out by a bloom filter first */
+    bool hasFilter() const {
+        return relation.hasBloomFilter() && !isProvenance && !isLattice();
+    }
 };
 
 class SynthesiserIndirectRelation : public SynthesiserRelation {
@@ -144,6 +230,26 @@ public:
     void generateTypeStruct(std::ostream& out) override;
 };
 
+class SynthesiserHashRelation : public SynthesiserRelation {
+public:
+    SynthesiserHashRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
+            : SynthesiserRelation(ramRel, indexSet, isProvenance) {}
+
+    void computeIndices() override;
+    std::string getTypeName() override;
+    void generateTypeStruct(std::ostream& out) override;
+};
+
+class SynthesiserDenseRelation : public SynthesiserRelation {
+public:
+    SynthesiserDenseRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
+            : SynthesiserRelation(ramRel, indexSet, isProvenance) {}
+
+    void computeIndices() override;
+    std::string getTypeName() override;
+    void generateTypeStruct(std::ostream& out) override;
+};
+
 class SynthesiserEqrelRelation : public SynthesiserRelation {
 public:
     SynthesiserEqrelRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
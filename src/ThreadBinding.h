@@ -0,0 +1,182 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ThreadBinding.h
+ *
+ * Utilities pinning the threads of the parallel evaluation to the cores
+ * of the NUMA nodes of the machine.
+ *
+ * Threads that stay on their core keep the memory they touch first on
+ * their local NUMA node: the node pools hand out the nodes of the
+ * relation data structures from slabs owned by the allocating thread, so
+ * the partitions a thread inserts are placed on its node. Two policies
+ * are supported, following the names of OpenMP's proc_bind settings:
+ *   - close:  threads fill the cores of one NUMA node after the other
+ *   - spread: threads are assigned round robin to the NUMA nodes
+ *
+ * The topology is read from the sysfs of Linux; on other systems the
+ * binding has no effect.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "Util.h"
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace souffle {
+
+/**
+ * Parses a list of CPUs in the format of the Linux sysfs, e.g. 0-3,8,10-11.
+ */
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> res;
+    std::stringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        const std::size_t dash = range.find('-');
+        try {
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                res.push_back(cpu);
+            }
+        } catch (...) {
+            // ignore malformed ranges, including the trailing newline
+        }
+    }
+    return res;
+}
+
+/**
+ * Computes the CPU for each thread of a team, given the CPUs of each NUMA
+ * node. If there are more threads than CPUs, the placement wraps around.
+ *
+ * @param policy the binding policy, close or spread
+ * @param nodes the non-empty lists of CPUs of the NUMA nodes
+ * @param numThreads the number of threads of the team
+ * @return the CPU of each thread
+ */
+inline std::vector<int> getThreadPlacement(
+        const std::string& policy, const std::vector<std::vector<int>>& nodes, std::size_t numThreads) {
+    std::vector<int> order;
+    if (policy == "spread") {
+        // take the i-th CPU of every node before the (i+1)-th one of any node
+        for (std::size_t i = 0; order.size() < numThreads; ++i) {
+            bool any = false;
+            for (const auto& node : nodes) {
+                if (i < node.size()) {
+                    order.push_back(node[i]);
+                    any = true;
+                }
+            }
+            if (!any) {
+                break;
+            }
+        }
+    } else {
+        for (const auto& node : nodes) {
+            order.insert(order.end(), node.begin(), node.end());
+        }
+    }
+    std::vector<int> res;
+    for (std::size_t i = 0; i < numThreads && !order.empty(); ++i) {
+        res.push_back(order[i % order.size()]);
+    }
+    return res;
+}
+
+#ifdef __linux__
+/**
+ * Lists the CPUs available to this process, grouped by NUMA node. Nodes
+ * without available CPUs are omitted.
+ */
+inline std::vector<std::vector<int>> getNumaNodes() {
+    cpu_set_t available;
+    CPU_ZERO(&available);
+    if (sched_getaffinity(0, sizeof(available), &available) != 0) {
+        return {};
+    }
+    std::vector<std::vector<int>> res;
+    std::vector<bool> covered(CPU_SETSIZE, false);
+    for (int node = 0;; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            break;
+        }
+        std::string list;
+        std::getline(file, list);
+        std::vector<int> cpus;
+        for (int cpu : parseCpuList(list)) {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &available)) {
+                cpus.push_back(cpu);
+                covered[cpu] = true;
+            }
+        }
+        if (!cpus.empty()) {
+            res.push_back(cpus);
+        }
+    }
+    // without NUMA information all available CPUs form a single node
+    std::vector<int> rest;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &available) && !covered[cpu]) {
+            rest.push_back(cpu);
+        }
+    }
+    if (!rest.empty()) {
+        res.push_back(rest);
+    }
+    return res;
+}
+#endif
+
+/**
+ * Pins each thread of the parallel regions to follow to a CPU according
+ * to the given policy. The binding covers the team size that is current
+ * when calling this function.
+ *
+ * @param policy the binding policy, none, close or spread
+ * @return the CPUs the threads have been bound to, as a comma separated list
+ */
+inline std::string bindThreads(const std::string& policy) {
+#if defined(_OPENMP) && defined(__linux__)
+    if (policy != "close" && policy != "spread") {
+        return "";
+    }
+    const std::vector<int> placement = getThreadPlacement(policy, getNumaNodes(), omp_get_max_threads());
+    if (placement.empty()) {
+        return "";
+    }
+#pragma omp parallel num_threads(placement.size())
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(placement[omp_get_thread_num()], &cpus);
+        sched_setaffinity(0, sizeof(cpus), &cpus);
+    }
+    return toString(join(placement, ","));
+#else
+    (void)policy;
+    return "";
+#endif
+}
+
+}  // end namespace souffle
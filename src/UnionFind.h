@@ -139,6 +139,13 @@ public:
         a_blocks.clear();
     }
 
+    /**
+     * Return an estimate of the number of bytes of memory occupied by this disjoint set
+     */
+    size_t getMemoryUsage() const {
+        return a_blocks.getMemoryUsage();
+    }
+
     /**
      * Check whether the two indices are in the same set
      * @param x node to be checked
@@ -339,6 +346,14 @@ public:
         denseToSparseMap.clear();
     }
 
+    /**
+     * Return an estimate of the number of bytes of memory occupied by this disjoint set
+     */
+    size_t getMemoryUsage() const {
+        return sizeof(*this) - sizeof(ds) - sizeof(sparseToDenseMap) - sizeof(denseToSparseMap) +
+               ds.getMemoryUsage() + sparseToDenseMap.getMemoryUsage() + denseToSparseMap.getMemoryUsage();
+    }
+
     /* wrapper for node creation */
     inline void makeNode(SparseDomain val) {
         // dense has the behaviour of creating if not exists.
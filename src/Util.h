@@ -21,10 +21,12 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <charconv>
 #include <chrono>
 #include <condition_variable>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -32,6 +34,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -40,6 +43,7 @@
 #include <cerrno>
 #include <climits>
 #include <cstdarg>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <sys/stat.h>
@@ -146,6 +150,82 @@ inline RamUnsigned RamUnsignedFromString(
     return static_cast<RamUnsigned>(val);
 }
 
+/**
+ * Converts a string view to a RamDomain, without copying it.
+ *
+ * The fast path uses std::from_chars. Inputs it rejects (leading whitespace or '+', values out
+ * of range) are handed to RamDomainFromString, such that the result and the exceptions thrown
+ * are the same as for RamDomainFromString.
+ */
+inline RamDomain RamDomainFromChars(std::string_view str) {
+    RamDomain val;
+    const auto result = std::from_chars(str.data(), str.data() + str.size(), val);
+    if (result.ec != std::errc()) {
+        return RamDomainFromString(std::string(str));
+    }
+    return val;
+}
+
+/**
+ * Converts a string view to a RamFloat, without copying it.
+ *
+ * Falls back to RamFloatFromString for inputs std::from_chars does not handle like strtod,
+ * e.g. hexadecimal floats, a leading '+' or values out of range.
+ */
+inline RamFloat RamFloatFromChars(std::string_view str) {
+#if defined(__cpp_lib_to_chars)
+    RamFloat val;
+    const char* last = str.data() + str.size();
+    const auto result = std::from_chars(str.data(), last, val);
+    if (result.ec == std::errc() && (result.ptr == last || (*result.ptr != 'x' && *result.ptr != 'X'))) {
+        return val;
+    }
+#endif
+    return RamFloatFromString(std::string(str));
+}
+
+/**
+ * Converts a string view to a RamUnsigned, without copying it.
+ *
+ * Falls back to RamUnsignedFromString for inputs std::from_chars rejects.
+ */
+inline RamUnsigned RamUnsignedFromChars(std::string_view str) {
+    RamUnsigned val;
+    const auto result = std::from_chars(str.data(), str.data() + str.size(), val);
+    if (result.ec != std::errc()) {
+        return RamUnsignedFromString(std::string(str));
+    }
+    return val;
+}
+
+/** The size of a buffer holding any RamFloat formatted by RamFloatToChars */
+constexpr std::size_t RAM_FLOAT_CHARS = 32;
+
+/**
+ * Formats a RamFloat into a buffer of RAM_FLOAT_CHARS as the shortest decimal that RamFloatFromChars
+ * converts back to the same value, e.g. 0.1 rather than 0.100000001 for a 32-bit float, and returns the
+ * end of the characters written.
+ *
+ * Without std::to_chars for floating point numbers, max_digits10 significant digits are written, which
+ * convert back to the same value but are not always the shortest.
+ */
+inline char* RamFloatToChars(char* first, RamFloat value) {
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(first, first + RAM_FLOAT_CHARS, value).ptr;
+#else
+    return first + std::snprintf(first, RAM_FLOAT_CHARS, "%.*g", std::numeric_limits<RamFloat>::max_digits10,
+            static_cast<double>(value));
+#endif
+}
+
+/**
+ * Formats a RamFloat like RamFloatToChars
+ */
+inline std::string RamFloatToString(RamFloat value) {
+    char buffer[RAM_FLOAT_CHARS];
+    return std::string(buffer, RamFloatToChars(buffer, value));
+}
+
 #if RAM_DOMAIN_SIZE == 64
 inline RamDomain stord(const std::string& str, std::size_t* pos = nullptr, int base = 10) {
     return static_cast<RamDomain>(std::stoull(str, pos, base));
@@ -262,14 +342,18 @@ struct range {
         return a == b;
     }
 
-    // splits up this range into the given number of partitions
-    std::vector<range> partition(int np = 100) {
+    // splits up this range into the given number of partitions, each covering at least
+    // minChunkSize elements (except if the range is smaller than minChunkSize)
+    std::vector<range> partition(int np = 100, int minChunkSize = 1) {
         // obtain the size
         int n = 0;
         for (auto i = a; i != b; ++i) {
             n++;
         }
 
+        // cap the number of partitions by the minimal chunk size
+        np = std::max(1, std::min(np, n / minChunkSize));
+
         // split it up
         auto s = n / np;
         auto r = n % np;
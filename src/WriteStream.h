@@ -15,11 +15,14 @@
 #pragma once
 
 #include "IODirectives.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "RecordTable.h"
 #include "SymbolTable.h"
+#include "Util.h"
 #include "json11.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <vector>
@@ -48,21 +51,39 @@ public:
             std::string type = types[relationName]["types"][i].string_value();
             typeAttributes.push_back(std::move(type));
         }
+
+        order = ioDirectives.getOrderColumns();
     }
 
+    /**
+     * Write the tuples of a relation; an output with an order is sorted by its columns first.
+     */
     template <typename T>
     void writeAll(const T& relation) {
+        if (!order.empty() && !summary && arity > 0) {
+            return writeSorted(relation);
+        }
+        writeOrdered(relation);
+    }
+
+    /**
+     * Write the tuples of a relation in the order they are iterated in, e.g. by an index whose
+     * order starts with the columns the output is sorted by.
+     */
+    template <typename T>
+    void writeOrdered(const T& relation) {
         if (summary) {
             return writeSize(relation.size());
         }
-        auto lease = symbolTable.acquireLock();
-        (void)lease;  // silence "unused variable" warning
         if (arity == 0) {
             if (relation.begin() != relation.end()) {
                 writeNullary();
             }
             return;
         }
+        if (formatsChunks()) {
+            return writeChunks(relation, 0);
+        }
         for (const auto& current : relation) {
             writeNext(current);
         }
@@ -84,6 +105,9 @@ protected:
     const bool summary;
     size_t arity;
 
+    /** The columns the output is sorted by, if any */
+    std::vector<size_t> order;
+
     virtual void writeNullary() = 0;
     virtual void writeNextTuple(const RamDomain* tuple) = 0;
     virtual void writeSize(std::size_t) {
@@ -94,6 +118,177 @@ protected:
         writeNextTuple(tuple.data);
     }
 
+    /** Whether the writer formats the chunks of a partitioned relation in parallel */
+    virtual bool formatsChunks() const {
+        return false;
+    }
+
+    /** Format a tuple at the end of the given buffer; called concurrently for different buffers */
+    virtual void formatTuple(std::string& /* destination */, const RamDomain* /* tuple */) {
+        assert(false && "attempting to format a tuple of a writer without chunks");
+    }
+
+    /** Write the formatted tuples of a chunk */
+    virtual void writeChunk(const std::string& /* chunk */) {
+        assert(false && "attempting to write a chunk of a writer without chunks");
+    }
+
+    /**
+     * Format the chunks of a partitioned relation in parallel and write them in order. At most one
+     * formatted chunk per thread is held in memory at any time.
+     */
+    template <typename Chunks>
+    void writePartition(Chunks& chunks) {
+        const size_t numChunks = chunks.size();
+        const size_t window = MAX_THREADS;
+        std::vector<std::string> buffers(std::min(window, numChunks));
+        for (size_t start = 0; start < numChunks; start += window) {
+            const size_t end = std::min(numChunks, start + window);
+            PARALLEL_START_IF(end - start > 1)
+                ;
+                pfor(size_t i = start; i < end; i++) {
+                    std::string& buffer = buffers[i - start];
+                    buffer.clear();
+                    for (const auto& tuple : *(chunks.begin() + i)) {
+                        formatTuple(buffer, tupleData(tuple));
+                    }
+                }
+            PARALLEL_END
+            for (size_t i = start; i < end; i++) {
+                writeChunk(buffers[i - start]);
+            }
+        }
+    }
+
+    /** Write a relation of generated code, partitioned by its master index */
+    template <typename T>
+    auto writeChunks(const T& relation, int) -> decltype(relation.partition(), void()) {
+        auto chunks = relation.partition();
+        writePartition(chunks);
+    }
+
+    /** Write a relation of the interpreter, partitioned by its main index */
+    template <typename T>
+    auto writeChunks(const T& relation, long) -> decltype(relation.partitionScan(1), void()) {
+        auto chunks = relation.partitionScan(parallelChunkCount(relation.size()));
+        writePartition(chunks);
+    }
+
+    /** Write a relation that cannot be partitioned sequentially, in chunks of bounded size */
+    template <typename T>
+    void writeChunks(const T& relation, ...) {
+        constexpr size_t maxChunkSize = 1 << 20;
+        std::string buffer;
+        for (const auto& tuple : relation) {
+            formatTuple(buffer, tupleData(tuple));
+            if (buffer.size() >= maxChunkSize) {
+                writeChunk(buffer);
+                buffer.clear();
+            }
+        }
+        writeChunk(buffer);
+    }
+
+    /** The tuples of a relation sorted by the writer, referring to copies of them */
+    struct SortedTuples {
+        std::vector<const RamDomain*> tuples;
+
+        std::vector<const RamDomain*>::const_iterator begin() const {
+            return tuples.begin();
+        }
+
+        std::vector<const RamDomain*>::const_iterator end() const {
+            return tuples.end();
+        }
+
+        size_t size() const {
+            return tuples.size();
+        }
+
+        std::vector<range<std::vector<const RamDomain*>::const_iterator>> partition() const {
+            const size_t numChunks = parallelChunkCount(tuples.size());
+            std::vector<range<std::vector<const RamDomain*>::const_iterator>> chunks;
+            for (size_t i = 0; i < numChunks; i++) {
+                chunks.emplace_back(tuples.begin() + tuples.size() * i / numChunks,
+                        tuples.begin() + tuples.size() * (i + 1) / numChunks);
+            }
+            return chunks;
+        }
+    };
+
+    /**
+     * Sort the tuples of a relation by the columns of the output, which are compared by their types,
+     * and write them. Ties are broken by the other columns, such that the output is deterministic.
+     * The tuples are copied, and sorted in parallel.
+     */
+    template <typename T>
+    void writeSorted(const T& relation) {
+        std::vector<RamDomain> data;
+        data.reserve(relation.size() * arity);
+        for (const auto& tuple : relation) {
+            const RamDomain* cur = tupleData(tuple);
+            data.insert(data.end(), cur, cur + arity);
+        }
+
+        SortedTuples sorted;
+        sorted.tuples.reserve(data.size() / arity);
+        for (size_t i = 0; i < data.size(); i += arity) {
+            sorted.tuples.push_back(&data[i]);
+        }
+
+        std::vector<size_t> columns = order;
+        for (size_t column = 0; column < arity; column++) {
+            if (std::find(order.begin(), order.end(), column) == order.end()) {
+                columns.push_back(column);
+            }
+        }
+        parallelSort(sorted.tuples.begin(), sorted.tuples.end(), [&](const RamDomain* a, const RamDomain* b) {
+            for (size_t column : columns) {
+                const int cmp = compareValues(column, a[column], b[column]);
+                if (cmp != 0) {
+                    return cmp < 0;
+                }
+            }
+            return false;
+        });
+        writeOrdered(sorted);
+    }
+
+    /** Compare two values of a column: numbers by their value, symbols by their text */
+    int compareValues(size_t column, RamDomain a, RamDomain b) const {
+        switch (typeAttributes[column][0]) {
+            case 'u': {
+                const RamUnsigned x = ramBitCast<RamUnsigned>(a);
+                const RamUnsigned y = ramBitCast<RamUnsigned>(b);
+                return (x > y) - (x < y);
+            }
+            case 'f': {
+                const RamFloat x = ramBitCast<RamFloat>(a);
+                const RamFloat y = ramBitCast<RamFloat>(b);
+                return (x > y) - (x < y);
+            }
+            case 's':
+                return a == b ? 0 : symbolTable.unsafeResolve(a).compare(symbolTable.unsafeResolve(b));
+            default:
+                // numbers, and records by their references
+                return (a > b) - (a < b);
+        }
+    }
+
+    template <typename Tuple>
+    static auto tupleData(const Tuple& tuple) -> decltype(&tuple.data[0]) {
+        return &tuple.data[0];
+    }
+
+    template <typename Tuple>
+    static auto tupleData(const Tuple& tuple) -> decltype(tuple.getBase()) {
+        return tuple.getBase();
+    }
+
+    static const RamDomain* tupleData(const RamDomain* tuple) {
+        return tuple;
+    }
+
     void outputRecord(std::ostream& destination, const RamDomain value, const std::string& name) {
         Json recordInfo = types["records"][name];
 
@@ -130,7 +325,7 @@ protected:
                     destination << recordValue;
                     break;
                 case 'f':
-                    destination << ramBitCast<RamFloat>(recordValue);
+                    destination << RamFloatToString(ramBitCast<RamFloat>(recordValue));
                     break;
                 case 'u':
                     destination << ramBitCast<RamUnsigned>(recordValue);
@@ -149,6 +344,36 @@ protected:
     }
 };
 
+/**
+ * The tuples of a relation in the order of one of its indexes, written by WriteStream::writeOrdered
+ * for an output sorted by the leading columns of the index.
+ */
+template <typename Index>
+class IndexOrder {
+public:
+    explicit IndexOrder(const Index& index) : index(index) {}
+
+    auto begin() const -> decltype(std::declval<const Index&>().begin()) {
+        return index.begin();
+    }
+
+    auto end() const -> decltype(std::declval<const Index&>().end()) {
+        return index.end();
+    }
+
+    std::size_t size() const {
+        return index.size();
+    }
+
+    /** Split the index into consecutive chunks, formatted in parallel by the writer */
+    auto partition() const -> decltype(std::declval<const Index&>().getChunks(1)) {
+        return index.getChunks(parallelChunkCount(index.size()));
+    }
+
+private:
+    const Index& index;
+};
+
 class WriteStreamFactory {
 public:
     virtual std::unique_ptr<WriteStream> getWriter(const IODirectives& ioDirectives,
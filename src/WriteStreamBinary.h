@@ -0,0 +1,214 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamBinary.h
+ *
+ * Writes binary fact files (see IOBinaryFormat.h), to files or shared memory.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "IOBinaryFormat.h"
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include "SymbolTable.h"
+#include "WriteStream.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * Collects the tuples of a relation in the layout of binary fact files, which are
+ * written by the subclasses once all tuples are known.
+ */
+class WriteStreamBinary : public WriteStream {
+protected:
+    WriteStreamBinary(const IODirectives& ioDirectives, const SymbolTable& symbolTable,
+            const RecordTable& recordTable, const std::string& name)
+            : WriteStream(ioDirectives, symbolTable, recordTable), columns(arity) {
+        for (const auto& type : typeAttributes) {
+            if (type[0] == 'r') {
+                throw std::invalid_argument("Binary IO does not support records in fact file " + name);
+            }
+            isSymbol.push_back(type[0] == 's');
+        }
+    }
+
+    /** Whether a column holds symbols */
+    std::vector<bool> isSymbol;
+
+    /** The collected tuples, column-major */
+    std::vector<std::vector<RamDomain>> columns;
+    uint64_t numTuples = 0;
+
+    /** The symbol sub-table, as indices of the symbol table */
+    std::vector<RamDomain> symbols;
+    std::unordered_map<RamDomain, RamDomain> symbolIndex;
+
+    void writeNullary() override {
+        numTuples = 1;
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        for (size_t col = 0; col < arity; ++col) {
+            RamDomain value = tuple[col];
+            if (isSymbol[col]) {
+                auto pos = symbolIndex.emplace(value, static_cast<RamDomain>(symbols.size()));
+                if (pos.second) {
+                    symbols.push_back(value);
+                }
+                value = pos.first->second;
+            }
+            columns[col].push_back(value);
+        }
+        ++numTuples;
+    }
+
+    /** The size of the binary facts in bytes */
+    uint64_t getFactsSize() const {
+        uint64_t offset = sizeof(BinaryFactsHeader);
+        for (const RamDomain symbol : symbols) {
+            offset += sizeof(uint64_t) + symbolTable.unsafeResolve(symbol).size();
+        }
+        return alignBinaryFactsOffset(offset) + arity * numTuples * sizeof(RamDomain);
+    }
+
+    /** Pass the binary facts piece by piece to the given function taking a pointer and a size */
+    template <typename Write>
+    void writeFacts(Write write) const {
+        const auto header = BinaryFactsHeader::create(arity, numTuples, symbols.size());
+        write(&header, sizeof(header));
+
+        uint64_t offset = sizeof(header);
+        for (const RamDomain symbol : symbols) {
+            const std::string& str = symbolTable.unsafeResolve(symbol);
+            const uint64_t length = str.size();
+            write(&length, sizeof(length));
+            write(str.data(), length);
+            offset += sizeof(length) + length;
+        }
+        const uint64_t padding = alignBinaryFactsOffset(offset) - offset;
+        const char zeros[8] = {};
+        write(zeros, padding);
+
+        for (const auto& column : columns) {
+            write(column.data(), column.size() * sizeof(RamDomain));
+        }
+    }
+};
+
+class WriteFileBinary : public WriteStreamBinary {
+public:
+    WriteFileBinary(
+            const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
+            : WriteStreamBinary(ioDirectives, symbolTable, recordTable, ioDirectives.getFileName()),
+              file(ioDirectives.getFileName(), std::ios::out | std::ios::binary) {
+        if (!file.is_open()) {
+            throw std::invalid_argument("Cannot open fact file " + ioDirectives.getFileName() + "\n");
+        }
+    }
+
+    /** The file is written once all tuples are known */
+    ~WriteFileBinary() override {
+        writeFacts([&](const void* data, size_t size) {
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        });
+    }
+
+protected:
+    std::ofstream file;
+};
+
+/**
+ * Publishes the binary facts of a relation in a named POSIX shared memory segment
+ * (segment=<name>, see getSharedMemorySegment), from which another program loads
+ * them without formatting or parsing.
+ */
+class WriteSharedMemoryBinary : public WriteStreamBinary {
+public:
+    WriteSharedMemoryBinary(
+            const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
+            : WriteStreamBinary(ioDirectives, symbolTable, recordTable, getSharedMemorySegment(ioDirectives)),
+              segment(getSharedMemorySegment(ioDirectives)) {
+        fd = shm_open(segment.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (fd < 0) {
+            throw std::invalid_argument("Cannot open shared memory segment " + segment + "\n");
+        }
+    }
+
+    /** The segment is sized and filled once all tuples are known */
+    ~WriteSharedMemoryBinary() override {
+        const uint64_t size = getFactsSize();
+        void* data = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "Cannot map shared memory segment " << segment << "\n";
+            return;
+        }
+        char* next = static_cast<char*>(data);
+        writeFacts([&](const void* piece, size_t pieceSize) {
+            std::memcpy(next, piece, pieceSize);
+            next += pieceSize;
+        });
+        munmap(data, size);
+    }
+
+protected:
+    const std::string segment;
+    int fd;
+};
+
+class WriteFileBinaryFactory : public WriteStreamFactory {
+public:
+    std::unique_ptr<WriteStream> getWriter(const IODirectives& ioDirectives, const SymbolTable& symbolTable,
+            const RecordTable& recordTable) override {
+        return std::make_unique<WriteFileBinary>(ioDirectives, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~WriteFileBinaryFactory() override = default;
+};
+
+class WriteSharedMemoryBinaryFactory : public WriteStreamFactory {
+public:
+    std::unique_ptr<WriteStream> getWriter(const IODirectives& ioDirectives, const SymbolTable& symbolTable,
+            const RecordTable& recordTable) override {
+        return std::make_unique<WriteSharedMemoryBinary>(ioDirectives, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "shm";
+        return name;
+    }
+
+    ~WriteSharedMemoryBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
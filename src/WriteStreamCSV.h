@@ -18,15 +18,18 @@
 #include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "SymbolTable.h"
+#include "Util.h"
 #include "WriteStream.h"
 #ifdef USE_LIBZ
 #include "gzfstream.h"
 #endif
 
 #include <cassert>
+#include <charconv>
 #include <fstream>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
 
 namespace souffle {
@@ -35,10 +38,25 @@ class WriteStreamCSV : public WriteStream {
 protected:
     WriteStreamCSV(
             const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
-            : WriteStream(ioDirectives, symbolTable, recordTable), delimiter(getDelimiter(ioDirectives)){};
+            : WriteStream(ioDirectives, symbolTable, recordTable), delimiter(getDelimiter(ioDirectives)),
+              symbolIds(ioDirectives.has("symbol-ids") && ioDirectives.get("symbol-ids") == "true"){};
 
     const std::string delimiter;
 
+    /** Whether symbols are written as their indices in the symbol table (symbol-ids=true) */
+    const bool symbolIds;
+
+    /** Whether the tuples are appended to the output of a preceding writer (append=true) */
+    static bool isAppending(const IODirectives& ioDirectives) {
+        return ioDirectives.has("append") && ioDirectives.get("append") == "true";
+    }
+
+    /** The mode to open an output file with */
+    static std::ios_base::openmode getOpenMode(const IODirectives& ioDirectives) {
+        const std::ios_base::openmode mode = std::ios::out | std::ios::binary;
+        return isAppending(ioDirectives) ? mode | std::ios::app : mode;
+    }
+
     std::string getDelimiter(const IODirectives& ioDirectives) const {
         if (ioDirectives.has("delimiter")) {
             return ioDirectives.get("delimiter");
@@ -46,38 +64,68 @@ protected:
         return "\t";
     }
 
+    /** The line of the last tuple written by writeNextTupleCSV */
+    std::string line;
+
     void writeNextTupleCSV(std::ostream& destination, const RamDomain* tuple) {
-        writeNextTupleElement(destination, typeAttributes.at(0), tuple[0]);
+        line.clear();
+        formatTuple(line, tuple);
+        destination << line;
+    }
+
+    bool formatsChunks() const override {
+        return true;
+    }
+
+    /** Format a tuple at the end of the destination, without the overhead of a stream per value */
+    void formatTuple(std::string& destination, const RamDomain* tuple) override {
+        formatTupleElement(destination, typeAttributes.at(0), tuple[0]);
 
         for (size_t col = 1; col < arity; ++col) {
-            destination << delimiter;
-            writeNextTupleElement(destination, typeAttributes.at(col), tuple[col]);
+            destination += delimiter;
+            formatTupleElement(destination, typeAttributes.at(col), tuple[col]);
         }
 
-        destination << "\n";
+        destination += '\n';
     }
 
-    void writeNextTupleElement(std::ostream& destination, const std::string& type, RamDomain value) {
+    void formatTupleElement(std::string& destination, const std::string& type, RamDomain value) {
         switch (type[0]) {
             case 's':
-                destination << symbolTable.unsafeResolve(value);
+                if (symbolIds) {
+                    appendInteger(destination, value);
+                } else {
+                    destination += symbolTable.unsafeResolve(value);
+                }
                 break;
             case 'i':
-                destination << value;
+                appendInteger(destination, value);
                 break;
             case 'u':
-                destination << ramBitCast<RamUnsigned>(value);
+                appendInteger(destination, ramBitCast<RamUnsigned>(value));
                 break;
-            case 'f':
-                destination << ramBitCast<RamFloat>(value);
+            case 'f': {
+                char buffer[RAM_FLOAT_CHARS];
+                destination.append(buffer, RamFloatToChars(buffer, ramBitCast<RamFloat>(value)));
                 break;
-            case 'r':
-                outputRecord(destination, value, type);
+            }
+            case 'r': {
+                std::ostringstream record;
+                outputRecord(record, value, type);
+                destination += record.str();
                 break;
+            }
             default:
                 assert(false && "Unsupported type attribute");
         }
     }
+
+    template <typename T>
+    static void appendInteger(std::string& destination, T value) {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        destination.append(buffer, result.ptr);
+    }
 };
 
 class WriteFileCSV : public WriteStreamCSV {
@@ -85,7 +133,7 @@ public:
     WriteFileCSV(
             const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
             : WriteStreamCSV(ioDirectives, symbolTable, recordTable),
-              file(ioDirectives.getFileName(), std::ios::out | std::ios::binary) {
+              file(ioDirectives.getFileName(), getOpenMode(ioDirectives)) {
         if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
             file << ioDirectives.get("attributeNames") << std::endl;
         }
@@ -103,6 +151,10 @@ protected:
     void writeNextTuple(const RamDomain* tuple) override {
         writeNextTupleCSV(file, tuple);
     }
+
+    void writeChunk(const std::string& chunk) override {
+        file.write(chunk.data(), chunk.size());
+    }
 };
 
 #ifdef USE_LIBZ
@@ -111,7 +163,7 @@ public:
     WriteGZipFileCSV(
             const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
             : WriteStreamCSV(ioDirectives, symbolTable, recordTable),
-              file(ioDirectives.getFileName(), std::ios::out | std::ios::binary) {
+              file(ioDirectives.getFileName(), getOpenMode(ioDirectives)) {
         if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
             file << ioDirectives.get("attributeNames") << std::endl;
         }
@@ -128,6 +180,10 @@ protected:
         writeNextTupleCSV(file, tuple);
     }
 
+    void writeChunk(const std::string& chunk) override {
+        file.write(chunk.data(), chunk.size());
+    }
+
     gzfstream::ogzfstream file;
 };
 #endif
@@ -136,7 +192,10 @@ class WriteCoutCSV : public WriteStreamCSV {
 public:
     WriteCoutCSV(
             const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
-            : WriteStreamCSV(ioDirectives, symbolTable, recordTable) {
+            : WriteStreamCSV(ioDirectives, symbolTable, recordTable), framed(!isAppending(ioDirectives)) {
+        if (!framed) {
+            return;
+        }
         std::cout << "---------------\n" << ioDirectives.getRelationName();
         if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
             std::cout << "\n" << ioDirectives.get("attributeNames");
@@ -145,7 +204,9 @@ public:
     }
 
     ~WriteCoutCSV() override {
-        std::cout << "===============\n";
+        if (framed) {
+            std::cout << "===============\n";
+        }
     }
 
 protected:
@@ -156,6 +217,13 @@ protected:
     void writeNextTuple(const RamDomain* tuple) override {
         writeNextTupleCSV(std::cout, tuple);
     }
+
+    void writeChunk(const std::string& chunk) override {
+        std::cout.write(chunk.data(), chunk.size());
+    }
+
+    /** Appended tuples continue the output of the preceding writer without a frame of their own */
+    const bool framed;
 };
 
 class WriteCoutPrintSize : public WriteStream {
@@ -0,0 +1,190 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamParquet.h
+ *
+ * Writes relations to Apache Parquet files, one column per attribute.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include "SymbolTable.h"
+#include "Util.h"
+#include "WriteStream.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
+
+namespace souffle {
+
+/**
+ * Numbers are stored in columns of the matching Arrow types, and symbols in string
+ * columns, which Parquet encodes by a dictionary per column chunk. Tuples are
+ * collected into row groups of row-group-size rows (by default 2^20).
+ */
+class WriteFileParquet : public WriteStream {
+public:
+    WriteFileParquet(
+            const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
+            : WriteStream(ioDirectives, symbolTable, recordTable), fileName(ioDirectives.getFileName()),
+              rowGroupSize(ioDirectives.has("row-group-size") ? std::stoul(ioDirectives.get("row-group-size"))
+                                                              : 1 << 20) {
+        if (arity == 0) {
+            throw std::invalid_argument("Parquet IO does not support nullary relations in " + fileName);
+        }
+        std::vector<std::string> names;
+        if (ioDirectives.has("attributeNames")) {
+            const char delimiter = ioDirectives.has("delimiter") ? ioDirectives.get("delimiter")[0] : '\t';
+            names = splitString(ioDirectives.get("attributeNames"), delimiter);
+        }
+
+        arrow::FieldVector fields;
+        for (size_t col = 0; col < arity; ++col) {
+            std::shared_ptr<arrow::DataType> type;
+            switch (typeAttributes[col][0]) {
+                case 'i':
+                    type = arrow::CTypeTraits<RamSigned>::type_singleton();
+                    builders.push_back(std::make_unique<SignedBuilder>());
+                    break;
+                case 'u':
+                    type = arrow::CTypeTraits<RamUnsigned>::type_singleton();
+                    builders.push_back(std::make_unique<UnsignedBuilder>());
+                    break;
+                case 'f':
+                    type = arrow::CTypeTraits<RamFloat>::type_singleton();
+                    builders.push_back(std::make_unique<FloatBuilder>());
+                    break;
+                case 's':
+                    type = arrow::utf8();
+                    builders.push_back(std::make_unique<arrow::StringBuilder>());
+                    break;
+                default:
+                    throw std::invalid_argument("Parquet IO does not support records in " + fileName);
+            }
+            const std::string name = col < names.size() ? names[col] : "a" + std::to_string(col);
+            fields.push_back(arrow::field(name, type, false));
+        }
+        schema = arrow::schema(fields);
+
+        std::shared_ptr<arrow::io::FileOutputStream> output;
+        PARQUET_ASSIGN_OR_THROW(output, arrow::io::FileOutputStream::Open(fileName));
+        PARQUET_ASSIGN_OR_THROW(
+                writer, parquet::arrow::FileWriter::Open(*schema, arrow::default_memory_pool(), output));
+        reserveRowGroup();
+    }
+
+    /** The last row group is written and the file closed once all tuples are known */
+    ~WriteFileParquet() override {
+        try {
+            writeRowGroup();
+            PARQUET_THROW_NOT_OK(writer->Close());
+        } catch (std::exception& e) {
+            std::cerr << "Error writing Parquet file " << fileName << ": " << e.what() << "\n";
+        }
+    }
+
+protected:
+    using SignedBuilder = arrow::NumericBuilder<arrow::CTypeTraits<RamSigned>::ArrowType>;
+    using UnsignedBuilder = arrow::NumericBuilder<arrow::CTypeTraits<RamUnsigned>::ArrowType>;
+    using FloatBuilder = arrow::NumericBuilder<arrow::CTypeTraits<RamFloat>::ArrowType>;
+
+    void writeNullary() override {
+        assert(false && "attempting to write a nullary relation to a Parquet file");
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        for (size_t col = 0; col < arity; ++col) {
+            arrow::ArrayBuilder* builder = builders[col].get();
+            switch (typeAttributes[col][0]) {
+                case 'i':
+                    static_cast<SignedBuilder*>(builder)->UnsafeAppend(tuple[col]);
+                    break;
+                case 'u':
+                    static_cast<UnsignedBuilder*>(builder)->UnsafeAppend(ramBitCast<RamUnsigned>(tuple[col]));
+                    break;
+                case 'f':
+                    static_cast<FloatBuilder*>(builder)->UnsafeAppend(ramBitCast<RamFloat>(tuple[col]));
+                    break;
+                case 's':
+                    PARQUET_THROW_NOT_OK(static_cast<arrow::StringBuilder*>(builder)->Append(
+                            symbolTable.unsafeResolve(tuple[col])));
+                    break;
+            }
+        }
+        if (++numRows == rowGroupSize) {
+            writeRowGroup();
+            reserveRowGroup();
+        }
+    }
+
+    /** Reserve the numeric columns of a row group, such that values can be appended unchecked */
+    void reserveRowGroup() {
+        for (auto& builder : builders) {
+            PARQUET_THROW_NOT_OK(builder->Reserve(rowGroupSize));
+        }
+    }
+
+    /** Write the collected tuples as a row group */
+    void writeRowGroup() {
+        if (numRows == 0) {
+            return;
+        }
+        arrow::ArrayVector columns;
+        for (auto& builder : builders) {
+            std::shared_ptr<arrow::Array> column;
+            PARQUET_THROW_NOT_OK(builder->Finish(&column));
+            columns.push_back(std::move(column));
+        }
+        const auto table = arrow::Table::Make(schema, columns, numRows);
+        PARQUET_THROW_NOT_OK(writer->WriteTable(*table, numRows));
+        numRows = 0;
+    }
+
+    const std::string fileName;
+
+    /** Maximal number of rows of a row group */
+    const size_t rowGroupSize;
+
+    std::shared_ptr<arrow::Schema> schema;
+    std::unique_ptr<parquet::arrow::FileWriter> writer;
+
+    /** The columns of the current row group */
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+    size_t numRows = 0;
+};
+
+class WriteFileParquetFactory : public WriteStreamFactory {
+public:
+    std::unique_ptr<WriteStream> getWriter(const IODirectives& ioDirectives, const SymbolTable& symbolTable,
+            const RecordTable& recordTable) override {
+        return std::make_unique<WriteFileParquet>(ioDirectives, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "parquet";
+        return name;
+    }
+
+    ~WriteFileParquetFactory() override = default;
+};
+
+} /* namespace souffle */
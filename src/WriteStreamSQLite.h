@@ -18,10 +18,14 @@
 #include "SymbolTable.h"
 #include "WriteStream.h"
 
+#include <algorithm>
+#include <iostream>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <sqlite3.h>
 
@@ -32,15 +36,26 @@ public:
     WriteStreamSQLite(
             const IODirectives& ioDirectives, const SymbolTable& symbolTable, const RecordTable& recordTable)
             : WriteStream(ioDirectives, symbolTable, recordTable), dbFilename(ioDirectives.get("dbname")),
-              relationName(ioDirectives.getRelationName()) {
+              relationName(ioDirectives.getRelationName()),
+              commitSize(ioDirectives.has("commit-size") ? std::stoul(ioDirectives.get("commit-size"))
+                                                         : defaultCommitSize) {
         openDB();
         createTables();
         prepareStatements();
-        //        executeSQL("BEGIN TRANSACTION", db);
+        executeSQL("BEGIN TRANSACTION", db);
     }
 
+    /** The buffered tuples and the view are written and the last transaction is committed */
     ~WriteStreamSQLite() override {
+        try {
+            insertBufferedRows();
+            createRelationView();
+            executeSQL("COMMIT", db);
+        } catch (const std::exception& e) {
+            std::cerr << e.what();
+        }
         sqlite3_finalize(insertStatement);
+        sqlite3_finalize(bulkInsertStatement);
         sqlite3_finalize(symbolInsertStatement);
         sqlite3_finalize(symbolSelectStatement);
         sqlite3_close(db);
@@ -61,20 +76,22 @@ protected:
                     value = tuple[i];
                     break;
             }
+            buffer[bufferedRows * arity + i] = value;
+        }
 
-#if RAM_DOMAIN_SIZE == 64
-            if (sqlite3_bind_int64(insertStatement, i + 1, value) != SQLITE_OK) {
-#else
-            if (sqlite3_bind_int(insertStatement, i + 1, value) != SQLITE_OK) {
-#endif
-                throwError("SQLite error in sqlite3_bind_text: ");
-            }
+        // insert the buffered tuples with a single statement once the buffer is full
+        if (++bufferedRows == rowsPerInsert) {
+            insertRows(bulkInsertStatement, buffer.data(), rowsPerInsert);
+            bufferedRows = 0;
         }
-        if (sqlite3_step(insertStatement) != SQLITE_DONE) {
-            throwError("SQLite error in sqlite3_step: ");
+
+        // start a new transaction after every commitSize tuples
+        if (++uncommittedRows == commitSize) {
+            insertBufferedRows();
+            executeSQL("COMMIT", db);
+            executeSQL("BEGIN TRANSACTION", db);
+            uncommittedRows = 0;
         }
-        sqlite3_clear_bindings(insertStatement);
-        sqlite3_reset(insertStatement);
     }
 
 private:
@@ -100,9 +117,34 @@ private:
         throw std::invalid_argument(error.str());
     }
 
+    /** Bind the given rows of values to a statement inserting that many rows and execute it */
+    void insertRows(sqlite3_stmt* statement, const RamDomain* values, size_t rows) {
+        for (size_t i = 0; i < rows * arity; i++) {
+#if RAM_DOMAIN_SIZE == 64
+            if (sqlite3_bind_int64(statement, i + 1, values[i]) != SQLITE_OK) {
+#else
+            if (sqlite3_bind_int(statement, i + 1, values[i]) != SQLITE_OK) {
+#endif
+                throwError("SQLite error in sqlite3_bind_text: ");
+            }
+        }
+        if (sqlite3_step(statement) != SQLITE_DONE) {
+            throwError("SQLite error in sqlite3_step: ");
+        }
+        sqlite3_reset(statement);
+    }
+
+    /** Insert the rows left in the buffer one by one */
+    void insertBufferedRows() {
+        for (size_t row = 0; row < bufferedRows; row++) {
+            insertRows(insertStatement, &buffer[row * arity], 1);
+        }
+        bufferedRows = 0;
+    }
+
     uint64_t getSymbolTableIDFromDB(int index) {
         if (sqlite3_bind_text(symbolSelectStatement, 1, symbolTable.unsafeResolve(index).c_str(), -1,
-                    SQLITE_TRANSIENT) != SQLITE_OK) {
+                    SQLITE_STATIC) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_bind_text: ");
         }
         if (sqlite3_step(symbolSelectStatement) != SQLITE_ROW) {
@@ -114,18 +156,21 @@ private:
         return rowid;
     }
     uint64_t getSymbolTableID(int index) {
-        if (dbSymbolTable.count(index) != 0) {
-            return dbSymbolTable[index];
+        auto pos = dbSymbolTable.find(index);
+        if (pos != dbSymbolTable.end()) {
+            return pos->second;
         }
 
         if (sqlite3_bind_text(symbolInsertStatement, 1, symbolTable.unsafeResolve(index).c_str(), -1,
-                    SQLITE_TRANSIENT) != SQLITE_OK) {
+                    SQLITE_STATIC) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_bind_text: ");
         }
-        // Either the insert succeeds and we have a new row id or it already exists and a select is needed.
-        uint64_t rowid;
         if (sqlite3_step(symbolInsertStatement) != SQLITE_DONE) {
-            // The symbol already exists so select it.
+            throwError("SQLite error in sqlite3_step: ");
+        }
+        // Either the insert added a new row or the symbol already exists and a select is needed.
+        uint64_t rowid;
+        if (sqlite3_changes(db) == 0) {
             rowid = getSymbolTableIDFromDB(index);
         } else {
             rowid = sqlite3_last_insert_rowid(db);
@@ -142,18 +187,26 @@ private:
             throwError("SQLite error in sqlite3_open");
         }
         sqlite3_extended_result_codes(db, 1);
+        // other writers of the database hold their transaction until they are done
+        sqlite3_busy_timeout(db, std::numeric_limits<int>::max());
         executeSQL("PRAGMA synchronous = OFF", db);
         executeSQL("PRAGMA journal_mode = MEMORY", db);
     }
 
     void prepareStatements() {
-        prepareInsertStatement();
+        // insert as many rows per statement as the limit of bound variables admits
+        const size_t maxVariables = sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+        const size_t maxRows = maxVariables / std::max<size_t>(1, arity);
+        rowsPerInsert = std::max<size_t>(1, std::min(maxRowsPerInsert, maxRows));
+        buffer.resize(rowsPerInsert * arity);
+        insertStatement = prepareInsertStatement(1);
+        bulkInsertStatement = prepareInsertStatement(rowsPerInsert);
         prepareSymbolInsertStatement();
         prepareSymbolSelectStatement();
     }
     void prepareSymbolInsertStatement() {
         std::stringstream insertSQL;
-        insertSQL << "INSERT INTO " << symbolTableName;
+        insertSQL << "INSERT OR IGNORE INTO " << symbolTableName;
         insertSQL << " VALUES(null,@V0);";
         const char* tail = nullptr;
         if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &symbolInsertStatement, &tail) != SQLITE_OK) {
@@ -171,23 +224,28 @@ private:
         }
     }
 
-    void prepareInsertStatement() {
+    sqlite3_stmt* prepareInsertStatement(size_t rows) {
         std::stringstream insertSQL;
         insertSQL << "INSERT INTO '_" << relationName << "' VALUES ";
-        insertSQL << "(@V0";
-        for (unsigned int i = 1; i < arity; i++) {
-            insertSQL << ",@V" << i;
+        for (size_t row = 0; row < rows; row++) {
+            insertSQL << (row == 0 ? "(" : ",(");
+            for (unsigned int i = 0; i < arity; i++) {
+                insertSQL << (i == 0 ? "?" : ",?");
+            }
+            insertSQL << ")";
         }
-        insertSQL << ");";
+        insertSQL << ";";
+        sqlite3_stmt* statement = nullptr;
         const char* tail = nullptr;
-        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &insertStatement, &tail) != SQLITE_OK) {
+        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &statement, &tail) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_prepare_v2: ");
         }
+        return statement;
     }
 
+    /** The view is only created once the tuples are loaded */
     void createTables() {
         createRelationTable();
-        createRelationView();
         createSymbolTable();
     }
 
@@ -248,12 +306,26 @@ private:
         executeSQL(createTableText.str(), db);
     }
 
-    const std::string& dbFilename;
-    const std::string& relationName;
+    /** Default number of tuples written per transaction */
+    static constexpr size_t defaultCommitSize = 1000000;
+
+    /** Largest number of rows inserted by a single statement */
+    static constexpr size_t maxRowsPerInsert = 256;
+
+    const std::string dbFilename;
+    const std::string relationName;
     const std::string symbolTableName = "__SymbolTable";
+    const size_t commitSize;
+
+    /** The values of the tuples not inserted yet, with symbols replaced by their row ids */
+    std::vector<RamDomain> buffer;
+    size_t bufferedRows = 0;
+    size_t rowsPerInsert = 1;
+    size_t uncommittedRows = 0;
 
     std::unordered_map<uint64_t, uint64_t> dbSymbolTable;
     sqlite3_stmt* insertStatement = nullptr;
+    sqlite3_stmt* bulkInsertStatement = nullptr;
     sqlite3_stmt* symbolInsertStatement = nullptr;
     sqlite3_stmt* symbolSelectStatement = nullptr;
     sqlite3* db = nullptr;
@@ -15,8 +15,13 @@
 
 #pragma once
 
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <zlib.h>
 
@@ -26,6 +31,13 @@ namespace gzfstream {
 
 namespace internal {
 
+/**
+ * A stream buffer for gzip files.
+ *
+ * Output is cut into blocks that are deflated in parallel, each into an independent gzip member;
+ * the concatenation of the members is a valid gzip file. Input is inflated by a background thread
+ * that reads the next chunk while the current one is consumed.
+ */
 class gzfstreambuf : public std::streambuf {
 public:
     gzfstreambuf() {
@@ -46,11 +58,20 @@ public:
         }
 
         this->mode = mode;
-        std::string gzmode((mode & std::ios::in) != 0 ? "rb" : "wb");
-        fileHandle = gzopen(filename.c_str(), gzmode.c_str());
-
-        if (fileHandle == nullptr) {
-            return nullptr;
+        if ((mode & std::ios::in) != 0) {
+            fileHandle = gzopen(filename.c_str(), "rb");
+            if (fileHandle == nullptr) {
+                return nullptr;
+            }
+            gzbuffer(fileHandle, readChunkSize);
+            readBuffer.resize(reserveSize + readChunkSize);
+            aheadBuffer.resize(reserveSize + readChunkSize);
+        } else {
+            // appended output becomes further members of the file
+            outputFile = std::fopen(filename.c_str(), (mode & std::ios::app) != 0 ? "ab" : "wb");
+            if (outputFile == nullptr) {
+                return nullptr;
+            }
         }
         isOpen = true;
 
@@ -59,9 +80,18 @@ public:
 
     gzfstreambuf* close() {
         if (is_open()) {
-            sync();
             isOpen = false;
-            if (gzclose(fileHandle) == Z_OK) {
+            if ((mode & std::ios::in) != 0) {
+                if (readAhead.valid()) {
+                    readAhead.wait();
+                }
+                if (gzclose(fileHandle) == Z_OK) {
+                    return this;
+                }
+                return nullptr;
+            }
+            const bool written = sync() == 0 && writeMembers(pending.size());
+            if (std::fclose(outputFile) == 0 && written) {
                 return this;
             }
         }
@@ -90,11 +120,9 @@ protected:
             *pptr() = c;
             pbump(1);
         }
-        int toWrite = pptr() - pbase();
-        if (gzwrite(fileHandle, pbase(), toWrite) != toWrite) {
+        if (sync() != 0) {
             return EOF;
         }
-        pbump(-toWrite);
 
         return c;
     }
@@ -106,40 +134,112 @@ protected:
         if ((gptr() != nullptr) && (gptr() < egptr())) {
             return traits_type::to_int_type(*gptr());
         }
-
-        unsigned charsPutBack = gptr() - eback();
-        if (charsPutBack > reserveSize) {
-            charsPutBack = reserveSize;
+        if (endOfFile) {
+            return EOF;
         }
-        memcpy(buffer + reserveSize - charsPutBack, gptr() - charsPutBack, charsPutBack);
 
-        int charsRead = gzread(fileHandle, buffer + reserveSize, bufferSize - reserveSize);
+        if (!readAhead.valid()) {
+            startReadAhead();
+        }
+        int charsRead = readAhead.get();
         if (charsRead <= 0) {
+            endOfFile = true;
             return EOF;
         }
 
-        setg(buffer + reserveSize - charsPutBack, buffer + reserveSize, buffer + reserveSize + charsRead);
+        unsigned charsPutBack = gptr() - eback();
+        if (charsPutBack > reserveSize) {
+            charsPutBack = reserveSize;
+        }
+        memcpy(aheadBuffer.data() + reserveSize - charsPutBack, gptr() - charsPutBack, charsPutBack);
+        std::swap(readBuffer, aheadBuffer);
+
+        char* start = readBuffer.data() + reserveSize;
+        setg(start - charsPutBack, start, start + charsRead);
+        startReadAhead();
 
         return traits_type::to_int_type(*gptr());
     }
 
+    /**
+     * Only complete batches of blocks are compressed, so that flushing the stream does not cut the
+     * output into small members; the remainder is written when the file is closed.
+     */
     int sync() override {
         if ((pptr() != nullptr) && pptr() > pbase()) {
-            int toWrite = pptr() - pbase();
-            if (gzwrite(fileHandle, pbase(), toWrite) != toWrite) {
-                return -1;
-            }
-            pbump(-toWrite);
+            pending.append(pbase(), pptr());
+            pbump(-(pptr() - pbase()));
+        }
+        const size_t batchSize = blockSize * MAX_THREADS;
+        if (pending.size() >= batchSize && !writeMembers(pending.size() / batchSize * batchSize)) {
+            return -1;
         }
         return 0;
     }
 
 private:
+    /** Inflate the next chunk of the input in the background */
+    void startReadAhead() {
+        readAhead = TaskPool::instance().submit(
+                [this]() { return gzread(fileHandle, aheadBuffer.data() + reserveSize, readChunkSize); });
+    }
+
+    /** Deflate the given block into a gzip member; fails with an empty member */
+    static std::string compressBlock(const char* data, size_t size) {
+        z_stream stream = {};
+        // a window of 15 bits plus 16 selects the gzip format
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return "";
+        }
+        std::string member(deflateBound(&stream, size), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = size;
+        stream.next_out = reinterpret_cast<Bytef*>(&member[0]);
+        stream.avail_out = member.size();
+        const bool finished = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+        member.resize(finished ? stream.total_out : 0);
+        deflateEnd(&stream);
+        return member;
+    }
+
+    /** Compress the first size bytes of the pending output in parallel and write them in order */
+    bool writeMembers(size_t size) {
+        // an empty file still needs a member to be a valid gzip file
+        const size_t numBlocks = size == 0 && !hasMembers ? 1 : (size + blockSize - 1) / blockSize;
+        std::vector<std::string> members(numBlocks);
+        PARALLEL_START_IF(numBlocks > 1)
+            ;
+            pfor(size_t i = 0; i < numBlocks; i++) {
+                const size_t offset = i * blockSize;
+                members[i] = compressBlock(pending.data() + offset, std::min(blockSize, size - offset));
+            }
+        PARALLEL_END
+        pending.erase(0, size);
+        for (const auto& member : members) {
+            if (member.empty() || std::fwrite(member.data(), 1, member.size(), outputFile) != member.size()) {
+                return false;
+            }
+        }
+        hasMembers = true;
+        return true;
+    }
+
     static constexpr unsigned int bufferSize = 65536;
     static constexpr unsigned int reserveSize = 16;
+    /** Size of the input blocks compressed into independent members */
+    static constexpr size_t blockSize = 1 << 20;
+    /** Size of the chunks inflated ahead of the reader */
+    static constexpr unsigned int readChunkSize = 1 << 18;
 
     char buffer[bufferSize] = {};
     gzFile fileHandle = {};
+    std::FILE* outputFile = nullptr;
+    std::string pending;
+    bool hasMembers = false;
+    std::vector<char> readBuffer;
+    std::vector<char> aheadBuffer;
+    TaskPool::Task<int> readAhead;
+    bool endOfFile = false;
     bool isOpen = false;
     std::ios_base::openmode mode = std::ios_base::in;
 };
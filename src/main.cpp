@@ -16,6 +16,7 @@
 
 #include "AstComponentChecker.h"
 #include "AstPragmaChecker.h"
+#include "AstProfileUse.h"
 #include "AstSemanticChecker.h"
 #include "AstTransforms.h"
 #include "AstTranslationUnit.h"
@@ -27,21 +28,32 @@
 #include "ErrorReport.h"
 #include "Explain.h"
 #include "Global.h"
+#include "IODirectives.h"
 #include "InterpreterEngine.h"
 #include "InterpreterProgInterface.h"
+#include "ParallelUtils.h"
 #include "ParserDriver.h"
+#include "PhaseTimes.h"
 #include "PrecedenceGraph.h"
+#include "ProgramServer.h"
+#include "RamBaseAnalysis.h"
 #include "RamIndexAnalysis.h"
 #include "RamLevelAnalysis.h"
 #include "RamProgram.h"
+#include "RamProgramCache.h"
+#include "RamStatement.h"
 #include "RamTransformer.h"
 #include "RamTransforms.h"
 #include "RamTranslationUnit.h"
 #include "RamTypes.h"
+#include "RamVisitor.h"
+#include "ResourceLimits.h"
+#include "SymbolDictionary.h"
 #include "SymbolTable.h"
 #include "Synthesiser.h"
 #include "Util.h"
 #include "config.h"
+#include "profile/LiveEndpoint.h"
 #include "profile/Tui.h"
 #include <cassert>
 #include <chrono>
@@ -51,17 +63,21 @@
 #include <iostream>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <thread>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <utility>
 #include <vector>
 
 namespace souffle {
 /**
- * Executes a binary file.
+ * Executes a binary file, removing it and the given generated sources afterwards unless the
+ * binary is kept, as the dl-program or as the cached binary of a tiered program.
  */
-void executeBinary(const std::string& binaryFilename) {
+void executeBinary(const std::string& binaryFilename, const std::vector<std::string>& sourceFilenames) {
     assert(!binaryFilename.empty() && "binary filename cannot be blank");
 
     // check whether the executable exists
@@ -81,9 +97,11 @@ void executeBinary(const std::string& binaryFilename) {
 
     int exitCode = system(binaryFilename.c_str());
 
-    if (Global::config().get("dl-program").empty()) {
+    if (Global::config().get("dl-program").empty() && !Global::config().has("tiered")) {
         remove(binaryFilename.c_str());
-        remove((binaryFilename + ".cpp").c_str());
+        for (const std::string& sourceFilename : sourceFilenames) {
+            remove(sourceFilename.c_str());
+        }
     }
 
     // exit with same code as executable
@@ -93,9 +111,9 @@ void executeBinary(const std::string& binaryFilename) {
 }
 
 /**
- * Compiles the given source file to a binary file.
+ * Compiles the given source files to a binary file.
  */
-void compileToBinary(std::string compileCmd, const std::string& sourceFilename) {
+void compileToBinary(std::string compileCmd, const std::vector<std::string>& sourceFilenames) {
     // add source code
     compileCmd += ' ';
     for (const std::string& path : splitString(Global::config().get("library-dir"), ' ')) {
@@ -113,14 +131,208 @@ void compileToBinary(std::string compileCmd, const std::string& sourceFilename)
         compileCmd += "-l" + library + ' ';
     }
 
-    compileCmd += sourceFilename;
+    const std::string sources = toString(join(sourceFilenames, " "));
+    compileCmd += sources;
 
     // run executable
     if (system(compileCmd.c_str()) != 0) {
-        throw std::invalid_argument("failed to compile C++ source <" + sourceFilename + ">");
+        throw std::invalid_argument("failed to compile C++ source <" + sources + ">");
+    }
+}
+
+/**
+ * Reads a source file that is not pre-processed. The source is prefixed by a line marker, such that
+ * locations refer to the file, and must not contain pre-processor directives, as the scanner skips them.
+ */
+std::string readSource(const std::string& fileName) {
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("failed to open " + fileName);
+    }
+    std::string code = "#line 1 \"" + fileName + "\"\n";
+    const std::size_t begin = code.size();
+    code.append(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    // a directive is the first token of its line
+    for (std::size_t line = begin; line < code.size();) {
+        const std::size_t first = code.find_first_not_of(" \t", line);
+        if (first != std::string::npos && code[first] == '#') {
+            throw std::runtime_error(fileName + " contains pre-processor directives, hence cannot be parsed "
+                                                "without the pre-processor");
+        }
+        const std::size_t end = code.find('\n', line);
+        line = (end == std::string::npos) ? code.size() : end + 1;
+    }
+    return code;
+}
+
+/**
+ * Checks that the query inputs of a served program are input relations, such that they are not removed as
+ * empty relations.
+ */
+void checkQueryInputs(const RamProgram& program) {
+    std::set<std::string> inputs;
+    visitDepthFirst(
+            program.getMain(), [&](const RamLoad& load) { inputs.insert(load.getRelation().getName()); });
+    for (const std::string& name : splitString(Global::config().get("query-inputs"), ',')) {
+        if (!name.empty() && inputs.count(name) == 0) {
+            throw std::runtime_error("Query input " + name + " is not an input relation");
+        }
     }
 }
 
+/**
+ * Executes a RAM program with the interpreter, runs the explain interface if provenance is enabled, and
+ * serves the queries on the program if a server is requested.
+ */
+void interpret(RamTranslationUnit& ramTranslationUnit) {
+    checkQueryInputs(ramTranslationUnit.getProgram());
+    TaskPool::Task<void> profiler;
+    // Start up profiler if needed
+    if (Global::config().has("live-profile") && !Global::config().has("compile")) {
+        profiler = TaskPool::instance().submitService([]() { profile::Tui().runProf(); });
+    }
+    std::unique_ptr<profile::LiveEndpoint> endpoint;
+    if (Global::config().has("profile-endpoint")) {
+        endpoint = std::make_unique<profile::LiveEndpoint>(Global::config().get("profile-endpoint"));
+    }
+
+    // configure and execute interpreter
+    std::unique_ptr<InterpreterEngine> interpreter(std::make_unique<InterpreterEngine>(ramTranslationUnit));
+    if (Global::config().has("symbol-table")) {
+        seedSymbolTable(interpreter->getSymbolTable(), Global::config().get("symbol-table"));
+    }
+    interpreter->executeMain();
+    if (Global::config().has("symbol-table")) {
+        saveSymbolTable(interpreter->getSymbolTable(), Global::config().get("symbol-table"));
+    }
+    endpoint = nullptr;
+    // If the profiler was started, join back here once it exits.
+    if (profiler.valid()) {
+        profiler.wait();
+    }
+    if (Global::config().has("provenance")) {
+        // Test for bugged combination of provenance, interpreted souffle, and concurrency
+        if (Global::config().get("jobs") != "1") {
+            throw std::runtime_error("Provenance is not supported with parallel interpreted mode");
+        }
+
+        // only run explain interface if interpreted
+        InterpreterProgInterface interface(*interpreter);
+        if (Global::config().get("provenance") == "explain" ||
+                Global::config().get("provenance") == "subtreeHeights") {
+            explain(interface, false, Global::config().get("provenance") == "subtreeHeights");
+        } else if (Global::config().get("provenance") == "explore") {
+            explain(interface, true, false);
+        }
+    }
+    // the relations not depending on the query inputs are kept while the queries are evaluated
+    if (Global::config().has("serve")) {
+        InterpreterProgInterface interface(*interpreter);
+        const auto* analysis = ramTranslationUnit.getAnalysis<RamBaseAnalysis>();
+        std::vector<std::string> base;
+        for (const std::string& name : analysis->getBaseRelations()) {
+            if (interface.getRelation(name) != nullptr) {
+                base.push_back(name);
+            }
+        }
+        interface.setBaseRelations(base);
+        ProgramServer(interface, Global::config().get("serve")).serve();
+    }
+}
+
+/**
+ * The time of an interpreted evaluation of a tiered program from which on the program is compiled in
+ * the background, such that later runs execute the compiled binary.
+ */
+constexpr double TIER_UP_SECONDS = 1.0;
+
+/**
+ * Executes a RAM program of a tiered run with the interpreter, and compiles the C++ code of the program
+ * into the given binary in a detached background process if the evaluation took longer than
+ * TIER_UP_SECONDS. The code is cached next to the binary. It is generated before the evaluation, which
+ * adds the symbols of the inputs to the symbol table, unless an earlier run has cached it already.
+ */
+void interpretTiered(RamTranslationUnit& ramTranslationUnit, const std::string& binaryFilename,
+        const std::string& souffleExecutable) {
+    const std::string sourceFilename = binaryFilename + ".cpp";
+    if (!existFile(sourceFilename)) {
+        // the code is written under a name of this process, and moved into place once it is complete
+        const std::string tempFilename = binaryFilename + "_" + std::to_string(getpid()) + ".cpp";
+        bool withSharedLibrary;
+        std::ofstream os(tempFilename);
+        Synthesiser(ramTranslationUnit)
+                .generateCode(os, identifier(simpleName(binaryFilename)), withSharedLibrary);
+        os.close();
+        if (rename(tempFilename.c_str(), sourceFilename.c_str()) != 0) {
+            remove(tempFilename.c_str());
+            throw std::runtime_error("failed to cache the C++ code of " + binaryFilename);
+        }
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    interpret(ramTranslationUnit);
+    const auto end = std::chrono::high_resolution_clock::now();
+    if (std::chrono::duration<double>(end - start).count() < TIER_UP_SECONDS) {
+        return;
+    }
+
+    std::string compileCmd = ::findTool("souffle-compile", souffleExecutable, ".");
+    if (!isExecutable(compileCmd)) {
+        throw std::runtime_error("failed to locate souffle-compile");
+    }
+    // the code calls user-defined functors of a shared library, as decided by Synthesiser::generateCode
+    bool withSharedLibrary = false;
+    visitDepthFirst(ramTranslationUnit.getProgram(),
+            [&](const RamUserDefinedOperator&) { withSharedLibrary = true; });
+    if (withSharedLibrary) {
+        if (!Global::config().has("libraries")) {
+            Global::config().set("libraries", "functors");
+        }
+        if (!Global::config().has("library-dir")) {
+            Global::config().set("library-dir", ".");
+        }
+    }
+    if (Global::config().has("verbose")) {
+        std::cout << "Compiling " << binaryFilename << " in the background" << std::endl;
+    }
+    std::cout.flush();
+    std::cerr.flush();
+
+    // the compilation runs in a grandchild, which outlives this process and is not waited for
+    const pid_t child = fork();
+    if (child < 0) {
+        throw std::runtime_error("failed to fork the compilation of " + binaryFilename);
+    }
+    if (child > 0) {
+        waitpid(child, nullptr, 0);
+        return;
+    }
+    setsid();
+    if (fork() != 0) {
+        _exit(0);
+    }
+    if (freopen("/dev/null", "w", stdout) == nullptr || freopen("/dev/null", "w", stderr) == nullptr) {
+        _exit(1);
+    }
+
+    // the binary is compiled under a name of this process, and moved into place once it is complete
+    const std::string baseFilename = binaryFilename + "_" + std::to_string(getpid());
+    int status = 1;
+    if (link(sourceFilename.c_str(), (baseFilename + ".cpp").c_str()) == 0) {
+        try {
+            compileToBinary(compileCmd, {baseFilename + ".cpp"});
+            if (rename(baseFilename.c_str(), binaryFilename.c_str()) == 0) {
+                status = 0;
+            }
+        } catch (std::exception&) {
+        }
+        remove(baseFilename.c_str());
+        remove((baseFilename + ".cpp").c_str());
+    }
+    _exit(status);
+}
+
 int main(int argc, char** argv) {
     /* Time taking for overall runtime */
     auto souffle_start = std::chrono::high_resolution_clock::now();
@@ -153,8 +365,111 @@ int main(int argc, char** argv) {
                 {"output-dir", 'D', "DIR", ".", false,
                         "Specify directory for output files (if <DIR> is -, stdout is used)."},
                 {"jobs", 'j', "N", "1", false,
-                        "Run interpreter/compiler in parallel using N threads, N=auto for system "
-                        "default."},
+                        "Run interpreter/compiler in parallel using N threads, N=auto for the processors "
+                        "available, bounded by the CPU quota of a container."},
+                {"stratum-jobs", '\6', "N", "", false,
+                        "Evaluate independent strata, the relations of recursive strata, inputs and outputs "
+                        "concurrently using at most N threads per stratum, N=0 to share the threads evenly."},
+                {"tail-threshold", '\177', "N", "", false,
+                        "Evaluate the iterations of recursive strata whose delta relations all have fewer "
+                        "than N tuples sequentially in the interpreter, without forking threads."},
+                {"thread-binding", '\10', "[ none | close | spread ]", "", false,
+                        "Pin the evaluation threads to the cores, filling one NUMA node after the other "
+                        "(close) or distributing them round robin across the nodes (spread)."},
+                {"insert-buffers", '\11', "", "", false,
+                        "Buffer the insertions of parallel rules in each thread, merging them into the "
+                        "relations at the end of the rule."},
+                {"adaptive-joins", '\12', "", "", false,
+                        "Evaluate recursive rules with the cheapest of several join orders, chosen at each "
+                        "iteration from the current relation sizes."},
+                {"incremental", '\13', "", "", false,
+                        "Generate an update of the computed relations for insertions into and removals from "
+                        "the input relations, evaluating the consequences of the changes only."},
+                {"checkpoint", '\14', "FILE", "", false,
+                        "Record the state of the program in <FILE> after each stratum, and resume from the "
+                        "last completed stratum recorded in an existing <FILE>."},
+                {"lazy-indexes", '\15', "", "", false,
+                        "Build the secondary indexes of a relation right before the first stratum using "
+                        "them, and drop them after the last stratum using them."},
+                {"freeze-relations", '\176', "", "", false,
+                        "Pack the b-tree indexes of a relation into full, adjacent nodes after the last "
+                        "stratum writing it, if later strata read it."},
+                {"front-coding", '\175', "", "", false,
+                        "Front code the tuples of relations of eight or more columns in the interpreter, "
+                        "encoding each tuple by its differences to the preceding one."},
+                {"prune-inputs", '\173', "", "", false,
+                        "Filter the input relations read from CSV by the constants all their atoms "
+                        "give a column, and drop the columns of input relations no atom binds, while "
+                        "reading them."},
+                {"free-relations", '\16', "", "", false,
+                        "Free each relation after the last stratum using it, freeing the output relations "
+                        "once they are written."},
+                {"memory-budget", '\34', "MB", "", false,
+                        "Spill the b-tree relations of the interpreter to disk once their buffered tuples "
+                        "exceed MB mebibytes, keeping sorted runs of their tuples in temporary files. "
+                        "MB=auto for half the memory limit of a container or the physical memory."},
+                {"memory-limit", '\174', "SIZE", "", false,
+                        "Keep the resident memory of the interpreter below SIZE, e.g. 64G, in mebibytes "
+                        "without a K, M, G or T suffix, by packing, spilling and dropping the indexes of "
+                        "relations once it nears the limit."},
+                {"spill-dir", '\35', "DIR", "", false,
+                        "Create the files of relations spilled to disk in <DIR>, the temporary directory "
+                        "by default. Applies to --memory-budget and relations qualified as external."},
+                {"distributed", '\36', "", "", false,
+                        "Distribute the evaluation of the interpreter across the ranks of an MPI job, "
+                        "partitioning the outermost scan of each rule and exchanging the derived tuples."},
+                {"share-join-prefixes", '\20', "", "", false,
+                        "Evaluate the leading atoms shared by several rules once, materialising their join "
+                        "into an auxiliary relation."},
+                {"symbol-table", '\21', "FILE", "", false,
+                        "Pre-seed the symbol table from the dictionary <FILE> of an earlier run, if it "
+                        "exists, and record the symbol table in <FILE> once the program has run."},
+                {"split-units", '\22', "", "", false,
+                        "Split the generated C++ code into a translation unit per stratum, such that the "
+                        "units are compiled in parallel."},
+                {"compile-cache", '\23', "DIR", "", false,
+                        "Cache the object files of the translation units of the generated C++ code in <DIR>, "
+                        "such that only changed units are recompiled. Implies --split-units."},
+                {"profile-guided", '\24', "DIR", "", false,
+                        "Optimise the compiled binary with the profile of a run on the facts in <DIR>, and "
+                        "report the speedup over the binary compiled without it."},
+                {"lto", '\25', "", "", false, "Enable link time optimisation of the compiled binary."},
+                {"ram-cache", '\32', "DIR", "", false,
+                        "Cache the translated programs of the interpreter in <DIR>, such that a program run "
+                        "again with the same options is neither parsed nor optimised."},
+                {"serve", '\41', "ADDRESS", "", false,
+                        "Evaluate the program, then answer the queries of clients on ADDRESS, a port of the "
+                        "loopback interface, HOST:PORT or unix:PATH, keeping the relations resident."},
+                {"query-inputs", '\42', "RELATIONS", "", false,
+                        "The comma-separated input relations filled by the queries of --serve; only the "
+                        "strata depending on them are evaluated per query."},
+                {"relation-config", '\43', "FILE", "", false,
+                        "Apply the representations of relations chosen in <FILE>, as written by "
+                        "souffle-tune."},
+                {"query-templates", '\44', "", "", false,
+                        "Emit the queries of rules differing in their relations and constants only once, as "
+                        "templates of the generated C++ code, reducing its size and compilation time."},
+                {"adaptive-conditions", '\45', "", "", false,
+                        "Evaluate the conditions of rules in the interpreter in the order of their observed "
+                        "selectivities and costs, reordered at runtime."},
+                {"inline-limit", '\46', "N", "", false,
+                        "Materialise an inline relation rather than inlining it if inlining generates more "
+                        "than N body literals from a single clause, 4096 by default."},
+                {"phase-times", '\47', "FILE", "", false,
+                        "Write the time taken by each phase of the compiler, i.e. parsing, each AST and RAM "
+                        "transformer, the translation to RAM, the synthesis and the compilation of the C++ "
+                        "code, as JSON to <FILE>."},
+                {"input-sample", '\50', "RATE", "", false,
+                        "Load a uniform sample of the given fraction of the tuples of each input relation, "
+                        "e.g. to estimate the sizes and runtimes of a long evaluation by profiling it on "
+                        "samples of several rates."},
+                {"hoist-joins", '\51', "", "", false,
+                        "Materialise the joins of recursive rules over relations a fixpoint loop does not "
+                        "change once before the loop, rather than joining them in each iteration."},
+                {"tiered", '\52', "DIR", "", false,
+                        "Interpret the program, and compile it into <DIR> in the background if its "
+                        "evaluation took longer than a second, such that later runs with the same options "
+                        "execute the compiled binary."},
                 {"compile", 'c', "", "", false,
                         "Generate C++ source code, compile to a binary executable, then run this "
                         "executable."},
@@ -164,31 +479,57 @@ int main(int argc, char** argv) {
                 {"swig", 's', "LANG", "", false,
                         "Generate SWIG interface for given language. The values <LANG> accepts is java and "
                         "python. "},
+                {"btree-search", '\7', "[ binary | linear | simd | packed ]", "", false,
+                        "Select the key search strategy of b-tree indexes in generated C++ code."},
                 {"library-dir", 'L', "DIR", "", true, "Specify directory for library files."},
                 {"libraries", 'l', "FILE", "", true, "Specify libraries."},
                 {"no-warn", 'w', "", "", false, "Disable warnings."},
                 {"magic-transform", 'm', "RELATIONS", "", false,
                         "Enable magic set transformation changes on the given relations, use '*' "
                         "for all."},
+                {"magic-selective", '\17', "", "", false,
+                        "Only apply the magic set transformation to adornments whose bound arguments are "
+                        "selective, estimated from the profile given by --profile-use."},
                 {"macro", 'M', "MACROS", "", false, "Set macro definitions for the pre-processor"},
+                {"no-preprocessor", '\33', "", "", false,
+                        "Parse the input file without running the pre-processor. The file must not contain "
+                        "pre-processor directives or macros."},
                 {"disable-transformers", 'z', "TRANSFORMERS", "", false,
                         "Disable the given AST transformers."},
                 {"dl-program", 'o', "FILE", "", false,
                         "Generate C++ source code, written to <FILE>, and compile this to a "
                         "binary executable (without executing it)."},
                 {"live-profile", '\2', "", "", false, "Enable live profiling."},
-                {"profile", 'p', "FILE", "", false, "Enable profiling, and write profile data to <FILE>."},
+                {"profile", 'p', "FILE", "", false,
+                        "Enable profiling, and write profile data to <FILE>. A <FILE> with the extension "
+                        ".bin is written as an indexed stream while the program runs."},
+                {"profile-counters", '\26', "", "", false,
+                        "Record the instructions, cache misses and branch misses of each rule and relation "
+                        "in the profile, counted by hardware performance counters. Requires --profile."},
+                {"profile-endpoint", '\27', "ADDRESS", "", false,
+                        "Serve the profile of the running program over HTTP on ADDRESS, a port of the "
+                        "loopback interface, HOST:PORT or unix:PATH, in the Prometheus text format at "
+                        "/metrics and in JSON at /json. Implies --profile."},
+                {"profile-sampling", '\30', "FILE", "", false,
+                        "Sample the rule executed by each thread every millisecond of CPU time, without "
+                        "instrumenting the program, and write the samples as a profile to <FILE>."},
                 {"profile-use", 'u', "FILE", "", false,
                         "Use profile log-file <FILE> for profile-guided optimization."},
                 {"debug-report", 'r', "FILE", "", false, "Write HTML debug report to <FILE>."},
+                {"debug-report-sections", '\1', "TRANSFORMERS", "", false,
+                        "Restrict the debug report to the sections of the given comma-separated "
+                        "transformers."},
                 {"pragma", 'P', "OPTIONS", "", false, "Set pragma options."},
                 {"provenance", 't', "[ none | explain | explore | subtreeHeights ]", "", false,
                         "Enable provenance instrumentation and interaction."},
+                {"provenance-relations", '\31', "RELATIONS", "", false,
+                        "Annotate only the comma-separated RELATIONS and the relations they are derived from "
+                        "with provenance, such that the other relations keep their width."},
                 {"verbose", 'v', "", "", false, "Verbose output."},
                 {"version", '\3', "", "", false, "Version."},
                 {"show", '\4',
-                        "[ parse-errors | precedence-graph | scc-graph | transformed-datalog | "
-                        "transformed-ram | type-analysis ]",
+                        "[ join-plans | magic-sets | parse-errors | precedence-graph | scc-graph | "
+                        "transformed-datalog | transformed-ram | type-analysis ]",
                         "", false, "Print selected program information."},
                 {"parse-errors", '\5', "", "", false, "Show parsing errors, if any, then exit."},
                 {"help", 'h', "", "", false, "Display this help message."}};
@@ -235,6 +576,39 @@ int main(int argc, char** argv) {
             throw std::runtime_error("cannot open file " + std::string(Global::config().get("")));
         }
 
+        /* for the btree-search option, to select the search strategy of generated b-trees */
+        if (Global::config().has("btree-search") && !Global::config().has("btree-search", "binary") &&
+                !Global::config().has("btree-search", "linear") &&
+                !Global::config().has("btree-search", "simd") &&
+                !Global::config().has("btree-search", "packed")) {
+            throw std::runtime_error(
+                    "--btree-search may only be set to 'binary', 'linear', 'simd' or 'packed'.");
+        }
+
+        /* for the thread-binding option, to select the placement of evaluation threads */
+        if (Global::config().has("thread-binding") && !Global::config().has("thread-binding", "none") &&
+                !Global::config().has("thread-binding", "close") &&
+                !Global::config().has("thread-binding", "spread")) {
+            throw std::runtime_error("--thread-binding may only be set to 'none', 'close' or 'spread'.");
+        }
+
+        /* for the inline-limit option, to bound the clauses generated by inlining */
+        if (Global::config().has("inline-limit") && !isNumber(Global::config().get("inline-limit").c_str())) {
+            throw std::runtime_error("--inline-limit may only be set to an integer greater or equal to 0.");
+        }
+
+        /* for the input-sample option, to load a fraction of the tuples of the inputs */
+        if (Global::config().has("input-sample") &&
+                !IODirectives::isSampleRate(Global::config().get("input-sample"))) {
+            throw std::runtime_error(
+                    "--input-sample may only be set to a number greater than 0 and at most 1.");
+        }
+
+        if (Global::config().has("phase-times")) {
+            PhaseTimes::instance().setOutputFile(
+                    Global::config().get("phase-times"), Global::config().get(""));
+        }
+
         /* for the jobs option, to determine the number of threads used */
 #ifdef _OPENMP
         if (isNumber(Global::config().get("jobs").c_str())) {
@@ -247,6 +621,18 @@ int main(int argc, char** argv) {
             }
             Global::config().set("jobs", "0");
         }
+        // the background threads of I/O and profiling are bounded by the number of jobs as well
+        if (Global::config().get("jobs") != "0") {
+            TaskPool::instance().setCapacity(std::stoi(Global::config().get("jobs")));
+        }
+        if (Global::config().has("stratum-jobs") && !isNumber(Global::config().get("stratum-jobs").c_str())) {
+            throw std::runtime_error("--stratum-jobs may only be set to an integer greater or equal to 0.");
+        }
+        if (Global::config().has("tail-threshold") &&
+                (!isNumber(Global::config().get("tail-threshold").c_str()) ||
+                        std::stoll(Global::config().get("tail-threshold")) < 0)) {
+            throw std::runtime_error("--tail-threshold may only be set to an integer greater or equal to 0.");
+        }
 #else
         // Check that -j option has not been changed from the default
         if (Global::config().get("jobs") != "1") {
@@ -254,6 +640,73 @@ int main(int argc, char** argv) {
         }
 #endif
 
+        if (Global::config().has("memory-budget", "auto")) {
+            const size_t budget = std::max<size_t>(1, ResourceLimits::getMemory() >> 21);
+            Global::config().set("memory-budget", std::to_string(budget));
+        }
+        if (Global::config().has("memory-budget") &&
+                (!isNumber(Global::config().get("memory-budget").c_str()) ||
+                        std::stoll(Global::config().get("memory-budget")) < 1)) {
+            throw std::runtime_error(
+                    "--memory-budget may only be set to 'auto' or an integer greater than 0.");
+        }
+        // the buffered tuples may not exceed the memory limit of a container, lest the process is killed
+        if (Global::config().has("memory-budget") && ResourceLimits::getMemoryLimit() > 0) {
+            const size_t limit = std::max<size_t>(1, ResourceLimits::getMemoryLimit() >> 20);
+            if (std::stoull(Global::config().get("memory-budget")) > limit) {
+                Global::config().set("memory-budget", std::to_string(limit));
+            }
+        }
+        if (Global::config().has("memory-limit")) {
+            const std::string& limit = Global::config().get("memory-limit");
+            size_t digits = 0;
+            while (digits < limit.size() && isdigit(limit[digits])) {
+                ++digits;
+            }
+            const std::string suffix = limit.substr(digits);
+            const size_t unit = suffix.size() == 1 ? std::string("KMGT").find(toupper(suffix[0])) : 1;
+            if (digits == 0 || suffix.size() > 1 || unit == std::string::npos ||
+                    std::stoull(limit.substr(0, digits)) == 0) {
+                throw std::runtime_error("--memory-limit may only be set to an integer greater than 0, "
+                                         "followed by an optional K, M, G or T suffix.");
+            }
+            const size_t shift = 10 * (unit + 1);
+            // concurrent strata and generated programs have no points at which memory may be freed
+            for (const char* option :
+                    {"compile", "generate", "dl-program", "swig", "stratum-jobs", "tiered"}) {
+                if (Global::config().has(option)) {
+                    throw std::runtime_error(
+                            std::string("--memory-limit is not supported with --") + option + ".");
+                }
+            }
+            size_t bytes = std::stoull(limit.substr(0, digits)) << shift;
+            if (ResourceLimits::getMemoryLimit() > 0) {
+                bytes = std::min<size_t>(bytes, ResourceLimits::getMemoryLimit());
+            }
+            Global::config().set("memory-limit", std::to_string(bytes));
+        }
+        if (Global::config().has("spill-dir") && !existDir(Global::config().get("spill-dir"))) {
+            throw std::runtime_error(
+                    "spill directory " + Global::config().get("spill-dir") + " does not exist");
+        }
+
+        if (Global::config().has("incremental") && Global::config().has("provenance")) {
+            throw std::runtime_error("--incremental is not supported with provenance.");
+        }
+
+        if (Global::config().has("distributed")) {
+#ifndef USE_MPI
+            throw std::runtime_error("This installation of Souffle does not support distributed evaluation.");
+#endif
+            for (const char* option : {"compile", "generate", "dl-program", "swig", "provenance",
+                         "incremental", "profile", "stratum-jobs", "checkpoint", "symbol-table", "tiered"}) {
+                if (Global::config().has(option)) {
+                    throw std::runtime_error(
+                            std::string("--distributed is not supported with --") + option + ".");
+                }
+            }
+        }
+
         /* if an output directory is given, check it exists */
         if (Global::config().has("output-dir") && !Global::config().has("output-dir", "-") &&
                 !existDir(Global::config().get("output-dir")) &&
@@ -301,12 +754,45 @@ int main(int argc, char** argv) {
             Global::config().set("macro", allMacros);
         }
 
+        // a tiered program runs with the interpreter, or as the same program compiled by an earlier run
+        if (Global::config().has("tiered")) {
+            for (const char* option :
+                    {"compile", "generate", "dl-program", "swig", "provenance", "live-profile"}) {
+                if (Global::config().has(option)) {
+                    throw std::runtime_error(
+                            std::string("--tiered is not supported with --") + option + ".");
+                }
+            }
+        }
+
         /* turn on compilation of executables */
         if (Global::config().has("dl-program")) {
             Global::config().set("compile");
         }
 
-        if (Global::config().has("live-profile") && !Global::config().has("profile")) {
+        if (Global::config().has("profile-sampling") &&
+                (Global::config().has("profile") || Global::config().has("live-profile") ||
+                        Global::config().has("profile-endpoint"))) {
+            throw std::runtime_error("--profile-sampling samples a program without instrumenting it, and "
+                                     "cannot be combined with other profiling options.");
+        }
+
+        if (Global::config().has("query-inputs") && !Global::config().has("serve")) {
+            throw std::runtime_error("--query-inputs requires --serve.");
+        }
+
+        if (Global::config().has("serve") && Global::config().has("profile-guided")) {
+            throw std::runtime_error("--serve cannot be combined with --profile-guided, whose training run "
+                                     "would not terminate.");
+        }
+
+        if (Global::config().has("serve") && Global::config().has("tiered")) {
+            throw std::runtime_error("--serve cannot be combined with --tiered, whose compiled binary does "
+                                     "not serve queries.");
+        }
+
+        if ((Global::config().has("live-profile") || Global::config().has("profile-endpoint")) &&
+                !Global::config().has("profile")) {
             Global::config().set("profile");
         }
     } catch (std::exception& e) {
@@ -329,24 +815,37 @@ int main(int argc, char** argv) {
         throw std::runtime_error("failed to determine souffle executable path");
     }
 
-    /* Create the pipe to establish a communication between cpp and souffle */
-    std::string cmd = ::which("mcpp");
+    // ------- read program -------------
 
-    if (!isExecutable(cmd)) {
-        throw std::runtime_error("failed to locate mcpp pre-processor");
-    }
+    /* The source, if it is read into memory rather than parsed from the pre-processor pipe */
+    std::string code;
+    FILE* in = nullptr;
+    if (Global::config().has("no-preprocessor")) {
+        if (Global::config().has("macro")) {
+            throw std::runtime_error("macro definitions require the pre-processor");
+        }
+        code = readSource(Global::config().get(""));
+    } else {
+        /* Create the pipe to establish a communication between cpp and souffle */
+        std::string cmd = ::which("mcpp");
 
-    cmd += " -e utf8 -W0 " + Global::config().get("include-dir");
-    if (Global::config().has("macro")) {
-        cmd += " " + Global::config().get("macro");
+        if (!isExecutable(cmd)) {
+            throw std::runtime_error("failed to locate mcpp pre-processor");
+        }
+
+        cmd += " -e utf8 -W0 " + Global::config().get("include-dir");
+        if (Global::config().has("macro")) {
+            cmd += " " + Global::config().get("macro");
+        }
+        // Add RamDomain size as a macro
+        cmd += " -DRAM_DOMAIN_SIZE=" + std::to_string(RAM_DOMAIN_SIZE);
+        cmd += " " + Global::config().get("");
+        in = popen(cmd.c_str(), "r");
     }
-    // Add RamDomain size as a macro
-    cmd += " -DRAM_DOMAIN_SIZE=" + std::to_string(RAM_DOMAIN_SIZE);
-    cmd += " " + Global::config().get("");
-    FILE* in = popen(cmd.c_str(), "r");
 
     /* Time taking for parsing */
     auto parser_start = std::chrono::high_resolution_clock::now();
+    const auto parsePhaseStart = PhaseTimes::clock::now();
 
     // ------- parse program -------------
 
@@ -354,16 +853,110 @@ int main(int argc, char** argv) {
     SymbolTable symTab;
     ErrorReport errReport(Global::config().has("no-warn"));
     DebugReport debugReport;
-    std::unique_ptr<AstTranslationUnit> astTranslationUnit =
-            ParserDriver::parseTranslationUnit("<stdin>", in, symTab, errReport, debugReport);
+    std::unique_ptr<AstTranslationUnit> astTranslationUnit;
 
-    // close input pipe
-    int preprocessor_status = pclose(in);
-    if (preprocessor_status == -1) {
-        perror(nullptr);
-        throw std::runtime_error("failed to close pre-processor pipe");
+    // reads the source from the pre-processor pipe, if a cached program is named by it
+    auto readPipe = [&]() {
+        if (in == nullptr) {
+            return;
+        }
+        char buffer[4096];
+        for (size_t n; (n = fread(buffer, 1, sizeof(buffer), in)) > 0;) {
+            code.append(buffer, n);
+        }
+        if (pclose(in) == -1) {
+            perror(nullptr);
+            throw std::runtime_error("failed to close pre-processor pipe");
+        }
+        in = nullptr;
+    };
+
+    // a tiered program is named by its preprocessed source and the options, like a cached RAM program
+    std::string tieredBinary;
+    if (Global::config().has("tiered") && !Global::config().has("show") &&
+            Global::config().get("debug-report").empty()) {
+        readPipe();
+
+        const std::string tieredDir = Global::config().get("tiered");
+        if (!existDir(tieredDir) && mkdir(tieredDir.c_str(), 0755) != 0) {
+            throw std::runtime_error("cannot create tiered program directory " + tieredDir);
+        }
+        // the name of the cached RAM program without its .ram extension
+        tieredBinary = RamProgramCache::getFileName(tieredDir, code);
+        tieredBinary.resize(tieredBinary.size() - 4);
+        if (isExecutable(tieredBinary)) {
+            if (Global::config().has("verbose")) {
+                std::cout << "Executing compiled binary " << tieredBinary << std::endl;
+            }
+            try {
+                executeBinary(tieredBinary, {});
+            } catch (std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                std::exit(1);
+            }
+            return 0;
+        }
     }
 
+    // the RAM cache applies to interpreted programs whose RAM is not inspected
+    std::string ramCacheFile;
+    if (Global::config().has("ram-cache") && !Global::config().has("compile") &&
+            !Global::config().has("dl-program") && !Global::config().has("generate") &&
+            !Global::config().has("swig") && !Global::config().has("show") &&
+            Global::config().get("debug-report").empty()) {
+        // the cached program is named by the preprocessed source
+        readPipe();
+
+        const std::string cacheDir = Global::config().get("ram-cache");
+        if (!existDir(cacheDir) && mkdir(cacheDir.c_str(), 0755) != 0) {
+            throw std::runtime_error("cannot create RAM cache " + cacheDir);
+        }
+        ramCacheFile = RamProgramCache::getFileName(cacheDir, code);
+
+        std::string warnings;
+        if (auto program = RamProgramCache::load(ramCacheFile, symTab, warnings)) {
+            if (Global::config().has("verbose")) {
+                std::cout << "Loaded RAM program from " << ramCacheFile << std::endl;
+            }
+            std::cerr << warnings;
+            RamTranslationUnit ramTranslationUnit(std::move(program), symTab, errReport, debugReport);
+            try {
+                if (tieredBinary.empty()) {
+                    interpret(ramTranslationUnit);
+                } else {
+                    interpretTiered(ramTranslationUnit, tieredBinary, souffleExecutable);
+                }
+            } catch (std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                std::exit(1);
+            }
+
+            /* Report overall run-time in verbose mode */
+            if (Global::config().has("verbose")) {
+                auto souffle_end = std::chrono::high_resolution_clock::now();
+                std::cout << "Total Time: "
+                          << std::chrono::duration<double>(souffle_end - souffle_start).count() << "sec\n";
+            }
+            return 0;
+        }
+    }
+
+    if (in == nullptr) {
+        astTranslationUnit = ParserDriver::parseTranslationUnit(code, symTab, errReport, debugReport);
+    } else {
+        astTranslationUnit =
+                ParserDriver::parseTranslationUnit("<stdin>", in, symTab, errReport, debugReport);
+
+        // close input pipe
+        int preprocessor_status = pclose(in);
+        if (preprocessor_status == -1) {
+            perror(nullptr);
+            throw std::runtime_error("failed to close pre-processor pipe");
+        }
+    }
+
+    PhaseTimes::instance().record("parse", "parser", parsePhaseStart);
+
     /* Report run-time of the parser if verbose flag is set */
     if (Global::config().has("verbose")) {
         auto parser_end = std::chrono::high_resolution_clock::now();
@@ -421,6 +1014,9 @@ int main(int argc, char** argv) {
     auto pipeline = std::make_unique<PipelineTransformer>(std::make_unique<AstComponentChecker>(),
             std::make_unique<ComponentInstantiationTransformer>(),
             std::make_unique<UniqueAggregationVariablesTransformer>(),
+            std::make_unique<RecursiveAggregatesTransformer>(),
+            std::make_unique<ConditionalTransformer>(Global::config().has("relation-config"),
+                    std::make_unique<RelationConfigTransformer>()),
             std::make_unique<AstUserDefinedFunctorsTransformer>(),
             std::make_unique<PolymorphicOperatorsTransformer>(), std::make_unique<AstSemanticChecker>(),
             std::make_unique<RemoveTypecastsTransformer>(),
@@ -443,6 +1039,13 @@ int main(int argc, char** argv) {
             std::make_unique<RemoveRedundantSumsTransformer>(),
             std::make_unique<RemoveEmptyRelationsTransformer>(),
             std::make_unique<ReorderLiteralsTransformer>(), std::move(magicPipeline),
+            // the clients of a served program read and fill the input relations by all their columns
+            std::make_unique<ConditionalTransformer>(Global::config().has("prune-inputs") &&
+                                                             !Global::config().has("provenance") &&
+                                                             !Global::config().has("serve"),
+                    std::make_unique<PruneInputsTransformer>()),
+            std::make_unique<ConditionalTransformer>(Global::config().has("share-join-prefixes"),
+                    std::make_unique<ShareJoinPrefixesTransformer>()),
             std::make_unique<AstExecutionPlanChecker>(), std::move(provenancePipeline));
 
     // Disable unwanted transformations
@@ -470,6 +1073,11 @@ int main(int argc, char** argv) {
     pipeline->apply(*astTranslationUnit);
 
     if (Global::config().has("show")) {
+        // The magic set transformer reports the specialised relations itself
+        if (Global::config().get("show") == "magic-sets") {
+            return 0;
+        }
+
         // Output the transformed datalog and return
         if (Global::config().get("show") == "transformed-datalog") {
             std::cout << *astTranslationUnit->getProgram() << std::endl;
@@ -496,20 +1104,35 @@ int main(int argc, char** argv) {
             std::cout << std::endl;
             return 0;
         }
+
+        // Output the join orders and their estimated costs based on the profile statistics
+        if (Global::config().get("show") == "join-plans") {
+            astTranslationUnit->getAnalysis<AstProfileUse>()->print(std::cout);
+            std::cout << std::endl;
+            return 0;
+        }
     }
 
     // ------- execution -------------
 
     /* translate AST to RAM */
+    const auto translateStart = PhaseTimes::clock::now();
     std::unique_ptr<RamTranslationUnit> ramTranslationUnit =
             AstTranslator().translateUnit(*astTranslationUnit);
+    PhaseTimes::instance().record("translate", "AstTranslator", translateStart);
 
     std::unique_ptr<RamTransformer> ramTransform = std::make_unique<RamTransformerSequence>(
             std::make_unique<RamLoopTransformer>(
-                    std::make_unique<RamTransformerSequence>(std::make_unique<ExpandFilterTransformer>(),
+                    std::make_unique<RamTransformerSequence>(std::make_unique<FoldConstantsTransformer>(),
+                            std::make_unique<ExpandFilterTransformer>(),
                             std::make_unique<HoistConditionsTransformer>(),
                             std::make_unique<MakeIndexTransformer>())),
             std::make_unique<IfConversionTransformer>(), std::make_unique<ChoiceConversionTransformer>(),
+            std::make_unique<RamConditionalTransformer>(
+                    // the materialised joins may be much larger than the tuples the loop probes
+                    []() -> bool { return Global::config().has("hoist-joins"); },
+                    std::make_unique<HoistInvariantJoinsTransformer>()),
+            std::make_unique<EqrelJoinTransformer>(),
             std::make_unique<CollapseFiltersTransformer>(), std::make_unique<TupleIdTransformer>(),
             std::make_unique<RamLoopTransformer>(std::make_unique<RamTransformerSequence>(
                     std::make_unique<HoistAggregateTransformer>(), std::make_unique<TupleIdTransformer>())),
@@ -518,10 +1141,42 @@ int main(int argc, char** argv) {
             std::make_unique<EliminateDuplicatesTransformer>(),
             std::make_unique<ReorderConditionsTransformer>(),
             std::make_unique<RamLoopTransformer>(std::make_unique<ReorderFilterBreak>()),
+            std::make_unique<RamConditionalTransformer>(
+                    // searches are weighted by their frequencies in a previous profile
+                    []() -> bool { return Global::config().has("profile-use"); },
+                    std::make_unique<ProfileGuidedIndexTransformer>()),
+            std::make_unique<RamConditionalTransformer>(
+                    // provenance annotations are not intersected
+                    []() -> bool { return !Global::config().has("provenance"); },
+                    std::make_unique<LeapfrogJoinTransformer>()),
             std::make_unique<RamConditionalTransformer>(
                     // job count of 0 means all cores are used.
                     []() -> bool { return std::stoi(Global::config().get("jobs")) != 1; },
                     std::make_unique<ParallelTransformer>()),
+            std::make_unique<RamConditionalTransformer>(
+                    // provenance searches the relations by the indexes of their joins
+                    []() -> bool { return !Global::config().has("provenance"); },
+                    std::make_unique<HashJoinTransformer>()),
+            std::make_unique<GroupAggregateTransformer>(),
+            std::make_unique<RamConditionalTransformer>(
+                    // provenance annotations are not merged
+                    []() -> bool { return !Global::config().has("provenance"); },
+                    std::make_unique<MergeJoinTransformer>()),
+            std::make_unique<RamConditionalTransformer>(
+                    // provenance and incremental updates search the relations in subroutines, and served
+                    // queries search the base relations after their last stratum
+                    []() -> bool {
+                        return Global::config().has("lazy-indexes") && !Global::config().has("provenance") &&
+                               !Global::config().has("incremental") && !Global::config().has("serve");
+                    },
+                    std::make_unique<LazyIndexTransformer>()),
+            std::make_unique<RamConditionalTransformer>(
+                    []() -> bool {
+                        return (Global::config().has("freeze-relations") ||
+                                       Global::config().has("memory-limit")) &&
+                               !Global::config().has("provenance") && !Global::config().has("incremental");
+                    },
+                    std::make_unique<FreezeTransformer>()),
             std::make_unique<ReportIndexTransfomer>());
 
     ramTransform->apply(*ramTranslationUnit);
@@ -535,40 +1190,20 @@ int main(int argc, char** argv) {
         return 0;
     }
 
+    // Cache the RAM program with the symbols of its constants, before it is run
+    if (!ramCacheFile.empty()) {
+        const std::string warnings = errReport.getNumIssues() != 0 ? toString(errReport) : "";
+        RamProgramCache::store(ramCacheFile, ramTranslationUnit->getProgram(), symTab, warnings);
+    }
+
     try {
-        if (!Global::config().has("compile") && !Global::config().has("dl-program") &&
+        if (!tieredBinary.empty()) {
+            // ------- tiered interpreter -------------
+            interpretTiered(*ramTranslationUnit, tieredBinary, souffleExecutable);
+        } else if (!Global::config().has("compile") && !Global::config().has("dl-program") &&
                 !Global::config().has("generate") && !Global::config().has("swig")) {
             // ------- interpreter -------------
-
-            std::thread profiler;
-            // Start up profiler if needed
-            if (Global::config().has("live-profile") && !Global::config().has("compile")) {
-                profiler = std::thread([]() { profile::Tui().runProf(); });
-            }
-
-            // configure and execute interpreter
-            std::unique_ptr<InterpreterEngine> interpreter(
-                    std::make_unique<InterpreterEngine>(*ramTranslationUnit));
-            interpreter->executeMain();
-            // If the profiler was started, join back here once it exits.
-            if (profiler.joinable()) {
-                profiler.join();
-            }
-            if (Global::config().has("provenance")) {
-                // Test for bugged combination of provenance, interpreted souffle, and concurrency
-                if (Global::config().get("jobs") != "1") {
-                    throw std::runtime_error("Provenance is not supported with parallel interpreted mode");
-                }
-
-                // only run explain interface if interpreted
-                InterpreterProgInterface interface(*interpreter);
-                if (Global::config().get("provenance") == "explain" ||
-                        Global::config().get("provenance") == "subtreeHeights") {
-                    explain(interface, false, Global::config().get("provenance") == "subtreeHeights");
-                } else if (Global::config().get("provenance") == "explore") {
-                    explain(interface, true, false);
-                }
-            }
+            interpret(*ramTranslationUnit);
         } else {
             // ------- compiler -------------
             std::string compileCmd = ::findTool("souffle-compile", souffleExecutable, ".");
@@ -577,7 +1212,18 @@ int main(int argc, char** argv) {
                 throw std::runtime_error("failed to locate souffle-compile");
             }
             compileCmd += " ";
+            if (Global::config().has("compile-cache")) {
+                Global::config().set("split-units");
+                compileCmd += "-C " + Global::config().get("compile-cache") + " ";
+            }
+            if (Global::config().has("profile-guided")) {
+                compileCmd += "-p " + Global::config().get("profile-guided") + " ";
+            }
+            if (Global::config().has("lto")) {
+                compileCmd += "-t ";
+            }
 
+            checkQueryInputs(ramTranslationUnit->getProgram());
             std::unique_ptr<Synthesiser> synthesiser = std::make_unique<Synthesiser>(*ramTranslationUnit);
 
             // Find the base filename for code generation and execution
@@ -591,6 +1237,13 @@ int main(int argc, char** argv) {
                 if (baseFilename.size() >= 4 && baseFilename.substr(baseFilename.size() - 4) == ".cpp") {
                     baseFilename = baseFilename.substr(0, baseFilename.size() - 4);
                 }
+            } else if (Global::config().has("compile-cache")) {
+                // cached objects refer to the program class by name, which must not vary between runs
+                const std::string cacheDir = Global::config().get("compile-cache");
+                if (!existDir(cacheDir) && mkdir(cacheDir.c_str(), 0755) != 0) {
+                    throw std::runtime_error("cannot create compile cache " + cacheDir);
+                }
+                baseFilename = cacheDir + "/" + identifier(simpleName(Global::config().get("")));
             } else {
                 baseFilename = tempFile();
             }
@@ -601,10 +1254,31 @@ int main(int argc, char** argv) {
             std::string baseIdentifier = identifier(simpleName(baseFilename));
             std::string sourceFilename = baseFilename + ".cpp";
 
+            // the generated sources: the main source, and with split units a header and a source per stratum
+            std::vector<std::string> sourceFilenames{sourceFilename};
+            std::vector<std::string> generatedFilenames{sourceFilename};
+
             bool withSharedLibrary;
+            const auto synthesisStart = PhaseTimes::clock::now();
             std::ofstream os(sourceFilename);
-            synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
+            if (Global::config().has("split-units") && !Global::config().has("swig")) {
+                const std::string headerFilename = baseFilename + ".h";
+                std::ofstream header(headerFilename);
+                std::vector<std::string> units;
+                synthesiser->generateCode(
+                        os, baseIdentifier, withSharedLibrary, &header, baseName(headerFilename), &units);
+                generatedFilenames.push_back(headerFilename);
+                for (size_t i = 0; i < units.size(); ++i) {
+                    sourceFilenames.push_back(baseFilename + "_" + std::to_string(i) + ".cpp");
+                    generatedFilenames.push_back(sourceFilenames.back());
+                    std::ofstream unit(sourceFilenames.back());
+                    unit << units[i];
+                }
+            } else {
+                synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
+            }
             os.close();
+            PhaseTimes::instance().record("synthesis", "Synthesiser", synthesisStart);
 
             if (withSharedLibrary) {
                 if (!Global::config().has("libraries")) {
@@ -617,10 +1291,14 @@ int main(int argc, char** argv) {
 
             if (Global::config().has("swig")) {
                 compileCmd += "-s " + Global::config().get("swig") + " ";
-                compileToBinary(compileCmd, sourceFilename);
+                const auto compileStart = PhaseTimes::clock::now();
+                compileToBinary(compileCmd, sourceFilenames);
+                PhaseTimes::instance().record("compile", "souffle-compile", compileStart);
             } else if (Global::config().has("compile")) {
                 auto start = std::chrono::high_resolution_clock::now();
-                compileToBinary(compileCmd, sourceFilename);
+                const auto compileStart = PhaseTimes::clock::now();
+                compileToBinary(compileCmd, sourceFilenames);
+                PhaseTimes::instance().record("compile", "souffle-compile", compileStart);
                 /* Report overall run-time in verbose mode */
                 if (Global::config().has("verbose")) {
                     auto end = std::chrono::high_resolution_clock::now();
@@ -629,7 +1307,7 @@ int main(int argc, char** argv) {
                 }
                 // run compiled C++ program if requested.
                 if (!Global::config().has("dl-program") && !Global::config().has("swig")) {
-                    executeBinary(baseFilename);
+                    executeBinary(baseFilename, generatedFilenames);
                 }
             }
         }
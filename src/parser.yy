@@ -57,13 +57,11 @@
     #define YYLLOC_DEFAULT(Cur, Rhs, N)                         \
     do {                                                        \
         if (N) {                                                \
+            (Cur)               = YYRHSLOC(Rhs, N);             \
             (Cur).start         = YYRHSLOC(Rhs, 1).start;       \
-            (Cur).end           = YYRHSLOC(Rhs, N).end;         \
-            (Cur).filename      = YYRHSLOC(Rhs, N).filename;    \
         } else {                                                \
-            (Cur).start         = YYRHSLOC(Rhs, 0).end;         \
-            (Cur).end           = YYRHSLOC(Rhs, 0).end;         \
-            (Cur).filename      = YYRHSLOC(Rhs, 0).filename;    \
+            (Cur)               = YYRHSLOC(Rhs, 0);             \
+            (Cur).start         = (Cur).end;                    \
         }                                                       \
     } while (0)
 }
@@ -89,6 +87,11 @@
 %token BRIE_QUALIFIER            "BRIE datastructure qualifier"
 %token BTREE_QUALIFIER           "BTREE datastructure qualifier"
 %token EQREL_QUALIFIER           "equivalence relation qualifier"
+%token HASHSET_QUALIFIER         "HASHSET datastructure qualifier"
+%token DENSE_QUALIFIER           "DENSE datastructure qualifier"
+%token EXTERNAL_QUALIFIER        "EXTERNAL datastructure qualifier"
+%token BLOCKSIZE_QUALIFIER       "block size qualifier"
+%token CHOICEDOMAIN              "choice-domain"
 %token OVERRIDABLE_QUALIFIER     "relation qualifier overidable"
 %token INLINE_QUALIFIER          "relation qualifier inline"
 %token TMATCH                    "match predicate"
@@ -107,6 +110,7 @@
 %token IF                        ":-"
 %token DECL                      "relation declaration"
 %token FUNCTOR                   "functor declaration"
+%token STATEFUL                  "stateful functor qualifier"
 %token INPUT_DECL                "input directives declaration"
 %token OUTPUT_DECL               "output directives declaration"
 %token PRINTSIZE_DECL            "printsize directives declaration"
@@ -177,6 +181,8 @@
 %type <AstClause *>                         fact
 %type <AstFunctorDeclaration *>             functor_decl
 %type <TypeAttribute>                       functor_type
+%type <std::vector<std::string>>            choice_domain
+%type <std::vector<std::string>>            choice_domain_list
 %type <std::vector<AstAtom *>>              head
 %type <std::vector<std::string>>            identifier
 %type <std::vector<AstIO *>>                io_directive_list
@@ -191,7 +197,7 @@
             <std::string, std::string>>>    non_empty_key_value_pairs
 %type <AstRecordType *>                     non_empty_record_type_list
 %type <AstPragma *>                         pragma
-%type <uint32_t>                            qualifiers
+%type <std::pair<uint32_t, RamDomain>>      qualifiers
 %type <std::vector<AstRelation *>>          relation_decl
 %type <std::vector<AstRelation *>>          relation_list
 %type <std::vector<AstClause *>>            rule
@@ -445,7 +451,8 @@ union_type_list
 relation_decl
   : DECL relation_list LPAREN RPAREN qualifiers {
         for (auto* rel : $relation_list) {
-            rel->setQualifier($qualifiers);
+            rel->setQualifier($qualifiers.first);
+            rel->setBlockSize($qualifiers.second);
         }
         $$ = $relation_list;
 
@@ -453,7 +460,8 @@ relation_decl
     }
   | DECL relation_list LPAREN non_empty_attributes RPAREN qualifiers {
         for (auto* rel : $relation_list) {
-            rel->setQualifier($qualifiers);
+            rel->setQualifier($qualifiers.first);
+            rel->setBlockSize($qualifiers.second);
             for (auto* attr : $non_empty_attributes) {
                 rel->addAttribute(std::unique_ptr<AstAttribute>(attr->clone()));
             }
@@ -462,6 +470,39 @@ relation_decl
 
         $relation_list.clear();
     }
+  | DECL relation_list LPAREN non_empty_attributes RPAREN qualifiers CHOICEDOMAIN choice_domain {
+        for (auto* rel : $relation_list) {
+            rel->setQualifier($qualifiers.first);
+            rel->setBlockSize($qualifiers.second);
+            rel->setChoiceDomain($choice_domain);
+            for (auto* attr : $non_empty_attributes) {
+                rel->addAttribute(std::unique_ptr<AstAttribute>(attr->clone()));
+            }
+        }
+        $$ = $relation_list;
+
+        $relation_list.clear();
+    }
+  ;
+
+/* Attributes of which a relation keeps only the first tuple */
+choice_domain
+  : IDENT {
+        $$.push_back($IDENT);
+    }
+  | LPAREN choice_domain_list RPAREN {
+        $$ = $choice_domain_list;
+    }
+  ;
+
+choice_domain_list
+  : IDENT {
+        $$.push_back($IDENT);
+    }
+  | choice_domain_list[curr_list] COMMA IDENT {
+        $$ = $curr_list;
+        $$.push_back($IDENT);
+    }
   ;
 
 /* List of relation names to declare */
@@ -511,49 +552,103 @@ non_empty_attributes
 qualifiers
   : qualifiers OUTPUT_QUALIFIER {
         driver.warning(@2, "Deprecated output qualifier used");
-        if($1 & OUTPUT_RELATION)
+        if($1.first & OUTPUT_RELATION)
             driver.error(@2, "output qualifier already set");
-        $$ = $1 | OUTPUT_RELATION;
+        $$ = $1;
+        $$.first |= OUTPUT_RELATION;
     }
   | qualifiers INPUT_QUALIFIER {
         driver.warning(@2, "Deprecated input qualifier was used");
-        if($1 & INPUT_RELATION)
+        if($1.first & INPUT_RELATION)
             driver.error(@2, "input qualifier already set");
-        $$ = $1 | INPUT_RELATION;
+        $$ = $1;
+        $$.first |= INPUT_RELATION;
     }
   | qualifiers PRINTSIZE_QUALIFIER {
         driver.warning(@2, "Deprecated printsize qualifier was used");
-        if($1 & PRINTSIZE_RELATION)
+        if($1.first & PRINTSIZE_RELATION)
             driver.error(@2, "printsize qualifier already set");
-        $$ = $1 | PRINTSIZE_RELATION;
+        $$ = $1;
+        $$.first |= PRINTSIZE_RELATION;
     }
   | qualifiers OVERRIDABLE_QUALIFIER {
-        if($1 & OVERRIDABLE_RELATION)
+        if($1.first & OVERRIDABLE_RELATION)
             driver.error(@2, "overridable qualifier already set");
-        $$ = $1 | OVERRIDABLE_RELATION;
+        $$ = $1;
+        $$.first |= OVERRIDABLE_RELATION;
     }
   | qualifiers INLINE_QUALIFIER {
-        if($1 & INLINE_RELATION)
+        if($1.first & INLINE_RELATION)
             driver.error(@2, "inline qualifier already set");
-        $$ = $1 | INLINE_RELATION;
+        $$ = $1;
+        $$.first |= INLINE_RELATION;
     }
   | qualifiers BRIE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
-        $$ = $1 | BRIE_RELATION;
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= BRIE_RELATION;
     }
   | qualifiers BTREE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
-        $$ = $1 | BTREE_RELATION;
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= BTREE_RELATION;
     }
   | qualifiers EQREL_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
-        $$ = $1 | EQREL_RELATION;
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= EQREL_RELATION;
+    }
+  | qualifiers HASHSET_QUALIFIER {
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= HASHSET_RELATION;
+    }
+  | qualifiers DENSE_QUALIFIER {
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= DENSE_RELATION;
+    }
+  | qualifiers MIN {
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= MIN_RELATION;
+    }
+  | qualifiers MAX {
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= MAX_RELATION;
+    }
+  | qualifiers EXTERNAL_QUALIFIER {
+        if($1.first & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|HASHSET_RELATION|
+                       DENSE_RELATION|MIN_RELATION|MAX_RELATION|EXTERNAL_RELATION))
+            driver.error(@2, "btree/brie/eqrel/hashset/dense/min/max/external qualifier already set");
+        $$ = $1;
+        $$.first |= EXTERNAL_RELATION;
+    }
+  | qualifiers BLOCKSIZE_QUALIFIER LPAREN NUMBER RPAREN {
+        if($1.second != 0)
+            driver.error(@2, "blocksize qualifier already set");
+        if($NUMBER < 64 || ($NUMBER & ($NUMBER - 1)) != 0)
+            driver.error(@NUMBER, "block size must be a power of two of at least 64 bytes");
+        $$ = $1;
+        $$.second = $NUMBER;
     }
   | %empty {
-        $$ = 0;
+        $$ = std::make_pair(0, 0);
     }
   ;
 
@@ -1528,6 +1623,15 @@ functor_decl
         $$ = new AstFunctorDeclaration($IDENT, typesig, $functor_type);
         $$->setSrcLoc(@$);
     }
+  | FUNCTOR IDENT LPAREN RPAREN COLON functor_type STATEFUL {
+        $$ = new AstFunctorDeclaration($IDENT, {}, $functor_type, true);
+        $$->setSrcLoc(@$);
+    }
+  | FUNCTOR IDENT LPAREN non_empty_functor_arg_type_list RPAREN COLON functor_type STATEFUL {
+        auto typesig = $non_empty_functor_arg_type_list;
+        $$ = new AstFunctorDeclaration($IDENT, typesig, $functor_type, true);
+        $$->setSrcLoc(@$);
+    }
   ;
 
 /* Functor argument list type */
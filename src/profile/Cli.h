@@ -8,11 +8,18 @@
 
 #pragma once
 
+#include "DiffGenerator.h"
+#include "EstimateGenerator.h"
+#include "OutputProcessor.h"
+#include "Reader.h"
 #include "StringUtils.h"
 #include "Tui.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <getopt.h>
@@ -28,11 +35,17 @@ class Cli {
 public:
     std::map<char, std::string> args;
 
+    /** The log files of the runs compared by souffle-profile diff <old-log> <new-log> */
+    std::vector<std::string> diffFiles;
+
+    /** The log files of the sampled runs extrapolated by souffle-profile estimate <log>... */
+    std::vector<std::string> estimateFiles;
+
     Cli(int argc, char* argv[]) : args() {
         int c;
         option longOptions[1];
         longOptions[0] = {nullptr, 0, nullptr, 0};
-        while ((c = getopt_long(argc, argv, "c:hj::", longOptions, nullptr)) != EOF) {
+        while ((c = getopt_long(argc, argv, "c:hj::r:t:s:mn:", longOptions, nullptr)) != EOF) {
             // An invalid argument was given
             if (c == '?') {
                 exit(1);
@@ -47,20 +60,31 @@ public:
                 args[c] = c;
             }
         }
-        if (optind < argc && args.count('f') == 0) {
+        if (optind + 2 < argc && std::string(argv[optind]) == "diff") {
+            diffFiles = {argv[optind + 1], argv[optind + 2]};
+        } else if (optind + 1 < argc && std::string(argv[optind]) == "estimate") {
+            estimateFiles.assign(argv + optind + 1, argv + argc);
+        } else if (optind < argc && args.count('f') == 0) {
             args['f'] = argv[optind];
         }
     }
 
     void parse() {
-        if (args.size() == 0) {
+        if (args.size() == 0 && diffFiles.empty() && estimateFiles.empty()) {
             std::cout << "No arguments provided.\nTry souffle-profile -h for help.\n";
             exit(1);
         }
 
-        if (args.count('h') != 0 || args.count('f') == 0) {
+        if (args.count('h') != 0 || (args.count('f') == 0 && diffFiles.empty() && estimateFiles.empty())) {
             std::cout << "Souffle Profiler" << std::endl
-                      << "Usage: souffle-profile <log-file> [ -h | -c <command> [options] | -j ]" << std::endl
+                      << "Usage: souffle-profile <log-file> [ -h | -c <command> [options] | -j | -t "
+                         "<filename> ]"
+                      << std::endl
+                      << "       souffle-profile diff <old-log-file> <new-log-file> [ -s <order> | -m | "
+                         "-n <N> ]"
+                      << std::endl
+                      << "       souffle-profile estimate <log-file>... [ -s <order> | -m | -n <N> ]"
+                      << std::endl
                       << "<log-file>            The log file to profile." << std::endl
                       << "-c <command>          Run the given command on the log file, try with  "
                          "'-c help' for a list"
@@ -69,25 +93,115 @@ public:
                       << "-j[filename]          Generate a GUI (html/js) version of the profiler."
                       << std::endl
                       << "                      Default filename is profiler_html/[num].html" << std::endl
+                      << "-r <relations>        Load only the given comma-separated relations of a"
+                      << std::endl
+                      << "                      streamed (.bin) log file." << std::endl
+                      << "-t <filename>         Export the timings as a Chrome trace event file, to be"
+                      << std::endl
+                      << "                      viewed in chrome://tracing or Perfetto." << std::endl
+                      << "-s <order>            Rank the differences of two runs by the absolute (time,"
+                      << std::endl
+                      << "                      tuples) or relative (time%, tuples%) change, and the"
+                      << std::endl
+                      << "                      estimates of sampled runs by the time or tuples." << std::endl
+                      << "-m                    Output the differences or estimates as JSON." << std::endl
+                      << "-n <N>                Output the N largest differences or estimates." << std::endl
                       << "-h                    Print this help message." << std::endl;
             exit(0);
         }
+        std::set<std::string> relations;
+        if (args.count('r') != 0) {
+            for (const auto& relation : Tools::split(args['r'], ",")) {
+                relations.insert(relation);
+            }
+        }
+        if (!diffFiles.empty()) {
+            diff(relations);
+            return;
+        }
+        if (!estimateFiles.empty()) {
+            estimate(relations);
+            return;
+        }
         std::string filename = args['f'];
 
         if (args.count('c') != 0) {
-            Tui tui(filename, false, false);
+            Tui tui(filename, false, false, relations);
             for (auto& command : Tools::split(args['c'], ";")) {
                 tui.runCommand(Tools::split(command, " "));
             }
+        } else if (args.count('t') != 0) {
+            Tui(filename, false, false, relations).outputTrace(args['t']);
         } else if (args.count('j') != 0) {
             if (args['j'] == "j") {
-                Tui(filename, false, true).outputHtml();
+                Tui(filename, false, true, relations).outputHtml();
             } else {
-                Tui(filename, false, true).outputHtml(args['j']);
+                Tui(filename, false, true, relations).outputHtml(args['j']);
             }
         } else {
-            Tui(filename, true, false).runProf();
+            Tui(filename, true, false, relations).runProf();
+        }
+    }
+
+    /** Compare the runs of the given log files */
+    void diff(const std::set<std::string>& relations) {
+        const std::string order = getOrder(DiffGenerator::getOrders());
+        const size_t limit = getLimit();
+
+        // the runs are read one after the other through the profile database
+        std::vector<OutputProcessor> runs(2);
+        for (size_t i = 0; i < 2; ++i) {
+            Reader reader(diffFiles[i], runs[i].getProgramRun(), relations);
+            reader.processFile();
+        }
+        DiffGenerator::write(std::cout, *runs[0].getProgramRun(), *runs[1].getProgramRun(), order,
+                args.count('m') != 0, limit);
+    }
+
+    /** Estimate a full evaluation from the runs of the given log files on samples of its inputs */
+    void estimate(const std::set<std::string>& relations) {
+        const std::string order = getOrder(EstimateGenerator::getOrders());
+        const size_t limit = getLimit();
+
+        std::vector<OutputProcessor> processors(estimateFiles.size());
+        std::vector<EstimateGenerator::Run> runs;
+        for (size_t i = 0; i < estimateFiles.size(); ++i) {
+            Reader reader(estimateFiles[i], processors[i].getProgramRun(), relations);
+            reader.processFile();
+            // runs on all of the inputs do not record a sample rate
+            double rate = 1;
+            const auto config =
+                    ProfileEventSingleton::instance().getDB().getStringMap({"program", "configuration"});
+            auto pos = config.find("input-sample");
+            if (pos != config.end()) {
+                rate = std::stod(pos->second);
+            }
+            runs.push_back({processors[i].getProgramRun().get(), rate});
+        }
+        EstimateGenerator::write(std::cout, runs, order, args.count('m') != 0, limit);
+    }
+
+private:
+    /** The order given by -s, which must be one of the given ones, the first by default */
+    std::string getOrder(const std::vector<std::string>& orders) {
+        const std::string order = args.count('s') != 0 ? args['s'] : orders.front();
+        if (std::find(orders.begin(), orders.end(), order) == orders.end()) {
+            std::cerr << "Unknown order " << order << ", expected one of:";
+            for (const auto& cur : orders) {
+                std::cerr << " " << cur;
+            }
+            std::cerr << std::endl;
+            exit(1);
+        }
+        return order;
+    }
+
+    /** The number of entries to output given by -n, all by default */
+    size_t getLimit() {
+        if (args.count('n') != 0) {
+            return std::stoul(args['n']);
         }
+        return std::numeric_limits<size_t>::max();
     }
 };
 
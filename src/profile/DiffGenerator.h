@@ -0,0 +1,225 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+#pragma once
+
+#include "ProgramRun.h"
+#include "StringUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+/*
+ * Class comparing two program runs, e.g., of a nightly regression, by matching their relations by
+ * name and their rules by clause across the runs.
+ *
+ * The relations and rules are ranked by the absolute or relative change of their runtime or number
+ * of tuples, and written as a table or as JSON for further processing. Relations and rules of only
+ * one run are compared with an empty profile, their relative change is undefined.
+ */
+class DiffGenerator {
+public:
+    /** The orders of the changes, e.g., "time" for the absolute and "time%" for the relative change */
+    static const std::vector<std::string>& getOrders() {
+        static const std::vector<std::string> orders = {"time", "time%", "tuples", "tuples%"};
+        return orders;
+    }
+
+    static void write(std::ostream& os, const ProgramRun& before, const ProgramRun& after,
+            const std::string& order, bool json, size_t limit) {
+        std::vector<Change> relations = match(getRelations(before), getRelations(after));
+        std::vector<Change> rules = match(getRules(before), getRules(after));
+        sort(relations, order);
+        sort(rules, order);
+        if (json) {
+            os << R"_({"order": ")_" << order << R"_(", "relations": )_";
+            writeJson(os, relations, limit);
+            os << R"_(, "rules": )_";
+            writeJson(os, rules, limit);
+            os << "}\n";
+        } else {
+            os << "Relations ranked by " << order << " change\n";
+            writeTable(os, relations, limit);
+            os << "\nRules ranked by " << order << " change\n";
+            writeTable(os, rules, limit);
+        }
+    }
+
+private:
+    /** The runtime and number of tuples of a relation or rule in a run */
+    struct Measure {
+        std::chrono::microseconds time{};
+        long tuples = 0;
+        bool present = false;
+    };
+
+    /** A relation or rule matched across the runs */
+    struct Change {
+        std::string name;
+        Measure before;
+        Measure after;
+
+        double timeChange() const {
+            return static_cast<double>((after.time - before.time).count());
+        }
+
+        double tupleChange() const {
+            return static_cast<double>(after.tuples - before.tuples);
+        }
+
+        /** The relative change, NaN if the relation or rule is missing from a run or was empty */
+        double ratio(double change, double base) const {
+            if (!before.present || !after.present || base == 0) {
+                return std::nan("");
+            }
+            return change / base;
+        }
+
+        double timeRatio() const {
+            return ratio(timeChange(), static_cast<double>(before.time.count()));
+        }
+
+        double tupleRatio() const {
+            return ratio(tupleChange(), static_cast<double>(before.tuples));
+        }
+    };
+
+    static std::map<std::string, Measure> getRelations(const ProgramRun& run) {
+        std::map<std::string, Measure> res;
+        for (const auto& cur : run.getRelationMap()) {
+            const Relation& relation = *cur.second;
+            Measure& measure = res[relation.getName()];
+            measure.time += relation.getNonRecTime() + relation.getRecTime() + relation.getCopyTime();
+            measure.tuples += static_cast<long>(relation.size());
+            measure.present = true;
+        }
+        return res;
+    }
+
+    /** Get the rules of a run by their clauses, summing up the iterations of recursive rules */
+    static std::map<std::string, Measure> getRules(const ProgramRun& run) {
+        std::map<std::string, Measure> res;
+        auto add = [&](const Rule& rule) {
+            Measure& measure = res[rule.getName()];
+            measure.time += rule.getRuntime();
+            measure.tuples += rule.size();
+            measure.present = true;
+        };
+        for (const auto& cur : run.getRelationMap()) {
+            for (const auto& rule : cur.second->getRuleMap()) {
+                add(*rule.second);
+            }
+            for (const auto& iteration : cur.second->getIterations()) {
+                for (const auto& rule : iteration->getRules()) {
+                    add(*rule.second);
+                }
+            }
+        }
+        return res;
+    }
+
+    static std::vector<Change> match(
+            const std::map<std::string, Measure>& before, const std::map<std::string, Measure>& after) {
+        std::map<std::string, Change> changes;
+        for (const auto& cur : before) {
+            changes[cur.first].before = cur.second;
+        }
+        for (const auto& cur : after) {
+            changes[cur.first].after = cur.second;
+        }
+        std::vector<Change> res;
+        for (auto& cur : changes) {
+            cur.second.name = cur.first;
+            res.push_back(cur.second);
+        }
+        return res;
+    }
+
+    /** Rank the changes by the magnitude of the given change, undefined relative changes last */
+    static void sort(std::vector<Change>& changes, const std::string& order) {
+        auto key = [&](const Change& change) {
+            double res = std::abs(change.timeChange());
+            if (order == "time%") {
+                res = std::abs(change.timeRatio());
+            } else if (order == "tuples") {
+                res = std::abs(change.tupleChange());
+            } else if (order == "tuples%") {
+                res = std::abs(change.tupleRatio());
+            }
+            return std::isnan(res) ? -1 : res;
+        };
+        std::stable_sort(changes.begin(), changes.end(),
+                [&](const Change& a, const Change& b) { return key(a) > key(b); });
+    }
+
+    static std::string formatRatio(const Change& change, double ratio) {
+        if (std::isnan(ratio)) {
+            return !change.before.present ? "new" : !change.after.present ? "removed" : "-";
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), "%+.1f%%", 100 * ratio);
+        return text;
+    }
+
+    static std::string formatChange(double change, const std::string& value) {
+        return (change > 0 ? "+" : change < 0 ? "-" : "") + value;
+    }
+
+    static void writeTable(std::ostream& os, const std::vector<Change>& changes, size_t limit) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%10s%10s%10s%10s%10s%10s%10s%10s  %s\n", "TIME OLD", "TIME NEW",
+                "CHANGE", "CHANGE%", "TUP OLD", "TUP NEW", "CHANGE", "CHANGE%", "NAME");
+        os << line;
+        for (size_t i = 0; i < std::min(limit, changes.size()); ++i) {
+            const Change& change = changes[i];
+            const auto timeDelta =
+                    std::chrono::microseconds(static_cast<long>(std::abs(change.timeChange())));
+            const long tupleDelta = static_cast<long>(std::abs(change.tupleChange()));
+            std::snprintf(line, sizeof(line), "%10s%10s%10s%10s%10s%10s%10s%10s  ",
+                    Tools::formatTime(change.before.time).c_str(),
+                    Tools::formatTime(change.after.time).c_str(),
+                    formatChange(change.timeChange(), Tools::formatTime(timeDelta)).c_str(),
+                    formatRatio(change, change.timeRatio()).c_str(),
+                    Tools::formatNum(3, change.before.tuples).c_str(),
+                    Tools::formatNum(3, change.after.tuples).c_str(),
+                    formatChange(change.tupleChange(), Tools::formatNum(3, tupleDelta)).c_str(),
+                    formatRatio(change, change.tupleRatio()).c_str());
+            os << line << change.name << "\n";
+        }
+    }
+
+    static void writeJson(std::ostream& os, const std::vector<Change>& changes, size_t limit) {
+        auto ratio = [](double value) { return std::isnan(value) ? "null" : Tools::cleanJsonOut(value); };
+        auto present = [](const Measure& measure) { return measure.present ? "true" : "false"; };
+        os << "[";
+        for (size_t i = 0; i < std::min(limit, changes.size()); ++i) {
+            const Change& change = changes[i];
+            os << (i == 0 ? "\n" : ",\n") << R"_({"name": ")_" << Tools::cleanJsonOut(change.name)
+               << R"_(", "present": [)_" << present(change.before) << ", " << present(change.after)
+               << R"_(], "time": [)_" << change.before.time.count() << ", " << change.after.time.count()
+               << R"_(], "time_change": )_" << static_cast<long>(change.timeChange())
+               << R"_(, "time_ratio": )_" << ratio(change.timeRatio()) << R"_(, "tuples": [)_"
+               << change.before.tuples << ", " << change.after.tuples << R"_(], "tuples_change": )_"
+               << static_cast<long>(change.tupleChange()) << R"_(, "tuples_ratio": )_"
+               << ratio(change.tupleRatio()) << "}";
+        }
+        os << "\n]";
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
@@ -0,0 +1,217 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+#pragma once
+
+#include "ProgramRun.h"
+#include "StringUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+/*
+ * Class estimating the sizes and runtimes of the relations of a full evaluation from the runs of a
+ * program on samples of its inputs, loaded with --input-sample=RATE.
+ *
+ * The number of tuples and the runtime of each relation are fitted by a power of the sample rate, by a
+ * least-squares fit of their logarithms, and extrapolated to the rate 1. The exponent of the fit tells
+ * how a relation scales with its inputs: about 1 for a linear relation, and 2 or more for a relation
+ * growing quadratically, e.g. by a join without selective keys. A single run, or runs of a single rate,
+ * are extrapolated linearly. The time of loading the inputs, which are read completely, is not scaled.
+ */
+class EstimateGenerator {
+public:
+    /** The orders of the estimates, by the estimated runtime or number of tuples */
+    static const std::vector<std::string>& getOrders() {
+        static const std::vector<std::string> orders = {"time", "tuples"};
+        return orders;
+    }
+
+    /** A run of the program on a sample of its inputs */
+    struct Run {
+        const ProgramRun* run;
+        double rate;
+    };
+
+    static void write(std::ostream& os, const std::vector<Run>& runs, const std::string& order, bool json,
+            size_t limit) {
+        std::vector<Estimate> relations = estimate(runs);
+        std::stable_sort(relations.begin(), relations.end(), [&](const Estimate& a, const Estimate& b) {
+            return order == "tuples" ? a.tuples.estimate > b.tuples.estimate
+                                     : a.time.estimate > b.time.estimate;
+        });
+        double total = 0;
+        for (const Estimate& relation : relations) {
+            total += relation.time.estimate;
+        }
+        const auto load = std::max_element(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+            return a.rate < b.rate;
+        })->run->getTotalLoadtime();
+
+        if (json) {
+            os << R"_({"order": ")_" << order << R"_(", "rates": [)_";
+            for (size_t i = 0; i < runs.size(); ++i) {
+                os << (i == 0 ? "" : ", ") << runs[i].rate;
+            }
+            os << R"_(], "time": )_" << static_cast<long>(total) << R"_(, "load_time": )_" << load.count()
+               << R"_(, "relations": )_";
+            writeJson(os, relations, limit);
+            os << "}\n";
+        } else {
+            os << "Estimated from runs at the sample rates";
+            for (size_t i = 0; i < runs.size(); ++i) {
+                os << (i == 0 ? " " : ", ") << runs[i].rate;
+            }
+            os << "\nEstimated evaluation time " << Tools::formatTime(micros(total))
+               << ", loading the inputs " << Tools::formatTime(load) << "\n";
+            os << "Relations ranked by estimated " << order << "\n";
+            writeTable(os, relations, limit);
+        }
+    }
+
+private:
+    /** A measure of the runs, fitted by a power of the sample rate */
+    struct Fit {
+        /** the measure of the run of the highest rate */
+        double sampled = 0;
+        /** the measure extrapolated to the rate 1 */
+        double estimate = 0;
+        /** the exponent of the rate */
+        double exponent = 1;
+    };
+
+    /** The estimated runtime and number of tuples of a relation */
+    struct Estimate {
+        std::string name;
+        Fit time;
+        Fit tuples;
+    };
+
+    static std::chrono::microseconds micros(double value) {
+        return std::chrono::microseconds(static_cast<long>(value));
+    }
+
+    /** Fit the measures of the runs at the given rates; runs measuring zero are left out */
+    static Fit fit(const std::vector<double>& rates, const std::vector<double>& values) {
+        Fit res;
+        double highest = 0;
+        std::vector<double> xs;
+        std::vector<double> ys;
+        for (size_t i = 0; i < rates.size(); ++i) {
+            if (rates[i] > highest) {
+                highest = rates[i];
+                res.sampled = values[i];
+            }
+            if (values[i] > 0) {
+                xs.push_back(std::log(rates[i]));
+                ys.push_back(std::log(values[i]));
+            }
+        }
+        if (xs.empty()) {
+            return res;
+        }
+        const double n = static_cast<double>(xs.size());
+        double meanX = 0;
+        double meanY = 0;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            meanX += xs[i] / n;
+            meanY += ys[i] / n;
+        }
+        double covariance = 0;
+        double variance = 0;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            covariance += (xs[i] - meanX) * (ys[i] - meanY);
+            variance += (xs[i] - meanX) * (xs[i] - meanX);
+        }
+        // runs of a single rate are extrapolated linearly
+        if (variance > 1e-12) {
+            res.exponent = covariance / variance;
+        }
+        // the fitted line at the rate 1, whose logarithm is 0
+        res.estimate = std::exp(meanY - res.exponent * meanX);
+        return res;
+    }
+
+    static std::vector<Estimate> estimate(const std::vector<Run>& runs) {
+        // the measures of each relation in the runs, zero if it is missing from a run
+        std::map<std::string, std::vector<double>> times;
+        std::map<std::string, std::vector<double>> tuples;
+        std::vector<double> rates;
+        for (size_t i = 0; i < runs.size(); ++i) {
+            rates.push_back(runs[i].rate);
+            for (const auto& cur : runs[i].run->getRelationMap()) {
+                const Relation& relation = *cur.second;
+                auto& time = times[relation.getName()];
+                auto& size = tuples[relation.getName()];
+                time.resize(runs.size(), 0);
+                size.resize(runs.size(), 0);
+                time[i] += static_cast<double>(
+                        (relation.getNonRecTime() + relation.getRecTime() + relation.getCopyTime()).count());
+                size[i] += static_cast<double>(relation.size());
+            }
+        }
+        std::vector<Estimate> res;
+        for (const auto& cur : times) {
+            res.push_back({cur.first, fit(rates, cur.second), fit(rates, tuples[cur.first])});
+        }
+        return res;
+    }
+
+    static std::string formatExponent(const Fit& fit) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.2f", fit.exponent);
+        return text;
+    }
+
+    static void writeTable(std::ostream& os, const std::vector<Estimate>& estimates, size_t limit) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%10s%10s%8s%10s%10s%8s  %s\n", "TIME", "EST TIME", "EXP",
+                "TUPLES", "EST TUP", "EXP", "NAME");
+        os << line;
+        for (size_t i = 0; i < std::min(limit, estimates.size()); ++i) {
+            const Estimate& cur = estimates[i];
+            std::snprintf(line, sizeof(line), "%10s%10s%8s%10s%10s%8s  ",
+                    Tools::formatTime(micros(cur.time.sampled)).c_str(),
+                    Tools::formatTime(micros(cur.time.estimate)).c_str(), formatExponent(cur.time).c_str(),
+                    Tools::formatNum(3, static_cast<int64_t>(cur.tuples.sampled)).c_str(),
+                    Tools::formatNum(3, static_cast<int64_t>(cur.tuples.estimate)).c_str(),
+                    formatExponent(cur.tuples).c_str());
+            os << line << cur.name << "\n";
+        }
+    }
+
+    static void writeJson(std::ostream& os, const std::vector<Estimate>& estimates, size_t limit) {
+        auto writeFit = [&](const Fit& fit) {
+            os << "{\"sampled\": " << static_cast<long>(fit.sampled)
+               << ", \"estimate\": " << static_cast<long>(fit.estimate)
+               << ", \"exponent\": " << Tools::cleanJsonOut(fit.exponent) << "}";
+        };
+        os << "[";
+        for (size_t i = 0; i < std::min(limit, estimates.size()); ++i) {
+            const Estimate& cur = estimates[i];
+            os << (i == 0 ? "\n" : ",\n") << R"_({"name": ")_" << Tools::cleanJsonOut(cur.name)
+               << R"_(", "time": )_";
+            writeFit(cur.time);
+            os << R"_(, "tuples": )_";
+            writeFit(cur.tuples);
+            os << "}";
+        }
+        os << "\n]";
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
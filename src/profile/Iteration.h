@@ -27,6 +27,7 @@ private:
     std::chrono::microseconds starttime{};
     std::chrono::microseconds endtime{};
     size_t numTuples = 0;
+    size_t deltaTuples = 0;
     std::chrono::microseconds copytime{};
     std::string locator = "";
 
@@ -75,6 +76,15 @@ public:
         this->numTuples = numTuples;
     }
 
+    /** The number of tuples of the delta relation the iteration is evaluated on */
+    size_t getDeltaSize() const {
+        return deltaTuples;
+    }
+
+    void setDeltaTuples(size_t deltaTuples) {
+        this->deltaTuples = deltaTuples;
+    }
+
     std::chrono::microseconds getCopytime() const {
         return copytime;
     }
@@ -0,0 +1,244 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+#pragma once
+
+#include "ProgramRun.h"
+#include "Reader.h"
+#include "StringUtils.h"
+#include "../ParallelUtils.h"
+#include "../ServerSocket.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace souffle {
+namespace profile {
+
+/*
+ * Endpoint serving the profile of the running program over HTTP, for monitoring headless runs.
+ *
+ * The endpoint listens on a Unix socket, given as "unix:PATH", or on a TCP port, given as "PORT" for
+ * the loopback interface or as "HOST:PORT". It answers requests of "/metrics" in the Prometheus text
+ * format and requests of "/" or "/json" in JSON; each request folds the events recorded so far and
+ * reads the relation sizes, iterations and run times from the profile database anew.
+ */
+class LiveEndpoint {
+public:
+    /** Resource usage of the process */
+    struct Usage {
+        std::chrono::microseconds usertime{};
+        std::chrono::microseconds systemtime{};
+        /** maximum resident set size in bytes */
+        size_t maxRSS = 0;
+    };
+
+    explicit LiveEndpoint(const std::string& address) : run(std::make_shared<ProgramRun>()), reader(run) {
+        listener = openServerSocket(address, socketPath);
+        if (listener < 0) {
+            std::cerr << "Cannot open profile endpoint <" << address << ">\n";
+            return;
+        }
+        running = true;
+        server = TaskPool::instance().submitService([this]() { serve(); });
+    }
+
+    ~LiveEndpoint() {
+        running = false;
+        if (server.valid()) {
+            server.wait();
+        }
+        if (listener >= 0) {
+            close(listener);
+        }
+        if (!socketPath.empty()) {
+            unlink(socketPath.c_str());
+        }
+    }
+
+    /** Return the resource usage of the process so far */
+    static Usage getUsage() {
+        struct rusage ru {};
+        getrusage(RUSAGE_SELF, &ru);
+        Usage usage;
+        usage.usertime =
+                std::chrono::seconds(ru.ru_utime.tv_sec) + std::chrono::microseconds(ru.ru_utime.tv_usec);
+        usage.systemtime =
+                std::chrono::seconds(ru.ru_stime.tv_sec) + std::chrono::microseconds(ru.ru_stime.tv_usec);
+        usage.maxRSS = static_cast<size_t>(ru.ru_maxrss) * 1024;
+        return usage;
+    }
+
+    /** Write the metrics of a program run in the Prometheus text format */
+    static void writeMetrics(std::ostream& os, const ProgramRun& run, bool live, const Usage& usage) {
+        auto metric = [&](const std::string& name, const std::string& type, const std::string& help) {
+            os << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+        };
+        metric("souffle_running", "gauge", "Whether the program is still running.");
+        os << "souffle_running " << (live ? 1 : 0) << "\n";
+        metric("souffle_runtime_seconds", "gauge", "Time since the start of the program.");
+        os << "souffle_runtime_seconds " << seconds(run.getEndtime() - run.getStarttime()) << "\n";
+        metric("souffle_cpu_user_seconds_total", "counter", "User CPU time of the process.");
+        os << "souffle_cpu_user_seconds_total " << seconds(usage.usertime) << "\n";
+        metric("souffle_cpu_system_seconds_total", "counter", "System CPU time of the process.");
+        os << "souffle_cpu_system_seconds_total " << seconds(usage.systemtime) << "\n";
+        metric("souffle_max_rss_bytes", "gauge", "Maximum resident set size of the process.");
+        os << "souffle_max_rss_bytes " << usage.maxRSS << "\n";
+        if (!run.getMemoryUsage().empty()) {
+            metric("souffle_stratum", "gauge", "Last stratum whose memory usage was recorded.");
+            os << "souffle_stratum " << run.getMemoryUsage().rbegin()->first << "\n";
+        }
+        metric("souffle_tuples", "gauge", "Tuples computed by all relations.");
+        os << "souffle_tuples " << run.getTotalSize() << "\n";
+
+        metric("souffle_relation_tuples", "gauge", "Tuples computed by the relation.");
+        for (const auto& cur : run.getRelationMap()) {
+            os << "souffle_relation_tuples" << label(cur.first) << " " << cur.second->size() << "\n";
+        }
+        metric("souffle_relation_iterations", "gauge", "Iterations of the fixpoint of the relation.");
+        for (const auto& cur : run.getRelationMap()) {
+            os << "souffle_relation_iterations" << label(cur.first) << " "
+               << cur.second->getIterations().size() << "\n";
+        }
+        metric("souffle_relation_runtime_seconds", "gauge", "Time spent computing the relation.");
+        for (const auto& cur : run.getRelationMap()) {
+            os << "souffle_relation_runtime_seconds" << label(cur.first) << " "
+               << seconds(runtime(*cur.second)) << "\n";
+        }
+        metric("souffle_relation_tuples_per_second", "gauge", "Tuples computed by the relation per second.");
+        for (const auto& cur : run.getRelationMap()) {
+            os << "souffle_relation_tuples_per_second" << label(cur.first) << " " << throughput(*cur.second)
+               << "\n";
+        }
+    }
+
+    /** Write the metrics of a program run in JSON */
+    static void writeJson(std::ostream& os, const ProgramRun& run, bool live, const Usage& usage) {
+        os << R"_({"running": )_" << (live ? "true" : "false");
+        os << R"_(, "runtime": )_" << seconds(run.getEndtime() - run.getStarttime());
+        os << R"_(, "user-time": )_" << seconds(usage.usertime);
+        os << R"_(, "system-time": )_" << seconds(usage.systemtime);
+        os << R"_(, "max-rss": )_" << usage.maxRSS;
+        if (!run.getMemoryUsage().empty()) {
+            os << R"_(, "stratum": )_" << run.getMemoryUsage().rbegin()->first;
+        }
+        os << R"_(, "tuples": )_" << run.getTotalSize();
+        os << R"_(, "relations": {)_";
+        bool first = true;
+        for (const auto& cur : run.getRelationMap()) {
+            const Relation& relation = *cur.second;
+            os << (first ? "" : ", ") << '"' << Tools::cleanJsonOut(cur.first) << R"_(": {"tuples": )_"
+               << relation.size() << R"_(, "iterations": )_" << relation.getIterations().size()
+               << R"_(, "runtime": )_" << seconds(runtime(relation)) << R"_(, "tuples-per-second": )_"
+               << throughput(relation) << "}";
+            first = false;
+        }
+        os << "}}\n";
+    }
+
+private:
+    std::shared_ptr<ProgramRun> run;
+    Reader reader;
+    int listener = -1;
+    std::string socketPath;
+    std::atomic<bool> running{false};
+    TaskPool::Task<void> server;
+
+    static double seconds(std::chrono::microseconds time) {
+        return time.count() / 1000000.0;
+    }
+
+    static std::chrono::microseconds runtime(const Relation& relation) {
+        return relation.getNonRecTime() + relation.getRecTime() + relation.getCopyTime();
+    }
+
+    static double throughput(const Relation& relation) {
+        const double time = seconds(runtime(relation));
+        return time > 0 ? relation.size() / time : 0;
+    }
+
+    /** Label of a relation, escaped as the Prometheus text format requires */
+    static std::string label(const std::string& relation) {
+        std::string res = "{relation=\"";
+        for (char c : relation) {
+            if (c == '\\' || c == '"') {
+                res += '\\';
+            }
+            res += c;
+        }
+        return res + "\"}";
+    }
+
+    /** Answer requests until the endpoint is destroyed, checking for its destruction every 0.5s */
+    void serve() {
+        while (running) {
+            pollfd pfd{listener, POLLIN, 0};
+            if (poll(&pfd, 1, 500) <= 0) {
+                continue;
+            }
+            const int client = accept(listener, nullptr, nullptr);
+            if (client >= 0) {
+                respond(client);
+                close(client);
+            }
+        }
+    }
+
+    /** Read the request line of a client and send the profile in the requested format */
+    void respond(int client) {
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+            const ssize_t count = recv(client, buffer, sizeof(buffer), 0);
+            if (count <= 0) {
+                break;
+            }
+            request.append(buffer, count);
+        }
+        const std::string target = request.substr(0, request.find("\r\n"));
+        std::string path;
+        std::istringstream(target) >> path >> path;
+
+        std::string status = "200 OK";
+        std::string type;
+        std::stringstream body;
+        if (path == "/metrics" || path == "/" || path == "/json") {
+            reader.processFile();
+            const Usage usage = getUsage();
+            if (path == "/metrics") {
+                type = "text/plain; version=0.0.4";
+                writeMetrics(body, *run, reader.isLive(), usage);
+            } else {
+                type = "application/json";
+                writeJson(body, *run, reader.isLive(), usage);
+            }
+        } else {
+            status = "404 Not Found";
+            type = "text/plain";
+            body << "Use /metrics or /json.\n";
+        }
+
+        const std::string content = body.str();
+        std::stringstream response;
+        response << "HTTP/1.0 " << status << "\r\nContent-Type: " << type
+                 << "\r\nContent-Length: " << content.size() << "\r\nConnection: close\r\n\r\n"
+                 << content;
+        sendAll(client, response.str());
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
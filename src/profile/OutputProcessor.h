@@ -114,6 +114,9 @@ Table inline OutputProcessor::getRelTable() const {
  * ROW[8] = PERFOR
  * ROW[9] = VER
  * ROW[10]= REL_NAME
+ * ROW[11]= INSTRUCTIONS
+ * ROW[12]= CACHE MISSES
+ * ROW[13]= BRANCH MISSES
  */
 Table inline OutputProcessor::getRulTable() const {
     const std::unordered_map<std::string, std::shared_ptr<Relation>>& relationMap =
@@ -122,7 +125,7 @@ Table inline OutputProcessor::getRulTable() const {
 
     for (auto& rel : relationMap) {
         for (auto& current : rel.second->getRuleMap()) {
-            Row row(11);
+            Row row(14);
             std::shared_ptr<Rule> rule = current.second;
             row[0] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
             row[1] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
@@ -134,6 +137,9 @@ Table inline OutputProcessor::getRulTable() const {
             row[7] = std::make_shared<Cell<std::string>>(rel.second->getName());
             row[8] = std::make_shared<Cell<long>>(0);
             row[10] = std::make_shared<Cell<std::string>>(rule->getLocator());
+            row[11] = std::make_shared<Cell<long>>(rule->getInstructions());
+            row[12] = std::make_shared<Cell<long>>(rule->getCacheMisses());
+            row[13] = std::make_shared<Cell<long>>(rule->getBranchMisses());
             ruleMap.emplace(rule->getName(), std::make_shared<Row>(row));
         }
         for (auto& iter : rel.second->getIterations()) {
@@ -146,9 +152,12 @@ Table inline OutputProcessor::getRulTable() const {
                     row[4] = std::make_shared<Cell<long>>(row[4]->getLongVal() + rule->size());
                     row[0] = std::make_shared<Cell<std::chrono::microseconds>>(
                             row[0]->getTimeVal() + rule->getRuntime());
+                    row[11] = std::make_shared<Cell<long>>(row[11]->getLongVal() + rule->getInstructions());
+                    row[12] = std::make_shared<Cell<long>>(row[12]->getLongVal() + rule->getCacheMisses());
+                    row[13] = std::make_shared<Cell<long>>(row[13]->getLongVal() + rule->getBranchMisses());
                     ruleMap[rule->getName()] = std::make_shared<Row>(row);
                 } else {
-                    Row row(11);
+                    Row row(14);
                     row[0] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
                     row[1] = std::make_shared<Cell<std::chrono::microseconds>>(std::chrono::microseconds(0));
                     row[2] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
@@ -159,6 +168,9 @@ Table inline OutputProcessor::getRulTable() const {
                     row[7] = std::make_shared<Cell<std::string>>(rel.second->getName());
                     row[8] = std::make_shared<Cell<long>>(rule->getVersion());
                     row[10] = std::make_shared<Cell<std::string>>(rule->getLocator());
+                    row[11] = std::make_shared<Cell<long>>(rule->getInstructions());
+                    row[12] = std::make_shared<Cell<long>>(rule->getCacheMisses());
+                    row[13] = std::make_shared<Cell<long>>(rule->getBranchMisses());
                     ruleMap[rule->getName()] = std::make_shared<Row>(row);
                 }
             }
@@ -269,6 +281,9 @@ Table inline OutputProcessor::getSubrulTable(std::string strRel, std::string str
  * ROW[8] = PERFOR
  * ROW[9] = VER
  * ROW[10]= REL_NAME
+ * ROW[11]= INSTRUCTIONS
+ * ROW[12]= CACHE MISSES
+ * ROW[13]= BRANCH MISSES
  */
 Table inline OutputProcessor::getVersions(std::string strRel, std::string strRul) const {
     const std::unordered_map<std::string, std::shared_ptr<Relation>>& relationMap =
@@ -11,7 +11,10 @@
 #include "Relation.h"
 #include "StringUtils.h"
 #include "Table.h"
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <set>
 #include <sstream>
@@ -32,6 +35,38 @@ private:
     std::chrono::microseconds startTime{0};
     std::chrono::microseconds endTime{0};
 
+    // number of executions of the searches of each relation, keyed by their signature
+    std::map<std::string, std::map<uint64_t, size_t>> searches;
+
+    // number of tuples found by the searches of each relation, keyed by their signature
+    std::map<std::string, std::map<uint64_t, size_t>> searchTuples;
+
+public:
+    /** Hits and misses of the operation hints of each index, keyed by the index and the operation */
+    using HintStatistics = std::map<size_t, std::map<std::string, std::array<size_t, 2>>>;
+
+    /** Estimated memory usage recorded at the end of a stratum */
+    struct MemoryUsage {
+        std::chrono::microseconds time{0};
+        // bytes occupied by each index of the relations computed or expired by the stratum
+        std::map<std::string, std::vector<size_t>> relations;
+        size_t symbolTable = 0;
+        size_t recordTable = 0;
+    };
+
+private:
+    // memory usage at the end of each stratum, keyed by the index of the stratum
+    std::map<size_t, MemoryUsage> memory;
+
+    // hits and misses of the operation hints of the indexes of each relation
+    std::map<std::string, HintStatistics> hints;
+
+    // samples of the CPU time attributed to each rule, keyed by its message, and to other work
+    std::map<std::string, size_t> samples;
+
+    // utilisation of the threads of the parallel loops of each rule, keyed by its message and the metric
+    std::map<std::string, std::map<std::string, size_t>> parallelLoops;
+
 public:
     ProgramRun() : relationMap() {}
 
@@ -123,6 +158,67 @@ public:
         return result;
     }
 
+    void addSearches(const std::string& relation, uint64_t signature, size_t count) {
+        searches[relation][signature] += count;
+    }
+
+    /** Return the number of executions of the searches of a relation, keyed by their signature */
+    const std::map<uint64_t, size_t>* getSearches(const std::string& relation) const {
+        auto pos = searches.find(relation);
+        return pos != searches.end() ? &pos->second : nullptr;
+    }
+
+    void addSearchTuples(const std::string& relation, uint64_t signature, size_t count) {
+        searchTuples[relation][signature] += count;
+    }
+
+    /** Return the number of tuples found by the searches of a relation, keyed by their signature */
+    const std::map<uint64_t, size_t>* getSearchTuples(const std::string& relation) const {
+        auto pos = searchTuples.find(relation);
+        return pos != searchTuples.end() ? &pos->second : nullptr;
+    }
+
+    /** Return the hits and misses of the operation hints of the indexes of each relation */
+    HintStatistics& getHintStatistics(const std::string& relation) {
+        return hints[relation];
+    }
+
+    const std::map<std::string, HintStatistics>& getHintStatistics() const {
+        return hints;
+    }
+
+    /** Return the memory usage recorded at the end of a stratum, creating it if necessary */
+    MemoryUsage& getMemoryUsage(size_t stratum) {
+        return memory[stratum];
+    }
+
+    /** Return the memory usage recorded at the end of each stratum, keyed by the index of the stratum */
+    const std::map<size_t, MemoryUsage>& getMemoryUsage() const {
+        return memory;
+    }
+
+    void setSamples(const std::string& rule, size_t count) {
+        samples[rule] = count;
+    }
+
+    /** Return the samples of the CPU time attributed to each rule, and to other work under "other" */
+    const std::map<std::string, size_t>& getSamples() const {
+        return samples;
+    }
+
+    void setParallelLoops(const std::string& rule, const std::string& metric, size_t value) {
+        parallelLoops[rule][metric] = value;
+    }
+
+    /**
+     * Return the utilisation of the threads of the parallel loops of each rule, and of the loops outside
+     * of rules under "other", keyed by the metric, e.g. "busy" and "idle" for the microseconds the
+     * threads worked and waited for the last thread of a loop
+     */
+    const std::map<std::string, std::map<std::string, size_t>>& getParallelLoops() const {
+        return parallelLoops;
+    }
+
     const Relation* getRelation(const std::string& name) const {
         if (relationMap.find(name) != relationMap.end()) {
             return &(*relationMap.at(name));
@@ -9,12 +9,15 @@
 #pragma once
 
 #include "../ProfileDatabase.h"
+#include "../ParallelUtils.h"
 #include "../ProfileEvent.h"
 #include "Iteration.h"
 #include "ProgramRun.h"
 #include "Relation.h"
 #include "Rule.h"
 #include "StringUtils.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdlib>
@@ -22,8 +25,8 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <set>
 #include <string>
-#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -85,6 +88,18 @@ private:
     Rule& rule;
 };
 
+/**
+ * Visit ProfileDB hardware counters of a rule.
+ * counters: {instructions: num, cache-misses: num, branch-misses: num}
+ */
+void visitCounters(DirectoryEntry& directory, Rule& rule) {
+    auto read = [&](const std::string& key) -> size_t {
+        auto* count = dynamic_cast<SizeEntry*>(directory.readEntry(key));
+        return count == nullptr ? 0 : count->getSize();
+    };
+    rule.setCounters(read("instructions"), read("cache-misses"), read("branch-misses"));
+}
+
 /**
  * Visit ProfileDB recursive rule.
  * ruleversion: {DSN}
@@ -98,6 +113,8 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            visitCounters(directory, base);
         }
     }
 };
@@ -143,6 +160,8 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            visitCounters(directory, base);
         }
     }
 };
@@ -181,6 +200,12 @@ public:
         }
         DSNVisitor::visit(duration);
     }
+    void visit(SizeEntry& size) override {
+        if (size.getKey() == "delta-tuples") {
+            base.setDeltaTuples(size.getSize());
+        }
+        DSNVisitor::visit(size);
+    }
     void visit(DirectoryEntry& directory) override {
         if (directory.getKey() == "recursive-rule") {
             RecursiveRulesVisitor rulesVisitor(base, relation);
@@ -239,8 +264,13 @@ public:
     }
     void visit(DirectoryEntry& directory) override {
         if (directory.getKey() == "iteration") {
+            // visit the iterations in the order of their numbers rather than their names
+            const std::set<std::string> names = directory.getKeys();
+            std::vector<std::string> keys(names.begin(), names.end());
+            std::stable_sort(keys.begin(), keys.end(),
+                    [](const std::string& a, const std::string& b) { return a.size() < b.size(); });
             IterationsVisitor iterationsVisitor(base);
-            for (const auto& key : directory.getKeys()) {
+            for (const auto& key : keys) {
                 directory.readEntry(key)->accept(iterationsVisitor);
             }
         } else if (directory.getKey() == "non-recursive-rule") {
@@ -253,6 +283,17 @@ public:
             auto* postMaxRSS = dynamic_cast<SizeEntry*>(directory.readEntry("post"));
             base.setPreMaxRSS(preMaxRSS->getSize());
             base.setPostMaxRSS(postMaxRSS->getSize());
+        } else if (directory.getKey() == "statistics") {
+            if (auto* cardinality = dynamic_cast<SizeEntry*>(directory.readEntry("num-tuples"))) {
+                base.setCardinality(cardinality->getSize());
+            }
+            if (auto* distinct = dynamic_cast<DirectoryEntry*>(directory.readEntry("distinct-values"))) {
+                for (const auto& key : distinct->getKeys()) {
+                    if (auto* count = dynamic_cast<SizeEntry*>(distinct->readEntry(key))) {
+                        base.setDistinctValues(std::stoul(key), count->getSize());
+                    }
+                }
+            }
         }
     }
     void visit(SizeEntry& size) override {
@@ -282,10 +323,14 @@ private:
 public:
     std::shared_ptr<ProgramRun> run;
 
-    Reader(std::string filename, std::shared_ptr<ProgramRun> run)
+    /**
+     * Read a profile log; only the given relations are loaded from a profile stream, unless none
+     * are given
+     */
+    Reader(std::string filename, std::shared_ptr<ProgramRun> run, const std::set<std::string>& relations = {})
             : file_loc(std::move(filename)), run(std::move(run)) {
         try {
-            ProfileEventSingleton::instance().setDBFromFile(file_loc);
+            ProfileEventSingleton::instance().setDBFromFile(file_loc, relations);
         } catch (const std::exception& e) {
             std::cerr << e.what() << std::endl;
             exit(1);
@@ -297,6 +342,8 @@ public:
      * Read the contents from file into the class
      */
     void processFile() {
+        // fold the events of a running program
+        ProfileEventSingleton::instance().fold();
         rel_id = 0;
         relationMap.clear();
         auto programDuration = dynamic_cast<DurationEntry*>(db.lookupEntry({"program", "runtime"}));
@@ -312,17 +359,41 @@ public:
             online = false;
         }
 
+        // programs sampled without instrumentation only record samples
+        if (auto* samples = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "samples"}))) {
+            for (const auto& rule : samples->getKeys()) {
+                if (auto* count = dynamic_cast<SizeEntry*>(samples->readEntry(rule))) {
+                    run->setSamples(rule, count->getSize());
+                }
+            }
+        }
+
+        if (auto* loops = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "parallel-loops"}))) {
+            for (const auto& rule : loops->getKeys()) {
+                if (auto* metrics = dynamic_cast<DirectoryEntry*>(loops->readEntry(rule))) {
+                    for (const auto& metric : metrics->getKeys()) {
+                        if (auto* value = dynamic_cast<SizeEntry*>(metrics->readEntry(metric))) {
+                            run->setParallelLoops(rule, metric, value->getSize());
+                        }
+                    }
+                }
+            }
+        }
+
         auto relations = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "relation"}));
         if (relations == nullptr) {
-            // Souffle hasn't generated any profiling information yet.
+            // Souffle hasn't generated any profiling information yet, unless it was sampled
+            loaded = !run->getSamples().empty();
             return;
         }
+        std::vector<const DirectoryEntry*> entries;
         for (const auto& cur : relations->getKeys()) {
             auto relation = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "relation", cur}));
             if (relation != nullptr) {
-                addRelation(*relation);
+                entries.push_back(relation);
             }
         }
+        addRelations(entries);
         for (const auto& relation : relationMap) {
             for (const auto& rule : relation.second->getRuleMap()) {
                 for (const auto& atom : rule.second->getAtoms()) {
@@ -344,6 +415,42 @@ public:
             }
         }
         run->setRelationMap(this->relationMap);
+        if (auto* searches = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "searches"}))) {
+            for (const auto& relation : searches->getKeys()) {
+                if (auto* counts = dynamic_cast<DirectoryEntry*>(searches->readEntry(relation))) {
+                    for (const auto& signature : counts->getKeys()) {
+                        if (auto* count = dynamic_cast<SizeEntry*>(counts->readEntry(signature))) {
+                            run->addSearches(relation, std::stoull(signature), count->getSize());
+                        }
+                    }
+                }
+            }
+        }
+        if (auto* tuples = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "search-tuples"}))) {
+            for (const auto& relation : tuples->getKeys()) {
+                if (auto* counts = dynamic_cast<DirectoryEntry*>(tuples->readEntry(relation))) {
+                    for (const auto& signature : counts->getKeys()) {
+                        if (auto* count = dynamic_cast<SizeEntry*>(counts->readEntry(signature))) {
+                            run->addSearchTuples(relation, std::stoull(signature), count->getSize());
+                        }
+                    }
+                }
+            }
+        }
+        if (auto* hints = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "hints"}))) {
+            for (const auto& relation : hints->getKeys()) {
+                if (auto* indexes = dynamic_cast<DirectoryEntry*>(hints->readEntry(relation))) {
+                    addHintStatistics(run->getHintStatistics(relation), *indexes);
+                }
+            }
+        }
+        if (auto* memory = dynamic_cast<DirectoryEntry*>(db.lookupEntry({"program", "memory"}))) {
+            for (const auto& stratum : memory->getKeys()) {
+                if (auto* entry = dynamic_cast<DirectoryEntry*>(memory->readEntry(stratum))) {
+                    addMemoryUsage(std::stoul(stratum), *entry);
+                }
+            }
+        }
         loaded = true;
     }
 
@@ -353,15 +460,90 @@ public:
         return online;
     }
 
+    void addHintStatistics(ProgramRun::HintStatistics& statistics, const DirectoryEntry& indexes) {
+        for (const auto& index : indexes.getKeys()) {
+            auto* operations = dynamic_cast<DirectoryEntry*>(indexes.readEntry(index));
+            if (operations == nullptr) {
+                continue;
+            }
+            for (const auto& operation : operations->getKeys()) {
+                auto* outcomes = dynamic_cast<DirectoryEntry*>(operations->readEntry(operation));
+                if (outcomes == nullptr) {
+                    continue;
+                }
+                auto& counts = statistics[std::stoul(index)][operation];
+                if (auto* hits = dynamic_cast<SizeEntry*>(outcomes->readEntry("hits"))) {
+                    counts[0] = hits->getSize();
+                }
+                if (auto* misses = dynamic_cast<SizeEntry*>(outcomes->readEntry("misses"))) {
+                    counts[1] = misses->getSize();
+                }
+            }
+        }
+    }
+
+    void addMemoryUsage(size_t stratum, const DirectoryEntry& entry) {
+        ProgramRun::MemoryUsage& usage = run->getMemoryUsage(stratum);
+        if (auto* time = dynamic_cast<TimeEntry*>(entry.readEntry("time"))) {
+            usage.time = time->getTime();
+        }
+        if (auto* symbolTable = dynamic_cast<SizeEntry*>(entry.readEntry("symbol-table"))) {
+            usage.symbolTable = symbolTable->getSize();
+        }
+        if (auto* recordTable = dynamic_cast<SizeEntry*>(entry.readEntry("record-table"))) {
+            usage.recordTable = recordTable->getSize();
+        }
+        if (auto* relations = dynamic_cast<DirectoryEntry*>(entry.readEntry("relation"))) {
+            for (const auto& name : relations->getKeys()) {
+                auto* indexes = dynamic_cast<DirectoryEntry*>(relations->readEntry(name));
+                if (indexes == nullptr) {
+                    continue;
+                }
+                std::vector<size_t>& bytes = usage.relations[name];
+                for (const auto& index : indexes->getKeys()) {
+                    if (auto* size = dynamic_cast<SizeEntry*>(indexes->readEntry(index))) {
+                        const size_t i = std::stoul(index);
+                        bytes.resize(std::max(bytes.size(), i + 1));
+                        bytes[i] = size->getSize();
+                    }
+                }
+            }
+        }
+    }
+
     void addRelation(const DirectoryEntry& relation) {
-        const std::string& name = cleanRelationName(relation.getKey());
+        addRelations({&relation});
+    }
 
-        relationMap.emplace(name, std::make_shared<Relation>(name, createId()));
-        auto& rel = *relationMap[name];
-        RelationVisitor relationVisitor(rel);
+    /**
+     * Add the given relations; their iterations and rules are read in parallel, since each relation
+     * only refers to its own entries of the profile
+     */
+    void addRelations(const std::vector<const DirectoryEntry*>& relations) {
+        std::vector<Relation*> targets;
+        for (const DirectoryEntry* relation : relations) {
+            const std::string& name = cleanRelationName(relation->getKey());
+            relationMap.emplace(name, std::make_shared<Relation>(name, createId()));
+            targets.push_back(relationMap[name].get());
+        }
 
-        for (const auto& key : relation.getKeys()) {
-            relation.readEntry(key)->accept(relationVisitor);
+        std::atomic<size_t> next{0};
+        auto read = [&]() {
+            for (size_t i; (i = next++) < relations.size();) {
+                RelationVisitor relationVisitor(*targets[i]);
+                for (const auto& key : relations[i]->getKeys()) {
+                    relations[i]->readEntry(key)->accept(relationVisitor);
+                }
+            }
+        };
+        const size_t numThreads = std::min(relations.size(), TaskPool::instance().getCapacity());
+        std::vector<TaskPool::Task<void>> readers;
+        for (size_t i = 1; i < numThreads; ++i) {
+            readers.push_back(TaskPool::instance().submit(read));
+        }
+        read();
+        for (auto& reader : readers) {
+            reader.wait();
         }
     }
 
@@ -11,6 +11,7 @@
 #include "Iteration.h"
 #include "Rule.h"
 #include <chrono>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -40,6 +41,11 @@ private:
     int recursiveId = 0;
     size_t tuplesRead = 0;
 
+    // the relation statistics of cost-based optimisations
+    bool hasStatistics = false;
+    size_t cardinality = 0;
+    std::map<size_t, size_t> distinctValues;
+
     std::vector<std::shared_ptr<Iteration>> iterations;
 
     std::unordered_map<std::string, std::shared_ptr<Rule>> ruleMap;
@@ -246,6 +252,29 @@ public:
     void addReads(size_t tuplesRead) {
         this->tuplesRead += tuplesRead;
     }
+
+    /** Whether the number of tuples and distinct values of the relation were recorded */
+    bool hasCardinality() const {
+        return hasStatistics;
+    }
+
+    size_t getCardinality() const {
+        return cardinality;
+    }
+
+    void setCardinality(size_t cardinality) {
+        hasStatistics = true;
+        this->cardinality = cardinality;
+    }
+
+    /** Return the estimated number of distinct values of each recorded column */
+    const std::map<size_t, size_t>& getDistinctValues() const {
+        return distinctValues;
+    }
+
+    void setDistinctValues(size_t column, size_t count) {
+        distinctValues[column] = count;
+    }
 };
 
 }  // namespace profile
@@ -53,6 +53,9 @@ protected:
     std::string identifier;
     std::string locator{};
     std::set<Atom> atoms;
+    size_t instructions{0};
+    size_t cacheMisses{0};
+    size_t branchMisses{0};
 
 private:
     bool recursive = false;
@@ -80,7 +83,7 @@ public:
         return endtime;
     }
 
-    long size() {
+    long size() const {
         return numTuples;
     }
 
@@ -96,6 +99,24 @@ public:
         this->numTuples = numTuples;
     }
 
+    size_t getInstructions() const {
+        return instructions;
+    }
+
+    size_t getCacheMisses() const {
+        return cacheMisses;
+    }
+
+    size_t getBranchMisses() const {
+        return branchMisses;
+    }
+
+    void setCounters(size_t instructions, size_t cacheMisses, size_t branchMisses) {
+        this->instructions = instructions;
+        this->cacheMisses = cacheMisses;
+        this->branchMisses = branchMisses;
+    }
+
     void addAtomFrequency(const std::string& subruleName, std::string atom, size_t level, size_t frequency) {
         atoms.emplace(atom, subruleName, level, frequency);
     }
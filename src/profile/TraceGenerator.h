@@ -0,0 +1,134 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+#pragma once
+
+#include "ProgramRun.h"
+#include "StringUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+/*
+ * Class exporting the timings of relations, iterations and rules of a program run as a Chrome trace
+ * event file, to be viewed in chrome://tracing, Perfetto or other trace viewers.
+ *
+ * The profile does not record the threads evaluating relations and rules. Events are therefore
+ * placed on tracks such that the events of each track are disjoint or nested, one track for a
+ * sequential run; events overlapping without nesting, e.g. of strata evaluated concurrently, are
+ * placed on separate tracks, which shows the concurrency of the run and the gaps in between.
+ */
+class TraceGenerator {
+public:
+    static void write(std::ostream& os, const ProgramRun& run) {
+        std::vector<Event> events;
+        for (const auto& cur : run.getRelationMap()) {
+            const Relation& relation = *cur.second;
+            addEvent(events, relation.getName(), "relation", relation.getStarttime(), relation.getEndtime(),
+                    relation.getLocator(), static_cast<long>(relation.size()));
+            for (const auto& rule : relation.getRuleMap()) {
+                addRuleEvent(events, *rule.second);
+            }
+            for (const auto& iteration : relation.getIterations()) {
+                addEvent(events, relation.getName(), "iteration", iteration->getStarttime(),
+                        iteration->getEndtime(), relation.getLocator(), static_cast<long>(iteration->size()));
+                for (const auto& rule : iteration->getRules()) {
+                    addRuleEvent(events, *rule.second);
+                }
+            }
+        }
+
+        // enclosing events precede the events they enclose
+        std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+            if (a.start != b.start) {
+                return a.start < b.start;
+            }
+            return a.end > b.end;
+        });
+        const size_t trackCount = assignTracks(events);
+
+        os << R"_({"displayTimeUnit": "ms", "traceEvents": [)_" << '\n';
+        os << R"_({"name": "process_name", "ph": "M", "pid": 0, "tid": 0, "args": {"name": "souffle"}})_";
+        for (size_t track = 0; track < trackCount; ++track) {
+            os << ",\n"
+               << R"_({"name": "thread_name", "ph": "M", "pid": 0, "tid": )_" << track
+               << R"_(, "args": {"name": "track )_" << track << R"_("}})_";
+        }
+        for (const auto& event : events) {
+            os << ",\n"
+               << R"_({"name": ")_" << Tools::cleanJsonOut(event.name) << R"_(", "cat": ")_" << event.category
+               << R"_(", "ph": "X", "pid": 0, "tid": )_" << event.track
+               << R"_(, "ts": )_" << (event.start - run.getStarttime()).count()
+               << R"_(, "dur": )_" << (event.end - event.start).count() << R"_(, "args": {"source": ")_"
+               << Tools::cleanJsonOut(event.locator) << R"_(", "tuples": )_" << event.tuples << "}}";
+        }
+        os << "\n]}\n";
+    }
+
+private:
+    struct Event {
+        std::string name;
+        std::string category;
+        std::chrono::microseconds start;
+        std::chrono::microseconds end;
+        std::string locator;
+        long tuples;
+        size_t track;
+    };
+
+    static void addEvent(std::vector<Event>& events, const std::string& name, const std::string& category,
+            std::chrono::microseconds start, std::chrono::microseconds end, const std::string& locator,
+            long tuples) {
+        // relations and rules of older profiles or evaluated by recursion have no timing of their own
+        if (end <= start || start.count() == 0) {
+            return;
+        }
+        events.push_back({name, category, start, end, locator, tuples, 0});
+    }
+
+    static void addRuleEvent(std::vector<Event>& events, const Rule& rule) {
+        const std::string category = rule.isRecursive() ? "recursive-rule" : "non-recursive-rule";
+        addEvent(events, rule.getName(), category, rule.getStarttime(), rule.getEndtime(), rule.getLocator(),
+                rule.size());
+    }
+
+    /**
+     * Place the events, sorted by their start, on the first track they are disjoint from or nested
+     * in; return the number of tracks
+     */
+    static size_t assignTracks(std::vector<Event>& events) {
+        // ends of the events enclosing the current event on each track
+        std::vector<std::vector<std::chrono::microseconds>> open;
+        for (auto& event : events) {
+            size_t track = 0;
+            for (; track < open.size(); ++track) {
+                auto& ends = open[track];
+                while (!ends.empty() && ends.back() <= event.start) {
+                    ends.pop_back();
+                }
+                if (ends.empty() || event.end <= ends.back()) {
+                    break;
+                }
+            }
+            if (track == open.size()) {
+                open.emplace_back();
+            }
+            open[track].push_back(event.end);
+            event.track = track;
+        }
+        return std::max<size_t>(open.size(), 1);
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
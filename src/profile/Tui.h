@@ -13,14 +13,16 @@
 #include "OutputProcessor.h"
 #include "Reader.h"
 #include "Table.h"
+#include "TraceGenerator.h"
 #include "UserInputReader.h"
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
-#include <thread>
 #include <vector>
 #include <dirent.h>
 #include <sys/ioctl.h>
@@ -42,7 +44,8 @@ private:
     bool loaded;
     std::string f_name;
     bool alive = false;
-    std::thread updater;
+    // updates the display of a live profile every 30s, checking for input every 0.5s
+    std::unique_ptr<PeriodicTask> updater;
     int sortColumn = 0;
     int precision = 3;
     Table relationTable;
@@ -63,7 +66,7 @@ private:
     };
 
 public:
-    Tui(std::string filename, bool live, bool gui) {
+    Tui(std::string filename, bool live, bool gui, const std::set<std::string>& relations = {}) {
         // Set a friendlier output size if we're being interacted with directly.
         if (live) {
             resultLimit = 20;
@@ -72,7 +75,7 @@ public:
 
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
 
-        this->reader = std::make_shared<Reader>(filename, run);
+        this->reader = std::make_shared<Reader>(filename, run, relations);
 
         this->alive = false;
         updateDB();
@@ -85,23 +88,22 @@ public:
         this->loaded = true;
         this->alive = true;
         updateDB();
-        updater = std::thread([this]() {
-            // Update the display every 30s. Check for input every 0.5s
-            std::chrono::milliseconds interval(30000);
-            auto nextUpdateTime = std::chrono::high_resolution_clock::now();
-            do {
-                std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                if (nextUpdateTime < std::chrono::high_resolution_clock::now()) {
-                    runCommand({});
-                    nextUpdateTime = std::chrono::high_resolution_clock::now() + interval;
-                }
-            } while (reader->isLive() && !linereader.hasReceivedInput());
-        });
+        auto nextUpdateTime = std::chrono::high_resolution_clock::now();
+        updater = std::make_unique<PeriodicTask>(
+                [this, nextUpdateTime]() mutable {
+                    if (nextUpdateTime < std::chrono::high_resolution_clock::now()) {
+                        runCommand({});
+                        nextUpdateTime = std::chrono::high_resolution_clock::now() + std::chrono::seconds(30);
+                    }
+                    return reader->isLive() && !linereader.hasReceivedInput();
+                },
+                std::chrono::milliseconds(500));
+        updater->start(std::chrono::milliseconds(500));
     }
 
     ~Tui() {
-        if (updater.joinable()) {
-            updater.join();
+        if (updater != nullptr) {
+            updater->stop();
         }
     }
 
@@ -165,8 +167,32 @@ public:
             } else {
                 std::cout << "Invalid parameters to graph command.\n";
             }
+        } else if (c[0] == "samples") {
+            samples(resultLimit);
+        } else if (c[0] == "parallel") {
+            parallelLoops(resultLimit);
+        } else if (c[0] == "searches") {
+            if (c.size() <= 2) {
+                searches(c.size() == 2 ? c[1] : "");
+            } else {
+                std::cout << "Invalid parameters to searches command.\n";
+            }
         } else if (c[0] == "memory") {
-            memoryUsage();
+            if (c.size() == 1) {
+                memoryUsage();
+            } else if (c.size() == 2 && c[1] == "timeline") {
+                memoryTimeline();
+            } else if (c.size() == 2 && c[1] == "relations") {
+                memoryRelations(resultLimit);
+            } else {
+                std::cout << "Invalid parameters to memory command.\n";
+            }
+        } else if (c[0] == "hot") {
+            if (c.size() == 2 && isNumber(c[1].c_str())) {
+                hot(std::stoul(c[1]));
+            } else {
+                std::cout << "Invalid parameters to hot command.\n";
+            }
         } else if (c[0] == "usage") {
             if (c.size() > 1) {
                 if (c[1][0] == 'R') {
@@ -294,25 +320,26 @@ public:
             ss << "], ";
             std::vector<std::shared_ptr<Iteration>> iter =
                     run->getRelation(row[5]->toString(0))->getIterations();
-            ss << R"_({"tot_t": [)_";
-            firstCol = true;
-            for (auto& i : iter) {
-                comma(firstCol);
-                ss << i->getRuntime().count();
-            }
-            ss << R"_(], "copy_t": [)_";
-            firstCol = true;
-            for (auto& i : iter) {
-                comma(firstCol);
-                ss << i->getCopytime().count();
-            }
-            ss << R"_(], "tuples": [)_";
-            firstCol = true;
+            std::vector<int64_t> runtimes;
+            std::vector<int64_t> copytimes;
+            std::vector<uint64_t> tuples;
+            std::vector<uint64_t> deltas;
             for (auto& i : iter) {
-                comma(firstCol);
-                ss << i->size();
-            }
-            ss << "]}]";
+                runtimes.push_back(i->getRuntime().count());
+                copytimes.push_back(i->getCopytime().count());
+                tuples.push_back(i->size());
+                deltas.push_back(i->getDeltaSize());
+            }
+            const size_t step = getChartStep(iter.size());
+            ss << R"_({"step": )_" << step << R"_(, "tot_t": )_";
+            genJsonIterations(ss, runtimes, step);
+            ss << R"_(, "copy_t": )_";
+            genJsonIterations(ss, copytimes, step);
+            ss << R"_(, "tuples": )_";
+            genJsonIterations(ss, tuples, step);
+            ss << R"_(, "delta": )_";
+            genJsonIterations(ss, deltas, step);
+            ss << "}]";
         }
         ss << "}";
 
@@ -391,12 +418,10 @@ public:
             ss << "], ";
 
             if (row[6]->toString(0).at(0) != 'C') {
-                ss << "{}, {}]";
+                ss << "{}, {}";
             } else {
-                ss << R"_({"tot_t": [)_";
-
+                std::vector<int64_t> iteration_times;
                 std::vector<uint64_t> iteration_tuples;
-                bool firstCol = true;
                 for (auto& i : run->getRelation(row[7]->toString(0))->getIterations()) {
                     bool add = false;
                     std::chrono::microseconds totalTime{};
@@ -410,19 +435,17 @@ public:
                         }
                     }
                     if (add) {
-                        comma(firstCol);
-                        ss << totalTime.count();
+                        iteration_times.push_back(totalTime.count());
                         iteration_tuples.push_back(totalSize);
                     }
                 }
-                ss << R"_(], "tuples": [)_";
-                firstCol = true;
-                for (auto& i : iteration_tuples) {
-                    comma(firstCol);
-                    ss << i;
-                }
+                const size_t step = getChartStep(iteration_times.size());
+                ss << R"_({"step": )_" << step << R"_(, "tot_t": )_";
+                genJsonIterations(ss, iteration_times, step);
+                ss << R"_(, "tuples": )_";
+                genJsonIterations(ss, iteration_tuples, step);
 
-                ss << "]}, {";
+                ss << "}, {";
 
                 if (has_ver) {
                     ss << R"_("tot_t": [)_";
@@ -441,13 +464,34 @@ public:
                     }
                     ss << ']';
                 }
-                ss << "}]";
+                ss << "}";
             }
+            ss << ", " << row[11]->getLongVal() << ", " << row[12]->getLongVal() << ", "
+               << row[13]->getLongVal() << "]";
         }
         ss << "\n}";
         return ss;
     }
 
+    /** Get the number of consecutive iterations summed up by a point of an iteration chart */
+    static size_t getChartStep(size_t numIterations) {
+        return std::max<size_t>(1, (numIterations + MAX_CHART_POINTS - 1) / MAX_CHART_POINTS);
+    }
+
+    /** Output the values of iterations as a JSON array, summing up step consecutive iterations each */
+    template <typename T>
+    static void genJsonIterations(std::stringstream& ss, const std::vector<T>& values, size_t step) {
+        ss << '[';
+        for (size_t i = 0; i < values.size(); i += step) {
+            T sum{};
+            for (size_t j = i; j < std::min(values.size(), i + step); ++j) {
+                sum += values[j];
+            }
+            ss << (i == 0 ? "" : ", ") << sum;
+        }
+        ss << ']';
+    }
+
     std::stringstream& genJsonUsage(std::stringstream& ss) {
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
 
@@ -616,6 +660,17 @@ public:
         return ss.str();
     }
 
+    /** export the timings of the profile as a Chrome trace event file */
+    void outputTrace(const std::string& filename) {
+        std::ofstream outfile(filename);
+        if (!outfile.is_open()) {
+            std::cerr << "Cannot open trace file <" << filename << ">" << std::endl;
+            exit(2);
+        }
+        TraceGenerator::write(outfile, *out.getProgramRun());
+        std::cout << "trace output to: " << filename << std::endl;
+    }
+
     void outputHtml(std::string filename = "profiler_html/") {
         std::cout << "SouffleProf\n";
         std::cout << "Generating HTML files...\n";
@@ -660,8 +715,8 @@ public:
     }
 
     void quit() {
-        if (updater.joinable()) {
-            updater.join();
+        if (updater != nullptr) {
+            updater->stop();
         }
     }
 
@@ -675,7 +730,7 @@ public:
         std::printf(
                 "  %-30s%-5s %s\n", "rul id <rule id>", "-", "display the rule name for the given rule id.");
         std::printf("  %-30s%-5s %s\n", "graph <relation id> <type>", "-",
-                "graph a relation by type: (tot_t/copy_t/tuples).");
+                "graph a relation by type: (tot_t/copy_t/tuples/delta).");
         std::printf("  %-30s%-5s %s\n", "graph <rule id> <type>", "-",
                 "graph recursive(C) rule by type(tot_t/tuples).");
         std::printf("  %-30s%-5s %s\n", "graph ver <rule id> <type>", "-",
@@ -685,6 +740,18 @@ public:
         std::printf("  %-30s%-5s %s\n", "usage [relation id|rule id]", "-",
                 "display CPU usage graphs for a relation or rule.");
         std::printf("  %-30s%-5s %s\n", "memory", "-", "display memory usage.");
+        std::printf("  %-30s%-5s %s\n", "samples", "-",
+                "display the share of the sampled CPU time spent in each rule.");
+        std::printf("  %-30s%-5s %s\n", "parallel", "-",
+                "display the idle time and load imbalance of the threads of the parallel loops of rules.");
+        std::printf("  %-30s%-5s %s\n", "searches [relation name]", "-",
+                "display the searches and operation hints of the indexes of relations.");
+        std::printf("  %-30s%-5s %s\n", "memory timeline", "-",
+                "display the memory of relations, symbols and records at the end of each stratum.");
+        std::printf("  %-30s%-5s %s\n", "memory relations", "-",
+                "display the peak memory of each relation and its indexes.");
+        std::printf("  %-30s%-5s %s\n", "hot <N>", "-",
+                "list the N relations taking the most time and the N taking the most memory.");
         std::printf("  %-30s%-5s %s\n", "help", "-", "print this.");
 
         std::cout << "\nInteractive mode only commands:" << std::endl;
@@ -965,6 +1032,274 @@ public:
         }
         std::cout << std::endl;
     }
+    /** Format a search signature as the list of the columns it binds */
+    static std::string formatSignature(uint64_t signature) {
+        std::string res;
+        for (size_t column = 0; signature >> column != 0; ++column) {
+            if (((signature >> column) & 1) != 0) {
+                res += (res.empty() ? "" : ",") + std::to_string(column);
+            }
+        }
+        return "{" + res + "}";
+    }
+
+    /**
+     * Display the executions of the searches of a relation, or of all relations, with the tuples they
+     * found, and the hits and misses of the operation hints of their indexes
+     */
+    void searches(const std::string& name) {
+        const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
+        std::set<std::string> relations;
+        for (const auto& cur : run->getHintStatistics()) {
+            relations.insert(cur.first);
+        }
+        for (const auto& cur : run->getRelationMap()) {
+            if (run->getSearches(cur.first) != nullptr) {
+                relations.insert(cur.first);
+            }
+        }
+        if (!name.empty()) {
+            if (relations.count(name) == 0) {
+                std::cout << "No searches recorded for relation " << name << ".\n";
+                return;
+            }
+            relations = {name};
+        }
+
+        for (const auto& relation : relations) {
+            std::cout << "Relation " << relation << "\n";
+            if (const auto* counts = run->getSearches(relation)) {
+                const auto* tuples = run->getSearchTuples(relation);
+                std::printf("  %-20s%10s%10s%12s\n", "SEARCH", "CALLS", "TUPLES", "TUPLES/CALL");
+                for (const auto& count : *counts) {
+                    size_t found = 0;
+                    if (tuples != nullptr && tuples->count(count.first) > 0) {
+                        found = tuples->at(count.first);
+                    }
+                    std::string ratio = "-";
+                    if (count.second != 0) {
+                        ratio = Tools::formatNum(static_cast<double>(found) / count.second);
+                    }
+                    std::printf("  %-20s%10s%10s%12s\n", formatSignature(count.first).c_str(),
+                            Tools::formatNum(precision, count.second).c_str(),
+                            Tools::formatNum(precision, found).c_str(), ratio.c_str());
+                }
+            }
+            const auto& hints = run->getHintStatistics();
+            auto pos = hints.find(relation);
+            if (pos != hints.end()) {
+                std::printf("  %-8s%-14s%10s%10s%10s\n", "INDEX", "OPERATION", "HITS", "MISSES", "HIT RATE");
+                for (const auto& index : pos->second) {
+                    for (const auto& operation : index.second) {
+                        const size_t total = operation.second[0] + operation.second[1];
+                        const std::string rate =
+                                total == 0 ? "-" : std::to_string(100 * operation.second[0] / total) + "%";
+                        std::printf("  %-8zu%-14s%10s%10s%10s\n", index.first, operation.first.c_str(),
+                                Tools::formatNum(precision, operation.second[0]).c_str(),
+                                Tools::formatNum(precision, operation.second[1]).c_str(), rate.c_str());
+                    }
+                }
+            }
+            std::cout << "\n";
+        }
+    }
+
+    /** Total bytes occupied by the indexes of a relation */
+    static size_t totalMemory(const std::vector<size_t>& indexes) {
+        size_t total = 0;
+        for (size_t bytes : indexes) {
+            total += bytes;
+        }
+        return total;
+    }
+
+    /** Display the memory recorded at the end of each stratum, in the order the strata completed */
+    void memoryTimeline() {
+        const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
+        std::vector<std::pair<size_t, const ProgramRun::MemoryUsage*>> strata;
+        for (const auto& cur : run->getMemoryUsage()) {
+            strata.emplace_back(cur.first, &cur.second);
+        }
+        if (strata.empty()) {
+            std::cout << "No memory usage recorded for this run.\n";
+            return;
+        }
+        std::stable_sort(strata.begin(), strata.end(),
+                [](const auto& a, const auto& b) { return a.second->time < b.second->time; });
+
+        std::printf("%10s%9s%11s%11s%11s  %s\n", "TIME", "STRATUM", "RELATIONS", "SYMBOLS", "RECORDS",
+                "LARGEST RELATION");
+        for (const auto& stratum : strata) {
+            const ProgramRun::MemoryUsage& usage = *stratum.second;
+            size_t relations = 0;
+            size_t largest = 0;
+            std::string largestName = "-";
+            for (const auto& relation : usage.relations) {
+                const size_t bytes = totalMemory(relation.second);
+                relations += bytes;
+                if (bytes > largest) {
+                    largest = bytes;
+                    largestName = relation.first;
+                }
+            }
+            std::printf("%10s%9zu%11s%11s%11s  %s\n",
+                    Tools::formatTime(usage.time - run->getStarttime()).c_str(), stratum.first,
+                    Tools::formatMemory(relations / 1024).c_str(),
+                    Tools::formatMemory(usage.symbolTable / 1024).c_str(),
+                    Tools::formatMemory(usage.recordTable / 1024).c_str(), largestName.c_str());
+        }
+    }
+
+    /** The memory of the indexes of each relation at the end of the stratum it took the most memory */
+    std::map<std::string, std::vector<size_t>> getPeakMemory() const {
+        std::map<std::string, std::vector<size_t>> peaks;
+        for (const auto& stratum : out.getProgramRun()->getMemoryUsage()) {
+            for (const auto& relation : stratum.second.relations) {
+                auto& peak = peaks[relation.first];
+                if (totalMemory(relation.second) >= totalMemory(peak)) {
+                    peak = relation.second;
+                }
+            }
+        }
+        return peaks;
+    }
+
+    /** Display the peak memory of each relation, and of its indexes at the peak, largest first */
+    void memoryRelations(size_t limit) {
+        const std::map<std::string, std::vector<size_t>> peaks = getPeakMemory();
+        if (peaks.empty()) {
+            std::cout << "No memory usage recorded for this run.\n";
+            return;
+        }
+        std::vector<std::pair<std::string, std::vector<size_t>>> sorted(peaks.begin(), peaks.end());
+        std::stable_sort(sorted.begin(), sorted.end(),
+                [](const auto& a, const auto& b) { return totalMemory(a.second) > totalMemory(b.second); });
+
+        std::printf("%11s  %-30s %s\n", "PEAK", "NAME", "INDEXES");
+        for (size_t i = 0; i < sorted.size() && i < limit; ++i) {
+            std::string indexes;
+            for (size_t bytes : sorted[i].second) {
+                indexes += (indexes.empty() ? "" : " ") + Tools::formatMemory(bytes / 1024);
+            }
+            std::printf("%11s  %-30s %s\n", Tools::formatMemory(totalMemory(sorted[i].second) / 1024).c_str(),
+                    sorted[i].first.c_str(), indexes.c_str());
+        }
+    }
+
+    /**
+     * List the N relations taking the most time and the N relations taking the most memory, by most time
+     * first, as lines of the name, the seconds and the peak bytes separated by tabs, e.g. for souffle-tune
+     */
+    void hot(size_t limit) {
+        const std::map<std::string, std::vector<size_t>> peaks = getPeakMemory();
+        std::map<std::string, std::pair<double, size_t>> usage;
+        for (const auto& cur : out.getProgramRun()->getRelationMap()) {
+            const Relation& rel = *cur.second;
+            const auto time = rel.getNonRecTime() + rel.getRecTime() + rel.getCopyTime();
+            usage[cur.first].first = std::chrono::duration<double>(time).count();
+        }
+        for (const auto& cur : peaks) {
+            usage[cur.first].second = totalMemory(cur.second);
+        }
+
+        std::vector<std::pair<std::string, std::pair<double, size_t>>> byTime(usage.begin(), usage.end());
+        auto byMemory = byTime;
+        std::stable_sort(byTime.begin(), byTime.end(),
+                [](const auto& a, const auto& b) { return a.second.first > b.second.first; });
+        std::stable_sort(byMemory.begin(), byMemory.end(),
+                [](const auto& a, const auto& b) { return a.second.second > b.second.second; });
+        std::set<std::string> hotMemory;
+        for (size_t i = 0; i < byMemory.size() && i < limit; ++i) {
+            hotMemory.insert(byMemory[i].first);
+        }
+        for (size_t i = 0; i < byTime.size(); ++i) {
+            if (i < limit || hotMemory.count(byTime[i].first) != 0) {
+                std::printf("%s\t%.6f\t%zu\n", byTime[i].first.c_str(), byTime[i].second.first,
+                        byTime[i].second.second);
+            }
+        }
+    }
+
+    /** Display the share of the samples of the CPU time attributed to each rule, largest first */
+    void samples(size_t limit) {
+        const auto& counts = out.getProgramRun()->getSamples();
+        size_t total = 0;
+        for (const auto& cur : counts) {
+            total += cur.second;
+        }
+        if (total == 0) {
+            std::cout << "No samples recorded for this run; sample a program with --profile-sampling.\n";
+            return;
+        }
+        std::vector<std::pair<std::string, size_t>> sorted(counts.begin(), counts.end());
+        std::stable_sort(sorted.begin(), sorted.end(),
+                [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        std::printf("%7s %9s  %s\n", "CPU", "SAMPLES", "RULE");
+        for (size_t i = 0; i < sorted.size() && i < limit; ++i) {
+            // show the rule and its location on one line
+            std::string rule = sorted[i].first;
+            for (size_t pos = 0; (pos = rule.find("\\n", pos)) != std::string::npos;) {
+                rule.replace(pos, 2, " ");
+            }
+            std::replace(rule.begin(), rule.end(), '\n', ' ');
+            std::printf("%6.2f%% %9s  %s\n", 100.0 * sorted[i].second / total,
+                    Tools::formatNum(precision, sorted[i].second).c_str(), rule.c_str());
+        }
+    }
+
+    /**
+     * Display the utilisation of the threads of the parallel loops of each rule, most idle time first.
+     * The imbalance of a loop is the time of its last thread over the mean time of its threads, and the
+     * imbalance of chunks the chunks of the busiest thread over the mean chunks of its threads; both
+     * are averaged over the executions of the loops, being 1 for perfectly balanced loops.
+     */
+    void parallelLoops(size_t limit) {
+        const auto& loops = out.getProgramRun()->getParallelLoops();
+        if (loops.empty()) {
+            std::cout << "No parallel loops recorded for this run; profile a program with --profile.\n";
+            return;
+        }
+        auto metric = [](const std::map<std::string, size_t>& metrics, const std::string& name) {
+            auto pos = metrics.find(name);
+            return pos == metrics.end() ? 0.0 : static_cast<double>(pos->second);
+        };
+        std::vector<std::pair<std::string, const std::map<std::string, size_t>*>> sorted;
+        for (const auto& cur : loops) {
+            sorted.emplace_back(cur.first, &cur.second);
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [&](const auto& a, const auto& b) {
+            return metric(*a.second, "idle") > metric(*b.second, "idle");
+        });
+
+        std::printf("%9s %9s %7s %10s %10s %6s %7s %7s  %s\n", "LOOPS", "FORKED", "THREADS", "BUSY(s)",
+                "IDLE(s)", "IDLE", "IMBAL", "CHUNKS", "RULE");
+        for (size_t i = 0; i < sorted.size() && i < limit; ++i) {
+            const auto& metrics = *sorted[i].second;
+            const double executions = metric(metrics, "executions");
+            const double threads = metric(metrics, "threads");
+            const double busy = metric(metrics, "busy");
+            const double idle = metric(metrics, "idle");
+            const double chunks = metric(metrics, "chunks");
+            const double imbalance =
+                    busy > 0 ? metric(metrics, "critical") * threads / (busy * executions) : 1;
+            const double chunkImbalance =
+                    chunks > 0 ? metric(metrics, "max-chunks") * threads / (chunks * executions) : 1;
+            // show the rule and its location on one line
+            std::string rule = sorted[i].first;
+            for (size_t pos = 0; (pos = rule.find("\\n", pos)) != std::string::npos;) {
+                rule.replace(pos, 2, " ");
+            }
+            std::replace(rule.begin(), rule.end(), '\n', ' ');
+            std::printf("%9s %9s %7.2f %10.3f %10.3f %5.1f%% %7.2f %7.2f  %s\n",
+                    Tools::formatNum(precision, static_cast<int64_t>(executions)).c_str(),
+                    Tools::formatNum(precision, static_cast<int64_t>(metric(metrics, "forked"))).c_str(),
+                    executions > 0 ? threads / executions : 0.0, busy / 1e6, idle / 1e6,
+                    busy + idle > 0 ? 100.0 * idle / (busy + idle) : 0.0, imbalance, chunkImbalance,
+                    rule.c_str());
+        }
+    }
+
     void setupTabCompletion() {
         linereader.clearTabCompletion();
 
@@ -976,7 +1311,12 @@ public:
         linereader.appendTabCompletion("help");
         linereader.appendTabCompletion("usage");
         linereader.appendTabCompletion("limit ");
+        linereader.appendTabCompletion("samples");
+        linereader.appendTabCompletion("parallel");
+        linereader.appendTabCompletion("searches");
         linereader.appendTabCompletion("memory");
+        linereader.appendTabCompletion("memory timeline");
+        linereader.appendTabCompletion("memory relations");
         linereader.appendTabCompletion("configuration");
 
         // add rel tab completes after the rest so users can see all commands first
@@ -985,6 +1325,7 @@ public:
             linereader.appendTabCompletion("graph " + row[5] + " tot_t");
             linereader.appendTabCompletion("graph " + row[5] + " copy_t");
             linereader.appendTabCompletion("graph " + row[5] + " tuples");
+            linereader.appendTabCompletion("graph " + row[5] + " delta");
             linereader.appendTabCompletion("usage " + row[5]);
         }
     }
@@ -1089,8 +1430,8 @@ public:
     void rul(size_t limit, bool showLimit = true) {
         ruleTable.sort(sortColumn);
         std::cout << "  ----- Rule Table -----\n";
-        std::printf(
-                "%8s%8s%8s%8s%8s%8s %s\n\n", "TOT_T", "NREC_T", "REC_T", "TUPLES", "TUP/s", "ID", "RELATION");
+        std::printf("%8s%8s%8s%8s%8s%8s%8s%8s%8s %s\n\n", "TOT_T", "NREC_T", "REC_T", "TUPLES", "TUP/s",
+                "INSTR", "C_MISS", "B_MISS", "ID", "RELATION");
         size_t count = 0;
         for (auto& row : Tools::formatTable(ruleTable, precision)) {
             if (++count > limit) {
@@ -1099,8 +1440,9 @@ public:
                 }
                 break;
             }
-            std::printf("%8s%8s%8s%8s%8s%8s %s\n", row[0].c_str(), row[1].c_str(), row[2].c_str(),
-                    row[4].c_str(), row[9].c_str(), row[6].c_str(), row[7].c_str());
+            std::printf("%8s%8s%8s%8s%8s%8s%8s%8s%8s %s\n", row[0].c_str(), row[1].c_str(), row[2].c_str(),
+                    row[4].c_str(), row[9].c_str(), row[11].c_str(), row[12].c_str(), row[13].c_str(),
+                    row[6].c_str(), row[7].c_str());
         }
     }
 
@@ -1259,6 +1601,8 @@ public:
                     }
                     std::printf("%4s   %s\n\n", "NO", "TUPLES");
                     graphBySize(list);
+                } else if (col == "delta") {
+                    graphConvergence(iter);
                 }
                 return;
             }
@@ -1289,6 +1633,8 @@ public:
                     }
                     std::printf("%4s   %s\n\n", "NO", "TUPLES");
                     graphBySize(list);
+                } else if (col == "delta") {
+                    graphConvergence(iter);
                 }
                 return;
             }
@@ -1380,6 +1726,18 @@ public:
     }
 
     void graphByTime(std::vector<std::chrono::microseconds> list) {
+        if (list.size() > MAX_GRAPH_ROWS) {
+            std::vector<double> values;
+            for (auto& d : list) {
+                values.push_back(d.count() / 1000000.0);
+            }
+            graphSummary(values, [](double value) {
+                char text[32];
+                std::snprintf(text, sizeof(text), "%10.8f", value);
+                return std::string(text);
+            });
+            return;
+        }
         std::chrono::microseconds max{};
         for (auto& d : list) {
             if (d > max) {
@@ -1402,6 +1760,13 @@ public:
     }
 
     void graphBySize(std::vector<size_t> list) {
+        if (list.size() > MAX_GRAPH_ROWS) {
+            std::vector<double> values(list.begin(), list.end());
+            graphSummary(values, [&](double value) {
+                return Tools::formatNum(precision, static_cast<size_t>(value));
+            });
+            return;
+        }
         size_t max = 0;
         for (auto& l : list) {
             if (l > max) {
@@ -1422,7 +1787,99 @@ public:
         }
     }
 
+    /**
+     * Graph the sizes of the deltas the iterations of a recursive relation are evaluated on, in the
+     * order of the iterations, followed by the share of the runtime spent on the tail of iterations
+     * whose deltas are tiny compared to the largest one.
+     */
+    void graphConvergence(const std::vector<std::shared_ptr<Iteration>>& iterations) {
+        size_t peak = 0;
+        for (auto& i : iterations) {
+            peak = std::max(peak, i->getDeltaSize());
+        }
+        if (peak == 0) {
+            std::cout << "No delta sizes recorded for this relation.\n";
+            return;
+        }
+
+        // sum up consecutive iterations if there are too many to graph one by one
+        const size_t step = (iterations.size() + MAX_GRAPH_ROWS - 1) / MAX_GRAPH_ROWS;
+        std::vector<size_t> deltas;
+        std::vector<std::chrono::microseconds> runtimes;
+        for (size_t i = 0; i < iterations.size(); i += step) {
+            size_t delta = 0;
+            std::chrono::microseconds runtime{};
+            for (size_t j = i; j < std::min(iterations.size(), i + step); ++j) {
+                delta += iterations[j]->getDeltaSize();
+                runtime += iterations[j]->getRuntime();
+            }
+            deltas.push_back(delta);
+            runtimes.push_back(runtime);
+        }
+        const size_t max = *std::max_element(deltas.begin(), deltas.end());
+        std::printf("%6s %8s %12s\n\n", "NO", "DELTA", "RUNTIME");
+        for (size_t i = 0; i < deltas.size(); ++i) {
+            const std::string bar(static_cast<size_t>(48.0 * deltas[i] / max), '*');
+            std::printf("%6zu %8s %12.6f | %s\n", i * step, Tools::formatNum(precision, deltas[i]).c_str(),
+                    runtimes[i].count() / 1000000.0, bar.c_str());
+        }
+
+        // the tail of iterations deriving from deltas below a percent of the largest one
+        size_t tail = 0;
+        std::chrono::microseconds tailRuntime{};
+        std::chrono::microseconds runtime{};
+        for (auto& i : iterations) {
+            runtime += i->getRuntime();
+        }
+        for (auto i = iterations.rbegin(); i != iterations.rend() && (*i)->getDeltaSize() * 100 < peak; ++i) {
+            ++tail;
+            tailRuntime += (*i)->getRuntime();
+        }
+        std::printf("\n%zu of %zu iterations evaluated deltas below 1%% of the largest, taking %.1f%% of the "
+                    "runtime\n",
+                tail, iterations.size(),
+                runtime.count() == 0 ? 0.0 : 100.0 * tailRuntime.count() / runtime.count());
+    }
+
+    /**
+     * Summarise the values of many iterations by their percentiles, and a histogram of the
+     * number of iterations whose values fall into equally wide ranges.
+     */
+    template <typename F>
+    void graphSummary(std::vector<double> values, const F& format) {
+        std::sort(values.begin(), values.end());
+        std::printf("%zu iterations\n\n", values.size());
+        for (size_t percentile : {100, 99, 90, 75, 50, 25, 0}) {
+            const std::string label = percentile == 100 ? "max" : percentile == 0 ? "min"
+                                                                 : "p" + std::to_string(percentile);
+            const size_t pos = (values.size() - 1) * percentile / 100;
+            std::printf("%4s %s\n", label.c_str(), format(values[pos]).c_str());
+        }
+        std::printf("\n%10s %8s\n", "UP TO", "NO");
+
+        const double max = values.back();
+        std::vector<size_t> counts(HISTOGRAM_BUCKETS, 0);
+        for (double value : values) {
+            counts[max <= 0 ? 0 : std::min<size_t>(HISTOGRAM_BUCKETS - 1, value / max * HISTOGRAM_BUCKETS)]++;
+        }
+        const size_t maxCount = *std::max_element(counts.begin(), counts.end());
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+            const std::string bar(56 * counts[i] / maxCount, '*');
+            std::printf("%10s %8zu | %s\n", format(max * (i + 1) / HISTOGRAM_BUCKETS).c_str(), counts[i],
+                    bar.c_str());
+        }
+    }
+
 protected:
+    /** Maximal number of points of the iteration charts of the HTML output */
+    static constexpr size_t MAX_CHART_POINTS = 512;
+
+    /** Maximal number of iterations graphed one by one, more are summarised */
+    static constexpr size_t MAX_GRAPH_ROWS = 64;
+
+    /** Number of ranges of the histograms summarising iterations */
+    static constexpr size_t HISTOGRAM_BUCKETS = 16;
+
     void verAtoms(Table& atomTable, const std::string& ruleName = "") {
         // If there are no subrules then just print out any atoms found
         // If we do find subrules, then label atoms with their subrules.
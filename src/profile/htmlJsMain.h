@@ -51,8 +51,10 @@ function graphRel() {
     graph_vals.labels = [];
     graph_vals.tot_t = [];
     graph_vals.tuples = [];
+    graph_vals.delta = data.rel[selected.rel][9].delta || [];
+    var step = data.rel[selected.rel][9].step || 1;
     for (j = 0; j < data.rel[selected.rel][9].tot_t.length; j++) {
-        graph_vals.labels.push(j.toString());
+        graph_vals.labels.push((j * step).toString());
         graph_vals.tot_t.push(
             data.rel[selected.rel][9].tot_t[j]
         );
@@ -76,8 +78,10 @@ function graphIterRul() {
     graph_vals.labels = [];
     graph_vals.tot_t = [];
     graph_vals.tuples = [];
+    graph_vals.delta = [];
+    var step = data.rul[selected.rul][9].step || 1;
     for (j = 0; j < data.rul[selected.rul][9].tot_t.length; j++) {
-        graph_vals.labels.push(j.toString());
+        graph_vals.labels.push((j * step).toString());
         graph_vals.tot_t.push(
             data.rul[selected.rul][9].tot_t[j]
         );
@@ -182,6 +186,16 @@ function drawGraph() {
         labels: graph_vals.labels,
         series: [graph_vals.tuples],
     }, options)
+
+    // the delta sizes outline how the fixpoint of a recursive relation converges
+    var delta = document.getElementById("chart-delta");
+    delta.style.display = graph_vals.delta.some(function (v) { return v > 0; }) ? "block" : "none";
+    if (delta.style.display === "block") {
+        new Chartist.Line(".ct-chart3", {
+            labels: graph_vals.labels,
+            series: [graph_vals.delta],
+        }, options)
+    }
 }
 
 
@@ -332,6 +346,26 @@ function generate_table(data_format,body_id,data_key) {
     }
 }
 
+function show_page(body_id, page) {
+    var rows = document.getElementById(body_id).rows;
+    var last = Math.max(0, Math.ceil(rows.length / page_rows) - 1);
+    page = Math.min(Math.max(page, 0), last);
+    pages[body_id] = page;
+    for (var i = 0; i < rows.length; i++) {
+        rows[i].style.display = (Math.floor(i / page_rows) === page) ? "" : "none";
+    }
+    document.getElementById(body_id + "_pager").innerHTML = "Rows " +
+        Math.min(rows.length, page * page_rows + 1) + " to " +
+        Math.min(rows.length, (page + 1) * page_rows) + " of " + rows.length;
+}
+
+function paginate(table_id, body_id) {
+    document.getElementById(table_id).addEventListener('afterSort', function () {
+        show_page(body_id, 0);
+    });
+    show_page(body_id, 0);
+}
+
 function gen_rel_table() {
     generate_table([["text",0],["id",1],["time",2],["time",3],["time",4],
         ["time",5],["int",6],["int", 7],["perc","float",2],["perc","int",6],["code_loc",8]],
@@ -341,7 +375,7 @@ function gen_rel_table() {
 
 function gen_rul_table() {
     generate_table([["text",0],["id",1],["time",2],["time",3],["time",4],
-            ["int",5],["perc","float",2],["perc","int",5],["code_loc",6]],
+            ["int",5],["perc","float",2],["perc","int",5],["int",10],["int",11],["int",12],["code_loc",6]],
         "Rul_table_body",
         "rul");
 }
@@ -355,7 +389,7 @@ function gen_top_rel_table() {
 
 function gen_top_rul_table() {
     generate_table([["text",0],["id",1],["time",2],["time",3],["time",4],
-            ["int",5],["perc","float",2],["perc","int",5],["code_loc",6]],
+            ["int",5],["perc","float",2],["perc","int",5],["int",10],["int",11],["int",12],["code_loc",6]],
         "top_rul_table_body",
         "topRul");
 }
@@ -363,7 +397,7 @@ function gen_top_rul_table() {
 
 function genRulesOfRelations() {
     var data_format = [["text",0],["id",1],["time",2],["time",3],["time",4],
-            ["int",5],["perc","float",2],["perc","int",5],["code_loc",6]];
+            ["int",5],["perc","float",2],["perc","int",5],["int",10],["int",11],["int",12],["code_loc",6]];
     var rules = data.rel[selected.rel][9];
     var perc_totals = [];
     var row, cell, perc_counter, table_body, i, j;
@@ -570,13 +604,16 @@ function gen_code(highlight_row) {
 }
 
 
+var page_rows = 100;
+var pages = {};
 var precision = !1;
 var selected = {rel: !1, rul: !1};
 var came_from = !1;
 var graph_vals = {
     labels:[],
     tot_t:[],
-    tuples:[]
+    tuples:[],
+    delta:[]
 };
 
 
@@ -589,6 +626,8 @@ function init() {
     Tablesort(document.getElementById('Rul_table'),{descending: true});
     Tablesort(document.getElementById('rulesofrel_table'),{descending: true});
     Tablesort(document.getElementById('rulvertable'),{descending: true});
+    paginate('Rel_table', 'Rel_table_body');
+    paginate('Rul_table', 'Rul_table_body');
     document.getElementById("default").click();
     //document.getElementById("default").classList['active'] = !0;
 
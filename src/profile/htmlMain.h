@@ -91,6 +91,9 @@ std::string htmlBodyTop = R"___(
                     <th data-sort-method="number">Tuples</th>
                     <th data-sort-method="number">% of Time</th>
                     <th data-sort-method="number">% of Tuples</th>
+                    <th data-sort-method="number">Instructions</th>
+                    <th data-sort-method="number">Cache Misses</th>
+                    <th data-sort-method="number">Branch Misses</th>
                     <th data-sort-method="text">Source</th>
                 </tr>
                 </thead>
@@ -131,6 +134,11 @@ std::string htmlBodyTop = R"___(
             </tbody>
         </table>
     </div>
+    <div class="pager">
+        <button onclick="show_page('Rel_table_body', pages['Rel_table_body'] - 1);">Previous page</button>
+        <span id="Rel_table_body_pager"></span>
+        <button onclick="show_page('Rel_table_body', pages['Rel_table_body'] + 1);">Next page</button>
+    </div>
     <hr/>
     <div id="rulesofrel" style="display:none;">
         <h3>Rules of Relation</h3>
@@ -146,6 +154,9 @@ std::string htmlBodyTop = R"___(
                     <th data-sort-method="number">Tuples</th>
                     <th data-sort-method="number">% of Time</th>
                     <th data-sort-method="number">% of Tuples</th>
+                    <th data-sort-method="number">Instructions</th>
+                    <th data-sort-method="number">Cache Misses</th>
+                    <th data-sort-method="number">Branch Misses</th>
                     <th data-sort-method="text" style="width:20%;">Source</th>
                 </tr>
                 </thead>
@@ -172,6 +183,9 @@ std::string htmlBodyTop = R"___(
                 <th data-sort-method="number">Tuples</th>
                 <th data-sort-method="number">% of Time</th>
                 <th data-sort-method="number">% of Tuples</th>
+                <th data-sort-method="number">Instructions</th>
+                <th data-sort-method="number">Cache Misses</th>
+                <th data-sort-method="number">Branch Misses</th>
                 <th data-sort-method="text">Source</th>
             </tr>
             </thead>
@@ -179,6 +193,11 @@ std::string htmlBodyTop = R"___(
             </tbody>
         </table>
     </div>
+    <div class="pager">
+        <button onclick="show_page('Rul_table_body', pages['Rul_table_body'] - 1);">Previous page</button>
+        <span id="Rul_table_body_pager"></span>
+        <button onclick="show_page('Rul_table_body', pages['Rul_table_body'] + 1);">Next page</button>
+    </div>
     <hr/>
     <div id="rulver" style="display:none;">
         <h3>Rule Versions Table</h3>
@@ -227,8 +246,10 @@ std::string htmlBodyTop = R"___(
     <div class="ct-chart1"></div>
     <h1>Total number of tuples</h1>
     <div class="ct-chart2"></div>
-    <!--<h1>Copy time</h1>-->
-    <!--<div class="ct-chart3"></div>-->
+    <div id="chart-delta" style="display:none;">
+        <h1>Delta size per iteration</h1>
+        <div class="ct-chart3"></div>
+    </div>
     <!--<button onclick="show_graph_vals=!show_graph_vals;draw_graph();">Toggle values</button>-->
 </div>
 <div id="Code" class="tabcontent">
@@ -49,14 +49,11 @@
 
 #define yylloc yyget_extra(yyscanner)->yylloc
 
-#define yyfilename yyget_extra(yyscanner)->yyfilename
-
     /* Execute when matching */
 #define YY_USER_ACTION  { \
     yylloc.start = SrcLocation::Point({ yylineno, yycolumn }); \
     yycolumn += yyleng;             \
     yylloc.end   = SrcLocation::Point({ yylineno, yycolumn }); \
-    yylloc.filename = yyfilename;   \
 }
 
 %}
@@ -104,8 +101,14 @@
 "printsize"                           { return yy::parser::make_PRINTSIZE_QUALIFIER(yylloc); }
 "eqrel"                               { return yy::parser::make_EQREL_QUALIFIER(yylloc); }
 "inline"                              { return yy::parser::make_INLINE_QUALIFIER(yylloc); }
+"stateful"                            { return yy::parser::make_STATEFUL(yylloc); }
 "brie"                                { return yy::parser::make_BRIE_QUALIFIER(yylloc); }
 "btree"                               { return yy::parser::make_BTREE_QUALIFIER(yylloc); }
+"hashset"                             { return yy::parser::make_HASHSET_QUALIFIER(yylloc); }
+"dense"                               { return yy::parser::make_DENSE_QUALIFIER(yylloc); }
+"external"                            { return yy::parser::make_EXTERNAL_QUALIFIER(yylloc); }
+"blocksize"                           { return yy::parser::make_BLOCKSIZE_QUALIFIER(yylloc); }
+"choice-domain"                       { return yy::parser::make_CHOICEDOMAIN(yylloc); }
 "min"                                 { return yy::parser::make_MIN(yylloc); }
 "max"                                 { return yy::parser::make_MAX(yylloc); }
 "as"                                  { return yy::parser::make_AS(yylloc); }
@@ -210,12 +213,12 @@
                                           assert(strlen(fname) > 0 && "failed conversion");
                                           fname[strlen(fname)]='\0';
                                           yycolumn = 1; yylineno = lineno-1;
-                                          yyfilename = fname;
+                                          yylloc.setFilename(fname);
                                         } else if(sscanf(yytext,"#line %d \"%[^\"]",&lineno,fname)>=2) {
                                           assert(strlen(fname) > 0 && "failed conversion");
                                           fname[strlen(fname)]='\0';
                                           yycolumn = 1; yylineno = lineno-1;
-                                          yyfilename = fname;
+                                          yylloc.setFilename(fname);
                                         }
                                       }
 "//".*$                               { }
@@ -14,9 +14,12 @@
  *
  ***********************************************************************/
 
+#include <algorithm>
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -83,6 +86,124 @@ public:
     void dumpOutputs(std::ostream& out = std::cout) {
         program->dumpOutputs(out);
     }
+
+    /**
+     * Get the number of attributes of a relation, i.e. the number of columns of its arrays of rows
+     */
+    std::size_t getArity(const std::string& relationName) {
+        return getRelation(relationName)->getArity();
+    }
+
+    /**
+     * Get the number of tuples of a relation, i.e. the number of rows extracted by extractRows
+     */
+    std::size_t getSize(const std::string& relationName) {
+        return getRelation(relationName)->size();
+    }
+
+    /**
+     * Insert the rows of a contiguous array of integers into a relation with a single call, e.g. a
+     * two-dimensional NumPy array of the size of souffle::RamDomain passed through the buffer protocol,
+     * or a direct Java ByteBuffer in native byte order.
+     *
+     * The values of symbol attributes are indexes into the given dictionary of symbols, which are looked
+     * up in the symbol table of the program once for each symbol of the dictionary.
+     *
+     * @param relationName The name of the relation
+     * @param data The rows, stored consecutively as getArity() values each
+     * @param length The number of values of the array, a multiple of the arity
+     * @param symbols The symbols referred to by the values of symbol attributes
+     * @return The number of inserted rows
+     */
+    std::size_t insertRows(const std::string& relationName, const souffle::RamDomain* data,
+            std::size_t length, const std::vector<std::string>& symbols = {}) {
+        souffle::Relation* relation = getRelation(relationName);
+        const std::size_t arity = relation->getArity();
+        if (arity == 0 || length % arity != 0) {
+            throw std::invalid_argument(
+                    "The length of the array is not a multiple of the arity of relation " + relationName);
+        }
+        const std::size_t numRows = length / arity;
+        std::vector<std::size_t> symbolColumns;
+        for (std::size_t i = 0; i < arity; ++i) {
+            if (*relation->getAttrType(i) == 's') {
+                symbolColumns.push_back(i);
+            }
+        }
+        if (symbolColumns.empty()) {
+            relation->insertBatch(data, numRows);
+            return numRows;
+        }
+
+        // translate the indexes into the dictionary into the numbers of the symbols
+        souffle::SymbolTable& symbolTable = program->getSymbolTable();
+        std::vector<souffle::RamDomain> numbers;
+        numbers.reserve(symbols.size());
+        for (const std::string& symbol : symbols) {
+            numbers.push_back(symbolTable.lookup(symbol));
+        }
+        std::vector<souffle::RamDomain> rows(data, data + length);
+        for (std::size_t row = 0; row < numRows; ++row) {
+            for (std::size_t column : symbolColumns) {
+                souffle::RamDomain& value = rows[row * arity + column];
+                if (value < 0 || static_cast<std::size_t>(value) >= numbers.size()) {
+                    throw std::out_of_range("Symbol index " + std::to_string(value) +
+                                            " is not in the dictionary of symbols");
+                }
+                value = numbers[value];
+            }
+        }
+        relation->insertBatch(rows.data(), numRows);
+        return numRows;
+    }
+
+    /**
+     * Extract the tuples of a relation into a contiguous array of integers with a single call, e.g. a
+     * writable two-dimensional NumPy array of getSize() rows and getArity() columns.
+     *
+     * The values of symbol attributes are the numbers of the symbols, which are the indexes of the
+     * symbols returned by getSymbols().
+     *
+     * @param relationName The name of the relation
+     * @param data The array the rows are stored in, consecutively as getArity() values each
+     * @param length The number of values of the array; the rows that do not fit are not extracted
+     * @return The number of extracted rows
+     */
+    std::size_t extractRows(const std::string& relationName, souffle::RamDomain* data, std::size_t length) {
+        souffle::Relation* relation = getRelation(relationName);
+        const std::size_t arity = relation->getArity();
+        const std::size_t capacity = (arity == 0) ? 0 : length / arity;
+        std::size_t numRows = 0;
+        relation->scanBatches([&](const souffle::RamDomain* batch, std::size_t count) {
+            count = std::min(count, capacity - numRows);
+            std::copy(batch, batch + count * arity, data + numRows * arity);
+            numRows += count;
+        });
+        return numRows;
+    }
+
+    /**
+     * Get the symbols of the program, indexed by their numbers, i.e. the dictionary of the values of
+     * symbol attributes of extracted rows
+     */
+    std::vector<std::string> getSymbols() {
+        const souffle::SymbolTable& symbolTable = program->getSymbolTable();
+        std::vector<std::string> symbols;
+        symbols.reserve(symbolTable.size());
+        for (std::size_t i = 0; i < symbolTable.size(); ++i) {
+            symbols.push_back(symbolTable.resolve(static_cast<souffle::RamDomain>(i)));
+        }
+        return symbols;
+    }
+
+private:
+    souffle::Relation* getRelation(const std::string& relationName) {
+        souffle::Relation* relation = program->getRelation(relationName);
+        if (relation == nullptr) {
+            throw std::invalid_argument("Unknown relation " + relationName);
+        }
+        return relation;
+    }
 };
 
 /**
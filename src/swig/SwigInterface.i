@@ -35,6 +35,76 @@ souffle::Relation* rel;
 souffle::Relation* rel_out;
 %}
 
+// errors of the interface are raised as exceptions of the target language
+%include "exception.i"
+%exception {
+    try {
+        $action
+    } catch (const std::exception& e) {
+        SWIG_exception(SWIG_RuntimeError, e.what());
+    }
+}
+
+// arrays of rows are passed without copying them element by element: in Python as objects supporting the
+// buffer protocol, such as NumPy arrays of the size of souffle::RamDomain, and in Java as direct buffers
+#ifdef SWIGPYTHON
+%typemap(in) (const souffle::RamDomain* data, std::size_t length) (Py_buffer view, int held = 0) {
+    if (PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        SWIG_fail;
+    }
+    held = 1;
+    if (view.itemsize != sizeof(souffle::RamDomain)) {
+        PyErr_SetString(PyExc_TypeError, "the items of the array must be of the size of souffle::RamDomain");
+        SWIG_fail;
+    }
+    $1 = static_cast<const souffle::RamDomain*>(view.buf);
+    $2 = view.len / view.itemsize;
+}
+%typemap(in) (souffle::RamDomain* data, std::size_t length) (Py_buffer view, int held = 0) {
+    if (PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0) {
+        SWIG_fail;
+    }
+    held = 1;
+    if (view.itemsize != sizeof(souffle::RamDomain)) {
+        PyErr_SetString(PyExc_TypeError, "the items of the array must be of the size of souffle::RamDomain");
+        SWIG_fail;
+    }
+    $1 = static_cast<souffle::RamDomain*>(view.buf);
+    $2 = view.len / view.itemsize;
+}
+%typemap(freearg) (const souffle::RamDomain* data, std::size_t length),
+        (souffle::RamDomain* data, std::size_t length) {
+    if (held$argnum) {
+        PyBuffer_Release(&view$argnum);
+    }
+}
+#endif
+
+#ifdef SWIGJAVA
+%typemap(jni) (const souffle::RamDomain* data, std::size_t length),
+        (souffle::RamDomain* data, std::size_t length) "jobject"
+%typemap(jtype) (const souffle::RamDomain* data, std::size_t length),
+        (souffle::RamDomain* data, std::size_t length) "java.nio.ByteBuffer"
+%typemap(jstype) (const souffle::RamDomain* data, std::size_t length),
+        (souffle::RamDomain* data, std::size_t length) "java.nio.ByteBuffer"
+%typemap(javain) (const souffle::RamDomain* data, std::size_t length),
+        (souffle::RamDomain* data, std::size_t length) "$javainput"
+%typemap(in) (const souffle::RamDomain* data, std::size_t length),
+        (souffle::RamDomain* data, std::size_t length) {
+    $1 = static_cast<souffle::RamDomain*>(jenv->GetDirectBufferAddress($input));
+    if ($1 == nullptr) {
+        SWIG_JavaThrowException(
+                jenv, SWIG_JavaIllegalArgumentException, "the buffer must be a direct buffer");
+        return $null;
+    }
+    $2 = static_cast<std::size_t>(jenv->GetDirectBufferCapacity($input)) / sizeof(souffle::RamDomain);
+}
+#endif
+
+namespace std {
+    %template(vector_string) vector<string>;
+}
+
 %include "SwigInterface.h" 
 %newobject newInstance;
 SWIGSouffleProgram* newInstance(const std::string& name);
@@ -0,0 +1,295 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file benchmark.h
+ *
+ * Simple micro-benchmark infrastructure
+ *
+ * Benchmarks are registered like test cases and are run by the main
+ * program of this header for each combination of the sizes, key
+ * distributions and numbers of threads given on the command line.
+ *
+ ***********************************************************************/
+#pragma once
+
+#include "RamTypes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace benchmark {
+
+/** The distributions of the keys a benchmark is run with */
+enum class Distribution { Sequential, Shuffled, Skewed };
+
+inline std::string toString(Distribution distribution) {
+    switch (distribution) {
+        case Distribution::Sequential: return "sequential";
+        case Distribution::Shuffled: return "shuffled";
+        case Distribution::Skewed: return "skewed";
+    }
+    return "";
+}
+
+/** Prevent the compiler from optimising away the computation of a value */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/**
+ * The parameters of a single run of a benchmark, and the measurement of its operations.
+ */
+class State {
+public:
+    State(size_t size, Distribution distribution, unsigned threads, unsigned repetitions)
+            : size(size), distribution(distribution), threads(threads), repetitions(repetitions) {}
+
+    /** Number of keys, and thus of elements of the measured data structure */
+    const size_t size;
+    const Distribution distribution;
+    const unsigned threads;
+
+    /**
+     * Return the keys in [0, size) in the order of the distribution: ascending, as a random
+     * permutation, or drawn at random with most of them among the smallest keys, including duplicates.
+     */
+    std::vector<souffle::RamDomain> keys(unsigned seed = 3) const {
+        std::vector<souffle::RamDomain> res(size);
+        std::mt19937 random(seed);
+        if (distribution == Distribution::Skewed) {
+            std::uniform_real_distribution<double> uniform(0, 1);
+            for (auto& key : res) {
+                key = static_cast<souffle::RamDomain>(size * std::pow(uniform(random), 4));
+            }
+            return res;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            res[i] = static_cast<souffle::RamDomain>(i);
+        }
+        if (distribution == Distribution::Shuffled) {
+            std::shuffle(res.begin(), res.end(), random);
+        }
+        return res;
+    }
+
+    /**
+     * Measure the operation, which performs the given number of operations; the best time of the
+     * repetitions counts. The value returned by the operation, e.g. the data structure it filled, is
+     * destroyed after the measurement.
+     */
+    template <typename Operation>
+    void measure(size_t operations, Operation operation) {
+        for (unsigned i = 0; i < repetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            auto result = operation();
+            auto end = std::chrono::steady_clock::now();
+            doNotOptimize(result);
+            double time = std::chrono::duration<double>(end - start).count();
+            if (ops == 0 || time < seconds) {
+                seconds = time;
+            }
+            ops = operations;
+        }
+    }
+
+    /**
+     * Run the operation on the indexes [begin, end) of a partition of [0, count) for each of the
+     * threads, and wait for all of them.
+     */
+    template <typename Operation>
+    void parallel(size_t count, Operation operation) const {
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back(operation, count * i / threads, count * (i + 1) / threads);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /** Number of operations of the last measurement */
+    size_t getOperations() const {
+        return ops;
+    }
+
+    /** Best time of the last measurement in seconds */
+    double getSeconds() const {
+        return seconds;
+    }
+
+private:
+    const unsigned repetitions;
+    size_t ops = 0;
+    double seconds = 0;
+};
+
+/* singly linked list for linking benchmarks */
+
+static class Benchmark* base = nullptr;
+
+class Benchmark {
+private:
+    Benchmark* next;
+    std::string group;
+    std::string name;
+    bool threaded;
+
+public:
+    Benchmark(std::string g, std::string n, bool threaded)
+            : group(std::move(g)), name(std::move(n)), threaded(threaded) {
+        next = base;
+        base = this;
+    }
+    virtual ~Benchmark() = default;
+
+    /**
+     * Run method, measuring the operations through the state
+     */
+    virtual void run(State& state) = 0;
+
+    Benchmark* nextBenchmark() {
+        return next;
+    }
+
+    const std::string& getGroup() const {
+        return group;
+    }
+
+    const std::string& getName() const {
+        return name;
+    }
+
+    /**
+     * Whether the benchmark uses the threads of the state; other benchmarks are run single-threaded
+     */
+    bool isThreaded() const {
+        return threaded;
+    }
+};
+
+}  // namespace benchmark
+
+#define BENCHMARK(a, b, threaded)                                                               \
+    class benchmark_##a##_##b : public benchmark::Benchmark {                                   \
+    public:                                                                                     \
+        benchmark_##a##_##b(std::string g, std::string n, bool t) : benchmark::Benchmark(g, n, t) {} \
+        void run(benchmark::State& state) override;                                            \
+    } Benchmark_##a##_##b(#a, #b, threaded);                                                    \
+    void benchmark_##a##_##b::run(benchmark::State& state)
+
+namespace benchmark {
+
+inline std::vector<size_t> parseList(const std::string& list) {
+    std::vector<size_t> res;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        res.push_back(std::stoul(item));
+    }
+    return res;
+}
+
+}  // namespace benchmark
+
+/**
+ * Main program of a benchmark
+ */
+int main(int argc, char** argv) {
+    using namespace benchmark;
+
+    std::string filter;
+    std::vector<size_t> sizes = {1000, 100000, 1000000};
+    std::vector<size_t> threads = {1, std::max(2u, std::thread::hardware_concurrency())};
+    std::vector<Distribution> distributions = {
+            Distribution::Sequential, Distribution::Shuffled, Distribution::Skewed};
+    unsigned repetitions = 3;
+    bool csv = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](const std::string& option) {
+            return arg.compare(0, option.size(), option) == 0 ? arg.substr(option.size()) : std::string();
+        };
+        if (!value("--filter=").empty()) {
+            filter = value("--filter=");
+        } else if (!value("--sizes=").empty()) {
+            sizes = parseList(value("--sizes="));
+        } else if (!value("--threads=").empty()) {
+            threads = parseList(value("--threads="));
+        } else if (!value("--repetitions=").empty()) {
+            repetitions = std::stoul(value("--repetitions="));
+        } else if (arg == "--csv") {
+            csv = true;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter=GROUP/NAME] [--sizes=N,...] [--threads=N,...] [--repetitions=N]"
+                         " [--csv]\n";
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // run the benchmarks in the order of their definition
+    std::vector<Benchmark*> benchmarks;
+    for (Benchmark* p = base; p != nullptr; p = p->nextBenchmark()) {
+        benchmarks.insert(benchmarks.begin(), p);
+    }
+
+    if (csv) {
+        std::cout << "benchmark,size,distribution,threads,operations,seconds,ns_per_op,ops_per_second\n";
+    } else {
+        std::cout << std::left << std::setw(40) << "BENCHMARK" << std::right << std::setw(10) << "SIZE"
+                  << std::setw(12) << "KEYS" << std::setw(8) << "THREADS" << std::setw(12) << "NS/OP"
+                  << std::setw(16) << "OPS/S" << "\n";
+    }
+    for (Benchmark* p : benchmarks) {
+        const std::string name = p->getGroup() + "/" + p->getName();
+        if (name.find(filter) == std::string::npos) {
+            continue;
+        }
+        for (size_t size : sizes) {
+            for (Distribution distribution : distributions) {
+                for (size_t numThreads : threads) {
+                    if (!p->isThreaded() && numThreads != threads.front()) {
+                        continue;
+                    }
+                    State state(size, distribution, p->isThreaded() ? numThreads : 1, repetitions);
+                    p->run(state);
+                    const double ns = state.getOperations() > 0
+                                              ? state.getSeconds() * 1e9 / state.getOperations()
+                                              : 0;
+                    const double rate =
+                            state.getSeconds() > 0 ? state.getOperations() / state.getSeconds() : 0;
+                    if (csv) {
+                        std::cout << name << "," << size << "," << toString(distribution) << ","
+                                  << state.threads << "," << state.getOperations() << ","
+                                  << state.getSeconds() << "," << ns << "," << rate << "\n";
+                    } else {
+                        std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << size
+                                  << std::setw(12) << toString(distribution) << std::setw(8) << state.threads
+                                  << std::setw(12) << std::fixed << std::setprecision(1) << ns
+                                  << std::setw(16) << std::setprecision(0) << rate << "\n";
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file binary_io_test.cpp
+ *
+ * Tests the binary fact file reader and writer.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "CompiledTuple.h"
+#include "IODirectives.h"
+#include "ReadStreamBinary.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "WriteStreamBinary.h"
+#include "json11.h"
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace souffle::test {
+
+using Tuple = ram::Tuple<RamDomain, 3>;
+
+/** A minimal relation collecting the inserted tuples */
+struct Collector {
+    std::vector<Tuple> tuples;
+
+    void insert(const RamDomain* tuple) {
+        tuples.push_back({{tuple[0], tuple[1], tuple[2]}});
+    }
+};
+
+IODirectives getDirectives(const std::string& fileName) {
+    std::vector<std::string> attributeTypes{"i", "s", "f"};
+    json11::Json types = json11::Json::object{
+            {"test", json11::Json::object{{"arity", static_cast<long long>(3)},
+                             {"auxArity", static_cast<long long>(0)},
+                             {"types", json11::Json::array(attributeTypes.begin(), attributeTypes.end())}}}};
+    std::map<std::string, std::string> directives = {
+            {"IO", "binary"}, {"name", "test"}, {"filename", fileName}, {"types", types.dump()}};
+    return IODirectives(directives);
+}
+
+TEST(BinaryIO, RoundTrip) {
+    const std::string fileName = "binary_io_test.bin";
+    const IODirectives directives = getDirectives(fileName);
+    RecordTable recordTable;
+
+    // write tuples with symbols of one table ...
+    SymbolTable writeSymbols;
+    std::vector<Tuple> written;
+    for (RamDomain i = 0; i < 10000; ++i) {
+        written.push_back({{i, writeSymbols.lookup("sym" + std::to_string(i % 100)),
+                ramBitCast(static_cast<RamFloat>(i) / 2)}});
+    }
+    {
+        WriteFileBinary writer(directives, writeSymbols, recordTable);
+        writer.writeAll(written);
+    }
+
+    // ... and read them into another table with different symbol indices
+    SymbolTable readSymbols;
+    readSymbols.insert("unrelated");
+    Collector relation;
+    {
+        ReadFileBinary reader(directives, readSymbols, recordTable);
+        reader.readAll(relation);
+    }
+    std::remove(fileName.c_str());
+
+    EXPECT_EQ(written.size(), relation.tuples.size());
+    for (size_t i = 0; i < written.size(); ++i) {
+        EXPECT_EQ(written[i][0], relation.tuples[i][0]);
+        EXPECT_EQ(writeSymbols.resolve(written[i][1]), readSymbols.resolve(relation.tuples[i][1]));
+        EXPECT_EQ(written[i][2], relation.tuples[i][2]);
+    }
+    EXPECT_EQ(101, readSymbols.size());
+}
+
+TEST(BinaryIO, SharedMemory) {
+    IODirectives directives = getDirectives("unused");
+    directives.setIOType("shm");
+    directives.set("segment", "souffle.binary_io_test." + std::to_string(getpid()));
+    RecordTable recordTable;
+
+    SymbolTable writeSymbols;
+    std::vector<Tuple> written;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        written.push_back({{-i, writeSymbols.lookup("sym" + std::to_string(i % 10)), ramBitCast(i)}});
+    }
+    {
+        WriteSharedMemoryBinary writer(directives, writeSymbols, recordTable);
+        writer.writeAll(written);
+    }
+
+    // the segment is kept for further readers, unless it is unlinked by the last one
+    for (const std::string unlink : {"false", "true"}) {
+        directives.set("unlink", unlink);
+        SymbolTable readSymbols;
+        Collector relation;
+        {
+            ReadSharedMemoryBinary reader(directives, readSymbols, recordTable);
+            reader.readAll(relation);
+        }
+        EXPECT_EQ(written.size(), relation.tuples.size());
+        for (size_t i = 0; i < written.size(); ++i) {
+            EXPECT_EQ(written[i][0], relation.tuples[i][0]);
+            EXPECT_EQ(writeSymbols.resolve(written[i][1]), readSymbols.resolve(relation.tuples[i][1]));
+            EXPECT_EQ(written[i][2], relation.tuples[i][2]);
+        }
+    }
+
+    SymbolTable symbolTable;
+    bool failed = false;
+    try {
+        ReadSharedMemoryBinary reader(directives, symbolTable, recordTable);
+    } catch (std::invalid_argument&) {
+        failed = true;
+    }
+    EXPECT_TRUE(failed);
+}
+
+TEST(BinaryIO, InvalidFile) {
+    const std::string fileName = "binary_io_test_invalid.bin";
+    {
+        std::ofstream file(fileName);
+        file << "1\t2\t3\n";
+    }
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    bool failed = false;
+    try {
+        ReadFileBinary reader(getDirectives(fileName), symbolTable, recordTable);
+    } catch (std::invalid_argument&) {
+        failed = true;
+    }
+    std::remove(fileName.c_str());
+    EXPECT_TRUE(failed);
+}
+
+}  // namespace souffle::test
@@ -17,6 +17,7 @@
 #include "test.h"
 
 #include <algorithm>
+#include <array>
 #include <iomanip>
 #include <iostream>
 #include <random>
@@ -73,7 +74,9 @@ TEST(EqRelTest, Basic) {
 
 TEST(EqRelTest, Clear) {
     EqRel br;
+    EXPECT_TRUE(br.empty());
     br.insert(0, 44);
+    EXPECT_FALSE(br.empty());
     br.insert(0, 1);
 
     EXPECT_EQ(9, br.size());
@@ -84,6 +87,7 @@ TEST(EqRelTest, Clear) {
     }
     EXPECT_EQ(count, br.size());
     br.clear();
+    EXPECT_TRUE(br.empty());
     EXPECT_EQ(0, br.size());
     count = 0;
     for (auto x : br) {
@@ -341,6 +345,41 @@ TEST(EqRelTest, Merge) {
     EXPECT_EQ(count, br2.size());
 }
 
+TEST(EqRelTest, InsertBulk) {
+    // pairs {i, i + 1} of odd i, linking the even elements into one set and the odd ones into another
+    const int N = 1000;
+    std::vector<RamDomain> pairs;
+    for (int i = 0; i + 2 < N; i++) {
+        pairs.push_back(i);
+        pairs.push_back(i + 2);
+        // padding, skipped by the stride
+        pairs.push_back(-1);
+    }
+    std::vector<std::array<RamDomain, 3>> shuffled(pairs.size() / 3);
+    for (size_t i = 0; i < shuffled.size(); i++) {
+        shuffled[i] = {{pairs[3 * i], pairs[3 * i + 1], pairs[3 * i + 2]}};
+    }
+    std::random_device rd;
+    std::mt19937 generator(rd());
+    shuffle(shuffled.begin(), shuffled.end(), generator);
+
+    EqRel br;
+    br.insert(0, 0);
+    EXPECT_EQ(1, br.size());
+    br.insertBulk(&shuffled[0][0], shuffled.size(), 3);
+    EXPECT_EQ(2 * (size_t)(N / 2) * (N / 2), br.size());
+    EXPECT_TRUE(br.contains(0, N - 2));
+    EXPECT_TRUE(br.contains(1, N - 1));
+    EXPECT_FALSE(br.contains(0, 1));
+    EXPECT_FALSE(br.contains(-1, -1));
+
+    // the cache regenerated by size() is maintained by single insertions
+    br.insert(0, 1);
+    EXPECT_EQ((size_t)N * N, br.size());
+    br.insertBulk(&shuffled[0][0], 0, 3);
+    EXPECT_EQ((size_t)N * N, br.size());
+}
+
 TEST(EqRelTest, IterEmpty) {
     // test iterating over an empty binrel fails
     EqRel br;
@@ -519,6 +558,49 @@ TEST(EqRelTest, IterPartition) {
     EXPECT_EQ(br.size(), values.size());
 }
 
+TEST(EqRelTest, IterIncremental) {
+    // test that inserts after an iteration keep the cached disjoint sets consistent
+    EqRel br;
+    std::vector<RamDomain> rep(200);
+    for (RamDomain i = 0; i < 200; ++i) {
+        rep[i] = i;
+    }
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<RamDomain> dist(0, 199);
+    for (int step = 0; step < 300; ++step) {
+        RamDomain x = dist(generator);
+        RamDomain y = dist(generator);
+        br.insert(x, y);
+
+        // brute-force union of the classes of x and y
+        RamDomain from = rep[x];
+        RamDomain to = rep[y];
+        for (auto& cur : rep) {
+            if (cur == from) cur = to;
+        }
+
+        // iterate over the range of x, which regenerates or reuses the cache
+        std::set<RamDomain> covered;
+        for (auto tup : br.getBoundaries<1>({{x, 0}})) {
+            EXPECT_EQ(x, tup[0]);
+            covered.insert(tup[1]);
+        }
+        std::set<RamDomain> expected;
+        for (RamDomain i = 0; i < 200; ++i) {
+            if (rep[i] == rep[x] && br.contains(i, i)) expected.insert(i);
+        }
+        EXPECT_EQ(expected, covered);
+    }
+
+    size_t count = 0;
+    for (auto tup : br) {
+        EXPECT_EQ(rep[tup[0]], rep[tup[1]]);
+        ++count;
+    }
+    EXPECT_EQ(count, br.size());
+}
+
 TEST(EqRelTest, Scaling) {
     const int N = 100;
 
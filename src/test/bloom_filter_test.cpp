@@ -0,0 +1,78 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file bloom_filter_test.cpp
+ *
+ * A test case testing the bloom filter of tuples.
+ *
+ ***********************************************************************/
+
+#include "BloomFilter.h"
+#include "RamTypes.h"
+#include "test.h"
+
+namespace souffle {
+namespace test {
+
+TEST(BloomFilter, Basic) {
+    BloomFilter filter(100);
+    RamDomain a[2] = {1, 2};
+    RamDomain b[2] = {2, 1};
+    EXPECT_FALSE(filter.mayContain(a, 2));
+
+    filter.insert(a, 2);
+    EXPECT_TRUE(filter.mayContain(a, 2));
+    EXPECT_FALSE(filter.mayContain(b, 2));
+
+    filter.clear();
+    EXPECT_FALSE(filter.mayContain(a, 2));
+}
+
+TEST(BloomFilter, FalsePositives) {
+    const int N = 10000;
+    BloomFilter filter(N);
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain tuple[2] = {i, i + 1};
+        filter.insert(tuple, 2);
+    }
+
+    // inserted tuples are never ruled out
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain tuple[2] = {i, i + 1};
+        EXPECT_TRUE(filter.mayContain(tuple, 2));
+    }
+
+    // most other tuples are
+    int positives = 0;
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain tuple[2] = {i + 1, i};
+        if (filter.mayContain(tuple, 2)) {
+            ++positives;
+        }
+    }
+    EXPECT_LT(positives, N / 20);
+}
+
+TEST(BloomFilter, Parallel) {
+    const int N = 10000;
+    BloomFilter filter(N);
+#pragma omp parallel for
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain tuple[3] = {i, 2 * i, 3 * i};
+        filter.insert(tuple, 3);
+    }
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain tuple[3] = {i, 2 * i, 3 * i};
+        EXPECT_TRUE(filter.mayContain(tuple, 3));
+    }
+}
+
+}  // namespace test
+}  // namespace souffle
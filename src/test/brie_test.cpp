@@ -18,6 +18,8 @@
 #include "test.h"
 #include <cstring>
 #include <random>
+#include <set>
+#include <vector>
 
 using namespace souffle;
 
@@ -582,6 +584,258 @@ TEST(SparseBitMap, CopyAndMerge) {
     }
 }
 
+TEST(SparseBitMap, ForEach) {
+    SparseBitMap<> map;
+    std::random_device rd;
+    std::mt19937 generator(rd());
+    std::uniform_int_distribution<int> dist(0, 10000);
+    for (int i = 0; i < 1000; ++i) {
+        map.set(dist(generator));
+    }
+
+    std::vector<uint64_t> expected(map.begin(), map.end());
+    std::vector<uint64_t> visited;
+    map.forEach([&](uint64_t i) { visited.push_back(i); });
+    EXPECT_EQ(expected, visited);
+}
+
+TEST(SparseBitMap, ForEachRun) {
+    SparseBitMap<> map;
+    // runs within a word, ending a word, spanning words and spanning a gap of words
+    for (int i = 3; i < 7; ++i) map.set(i);
+    map.set(9);
+    for (int i = 60; i < 200; ++i) map.set(i);
+    for (int i = 1000; i < 1064; ++i) map.set(i);
+    map.set(5000);
+
+    std::vector<std::pair<uint64_t, uint64_t>> runs;
+    map.forEachRun([&](uint64_t first, uint64_t length) { runs.emplace_back(first, length); });
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {{3, 4}, {9, 1}, {60, 140}, {1000, 64}, {5000, 1}};
+    EXPECT_EQ(expected, runs);
+
+    // a full word
+    SparseBitMap<> full;
+    for (int i = 64; i < 128; ++i) full.set(i);
+    runs.clear();
+    full.forEachRun([&](uint64_t first, uint64_t length) { runs.emplace_back(first, length); });
+    expected = {{64, 64}};
+    EXPECT_EQ(expected, runs);
+}
+
+TEST(SparseBitMap, ForEachCommon) {
+    SparseBitMap<> a;
+    SparseBitMap<> b;
+    std::random_device rd;
+    std::mt19937 generator(rd());
+    std::uniform_int_distribution<int> dist(0, 100000);
+    for (int i = 0; i < 5000; ++i) {
+        a.set(dist(generator));
+        b.set(dist(generator) / 2);
+    }
+
+    std::vector<uint64_t> expected;
+    for (const auto& cur : a) {
+        if (b.test(cur)) expected.push_back(cur);
+    }
+    std::vector<uint64_t> common;
+    a.forEachCommon(b, [&](uint64_t i) { common.push_back(i); });
+    EXPECT_EQ(expected, common);
+
+    common.clear();
+    b.forEachCommon(a, [&](uint64_t i) { common.push_back(i); });
+    EXPECT_EQ(expected, common);
+
+    common.clear();
+    a.forEachCommon(SparseBitMap<>(), [&](uint64_t i) { common.push_back(i); });
+    EXPECT_TRUE(common.empty());
+}
+
+TEST(RoaringBitMap, Basic) {
+    RoaringBitMap<> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_TRUE(map.begin() == map.end());
+
+    EXPECT_TRUE(map.set(12));
+    EXPECT_TRUE(map.set(120));
+    EXPECT_TRUE(map.set(70000));
+    EXPECT_TRUE(map.set(84));
+    EXPECT_FALSE(map.set(120));
+
+    EXPECT_EQ(4, map.size());
+    EXPECT_TRUE(map[12]);
+    EXPECT_TRUE(map[70000]);
+    EXPECT_FALSE(map[13]);
+    EXPECT_FALSE(map[70001]);
+
+    std::vector<uint64_t> values(map.begin(), map.end());
+    EXPECT_EQ((std::vector<uint64_t>{12, 84, 120, 70000}), values);
+
+    EXPECT_EQ(84, *map.find(84));
+    EXPECT_TRUE(map.find(85) == map.end());
+    EXPECT_TRUE(map.find(200000) == map.end());
+
+    // lower bounds within a chunk, across chunks and beyond the last value
+    EXPECT_EQ(84, *map.lower_bound(13));
+    EXPECT_EQ(70000, *map.lower_bound(121));
+    EXPECT_TRUE(map.lower_bound(70001) == map.end());
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map[12]);
+}
+
+namespace {
+
+/**
+ * Fills the given map and set with values of one of a number of patterns, turning the
+ * chunks of the map into arrays, bitmaps or lists of runs.
+ */
+void fillPattern(int pattern, RoaringBitMap<>& map, std::set<uint64_t>& values) {
+    std::mt19937 generator(pattern);
+    auto add = [&](uint64_t value) {
+        map.set(value);
+        values.insert(value);
+    };
+    switch (pattern) {
+        case 0:  // sparse values
+            for (int i = 0; i < 1000; ++i) add(generator() % 1000000);
+            break;
+        case 1:  // dense values
+            for (int i = 0; i < 100000; ++i) add(generator() % 200000);
+            break;
+        case 2:  // long runs, spanning chunks
+            for (uint64_t i = 60000; i < 140000; ++i) add(i);
+            for (uint64_t i = 150000; i < 150100; ++i) add(i);
+            break;
+        case 3:  // alternating values, merged into runs later on
+            for (uint64_t i = 0; i < 100000; i += 2) add(i);
+            for (uint64_t i = 1; i < 50000; i += 2) add(i);
+            break;
+    }
+}
+
+}  // namespace
+
+TEST(RoaringBitMap, Containers) {
+    for (int pattern = 0; pattern < 4; ++pattern) {
+        RoaringBitMap<> map;
+        std::set<uint64_t> values;
+        fillPattern(pattern, map, values);
+
+        EXPECT_EQ(values.size(), map.size());
+        EXPECT_TRUE(std::equal(map.begin(), map.end(), values.begin(), values.end()));
+
+        std::vector<uint64_t> visited;
+        map.forEach([&](uint64_t i) { visited.push_back(i); });
+        EXPECT_TRUE(std::equal(visited.begin(), visited.end(), values.begin(), values.end()));
+
+        std::mt19937 generator(pattern);
+        for (int i = 0; i < 1000; ++i) {
+            uint64_t value = generator() % 250000;
+            EXPECT_EQ(values.count(value) == 1, map.test(value));
+            auto pos = map.lower_bound(value);
+            auto ref = values.lower_bound(value);
+            if (ref == values.end()) {
+                EXPECT_TRUE(pos == map.end());
+            } else {
+                EXPECT_EQ(*ref, *pos);
+            }
+        }
+
+        // runs agree with the consecutive values of the set
+        std::vector<std::pair<uint64_t, uint64_t>> runs;
+        map.forEachRun([&](uint64_t first, uint64_t length) { runs.emplace_back(first, length); });
+        std::vector<std::pair<uint64_t, uint64_t>> expected;
+        for (uint64_t cur : values) {
+            if (!expected.empty() && expected.back().first + expected.back().second == cur) {
+                expected.back().second++;
+            } else {
+                expected.emplace_back(cur, 1);
+            }
+        }
+        EXPECT_EQ(expected, runs);
+    }
+}
+
+TEST(RoaringBitMap, CopyAndMerge) {
+    for (int a = 0; a < 4; ++a) {
+        for (int b = 0; b < 4; ++b) {
+            RoaringBitMap<> mapA;
+            RoaringBitMap<> mapB;
+            std::set<uint64_t> values;
+            fillPattern(a, mapA, values);
+            fillPattern(b, mapB, values);
+
+            RoaringBitMap<> m = mapA;
+            m.addAll(mapB);
+            m.addAll(m);
+            EXPECT_EQ(values.size(), m.size());
+            EXPECT_TRUE(std::equal(m.begin(), m.end(), values.begin(), values.end()));
+
+            // the merged map remains a copy
+            mapA.clear();
+            EXPECT_EQ(values.size(), m.size());
+        }
+    }
+}
+
+TEST(RoaringBitMap, ForEachCommon) {
+    for (int a = 0; a < 4; ++a) {
+        for (int b = 0; b < 4; ++b) {
+            RoaringBitMap<> mapA;
+            RoaringBitMap<> mapB;
+            std::set<uint64_t> valuesA;
+            std::set<uint64_t> valuesB;
+            fillPattern(a, mapA, valuesA);
+            fillPattern(b, mapB, valuesB);
+
+            std::vector<uint64_t> expected;
+            std::set_intersection(valuesA.begin(), valuesA.end(), valuesB.begin(), valuesB.end(),
+                    std::back_inserter(expected));
+            std::vector<uint64_t> common;
+            mapA.forEachCommon(mapB, [&](uint64_t i) { common.push_back(i); });
+            EXPECT_EQ(expected, common);
+        }
+    }
+
+    RoaringBitMap<> map;
+    std::set<uint64_t> values;
+    fillPattern(0, map, values);
+    std::vector<uint64_t> common;
+    map.forEachCommon(RoaringBitMap<>(), [&](uint64_t i) { common.push_back(i); });
+    EXPECT_TRUE(common.empty());
+}
+
+TEST(RoaringBitMap, MemoryUsage) {
+    // both sparse values and runs take less memory than within a sparse bit map
+    for (int pattern : {0, 2}) {
+        RoaringBitMap<> map;
+        std::set<uint64_t> values;
+        fillPattern(pattern, map, values);
+        SparseBitMap<> reference;
+        for (uint64_t cur : values) reference.set(cur);
+        EXPECT_LT(map.getMemoryUsage(), reference.getMemoryUsage());
+    }
+}
+
+TEST(RoaringBitMap, Parallel) {
+    const int N = 100000;
+    RoaringBitMap<> map;
+    std::atomic<int> inserted(0);
+
+    // all threads insert all values
+#pragma omp parallel for
+    for (int i = 0; i < 4 * N; ++i) {
+        if (map.set((i % N) * 3)) inserted++;
+    }
+
+    EXPECT_EQ(N, inserted);
+    EXPECT_EQ(N, map.size());
+    for (int i = 0; i < 3 * N; ++i) {
+        EXPECT_EQ(i % 3 == 0, map.test(i));
+    }
+}
+
 TEST(Trie, Basic) {
     Trie<1> set;
 
@@ -1216,6 +1470,67 @@ TEST(Trie, Size) {
     EXPECT_EQ(5, t.size());
 }
 
+TEST(Trie, Size_Maintained) {
+    // the size of an empty trie merging another one is the size of the other one
+    Trie<1> a;
+    Trie<1> b;
+    for (RamDomain i = 0; i < 100; i += 2) b.insert({i});
+    a.insertAll(b);
+    EXPECT_EQ(50, a.size());
+
+    // insertions are counted after merging the entries of another trie
+    for (RamDomain i = 0; i < 100; i += 5) a.insert({i});
+    EXPECT_EQ(60, a.size());
+    a.insertAll(b);
+    EXPECT_EQ(60, a.size());
+
+    // copies of nested tries are counted anew
+    Trie<3> t;
+    for (RamDomain i = 0; i < 10; ++i) {
+        for (RamDomain j = 0; j < 10; ++j) {
+            t.insert(i, j, i + j);
+        }
+    }
+    Trie<3> u;
+    u.insert(0, 0, 0);
+    u.insert(20, 0, 0);
+    u.insertAll(t);
+    Trie<3> copy(u);
+    EXPECT_EQ(101, u.size());
+    EXPECT_EQ(101, copy.size());
+    u.insert(20, 0, 1);
+    EXPECT_EQ(102, u.size());
+    EXPECT_EQ(101, copy.size());
+
+    u.clear();
+    EXPECT_TRUE(u.empty());
+    EXPECT_EQ(0, u.size());
+    u.insert(1, 1, 1);
+    EXPECT_EQ(1, u.size());
+}
+
+TEST(Trie, Runs_1D) {
+    Trie<1> a;
+    Trie<1> b;
+    for (RamDomain i = 10; i < 100; ++i) a.insert({i});
+    for (RamDomain i = 200; i < 210; ++i) a.insert({i});
+    for (RamDomain i = 0; i < 300; i += 3) b.insert({i});
+
+    std::vector<std::pair<RamDomain, std::size_t>> runs;
+    a.forEachRun([&](RamDomain first, std::size_t length) { runs.emplace_back(first, length); });
+    std::vector<std::pair<RamDomain, std::size_t>> expected = {{10, 90}, {200, 10}};
+    EXPECT_EQ(expected, runs);
+
+    std::vector<RamDomain> common;
+    a.forEachCommon(b, [&](RamDomain i) { common.push_back(i); });
+    std::vector<RamDomain> expectedCommon;
+    for (const auto& cur : a) {
+        if (b.contains(cur)) expectedCommon.push_back(cur[0]);
+    }
+    EXPECT_EQ(33, common.size());
+    EXPECT_EQ(expectedCommon, common);
+}
+
 TEST(Trie, Limits) {
     Trie<2> data;
 
@@ -15,6 +15,9 @@
  ***********************************************************************/
 
 #include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "RamTypes.h"
 #include "test.h"
 
 #include <algorithm>
@@ -477,6 +480,104 @@ TEST(BTreeSet, Load) {
     }
 }
 
+TEST(BTreeSet, InsertBulk) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 5000; N += 7) {
+        // generate some unordered data with duplicates
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back((i * 7919) % (N / 2 + 1));
+        }
+
+        test_set t;
+        t.insertBulk(data);
+        EXPECT_TRUE(t.check());
+
+        std::set<int> expected(data.begin(), data.end());
+        EXPECT_EQ(expected.size(), t.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), t.begin()));
+
+        // a bulk insertion into a non-empty tree merges the elements
+        t.insertBulk({-1, N, 0});
+        EXPECT_TRUE(t.check());
+        EXPECT_TRUE(t.contains(-1));
+        EXPECT_TRUE(t.contains(N));
+        EXPECT_EQ(expected.size() + 2, t.size());
+    }
+}
+
+TEST(BTreeSet, InsertBulkNew) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 5000; N += 7) {
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back((i * 7919) % (N / 2 + 1));
+        }
+
+        // all distinct elements are new to an empty tree
+        test_set t;
+        std::vector<int> fresh = t.insertBulkNew(data);
+        EXPECT_TRUE(t.check());
+        std::set<int> expected(data.begin(), data.end());
+        EXPECT_EQ(expected.size(), t.size());
+        EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), fresh);
+
+        // only the elements not contained are new to a non-empty tree
+        fresh = t.insertBulkNew({N, -1, 0, N});
+        EXPECT_TRUE(t.check());
+        EXPECT_EQ((std::vector<int>{-1, N}), fresh);
+        EXPECT_EQ(expected.size() + 2, t.size());
+    }
+}
+
+TEST(BTreeSet, Compact) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+    using test_multiset = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    std::mt19937 generator(3);
+    for (int N = 0; N < 5000; N += 7) {
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back(generator() % (N + 1));
+        }
+
+        test_set t;
+        test_multiset m;
+        for (int cur : data) {
+            t.insert(cur);
+            m.insert(cur);
+        }
+        const std::size_t memory = t.getMemoryUsage();
+        t.compact();
+        m.compact();
+        EXPECT_TRUE(t.check());
+        EXPECT_TRUE(m.check());
+        EXPECT_TRUE(t.getMemoryUsage() <= memory);
+
+        std::set<int> expected(data.begin(), data.end());
+        EXPECT_EQ(expected.size(), t.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), t.begin()));
+        std::multiset<int> expectedMulti(data.begin(), data.end());
+        EXPECT_EQ(expectedMulti.size(), m.size());
+        EXPECT_TRUE(std::equal(expectedMulti.begin(), expectedMulti.end(), m.begin()));
+        for (int i = -1; i <= N + 1; i += 13) {
+            EXPECT_EQ(expected.count(i), t.contains(i));
+            auto pos = t.lower_bound(i);
+            auto ref = expected.lower_bound(i);
+            EXPECT_EQ(ref == expected.end(), pos == t.end());
+        }
+
+        // a compacted tree keeps accepting insertions
+        t.insert(-1);
+        t.insert(N / 2);
+        EXPECT_TRUE(t.check());
+        EXPECT_TRUE(t.contains(-1));
+        EXPECT_TRUE(t.contains(N / 2));
+    }
+}
+
 TEST(BTreeSet, Clear) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -567,6 +668,139 @@ TEST(BTreeSet, ChunkSplitStress) {
     }
 }
 
+TEST(BTreeSet, SimdSearch) {
+    using tuple_t = ram::Tuple<RamDomain, 3>;
+    using comp_t = ram::index_utils::comparator<1, 0, 2>;
+    using simd_set = btree_set<tuple_t, comp_t, std::allocator<tuple_t>, 256, detail::simd_search>;
+    using binary_set = btree_set<tuple_t, comp_t, std::allocator<tuple_t>, 256, detail::binary_search>;
+
+    // only contiguous tuples ordered by a leading column are searched column wise
+    EXPECT_TRUE((detail::is_column_searchable<tuple_t, const tuple_t*, comp_t>::value));
+    EXPECT_FALSE(
+            (detail::is_column_searchable<tuple_t, const tuple_t*, ram::index_utils::comparator<>>::value));
+    EXPECT_FALSE((detail::is_column_searchable<int, const int*, detail::comparator<int>>::value));
+
+    // a narrow leading column, such that many keys share it
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<RamDomain> lead(-8, 8);
+    std::uniform_int_distribution<RamDomain> rest(-1000, 1000);
+
+    simd_set a;
+    binary_set b;
+    for (int i = 0; i < 20000; i++) {
+        tuple_t cur{{rest(generator), lead(generator), rest(generator)}};
+        EXPECT_EQ(b.insert(cur), a.insert(cur));
+    }
+    EXPECT_EQ(b.size(), a.size());
+    EXPECT_TRUE(std::equal(a.begin(), a.end(), b.begin()));
+
+    // probe keys, including leading columns outside of the stored range
+    std::uniform_int_distribution<RamDomain> probe(-10, 10);
+    for (int i = 0; i < 20000; i++) {
+        tuple_t cur{{rest(generator), probe(generator), rest(generator)}};
+        EXPECT_EQ(b.contains(cur), a.contains(cur));
+        auto lower = a.lower_bound(cur);
+        EXPECT_EQ(b.lower_bound(cur) == b.end(), lower == a.end());
+        if (lower != a.end()) {
+            EXPECT_EQ(*b.lower_bound(cur), *lower);
+        }
+        auto upper = a.upper_bound(cur);
+        EXPECT_EQ(b.upper_bound(cur) == b.end(), upper == a.end());
+        if (upper != a.end()) {
+            EXPECT_EQ(*b.upper_bound(cur), *upper);
+        }
+    }
+}
+
+TEST(BTreeSet, PackedSearch) {
+    using tuple_t = ram::Tuple<RamDomain, 2>;
+    using packed_t = ram::index_utils::packed_comparator<1, 0>;
+    using comp_t = ram::index_utils::comparator<1, 0>;
+    using packed_set = btree_set<tuple_t, packed_t, std::allocator<tuple_t>, 256, detail::packed_search>;
+    using unpacked_set = btree_set<tuple_t, comp_t, std::allocator<tuple_t>, 256, detail::packed_search>;
+    using binary_set = btree_set<tuple_t, comp_t, std::allocator<tuple_t>, 256, detail::binary_search>;
+
+    // only packed comparators provide an encoding; others are searched by bisection
+    EXPECT_TRUE((detail::has_key_encoding<packed_t>::value));
+    EXPECT_FALSE((detail::has_key_encoding<comp_t>::value));
+
+    // a narrow leading column, such that many keys share it, and extreme values
+    std::mt19937 generator(4);
+    std::uniform_int_distribution<RamDomain> lead(-8, 8);
+    std::uniform_int_distribution<RamDomain> rest(std::numeric_limits<RamDomain>::min(),
+            std::numeric_limits<RamDomain>::max());
+
+    packed_set a;
+    unpacked_set u;
+    binary_set b;
+    std::vector<tuple_t> inserted;
+    for (int i = 0; i < 20000; i++) {
+        tuple_t cur{{rest(generator), lead(generator)}};
+        inserted.push_back(cur);
+        const bool fresh = b.insert(cur);
+        EXPECT_EQ(fresh, a.insert(cur));
+        EXPECT_EQ(fresh, u.insert(cur));
+    }
+    EXPECT_EQ(b.size(), a.size());
+    EXPECT_EQ(b.size(), u.size());
+    EXPECT_TRUE(std::equal(a.begin(), a.end(), b.begin()));
+    EXPECT_TRUE(std::equal(u.begin(), u.end(), b.begin()));
+
+    // probe stored keys and keys with leading columns outside of the stored range
+    std::uniform_int_distribution<RamDomain> probe(-10, 10);
+    for (int i = 0; i < 20000; i++) {
+        tuple_t cur = (i % 2 == 0) ? tuple_t{{rest(generator), probe(generator)}} : inserted[i];
+        EXPECT_EQ(b.contains(cur), a.contains(cur));
+        auto lower = a.lower_bound(cur);
+        EXPECT_EQ(b.lower_bound(cur) == b.end(), lower == a.end());
+        if (lower != a.end()) {
+            EXPECT_EQ(*b.lower_bound(cur), *lower);
+        }
+        auto upper = a.upper_bound(cur);
+        EXPECT_EQ(b.upper_bound(cur) == b.end(), upper == a.end());
+        if (upper != a.end()) {
+            EXPECT_EQ(*b.upper_bound(cur), *upper);
+        }
+    }
+}
+
+TEST(BTreeSet, Prefetch) {
+    using tuple_t = ram::Tuple<RamDomain, 2>;
+    // small nodes make the tree high enough to be prefetched
+    using test_set = btree_set<tuple_t, ram::index_utils::comparator<0, 1>, std::allocator<tuple_t>, 64>;
+    test_set::operation_hints hints;
+    std::vector<tuple_t> keys;
+    for (RamDomain i = 0; i < 40; i++) {
+        keys.push_back(tuple_t{{i * 997 % 5000, std::numeric_limits<RamDomain>::min()}});
+    }
+
+    // prefetching an empty tree or no keys has no effect
+    test_set set;
+    set.prefetch(keys.data(), keys.size(), hints);
+    EXPECT_TRUE(set.empty());
+
+    for (RamDomain i = 0; i < 100000; i++) {
+        set.insert(tuple_t{{i / 20, i % 20}});
+    }
+    set.prefetch(keys.data(), 0, hints);
+
+    // the searches following the prefetching of several batches of keys, partly covered by the hints,
+    // find the same tuples
+    EXPECT_EQ(keys[5][0], (*set.lower_bound(keys[5], hints))[0]);
+    set.prefetch(keys.data(), keys.size(), hints);
+    for (const auto& key : keys) {
+        auto pos = set.lower_bound(key, hints);
+        EXPECT_TRUE(pos != set.end());
+        EXPECT_EQ(key[0], (*pos)[0]);
+        EXPECT_EQ(0, (*pos)[1]);
+    }
+
+    // keys beyond the last tuple descend to the last leaf
+    tuple_t beyond{{100000, 0}};
+    set.prefetch(&beyond, 1, hints);
+    EXPECT_TRUE(set.lower_bound(beyond, hints) == set.end());
+}
+
 using Entry = std::tuple<int, int>;
 
 std::vector<Entry> getData(unsigned numEntries) {
@@ -703,6 +937,39 @@ TEST(Performance, Basic) {
     checkPerformance(t3, "souffle btree_set - 256 - binary", in, out);
 }
 
+TEST(Performance, TupleSearch) {
+    //        int N = 1<<22;
+    int N = 1 << 18;
+
+    // get list of distinct tuples to be inserted, with a leading column of 1000 values
+    using tuple_t = ram::Tuple<RamDomain, 3>;
+    using comp_t = ram::index_utils::comparator<0, 1, 2>;
+    std::cout << "Generating Test-Data ...\n";
+    std::vector<tuple_t> in;
+    std::vector<tuple_t> out;
+    time("generating data", [&]() {
+        std::vector<tuple_t> data(2 * N);
+        for (int i = 0; i < 2 * N; i++) {
+            data[i] = tuple_t{{i % 1000, i / 1000, i % 7}};
+        }
+        std::mt19937 generator(3);
+        shuffle(data.begin(), data.end(), generator);
+        for (std::size_t i = 0; i < data.size(); i += 2) {
+            in.push_back(data[i]);
+            out.push_back(data[i + 1]);
+        }
+    });
+
+    using t1 = btree_set<tuple_t, comp_t, std::allocator<tuple_t>, 256, detail::linear_search>;
+    checkPerformance(t1, "souffle btree_set - 256 - tuples - linear", in, out);
+
+    using t2 = btree_set<tuple_t, comp_t, std::allocator<tuple_t>, 256, detail::binary_search>;
+    checkPerformance(t2, "souffle btree_set - 256 - tuples - binary", in, out);
+
+    using t3 = btree_set<tuple_t, comp_t, std::allocator<tuple_t>, 256, detail::simd_search>;
+    checkPerformance(t3, "souffle btree_set - 256 - tuples - simd", in, out);
+}
+
 TEST(Performance, Load) {
     //        int N = 1<<24;
     int N = 1 << 20;
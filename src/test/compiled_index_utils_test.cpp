@@ -99,5 +99,40 @@ TEST(IndicesTools, FullIndex) {
     EXPECT_EQ(typeid(index<0, 1, 2, 3>), typeid(index_utils::get_full_index<4>::type));
 }
 
+/** Check whether both comparators agree on all pairs of a set of tuples with extreme values */
+template <typename Packed, typename Plain, size_t Arity>
+bool samePackedOrder() {
+    const RamDomain values[] = {std::numeric_limits<RamDomain>::min(), -2, -1, 0, 1, 2,
+            std::numeric_limits<RamDomain>::max()};
+    std::vector<Tuple<RamDomain, Arity>> tuples;
+    for (size_t i = 0; i < 200; ++i) {
+        Tuple<RamDomain, Arity> tuple;
+        for (size_t j = 0; j < Arity; ++j) {
+            tuple[j] = values[(i * 7 + j * 3 + i / 5) % 7];
+        }
+        tuples.push_back(tuple);
+    }
+    for (const auto& a : tuples) {
+        for (const auto& b : tuples) {
+            if (Plain()(a, b) != Packed()(a, b) || Plain().less(a, b) != Packed().less(a, b) ||
+                    Plain().equal(a, b) != Packed().equal(a, b)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST(IndicesTools, PackedComparator) {
+    using namespace index_utils;
+    EXPECT_EQ(typeid(comparator<0>), typeid(packed_comparator<0>));
+    EXPECT_EQ(1u, (packed_comparator<1, 0>::leading_column));
+
+    EXPECT_TRUE((samePackedOrder<packed_comparator<1, 0>, comparator<1, 0>, 2>()));
+    EXPECT_TRUE((samePackedOrder<packed_comparator<2, 0, 1>, comparator<2, 0, 1>, 3>()));
+    EXPECT_TRUE((samePackedOrder<packed_comparator<0, 1, 2, 3>, comparator<0, 1, 2, 3>, 4>()));
+    EXPECT_TRUE((samePackedOrder<packed_comparator<3, 1>, comparator<3, 1>, 4>()));
+}
+
 }  // namespace ram
 }  // end namespace souffle
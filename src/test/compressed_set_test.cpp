@@ -0,0 +1,153 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file compressed_set_test.cpp
+ *
+ * A test case testing the compressed set implementation.
+ *
+ ***********************************************************************/
+
+#include "CompiledTuple.h"
+#include "CompressedSet.h"
+#include "test.h"
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 2>;
+using Set = CompressedSet<Entry>;
+
+TEST(CompressedSet, Basic) {
+    Set set;
+    Set::operation_hints hints;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+    EXPECT_TRUE(set.lower_bound(Entry{{1, 2}}, hints) == set.end());
+
+    EXPECT_TRUE(set.insert(Entry{{1, 2}}));
+    EXPECT_TRUE(set.insert(Entry{{2, 1}}));
+    EXPECT_FALSE(set.insert(Entry{{1, 2}}));
+
+    EXPECT_FALSE(set.empty());
+    EXPECT_EQ(2, set.size());
+    EXPECT_TRUE(set.contains(Entry{{1, 2}}));
+    EXPECT_TRUE(set.contains(Entry{{2, 1}}));
+    EXPECT_FALSE(set.contains(Entry{{1, 1}}));
+
+    auto pos = set.find(Entry{{2, 1}}, hints);
+    EXPECT_TRUE(pos != set.end());
+    EXPECT_EQ((Entry{{2, 1}}), *pos);
+    EXPECT_TRUE(set.find(Entry{{2, 2}}, hints) == set.end());
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Entry{{1, 2}}));
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(CompressedSet, BulkInsert) {
+    // elements spanning several blocks, including duplicates and extreme values
+    std::vector<Entry> data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(Entry{{(i * 7919) % 301 - 150, i % 13 == 0 ? MIN_RAM_DOMAIN : i * i}});
+    }
+    data.push_back(Entry{{MAX_RAM_DOMAIN, MAX_RAM_DOMAIN}});
+    data.push_back(Entry{{MIN_RAM_DOMAIN, 0}});
+    data.push_back(data.front());
+    std::set<Entry> expected(data.begin(), data.end());
+
+    Set set;
+    set.insertBulk(data);
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::vector<Entry>(expected.begin(), expected.end()) ==
+                std::vector<Entry>(set.begin(), set.end()));
+
+    // a second bulk insert merges with the present elements
+    std::vector<Entry> more;
+    for (int i = 0; i < 500; i++) {
+        more.push_back(Entry{{i, -i}});
+    }
+    expected.insert(more.begin(), more.end());
+    set.insertBulk(more);
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::vector<Entry>(expected.begin(), expected.end()) ==
+                std::vector<Entry>(set.begin(), set.end()));
+    EXPECT_LT(set.getMemoryUsage(), expected.size() * sizeof(Entry));
+}
+
+TEST(CompressedSet, Bounds) {
+    std::set<Entry> expected;
+    std::vector<Entry> data;
+    for (int i = -300; i < 300; i += 3) {
+        for (int j = 0; j < 5; j++) {
+            data.push_back(Entry{{i, i * j}});
+            expected.insert(Entry{{i, i * j}});
+        }
+    }
+    Set set;
+    set.insertBulk(data);
+
+    Set::operation_hints hints;
+    for (int i = -310; i < 310; i++) {
+        for (RamDomain j : {MIN_RAM_DOMAIN, -1, 0, 1, 5, MAX_RAM_DOMAIN}) {
+            Entry key{{i, j}};
+            auto lower = set.lower_bound(key, hints);
+            auto upper = set.upper_bound(key, hints);
+            auto expectedLower = expected.lower_bound(key);
+            auto expectedUpper = expected.upper_bound(key);
+            EXPECT_EQ(expectedLower == expected.end(), lower == set.end());
+            EXPECT_EQ(expectedUpper == expected.end(), upper == set.end());
+            if (lower != set.end() && expectedLower != expected.end()) {
+                EXPECT_EQ(*expectedLower, *lower);
+            }
+            if (upper != set.end() && expectedUpper != expected.end()) {
+                EXPECT_EQ(*expectedUpper, *upper);
+            }
+            EXPECT_EQ(expected.count(key) > 0, set.contains(key, hints));
+        }
+    }
+}
+
+TEST(CompressedSet, Partition) {
+    Set set;
+    EXPECT_TRUE(set.partition(8).empty());
+
+    const int N = 10000;
+    std::vector<Entry> data;
+    for (int i = 0; i < N; i++) {
+        data.push_back(Entry{{i, -i}});
+    }
+    set.insertBulk(data);
+
+    for (std::size_t num : {1, 7, 100, 20000}) {
+        auto chunks = set.partition(num);
+        EXPECT_TRUE(chunks.size() <= num);
+        if (num == 1) {
+            EXPECT_EQ(1, chunks.size());
+        }
+        std::size_t count = 0;
+        std::set<Entry> visited;
+        for (const auto& chunk : chunks) {
+            EXPECT_TRUE(chunk.begin() != chunk.end());
+            for (const auto& cur : chunk) {
+                visited.insert(cur);
+                count++;
+            }
+        }
+        EXPECT_EQ(N, count);
+        EXPECT_EQ(N, visited.size());
+    }
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -57,5 +57,41 @@ TEST(Constraints, Basic) {
     EXPECT_EQ("{A->{1,2},B->{1,2,3}}", toString(p.solve()));
 }
 
+TEST(Constraints, Worklist) {
+    using Vars = Variable<string, set_property_space<int>>;
+
+    Vars A("A");
+    Vars B("B");
+    Vars C("C");
+    Vars D("D");
+
+    Problem<Vars> p;
+
+    // constraints are added against the direction of the propagation
+    p.add(sub(C, D));
+    p.add(sub(B, C));
+    p.add(sub(A, B));
+    p.add(sub(std::set<int>{1}, A));
+    EXPECT_EQ("{A->{1},B->{1},C->{1},D->{1}}", toString(p.solve()));
+
+    // a constraint not listing its variables is re-evaluated whenever any variable changes
+    struct CopyToD : public Constraint<Vars> {
+        Vars from;
+        Vars to;
+        CopyToD(Vars from, Vars to) : from(std::move(from)), to(std::move(to)) {}
+        bool update(Assignment<Vars>& ass) const override {
+            set_property_space<int>::meet_assign_op_type meet_assign;
+            return meet_assign(ass[to], ass[from]);
+        }
+        void print(std::ostream& out) const override {
+            out << from << " ~> " << to;
+        }
+    };
+    Vars E("E");
+    p.add(std::make_shared<CopyToD>(E, D));
+    p.add(sub(std::set<int>{2}, E));
+    EXPECT_EQ("{A->{1},B->{1},C->{1},D->{1,2},E->{2}}", toString(p.solve()));
+}
+
 }  // end namespace test
 }  // end namespace souffle
@@ -0,0 +1,522 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file data_structure_benchmark.cpp
+ *
+ * Micro-benchmarks of the data structures underlying relations, symbols
+ * and records: insertions, membership tests, range scans and partitions,
+ * and of writing and reading their tuples as CSV files.
+ *
+ * Binary relations are filled with the tuples (key / 16, key % 16) of the
+ * keys of the distribution, so that each value of the first column has up
+ * to 16 tuples to scan. Ternary tries are filled with the tuples
+ * (key / 256, key / 16 % 16, key % 16) to measure the contention of
+ * concurrent insertions on two levels of shared nodes.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "Brie.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "EquivalenceRelation.h"
+#include "IODirectives.h"
+#include "PiggyList.h"
+#include "RamTypes.h"
+#include "ReadStreamCSV.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "WriteStreamCSV.h"
+#include "benchmark.h"
+#include "json11.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+namespace {
+
+using tuple_t = ram::Tuple<RamDomain, 2>;
+using btree_t = btree_set<tuple_t, ram::index_utils::comparator<0, 1>>;
+using trie_t = Trie<2>;
+using trie3_t = Trie<3>;
+using eqrel_t = EquivalenceRelation<tuple_t>;
+
+tuple_t pair(RamDomain key) {
+    return tuple_t{{key / 16, key % 16}};
+}
+
+trie3_t::entry_type triple(RamDomain key) {
+    return trie3_t::entry_type{{key / 256, key / 16 % 16, key % 16}};
+}
+
+template <typename Set>
+std::unique_ptr<Set> fill(const std::vector<RamDomain>& keys) {
+    auto set = std::make_unique<Set>();
+    for (RamDomain key : keys) {
+        set->insert(pair(key));
+    }
+    return set;
+}
+
+template <>
+std::unique_ptr<eqrel_t> fill(const std::vector<RamDomain>& keys) {
+    auto set = std::make_unique<eqrel_t>();
+    for (RamDomain key : keys) {
+        set->insert(key / 16, key % 16);
+    }
+    return set;
+}
+
+/** Fill a trie on the threads of the state, each inserting its share of the keys into the trie */
+template <typename Trie, typename Entry>
+std::unique_ptr<Trie> insertShared(benchmark::State& state, const std::vector<RamDomain>& keys, Entry entry) {
+    auto set = std::make_unique<Trie>();
+    state.parallel(keys.size(), [&](size_t begin, size_t end) {
+        typename Trie::op_context ctxt;
+        for (size_t i = begin; i < end; ++i) {
+            set->insert(entry(keys[i]), ctxt);
+        }
+    });
+    return set;
+}
+
+/**
+ * Fill a trie on the threads of the state, each inserting its share of the keys into a subtrie of
+ * its own, which is merged into the trie once the thread is done
+ */
+template <typename Trie, typename Entry>
+std::unique_ptr<Trie> insertSubtries(
+        benchmark::State& state, const std::vector<RamDomain>& keys, Entry entry) {
+    auto set = std::make_unique<Trie>();
+    std::mutex lock;
+    state.parallel(keys.size(), [&](size_t begin, size_t end) {
+        Trie local;
+        typename Trie::op_context ctxt;
+        for (size_t i = begin; i < end; ++i) {
+            local.insert(entry(keys[i]), ctxt);
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        set->insertAll(local);
+    });
+    return set;
+}
+
+/** Count the elements of the partition of a set, scanning the chunks on the threads of the state */
+template <typename Set>
+size_t scanPartition(benchmark::State& state, const Set& set) {
+    auto chunks = set.partition(state.threads * 8);
+    std::atomic<size_t> count(0);
+    state.parallel(chunks.size(), [&](size_t begin, size_t end) {
+        size_t local = 0;
+        for (size_t i = begin; i < end; ++i) {
+            for (const auto& cur : chunks[i]) {
+                benchmark::doNotOptimize(cur);
+                ++local;
+            }
+        }
+        count += local;
+    });
+    return count;
+}
+
+using csv_tuple_t = ram::Tuple<RamDomain, 3>;
+
+/** The tuples (key, key * 7, key / 7.0) of a number, an unsigned and a float of each key */
+std::vector<csv_tuple_t> csvTuples(const std::vector<RamDomain>& keys) {
+    std::vector<csv_tuple_t> res;
+    for (RamDomain key : keys) {
+        res.push_back(csv_tuple_t{{key, ramBitCast(static_cast<RamUnsigned>(key) * 7),
+                ramBitCast(static_cast<RamFloat>(key) / 7)}});
+    }
+    return res;
+}
+
+/** The directives of a CSV file of the tuples of csvTuples */
+IODirectives csvDirectives(const std::string& fileName) {
+    std::vector<std::string> attributeTypes{"i", "u", "f"};
+    json11::Json types = json11::Json::object{
+            {"csv", json11::Json::object{{"arity", static_cast<long long>(3)},
+                            {"auxArity", static_cast<long long>(0)},
+                            {"types", json11::Json::array(attributeTypes.begin(), attributeTypes.end())}}}};
+    std::map<std::string, std::string> directives = {
+            {"IO", "file"}, {"name", "csv"}, {"filename", fileName}, {"types", types.dump()}};
+    return IODirectives(directives);
+}
+
+/** A relation counting the tuples read into it */
+struct CountingRelation {
+    size_t count = 0;
+
+    void insert(const RamDomain* /* tuple */) {
+        ++count;
+    }
+};
+
+}  // namespace
+
+// -- B-tree --
+
+BENCHMARK(BTree, Insert, false) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() { return fill<btree_t>(keys); });
+}
+
+BENCHMARK(BTree, ParallelInsert, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() {
+        auto set = std::make_unique<btree_t>();
+        state.parallel(keys.size(), [&](size_t begin, size_t end) {
+            btree_t::operation_hints hints;
+            for (size_t i = begin; i < end; ++i) {
+                set->insert(pair(keys[i]), hints);
+            }
+        });
+        return set;
+    });
+}
+
+BENCHMARK(BTree, Contains, true) {
+    auto keys = state.keys();
+    auto set = fill<btree_t>(keys);
+    auto probes = state.keys(7);
+    state.measure(probes.size(), [&]() {
+        std::atomic<size_t> found(0);
+        state.parallel(probes.size(), [&](size_t begin, size_t end) {
+            btree_t::operation_hints hints;
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                local += set->contains(pair(probes[i]), hints);
+            }
+            found += local;
+        });
+        return found.load();
+    });
+}
+
+BENCHMARK(BTree, RangeScan, true) {
+    auto keys = state.keys();
+    auto set = fill<btree_t>(keys);
+    auto probes = state.keys(7);
+    state.measure(probes.size(), [&]() {
+        std::atomic<size_t> found(0);
+        state.parallel(probes.size(), [&](size_t begin, size_t end) {
+            btree_t::operation_hints hints;
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                const RamDomain first = probes[i] / 16;
+                auto low = set->lower_bound(tuple_t{{first, std::numeric_limits<RamDomain>::min()}}, hints);
+                auto high = set->upper_bound(tuple_t{{first, std::numeric_limits<RamDomain>::max()}}, hints);
+                for (auto it = low; it != high; ++it) {
+                    ++local;
+                }
+            }
+            found += local;
+        });
+        return found.load();
+    });
+}
+
+BENCHMARK(BTree, PrefetchedRangeScan, true) {
+    auto keys = state.keys();
+    auto set = fill<btree_t>(keys);
+    auto probes = state.keys(7);
+    state.measure(probes.size(), [&]() {
+        std::atomic<size_t> found(0);
+        state.parallel(probes.size(), [&](size_t begin, size_t end) {
+            btree_t::operation_hints hints;
+            std::array<tuple_t, btree_t::PREFETCH_BATCH> lows;
+            size_t local = 0;
+            for (size_t batch = begin; batch < end; batch += lows.size()) {
+                const size_t count = std::min(end - batch, lows.size());
+                for (size_t i = 0; i < count; ++i) {
+                    lows[i] = tuple_t{{probes[batch + i] / 16, std::numeric_limits<RamDomain>::min()}};
+                }
+                set->prefetch(lows.data(), count, hints);
+                for (size_t i = 0; i < count; ++i) {
+                    auto low = set->lower_bound(lows[i], hints);
+                    auto high = set->upper_bound(
+                            tuple_t{{lows[i][0], std::numeric_limits<RamDomain>::max()}}, hints);
+                    for (auto it = low; it != high; ++it) {
+                        ++local;
+                    }
+                }
+            }
+            found += local;
+        });
+        return found.load();
+    });
+}
+
+BENCHMARK(BTree, Partition, true) {
+    auto set = fill<btree_t>(state.keys());
+    state.measure(set->size(), [&]() { return scanPartition(state, *set); });
+}
+
+// -- Brie --
+
+BENCHMARK(Trie, Insert, false) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() { return fill<trie_t>(keys); });
+}
+
+BENCHMARK(Trie, ParallelInsert, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() { return insertShared<trie_t>(state, keys, pair); });
+}
+
+BENCHMARK(Trie, ParallelInsertSubtries, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() { return insertSubtries<trie_t>(state, keys, pair); });
+}
+
+BENCHMARK(Trie, Contains, true) {
+    auto keys = state.keys();
+    auto set = fill<trie_t>(keys);
+    auto probes = state.keys(7);
+    state.measure(probes.size(), [&]() {
+        std::atomic<size_t> found(0);
+        state.parallel(probes.size(), [&](size_t begin, size_t end) {
+            trie_t::op_context ctxt;
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                local += set->contains(pair(probes[i]), ctxt);
+            }
+            found += local;
+        });
+        return found.load();
+    });
+}
+
+BENCHMARK(Trie, RangeScan, true) {
+    auto keys = state.keys();
+    auto set = fill<trie_t>(keys);
+    auto probes = state.keys(7);
+    state.measure(probes.size(), [&]() {
+        std::atomic<size_t> found(0);
+        state.parallel(probes.size(), [&](size_t begin, size_t end) {
+            trie_t::op_context ctxt;
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                for (const auto& cur : set->getBoundaries<1>(pair(probes[i]), ctxt)) {
+                    benchmark::doNotOptimize(cur);
+                    ++local;
+                }
+            }
+            found += local;
+        });
+        return found.load();
+    });
+}
+
+BENCHMARK(Trie, Partition, true) {
+    auto set = fill<trie_t>(state.keys());
+    state.measure(set->size(), [&]() { return scanPartition(state, *set); });
+}
+
+BENCHMARK(Trie3D, ParallelInsert, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() { return insertShared<trie3_t>(state, keys, triple); });
+}
+
+BENCHMARK(Trie3D, ParallelInsertSubtries, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() { return insertSubtries<trie3_t>(state, keys, triple); });
+}
+
+// -- Equivalence relation --
+
+BENCHMARK(EquivalenceRelation, Insert, false) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() { return fill<eqrel_t>(keys); });
+}
+
+BENCHMARK(EquivalenceRelation, ParallelInsert, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() {
+        auto set = std::make_unique<eqrel_t>();
+        state.parallel(keys.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                set->insert(keys[i] / 16, keys[i] % 16);
+            }
+        });
+        return set;
+    });
+}
+
+BENCHMARK(EquivalenceRelation, Contains, true) {
+    auto keys = state.keys();
+    auto set = fill<eqrel_t>(keys);
+    auto probes = state.keys(7);
+    state.measure(probes.size(), [&]() {
+        std::atomic<size_t> found(0);
+        state.parallel(probes.size(), [&](size_t begin, size_t end) {
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                local += set->contains(probes[i] / 16, probes[i] % 16);
+            }
+            found += local;
+        });
+        return found.load();
+    });
+}
+
+BENCHMARK(EquivalenceRelation, Partition, true) {
+    auto set = fill<eqrel_t>(state.keys());
+    state.measure(set->size(), [&]() { return scanPartition(state, *set); });
+}
+
+// -- Piggy list --
+
+BENCHMARK(PiggyList, Append, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() {
+        auto list = std::make_unique<PiggyList<RamDomain>>();
+        state.parallel(keys.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                list->append(keys[i]);
+            }
+        });
+        return list;
+    });
+}
+
+BENCHMARK(PiggyList, Get, true) {
+    auto keys = state.keys();
+    PiggyList<RamDomain> list;
+    for (RamDomain key : keys) {
+        list.append(key);
+    }
+    // the keys of the skewed distribution are below the size, so they are valid indexes
+    state.measure(keys.size(), [&]() {
+        std::atomic<size_t> sum(0);
+        state.parallel(keys.size(), [&](size_t begin, size_t end) {
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                local += list.get(keys[i]);
+            }
+            sum += local;
+        });
+        return sum.load();
+    });
+}
+
+// -- Symbol table --
+
+BENCHMARK(SymbolTable, Insert, true) {
+    std::vector<std::string> symbols;
+    for (RamDomain key : state.keys()) {
+        symbols.push_back("symbol_" + std::to_string(key));
+    }
+    state.measure(symbols.size(), [&]() {
+        auto table = std::make_unique<SymbolTable>();
+        state.parallel(symbols.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                table->lookup(symbols[i]);
+            }
+        });
+        return table;
+    });
+}
+
+BENCHMARK(SymbolTable, Resolve, true) {
+    SymbolTable table;
+    std::vector<RamDomain> indexes;
+    for (RamDomain key : state.keys()) {
+        indexes.push_back(table.lookup("symbol_" + std::to_string(key)));
+    }
+    state.measure(indexes.size(), [&]() {
+        std::atomic<size_t> length(0);
+        state.parallel(indexes.size(), [&](size_t begin, size_t end) {
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                local += table.resolve(indexes[i]).size();
+            }
+            length += local;
+        });
+        return length.load();
+    });
+}
+
+// -- Record table --
+
+BENCHMARK(RecordTable, Pack, true) {
+    auto keys = state.keys();
+    state.measure(keys.size(), [&]() {
+        auto table = std::make_unique<RecordTable>();
+        state.parallel(keys.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const RamDomain record[] = {keys[i] / 16, keys[i] % 16};
+                table->pack(record, 2);
+            }
+        });
+        return table;
+    });
+}
+
+BENCHMARK(RecordTable, Unpack, true) {
+    RecordTable table;
+    std::vector<RamDomain> references;
+    for (RamDomain key : state.keys()) {
+        const RamDomain record[] = {key / 16, key % 16};
+        references.push_back(table.pack(record, 2));
+    }
+    state.measure(references.size(), [&]() {
+        std::atomic<size_t> sum(0);
+        state.parallel(references.size(), [&](size_t begin, size_t end) {
+            size_t local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                local += table.unpack(references[i], 2)[1];
+            }
+            sum += local;
+        });
+        return sum.load();
+    });
+}
+
+// -- CSV files --
+
+BENCHMARK(CSV, Write, false) {
+    const auto tuples = csvTuples(state.keys());
+    const std::string fileName = "data_structure_benchmark.csv";
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    state.measure(tuples.size(), [&]() {
+        WriteFileCSV writer(csvDirectives(fileName), symbolTable, recordTable);
+        writer.writeAll(tuples);
+        return tuples.size();
+    });
+    std::remove(fileName.c_str());
+}
+
+BENCHMARK(CSV, Read, false) {
+    const std::string fileName = "data_structure_benchmark.csv";
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    {
+        WriteFileCSV writer(csvDirectives(fileName), symbolTable, recordTable);
+        writer.writeAll(csvTuples(state.keys()));
+    }
+    state.measure(state.size, [&]() {
+        CountingRelation relation;
+        ReadFileCSV reader(csvDirectives(fileName), symbolTable, recordTable);
+        reader.readAll(relation);
+        return relation.count;
+    });
+    std::remove(fileName.c_str());
+}
@@ -0,0 +1,209 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file dense_set_test.cpp
+ *
+ * A test case testing the dense set and adjacency set implementations.
+ *
+ ***********************************************************************/
+
+#include "CompiledTuple.h"
+#include "DenseSet.h"
+#include "ParallelUtils.h"
+#include "test.h"
+#include <random>
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Unary = ram::Tuple<RamDomain, 1>;
+using Binary = ram::Tuple<RamDomain, 2>;
+
+TEST(DenseSet, Basic) {
+    DenseSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert(Unary{{3}}));
+    EXPECT_TRUE(set.insert(Unary{{-5}}));
+    EXPECT_TRUE(set.insert(Unary{{MAX_RAM_DOMAIN}}));
+    EXPECT_TRUE(set.insert(Unary{{MIN_RAM_DOMAIN}}));
+    EXPECT_FALSE(set.insert(Unary{{3}}));
+
+    EXPECT_EQ(4, set.size());
+    EXPECT_TRUE(set.contains(Unary{{-5}}));
+    EXPECT_FALSE(set.contains(Unary{{5}}));
+
+    // elements are visited in the order of signed values
+    std::vector<RamDomain> values;
+    for (const auto& cur : set) {
+        values.push_back(cur[0]);
+    }
+    EXPECT_EQ((std::vector<RamDomain>{MIN_RAM_DOMAIN, -5, 3, MAX_RAM_DOMAIN}), values);
+
+    DenseSet::operation_hints hints;
+    EXPECT_EQ((Unary{{3}}), *set.lower_bound(Unary{{-4}}, hints));
+    EXPECT_EQ((Unary{{MAX_RAM_DOMAIN}}), *set.upper_bound(Unary{{3}}, hints));
+    EXPECT_TRUE(set.upper_bound(Unary{{MAX_RAM_DOMAIN}}, hints) == set.end());
+    EXPECT_TRUE(set.find(Unary{{4}}) == set.end());
+
+    auto single = set.getBoundaries<1>(Unary{{-5}}, hints);
+    EXPECT_EQ(1, std::distance(single.begin(), single.end()));
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Unary{{3}}));
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(DenseSet, Chunks) {
+    // a dense range turning chunks into bitmaps, and sparse values across chunks
+    std::set<RamDomain> expected;
+    DenseSet set;
+    for (RamDomain i = 0; i < 200000; i++) {
+        set.insert(Unary{{i}});
+        expected.insert(i);
+    }
+    std::mt19937 gen(3);
+    for (int i = 0; i < 10000; i++) {
+        RamDomain value = static_cast<RamDomain>(gen());
+        set.insert(Unary{{value}});
+        expected.insert(value);
+    }
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin(),
+            [](const Unary& a, RamDomain b) { return a[0] == b; }));
+
+    // lower bounds agree with the ordered set
+    DenseSet::operation_hints hints;
+    for (int i = 0; i < 1000; i++) {
+        RamDomain value = static_cast<RamDomain>(gen());
+        auto pos = set.lower_bound(Unary{{value}}, hints);
+        auto ref = expected.lower_bound(value);
+        if (ref == expected.end()) {
+            EXPECT_TRUE(pos == set.end());
+        } else {
+            EXPECT_EQ(*ref, (*pos)[0]);
+        }
+    }
+}
+
+TEST(DenseSet, Partition) {
+    DenseSet set;
+    EXPECT_TRUE(set.partition(8).empty());
+
+    const int N = 1000000;
+    for (int i = 0; i < N; i += 3) {
+        set.insert(Unary{{i}});
+    }
+    for (std::size_t num : {1, 4, 100}) {
+        std::size_t count = 0;
+        RamDomain last = -1;
+        for (const auto& chunk : set.partition(num)) {
+            EXPECT_TRUE(chunk.begin() != chunk.end());
+            for (const auto& cur : chunk) {
+                EXPECT_LT(last, cur[0]);
+                last = cur[0];
+                count++;
+            }
+        }
+        EXPECT_EQ(set.size(), count);
+    }
+}
+
+TEST(AdjacencySet, Basic) {
+    AdjacencySet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert(Binary{{1, 2}}));
+    EXPECT_TRUE(set.insert(Binary{{1, -2}}));
+    EXPECT_TRUE(set.insert(Binary{{-7, 4}}));
+    EXPECT_TRUE(set.insert(Binary{{9, 0}}));
+    EXPECT_FALSE(set.insert(Binary{{1, 2}}));
+
+    EXPECT_EQ(4, set.size());
+    EXPECT_TRUE(set.contains(Binary{{1, -2}}));
+    EXPECT_FALSE(set.contains(Binary{{2, 1}}));
+
+    std::vector<Binary> elements(set.begin(), set.end());
+    EXPECT_EQ((std::vector<Binary>{{{-7, 4}}, {{1, -2}}, {{1, 2}}, {{9, 0}}}), elements);
+
+    // the row of a source and the bounds between rows
+    AdjacencySet::operation_hints hints;
+    auto row = set.getBoundaries<1>(Binary{{1, 0}}, hints);
+    EXPECT_EQ((std::vector<Binary>{{{1, -2}}, {{1, 2}}}), std::vector<Binary>(row.begin(), row.end()));
+    EXPECT_TRUE(set.getBoundaries<1>(Binary{{2, 0}}, hints).empty());
+    EXPECT_EQ((Binary{{9, 0}}), *set.lower_bound(Binary{{1, 3}}, hints));
+    EXPECT_EQ((Binary{{1, 2}}), *set.upper_bound(Binary{{1, -2}}, hints));
+    EXPECT_TRUE(set.lower_bound(Binary{{9, 1}}, hints) == set.end());
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Binary{{1, 2}}));
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(AdjacencySet, LargeRows) {
+    // rows of growing degree, the larger of which are turned into key sets
+    std::set<Binary> expected;
+    AdjacencySet set;
+    std::mt19937 gen(5);
+    for (RamDomain source = 0; source < 64; source++) {
+        for (int i = 0; i < source * source; i++) {
+            Binary tuple{{source, static_cast<RamDomain>(gen() % 100000) - 50000}};
+            EXPECT_EQ(expected.insert(tuple).second, set.insert(tuple));
+        }
+    }
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+
+    AdjacencySet::operation_hints hints;
+    for (RamDomain source = 0; source < 64; source++) {
+        auto row = set.getBoundaries<1>(Binary{{source, 0}}, hints);
+        auto from = expected.lower_bound(Binary{{source, MIN_RAM_DOMAIN}});
+        auto to = expected.lower_bound(Binary{{source + 1, MIN_RAM_DOMAIN}});
+        EXPECT_TRUE(std::equal(row.begin(), row.end(), from, to));
+    }
+
+    std::size_t count = 0;
+    for (const auto& chunk : set.partition(10)) {
+        count += std::distance(chunk.begin(), chunk.end());
+    }
+    EXPECT_EQ(expected.size(), count);
+}
+
+TEST(AdjacencySet, ParallelInsert) {
+    const int N = 10000;
+    AdjacencySet set;
+    DenseSet sources;
+
+    // all threads insert all elements
+#pragma omp parallel for
+    for (int i = 0; i < 4 * N; i++) {
+        int j = i % N;
+        set.insert(Binary{{j % 97, j}});
+        sources.insert(Unary{{j % 97}});
+    }
+
+    EXPECT_EQ(N, set.size());
+    EXPECT_EQ(97, sources.size());
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(set.contains(Binary{{i % 97, i}}));
+    }
+    std::set<Binary> visited(set.begin(), set.end());
+    EXPECT_EQ(N, visited.size());
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,129 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file external_set_test.cpp
+ *
+ * A test case testing the external set implementation.
+ *
+ ***********************************************************************/
+
+#include "CompiledTuple.h"
+#include "ExternalSet.h"
+#include "test.h"
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 2>;
+using Set = ExternalSet<Entry>;
+
+TEST(ExternalSet, Basic) {
+    Set set;
+    Set::operation_hints hints;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert(Entry{{1, 2}}));
+    set.flush();
+    EXPECT_EQ(1, set.getNumRuns());
+    EXPECT_TRUE(set.insert(Entry{{2, 1}}));
+    EXPECT_FALSE(set.insert(Entry{{1, 2}}));
+    EXPECT_FALSE(set.insert(Entry{{2, 1}}));
+
+    EXPECT_FALSE(set.empty());
+    EXPECT_EQ(2, set.size());
+    EXPECT_TRUE(set.contains(Entry{{1, 2}}));
+    EXPECT_TRUE(set.contains(Entry{{2, 1}}));
+    EXPECT_FALSE(set.contains(Entry{{1, 1}}));
+
+    auto pos = set.find(Entry{{2, 1}}, hints);
+    EXPECT_TRUE(pos != set.end());
+    EXPECT_EQ((Entry{{2, 1}}), *pos);
+    EXPECT_TRUE(set.find(Entry{{2, 2}}, hints) == set.end());
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.getNumRuns());
+    EXPECT_FALSE(set.contains(Entry{{1, 2}}));
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(ExternalSet, Runs) {
+    Set set;
+    std::set<Entry> ref;
+
+    // spill a buffer after each batch, in an order interleaving the batches
+    for (int batch = 0; batch < 20; ++batch) {
+        for (int i = 0; i < 500; ++i) {
+            Entry cur{{(i * 7919 + batch * 13) % 1000, i % 3}};
+            EXPECT_EQ(ref.insert(cur).second, set.insert(cur));
+        }
+        set.flush();
+        EXPECT_EQ(ref.size(), set.size());
+    }
+
+    // runs of similar sizes are merged
+    EXPECT_LT(set.getNumRuns(), 10);
+
+    std::vector<Entry> all(set.begin(), set.end());
+    EXPECT_EQ(std::vector<Entry>(ref.begin(), ref.end()), all);
+
+    // bounds across the buffer and the runs
+    set.insert(Entry{{500, 5}});
+    ref.insert(Entry{{500, 5}});
+    Set::operation_hints hints;
+    Entry low{{500, 0}};
+    Entry high{{501, 0}};
+    std::vector<Entry> part(set.lower_bound(low, hints), set.lower_bound(high, hints));
+    EXPECT_EQ(std::vector<Entry>(ref.lower_bound(low), ref.lower_bound(high)), part);
+    EXPECT_EQ(*ref.upper_bound(low), *set.upper_bound(low, hints));
+}
+
+TEST(ExternalSet, Partition) {
+    Set set;
+    for (int i = 0; i < 10000; ++i) {
+        set.insert(Entry{{i, -i}});
+        if (i % 3000 == 0) {
+            set.flush();
+        }
+    }
+
+    auto chunks = set.partition(16);
+    EXPECT_LT(chunks.size(), 17);
+    std::vector<Entry> all;
+    for (const auto& chunk : chunks) {
+        for (const auto& cur : chunk) {
+            all.push_back(cur);
+        }
+    }
+    EXPECT_EQ(std::vector<Entry>(set.begin(), set.end()), all);
+    EXPECT_EQ(10000, all.size());
+}
+
+TEST(ExternalSet, Budget) {
+    ExternalMemory::budget = 1000 * sizeof(Entry);
+    Set set;
+    for (int i = 0; i < 5000; ++i) {
+        set.insert(Entry{{i, i}});
+        if (i % 500 == 499) {
+            set.spill();
+        }
+    }
+    EXPECT_LT(0, set.getNumRuns());
+    EXPECT_EQ(5000, set.size());
+    EXPECT_LT(ExternalMemory::buffered, ExternalMemory::budget + 1);
+    ExternalMemory::budget = 0;
+}
+
+}  // namespace test
+}  // namespace souffle
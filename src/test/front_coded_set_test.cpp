@@ -0,0 +1,171 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file front_coded_set_test.cpp
+ *
+ * A test case testing the front coded set implementation.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "CompiledTuple.h"
+#include "FrontCodedSet.h"
+#include "test.h"
+#include <random>
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 3>;
+using Set = FrontCodedSet<Entry, 8>;
+
+using Wide = ram::Tuple<RamDomain, 10>;
+
+TEST(FrontCodedSet, Basic) {
+    Set set;
+    Set::operation_hints hints;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+    EXPECT_TRUE(set.lower_bound(Entry{{1, 2, 3}}, hints) == set.end());
+
+    EXPECT_TRUE(set.insert(Entry{{1, 2, 3}}));
+    EXPECT_TRUE(set.insert(Entry{{1, 2, -3}}));
+    EXPECT_TRUE(set.insert(Entry{{MIN_RAM_DOMAIN, MAX_RAM_DOMAIN, 0}}));
+    EXPECT_TRUE(set.insert(Entry{{MAX_RAM_DOMAIN, MIN_RAM_DOMAIN, MAX_RAM_DOMAIN}}));
+    EXPECT_FALSE(set.insert(Entry{{1, 2, 3}}));
+
+    EXPECT_EQ(4, set.size());
+    EXPECT_TRUE(set.contains(Entry{{1, 2, -3}}));
+    EXPECT_FALSE(set.contains(Entry{{1, 2, 0}}));
+
+    std::vector<Entry> elements(set.begin(), set.end());
+    EXPECT_EQ((std::vector<Entry>{{{MIN_RAM_DOMAIN, MAX_RAM_DOMAIN, 0}}, {{1, 2, -3}}, {{1, 2, 3}},
+                      {{MAX_RAM_DOMAIN, MIN_RAM_DOMAIN, MAX_RAM_DOMAIN}}}),
+            elements);
+
+    EXPECT_EQ((Entry{{1, 2, 3}}), *set.lower_bound(Entry{{1, 2, 0}}, hints));
+    EXPECT_EQ((Entry{{1, 2, 3}}), *set.upper_bound(Entry{{1, 2, -3}}, hints));
+    EXPECT_TRUE(set.find(Entry{{1, 2, 0}}, hints) == set.end());
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Entry{{1, 2, 3}}));
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(FrontCodedSet, Insert) {
+    // random inserts splitting blocks, and inserts preceding all elements
+    std::set<Entry> expected;
+    Set set;
+    std::mt19937 gen(7);
+    for (int i = 0; i < 20000; i++) {
+        Entry entry{{static_cast<RamDomain>(gen() % 50) - 25, static_cast<RamDomain>(gen() % 20),
+                static_cast<RamDomain>(gen())}};
+        if (i % 1000 == 0) {
+            entry[0] = -i;
+        }
+        EXPECT_EQ(expected.insert(entry).second, set.insert(entry));
+    }
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+
+    Set::operation_hints hints;
+    for (int i = 0; i < 2000; i++) {
+        Entry key{{static_cast<RamDomain>(gen() % 60) - 30, static_cast<RamDomain>(gen() % 20), 0}};
+        auto lower = set.lower_bound(key, hints);
+        auto expectedLower = expected.lower_bound(key);
+        EXPECT_EQ(expectedLower == expected.end(), lower == set.end());
+        if (lower != set.end() && expectedLower != expected.end()) {
+            EXPECT_EQ(*expectedLower, *lower);
+        }
+    }
+
+    // compaction retains the elements
+    set.compact();
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(set.insert(Entry{{100, 0, 0}}));
+    EXPECT_TRUE(set.contains(Entry{{100, 0, 0}}));
+}
+
+TEST(FrontCodedSet, InsertBulk) {
+    std::set<Entry> expected;
+    std::vector<Entry> data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(Entry{{i % 7, (i * 7919) % 301 - 150, i % 13 == 0 ? MIN_RAM_DOMAIN : i * i}});
+    }
+    data.push_back(data.front());
+    expected.insert(data.begin(), data.end());
+
+    Set set;
+    set.insertBulk(data);
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+
+    // few elements are inserted one by one, many are merged
+    for (int num : {10, 3000}) {
+        std::vector<Entry> more;
+        for (int i = 0; i < num; i++) {
+            more.push_back(Entry{{i % 11, -i, i}});
+        }
+        expected.insert(more.begin(), more.end());
+        set.insertBulk(more);
+        EXPECT_EQ(expected.size(), set.size());
+        EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+    }
+
+    std::size_t count = 0;
+    for (const auto& chunk : set.partition(7)) {
+        count += std::distance(chunk.begin(), chunk.end());
+    }
+    EXPECT_EQ(expected.size(), count);
+}
+
+TEST(FrontCodedSet, WideMemory) {
+    // wide tuples repeating most of their columns take a fraction of the memory of a b-tree
+    FrontCodedSet<Wide> set;
+    btree_set<Wide> reference;
+    std::mt19937 gen(11);
+    for (int i = 0; i < 100000; i++) {
+        RamDomain file = gen() % 10;
+        RamDomain method = file * 100 + gen() % 100;
+        Wide tuple{{file, method, 0, 1, static_cast<RamDomain>(gen() % 1000), file, 7, -1, method,
+                static_cast<RamDomain>(gen() % 100000)}};
+        EXPECT_EQ(reference.insert(tuple), set.insert(tuple));
+    }
+    EXPECT_EQ(reference.size(), set.size());
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), reference.begin(), reference.end()));
+    EXPECT_LT(set.getMemoryUsage() * 3, reference.getMemoryUsage());
+}
+
+TEST(FrontCodedSet, ParallelInsert) {
+    const int N = 10000;
+    Set set;
+
+    // all threads insert all elements
+#pragma omp parallel for
+    for (int i = 0; i < 4 * N; i++) {
+        int j = (i * 7919) % N;
+        set.insert(Entry{{j % 10, j % 97, j}});
+    }
+
+    EXPECT_EQ(N, set.size());
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(set.contains(Entry{{i % 10, i % 97, i}}));
+    }
+    std::set<Entry> visited(set.begin(), set.end());
+    EXPECT_EQ(N, visited.size());
+}
+
+}  // namespace test
+}  // namespace souffle
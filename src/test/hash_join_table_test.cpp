@@ -0,0 +1,77 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hash_join_table_test.cpp
+ *
+ * A test case testing the hash table of hash joins.
+ *
+ ***********************************************************************/
+
+#include "CompiledTuple.h"
+#include "HashJoinTable.h"
+#include "test.h"
+#include <map>
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Key = ram::Tuple<RamDomain, 1>;
+using Entry = ram::Tuple<RamDomain, 2>;
+using Table = HashJoinTable<Key, Entry>;
+
+std::multiset<Entry> probe(const Table& table, RamDomain key) {
+    std::multiset<Entry> res;
+    table.probe(Key{{key}}, [&](const Entry& entry) { res.insert(entry); });
+    return res;
+}
+
+TEST(HashJoinTable, Empty) {
+    Table table;
+    EXPECT_EQ(0, table.size());
+    EXPECT_TRUE(probe(table, 1).empty());
+    table.build();
+    EXPECT_TRUE(probe(table, 1).empty());
+}
+
+TEST(HashJoinTable, Probe) {
+    Table table;
+    table.insert(Key{{1}}, Entry{{1, 2}});
+    table.insert(Key{{2}}, Entry{{2, 3}});
+    table.insert(Key{{1}}, Entry{{1, 4}});
+    table.insert(Key{{1}}, Entry{{1, 4}});
+    table.build();
+    EXPECT_EQ(4, table.size());
+
+    // duplicates are kept, as each pair of joined tuples is evaluated
+    EXPECT_EQ(std::multiset<Entry>({Entry{{1, 2}}, Entry{{1, 4}}, Entry{{1, 4}}}), probe(table, 1));
+    EXPECT_EQ(std::multiset<Entry>({Entry{{2, 3}}}), probe(table, 2));
+    EXPECT_TRUE(probe(table, 3).empty());
+}
+
+TEST(HashJoinTable, Large) {
+    const int N = 10000;
+    Table table;
+    std::map<RamDomain, std::multiset<Entry>> expected;
+    for (int i = 0; i < N; i++) {
+        const Entry entry{{i % 97, i}};
+        table.insert(Key{{entry[0]}}, entry);
+        expected[entry[0]].insert(entry);
+    }
+    table.build();
+    EXPECT_EQ(N, table.size());
+    for (RamDomain key = 0; key < 100; key++) {
+        EXPECT_EQ(expected[key], probe(table, key));
+    }
+}
+
+}  // end namespace test
+}  // end namespace souffle
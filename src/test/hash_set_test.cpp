@@ -0,0 +1,127 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hash_set_test.cpp
+ *
+ * A test case testing the concurrent hash set implementation.
+ *
+ ***********************************************************************/
+
+#include "CompiledTuple.h"
+#include "HashSet.h"
+#include "ParallelUtils.h"
+#include "test.h"
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 2>;
+using Set = HashSet<Entry>;
+
+TEST(HashSet, Basic) {
+    Set set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert(Entry{{1, 2}}));
+    EXPECT_TRUE(set.insert(Entry{{2, 1}}));
+    EXPECT_FALSE(set.insert(Entry{{1, 2}}));
+
+    EXPECT_FALSE(set.empty());
+    EXPECT_EQ(2, set.size());
+    EXPECT_TRUE(set.contains(Entry{{1, 2}}));
+    EXPECT_TRUE(set.contains(Entry{{2, 1}}));
+    EXPECT_FALSE(set.contains(Entry{{1, 1}}));
+
+    auto pos = set.find(Entry{{2, 1}});
+    EXPECT_TRUE(pos != set.end());
+    EXPECT_EQ((Entry{{2, 1}}), *pos);
+    EXPECT_TRUE(set.find(Entry{{2, 2}}) == set.end());
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Entry{{1, 2}}));
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(HashSet, Growth) {
+    const int N = 10000;
+    Set set;
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(set.insert(Entry{{i, -i}}));
+    }
+    EXPECT_EQ(N, set.size());
+
+    // all elements are found and visited exactly once
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(set.contains(Entry{{i, -i}}));
+        EXPECT_FALSE(set.contains(Entry{{i, i + 1}}));
+    }
+    std::set<Entry> visited(set.begin(), set.end());
+    EXPECT_EQ(N, visited.size());
+    EXPECT_EQ((Entry{{0, 0}}), *visited.begin());
+}
+
+TEST(HashSet, Partition) {
+    Set set;
+    EXPECT_TRUE(set.partition(8).empty());
+
+    const int N = 10000;
+    for (int i = 0; i < N; i++) {
+        set.insert(Entry{{i, i}});
+    }
+
+    for (std::size_t num : {1, 7, 100, 20000}) {
+        auto chunks = set.partition(num);
+        EXPECT_TRUE(chunks.size() <= std::min<std::size_t>(num, N));
+        if (num == 1) {
+            EXPECT_EQ(1, chunks.size());
+        }
+        std::size_t count = 0;
+        std::set<Entry> visited;
+        for (const auto& chunk : chunks) {
+            EXPECT_TRUE(chunk.begin() != chunk.end());
+            for (const auto& cur : chunk) {
+                visited.insert(cur);
+                count++;
+            }
+        }
+        EXPECT_EQ(N, count);
+        EXPECT_EQ(N, visited.size());
+    }
+}
+
+TEST(HashSet, ParallelInsert) {
+    const int N = 10000;
+    Set set;
+
+    // all threads insert all elements, while probing for the ones of the previous round
+#pragma omp parallel for
+    for (int i = 0; i < 4 * N; i++) {
+        int j = i % N;
+        set.insert(Entry{{j, j % 7}});
+        if (j > 0) {
+            set.contains(Entry{{j - 1, (j - 1) % 7}});
+        }
+    }
+
+    EXPECT_EQ(N, set.size());
+    for (int i = 0; i < N; i++) {
+        EXPECT_TRUE(set.contains(Entry{{i, i % 7}}));
+    }
+    std::set<Entry> visited(set.begin(), set.end());
+    EXPECT_EQ(N, visited.size());
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,67 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hyper_log_log_test.cpp
+ *
+ * A test case testing the estimates of distinct values by HyperLogLog
+ * sketches.
+ *
+ ***********************************************************************/
+
+#include "HyperLogLog.h"
+#include "RamTypes.h"
+#include "test.h"
+#include <cstdlib>
+
+namespace souffle {
+namespace test {
+
+TEST(HyperLogLog, Small) {
+    HyperLogLog sketch;
+    EXPECT_EQ(0, sketch.estimate());
+
+    for (int i = 0; i < 100; ++i) {
+        sketch.add(i % 3);
+    }
+    EXPECT_EQ(3, sketch.estimate());
+
+    for (RamDomain i = 0; i < 100; ++i) {
+        sketch.add(i);
+    }
+    EXPECT_EQ(100, sketch.estimate());
+}
+
+TEST(HyperLogLog, Large) {
+    for (int n : {10000, 100000, 1000000}) {
+        HyperLogLog sketch;
+        for (int i = 0; i < n; ++i) {
+            sketch.add(static_cast<RamDomain>(i * 7));
+            sketch.add(static_cast<RamDomain>(i * 7));
+        }
+        // within five standard errors
+        EXPECT_LT(std::abs(static_cast<double>(sketch.estimate()) - n), 0.08 * n);
+    }
+}
+
+TEST(HyperLogLog, Merge) {
+    const int n = 100000;
+    HyperLogLog a;
+    HyperLogLog b;
+    HyperLogLog all;
+    for (int i = 0; i < n; ++i) {
+        (i % 2 == 0 ? a : b).add(i);
+        all.add(i);
+    }
+    a.merge(b);
+    EXPECT_EQ(all.estimate(), a.estimate());
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,206 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file interpreter_fusion_test.cpp
+ *
+ * Tests the evaluation of fused interpreter nodes, i.e., negated existence
+ * checks, simple constraints, simple projections and batched scans.
+ *
+ ***********************************************************************/
+
+#include "DebugReport.h"
+#include "ErrorReport.h"
+#include "InterpreterEngine.h"
+#include "RamCondition.h"
+#include "RamExpression.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamStatement.h"
+#include "RamTranslationUnit.h"
+#include "SymbolTable.h"
+
+#include "test.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+using ExprVec = std::vector<std::unique_ptr<RamExpression>>;
+
+/** Build a vector of constant expressions */
+ExprVec constants(const std::vector<RamDomain>& values) {
+    ExprVec res;
+    for (RamDomain value : values) {
+        res.push_back(std::make_unique<RamSignedConstant>(value));
+    }
+    return res;
+}
+
+/** Build a query projecting a constant tuple into the given relation */
+std::unique_ptr<RamStatement> fact(const RamRelation* rel, const std::vector<RamDomain>& values) {
+    return std::make_unique<RamQuery>(
+            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(rel), constants(values)));
+}
+
+/**
+ * Program with A = {(1,2), (1,5), (3,4)} and B = {(5)}. The main program computes
+ *   C(y, x) :- A(x, y), x = 1, !B(y).
+ * and the subroutine returns all tuples of C with the first element below the argument.
+ */
+TEST(Fusion, Evaluation) {
+    Global::config().set("jobs", "1");
+
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    rels.push_back(std::make_unique<RamRelation>("A", 2, 0, std::vector<std::string>({"x", "y"}),
+            std::vector<std::string>({"i", "i"}), RelationRepresentation::DEFAULT));
+    rels.push_back(std::make_unique<RamRelation>("B", 1, 0, std::vector<std::string>({"x"}),
+            std::vector<std::string>({"i"}), RelationRepresentation::DEFAULT));
+    rels.push_back(std::make_unique<RamRelation>("C", 2, 0, std::vector<std::string>({"x", "y"}),
+            std::vector<std::string>({"i", "i"}), RelationRepresentation::DEFAULT));
+    const RamRelation* relA = rels[0].get();
+    const RamRelation* relB = rels[1].get();
+    const RamRelation* relC = rels[2].get();
+
+    // C(t0.1, t0.0) for t0 in A if t0.0 = 1 and not (t0.1) in B
+    ExprVec existsValues;
+    existsValues.push_back(std::make_unique<RamTupleElement>(0, 1));
+    auto condition = std::make_unique<RamConjunction>(
+            std::make_unique<RamConstraint>(BinaryConstraintOp::EQ, std::make_unique<RamTupleElement>(0, 0),
+                    std::make_unique<RamSignedConstant>(1)),
+            std::make_unique<RamNegation>(std::make_unique<RamExistenceCheck>(
+                    std::make_unique<RamRelationReference>(relB), std::move(existsValues))));
+    ExprVec projectValues;
+    projectValues.push_back(std::make_unique<RamTupleElement>(0, 1));
+    projectValues.push_back(std::make_unique<RamTupleElement>(0, 0));
+    auto rule = std::make_unique<RamQuery>(
+            std::make_unique<RamScan>(std::make_unique<RamRelationReference>(relA), 0,
+                    std::make_unique<RamFilter>(std::move(condition),
+                            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(relC),
+                                    std::move(projectValues)))));
+
+    auto main = std::make_unique<RamSequence>(fact(relA, {1, 2}), fact(relA, {1, 5}), fact(relA, {3, 4}),
+            fact(relB, {5}), std::move(rule));
+
+    // return t0.0, t0.1 for t0 in C if t0.0 < arg(0)
+    ExprVec returnValues;
+    returnValues.push_back(std::make_unique<RamTupleElement>(0, 0));
+    returnValues.push_back(std::make_unique<RamTupleElement>(0, 1));
+    auto sub = std::make_unique<RamQuery>(std::make_unique<RamScan>(
+            std::make_unique<RamRelationReference>(relC), 0,
+            std::make_unique<RamFilter>(std::make_unique<RamConstraint>(BinaryConstraintOp::LT,
+                                                std::make_unique<RamTupleElement>(0, 0),
+                                                std::make_unique<RamSubroutineArgument>(0)),
+                    std::make_unique<RamSubroutineReturnValue>(std::move(returnValues)))));
+    std::map<std::string, std::unique_ptr<RamStatement>> subs;
+    subs.insert(std::make_pair("test", std::move(sub)));
+
+    auto prog = std::make_unique<RamProgram>(std::move(rels), std::move(main), std::move(subs));
+    SymbolTable symTab;
+    ErrorReport errReport;
+    DebugReport debugReport;
+    RamTranslationUnit translationUnit(std::move(prog), symTab, errReport, debugReport);
+    InterpreterEngine interpreter(translationUnit);
+    interpreter.executeMain();
+
+    std::vector<RamDomain> ret;
+    interpreter.executeSubroutine("test", {10}, ret);
+    EXPECT_EQ(std::vector<RamDomain>({2, 1}), ret);
+
+    ret.clear();
+    interpreter.executeSubroutine("test", {2}, ret);
+    EXPECT_TRUE(ret.empty());
+}
+
+/**
+ * Program with D = {0, ..., 59}, computing A(x, y) :- D(x), D(y). and
+ *   C(x, y) :- A(x, y), 10 < x, y != 3, x < y.
+ * such that the scan of A spans several batches. The subroutine returns all tuples of C.
+ */
+TEST(Fusion, Batches) {
+    Global::config().set("jobs", "1");
+
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    rels.push_back(std::make_unique<RamRelation>("D", 1, 0, std::vector<std::string>({"x"}),
+            std::vector<std::string>({"i"}), RelationRepresentation::DEFAULT));
+    rels.push_back(std::make_unique<RamRelation>("A", 2, 0, std::vector<std::string>({"x", "y"}),
+            std::vector<std::string>({"i", "i"}), RelationRepresentation::DEFAULT));
+    rels.push_back(std::make_unique<RamRelation>("C", 2, 0, std::vector<std::string>({"x", "y"}),
+            std::vector<std::string>({"i", "i"}), RelationRepresentation::DEFAULT));
+    const RamRelation* relD = rels[0].get();
+    const RamRelation* relA = rels[1].get();
+    const RamRelation* relC = rels[2].get();
+
+    std::unique_ptr<RamStatement> main = fact(relD, {0});
+    for (RamDomain i = 1; i < 60; i++) {
+        main = std::make_unique<RamSequence>(std::move(main), fact(relD, {i}));
+    }
+
+    // A(t0.0, t1.0) for t0 in D for t1 in D
+    ExprVec productValues;
+    productValues.push_back(std::make_unique<RamTupleElement>(0, 0));
+    productValues.push_back(std::make_unique<RamTupleElement>(1, 0));
+    auto product = std::make_unique<RamQuery>(std::make_unique<RamScan>(
+            std::make_unique<RamRelationReference>(relD), 0,
+            std::make_unique<RamScan>(std::make_unique<RamRelationReference>(relD), 1,
+                    std::make_unique<RamProject>(
+                            std::make_unique<RamRelationReference>(relA), std::move(productValues)))));
+
+    // C(t0.0, t0.1) for t0 in A if 10 < t0.0 and t0.1 != 3 and t0.0 < t0.1
+    auto condition = std::make_unique<RamConjunction>(
+            std::make_unique<RamConjunction>(
+                    std::make_unique<RamConstraint>(BinaryConstraintOp::LT,
+                            std::make_unique<RamSignedConstant>(10), std::make_unique<RamTupleElement>(0, 0)),
+                    std::make_unique<RamConstraint>(BinaryConstraintOp::NE,
+                            std::make_unique<RamTupleElement>(0, 1), std::make_unique<RamSignedConstant>(3))),
+            std::make_unique<RamConstraint>(BinaryConstraintOp::LT, std::make_unique<RamTupleElement>(0, 0),
+                    std::make_unique<RamTupleElement>(0, 1)));
+    ExprVec projectValues;
+    projectValues.push_back(std::make_unique<RamTupleElement>(0, 0));
+    projectValues.push_back(std::make_unique<RamTupleElement>(0, 1));
+    auto rule = std::make_unique<RamQuery>(
+            std::make_unique<RamScan>(std::make_unique<RamRelationReference>(relA), 0,
+                    std::make_unique<RamFilter>(std::move(condition),
+                            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(relC),
+                                    std::move(projectValues)))));
+    main = std::make_unique<RamSequence>(std::move(main), std::move(product), std::move(rule));
+
+    ExprVec returnValues;
+    returnValues.push_back(std::make_unique<RamTupleElement>(0, 0));
+    returnValues.push_back(std::make_unique<RamTupleElement>(0, 1));
+    auto sub = std::make_unique<RamQuery>(
+            std::make_unique<RamScan>(std::make_unique<RamRelationReference>(relC), 0,
+                    std::make_unique<RamSubroutineReturnValue>(std::move(returnValues))));
+    std::map<std::string, std::unique_ptr<RamStatement>> subs;
+    subs.insert(std::make_pair("test", std::move(sub)));
+
+    auto prog = std::make_unique<RamProgram>(std::move(rels), std::move(main), std::move(subs));
+    SymbolTable symTab;
+    ErrorReport errReport;
+    DebugReport debugReport;
+    RamTranslationUnit translationUnit(std::move(prog), symTab, errReport, debugReport);
+    InterpreterEngine interpreter(translationUnit);
+    interpreter.executeMain();
+
+    std::vector<RamDomain> ret;
+    interpreter.executeSubroutine("test", {}, ret);
+    std::vector<RamDomain> expected;
+    for (RamDomain x = 11; x < 60; x++) {
+        for (RamDomain y = x + 1; y < 60; y++) {
+            expected.push_back(x);
+            expected.push_back(y);
+        }
+    }
+    EXPECT_EQ(expected, ret);
+}
+
+}  // namespace souffle::test
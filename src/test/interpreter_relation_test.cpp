@@ -18,6 +18,7 @@
 #include "InterpreterRelation.h"
 #include "SouffleInterface.h"
 #include "test.h"
+#include <numeric>
 
 using namespace souffle;
 
@@ -161,4 +162,447 @@ TEST(IndependentCopying, Iteration) {
     EXPECT_EQ(1, (*it)[0]);
 }
 
+TEST(Relation2, InsertBulk) {
+    // create a binary relation with two indexes
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.addSearch(1);
+    order.addSearch(2);
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    EXPECT_EQ(2, order.getAllOrders().size());
+
+    // tuples are stored with a stride of three
+    std::vector<RamDomain> tuples{3, 1, 0, 1, 2, 0, 3, 1, 0, 2, 5, 0};
+    rel.insertBulk(tuples.data(), 4, 3);
+    EXPECT_EQ(3, rel.size());
+    for (auto cur : rel) {
+        EXPECT_TRUE(cur[0] == 1 || cur[0] == 2 || cur[0] == 3);
+    }
+
+    // both indexes are loaded
+    RamDomain low[2] = {MIN_RAM_DOMAIN, 5};
+    RamDomain high[2] = {MAX_RAM_DOMAIN, 5};
+    EXPECT_TRUE(rel.contains(order.getLexOrderNum(2), TupleRef(low, 2), TupleRef(high, 2)));
+    low[1] = high[1] = 4;
+    EXPECT_FALSE(rel.contains(order.getLexOrderNum(2), TupleRef(low, 2), TupleRef(high, 2)));
+
+    // a bulk insertion into a non-empty relation
+    std::vector<RamDomain> more{1, 2, 0, 4, 4, 0};
+    rel.insertBulk(more.data(), 2, 3);
+    EXPECT_EQ(4, rel.size());
+    RamDomain existing[2] = {4, 4};
+    EXPECT_TRUE(rel.contains(TupleRef(existing, 2)));
+}
+
+TEST(Relation2, EvictIndexes) {
+    MinIndexSelection order{};
+    order.addSearch(1);
+    order.addSearch(2);
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    const size_t secondary = order.getLexOrderNum(2);
+    std::vector<RamDomain> tuples{3, 1, 1, 2, 2, 5};
+    rel.insertBulk(tuples.data(), 3, 2);
+
+    // the secondary index is dropped, the main index kept
+    const size_t bytes = rel.getMemoryUsage()[secondary];
+    EXPECT_LT(0, rel.evictIndexes());
+    EXPECT_LT(rel.getMemoryUsage()[secondary], bytes);
+    EXPECT_EQ(0, rel.evictIndexes());
+    RamDomain inserted[2] = {4, 5};
+    rel.insert(TupleRef(inserted, 2));
+    EXPECT_EQ(4, rel.size());
+
+    // and built again from the main index, including the tuples inserted since
+    rel.restoreIndexes();
+    RamDomain low[2] = {MIN_RAM_DOMAIN, 5};
+    RamDomain high[2] = {MAX_RAM_DOMAIN, 5};
+    size_t found = 0;
+    for (const auto& cur : rel.range(secondary, TupleRef(low, 2), TupleRef(high, 2))) {
+        EXPECT_EQ(5, cur[1]);
+        ++found;
+    }
+    EXPECT_EQ(2, found);
+}
+
+TEST(Relation2, Merge) {
+    MinIndexSelection order{};
+    order.addSearch(1);
+    order.addSearch(2);
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    InterpreterRelation other(2, 0, "other", {"i", "i"}, order);
+    const size_t secondary = order.getLexOrderNum(2);
+
+    // a merge of enough new tuples to maintain both indexes concurrently, some of them known already
+    const RamDomain N = 3 * InterpreterRelation::PARALLEL_INDEX_TUPLES;
+    for (RamDomain i = 0; i < N; i += 3) {
+        RamDomain known[2] = {i, i % 7};
+        rel.insert(TupleRef(known, 2));
+    }
+    for (RamDomain i = N - 1; i >= 0; --i) {
+        RamDomain fresh[2] = {i, i % 7};
+        other.insert(TupleRef(fresh, 2));
+    }
+    rel.insert(other);
+    EXPECT_EQ(N, rel.size());
+
+    // both indexes hold all tuples
+    RamDomain low[2] = {MIN_RAM_DOMAIN, 3};
+    RamDomain high[2] = {MAX_RAM_DOMAIN, 3};
+    size_t found = 0;
+    for (const auto& cur : rel.range(secondary, TupleRef(low, 2), TupleRef(high, 2))) {
+        EXPECT_EQ(3, cur[0] % 7);
+        ++found;
+    }
+    EXPECT_EQ(N / 7 + (N % 7 > 3 ? 1 : 0), found);
+}
+
+TEST(Relation2, Views) {
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    RamDomain first[2] = {1, 2};
+    RamDomain second[2] = {3, 4};
+    rel.insert(TupleRef(first, 2));
+
+    // a thread obtains the same view for the same position again, also after insertions
+    IndexView* view = rel.getView(0, 0);
+    EXPECT_EQ(view, rel.getView(0, 0));
+    EXPECT_NE(view, rel.getView(0, 1));
+    rel.insert(TupleRef(second, 2));
+    EXPECT_EQ(view, rel.getView(0, 0));
+    EXPECT_TRUE(view->contains(TupleRef(first, 2)));
+    EXPECT_TRUE(view->contains(TupleRef(second, 2)));
+
+    // purging the relation invalidates the view
+    rel.purge();
+    rel.insert(TupleRef(second, 2));
+    view = rel.getView(0, 0);
+    EXPECT_FALSE(view->contains(TupleRef(first, 2)));
+    EXPECT_TRUE(view->contains(TupleRef(second, 2)));
+}
+
+TEST(Relation3, Choice) {
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(3);
+    InterpreterChoiceRelation rel(3, 0, "test", {"i", "i", "i"}, order, {0, 2});
+
+    // a tuple of a known key is rejected
+    RamDomain first[3] = {1, 2, 3};
+    RamDomain second[3] = {1, 4, 3};
+    RamDomain third[3] = {1, 2, 4};
+    EXPECT_TRUE(rel.insert(TupleRef(first, 3)));
+    EXPECT_FALSE(rel.insert(TupleRef(second, 3)));
+    EXPECT_TRUE(rel.insert(TupleRef(third, 3)));
+    EXPECT_FALSE(rel.insert(TupleRef(first, 3)));
+    EXPECT_EQ(2, rel.size());
+    EXPECT_FALSE(rel.contains(TupleRef(second, 3)));
+
+    // bulk insertions keep the first tuple of each key
+    std::vector<RamDomain> tuples{2, 1, 1, 2, 0, 1, 1, 5, 3, 3, 1, 1};
+    rel.insertBulk(tuples.data(), 4, 3);
+    EXPECT_EQ(4, rel.size());
+    RamDomain kept[3] = {2, 1, 1};
+    EXPECT_TRUE(rel.contains(TupleRef(kept, 3)));
+
+    // purging the relation forgets the keys
+    rel.purge();
+    EXPECT_TRUE(rel.insert(TupleRef(second, 3)));
+    EXPECT_EQ(1, rel.size());
+}
+
+TEST(Relation2, InsertBatch) {
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "test", {"i", "s"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", {"i", "s"}, {"a", "b"}, 0);
+
+    // insert row by row
+    std::vector<RamDomain> rows{1, symbolTable.lookup("x"), 2, symbolTable.lookup("y"), 1,
+            symbolTable.lookup("x")};
+    relInt.insertBatch(rows.data(), 3);
+    EXPECT_EQ(2, relInt.size());
+
+    // insert column by column
+    std::vector<RamDomain> first{3, 2};
+    std::vector<RamDomain> second{symbolTable.lookup("z"), symbolTable.lookup("y")};
+    const RamDomain* columns[] = {first.data(), second.data()};
+    relInt.insertBatchColumns(columns, 2);
+    EXPECT_EQ(3, relInt.size());
+    EXPECT_TRUE(relInt.contains(tuple(&relInt, {3, symbolTable.lookup("z")})));
+}
+
+TEST(Relation2, ScanBatches) {
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", {"i", "i"}, {"a", "b"}, 0);
+
+    const RamDomain N = 2500;
+    for (RamDomain i = 0; i < N; ++i) {
+        relInt.insert(tuple(&relInt, {i, 2 * i}));
+    }
+
+    // tuples are handed out in order, in full batches except for the last one
+    std::vector<std::size_t> batches;
+    RamDomain next = 0;
+    bool ordered = true;
+    relInt.scanBatches(
+            [&](const RamDomain* data, std::size_t numTuples) {
+                batches.push_back(numTuples);
+                for (std::size_t i = 0; i < numTuples; ++i) {
+                    ordered = ordered && data[2 * i] == next && data[2 * i + 1] == 2 * next;
+                    ++next;
+                }
+            },
+            1000);
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(N, next);
+    EXPECT_EQ(3, batches.size());
+    EXPECT_EQ(500, batches.back());
+}
+
+TEST(Relation2, EqualRange) {
+    // index the relation by its second attribute
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.addSearch(2);
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", {"i", "i"}, {"a", "b"}, 0);
+
+    const RamDomain N = 100;
+    for (RamDomain i = 0; i < N; ++i) {
+        relInt.insert(tuple(&relInt, {i, i % 10}));
+    }
+
+    auto lookup = [&](const std::vector<std::size_t>& columns, const std::vector<RamDomain>& values) {
+        std::vector<RamDomain> firsts;
+        relInt.equalRange(columns, values, [&](const tuple& t) { firsts.push_back(t[0]); });
+        return firsts;
+    };
+
+    // the indexed attribute is searched, the other one is checked
+    auto seconds = lookup({1}, {3});
+    EXPECT_EQ(10, seconds.size());
+    EXPECT_TRUE(std::all_of(seconds.begin(), seconds.end(), [](RamDomain a) { return a % 10 == 3; }));
+    EXPECT_EQ(std::vector<RamDomain>({42}), lookup({0}, {42}));
+    EXPECT_EQ(std::vector<RamDomain>({42}), lookup({1, 0}, {2, 42}));
+    EXPECT_TRUE(lookup({1, 0}, {3, 42}).empty());
+    EXPECT_TRUE(lookup({1, 1}, {2, 3}).empty());
+    EXPECT_EQ(N, lookup({}, {}).size());
+}
+
+TEST(Relation2, OrderedIndex) {
+    // index the relation by its second attribute, then its first
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.addSearch(3);
+    order.addOrder({1, 0});
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", {"i", "i"}, {"a", "b"}, 0);
+
+    const RamDomain N = 100;
+    for (RamDomain i = 0; i < N; ++i) {
+        relInt.insert(tuple(&relInt, {N - i, i % 10 - 5}));
+    }
+
+    // the index starting with the second attribute iterates the tuples in its order
+    const int indexPos = rel.getOrderedIndex({1, 0});
+    EXPECT_NE(-1, indexPos);
+    EXPECT_EQ(-1, rel.getOrderedIndex({0, 1, 2}));
+    std::vector<std::pair<RamDomain, RamDomain>> tuples;
+    for (const RamDomain* cur : rel.getIndexScan(indexPos)) {
+        tuples.emplace_back(cur[1], cur[0]);
+    }
+    EXPECT_EQ(N, tuples.size());
+    EXPECT_TRUE(std::is_sorted(tuples.begin(), tuples.end()));
+    EXPECT_EQ(-5, tuples.front().first);
+
+    // the partitions of the index are consecutive
+    std::vector<std::pair<RamDomain, RamDomain>> partitioned;
+    for (auto& stream : rel.getIndexScan(indexPos).partitionScan(4)) {
+        for (const auto& cur : stream) {
+            partitioned.emplace_back(cur[1], cur[0]);
+        }
+    }
+    EXPECT_TRUE(tuples == partitioned);
+}
+
+TEST(IndirectRelation, Wide) {
+    // index the relation by its last attribute as well, such that many entries tie on their prefixes
+    MinIndexSelection order{};
+    order.addSearch(1 << 4);
+    order.solve();
+    InterpreterIndirectRelation rel(5, 0, "test", {"i", "i", "i", "i", "i"}, order);
+
+    const RamDomain N = 1000;
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain tuple[5] = {0, i % 3, i, i % 7, i % 10};
+        EXPECT_TRUE(rel.insert(tuple));
+        EXPECT_FALSE(rel.insert(tuple));
+    }
+    EXPECT_EQ(N, rel.size());
+
+    // tuples tying on the prefixes are told apart by their remaining attributes
+    RamDomain tuple[5] = {0, 1, 4, 4, 4};
+    EXPECT_TRUE(rel.contains(TupleRef(tuple, 5)));
+    tuple[3] = 5;
+    EXPECT_FALSE(rel.contains(TupleRef(tuple, 5)));
+
+    // the tuples are scanned in the order of the index, by their last attribute first
+    std::vector<std::vector<RamDomain>> scanned;
+    for (const auto& cur : rel.scan()) {
+        scanned.push_back({cur[4], cur[0], cur[1], cur[2], cur[3]});
+    }
+    EXPECT_EQ(N, scanned.size());
+    EXPECT_TRUE(std::is_sorted(scanned.begin(), scanned.end()));
+
+    // the tuples with a given last attribute are searched in the order of their other attributes
+    RamDomain low[5] = {MIN_RAM_DOMAIN, MIN_RAM_DOMAIN, MIN_RAM_DOMAIN, MIN_RAM_DOMAIN, 3};
+    RamDomain high[5] = {MAX_RAM_DOMAIN, MAX_RAM_DOMAIN, MAX_RAM_DOMAIN, MAX_RAM_DOMAIN, 3};
+    std::vector<std::pair<RamDomain, RamDomain>> found;
+    for (const auto& cur : rel.range(order.getLexOrderNum(1 << 4), TupleRef(low, 5), TupleRef(high, 5))) {
+        EXPECT_EQ(3, cur[4]);
+        found.emplace_back(cur[1], cur[2]);
+    }
+    EXPECT_EQ(N / 10, found.size());
+    EXPECT_TRUE(std::is_sorted(found.begin(), found.end()));
+}
+
+TEST(DenseRelation, ReverseAdjacency) {
+    // a binary relation searched by either attribute, stored in an adjacency and a reverse adjacency
+    MinIndexSelection order{};
+    order.addSearch(1);
+    order.addSearch(2);
+    order.solve();
+    InterpreterRelation rel(2, 0, "test", {"s", "s"}, order, createDenseIndex);
+    EXPECT_EQ(2, order.getAllOrders().size());
+
+    const RamDomain N = 1000;
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain tuple[2] = {i % 10, i};
+        EXPECT_TRUE(rel.insert(tuple));
+        EXPECT_FALSE(rel.insert(tuple));
+    }
+    EXPECT_EQ(N, rel.size());
+
+    // the successors of a source are found in the adjacency, in ascending order
+    RamDomain low[2] = {3, MIN_RAM_DOMAIN};
+    RamDomain high[2] = {3, MAX_RAM_DOMAIN};
+    std::vector<RamDomain> targets;
+    for (const auto& cur : rel.range(order.getLexOrderNum(1), TupleRef(low, 2), TupleRef(high, 2))) {
+        EXPECT_EQ(3, cur[0]);
+        targets.push_back(cur[1]);
+    }
+    EXPECT_EQ(N / 10, targets.size());
+    EXPECT_TRUE(std::is_sorted(targets.begin(), targets.end()));
+
+    // the predecessor of a target is found in the reverse adjacency
+    RamDomain target[2] = {MIN_RAM_DOMAIN, 42};
+    RamDomain targetHigh[2] = {MAX_RAM_DOMAIN, 42};
+    std::vector<RamDomain> sources;
+    for (const auto& cur : rel.range(order.getLexOrderNum(2), TupleRef(target, 2), TupleRef(targetHigh, 2))) {
+        sources.push_back(cur[0]);
+    }
+    EXPECT_EQ(std::vector<RamDomain>({2}), sources);
+
+    // a seek of the reverse adjacency finds the least source of a target
+    RamDomain key[2] = {MIN_RAM_DOMAIN, 57};
+    RamDomain res[2];
+    EXPECT_TRUE(rel.getView(order.getLexOrderNum(2), 0)->seek(TupleRef(key, 2), 0, res));
+    EXPECT_EQ(7, res[0]);
+}
+
+TEST(BTreeIndex, Streams) {
+    const RamDomain N = 300;
+    for (const Order& order : {Order::create(2), Order({1, 0})}) {
+        auto index = createBTreeIndex(order);
+        EXPECT_EQ(order.isNatural(), order == Order::create(2));
+        for (RamDomain i = 0; i < N; ++i) {
+            RamDomain entry[2] = {i, N - i};
+            index->insert(TupleRef(entry, 2));
+        }
+
+        // elements are streamed in the order of the index, in relation order
+        Stream stream = index->scan();
+        std::vector<RamDomain> firsts;
+        auto it = stream.begin();
+        for (RamDomain i = 0; i < Stream::BUFFER_SIZE + 2; ++i, ++it) {
+            EXPECT_EQ(N, (*it)[0] + (*it)[1]);
+            firsts.push_back((*it)[0]);
+        }
+
+        // a clone continues at the same position
+        auto clone = stream.clone();
+        RamDomain remaining = 0;
+        auto other = clone->begin();
+        for (; it != stream.end(); ++it, ++other) {
+            EXPECT_TRUE((*it) == (*other));
+            firsts.push_back((*it)[0]);
+            ++remaining;
+        }
+        EXPECT_TRUE(other == clone->end());
+        EXPECT_EQ(N - Stream::BUFFER_SIZE - 2, remaining);
+
+        bool ordered = true;
+        for (RamDomain i = 0; i < N; ++i) {
+            ordered = ordered && firsts[i] == (order.isNatural() ? i : N - 1 - i);
+        }
+        EXPECT_TRUE(ordered);
+    }
+}
+
+TEST(Stream, Refills) {
+    // a source of count elements, recording the number of chunks requested from it
+    class CountingSource : public Stream::Source {
+        const std::vector<RamDomain>& elements;
+        std::size_t next = 0;
+        int& loads;
+
+    public:
+        CountingSource(const std::vector<RamDomain>& elements, int& loads)
+                : elements(elements), loads(loads) {}
+
+        int load(TupleRef* out, int max) override {
+            ++loads;
+            int c = 0;
+            while (next < elements.size() && c < max) {
+                out[c++] = TupleRef(&elements[next++], 1);
+            }
+            return c;
+        }
+
+        int reload(TupleRef*, int) override {
+            return 0;
+        }
+
+        std::unique_ptr<Stream::Source> clone() override {
+            return nullptr;
+        }
+    };
+
+    const int chunk = Stream::BUFFER_SIZE;
+    for (int count : {0, 5, chunk - 1, chunk, 3 * chunk + 1}) {
+        std::vector<RamDomain> elements(count);
+        std::iota(elements.begin(), elements.end(), 0);
+        int loads = 0;
+        Stream stream(std::make_unique<CountingSource>(elements, loads));
+        int seen = 0;
+        for (const TupleRef& cur : stream) {
+            EXPECT_EQ(seen, cur[0]);
+            ++seen;
+        }
+        EXPECT_EQ(count, seen);
+
+        // a short chunk is the last one, only full chunks are followed by another refill
+        EXPECT_EQ(count / chunk + 1, loads);
+    }
+}
+
 }  // end namespace test
@@ -0,0 +1,144 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file key_index_test.cpp
+ *
+ * A test case testing the secondary indexes storing keys and references.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "KeyIndex.h"
+#include "Table.h"
+#include "test.h"
+#include <random>
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Tuple = ram::Tuple<RamDomain, 6>;
+using Index = KeyIndex<Tuple, 2, 0>;
+using Reference = btree_multiset<Tuple, ram::index_utils::comparator<2, 0, 1, 3, 4, 5>>;
+
+TEST(KeyIndex, Basic) {
+    Table<Tuple> table;
+    Index index;
+    Index::operation_hints hints;
+    EXPECT_TRUE(index.empty());
+    EXPECT_TRUE(index.begin() == index.end());
+
+    EXPECT_TRUE(index.insert(table.insert(Tuple{{1, 2, 3, 4, 5, 6}}), hints));
+    EXPECT_TRUE(index.insert(table.insert(Tuple{{1, 0, 3, 0, 0, 0}}), hints));
+    EXPECT_TRUE(index.insert(table.insert(Tuple{{MIN_RAM_DOMAIN, 0, MAX_RAM_DOMAIN, 0, 0, 0}}), hints));
+    EXPECT_TRUE(index.insert(table.insert(Tuple{{2, 0, 3, 0, 0, 0}}), hints));
+    EXPECT_EQ(4, index.size());
+
+    // the tuples of a key are located by bounds padding all other columns
+    Tuple low{{1, MIN_RAM_DOMAIN, 3, MIN_RAM_DOMAIN, MIN_RAM_DOMAIN, MIN_RAM_DOMAIN}};
+    Tuple high{{1, MAX_RAM_DOMAIN, 3, MAX_RAM_DOMAIN, MAX_RAM_DOMAIN, MAX_RAM_DOMAIN}};
+    std::set<Tuple> found(index.lower_bound(low, hints), index.upper_bound(high, hints));
+    EXPECT_EQ((std::set<Tuple>{{{1, 2, 3, 4, 5, 6}}, {{1, 0, 3, 0, 0, 0}}}), found);
+    EXPECT_EQ(3, (*index.lower_bound(low, hints))[2]);
+
+    // so are the tuples of a prefix of the key
+    low[0] = MIN_RAM_DOMAIN;
+    high[0] = MAX_RAM_DOMAIN;
+    EXPECT_EQ(3, std::distance(index.lower_bound(low, hints), index.upper_bound(high, hints)));
+
+    // the tuples are scanned in the order of their keys
+    std::vector<Tuple> tuples(index.begin(), index.end());
+    EXPECT_EQ(4, tuples.size());
+    EXPECT_EQ((Tuple{{2, 0, 3, 0, 0, 0}}), tuples[2]);
+    EXPECT_EQ((Tuple{{MIN_RAM_DOMAIN, 0, MAX_RAM_DOMAIN, 0, 0, 0}}), tuples[3]);
+
+    index.clear();
+    EXPECT_TRUE(index.empty());
+}
+
+TEST(KeyIndex, InsertBulk) {
+    // scans and searches agree with a b-tree of complete tuples ordered by the key first
+    Table<Tuple> table;
+    Reference reference;
+    std::vector<const Tuple*> refs;
+    std::mt19937 gen(3);
+    for (int i = 0; i < 20000; i++) {
+        Tuple tuple{{static_cast<RamDomain>(gen() % 30) - 15, static_cast<RamDomain>(gen()),
+                static_cast<RamDomain>(gen() % 40), i, 0, static_cast<RamDomain>(gen())}};
+        reference.insert(tuple);
+        refs.push_back(&table.insert(tuple));
+    }
+
+    Index index;
+    index.insertBulk(std::vector<const Tuple*>(refs.begin(), refs.begin() + 10000));
+    Index::operation_hints hints;
+    for (auto it = refs.begin() + 10000; it != refs.end(); ++it) {
+        EXPECT_TRUE(index.insert(**it, hints));
+    }
+    EXPECT_EQ(reference.size(), index.size());
+
+    auto keyOf = [](const Tuple& t) { return std::make_pair(t[2], t[0]); };
+    std::vector<std::pair<RamDomain, RamDomain>> keys;
+    std::multiset<Tuple> scanned;
+    for (const auto& tuple : index) {
+        keys.push_back(keyOf(tuple));
+        scanned.insert(tuple);
+    }
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    EXPECT_EQ(std::multiset<Tuple>(reference.begin(), reference.end()), scanned);
+
+    Reference::operation_hints referenceHints;
+    for (int i = 0; i < 200; i++) {
+        Tuple low{{static_cast<RamDomain>(gen() % 34) - 17, MIN_RAM_DOMAIN,
+                static_cast<RamDomain>(gen() % 44), MIN_RAM_DOMAIN, MIN_RAM_DOMAIN, MIN_RAM_DOMAIN}};
+        Tuple high{{low[0], MAX_RAM_DOMAIN, low[2], MAX_RAM_DOMAIN, MAX_RAM_DOMAIN, MAX_RAM_DOMAIN}};
+        std::multiset<Tuple> found(index.lower_bound(low, hints), index.upper_bound(high, hints));
+        std::multiset<Tuple> expected(
+                reference.lower_bound(low, referenceHints), reference.upper_bound(high, referenceHints));
+        EXPECT_EQ(expected, found);
+    }
+
+    // chunks and compaction retain the tuples
+    std::size_t count = 0;
+    for (const auto& chunk : index.getChunks(7)) {
+        count += std::distance(chunk.begin(), chunk.end());
+    }
+    EXPECT_EQ(reference.size(), count);
+    index.compact();
+    EXPECT_EQ(reference.size(), static_cast<std::size_t>(std::distance(index.begin(), index.end())));
+
+    // entries of a short key with a reference take less memory than complete tuples
+    EXPECT_LT(index.getMemoryUsage(), reference.getMemoryUsage());
+}
+
+TEST(KeyIndex, ParallelInsert) {
+    const int N = 10000;
+    Table<Tuple> table;
+    std::vector<const Tuple*> refs;
+    for (int i = 0; i < N; i++) {
+        refs.push_back(&table.insert(Tuple{{i % 10, i, i % 97, 0, 0, 0}}));
+    }
+
+    Index index;
+#pragma omp parallel for
+    for (int i = 0; i < N; i++) {
+        index.insert(*refs[(i * 7919) % N]);
+    }
+
+    EXPECT_EQ(N, index.size());
+    std::set<Tuple> visited(index.begin(), index.end());
+    EXPECT_EQ(N, visited.size());
+}
+
+}  // namespace test
+}  // namespace souffle
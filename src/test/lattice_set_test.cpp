@@ -0,0 +1,141 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file lattice_set_test.cpp
+ *
+ * A test case testing the lattice set implementation.
+ *
+ ***********************************************************************/
+
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "LatticeSet.h"
+#include "test.h"
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 3>;
+using Set = LatticeSet<Entry>;
+
+TEST(LatticeSet, Basic) {
+    Set set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert(Entry{{1, 2, 10}}));
+    EXPECT_TRUE(set.insert(Entry{{2, 1, 10}}));
+    EXPECT_EQ(2, set.size());
+
+    // equal and greater values are subsumed
+    EXPECT_FALSE(set.insert(Entry{{1, 2, 10}}));
+    EXPECT_FALSE(set.insert(Entry{{1, 2, 11}}));
+    EXPECT_TRUE(set.subsumes(Entry{{1, 2, 12}}));
+    EXPECT_FALSE(set.subsumes(Entry{{1, 2, 9}}));
+    EXPECT_FALSE(set.subsumes(Entry{{1, 3, 12}}));
+
+    // a lesser value replaces the present tuple of its key
+    EXPECT_TRUE(set.insert(Entry{{1, 2, -5}}));
+    EXPECT_EQ(2, set.size());
+    EXPECT_TRUE(set.contains(Entry{{1, 2, -5}}));
+    EXPECT_FALSE(set.contains(Entry{{1, 2, 10}}));
+    EXPECT_TRUE(std::vector<Entry>({Entry{{1, 2, -5}}, Entry{{2, 1, 10}}}) ==
+                std::vector<Entry>(set.begin(), set.end()));
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.subsumes(Entry{{1, 2, 12}}));
+    EXPECT_TRUE(set.insert(Entry{{1, 2, 12}}));
+}
+
+TEST(LatticeSet, Max) {
+    // the value is held by the first column, ordered by the second column first
+    using Order = ram::index_utils::comparator<1, 0, 2>;
+    LatticeSet<Entry, Order> set(0, true);
+    EXPECT_TRUE(set.insert(Entry{{5, 1, 1}}));
+    EXPECT_TRUE(set.insert(Entry{{3, 2, 1}}));
+    EXPECT_FALSE(set.insert(Entry{{4, 1, 1}}));
+    EXPECT_TRUE(set.insert(Entry{{7, 1, 1}}));
+    EXPECT_TRUE(set.insert(Entry{{1, 1, 2}}));
+    EXPECT_TRUE(std::vector<Entry>({Entry{{1, 1, 2}}, Entry{{7, 1, 1}}, Entry{{3, 2, 1}}}) ==
+                std::vector<Entry>(set.begin(), set.end()));
+}
+
+TEST(LatticeSet, Random) {
+    // compare the dominant tuples of random insertions with a map of the least values
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<RamDomain> dist(-20, 20);
+    Set set;
+    std::map<std::pair<RamDomain, RamDomain>, RamDomain> expected;
+    for (int i = 0; i < 5000; ++i) {
+        Entry cur{{dist(generator), dist(generator), dist(generator) * 100}};
+        auto key = std::make_pair(cur[0], cur[1]);
+        auto pos = expected.find(key);
+        bool improves = pos == expected.end() || cur[2] < pos->second;
+        EXPECT_EQ(improves, set.insert(cur));
+        if (improves) {
+            expected[key] = cur[2];
+        }
+    }
+    std::vector<Entry> values;
+    for (const auto& cur : expected) {
+        values.push_back(Entry{{cur.first.first, cur.first.second, cur.second}});
+    }
+    EXPECT_EQ(values.size(), set.size());
+    EXPECT_TRUE(values == std::vector<Entry>(set.begin(), set.end()));
+
+    Set::operation_hints hints;
+    auto range = make_range(
+            set.lower_bound(Entry{{3, MIN_RAM_DOMAIN, MIN_RAM_DOMAIN}}, hints),
+            set.upper_bound(Entry{{3, MAX_RAM_DOMAIN, MAX_RAM_DOMAIN}}, hints));
+    std::size_t count = 0;
+    for (const auto& cur : range) {
+        EXPECT_EQ(3, cur[0]);
+        EXPECT_EQ(expected[std::make_pair(cur[0], cur[1])], cur[2]);
+        count++;
+    }
+    const auto first = expected.lower_bound(std::make_pair(3, MIN_RAM_DOMAIN));
+    const auto last = expected.lower_bound(std::make_pair(4, MIN_RAM_DOMAIN));
+    EXPECT_EQ(static_cast<std::size_t>(std::distance(first, last)), count);
+
+    std::size_t partitioned = 0;
+    for (const auto& chunk : set.partition(7)) {
+        for (const auto& cur : chunk) {
+            EXPECT_TRUE(set.contains(cur));
+            partitioned++;
+        }
+    }
+    EXPECT_EQ(set.size(), partitioned);
+}
+
+TEST(LatticeSet, Extend) {
+    Set old;
+    old.insert(Entry{{1, 1, 5}});
+    old.insert(Entry{{2, 2, 5}});
+
+    Set knowledge;
+    knowledge.insert(Entry{{1, 1, 5}});
+    knowledge.insert(Entry{{2, 2, 4}});
+    knowledge.insert(Entry{{3, 3, 9}});
+
+    // only the tuples improving on the old knowledge remain
+    knowledge.extend(old);
+    EXPECT_TRUE(std::vector<Entry>({Entry{{2, 2, 4}}, Entry{{3, 3, 9}}}) ==
+                std::vector<Entry>(knowledge.begin(), knowledge.end()));
+    EXPECT_TRUE(knowledge.insert(Entry{{1, 1, 6}}));
+}
+
+}  // namespace test
+}  // namespace souffle
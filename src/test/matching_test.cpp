@@ -95,3 +95,57 @@ TEST(Matching, StaticTest_2) {
 
     EXPECT_EQ(num, 5);
 }
+
+TEST(Matching, ReduceSearches) {
+    TestAutoIndex order;
+    order.addSearch(1);
+    order.addSearch(3);
+    order.addSearch(5);
+    order.addSearch(7);
+    order.solve();
+    EXPECT_EQ(order.getAllOrders().size(), 2);
+
+    // a relation of 1000 tuples with 10 distinct values per column
+    auto matches = [](SearchSignature search) {
+        double res = 1000;
+        for (size_t i = 0; i < 3; i++) {
+            if ((search & (SearchSignature(1) << i)) != 0) {
+                res /= 10;
+            }
+        }
+        return res;
+    };
+    const double indexCost = 1000 * log2(1001);
+
+    // the rare search on the first and last column is served by the index of the frequent search
+    auto prefixes = order.reduceSearches({{3, 1000000}, {5, 1}}, matches, indexCost);
+    EXPECT_EQ(prefixes.size(), 1);
+    EXPECT_EQ(prefixes[5], 1);
+
+    // the frequent search on the first and last column is worth an index of its own
+    prefixes = order.reduceSearches({{3, 1000000}, {5, 1000}}, matches, indexCost);
+    EXPECT_TRUE(prefixes.empty());
+
+    // unprofiled searches keep their index
+    prefixes = order.reduceSearches({{3, 1000000}}, matches, indexCost);
+    EXPECT_TRUE(prefixes.empty());
+}
+
+TEST(Matching, OutputOrder) {
+    TestAutoIndex order;
+    order.addSearch(2);
+    order.addOrder({2, 0});
+    order.solve();
+
+    // the prefixes of the output order form a chain of their own
+    EXPECT_EQ(order.getAllOrders().size(), 2);
+    const int num = order.getOrderNum({2, 0});
+    EXPECT_NE(num, -1);
+    EXPECT_EQ(order.getAllOrders()[num][0], 2);
+    EXPECT_EQ(order.getAllOrders()[num][1], 0);
+    EXPECT_EQ(order.getOutputOrders().size(), 1);
+
+    // no index starts with columns that were not added as an order
+    EXPECT_EQ(order.getOrderNum({0, 2}), -1);
+    EXPECT_EQ(order.getOrderNum({}), -1);
+}
@@ -0,0 +1,140 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file narrow_set_test.cpp
+ *
+ * A test case testing the narrow set implementation.
+ *
+ ***********************************************************************/
+
+#include "CompiledTuple.h"
+#include "NarrowSet.h"
+#include "test.h"
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 3>;
+
+// the first and the last column are narrow
+using Set = NarrowSet<Entry, 2 + sizeof(RamDomain) / sizeof(uint32_t)>;
+const std::vector<bool> narrow = {true, false, true};
+
+TEST(NarrowSet, Basic) {
+    Set set(narrow);
+    Set::operation_hints hints;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+    EXPECT_TRUE(set.lower_bound(Entry{{1, 2, 3}}, hints) == set.end());
+
+    EXPECT_TRUE(set.insert(Entry{{1, 2, 3}}));
+    EXPECT_TRUE(set.insert(Entry{{-1, MIN_RAM_DOMAIN, -3}}));
+    EXPECT_TRUE(set.insert(Entry{{1, MAX_RAM_DOMAIN, 3}}));
+    EXPECT_FALSE(set.insert(Entry{{1, 2, 3}}));
+
+    EXPECT_FALSE(set.empty());
+    EXPECT_EQ(3, set.size());
+    EXPECT_TRUE(set.contains(Entry{{1, 2, 3}}));
+    EXPECT_TRUE(set.contains(Entry{{-1, MIN_RAM_DOMAIN, -3}}));
+    EXPECT_TRUE(set.contains(Entry{{1, MAX_RAM_DOMAIN, 3}}));
+    EXPECT_FALSE(set.contains(Entry{{1, 2, 2}}));
+    EXPECT_FALSE(set.contains(Entry{{MAX_RAM_DOMAIN, 2, 3}}));
+
+    // the elements are widened in the order of their signed columns
+    std::vector<Entry> elements(set.begin(), set.end());
+    EXPECT_EQ(3, elements.size());
+    EXPECT_EQ((Entry{{-1, MIN_RAM_DOMAIN, -3}}), elements[0]);
+    EXPECT_EQ((Entry{{1, 2, 3}}), elements[1]);
+    EXPECT_EQ((Entry{{1, MAX_RAM_DOMAIN, 3}}), elements[2]);
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Entry{{1, 2, 3}}));
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(NarrowSet, BulkInsert) {
+    std::vector<Entry> data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(Entry{{(i * 7919) % 301 - 150, i % 13 == 0 ? MIN_RAM_DOMAIN : i * i, -i % 7}});
+    }
+    data.push_back(data.front());
+    std::set<Entry> expected(data.begin(), data.end());
+
+    Set set(narrow);
+    set.insertBulk(data);
+    EXPECT_EQ(expected.size(), set.size());
+    EXPECT_TRUE(std::vector<Entry>(expected.begin(), expected.end()) ==
+                std::vector<Entry>(set.begin(), set.end()));
+}
+
+TEST(NarrowSet, Bounds) {
+    std::set<Entry> expected;
+    Set set(narrow);
+    for (int i = -300; i < 300; i += 3) {
+        for (int j = 0; j < 5; j++) {
+            expected.insert(Entry{{i, i * j, j}});
+            set.insert(Entry{{i, i * j, j}});
+        }
+    }
+
+    // the keys of the searches may exceed the narrow columns
+    Set::operation_hints hints;
+    for (RamDomain i : std::vector<RamDomain>{MIN_RAM_DOMAIN, -301, -300, -1, 0, 1, 299, MAX_RAM_DOMAIN}) {
+        for (RamDomain j : std::vector<RamDomain>{MIN_RAM_DOMAIN, -1, 0, 1, 5, MAX_RAM_DOMAIN}) {
+            for (RamDomain k : std::vector<RamDomain>{MIN_RAM_DOMAIN, 0, 4, MAX_RAM_DOMAIN}) {
+                Entry key{{i, j, k}};
+                auto lower = set.lower_bound(key, hints);
+                auto upper = set.upper_bound(key, hints);
+                auto expectedLower = expected.lower_bound(key);
+                auto expectedUpper = expected.upper_bound(key);
+                EXPECT_EQ(expectedLower == expected.end(), lower == set.end());
+                EXPECT_EQ(expectedUpper == expected.end(), upper == set.end());
+                if (lower != set.end() && expectedLower != expected.end()) {
+                    EXPECT_EQ(*expectedLower, *lower);
+                }
+                if (upper != set.end() && expectedUpper != expected.end()) {
+                    EXPECT_EQ(*expectedUpper, *upper);
+                }
+                EXPECT_EQ(expected.count(key) > 0, set.contains(key, hints));
+            }
+        }
+    }
+}
+
+TEST(NarrowSet, Partition) {
+    Set set(narrow);
+    EXPECT_TRUE(set.partition(8).empty());
+
+    const int N = 10000;
+    for (int i = 0; i < N; i++) {
+        set.insert(Entry{{i, -i, i % 10}});
+    }
+
+    for (std::size_t num : {1, 7, 100}) {
+        std::size_t count = 0;
+        std::set<Entry> visited;
+        for (const auto& chunk : set.partition(num)) {
+            for (const auto& cur : chunk) {
+                visited.insert(cur);
+                count++;
+            }
+        }
+        EXPECT_EQ(N, count);
+        EXPECT_EQ(N, visited.size());
+    }
+}
+
+}  // namespace test
+}  // namespace souffle
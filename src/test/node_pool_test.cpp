@@ -0,0 +1,119 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file node_pool_test.cpp
+ *
+ * A test case testing the node pool allocator.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "NodePool.h"
+#include "test.h"
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+TEST(NodePool, SizeClasses) {
+    // pools are shared by block sizes of the same size class
+    EXPECT_EQ(&(NodePool::get<100, 8>()), &(NodePool::get<112, 8>()));
+    EXPECT_EQ(&(NodePool::get<1, 1>()), &(NodePool::get<16, 16>()));
+    EXPECT_NE(&(NodePool::get<100, 8>()), &(NodePool::get<113, 8>()));
+    EXPECT_NE(&(NodePool::get<100, 8>()), &(NodePool::get<100, 64>()));
+}
+
+TEST(NodePool, Reuse) {
+    NodePool& pool = NodePool::get<200, 8>();
+    const NodePoolStatistics before = NodePool::getStatistics();
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 1000; i++) {
+        blocks.push_back(pool.allocate());
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(blocks.back()) % 8);
+    }
+    EXPECT_EQ(1000, std::set<void*>(blocks.begin(), blocks.end()).size());
+
+    const NodePoolStatistics mid = NodePool::getStatistics();
+    EXPECT_EQ(before.inUse + 1000 * 208, mid.inUse);
+    EXPECT_LT(before.reserved, mid.reserved);
+
+    // released blocks are reused without reserving further memory
+    {
+        NodePool::Batch batch(pool);
+        for (void* cur : blocks) {
+            batch.add(cur);
+        }
+    }
+    EXPECT_EQ(before.inUse, NodePool::getStatistics().inUse);
+
+    std::set<void*> reused;
+    for (int i = 0; i < 1000; i++) {
+        reused.insert(pool.allocate());
+    }
+    EXPECT_TRUE(reused == std::set<void*>(blocks.begin(), blocks.end()));
+    EXPECT_EQ(mid.reserved, NodePool::getStatistics().reserved);
+
+    for (void* cur : reused) {
+        pool.deallocate(cur);
+    }
+    EXPECT_EQ(before.inUse, NodePool::getStatistics().inUse);
+}
+
+TEST(NodePool, ParallelBTree) {
+    using Set = btree_set<int>;
+    const NodePoolStatistics before = NodePool::getStatistics();
+
+    // trees filled and cleared concurrently return all their nodes
+    for (int round = 0; round < 3; round++) {
+        Set set;
+#pragma omp parallel for
+        for (int i = 0; i < 100000; i++) {
+            set.insert(i);
+        }
+        EXPECT_EQ(100000, set.size());
+        EXPECT_LT(before.inUse, NodePool::getStatistics().inUse);
+        set.clear();
+        EXPECT_EQ(before.inUse, NodePool::getStatistics().inUse);
+    }
+}
+
+TEST(NodePool, HugePages) {
+    NodePool& pool = NodePool::get<336, 8>();
+    const NodePoolStatistics before = NodePool::getStatistics();
+    NodePool::setHugePages(HugePages::Transparent);
+    void* block = pool.allocate();
+
+    // the new slab spans whole huge pages, advised as such if the system has transparent huge pages
+    const NodePoolStatistics after = NodePool::getStatistics();
+    EXPECT_EQ(0, (after.reserved - before.reserved) % (2 * 1024 * 1024));
+    EXPECT_TRUE(after.hugePages == before.hugePages || after.hugePages - before.hugePages == 2 * 1024 * 1024);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % (2 * 1024 * 1024));
+
+    // explicit huge pages fall back to transparent ones if none are reserved
+    NodePool::setHugePages(HugePages::Explicit2M);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10000; i++) {
+        blocks.push_back(pool.allocate());
+    }
+    EXPECT_EQ(0, (NodePool::getStatistics().reserved - before.reserved) % (2 * 1024 * 1024));
+
+    NodePool::setHugePages(HugePages::None);
+    pool.deallocate(block);
+    for (void* cur : blocks) {
+        pool.deallocate(cur);
+    }
+    EXPECT_EQ(before.inUse, NodePool::getStatistics().inUse);
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -17,6 +17,14 @@
 #include "ParallelUtils.h"
 #include "test.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
 namespace souffle {
 
 namespace test {
@@ -91,5 +99,253 @@ TEST(ParallelUtils, OptimisticReadWriteLock) {
 
     EXPECT_EQ(2 * (N / K), c);
 }
+
+TEST(ParallelUtils, ParallelSort) {
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    for (int N : {0, 1, 1000, 4099, 100000}) {
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back((i * 7919) % 1009);
+        }
+        std::vector<int> expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        parallelSort(data.begin(), data.end(), std::less<int>());
+        EXPECT_TRUE(data == expected);
+    }
+}
+
+TEST(ParallelUtils, ParallelSchedule) {
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    // two independent chains joined by a final task
+    const std::vector<std::vector<std::size_t>> dependencies{{}, {}, {0}, {1}, {0}, {2, 3, 4}};
+    std::atomic<std::size_t> clock(0);
+    std::vector<std::size_t> started(dependencies.size());
+    std::vector<std::size_t> finished(dependencies.size());
+    std::vector<int> runs(dependencies.size(), 0);
+
+    parallelSchedule(dependencies, 0, [&](std::size_t task) {
+        started[task] = ++clock;
+        runs[task]++;
+        finished[task] = ++clock;
+    });
+
+    for (std::size_t task = 0; task < dependencies.size(); task++) {
+        EXPECT_EQ(1, runs[task]);
+        for (std::size_t dep : dependencies[task]) {
+            EXPECT_LT(finished[dep], started[task]);
+        }
+    }
+}
+
+TEST(ParallelUtils, WorkStealingLoop) {
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    for (std::size_t N : {0, 1, 3, 1000}) {
+        std::vector<std::size_t> chunks(N);
+        std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[N]);
+        for (std::size_t i = 0; i < N; i++) {
+            chunks[i] = i;
+            visits[i] = 0;
+        }
+
+        // the first chunks are expensive, such that the other threads have to steal them
+        WorkStealingLoop loop(chunks.size());
+        PARALLEL_START
+            pfor_steal(it, chunks, loop) {
+                volatile std::size_t sink = 0;
+                for (std::size_t i = 0; i < (*it < 10 ? 100000 : 10); i++) {
+                    sink = sink + i;
+                }
+                visits[*it]++;
+            }
+        PARALLEL_END;
+
+        for (std::size_t i = 0; i < N; i++) {
+            EXPECT_EQ(1, visits[i]);
+        }
+    }
+}
+
+TEST(ParallelUtils, WorkStealingLoopStatistics) {
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    std::vector<std::size_t> chunks(100);
+    for (std::size_t i = 0; i < chunks.size(); i++) {
+        chunks[i] = i;
+    }
+
+    // loops are only profiled if requested
+    WorkStealingLoop unprofiled(chunks.size());
+    EXPECT_EQ(0, unprofiled.getStatistics().executions);
+
+    WorkStealingLoop loop(chunks.size(), true);
+    PARALLEL_START
+        pfor_steal(it, chunks, loop) {
+            volatile std::size_t sink = 0;
+            for (std::size_t i = 0; i < (*it == 0 ? 1000000 : 10); i++) {
+                sink = sink + i;
+            }
+        }
+    PARALLEL_END;
+
+    const ParallelLoopStatistics statistics = loop.getStatistics();
+    EXPECT_EQ(1, statistics.executions);
+    EXPECT_EQ(chunks.size(), statistics.chunks);
+    EXPECT_TRUE(statistics.chunks <= statistics.maxChunks * statistics.threads);
+    EXPECT_TRUE(statistics.threads >= 1);
+    EXPECT_TRUE(statistics.threads <= std::size_t(MAX_THREADS));
+    EXPECT_EQ(statistics.threads > 1 ? 1 : 0, statistics.forked);
+    // the threads idle for the thread taking the expensive chunk
+    EXPECT_TRUE(statistics.critical <= statistics.busy);
+    EXPECT_EQ(statistics.critical * statistics.threads, statistics.busy + statistics.idle);
+
+    ParallelLoopStatistics total;
+    total += statistics;
+    total += statistics;
+    EXPECT_EQ(2, total.executions);
+    EXPECT_EQ(2 * statistics.idle, total.idle);
+}
+
+TEST(ParallelUtils, ParallelChunkCount) {
+    // small loops are not split up
+    EXPECT_EQ(1, parallelChunkCount(0, 64));
+    EXPECT_EQ(1, parallelChunkCount(MIN_CHUNK_TUPLES - 1, 64));
+    EXPECT_EQ(1, parallelChunkCount(2 * MIN_CHUNK_TUPLES - 1, 64));
+
+    // medium loops are split into chunks of at least MIN_CHUNK_TUPLES tuples
+    EXPECT_EQ(2, parallelChunkCount(2 * MIN_CHUNK_TUPLES, 64));
+    EXPECT_EQ(10, parallelChunkCount(10 * MIN_CHUNK_TUPLES + 1, 64));
+
+    // large loops are split into the maximal number of chunks
+    EXPECT_EQ(64, parallelChunkCount(1000 * MIN_CHUNK_TUPLES, 64));
+    EXPECT_EQ(MAX_CHUNKS_PER_THREAD * MAX_THREADS, parallelChunkCount(1000000 * MIN_CHUNK_TUPLES));
+}
+
+TEST(ParallelUtils, BlockCounter) {
+    // a single thread obtains dense values
+    BlockCounter<int> counter;
+    for (int i = 0; i < 10000; i++) {
+        EXPECT_EQ(i, counter++);
+    }
+
+    // a new counter starts from zero again, without reusing values of the first one
+    BlockCounter<int> other;
+    EXPECT_EQ(0, other++);
+    EXPECT_TRUE(counter++ >= 10000);
+
+    // concurrent threads obtain unique values
+    const int N = 100000;
+    std::vector<int> values(N);
+#pragma omp parallel for num_threads(4)
+    for (int i = 0; i < N; i++) {
+        values[i] = other++;
+    }
+    std::sort(values.begin(), values.end());
+    EXPECT_TRUE(std::adjacent_find(values.begin(), values.end()) == values.end());
+    EXPECT_TRUE(values.front() > 0);
+}
+
+TEST(ParallelUtils, TaskPool) {
+    TaskPool& pool = TaskPool::instance();
+    EXPECT_TRUE(pool.getCapacity() >= 1);
+
+    // tasks return their results
+    std::vector<TaskPool::Task<int>> tasks;
+    for (int i = 0; i < 100; i++) {
+        tasks.push_back(pool.submit([i]() { return i * i; }));
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(i * i, tasks[i].get());
+    }
+
+    // tasks may wait for the tasks they submit, also if they occupy all workers
+    std::vector<TaskPool::Task<int>> outer;
+    for (std::size_t i = 0; i < 2 * pool.getCapacity(); i++) {
+        outer.push_back(pool.submit([&pool]() { return pool.submit([]() { return 1; }).get() + 1; }));
+    }
+    for (auto& task : outer) {
+        EXPECT_EQ(2, task.get());
+    }
+
+    // delayed tasks are run once their delay has passed
+    const auto start = TaskPool::Clock::now();
+    pool.submitAfter(std::chrono::milliseconds(20), []() {}).wait();
+    EXPECT_TRUE(TaskPool::Clock::now() - start >= std::chrono::milliseconds(20));
+}
+
+TEST(ParallelUtils, PeriodicTask) {
+    std::atomic<int> steps{0};
+    PeriodicTask task([&]() { return ++steps < 5; }, std::chrono::milliseconds(1));
+    task.start();
+    while (steps < 5) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(5, steps);
+
+    // a stopped task does not run any further steps
+    std::atomic<int> others{0};
+    PeriodicTask other([&]() { return ++others > 0; }, std::chrono::milliseconds(1));
+    other.start();
+    while (others < 3) {
+        std::this_thread::yield();
+    }
+    other.stop();
+    const int stopped = others;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(stopped, others);
+}
+
+TEST(ParallelUtils, InsertByRanges) {
+    // the threads insert the sorted, overlapping buffers of all threads, each value once by one thread
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    const int n = 10000;
+    std::vector<std::vector<int>> inserted(MAX_THREADS);
+    std::atomic<bool> ranges{false};
+#pragma omp parallel
+    {
+#ifdef _OPENMP
+        const int self = omp_get_thread_num();
+#else
+        const int self = 0;
+#endif
+        std::vector<int> buffer;
+        for (int i = 0; i < n; ++i) {
+            buffer.push_back((i * 7919 + self * 13) % n);
+        }
+        std::sort(buffer.begin(), buffer.end());
+        buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+        auto& own = inserted[self];
+        if (insertByRanges(buffer, std::less<>(), [&](int value) { own.push_back(value); })) {
+            ranges = true;
+        } else {
+            own = buffer;
+        }
+    }
+    EXPECT_EQ(MAX_THREADS > 1, ranges.load());
+
+    // each value is inserted by a single thread, and the threads insert ascending ranges of values
+    size_t values = 0;
+    int last = -1;
+    for (auto& cur : inserted) {
+        std::sort(cur.begin(), cur.end());
+        cur.erase(std::unique(cur.begin(), cur.end()), cur.end());
+        values += cur.size();
+        if (!cur.empty()) {
+            EXPECT_LT(last, cur.front());
+            last = cur.back();
+        }
+    }
+    EXPECT_EQ(size_t(n), values);
+}
 }  // namespace test
 }  // end namespace souffle
@@ -14,10 +14,17 @@
  *
  ***********************************************************************/
 
+#include "ProfileEvent.h"
+#include "SignalHandler.h"
+#include "profile/LiveEndpoint.h"
 #include "profile/StringUtils.h"
 #include "test.h"
 
+#include <cstdio>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 using namespace souffle;
@@ -134,3 +141,210 @@ TEST(StringUtil, cleanJsonOutDouble) {
     EXPECT_EQ("NaN", Tools::cleanJsonOut(NAN));
     EXPECT_EQ("1.234567e+02", Tools::cleanJsonOut(123.4567));
 }
+
+TEST(ProfileEventLog, FoldWhileRecording) {
+    const size_t threads = 4;
+    // more events than fit into the buffer of a log
+    const size_t events = 20000;
+    ProfileDatabase db;
+    std::vector<ProfileEventLog> logs(threads);
+    std::atomic<bool> done{false};
+
+    // fold the logs concurrently with recording, as the profile timer does
+    std::thread folder([&]() {
+        while (!done) {
+            for (auto& log : logs) {
+                log.fold(db);
+            }
+        }
+    });
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < threads; ++t) {
+        producers.emplace_back([&, t]() {
+            for (size_t i = 0; i < events; ++i) {
+                const std::string txt =
+                        "@n-nonrecursive-relation;R" + std::to_string(t) + "_" + std::to_string(i) + ";loc";
+                logs[t].append(EventKind::Quantity, txt, {i, 0}, db);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    done = true;
+    folder.join();
+    for (auto& log : logs) {
+        log.fold(db);
+    }
+
+    for (size_t t = 0; t < threads; ++t) {
+        for (size_t i = 0; i < events; ++i) {
+            const std::string relation = "R" + std::to_string(t) + "_" + std::to_string(i);
+            auto* entry =
+                    dynamic_cast<SizeEntry*>(db.lookupEntry({"program", "relation", relation, "num-tuples"}));
+            ASSERT_TRUE(entry != nullptr);
+            EXPECT_EQ(entry->getSize(), i);
+        }
+    }
+}
+
+TEST(ProfileStream, LoadRelations) {
+    const std::string filename = "profile_stream_test.bin";
+    const uint64_t start[6] = {1, 2, 3, 4, 5, 6};
+    const uint64_t size[6] = {7, 0};
+    {
+        ProfileStreamWriter writer(filename);
+        ASSERT_TRUE(writer.isOpen());
+        writer.writeConfig("jobs", "4");
+        writer.write(EventKind::Timing, "@t-nonrecursive-relation;A;a.dl [1:1-1:10]", start);
+        writer.write(EventKind::Quantity, "@n-nonrecursive-relation;B;b.dl [2:1-2:10]", size);
+        writer.write(EventKind::Time, "@time;starttime", start);
+    }
+    ASSERT_TRUE(ProfileStreamReader::isStream(filename));
+
+    auto hasRelation = [](ProfileDatabase& db, const std::string& relation) {
+        return db.lookupEntry({"program", "relation", relation}) != nullptr;
+    };
+    ProfileDatabase all;
+    ProfileStreamReader::load(filename, all);
+    EXPECT_TRUE(hasRelation(all, "A"));
+    EXPECT_TRUE(hasRelation(all, "B"));
+    auto* runtime = dynamic_cast<DurationEntry*>(all.lookupEntry({"program", "relation", "A", "runtime"}));
+    ASSERT_TRUE(runtime != nullptr);
+    EXPECT_EQ(runtime->getStart().count(), 1);
+    EXPECT_EQ(runtime->getEnd().count(), 2);
+
+    ProfileDatabase selected;
+    ProfileStreamReader::load(filename, selected, {"B"});
+    EXPECT_FALSE(hasRelation(selected, "A"));
+    EXPECT_TRUE(hasRelation(selected, "B"));
+    // events on the whole program are always loaded
+    EXPECT_TRUE(selected.lookupEntry({"program", "starttime"}) != nullptr);
+    auto* jobs = dynamic_cast<TextEntry*>(selected.lookupEntry({"program", "configuration", "jobs"}));
+    ASSERT_TRUE(jobs != nullptr);
+    EXPECT_EQ(jobs->getText(), "4");
+
+    std::remove(filename.c_str());
+}
+
+TEST(HardwareCounters, ProcessEvents) {
+    ProfileDatabase db;
+    const uint64_t rule[6] = {100, 10, 1, 2};
+    const uint64_t relation[6] = {200, 20, 2, 0};
+    processEvent(db, EventKind::Counters, "@h-recursive-rule;A;0;a.dl [1:1-1:10];A(x) :- B(x).", rule);
+    processEvent(db, EventKind::Counters, "@h-nonrecursive-relation;B;b.dl [2:1-2:10]", relation);
+
+    auto getCount = [&](std::vector<std::string> path, const std::string& counter) -> size_t {
+        path.push_back("counters");
+        path.push_back(counter);
+        auto* count = dynamic_cast<SizeEntry*>(db.lookupEntry(path));
+        return count == nullptr ? 0 : count->getSize();
+    };
+    const std::vector<std::string> rulePath = {
+            "program", "relation", "A", "iteration", "2", "recursive-rule", "A(x) :- B(x).", "0"};
+    EXPECT_EQ(getCount(rulePath, "instructions"), 100);
+    EXPECT_EQ(getCount(rulePath, "cache-misses"), 10);
+    EXPECT_EQ(getCount(rulePath, "branch-misses"), 1);
+    EXPECT_EQ(getCount({"program", "relation", "B"}, "instructions"), 200);
+}
+
+TEST(MemoryUsage, ProcessEvents) {
+    ProfileDatabase db;
+    const uint64_t time[6] = {1000};
+    const uint64_t main[6] = {4096};
+    const uint64_t secondary[6] = {1024};
+    const uint64_t symbols[6] = {512};
+    processEvent(db, EventKind::Quantity, "@relation-memory;A;3;0", main);
+    processEvent(db, EventKind::Quantity, "@relation-memory;A;3;1", secondary);
+    processEvent(db, EventKind::Time, "@memory;3;time", time);
+    processEvent(db, EventKind::Quantity, "@memory;3;symbol-table", symbols);
+
+    auto getSize = [&](const std::vector<std::string>& path) -> size_t {
+        auto* size = dynamic_cast<SizeEntry*>(db.lookupEntry(path));
+        return size == nullptr ? 0 : size->getSize();
+    };
+    EXPECT_EQ(getSize({"program", "memory", "3", "relation", "A", "0"}), 4096);
+    EXPECT_EQ(getSize({"program", "memory", "3", "relation", "A", "1"}), 1024);
+    EXPECT_EQ(getSize({"program", "memory", "3", "symbol-table"}), 512);
+    auto* entry = dynamic_cast<TimeEntry*>(db.lookupEntry({"program", "memory", "3", "time"}));
+    ASSERT_TRUE(entry != nullptr);
+    EXPECT_EQ(entry->getTime().count(), 1000);
+
+    // memory events are on the whole program, except for the memory of relations
+    EXPECT_EQ(getEventRelation("@memory;3;time"), "");
+    EXPECT_EQ(getEventRelation("@relation-memory;A;3;0"), "A");
+}
+
+TEST(SearchStatistics, ProcessEvents) {
+    ProfileDatabase db;
+    const uint64_t tuples[6] = {120};
+    const uint64_t hits[6] = {75};
+    const uint64_t misses[6] = {25};
+    processEvent(db, EventKind::Quantity, "@relation-search-tuples;A;3", tuples);
+    processEvent(db, EventKind::Quantity, "@relation-hints;A;0;insert;hits", hits);
+    processEvent(db, EventKind::Quantity, "@relation-hints;A;0;insert;misses", misses);
+
+    auto getSize = [&](const std::vector<std::string>& path) -> size_t {
+        auto* size = dynamic_cast<SizeEntry*>(db.lookupEntry(path));
+        return size == nullptr ? 0 : size->getSize();
+    };
+    EXPECT_EQ(getSize({"program", "search-tuples", "A", "3"}), 120);
+    EXPECT_EQ(getSize({"program", "hints", "A", "0", "insert", "hits"}), 75);
+    EXPECT_EQ(getSize({"program", "hints", "A", "0", "insert", "misses"}), 25);
+
+    EXPECT_EQ(getEventRelation("@relation-search-tuples;A;3"), "A");
+    EXPECT_EQ(getEventRelation("@relation-hints;A;0;insert;hits"), "A");
+}
+
+TEST(LiveEndpoint, WriteMetrics) {
+    ProgramRun run;
+    run.setStarttime(std::chrono::microseconds(1000000));
+    run.setEndtime(std::chrono::microseconds(3000000));
+    auto relation = std::make_shared<Relation>("A", "R1");
+    relation->setStarttime(std::chrono::microseconds(1000000));
+    relation->setEndtime(std::chrono::microseconds(2000000));
+    relation->setNumTuples(500);
+    std::unordered_map<std::string, std::shared_ptr<Relation>> relations = {{"A", relation}};
+    run.setRelationMap(relations);
+    LiveEndpoint::Usage usage;
+    usage.maxRSS = 4096;
+
+    std::stringstream metrics;
+    LiveEndpoint::writeMetrics(metrics, run, true, usage);
+    EXPECT_TRUE(metrics.str().find("souffle_running 1\n") != std::string::npos);
+    EXPECT_TRUE(metrics.str().find("souffle_runtime_seconds 2\n") != std::string::npos);
+    EXPECT_TRUE(metrics.str().find("souffle_max_rss_bytes 4096\n") != std::string::npos);
+    EXPECT_TRUE(metrics.str().find("souffle_relation_tuples{relation=\"A\"} 500\n") != std::string::npos);
+    EXPECT_TRUE(metrics.str().find("souffle_relation_tuples_per_second{relation=\"A\"} 500\n") !=
+                std::string::npos);
+
+    std::stringstream json;
+    LiveEndpoint::writeJson(json, run, false, usage);
+    EXPECT_TRUE(json.str().find(R"_("running": false)_") != std::string::npos);
+    EXPECT_TRUE(json.str().find(R"_("A": {"tuples": 500, "iterations": 0)_") != std::string::npos);
+}
+
+TEST(Samples, AttributeCpuTime) {
+    static const char* rule = "A(x) :- B(x).\nin file test.dl [1:1-1:14]";
+    SignalHandler::instance()->startSampling();
+    SignalHandler::instance()->setMsg(rule);
+    // burn CPU time until samples were taken
+    volatile size_t sink = 0;
+    const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < end) {
+        for (size_t i = 0; i < 100000; ++i) {
+            sink += i;
+        }
+    }
+    SignalHandler::instance()->clearMsg();
+    auto samples = SignalHandler::instance()->stopSampling();
+    EXPECT_TRUE(samples[rule] > 0);
+
+    ProfileDatabase db;
+    const uint64_t count[6] = {42};
+    processEvent(db, EventKind::Quantity, "@samples;other", count);
+    auto* entry = dynamic_cast<SizeEntry*>(db.lookupEntry({"program", "samples", "other"}));
+    ASSERT_TRUE(entry != nullptr);
+    EXPECT_EQ(entry->getSize(), 42);
+    EXPECT_EQ(getEventRelation("@samples;other"), "");
+}
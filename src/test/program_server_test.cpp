@@ -0,0 +1,179 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file program_server_test.cpp
+ *
+ * Tests the base analysis of a served program and the requests of the
+ * program server on an interpreted program.
+ *
+ ***********************************************************************/
+
+#include "DebugReport.h"
+#include "ErrorReport.h"
+#include "Global.h"
+#include "InterpreterEngine.h"
+#include "InterpreterProgInterface.h"
+#include "ProgramServer.h"
+#include "RamBaseAnalysis.h"
+#include "RamCondition.h"
+#include "RamExpression.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamStatement.h"
+#include "RamTranslationUnit.h"
+#include "SymbolTable.h"
+
+#include "test.h"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace souffle::test {
+
+using ExprVec = std::vector<std::unique_ptr<RamExpression>>;
+
+/** Build a query projecting a constant tuple into the given relation */
+std::unique_ptr<RamStatement> fact(const RamRelation* rel, const std::vector<RamDomain>& values) {
+    ExprVec constants;
+    for (RamDomain value : values) {
+        constants.push_back(std::make_unique<RamSignedConstant>(value));
+    }
+    return std::make_unique<RamQuery>(
+            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(rel), std::move(constants)));
+}
+
+/** Connect to the Unix socket of a server, waiting for the server to listen */
+int connectTo(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            return fd;
+        }
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return -1;
+}
+
+/** Send a request and receive its reply, up to the line "ok" or the error message */
+std::string request(int fd, const std::string& line) {
+    const std::string data = line + "\n";
+    if (send(fd, data.data(), data.size(), 0) != static_cast<ssize_t>(data.size())) {
+        return "";
+    }
+    std::string reply;
+    char chunk[256];
+    while (true) {
+        if (!reply.empty() && reply.back() == '\n') {
+            const size_t end = reply.size() - 1;
+            const size_t start = end == 0 ? 0 : reply.rfind('\n', end - 1) + 1;
+            const std::string last = reply.substr(start, end - start);
+            if (last == "ok" || last.compare(0, 6, "error\t") == 0) {
+                return reply;
+            }
+        }
+        const ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+        if (count <= 0) {
+            return reply;
+        }
+        reply.append(chunk, count);
+    }
+}
+
+/**
+ * Program with the base relation E = {(1,2), (2,3), (3,4)} and the query input Q, computing
+ *   R(x, y) :- Q(x), E(x, y).
+ * Each run of the server evaluates R on the facts of Q inserted by a client, keeping E.
+ */
+TEST(ProgramServer, Requests) {
+    Global::config().set("jobs", "1");
+    Global::config().set("query-inputs", "Q");
+
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    rels.push_back(std::make_unique<RamRelation>("E", 2, 0, std::vector<std::string>({"x", "y"}),
+            std::vector<std::string>({"i", "i"}), RelationRepresentation::DEFAULT));
+    rels.push_back(std::make_unique<RamRelation>("Q", 1, 0, std::vector<std::string>({"x"}),
+            std::vector<std::string>({"i"}), RelationRepresentation::DEFAULT));
+    rels.push_back(std::make_unique<RamRelation>("R", 2, 0, std::vector<std::string>({"x", "y"}),
+            std::vector<std::string>({"i", "i"}), RelationRepresentation::DEFAULT));
+    const RamRelation* relE = rels[0].get();
+    const RamRelation* relQ = rels[1].get();
+    const RamRelation* relR = rels[2].get();
+
+    // R(t0.0, t1.1) for t0 in Q for t1 in E if t1.0 = t0.0
+    ExprVec projectValues;
+    projectValues.push_back(std::make_unique<RamTupleElement>(0, 0));
+    projectValues.push_back(std::make_unique<RamTupleElement>(1, 1));
+    auto rule = std::make_unique<RamQuery>(std::make_unique<RamScan>(
+            std::make_unique<RamRelationReference>(relQ), 0,
+            std::make_unique<RamScan>(std::make_unique<RamRelationReference>(relE), 1,
+                    std::make_unique<RamFilter>(
+                            std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+                                    std::make_unique<RamTupleElement>(1, 0),
+                                    std::make_unique<RamTupleElement>(0, 0)),
+                            std::make_unique<RamProject>(std::make_unique<RamRelationReference>(relR),
+                                    std::move(projectValues))))));
+    auto main = std::make_unique<RamSequence>(
+            fact(relE, {1, 2}), fact(relE, {2, 3}), fact(relE, {3, 4}), std::move(rule));
+
+    auto prog = std::make_unique<RamProgram>(
+            std::move(rels), std::move(main), std::map<std::string, std::unique_ptr<RamStatement>>());
+    SymbolTable symTab;
+    ErrorReport errReport;
+    DebugReport debugReport;
+    RamTranslationUnit translationUnit(std::move(prog), symTab, errReport, debugReport);
+
+    // only R reads the query input
+    const auto* analysis = translationUnit.getAnalysis<RamBaseAnalysis>();
+    EXPECT_EQ(std::vector<std::string>({"E"}), analysis->getBaseRelations());
+
+    InterpreterEngine interpreter(translationUnit);
+    interpreter.executeMain();
+    InterpreterProgInterface interface(interpreter);
+    interface.setBaseRelations(analysis->getBaseRelations());
+
+    const std::string path = "/tmp/souffle_program_server_test_" + std::to_string(getpid());
+    std::thread server([&]() { ProgramServer(interface, "unix:" + path).serve(); });
+    const int fd = connectTo(path);
+    EXPECT_TRUE(fd >= 0);
+
+    EXPECT_EQ("3\nok\n", request(fd, "size\tE"));
+    EXPECT_EQ("0\nok\n", request(fd, "size\tR"));
+    EXPECT_EQ("error\tBase relation E is read-only\n", request(fd, "insert\tE\t9\t9"));
+    EXPECT_EQ("ok\n", request(fd, "insert\tQ\t2"));
+    EXPECT_EQ("ok\n", request(fd, "run"));
+    EXPECT_EQ("2\t3\nok\n", request(fd, "select\tR\t_\t_"));
+    EXPECT_EQ("ok\n", request(fd, "select\tR\t1\t_"));
+    EXPECT_EQ("3\nok\n", request(fd, "size\tE"));
+
+    // a reset keeps the base relation only
+    EXPECT_EQ("ok\n", request(fd, "reset"));
+    EXPECT_EQ("0\nok\n", request(fd, "size\tR"));
+    EXPECT_EQ("3\nok\n", request(fd, "size\tE"));
+    EXPECT_EQ(0, request(fd, "size\tS").compare(0, 6, "error\t"));
+
+    EXPECT_EQ("ok\n", request(fd, "shutdown"));
+    close(fd);
+    server.join();
+    Global::config().unset("query-inputs");
+}
+
+}  // namespace souffle::test
@@ -17,16 +17,20 @@
 #include "DebugReport.h"
 #include "ErrorReport.h"
 #include "InterpreterEngine.h"
+#include "RamCondition.h"
 #include "RamExpression.h"
 #include "RamOperation.h"
 #include "RamProgram.h"
 #include "RamStatement.h"
+#include "RamTransforms.h"
 #include "RamTranslationUnit.h"
 #include "SymbolTable.h"
 
 #include "test.h"
 
+#include <chrono>
 #include <cmath>
+#include <iostream>
 #include <map>
 #include <random>
 #include <string>
@@ -665,4 +669,92 @@ TEST(MultiArg, FloatMin) {
     EXPECT_EQ(ramBitCast<RamFloat>(result), static_cast<RamFloat>(-100));
 }
 
+/** Build a balanced tree of additions over the given number of constant leaves */
+std::unique_ptr<RamExpression> buildAdditionTree(size_t leaves) {
+    if (leaves == 1) {
+        return std::make_unique<RamSignedConstant>(1);
+    }
+    std::vector<std::unique_ptr<RamExpression>> args;
+    args.push_back(buildAdditionTree(leaves / 2));
+    args.push_back(buildAdditionTree(leaves - leaves / 2));
+    return std::make_unique<RamIntrinsicOperator>(FunctorOp::ADD, std::move(args));
+}
+
+/**
+ * Measures the per-node cost of the interpreter dispatch: a loop evaluates a large
+ * expression tree in every iteration. Compile the interpreter with
+ * -DINTERPRETER_THREADED_DISPATCH to compare against the direct-threaded dispatch.
+ */
+TEST(Performance, Dispatch) {
+    const size_t leaves = 1024;
+    const RamDomain iterations = 2000;
+
+    // LOOP { QUERY IF (tree = -1) RETURN; EXIT (autoinc() >= iterations) }
+    auto condition = std::make_unique<RamConstraint>(
+            BinaryConstraintOp::EQ, buildAdditionTree(leaves), std::make_unique<RamSignedConstant>(-1));
+    auto query = std::make_unique<RamQuery>(std::make_unique<RamFilter>(std::move(condition),
+            std::make_unique<RamSubroutineReturnValue>(std::vector<std::unique_ptr<RamExpression>>())));
+    auto exit = std::make_unique<RamExit>(std::make_unique<RamConstraint>(BinaryConstraintOp::GE,
+            std::make_unique<RamAutoIncrement>(), std::make_unique<RamSignedConstant>(iterations - 1)));
+    auto loop = std::make_unique<RamLoop>(std::make_unique<RamSequence>(std::move(query), std::move(exit)));
+
+    Global::config().set("jobs", "1");
+    std::unique_ptr<RamProgram> prog =
+            std::make_unique<RamProgram>(std::vector<std::unique_ptr<RamRelation>>(),
+                    std::make_unique<RamSequence>(std::move(loop)),
+                    std::map<std::string, std::unique_ptr<RamStatement>>());
+    SymbolTable symTab;
+    ErrorReport errReport;
+    DebugReport debugReport;
+    RamTranslationUnit translationUnit(std::move(prog), symTab, errReport, debugReport);
+    InterpreterEngine interpreter(translationUnit);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    interpreter.executeMain();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // the addition tree has 2 * leaves - 1 nodes, plus a handful of nodes for the loop body
+    const double nodes = static_cast<double>(iterations) * (2 * leaves + 8);
+    const double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << "Interpreter dispatch: " << ns / nodes << "ns per node\n";
+}
+
+TEST(FoldConstants, AgreesWithInterpreter) {
+    const std::vector<FunctorOp> unary = {FunctorOp::NEG, FunctorOp::FNEG, FunctorOp::BNOT, FunctorOp::UBNOT,
+            FunctorOp::LNOT, FunctorOp::ULNOT, FunctorOp::ITOU, FunctorOp::UTOI, FunctorOp::ITOF,
+            FunctorOp::UTOF};
+    const std::vector<FunctorOp> binary = {FunctorOp::ADD, FunctorOp::SUB, FunctorOp::MUL, FunctorOp::DIV,
+            FunctorOp::MOD, FunctorOp::BAND, FunctorOp::BOR, FunctorOp::BXOR, FunctorOp::LAND, FunctorOp::LOR,
+            FunctorOp::UADD, FunctorOp::USUB, FunctorOp::UMUL, FunctorOp::UDIV, FunctorOp::UMOD,
+            FunctorOp::UBAND, FunctorOp::UBOR, FunctorOp::UBXOR, FunctorOp::ULAND, FunctorOp::ULOR,
+            FunctorOp::FADD, FunctorOp::FSUB, FunctorOp::FMUL, FunctorOp::FDIV, FunctorOp::MAX,
+            FunctorOp::MIN, FunctorOp::UMAX, FunctorOp::UMIN, FunctorOp::FMAX, FunctorOp::FMIN};
+    FoldConstantsTransformer folder;
+
+    auto randomNumbers = testutil::generateRandomVector<RamDomain>(2 * TESTS_PER_OPERATION);
+    // division by zero is evaluated at runtime
+    randomNumbers.push_back(0);
+    randomNumbers.push_back(0);
+    for (size_t i = 0; i + 1 < randomNumbers.size(); i += 2) {
+        for (FunctorOp functor : unary) {
+            std::vector<std::unique_ptr<RamExpression>> args;
+            args.push_back(std::make_unique<RamSignedConstant>(randomNumbers[i]));
+            auto folded = folder.foldFunctor(RamIntrinsicOperator(functor, std::move(args)));
+            ASSERT_TRUE(folded != nullptr);
+            EXPECT_EQ(static_cast<RamConstant&>(*folded).getConstant(), evalUnary(functor, randomNumbers[i]));
+        }
+        for (FunctorOp functor : binary) {
+            std::vector<std::unique_ptr<RamExpression>> args;
+            args.push_back(std::make_unique<RamSignedConstant>(randomNumbers[i]));
+            args.push_back(std::make_unique<RamSignedConstant>(randomNumbers[i + 1]));
+            if (auto folded = folder.foldFunctor(RamIntrinsicOperator(functor, std::move(args)))) {
+                EXPECT_EQ(static_cast<RamConstant&>(*folded).getConstant(),
+                        evalBinary(functor, randomNumbers[i], randomNumbers[i + 1]));
+            } else {
+                EXPECT_EQ(randomNumbers[i + 1], 0);
+            }
+        }
+    }
+}
+
 }  // namespace souffle::test
@@ -64,14 +64,14 @@ TEST(RamUserDefinedOperator, CloneAndEquals) {
     std::vector<std::unique_ptr<RamExpression>> a_args;
     a_args.emplace_back(new RamSignedConstant(1));
     a_args.emplace_back(new RamSignedConstant(10));
-    RamUserDefinedOperator a(
-            "NE", {TypeAttribute::Signed, TypeAttribute::Signed}, TypeAttribute::Signed, std::move(a_args));
+    RamUserDefinedOperator a("NE", {TypeAttribute::Signed, TypeAttribute::Signed}, TypeAttribute::Signed,
+            false, std::move(a_args));
 
     std::vector<std::unique_ptr<RamExpression>> b_args;
     b_args.emplace_back(new RamSignedConstant(1));
     b_args.emplace_back(new RamSignedConstant(10));
-    RamUserDefinedOperator b(
-            "NE", {TypeAttribute::Signed, TypeAttribute::Signed}, TypeAttribute::Signed, std::move(b_args));
+    RamUserDefinedOperator b("NE", {TypeAttribute::Signed, TypeAttribute::Signed}, TypeAttribute::Signed,
+            false, std::move(b_args));
     EXPECT_EQ(a, b);
     EXPECT_NE(&a, &b);
 
@@ -79,6 +79,21 @@ TEST(RamUserDefinedOperator, CloneAndEquals) {
     EXPECT_EQ(a, *aClone);
     EXPECT_NE(&a, aClone);
     delete aClone;
+
+    // a stateful functor differs from a stateless one of the same name and arguments
+    std::vector<std::unique_ptr<RamExpression>> c_args;
+    c_args.emplace_back(new RamSignedConstant(1));
+    c_args.emplace_back(new RamSignedConstant(10));
+    RamUserDefinedOperator c("NE", {TypeAttribute::Signed, TypeAttribute::Signed}, TypeAttribute::Signed,
+            true, std::move(c_args));
+    EXPECT_NE(a, c);
+    EXPECT_TRUE(c.isStateful());
+
+    RamUserDefinedOperator* cClone = c.clone();
+    EXPECT_EQ(c, *cClone);
+    EXPECT_NE(&c, cClone);
+    EXPECT_TRUE(cClone->isStateful());
+    delete cClone;
 }
 
 TEST(RamTupleElement, CloneAndEquals) {
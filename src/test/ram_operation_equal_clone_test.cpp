@@ -329,6 +329,32 @@ TEST(RamAggregate, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamParallelAggregate, CloneAndEquals) {
+    RamRelation edge("edge", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // PARALLEL t0.0 = SUM t0.1 FOR ALL t0 IN edge
+    //  RETURN t0.0
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto a_return = std::make_unique<RamSubroutineReturnValue>(std::move(a_return_args));
+    RamParallelAggregate a(std::move(a_return), AggregateFunction::SUM,
+            std::make_unique<RamRelationReference>(&edge), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), 0);
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto b_return = std::make_unique<RamSubroutineReturnValue>(std::move(b_return_args));
+    RamParallelAggregate b(std::move(b_return), AggregateFunction::SUM,
+            std::make_unique<RamRelationReference>(&edge), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), 0);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamParallelAggregate* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(RamIndexAggregate, CloneAndEquals) {
     RamRelation sqrt("sqrt", 2, 1, {"nth", "value"}, {"i", "i"}, RelationRepresentation::DEFAULT);
     // t0.0 = MIN t1.1 SEARCH t1 IN sqrt ON INDEX t1.0 = ⊥ AND t1.1 = ⊥
@@ -366,6 +392,38 @@ TEST(RamIndexAggregate, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamParallelIndexAggregate, CloneAndEquals) {
+    RamRelation sqrt("sqrt", 2, 1, {"nth", "value"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // PARALLEL t0.0 = MAX t0.1 SEARCH t0 IN sqrt ON INDEX t0.0 = 3 AND t0.1 = ⊥
+    //  RETURN t0.0
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto a_return = std::make_unique<RamSubroutineReturnValue>(std::move(a_return_args));
+    std::vector<std::unique_ptr<RamExpression>> a_criteria;
+    a_criteria.emplace_back(new RamSignedConstant(3));
+    a_criteria.emplace_back(new RamUndefValue);
+    RamParallelIndexAggregate a(std::move(a_return), AggregateFunction::MAX,
+            std::make_unique<RamRelationReference>(&sqrt), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), std::move(a_criteria), 0);
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto b_return = std::make_unique<RamSubroutineReturnValue>(std::move(b_return_args));
+    std::vector<std::unique_ptr<RamExpression>> b_criteria;
+    b_criteria.emplace_back(new RamSignedConstant(3));
+    b_criteria.emplace_back(new RamUndefValue);
+    RamParallelIndexAggregate b(std::move(b_return), AggregateFunction::MAX,
+            std::make_unique<RamRelationReference>(&sqrt), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), std::move(b_criteria), 0);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamParallelIndexAggregate* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(RamUnpackedRecord, CloneAndEquals) {
     // UNPACK (t0.0, t0.2) INTO t1
     // RETURN number(0)
@@ -0,0 +1,127 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ram_program_cache_test.cpp
+ *
+ * Tests storing RAM programs in and loading them from a cache file.
+ *
+ ***********************************************************************/
+
+#include "RamCondition.h"
+#include "RamExpression.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamProgramCache.h"
+#include "RamRelation.h"
+#include "RamStatement.h"
+#include "SymbolTable.h"
+#include "Util.h"
+
+#include "test.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace souffle {
+
+namespace test {
+
+/** Create a program copying the tuples of A with a given first attribute to B, and a subroutine */
+std::unique_ptr<RamProgram> createProgram(SymbolTable& symbolTable) {
+    std::vector<std::unique_ptr<RamRelation>> rels;
+    rels.push_back(std::make_unique<RamRelation>("A", 2, 0, std::vector<std::string>{"x", "y"},
+            std::vector<std::string>{"i", "s"}, RelationRepresentation::BTREE));
+    rels.push_back(std::make_unique<RamRelation>("B", 2, 0, std::vector<std::string>{"x", "y"},
+            std::vector<std::string>{"i", "s"}, RelationRepresentation::DEFAULT, 256, 1000, true));
+    const RamRelation* A = rels[0].get();
+    const RamRelation* B = rels[1].get();
+
+    std::vector<std::unique_ptr<RamExpression>> pattern;
+    pattern.push_back(std::make_unique<RamSignedConstant>(1));
+    pattern.push_back(std::make_unique<RamUndefValue>());
+    std::vector<std::unique_ptr<RamExpression>> values;
+    values.push_back(std::make_unique<RamTupleElement>(0, 0));
+    values.push_back(std::make_unique<RamSignedConstant>(symbolTable.lookup("copied")));
+    auto project = std::make_unique<RamProject>(std::make_unique<RamRelationReference>(B), std::move(values));
+    auto filter = std::make_unique<RamFilter>(
+            std::make_unique<RamConstraint>(BinaryConstraintOp::NE,
+                    std::make_unique<RamTupleElement>(0, 1), std::make_unique<RamFloatConstant>(-3)),
+            std::move(project), "@frequency-rule;B;...");
+    auto scan = std::make_unique<RamIndexScan>(
+            std::make_unique<RamRelationReference>(A), 0, std::move(pattern), std::move(filter));
+
+    IODirectives directives;
+    directives.setIOType("file");
+    directives.set("filename", "A.facts");
+    std::vector<IODirectives> ioDirectives{directives};
+
+    auto main = std::make_unique<RamSequence>(
+            std::make_unique<RamLoad>(std::make_unique<RamRelationReference>(A), ioDirectives),
+            std::make_unique<RamLogRelationTimer>(std::make_unique<RamQuery>(std::move(scan)), "@t-B",
+                    std::make_unique<RamRelationReference>(B)),
+            std::make_unique<RamLoop>(std::make_unique<RamExit>(
+                    std::make_unique<RamNegation>(std::make_unique<RamEmptinessCheck>(
+                            std::make_unique<RamRelationReference>(B))))));
+
+    std::vector<std::unique_ptr<RamExpression>> returned;
+    returned.push_back(std::make_unique<RamSubroutineArgument>(0));
+    std::map<std::string, std::unique_ptr<RamStatement>> subs;
+    subs["B_subproof"] = std::make_unique<RamQuery>(
+            std::make_unique<RamSubroutineReturnValue>(std::move(returned)));
+
+    return std::make_unique<RamProgram>(std::move(rels), std::move(main), std::move(subs));
+}
+
+TEST(RamProgramCache, StoreAndLoad) {
+    SymbolTable symbolTable;
+    symbolTable.lookup("constant");
+    auto program = createProgram(symbolTable);
+
+    const std::string fileName = tempFile() + ".ram";
+    RamProgramCache::store(fileName, *program, symbolTable, "Warning: unused relation");
+
+    SymbolTable loadedSymbols;
+    std::string warnings;
+    auto loaded = RamProgramCache::load(fileName, loadedSymbols, warnings);
+    std::remove(fileName.c_str());
+
+    ASSERT_TRUE(loaded != nullptr);
+    EXPECT_EQ(toString(*program), toString(*loaded));
+    EXPECT_EQ("Warning: unused relation", warnings);
+    EXPECT_EQ(symbolTable.size(), loadedSymbols.size());
+    EXPECT_EQ("copied", loadedSymbols.resolve(1));
+    EXPECT_EQ(256, loaded->getRelations()[1]->getBlockSize());
+    EXPECT_TRUE(loaded->getRelations()[1]->hasBloomFilter());
+}
+
+TEST(RamProgramCache, Corrupt) {
+    SymbolTable symbolTable;
+    auto program = createProgram(symbolTable);
+
+    const std::string fileName = tempFile() + ".ram";
+    std::string warnings;
+    SymbolTable missingSymbols;
+    EXPECT_TRUE(RamProgramCache::load(fileName, missingSymbols, warnings) == nullptr);
+
+    // a truncated file is not loaded, and leaves the symbol table unchanged
+    RamProgramCache::store(fileName, *program, symbolTable, "");
+    std::ifstream in(fileName, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream(fileName, std::ios::binary | std::ios::trunc) << content.substr(0, content.size() - 1);
+
+    SymbolTable truncatedSymbols;
+    EXPECT_TRUE(RamProgramCache::load(fileName, truncatedSymbols, warnings) == nullptr);
+    EXPECT_EQ(0, truncatedSymbols.size());
+    std::remove(fileName.c_str());
+}
+
+}  // end namespace test
+}  // end namespace souffle
@@ -66,6 +66,52 @@ TEST(RamClear, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamBuildIndex, CloneAndEquals) {
+    // BUILD_INDEX A ON (1)
+    RamRelation A("A", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    RamBuildIndex a(std::make_unique<RamRelationReference>(&A), 2);
+    RamBuildIndex b(std::make_unique<RamRelationReference>(&A), 2);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamBuildIndex* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    // the index is identified by the search
+    RamBuildIndex d(std::make_unique<RamRelationReference>(&A), 1);
+    EXPECT_NE(a, d);
+}
+
+TEST(RamFreeze, CloneAndEquals) {
+    // FREEZE A
+    RamRelation A("A", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    RamFreeze a(std::make_unique<RamRelationReference>(&A));
+    RamFreeze b(std::make_unique<RamRelationReference>(&A));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamFreeze* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(RamDropIndex, CloneAndEquals) {
+    // DROP_INDEX A ON (1)
+    RamRelation A("A", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    RamDropIndex a(std::make_unique<RamRelationReference>(&A), 2);
+    RamDropIndex b(std::make_unique<RamRelationReference>(&A), 2);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamDropIndex* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(RamExtend, CloneAndEquals) {
     // MERGE B WITH A
     RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
@@ -258,6 +304,91 @@ TEST(RamParallel, CloneAndEquals) {
     EXPECT_NE(&a, c);
     delete c;
 }
+
+TEST(RamSchedule, CloneAndEquals) {
+    RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    RamRelation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+
+    /* SCHEDULE (JOBS 2)
+     *  STRATUM 0
+     *   CLEAR A
+     *  STRATUM 1
+     *   CLEAR B
+     *  STRATUM 2 AFTER 0, 1
+     *   CLEAR A
+     * END SCHEDULE
+     * */
+    RamSchedule a(2);
+    a.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), {});
+    a.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&B)), {});
+    a.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), {0, 1});
+
+    RamSchedule b(2);
+    b.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), {});
+    b.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&B)), {});
+    b.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), {0, 1});
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamSchedule* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    // same strata with different dependencies
+    RamSchedule d(2);
+    d.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), {});
+    d.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&B)), {0});
+    d.add(std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), {0, 1});
+    EXPECT_NE(a, d);
+}
+TEST(RamAdaptiveQuery, CloneAndEquals) {
+    RamRelation A("A", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    RamRelation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+
+    /* ADAPTIVE
+     *  QUERY
+     *   FOR t0 IN A
+     *    PROJECT (t0.0) INTO B
+     *  QUERY
+     *   FOR t0 IN B
+     *    PROJECT (t0.0) INTO B
+     * END ADAPTIVE
+     * */
+    auto makeQuery = [&](const RamRelation& searched) {
+        std::vector<std::unique_ptr<RamExpression>> expressions;
+        expressions.emplace_back(new RamTupleElement(0, 0));
+        auto project = std::make_unique<RamProject>(
+                std::make_unique<RamRelationReference>(&B), std::move(expressions));
+        return std::make_unique<RamQuery>(std::make_unique<RamScan>(
+                std::make_unique<RamRelationReference>(&searched), 0, std::move(project), ""));
+    };
+    RamAdaptiveQuery a;
+    a.add(makeQuery(A));
+    a.add(makeQuery(B));
+
+    RamAdaptiveQuery b;
+    b.add(makeQuery(A));
+    b.add(makeQuery(B));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamAdaptiveQuery* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    // the same alternatives in another order
+    RamAdaptiveQuery d;
+    d.add(makeQuery(B));
+    d.add(makeQuery(A));
+    EXPECT_NE(a, d);
+
+    auto levels = RamAdaptiveQuery::getLevels(*a.getStatements()[0]);
+    EXPECT_EQ(1, levels.size());
+    EXPECT_EQ(&A, levels[0].relation);
+    EXPECT_EQ(2, levels[0].freeAttributes);
+}
 TEST(RamLoop, CloneAndEquals) {
     RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
     RamRelation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
@@ -436,6 +567,26 @@ TEST(RamDebugInfo, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamCheckpoint, CloneAndEquals) {
+    RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    // BEGIN_CHECKPOINT 1 "state.ckpt"
+    //  CLEAR A
+    // END_CHECKPOINT
+    RamCheckpoint a(1, std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), "state.ckpt");
+    RamCheckpoint b(1, std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), "state.ckpt");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamCheckpoint* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    // another stratum of the same checkpoint file
+    RamCheckpoint d(2, std::make_unique<RamClear>(std::make_unique<RamRelationReference>(&A)), "state.ckpt");
+    EXPECT_NE(a, d);
+}
+
 TEST(RamLogSize, CloneAndEquals) {
     RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
     RamLogSize a(std::make_unique<RamRelationReference>(&A), "Log message");
@@ -448,5 +599,43 @@ TEST(RamLogSize, CloneAndEquals) {
     EXPECT_NE(&a, c);
     delete c;
 }
+
+TEST(RamLogStatistics, CloneAndEquals) {
+    RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    RamLogStatistics a(std::make_unique<RamRelationReference>(&A), "Log message");
+    RamLogStatistics b(std::make_unique<RamRelationReference>(&A), "Log message");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamLogStatistics* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(RamLogMemory, CloneAndEquals) {
+    RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    RamRelation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    std::vector<std::unique_ptr<RamRelationReference>> a_refs;
+    a_refs.push_back(std::make_unique<RamRelationReference>(&A));
+    a_refs.push_back(std::make_unique<RamRelationReference>(&B));
+    RamLogMemory a(1, std::move(a_refs));
+    std::vector<std::unique_ptr<RamRelationReference>> b_refs;
+    b_refs.push_back(std::make_unique<RamRelationReference>(&A));
+    b_refs.push_back(std::make_unique<RamRelationReference>(&B));
+    RamLogMemory b(1, std::move(b_refs));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamLogMemory* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    std::vector<std::unique_ptr<RamRelationReference>> d_refs;
+    d_refs.push_back(std::make_unique<RamRelationReference>(&A));
+    RamLogMemory d(1, std::move(d_refs));
+    EXPECT_NE(a, d);
+}
 }  // end namespace test
 }  // end namespace souffle
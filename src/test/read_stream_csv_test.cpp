@@ -0,0 +1,396 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file read_stream_csv_test.cpp
+ *
+ * Tests the CSV reader.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "IODirectives.h"
+#include "ReadStreamCSV.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "json11.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::test {
+
+/** A minimal relation collecting the inserted tuples */
+struct Collector {
+    std::vector<std::vector<RamDomain>> tuples;
+
+    void insert(const RamDomain* tuple) {
+        tuples.emplace_back(tuple, tuple + 3);
+    }
+};
+
+IODirectives getDirectives(const std::map<std::string, std::string>& extra = {}) {
+    std::vector<std::string> attributeTypes{"i", "s", "u"};
+    json11::Json types = json11::Json::object{
+            {"test", json11::Json::object{{"arity", static_cast<long long>(3)},
+                             {"auxArity", static_cast<long long>(0)},
+                             {"types", json11::Json::array(attributeTypes.begin(), attributeTypes.end())}}}};
+    std::map<std::string, std::string> directives = {
+            {"IO", "stdin"}, {"name", "test"}, {"types", types.dump()}};
+    directives.insert(extra.begin(), extra.end());
+    return IODirectives(directives);
+}
+
+// read more lines than fit into a single chunk
+TEST(ReadStreamCSV, Chunks) {
+    const RamDomain N = 200000;
+    std::stringstream input;
+    for (RamDomain i = 0; i < N; ++i) {
+        input << i << "\tsym" << (N - i) % 1000 << "\t" << 2 * i << "\r\n";
+    }
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Collector relation;
+    ReadStreamCSV reader(input, getDirectives(), symbolTable, recordTable);
+    reader.readAll(relation);
+
+    EXPECT_EQ(N, relation.tuples.size());
+    for (RamDomain i = 0; i < N; ++i) {
+        EXPECT_EQ(i, relation.tuples[i][0]);
+        EXPECT_EQ("sym" + std::to_string((N - i) % 1000), symbolTable.resolve(relation.tuples[i][1]));
+        EXPECT_EQ(2 * i, relation.tuples[i][2]);
+    }
+
+    // symbols are numbered in order of appearance
+    EXPECT_EQ(1000, symbolTable.size());
+    for (RamDomain i = 0; i < 1000; ++i) {
+        EXPECT_EQ(i, relation.tuples[i][1]);
+    }
+}
+
+// insert the chunks of a streamed input while reading the next ones
+TEST(ReadStreamCSV, Streamed) {
+    const RamDomain N = 300000;
+    std::stringstream input;
+    for (RamDomain i = 0; i < N; ++i) {
+        input << i << "\tsym" << i % 10 << "\t" << 3 * i << "\n";
+    }
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Collector relation;
+    ReadStreamCSV reader(input, getDirectives({{"stream", "true"}}), symbolTable, recordTable);
+    reader.readAll(relation);
+
+    EXPECT_EQ(N, relation.tuples.size());
+    for (RamDomain i = 0; i < N; ++i) {
+        EXPECT_EQ(i, relation.tuples[i][0]);
+        EXPECT_EQ("sym" + std::to_string(i % 10), symbolTable.resolve(relation.tuples[i][1]));
+        EXPECT_EQ(3 * i, relation.tuples[i][2]);
+    }
+
+    // errors of the reader are reported after inserting the preceding chunks
+    std::stringstream invalid;
+    for (RamDomain i = 0; i < N; ++i) {
+        invalid << i << "\ts\t" << (i == N - 1 ? "x" : "1") << "\n";
+    }
+    Collector partial;
+    ReadStreamCSV invalidReader(invalid, getDirectives({{"stream", "true"}}), symbolTable, recordTable);
+    std::string error;
+    try {
+        invalidReader.readAll(partial);
+    } catch (std::invalid_argument& e) {
+        error = e.what();
+    }
+    EXPECT_EQ("Error converting <x> in column 3 in line " + std::to_string(N) + "; ", error);
+    EXPECT_LT(0, partial.tuples.size());
+}
+
+// honor the column mapping and delimiter
+TEST(ReadStreamCSV, Columns) {
+    std::stringstream input;
+    input << "x,1,a,2\n"
+          << "y,3,b,4\n";
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Collector relation;
+    ReadStreamCSV reader(
+            input, getDirectives({{"delimiter", ","}, {"columns", "3:2:1"}}), symbolTable, recordTable);
+    reader.readAll(relation);
+
+    EXPECT_EQ(2, relation.tuples.size());
+    EXPECT_EQ(2, relation.tuples[0][0]);
+    EXPECT_EQ("a", symbolTable.resolve(relation.tuples[0][1]));
+    EXPECT_EQ(1, relation.tuples[0][2]);
+    EXPECT_EQ(4, relation.tuples[1][0]);
+    EXPECT_EQ("b", symbolTable.resolve(relation.tuples[1][1]));
+    EXPECT_EQ(3, relation.tuples[1][2]);
+}
+
+// report the first erroneous line
+TEST(ReadStreamCSV, Error) {
+    std::stringstream input;
+    for (int i = 0; i < 5000; ++i) {
+        input << i << "\ts\t" << (i == 3000 || i == 4000 ? "x" : "1") << "\n";
+    }
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Collector relation;
+    ReadStreamCSV reader(input, getDirectives(), symbolTable, recordTable);
+    std::string error;
+    try {
+        reader.readAll(relation);
+    } catch (std::invalid_argument& e) {
+        error = e.what();
+    }
+    EXPECT_EQ("Error converting <x> in column 3 in line 3001; ", error);
+}
+
+// read symbols given by their indices in the symbol table
+TEST(ReadStreamCSV, SymbolIds) {
+    std::stringstream input;
+    input << "0\t0\t0\n"
+          << "1\t2\t3\n"
+          << "1\t3\t3\n";
+
+    SymbolTable symbolTable({"a", "b", "c"});
+    RecordTable recordTable;
+    Collector relation;
+    ReadStreamCSV reader(input, getDirectives({{"symbol-ids", "true"}}), symbolTable, recordTable);
+    std::string error;
+    try {
+        reader.readAll(relation);
+    } catch (std::invalid_argument& e) {
+        error = e.what();
+    }
+    EXPECT_EQ("Error converting <3> in column 2 in line 3; ", error);
+    EXPECT_EQ(3, symbolTable.size());
+
+    std::stringstream valid;
+    valid << "0\t0\t0\n"
+          << "1\t2\t3\n";
+    ReadStreamCSV validReader(valid, getDirectives({{"symbol-ids", "true"}}), symbolTable, recordTable);
+    validReader.readAll(relation);
+    EXPECT_EQ(2, relation.tuples.size());
+    EXPECT_EQ("a", symbolTable.resolve(relation.tuples[0][1]));
+    EXPECT_EQ("c", symbolTable.resolve(relation.tuples[1][1]));
+}
+
+// accept the same number formats as the std::sto* conversions
+TEST(ReadStreamCSV, Numbers) {
+    std::stringstream input;
+    input << "+5\ta\t7\n"
+          << " -3\tb\t0012\n"
+          << "42abc\tc\t+1\n";
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Collector relation;
+    ReadStreamCSV reader(input, getDirectives(), symbolTable, recordTable);
+    reader.readAll(relation);
+
+    EXPECT_EQ(3, relation.tuples.size());
+    EXPECT_EQ(5, relation.tuples[0][0]);
+    EXPECT_EQ(7, relation.tuples[0][2]);
+    EXPECT_EQ(-3, relation.tuples[1][0]);
+    EXPECT_EQ(12, relation.tuples[1][2]);
+    EXPECT_EQ(42, relation.tuples[2][0]);
+    EXPECT_EQ(1, relation.tuples[2][2]);
+}
+
+// read the shards of a relation concurrently
+TEST(ReadShardedCSV, Shards) {
+    char dirTemplate[] = "/tmp/souffle-shards-XXXXXX";
+    const std::string dir = mkdtemp(dirTemplate);
+    const std::vector<std::string> files{"part-0", "part-1", "part-2", "readme"};
+    const RamDomain N = 100000;
+    for (size_t shard = 0; shard < files.size(); ++shard) {
+        std::ofstream file(dir + "/" + files[shard]);
+        for (RamDomain i = 0; i < N; ++i) {
+            file << shard * N + i << "\tsym" << (shard * N + i) % 1000 << "\t" << i % 2 << "\n";
+        }
+    }
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Collector relation;
+    ReadShardedCSV reader(getDirectives({{"filename", dir + "/test.facts"}, {"shards", "part-*"},
+                                  {"filter", R"({"2": "u1"})"}}),
+            symbolTable, recordTable);
+    reader.readAll(relation);
+
+    // the chunks of the shards are interleaved
+    std::sort(relation.tuples.begin(), relation.tuples.end());
+    EXPECT_EQ(3 * N / 2, relation.tuples.size());
+    for (size_t j = 0; j < relation.tuples.size(); ++j) {
+        const RamDomain value = 2 * j + 1;
+        EXPECT_EQ(value, relation.tuples[j][0]);
+        EXPECT_EQ("sym" + std::to_string(value % 1000), symbolTable.resolve(relation.tuples[j][1]));
+    }
+    EXPECT_EQ(500, symbolTable.size());
+
+    // a directory gives all of its files
+    Collector all;
+    ReadShardedCSV dirReader(getDirectives({{"shards", dir}}), symbolTable, recordTable);
+    dirReader.readAll(all);
+    EXPECT_EQ(4 * N, all.tuples.size());
+
+    std::string error;
+    try {
+        ReadShardedCSV missing(getDirectives({{"shards", dir + "/none-*"}}), symbolTable, recordTable);
+    } catch (std::invalid_argument& e) {
+        error = e.what();
+    }
+    EXPECT_EQ("Cannot find fact shards " + dir + "/none-*\n", error);
+
+    for (const auto& file : files) {
+        std::remove((dir + "/" + file).c_str());
+    }
+    std::remove(dir.c_str());
+}
+
+// drop the lines whose filtered columns differ from the constants, and their symbols
+TEST(ReadStreamCSV, Filter) {
+    const RamDomain N = 100000;
+    std::stringstream input;
+    for (RamDomain i = 0; i < N; ++i) {
+        input << (i % 3 == 0 ? "call" : "load") << i << "," << i << ",s" << i << "," << i % 7 << ",0"
+              << 2 * i << "," << (i % 3 == 0 ? "call" : "load") << "\n";
+    }
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Collector relation;
+    ReadStreamCSV reader(input,
+            getDirectives({{"delimiter", ","}, {"columns", "1:2:4"},
+                    {"filter", R"({"3": "i5", "5": "scall"})"}}),
+            symbolTable, recordTable);
+    reader.readAll(relation);
+
+    std::vector<RamDomain> expected;
+    for (RamDomain i = 0; i < N; ++i) {
+        if (i % 3 == 0 && i % 7 == 5) {
+            expected.push_back(i);
+        }
+    }
+    EXPECT_EQ(expected.size(), relation.tuples.size());
+    for (size_t j = 0; j < expected.size(); ++j) {
+        EXPECT_EQ(expected[j], relation.tuples[j][0]);
+        EXPECT_EQ("s" + std::to_string(expected[j]), symbolTable.resolve(relation.tuples[j][1]));
+        EXPECT_EQ(2 * expected[j], relation.tuples[j][2]);
+    }
+    EXPECT_EQ(expected.size(), symbolTable.size());
+
+    // a chunk without any kept line does not end the input, neither when reading line by line
+    std::stringstream sparse;
+    for (RamDomain i = 0; i < N; ++i) {
+        sparse << i << "\tsym\t" << (i == N - 1 ? 1 : 0) << "\n";
+    }
+    Collector last;
+    ReadStreamCSV sparseReader(
+            sparse, getDirectives({{"filter", R"({"2": "u1"})"}}), symbolTable, recordTable);
+    sparseReader.readAll(last);
+    EXPECT_EQ(1, last.tuples.size());
+    EXPECT_EQ(N - 1, last.tuples[0][0]);
+
+    // filtered columns are converted as if they were read
+    std::stringstream invalid;
+    invalid << "1\ta\t1\n"
+            << "2\tb\tx\n";
+    Collector none;
+    ReadStreamCSV invalidReader(
+            invalid, getDirectives({{"filter", R"({"2": "u0"})"}}), symbolTable, recordTable);
+    std::string error;
+    try {
+        invalidReader.readAll(none);
+    } catch (std::invalid_argument& e) {
+        error = e.what();
+    }
+    EXPECT_EQ("Error converting <x> in column 3 in line 2; ", error);
+}
+
+// a sampled input keeps about the given fraction of its tuples, the same ones for each load
+TEST(ReadStreamCSV, Sample) {
+    const RamDomain N = 100000;
+    auto read = [&](SymbolTable& symbolTable, const std::map<std::string, std::string>& directives) {
+        std::stringstream input;
+        for (RamDomain i = 0; i < N; ++i) {
+            input << i << "\tsym" << i % 100 << "\t" << i % 7 << "\n";
+        }
+        RecordTable recordTable;
+        Collector relation;
+        ReadStreamCSV reader(input, getDirectives(directives), symbolTable, recordTable);
+        reader.readAll(relation);
+        std::set<std::pair<RamDomain, std::string>> tuples;
+        for (const auto& tuple : relation.tuples) {
+            tuples.emplace(tuple[0], symbolTable.resolve(tuple[1]));
+        }
+        return tuples;
+    };
+
+    SymbolTable symbolTable;
+    const auto tenth = read(symbolTable, {{"sample", "0.1"}});
+    EXPECT_LT(N / 10 - N / 100, tenth.size());
+    EXPECT_LT(tenth.size(), N / 10 + N / 100);
+    EXPECT_EQ(N, read(symbolTable, {{"sample", "1"}}).size());
+
+    // the sample does not depend on the indices of symbols, and a sample of a lower rate is a subset
+    SymbolTable reversed;
+    for (RamDomain i = 99; i >= 0; --i) {
+        reversed.lookup("sym" + std::to_string(i));
+    }
+    EXPECT_TRUE(tenth == read(reversed, {{"sample", "0.1"}}));
+    const auto hundredth = read(symbolTable, {{"sample", "0.01"}, {"stream", "true"}});
+    EXPECT_LT(0, hundredth.size());
+    EXPECT_LT(hundredth.size(), tenth.size());
+    EXPECT_TRUE(std::includes(tenth.begin(), tenth.end(), hundredth.begin(), hundredth.end()));
+}
+
+TEST(RamFromChars, Conversions) {
+    EXPECT_EQ(-17, RamDomainFromChars("-17"));
+    EXPECT_EQ(17, RamDomainFromChars("+17"));
+    EXPECT_EQ(17u, RamUnsignedFromChars("17"));
+    EXPECT_EQ(2.5, RamFloatFromChars("2.5"));
+    EXPECT_EQ(8.0, RamFloatFromChars("0x1p3"));
+    EXPECT_EQ(-1.0, RamFloatFromChars(" -1"));
+
+    bool caught = false;
+    try {
+        RamDomainFromChars("99999999999999999999999");
+    } catch (std::out_of_range&) {
+        caught = true;
+    }
+    EXPECT_TRUE(caught);
+}
+
+TEST(RamFloatToChars, RoundTrip) {
+    EXPECT_EQ("0.1", RamFloatToString(static_cast<RamFloat>(0.1)));
+    EXPECT_EQ("-2.5", RamFloatToString(-2.5));
+    EXPECT_EQ("0", RamFloatToString(0));
+
+    // the shortest decimal of a float converts back to the same float
+    for (RamDomain i = 1; i < 100000; ++i) {
+        const RamFloat value = static_cast<RamFloat>(i) / 7 * (i % 2 == 0 ? 1e-20 : 1e20);
+        EXPECT_EQ(value, RamFloatFromChars(RamFloatToString(value)));
+    }
+}
+
+}  // namespace souffle::test
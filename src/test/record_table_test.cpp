@@ -103,4 +103,84 @@ TEST(PackUnpack, Vector) {
     }
 }
 
+// Pack the same tuples from many threads
+// equal tuples obtain equal references, distinct tuples distinct ones
+TEST(PackUnpack, Parallel) {
+    constexpr size_t N = 10000;
+
+    RecordTable recordTable;
+
+    std::vector<RamDomain> refs(N);
+
+#pragma omp parallel for
+    for (size_t i = 0; i < 4 * N; ++i) {
+        const auto key = static_cast<RamDomain>(i % N);
+        std::vector<RamDomain> record = {key, key % 7};
+        RamDomain ref = recordTable.pack(record);
+        if (i < N) {
+            refs[i] = ref;
+        }
+    }
+
+    std::set<RamDomain> unique(refs.begin(), refs.end());
+    EXPECT_EQ(N, unique.size());
+    EXPECT_EQ(0, unique.count(recordTable.getNil()));
+
+    for (size_t i = 0; i < N; ++i) {
+        const RamDomain* unpacked = recordTable.unpack(refs[i], 2);
+        EXPECT_EQ(static_cast<RamDomain>(i), unpacked[0]);
+        EXPECT_EQ(static_cast<RamDomain>(i % 7), unpacked[1]);
+    }
+}
+
+// Records are stored once, and only occupy their arity in the slab
+TEST(RecordTable, MemoryUsage) {
+    RecordTable recordTable;
+    const size_t empty = recordTable.memoryUsage();
+
+    for (RamDomain i = 0; i < 1000; ++i) {
+        recordTable.pack(std::vector<RamDomain>{i, i + 1, i + 2});
+    }
+    EXPECT_EQ(1000, recordTable.size());
+    const size_t used = recordTable.memoryUsage();
+    EXPECT_LT(empty + 1000 * 3 * sizeof(RamDomain), used);
+
+    // packing existing records does not allocate anything
+    for (RamDomain i = 0; i < 1000; ++i) {
+        recordTable.pack(std::vector<RamDomain>{i, i + 1, i + 2});
+    }
+    EXPECT_EQ(1000, recordTable.size());
+    EXPECT_EQ(used, recordTable.memoryUsage());
+}
+
+// Nested records share their sub-records, and records of small and large arities are kept apart
+TEST(RecordTable, Nested) {
+    RecordTable recordTable;
+
+    // the list [0, 1, ..., 99], built twice
+    RamDomain lists[2];
+    for (RamDomain& list : lists) {
+        list = recordTable.getNil();
+        for (RamDomain i = 100; i-- > 0;) {
+            list = recordTable.pack(ram::Tuple<RamDomain, 2>({i, list}));
+        }
+    }
+    EXPECT_EQ(lists[0], lists[1]);
+    EXPECT_EQ(100, recordTable.size(2));
+
+    RamDomain list = lists[0];
+    for (RamDomain i = 0; i < 100; ++i) {
+        const RamDomain* cell = recordTable.unpack<2>(list);
+        EXPECT_EQ(i, cell[0]);
+        list = cell[1];
+    }
+    EXPECT_TRUE(recordTable.isNil(list));
+
+    std::vector<RamDomain> wide(40, 7);
+    const RamDomain ref = recordTable.pack(wide);
+    EXPECT_EQ(ref, recordTable.pack(wide.data(), wide.size()));
+    EXPECT_EQ(7, recordTable.unpack(ref, wide.size())[39]);
+    EXPECT_TRUE((std::vector<size_t>{2, 40}) == recordTable.getArities());
+}
+
 }  // namespace souffle::test
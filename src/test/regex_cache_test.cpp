@@ -0,0 +1,69 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file regex_cache_test.cpp
+ *
+ * A test case testing compiled patterns of match constraints and their
+ * cache.
+ *
+ ***********************************************************************/
+
+#include "RegexCache.h"
+#include "test.h"
+#include <string>
+
+namespace souffle {
+namespace test {
+
+TEST(CompiledRegex, Literal) {
+    CompiledRegex regex("abc");
+    EXPECT_TRUE(regex.isValid());
+    EXPECT_TRUE(regex.matches("abc"));
+    EXPECT_FALSE(regex.matches("ab"));
+    EXPECT_FALSE(regex.matches("abcd"));
+    EXPECT_FALSE(regex.matches(""));
+}
+
+TEST(CompiledRegex, Pattern) {
+    CompiledRegex regex("a.*c");
+    EXPECT_TRUE(regex.isValid());
+    EXPECT_TRUE(regex.matches("ac"));
+    EXPECT_TRUE(regex.matches("abbc"));
+    EXPECT_FALSE(regex.matches("abcd"));
+
+    CompiledRegex alternatives("[0-9]+|x");
+    EXPECT_TRUE(alternatives.matches("123"));
+    EXPECT_TRUE(alternatives.matches("x"));
+    EXPECT_FALSE(alternatives.matches("x1"));
+}
+
+TEST(CompiledRegex, Invalid) {
+    CompiledRegex regex("a(b");
+    EXPECT_FALSE(regex.isValid());
+    EXPECT_EQ("a(b", regex.getPattern());
+}
+
+TEST(RegexCache, Lookup) {
+    const CompiledRegex& first = RegexCache::get("b+");
+    EXPECT_TRUE(first.matches("bbb"));
+    EXPECT_EQ(&first, &RegexCache::get("b+"));
+
+    // evict the pattern by many others, and recompile it
+    for (int i = 0; i < 100; ++i) {
+        const CompiledRegex& other = RegexCache::get("c" + std::to_string(i) + ".");
+        EXPECT_TRUE(other.matches("c" + std::to_string(i) + "d"));
+    }
+    const CompiledRegex& again = RegexCache::get("b+");
+    EXPECT_TRUE(again.matches("b"));
+    EXPECT_FALSE(again.matches("a"));
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,80 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file subroutine_cache_test.cpp
+ *
+ * A test case testing the memo table of the results of subroutines.
+ *
+ ***********************************************************************/
+
+#include "SubroutineCache.h"
+#include "test.h"
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+TEST(SubroutineCache, LookupAndInsert) {
+    SubroutineCache cache(1 << 20);
+    std::vector<RamDomain> ret;
+    EXPECT_FALSE(cache.lookup("sub", {1, 2}, ret));
+
+    cache.insert("sub", {1, 2}, {3, 4, 5});
+    EXPECT_TRUE(cache.lookup("sub", {1, 2}, ret));
+    EXPECT_EQ(3, ret.size());
+    EXPECT_EQ(5, ret[2]);
+
+    // the results are keyed by the subroutine and all of its arguments
+    EXPECT_FALSE(cache.lookup("sub", {1}, ret));
+    EXPECT_FALSE(cache.lookup("other", {1, 2}, ret));
+}
+
+TEST(SubroutineCache, Versions) {
+    SubroutineCache cache(1 << 20);
+    std::vector<RamDomain> ret;
+    cache.insert("sub", {}, {1}, {0, 7});
+    cache.insert("sub", {1}, {2}, {0, 7});
+    cache.insert("other", {1}, {3}, {0, 1});
+    EXPECT_TRUE(cache.lookup("sub", {}, ret, {0, 7}));
+    EXPECT_TRUE(cache.lookup("sub", {1}, ret, {0, 7}));
+
+    // a relation read by the subroutine changed, which drops all of its results
+    EXPECT_FALSE(cache.lookup("sub", {1}, ret, {0, 8}));
+    EXPECT_FALSE(cache.lookup("sub", {}, ret, {0, 7}));
+    EXPECT_FALSE(cache.lookup("sub", {1}, ret, {0, 7}));
+
+    // but not those of other subroutines
+    EXPECT_TRUE(cache.lookup("other", {1}, ret, {0, 1}));
+    EXPECT_EQ(3, ret[0]);
+
+    // results of the current versions are held again
+    cache.insert("sub", {1}, {4}, {1, 7});
+    EXPECT_TRUE(cache.lookup("sub", {1}, ret, {1, 7}));
+    EXPECT_EQ(4, ret[0]);
+}
+
+TEST(SubroutineCache, Eviction) {
+    SubroutineCache cache(1024);
+    std::vector<RamDomain> ret;
+    for (RamDomain i = 0; i < 100; i++) {
+        cache.insert("sub", {i}, {i, i});
+        // the most recently used result is kept
+        EXPECT_TRUE(cache.lookup("sub", {0}, ret));
+    }
+    EXPECT_TRUE(cache.lookup("sub", {99}, ret));
+    EXPECT_FALSE(cache.lookup("sub", {1}, ret));
+
+    cache.setCapacity(0);
+    EXPECT_FALSE(cache.lookup("sub", {99}, ret));
+}
+
+}  // end namespace test
+}  // end namespace souffle
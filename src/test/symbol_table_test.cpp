@@ -15,9 +15,12 @@
  ***********************************************************************/
 
 #include "AstProgram.h"
+#include "SymbolDictionary.h"
 #include "test.h"
 
+#include <cstdio>
 #include <functional>
+#include <stdexcept>
 
 using namespace souffle;
 
@@ -63,6 +66,18 @@ TEST(SymbolTable, Copy) {
     delete b;
 }
 
+TEST(SymbolTable, StaticSymbols) {
+    // the symbols of an array keep their order, a repeated symbol keeping its first index
+    static constexpr const char* symbols[] = {"a", "", "bc", "a", "d"};
+    SymbolTable table(symbols, 5);
+    EXPECT_EQ(4, table.size());
+    EXPECT_EQ(0, table.lookup("a"));
+    EXPECT_EQ(1, table.lookup(""));
+    EXPECT_EQ(2, table.lookup("bc"));
+    EXPECT_EQ(3, table.lookup("d"));
+    EXPECT_STREQ("d", table.resolve(3));
+}
+
 TEST(SymbolTable, Assign) {
     auto* a = new SymbolTable();
     a->insert("Hello");
@@ -137,4 +152,99 @@ TEST(SymbolTable, Inserts) {
     }
 }
 
+TEST(SymbolTable, ParallelLookup) {
+    const size_t N = 100000;
+
+    SymbolTable table;
+    std::vector<RamDomain> indices(N);
+
+#pragma omp parallel for
+    for (size_t i = 0; i < 2 * N; ++i) {
+        RamDomain index = table.lookup(std::to_string(i % N) + "symbol");
+        if (i < N) {
+            indices[i] = index;
+        }
+    }
+
+    EXPECT_EQ(N, table.size());
+
+    // every symbol received a unique index, and resolves back to itself
+    std::set<RamDomain> unique(indices.begin(), indices.end());
+    EXPECT_EQ(N, unique.size());
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_EQ(std::to_string(i) + "symbol", table.resolve(indices[i]));
+        EXPECT_EQ(indices[i], table.lookupExisting(std::to_string(i) + "symbol"));
+    }
+
+    // a copy preserves all indices
+    SymbolTable copy(table);
+    EXPECT_EQ(N, copy.size());
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_EQ(table.resolve(i), copy.resolve(i));
+    }
+}
+
+TEST(SymbolTable, Concatenate) {
+    SymbolTable table;
+    RamDomain a = table.lookup("ab");
+    RamDomain b = table.lookup("c");
+    RamDomain e = table.lookup("");
+
+    RamDomain abc = table.concatenate({a, b});
+    EXPECT_EQ("abc", table.resolve(abc));
+    EXPECT_EQ(abc, table.concatenate({a, e, b}));
+    EXPECT_EQ(e, table.concatenate({e}));
+    EXPECT_EQ("abcabab", table.resolve(table.concatenate({abc, a, a})));
+}
+
+TEST(SymbolTable, MemoryUsage) {
+    SymbolTable table;
+    const size_t empty = table.memoryUsage();
+
+    std::string longSymbol(1000, 'x');
+    table.insert(longSymbol);
+    EXPECT_LT(empty + longSymbol.size(), table.memoryUsage());
+
+    // inserting an existing symbol does not store it again
+    const size_t used = table.memoryUsage();
+    table.insert(longSymbol);
+    EXPECT_EQ(used, table.memoryUsage());
+
+    // moving transfers the storage
+    SymbolTable moved(std::move(table));
+    EXPECT_EQ(used, moved.memoryUsage());
+    EXPECT_EQ(longSymbol, moved.resolve(0));
+}
+
+TEST(SymbolTable, Dictionary) {
+    const std::string fileName = "symbol_table_test.dict";
+    std::remove(fileName.c_str());
+
+    SymbolTable table({"a", "b"});
+    for (int i = 0; i < 1000; ++i) {
+        table.insert("sym" + std::to_string(i));
+    }
+    EXPECT_FALSE(seedSymbolTable(table, fileName));
+    saveSymbolTable(table, fileName);
+
+    // a table with the same constants obtains the indices of the saved table
+    SymbolTable seeded({"a", "b"});
+    EXPECT_TRUE(seedSymbolTable(seeded, fileName));
+    EXPECT_EQ(table.size(), seeded.size());
+    for (size_t i = 0; i < table.size(); ++i) {
+        EXPECT_EQ(table.resolve(i), seeded.resolve(i));
+    }
+
+    // a table with other constants is rejected
+    SymbolTable other({"b"});
+    bool failed = false;
+    try {
+        seedSymbolTable(other, fileName);
+    } catch (std::runtime_error&) {
+        failed = true;
+    }
+    EXPECT_TRUE(failed);
+    std::remove(fileName.c_str());
+}
+
 }  // end namespace test
@@ -0,0 +1,56 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file thread_binding_test.cpp
+ *
+ * A test case testing the placement of threads on NUMA nodes.
+ *
+ ***********************************************************************/
+
+#include "ThreadBinding.h"
+#include "test.h"
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace test {
+
+TEST(ThreadBinding, ParseCpuList) {
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), parseCpuList("0-3,8,10-11\n"));
+    EXPECT_EQ(std::vector<int>({5}), parseCpuList("5"));
+    EXPECT_EQ(std::vector<int>(), parseCpuList(""));
+    EXPECT_EQ(std::vector<int>(), parseCpuList("\n"));
+}
+
+TEST(ThreadBinding, Placement) {
+    const std::vector<std::vector<int>> nodes({{0, 1, 2}, {4, 5, 6}});
+
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 4}), getThreadPlacement("close", nodes, 4));
+    EXPECT_EQ(std::vector<int>({0, 4, 1, 5}), getThreadPlacement("spread", nodes, 4));
+
+    // more threads than cores wrap around
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 4, 5, 6, 0}), getThreadPlacement("close", nodes, 7));
+    EXPECT_EQ(std::vector<int>({0, 4, 1, 5, 2, 6, 0}), getThreadPlacement("spread", nodes, 7));
+
+    // nodes of different size
+    EXPECT_EQ(std::vector<int>({0, 4, 5}), getThreadPlacement("spread", {{0}, {4, 5}}, 3));
+    EXPECT_EQ(std::vector<int>(), getThreadPlacement("spread", {}, 3));
+}
+
+TEST(ThreadBinding, Bind) {
+    EXPECT_EQ("", bindThreads("none"));
+#if defined(_OPENMP) && defined(__linux__)
+    EXPECT_EQ(static_cast<std::size_t>(omp_get_max_threads()),
+            parseCpuList(bindThreads("close")).size());
+#endif
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -246,4 +246,23 @@ TEST(Util, Range) {
         }
         EXPECT_EQ(last, 8);
     }
+
+    {
+        // the number of partitions is capped by the minimal chunk size
+        int last = -1;
+        auto parts = range.partition(7, 4);
+        EXPECT_EQ(2, parts.size());
+        for (const auto& p : parts) {
+            auto size = p.end() - p.begin();
+            EXPECT_TRUE(4 <= size && size <= 5);
+            for (const auto& cur : p) {
+                EXPECT_EQ(last + 1, cur);
+                last = cur;
+            }
+        }
+        EXPECT_EQ(last, 8);
+
+        // a range below the minimal chunk size is not split up
+        EXPECT_EQ(1, range.partition(7, 100).size());
+    }
 }
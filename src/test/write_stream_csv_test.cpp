@@ -0,0 +1,141 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file write_stream_csv_test.cpp
+ *
+ * Tests the CSV writer.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "IODirectives.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "WriteStreamCSV.h"
+#include "json11.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace souffle::test {
+
+using Tuple = ram::Tuple<RamDomain, 3>;
+
+/** A minimal relation iterating its tuples in insertion order */
+struct Unordered {
+    std::vector<Tuple> tuples;
+
+    std::vector<Tuple>::const_iterator begin() const {
+        return tuples.begin();
+    }
+
+    std::vector<Tuple>::const_iterator end() const {
+        return tuples.end();
+    }
+
+    std::size_t size() const {
+        return tuples.size();
+    }
+};
+
+IODirectives getDirectives(const std::string& fileName, const std::map<std::string, std::string>& extra) {
+    std::vector<std::string> attributeTypes{"i", "s", "f"};
+    json11::Json types = json11::Json::object{
+            {"test", json11::Json::object{{"arity", static_cast<long long>(3)},
+                             {"auxArity", static_cast<long long>(0)},
+                             {"types", json11::Json::array(attributeTypes.begin(), attributeTypes.end())}}}};
+    std::map<std::string, std::string> directives = {
+            {"IO", "file"}, {"name", "test"}, {"filename", fileName}, {"types", types.dump()}};
+    directives.insert(extra.begin(), extra.end());
+    return IODirectives(directives);
+}
+
+/** Write a relation to a temporary file with the given directives, and return the lines written */
+template <typename Write>
+std::string writeLines(const std::map<std::string, std::string>& extra, const Write& write) {
+    char fileName[] = "/tmp/souffle-write-XXXXXX";
+    int fd = mkstemp(fileName);
+    close(fd);
+    {
+        SymbolTable symbolTable;
+        RecordTable recordTable;
+        WriteFileCSV writer(getDirectives(fileName, extra), symbolTable, recordTable);
+        write(writer, symbolTable);
+    }
+    std::ifstream file(fileName);
+    std::stringstream res;
+    res << file.rdbuf();
+    std::remove(fileName);
+    return res.str();
+}
+
+// an output sorted by a symbol is ordered by the text of the symbols, ties by the other columns
+TEST(WriteStreamCSV, SortedBySymbol) {
+    const std::string lines =
+            writeLines({{"orderColumns", "1"}}, [](WriteStream& writer, SymbolTable& symbolTable) {
+                Unordered rel;
+                for (const char* symbol : {"zeta", "beta", "alpha"}) {
+                    symbolTable.lookup(symbol);
+                }
+                rel.tuples.push_back(Tuple{{2, symbolTable.lookup("beta"), ramBitCast(1.5f)}});
+                rel.tuples.push_back(Tuple{{3, symbolTable.lookup("alpha"), ramBitCast(0.5f)}});
+                rel.tuples.push_back(Tuple{{1, symbolTable.lookup("beta"), ramBitCast(-2.5f)}});
+                rel.tuples.push_back(Tuple{{-4, symbolTable.lookup("zeta"), ramBitCast(3.0f)}});
+                writer.writeAll(rel);
+            });
+    EXPECT_EQ("3\talpha\t0.5\n1\tbeta\t-2.5\n2\tbeta\t1.5\n-4\tzeta\t3\n", lines);
+}
+
+// an output sorted by floats is ordered by their values rather than their representations
+TEST(WriteStreamCSV, SortedByFloat) {
+    const std::string lines =
+            writeLines({{"orderColumns", "2:0"}}, [](WriteStream& writer, SymbolTable& symbolTable) {
+                Unordered rel;
+                const RamDomain symbol = symbolTable.lookup("a");
+                rel.tuples.push_back(Tuple{{1, symbol, ramBitCast(1.5f)}});
+                rel.tuples.push_back(Tuple{{2, symbol, ramBitCast(-2.5f)}});
+                rel.tuples.push_back(Tuple{{0, symbol, ramBitCast(1.5f)}});
+                rel.tuples.push_back(Tuple{{3, symbol, ramBitCast(-0.5f)}});
+                writer.writeAll(rel);
+            });
+    EXPECT_EQ("2\ta\t-2.5\n3\ta\t-0.5\n0\ta\t1.5\n1\ta\t1.5\n", lines);
+}
+
+// an index whose order starts with the columns of the output is written as it is iterated
+TEST(WriteStreamCSV, IndexOrder) {
+    using Index = btree_set<Tuple, ram::index_utils::comparator<0, 2, 1>>;
+    Index index;
+    std::string expected;
+    const std::string lines =
+            writeLines({{"orderColumns", "0"}}, [&](WriteStream& writer, SymbolTable& symbolTable) {
+                const RamDomain symbol = symbolTable.lookup("a");
+                for (RamDomain i = 0; i < 10000; i++) {
+                    index.insert(Tuple{{(i * 7919) % 10000 - 5000, symbol, ramBitCast(0.5f)}});
+                }
+                for (RamDomain i = -5000; i < 5000; i++) {
+                    expected += std::to_string(i) + "\ta\t0.5\n";
+                }
+                writer.writeOrdered(IndexOrder<Index>(index));
+            });
+    EXPECT_EQ(expected, lines);
+}
+
+}  // end namespace souffle::test
@@ -0,0 +1,237 @@
+#!/bin/bash
+# Souffle - A Datalog Compiler
+# Copyright (c) 2020, The Souffle Developers. All rights reserved.
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+#
+# Benchmark the programs listed in tests/benchmark/programs, taken from tests/example with their
+# facts scaled up, in the interpreter and compiled, at several numbers of threads. The synthetic
+# workloads listed in tests/benchmark/workloads run the programs of tests/benchmark/synthetic on
+# facts generated by tests/benchmark/generate.sh at several sizes, which shows how the throughput
+# scales with the input as well as with the threads.
+#
+# For each program, mode and number of threads, the minimum wall time and the maximum peak RSS
+# over the repetitions are written as tab-separated values, with the tuples of the output
+# relations, the output tuples per second and the tuples of the input relations. If a baseline of
+# such values exists, the wall times are compared with it, and the script fails if any of them
+# regressed by more than the threshold.
+
+set -uo pipefail
+
+usage() {
+    cat <<EOF
+Usage: $0 [OPTION]...
+
+  -s FILE     souffle executable (default: \$SOUFFLE or souffle)
+  -m MODES    modes to run, from interpreter and compiled (default: "interpreter compiled")
+  -j JOBS     numbers of threads to run with (default: "1 4 8")
+  -r COUNT    repetitions of each run, of which the fastest counts (default: 3)
+  -p NAMES    programs to run, or synthetic workloads as program/generator (default: all of
+              tests/benchmark/programs and tests/benchmark/workloads)
+  -n SIZES    input sizes of the synthetic workloads (default: those of tests/benchmark/workloads)
+  -o FILE     write the results to FILE (default: benchmark.tsv)
+  -b FILE     compare the results with the baseline FILE (default: baseline.tsv, if it exists)
+  -t PERCENT  slowdown over the baseline reported as a regression (default: 10)
+  -u          store the results as the baseline instead of comparing with it
+  -h          display this help message
+EOF
+}
+
+BENCHMARK_DIR=$(cd "$(dirname "$0")" && pwd)
+EXAMPLES="$BENCHMARK_DIR/../example"
+SOUFFLE=${SOUFFLE:-souffle}
+MODES="interpreter compiled"
+JOBS="1 4 8"
+REPEAT=3
+PROGRAMS=""
+SIZES=""
+OUTPUT=benchmark.tsv
+BASELINE=baseline.tsv
+THRESHOLD=10
+UPDATE=0
+
+while getopts "s:m:j:r:p:n:o:b:t:uh" opt; do
+    case $opt in
+        s) SOUFFLE=$OPTARG ;;
+        m) MODES=$OPTARG ;;
+        j) JOBS=$OPTARG ;;
+        r) REPEAT=$OPTARG ;;
+        p) PROGRAMS=$OPTARG ;;
+        n) SIZES=$OPTARG ;;
+        o) OUTPUT=$OPTARG ;;
+        b) BASELINE=$OPTARG ;;
+        t) THRESHOLD=$OPTARG ;;
+        u) UPDATE=1 ;;
+        h) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+
+if ! command -v "$SOUFFLE" > /dev/null; then
+    echo "Error: souffle executable '$SOUFFLE' not found!"
+    exit 1
+fi
+
+# peak RSS is measured by GNU time, if it is installed
+TIME=""
+if /usr/bin/time -f "%M" true > /dev/null 2>&1; then
+    TIME=/usr/bin/time
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# copy the facts of a program, with the given number of copies of each fact; the symbols of all
+# but the first copy are suffixed by the index of the copy
+scale_facts() {
+    local src=$1 dst=$2 copies=$3
+    mkdir -p "$dst"
+    for file in "$src"/*; do
+        [ -f "$file" ] || continue
+        awk -F'\t' -v OFS='\t' -v copies="$copies" '{
+            for (k = 1; k <= copies; k++) {
+                line = ""
+                for (i = 1; i <= NF; i++) {
+                    field = $i
+                    if (k > 1 && field !~ /^-?[0-9]+(\.[0-9]+)?$/) {
+                        field = field "_" k
+                    }
+                    line = line (i > 1 ? OFS : "") field
+                }
+                print line
+            }
+        }' "$file" > "$dst/$(basename "$file")"
+    done
+}
+
+# run a command once; print its wall time in seconds and peak RSS in kilobytes
+measure() {
+    local TIMEFORMAT=%R wall rss="NA"
+    if [ -n "$TIME" ]; then
+        wall=$({ time "$TIME" -f "%M" -o "$WORK/rss" "$@" > /dev/null 2> "$WORK/err"; } 2>&1) || return 1
+        rss=$(tail -n 1 "$WORK/rss")
+    else
+        wall=$({ time "$@" > /dev/null 2> "$WORK/err"; } 2>&1) || return 1
+    fi
+    echo "$wall $rss"
+}
+
+# run a program in each mode with each number of threads on the given facts, and write its results
+# under the given name; a compiled program is compiled once for all of its facts
+run_program() {
+    local name=$1 source=$2 facts=$3
+    local binary
+    binary="$WORK/binaries/$(basename "$(dirname "$source")")-$(basename "$source" .dl)"
+    local out="$WORK/output" inputs
+    inputs=$(cat "$facts"/* 2> /dev/null | wc -l)
+
+    for mode in $MODES; do
+        if [ "$mode" = "compiled" ] && [ ! -x "$binary" ]; then
+            # the C++ compilation is not part of the measured time
+            mkdir -p "$WORK/binaries"
+            if ! "$SOUFFLE" -o "$binary" "$source" > /dev/null 2> "$WORK/err"; then
+                echo "Error: cannot compile $name" >&2
+                cat "$WORK/err" >&2
+                continue
+            fi
+        fi
+        for jobs in $JOBS; do
+            best="" peak=0 failed=0
+            for ((i = 0; i < REPEAT; ++i)); do
+                rm -rf "$out" && mkdir -p "$out"
+                if [ "$mode" = "compiled" ]; then
+                    result=$(measure "$binary" -F "$facts" -D "$out" -j "$jobs") || failed=1
+                else
+                    result=$(measure "$SOUFFLE" -F "$facts" -D "$out" -j "$jobs" "$source") || failed=1
+                fi
+                if [ $failed -ne 0 ]; then
+                    echo "Error: $name failed in $mode mode with $jobs threads" >&2
+                    cat "$WORK/err" >&2
+                    break
+                fi
+                read -r wall rss <<< "$result"
+                if [ -z "$best" ] || awk -v a="$wall" -v b="$best" 'BEGIN { exit !(a < b) }'; then
+                    best=$wall
+                fi
+                if [ "$rss" = "NA" ] || [ "$peak" = "NA" ]; then
+                    peak="NA"
+                elif [ "$rss" -gt "$peak" ]; then
+                    peak=$rss
+                fi
+            done
+            [ $failed -eq 0 ] || continue
+            tuples=$(cat "$out"/* 2> /dev/null | wc -l)
+            rate=$(awk -v n="$tuples" -v t="$best" 'BEGIN { printf "%.1f", (t > 0 ? n / t : 0) }')
+            printf "%s\t%s\t%s\t%.3f\t%s\t%s\t%s\t%s\n" "$name" "$mode" "$jobs" "$best" "$peak" "$tuples" "$rate" \
+                    "$inputs" | tee -a "$OUTPUT"
+        done
+    done
+}
+
+printf "program\tmode\tjobs\twall\trss\ttuples\ttuples_per_second\tinput_tuples\n" > "$OUTPUT"
+
+grep -v '^#' "$BENCHMARK_DIR/programs" | while read -r program copies; do
+    [ -n "$program" ] || continue
+    if [ -n "$PROGRAMS" ] && [[ " $PROGRAMS " != *" $program "* ]]; then
+        continue
+    fi
+    dir="$EXAMPLES/$program"
+    facts="$WORK/$program/facts"
+    if [ -d "$dir/facts" ]; then
+        scale_facts "$dir/facts" "$facts" "$copies"
+    else
+        mkdir -p "$facts"
+    fi
+    run_program "$program" "$dir/$program.dl" "$facts"
+    rm -rf "$WORK/$program"
+done
+
+# the synthetic workloads are named by their program, generator and size, e.g. tc/chain/1000
+grep -v '^#' "$BENCHMARK_DIR/workloads" | while read -r program generator sizes; do
+    [ -n "$program" ] || continue
+    if [ -n "$PROGRAMS" ] && [[ " $PROGRAMS " != *" $program "* ]] &&
+            [[ " $PROGRAMS " != *" $program/$generator "* ]]; then
+        continue
+    fi
+    for size in ${SIZES:-$sizes}; do
+        facts="$WORK/$program/$generator/$size"
+        if ! "$BENCHMARK_DIR/generate.sh" "$generator" "$size" "$facts" > /dev/null 2> "$WORK/err"; then
+            echo "Error: cannot generate the facts of $program/$generator/$size" >&2
+            cat "$WORK/err" >&2
+            continue
+        fi
+        run_program "$program/$generator/$size" "$BENCHMARK_DIR/synthetic/$program.dl" "$facts"
+        rm -rf "$facts"
+    done
+done
+
+if [ $UPDATE -eq 1 ]; then
+    cp "$OUTPUT" "$BASELINE"
+    echo "Stored the results as the baseline $BASELINE"
+    exit 0
+fi
+if [ ! -f "$BASELINE" ]; then
+    echo "No baseline $BASELINE to compare with; store one with -u"
+    exit 0
+fi
+
+# compare the wall times with those of the baseline
+awk -F'\t' -v threshold="$THRESHOLD" '
+    FNR == 1 { next }
+    NR == FNR { base[$1 FS $2 FS $3] = $4; next }
+    ($1 FS $2 FS $3) in base {
+        old = base[$1 FS $2 FS $3]
+        change = old > 0 ? 100 * ($4 - old) / old : 0
+        status = change > threshold ? "REGRESSION" : "ok"
+        if (change > threshold) {
+            regressions++
+        }
+        printf "%-20s %-12s -j%-4s %9.3fs -> %9.3fs %+7.1f%%  %s\n", $1, $2, $3, old, $4, change, status
+    }
+    END {
+        if (regressions > 0) {
+            printf "%d regression(s) over %s%% against the baseline\n", regressions, threshold
+            exit 1
+        }
+    }' "$BASELINE" "$OUTPUT"
@@ -0,0 +1,213 @@
+#!/bin/bash
+# Souffle - A Datalog Compiler
+# Copyright (c) 2020, The Souffle Developers. All rights reserved.
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+#
+# Benchmark the compilation of large generated programs, whose turnaround is dominated by the
+# front-end and the C++ compiler rather than by their evaluation. Each program is compiled with
+# --phase-times, and the time of each phase, i.e. parsing, each AST and RAM transformer summed
+# over its applications, the translation to RAM, the synthesis and the compilation of the C++ code,
+# is written as tab-separated values, with the total time of the compilation.
+#
+# The programs are generated at several sizes:
+#   strata  a chain of SIZE relations, each joining the previous one with the input, in as many strata
+#   scc     SIZE mutually recursive relations, which form a single large SCC
+#   wide    SIZE/10 relations of 16 attributes, each a rotation of the previous one
+#
+# If a baseline of such values exists, the times are compared with it, and the script fails if any
+# phase taking longer than the minimum time regressed by more than the threshold.
+
+set -uo pipefail
+
+usage() {
+    cat <<EOF
+Usage: $0 [OPTION]...
+
+  -s FILE     souffle executable (default: \$SOUFFLE or souffle)
+  -p NAMES    programs to compile, from strata, scc and wide (default: "strata scc wide")
+  -n SIZES    sizes of the generated programs (default: "250 500 1000")
+  -r COUNT    repetitions of each compilation, of which the fastest counts per phase (default: 3)
+  -g          only generate the C++ code, without compiling it
+  -o FILE     write the results to FILE (default: frontend.tsv)
+  -b FILE     compare the results with the baseline FILE (default: frontend-baseline.tsv, if it exists)
+  -t PERCENT  slowdown over the baseline reported as a regression (default: 10)
+  -m SECONDS  phases faster than this in the baseline are not compared (default: 0.05)
+  -u          store the results as the baseline instead of comparing with it
+  -h          display this help message
+EOF
+}
+
+SOUFFLE=${SOUFFLE:-souffle}
+PROGRAMS="strata scc wide"
+SIZES="250 500 1000"
+REPEAT=3
+GENERATE=0
+OUTPUT=frontend.tsv
+BASELINE=frontend-baseline.tsv
+THRESHOLD=10
+MINIMUM=0.05
+UPDATE=0
+
+while getopts "s:p:n:r:go:b:t:m:uh" opt; do
+    case $opt in
+        s) SOUFFLE=$OPTARG ;;
+        p) PROGRAMS=$OPTARG ;;
+        n) SIZES=$OPTARG ;;
+        r) REPEAT=$OPTARG ;;
+        g) GENERATE=1 ;;
+        o) OUTPUT=$OPTARG ;;
+        b) BASELINE=$OPTARG ;;
+        t) THRESHOLD=$OPTARG ;;
+        m) MINIMUM=$OPTARG ;;
+        u) UPDATE=1 ;;
+        h) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+
+if ! command -v "$SOUFFLE" > /dev/null; then
+    echo "Error: souffle executable '$SOUFFLE' not found!"
+    exit 1
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# write the program of the given kind and size to stdout
+generate() {
+    local kind=$1 size=$2
+    awk -v kind="$kind" -v size="$size" 'BEGIN {
+        print ".decl e(x:number, y:number)"
+        print ".input e"
+        if (kind == "strata") {
+            print ".decl r0(x:number, y:number)"
+            print "r0(x, y) :- e(x, y)."
+            for (i = 1; i < size; i++) {
+                printf ".decl r%d(x:number, y:number)\n", i
+                printf "r%d(x, y) :- r%d(x, z), e(z, y), x != y.\n", i, i - 1
+                printf "r%d(x, x) :- r%d(x, _), !r%d(_, x).\n", i, i - 1, i - 1
+            }
+            printf ".output r%d\n", size - 1
+        } else if (kind == "scc") {
+            for (i = 0; i < size; i++) {
+                printf ".decl s%d(x:number, y:number)\n", i
+                printf "s%d(x, y) :- e(x, y), x < %d.\n", i, i
+                printf "s%d(x, y) :- s%d(x, z), e(z, y).\n", i, (i + size - 1) % size
+                printf "s%d(x, y) :- s%d(x, z), s%d(z, y).\n", i, (i + 1) % size, (i + 7) % size
+            }
+            print ".output s0"
+        } else if (kind == "wide") {
+            args = "a1"
+            for (j = 2; j <= 16; j++) {
+                args = args ", a" j
+            }
+            rotated = "a2"
+            for (j = 3; j <= 16; j++) {
+                rotated = rotated ", a" j
+            }
+            rotated = rotated ", a1"
+            decl = "a1:number"
+            for (j = 2; j <= 16; j++) {
+                decl = decl ", a" j ":number"
+            }
+            printf ".decl w0(%s)\n", decl
+            printf "w0(%s) :- e(a1, a2)", args
+            for (j = 3; j <= 16; j++) {
+                printf ", e(a%d, a%d)", j - 1, j
+            }
+            print "."
+            for (i = 1; i < size / 10; i++) {
+                printf ".decl w%d(%s)\n", i, decl
+                printf "w%d(%s) :- w%d(%s), a1 != a16.\n", i, args, i - 1, rotated
+                printf "w%d(%s) :- w%d(%s), e(a16, a1).\n", i, args, i - 1, args
+            }
+            printf ".output w%d\n", int((size - 1) / 10)
+        }
+    }'
+}
+
+# compile a program once; append the seconds of each of its phases, summed over the applications
+# of a transformer, and of the whole compilation to the given file
+compile() {
+    local source=$1 result=$2
+    local TIMEFORMAT=%R wall
+    local target=(-o "$WORK/binary")
+    if [ $GENERATE -eq 1 ]; then
+        target=(-g "$WORK/binary.cpp")
+    fi
+    wall=$({ time "$SOUFFLE" --phase-times="$WORK/phases.json" "${target[@]}" "$source" \
+            > /dev/null 2> "$WORK/err"; } 2>&1) || return 1
+    # the phases are one JSON object each, whose keys are written in order
+    grep -o '{[^{}]*}' "$WORK/phases.json" |
+            sed -n 's/.*"name": "\([^"]*\)".*"phase": "\([^"]*\)".*"seconds": \([^,}]*\).*/\2\t\1\t\3/p' |
+            awk -F'\t' -v OFS='\t' '
+                !(($1 FS $2) in seconds) { order[++n] = $1 FS $2 }
+                { seconds[$1 FS $2] += $3 }
+                END { for (i = 1; i <= n; i++) print order[i], seconds[order[i]] }' >> "$result"
+    printf "total\tsouffle\t%s\n" "$wall" >> "$result"
+}
+
+printf "program\tsize\tphase\tname\tseconds\n" > "$OUTPUT"
+
+for program in $PROGRAMS; do
+    for size in $SIZES; do
+        source="$WORK/$program-$size.dl"
+        generate "$program" "$size" > "$source"
+        rm -f "$WORK/runs"
+        failed=0
+        for ((i = 0; i < REPEAT; ++i)); do
+            if ! compile "$source" "$WORK/runs"; then
+                echo "Error: cannot compile $program/$size" >&2
+                cat "$WORK/err" >&2
+                failed=1
+                break
+            fi
+        done
+        [ $failed -eq 0 ] || continue
+        # the fastest repetition of each phase counts
+        awk -F'\t' -v OFS='\t' -v program="$program" -v size="$size" '
+            !(($1 FS $2) in best) { order[++n] = $1 FS $2; best[$1 FS $2] = $3 }
+            $3 < best[$1 FS $2] { best[$1 FS $2] = $3 }
+            END {
+                for (i = 1; i <= n; i++) {
+                    printf "%s\t%s\t%s\t%.3f\n", program, size, order[i], best[order[i]]
+                }
+            }
+        ' "$WORK/runs" | tee -a "$OUTPUT"
+    done
+done
+
+if [ $UPDATE -eq 1 ]; then
+    cp "$OUTPUT" "$BASELINE"
+    echo "Stored the results as the baseline $BASELINE"
+    exit 0
+fi
+if [ ! -f "$BASELINE" ]; then
+    echo "No baseline $BASELINE to compare with; store one with -u"
+    exit 0
+fi
+
+# compare the times of the phases with those of the baseline
+awk -F'\t' -v threshold="$THRESHOLD" -v minimum="$MINIMUM" '
+    FNR == 1 { next }
+    NR == FNR { base[$1 FS $2 FS $3 FS $4] = $5; next }
+    ($1 FS $2 FS $3 FS $4) in base {
+        old = base[$1 FS $2 FS $3 FS $4]
+        if (old < minimum) {
+            next
+        }
+        change = old > 0 ? 100 * ($5 - old) / old : 0
+        status = change > threshold ? "REGRESSION" : "ok"
+        if (change > threshold) {
+            regressions++
+        }
+        printf "%-12s %-14s %-30s %9.3fs -> %9.3fs %+7.1f%%  %s\n", $1 "/" $2, $3, $4, old, $5, change, status
+    }
+    END {
+        if (regressions > 0) {
+            printf "%d regression(s) over %s%% against the baseline\n", regressions, threshold
+            exit 1
+        }
+    }' "$BASELINE" "$OUTPUT"
@@ -0,0 +1,91 @@
+#!/bin/bash
+# Souffle - A Datalog Compiler
+# Copyright (c) 2020, The Souffle Developers. All rights reserved.
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+#
+# Generate the facts of a synthetic workload of the benchmark, with a fixed seed such that the
+# facts of a size are the same in each run.
+#
+# The graph generators write the relation edge, oriented from higher to lower nodes, hence each
+# graph is acyclic and each triangle is found once:
+#   chain     N nodes, each with an edge to its predecessor
+#   grid      a square grid of N nodes, with edges to the left, upper and upper left neighbours
+#   powerlaw  N nodes, each with edges to 1 to 3 earlier nodes, skewed towards the earliest
+#             ones such that the in-degrees follow a power law
+#   strings   the powerlaw graph, whose nodes are long symbols sharing prefixes
+# The generator pointsto writes the relations AddressOf, Assign, Load and Store of a program
+# with N variables, whose assignments are skewed towards a few of the variables.
+
+set -euo pipefail
+
+if [ $# -lt 3 ]; then
+    echo "Usage: $0 GENERATOR SIZE DIR [SEED]"
+    echo "Generators: chain, grid, powerlaw, strings, pointsto"
+    exit 1
+fi
+
+GENERATOR=$1
+SIZE=$2
+DIR=$3
+SEED=${4:-1}
+
+mkdir -p "$DIR"
+
+case $GENERATOR in
+    chain)
+        awk -v n="$SIZE" 'BEGIN { for (i = 1; i < n; i++) print i "\t" i - 1 }' > "$DIR/edge.facts"
+        ;;
+    grid)
+        awk -v n="$SIZE" 'BEGIN {
+            side = int(sqrt(n))
+            for (r = 0; r < side; r++) {
+                for (c = 0; c < side; c++) {
+                    v = r * side + c
+                    if (c > 0) print v "\t" v - 1
+                    if (r > 0) print v "\t" v - side
+                    if (r > 0 && c > 0) print v "\t" v - side - 1
+                }
+            }
+        }' > "$DIR/edge.facts"
+        ;;
+    powerlaw | strings)
+        awk -v n="$SIZE" -v seed="$SEED" -v strings=$([ "$GENERATOR" = strings ] && echo 1 || echo 0) '
+            function name(v) {
+                if (!strings) return v
+                return "/usr/share/java/package" v % 97 "/src/main/java/org/example/module" v % 13 \
+                        "/Class" v ".java"
+            }
+            BEGIN {
+                srand(seed)
+                for (i = 1; i < n; i++) {
+                    degree = 1 + int(3 * rand())
+                    for (k = 0; k < degree; k++) {
+                        r = rand()
+                        print name(i) "\t" name(int(i * r * r * r))
+                    }
+                }
+            }' > "$DIR/edge.facts"
+        ;;
+    pointsto)
+        awk -v n="$SIZE" -v seed="$SEED" -v dir="$DIR" '
+            function var() {
+                r = rand()
+                return "v" int(n * r * r)
+            }
+            BEGIN {
+                srand(seed)
+                for (i = 0; i < n; i++) {
+                    if (rand() < 0.3) print "v" i "\to" i > (dir "/AddressOf.facts")
+                    print var() "\t" var() > (dir "/Assign.facts")
+                    if (rand() < 0.2) print var() "\t" var() > (dir "/Load.facts")
+                    if (rand() < 0.2) print var() "\t" var() > (dir "/Store.facts")
+                }
+            }'
+        ;;
+    *)
+        echo "Error: unknown generator $GENERATOR" >&2
+        exit 1
+        ;;
+esac
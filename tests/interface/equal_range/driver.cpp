@@ -0,0 +1,85 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program looking up tuples by some of their attributes using the OO-interface
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Print the tuples of a binary relation with the given values in the given columns, in order
+ */
+void lookup(const Relation* rel, const std::string& title, const std::vector<std::size_t>& columns,
+        const std::vector<RamDomain>& values) {
+    std::vector<std::array<RamDomain, 2>> found;
+    rel->equalRange(columns, values, [&](const tuple& t) { found.push_back({t[0], t[1]}); });
+    std::sort(found.begin(), found.end());
+    std::cout << title << ":";
+    for (const auto& cur : found) {
+        std::cout << " (" << cur[0] << "," << cur[1] << ")";
+    }
+    std::cout << "\n";
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // check number of arguments
+    if (argc != 2) {
+        error("wrong number of arguments!");
+    }
+
+    // create instance of program "equal_range"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("equal_range")) {
+        // load all input relations from the facts directory
+        prog->loadAll(argv[1]);
+
+        // run program
+        prog->run();
+
+        Relation* edge = prog->getRelation("edge");
+        Relation* path = prog->getRelation("path");
+        if (edge == nullptr || path == nullptr) {
+            error("cannot find relations edge and path");
+        }
+
+        // edge is indexed by its first attribute, path is not indexed
+        lookup(edge, "edge(1,_)", {0}, {1});
+        lookup(path, "path(2,_)", {0}, {2});
+        lookup(path, "path(_,4)", {1}, {4});
+        lookup(path, "path(1,4)", {0, 1}, {1, 4});
+        lookup(path, "path(1,_) and path(2,_)", {0, 0}, {1, 2});
+
+        // free program
+        delete prog;
+
+    } else {
+        error("cannot find program equal_range");
+    }
+}
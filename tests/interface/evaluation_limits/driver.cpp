@@ -0,0 +1,76 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program cancelling the evaluation of a program using the OO-interface
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <iostream>
+#include <string>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Run the program, and print why it was aborted or the size of relation path
+ */
+void run(SouffleProgram* prog, const std::string& title) {
+    try {
+        prog->run();
+        std::cout << title << ": path has " << prog->getRelation("path")->size() << " tuples\n";
+    } catch (EvaluationAborted& e) {
+        std::cout << title << ": " << e.what() << "\n";
+    }
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // check number of arguments
+    if (argc != 2) {
+        error("wrong number of arguments!");
+    }
+
+    // create instance of program "evaluation_limits"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("evaluation_limits")) {
+        prog->loadAll(argv[1]);
+        prog->setBaseRelations({"edge"});
+
+        // a cancelled token aborts the evaluation at the first iteration of the fixpoint
+        CancellationToken token;
+        prog->setCancellationToken(token);
+        token.cancel();
+        run(prog, "cancelled");
+
+        // the tuples derived before the cancellation are removed by a reset
+        prog->reset();
+        prog->setCancellationToken(CancellationToken());
+        prog->setTimeBudget(std::chrono::minutes(1));
+        prog->setMemoryBudget(std::size_t(1) << 40);
+        run(prog, "within budgets");
+
+        // free program
+        delete prog;
+
+    } else {
+        error("cannot find program evaluation_limits");
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program serving requests against a loaded base relation, by
+ * resetting a program instance and by forking it, including forks that
+ * modify the base relation, using the OO-interface
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Evaluate the request of the nodes reachable from the given node, and print them in order
+ */
+void request(SouffleProgram* prog, const std::string& title, RamDomain node) {
+    Relation* source = prog->getRelation("source");
+    Relation* reach = prog->getRelation("reach");
+    if (source == nullptr || reach == nullptr) {
+        error("cannot find relations source and reach");
+    }
+    tuple t(source);
+    t << node;
+    source->insert(t);
+
+    prog->run();
+
+    std::vector<RamDomain> nodes;
+    for (auto& cur : *reach) {
+        RamDomain value;
+        cur >> value;
+        nodes.push_back(value);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    std::cout << title << ":";
+    for (RamDomain value : nodes) {
+        std::cout << " " << value;
+    }
+    std::cout << "\n";
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // check number of arguments
+    if (argc != 2) {
+        error("wrong number of arguments!");
+    }
+
+    // create instance of program "fork_reset"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("fork_reset")) {
+        // load the base relation edge, which is kept by resets and shared by forks
+        prog->loadAll(argv[1]);
+        prog->setBaseRelations({"edge"});
+
+        // serve requests with the same instance, resetting it in between
+        request(prog, "reach from 1", 1);
+        prog->reset();
+        request(prog, "reach from 3", 3);
+        prog->reset();
+        std::cout << "edges after reset: " << prog->getRelation("edge")->size() << "\n";
+
+        // serve requests with forks of the instance
+        std::unique_ptr<SouffleProgram> first(prog->fork());
+        std::unique_ptr<SouffleProgram> second(prog->fork());
+        if (first == nullptr || second == nullptr) {
+            error("cannot fork program fork_reset");
+        }
+        request(first.get(), "fork reach from 2", 2);
+        request(second.get(), "fork reach from 4", 4);
+        std::cout << "reach of base: " << prog->getRelation("reach")->size() << "\n";
+
+        // a variant inserting into a base relation copies it, leaving the base and other forks unchanged
+        std::unique_ptr<SouffleProgram> variant(prog->fork());
+        Relation* edge = variant->getRelation("edge");
+        tuple back(edge);
+        back << 4 << 1;
+        edge->insert(back);
+        request(variant.get(), "variant reach from 2", 2);
+        first->reset();
+        request(first.get(), "fork reach from 3", 3);
+        std::cout << "edges of variant: " << edge->size() << "\n";
+        std::cout << "edges of base: " << prog->getRelation("edge")->size() << "\n";
+
+        // a variant purging a base relation only drops its share
+        std::unique_ptr<SouffleProgram> empty(prog->fork());
+        empty->getRelation("edge")->purge();
+        request(empty.get(), "empty reach from 1", 1);
+        std::cout << "edges of base: " << prog->getRelation("edge")->size() << "\n";
+
+        // unknown base relations are rejected
+        try {
+            prog->setBaseRelations({"missing"});
+        } catch (std::invalid_argument& e) {
+            std::cout << e.what() << "\n";
+        }
+
+        // free program
+        delete prog;
+
+    } else {
+        error("cannot find program fork_reset");
+    }
+}
@@ -13,6 +13,8 @@
  * Testing the user-defined functor interface
  *
  ***********************************************************************/
+#include "RecordTable.h"
+#include "SymbolTable.h"
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -69,4 +71,13 @@ FF_int factorial(FF_uint x) {
 FF_int rnd(FF_float x) {
     return round(x);
 }
+
+souffle::RamDomain mycat(souffle::SymbolTable* symbolTable, souffle::RecordTable*, souffle::RamDomain x,
+        souffle::RamDomain y) {
+    return symbolTable->lookup(symbolTable->resolve(x) + symbolTable->resolve(y));
+}
+
+souffle::RamDomain twice(souffle::SymbolTable*, souffle::RecordTable*, souffle::RamDomain x) {
+    return 2 * x;
+}
 }
@@ -0,0 +1,94 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program reloading a program from a loaded instance, migrating
+ * its input relations into the new instance, using the OO-interface
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Evaluate the program, and print the reached nodes in order
+ */
+void printReach(SouffleProgram* prog, const std::string& title) {
+    prog->run();
+
+    std::vector<std::string> nodes;
+    for (auto& cur : *prog->getRelation("reach")) {
+        std::string node;
+        cur >> node;
+        nodes.push_back(node);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    std::cout << title << ":";
+    for (const std::string& node : nodes) {
+        std::cout << " " << node;
+    }
+    std::cout << "\n";
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // check number of arguments
+    if (argc != 2) {
+        error("wrong number of arguments!");
+    }
+
+    // create instance of program "hot_reload"
+    SouffleProgram* prog = ProgramFactory::newInstance("hot_reload");
+    if (prog == nullptr) {
+        error("cannot find program hot_reload");
+    }
+    prog->loadAll(argv[1]);
+    printReach(prog, "reach");
+
+    // reload the program, sharing the symbol table and the input relations of the loaded instance
+    std::unique_ptr<SouffleProgram> reloaded(ProgramFactory::reloadInstance("hot_reload", *prog));
+    if (reloaded == nullptr) {
+        error("cannot reload program hot_reload");
+    }
+    std::cout << "migrated:";
+    for (const std::string& name : reloaded->migrateRelations(*prog)) {
+        std::cout << " " << name;
+    }
+    std::cout << "\n";
+
+    // the migrated relations outlive the previous instance, and are not loaded again
+    delete prog;
+    reloaded->loadAll(argv[1]);
+    printReach(reloaded.get(), "reach of reloaded");
+    std::cout << "edges of reloaded: " << reloaded->getRelation("edge")->size() << "\n";
+
+    Relation* source = reloaded->getRelation("source");
+    tuple t(source);
+    t << std::string("a");
+    source->insert(t);
+    printReach(reloaded.get(), "reach of reloaded with a new source");
+}
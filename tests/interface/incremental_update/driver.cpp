@@ -0,0 +1,95 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program updating a Souffle program incrementally using the OO-interface
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <string>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Print the pairs of a binary relation and the nodes of a unary relation
+ */
+void print(SouffleProgram* prog) {
+    std::cout << "path:";
+    for (auto& output : *prog->getRelation("path")) {
+        std::string src;
+        std::string dest;
+        output >> src >> dest;
+        std::cout << " " << src << "-" << dest;
+    }
+    std::cout << "\n";
+    for (std::string name : {"cyclic", "acyclic"}) {
+        std::cout << name << ":";
+        for (auto& output : *prog->getRelation(name)) {
+            std::string node;
+            output >> node;
+            std::cout << " " << node;
+        }
+        std::cout << "\n";
+    }
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // create an instance of program "incremental_update"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("incremental_update")) {
+        // get input relation "edge"
+        if (Relation* edge = prog->getRelation("edge")) {
+            // load the facts and run the program
+            prog->loadAll(argv[1]);
+            prog->run();
+            print(prog);
+
+            // close a cycle and extend the graph
+            tuple t1(edge);
+            t1 << "D"
+               << "A";
+            prog->insert(t1);
+            tuple t2(edge);
+            t2 << "D"
+               << "E";
+            prog->insert(t2);
+            prog->updateIncremental();
+            print(prog);
+
+            // break the cycle again
+            tuple t3(edge);
+            t3 << "B"
+               << "C";
+            prog->remove(t3);
+            prog->updateIncremental();
+            print(prog);
+
+            // free program analysis
+            delete prog;
+
+        } else {
+            error("cannot find relation edge");
+        }
+    } else {
+        error("cannot find program incremental_update");
+    }
+}
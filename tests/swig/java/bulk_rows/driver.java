@@ -0,0 +1,62 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+
+public class driver {
+  static {
+    try {
+      System.loadLibrary("SwigInterface");
+    } catch (UnsatisfiedLinkError e) {
+      System.load(System.getProperty("java.library.path") + "/" + "libSwigInterface.so");
+    }
+
+  }
+
+  // direct buffer in native byte order holding the given number of values
+  static ByteBuffer buffer(int length) {
+    return ByteBuffer.allocateDirect(4 * length).order(ByteOrder.nativeOrder());
+  }
+
+  static ByteBuffer rows(int... values) {
+    ByteBuffer res = buffer(values.length);
+    res.asIntBuffer().put(values);
+    return res;
+  }
+
+  public static void main(String argv[]) {
+    SWIGSouffleProgram p = SwigInterface.newInstance("bulk_rows");
+
+    // insert the rows of direct buffers, symbols referring to a dictionary
+    p.insertRows("edge", rows(1, 2, 2, 3, 3, 4));
+    vector_string dictionary = new vector_string();
+    dictionary.add("a");
+    dictionary.add("b");
+    dictionary.add("c");
+    p.insertRows("name", rows(1, 0, 2, 1, 3, 2, 4, 0), dictionary);
+    p.run();
+
+    // extract the rows into direct buffers, symbols referring to the symbols of the program
+    ByteBuffer path = buffer((int) (p.getSize("path") * p.getArity("path")));
+    long count = p.extractRows("path", path);
+    IntBuffer values = path.asIntBuffer();
+    for (int i = 0; i < count; i++) {
+      System.out.println(values.get(2 * i) + " " + values.get(2 * i + 1));
+    }
+    vector_string symbols = p.getSymbols();
+    ByteBuffer named = buffer((int) (p.getSize("named") * p.getArity("named")));
+    count = p.extractRows("named", named);
+    values = named.asIntBuffer();
+    for (int i = 0; i < count; i++) {
+      System.out.println(symbols.get(values.get(2 * i)) + " " + symbols.get(values.get(2 * i + 1)));
+    }
+    p.finalize();
+  }
+}
@@ -0,0 +1,29 @@
+"""
+Souffle - A Datalog Compiler
+Copyright (c) 2020, The Souffle Developers. All rights reserved
+Licensed under the Universal Permissive License v 1.0 as shown at:
+- https://opensource.org/licenses/UPL
+- <souffle root>/licenses/SOUFFLE-UPL.txt
+"""
+
+import SwigInterface
+import array
+
+p = SwigInterface.newInstance('bulk_rows')
+
+# insert the rows of arrays supporting the buffer protocol, symbols referring to a dictionary
+p.insertRows('edge', array.array('i', [1, 2, 2, 3, 3, 4]))
+p.insertRows('name', array.array('i', [1, 0, 2, 1, 3, 2, 4, 0]), ('a', 'b', 'c'))
+p.run()
+
+# extract the rows into arrays, symbols referring to the symbols of the program
+path = array.array('i', [0] * (p.getSize('path') * p.getArity('path')))
+for i in range(p.extractRows('path', path)):
+    print(path[2 * i], path[2 * i + 1])
+symbols = p.getSymbols()
+named = array.array('i', [0] * (p.getSize('named') * p.getArity('named')))
+for i in range(p.extractRows('named', named)):
+    print(symbols[named[2 * i]], symbols[named[2 * i + 1]])
+
+p.thisown = 1
+del p